@@ -16,6 +16,7 @@ namespace fs = std::experimental::filesystem;
 #include <fstream>
 #include <stdexcept>
 
+#include <fb303/ServiceData.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/FileUtil.h>
 #include <folly/Format.h>
@@ -24,6 +25,7 @@ namespace fs = std::experimental::filesystem;
 #include <folly/Optional.h>
 #include <folly/gen/Base.h>
 #include <folly/gen/String.h>
+#include <folly/synchronization/Baton.h>
 #include <folly/init/Init.h>
 #include <folly/system/ThreadName.h>
 #include <glog/logging.h>
@@ -38,11 +40,13 @@ namespace fs = std::experimental::filesystem;
 #include <openr/common/BuildInfo.h>
 #include <openr/common/Constants.h>
 #include <openr/common/Flags.h>
+#include <openr/common/MemoryAllocator.h>
 #include <openr/common/Util.h>
 #include <openr/config-store/PersistentStore.h>
 #include <openr/config/Config.h>
 #include <openr/config/GflagConfig.h>
 #include <openr/ctrl-server/OpenrCtrlHandler.h>
+#include <openr/ctrl-server/OpenrCtrlThreadManager.h>
 #include <openr/decision/Decision.h>
 #include <openr/decision/RouteUpdate.h>
 #include <openr/fib/Fib.h>
@@ -67,6 +71,7 @@ using namespace openr;
 using namespace folly::gen;
 
 using apache::thrift::concurrency::ThreadManager;
+using openr::messaging::QueueMode;
 using openr::messaging::ReplicateQueue;
 
 namespace {
@@ -77,7 +82,8 @@ namespace {
 const std::string inet6Path = "/proc/net/if_inet6";
 } // namespace
 
-// Disable background jemalloc background thread => new jemalloc-5 feature
+// Disable background jemalloc background thread => new jemalloc-5 feature.
+// Default until `memory_allocator_config` of config is applied at startup
 const char* malloc_conf = "background_thread:false";
 
 void
@@ -123,35 +129,84 @@ waitForFibService(const folly::EventBase& mainEvb, int port) {
 }
 
 /**
- * Start an EventBase in a thread, maintain order of thread creation and
- * returns raw pointer of Derived class.
+ * Options of named queue between modules, with its dwell time measured if
+ * enabled
  */
-template <typename T>
-T*
+template <typename ValueType>
+openr::messaging::QueueOptions<ValueType>
+getQueueOptions(const std::string& name, QueueMode mode = QueueMode::LOCKED) {
+  openr::messaging::QueueOptions<ValueType> options;
+  options.mode = mode;
+  options.name = name;
+  options.measureDwellTime = FLAGS_enable_queue_dwell_time;
+  return options;
+}
+
+// Startup of a module, see startEventBase()
+struct ModuleStartup {
+  std::string name;
+  OpenrEventBase* evb{nullptr};
+  Watchdog* watchdog{nullptr};
+  std::chrono::steady_clock::time_point createStartTime;
+  std::chrono::steady_clock::time_point createEndTime;
+  // Set in EventBase of module once it runs
+  std::chrono::steady_clock::time_point runTime;
+  folly::Baton<> runBaton;
+};
+
+/**
+ * Create module with createFn, start its EventBase in a thread, maintain
+ * order of thread creation and returns raw pointer of Derived class. The
+ * thread applies `module_thread_configs` of config for module, if any.
+ *
+ * NOTE: It doesn't wait for the EventBase to run, hence modules initialize
+ * concurrently with creation of the ones after them. Modules only interact
+ * through queues and calls scheduled into EventBase of one another, which
+ * get served once it runs. Modules blocking on a call into another module in
+ * their constructor, e.g. loading state from PersistentStore, wait for it.
+ * See waitUntilModulesRunning().
+ */
+template <typename CreateFn>
+auto
 startEventBase(
     std::vector<std::thread>& allThreads,
     std::vector<std::unique_ptr<OpenrEventBase>>& orderedEvbs,
+    std::vector<std::unique_ptr<ModuleStartup>>& moduleStartups,
+    const Config& config,
     Watchdog* watchdog,
     const std::string& name,
-    std::unique_ptr<T> evbT) {
+    CreateFn&& createFn) {
+  const auto createStartTime = std::chrono::steady_clock::now();
+  auto evbT = createFn();
   CHECK(evbT);
   auto t = evbT.get();
   auto evb = std::unique_ptr<OpenrEventBase>(
       reinterpret_cast<OpenrEventBase*>(evbT.release()));
 
   // Start a thread
-  allThreads.emplace_back(std::thread([evb = evb.get(), name]() noexcept {
+  auto threadConfig = config.getModuleThreadConfig(name);
+  allThreads.emplace_back(std::thread([evb = evb.get(),
+                                       name,
+                                       threadConfig]() noexcept {
     LOG(INFO) << "Starting " << name << " thread ...";
     folly::setThreadName(folly::sformat("openr-{}", name));
+    if (threadConfig) {
+      applyThreadConfig(*threadConfig);
+    }
     evb->run();
     LOG(INFO) << name << " thread got stopped.";
   }));
-  evb->waitUntilRunning();
-
-  // Add to watchdog
-  if (watchdog) {
-    watchdog->addEvb(evb.get(), name);
-  }
+  auto startup = std::make_unique<ModuleStartup>();
+  startup->name = name;
+  startup->evb = evb.get();
+  startup->watchdog = watchdog;
+  startup->createStartTime = createStartTime;
+  startup->createEndTime = std::chrono::steady_clock::now();
+  evb->runInEventBaseThread([startup = startup.get()]() noexcept {
+    startup->runTime = std::chrono::steady_clock::now();
+    startup->runBaton.post();
+  });
+  moduleStartups.emplace_back(std::move(startup));
 
   // Emplace evb into ordered list of evbs. So that we can destroy
   // them in revserse order of their creation.
@@ -160,8 +215,51 @@ startEventBase(
   return t;
 }
 
+/**
+ * Wait for EventBases of modules started with startEventBase() to run, and
+ * add them to watchdog. Time it took to create module and from then until
+ * its EventBase ran are exported as `process.startup.<module>.create_ms` and
+ * `.run_ms`, time from process start until all of them ran as
+ * `process.startup.modules_ms`.
+ */
+void
+waitUntilModulesRunning(
+    std::vector<std::unique_ptr<ModuleStartup>>& moduleStartups,
+    std::chrono::steady_clock::time_point processStartTime) {
+  for (const auto& startup : moduleStartups) {
+    startup->runBaton.wait();
+    const auto createMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        startup->createEndTime - startup->createStartTime);
+    const auto runMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        startup->runTime - startup->createEndTime);
+    facebook::fb303::fbData->setCounter(
+        folly::sformat("process.startup.{}.create_ms", startup->name),
+        createMs.count());
+    facebook::fb303::fbData->setCounter(
+        folly::sformat("process.startup.{}.run_ms", startup->name),
+        runMs.count());
+    LOG(INFO) << startup->name << " is running. Created in "
+              << createMs.count() << "ms, running " << runMs.count()
+              << "ms after";
+
+    if (startup->watchdog) {
+      startup->watchdog->addEvb(startup->evb, startup->name);
+    }
+  }
+  moduleStartups.clear();
+
+  const auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - processStartTime);
+  facebook::fb303::fbData->setCounter(
+      "process.startup.modules_ms", totalMs.count());
+  LOG(INFO) << "All modules are running " << totalMs.count()
+            << "ms after process start";
+}
+
 int
 main(int argc, char** argv) {
+  const auto processStartTime = std::chrono::steady_clock::now();
+
   // Set version string to show when `openr --version` is invoked
   std::stringstream ss;
   BuildInfo::log(ss);
@@ -222,6 +320,11 @@ main(int argc, char** argv) {
 
   SYSLOG(INFO) << config->getRunningConfig();
 
+  // Tune memory allocator before modules start allocating
+  if (auto allocatorConf = config->getMemoryAllocatorConfig()) {
+    applyMemoryAllocatorConfig(*allocatorConf);
+  }
+
   // Sanity checks on Segment Routing labels
   const int32_t maxLabel = Constants::kMaxSrLabel;
   CHECK(Constants::kSrGlobalRange.first > 0);
@@ -271,22 +374,41 @@ main(int argc, char** argv) {
   // Set main thread name
   folly::setThreadName("openr");
 
-  // Queue for inter-module communication
-  ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  // Queue for inter-module communication. Highest rate ones are lock-free,
+  // every reader of them is drained by a single fiber. Queues on the path of
+  // route convergence are named for their counters
+  ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue{
+      getQueueOptions<DecisionRouteUpdatePtr>("route_updates_queue")};
   ReplicateQueue<KvStoreSyncEvent> kvStoreSyncEventsQueue;
   ReplicateQueue<openr::thrift::InterfaceDatabase> interfaceUpdatesQueue;
   ReplicateQueue<openr::thrift::SparkNeighborEvent> neighborUpdatesQueue;
   ReplicateQueue<openr::thrift::PrefixUpdateRequest> prefixUpdateRequestQueue;
-  ReplicateQueue<openr::thrift::Publication> kvStoreUpdatesQueue;
+  ReplicateQueue<KvStorePublicationPtr> kvStoreUpdatesQueue{
+      getQueueOptions<KvStorePublicationPtr>(
+          "kvstore_updates_queue", QueueMode::SINGLE_READER)};
   ReplicateQueue<openr::thrift::PeerUpdateRequest> peerUpdatesQueue;
   ReplicateQueue<openr::thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
-  ReplicateQueue<openr::thrift::RouteDatabaseDelta> fibUpdatesQueue;
+  ReplicateQueue<openr::thrift::RouteDatabaseDelta> fibUpdatesQueue{
+      getQueueOptions<openr::thrift::RouteDatabaseDelta>("fib_updates_queue")};
   ReplicateQueue<openr::fbnl::NetlinkEvent> netlinkEventsQueue;
-  ReplicateQueue<openr::LogSample> logSampleQueue;
+  ReplicateQueue<openr::fbnl::NetlinkEvents> netlinkEventBatchesQueue{
+      QueueMode::SINGLE_READER};
+  // configs reloaded through OpenrCtrl
+  ReplicateQueue<ConfigPtr> configUpdatesQueue;
+
+  // log samples are best effort, they must not hold back their producers
+  openr::messaging::QueueOptions<openr::LogSample> logSampleQueueOptions;
+  logSampleQueueOptions.capacity = Constants::kLogSampleQueueCapacity;
+  logSampleQueueOptions.overflowPolicy =
+      openr::messaging::OverflowPolicy::DROP_OLDEST;
+  logSampleQueueOptions.name = "log_sample_queue";
+  logSampleQueueOptions.measureDwellTime = FLAGS_enable_queue_dwell_time;
+  ReplicateQueue<openr::LogSample> logSampleQueue{logSampleQueueOptions};
 
   // structures to organize our modules
   std::vector<std::thread> allThreads;
   std::vector<std::unique_ptr<OpenrEventBase>> orderedEvbs;
+  std::vector<std::unique_ptr<ModuleStartup>> moduleStartups;
   Watchdog* watchdog{nullptr};
 
   // Watchdog thread to monitor thread aliveness
@@ -294,9 +416,11 @@ main(int argc, char** argv) {
     watchdog = startEventBase(
         allThreads,
         orderedEvbs,
+        moduleStartups,
+        *config,
         nullptr /* watchdog won't monitor itself */,
         "Watchdog",
-        std::make_unique<Watchdog>(config));
+        [&]() { return std::make_unique<Watchdog>(config); });
   }
 
   // Starting main event-loop
@@ -329,8 +453,12 @@ main(int argc, char** argv) {
 
   // Create Netlink Protocol object in a new thread
   nlEvb = std::make_unique<OpenrEventBase>();
+  // NOTE: Events are published in batches per poll cycle of netlink socket
   nlSock = std::make_unique<openr::fbnl::NetlinkProtocolSocket>(
-      nlEvb->getEvb(), netlinkEventsQueue);
+      nlEvb->getEvb(),
+      netlinkEventsQueue,
+      false /* enableIPv6RouteReplaceSemantics */,
+      &netlinkEventBatchesQueue);
   allThreads.emplace_back([&]() {
     LOG(INFO) << "Starting NetlinkEvb thread ...";
     folly::setThreadName("openr-netlinkEvb");
@@ -353,10 +481,11 @@ main(int argc, char** argv) {
     netlinkFibServer->setCpp2WorkerThreadName("FibTWorker");
     netlinkFibServer->setPort(*config->getConfig().fib_port_ref());
 
-    netlinkFibServerThread =
-        std::make_unique<std::thread>([&netlinkFibServer, &nlSock]() {
+    netlinkFibServerThread = std::make_unique<std::thread>(
+        [&netlinkFibServer, &nlSock, &config]() {
           folly::setThreadName("openr-fibService");
-          auto fibHandler = std::make_shared<NetlinkFibHandler>(nlSock.get());
+          auto fibHandler = std::make_shared<NetlinkFibHandler>(
+              nlSock.get(), config->isNetlinkNexthopObjectsEnabled());
           netlinkFibServer->setInterface(std::move(fibHandler));
 
           LOG(INFO) << "Starting NetlinkFib server...";
@@ -369,111 +498,141 @@ main(int argc, char** argv) {
   auto configStore = startEventBase(
       allThreads,
       orderedEvbs,
+      moduleStartups,
+      *config,
       watchdog,
       "ConfigStore",
-      std::make_unique<PersistentStore>(FLAGS_config_store_filepath));
+      [&]() {
+        return std::make_unique<PersistentStore>(FLAGS_config_store_filepath);
+      });
 
   // Start monitor Module
   auto monitor = startEventBase(
       allThreads,
       orderedEvbs,
+      moduleStartups,
+      *config,
       watchdog,
       "Monitor",
-      std::make_unique<openr::Monitor>(
-          config,
-          Constants::kEventLogCategory.toString(),
-          logSampleQueue.getReader()));
+      [&]() {
+        return std::make_unique<openr::Monitor>(
+            config,
+            Constants::kEventLogCategory.toString(),
+            logSampleQueue.getReader());
+      });
 
   // Start KVStore
   auto kvStore = startEventBase(
       allThreads,
       orderedEvbs,
+      moduleStartups,
+      *config,
       watchdog,
       "KvStore",
-      std::make_unique<KvStore>(
-          context,
-          kvStoreUpdatesQueue,
-          kvStoreSyncEventsQueue,
-          peerUpdatesQueue.getReader(),
-          logSampleQueue,
-          KvStoreGlobalCmdUrl{folly::sformat(
-              "tcp://{}:{}",
-              *config->getConfig().listen_addr_ref(),
-              FLAGS_kvstore_rep_port)},
-          config,
-          maybeIpTos,
-          FLAGS_kvstore_zmq_hwm,
-          config->isKvStoreThriftEnabled(),
-          config->isPeriodicSyncEnabled()));
+      [&]() {
+        return std::make_unique<KvStore>(
+            context,
+            kvStoreUpdatesQueue,
+            kvStoreSyncEventsQueue,
+            peerUpdatesQueue.getReader(),
+            logSampleQueue,
+            KvStoreGlobalCmdUrl{folly::sformat(
+                "tcp://{}:{}",
+                *config->getConfig().listen_addr_ref(),
+                FLAGS_kvstore_rep_port)},
+            config,
+            maybeIpTos,
+            FLAGS_kvstore_zmq_hwm,
+            config->isKvStoreThriftEnabled(),
+            config->isPeriodicSyncEnabled(),
+            configUpdatesQueue.getReader());
+      });
 
   auto prefixManager = startEventBase(
       allThreads,
       orderedEvbs,
+      moduleStartups,
+      *config,
       watchdog,
       "PrefixManager",
-      std::make_unique<PrefixManager>(
-          staticRoutesUpdateQueue,
-          prefixUpdateRequestQueue.getReader(),
-          routeUpdatesQueue.getReader(),
-          config,
-          kvStore,
-          FLAGS_enable_perf_measurement,
-          initialPrefixHoldTime));
+      [&]() {
+        return std::make_unique<PrefixManager>(
+            staticRoutesUpdateQueue,
+            prefixUpdateRequestQueue.getReader(),
+            routeUpdatesQueue.getReader(),
+            config,
+            kvStore,
+            FLAGS_enable_perf_measurement,
+            initialPrefixHoldTime);
+      });
 
   // Prefix Allocator to automatically allocate prefixes for nodes
   if (config->isPrefixAllocationEnabled()) {
     startEventBase(
         allThreads,
         orderedEvbs,
+        moduleStartups,
+        *config,
         watchdog,
         "PrefixAllocator",
-        std::make_unique<PrefixAllocator>(
-            AreaId{*config->getAreaIds().begin()},
-            config,
-            nlSock.get(),
-            kvStore,
-            configStore,
-            prefixUpdateRequestQueue,
-            logSampleQueue,
-            Constants::kPrefixAllocatorSyncInterval));
+        [&]() {
+          return std::make_unique<PrefixAllocator>(
+              AreaId{*config->getAreaIds().begin()},
+              config,
+              nlSock.get(),
+              kvStore,
+              configStore,
+              prefixUpdateRequestQueue,
+              logSampleQueue,
+              Constants::kPrefixAllocatorSyncInterval);
+        });
   }
 
   // Create Spark instance for neighbor discovery
   auto spark = startEventBase(
       allThreads,
       orderedEvbs,
+      moduleStartups,
+      *config,
       watchdog,
       "Spark",
-      std::make_unique<Spark>(
-          maybeIpTos,
-          interfaceUpdatesQueue.getReader(),
-          neighborUpdatesQueue,
-          KvStoreCmdPort{static_cast<uint16_t>(FLAGS_kvstore_rep_port)},
-          OpenrCtrlThriftPort{static_cast<uint16_t>(FLAGS_openr_ctrl_port)},
-          std::make_shared<IoProvider>(),
-          config));
+      [&]() {
+        return std::make_unique<Spark>(
+            maybeIpTos,
+            interfaceUpdatesQueue.getReader(),
+            neighborUpdatesQueue,
+            KvStoreCmdPort{static_cast<uint16_t>(FLAGS_kvstore_rep_port)},
+            OpenrCtrlThriftPort{static_cast<uint16_t>(FLAGS_openr_ctrl_port)},
+            std::make_shared<IoProvider>(),
+            config);
+      });
 
   // Create link monitor instance.
   auto linkMonitor = startEventBase(
       allThreads,
       orderedEvbs,
+      moduleStartups,
+      *config,
       watchdog,
       "LinkMonitor",
-      std::make_unique<LinkMonitor>(
-          config,
-          nlSock.get(),
-          kvStore,
-          configStore,
-          FLAGS_enable_perf_measurement,
-          interfaceUpdatesQueue,
-          prefixUpdateRequestQueue,
-          peerUpdatesQueue,
-          logSampleQueue,
-          neighborUpdatesQueue.getReader(),
-          netlinkEventsQueue.getReader(),
-          FLAGS_assume_drained,
-          FLAGS_override_drain_state,
-          initialAdjHoldTime));
+      [&]() {
+        return std::make_unique<LinkMonitor>(
+            config,
+            nlSock.get(),
+            kvStore,
+            configStore,
+            FLAGS_enable_perf_measurement,
+            interfaceUpdatesQueue,
+            prefixUpdateRequestQueue,
+            peerUpdatesQueue,
+            logSampleQueue,
+            neighborUpdatesQueue.getReader(),
+            netlinkEventBatchesQueue.getReader(),
+            FLAGS_assume_drained,
+            FLAGS_override_drain_state,
+            initialAdjHoldTime,
+            configUpdatesQueue.getReader());
+      });
 
   // setup the SSL policy
   std::shared_ptr<wangle::SSLContextConfig> sslContext;
@@ -515,33 +674,45 @@ main(int argc, char** argv) {
   auto decision = startEventBase(
       allThreads,
       orderedEvbs,
+      moduleStartups,
+      *config,
       watchdog,
       "Decision",
-      std::make_unique<Decision>(
-          config,
-          FLAGS_enable_lfa,
-          not FLAGS_enable_bgp_route_programming,
-          std::chrono::milliseconds(FLAGS_decision_debounce_min_ms),
-          std::chrono::milliseconds(FLAGS_decision_debounce_max_ms),
-          kvStoreUpdatesQueue.getReader(),
-          staticRoutesUpdateQueue.getReader(),
-          routeUpdatesQueue));
+      [&]() {
+        return std::make_unique<Decision>(
+            config,
+            FLAGS_enable_lfa,
+            not FLAGS_enable_bgp_route_programming,
+            std::chrono::milliseconds(FLAGS_decision_debounce_min_ms),
+            std::chrono::milliseconds(FLAGS_decision_debounce_max_ms),
+            kvStoreUpdatesQueue.getReader(),
+            staticRoutesUpdateQueue.getReader(),
+            routeUpdatesQueue,
+            kvStoreSyncEventsQueue.getReader());
+      });
 
   // Define and start Fib Module
   auto fib = startEventBase(
       allThreads,
       orderedEvbs,
+      moduleStartups,
+      *config,
       watchdog,
       "Fib",
-      std::make_unique<Fib>(
-          config,
-          *config->getConfig().fib_port_ref(),
-          std::chrono::seconds(3 * *sparkConf.keepalive_time_s_ref()),
-          routeUpdatesQueue.getReader(),
-          staticRoutesUpdateQueue.getReader(),
-          fibUpdatesQueue,
-          logSampleQueue,
-          kvStore));
+      [&]() {
+        return std::make_unique<Fib>(
+            config,
+            *config->getConfig().fib_port_ref(),
+            std::chrono::seconds(3 * *sparkConf.keepalive_time_s_ref()),
+            routeUpdatesQueue.getReader(),
+            staticRoutesUpdateQueue.getReader(),
+            fibUpdatesQueue,
+            logSampleQueue,
+            kvStore);
+      });
+
+  // Modules initialized concurrently since their creation
+  waitUntilModulesRunning(moduleStartups, processStartTime);
 
   // Start OpenrCtrl thrift server
   auto thriftCtrlServer = std::make_unique<apache::thrift::ThriftServer>();
@@ -577,7 +748,8 @@ main(int argc, char** argv) {
       configStore,
       prefixManager,
       spark,
-      config);
+      config,
+      &configUpdatesQueue);
   // Starting openrCtrlEvb for thrift handler
   std::thread ctrlEvbThread([&]() noexcept {
     LOG(INFO) << "Starting openrCtrl eventbase...";
@@ -587,12 +759,28 @@ main(int argc, char** argv) {
   });
   ctrlEvb.waitUntilRunning();
 
+  // Responses to memory pressure ahead of crash, in order of escalation
+  if (watchdog) {
+    watchdog->addMemoryPressureHandler(
+        "trim_event_logs", [monitor]() { monitor->clearRecentEventLogs(); });
+    watchdog->addMemoryPressureHandler(
+        "drop_decision_caches", [decision]() { decision->dropCaches(); });
+    watchdog->addMemoryPressureHandler(
+        "shed_stream_subscribers",
+        [handler = std::weak_ptr<OpenrCtrlHandler>(ctrlHandler)]() {
+          if (auto ctrlHandler = handler.lock()) {
+            ctrlHandler->shedStreamSubscribers();
+          }
+        });
+  }
+
   CHECK(ctrlHandler);
   thriftCtrlServer->setInterface(ctrlHandler);
   thriftCtrlServer->setNumIOWorkerThreads(1);
-  // Intentionally kept this as (1). If you're changing to higher number please
-  // address thread safety for private member variables in OpenrCtrlHandler
-  thriftCtrlServer->setNumCPUWorkerThreads(1);
+  // Requests are served by worker pool of their priority, i.e. by multiple
+  // threads. State of OpenrCtrlHandler is synchronized accordingly
+  thriftCtrlServer->setThreadManager(
+      OpenrCtrlThreadManager::create(config->getCtrlServerConfig()));
   // Enable TOS reflection on the server socket
   thriftCtrlServer->setTosReflect(true);
 
@@ -626,7 +814,9 @@ main(int argc, char** argv) {
   staticRoutesUpdateQueue.close();
   fibUpdatesQueue.close();
   netlinkEventsQueue.close();
+  netlinkEventBatchesQueue.close();
   logSampleQueue.close();
+  configUpdatesQueue.close();
 
   // Stop & destroy thrift server. Will reduce ref-count on ctrlHandler
   thriftCtrlServer->stop();
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <set>
+
 #include <folly/Format.h>
 #include <folly/futures/Promise.h>
 
@@ -438,7 +440,7 @@ PrefixAllocator::savePrefixIndexToDisk(std::optional<uint32_t> prefixIndex) {
   configStore_->storeThriftObj(kConfigKey, thriftAllocPrefix).get();
 }
 
-uint32_t
+std::optional<uint32_t>
 PrefixAllocator::getInitPrefixIndex() {
   // initialize my prefix per the following preferrence:
   // from file > from kvstore > generate new
@@ -458,16 +460,10 @@ PrefixAllocator::getInitPrefixIndex() {
     return kvstorePrefixIndex.value();
   }
 
-  // Generate a new random prefix index
-  if (allocParams_.has_value()) {
-    uint32_t hashPrefixIndex =
-        hasher(myNodeName_) % getPrefixCount(*allocParams_);
-    LOG(INFO) << "Generate new initial prefix index: " << hashPrefixIndex;
-    return hashPrefixIndex;
-  }
-
-  // `0` is always a valid index in valid range
-  return 0;
+  // Let range allocator hash node name into range, avoiding indices known to
+  // be taken
+  LOG(INFO) << "Generate new initial prefix index";
+  return std::nullopt;
 }
 
 void
@@ -775,10 +771,6 @@ PrefixAllocator::semifuture_syncIfAddrs(
     int16_t family,
     int16_t scope,
     std::vector<folly::CIDRNetwork> newAddrs) {
-  std::vector<folly::SemiFuture<int>> futures;
-  const auto ifName = iface; // Copy intended
-  const auto ifIndex = getIfIndex(ifName).value();
-
   auto networks = folly::gen::from(newAddrs) |
       folly::gen::mapped([](const folly::CIDRNetwork& network) {
                     return folly::IPAddress::networkToString(network);
@@ -789,46 +781,58 @@ PrefixAllocator::semifuture_syncIfAddrs(
             << ", family=" << family << ", scope=" << scope
             << ", addresses=" << folly::join(",", networks);
 
-  // fetch existing iface address as std::vector<folly::CIDRNetwork>
-  auto oldAddrs = semifuture_getIfAddrs(iface, family, scope).get();
-
-  // Add new addresses
-  for (auto& newAddr : newAddrs) {
-    // Skip adding existing addresse
-    if (std::find(oldAddrs.begin(), oldAddrs.end(), newAddr) !=
-        oldAddrs.end()) {
-      continue;
-    }
-    // Add non-existing new address
-    fbnl::IfAddressBuilder builder;
-    builder.setPrefix(newAddr);
-    builder.setIfIndex(ifIndex);
-    builder.setScope(scope);
-    futures.emplace_back(nlSock_->addIfAddress(builder.build()));
-  }
-
-  // Delete old addresses
-  for (auto& oldAddr : oldAddrs) {
-    // Skip removing new addresse
-    if (std::find(newAddrs.begin(), newAddrs.end(), oldAddr) !=
-        newAddrs.end()) {
-      continue;
-    }
-    // Remove non-existing old address
-    fbnl::IfAddressBuilder builder;
-    builder.setPrefix(oldAddr);
-    builder.setIfIndex(ifIndex);
-    builder.setScope(scope);
-    futures.emplace_back(nlSock_->deleteIfAddress(builder.build()));
-  }
-
-  // Collect all futures
-  return collectAll(std::move(futures))
-      .deferValue([](std::vector<folly::Try<int>>&& retvals) {
-        for (auto& retval : retvals) {
-          const int ret = std::abs(retval.value());
-          if (ret != 0 && ret != EEXIST && ret != EADDRNOTAVAIL) {
-            throw fbnl::NlException("Address add/remove failed.", ret);
+  // Fetch interface index and existing addresses, then add missing and
+  // delete stale addresses in bulk. Nothing is waited for in between
+  auto* nlSock = nlSock_;
+  return semifuture_getIfIndex(iface)
+      .deferValue([this, iface, family, scope](std::optional<int> ifIndex) {
+        return semifuture_getIfAddrs(iface, family, scope)
+            .deferValue([ifIndex = ifIndex.value()](
+                            std::vector<folly::CIDRNetwork>&& oldAddrs) {
+              return std::make_pair(ifIndex, std::move(oldAddrs));
+            });
+      })
+      .deferValue([nlSock, scope, newAddrs = std::move(newAddrs)](
+                      std::pair<int, std::vector<folly::CIDRNetwork>>&&
+                          ifIndexAndOldAddrs) {
+        auto& [ifIndex, oldAddrs] = ifIndexAndOldAddrs;
+        const std::set<folly::CIDRNetwork> newSet(
+            newAddrs.begin(), newAddrs.end());
+        const std::set<folly::CIDRNetwork> oldSet(
+            oldAddrs.begin(), oldAddrs.end());
+
+        // addresses of `from` not in `other`
+        auto getDifference = [ifIndex = ifIndex, scope](
+                                 std::set<folly::CIDRNetwork> const& from,
+                                 std::set<folly::CIDRNetwork> const& other) {
+          std::vector<fbnl::IfAddress> addrs;
+          for (auto const& network : from) {
+            if (other.count(network)) {
+              continue;
+            }
+            fbnl::IfAddressBuilder builder;
+            builder.setPrefix(network);
+            builder.setIfIndex(ifIndex);
+            builder.setScope(scope);
+            addrs.emplace_back(builder.build());
+          }
+          return addrs;
+        };
+
+        std::vector<folly::SemiFuture<std::vector<int>>> futures;
+        futures.emplace_back(
+            nlSock->addIfAddresses(getDifference(newSet, oldSet)));
+        futures.emplace_back(
+            nlSock->deleteIfAddresses(getDifference(oldSet, newSet)));
+        return folly::collectAll(std::move(futures));
+      })
+      .deferValue([](std::vector<folly::Try<std::vector<int>>>&& results) {
+        for (auto& result : results) {
+          for (const auto retval : result.value()) {
+            const int ret = std::abs(retval);
+            if (ret != 0 && ret != EEXIST && ret != EADDRNOTAVAIL) {
+              throw fbnl::NlException("Address add/remove failed.", ret);
+            }
           }
         }
         return folly::Unit();
@@ -841,34 +845,39 @@ PrefixAllocator::semifuture_getIfAddrs(
   LOG(INFO) << "Querying addresses for interface " << ifName
             << ", family=" << family << ", scope=" << scope;
 
-  // Get iface index
-  const int ifIndex = getIfIndex(ifName).value();
-
-  return nlSock_->getAllIfAddresses().deferValue(
-      [ifIndex, family, scope](
-          folly::Expected<std::vector<fbnl::IfAddress>, int>&& nlAddrs) {
-        if (nlAddrs.hasError()) {
-          throw fbnl::NlException("Failed fetching addrs", nlAddrs.error());
-        }
-
-        std::vector<folly::CIDRNetwork> addrs{};
-        for (auto& nlAddr : nlAddrs.value()) {
-          if (nlAddr.getIfIndex() != ifIndex) {
-            continue;
-          }
-          // Apply filter on family if specified
-          if (family && nlAddr.getFamily() != family) {
-            continue;
-          }
-          // Apply filter on scope. Must always be specified
-          if (nlAddr.getScope() != scope) {
-            continue;
-          }
-          addrs.emplace_back(nlAddr.getPrefix().value());
-        }
-        return addrs;
+  // Get iface index, then addresses
+  return semifuture_getIfIndex(ifName).deferValue(
+      [nlSock = nlSock_, family, scope](std::optional<int> maybeIfIndex) {
+        const int ifIndex = maybeIfIndex.value();
+        return nlSock->getAllIfAddresses().deferValue(
+            [ifIndex, family, scope](
+                folly::Expected<std::vector<fbnl::IfAddress>, int>&&
+                    nlAddrs) {
+              if (nlAddrs.hasError()) {
+                throw fbnl::NlException(
+                    "Failed fetching addrs", nlAddrs.error());
+              }
+
+              std::vector<folly::CIDRNetwork> addrs{};
+              for (auto& nlAddr : nlAddrs.value()) {
+                if (nlAddr.getIfIndex() != ifIndex) {
+                  continue;
+                }
+                // Apply filter on family if specified
+                if (family && nlAddr.getFamily() != family) {
+                  continue;
+                }
+                // Apply filter on scope. Must always be specified
+                if (nlAddr.getScope() != scope) {
+                  continue;
+                }
+                addrs.emplace_back(nlAddr.getPrefix().value());
+              }
+              return addrs;
+            });
       });
 }
+
 folly::SemiFuture<folly::Unit>
 PrefixAllocator::semifuture_addRemoveIfAddr(
     const bool isAdd,
@@ -921,13 +930,21 @@ PrefixAllocator::semifuture_addRemoveIfAddr(
 
 std::optional<int>
 PrefixAllocator::getIfIndex(const std::string& ifName) {
-  auto links = nlSock_->getAllLinks().get().value();
-  for (auto& link : links) {
-    if (link.getLinkName() == ifName) {
-      return link.getIfIndex();
-    }
-  }
-  return std::nullopt;
+  return semifuture_getIfIndex(ifName).get();
+}
+
+folly::SemiFuture<std::optional<int>>
+PrefixAllocator::semifuture_getIfIndex(const std::string& ifName) {
+  return nlSock_->getAllLinks().deferValue(
+      [ifName](folly::Expected<std::vector<fbnl::Link>, int>&& links)
+          -> std::optional<int> {
+        for (auto& link : links.value()) {
+          if (link.getLinkName() == ifName) {
+            return link.getIfIndex();
+          }
+        }
+        return std::nullopt;
+      });
 }
 
 void
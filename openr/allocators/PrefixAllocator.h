@@ -109,8 +109,8 @@ class PrefixAllocator : public OpenrEventBase {
   // save newly elected prefix index to disk
   void savePrefixIndexToDisk(std::optional<uint32_t> prefixIndex);
 
-  // initialize my prefix
-  uint32_t getInitPrefixIndex();
+  // initialize my prefix, none to generate a new one
+  std::optional<uint32_t> getInitPrefixIndex();
 
   // start allocating prefixes, can be called again with new prefix
   // or `std::nullopt` if seed prefix is no longer valid to withdraw
@@ -143,6 +143,10 @@ class PrefixAllocator : public OpenrEventBase {
    */
   std::optional<int> getIfIndex(const std::string& ifName);
 
+  // Asynchronous version of getIfIndex
+  folly::SemiFuture<std::optional<int>> semifuture_getIfIndex(
+      const std::string& ifName);
+
   //
   // Const private variables
   //
@@ -153,9 +157,6 @@ class PrefixAllocator : public OpenrEventBase {
   // Sync interval for range allocator
   const std::chrono::milliseconds syncInterval_;
 
-  // hash node ID into prefix space
-  const std::hash<std::string> hasher{};
-
   //
   // Non-const private variables
   //
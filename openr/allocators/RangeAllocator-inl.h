@@ -49,6 +49,7 @@ RangeAllocator<T>::RangeAllocator(
     const std::chrono::milliseconds rangeAllocTtl)
     : nodeName_(nodeName),
       keyPrefix_(keyPrefix),
+      nodeHash_(std::hash<std::string>{}(nodeName)),
       kvStoreClient_(kvStoreClient),
       eventBase_(kvStoreClient->getOpenrEventBase()),
       callback_(std::move(callback)),
@@ -64,6 +65,13 @@ RangeAllocator<T>::RangeAllocator(
         allocateValue_.reset();
         tryAllocate(allocateValue);
       });
+
+  facebook::fb303::fbData->addStatExportType(
+      "range_allocator.allocation_attempts", facebook::fb303::SUM);
+  facebook::fb303::fbData->addStatExportType(
+      "range_allocator.collisions", facebook::fb303::SUM);
+  facebook::fb303::fbData->addStatExportType(
+      "range_allocator.attempts_to_allocate", facebook::fb303::AVG);
 }
 
 template <typename T>
@@ -78,6 +86,9 @@ RangeAllocator<T>::~RangeAllocator() {
     }
 
     // Unsubscribe from KvStoreClientInternal if we have been to
+    if (keyPrefixSubscriptionId_) {
+      kvStoreClient_->unsubscribeKeyPrefix(*keyPrefixSubscriptionId_);
+    }
     if (myValue_) {
       const auto myKey = createKey(*myValue_);
       kvStoreClient_->unsubscribeKey(area_, myKey);
@@ -101,7 +112,7 @@ RangeAllocator<T>::startAllocator(
 
   allocRange_ = allocRange;
   CHECK_LE(allocRange_.first, allocRange_.second) << "Invalid range.";
-  T initValue;
+  T initValue{allocRange_.first};
   if (maybeInitValue.has_value()) {
     initValue = maybeInitValue.value();
     // maybeInitValue may be outside of allocation range, e.g., initial dump
@@ -117,11 +128,41 @@ RangeAllocator<T>::startAllocator(
                  << ", ussing upper bound instead";
       initValue = allocRange_.second;
     }
-  } else {
-    initValue = allocRange_.first;
   }
   allocRangeSize_ = allocRange_.second - allocRange_.first + 1;
 
+  // Track owners of values from initial dump and subscription to changes
+  const uint64_t rangeSize = allocRangeSize_;
+  if (rangeSize <= Constants::kRangeAllocMaxBitmapSize) {
+    occupied_.assign((rangeSize + 63) / 64, 0);
+    if (rangeSize % 64) {
+      occupied_.back() = ~((uint64_t{1} << (rangeSize % 64)) - 1);
+    }
+  }
+  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(area_, keyPrefix_);
+  CHECK(maybeKeyMap.has_value())
+      << "Failed to dump keys with prefix: " << keyPrefix_
+      << " from kvstore in area: " << area_.t;
+  for (const auto& [key, thriftVal] : *maybeKeyMap) {
+    valueOwnerUpdated(key, thriftVal);
+  }
+  keyPrefixSubscriptionId_ = kvStoreClient_->subscribeKeyPrefix(
+      area_,
+      keyPrefix_,
+      [this](
+          const std::string& key,
+          std::optional<thrift::Value> thriftVal) noexcept {
+        valueOwnerUpdated(key, thriftVal);
+      });
+
+  if (not maybeInitValue.has_value()) {
+    // hash node name into range, or probe further if it's known to be taken
+    initValue = allocRange_.first + nodeHash_ % uint64_t(allocRangeSize_);
+    if (not isClaimable(initValue)) {
+      initValue = pickValue(initValue);
+    }
+  }
+
   // Subscribe to changes in KvStore
   VLOG(2) << "RangeAllocator: Created. Scheduling first tryAllocate. "
           << "Node: " << nodeName_ << ", Prefix: " << keyPrefix_;
@@ -132,25 +173,24 @@ RangeAllocator<T>::startAllocator(
 template <typename T>
 bool
 RangeAllocator<T>::isRangeConsumed() const {
-  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(area_, keyPrefix_);
-  CHECK(maybeKeyMap.has_value())
-      << "Failed to dump keys with prefix: " << keyPrefix_
-      << " from kvstore in area: " << area_.t;
-  T count = 0;
-  for (const auto& kv : *maybeKeyMap) {
-    const auto val =
-        details::binaryToPrimitive<T>(kv.second.value_ref().value());
-    if (val >= allocRange_.first && val <= allocRange_.second) {
-      ++count;
-    }
-  }
-  CHECK(count <= allocRangeSize_);
-  return (count == allocRangeSize_);
+  CHECK(hasStarted_) << "Not started";
+  CHECK(numValuesInRange_ <= allocRangeSize_);
+  return (numValuesInRange_ == allocRangeSize_);
 }
 
 template <typename T>
 std::optional<T>
 RangeAllocator<T>::getValueFromKvStore() const {
+  if (hasStarted_) {
+    for (const auto& [val, owner] : valueOwners_) {
+      if (owner == nodeName_) {
+        return val;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // values are not tracked before start, look up in KvStore
   const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(area_, keyPrefix_);
   CHECK(maybeKeyMap.has_value())
       << "Failed to dump keys with prefix: " << keyPrefix_
@@ -175,6 +215,9 @@ RangeAllocator<T>::tryAllocate(const T newVal) noexcept {
 
   VLOG(1) << "RangeAllocator " << nodeName_ << ": trying to allocate "
           << newVal;
+  ++numAttempts_;
+  facebook::fb303::fbData->addStatValue(
+      "range_allocator.allocation_attempts", 1, facebook::fb303::SUM);
 
   // Check for any existing value in KvStore
   const auto newKey = createKey(newVal);
@@ -240,6 +283,7 @@ RangeAllocator<T>::tryAllocate(const T newVal) noexcept {
     *newValue.ttl_ref() = rangeAllocTtl_.count(); // reset ttl
     kvStoreClient_->setKey(area_, newKey, newValue);
     myValue_ = newVal;
+    reportAllocated();
     callback_(myValue_);
   }
 
@@ -262,47 +306,160 @@ void
 RangeAllocator<T>::scheduleAllocate(const T seedVal) noexcept {
   // Apply exponential backoff
   backoff_.reportError();
+  facebook::fb303::fbData->addStatValue(
+      "range_allocator.collisions", 1, facebook::fb303::SUM);
 
-  // Use random value selection logic based on seedVal
-  std::mt19937_64 gen(seedVal + folly::Random::rand64());
+  // Schedule timeout to allocate new value
+  allocateValue_ = pickValue(seedVal);
+  timeout_->scheduleTimeout(backoff_.getTimeRemainingUntilRetry());
+}
+
+template <typename T>
+T
+RangeAllocator<T>::pickValue(const T seedVal) {
+  // Sequence of nodes colliding on a value diverges, while the same node
+  // doesn't retry values of its previous attempts
+  std::mt19937_64 gen(nodeHash_ ^ (seedVal + numAttempts_));
   std::uniform_int_distribution<T> dist(allocRange_.first, allocRange_.second);
-  auto newVal = dist(gen);
 
-  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(area_, keyPrefix_);
-  CHECK(maybeKeyMap.has_value())
-      << "Failed to dump keys with prefix: " << keyPrefix_
-      << " from kvstore in area: " << area_.t;
-  const auto valOwners =
-      folly::gen::from(*maybeKeyMap) |
-      folly::gen::map([](std::pair<std::string, thrift::Value> const& kv) {
-        return std::make_pair(
-            details::binaryToPrimitive<T>(kv.second.value_ref().value()),
-            *kv.second.originatorId_ref());
-      }) |
-      folly::gen::as<
-          std::unordered_map<T /* value */, std::string /* owner */>>();
-
-  // look for a value I can own
-  T i;
-  for (i = 0; i < allocRangeSize_; ++i) {
-    const auto it = valOwners.find(newVal);
-    // not owned yet or owned by higher originator if override is allowed
-    if (it == valOwners.end() or (overrideOwner_ and nodeName_ >= it->second)) {
-      if (!checkValueInUseCb_ or !checkValueInUseCb_(newVal)) {
-        // found
-        break;
-      }
+  // look for a value I can own. Random values succeed in few probes unless
+  // range is nearly consumed, then scan from a random one
+  std::optional<T> newVal;
+  for (size_t i = 0; i < Constants::kRangeAllocNumRandomProbes; ++i) {
+    const auto val = dist(gen);
+    if (isClaimable(val)) {
+      newVal = val;
+      break;
     }
-    // try next
-    newVal = (newVal < allocRange_.second) ? (newVal + 1) : allocRange_.first;
   }
-  if (i == allocRangeSize_) {
+  if (not newVal.has_value()) {
+    newVal = findClaimableValue(dist(gen));
+  }
+  if (not newVal.has_value()) {
     LOG(ERROR) << "All values are owned by higher originatorIds";
+    newVal = dist(gen);
   }
+  return *newVal;
+}
 
-  // Schedule timeout to allocate new value
-  allocateValue_ = newVal;
-  timeout_->scheduleTimeout(backoff_.getTimeRemainingUntilRetry());
+template <typename T>
+void
+RangeAllocator<T>::reportAllocated() {
+  if (numAttempts_ == 0) {
+    // echo of value I own already
+    return;
+  }
+  facebook::fb303::fbData->addStatValue(
+      "range_allocator.attempts_to_allocate",
+      numAttempts_,
+      facebook::fb303::AVG);
+  numAttempts_ = 0;
+}
+
+template <typename T>
+void
+RangeAllocator<T>::valueOwnerUpdated(
+    const std::string& key, const std::optional<thrift::Value>& thriftVal) {
+  std::optional<T> val;
+  if (thriftVal.has_value()) {
+    val = details::binaryToPrimitive<T>(thriftVal->value_ref().value());
+  } else {
+    // expired key has no value, it's encoded in key as well
+    const auto maybeVal =
+        folly::tryTo<T>(folly::StringPiece(key).subpiece(keyPrefix_.size()));
+    if (maybeVal.hasValue()) {
+      val = maybeVal.value();
+    }
+  }
+  if (not val.has_value()) {
+    return;
+  }
+
+  const bool inRange = *val >= allocRange_.first and *val <= allocRange_.second;
+  auto it = valueOwners_.find(*val);
+  if (not thriftVal.has_value()) {
+    if (it == valueOwners_.end()) {
+      return;
+    }
+    valueOwners_.erase(it);
+    if (inRange) {
+      --numValuesInRange_;
+      setOccupied(*val, false);
+    }
+    return;
+  }
+
+  const auto& owner = *thriftVal->originatorId_ref();
+  if (it == valueOwners_.end()) {
+    it = valueOwners_.emplace(*val, owner).first;
+    if (inRange) {
+      ++numValuesInRange_;
+    }
+  } else {
+    it->second = owner;
+  }
+  if (inRange) {
+    // owned by higher originator unless override is allowed
+    setOccupied(*val, not(overrideOwner_ and nodeName_ >= owner));
+  }
+}
+
+template <typename T>
+void
+RangeAllocator<T>::setOccupied(const T val, bool occupied) {
+  if (occupied_.empty()) {
+    return;
+  }
+  const uint64_t offset = val - allocRange_.first;
+  const uint64_t mask = uint64_t{1} << (offset % 64);
+  if (occupied) {
+    occupied_[offset / 64] |= mask;
+  } else {
+    occupied_[offset / 64] &= ~mask;
+  }
+}
+
+template <typename T>
+bool
+RangeAllocator<T>::isOccupied(const T val) const {
+  if (not occupied_.empty()) {
+    const uint64_t offset = val - allocRange_.first;
+    return occupied_[offset / 64] & (uint64_t{1} << (offset % 64));
+  }
+  const auto it = valueOwners_.find(val);
+  return it != valueOwners_.end() and
+      not(overrideOwner_ and nodeName_ >= it->second);
+}
+
+template <typename T>
+bool
+RangeAllocator<T>::isClaimable(const T val) const {
+  return not isOccupied(val) and
+      (not checkValueInUseCb_ or not checkValueInUseCb_(val));
+}
+
+template <typename T>
+std::optional<T>
+RangeAllocator<T>::findClaimableValue(const T startVal) const {
+  const uint64_t rangeSize = allocRangeSize_;
+  uint64_t offset = startVal - allocRange_.first;
+  for (uint64_t n = 0; n < rangeSize;) {
+    if (not occupied_.empty() and offset % 64 == 0 and
+        occupied_[offset / 64] == std::numeric_limits<uint64_t>::max()) {
+      // skip a word of occupied values at once
+      const auto step = std::min<uint64_t>(64, rangeSize - offset);
+      n += step;
+      offset = (offset + step) % rangeSize;
+      continue;
+    }
+    const T val = allocRange_.first + offset;
+    if (isClaimable(val)) {
+      return val;
+    }
+    ++n;
+    offset = (offset + 1) % rangeSize;
+  }
+  return std::nullopt;
 }
 
 template <typename T>
@@ -332,6 +489,7 @@ RangeAllocator<T>::keyValUpdated(
     // Our own advertisement got echoed back
     // Let the application know of newly allocated value
     myValue_ = val;
+    reportAllocated();
     callback_(myValue_);
 
     // Clear backoff
@@ -10,7 +10,11 @@
 #include <chrono>
 #include <random>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include <fb303/ServiceData.h>
+#include <folly/Conv.h>
 #include <folly/Format.h>
 #include <folly/Optional.h>
 #include <folly/Random.h>
@@ -40,6 +44,14 @@ class RangeAllocator {
    * - If we fail we should try again with another random number
    * - To ease up re-tries we use ExponentialBackoff
    *
+   * Once started, owners of values are tracked from KvStore key prefix
+   * subscription along with an occupancy bitmap of the range. Hence retries
+   * pick a value known to be free without dumping KvStore.
+   *
+   * Without initial value, the first choice is hashed from node name and
+   * probing continues in a sequence seeded by node name, which spreads nodes
+   * booting at once across the range instead of racing for same values.
+   *
    * callback: tells you of new allocated value.
    * overrideOwner:  allow a higher originator ID to grab a key from an existing
    * owner with a lower ID knowingly. In some applications like Terragraph, we
@@ -64,7 +76,7 @@ class RangeAllocator {
    * user must call this to start allocation
    * range and initial value may be unknown during construction
    * allocRange: the range from which to allocate values (range is inclusive)
-   * initValue: must be in allocRange
+   * initValue: must be in allocRange, hashed from node name if none
    */
   void startAllocator(
       const std::pair<T /* min */, T /* max */> allocRange,
@@ -111,11 +123,39 @@ class RangeAllocator {
    */
   void scheduleAllocate(const T seedVal) noexcept;
 
+  /**
+   * Pick a value I can own, probing a sequence determined by node name,
+   * number of attempts and seed value.
+   */
+  T pickValue(const T seedVal);
+
+  // Report number of attempts it took to own a value
+  void reportAllocated();
+
   /* Invoked whenever there is an update for our currently allocated value
    */
   void keyValUpdated(
       const std::string& key, const thrift::Value& thriftVal) noexcept;
 
+  /**
+   * Invoked for update or expiry (none) of any key with our prefix, to keep
+   * value owners and occupancy bitmap up to date
+   */
+  void valueOwnerUpdated(
+      const std::string& key, const std::optional<thrift::Value>& thriftVal);
+
+  // update occupancy bitmap for a value in range
+  void setOccupied(const T val, bool occupied);
+
+  // check if value in range is owned by someone I can't override
+  bool isOccupied(const T val) const;
+
+  // check if value in range can be owned by me
+  bool isClaimable(const T val) const;
+
+  // find first claimable value starting at startVal, none if there is none
+  std::optional<T> findClaimableValue(const T startVal) const;
+
   /**
    * Utility function to create KvStore key for the value.
    */
@@ -128,6 +168,9 @@ class RangeAllocator {
   const std::string nodeName_;
   const std::string keyPrefix_;
 
+  // Hash of node name, seeding first choice and probing of values
+  const uint64_t nodeHash_{0};
+
   // KvStoreClientInternal instance used for communicating with KvStore
   KvStoreClientInternal* const kvStoreClient_{nullptr};
 
@@ -161,6 +204,9 @@ class RangeAllocator {
   // Currently requested value
   std::optional<T> myRequestedValue_;
 
+  // Attempts to own a value since start or latest loss of value
+  uint64_t numAttempts_{0};
+
   // Exponential backoff to avoid frequent allocation retries
   ExponentialBackoff<std::chrono::milliseconds> backoff_;
 
@@ -177,6 +223,21 @@ class RangeAllocator {
   // KvStore TTL for value
   const std::chrono::milliseconds rangeAllocTtl_;
 
+  // Owners of values claimed in KvStore, in or out of range, tracked once
+  // allocator started
+  std::unordered_map<T /* value */, std::string /* owner */> valueOwners_;
+
+  // Number of values in valueOwners_ within range
+  T numValuesInRange_{0};
+
+  // Bitmap of values in range which I can't own, bits beyond the range are
+  // set. Kept for ranges up to Constants::kRangeAllocMaxBitmapSize, otherwise
+  // occupancy is looked up in valueOwners_
+  std::vector<uint64_t> occupied_;
+
+  // KvStore key prefix subscription to track valueOwners_
+  std::optional<int64_t> keyPrefixSubscriptionId_{std::nullopt};
+
   // area ID
   const AreaId area_{};
 };
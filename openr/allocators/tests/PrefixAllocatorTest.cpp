@@ -189,7 +189,7 @@ class PrefixAllocatorFixture : public ::testing::Test {
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta>
       staticRoutesUpdateQueue_;
   messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue_;
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue_;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue_;
 
   // Queue for event logs
   messaging::ReplicateQueue<LogSample> logSampleQueue_;
@@ -275,7 +275,7 @@ TEST_P(PrefixAllocTest, UniquePrefixes) {
     std::vector<std::unique_ptr<PrefixManager>> prefixManagers;
     std::vector<messaging::ReplicateQueue<thrift::PrefixUpdateRequest>>
         prefixQueues{numAllocators};
-    std::vector<messaging::ReplicateQueue<DecisionRouteUpdate>> routeQueues{
+    std::vector<messaging::ReplicateQueue<DecisionRouteUpdatePtr>> routeQueues{
         numAllocators};
     messaging::ReplicateQueue<LogSample> logSampleQueue;
     messaging::ReplicateQueue<thrift::RouteDatabaseDelta>
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBase.h>
+
+namespace openr {
+
+/**
+ * This class provides you the capability to batch events into runs of
+ * an expensive callback with delays adapted to the observed event rate and to
+ * the cost of the callback. It is modeled on SPF back-off of link state IGPs
+ * (RFC 8405).
+ *
+ * - First event after a quiet period, i.e. no run within the last
+ *   maxBackOff, schedules the callback after minBackOff
+ * - Events arriving while the callback is scheduled are batched into it
+ * - Events arriving within maxBackOff of the previous run indicate a storm,
+ *   the delay doubles with every run up to maxBackOff
+ * - Delay is at least costFactor times the duration of the previous run so
+ *   that the callback takes at most 1 / (1 + costFactor) of the time
+ */
+template <typename Duration>
+class AdaptiveDebounce final : private folly::AsyncTimeout {
+ public:
+  using TimeoutCallback = folly::Function<void(void)>;
+
+  AdaptiveDebounce(
+      folly::EventBase* eventBase,
+      Duration minBackOff,
+      Duration maxBackOff,
+      TimeoutCallback callback,
+      uint32_t costFactor = 1)
+      : AsyncTimeout(eventBase),
+        minBackOff_(minBackOff),
+        maxBackOff_(maxBackOff),
+        costFactor_(costFactor),
+        callback_(std::move(callback)) {
+    CHECK_LE(minBackOff_.count(), maxBackOff_.count());
+  }
+
+  ~AdaptiveDebounce() override = default;
+
+  /**
+   * Overload function operator. This method exposes debounced version of
+   * callback passed in. Returns the delay of the run if one got scheduled,
+   * std::nullopt if the event got batched into an already scheduled run.
+   */
+  std::optional<Duration>
+  operator()() noexcept {
+    if (isScheduled()) {
+      return std::nullopt;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (lastRunTime_.has_value() and now - *lastRunTime_ < maxBackOff_) {
+      stormDelay_ =
+          std::min(maxBackOff_, std::max(minBackOff_, stormDelay_ * 2));
+    } else {
+      stormDelay_ = minBackOff_;
+    }
+    const Duration costDelay =
+        lastRunCost_ * static_cast<typename Duration::rep>(costFactor_);
+    const Duration delay =
+        std::min(maxBackOff_, std::max(stormDelay_, costDelay));
+    scheduleTimeout(delay);
+    return delay;
+  }
+
+  // duration of the last run of the callback
+  Duration
+  getLastRunCost() const {
+    return lastRunCost_;
+  }
+
+ private:
+  void
+  timeoutExpired() noexcept override {
+    const auto start = std::chrono::steady_clock::now();
+    callback_();
+    lastRunTime_ = std::chrono::steady_clock::now();
+    lastRunCost_ = std::chrono::duration_cast<Duration>(*lastRunTime_ - start);
+  }
+
+  const Duration minBackOff_;
+  const Duration maxBackOff_;
+  const uint32_t costFactor_{1};
+  TimeoutCallback callback_{nullptr};
+
+  // delay as per event rate, doubled with every run of a storm
+  Duration stormDelay_{0};
+  Duration lastRunCost_{0};
+  std::optional<std::chrono::steady_clock::time_point> lastRunTime_;
+};
+
+} // namespace openr
@@ -11,6 +11,7 @@ namespace openr {
 
 constexpr double Constants::kRttChangeThreashold;
 constexpr folly::StringPiece Constants::kAdjDbMarker;
+constexpr folly::StringPiece Constants::kConvergenceTimeMarker;
 constexpr folly::StringPiece Constants::kErrorResponse;
 constexpr folly::StringPiece Constants::kEventLogCategory;
 constexpr folly::StringPiece Constants::kFibTimeMarker;
@@ -38,17 +39,35 @@ constexpr int32_t Constants::kOpenrCtrlPort;
 constexpr int32_t Constants::kSparkMcastPort;
 constexpr int32_t Constants::kMaxSrLabel;
 constexpr int32_t Constants::kOpenrSupportedVersion;
+constexpr int32_t Constants::kSparkFixedHeartbeatVersion;
 constexpr int32_t Constants::kOpenrVersion;
 constexpr int64_t Constants::kDefaultAdjWeight;
 constexpr int64_t Constants::kTtlInfinity;
 constexpr size_t Constants::kMaxFullSyncPendingCountThreshold;
+constexpr size_t Constants::kKvStoreMinKeysPerMergeShard;
+constexpr size_t Constants::kDecisionRouteComputationChunkSize;
+constexpr double Constants::kDecisionIncrementalRouteBuildMaxRatio;
+constexpr size_t Constants::kDecisionComputedRouteDbCacheSize;
+constexpr size_t Constants::kKvStoreHashTreeFanout;
+constexpr size_t Constants::kKvStoreHashTreeDepth;
+constexpr size_t Constants::kKvStoreMinDeltaValueSize;
+constexpr size_t Constants::kKvStoreMinSyncCompressionSize;
+constexpr size_t Constants::kKvStoreFloodQueueMaxBytes;
+constexpr size_t Constants::kKvStoreChangeLogSize;
+constexpr std::chrono::seconds Constants::kKvStoreSnapshotInterval;
+constexpr int64_t Constants::kKvStoreLatencyHistogramBucketUs;
+constexpr int64_t Constants::kKvStoreLatencyHistogramMaxUs;
 constexpr size_t Constants::kNumTimeSeries;
 constexpr std::chrono::milliseconds Constants::kFloodPendingPublication;
+constexpr std::chrono::milliseconds Constants::kKvStoreTtlWheelTick;
 constexpr std::chrono::milliseconds Constants::kKeepAliveCheckInterval;
+constexpr std::chrono::milliseconds Constants::kMaxCpuProfileDuration;
 constexpr std::chrono::milliseconds Constants::kKvStoreDbTtl;
 constexpr std::chrono::milliseconds Constants::kLinkImmediateTimeout;
 constexpr std::chrono::milliseconds Constants::kLinkThrottleTimeout;
 constexpr std::chrono::milliseconds Constants::kLongPollReqHoldTime;
+constexpr int32_t Constants::kMaxDumpPageSize;
+constexpr std::chrono::milliseconds Constants::kMinCountersPublishInterval;
 constexpr std::chrono::milliseconds Constants::kInitialBackoff;
 constexpr std::chrono::milliseconds Constants::kMaxBackoff;
 constexpr std::chrono::milliseconds Constants::kFibSyncInitialBackoff;
@@ -71,6 +90,7 @@ constexpr std::chrono::milliseconds Constants::kTtlDecrement;
 constexpr std::chrono::milliseconds Constants::kTtlInfInterval;
 constexpr std::chrono::milliseconds Constants::kTtlThreshold;
 constexpr std::chrono::seconds Constants::kConvergenceMaxDuration;
+constexpr std::chrono::seconds Constants::kConvergenceTimeFloodInterval;
 constexpr std::chrono::seconds Constants::kCounterSubmitInterval;
 constexpr std::chrono::seconds Constants::kKeepAliveIntvl;
 constexpr std::chrono::seconds Constants::kKeepAliveTime;
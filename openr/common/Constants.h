@@ -51,6 +51,10 @@ class Constants {
   // The maximum messages we can queue on sending socket
   static constexpr int kHighWaterMark{65536};
 
+  // Max number of log samples pending towards Monitor, oldest ones are dropped
+  // beyond it
+  static constexpr size_t kLogSampleQueueCapacity{16384};
+
   // Maximum label size
   static constexpr int32_t kMaxSrLabel{(1 << 20) - 1};
 
@@ -70,6 +74,41 @@ class Constants {
   // default interval to publish to monitor
   static constexpr std::chrono::seconds kCounterSubmitInterval{5};
 
+  // Number of prefixes whose routes are computed by a single task of parallel
+  // route computation. Smaller prefix tables are computed serially
+  static constexpr size_t kDecisionRouteComputationChunkSize{256};
+
+  // Routes are rebuilt from scratch on topology changes affecting more than
+  // this fraction of prefixes, see `enable_incremental_route_build`
+  static constexpr double kDecisionIncrementalRouteBuildMaxRatio{0.5};
+
+  // Buckets of route computation phase histograms of Decision
+  static constexpr int64_t kDecisionPhaseHistogramBucketUs{1000};
+  static constexpr int64_t kDecisionPhaseHistogramMaxUs{1000000};
+
+  // Max number of KvStore publications Decision reads from its queue at once
+  // before checking up on route rebuild
+  static constexpr size_t kDecisionPublicationBatchSize{64};
+
+  // Max number of nodes whose computed route databases Decision caches for
+  // getRouteDbComputed
+  static constexpr size_t kDecisionComputedRouteDbCacheSize{16};
+
+  // Default interval of writing Decision LSDB snapshots for fast restart
+  static constexpr std::chrono::seconds kDecisionLsdbSnapshotInterval{30};
+
+  // State restored from LSDB snapshot is reconciled with KvStore at the
+  // latest this long after restart if KvStore doesn't sync every area before,
+  // unless `eor_time_s` is set
+  static constexpr std::chrono::seconds kDecisionLsdbSnapshotReconcileTimeout{
+      60};
+
+  // Default max age of LSDB snapshot restored on restart
+  static constexpr std::chrono::seconds kDecisionLsdbSnapshotMaxAge{300};
+
+  // Interval of checking suppressed prefixes of route damping for reuse
+  static constexpr std::chrono::seconds kDecisionRouteDampingReuseInterval{1};
+
   // event log category
   static constexpr folly::StringPiece kEventLogCategory{"perfpipe_aquaman"};
 
@@ -86,6 +125,11 @@ class Constants {
       100};
   static constexpr std::chrono::milliseconds kPersistentStoreMaxBackoff{5000};
 
+  // Storage file of PersistentStore is compacted in background once it grows
+  // beyond both, minimum size and ratio of size of the database it holds
+  static constexpr uint64_t kPersistentStoreMinCompactionBytes{1 << 20};
+  static constexpr uint64_t kPersistentStoreCompactionRatio{4};
+
   //
   // KvStore specific
 
@@ -99,6 +143,36 @@ class Constants {
   // kMaxBackoff to send the next sync request
   static constexpr size_t kMaxFullSyncPendingCountThreshold{32};
 
+  // Minimum number of key-vals per shard for a publication to be merged in
+  // parallel. Smaller publications are merged inline on the event-base
+  static constexpr size_t kKvStoreMinKeysPerMergeShard{512};
+
+  // Shape of KvStore hash-tree index => 16^3 = 4096 leaves
+  static constexpr size_t kKvStoreHashTreeFanout{16};
+  static constexpr size_t kKvStoreHashTreeDepth{3};
+
+  // Minimum size of a value to be delta-encoded for flooding. Delta is only
+  // used if it is less than half of the full value
+  static constexpr size_t kKvStoreMinDeltaValueSize{256};
+
+  // Minimum serialized size of a full-sync response to be compressed
+  static constexpr size_t kKvStoreMinSyncCompressionSize{16 * 1024};
+
+  // Maximum bytes of key-vals queued for flooding towards a thrift peer
+  static constexpr size_t kKvStoreFloodQueueMaxBytes{16 * 1024 * 1024};
+
+  // Max number of publications per area kept in KvStore change log to resume
+  // subscriptions from
+  static constexpr size_t kKvStoreChangeLogSize{1024};
+
+  // Default interval of writing KvStore snapshots for warm restart
+  static constexpr std::chrono::seconds kKvStoreSnapshotInterval{30};
+
+  // Shape of latency histograms of KvStore publication processing stages.
+  // Latencies beyond max are accounted in the last bucket
+  static constexpr int64_t kKvStoreLatencyHistogramBucketUs{100};
+  static constexpr int64_t kKvStoreLatencyHistogramMaxUs{100000};
+
   //
   // PrefixAllocator specific
 
@@ -156,12 +230,34 @@ class Constants {
   static constexpr std::chrono::milliseconds kPlatformConnTimeout{100};
   static constexpr std::chrono::milliseconds kPlatformRoutesProcTimeout{20000};
   static constexpr std::chrono::milliseconds kPlatformIntfProcTimeout{1000};
+
+  // Maximum number of non-final chunks of a chunked FIB sync in flight
+  static constexpr size_t kFibSyncMaxChunksInFlight{4};
+
+  // Shape of histograms of Fib route programming latencies and of routes per
+  // programming call. Values beyond max are accounted in the last bucket
+  static constexpr int64_t kFibLatencyHistogramBucketMs{20};
+  static constexpr int64_t kFibLatencyHistogramMaxMs{20000};
+  static constexpr int64_t kFibRoutesPerCallHistogramBucket{10};
+  static constexpr int64_t kFibRoutesPerCallHistogramMax{10000};
   static constexpr std::chrono::milliseconds kServiceConnTimeout{500};
   static constexpr std::chrono::milliseconds kServiceProcTimeout{20000};
 
+  // maximum number of KvStore instances dumped at once by KvStoreUtil, keep
+  // well below file descriptor limit of tools
+  static constexpr size_t kKvStoreDumpMaxConcurrency{256};
+
   // time interval to sync between Open/R and Platform
   static constexpr std::chrono::seconds kPlatformSyncInterval{60};
 
+  // time interval to check for lost netlink events with event driven sync
+  // between Open/R and Platform
+  static constexpr std::chrono::seconds kNetlinkEventsLostCheckInterval{1};
+
+  // time interval of full sync of redistributed addresses to PrefixManager,
+  // which are otherwise advertised and withdrawn incrementally
+  static constexpr std::chrono::seconds kRedistAddrsFullSyncInterval{300};
+
   // time interval for keep alive check between fib and switch agent
   static constexpr std::chrono::milliseconds kKeepAliveCheckInterval{1000};
 
@@ -188,12 +284,21 @@ class Constants {
   // Kvstore timer for flooding pending publication
   static constexpr std::chrono::milliseconds kFloodPendingPublication{100};
 
+  // granularity of the timing wheel tracking TTL expiry of keys
+  static constexpr std::chrono::milliseconds kKvStoreTtlWheelTick{1};
+
   // KvStore database TTLs
   static constexpr std::chrono::milliseconds kKvStoreDbTtl{5min};
 
   // RangeAllocator keys TTLs
   static constexpr std::chrono::milliseconds kRangeAllocTtl{5min};
 
+  // RangeAllocator keeps occupancy bitmap of ranges up to this size
+  static constexpr uint64_t kRangeAllocMaxBitmapSize{1 << 24};
+
+  // Random values RangeAllocator tries before scanning for a free one
+  static constexpr size_t kRangeAllocNumRandomProbes{8};
+
   // delimiter separating prefix and name in kvstore key
   static constexpr folly::StringPiece kPrefixNameSeparator{":"};
 
@@ -202,6 +307,7 @@ class Constants {
   static constexpr folly::StringPiece kPrefixDbMarker{"prefix:"};
   static constexpr folly::StringPiece kPrefixAllocMarker{"allocprefix:"};
   static constexpr folly::StringPiece kFibTimeMarker{"fibtime:"};
+  static constexpr folly::StringPiece kConvergenceTimeMarker{"convtime:"};
   static constexpr folly::StringPiece kNodeLabelRangePrefix{"nodeLabel:"};
 
   static constexpr folly::StringPiece kGlobalCmdLocalIdTemplate{
@@ -229,9 +335,27 @@ class Constants {
   static constexpr uint16_t kPerfBufferSize{10};
   static constexpr std::chrono::seconds kConvergenceMaxDuration{3s};
 
+  // Shape of histograms of convergence time and its stages, and interval of
+  // flooding worst convergence time of node with `convtime:` key
+  static constexpr int64_t kConvergenceHistogramBucketMs{10};
+  static constexpr std::chrono::seconds kConvergenceTimeFloodInterval{10s};
+
+  // Limits of CPU profile collected through OpenrCtrl
+  static constexpr std::chrono::milliseconds kMaxCpuProfileDuration{60000};
+  static constexpr int32_t kMaxCpuProfileFrequencyHz{1000};
+
   // hold time for longPoll requests in openrCtrl thrift server
   static constexpr std::chrono::milliseconds kLongPollReqHoldTime{20000};
 
+  // max number of entries in page of paginated dumps
+  static constexpr int32_t kMaxDumpPageSize{10000};
+
+  // min interval of publications of counter subscriptions
+  static constexpr std::chrono::milliseconds kMinCountersPublishInterval{1000};
+
+  // time module has to provide its section of tech-support snapshot
+  static constexpr std::chrono::milliseconds kTechSupportSectionTimeout{10000};
+
   //
   // Prefix manager specific
   //
@@ -239,6 +363,10 @@ class Constants {
   // the time we hold on to announce to KvStore
   static constexpr std::chrono::milliseconds kPrefixMgrKvThrottleTimeout{250};
 
+  // the time PrefixManager waits for the next request of a bulk load before
+  // it gives up on end-of-RIB and advertises prefixes loaded so far
+  static constexpr std::chrono::seconds kPrefixMgrBulkLoadIdleTimeout{30};
+
   // Default metrics (path and source preference) for Open/R originated routes
   // (loopback address & interface subnets).
   static constexpr int32_t kDefaultPathPreference{1000}; // LIVE routes
@@ -271,13 +399,26 @@ class Constants {
   //
 
   // Current OpenR version
-  static constexpr int32_t kOpenrVersion{20200825};
+  static constexpr int32_t kOpenrVersion{20201014};
 
   // Lowest Supported OpenR version
   static constexpr int32_t kOpenrSupportedVersion{20200604};
 
+  // Lowest OpenR version supporting fixed-layout Spark heartbeats
+  static constexpr int32_t kSparkFixedHeartbeatVersion{20201014};
+
   // Threshold time in secs to crash after reaching critical memory
   static constexpr std::chrono::seconds kMemoryThresholdTime{600};
+
+  // Number of slowest callbacks and loop lag samples every OpenrEventBase
+  // keeps between reads of its loop stats
+  static constexpr size_t kEvbNumSlowestCallbacks{5};
+  static constexpr size_t kEvbMaxLoopLagSamples{120};
+
+  // Shape of loop lag histograms exported by Watchdog. Lags beyond max are
+  // accounted in the last bucket
+  static constexpr int64_t kEvbLoopLagHistogramBucketMs{10};
+  static constexpr int64_t kEvbLoopLagHistogramMaxMs{10000};
 };
 
 } // namespace openr
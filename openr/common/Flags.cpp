@@ -21,6 +21,10 @@ DEFINE_bool(
     enable_perf_measurement,
     true,
     "Enable performance measurement in network.");
+DEFINE_bool(
+    enable_queue_dwell_time,
+    false,
+    "Export histograms of time messages spend in queues between modules");
 DEFINE_int32(
     ip_tos,
     openr::Constants::kIpTos,
@@ -19,6 +19,7 @@ DECLARE_string(config);
 // platform flags
 DECLARE_bool(enable_fib_service_waiting);
 DECLARE_bool(enable_perf_measurement);
+DECLARE_bool(enable_queue_dwell_time);
 
 DECLARE_int32(ip_tos);
 
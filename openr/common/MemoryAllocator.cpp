@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/common/MemoryAllocator.h>
+
+#include <sys/types.h>
+
+#include <folly/Format.h>
+#include <folly/String.h>
+#include <folly/memory/MallctlHelper.h>
+#include <folly/memory/Malloc.h>
+#include <glog/logging.h>
+
+namespace openr {
+
+namespace {
+
+// Set decay time of `name`, e.g. "dirty_decay_ms", of existing arenas and as
+// default of arenas created later, e.g. memory arenas of modules
+bool
+setDecayMs(const std::string& name, ssize_t decayMs) noexcept {
+  try {
+    folly::mallctlWrite(folly::sformat("arenas.{}", name).c_str(), decayMs);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to set " << name << " of memory allocator to "
+               << decayMs << ": " << folly::exceptionStr(ex);
+    return false;
+  }
+
+  unsigned narenas{0};
+  try {
+    folly::mallctlRead("arenas.narenas", &narenas);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to read number of memory arenas: "
+               << folly::exceptionStr(ex);
+    return false;
+  }
+  for (unsigned arena = 0; arena < narenas; ++arena) {
+    try {
+      folly::mallctlWrite(
+          folly::sformat("arena.{}.{}", arena, name).c_str(), decayMs);
+    } catch (const std::exception&) {
+      // arena not initialized yet, gets default of `arenas.<name>`
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+bool
+applyMemoryAllocatorConfig(
+    const thrift::MemoryAllocatorConfig& config) noexcept {
+  if (not folly::usingJEMalloc()) {
+    LOG(WARNING) << "Not running with jemalloc, ignoring its config";
+    return false;
+  }
+
+  bool applied = true;
+  if (auto backgroundThread = config.background_thread_ref()) {
+    try {
+      folly::mallctlWrite("background_thread", *backgroundThread);
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "Failed to set background_thread of memory allocator to "
+                 << *backgroundThread << ": " << folly::exceptionStr(ex);
+      applied = false;
+    }
+  }
+  if (auto dirtyDecayMs = config.dirty_decay_ms_ref()) {
+    applied &= setDecayMs("dirty_decay_ms", *dirtyDecayMs);
+  }
+  if (auto muzzyDecayMs = config.muzzy_decay_ms_ref()) {
+    applied &= setDecayMs("muzzy_decay_ms", *muzzyDecayMs);
+  }
+  LOG_IF(INFO, applied) << "Applied memory allocator config";
+  return applied;
+}
+
+bool
+setThreadCacheEnabled(bool enabled) noexcept {
+  if (not folly::usingJEMalloc()) {
+    return false;
+  }
+  try {
+    folly::mallctlWrite("thread.tcache.enabled", enabled);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to " << (enabled ? "enable" : "disable")
+               << " thread cache of memory allocator: "
+               << folly::exceptionStr(ex);
+    return false;
+  }
+  return true;
+}
+
+std::optional<MemoryAllocatorStats>
+getMemoryAllocatorStats() noexcept {
+  if (not folly::usingJEMalloc()) {
+    return std::nullopt;
+  }
+
+  MemoryAllocatorStats stats;
+  try {
+    // Refresh statistics of jemalloc
+    folly::mallctlWrite<uint64_t>("epoch", 1);
+    folly::mallctlRead("stats.allocated", &stats.allocated);
+    folly::mallctlRead("stats.active", &stats.active);
+    folly::mallctlRead("stats.resident", &stats.resident);
+    folly::mallctlRead("stats.mapped", &stats.mapped);
+    folly::mallctlRead("stats.retained", &stats.retained);
+  } catch (const std::exception& ex) {
+    VLOG(2) << "Failed to read memory allocator statistics: "
+            << folly::exceptionStr(ex);
+    return std::nullopt;
+  }
+  return stats;
+}
+
+} // namespace openr
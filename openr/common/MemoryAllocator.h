@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include <openr/if/gen-cpp2/OpenrConfig_types.h>
+
+namespace openr {
+
+/**
+ * Process wide statistics of jemalloc, in bytes. See `stats.*` mallctls
+ */
+struct MemoryAllocatorStats {
+  // allocated by application
+  size_t allocated{0};
+  // in active pages, allocated plus fragmentation within pages
+  size_t active{0};
+  // in physically resident pages, including metadata and dirty pages
+  size_t resident{0};
+  // in active extents mapped by allocator
+  size_t mapped{0};
+  // retained virtual memory, not returned to the system
+  size_t retained{0};
+};
+
+/**
+ * Apply jemalloc tuning of config. Failures, e.g. not running with jemalloc,
+ * are logged and leave the respective setting unchanged. Returns true if all
+ * applied.
+ */
+bool applyMemoryAllocatorConfig(
+    const thrift::MemoryAllocatorConfig& config) noexcept;
+
+/**
+ * Enable or disable jemalloc thread cache of calling thread, flushing cached
+ * objects if disabled. Returns false on failure.
+ */
+bool setThreadCacheEnabled(bool enabled) noexcept;
+
+/**
+ * Refresh and read statistics of jemalloc. std::nullopt if not running with
+ * jemalloc or it's built without statistics
+ */
+std::optional<MemoryAllocatorStats> getMemoryAllocatorStats() noexcept;
+
+} // namespace openr
@@ -7,6 +7,8 @@
 
 #include <openr/common/NetworkUtil.h>
 
+#include <stdexcept>
+
 namespace std {
 
 /**
@@ -83,3 +85,95 @@ hash<openr::thrift::UnicastRoute>::operator()(
 }
 
 } // namespace std
+
+namespace openr {
+
+namespace {
+
+void
+checkPrefixLength(int length, bool isV4) {
+  const int bitCount = isV4 ? folly::IPAddressV4::bitCount()
+                            : folly::IPAddressV6::bitCount();
+  if (length < 0 or length > bitCount) {
+    throw std::invalid_argument(
+        folly::sformat("Invalid prefix length {}", length));
+  }
+}
+
+} // namespace
+
+PackedPrefix::PackedPrefix(const thrift::IpPrefix& prefix) {
+  const auto& addr = *prefix.prefixAddress_ref()->addr_ref();
+  if (addr.size() == folly::IPAddressV4::byteCount()) {
+    v4_ = true;
+  } else if (addr.size() != folly::IPAddressV6::byteCount()) {
+    throw std::invalid_argument(
+        folly::sformat("Invalid address length {}", addr.size()));
+  }
+  checkPrefixLength(*prefix.prefixLength_ref(), v4_);
+  std::memcpy(addr_.data(), addr.data(), addr.size());
+  length_ = *prefix.prefixLength_ref();
+}
+
+PackedPrefix::PackedPrefix(const folly::CIDRNetwork& network) {
+  const auto& addr = network.first;
+  if (not addr.isV4() and not addr.isV6()) {
+    throw std::invalid_argument("Address of unknown family");
+  }
+  v4_ = addr.isV4();
+  checkPrefixLength(network.second, v4_);
+  std::memcpy(addr_.data(), addr.bytes(), addr.byteCount());
+  length_ = network.second;
+}
+
+std::optional<PackedPrefix>
+PackedPrefix::tryFrom(const thrift::IpPrefix& prefix) noexcept {
+  try {
+    return PackedPrefix(prefix);
+  } catch (std::invalid_argument const&) {
+    return std::nullopt;
+  }
+}
+
+PackedPrefix
+PackedPrefix::masked() const {
+  PackedPrefix result(*this);
+  size_t bits = length_;
+  for (auto& byte : result.addr_) {
+    if (bits >= 8) {
+      bits -= 8;
+      continue;
+    }
+    byte &= static_cast<uint8_t>(0xff << (8 - bits));
+    bits = 0;
+  }
+  return result;
+}
+
+thrift::IpPrefix
+PackedPrefix::toThrift() const {
+  thrift::IpPrefix prefix;
+  prefix.prefixAddress_ref()->addr_ref()->assign(
+      reinterpret_cast<const char*>(addr_.data()),
+      v4_ ? folly::IPAddressV4::byteCount() : kSize);
+  prefix.prefixLength_ref() = length_;
+  return prefix;
+}
+
+folly::CIDRNetwork
+PackedPrefix::toCIDRNetwork() const {
+  if (v4_) {
+    return {folly::IPAddressV4::fromBinary(folly::ByteRange(
+                addr_.data(), folly::IPAddressV4::byteCount())),
+            length_};
+  }
+  return {folly::IPAddressV6::fromBinary(folly::ByteRange(addr_.data(), kSize)),
+          length_};
+}
+
+std::string
+PackedPrefix::str() const {
+  return folly::IPAddress::networkToString(toCIDRNetwork());
+}
+
+} // namespace openr
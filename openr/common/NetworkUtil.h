@@ -7,8 +7,13 @@
 
 #pragma once
 
+#include <array>
+#include <cstring>
+#include <optional>
+
 #include <folly/Format.h>
 #include <folly/IPAddress.h>
+#include <folly/hash/Hash.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include <thrift/lib/cpp2/Thrift.h>
 
@@ -212,4 +217,108 @@ toString(const thrift::MplsRoute& route) {
   return folly::join("\n", lines);
 }
 
+/**
+ * Compact and trivially copyable IPv4/IPv6 prefix, for keys of internal maps
+ * which would otherwise hash and compare thrift::IpPrefix, with a heap
+ * allocated address string, or folly::CIDRNetwork. Address bytes are kept as
+ * given, i.e. no mask gets applied unless asked for by masked().
+ *
+ * Implicitly constructible from thrift::IpPrefix and folly::CIDRNetwork so
+ * that maps can be looked up with either. Convert back with toThrift() and
+ * toCIDRNetwork() at API boundaries only.
+ */
+class PackedPrefix {
+ public:
+  PackedPrefix() = default;
+
+  // Throws std::invalid_argument on address of unknown family or length
+  // exceeding bit count of address
+  /* implicit */ PackedPrefix(const thrift::IpPrefix& prefix);
+  /* implicit */ PackedPrefix(const folly::CIDRNetwork& network);
+
+  // std::nullopt for malformed prefix, e.g. of a filter received over API
+  static std::optional<PackedPrefix> tryFrom(
+      const thrift::IpPrefix& prefix) noexcept;
+
+  bool
+  isV4() const {
+    return v4_;
+  }
+
+  uint8_t
+  length() const {
+    return length_;
+  }
+
+  // Prefix with host bits of address cleared
+  PackedPrefix masked() const;
+
+  thrift::IpPrefix toThrift() const;
+  folly::CIDRNetwork toCIDRNetwork() const;
+
+  // e.g. `10.0.0.0/8`, same as folly::IPAddress::networkToString()
+  std::string str() const;
+
+  size_t
+  hash() const {
+    uint64_t hi, lo;
+    std::memcpy(&hi, addr_.data(), sizeof(hi));
+    std::memcpy(&lo, addr_.data() + sizeof(hi), sizeof(lo));
+    const uint64_t meta = (static_cast<uint64_t>(v4_) << 8) | length_;
+    return folly::hash::hash_128_to_64(hi ^ (meta << 48), lo);
+  }
+
+  friend bool
+  operator==(const PackedPrefix& lhs, const PackedPrefix& rhs) {
+    return lhs.v4_ == rhs.v4_ and lhs.length_ == rhs.length_ and
+        lhs.addr_ == rhs.addr_;
+  }
+
+  friend bool
+  operator!=(const PackedPrefix& lhs, const PackedPrefix& rhs) {
+    return not(lhs == rhs);
+  }
+
+  // IPv4 prefixes order first, then by address and length
+  friend bool
+  operator<(const PackedPrefix& lhs, const PackedPrefix& rhs) {
+    if (lhs.v4_ != rhs.v4_) {
+      return lhs.v4_;
+    }
+    const auto cmp = std::memcmp(lhs.addr_.data(), rhs.addr_.data(), kSize);
+    return cmp != 0 ? cmp < 0 : lhs.length_ < rhs.length_;
+  }
+
+ private:
+  static constexpr size_t kSize{folly::IPAddressV6::byteCount()};
+
+  // IPv4 address takes the first four bytes, others are zero
+  std::array<uint8_t, kSize> addr_{};
+  uint8_t length_{0};
+  bool v4_{false};
+};
+
+static_assert(std::is_trivially_copyable_v<PackedPrefix>);
+static_assert(sizeof(PackedPrefix) == 18);
+
+inline std::string
+toString(const PackedPrefix& prefix) {
+  return prefix.str();
+}
+
 } // namespace openr
+
+namespace std {
+
+/**
+ * Make PackedPrefix hashable
+ */
+template <>
+struct hash<openr::PackedPrefix> {
+  size_t
+  operator()(openr::PackedPrefix const& prefix) const {
+    return prefix.hash();
+  }
+};
+
+} // namespace std
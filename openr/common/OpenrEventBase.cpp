@@ -7,8 +7,18 @@
 
 #include "openr/common/OpenrEventBase.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include <folly/Format.h>
+#include <folly/executors/ExecutionObserver.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/WithCancellation.h>
+#endif
 #include <folly/fibers/FiberManagerMap.h>
 
+#include <openr/common/Constants.h>
+
 namespace openr {
 
 namespace {
@@ -28,6 +38,20 @@ getZmqSocketFd(uintptr_t socketPtr) {
   return socketFd;
 }
 
+int64_t
+getElapsedUs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// `<file basename>:<line>`
+std::string
+getCallSiteName(const char* file, int line) {
+  const char* basename = std::strrchr(file, '/');
+  return folly::sformat("{}:{}", basename ? basename + 1 : file, line);
+}
+
 folly::fibers::FiberManager::Options
 getFmOptions() {
   folly::fibers::FiberManager::Options options;
@@ -37,6 +61,56 @@ getFmOptions() {
 }
 } // namespace
 
+class OpenrEventBase::LoopObserver final : public folly::EventBaseObserver {
+ public:
+  explicit LoopObserver(folly::Synchronized<LoopStats>& loopStats)
+      : loopStats_(loopStats) {}
+
+  uint32_t
+  getSampleRate() const override {
+    return 1;
+  }
+
+  void
+  loopSample(int64_t busyTime, int64_t idleTime) override {
+    auto stats = loopStats_.wlock();
+    stats->busyTimeUs += busyTime;
+    stats->idleTimeUs += idleTime;
+  }
+
+ private:
+  folly::Synchronized<LoopStats>& loopStats_;
+};
+
+class OpenrEventBase::FiberObserver final : public folly::ExecutionObserver {
+ public:
+  explicit FiberObserver(folly::Synchronized<LoopStats>& loopStats)
+      : loopStats_(loopStats) {}
+
+  // Fibers of a FiberManager run one at a time, in between starting() and
+  // stopped()
+  void
+  starting(uintptr_t /* id */) noexcept override {
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  void
+  runnable(uintptr_t /* id */) noexcept override {}
+
+  void
+  stopped(uintptr_t /* id */) noexcept override {
+    const auto runTimeUs = getElapsedUs(start_);
+    auto stats = loopStats_.wlock();
+    ++stats->numFiberRuns;
+    stats->fiberRunTimeUs += runTimeUs;
+    stats->maxFiberRunTimeUs = std::max(stats->maxFiberRunTimeUs, runTimeUs);
+  }
+
+ private:
+  folly::Synchronized<LoopStats>& loopStats_;
+  std::chrono::steady_clock::time_point start_;
+};
+
 EventBaseStopSignalHandler::EventBaseStopSignalHandler(folly::EventBase* evb)
     : folly::AsyncSignalHandler(evb) {}
 
@@ -122,31 +196,120 @@ OpenrEventBase::ZmqEventHandler::handlerReady(uint16_t events) noexcept {
 }
 
 OpenrEventBase::OpenrEventBase()
-    : fiberManager_(folly::fibers::getFiberManager(evb_, getFmOptions())) {
+    : loopObserver_(std::make_shared<LoopObserver>(loopStats_)),
+      fiberObserver_(std::make_unique<FiberObserver>(loopStats_)),
+      fiberManager_(folly::fibers::getFiberManager(evb_, getFmOptions())) {
+  evb_.setObserver(loopObserver_);
+  fiberManager_.setObserver(fiberObserver_.get());
+
   // Periodic timer to update eventbase's timestamp. This is used by Watchdog to
   // identify stuck threads.
   // update aliveness timestamp
   timestamp_.store(std::chrono::steady_clock::now().time_since_epoch().count());
   timeout_ = folly::AsyncTimeout::make(evb_, [this]() noexcept {
-    timestamp_.store(
-        std::chrono::steady_clock::now().time_since_epoch().count());
+    const auto now = std::chrono::steady_clock::now();
+    timestamp_.store(now.time_since_epoch().count());
+
+    // Time the timer fired late by is the time loop was busy before it. The
+    // first firing is skipped as loop may start long after construction
+    if (timeoutDue_ != std::chrono::steady_clock::time_point()) {
+      const auto lagMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             now - timeoutDue_)
+                             .count();
+      auto stats = loopStats_.wlock();
+      if (stats->loopLagMs.size() >= Constants::kEvbMaxLoopLagSamples) {
+        stats->loopLagMs.erase(stats->loopLagMs.begin());
+      }
+      stats->loopLagMs.emplace_back(std::max<int64_t>(0, lagMs));
+    }
+
+    timeoutDue_ = now + std::chrono::seconds(1);
     timeout_->scheduleTimeout(std::chrono::seconds(1));
   });
   timeout_->scheduleTimeout(0);
 }
 
-OpenrEventBase::~OpenrEventBase() {}
+OpenrEventBase::~OpenrEventBase() {
+  fiberManager_.setObserver(nullptr);
+}
+
+OpenrEventBase::LoopStats
+OpenrEventBase::getAndResetLoopStats() {
+  return std::exchange(*loopStats_.wlock(), LoopStats());
+}
+
+void
+OpenrEventBase::recordCallback(
+    const char* file,
+    int line,
+    std::chrono::steady_clock::time_point start) noexcept {
+  const auto runTimeUs = getElapsedUs(start);
+  auto stats = loopStats_.wlock();
+  auto& slowest = stats->slowestCallbacksUs;
+  if (slowest.size() >= Constants::kEvbNumSlowestCallbacks and
+      runTimeUs <= slowest.back().second) {
+    return;
+  }
+
+  // Keep the slowest run of every call site only
+  auto name = getCallSiteName(file, line);
+  auto it = std::find_if(slowest.begin(), slowest.end(), [&](auto const& cb) {
+    return cb.first == name;
+  });
+  if (it != slowest.end()) {
+    if (it->second >= runTimeUs) {
+      return;
+    }
+    slowest.erase(it);
+  } else if (slowest.size() >= Constants::kEvbNumSlowestCallbacks) {
+    slowest.pop_back();
+  }
+  auto pos = std::find_if(slowest.begin(), slowest.end(), [&](auto const& cb) {
+    return cb.second < runTimeUs;
+  });
+  slowest.emplace(pos, std::move(name), runTimeUs);
+}
+
+fbzmq::SocketCallback
+OpenrEventBase::timedSocketCallback(
+    fbzmq::SocketCallback callback, const char* file, int line) {
+  return [this, file, line, callback = std::move(callback)](
+             int events) mutable noexcept {
+    const auto start = std::chrono::steady_clock::now();
+    callback(events);
+    recordCallback(file, line, start);
+  };
+}
 
 void
 OpenrEventBase::run() {
   evb_.loopForever();
 }
 
+#if FOLLY_HAS_COROUTINES
+void
+OpenrEventBase::addCoroTask(folly::coro::Task<void>&& task) {
+  coroTaskFutures_.emplace_back(
+      folly::coro::co_withCancellation(
+          cancellationSource_.getToken(), std::move(task))
+          .scheduleOn(&evb_)
+          .start());
+}
+#endif
+
 void
 OpenrEventBase::stop() {
+#if FOLLY_HAS_COROUTINES
+  cancellationSource_.requestCancellation();
+#endif
   for (auto& future : fiberTaskFutures_) {
     future.wait();
   }
+#if FOLLY_HAS_COROUTINES
+  for (auto& future : coroTaskFutures_) {
+    future.wait();
+  }
+#endif
   evb_.terminateLoopSoon();
 }
 
@@ -169,21 +332,39 @@ OpenrEventBase::waitUntilStopped() {
 
 void
 OpenrEventBase::scheduleTimeout(
-    std::chrono::milliseconds timeout, folly::EventBase::Func callback) {
-  evb_.scheduleAt(
-      std::move(callback), timeout + std::chrono::steady_clock::now());
+    std::chrono::milliseconds timeout,
+    folly::EventBase::Func callback,
+    const char* file,
+    int line) {
+  scheduleTimeoutAt(
+      timeout + std::chrono::steady_clock::now(),
+      std::move(callback),
+      file,
+      line);
 }
 
 void
 OpenrEventBase::scheduleTimeoutAt(
     std::chrono::steady_clock::time_point scheduleTime,
-    folly::EventBase::Func callback) {
-  evb_.scheduleAt(std::move(callback), scheduleTime);
+    folly::EventBase::Func callback,
+    const char* file,
+    int line) {
+  evb_.scheduleAt(
+      [this, file, line, callback = std::move(callback)]() mutable noexcept {
+        const auto start = std::chrono::steady_clock::now();
+        callback();
+        recordCallback(file, line, start);
+      },
+      scheduleTime);
 }
 
 void
 OpenrEventBase::addSocketFd(
-    int socketFd, int events, fbzmq::SocketCallback callback) {
+    int socketFd,
+    int events,
+    fbzmq::SocketCallback callback,
+    const char* file,
+    int line) {
   if (fdHandlers_.count(socketFd)) {
     throw std::runtime_error("Socket-fd is already registered");
   }
@@ -195,12 +376,16 @@ OpenrEventBase::addSocketFd(
           socketFd,
           reinterpret_cast<uintptr_t>(nullptr),
           events,
-          std::move(callback)));
+          timedSocketCallback(std::move(callback), file, line)));
 }
 
 void
 OpenrEventBase::addSocket(
-    uintptr_t socketPtr, int events, fbzmq::SocketCallback callback) {
+    uintptr_t socketPtr,
+    int events,
+    fbzmq::SocketCallback callback,
+    const char* file,
+    int line) {
   int socketFd = getZmqSocketFd(socketPtr);
   if (fdHandlers_.count(socketFd)) {
     throw std::runtime_error("Socket is already registered");
@@ -209,7 +394,11 @@ OpenrEventBase::addSocket(
       std::piecewise_construct,
       std::forward_as_tuple(socketFd),
       std::forward_as_tuple(
-          &evb_, socketFd, socketPtr, events, std::move(callback)));
+          &evb_,
+          socketFd,
+          socketPtr,
+          events,
+          timedSocketCallback(std::move(callback), file, line)));
 }
 
 void
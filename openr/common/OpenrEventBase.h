@@ -8,12 +8,20 @@
 #pragma once
 
 #include <csignal>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/zmq/Socket.h>
+#include <folly/Synchronized.h>
 #include <folly/fibers/FiberManager.h>
 #include <folly/io/async/AsyncSignalHandler.h>
 #include <folly/io/async/EventHandler.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/CancellationToken.h>
+#include <folly/experimental/coro/Task.h>
+#endif
 
 namespace openr {
 
@@ -27,6 +35,29 @@ class EventBaseStopSignalHandler : public folly::AsyncSignalHandler {
 
 class OpenrEventBase {
  public:
+  /**
+   * Event loop statistics accumulated since the previous call of
+   * getAndResetLoopStats()
+   */
+  struct LoopStats {
+    // time spent running callbacks and waiting for events, as sampled by
+    // folly::EventBase for every loop
+    int64_t busyTimeUs{0};
+    int64_t idleTimeUs{0};
+
+    // lag of the periodic health check timer, one sample per firing
+    std::vector<int64_t> loopLagMs;
+
+    // run time of fiber tasks between their suspension points
+    int64_t numFiberRuns{0};
+    int64_t fiberRunTimeUs{0};
+    int64_t maxFiberRunTimeUs{0};
+
+    // slowest callbacks run via APIs of OpenrEventBase, named by the call
+    // site they were added from and sorted by descending run time
+    std::vector<std::pair<std::string, int64_t>> slowestCallbacksUs;
+  };
+
   OpenrEventBase();
 
   virtual ~OpenrEventBase();
@@ -60,12 +91,39 @@ class OpenrEventBase {
     return fiberManager_.addTaskFuture(std::move(func));
   }
 
+#if FOLLY_HAS_COROUTINES
+  /**
+   * Add a co-routine task, run on underlying event-base. Cancellation of all
+   * tasks is requested and they are awaited in `stop()`.
+   *
+   * NOTE: Cancellation is cooperative. Awaits of e.g. folly::coro::sleep()
+   * complete early, while queue reads complete once their queue is closed.
+   * Tasks must not call fiber-blocking APIs, they run outside of fibers.
+   */
+  void addCoroTask(folly::coro::Task<void>&& task);
+
+  // Token of cancellation requested in `stop()`, for tasks to poll
+  folly::CancellationToken
+  getCancellationToken() const {
+    return cancellationSource_.getToken();
+  }
+#endif
+
   /**
-   * EventBase API aliases
+   * EventBase API aliases. Callbacks are timed and accounted to the call site
+   * in LoopStats
    */
   void
-  runInEventBaseThread(folly::EventBase::Func callback) {
-    evb_.runInEventBaseThread(std::move(callback));
+  runInEventBaseThread(
+      folly::EventBase::Func callback,
+      const char* file = __builtin_FILE(),
+      int line = __builtin_LINE()) {
+    evb_.runInEventBaseThread(
+        [this, file, line, callback = std::move(callback)]() mutable noexcept {
+          const auto start = std::chrono::steady_clock::now();
+          callback();
+          recordCallback(file, line, start);
+        });
   }
 
   /**
@@ -77,6 +135,11 @@ class OpenrEventBase {
         std::chrono::steady_clock::duration(timestamp_.load()));
   }
 
+  /**
+   * Get event loop statistics since the previous call. Thread safe
+   */
+  LoopStats getAndResetLoopStats();
+
   /**
    * Runnable interface APIs
    */
@@ -96,24 +159,48 @@ class OpenrEventBase {
    */
 
   void scheduleTimeout(
-      std::chrono::milliseconds timeout, folly::EventBase::Func callback);
+      std::chrono::milliseconds timeout,
+      folly::EventBase::Func callback,
+      const char* file = __builtin_FILE(),
+      int line = __builtin_LINE());
 
   void scheduleTimeoutAt(
       std::chrono::steady_clock::time_point scheduleTime,
-      folly::EventBase::Func callback);
+      folly::EventBase::Func callback,
+      const char* file = __builtin_FILE(),
+      int line = __builtin_LINE());
 
   /**
    * Socket/FD polling APIs
    */
 
-  void addSocketFd(int socketFd, int events, fbzmq::SocketCallback callback);
+  void addSocketFd(
+      int socketFd,
+      int events,
+      fbzmq::SocketCallback callback,
+      const char* file = __builtin_FILE(),
+      int line = __builtin_LINE());
   void addSocket(
-      uintptr_t socketPtr, int events, fbzmq::SocketCallback callback);
+      uintptr_t socketPtr,
+      int events,
+      fbzmq::SocketCallback callback,
+      const char* file = __builtin_FILE(),
+      int line = __builtin_LINE());
 
   void removeSocketFd(int socketFd);
   void removeSocket(uintptr_t socketPtr);
 
  private:
+  // account run time of callback added from file:line, started at start
+  void recordCallback(
+      const char* file,
+      int line,
+      std::chrono::steady_clock::time_point start) noexcept;
+
+  // wrap socket callback to record its run time
+  fbzmq::SocketCallback timedSocketCallback(
+      fbzmq::SocketCallback callback, const char* file, int line);
+
   /**
    * Event handler class for sockets and fds
    */
@@ -145,6 +232,18 @@ class OpenrEventBase {
     std::unique_ptr<folly::AsyncTimeout> timeout_;
   };
 
+  // NOTE: Declared ahead of evb_ as callbacks still run while evb_ is being
+  // destroyed
+  folly::Synchronized<LoopStats> loopStats_;
+
+  // Samples busy and idle time of every loop of evb_
+  class LoopObserver;
+  std::shared_ptr<LoopObserver> loopObserver_;
+
+  // Times fiber tasks between their suspension points
+  class FiberObserver;
+  std::unique_ptr<FiberObserver> fiberObserver_;
+
   // EventBase object for async event polling/scheduling
   folly::EventBase evb_;
 
@@ -152,12 +251,21 @@ class OpenrEventBase {
   folly::fibers::FiberManager& fiberManager_;
   std::vector<folly::Future<folly::Unit>> fiberTaskFutures_;
 
+#if FOLLY_HAS_COROUTINES
+  // Co-routine tasks run on evb_ and source of their cancellation
+  folly::CancellationSource cancellationSource_;
+  std::vector<folly::SemiFuture<folly::Unit>> coroTaskFutures_;
+#endif
+
   // Data structure to hold fd and their handlers
   std::unordered_map<int /* fd */, ZmqEventHandler> fdHandlers_;
 
   // Timestamp
   std::atomic<std::chrono::steady_clock::duration::rep> timestamp_;
   std::unique_ptr<folly::AsyncTimeout> timeout_;
+
+  // Time the health check timer is due next, to measure loop lag
+  std::chrono::steady_clock::time_point timeoutDue_{};
 };
 
 } // namespace openr
@@ -0,0 +1,225 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/common/Profiler.h>
+
+#include <signal.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/String.h>
+#include <folly/experimental/symbolizer/StackTrace.h>
+#include <folly/memory/MallctlHelper.h>
+#include <folly/memory/Malloc.h>
+#include <glog/logging.h>
+
+namespace openr {
+
+constexpr size_t CpuProfiler::kMaxDepth;
+constexpr size_t CpuProfiler::kMaxSamples;
+
+namespace {
+
+// Samples of the running profiler. Every sample takes a slot of
+// kMaxDepth + 1 words, depth of its stack trace followed by the frames
+struct SampleBuffer {
+  explicit SampleBuffer(size_t capacity)
+      : slots(capacity * (CpuProfiler::kMaxDepth + 1)), capacity(capacity) {}
+
+  std::vector<uintptr_t> slots;
+  const size_t capacity;
+  std::atomic<size_t> next{0};
+};
+
+// State shared with the signal handler
+std::atomic<bool> gRunning{false};
+std::atomic<SampleBuffer*> gBuffer{nullptr};
+std::atomic<int> gActiveHandlers{0};
+std::unique_ptr<SampleBuffer> gSamples;
+
+void
+onProfilingSignal(int /* signum */, siginfo_t* /* info */, void* /* ctx */) {
+  const int savedErrno = errno;
+  ++gActiveHandlers;
+  if (auto* buffer = gBuffer.load()) {
+    const auto index = buffer->next.fetch_add(1);
+    if (index < buffer->capacity) {
+      auto* slot = buffer->slots.data() + index * (CpuProfiler::kMaxDepth + 1);
+      const auto depth = folly::symbolizer::getStackTraceSafe(
+          slot + 1, CpuProfiler::kMaxDepth);
+      slot[0] = depth > 0 ? depth : 0;
+    }
+  }
+  --gActiveHandlers;
+  errno = savedErrno;
+}
+
+void
+setTimer(std::chrono::microseconds period) {
+  struct itimerval timer {};
+  timer.it_interval.tv_sec = period.count() / 1000000;
+  timer.it_interval.tv_usec = period.count() % 1000000;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    throw std::runtime_error(folly::sformat(
+        "Failed to set profiling timer: {}", folly::errnoStr(errno)));
+  }
+}
+
+} // namespace
+
+CpuProfiler::CpuProfiler(
+    int frequencyHz, std::chrono::milliseconds maxDuration)
+    : period_(std::chrono::microseconds(1000000 / std::max(1, frequencyHz))) {
+  bool expected{false};
+  if (not gRunning.compare_exchange_strong(expected, true)) {
+    throw std::runtime_error("Another CPU profile is being collected");
+  }
+
+  // Timer of process CPU time fires once per period for every busy core
+  const size_t numSamples = std::max(1, frequencyHz) *
+      std::max<int64_t>(1, (maxDuration.count() + 999) / 1000) *
+      std::max(1u, std::thread::hardware_concurrency());
+  gSamples = std::make_unique<SampleBuffer>(std::min(numSamples, kMaxSamples));
+
+  // NOTE: Handler stays installed once profiling stopped, as signals may
+  // still be pending. It ignores signals while there is no sample buffer
+  static const bool installed = []() {
+    struct sigaction action {};
+    action.sa_sigaction = onProfilingSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGPROF, &action, nullptr) == 0;
+  }();
+  if (not installed) {
+    gSamples.reset();
+    gRunning = false;
+    throw std::runtime_error("Failed to install SIGPROF handler");
+  }
+
+  gBuffer = gSamples.get();
+  try {
+    setTimer(period_);
+  } catch (const std::exception&) {
+    gBuffer = nullptr;
+    gSamples.reset();
+    gRunning = false;
+    throw;
+  }
+  running_ = true;
+  LOG(INFO) << "Started CPU profiler with period of " << period_.count()
+            << "us and room for " << gSamples->capacity << " samples";
+}
+
+CpuProfiler::~CpuProfiler() {
+  if (running_) {
+    stop();
+  }
+}
+
+std::string
+CpuProfiler::stop() {
+  if (not running_) {
+    throw std::runtime_error("CPU profiler is already stopped");
+  }
+
+  // Stop sampling and wait for handlers in flight
+  gBuffer = nullptr;
+  setTimer(std::chrono::microseconds(0));
+  while (gActiveHandlers.load() > 0) {
+    std::this_thread::yield();
+  }
+  auto samples = std::move(gSamples);
+  running_ = false;
+  gRunning = false;
+
+  // Aggregate samples by stack trace
+  const auto numSamples = std::min(samples->next.load(), samples->capacity);
+  std::map<std::vector<uintptr_t>, uint64_t> stacks;
+  for (size_t i = 0; i < numSamples; ++i) {
+    const auto* slot = samples->slots.data() + i * (kMaxDepth + 1);
+    if (slot[0] == 0) {
+      continue;
+    }
+    ++stacks[std::vector<uintptr_t>(slot + 1, slot + 1 + slot[0])];
+  }
+  LOG(INFO) << "Stopped CPU profiler with " << numSamples << " samples of "
+            << stacks.size() << " stack traces, dropped "
+            << samples->next.load() - numSamples;
+
+  // pprof resolves frames through mapping of binaries following profile
+  auto profile = serialize(period_, stacks);
+  std::string maps;
+  if (not folly::readFile("/proc/self/maps", maps)) {
+    throw std::runtime_error("Failed to read /proc/self/maps");
+  }
+  return profile + maps;
+}
+
+std::string
+CpuProfiler::serialize(
+    std::chrono::microseconds period,
+    const std::map<std::vector<uintptr_t>, uint64_t>& stacks) {
+  // Header: header count, header words, version, period, padding
+  std::vector<uintptr_t> words{
+      0, 3, 0, static_cast<uintptr_t>(period.count()), 0};
+  for (const auto& [stack, count] : stacks) {
+    words.emplace_back(count);
+    words.emplace_back(stack.size());
+    words.insert(words.end(), stack.begin(), stack.end());
+  }
+  // Trailer
+  words.insert(words.end(), {0, 1, 0});
+  return std::string(
+      reinterpret_cast<const char*>(words.data()),
+      words.size() * sizeof(uintptr_t));
+}
+
+std::string
+getHeapProfile() {
+  if (not folly::usingJEMalloc()) {
+    throw std::runtime_error("Heap profile requires jemalloc");
+  }
+  bool active{false};
+  try {
+    folly::mallctlRead("prof.active", &active);
+  } catch (const std::exception&) {
+    // jemalloc built without profiling
+  }
+  if (not active) {
+    throw std::runtime_error(
+        "Heap profiling of jemalloc is not active, start with "
+        "MALLOC_CONF=prof:true");
+  }
+
+  // jemalloc dumps profile to a file only
+  static std::atomic<uint64_t> numDumps{0};
+  const auto path = std::filesystem::temp_directory_path() /
+      folly::sformat("openr.{}.{}.heap", getpid(), numDumps++);
+  folly::mallctlWrite("prof.dump", path.c_str());
+  std::string profile;
+  const bool isRead = folly::readFile(path.c_str(), profile);
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  if (not isRead) {
+    throw std::runtime_error(
+        folly::sformat("Failed to read heap profile {}", path.string()));
+  }
+  return profile;
+}
+
+} // namespace openr
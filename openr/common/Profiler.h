@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace openr {
+
+/**
+ * Sampling CPU profiler of the process. Sends SIGPROF at the given frequency
+ * of CPU time, and records stack trace of the interrupted thread. Only one
+ * profiler can be running at a time.
+ *
+ * Profile is in legacy CPU profile format of gperftools, which is read by
+ * pprof e.g. `pprof --svg /path/to/openr profile`
+ */
+class CpuProfiler final {
+ public:
+  // Max number of frames of a recorded stack trace, and of recorded samples
+  static constexpr size_t kMaxDepth{64};
+  static constexpr size_t kMaxSamples{32768};
+
+  /**
+   * Starts sampling, with room for samples of at most maxDuration. Throws
+   * std::runtime_error if another profiler is running.
+   */
+  CpuProfiler(int frequencyHz, std::chrono::milliseconds maxDuration);
+
+  // Stops sampling if not stopped yet
+  ~CpuProfiler();
+
+  /**
+   * Stops sampling and returns the profile. Samples beyond capacity are
+   * dropped.
+   */
+  std::string stop();
+
+  /**
+   * Serialize number of samples by stack trace in legacy CPU profile format,
+   * without mapping of binaries which follows it
+   */
+  static std::string serialize(
+      std::chrono::microseconds period,
+      const std::map<std::vector<uintptr_t>, uint64_t>& stacks);
+
+ private:
+  CpuProfiler(CpuProfiler const&) = delete;
+  CpuProfiler& operator=(CpuProfiler const&) = delete;
+
+  const std::chrono::microseconds period_;
+  bool running_{false};
+};
+
+/**
+ * Dump heap profile of jemalloc, in its `heap_v2` format which is read by
+ * jeprof and pprof. Throws std::runtime_error if not running with jemalloc
+ * or its profiling isn't active, e.g. not started with `MALLOC_CONF=prof:true`
+ */
+std::string getHeapProfile();
+
+} // namespace openr
@@ -40,6 +40,40 @@ RegexSet::match(std::string const& key) const {
   return regexSet_->Match(key, &matches);
 }
 
+KeyPrefixTrie::KeyPrefixTrie(std::vector<std::string> const& prefixList) {
+  for (auto const& prefix : prefixList) {
+    uint32_t index = 0;
+    for (char c : prefix) {
+      auto it = nodes_[index].children.find(c);
+      if (it != nodes_[index].children.end()) {
+        index = it->second;
+        continue;
+      }
+      const uint32_t child = nodes_.size();
+      nodes_[index].children.emplace(c, child);
+      nodes_.emplace_back();
+      index = child;
+    }
+    nodes_[index].terminal = true;
+  }
+}
+
+bool
+KeyPrefixTrie::match(std::string const& key) const {
+  uint32_t index = 0;
+  for (char c : key) {
+    if (nodes_[index].terminal) {
+      return true;
+    }
+    auto it = nodes_[index].children.find(c);
+    if (it == nodes_[index].children.end()) {
+      return false;
+    }
+    index = it->second;
+  }
+  return nodes_[index].terminal;
+}
+
 PrefixKey::PrefixKey(
     std::string const& node,
     folly::CIDRNetwork const& prefix,
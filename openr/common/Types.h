@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -29,7 +30,10 @@ namespace openr {
 // Aliases for data-structures
 //
 using NodeAndArea = std::pair<std::string, std::string>;
-using PrefixEntries = std::unordered_map<NodeAndArea, thrift::PrefixEntry>;
+// Prefix entries are immutable once received and shared by reference to avoid
+// copies in route computation
+using PrefixEntries =
+    std::unordered_map<NodeAndArea, std::shared_ptr<thrift::PrefixEntry const>>;
 
 // KvStore URLs
 BOOST_STRONG_TYPEDEF(std::string, KvStoreGlobalCmdUrl);
@@ -84,6 +88,36 @@ class RegexSet {
   std::unique_ptr<re2::RE2::Set> regexSet_;
 };
 
+/**
+ * Trie of literal key prefixes. Matching a key is linear in the length of the
+ * key and independent of the number of prefixes.
+ */
+class KeyPrefixTrie {
+ public:
+  explicit KeyPrefixTrie(std::vector<std::string> const& prefixList);
+
+  /**
+   * Return true if any of the prefixes is a prefix of the key
+   */
+  bool match(std::string const& key) const;
+
+  bool
+  empty() const {
+    return not nodes_.front().terminal and nodes_.front().children.empty();
+  }
+
+ private:
+  struct Node {
+    // a prefix ends at this node
+    bool terminal{false};
+    // map<next-char: index of child in nodes_>
+    std::unordered_map<char, uint32_t> children;
+  };
+
+  // nodes_[0] is the root, i.e. empty prefix
+  std::vector<Node> nodes_{1};
+};
+
 /**
  * PrefixKey class to form and parse a PrefixKey. PrefixKey can be instantiated
  * by passing parameters to form a key, or by passing the key string to parse
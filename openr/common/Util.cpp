@@ -10,10 +10,20 @@
 #include <ifaddrs.h>
 #include <net/if.h>
 #include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <folly/compression/Compression.h>
+#include <folly/executors/thread_factory/InitThreadFactory.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/hash/FarmHash.h>
+#include <folly/hash/Hash.h>
+
+#include <openr/common/MemoryAllocator.h>
+
 #if __has_include("filesystem")
 #include <filesystem>
 namespace fs = std::filesystem;
@@ -255,7 +265,26 @@ getDurationBetweenPerfEvents(
 template <class T>
 int64_t
 generateHashImpl(
-    const int64_t version, const std::string& originatorId, const T& value) {
+    const int64_t version,
+    const std::string& originatorId,
+    const T& value,
+    thrift::KvStoreHashVersion hashVersion) {
+  if (hashVersion == thrift::KvStoreHashVersion::FINGERPRINT64) {
+    // ATTN: Fingerprint64 is guaranteed to be same on every platform, unlike
+    //       farmhash::Hash64, as hashes are compared between nodes
+    uint64_t seed = folly::hash::hash_128_to_64(
+        static_cast<uint64_t>(version),
+        folly::hash::farmhash::Fingerprint64(
+            originatorId.data(), originatorId.size()));
+    if (value.has_value()) {
+      seed = folly::hash::hash_128_to_64(
+          seed,
+          folly::hash::farmhash::Fingerprint64(
+              value.value().data(), value.value().size()));
+    }
+    return static_cast<int64_t>(seed);
+  }
+
   size_t seed = 0;
   boost::hash_combine(seed, version);
   boost::hash_combine(seed, originatorId);
@@ -269,16 +298,18 @@ int64_t
 generateHash(
     const int64_t version,
     const std::string& originatorId,
-    const std::optional<std::string>& value) {
-  return generateHashImpl(version, originatorId, value);
+    const std::optional<std::string>& value,
+    thrift::KvStoreHashVersion hashVersion) {
+  return generateHashImpl(version, originatorId, value, hashVersion);
 }
 
 int64_t
 generateHash(
     const int64_t version,
     const std::string& originatorId,
-    const apache::thrift::optional_field_ref<const std::string&> value) {
-  return generateHashImpl(version, originatorId, value);
+    const apache::thrift::optional_field_ref<const std::string&> value,
+    thrift::KvStoreHashVersion hashVersion) {
+  return generateHashImpl(version, originatorId, value, hashVersion);
 }
 
 std::string
@@ -430,6 +461,60 @@ getBuildInfoThrift() noexcept {
       BuildInfo::getBuildMode());
 }
 
+bool
+applyThreadConfig(const thrift::ThreadConfig& config) noexcept {
+  bool applied = true;
+  if (not config.cpus_ref()->empty()) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (const auto cpu : *config.cpus_ref()) {
+      if (cpu >= 0 and cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &cpus);
+      }
+    }
+    const auto ret =
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (ret != 0) {
+      LOG(ERROR) << "Failed to pin thread to cpus "
+                 << folly::join(",", *config.cpus_ref()) << ": "
+                 << folly::errnoStr(ret);
+      applied = false;
+    }
+  }
+
+  struct sched_param param {};
+  param.sched_priority = *config.sched_priority_ref();
+  const auto policy = static_cast<int>(*config.sched_policy_ref());
+  const auto ret = pthread_setschedparam(pthread_self(), policy, &param);
+  if (ret != 0) {
+    LOG(ERROR) << "Failed to set sched policy "
+               << apache::thrift::TEnumTraits<thrift::ThreadSchedPolicy>::
+                      findName(*config.sched_policy_ref())
+               << " with priority << param.sched_priority
+               << " of thread: " << folly::errnoStr(ret);
+    applied = false;
+  }
+
+  if (auto enableTcache = config.enable_tcache_ref()) {
+    applied &= setThreadCacheEnabled(*enableTcache);
+  }
+  return applied;
+}
+
+std::shared_ptr<folly::ThreadFactory>
+createThreadFactory(
+    const std::string& namePrefix,
+    const std::optional<thrift::ThreadConfig>& threadConfig) {
+  auto factory = std::make_shared<folly::NamedThreadFactory>(namePrefix);
+  if (not threadConfig) {
+    return factory;
+  }
+  return std::make_shared<folly::InitThreadFactory>(
+      std::move(factory), [threadConfig = *threadConfig]() noexcept {
+        applyThreadConfig(threadConfig);
+      });
+}
+
 std::pair<thrift::PrefixForwardingType, thrift::PrefixForwardingAlgorithm>
 getPrefixForwardingTypeAndAlgorithm(
     const PrefixEntries& prefixEntries,
@@ -447,8 +532,8 @@ getPrefixForwardingTypeAndAlgorithm(
     if (not bestNodeAreas.count(nodeAndArea)) {
       continue; // Skip the prefix-entry of non best node-area
     }
-    r.first = std::min(r.first, *prefixEntry.forwardingType_ref());
-    r.second = std::min(r.second, *prefixEntry.forwardingAlgorithm_ref());
+    r.first = std::min(r.first, *prefixEntry->forwardingType_ref());
+    r.second = std::min(r.second, *prefixEntry->forwardingAlgorithm_ref());
     // Optimization case for most common algorithm and forwarding type
     if (r.first == thrift::PrefixForwardingType::IP &&
         r.second == thrift::PrefixForwardingAlgorithm::SP_ECMP) {
@@ -683,6 +768,138 @@ createThriftValueWithoutBinaryValue(const thrift::Value& val) {
   return updatedVal;
 }
 
+thrift::ValueDelta
+createValueDelta(
+    const std::string& base, const std::string& value, int64_t baseHash) {
+  const size_t maxLen = std::min(base.size(), value.size());
+  size_t prefixLen = 0;
+  while (prefixLen < maxLen and base[prefixLen] == value[prefixLen]) {
+    ++prefixLen;
+  }
+  // ATTN: shared suffix must not overlap with shared prefix
+  size_t suffixLen = 0;
+  while (suffixLen < maxLen - prefixLen and
+         base[base.size() - suffixLen - 1] ==
+             value[value.size() - suffixLen - 1]) {
+    ++suffixLen;
+  }
+
+  thrift::ValueDelta delta;
+  delta.baseHash_ref() = baseHash;
+  delta.prefixLen_ref() = prefixLen;
+  delta.suffixLen_ref() = suffixLen;
+  *delta.data_ref() =
+      value.substr(prefixLen, value.size() - prefixLen - suffixLen);
+  return delta;
+}
+
+std::optional<std::string>
+applyValueDelta(const std::string& base, const thrift::ValueDelta& delta) {
+  const auto prefixLen = *delta.prefixLen_ref();
+  const auto suffixLen = *delta.suffixLen_ref();
+  if (prefixLen < 0 or suffixLen < 0 or
+      static_cast<size_t>(prefixLen) + suffixLen > base.size()) {
+    return std::nullopt;
+  }
+
+  std::string value;
+  value.reserve(prefixLen + delta.data_ref()->size() + suffixLen);
+  value.append(base, 0, prefixLen);
+  value.append(*delta.data_ref());
+  value.append(base, base.size() - suffixLen, suffixLen);
+  return value;
+}
+
+namespace {
+
+std::optional<folly::io::CodecType>
+toFollyCodecType(thrift::CompressionType codec) {
+  switch (codec) {
+  case thrift::CompressionType::ZSTD:
+    return folly::io::CodecType::ZSTD;
+  case thrift::CompressionType::LZ4:
+    return folly::io::CodecType::LZ4;
+  default:
+    return std::nullopt;
+  }
+}
+
+} // namespace
+
+std::optional<std::string>
+compressBuffer(const folly::IOBuf& buf, thrift::CompressionType codec) {
+  const auto codecType = toFollyCodecType(codec);
+  if (not codecType.has_value() or not folly::io::hasCodec(*codecType)) {
+    return std::nullopt;
+  }
+
+  // compress the chain as is, without flattening it into a string
+  std::string data;
+  try {
+    auto compressedBuf = folly::io::getCodec(*codecType)->compress(&buf);
+    data = compressedBuf->moveToFbString().toStdString();
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to compress buffer. " << folly::exceptionStr(e);
+    return std::nullopt;
+  }
+  if (data.size() >= buf.computeChainDataLength()) {
+    return std::nullopt;
+  }
+  return data;
+}
+
+std::optional<thrift::CompressedPublication>
+compressPublication(
+    const thrift::Publication& publication,
+    thrift::CompressionType codec,
+    size_t minSize) {
+  // skip serialization if publication won't be compressed anyway
+  const auto codecType = toFollyCodecType(codec);
+  if (not codecType.has_value() or not folly::io::hasCodec(*codecType)) {
+    return std::nullopt;
+  }
+
+  apache::thrift::CompactSerializer serializer;
+  const auto pubBuf = writeThriftObj(publication, serializer);
+  const auto pubSize = pubBuf->computeChainDataLength();
+  if (pubSize < minSize) {
+    return std::nullopt;
+  }
+
+  auto data = compressBuffer(*pubBuf, codec);
+  if (not data.has_value()) {
+    return std::nullopt;
+  }
+  thrift::CompressedPublication compressed;
+  *compressed.data_ref() = std::move(*data);
+  compressed.codec_ref() = codec;
+  compressed.uncompressedSize_ref() = pubSize;
+  return compressed;
+}
+
+std::optional<thrift::Publication>
+decompressPublication(const thrift::CompressedPublication& compressed) {
+  const auto codecType = toFollyCodecType(*compressed.codec_ref());
+  if (not codecType.has_value() or not folly::io::hasCodec(*codecType) or
+      *compressed.uncompressedSize_ref() < 0) {
+    return std::nullopt;
+  }
+
+  try {
+    // decode off the uncompressed buffer instead of a copy of it
+    const auto input = folly::IOBuf::wrapBufferAsValue(
+        folly::StringPiece(*compressed.data_ref()));
+    const auto pubBuf = folly::io::getCodec(*codecType)->uncompress(
+        &input, static_cast<uint64_t>(*compressed.uncompressedSize_ref()));
+    apache::thrift::CompactSerializer serializer;
+    return readThriftObj<thrift::Publication>(*pubBuf, serializer);
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to decompress publication. "
+               << folly::exceptionStr(e);
+    return std::nullopt;
+  }
+}
+
 /**
  * Utility function to create `key, value` pair for updating route in KvStore
  */
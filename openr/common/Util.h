@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -18,6 +20,9 @@
 #include <folly/Optional.h>
 #include <folly/ScopeGuard.h>
 #include <folly/String.h>
+#include <folly/executors/thread_factory/ThreadFactory.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/IOBufQueue.h>
 #include <glog/logging.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
@@ -151,17 +156,20 @@ getDurationBetweenPerfEvents(
 /**
  * Generate hash for each keyval pair
  * as a abstract of version number, originator and values
+ * in given hash scheme
  * TODO: Remove the API in favor of other one
  */
 int64_t generateHash(
     const int64_t version,
     const std::string& originatorId,
-    const std::optional<std::string>& value);
+    const std::optional<std::string>& value,
+    thrift::KvStoreHashVersion hashVersion = thrift::KvStoreHashVersion::BOOST);
 
 int64_t generateHash(
     const int64_t version,
     const std::string& originatorId,
-    const apache::thrift::optional_field_ref<const std::string&> value);
+    const apache::thrift::optional_field_ref<const std::string&> value,
+    thrift::KvStoreHashVersion hashVersion = thrift::KvStoreHashVersion::BOOST);
 
 /**
  * TO BE DEPRECATED SOON: Backward compatible with empty remoteIfName
@@ -181,6 +189,22 @@ thrift::RouteDatabaseDelta findDeltaRoutes(
 
 thrift::BuildInfo getBuildInfoThrift() noexcept;
 
+/**
+ * Pin calling thread to CPUs of config, set its scheduling policy and
+ * priority and enable or disable its jemalloc thread cache. Failures, e.g.
+ * real-time policy without CAP_SYS_NICE, are logged and leave the respective
+ * setting unchanged. Returns true if all applied.
+ */
+bool applyThreadConfig(const thrift::ThreadConfig& config) noexcept;
+
+/**
+ * Factory of named threads of helper thread pools, e.g. route computation
+ * workers, which apply threadConfig if any once they start
+ */
+std::shared_ptr<folly::ThreadFactory> createThreadFactory(
+    const std::string& namePrefix,
+    const std::optional<thrift::ThreadConfig>& threadConfig);
+
 /**
  * Get forwarding algorithm and type from list of prefixes. We're taking map as
  * input for efficiency purpose.
@@ -226,7 +250,67 @@ addJitter(T base, double pct = 20.0) {
 }
 
 /**
- * Utility functions for conversion between thrift objects and string/IOBuf
+ * Select page of paginated dump (see thrift::PageParams) from container.
+ * Entries are ordered by string key from `getKey`, entries without key are
+ * skipped. Page holds up to `pageSize` entries with keys after `cursor`.
+ * Return iterators to entries of page in order of their keys, and cursor of
+ * next page if more entries follow.
+ *
+ * Runs in linear time of container size and holds at most one page of keys,
+ * hence unordered containers are paginated without sorting them.
+ */
+template <class Container, class GetKey>
+std::pair<
+    std::vector<typename Container::const_iterator>,
+    std::optional<std::string>>
+selectPage(
+    Container const& entries,
+    GetKey&& getKey,
+    std::optional<std::string> const& cursor,
+    size_t pageSize) {
+  using Entry = std::pair<std::string, typename Container::const_iterator>;
+  const auto cmp = [](Entry const& a, Entry const& b) {
+    return a.first < b.first;
+  };
+  pageSize = std::max<size_t>(pageSize, 1);
+
+  // max-heap of smallest keys after cursor. One more than page to learn if
+  // more entries follow
+  std::vector<Entry> heap;
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    std::optional<std::string> key = getKey(*it);
+    if (not key.has_value() or (cursor.has_value() and *key <= *cursor)) {
+      continue;
+    }
+    if (heap.size() > pageSize) {
+      if (heap.front().first <= *key) {
+        continue;
+      }
+      std::pop_heap(heap.begin(), heap.end(), cmp);
+      heap.pop_back();
+    }
+    heap.emplace_back(std::move(*key), it);
+    std::push_heap(heap.begin(), heap.end(), cmp);
+  }
+  std::sort_heap(heap.begin(), heap.end(), cmp);
+
+  std::optional<std::string> nextCursor;
+  if (heap.size() > pageSize) {
+    heap.pop_back();
+    nextCursor = heap.back().first;
+  }
+  std::vector<typename Container::const_iterator> page;
+  page.reserve(heap.size());
+  for (auto& [_, it] : heap) {
+    page.emplace_back(it);
+  }
+  return std::make_pair(std::move(page), std::move(nextCursor));
+}
+
+/**
+ * Utility functions for conversion between thrift objects and string/IOBuf.
+ * IOBuf variants avoid copying the encoding into a contiguous string, prefer
+ * them wherever the consumer takes an IOBuf or iovec (compression, files).
  */
 
 template <typename ThriftType, typename Serializer>
@@ -237,14 +321,32 @@ writeThriftObjStr(ThriftType const& obj, Serializer& serializer) {
   return result;
 }
 
+template <typename ThriftType, typename Serializer>
+std::unique_ptr<folly::IOBuf>
+writeThriftObj(ThriftType const& obj, Serializer& serializer) {
+  folly::IOBufQueue queue(folly::IOBufQueue::cacheChainLength());
+  serializer.serialize(obj, &queue);
+  auto buf = queue.move();
+  return buf ? std::move(buf) : folly::IOBuf::create(0);
+}
+
 template <typename ThriftType, typename Serializer>
 ThriftType
-readThriftObj(folly::IOBuf& buf, Serializer& serializer) {
+readThriftObj(const folly::IOBuf& buf, Serializer& serializer) {
   ThriftType obj;
   serializer.deserialize(&buf, obj);
   return obj;
 }
 
+// Decode straight off memory of caller, e.g. receive buffer or mapped file
+template <typename ThriftType, typename Serializer>
+ThriftType
+readThriftObj(folly::ByteRange buf, Serializer& serializer) {
+  ThriftType obj;
+  serializer.deserialize(buf, obj);
+  return obj;
+}
+
 template <typename ThriftType, typename Serializer>
 ThriftType
 readThriftObjStr(const std::string& buf, Serializer& serializer) {
@@ -333,6 +435,43 @@ thrift::Value createThriftValue(
 
 thrift::Value createThriftValueWithoutBinaryValue(const thrift::Value& val);
 
+/**
+ * Compute delta of `value` against `base` value with hash `baseHash`. Delta
+ * carries bytes in between the longest common prefix and suffix of the two.
+ */
+thrift::ValueDelta createValueDelta(
+    const std::string& base, const std::string& value, int64_t baseHash);
+
+/**
+ * Reconstruct value by applying `delta` on top of `base`. Returns
+ * std::nullopt if delta can't be applied on the given base.
+ */
+std::optional<std::string> applyValueDelta(
+    const std::string& base, const thrift::ValueDelta& delta);
+
+/**
+ * Compress `buf` with `codec`. Returns std::nullopt if codec is not available,
+ * compression fails or doesn't reduce the size.
+ */
+std::optional<std::string> compressBuffer(
+    const folly::IOBuf& buf, thrift::CompressionType codec);
+
+/**
+ * Compress compact-serialized `publication` with `codec`. Returns std::nullopt
+ * if serialized publication is smaller than `minSize`, codec is not available
+ * or compression doesn't reduce the size.
+ */
+std::optional<thrift::CompressedPublication> compressPublication(
+    const thrift::Publication& publication,
+    thrift::CompressionType codec,
+    size_t minSize);
+
+/**
+ * Decompress and deserialize publication. Returns std::nullopt on failure.
+ */
+std::optional<thrift::Publication> decompressPublication(
+    const thrift::CompressedPublication& compressed);
+
 /**
  * Utility function to create `key, value` pair for updating route advertisement
  * in KvStore
@@ -409,13 +548,22 @@ std::string getNodeNameFromKey(const std::string& key);
  * key, if more than one keys are returned. Choosing a lowest key as the
  * representative, will be deterministic and easier for implementation.
  *
- * NOTE: MetricsWrapper is expected to provide following API
+ * NOTE: MetricsWrapper is expected to provide following API, or to be a
+ * shared_ptr to such type
  *   apache::thrift::field_ref<const thrift::PrefixMetrics&> metrics_ref();
  */
 template <typename Key, typename MetricsWrapper>
 std::set<Key> selectBestPrefixMetrics(
     std::unordered_map<Key, MetricsWrapper> const& prefixes);
 
+/**
+ * Lowest of the keys selectBestPrefixMetrics() would return, without building
+ * the set of them. std::nullopt if there are no prefixes.
+ */
+template <typename Key, typename MetricsWrapper>
+std::optional<Key> selectBestPrefixMetricsKey(
+    std::unordered_map<Key, MetricsWrapper> const& prefixes);
+
 // Deterministic choose one as best path from multipaths. Used in Decision.
 // Choose local if local node is a part of the multipaths.
 // Otherwise choose smallest key: allNodeAreas.begin().
@@ -470,39 +618,88 @@ CompareResult compareMetricVectors(
 
 namespace openr {
 
+namespace detail {
+template <typename MetricsWrapper>
+thrift::PrefixMetrics const&
+getPrefixMetrics(MetricsWrapper const& metricsWrapper) {
+  return metricsWrapper.metrics_ref().value();
+}
+
+template <typename MetricsWrapper>
+thrift::PrefixMetrics const&
+getPrefixMetrics(std::shared_ptr<MetricsWrapper> const& metricsWrapper) {
+  return metricsWrapper->metrics_ref().value();
+}
+
+/**
+ * Metrics packed into integers which order the same as the tuple
+ * {path_preference (prefer-higher), source_preference (prefer-higher),
+ * distance (prefer-lower)}, i.e. greater is better. Sign bits are flipped to
+ * order signed values as unsigned ones.
+ */
+using PackedPrefixMetrics = std::pair<uint64_t, uint32_t>;
+
+inline uint32_t
+biasMetric(int32_t metric) {
+  return static_cast<uint32_t>(metric) ^ 0x80000000u;
+}
+
+inline PackedPrefixMetrics
+packPrefixMetrics(thrift::PrefixMetrics const& metrics) {
+  return {(static_cast<uint64_t>(biasMetric(*metrics.path_preference_ref()))
+           << 32) |
+              biasMetric(*metrics.source_preference_ref()),
+          ~biasMetric(*metrics.distance_ref())};
+}
+} // namespace detail
+
 template <typename Key, typename MetricsWrapper>
 std::set<Key>
 selectBestPrefixMetrics(
     std::unordered_map<Key, MetricsWrapper> const& prefixes) {
-  // Leveraging tuple for ease of comparision
-  std::tuple<int32_t, int32_t, int32_t> bestMetricsTuple{
-      std::numeric_limits<int32_t>::min(),
-      std::numeric_limits<int32_t>::min(),
-      std::numeric_limits<int32_t>::min()};
+  // Most prefixes have a single advertiser
+  if (prefixes.size() <= 1) {
+    std::set<Key> bestKeys;
+    if (not prefixes.empty()) {
+      bestKeys.emplace(prefixes.begin()->first);
+    }
+    return bestKeys;
+  }
+
+  // Find best metrics first, then collect its keys. Keys of metrics beaten
+  // later on don't get inserted to the set only to be cleared
+  detail::PackedPrefixMetrics bestMetrics{0, 0};
+  for (auto& [_, metricsWrapper] : prefixes) {
+    bestMetrics = std::max(
+        bestMetrics,
+        detail::packPrefixMetrics(detail::getPrefixMetrics(metricsWrapper)));
+  }
   std::set<Key> bestKeys;
   for (auto& [key, metricsWrapper] : prefixes) {
-    auto& metrics = metricsWrapper.metrics_ref().value();
-    std::tuple<int32_t, int32_t, int32_t> metricsTuple{
-        metrics.path_preference_ref().value(), /* prefer-higher */
-        metrics.source_preference_ref().value(), /* prefer-higher */
-        metrics.distance_ref().value() * -1 /* prefer-lower */};
-
-    // Skip if this is less than best metrics we've seen so far
-    if (metricsTuple < bestMetricsTuple) {
-      continue;
+    if (detail::packPrefixMetrics(detail::getPrefixMetrics(metricsWrapper)) ==
+        bestMetrics) {
+      bestKeys.emplace(key);
     }
+  }
+  return bestKeys;
+}
 
-    // Clear set and update best metric if this is a new best metric
-    if (metricsTuple > bestMetricsTuple) {
-      bestMetricsTuple = metricsTuple;
-      bestKeys.clear();
+template <typename Key, typename MetricsWrapper>
+std::optional<Key>
+selectBestPrefixMetricsKey(
+    std::unordered_map<Key, MetricsWrapper> const& prefixes) {
+  Key const* bestKey{nullptr};
+  detail::PackedPrefixMetrics bestMetrics{0, 0};
+  for (auto& [key, metricsWrapper] : prefixes) {
+    const auto metrics =
+        detail::packPrefixMetrics(detail::getPrefixMetrics(metricsWrapper));
+    if (not bestKey or bestMetrics < metrics or
+        (bestMetrics == metrics and key < *bestKey)) {
+      bestMetrics = metrics;
+      bestKey = &key;
     }
-
-    // Current metrics is either best or same as best metrics we've seen so far
-    bestKeys.emplace(key);
   }
-
-  return bestKeys;
+  return bestKey ? std::make_optional(*bestKey) : std::nullopt;
 }
 
 } // namespace openr
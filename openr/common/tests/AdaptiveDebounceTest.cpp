@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <thread>
+
+#include <folly/io/async/EventBase.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/AdaptiveDebounce.h>
+
+namespace openr {
+
+using namespace std::chrono_literals;
+
+TEST(AdaptiveDebounce, BasicOperation) {
+  folly::EventBase evb;
+  int numRuns{0};
+  AdaptiveDebounce<std::chrono::milliseconds> debouncedFn(
+      &evb, 10ms, 100ms, [&numRuns]() noexcept { ++numRuns; });
+
+  // first event reacts fast, following events are batched
+  EXPECT_EQ(10ms, debouncedFn());
+  EXPECT_EQ(std::nullopt, debouncedFn());
+  evb.loop();
+  EXPECT_EQ(1, numRuns);
+
+  // events right after a run back off exponentially up to max
+  for (auto expectedDelay : {20ms, 40ms, 80ms, 100ms, 100ms}) {
+    EXPECT_EQ(expectedDelay, debouncedFn());
+    evb.loop();
+  }
+  EXPECT_EQ(6, numRuns);
+
+  // quiet period resets the delay
+  std::this_thread::sleep_for(100ms);
+  EXPECT_EQ(10ms, debouncedFn());
+  evb.loop();
+  EXPECT_EQ(7, numRuns);
+}
+
+TEST(AdaptiveDebounce, RunCost) {
+  folly::EventBase evb;
+  AdaptiveDebounce<std::chrono::milliseconds> debouncedFn(
+      &evb,
+      10ms,
+      1000ms,
+      []() noexcept { std::this_thread::sleep_for(50ms); },
+      2 /* costFactor */);
+
+  EXPECT_EQ(10ms, debouncedFn());
+  evb.loop();
+  EXPECT_GE(debouncedFn.getLastRunCost(), 50ms);
+
+  // delay is at least twice the cost of the previous run
+  auto delay = debouncedFn();
+  ASSERT_TRUE(delay.has_value());
+  EXPECT_GE(*delay, 2 * debouncedFn.getLastRunCost());
+  EXPECT_LE(*delay, 1000ms);
+  evb.loop();
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  return RUN_ALL_TESTS();
+}
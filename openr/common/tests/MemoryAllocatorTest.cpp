@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/types.h>
+
+#include <folly/init/Init.h>
+#include <folly/memory/MallctlHelper.h>
+#include <folly/memory/Malloc.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/MemoryAllocator.h>
+
+using namespace openr;
+
+TEST(MemoryAllocatorTest, Stats) {
+  const auto stats = getMemoryAllocatorStats();
+  if (not folly::usingJEMalloc()) {
+    EXPECT_FALSE(stats.has_value());
+    return;
+  }
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_LT(0, stats->allocated);
+  EXPECT_LE(stats->allocated, stats->active);
+  EXPECT_LE(stats->active, stats->resident);
+  EXPECT_LE(stats->active, stats->mapped);
+}
+
+TEST(MemoryAllocatorTest, ApplyConfig) {
+  thrift::MemoryAllocatorConfig config;
+  config.dirty_decay_ms_ref() = 5000;
+  config.muzzy_decay_ms_ref() = 0;
+  if (not folly::usingJEMalloc()) {
+    EXPECT_FALSE(applyMemoryAllocatorConfig(config));
+    EXPECT_FALSE(setThreadCacheEnabled(false));
+    return;
+  }
+  EXPECT_TRUE(applyMemoryAllocatorConfig(config));
+
+  // default of new arenas and existing arena of this thread are set
+  ssize_t decayMs{0};
+  folly::mallctlRead("arenas.dirty_decay_ms", &decayMs);
+  EXPECT_EQ(5000, decayMs);
+  folly::mallctlRead("arena.0.dirty_decay_ms", &decayMs);
+  EXPECT_EQ(5000, decayMs);
+  folly::mallctlRead("arena.0.muzzy_decay_ms", &decayMs);
+  EXPECT_EQ(0, decayMs);
+
+  // thread cache of calling thread
+  EXPECT_TRUE(setThreadCacheEnabled(false));
+  bool enabled{true};
+  folly::mallctlRead("thread.tcache.enabled", &enabled);
+  EXPECT_FALSE(enabled);
+  EXPECT_TRUE(setThreadCacheEnabled(true));
+  folly::mallctlRead("thread.tcache.enabled", &enabled);
+  EXPECT_TRUE(enabled);
+}
+
+int
+main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  folly::init(&argc, &argv);
+  return RUN_ALL_TESTS();
+}
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
 #include <sys/eventfd.h>
 
 #include <fbzmq/zmq/Context.h>
@@ -13,8 +15,12 @@
 #include <folly/init/Init.h>
 #include <folly/synchronization/Baton.h>
 #include <gtest/gtest.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/Sleep.h>
+#endif
 
 #include <openr/common/OpenrEventBase.h>
+#include <openr/messaging/ReplicateQueue.h>
 
 using namespace openr;
 
@@ -73,6 +79,48 @@ TEST(OpenrEventBaseTest, FiberTest) {
   EXPECT_TRUE(f.hasValue());
 }
 
+#if FOLLY_HAS_COROUTINES
+TEST(OpenrEventBaseTest, CoroTest) {
+  OpenrEventBase evb;
+  messaging::ReplicateQueue<int> queue;
+  std::vector<int> reads;
+  bool cancelled{false};
+
+  // Reader of two values from queue
+  auto readerCoro = [](messaging::RQueue<int> q,
+                       std::vector<int>& reads) -> folly::coro::Task<void> {
+    while (reads.size() < 2) {
+      auto maybeValue = co_await q.getCoro();
+      if (maybeValue.hasError()) {
+        break;
+      }
+      reads.emplace_back(maybeValue.value());
+    }
+  };
+  // Sleeper, completes early once stop() requests cancellation
+  auto sleeperCoro = [](bool& cancelled) -> folly::coro::Task<void> {
+    auto result = co_await folly::coro::co_awaitTry(
+        folly::coro::sleep(std::chrono::seconds(3600)));
+    cancelled = result.hasException<folly::OperationCancelled>();
+  };
+  evb.addCoroTask(readerCoro(queue.getReader(), reads));
+  evb.addCoroTask(sleeperCoro(cancelled));
+
+  std::thread evbThread([&]() { evb.run(); });
+  evb.waitUntilRunning();
+  queue.push(1);
+  queue.push(2);
+
+  // Waits for reader, after cancelling sleeper
+  evb.stop();
+  evb.waitUntilStopped();
+  evbThread.join();
+  EXPECT_EQ(std::vector<int>({1, 2}), reads);
+  EXPECT_TRUE(cancelled);
+  EXPECT_TRUE(evb.getCancellationToken().isCancellationRequested());
+}
+#endif
+
 TEST(OpenrEventBaseTest, RunnableApi) {
   OpenrEventBase evb;
 
@@ -158,6 +206,40 @@ TEST_F(OpenrEventBaseTestFixture, TimeoutTest) {
   EXPECT_LE(std::chrono::milliseconds(200), elapsedMs);
 }
 
+TEST_F(OpenrEventBaseTestFixture, LoopStatsTest) {
+  evb.getAndResetLoopStats();
+
+  // Block loop for longer than interval of health check timer
+  folly::Baton waitBaton;
+  evb.runInEventBaseThread([&]() noexcept {
+    evb.addFiberTask([]() noexcept {});
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+    waitBaton.post();
+  });
+  waitBaton.wait();
+
+  // Let overdue health check timer fire
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  auto stats = evb.getAndResetLoopStats();
+  EXPECT_GE(stats.busyTimeUs, 1200 * 1000);
+  ASSERT_FALSE(stats.loopLagMs.empty());
+  EXPECT_GE(
+      *std::max_element(stats.loopLagMs.begin(), stats.loopLagMs.end()), 100);
+  EXPECT_GE(stats.numFiberRuns, 1);
+
+  // Blocking callback is the slowest one, named by its call site
+  ASSERT_FALSE(stats.slowestCallbacksUs.empty());
+  EXPECT_EQ(
+      0, stats.slowestCallbacksUs.front().first.find("OpenrEventBaseTest"));
+  EXPECT_GE(stats.slowestCallbacksUs.front().second, 1200 * 1000);
+
+  // Stats are reset once read
+  EXPECT_TRUE(evb.getAndResetLoopStats().slowestCallbacksUs.empty());
+}
+
 TEST_F(OpenrEventBaseTestFixture, ZmqSocketPollTest) {
   const auto msg = fbzmq::Message::from(std::string("test message")).value();
   const size_t expectedMsgs{16};
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <cstring>
+
+#include <folly/init/Init.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/Profiler.h>
+
+using namespace openr;
+
+namespace {
+
+// Words of legacy CPU profile, without mapping of binaries
+std::vector<uintptr_t>
+toWords(const std::string& profile, size_t numWords) {
+  std::vector<uintptr_t> words(numWords);
+  EXPECT_LE(numWords * sizeof(uintptr_t), profile.size());
+  std::memcpy(words.data(), profile.data(), numWords * sizeof(uintptr_t));
+  return words;
+}
+
+} // namespace
+
+TEST(ProfilerTest, SerializeCpuProfile) {
+  std::map<std::vector<uintptr_t>, uint64_t> stacks;
+  stacks[{0x10, 0x20}] = 3;
+  stacks[{0x30}] = 1;
+
+  const auto profile =
+      CpuProfiler::serialize(std::chrono::microseconds(10000), stacks);
+  EXPECT_EQ(15 * sizeof(uintptr_t), profile.size());
+  EXPECT_EQ(
+      std::vector<uintptr_t>(
+          {0, 3, 0, 10000, 0, 3, 2, 0x10, 0x20, 1, 1, 0x30, 0, 1, 0}),
+      toWords(profile, 15));
+}
+
+TEST(ProfilerTest, CpuProfile) {
+  CpuProfiler profiler(1000, std::chrono::seconds(1));
+
+  // Only one profiler at a time
+  EXPECT_THROW(
+      CpuProfiler(1000, std::chrono::seconds(1)), std::runtime_error);
+
+  // Burn CPU for a while
+  const auto start = std::chrono::steady_clock::now();
+  volatile uint64_t sum{0};
+  while (std::chrono::steady_clock::now() - start <
+         std::chrono::milliseconds(200)) {
+    sum = sum + 1;
+  }
+
+  // Header with period, samples and trailer followed by mapping of binaries
+  const auto profile = profiler.stop();
+  const auto header = toWords(profile, 5);
+  EXPECT_EQ(std::vector<uintptr_t>({0, 3, 0, 1000, 0}), header);
+  EXPECT_NE(std::string::npos, profile.find("r-xp"));
+  EXPECT_THROW(profiler.stop(), std::runtime_error);
+
+  // A new profiler can be started once stopped
+  CpuProfiler another(100, std::chrono::seconds(1));
+  EXPECT_FALSE(another.stop().empty());
+}
+
+int
+main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  folly::init(&argc, &argv);
+  return RUN_ALL_TESTS();
+}
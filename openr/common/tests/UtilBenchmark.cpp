@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+
+#include <openr/common/Util.h>
+
+namespace openr {
+
+/**
+ * Prefix entries of numEntries advertisers. Every other advertiser has the
+ * best metrics, the rest loses on distance.
+ */
+std::unordered_map<NodeAndArea, std::shared_ptr<thrift::PrefixEntry const>>
+createPrefixEntries(size_t numEntries) {
+  std::unordered_map<NodeAndArea, std::shared_ptr<thrift::PrefixEntry const>>
+      entries;
+  for (size_t i = 0; i < numEntries; ++i) {
+    auto entry = std::make_shared<thrift::PrefixEntry>();
+    entry->metrics_ref()->path_preference_ref() = 1000;
+    entry->metrics_ref()->source_preference_ref() = 200;
+    entry->metrics_ref()->distance_ref() = i % 2;
+    entries.emplace(
+        NodeAndArea{folly::sformat("node-{}", i), "area"}, std::move(entry));
+  }
+  return entries;
+}
+
+/**
+ * Benchmark for best route selection of numPrefixes prefixes of numEntries
+ * advertisers each, as done by Decision on route computation
+ */
+static void
+BM_SelectBestPrefixMetrics(
+    uint32_t iters, size_t numPrefixes, size_t numEntries) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto entries = createPrefixEntries(numEntries);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    for (size_t j = 0; j < numPrefixes; ++j) {
+      folly::doNotOptimizeAway(selectBestPrefixMetrics(entries));
+    }
+  }
+}
+
+/**
+ * Benchmark for selection of the best key only, as done by PrefixManager on
+ * sync of its prefixes to KvStore
+ */
+static void
+BM_SelectBestPrefixMetricsKey(
+    uint32_t iters, size_t numPrefixes, size_t numEntries) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto entries = createPrefixEntries(numEntries);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    for (size_t j = 0; j < numPrefixes; ++j) {
+      folly::doNotOptimizeAway(selectBestPrefixMetricsKey(entries));
+    }
+  }
+}
+
+// The first parameter is number of prefixes and the second one is number of
+// advertisers of every prefix
+BENCHMARK_NAMED_PARAM(BM_SelectBestPrefixMetrics, 1000_1, 1000, 1);
+BENCHMARK_NAMED_PARAM(BM_SelectBestPrefixMetrics, 1000_2, 1000, 2);
+BENCHMARK_NAMED_PARAM(BM_SelectBestPrefixMetrics, 1000_8, 1000, 8);
+BENCHMARK_NAMED_PARAM(BM_SelectBestPrefixMetrics, 1000_64, 1000, 64);
+
+BENCHMARK_NAMED_PARAM(BM_SelectBestPrefixMetricsKey, 1000_1, 1000, 1);
+BENCHMARK_NAMED_PARAM(BM_SelectBestPrefixMetricsKey, 1000_2, 1000, 2);
+BENCHMARK_NAMED_PARAM(BM_SelectBestPrefixMetricsKey, 1000_8, 1000, 8);
+BENCHMARK_NAMED_PARAM(BM_SelectBestPrefixMetricsKey, 1000_64, 1000, 64);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -127,6 +127,54 @@ TEST(UtilTest, NetworkUtilTest) {
   EXPECT_EQ("", toString(empty));
 }
 
+TEST(UtilTest, PackedPrefixTest) {
+  for (const auto& str : {"10.1.0.0/16", "0.0.0.0/0", "fc00:1::/64", "::/0"}) {
+    const auto network = folly::IPAddress::createNetwork(str);
+    const PackedPrefix prefix(network);
+    EXPECT_EQ(network.first.isV4(), prefix.isV4());
+    EXPECT_EQ(network.second, prefix.length());
+    EXPECT_EQ(network, prefix.toCIDRNetwork());
+    EXPECT_EQ(toIpPrefix(network), prefix.toThrift());
+    EXPECT_EQ(prefix, PackedPrefix(toIpPrefix(network)));
+    EXPECT_EQ(folly::IPAddress::networkToString(network), prefix.str());
+    EXPECT_EQ(toString(toIpPrefix(network)), toString(prefix));
+  }
+
+  // IPv4 and IPv4-mapped IPv6 prefixes differ, so do lengths
+  const PackedPrefix v4(folly::IPAddress::createNetwork("10.0.0.0/8"));
+  const PackedPrefix v6(folly::IPAddress::createNetwork("::ffff:10.0.0.0/104"));
+  const PackedPrefix v4Longer(folly::IPAddress::createNetwork("10.0.0.0/16"));
+  EXPECT_NE(v4, v6);
+  EXPECT_NE(v4, v4Longer);
+  EXPECT_TRUE(v4 < v6);
+  EXPECT_TRUE(v4 < v4Longer);
+  std::unordered_set<PackedPrefix> prefixes{v4, v6, v4Longer, v4};
+  EXPECT_EQ(3, prefixes.size());
+
+  // no mask gets applied unless asked for
+  const PackedPrefix host(
+      folly::IPAddress::createNetwork("10.1.2.3/12", -1, false));
+  EXPECT_EQ(
+      folly::IPAddress::createNetwork("10.1.2.3/12", -1, false),
+      host.toCIDRNetwork());
+  EXPECT_EQ(
+      folly::IPAddress::createNetwork("10.0.0.0/12"),
+      host.masked().toCIDRNetwork());
+  const auto v6Host = toIpPrefix(
+      folly::IPAddress::createNetwork("fc00:1:2:3::1/62", -1, false));
+  EXPECT_EQ(
+      toIPNetwork(v6Host), PackedPrefix(v6Host).masked().toCIDRNetwork());
+
+  // malformed prefixes
+  thrift::IpPrefix malformed;
+  EXPECT_THROW(PackedPrefix{malformed}, std::invalid_argument);
+  EXPECT_FALSE(PackedPrefix::tryFrom(malformed).has_value());
+  malformed = toIpPrefix("10.0.0.0/8");
+  malformed.prefixLength_ref() = 33;
+  EXPECT_FALSE(PackedPrefix::tryFrom(malformed).has_value());
+  EXPECT_TRUE(PackedPrefix::tryFrom(toIpPrefix("10.0.0.0/8")).has_value());
+}
+
 TEST(UtilTest, PrefixKeyTest) {
   std::vector<PrefixKeyEntry> strToItems;
 
@@ -624,15 +672,31 @@ TEST(UtilTest, MplsActionValidate) {
 
 TEST(UtilTest, getPrefixForwardingTypeAndAlgorithm) {
   PrefixEntries prefixes;
+  // prefix entries are immutable, replace them to update an attribute
+  auto setType = [&prefixes](std::string const& node, FwdType type) {
+    auto entry = *prefixes.at({node, "area1"});
+    entry.forwardingType_ref() = type;
+    prefixes[{node, "area1"}] =
+        std::make_shared<thrift::PrefixEntry const>(std::move(entry));
+  };
+  auto setAlgo = [&prefixes](std::string const& node, FwdAlgo algo) {
+    auto entry = *prefixes.at({node, "area1"});
+    entry.forwardingAlgorithm_ref() = algo;
+    prefixes[{node, "area1"}] =
+        std::make_shared<thrift::PrefixEntry const>(std::move(entry));
+  };
 
   // Default case (empty entries)
   EXPECT_EQ(
       (std::make_pair<FwdType, FwdAlgo>(FwdType::IP, FwdAlgo::SP_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, {}));
 
-  prefixes[{"node1", "area1"}] = createPrefixEntry(toIpPrefix("10.0.0.0/8"));
-  prefixes[{"node2", "area1"}] = createPrefixEntry(toIpPrefix("10.0.0.0/8"));
-  prefixes[{"node3", "area1"}] = createPrefixEntry(toIpPrefix("10.0.0.0/8"));
+  prefixes[{"node1", "area1"}] = std::make_shared<thrift::PrefixEntry const>(
+      createPrefixEntry(toIpPrefix("10.0.0.0/8")));
+  prefixes[{"node2", "area1"}] = std::make_shared<thrift::PrefixEntry const>(
+      createPrefixEntry(toIpPrefix("10.0.0.0/8")));
+  prefixes[{"node3", "area1"}] = std::make_shared<thrift::PrefixEntry const>(
+      createPrefixEntry(toIpPrefix("10.0.0.0/8")));
 
   std::set<NodeAndArea> bestNodeAreas = {
       {"node1", "area1"}, {"node2", "area1"}, {"node3", "area1"}};
@@ -641,7 +705,7 @@ TEST(UtilTest, getPrefixForwardingTypeAndAlgorithm) {
       (std::make_pair<FwdType, FwdAlgo>(FwdType::IP, FwdAlgo::SP_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, bestNodeAreas));
 
-  prefixes[{"node3", "area1"}].forwardingType_ref() = FwdType::SR_MPLS;
+  setType("node3", FwdType::SR_MPLS);
   EXPECT_EQ(
       (std::make_pair<FwdType, FwdAlgo>(FwdType::IP, FwdAlgo::SP_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, bestNodeAreas));
@@ -650,18 +714,17 @@ TEST(UtilTest, getPrefixForwardingTypeAndAlgorithm) {
       (std::make_pair<FwdType, FwdAlgo>(FwdType::SR_MPLS, FwdAlgo::SP_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, {{"node3", "area1"}}));
 
-  prefixes[{"node2", "area1"}].forwardingType_ref() = FwdType::SR_MPLS;
+  setType("node2", FwdType::SR_MPLS);
   EXPECT_EQ(
       (std::make_pair<FwdType, FwdAlgo>(FwdType::IP, FwdAlgo::SP_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, bestNodeAreas));
 
-  prefixes[{"node1", "area1"}].forwardingType_ref() = FwdType::SR_MPLS;
+  setType("node1", FwdType::SR_MPLS);
   EXPECT_EQ(
       (std::make_pair<FwdType, FwdAlgo>(FwdType::SR_MPLS, FwdAlgo::SP_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, bestNodeAreas));
 
-  prefixes[{"node3", "area1"}].forwardingAlgorithm_ref() =
-      FwdAlgo::KSP2_ED_ECMP;
+  setAlgo("node3", FwdAlgo::KSP2_ED_ECMP);
   EXPECT_EQ(
       (std::make_pair<FwdType, FwdAlgo>(FwdType::SR_MPLS, FwdAlgo::SP_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, bestNodeAreas));
@@ -671,14 +734,12 @@ TEST(UtilTest, getPrefixForwardingTypeAndAlgorithm) {
           FwdType::SR_MPLS, FwdAlgo::KSP2_ED_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, {{"node3", "area1"}}));
 
-  prefixes[{"node2", "area1"}].forwardingAlgorithm_ref() =
-      FwdAlgo::KSP2_ED_ECMP;
+  setAlgo("node2", FwdAlgo::KSP2_ED_ECMP);
   EXPECT_EQ(
       (std::make_pair<FwdType, FwdAlgo>(FwdType::SR_MPLS, FwdAlgo::SP_ECMP)),
       getPrefixForwardingTypeAndAlgorithm(prefixes, bestNodeAreas));
 
-  prefixes[{"node1", "area1"}].forwardingAlgorithm_ref() =
-      FwdAlgo::KSP2_ED_ECMP;
+  setAlgo("node1", FwdAlgo::KSP2_ED_ECMP);
   EXPECT_EQ(
       (std::make_pair<FwdType, FwdAlgo>(
           FwdType::SR_MPLS, FwdAlgo::KSP2_ED_ECMP)),
@@ -856,6 +917,180 @@ TEST(UtilTest, AddJitter) {
       t2_jitter_s <= (1 + pct / 100.0) * t2_jitter_s);
 }
 
+TEST(UtilTest, GenerateHashVersionTest) {
+  const std::optional<std::string> value{std::string(4096, 'a')};
+  const std::optional<std::string> otherValue{std::string(4096, 'b')};
+  for (auto hashVersion :
+       {thrift::KvStoreHashVersion::BOOST,
+        thrift::KvStoreHashVersion::FINGERPRINT64}) {
+    const auto hash = generateHash(1, "node1", value, hashVersion);
+    EXPECT_EQ(hash, generateHash(1, "node1", value, hashVersion));
+    // every part of tuple<version, originatorId, value> is hashed
+    EXPECT_NE(hash, generateHash(2, "node1", value, hashVersion));
+    EXPECT_NE(hash, generateHash(1, "node2", value, hashVersion));
+    EXPECT_NE(hash, generateHash(1, "node1", otherValue, hashVersion));
+    EXPECT_NE(hash, generateHash(1, "node1", std::nullopt, hashVersion));
+  }
+
+  // legacy scheme is the default
+  EXPECT_EQ(
+      generateHash(1, "node1", value),
+      generateHash(1, "node1", value, thrift::KvStoreHashVersion::BOOST));
+  EXPECT_NE(
+      generateHash(1, "node1", value, thrift::KvStoreHashVersion::BOOST),
+      generateHash(
+          1, "node1", value, thrift::KvStoreHashVersion::FINGERPRINT64));
+}
+
+TEST(UtilTest, ValueDeltaTest) {
+  auto verifyDelta = [](std::string const& base, std::string const& value) {
+    auto delta = createValueDelta(base, value, 123 /* baseHash */);
+    EXPECT_EQ(123, *delta.baseHash_ref());
+    EXPECT_EQ(
+        value.size(),
+        *delta.prefixLen_ref() + delta.data_ref()->size() +
+            *delta.suffixLen_ref());
+    EXPECT_EQ(value, applyValueDelta(base, delta));
+    return delta;
+  };
+
+  // single byte change in the middle
+  auto delta = verifyDelta("aaaaXaaaa", "aaaaYaaaa");
+  EXPECT_EQ(4, *delta.prefixLen_ref());
+  EXPECT_EQ(4, *delta.suffixLen_ref());
+  EXPECT_EQ("Y", *delta.data_ref());
+
+  // shared prefix and suffix must not overlap
+  delta = verifyDelta("aaaa", "aaaaaa");
+  EXPECT_EQ(4, *delta.prefixLen_ref());
+  EXPECT_EQ(0, *delta.suffixLen_ref());
+  delta = verifyDelta("aaaaaa", "aaaa");
+  EXPECT_EQ("", *delta.data_ref());
+
+  // identical, empty and completely different values
+  verifyDelta("abc", "abc");
+  verifyDelta("", "abc");
+  verifyDelta("abc", "");
+  verifyDelta("abc", "xyz");
+
+  // delta not applicable on shorter base
+  delta = createValueDelta("aaaaXaaaa", "aaaaYaaaa", 0);
+  EXPECT_FALSE(applyValueDelta("aaaa", delta).has_value());
+}
+
+TEST(UtilTest, CompressPublicationTest) {
+  std::unordered_map<std::string, thrift::Value> keyVals;
+  for (int i = 0; i < 100; ++i) {
+    keyVals.emplace(
+        folly::sformat("adj:node{}", i),
+        createThriftValue(1, "node1", std::string(100, 'a'), 1000));
+  }
+  const auto pub = createThriftPublication(keyVals, {}, std::nullopt);
+
+  // no compression for NONE codec or below size threshold
+  EXPECT_FALSE(
+      compressPublication(pub, thrift::CompressionType::NONE, 0).has_value());
+  EXPECT_FALSE(compressPublication(
+                   pub, thrift::CompressionType::ZSTD, 1024 * 1024)
+                   .has_value());
+
+  for (auto codec :
+       {thrift::CompressionType::ZSTD, thrift::CompressionType::LZ4}) {
+    auto compressed = compressPublication(pub, codec, 0);
+    ASSERT_TRUE(compressed.has_value());
+    EXPECT_EQ(codec, *compressed->codec_ref());
+    EXPECT_LT(
+        compressed->data_ref()->size(),
+        static_cast<size_t>(*compressed->uncompressedSize_ref()));
+
+    auto decompressed = decompressPublication(*compressed);
+    ASSERT_TRUE(decompressed.has_value());
+    EXPECT_EQ(pub, *decompressed);
+
+    // corrupted data
+    compressed->data_ref()->resize(compressed->data_ref()->size() / 2);
+    EXPECT_FALSE(decompressPublication(*compressed).has_value());
+  }
+}
+
+TEST(UtilTest, ThriftObjIOBufTest) {
+  apache::thrift::CompactSerializer serializer;
+  std::unordered_map<std::string, thrift::Value> keyVals;
+  for (int i = 0; i < 100; ++i) {
+    keyVals.emplace(
+        folly::sformat("adj:node{}", i),
+        createThriftValue(1, "node1", std::string(100, 'a'), 1000));
+  }
+  const auto pub = createThriftPublication(keyVals, {}, std::nullopt);
+
+  // IOBuf encoding is the same as string encoding
+  const auto buf = writeThriftObj(pub, serializer);
+  const auto str = writeThriftObjStr(pub, serializer);
+  EXPECT_EQ(str, buf->cloneCoalescedAsValue().moveToFbString().toStdString());
+
+  EXPECT_EQ(pub, readThriftObj<thrift::Publication>(*buf, serializer));
+  EXPECT_EQ(
+      pub,
+      readThriftObj<thrift::Publication>(
+          folly::ByteRange(folly::StringPiece(str)), serializer));
+}
+
+TEST(UtilTest, SelectPage) {
+  std::unordered_map<int, std::string> entries;
+  for (int i = 0; i < 25; ++i) {
+    entries.emplace(i, folly::sformat("key-{:02}", i));
+  }
+  // odd entries only
+  auto getKey = [](auto const& kv) -> std::optional<std::string> {
+    return kv.first % 2 ? std::make_optional(kv.second) : std::nullopt;
+  };
+
+  //
+  // Iterate pages until no cursor is returned, all selected entries are
+  // returned exactly once and in order
+  //
+  std::vector<int> selected;
+  std::optional<std::string> cursor;
+  size_t numPages{0};
+  do {
+    auto [page, nextCursor] = selectPage(entries, getKey, cursor, 5);
+    EXPECT_LE(page.size(), 5);
+    for (auto const& it : page) {
+      selected.emplace_back(it->first);
+    }
+    if (nextCursor.has_value()) {
+      ASSERT_FALSE(page.empty());
+      EXPECT_EQ(page.back()->second, *nextCursor);
+    }
+    cursor = std::move(nextCursor);
+    ++numPages;
+  } while (cursor.has_value());
+  EXPECT_EQ(3, numPages);
+  EXPECT_EQ(
+      std::vector<int>({1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23}), selected);
+
+  //
+  // Page as large as remaining entries is the last one
+  //
+  {
+    auto [page, nextCursor] =
+        selectPage(entries, getKey, std::string("key-13"), 5);
+    EXPECT_EQ(5, page.size());
+    EXPECT_EQ(15, page.front()->first);
+    EXPECT_FALSE(nextCursor.has_value());
+  }
+
+  //
+  // Cursor after all entries
+  //
+  {
+    auto [page, nextCursor] =
+        selectPage(entries, getKey, std::string("key-99"), 5);
+    EXPECT_TRUE(page.empty());
+    EXPECT_FALSE(nextCursor.has_value());
+  }
+}
+
 TEST(UtilTest, BestMetricsSelection) {
   auto createMetrics = [](int32_t pp, int32_t sp, int32_t d) {
     thrift::PrefixEntry prefixEntry;
@@ -961,6 +1196,47 @@ TEST(UtilTest, BestMetricsSelection) {
         std::make_pair<std::string, std::string>("node2", "area1");
     EXPECT_EQ(node2bestKey, selectBestNodeArea(bestKeys, "node2"));
   }
+
+  //
+  // Negative and extreme metrics order as signed values
+  //
+  {
+    const auto kMin = std::numeric_limits<int32_t>::min();
+    const auto kMax = std::numeric_limits<int32_t>::max();
+    std::unordered_map<std::string, thrift::PrefixEntry> prefixes = {
+        {"KEY1", createMetrics(-1, kMax, kMin)},
+        {"KEY2", createMetrics(0, kMin, kMax)},
+        {"KEY3", createMetrics(0, kMin, -5)},
+        {"KEY4", createMetrics(kMin, kMax, kMin)}};
+    const auto bestKeys = selectBestPrefixMetrics(prefixes);
+    EXPECT_EQ(1, bestKeys.size());
+    EXPECT_EQ(1, bestKeys.count("KEY3"));
+  }
+}
+
+TEST(UtilTest, SelectBestPrefixMetricsKeyTest) {
+  auto createMetrics = [](int32_t pp, int32_t sp, int32_t d) {
+    thrift::PrefixEntry prefixEntry;
+    prefixEntry.metrics_ref()->path_preference_ref() = pp;
+    prefixEntry.metrics_ref()->source_preference_ref() = sp;
+    prefixEntry.metrics_ref()->distance_ref() = d;
+    return prefixEntry;
+  };
+
+  std::unordered_map<std::string, thrift::PrefixEntry> prefixes;
+  EXPECT_FALSE(selectBestPrefixMetricsKey(prefixes).has_value());
+
+  // Lowest of the best keys
+  prefixes = {
+      {"KEY5", createMetrics(100, 10, 1)},
+      {"KEY2", createMetrics(100, 10, 2)},
+      {"KEY3", createMetrics(100, 10, 1)},
+      {"KEY4", createMetrics(100, 10, 1)},
+      {"KEY1", createMetrics(100, 10, 2)}};
+  EXPECT_EQ("KEY3", selectBestPrefixMetricsKey(prefixes));
+  EXPECT_EQ(
+      *selectBestPrefixMetrics(prefixes).begin(),
+      selectBestPrefixMetricsKey(prefixes));
 }
 
 int
@@ -7,20 +7,67 @@
 
 #include "PersistentStore.h"
 
+#include <sys/stat.h>
+#include <algorithm>
 #include <chrono>
 
+#include <fb303/ServiceData.h>
 #include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/container/F14Map.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
 #include <folly/io/IOBuf.h>
+#include <folly/lang/Bits.h>
+#include <folly/system/MemoryMapping.h>
 
 #include <openr/common/Util.h>
 
+namespace fb303 = facebook::fb303;
+
 using std::exception;
 
 namespace {
 
-static const long kDbFlushRatio = 10000;
+// View of encoded PersistentObject, pointing into buffer it is decoded from
+struct PersistentObjectView {
+  openr::ActionType type;
+  folly::StringPiece key;
+  folly::StringPiece data;
+};
+
+// Decode PersistentObject at the front of data without copying it, see
+// PersistentStore::encodePersistentObject. Returns nullopt if data doesn't
+// hold complete object
+std::optional<PersistentObjectView>
+decodePersistentObjectView(folly::ByteRange& data) {
+  auto readString = [&data](folly::StringPiece& str) {
+    if (data.size() < sizeof(uint32_t)) {
+      return false;
+    }
+    const auto length =
+        folly::Endian::big(folly::loadUnaligned<uint32_t>(data.data()));
+    data.advance(sizeof(uint32_t));
+    if (data.size() < length) {
+      return false;
+    }
+    str = folly::StringPiece(data.subpiece(0, length));
+    data.advance(length);
+    return true;
+  };
+
+  if (data.empty()) {
+    return std::nullopt;
+  }
+  PersistentObjectView object;
+  object.type = openr::ActionType(data.front());
+  data.advance(sizeof(uint8_t));
+  if (not readString(object.key) or not readString(object.data)) {
+    return std::nullopt;
+  }
+  return object;
+}
 
-} // anonymous namespace
+} // namespace
 
 namespace openr {
 
@@ -28,7 +75,24 @@ PersistentStore::PersistentStore(
     const std::string& storageFilePath,
     bool dryrun,
     bool periodicallySaveToDisk)
-    : storageFilePath_(storageFilePath), dryrun_(dryrun) {
+    : storageFilePath_(storageFilePath),
+      compactionFilePath_(storageFilePath + ".compaction"),
+      dryrun_(dryrun) {
+  if (not dryrun_) {
+    ioExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        1, std::make_shared<folly::NamedThreadFactory>("PersistentStoreIo"));
+  }
+
+  // Initialize stat keys
+  fb303::fbData->addStatExportType(
+      "persistent_store.commit_duration_ms", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "persistent_store.commit_bytes", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "persistent_store.commit_failures", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "persistent_store.compaction_duration_ms", fb303::AVG);
+
   if (periodicallySaveToDisk) {
     // Create timer and backoff mechanism only if backoff is requested
     saveDbTimerBackoff_ =
@@ -54,10 +118,30 @@ PersistentStore::PersistentStore(
     LOG(ERROR) << "Failed to load config-database from file: "
                << storageFilePath_;
   }
+  for (const auto& [key, value] : *database_.keyVals_ref()) {
+    databaseBytes_ += getEncodedSize(key, value);
+  }
+  std::error_code ec;
+  logBytes_ = fs::exists(storageFilePath_, ec)
+      ? fs::file_size(storageFilePath_, ec)
+      : 0;
+
+  // Leftover of compaction interrupted by restart
+  fs::remove(compactionFilePath_, ec);
 }
 
 PersistentStore::~PersistentStore() {
+  // Complete disk I/O handed over, it is superseded by write of whole
+  // database below anyways
+  if (ioExecutor_) {
+    ioExecutor_->join();
+  }
+  if (logFd_ >= 0) {
+    folly::closeNoInt(logFd_);
+  }
   saveDatabaseToDisk();
+  std::error_code ec;
+  fs::remove(compactionFilePath_, ec);
 }
 
 folly::SemiFuture<folly::Unit>
@@ -73,7 +157,12 @@ PersistentStore::store(std::string key, std::string value) {
     SYSLOG(INFO) << "Store key: " << key << ", value: " << value
                  << " to config-store";
     // Override previous value if any
-    database_.keyVals_ref()[key] = value;
+    auto [it, inserted] = database_.keyVals_ref()->emplace(key, value);
+    if (not inserted) {
+      databaseBytes_ -= getEncodedSize(key, it->second);
+      it->second = value;
+    }
+    databaseBytes_ += getEncodedSize(key, value);
     auto pObject = toPersistentObject(ActionType::ADD, key, value);
     pObjects_.emplace_back(std::move(pObject));
     maybeSaveObjectToDisk();
@@ -89,7 +178,10 @@ PersistentStore::erase(std::string key) {
   runInEventBaseThread(
       [this, p = std::move(p), key = std::move(key)]() mutable noexcept {
         SYSLOG(INFO) << "Erase key: " << key << " from config-store";
-        if (database_.keyVals_ref()->erase(key) > 0) {
+        auto it = database_.keyVals_ref()->find(key);
+        if (it != database_.keyVals_ref()->end()) {
+          databaseBytes_ -= getEncodedSize(key, it->second);
+          database_.keyVals_ref()->erase(it);
           auto pObject = toPersistentObject(ActionType::DEL, key, "");
           pObjects_.emplace_back(std::move(pObject));
           maybeSaveObjectToDisk();
@@ -124,6 +216,7 @@ PersistentStore::maybeSaveObjectToDisk() noexcept {
     // This is primarily used for unit testing to save DB immediately
     // Block the response till file is saved
     savePersistentObjectToDisk();
+    waitForDiskIo();
   } else if (not saveDbTimer_->isScheduled()) {
     saveDbTimer_->scheduleTimeout(
         saveDbTimerBackoff_->getTimeRemainingUntilRetry());
@@ -133,7 +226,7 @@ PersistentStore::maybeSaveObjectToDisk() noexcept {
 bool
 PersistentStore::savePersistentObjectToDisk() noexcept {
   if (not dryrun_) {
-    // Write PersistentObject to ioBuf
+    // Group commit of all objects since last write
     std::vector<PersistentObject> newObjects;
     newObjects = std::move(pObjects_);
 
@@ -149,69 +242,168 @@ PersistentStore::savePersistentObjectToDisk() noexcept {
       queue.append(std::move(**buf));
     }
 
-    // Append IoBuf to disk
-    auto ioBuf = queue.move();
-    auto success = writeIoBufToDisk(ioBuf, WriteType::APPEND);
-    if (success.hasError()) {
-      LOG(ERROR) << "Failed to write PersistentObject to file '"
-                 << storageFilePath_
-                 << "'. Error: " << folly::exceptionStr(success.error());
-      return false;
+    // Hand data over to I/O thread. Log grows by it once it is appended
+    std::string data;
+    if (auto ioBuf = queue.move()) {
+      ioBuf->coalesce();
+      data = ioBuf->moveToFbString().toStdString();
     }
+    logBytes_ += data.size();
+    ioExecutor_->add([this, data = std::move(data)]() mutable noexcept {
+      appendToLog(std::move(data));
+    });
 
-    numOfNewWritesToDisk_++;
-
-    // Write the whole database to disk periodically
-    if (numOfNewWritesToDisk_ >= kDbFlushRatio) {
-      numOfNewWritesToDisk_ = 0;
-      const auto startTs = std::chrono::steady_clock::now();
-      if (not saveDatabaseToDisk()) {
-        return false;
-      }
-      LOG(INFO) << "Updated database on disk. Took "
-                << std::chrono::duration_cast<std::chrono::milliseconds>(
-                       std::chrono::steady_clock::now() - startTs)
-                       .count()
-                << "ms";
-    }
+    maybeCompact();
   } else {
     VLOG(1) << "Skipping writing to disk in dryrun mode";
+    numOfWritesToDisk_++;
   }
-  numOfWritesToDisk_++;
 
   return true;
 }
 
-bool
-PersistentStore::saveDatabaseToDisk() noexcept {
-  std::unique_ptr<folly::IOBuf> ioBuf;
-  // If database is empty, write 'kTlvFormatMarker' to disk and return
-  if (database_.keyVals_ref()->size() == 0) {
-    ioBuf = folly::IOBuf::copyBuffer(
-        kTlvFormatMarker.data(), kTlvFormatMarker.size());
-  } else {
-    // Append kTlvFormatMarker to queue
-    auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
-    queue.append(kTlvFormatMarker.data(), kTlvFormatMarker.size());
+void
+PersistentStore::waitForDiskIo() noexcept {
+  if (ioExecutor_) {
+    folly::via(ioExecutor_.get(), []() {}).wait();
+  }
+}
 
-    // Encode database_ and append to queue
-    for (auto& keyPair : *database_.keyVals_ref()) {
-      PersistentObject pObject;
-      pObject =
-          toPersistentObject(ActionType::ADD, keyPair.first, keyPair.second);
+void
+PersistentStore::maybeCompact() noexcept {
+  if (logBytes_ < Constants::kPersistentStoreMinCompactionBytes or
+      logBytes_ < Constants::kPersistentStoreCompactionRatio * databaseBytes_) {
+    return;
+  }
 
-      auto buf = encodePersistentObject(pObject);
-      if (buf.hasError()) {
-        LOG(ERROR) << "Failed to encode PersistentObject to ioBuf. Error:  "
-                   << folly::exceptionStr(buf.error());
-        return false;
+  // Snapshot is encoded and written on I/O thread, after all objects handed
+  // over so far. Objects handed over later are appended to compacted log
+  VLOG(1) << "Compacting " << logBytes_ << " bytes of " << storageFilePath_;
+  logBytes_ = databaseBytes_;
+  ioExecutor_->add([this, keyVals = *database_.keyVals_ref()]() noexcept {
+    compactLog(keyVals);
+  });
+}
+
+void
+PersistentStore::appendToLog(std::string data) noexcept {
+  const auto startTs = std::chrono::steady_clock::now();
+  if (not failedData_.empty()) {
+    failedData_.append(data);
+    data = std::move(failedData_);
+    failedData_.clear();
+  }
+
+  auto success = [this, &data]() -> folly::Expected<folly::Unit, std::string> {
+    if (logFd_ < 0) {
+      logFd_ = folly::openNoInt(
+          storageFilePath_.c_str(),
+          O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC,
+          0666);
+      if (logFd_ < 0) {
+        return folly::makeUnexpected<std::string>(
+            folly::sformat("open failed: {}", folly::errnoStr(errno)));
+      }
+      struct stat st;
+      if (::fstat(logFd_, &st) != 0 or
+          (st.st_size == 0 and
+           folly::writeFull(
+               logFd_, kTlvFormatMarker.data(), kTlvFormatMarker.size()) !=
+               static_cast<ssize_t>(kTlvFormatMarker.size()))) {
+        const auto error = folly::errnoStr(errno);
+        folly::closeNoInt(logFd_);
+        logFd_ = -1;
+        return folly::makeUnexpected<std::string>(
+            folly::sformat("open failed: {}", error));
       }
-      queue.append(std::move(*buf));
     }
-    // Write queue to disk
-    ioBuf = queue.move();
+
+    if (folly::writeFull(logFd_, data.data(), data.size()) !=
+            static_cast<ssize_t>(data.size()) or
+        folly::fsyncNoInt(logFd_) != 0) {
+      const auto error = folly::errnoStr(errno);
+      // Re-open log with next append
+      folly::closeNoInt(logFd_);
+      logFd_ = -1;
+      return folly::makeUnexpected<std::string>(
+          folly::sformat("append failed: {}", error));
+    }
+    return folly::Unit();
+  }();
+
+  if (success.hasError()) {
+    LOG(ERROR) << "Failed to write PersistentObject to file '"
+               << storageFilePath_ << "'. Error: " << success.error();
+    fb303::fbData->addStatValue(
+        "persistent_store.commit_failures", 1, fb303::SUM);
+    failedData_ = std::move(data);
+    return;
+  }
+
+  fb303::fbData->addStatValue(
+      "persistent_store.commit_bytes", data.size(), fb303::AVG);
+  fb303::fbData->addStatValue(
+      "persistent_store.commit_duration_ms",
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - startTs)
+          .count(),
+      fb303::AVG);
+  numOfWritesToDisk_++;
+}
+
+void
+PersistentStore::compactLog(const KeyVals& keyVals) noexcept {
+  const auto startTs = std::chrono::steady_clock::now();
+  auto data = encodeDatabase(keyVals);
+  folly::Expected<folly::Unit, std::string> success = folly::Unit();
+  if (data.hasError()) {
+    success = folly::makeUnexpected(data.error());
+  } else {
+    success = writeFileSynced(
+        compactionFilePath_, *data, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC);
   }
 
+  // Atomically replace the log
+  std::error_code ec;
+  if (success.hasValue()) {
+    fs::rename(compactionFilePath_, storageFilePath_, ec);
+    if (ec) {
+      success = folly::makeUnexpected(ec.message());
+    }
+  }
+  if (success.hasError()) {
+    LOG(ERROR) << "Failed to compact file '" << storageFilePath_
+               << "'. Error: " << success.error();
+    fs::remove(compactionFilePath_, ec);
+    return;
+  }
+
+  // Snapshot includes data of failed appends. Next append re-opens the log
+  failedData_.clear();
+  if (logFd_ >= 0) {
+    folly::closeNoInt(logFd_);
+    logFd_ = -1;
+  }
+  const auto durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - startTs)
+                              .count();
+  fb303::fbData->addStatValue(
+      "persistent_store.compaction_duration_ms", durationMs, fb303::AVG);
+  LOG(INFO) << "Compacted database on disk to " << data->size()
+            << " bytes. Took " << durationMs << "ms";
+  numOfCompactions_++;
+}
+
+bool
+PersistentStore::saveDatabaseToDisk() noexcept {
+  auto data = encodeDatabase(*database_.keyVals_ref());
+  if (data.hasError()) {
+    LOG(ERROR) << "Failed to encode PersistentObject to ioBuf. Error:  "
+               << folly::exceptionStr(data.error());
+    return false;
+  }
+
+  auto ioBuf = folly::IOBuf::copyBuffer(*data);
   auto success = writeIoBufToDisk(ioBuf, WriteType::WRITE);
   if (success.hasError()) {
     LOG(ERROR) << "Failed to write database to file '" << storageFilePath_
@@ -221,6 +413,46 @@ PersistentStore::saveDatabaseToDisk() noexcept {
   return true;
 }
 
+folly::Expected<std::string, std::string>
+PersistentStore::encodeDatabase(const KeyVals& keyVals) noexcept {
+  // Append kTlvFormatMarker to queue
+  auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
+  queue.append(kTlvFormatMarker.data(), kTlvFormatMarker.size());
+
+  // Encode database and append to queue
+  for (const auto& [key, value] : keyVals) {
+    auto buf =
+        encodePersistentObject(PersistentObject{ActionType::ADD, key, value});
+    if (buf.hasError()) {
+      return folly::makeUnexpected(buf.error());
+    }
+    queue.append(std::move(*buf));
+  }
+  auto ioBuf = queue.move();
+  ioBuf->coalesce();
+  return ioBuf->moveToFbString().toStdString();
+}
+
+folly::Expected<folly::Unit, std::string>
+PersistentStore::writeFileSynced(
+    const fs::path& path, const std::string& data, int flags) noexcept {
+  const int fd = folly::openNoInt(path.c_str(), flags, 0666);
+  if (fd < 0) {
+    return folly::makeUnexpected<std::string>(
+        folly::sformat("open failed: {}", folly::errnoStr(errno)));
+  }
+  const bool success = folly::writeFull(fd, data.data(), data.size()) ==
+          static_cast<ssize_t>(data.size()) and
+      folly::fsyncNoInt(fd) == 0;
+  const auto error = folly::errnoStr(errno);
+  folly::closeNoInt(fd);
+  if (not success) {
+    return folly::makeUnexpected<std::string>(
+        folly::sformat("write failed: {}", error));
+  }
+  return folly::Unit();
+}
+
 bool
 PersistentStore::loadDatabaseFromDisk() noexcept {
   // Check if file exists
@@ -230,22 +462,23 @@ PersistentStore::loadDatabaseFromDisk() noexcept {
     return true;
   }
 
-  // Read data from file
-  std::string fileData{""};
-  if (not folly::readFile(storageFilePath_.c_str(), fileData)) {
+  // Map file into memory, objects are decoded straight off it
+  std::unique_ptr<folly::MemoryMapping> mapping;
+  try {
+    mapping = std::make_unique<folly::MemoryMapping>(storageFilePath_.c_str());
+  } catch (std::exception const& e) {
     LOG(ERROR) << "Failed to read file contents from '" << storageFilePath_
-               << "'. Error (" << errno << "): " << folly::errnoStr(errno);
+               << "'. Error: " << folly::exceptionStr(e);
     return false;
   }
+  const auto data = mapping->range();
 
-  // Create IoBuf and cursor for loading data from disk
-  auto ioBuf = folly::IOBuf::wrapBuffer(fileData.c_str(), fileData.size());
-  folly::io::Cursor cursor(ioBuf.get());
-
-  // Read 'kTlvFormatMarker' from ioBuf
-  if (not cursor.canAdvance(kTlvFormatMarker.size()) or
-      cursor.readFixedString(kTlvFormatMarker.size()) != kTlvFormatMarker) {
+  // Read 'kTlvFormatMarker' from file
+  if (data.size() < kTlvFormatMarker.size() or
+      folly::StringPiece(data.subpiece(0, kTlvFormatMarker.size())) !=
+          kTlvFormatMarker) {
     // Load old Format and write TlvFormat
+    auto ioBuf = folly::IOBuf::wrapBuffer(data);
     auto oldSuccess = loadDatabaseOldFormat(ioBuf);
     if (oldSuccess.hasError()) {
       LOG(ERROR) << "Failed to read old-format file contents from '"
@@ -256,7 +489,7 @@ PersistentStore::loadDatabaseFromDisk() noexcept {
     return true;
   }
   // Load TlvFormat
-  auto tlvSuccess = loadDatabaseTlvFormat(ioBuf);
+  auto tlvSuccess = loadDatabaseTlvFormat(data);
   if (tlvSuccess.hasError()) {
     LOG(ERROR) << "Failed to read Tlv-format file contents from '"
                << storageFilePath_
@@ -284,41 +517,57 @@ PersistentStore::loadDatabaseOldFormat(
 }
 
 folly::Expected<folly::Unit, std::string>
-PersistentStore::loadDatabaseTlvFormat(
-    const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept {
-  // Parse ioBuf to persistentObject and then to `database_`
-  folly::io::Cursor cursor(ioBuf.get());
-  thrift::StoreDatabase newDatabase;
-  // Read 'kTlvFormatMarker'
-  try {
-    cursor.readFixedString(kTlvFormatMarker.size());
-  } catch (std::out_of_range& e) {
-    return folly::makeUnexpected<std::string>(
-        folly::exceptionStr(e).toStdString());
+PersistentStore::loadDatabaseTlvFormat(folly::ByteRange data) noexcept {
+  // Skip 'kTlvFormatMarker'
+  if (data.size() < kTlvFormatMarker.size()) {
+    return folly::makeUnexpected<std::string>("Missing format marker");
   }
-  // Iteratively read persistentObject from disk
-  while (true) {
-    // Read and decode into persistentObject
-    auto optionalObject = decodePersistentObject(cursor);
-    if (optionalObject.hasError()) {
-      return folly::makeUnexpected(optionalObject.error());
+  data.advance(kTlvFormatMarker.size());
+
+  // Iteratively read latest object of every key. Log mostly holds objects
+  // superseded by later ones, they are never copied out of the file
+  folly::F14FastMap<folly::StringPiece, std::optional<folly::StringPiece>>
+      latestObjects;
+  bool truncated{false};
+  while (not data.empty()) {
+    // Incomplete object at the end is a commit interrupted by crash, log is
+    // rewritten without it
+    auto maybeObject = decodePersistentObjectView(data);
+    if (not maybeObject.has_value()) {
+      LOG(WARNING) << "Dropping incomplete object at the end of file '"
+                   << storageFilePath_ << "'";
+      truncated = true;
+      break;
     }
 
-    // Read finish
-    if (not optionalObject->has_value()) {
-      break;
+    // Add/Delete persistentObject to/from 'latestObjects'
+    if (maybeObject->type == ActionType::ADD) {
+      latestObjects[maybeObject->key] = maybeObject->data;
+    } else if (maybeObject->type == ActionType::DEL) {
+      latestObjects[maybeObject->key] = std::nullopt;
     }
-    auto pObject = std::move(optionalObject->value());
-
-    // Add/Delete persistentObject to/from 'newDatabase'
-    if (pObject.type == ActionType::ADD) {
-      newDatabase.keyVals_ref()[pObject.key] =
-          pObject.data.has_value() ? pObject.data.value() : "";
-    } else if (pObject.type == ActionType::DEL) {
-      newDatabase.keyVals_ref()->erase(pObject.key);
+  }
+
+  // Copy live key-values into 'newDatabase', in key order so that each one is
+  // inserted at the end
+  std::vector<std::pair<folly::StringPiece, folly::StringPiece>> keyVals;
+  keyVals.reserve(latestObjects.size());
+  for (const auto& [key, maybeValue] : latestObjects) {
+    if (maybeValue.has_value()) {
+      keyVals.emplace_back(key, *maybeValue);
     }
   }
+  std::sort(keyVals.begin(), keyVals.end());
+  thrift::StoreDatabase newDatabase;
+  auto& newKeyVals = *newDatabase.keyVals_ref();
+  for (const auto& [key, value] : keyVals) {
+    newKeyVals.emplace_hint(newKeyVals.end(), key.str(), value.str());
+  }
+
   database_ = std::move(newDatabase);
+  if (truncated) {
+    saveDatabaseToDisk();
+  }
   return folly::Unit();
 }
 
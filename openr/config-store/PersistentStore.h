@@ -15,8 +15,10 @@ namespace fs = std::filesystem;
 #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
 #endif
+#include <map>
 #include <string>
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/futures/Future.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
@@ -51,6 +53,17 @@ struct PersistentObject {
  *
  * `storageFilePath`: Describe the path of file in file system where data will
  * be stored/retrieved from (in binary format).
+ *
+ * Storage file is a write-ahead log of persistent objects. Objects of all
+ * updates since last write are group committed with single append and fsync.
+ * Once log grows well beyond the database it holds, it is compacted: snapshot
+ * of database is written to a separate file, which atomically replaces the
+ * log. Hence cost of a write doesn't grow with size of the database.
+ *
+ * Disk I/O of commits and compactions runs on a dedicated I/O thread, in
+ * order. Event base serves requests from in-memory database and only hands
+ * encoded objects over, hence slow disk doesn't stall `store`/`load`.
+ * Database is loaded from disk on construction, before any request.
  */
 class PersistentStore : public OpenrEventBase {
  public:
@@ -67,6 +80,11 @@ class PersistentStore : public OpenrEventBase {
     return numOfWritesToDisk_;
   }
 
+  uint64_t
+  getNumOfCompactions() const {
+    return numOfCompactions_;
+  }
+
   /**
    * Encode/Decode a PersistentObject, this can be private method, but for unit
    * test, we make it public
@@ -118,6 +136,8 @@ class PersistentStore : public OpenrEventBase {
   }
 
  private:
+  using KeyVals = std::map<std::string, std::string>;
+
   // Function to save/load `database_` to local disk. Returns true on success
   // else false. Doesn't throw exception.
   bool saveDatabaseToDisk() noexcept;
@@ -127,20 +147,54 @@ class PersistentStore : public OpenrEventBase {
   folly::Expected<folly::Unit, std::string> loadDatabaseOldFormat(
       const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept;
 
-  // Load TlvFormat from disk
+  // Load TlvFormat from contents of file
   folly::Expected<folly::Unit, std::string> loadDatabaseTlvFormat(
-      const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept;
+      folly::ByteRange data) noexcept;
 
   // Wrapper function to save persistent object to disk immediately or later
   void maybeSaveObjectToDisk() noexcept;
 
-  // Function to save Persistent Object to local disk.
+  // Function to save Persistent Object to local disk. Objects are handed
+  // over to I/O thread, returns false if they couldn't be encoded
   bool savePersistentObjectToDisk() noexcept;
 
+  // Wait for disk I/O handed over so far to complete
+  void waitForDiskIo() noexcept;
+
   // Write IoBuf ro local disk
   folly::Expected<folly::Unit, std::string> writeIoBufToDisk(
       const std::unique_ptr<folly::IOBuf>& ioBuf, WriteType writeType) noexcept;
 
+  // Compact the log on I/O thread if it grew large enough
+  void maybeCompact() noexcept;
+
+  //
+  // I/O thread methods
+  //
+
+  // Append group of encoded objects to the log and fsync it. Log is opened on
+  // first use, with format marker if empty. Data of failed append is retried
+  // with the next one
+  void appendToLog(std::string data) noexcept;
+
+  // Replace the log with snapshot of database
+  void compactLog(const KeyVals& keyVals) noexcept;
+
+  // Encode database with format marker as it is stored in file
+  static folly::Expected<std::string, std::string> encodeDatabase(
+      const KeyVals& keyVals) noexcept;
+
+  // Write or append data to file, and fsync it
+  static folly::Expected<folly::Unit, std::string> writeFileSynced(
+      const fs::path& path, const std::string& data, int flags) noexcept;
+
+  // Size of encoded key-value, see encodePersistentObject
+  static uint64_t
+  getEncodedSize(const std::string& key, const std::string& value) {
+    return sizeof(uint8_t) + sizeof(uint32_t) + key.size() + sizeof(uint32_t) +
+        value.size();
+  }
+
   // Function to create a PersistentObject.
   PersistentObject toPersistentObject(
       const ActionType type, const std::string& key, const std::string& data);
@@ -148,13 +202,29 @@ class PersistentStore : public OpenrEventBase {
   // Keeps track of number of writes of Database to disk
   std::atomic<std::uint64_t> numOfWritesToDisk_{0};
 
-  // Keeps track of number of writes of PersistentObject to disk
-  std::atomic<std::uint64_t> numOfNewWritesToDisk_{0};
+  // Keeps track of number of compactions of the log
+  std::atomic<std::uint64_t> numOfCompactions_{0};
 
   // Location on disk where data will be synced up. A file will be created
   // if doesn't exists.
   const fs::path storageFilePath_;
 
+  // Location of compacted file, until it replaces the one above
+  const fs::path compactionFilePath_;
+
+  // Size of log as of objects handed over to I/O thread, and size of
+  // database if it was written from scratch
+  uint64_t logBytes_{0};
+  uint64_t databaseBytes_{kTlvFormatMarker.size()};
+
+  // Single I/O thread, runs disk I/O in order it is handed over
+  std::unique_ptr<folly::CPUThreadPoolExecutor> ioExecutor_;
+
+  // Accessed on I/O thread only. Log, i.e. storage file, kept open for
+  // appends between compactions, and data of failed append
+  int logFd_{-1};
+  std::string failedData_;
+
   // Dryrun to avoid disk writes in UTs
   bool dryrun_{false};
 
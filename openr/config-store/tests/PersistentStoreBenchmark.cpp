@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
+#include <thread>
+
 #include <folly/Benchmark.h>
 #include <folly/Random.h>
 #include <folly/init/Init.h>
@@ -125,6 +128,42 @@ BM_PersistentStoreLoad(uint32_t iters, size_t numOfStringKeys) {
   eraseKeyFromStore(stringKeys, *store);
 }
 
+/**
+ * Benchmark for latency of requests while disk I/O is in flight
+ * 1. Generate keys with large values
+ * 2. Keep overwriting them from another thread, which keeps I/O thread busy
+ *    with appends, fsyncs and compactions of file
+ * 3. Load keys from store
+ */
+void
+BM_PersistentStoreLoadDuringWrites(uint32_t iters, size_t numOfStringKeys) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  auto store = std::make_unique<PersistentStoreWrapper>(tid);
+  store->run();
+
+  auto stringKeys = constructRandomVector(numOfStringKeys);
+  const std::string value(4096, 'v');
+  std::atomic<bool> writing{true};
+  std::thread writer([&]() {
+    while (writing) {
+      for (const auto& key : stringKeys) {
+        (*store)->store(key, value).get();
+      }
+    }
+  });
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; i++) {
+    (*store)->load(stringKeys[i % stringKeys.size()]).get();
+  }
+  suspender.rehire(); // Stop measuring time again
+
+  writing = false;
+  writer.join();
+  eraseKeyFromStore(stringKeys, *store);
+}
+
 /**
  * Benchmark for Creating/Destroing a store
  * 1. Generate random keys
@@ -168,6 +207,10 @@ BENCHMARK_PARAM(BM_PersistentStoreLoad, 100);
 BENCHMARK_PARAM(BM_PersistentStoreLoad, 1000);
 BENCHMARK_PARAM(BM_PersistentStoreLoad, 10000);
 
+BENCHMARK_PARAM(BM_PersistentStoreLoadDuringWrites, 10);
+BENCHMARK_PARAM(BM_PersistentStoreLoadDuringWrites, 100);
+BENCHMARK_PARAM(BM_PersistentStoreLoadDuringWrites, 1000);
+
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 10);
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 100);
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 1000);
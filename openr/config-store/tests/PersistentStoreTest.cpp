@@ -38,6 +38,7 @@ loadDatabaseFromDisk(const std::string& filePath) {
     auto optionalObject = PersistentStore::decodePersistentObject(cursor);
     if (optionalObject.hasError()) {
       LOG(ERROR) << optionalObject.error();
+      break;
     }
 
     // Read finish
@@ -215,6 +216,86 @@ TEST(PersistentStoreTest, BulkStoreLoad) {
   }
 }
 
+TEST(PersistentStoreTest, LoadLog) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const auto filePath = folly::sformat("/tmp/aq_persistent_store_test_{}", tid);
+
+  // Log with superseded and deleted keys, and incomplete object at the end
+  auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
+  queue.append(kTlvFormatMarker.data(), kTlvFormatMarker.size());
+  const std::vector<PersistentObject> pObjects{
+      {ActionType::ADD, "key1", "val1"},
+      {ActionType::ADD, "key2", "val2"},
+      {ActionType::ADD, "key1", "val3"},
+      {ActionType::DEL, "key2", std::nullopt},
+      {ActionType::ADD, "key3", std::nullopt},
+      {ActionType::ADD, "key4", "val4"},
+  };
+  for (const auto& pObject : pObjects) {
+    queue.append(std::move(*PersistentStore::encodePersistentObject(pObject)));
+  }
+  auto ioBuf = queue.move();
+  ioBuf->coalesce();
+  auto fileData = ioBuf->moveToFbString().toStdString();
+  fileData.resize(fileData.size() - 2);
+  ASSERT_TRUE(folly::writeFile(fileData, filePath.c_str()));
+
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_EQ("val3", store->load("key1").get());
+    EXPECT_EQ(std::nullopt, store->load("key2").get());
+    EXPECT_EQ("", store->load("key3").get());
+    EXPECT_EQ(std::nullopt, store->load("key4").get());
+
+    store->erase("key1").get();
+    store->erase("key3").get();
+  }
+}
+
+TEST(PersistentStoreTest, Compaction) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const std::string value(4096, 'x');
+
+  thrift::StoreDatabase database;
+  std::string filePath;
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    filePath = store.filePath;
+    database = loadDatabaseFromDisk(filePath);
+
+    // Overwrite same keys until log grows beyond compaction threshold, and
+    // keep writing until compacted log replaces it
+    size_t index = 0;
+    while (store->getNumOfCompactions() == 0) {
+      const auto key = folly::sformat("key-{}", index++ % 4);
+      const auto val = folly::sformat("{}-{}", value, index);
+      database.keyVals_ref()[key] = val;
+      store->store(key, val).get();
+      ASSERT_LT(index, 10000);
+    }
+    EXPECT_LT(
+        fs::file_size(filePath), Constants::kPersistentStoreMinCompactionBytes);
+
+    // Log remains appendable after compaction. Objects are written to disk
+    // asynchronously
+    database.keyVals_ref()["key-new"] = "val-new";
+    store->store("key-new", "val-new").get();
+    for (int i = 0; i < 100; ++i) {
+      if (database == loadDatabaseFromDisk(filePath)) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(database, loadDatabaseFromDisk(filePath));
+
+    // Stop & destroy store before exiting
+  }
+
+  EXPECT_EQ(database, loadDatabaseFromDisk(filePath));
+}
+
 } // namespace openr
 
 int
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <sched.h>
+
 #include <fb303/ServiceData.h>
 #include <folly/FileUtil.h>
 #include <glog/logging.h>
@@ -46,6 +48,29 @@ AreaConfiguration::compileRegexSet(std::vector<std::string> const& strings) {
   return reSet;
 }
 
+AreaConfiguration::InterfaceMatch
+AreaConfiguration::getInterfaceMatch(std::string const& iface) const {
+  {
+    auto matches = interfaceMatches_.rlock();
+    auto it = matches->find(iface);
+    if (it != matches->end()) {
+      return it->second;
+    }
+  }
+
+  InterfaceMatch match;
+  match.shouldDiscover = !interfaceExcludeRegexSet_->Match(iface, nullptr) &&
+      interfaceIncludeRegexSet_->Match(iface, nullptr);
+  match.shouldRedistribute = interfaceRedistRegexSet_->Match(iface, nullptr);
+
+  auto matches = interfaceMatches_.wlock();
+  if (matches->size() >= kMaxCachedInterfaces) {
+    matches->clear();
+  }
+  matches->emplace(iface, match);
+  return match;
+}
+
 Config::Config(const std::string& configFile) {
   std::string contents;
   if (not folly::readFile(configFile.c_str(), contents)) {
@@ -79,6 +104,43 @@ Config::getRunningConfig() const {
   return contents;
 }
 
+void
+Config::checkReloadable(Config const& config) const {
+  // Reset reloadable fields of new config to the running ones. Any remaining
+  // difference requires restart
+  auto next = config.getConfig();
+  auto& nextAreas = *next.areas_ref();
+  const auto& areas = *config_.areas_ref();
+  for (size_t i = 0; i < nextAreas.size() and i < areas.size(); ++i) {
+    nextAreas[i].include_interface_regexes_ref() =
+        *areas[i].include_interface_regexes_ref();
+    nextAreas[i].exclude_interface_regexes_ref() =
+        *areas[i].exclude_interface_regexes_ref();
+    nextAreas[i].redistribute_interface_regexes_ref() =
+        *areas[i].redistribute_interface_regexes_ref();
+  }
+  // Areas inherit deprecated interface regexes of link monitor config
+  auto& nextLmConf = *next.link_monitor_config_ref();
+  const auto& lmConf = *config_.link_monitor_config_ref();
+  nextLmConf.include_interface_regexes_ref() =
+      *lmConf.include_interface_regexes_ref();
+  nextLmConf.exclude_interface_regexes_ref() =
+      *lmConf.exclude_interface_regexes_ref();
+  nextLmConf.redistribute_interface_regexes_ref() =
+      *lmConf.redistribute_interface_regexes_ref();
+
+  auto nextFloodRate = next.kvstore_config_ref()->flood_rate_ref();
+  auto floodRate = config_.kvstore_config_ref()->flood_rate_ref();
+  if (nextFloodRate and floodRate) {
+    nextFloodRate = *floodRate;
+  }
+
+  if (next != config_) {
+    throw std::invalid_argument(
+        "config differs from running config in fields requiring restart");
+  }
+}
+
 PrefixAllocationParams
 Config::createPrefixAllocationParams(
     const std::string& seedPfxStr, uint8_t allocationPfxLen) {
@@ -178,6 +240,103 @@ Config::populateInternalDb() {
     throw std::invalid_argument(folly::sformat(
         "enable_ordered_fib_programming only support single area config"));
   }
+  for (const auto& priorityClass : *config_.fib_priority_classes_ref()) {
+    auto& prefixes = fibPriorityClasses_.emplace_back();
+    for (const auto& prefixStr : *priorityClass.prefixes_ref()) {
+      const auto maybePrefix =
+          folly::IPAddress::tryCreateNetwork(prefixStr, -1, true);
+      if (maybePrefix.hasError()) {
+        throw std::invalid_argument(folly::sformat(
+            "invalid prefix {} of fib priority class {}",
+            prefixStr,
+            *priorityClass.name_ref()));
+      }
+      prefixes.emplace_back(maybePrefix.value());
+    }
+  }
+
+  //
+  // Decision
+  //
+  if (const auto& dampingConf = config_.route_damping_config_ref()) {
+    if (*dampingConf->penalty_ref() <= 0 or
+        *dampingConf->half_life_s_ref() <= 0 or
+        *dampingConf->max_suppress_time_s_ref() <= 0) {
+      throw std::out_of_range(
+          "route_damping_config penalty, half_life_s and max_suppress_time_s "
+          "should be > 0");
+    }
+    if (*dampingConf->reuse_threshold_ref() <= 0 or
+        *dampingConf->reuse_threshold_ref() >=
+            *dampingConf->suppress_threshold_ref()) {
+      throw std::invalid_argument(folly::sformat(
+          "route_damping_config reuse_threshold ({}) should be > 0 and < "
+          "suppress_threshold ({})",
+          *dampingConf->reuse_threshold_ref(),
+          *dampingConf->suppress_threshold_ref()));
+    }
+  }
+
+  //
+  // Ctrl server
+  //
+  const auto& ctrlConf = *config_.ctrl_server_config_ref();
+  if (*ctrlConf.high_priority_threads_ref() <= 0 or
+      *ctrlConf.normal_priority_threads_ref() <= 0 or
+      *ctrlConf.best_effort_threads_ref() <= 0) {
+    throw std::out_of_range(
+        "ctrl server threads of every priority should be > 0");
+  }
+  for (const auto& [method, priority] : *ctrlConf.method_priorities_ref()) {
+    if (not enumName(priority)) {
+      throw std::invalid_argument(folly::sformat(
+          "invalid priority of ctrl method {}: {}",
+          method,
+          static_cast<int>(priority)));
+    }
+  }
+
+  //
+  // Module threads
+  //
+  const auto& threadConfs = *config_.module_thread_configs_ref();
+  for (const auto& [module, threadConf] : threadConfs) {
+    for (const auto cpu : *threadConf.cpus_ref()) {
+      if (cpu < 0 or cpu >= CPU_SETSIZE) {
+        throw std::out_of_range(
+            folly::sformat("invalid cpu of {} thread: {}", module, cpu));
+      }
+    }
+    const auto policy = *threadConf.sched_policy_ref();
+    if (not enumName(policy)) {
+      throw std::invalid_argument(folly::sformat(
+          "invalid sched policy of {} thread: {}",
+          module,
+          static_cast<int>(policy)));
+    }
+    const bool isRealtime = policy == thrift::ThreadSchedPolicy::FIFO or
+        policy == thrift::ThreadSchedPolicy::RR;
+    const auto priority = *threadConf.sched_priority_ref();
+    if ((isRealtime and (priority < 1 or priority > 99)) or
+        (not isRealtime and priority != 0)) {
+      throw std::out_of_range(folly::sformat(
+          "invalid sched priority of {} thread: {}", module, priority));
+    }
+  }
+
+  //
+  // Memory allocator
+  //
+  if (const auto& allocConf = config_.memory_allocator_config_ref()) {
+    for (const auto& decayMs :
+         {allocConf->dirty_decay_ms_ref().value_or(0),
+          allocConf->muzzy_decay_ms_ref().value_or(0)}) {
+      if (decayMs < -1) {
+        throw std::out_of_range(folly::sformat(
+            "memory_allocator_config decay should be >= -1: {}", decayMs));
+      }
+    }
+  }
 
   //
   // Kvstore
@@ -191,6 +350,27 @@ Config::populateInternalDb() {
       throw std::out_of_range("kvstore flood_msg_burst_size should be > 0");
     }
   }
+  if (const auto& prefixes = kvConf.priority_flood_key_prefixes_ref()) {
+    for (const auto& prefix : *prefixes) {
+      // empty prefix would exempt all keys from flood rate limit
+      if (prefix.empty()) {
+        throw std::invalid_argument(
+            "kvstore priority_flood_key_prefixes can't be empty strings");
+      }
+    }
+  }
+  if (kvConf.enable_thrift_only_transport_ref().value_or(false)) {
+    if (not *config_.enable_kvstore_thrift_ref()) {
+      throw std::invalid_argument(
+          "kvstore enable_thrift_only_transport requires "
+          "enable_kvstore_thrift");
+    }
+    if (kvConf.enable_flood_optimization_ref().value_or(false)) {
+      throw std::invalid_argument(
+          "kvstore enable_thrift_only_transport can't be used with "
+          "enable_flood_optimization");
+    }
+  }
 
   //
   // Spark
@@ -291,6 +471,41 @@ Config::populateInternalDb() {
         *sparkConfig.step_detector_conf_ref()->upper_threshold_ref()));
   }
 
+  const auto& rttChangeConfig = *sparkConfig.rtt_change_conf_ref();
+  if (*rttChangeConfig.ewma_weight_ref() <= 0 ||
+      *rttChangeConfig.ewma_weight_ref() > 1) {
+    throw std::out_of_range(folly::sformat(
+        "rtt_change_conf.ewma_weight ({}) should be in range (0, 1]",
+        *rttChangeConfig.ewma_weight_ref()));
+  }
+
+  if (*rttChangeConfig.min_change_us_ref() < 0 ||
+      *rttChangeConfig.min_interval_ms_ref() < 0) {
+    throw std::out_of_range(folly::sformat(
+        "rtt_change_conf.min_change_us ({}) and rtt_change_conf.min_interval_ms ({}) should be >= 0",
+        *rttChangeConfig.min_change_us_ref(),
+        *rttChangeConfig.min_interval_ms_ref()));
+  }
+
+  if (*sparkConfig.enable_fast_heartbeat_ref()) {
+    if (*sparkConfig.fast_heartbeat_interval_ms_ref() <= 0 ||
+        *sparkConfig.fast_heartbeat_max_pps_per_interface_ref() <= 0) {
+      throw std::out_of_range(folly::sformat(
+          "fast_heartbeat_interval_ms ({}) and fast_heartbeat_max_pps_per_interface ({}) should be > 0",
+          *sparkConfig.fast_heartbeat_interval_ms_ref(),
+          *sparkConfig.fast_heartbeat_max_pps_per_interface_ref()));
+    }
+
+    // Tolerate loss of two consecutive fast heartbeats
+    if (*sparkConfig.fast_heartbeat_hold_time_ms_ref() <
+        3 * *sparkConfig.fast_heartbeat_interval_ms_ref()) {
+      throw std::invalid_argument(folly::sformat(
+          "fast_heartbeat_hold_time_ms ({}) should be >= 3 * fast_heartbeat_interval_ms ({})",
+          *sparkConfig.fast_heartbeat_hold_time_ms_ref(),
+          *sparkConfig.fast_heartbeat_interval_ms_ref()));
+    }
+  }
+
   //
   // Monitor
   //
@@ -300,6 +515,21 @@ Config::populateInternalDb() {
         "monitor_max_event_log ({}) should be >= 0",
         *monitorConfig.max_event_log_ref()));
   }
+  for (const auto& [event, limit] : *monitorConfig.event_log_limits_ref()) {
+    if (*limit.sample_rate_ref() < 1) {
+      throw std::out_of_range(folly::sformat(
+          "monitor_config.event_log_limits sample_rate of {} ({}) should be "
+          ">= 1",
+          event,
+          *limit.sample_rate_ref()));
+    }
+    if (*limit.rate_per_sec_ref() < 0 || *limit.burst_ref() < 0) {
+      throw std::out_of_range(folly::sformat(
+          "monitor_config.event_log_limits rate_per_sec and burst of {} "
+          "should be >= 0",
+          event));
+    }
+  }
   //
   // Link Monitor
   //
@@ -396,6 +626,17 @@ Config::populateInternalDb() {
     throw std::invalid_argument(
         "enable_watchdog = true, but watchdog_config is empty");
   }
+  if (isWatchdogEnabled()) {
+    for (const auto& [module, maxMemoryMb] :
+         *config_.watchdog_config_ref()->module_max_memory_mb_ref()) {
+      if (maxMemoryMb <= 0) {
+        throw std::out_of_range(folly::sformat(
+            "watchdog_config.module_max_memory_mb of {} ({}) should be > 0",
+            module,
+            maxMemoryMb));
+      }
+    }
+  }
 
 } // namespace openr
 } // namespace openr
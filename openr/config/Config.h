@@ -7,7 +7,11 @@
 
 #pragma once
 
+#include <optional>
+#include <unordered_map>
+
 #include <folly/IPAddress.h>
+#include <folly/Synchronized.h>
 #include <re2/re2.h>
 #include <re2/set.h>
 
@@ -38,8 +42,7 @@ class AreaConfiguration {
 
   bool
   shouldDiscoverOnIface(std::string const& iface) const {
-    return !interfaceExcludeRegexSet_->Match(iface, nullptr) &&
-        interfaceIncludeRegexSet_->Match(iface, nullptr);
+    return getInterfaceMatch(iface).shouldDiscover;
   }
 
   bool
@@ -49,10 +52,24 @@ class AreaConfiguration {
 
   bool
   shouldRedistributeIface(std::string const& iface) const {
-    return interfaceRedistRegexSet_->Match(iface, nullptr);
+    return getInterfaceMatch(iface).shouldRedistribute;
   }
 
  private:
+  // Interface regexes matched against an interface name
+  struct InterfaceMatch {
+    bool shouldDiscover{false};
+    bool shouldRedistribute{false};
+  };
+
+  // Bound on number of cached interface names. Cache is dropped once full,
+  // e.g. on churn of container interfaces
+  static constexpr size_t kMaxCachedInterfaces{16384};
+
+  // Match interface regexes, cached per interface name. Config is immutable,
+  // hence cached results remain valid for the lifetime of the object
+  InterfaceMatch getInterfaceMatch(std::string const& iface) const;
+
   const std::string areaId_;
 
   // given a list of strings we will convert is to a compiled RE2::Set
@@ -61,6 +78,10 @@ class AreaConfiguration {
 
   std::shared_ptr<re2::RE2::Set> neighborRegexSet_, interfaceIncludeRegexSet_,
       interfaceExcludeRegexSet_, interfaceRedistRegexSet_;
+
+  // NOTE: Area config is shared by modules running in different threads
+  mutable folly::Synchronized<std::unordered_map<std::string, InterfaceMatch>>
+      interfaceMatches_;
 };
 
 class Config {
@@ -82,6 +103,15 @@ class Config {
   }
   std::string getRunningConfig() const;
 
+  /**
+   * Check that this config can be changed to config without restart, i.e.
+   * they differ in reloadable fields only. Throws std::invalid_argument
+   * otherwise. Reloadable are:
+   * - interface regexes of areas, as long as the list of area ids is the same
+   * - `kvstore_config.flood_rate`, as long as it stays set
+   */
+  void checkReloadable(Config const& config) const;
+
   const std::string&
   getNodeName() const {
     return *config_.node_name_ref();
@@ -136,6 +166,96 @@ class Config {
     return *config_.enable_best_route_selection_ref();
   }
 
+  bool
+  isIncrementalSpfEnabled() const {
+    return *config_.enable_incremental_spf_ref();
+  }
+
+  bool
+  isIncrementalRouteBuildEnabled() const {
+    return *config_.enable_incremental_route_build_ref();
+  }
+
+  bool
+  isAdaptiveDecisionDebounceEnabled() const {
+    return *config_.enable_adaptive_decision_debounce_ref();
+  }
+
+  bool
+  isLfaBackupNextHopsEnabled() const {
+    return *config_.enable_lfa_backup_nexthops_ref();
+  }
+
+  size_t
+  getRouteComputationThreads() const {
+    return std::max(0, config_.route_computation_threads_ref().value_or(0));
+  }
+
+  size_t
+  getFibSyncChunkSize() const {
+    return std::max(0, config_.fib_sync_chunk_size_ref().value_or(0));
+  }
+
+  bool
+  isFibRouteReconcileEnabled() const {
+    return *config_.enable_fib_route_reconcile_ref();
+  }
+
+  bool
+  isConvergenceTimeFloodingEnabled() const {
+    return *config_.enable_convergence_time_flooding_ref();
+  }
+
+  bool
+  isNetlinkNexthopObjectsEnabled() const {
+    return *config_.enable_netlink_nexthop_objects_ref();
+  }
+
+  size_t
+  getPrefixDbKeyShards() const {
+    return std::max(0, config_.prefix_db_key_shards_ref().value_or(0));
+  }
+
+  const thrift::CtrlServerConfig&
+  getCtrlServerConfig() const {
+    return *config_.ctrl_server_config_ref();
+  }
+
+  // Flap damping of routes in Decision, std::nullopt if disabled
+  std::optional<thrift::RouteDampingConfig>
+  getRouteDampingConfig() const {
+    return config_.route_damping_config_ref().to_optional();
+  }
+
+  // jemalloc tuning, std::nullopt if not set
+  std::optional<thrift::MemoryAllocatorConfig>
+  getMemoryAllocatorConfig() const {
+    return config_.memory_allocator_config_ref().to_optional();
+  }
+
+  // CPU affinity and scheduling of threads of module, e.g. "Decision"
+  std::optional<thrift::ThreadConfig>
+  getModuleThreadConfig(const std::string& module) const {
+    const auto& configs = *config_.module_thread_configs_ref();
+    auto it = configs.find(module);
+    if (it == configs.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  // Prefixes of fib_priority_classes, highest priority class first
+  const std::vector<std::vector<folly::CIDRNetwork>>&
+  getFibPriorityClasses() const {
+    return fibPriorityClasses_;
+  }
+
+  std::chrono::milliseconds
+  getFibRouteCoalesceWindow() const {
+    return std::chrono::milliseconds(
+        std::max(0, config_.fib_route_coalesce_window_ms_ref().value_or(0)));
+  }
+
   bool
   isLogSubmissionEnabled() const {
     return *getMonitorConfig().enable_event_log_submission_ref();
@@ -270,6 +390,12 @@ class Config {
 
   // areaId -> neighbor regex and interface regex mapped
   std::unordered_map<std::string /* areaId */, AreaConfiguration> areaConfigs_;
+
+  // parsed prefixes of fib_priority_classes
+  std::vector<std::vector<folly::CIDRNetwork>> fibPriorityClasses_;
 };
 
+// Config delivered to modules on hot reload, see Config::checkReloadable()
+using ConfigPtr = std::shared_ptr<const Config>;
+
 } // namespace openr
@@ -252,6 +252,63 @@ TEST(ConfigTest, AreaConfiguration) {
   EXPECT_FALSE(areaConf.shouldRedistributeIface("loopback10"));
   EXPECT_FALSE(areaConf.shouldRedistributeIface("iface450"));
   EXPECT_FALSE(areaConf.shouldRedistributeIface(""));
+
+  // matches are cached per interface, repeated and copied lookups agree
+  auto const areaConfCopy = areaConf;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(areaConfCopy.shouldDiscoverOnIface("iface20"));
+    EXPECT_FALSE(areaConfCopy.shouldDiscoverOnIface("iface400"));
+    EXPECT_TRUE(areaConfCopy.shouldRedistributeIface("loopback1"));
+    EXPECT_FALSE(areaConfCopy.shouldRedistributeIface("iface20"));
+  }
+}
+
+TEST(ConfigTest, CheckReloadable) {
+  openr::thrift::AreaConfig areaConfig;
+  *areaConfig.area_id_ref() = "myArea";
+  areaConfig.include_interface_regexes_ref()->emplace_back("iface.*");
+  areaConfig.neighbor_regexes_ref()->emplace_back("fsw.*");
+  auto tConfig = getBasicOpenrConfig("node-1", "domain", {areaConfig});
+  tConfig.kvstore_config_ref()->flood_rate_ref() = getFloodRate();
+  const Config running{tConfig};
+
+  // same config
+  EXPECT_NO_THROW(running.checkReloadable(Config(tConfig)));
+
+  // interface regexes and flood rate
+  {
+    auto next = tConfig;
+    next.areas_ref()->at(0).include_interface_regexes_ref() = {"eth.*"};
+    next.areas_ref()->at(0).redistribute_interface_regexes_ref() = {"lo"};
+    next.kvstore_config_ref()->flood_rate_ref()->flood_msg_per_sec_ref() = 10;
+    EXPECT_NO_THROW(running.checkReloadable(Config(next)));
+  }
+  // neighbor regexes
+  {
+    auto next = tConfig;
+    next.areas_ref()->at(0).neighbor_regexes_ref() = {"rsw.*"};
+    EXPECT_THROW(running.checkReloadable(Config(next)), std::invalid_argument);
+  }
+  // flood rate is unset
+  {
+    auto next = tConfig;
+    next.kvstore_config_ref()->flood_rate_ref().reset();
+    EXPECT_THROW(running.checkReloadable(Config(next)), std::invalid_argument);
+  }
+  // added area
+  {
+    auto next = tConfig;
+    auto newArea = areaConfig;
+    *newArea.area_id_ref() = "newArea";
+    next.areas_ref()->emplace_back(newArea);
+    EXPECT_THROW(running.checkReloadable(Config(next)), std::invalid_argument);
+  }
+  // other field
+  {
+    auto next = tConfig;
+    next.enable_rib_policy_ref() = not *tConfig.enable_rib_policy_ref();
+    EXPECT_THROW(running.checkReloadable(Config(next)), std::invalid_argument);
+  }
 }
 
 TEST(ConfigTest, PopulateInternalDb) {
@@ -273,6 +330,23 @@ TEST(ConfigTest, PopulateInternalDb) {
     EXPECT_TRUE(Config(conf).isRibPolicyEnabled());
   }
 
+  // fib priority classes
+  {
+    auto conf = getBasicOpenrConfig();
+    thrift::FibPriorityClass priorityClass;
+    *priorityClass.name_ref() = "infra";
+    priorityClass.prefixes_ref()->emplace_back("fc00::/64");
+    conf.fib_priority_classes_ref()->emplace_back(priorityClass);
+    EXPECT_EQ(
+        Config(conf).getFibPriorityClasses(),
+        std::vector<std::vector<folly::CIDRNetwork>>(
+            {{folly::IPAddress::createNetwork("fc00::/64")}}));
+
+    conf.fib_priority_classes_ref()->at(0).prefixes_ref()->emplace_back(
+        "boom");
+    EXPECT_THROW((Config(conf)), std::invalid_argument);
+  }
+
   // kvstore
 
   // flood_msg_per_sec <= 0
@@ -295,6 +369,38 @@ TEST(ConfigTest, PopulateInternalDb) {
         ->flood_msg_burst_size_ref() = 0;
     EXPECT_THROW((Config(confInvalidFloodMsgPerSec)), std::out_of_range);
   }
+  // empty priority flood key prefix
+  {
+    auto confInvalidPriorityPrefix = getBasicOpenrConfig();
+    confInvalidPriorityPrefix.kvstore_config_ref()
+        ->priority_flood_key_prefixes_ref() = {"adj:", ""};
+    EXPECT_THROW(
+        (Config(confInvalidPriorityPrefix)), std::invalid_argument);
+  }
+
+  // Exception: jemalloc decay < -1
+  {
+    auto confInvalidDecay = getBasicOpenrConfig();
+    thrift::MemoryAllocatorConfig allocConf;
+    allocConf.muzzy_decay_ms_ref() = -2;
+    confInvalidDecay.memory_allocator_config_ref() = allocConf;
+    EXPECT_THROW((Config(confInvalidDecay)), std::out_of_range);
+  }
+
+  // Exception: thrift only transport without thrift enabled or with flood
+  // optimization
+  {
+    auto confInvalidThriftOnly = getBasicOpenrConfig();
+    confInvalidThriftOnly.kvstore_config_ref()
+        ->enable_thrift_only_transport_ref() = true;
+    confInvalidThriftOnly.enable_kvstore_thrift_ref() = false;
+    EXPECT_THROW((Config(confInvalidThriftOnly)), std::invalid_argument);
+
+    confInvalidThriftOnly.enable_kvstore_thrift_ref() = true;
+    confInvalidThriftOnly.kvstore_config_ref()
+        ->enable_flood_optimization_ref() = true;
+    EXPECT_THROW((Config(confInvalidThriftOnly)), std::invalid_argument);
+  }
 
   // Spark
 
@@ -398,6 +504,38 @@ TEST(ConfigTest, PopulateInternalDb) {
     EXPECT_THROW(auto c = Config(confInvalidSpark), std::invalid_argument);
   }
 
+  // Exception: rtt_change_conf.ewma_weight not in (0, 1]
+  //            rtt_change_conf.min_change_us < 0
+  {
+    auto confInvalidSpark = getBasicOpenrConfig();
+    confInvalidSpark.spark_config_ref()
+        ->rtt_change_conf_ref()
+        ->ewma_weight_ref() = 0;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::out_of_range);
+
+    confInvalidSpark.spark_config_ref()
+        ->rtt_change_conf_ref()
+        ->ewma_weight_ref() = 0.5;
+    confInvalidSpark.spark_config_ref()
+        ->rtt_change_conf_ref()
+        ->min_change_us_ref() = -1;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::out_of_range);
+  }
+
+  // Exception: fast_heartbeat_interval_ms <= 0
+  //            fast_heartbeat_hold_time_ms < 3 * fast_heartbeat_interval_ms
+  {
+    auto confInvalidSpark = getBasicOpenrConfig();
+    confInvalidSpark.spark_config_ref()->enable_fast_heartbeat_ref() = true;
+    confInvalidSpark.spark_config_ref()->fast_heartbeat_interval_ms_ref() = 0;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::out_of_range);
+
+    confInvalidSpark.spark_config_ref()->fast_heartbeat_interval_ms_ref() = 100;
+    confInvalidSpark.spark_config_ref()->fast_heartbeat_hold_time_ms_ref() =
+        200;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::invalid_argument);
+  }
+
   // Monitor
 
   // Exception monitor_max_event_log >= 0
@@ -407,6 +545,16 @@ TEST(ConfigTest, PopulateInternalDb) {
     EXPECT_THROW(auto c = Config(confInvalidMon), std::out_of_range);
   }
 
+  // Exception event log sample_rate >= 1
+  {
+    auto confInvalidMon = getBasicOpenrConfig();
+    thrift::EventLogLimit limit;
+    limit.sample_rate_ref() = 0;
+    confInvalidMon.monitor_config_ref()->event_log_limits_ref()->emplace(
+        "NB_UP", limit);
+    EXPECT_THROW(auto c = Config(confInvalidMon), std::out_of_range);
+  }
+
   // link monitor
 
   // linkflap_initial_backoff_ms < 0
@@ -533,6 +681,86 @@ TEST(ConfigTest, PopulateInternalDb) {
     confInvalid.enable_watchdog_ref() = true;
     EXPECT_THROW((Config(confInvalid)), std::invalid_argument);
   }
+  // non-positive memory limit of a module
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    confInvalid.enable_watchdog_ref() = true;
+    thrift::WatchdogConfig watchdogConf;
+    watchdogConf.module_max_memory_mb_ref()->emplace("KvStore", 0);
+    confInvalid.watchdog_config_ref() = watchdogConf;
+    EXPECT_THROW((Config(confInvalid)), std::out_of_range);
+  }
+
+  // route damping
+
+  // non-positive half life
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    thrift::RouteDampingConfig dampingConf;
+    dampingConf.half_life_s_ref() = 0;
+    confInvalid.route_damping_config_ref() = dampingConf;
+    EXPECT_THROW((Config(confInvalid)), std::out_of_range);
+  }
+  // reuse threshold not below suppress threshold
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    thrift::RouteDampingConfig dampingConf;
+    dampingConf.reuse_threshold_ref() = 2000;
+    dampingConf.suppress_threshold_ref() = 2000;
+    confInvalid.route_damping_config_ref() = dampingConf;
+    EXPECT_THROW((Config(confInvalid)), std::invalid_argument);
+  }
+
+  // ctrl server
+
+  // no worker thread of a priority
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    confInvalid.ctrl_server_config_ref()->best_effort_threads_ref() = 0;
+    EXPECT_THROW((Config(confInvalid)), std::out_of_range);
+  }
+  // unknown method priority
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    confInvalid.ctrl_server_config_ref()->method_priorities_ref()->emplace(
+        "getRouteDb", static_cast<thrift::CtrlRequestPriority>(2));
+    EXPECT_THROW((Config(confInvalid)), std::invalid_argument);
+  }
+
+  // module threads
+
+  // cpu out of range
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    thrift::ThreadConfig threadConf;
+    threadConf.cpus_ref() = {0, -1};
+    confInvalid.module_thread_configs_ref()->emplace("Spark", threadConf);
+    EXPECT_THROW((Config(confInvalid)), std::out_of_range);
+  }
+  // real-time policy without priority
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    thrift::ThreadConfig threadConf;
+    threadConf.sched_policy_ref() = thrift::ThreadSchedPolicy::FIFO;
+    confInvalid.module_thread_configs_ref()->emplace("Spark", threadConf);
+    EXPECT_THROW((Config(confInvalid)), std::out_of_range);
+  }
+  // priority of non real-time policy
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    thrift::ThreadConfig threadConf;
+    threadConf.sched_priority_ref() = 10;
+    confInvalid.module_thread_configs_ref()->emplace("Decision", threadConf);
+    EXPECT_THROW((Config(confInvalid)), std::out_of_range);
+  }
+  // unknown policy
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    thrift::ThreadConfig threadConf;
+    threadConf.sched_policy_ref() = static_cast<thrift::ThreadSchedPolicy>(7);
+    confInvalid.module_thread_configs_ref()->emplace("KvStore", threadConf);
+    EXPECT_THROW((Config(confInvalid)), std::invalid_argument);
+  }
 }
 
 TEST(ConfigTest, GeneralGetter) {
@@ -571,6 +799,22 @@ TEST(ConfigTest, GeneralGetter) {
 
     // getSparkConfig
     EXPECT_EQ(*tConfig.spark_config_ref(), config.getSparkConfig());
+
+    // getModuleThreadConfig
+    EXPECT_FALSE(config.getModuleThreadConfig("Spark").has_value());
+  }
+
+  // module thread configs
+  {
+    auto tConfig = getBasicOpenrConfig();
+    thrift::ThreadConfig threadConf;
+    threadConf.cpus_ref() = {2, 3};
+    threadConf.sched_policy_ref() = thrift::ThreadSchedPolicy::FIFO;
+    threadConf.sched_priority_ref() = 10;
+    tConfig.module_thread_configs_ref()->emplace("Spark", threadConf);
+    auto config = Config(tConfig);
+    EXPECT_EQ(threadConf, config.getModuleThreadConfig("Spark"));
+    EXPECT_FALSE(config.getModuleThreadConfig("Decision").has_value());
   }
 
   // config with bgp peering
@@ -16,12 +16,15 @@ namespace fs = std::experimental::filesystem;
 #endif
 
 #include <folly/ExceptionString.h>
+#include <folly/futures/Future.h>
 #include <folly/io/async/SSLContext.h>
 #include <folly/io/async/ssl/OpenSSLUtils.h>
 #include <re2/re2.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 
 #include <openr/common/Constants.h>
+#include <openr/common/Profiler.h>
 #include <openr/common/Util.h>
 #include <openr/config-store/PersistentStore.h>
 #include <openr/decision/Decision.h>
@@ -48,10 +51,12 @@ OpenrCtrlHandler::OpenrCtrlHandler(
     PersistentStore* configStore,
     PrefixManager* prefixManager,
     Spark* spark,
-    std::shared_ptr<const Config> config)
+    std::shared_ptr<const Config> config,
+    messaging::ReplicateQueue<ConfigPtr>* configUpdatesQueue)
     : fb303::BaseService("openr"),
       nodeName_(nodeName),
       acceptablePeerCommonNames_(acceptablePeerCommonNames),
+      ctrlEvb_(ctrlEvb),
       decision_(decision),
       fib_(fib),
       kvStore_(kvStore),
@@ -60,7 +65,19 @@ OpenrCtrlHandler::OpenrCtrlHandler(
       configStore_(configStore),
       prefixManager_(prefixManager),
       spark_(spark),
-      config_(config) {
+      config_(config),
+      configUpdatesQueue_(configUpdatesQueue),
+      methodPriorities_(OpenrCtrlThreadManager::getMethodPriorities(
+          config ? config->getCtrlServerConfig()
+                 : thrift::CtrlServerConfig())),
+      kvStoreChangeLog_(
+          Constants::kKvStoreChangeLogSize, getUnixTimeStampMs() * 1000) {
+  CHECK_NOTNULL(ctrlEvb);
+  longPollExpiryTimer_ = folly::AsyncTimeout::make(
+      *ctrlEvb_->getEvb(), [this]() noexcept { expireLongPollReqs(); });
+  countersPublishTimer_ = folly::AsyncTimeout::make(
+      *ctrlEvb_->getEvb(), [this]() noexcept { publishCounters(); });
+
   // Add fiber task to receive publication from KvStore
   if (kvStore_) {
     auto taskFutureKvStore = ctrlEvb->addFiberTaskFuture([
@@ -75,16 +92,21 @@ OpenrCtrlHandler::OpenrCtrlHandler(
           LOG(INFO) << "Terminating KvStore publications processing fiber";
           break;
         }
+        auto const& publication = *maybePublication.value();
 
         SYNCHRONIZED(kvStorePublishers_) {
-          for (auto& kv : kvStorePublishers_) {
-            kv.second->publish(maybePublication.value());
+          // record publication with its sequence number before publishing,
+          // so that subscribers can resume from it
+          auto const loggedPublication =
+              kvStoreChangeLog_.append(publication);
+          for (auto& kv : kvStorePublishers_.publishers) {
+            kv.second->publish(*loggedPublication);
           }
         }
 
         bool isAdjChanged = false;
         // check if any of KeyVal has 'adj' update
-        for (auto& kv : *maybePublication.value().keyVals_ref()) {
+        for (auto& kv : *publication.keyVals_ref()) {
           auto& key = kv.first;
           auto& val = kv.second;
           // check if we have any value update.
@@ -105,37 +127,15 @@ OpenrCtrlHandler::OpenrCtrlHandler(
           // thrift::Publication contains "adj:*" key change.
           // Clean ALL pending promises
           longPollReqs_.withWLock([&](auto& longPollReqs) {
-            for (auto& kv : longPollReqs[maybePublication->get_area()]) {
+            for (auto& kv : longPollReqs[publication.get_area()]) {
               auto& p = kv.second.first;
               p.setValue(true);
             }
             longPollReqs.clear();
           });
-        } else {
-          longPollReqs_.withWLock([&](auto& longPollReqs) {
-            auto now = getUnixTimeStampMs();
-            std::vector<int64_t> reqsToClean;
-            for (auto& kv : longPollReqs[maybePublication->get_area()]) {
-              auto& clientId = kv.first;
-              auto& req = kv.second;
-
-              auto& p = req.first;
-              auto& timeStamp = req.second;
-              if (now - timeStamp >= Constants::kLongPollReqHoldTime.count()) {
-                LOG(INFO) << "Elapsed time: " << now - timeStamp
-                          << " is over hold limit: "
-                          << Constants::kLongPollReqHoldTime.count();
-                reqsToClean.emplace_back(clientId);
-                p.setValue(false);
-              }
-            }
-
-            // cleanup expired requests since no ADJ change observed
-            for (auto& clientId : reqsToClean) {
-              longPollReqs[maybePublication->get_area()].erase(clientId);
-            }
-          });
         }
+        // NOTE: requests without "adj:" key change are expired by
+        // longPollExpiryTimer_
       }
       LOG(INFO) << "KvStore updates processing fiber stopped";
     });
@@ -163,6 +163,20 @@ OpenrCtrlHandler::OpenrCtrlHandler(
                 fibPublisher.second.next(maybeUpdate.value());
               }
             });
+
+            // Serialize the update once and share the buffer with all
+            // serialized streams
+            fibSerializedPublishers_.withWLock([&maybeUpdate](
+                                                   auto& publishers) {
+              if (publishers.empty()) {
+                return;
+              }
+              const auto buf = apache::thrift::CompactSerializer::serialize<
+                  folly::IOBuf>(maybeUpdate.value());
+              for (auto& publisher : publishers) {
+                publisher.second.next(buf.cloneAsValue());
+              }
+            });
           }
           LOG(INFO) << "Fib updates processing fiber stopped";
         });
@@ -174,9 +188,16 @@ OpenrCtrlHandler::OpenrCtrlHandler(
 OpenrCtrlHandler::~OpenrCtrlHandler() {
   closeKvStorePublishers();
   closeFibPublishers();
+  closeCountersPublishers();
 
   LOG(INFO) << "Cleanup all pending request(s).";
   longPollReqs_.withWLock([&](auto& longPollReqs) { longPollReqs.clear(); });
+  // Timers must be destroyed in their thread. It also waits for pending
+  // scheduling of timers
+  ctrlEvb_->getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
+    longPollExpiryTimer_.reset();
+    countersPublishTimer_.reset();
+  });
 
   LOG(INFO)
       << "Waiting for termination of kvStoreUpdatesQueue, FibUpdatesQueue";
@@ -193,12 +214,16 @@ OpenrCtrlHandler::~OpenrCtrlHandler() {
 void
 OpenrCtrlHandler::closeKvStorePublishers() {
   std::vector<std::unique_ptr<KvStorePublisher>> publishers;
+  size_t numStreams{0};
   SYNCHRONIZED(kvStorePublishers_) {
-    for (auto& kv : kvStorePublishers_) {
+    for (auto& kv : kvStorePublishers_.publishers) {
+      numStreams += kv.second->getNumStreams();
       publishers.emplace_back(std::move(kv.second));
     }
+    kvStorePublishers_.publishers.clear();
+    kvStorePublishers_.groupKeys.clear();
   }
-  LOG(INFO) << "Terminating " << publishers.size()
+  LOG(INFO) << "Terminating " << numStreams
             << " active KvStore snoop stream(s).";
   for (auto& publisher : publishers) {
     // We have to send an exception as part of the completion, otherwise
@@ -217,12 +242,55 @@ OpenrCtrlHandler::closeFibPublishers() {
     for (auto& kv : fibPublishers) {
       fibPublishers_close.emplace_back(std::move(kv.second));
     }
+    fibPublishers.clear();
   });
   LOG(INFO) << "Terminating " << fibPublishers_close.size()
             << " active Fib snoop stream(s).";
   for (auto& fibPublisher : fibPublishers_close) {
     std::move(fibPublisher).complete();
   }
+
+  std::vector<apache::thrift::ServerStreamPublisher<folly::IOBuf>>
+      serializedPublishers_close;
+  fibSerializedPublishers_.withWLock(
+      [&serializedPublishers_close](auto& publishers) {
+        for (auto& kv : publishers) {
+          serializedPublishers_close.emplace_back(std::move(kv.second));
+        }
+        publishers.clear();
+      });
+  LOG(INFO) << "Terminating " << serializedPublishers_close.size()
+            << " active serialized Fib snoop stream(s).";
+  for (auto& publisher : serializedPublishers_close) {
+    std::move(publisher).complete();
+  }
+}
+
+// Refer to note on top of closeKvStorePublishers
+void
+OpenrCtrlHandler::closeCountersPublishers() {
+  std::vector<
+      apache::thrift::ServerStreamPublisher<std::map<std::string, int64_t>>>
+      publishers;
+  countersSubscriptions_.withWLock([&publishers](auto& subscriptions) {
+    for (auto& [_, subscription] : subscriptions) {
+      publishers.emplace_back(std::move(subscription.publisher));
+    }
+    subscriptions.clear();
+  });
+  LOG(INFO) << "Terminating " << publishers.size()
+            << " active counter stream(s).";
+  for (auto& publisher : publishers) {
+    std::move(publisher).complete();
+  }
+}
+
+void
+OpenrCtrlHandler::shedStreamSubscribers() {
+  fb303::fbData->addStatValue("ctrl.stream_subscribers_shed", 1, fb303::COUNT);
+  closeKvStorePublishers();
+  closeFibPublishers();
+  closeCountersPublishers();
 }
 
 void
@@ -260,6 +328,14 @@ OpenrCtrlHandler::authorizeConnection() {
   }
 }
 
+apache::thrift::concurrency::PRIORITY
+OpenrCtrlHandler::getRequestPriority(
+    apache::thrift::Cpp2RequestContext* ctx,
+    apache::thrift::concurrency::PRIORITY prio) {
+  auto it = methodPriorities_.find(ctx->getMethodName());
+  return it != methodPriorities_.end() ? it->second : prio;
+}
+
 fb303::cpp2::fb303_status
 OpenrCtrlHandler::getStatus() {
   return fb303::cpp2::fb303_status::ALIVE;
@@ -273,6 +349,47 @@ OpenrCtrlHandler::getEventLogs(std::vector<::std::string>& _return) {
   }
 }
 
+folly::SemiFuture<std::unique_ptr<std::string>>
+OpenrCtrlHandler::semifuture_getProfile(
+    std::unique_ptr<thrift::ProfileParams> params) {
+  if (*params->type_ref() == thrift::ProfileType::HEAP) {
+    try {
+      return folly::makeSemiFuture(
+          std::make_unique<std::string>(getHeapProfile()));
+    } catch (const std::exception& ex) {
+      return folly::makeSemiFuture<std::unique_ptr<std::string>>(
+          thrift::OpenrError(ex.what()));
+    }
+  }
+
+  const std::chrono::milliseconds duration{*params->duration_ms_ref()};
+  const auto frequencyHz = *params->frequency_hz_ref();
+  if (duration.count() <= 0 or duration > Constants::kMaxCpuProfileDuration or
+      frequencyHz <= 0 or frequencyHz > Constants::kMaxCpuProfileFrequencyHz) {
+    return folly::makeSemiFuture<std::unique_ptr<std::string>>(
+        thrift::OpenrError(folly::sformat(
+            "Invalid duration ({}ms) or frequency ({}Hz) of CPU profile",
+            duration.count(),
+            frequencyHz)));
+  }
+
+  std::shared_ptr<CpuProfiler> profiler;
+  try {
+    profiler = std::make_shared<CpuProfiler>(frequencyHz, duration);
+  } catch (const std::exception& ex) {
+    return folly::makeSemiFuture<std::unique_ptr<std::string>>(
+        thrift::OpenrError(ex.what()));
+  }
+  return folly::futures::sleep(duration).deferValue(
+      [profiler = std::move(profiler)](folly::Unit) {
+        try {
+          return std::make_unique<std::string>(profiler->stop());
+        } catch (const std::exception& ex) {
+          throw thrift::OpenrError(ex.what());
+        }
+      });
+}
+
 void
 OpenrCtrlHandler::getCounters(std::map<std::string, int64_t>& _return) {
   BaseService::getCounters(_return);
@@ -322,6 +439,316 @@ OpenrCtrlHandler::getCounter(std::unique_ptr<std::string> key) {
   return BaseService::getCounter(std::move(key));
 }
 
+bool
+OpenrCtrlHandler::CountersSubscription::isSelected(const std::string& name) {
+  if (selectAll) {
+    return true;
+  }
+  auto it = isSelectedCache.find(name);
+  if (it == isSelectedCache.end()) {
+    const bool selected =
+        keys.count(name) or (regexes and regexes->Match(name, nullptr));
+    it = isSelectedCache.emplace(name, selected).first;
+  }
+  return it->second;
+}
+
+folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+    std::map<std::string, int64_t>,
+    std::map<std::string, int64_t>>>
+OpenrCtrlHandler::semifuture_subscribeAndGetCounters(
+    std::unique_ptr<thrift::CountersSubscriptionParams> params) {
+  // Compile matchers ahead of creating the stream
+  std::unique_ptr<re2::RE2::Set> regexes;
+  if (not params->regexes_ref()->empty()) {
+    regexes = std::make_unique<re2::RE2::Set>(
+        re2::RE2::DefaultOptions, re2::RE2::UNANCHORED);
+    for (const auto& regex : *params->regexes_ref()) {
+      std::string error;
+      if (regexes->Add(regex, &error) < 0) {
+        throw thrift::OpenrError(
+            folly::sformat("Invalid counter regex {}: {}", regex, error));
+      }
+    }
+    if (not regexes->Compile()) {
+      throw thrift::OpenrError("Failed to compile counter regexes");
+    }
+  }
+
+  // Get new client-ID (monotonically increasing)
+  auto clientToken = publisherToken_++;
+
+  auto streamAndPublisher = apache::thrift::ServerStream<
+      std::map<std::string, int64_t>>::createPublisher([this, clientToken]() {
+    countersSubscriptions_.withWLock([&clientToken](auto& subscriptions) {
+      if (subscriptions.erase(clientToken)) {
+        LOG(INFO) << "Counter stream-" << clientToken << " ended.";
+      } else {
+        LOG(ERROR) << "Can't remove unknown counter stream-" << clientToken;
+      }
+      fb303::fbData->setCounter("subscribers.counters", subscriptions.size());
+    });
+  });
+
+  CountersSubscription subscription(
+      std::move(streamAndPublisher.second),
+      std::max(
+          std::chrono::milliseconds(*params->intervalMs_ref()),
+          Constants::kMinCountersPublishInterval));
+  subscription.keys.insert(
+      params->keys_ref()->begin(), params->keys_ref()->end());
+  subscription.regexes = std::move(regexes);
+  subscription.selectAll =
+      subscription.keys.empty() and not subscription.regexes;
+
+  // Initial values of selected counters
+  std::map<std::string, int64_t> counters;
+  getCounters(counters);
+  std::map<std::string, int64_t> selectedCounters;
+  for (const auto& [name, value] : counters) {
+    if (subscription.isSelected(name)) {
+      selectedCounters.emplace(name, value);
+      subscription.lastValues.emplace(name, value);
+    }
+  }
+  subscription.nextPublishTime =
+      std::chrono::steady_clock::now() + subscription.interval;
+
+  countersSubscriptions_.withWLock(
+      [&clientToken, &subscription](auto& subscriptions) {
+        LOG(INFO) << "Counter stream-" << clientToken << " started.";
+        subscriptions.emplace(clientToken, std::move(subscription));
+        fb303::fbData->setCounter(
+            "subscribers.counters", subscriptions.size());
+      });
+
+  // Timer may be scheduled beyond first publication of the new subscription
+  ctrlEvb_->runInEventBaseThread([this]() { publishCounters(); });
+
+  return folly::makeSemiFuture(apache::thrift::ResponseAndServerStream<
+                               std::map<std::string, int64_t>,
+                               std::map<std::string, int64_t>>{
+      std::move(selectedCounters), std::move(streamAndPublisher.first)});
+}
+
+folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+    thrift::TechSupportHeader,
+    thrift::TechSupportSection>>
+OpenrCtrlHandler::semifuture_getTechSupportSnapshot(
+    std::unique_ptr<thrift::TechSupportParams> params) {
+  thrift::TechSupportHeader header;
+  *header.nodeName_ref() = nodeName_;
+  *header.timestampMs_ref() = getUnixTimeStampMs();
+
+  auto streamAndPublisher =
+      apache::thrift::ServerStream<thrift::TechSupportSection>::
+          createPublisher([]() {});
+  auto publisher = std::make_shared<
+      apache::thrift::ServerStreamPublisher<thrift::TechSupportSection>>(
+      std::move(streamAndPublisher.second));
+  const auto codec = *params->compression_ref();
+
+  // Serialize and compress payload of section once module responds. Module
+  // which is stuck fails its section instead of holding up the stream
+  std::vector<folly::Future<folly::Unit>> sections;
+  auto addSection = [&](std::string name,
+                        std::optional<std::string> area,
+                        auto&& sf,
+                        auto setPayload) {
+    sections.emplace_back(
+        std::move(sf)
+            .within(Constants::kTechSupportSectionTimeout)
+            .via(ctrlEvb_->getEvb())
+            .thenTry([publisher,
+                      codec,
+                      name = std::move(name),
+                      area = std::move(area),
+                      setPayload](auto&& result) {
+              thrift::TechSupportSection section;
+              *section.name_ref() = name;
+              section.area_ref().from_optional(area);
+              if (result.hasException()) {
+                section.error_ref() = result.exception().what().toStdString();
+                publisher->next(std::move(section));
+                return;
+              }
+
+              thrift::TechSupportPayload payload;
+              setPayload(payload, std::move(*result.value()));
+              apache::thrift::CompactSerializer serializer;
+              auto buf = writeThriftObj(payload, serializer);
+              *section.uncompressedSize_ref() = buf->computeChainDataLength();
+              if (auto data = compressBuffer(*buf, codec)) {
+                section.codec_ref() = codec;
+                *section.payload_ref() = std::move(*data);
+              } else {
+                *section.payload_ref() = buf->moveToFbString().toStdString();
+              }
+              publisher->next(std::move(section));
+            }));
+  };
+
+  // Module state which isn't owned by any module thread
+  addSection(
+      "config",
+      std::nullopt,
+      folly::makeSemiFuture(
+          std::make_unique<thrift::OpenrConfig>(config_.copy()->getConfig())),
+      [](auto& p, auto&& v) { p.set_config(std::move(v)); });
+  {
+    auto counters = std::make_unique<std::map<std::string, int64_t>>();
+    getCounters(*counters);
+    addSection(
+        "counters",
+        std::nullopt,
+        folly::makeSemiFuture(std::move(counters)),
+        [](auto& p, auto&& v) { p.set_counters(std::move(v)); });
+  }
+  if (monitor_) {
+    auto logs = monitor_->getRecentEventLogs();
+    addSection(
+        "event_logs",
+        std::nullopt,
+        folly::makeSemiFuture(std::make_unique<std::vector<std::string>>(
+            logs.begin(), logs.end())),
+        [](auto& p, auto&& v) { p.set_eventLogs(std::move(v)); });
+  }
+
+  // Module states, every module serves its request in its own thread
+  if (linkMonitor_) {
+    addSection(
+        "link_monitor_interfaces",
+        std::nullopt,
+        linkMonitor_->getInterfaces(),
+        [](auto& p, auto&& v) { p.set_interfaces(std::move(v)); });
+    addSection(
+        "link_monitor_adjacencies",
+        std::nullopt,
+        linkMonitor_->getAdjacencies(),
+        [](auto& p, auto&& v) { p.set_linkMonitorAdjacencies(std::move(v)); });
+  }
+  if (spark_) {
+    addSection(
+        "spark_neighbors",
+        std::nullopt,
+        spark_->getNeighbors(),
+        [](auto& p, auto&& v) { p.set_neighbors(std::move(v)); });
+  }
+  if (kvStore_) {
+    for (auto const& area : config_.copy()->getAreaIds()) {
+      addSection(
+          "kvstore_peers",
+          area,
+          kvStore_->getKvStorePeers(area),
+          [](auto& p, auto&& v) { p.set_kvStorePeers(std::move(v)); });
+      addSection(
+          "kvstore_key_vals",
+          area,
+          kvStore_->dumpKvStoreKeys(thrift::KeyDumpParams(), {area})
+              .deferValue(
+                  [](std::unique_ptr<std::vector<thrift::Publication>>&&
+                         pubs) {
+                    return std::make_unique<thrift::Publication>(
+                        pubs->empty() ? thrift::Publication{}
+                                      : std::move(pubs->front()));
+                  }),
+          [](auto& p, auto&& v) { p.set_kvStoreKeyVals(std::move(v)); });
+    }
+  }
+  if (decision_) {
+    addSection(
+        "decision_adjacencies",
+        std::nullopt,
+        decision_->getDecisionAdjacenciesFiltered(),
+        [](auto& p, auto&& v) { p.set_decisionAdjacencies(std::move(v)); });
+    addSection(
+        "decision_prefixes",
+        std::nullopt,
+        decision_->getDecisionPrefixDbs(),
+        [](auto& p, auto&& v) { p.set_decisionPrefixes(std::move(v)); });
+    if (*params->includeRoutes_ref()) {
+      addSection(
+          "decision_routes",
+          std::nullopt,
+          decision_->getDecisionRouteDb(""),
+          [](auto& p, auto&& v) { p.set_routesComputed(std::move(v)); });
+    }
+  }
+  if (fib_) {
+    addSection(
+        "fib_perf",
+        std::nullopt,
+        fib_->getPerfDb(),
+        [](auto& p, auto&& v) { p.set_perfDb(std::move(v)); });
+    if (*params->includeRoutes_ref()) {
+      addSection(
+          "fib_routes",
+          std::nullopt,
+          fib_->getRouteDb(),
+          [](auto& p, auto&& v) { p.set_routesInstalled(std::move(v)); });
+    }
+  }
+  if (prefixManager_) {
+    addSection(
+        "prefix_manager_prefixes",
+        std::nullopt,
+        prefixManager_->getPrefixes(),
+        [](auto& p, auto&& v) { p.set_prefixes(std::move(v)); });
+  }
+
+  // Complete stream once all sections are published
+  folly::collectAll(std::move(sections))
+      .via(ctrlEvb_->getEvb())
+      .thenValue([publisher](auto&&) { std::move(*publisher).complete(); });
+
+  return folly::makeSemiFuture(apache::thrift::ResponseAndServerStream<
+                               thrift::TechSupportHeader,
+                               thrift::TechSupportSection>{
+      std::move(header), std::move(streamAndPublisher.first)});
+}
+
+void
+OpenrCtrlHandler::publishCounters() {
+  const auto now = std::chrono::steady_clock::now();
+  std::optional<std::chrono::steady_clock::time_point> nextPublishTime;
+
+  // All counters are retrieved once for all subscriptions due
+  std::optional<std::map<std::string, int64_t>> counters;
+  countersSubscriptions_.withWLock([&](auto& subscriptions) {
+    for (auto& [_, subscription] : subscriptions) {
+      if (subscription.nextPublishTime <= now) {
+        if (not counters.has_value()) {
+          getCounters(counters.emplace());
+        }
+        std::map<std::string, int64_t> changedCounters;
+        for (const auto& [name, value] : *counters) {
+          if (not subscription.isSelected(name)) {
+            continue;
+          }
+          auto [it, inserted] = subscription.lastValues.emplace(name, value);
+          if (inserted or it->second != value) {
+            it->second = value;
+            changedCounters.emplace(name, value);
+          }
+        }
+        if (not changedCounters.empty()) {
+          subscription.publisher.next(std::move(changedCounters));
+        }
+        subscription.nextPublishTime = now + subscription.interval;
+      }
+      if (not nextPublishTime.has_value() or
+          subscription.nextPublishTime < *nextPublishTime) {
+        nextPublishTime = subscription.nextPublishTime;
+      }
+    }
+  });
+
+  if (nextPublishTime.has_value()) {
+    countersPublishTimer_->scheduleTimeout(
+        std::chrono::ceil<std::chrono::milliseconds>(*nextPublishTime - now));
+  }
+}
+
 void
 OpenrCtrlHandler::getMyNodeName(std::string& _return) {
   _return = std::string(nodeName_);
@@ -339,10 +766,8 @@ OpenrCtrlHandler::getBuildInfo(thrift::BuildInfo& _buildInfo) {
   _buildInfo = getBuildInfoThrift();
 }
 
-// validate config
-void
-OpenrCtrlHandler::dryrunConfig(
-    std::string& _return, std::unique_ptr<std::string> file) {
+std::shared_ptr<const Config>
+OpenrCtrlHandler::loadConfigOrThrow(std::unique_ptr<std::string> const& file) {
   if (not file) {
     throw thrift::OpenrError("Dereference nullptr for config file");
   }
@@ -355,29 +780,59 @@ OpenrCtrlHandler::dryrunConfig(
   }
 
   try {
-    // Create policy manager using new config file
-    auto config = Config(fileName);
-    _return = config.getRunningConfig();
+    return std::make_shared<const Config>(fileName);
   } catch (const std::exception& ex) {
     throw thrift::OpenrError(ex.what());
   }
 }
 
+// validate config
+void
+OpenrCtrlHandler::dryrunConfig(
+    std::string& _return, std::unique_ptr<std::string> file) {
+  _return = loadConfigOrThrow(file)->getRunningConfig();
+}
+
+void
+OpenrCtrlHandler::reloadConfig(std::unique_ptr<std::string> file, bool dryrun) {
+  if (not configUpdatesQueue_) {
+    throw thrift::OpenrError("Config reload is not supported");
+  }
+  auto config = loadConfigOrThrow(file);
+
+  // NOTE: Lock is held until config is delivered, hence modules get reloaded
+  // configs in order
+  auto runningConfig = config_.wlock();
+  try {
+    (*runningConfig)->checkReloadable(*config);
+  } catch (const std::exception& ex) {
+    throw thrift::OpenrError(ex.what());
+  }
+  if (dryrun) {
+    return;
+  }
+  LOG(INFO) << "Reloading config from " << *file;
+  fb303::fbData->addStatValue("ctrl.config_reloads", 1, fb303::COUNT);
+  *runningConfig = config;
+  configUpdatesQueue_->push(std::move(config));
+}
+
 void
 OpenrCtrlHandler::getRunningConfig(std::string& _return) {
-  _return = config_->getRunningConfig();
+  _return = config_.copy()->getRunningConfig();
 }
 
 void
 OpenrCtrlHandler::getRunningConfigThrift(thrift::OpenrConfig& _config) {
-  _config = config_->getConfig();
+  _config = config_.copy()->getConfig();
 }
 
 std::unique_ptr<std::string>
 OpenrCtrlHandler::getSingleAreaOrThrow(std::string const& caller) {
   fb303::fbData->addStatValue(
       folly::sformat("ctrl.get_single_area.{}", caller), 1, fb303::COUNT);
-  auto const& areas = config_->getAreas();
+  auto config = config_.copy();
+  auto const& areas = config->getAreas();
   if (1 != areas.size()) {
     throw thrift::OpenrError(
         "Iterface requires node to be confgiured with exactly one area");
@@ -385,6 +840,17 @@ OpenrCtrlHandler::getSingleAreaOrThrow(std::string const& caller) {
   return std::make_unique<std::string>(areas.begin()->first);
 }
 
+thrift::PageParams
+OpenrCtrlHandler::checkPageParams(std::unique_ptr<thrift::PageParams> page) {
+  if (*page->pageSize_ref() <= 0) {
+    throw thrift::OpenrError(folly::sformat(
+        "Invalid page size {}, must be positive", *page->pageSize_ref()));
+  }
+  page->pageSize_ref() =
+      std::min(*page->pageSize_ref(), Constants::kMaxDumpPageSize);
+  return std::move(*page);
+}
+
 //
 // PrefixManager APIs
 //
@@ -456,6 +922,13 @@ OpenrCtrlHandler::semifuture_getRouteDb() {
   return fib_->getRouteDb();
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::RouteDbPage>>
+OpenrCtrlHandler::semifuture_getRouteDbPage(
+    std::unique_ptr<thrift::PageParams> page) {
+  CHECK(fib_);
+  return fib_->getRouteDbPage(checkPageParams(std::move(page)));
+}
+
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::UnicastRoute>>>
 OpenrCtrlHandler::semifuture_getUnicastRoutesFiltered(
     std::unique_ptr<std::vector<std::string>> prefixes) {
@@ -524,6 +997,15 @@ OpenrCtrlHandler::semifuture_getReceivedRoutesFiltered(
   return decision_->getReceivedRoutesFiltered(std::move(*filter));
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::ReceivedRoutesPage>>
+OpenrCtrlHandler::semifuture_getReceivedRoutesFilteredPage(
+    std::unique_ptr<thrift::ReceivedRouteFilter> filter,
+    std::unique_ptr<thrift::PageParams> page) {
+  CHECK(decision_);
+  return decision_->getReceivedRoutesFilteredPage(
+      std::move(*filter), checkPageParams(std::move(page)));
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
 OpenrCtrlHandler::semifuture_getRouteDbComputed(
     std::unique_ptr<std::string> nodeName) {
@@ -531,6 +1013,15 @@ OpenrCtrlHandler::semifuture_getRouteDbComputed(
   return decision_->getDecisionRouteDb(*nodeName);
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
+OpenrCtrlHandler::semifuture_getRouteDbComputedFiltered(
+    std::unique_ptr<std::string> nodeName,
+    std::unique_ptr<std::vector<thrift::IpPrefix>> prefixes) {
+  CHECK(decision_);
+  return decision_->getDecisionRouteDbFiltered(
+      std::move(*nodeName), std::move(*prefixes));
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::AdjDbs>>
 OpenrCtrlHandler::semifuture_getDecisionAdjacencyDbs() {
   auto filter = std::make_unique<thrift::AdjacenciesFilter>();
@@ -554,12 +1045,34 @@ OpenrCtrlHandler::semifuture_getDecisionAdjacenciesFiltered(
   return decision_->getDecisionAdjacenciesFiltered(std::move(*filter));
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::AdjacencyDbsPage>>
+OpenrCtrlHandler::semifuture_getDecisionAdjacenciesFilteredPage(
+    std::unique_ptr<thrift::AdjacenciesFilter> filter,
+    std::unique_ptr<thrift::PageParams> page) {
+  CHECK(decision_);
+  return decision_->getDecisionAdjacenciesFilteredPage(
+      std::move(*filter), checkPageParams(std::move(page)));
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::PrefixDbs>>
 OpenrCtrlHandler::semifuture_getDecisionPrefixDbs() {
   CHECK(decision_);
   return decision_->getDecisionPrefixDbs();
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::LsdbSnapshot>>
+OpenrCtrlHandler::semifuture_getDecisionLsdbSnapshot(
+    std::unique_ptr<thrift::LsdbSnapshotParams> params) {
+  CHECK(decision_);
+  return decision_->getDecisionLsdbSnapshot(std::move(*params));
+}
+
+folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteDampingState>>>
+OpenrCtrlHandler::semifuture_getRouteDampingStates() {
+  CHECK(decision_);
+  return decision_->getRouteDampingStates();
+}
+
 //
 // KvStore APIs
 //
@@ -602,6 +1115,20 @@ OpenrCtrlHandler::semifuture_getKvStoreKeyValsFilteredArea(
           });
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::KvStorePage>>
+OpenrCtrlHandler::semifuture_getKvStoreKeyValsFilteredAreaPage(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::string> area,
+    std::unique_ptr<thrift::PageParams> page) {
+  CHECK(kvStore_);
+  if (filter->keyValHashes_ref().has_value() or
+      filter->hashTreeLeaves_ref().has_value()) {
+    throw thrift::OpenrError("Full-sync filter can't be paginated");
+  }
+  return kvStore_->dumpKvStoreKeysPage(
+      std::move(*area), std::move(*filter), checkPageParams(std::move(page)));
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::Publication>>
 OpenrCtrlHandler::semifuture_getKvStoreHashFiltered(
     std::unique_ptr<thrift::KeyDumpParams> filter) {
@@ -617,6 +1144,14 @@ OpenrCtrlHandler::semifuture_getKvStoreHashFilteredArea(
   return kvStore_->dumpKvStoreHashes(std::move(*area), std::move(*filter));
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::HashTreeNodes>>
+OpenrCtrlHandler::semifuture_getKvStoreHashTreeArea(
+    std::unique_ptr<thrift::HashTreeParams> params,
+    std::unique_ptr<std::string> area) {
+  CHECK(kvStore_);
+  return kvStore_->getKvStoreHashTree(std::move(*area), std::move(*params));
+}
+
 folly::SemiFuture<folly::Unit>
 OpenrCtrlHandler::semifuture_setKvStoreKeyVals(
     std::unique_ptr<thrift::KeySetParams> setParams,
@@ -636,9 +1171,6 @@ folly::SemiFuture<bool>
 OpenrCtrlHandler::semifuture_longPollKvStoreAdjArea(
     std::unique_ptr<std::string> area,
     std::unique_ptr<thrift::KeyVals> snapshot) {
-  folly::Promise<bool> p;
-  auto sf = p.getSemiFuture();
-
   auto timeStamp = getUnixTimeStampMs();
   auto requestId = pendingRequestId_++;
 
@@ -659,37 +1191,78 @@ OpenrCtrlHandler::semifuture_longPollKvStoreAdjArea(
   // Only dump difference between KvStore and client snapshot
   params.keyValHashes_ref() = std::move(adjKeyVals);
 
-  // Explicitly do SYNC call to KvStore
-  std::unique_ptr<thrift::Publication> thriftPub{nullptr};
-  try {
-    thriftPub = semifuture_getKvStoreKeyValsFilteredArea(
-                    std::make_unique<thrift::KeyDumpParams>(params),
-                    std::make_unique<std::string>(*area))
-                    .get();
-  } catch (std::exception const& ex) {
-    p.setException(thrift::OpenrError(ex.what()));
-    return sf;
-  }
-
-  if (thriftPub->keyVals_ref()->size() > 0) {
-    VLOG(3) << "AdjKey has been added/modified. Notify immediately";
-    p.setValue(true);
-  } else if (
-      thriftPub->tobeUpdatedKeys_ref().has_value() &&
-      thriftPub->tobeUpdatedKeys_ref().value().size() > 0) {
-    VLOG(3) << "AdjKey has been deleted/expired. Notify immediately";
-    p.setValue(true);
-  } else {
-    // Client provided data is consistent with KvStore.
-    // Store req for future processing when there is publication
-    // from KvStore.
-    VLOG(3) << "No adj change detected. Store req as pending request";
-    longPollReqs_.withWLock([&](auto& longPollReq) {
-      longPollReq[*area].emplace(
-          requestId, std::make_pair(std::move(p), timeStamp));
-    });
+  // Chain on KvStore response, thrift worker thread must not block on it
+  auto areaName = *area;
+  return semifuture_getKvStoreKeyValsFilteredArea(
+             std::make_unique<thrift::KeyDumpParams>(std::move(params)),
+             std::move(area))
+      .deferValue([this, areaName = std::move(areaName), requestId, timeStamp](
+                      std::unique_ptr<thrift::Publication> thriftPub) {
+        if (thriftPub->keyVals_ref()->size() > 0) {
+          VLOG(3) << "AdjKey has been added/modified. Notify immediately";
+          return folly::makeSemiFuture(true);
+        }
+        if (thriftPub->tobeUpdatedKeys_ref().has_value() &&
+            thriftPub->tobeUpdatedKeys_ref().value().size() > 0) {
+          VLOG(3) << "AdjKey has been deleted/expired. Notify immediately";
+          return folly::makeSemiFuture(true);
+        }
+
+        // Client provided data is consistent with KvStore.
+        // Store req for future processing when there is publication
+        // from KvStore.
+        VLOG(3) << "No adj change detected. Store req as pending request";
+        folly::Promise<bool> p;
+        auto sf = p.getSemiFuture();
+        longPollReqs_.withWLock([&](auto& longPollReq) {
+          longPollReq[areaName].emplace(
+              requestId, std::make_pair(std::move(p), timeStamp));
+        });
+        scheduleLongPollExpiry();
+        return sf;
+      })
+      .deferError([](folly::exception_wrapper&& ew) -> bool {
+        throw thrift::OpenrError(ew.what().toStdString());
+      });
+}
+
+void
+OpenrCtrlHandler::scheduleLongPollExpiry() {
+  ctrlEvb_->runInEventBaseThread([this]() {
+    if (not longPollExpiryTimer_->isScheduled()) {
+      expireLongPollReqs();
+    }
+  });
+}
+
+void
+OpenrCtrlHandler::expireLongPollReqs() {
+  const auto holdTime = Constants::kLongPollReqHoldTime.count();
+  const auto now = getUnixTimeStampMs();
+  std::optional<int64_t> oldestTimeStamp;
+  longPollReqs_.withWLock([&](auto& longPollReqs) {
+    for (auto& [_, reqs] : longPollReqs) {
+      for (auto it = reqs.begin(); it != reqs.end();) {
+        auto& [p, timeStamp] = it->second;
+        if (now - timeStamp < holdTime) {
+          oldestTimeStamp =
+              std::min(oldestTimeStamp.value_or(timeStamp), timeStamp);
+          ++it;
+          continue;
+        }
+        LOG(INFO) << "Elapsed time: " << now - timeStamp
+                  << " is over hold limit: " << holdTime;
+        // cleanup expired requests since no ADJ change observed
+        p.setValue(false);
+        it = reqs.erase(it);
+      }
+    }
+  });
+
+  if (oldestTimeStamp.has_value()) {
+    longPollExpiryTimer_->scheduleTimeout(
+        std::chrono::milliseconds(*oldestTimeStamp + holdTime - now));
   }
-  return sf;
 }
 
 folly::SemiFuture<folly::Unit>
@@ -730,41 +1303,106 @@ OpenrCtrlHandler::semifuture_getKvStorePeersArea(
   return kvStore_->getKvStorePeers(std::move(*area));
 }
 
-apache::thrift::ServerStream<thrift::Publication>
-OpenrCtrlHandler::subscribeKvStoreFilter(
+template <class T>
+apache::thrift::ServerStream<T>
+OpenrCtrlHandler::subscribeKvStoreFilterImpl(
     std::unique_ptr<thrift::KeyDumpParams> filter,
-    std::unique_ptr<std::set<std::string>> selectAreas) {
+    std::unique_ptr<std::set<std::string>> selectAreas,
+    KvStoreSubscriptionSnapshots* snapshots) {
   // Get new client-ID (monotonically increasing)
   auto clientToken = publisherToken_++;
 
-  auto streamAndPublisher =
-      apache::thrift::ServerStream<thrift::Publication>::createPublisher(
-          [this, clientToken]() {
-            SYNCHRONIZED(kvStorePublishers_) {
-              if (kvStorePublishers_.erase(clientToken)) {
-                LOG(INFO) << "KvStore snoop stream-" << clientToken
-                          << " ended.";
-              } else {
-                LOG(ERROR) << "Can't remove unknown KvStore snoop stream-"
-                           << clientToken;
-              }
-              fb303::fbData->setCounter(
-                  "subscribers.kvstore", kvStorePublishers_.size());
+  auto streamAndPublisher = apache::thrift::ServerStream<T>::createPublisher(
+      [this, clientToken]() {
+        SYNCHRONIZED(kvStorePublishers_) {
+          auto it = kvStorePublishers_.groupKeys.find(clientToken);
+          auto groupIt = it == kvStorePublishers_.groupKeys.end()
+              ? kvStorePublishers_.publishers.end()
+              : kvStorePublishers_.publishers.find(it->second);
+          if (groupIt != kvStorePublishers_.publishers.end() and
+              groupIt->second->removeStream(clientToken)) {
+            LOG(INFO) << "KvStore snoop stream-" << clientToken << " ended.";
+            if (groupIt->second->getNumStreams() == 0) {
+              kvStorePublishers_.publishers.erase(groupIt);
             }
-          });
+          } else {
+            LOG(ERROR) << "Can't remove unknown KvStore snoop stream-"
+                       << clientToken;
+          }
+          if (it != kvStorePublishers_.groupKeys.end()) {
+            kvStorePublishers_.groupKeys.erase(it);
+          }
+          fb303::fbData->setCounter(
+              "subscribers.kvstore", kvStorePublishers_.groupKeys.size());
+          fb303::fbData->setCounter(
+              "subscribers.kvstore.filters",
+              kvStorePublishers_.publishers.size());
+        }
+      });
 
   SYNCHRONIZED(kvStorePublishers_) {
-    assert(kvStorePublishers_.count(clientToken) == 0);
+    assert(kvStorePublishers_.groupKeys.count(clientToken) == 0);
     LOG(INFO) << "KvStore snoop stream-" << clientToken
               << " started for areas: " << folly::join(", ", *selectAreas);
-    auto kvStorePublisher = std::make_unique<KvStorePublisher>(
-        *selectAreas, std::move(*filter), std::move(streamAndPublisher.second));
-    kvStorePublishers_.emplace(clientToken, std::move(kvStorePublisher));
-    fb303::fbData->setCounter("subscribers.kvstore", kvStorePublishers_.size());
+    std::map<std::string, int64_t> resumeSeqNums;
+    if (filter->resumeSeqNums_ref().has_value()) {
+      resumeSeqNums = std::move(*filter->resumeSeqNums_ref());
+      filter->resumeSeqNums_ref().reset();
+    }
+    // Streams with identical filter and areas share publisher
+    auto groupKey = KvStorePublisher::getGroupKey(*selectAreas, *filter);
+    auto& kvStorePublisher = kvStorePublishers_.publishers[groupKey];
+    if (not kvStorePublisher) {
+      kvStorePublisher =
+          std::make_unique<KvStorePublisher>(*selectAreas, std::move(*filter));
+    }
+
+    // snapshots are built under the same lock as publications are logged and
+    // published, so that stream picks up exactly after them
+    for (auto const& area : *selectAreas) {
+      if (not snapshots) {
+        break;
+      }
+      snapshots->seqNums.emplace(area, kvStoreChangeLog_.getLastSeqNum(area));
+      auto it = resumeSeqNums.find(area);
+      if (it == resumeSeqNums.end()) {
+        continue;
+      }
+      auto snapshot = kvStorePublisher->getIncrementalSnapshot(
+          kvStoreChangeLog_, area, it->second);
+      if (snapshot.has_value()) {
+        snapshots->publications.emplace_back(std::move(*snapshot));
+      }
+    }
+    kvStorePublisher->addStream(
+        clientToken, std::move(streamAndPublisher.second));
+    kvStorePublishers_.groupKeys.emplace(clientToken, std::move(groupKey));
+    fb303::fbData->setCounter(
+        "subscribers.kvstore", kvStorePublishers_.groupKeys.size());
+    fb303::fbData->setCounter(
+        "subscribers.kvstore.filters", kvStorePublishers_.publishers.size());
   }
   return std::move(streamAndPublisher.first);
 }
 
+apache::thrift::ServerStream<thrift::Publication>
+OpenrCtrlHandler::subscribeKvStoreFilter(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::set<std::string>> selectAreas,
+    KvStoreSubscriptionSnapshots* snapshots) {
+  return subscribeKvStoreFilterImpl<thrift::Publication>(
+      std::move(filter), std::move(selectAreas), snapshots);
+}
+
+apache::thrift::ServerStream<folly::IOBuf>
+OpenrCtrlHandler::subscribeKvStoreFilterSerialized(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::set<std::string>> selectAreas,
+    KvStoreSubscriptionSnapshots* snapshots) {
+  return subscribeKvStoreFilterImpl<folly::IOBuf>(
+      std::move(filter), std::move(selectAreas), snapshots);
+}
+
 folly::SemiFuture<apache::thrift::ResponseAndServerStream<
     thrift::Publication,
     thrift::Publication>>
@@ -794,27 +1432,78 @@ OpenrCtrlHandler::semifuture_subscribeAndGetKvStoreFiltered(
       });
 }
 
+template <class T>
 folly::SemiFuture<apache::thrift::ResponseAndServerStream<
     std::vector<thrift::Publication>,
-    thrift::Publication>>
-OpenrCtrlHandler::semifuture_subscribeAndGetAreaKvStores(
+    T>>
+OpenrCtrlHandler::subscribeAndGetAreaKvStoresImpl(
     std::unique_ptr<thrift::KeyDumpParams> dumpParams,
     std::unique_ptr<std::set<std::string>> selectAreas) {
   auto dumpParamsCopy = std::make_unique<thrift::KeyDumpParams>(*dumpParams);
   auto selectAreasCopy = std::make_unique<std::set<std::string>>(*selectAreas);
+
+  // Subscribe first. Areas which can be resumed from cursors of the client
+  // get incremental snapshots from change log, the rest is dumped fully.
+  // NOTE: subscription of all areas (empty `selectAreas`) is never resumed
+  KvStoreSubscriptionSnapshots snapshots;
+  auto stream = subscribeKvStoreFilterImpl<T>(
+      std::move(dumpParamsCopy), std::move(selectAreasCopy), &snapshots);
+  for (auto const& pub : snapshots.publications) {
+    selectAreas->erase(pub.get_area());
+  }
+  dumpParams->resumeSeqNums_ref().reset();
+
+  if (not snapshots.publications.empty() and selectAreas->empty()) {
+    return folly::makeSemiFuture(apache::thrift::ResponseAndServerStream<
+                                 std::vector<thrift::Publication>,
+                                 T>{
+        std::move(snapshots.publications), std::move(stream)});
+  }
+
   return kvStore_
       ->dumpKvStoreKeys(std::move(*dumpParams), std::move(*selectAreas))
-      .defer([stream = subscribeKvStoreFilter(
-                  std::move(dumpParamsCopy), std::move(selectAreasCopy))](
+      .defer([stream = std::move(stream),
+              snapshots = std::move(snapshots)](
                  folly::Try<std::unique_ptr<std::vector<thrift::Publication>>>&&
                      pubs) mutable {
         pubs.throwIfFailed();
+        auto& response = *pubs.value();
+        // tag full dumps with cursor of their area
+        for (auto& pub : response) {
+          auto it = snapshots.seqNums.find(pub.get_area());
+          if (it != snapshots.seqNums.end()) {
+            pub.seqNum_ref() = it->second;
+          }
+        }
+        for (auto& pub : snapshots.publications) {
+          response.emplace_back(std::move(pub));
+        }
         return apache::thrift::ResponseAndServerStream<
             std::vector<thrift::Publication>,
-            thrift::Publication>{std::move(*pubs.value()), std::move(stream)};
+            T>{std::move(response), std::move(stream)};
       });
 }
 
+folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+    std::vector<thrift::Publication>,
+    thrift::Publication>>
+OpenrCtrlHandler::semifuture_subscribeAndGetAreaKvStores(
+    std::unique_ptr<thrift::KeyDumpParams> dumpParams,
+    std::unique_ptr<std::set<std::string>> selectAreas) {
+  return subscribeAndGetAreaKvStoresImpl<thrift::Publication>(
+      std::move(dumpParams), std::move(selectAreas));
+}
+
+folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+    std::vector<thrift::Publication>,
+    folly::IOBuf>>
+OpenrCtrlHandler::semifuture_subscribeAndGetAreaKvStoresSerialized(
+    std::unique_ptr<thrift::KeyDumpParams> dumpParams,
+    std::unique_ptr<std::set<std::string>> selectAreas) {
+  return subscribeAndGetAreaKvStoresImpl<folly::IOBuf>(
+      std::move(dumpParams), std::move(selectAreas));
+}
+
 apache::thrift::ServerStream<thrift::RouteDatabaseDelta>
 OpenrCtrlHandler::subscribeFib() {
   // Get new client-ID (monotonically increasing)
@@ -861,6 +1550,55 @@ OpenrCtrlHandler::semifuture_subscribeAndGetFib() {
       });
 }
 
+apache::thrift::ServerStream<folly::IOBuf>
+OpenrCtrlHandler::subscribeFibSerialized() {
+  // Get new client-ID (monotonically increasing)
+  auto clientToken = publisherToken_++;
+
+  auto streamAndPublisher =
+      apache::thrift::ServerStream<folly::IOBuf>::createPublisher(
+          [this, clientToken]() {
+            fibSerializedPublishers_.withWLock([&clientToken](
+                                                   auto& publishers) {
+              if (publishers.erase(clientToken)) {
+                LOG(INFO) << "Serialized Fib snoop stream-" << clientToken
+                          << " ended.";
+              } else {
+                LOG(ERROR) << "Can't remove unknown serialized Fib snoop "
+                           << "stream-" << clientToken;
+              }
+              fb303::fbData->setCounter(
+                  "subscribers.fib_serialized", publishers.size());
+            });
+          });
+
+  fibSerializedPublishers_.withWLock(
+      [&clientToken, &streamAndPublisher](auto& publishers) {
+        assert(publishers.count(clientToken) == 0);
+        LOG(INFO) << "Serialized Fib snoop stream-" << clientToken
+                  << " started.";
+        publishers.emplace(clientToken, std::move(streamAndPublisher.second));
+        fb303::fbData->setCounter(
+            "subscribers.fib_serialized", publishers.size());
+      });
+  return std::move(streamAndPublisher.first);
+}
+
+folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+    thrift::RouteDatabase,
+    folly::IOBuf>>
+OpenrCtrlHandler::semifuture_subscribeAndGetFibSerialized() {
+  auto stream = subscribeFibSerialized();
+  return semifuture_getRouteDb().defer(
+      [stream = std::move(stream)](
+          folly::Try<std::unique_ptr<thrift::RouteDatabase>>&& db) mutable {
+        db.throwIfFailed();
+        return apache::thrift::ResponseAndServerStream<
+            thrift::RouteDatabase,
+            folly::IOBuf>{std::move(*db.value()), std::move(stream)};
+      });
+}
+
 //
 // LinkMonitor APIs
 //
@@ -8,9 +8,12 @@
 #pragma once
 
 #include <fb303/BaseService.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <re2/set.h>
 #include <openr/common/Types.h>
 #include <openr/config-store/PersistentStore.h>
 #include <openr/config/Config.h>
+#include <openr/ctrl-server/OpenrCtrlThreadManager.h>
 #include <openr/decision/Decision.h>
 #include <openr/fib/Fib.h>
 #include <openr/if/gen-cpp2/OpenrCtrlCpp.h>
@@ -40,16 +43,30 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       PersistentStore* configStore,
       PrefixManager* prefixManager,
       Spark* spark,
-      std::shared_ptr<const Config> config);
+      std::shared_ptr<const Config> config,
+      // Queue to deliver reloaded config to modules, reload is not supported
+      // if not set
+      messaging::ReplicateQueue<ConfigPtr>* configUpdatesQueue = nullptr);
 
   ~OpenrCtrlHandler() override;
 
+  /**
+   * Terminate all KvStore, Fib and counter streams, e.g. to release memory
+   * under memory pressure. Clients are expected to resubscribe. Thread safe
+   */
+  void shedStreamSubscribers();
+
   //
   // fb303 service APIs
   //
 
   facebook::fb303::cpp2::fb303_status getStatus() override;
 
+  // Priority of request by its method name, see OpenrCtrlThreadManager
+  apache::thrift::concurrency::PRIORITY getRequestPriority(
+      apache::thrift::Cpp2RequestContext* ctx,
+      apache::thrift::concurrency::PRIORITY prio) override;
+
   void getCounters(std::map<std::string, int64_t>& _return) override;
   void getRegexCounters(
       std::map<std::string, int64_t>& _return,
@@ -73,12 +90,17 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   void dryrunConfig(
       ::std::string& _return, std::unique_ptr<::std::string> file) override;
 
+  void reloadConfig(std::unique_ptr<::std::string> file, bool dryrun) override;
+
   //
   // Monitor APIs
   //
 
   void getEventLogs(std::vector<::std::string>& _return) override;
 
+  folly::SemiFuture<std::unique_ptr<std::string>> semifuture_getProfile(
+      std::unique_ptr<thrift::ProfileParams> params) override;
+
   //
   // PrefixManager APIs
   //
@@ -109,6 +131,11 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   semifuture_getReceivedRoutesFiltered(
       std::unique_ptr<thrift::ReceivedRouteFilter> filter) override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::ReceivedRoutesPage>>
+  semifuture_getReceivedRoutesFilteredPage(
+      std::unique_ptr<thrift::ReceivedRouteFilter> filter,
+      std::unique_ptr<thrift::PageParams> page) override;
+
   //
   // Fib APIs
   //
@@ -116,6 +143,9 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
   semifuture_getRouteDb() override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::RouteDbPage>>
+  semifuture_getRouteDbPage(std::unique_ptr<thrift::PageParams> page) override;
+
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::UnicastRoute>>>
   semifuture_getUnicastRoutesFiltered(
       std::unique_ptr<std::vector<::std::string>> prefixes) override;
@@ -164,12 +194,29 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   semifuture_getDecisionAdjacenciesFiltered(
       std::unique_ptr<thrift::AdjacenciesFilter> filter) override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::AdjacencyDbsPage>>
+  semifuture_getDecisionAdjacenciesFilteredPage(
+      std::unique_ptr<thrift::AdjacenciesFilter> filter,
+      std::unique_ptr<thrift::PageParams> page) override;
+
   folly::SemiFuture<std::unique_ptr<thrift::PrefixDbs>>
   semifuture_getDecisionPrefixDbs() override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::LsdbSnapshot>>
+  semifuture_getDecisionLsdbSnapshot(
+      std::unique_ptr<thrift::LsdbSnapshotParams> params) override;
+
+  folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteDampingState>>>
+  semifuture_getRouteDampingStates() override;
+
   folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
   semifuture_getRouteDbComputed(std::unique_ptr<std::string> nodeName) override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
+  semifuture_getRouteDbComputedFiltered(
+      std::unique_ptr<std::string> nodeName,
+      std::unique_ptr<std::vector<thrift::IpPrefix>> prefixes) override;
+
   //
   // KvStore APIs
   //
@@ -192,6 +239,12 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       std::unique_ptr<thrift::KeyDumpParams> filter,
       std::unique_ptr<std::string> area) override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::KvStorePage>>
+  semifuture_getKvStoreKeyValsFilteredAreaPage(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::string> area,
+      std::unique_ptr<thrift::PageParams> page) override;
+
   folly::SemiFuture<std::unique_ptr<thrift::Publication>>
   semifuture_getKvStoreHashFiltered(
       std::unique_ptr<thrift::KeyDumpParams> filter) override;
@@ -201,6 +254,11 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       std::unique_ptr<thrift::KeyDumpParams> filter,
       std::unique_ptr<std::string> area) override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::HashTreeNodes>>
+  semifuture_getKvStoreHashTreeArea(
+      std::unique_ptr<thrift::HashTreeParams> params,
+      std::unique_ptr<std::string> area) override;
+
   folly::SemiFuture<folly::Unit> semifuture_setKvStoreKeyVals(
       std::unique_ptr<thrift::KeySetParams> setParams,
       std::unique_ptr<std::string> area) override;
@@ -225,12 +283,28 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   // Stream API's
   // Intentionally not use SemiFuture as stream is async by nature and we will
   // immediately create and return the stream handler
+  //
+  // If `snapshots` is given, it is filled with incremental snapshots of areas
+  // that can be resumed from `resumeSeqNums` of the filter, and with the
+  // cursor of every selected area at the time of subscription
   apache::thrift::ServerStream<thrift::Publication> subscribeKvStoreFilter(
       std::unique_ptr<thrift::KeyDumpParams> filter,
-      std::unique_ptr<std::set<std::string>> selectAreas);
+      std::unique_ptr<std::set<std::string>> selectAreas,
+      KvStoreSubscriptionSnapshots* snapshots = nullptr);
+
+  // Stream of CompactSerializer serialized publications. Every publication
+  // is filtered and serialized once for all subscribers with the same filter
+  apache::thrift::ServerStream<folly::IOBuf> subscribeKvStoreFilterSerialized(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas,
+      KvStoreSubscriptionSnapshots* snapshots = nullptr);
 
   apache::thrift::ServerStream<thrift::RouteDatabaseDelta> subscribeFib();
 
+  // Stream of CompactSerializer serialized Fib deltas. Every delta is
+  // serialized once and shared by all subscribers
+  apache::thrift::ServerStream<folly::IOBuf> subscribeFibSerialized();
+
   folly::SemiFuture<apache::thrift::ResponseAndServerStream<
       thrift::Publication,
       thrift::Publication>>
@@ -249,11 +323,38 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       std::unique_ptr<thrift::KeyDumpParams> filter,
       std::unique_ptr<std::set<std::string>> selectAreas) override;
 
+  folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+      std::vector<thrift::Publication>,
+      folly::IOBuf>>
+  semifuture_subscribeAndGetAreaKvStoresSerialized(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas) override;
+
   folly::SemiFuture<apache::thrift::ResponseAndServerStream<
       thrift::RouteDatabase,
       thrift::RouteDatabaseDelta>>
   semifuture_subscribeAndGetFib() override;
 
+  folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+      thrift::RouteDatabase,
+      folly::IOBuf>>
+  semifuture_subscribeAndGetFibSerialized() override;
+
+  // Counters are matched on subscription and published from ctrlEvb thread
+  folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+      std::map<std::string, int64_t>,
+      std::map<std::string, int64_t>>>
+  semifuture_subscribeAndGetCounters(
+      std::unique_ptr<thrift::CountersSubscriptionParams> params) override;
+
+  // Sections are requested from all modules at once and published from
+  // ctrlEvb thread as they complete
+  folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+      thrift::TechSupportHeader,
+      thrift::TechSupportSection>>
+  semifuture_getTechSupportSnapshot(
+      std::unique_ptr<thrift::TechSupportParams> params) override;
+
   // Long poll support
   folly::SemiFuture<bool> semifuture_longPollKvStoreAdj(
       std::unique_ptr<thrift::KeyVals> snapshot) override;
@@ -332,7 +433,18 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
 
   inline size_t
   getNumKvStorePublishers() {
-    return kvStorePublishers_.wlock()->size();
+    return kvStorePublishers_.wlock()->groupKeys.size();
+  }
+
+  // Number of distinct filters among KvStore streams
+  inline size_t
+  getNumKvStorePublisherGroups() {
+    return kvStorePublishers_.wlock()->publishers.size();
+  }
+
+  inline size_t
+  getNumCountersSubscriptions() {
+    return countersSubscriptions_.rlock()->size();
   }
 
   inline size_t
@@ -342,7 +454,8 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
 
   inline size_t
   getNumFibPublishers() {
-    return fibPublishers_.wlock()->size();
+    return fibPublishers_.wlock()->size() +
+        fibSerializedPublishers_.wlock()->size();
   }
 
   //
@@ -354,17 +467,55 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   }
 
  private:
+  // load and validate config file, throws thrift::OpenrError upon error
+  static std::shared_ptr<const Config> loadConfigOrThrow(
+      std::unique_ptr<std::string> const& file);
+
   // returns the single area name configured for this node or throws if not
   // eaxclty 1 area is configured
   std::unique_ptr<std::string> getSingleAreaOrThrow(std::string const& caller);
 
   void authorizeConnection();
+
+  // validate page params of paginated dump and cap page size, or throws an
+  // instance of OpenrError
+  static thrift::PageParams checkPageParams(
+      std::unique_ptr<thrift::PageParams> page);
+
+  // Add stream of KvStore publications to the publisher of its filter
+  template <class T>
+  apache::thrift::ServerStream<T> subscribeKvStoreFilterImpl(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas,
+      KvStoreSubscriptionSnapshots* snapshots);
+
+  template <class T>
+  folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+      std::vector<thrift::Publication>,
+      T>>
+  subscribeAndGetAreaKvStoresImpl(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas);
+
+  // Answer long-poll requests held beyond kLongPollReqHoldTime and schedule
+  // expiry timer for the oldest remaining one. Runs in ctrlEvb thread
+  void expireLongPollReqs();
+
+  // Schedule expiry timer unless already scheduled. Thread safe
+  void scheduleLongPollExpiry();
+  // Publish changed counters of subscriptions due and schedule timer for
+  // the next one. Runs in ctrlEvb thread
+  void publishCounters();
   void closeKvStorePublishers();
   void closeFibPublishers();
+  void closeCountersPublishers();
 
   const std::string nodeName_;
   const std::unordered_set<std::string> acceptablePeerCommonNames_;
 
+  // Event base of ctrl module, runs timers of handler
+  OpenrEventBase* ctrlEvb_{nullptr};
+
   // Pointers to Open/R modules
   Decision* decision_{nullptr};
   Fib* fib_{nullptr};
@@ -374,15 +525,30 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   PersistentStore* configStore_{nullptr};
   PrefixManager* prefixManager_{nullptr};
   Spark* spark_{nullptr};
-  std::shared_ptr<const Config> config_;
+  // NOTE: Replaced on config reload
+  folly::Synchronized<std::shared_ptr<const Config>> config_;
+  messaging::ReplicateQueue<ConfigPtr>* configUpdatesQueue_{nullptr};
+
+  // Priority of requests by method name
+  const std::unordered_map<std::string, apache::thrift::concurrency::PRIORITY>
+      methodPriorities_;
 
   // Publisher token (monotonically increasing) for all publishers
   std::atomic<int64_t> publisherToken_{0};
 
-  // Active kvstore snoop publishers
-  folly::Synchronized<
-      std::unordered_map<int64_t, std::unique_ptr<KvStorePublisher>>>
-      kvStorePublishers_;
+  // Active kvstore snoop streams, grouped into publishers by filter
+  struct KvStorePublishers {
+    // publishers by group key of their filter and areas
+    std::unordered_map<std::string, std::unique_ptr<KvStorePublisher>>
+        publishers;
+    // group key of publisher for every stream by client token
+    std::unordered_map<int64_t, std::string> groupKeys;
+  };
+  folly::Synchronized<KvStorePublishers> kvStorePublishers_;
+
+  // Recent KvStore publications to resume subscriptions from. Guarded by the
+  // lock of `kvStorePublishers_`
+  KvStoreChangeLog kvStoreChangeLog_;
 
   // Active Fib streaming publishers
   folly::Synchronized<std::unordered_map<
@@ -390,6 +556,42 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       apache::thrift::ServerStreamPublisher<thrift::RouteDatabaseDelta>>>
       fibPublishers_;
 
+  // Active Fib streaming publishers of serialized deltas
+  folly::Synchronized<std::unordered_map<
+      int64_t,
+      apache::thrift::ServerStreamPublisher<folly::IOBuf>>>
+      fibSerializedPublishers_;
+
+  // Counter subscription with compiled matchers and last published values
+  struct CountersSubscription {
+    CountersSubscription(
+        apache::thrift::ServerStreamPublisher<std::map<std::string, int64_t>>&&
+            publisher,
+        std::chrono::milliseconds interval)
+        : publisher(std::move(publisher)), interval(interval) {}
+
+    // True if counter of name is selected, memoized per name
+    bool isSelected(const std::string& name);
+
+    apache::thrift::ServerStreamPublisher<std::map<std::string, int64_t>>
+        publisher;
+    const std::chrono::milliseconds interval;
+    std::chrono::steady_clock::time_point nextPublishTime;
+    std::unordered_set<std::string> keys;
+    // unset if no regexes are given
+    std::unique_ptr<re2::RE2::Set> regexes;
+    bool selectAll{false};
+    std::unordered_map<std::string, bool> isSelectedCache;
+    std::unordered_map<std::string, int64_t> lastValues;
+  };
+
+  // Active counter subscriptions by client token
+  folly::Synchronized<std::unordered_map<int64_t, CountersSubscription>>
+      countersSubscriptions_;
+
+  // Timer to publish counters of subscriptions. Owned by ctrlEvb thread
+  std::unique_ptr<folly::AsyncTimeout> countersPublishTimer_;
+
   // pending longPoll requests from clients, which consists of
   // 1). promise; 2). timestamp when req received on server
   std::atomic<int64_t> pendingRequestId_{0};
@@ -398,6 +600,9 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       std::unordered_map<int64_t, std::pair<folly::Promise<bool>, int64_t>>>>
       longPollReqs_;
 
+  // Timer to expire pending longPoll requests. Owned by ctrlEvb thread
+  std::unique_ptr<folly::AsyncTimeout> longPollExpiryTimer_;
+
   // fiber task future hold for kvStore update, fib update reader's
   std::vector<folly::Future<folly::Unit>> workers_;
 }; // class OpenrCtrlHandler
@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/ctrl-server/OpenrCtrlThreadManager.h>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <fb303/ServiceData.h>
+#include <folly/Conv.h>
+#include <folly/Format.h>
+#include <glog/logging.h>
+
+namespace fb303 = facebook::fb303;
+
+using apache::thrift::concurrency::PRIORITY;
+using apache::thrift::concurrency::PriorityThreadManager;
+using apache::thrift::concurrency::ThreadManager;
+
+namespace openr {
+
+constexpr folly::StringPiece OpenrCtrlThreadManager::kNamePrefix;
+
+namespace {
+
+// Requests served ahead of others, they change state of Open/R
+const std::vector<std::string> kHighPriorityMethods{
+    "advertisePrefixes",
+    "withdrawPrefixes",
+    "withdrawPrefixesByType",
+    "syncPrefixesByType",
+    "setKvStoreKeyVals",
+    "processKvStoreDualMessage",
+    "updateFloodTopologyChild",
+    "setNodeOverload",
+    "unsetNodeOverload",
+    "setInterfaceOverload",
+    "unsetInterfaceOverload",
+    "setInterfaceMetric",
+    "unsetInterfaceMetric",
+    "setAdjacencyMetric",
+    "unsetAdjacencyMetric",
+    "setConfigKey",
+    "eraseConfigKey",
+    "floodRestartingMsg",
+    "setRibPolicy",
+};
+
+// Unbounded dumps of whole databases. Paginated variants stay NORMAL
+const std::vector<std::string> kBestEffortMethods{
+    "getAdvertisedRoutes",
+    "getAdvertisedRoutesFiltered",
+    "getReceivedRoutes",
+    "getReceivedRoutesFiltered",
+    "getRouteDb",
+    "getRouteDbComputed",
+    "getUnicastRoutes",
+    "getUnicastRoutesFiltered",
+    "getMplsRoutes",
+    "getMplsRoutesFiltered",
+    "getDecisionAdjacencyDbs",
+    "getDecisionAdjacenciesFiltered",
+    "getDecisionPrefixDbs",
+    "getDecisionLsdbSnapshot",
+    "getKvStoreKeyValsFiltered",
+    "getKvStoreKeyValsFilteredArea",
+    "getKvStoreHashFiltered",
+    "getKvStoreHashFilteredArea",
+    "getEventLogs",
+    "getProfile",
+    "subscribeAndGetKvStore",
+    "subscribeAndGetKvStoreFiltered",
+    "subscribeAndGetAreaKvStores",
+    "subscribeAndGetAreaKvStoresSerialized",
+    "subscribeAndGetFib",
+    "subscribeAndGetFibSerialized",
+};
+
+std::string
+getPriorityName(PRIORITY priority) {
+  switch (priority) {
+  case PRIORITY::HIGH:
+    return "high";
+  case PRIORITY::NORMAL:
+    return "normal";
+  case PRIORITY::BEST_EFFORT:
+    return "best_effort";
+  default:
+    return folly::to<std::string>(static_cast<int>(priority));
+  }
+}
+
+/**
+ * Export time tasks of pools of OpenrCtrl thread manager waited in queue.
+ * ThreadManager names the pool of priority N `<prefix>-pri<N>`.
+ */
+class QueueWaitObserver final : public ThreadManager::Observer {
+ public:
+  QueueWaitObserver() {
+    for (const auto priority :
+         {PRIORITY::HIGH, PRIORITY::NORMAL, PRIORITY::BEST_EFFORT}) {
+      const auto name = getPriorityName(priority);
+      const auto poolName = folly::sformat(
+          "{}-pri{}",
+          OpenrCtrlThreadManager::kNamePrefix,
+          static_cast<int>(priority));
+      counterNames_.emplace(
+          poolName, folly::sformat("ctrl.queue_wait_ms.{}", name));
+      fb303::fbData->addStatExportType(
+          counterNames_.at(poolName), fb303::AVG);
+      fb303::fbData->addStatExportType(
+          counterNames_.at(poolName), fb303::MAX);
+    }
+  }
+
+  void
+  preRun(folly::RequestContext*) override {}
+
+  void
+  postRun(
+      folly::RequestContext*, const ThreadManager::RunStats& stats) override {
+    auto it = counterNames_.find(stats.threadPoolName);
+    if (it == counterNames_.end()) {
+      // Task of another thread manager
+      return;
+    }
+    fb303::fbData->addStatValue(
+        it->second,
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            stats.runBegin - stats.queueBegin)
+            .count());
+  }
+
+ private:
+  // Counter name by pool name. Immutable after construction
+  std::unordered_map<std::string, std::string> counterNames_;
+};
+
+} // namespace
+
+std::shared_ptr<ThreadManager>
+OpenrCtrlThreadManager::create(const thrift::CtrlServerConfig& config) {
+  // Priorities not served by OpenrCtrl get a single idle thread
+  std::array<size_t, apache::thrift::concurrency::N_PRIORITIES> counts;
+  counts.fill(1);
+  counts[PRIORITY::HIGH] = *config.high_priority_threads_ref();
+  counts[PRIORITY::NORMAL] = *config.normal_priority_threads_ref();
+  counts[PRIORITY::BEST_EFFORT] = *config.best_effort_threads_ref();
+
+  // NOTE: Task stats are needed to observe queue wait time
+  auto threadManager = PriorityThreadManager::newPriorityThreadManager(
+      counts, true /* task stats */);
+  threadManager->setNamePrefix(kNamePrefix.str());
+  ThreadManager::setObserver(std::make_shared<QueueWaitObserver>());
+  threadManager->start();
+
+  LOG(INFO) << "Started OpenrCtrl thread manager with "
+            << counts[PRIORITY::HIGH] << " high, " << counts[PRIORITY::NORMAL]
+            << " normal and " << counts[PRIORITY::BEST_EFFORT]
+            << " best effort priority threads";
+  return threadManager;
+}
+
+std::unordered_map<std::string, PRIORITY>
+OpenrCtrlThreadManager::getMethodPriorities(
+    const thrift::CtrlServerConfig& config) {
+  std::unordered_map<std::string, PRIORITY> priorities;
+  for (const auto& method : kHighPriorityMethods) {
+    priorities.emplace(method, PRIORITY::HIGH);
+  }
+  for (const auto& method : kBestEffortMethods) {
+    priorities.emplace(method, PRIORITY::BEST_EFFORT);
+  }
+  for (const auto& [method, priority] : *config.method_priorities_ref()) {
+    priorities[method] = toThreadPriority(priority);
+  }
+  return priorities;
+}
+
+PRIORITY
+OpenrCtrlThreadManager::toThreadPriority(thrift::CtrlRequestPriority priority) {
+  switch (priority) {
+  case thrift::CtrlRequestPriority::HIGH:
+    return PRIORITY::HIGH;
+  case thrift::CtrlRequestPriority::BEST_EFFORT:
+    return PRIORITY::BEST_EFFORT;
+  case thrift::CtrlRequestPriority::NORMAL:
+  default:
+    return PRIORITY::NORMAL;
+  }
+}
+
+} // namespace openr
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <folly/Range.h>
+#include <thrift/lib/cpp/concurrency/ThreadManager.h>
+
+#include <openr/if/gen-cpp2/OpenrConfig_types.h>
+
+namespace openr {
+
+/**
+ * Worker threads of OpenrCtrl thrift server. Requests of every priority of
+ * thrift::CtrlRequestPriority are served by a separate pool, hence e.g.
+ * full KvStore dumps don't queue up ahead of prefix advertisements.
+ *
+ * Time requests wait in queue of each pool before they get served is
+ * exported as `ctrl.queue_wait_ms.<priority>`.
+ */
+class OpenrCtrlThreadManager final {
+ public:
+  // Name prefix of the worker threads
+  static constexpr folly::StringPiece kNamePrefix{"OpenrCtrlPool"};
+
+  /**
+   * Create and start priority thread manager with the number of threads per
+   * priority of config. Registers observer of queue wait time of its pools.
+   */
+  static std::shared_ptr<apache::thrift::concurrency::ThreadManager> create(
+      const thrift::CtrlServerConfig& config);
+
+  /**
+   * Priority of OpenrCtrl methods by method name. Defaults are overridden by
+   * `method_priorities` of config. Methods not in the map are served with
+   * NORMAL priority.
+   */
+  static std::unordered_map<
+      std::string,
+      apache::thrift::concurrency::PRIORITY>
+  getMethodPriorities(const thrift::CtrlServerConfig& config);
+
+  static apache::thrift::concurrency::PRIORITY toThreadPriority(
+      thrift::CtrlRequestPriority priority);
+};
+
+} // namespace openr
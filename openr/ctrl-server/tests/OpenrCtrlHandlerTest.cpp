@@ -8,10 +8,13 @@
 #include <cstdio>
 #include <thread>
 
+#include <fb303/ServiceData.h>
 #include <fbzmq/zmq/Context.h>
 #include <folly/init/Init.h>
+#include <folly/synchronization/Baton.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/Constants.h>
 #include <openr/common/OpenrClient.h>
@@ -138,7 +141,7 @@ class OpenrCtrlFixture : public ::testing::Test {
         peerUpdatesQueue_,
         logSampleQueue_,
         neighborUpdatesQueue_.getReader(),
-        nlSock_->getReader(),
+        nlSock_->getBatchReader(),
         false, /* assumeDrained */
         false, /* overrideDrainState */
         std::chrono::seconds(1));
@@ -229,7 +232,7 @@ class OpenrCtrlFixture : public ::testing::Test {
   }
 
  private:
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue_;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue_;
   messaging::ReplicateQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue_;
   messaging::ReplicateQueue<thrift::PeerUpdateRequest> peerUpdatesQueue_;
   messaging::ReplicateQueue<thrift::SparkNeighborEvent> neighborUpdatesQueue_;
@@ -485,6 +488,49 @@ TEST_F(OpenrCtrlFixture, KvStoreApis) {
     EXPECT_EQ(keyVals.at("key333"), pub.keyVals_ref()["key333"]);
   }
 
+  // paginated
+  {
+    thrift::KeyDumpParams params;
+    params.keys_ref() = {"key"};
+    thrift::PageParams page;
+    page.pageSize_ref() = 4;
+    std::vector<std::string> keys;
+    size_t numPages{0};
+    do {
+      thrift::KvStorePage kvStorePage;
+      openrCtrlThriftClient_->sync_getKvStoreKeyValsFilteredAreaPage(
+          kvStorePage, params, kSpineAreaId, page);
+      auto const& pub = *kvStorePage.publication_ref();
+      EXPECT_LE(pub.keyVals_ref()->size(), 4);
+      for (auto const& [key, val] : *pub.keyVals_ref()) {
+        EXPECT_EQ(keyVals.at(key), val);
+        keys.emplace_back(key);
+      }
+      page.cursor_ref().copy_from(kvStorePage.nextCursor_ref());
+      ++numPages;
+    } while (page.cursor_ref().has_value());
+    EXPECT_EQ(3, numPages);
+    EXPECT_THAT(
+        keys,
+        testing::ElementsAre(
+            "key1",
+            "key11",
+            "key111",
+            "key2",
+            "key22",
+            "key222",
+            "key3",
+            "key33",
+            "key333"));
+
+    page.pageSize_ref() = 0;
+    thrift::KvStorePage kvStorePage;
+    EXPECT_THROW(
+        openrCtrlThriftClient_->sync_getKvStoreKeyValsFilteredAreaPage(
+            kvStorePage, params, kSpineAreaId, page),
+        thrift::OpenrError);
+  }
+
   // with areas
   {
     thrift::Publication pub;
@@ -907,9 +953,10 @@ TEST_F(OpenrCtrlFixture, subscribeAndGetKvStoreFilteredWithKeysNoTtlUpdate) {
                   received++;
                 });
 
-    /* There are two clients */
+    /* There are two clients, sharing publisher of same filter */
     EXPECT_EQ(2, handler->getNumKvStorePublishers());
     EXPECT_EQ(2, handler_other->getNumKvStorePublishers());
+    EXPECT_EQ(1, handler->getNumKvStorePublisherGroups());
 
     /* key4 and random_prefix keys are getting added for the first time */
     kvStoreWrapper_->setKey(
@@ -1771,6 +1818,232 @@ TEST_F(OpenrCtrlFixture, subscribeAndGetKvStoreFilteredWithoutValue) {
   }
 }
 
+//
+// Streams with identical filter share publisher, serialized stream receives
+// the same filtered publications as the typed one
+//
+TEST_F(OpenrCtrlFixture, subscribeAndGetAreaKvStoresSerialized) {
+  thrift::KeyDumpParams filter;
+  filter.keys_ref() = {"key"};
+  filter.doNotPublishValue_ref() = true;
+  thrift::KeyDumpParams otherFilter;
+  otherFilter.keys_ref() = {"other"};
+
+  auto handler = openrThriftServerWrapper_->getOpenrCtrlHandler();
+  auto responseAndSubscription =
+      handler
+          ->semifuture_subscribeAndGetAreaKvStores(
+              std::make_unique<thrift::KeyDumpParams>(filter),
+              std::make_unique<std::set<std::string>>(kSpineOnlySet))
+          .get();
+  auto responseAndSubscriptionSerialized =
+      handler
+          ->semifuture_subscribeAndGetAreaKvStoresSerialized(
+              std::make_unique<thrift::KeyDumpParams>(filter),
+              std::make_unique<std::set<std::string>>(kSpineOnlySet))
+          .get();
+  auto responseAndSubscriptionOther =
+      handler
+          ->semifuture_subscribeAndGetAreaKvStoresSerialized(
+              std::make_unique<thrift::KeyDumpParams>(otherFilter),
+              std::make_unique<std::set<std::string>>(kSpineOnlySet))
+          .get();
+
+  EXPECT_EQ(3, handler->getNumKvStorePublishers());
+  EXPECT_EQ(2, handler->getNumKvStorePublisherGroups());
+
+  std::atomic<int> received{0};
+  std::atomic<int> receivedSerialized{0};
+  std::atomic<int> receivedOther{0};
+  auto subscription =
+      std::move(responseAndSubscription.stream)
+          .toClientStreamUnsafeDoNotUse()
+          .subscribeExTry(folly::getEventBase(), [&received](auto&& t) {
+            if (not t.hasValue() or not t->keyVals_ref()->count("key1")) {
+              return;
+            }
+            EXPECT_FALSE(t->keyVals_ref()->at("key1").value_ref().has_value());
+            received++;
+          });
+  auto subscriptionSerialized =
+      std::move(responseAndSubscriptionSerialized.stream)
+          .toClientStreamUnsafeDoNotUse()
+          .subscribeExTry(
+              folly::getEventBase(), [&receivedSerialized](auto&& t) {
+                if (not t.hasValue()) {
+                  return;
+                }
+                auto pub = apache::thrift::CompactSerializer::deserialize<
+                    thrift::Publication>(&*t);
+                if (not pub.keyVals_ref()->count("key1")) {
+                  return;
+                }
+                EXPECT_EQ(kSpineAreaId.t, pub.get_area());
+                EXPECT_FALSE(
+                    pub.keyVals_ref()->at("key1").value_ref().has_value());
+                receivedSerialized++;
+              });
+  auto subscriptionOther =
+      std::move(responseAndSubscriptionOther.stream)
+          .toClientStreamUnsafeDoNotUse()
+          .subscribeExTry(folly::getEventBase(), [&receivedOther](auto&& t) {
+            if (not t.hasValue()) {
+              return;
+            }
+            auto pub = apache::thrift::CompactSerializer::deserialize<
+                thrift::Publication>(&*t);
+            if (pub.keyVals_ref()->count("other1")) {
+              EXPECT_EQ(0, pub.keyVals_ref()->count("key1"));
+              receivedOther++;
+            }
+          });
+
+  kvStoreWrapper_->setKey(
+      kSpineAreaId, "key1", createThriftValue(1, "node1", std::string("v1")));
+  kvStoreWrapper_->setKey(
+      kSpineAreaId,
+      "other1",
+      createThriftValue(1, "node1", std::string("v1")));
+
+  while (received < 1 or receivedSerialized < 1 or receivedOther < 1) {
+    std::this_thread::yield();
+  }
+
+  // Publisher of filter is retained until its last stream ends
+  subscription.cancel();
+  std::move(subscription).detach();
+  while (handler->getNumKvStorePublishers() != 2) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(2, handler->getNumKvStorePublisherGroups());
+
+  subscriptionSerialized.cancel();
+  std::move(subscriptionSerialized).detach();
+  subscriptionOther.cancel();
+  std::move(subscriptionOther).detach();
+  while (handler->getNumKvStorePublishers() != 0) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(0, handler->getNumKvStorePublisherGroups());
+}
+
+TEST_F(OpenrCtrlFixture, subscribeAndGetCounters) {
+  facebook::fb303::fbData->setCounter("test.counters.key", 1);
+  facebook::fb303::fbData->setCounter("test.counters.regex1", 1);
+  facebook::fb303::fbData->setCounter("test.counters.other", 1);
+
+  auto handler = openrThriftServerWrapper_->getOpenrCtrlHandler();
+
+  // Invalid regex is rejected
+  {
+    auto params = std::make_unique<thrift::CountersSubscriptionParams>();
+    params->regexes_ref() = {"test.counters.("};
+    EXPECT_THROW(
+        handler->semifuture_subscribeAndGetCounters(std::move(params)).get(),
+        thrift::OpenrError);
+  }
+
+  auto params = std::make_unique<thrift::CountersSubscriptionParams>();
+  params->keys_ref() = {"test.counters.key"};
+  params->regexes_ref() = {"test\\.counters\\.regex[0-9]"};
+  params->intervalMs_ref() = 0; // raised to min interval
+  auto responseAndSubscription =
+      handler->semifuture_subscribeAndGetCounters(std::move(params)).get();
+  EXPECT_EQ(
+      (std::map<std::string, int64_t>{
+          {"test.counters.key", 1}, {"test.counters.regex1", 1}}),
+      responseAndSubscription.response);
+
+  // Only changed counters are published. Changes may be split across
+  // publications if timer fires in between
+  const std::map<std::string, int64_t> expected{
+      {"test.counters.key", 2}, {"test.counters.regex2", 1}};
+  folly::Synchronized<std::map<std::string, int64_t>> received;
+  auto subscription =
+      std::move(responseAndSubscription.stream)
+          .toClientStreamUnsafeDoNotUse()
+          .subscribeExTry(folly::getEventBase(), [&received](auto&& t) {
+            if (not t.hasValue()) {
+              return;
+            }
+            EXPECT_FALSE(t->empty());
+            received.withWLock([&t](auto& counters) {
+              for (const auto& [name, value] : *t) {
+                EXPECT_EQ(0, counters.count(name));
+                counters.emplace(name, value);
+              }
+            });
+          });
+  EXPECT_EQ(1, handler->getNumCountersSubscriptions());
+
+  facebook::fb303::fbData->setCounter("test.counters.key", 2);
+  facebook::fb303::fbData->setCounter("test.counters.regex2", 1);
+  facebook::fb303::fbData->setCounter("test.counters.other", 2);
+  while (*received.rlock() != expected) {
+    EXPECT_LE(received.rlock()->size(), expected.size());
+    std::this_thread::yield();
+  }
+
+  subscription.cancel();
+  std::move(subscription).detach();
+  while (handler->getNumCountersSubscriptions() != 0) {
+    std::this_thread::yield();
+  }
+}
+
+TEST_F(OpenrCtrlFixture, getTechSupportSnapshot) {
+  auto handler = openrThriftServerWrapper_->getOpenrCtrlHandler();
+  auto params = std::make_unique<thrift::TechSupportParams>();
+  params->includeRoutes_ref() = true;
+  params->compression_ref() = thrift::CompressionType::NONE;
+  auto responseAndStream =
+      handler->semifuture_getTechSupportSnapshot(std::move(params)).get();
+  EXPECT_EQ(nodeName_, *responseAndStream.response.nodeName_ref());
+
+  folly::Synchronized<std::vector<thrift::TechSupportSection>> sections;
+  folly::Baton<> completed;
+  auto subscription =
+      std::move(responseAndStream.stream)
+          .toClientStreamUnsafeDoNotUse()
+          .subscribeExTry(
+              folly::getEventBase(), [&sections, &completed](auto&& t) {
+                if (not t.hasValue()) {
+                  EXPECT_FALSE(t.hasException());
+                  completed.post();
+                  return;
+                }
+                sections.wlock()->emplace_back(std::move(*t));
+              });
+  completed.wait();
+  std::move(subscription).detach();
+
+  // per-area sections are published for every area
+  std::multiset<std::string> names;
+  for (auto const& section : *sections.rlock()) {
+    EXPECT_FALSE(section.error_ref().has_value()) << *section.name_ref();
+    EXPECT_EQ(thrift::CompressionType::NONE, *section.codec_ref());
+    names.emplace(*section.name_ref());
+
+    apache::thrift::CompactSerializer serializer;
+    auto payload = readThriftObjStr<thrift::TechSupportPayload>(
+        *section.payload_ref(), serializer);
+    if (*section.name_ref() == "config") {
+      EXPECT_EQ(nodeName_, *payload.get_config().node_name_ref());
+    }
+  }
+  for (auto const& name :
+       {"config",
+        "counters",
+        "kvstore_peers",
+        "kvstore_key_vals",
+        "decision_routes",
+        "fib_routes"}) {
+    EXPECT_EQ(
+        std::string(name).find("kvstore_") == 0 ? 3 : 1, names.count(name))
+        << name;
+  }
+}
+
 TEST_F(OpenrCtrlFixture, LinkMonitorApis) {
   // create an interface
   auto nlEventsInjector =
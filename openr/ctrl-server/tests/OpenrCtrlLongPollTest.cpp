@@ -242,6 +242,8 @@ TEST_F(LongPollFixture, LongPollAdjUnchanged) {
   //
   bool isTimeout = false;
   bool isAdjChanged = true;
+  std::chrono::steady_clock::time_point startTime;
+  std::chrono::steady_clock::time_point endTime;
 
   // inject key to kvstore and openrCtrlThriftServer should have adj key
   kvStoreWrapper_->setKey(
@@ -249,8 +251,8 @@ TEST_F(LongPollFixture, LongPollAdjUnchanged) {
       adjKey_,
       createThriftValue(1, nodeName_, std::string("value1")));
 
-  // mimick there is a new publication from kvstore.
-  // This publication should clean up pending req.
+  // mimick there is a new publication from kvstore after pending req expired.
+  // Expiry is timer driven and must not wait for this publication.
   evl_.scheduleTimeout(
       Constants::kLongPollReqHoldTime + std::chrono::milliseconds(5000),
       [&]() noexcept {
@@ -274,8 +276,10 @@ TEST_F(LongPollFixture, LongPollAdjUnchanged) {
         adjKey_, createThriftValue(1, nodeName_, std::string("value1")));
 
     LOG(INFO) << "Start long poll...";
+    startTime = std::chrono::steady_clock::now();
     isAdjChanged =
         client2_->sync_longPollKvStoreAdjArea(kTestingAreaName, snapshot);
+    endTime = std::chrono::steady_clock::now();
     LOG(INFO) << "Finished long poll...";
   } catch (std::exception& ex) {
     LOG(INFO) << "Exception happened: " << folly::exceptionStr(ex);
@@ -284,6 +288,11 @@ TEST_F(LongPollFixture, LongPollAdjUnchanged) {
 
   ASSERT_FALSE(isAdjChanged);
   ASSERT_FALSE(isTimeout);
+  // answered on expiry, ahead of publication
+  ASSERT_GE(endTime - startTime, Constants::kLongPollReqHoldTime);
+  ASSERT_LT(
+      endTime - startTime,
+      Constants::kLongPollReqHoldTime + std::chrono::milliseconds(5000));
 
   // wait for evl before cleanup
   evl_.waitUntilStopped();
@@ -7,18 +7,29 @@
 
 #include "Decision.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <map>
+#include <memory_resource>
 #include <set>
 #include <string>
+#include <tuple>
 #include <unordered_set>
 
 #include <fb303/ServiceData.h>
+#include <folly/FileUtil.h>
 #include <folly/Format.h>
 #include <folly/MapUtil.h>
 #include <folly/Memory.h>
 #include <folly/Optional.h>
+#include <folly/ScopeGuard.h>
 #include <folly/String.h>
+#include <folly/Synchronized.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/futures/Future.h>
+#include <folly/system/MemoryMapping.h>
+#include <folly/tracing/StaticTracepoint.h>
 #if FOLLY_USE_SYMBOLIZER
 #include <folly/experimental/exception_tracer/ExceptionTracer.h>
 #endif
@@ -26,6 +37,7 @@
 #include <openr/common/Constants.h>
 #include <openr/common/NetworkUtil.h>
 #include <openr/common/Util.h>
+#include <openr/decision/LsdbSnapshot.h>
 #include <openr/decision/PrefixState.h>
 #include <openr/decision/RibEntry.h>
 
@@ -39,6 +51,76 @@ using SpfResult = openr::LinkState::SpfResult;
 
 namespace openr {
 
+namespace {
+
+// Names of route computation phases in histograms and perf events, indexed
+// by SpfSolver::RouteBuildPhase
+const std::array<
+    std::pair<folly::StringPiece, folly::StringPiece>,
+    SpfSolver::kNumRouteBuildPhases>
+    kRouteBuildPhaseNames{{
+        {"spf", "DECISION_SPF"},
+        {"best_route_selection", "DECISION_BEST_ROUTE_SELECTION"},
+        {"nexthops", "DECISION_NEXTHOPS"},
+        {"mpls_routes", "DECISION_MPLS_ROUTES"},
+        {"calculate_update", "DECISION_CALCULATE_UPDATE"},
+    }};
+
+// Histogram of worst convergence time flooded by nodes in `convtime:` keys
+const std::string kNetworkConvergenceHistogram{
+    "decision.network_convergence_time_ms"};
+
+std::string
+getRouteBuildPhaseHistogram(size_t phase) {
+  return folly::sformat(
+      "decision.route_build_phase_us.{}", kRouteBuildPhaseNames[phase].first);
+}
+
+// Size of scratch buffer of every thread computing routes. Temporaries of
+// most route computations fit in, larger ones overflow to the heap
+constexpr size_t kRouteScratchBufferBytes{16 * 1024};
+
+/**
+ * Monotonic arena for short-lived containers of a single route computation,
+ * e.g. candidate next-hop nodes and paths. Nothing is freed until the arena
+ * goes out of scope, which is what makes allocations cheap.
+ *
+ * The arena starts off a buffer of the calling thread which is reused by
+ * every route computation on the thread, hence only one arena may exist per
+ * thread at a time. Route computation doesn't yield, so this holds for
+ * fibers of the thread as well.
+ */
+class RouteScratchArena {
+ public:
+  RouteScratchArena() : resource_(getBuffer(), kRouteScratchBufferBytes) {
+    DCHECK(not inUse_) << "Nested route scratch arenas";
+    inUse_ = true;
+  }
+
+  ~RouteScratchArena() {
+    inUse_ = false;
+  }
+
+  std::pmr::memory_resource*
+  get() {
+    return &resource_;
+  }
+
+ private:
+  static std::byte*
+  getBuffer() {
+    thread_local auto buffer =
+        std::make_unique<std::byte[]>(kRouteScratchBufferBytes);
+    return buffer.get();
+  }
+
+  static inline thread_local bool inUse_{false};
+
+  std::pmr::monotonic_buffer_resource resource_;
+};
+
+} // namespace
+
 namespace detail {
 
 void
@@ -46,8 +128,9 @@ DecisionPendingUpdates::applyLinkStateChange(
     std::string const& nodeName,
     LinkState::LinkStateChange const& change,
     apache::thrift::optional_field_ref<thrift::PerfEvents const&> perfEvents) {
+  topologyChanged_ |= change.topologyChanged;
   needsFullRebuild_ |=
-      (change.topologyChanged || change.nodeLabelChanged ||
+      (change.nodeLabelChanged ||
        // we only need a full rebuild if link attributes change locally
        // this would be a nexthop or link label change
        (change.linkAttributesChanged && nodeName == myNodeName_));
@@ -62,12 +145,24 @@ DecisionPendingUpdates::applyPrefixStateChange(
   addUpdate(perfEvents);
 }
 
+void
+DecisionPendingUpdates::applyStaticRoutesChange(
+    std::unordered_set<int32_t>&& labels,
+    std::unordered_set<thrift::IpPrefix>&& dependentPrefixes,
+    apache::thrift::optional_field_ref<thrift::PerfEvents const&> perfEvents) {
+  updatedStaticLabels_.merge(std::move(labels));
+  updatedPrefixes_.merge(std::move(dependentPrefixes));
+  addUpdate(perfEvents);
+}
+
 void
 DecisionPendingUpdates::reset() {
   count_ = 0;
   perfEvents_ = std::nullopt;
   needsFullRebuild_ = false;
+  topologyChanged_ = false;
   updatedPrefixes_.clear();
+  updatedStaticLabels_.clear();
 }
 
 void
@@ -77,6 +172,20 @@ DecisionPendingUpdates::addEvent(std::string const& eventDescription) {
   }
 }
 
+void
+DecisionPendingUpdates::addEvent(
+    std::string const& eventDescription, int64_t unixTs) {
+  if (not perfEvents_) {
+    return;
+  }
+  auto& events = *perfEvents_->events_ref();
+  if (not events.empty()) {
+    unixTs = std::max(unixTs, *events.back().unixTs_ref());
+  }
+  events.emplace_back(
+      apache::thrift::FRAGILE, myNodeName_, eventDescription, unixTs);
+}
+
 std::optional<thrift::PerfEvents>
 DecisionPendingUpdates::moveOutEvents() {
   std::optional<thrift::PerfEvents> events = std::move(perfEvents_);
@@ -120,7 +229,7 @@ DecisionRouteDb::calculateUpdate(DecisionRouteDb&& newDb) const {
   // unicastRoutesToDelete
   for (auto& [prefix, _] : unicastRoutes) {
     if (!newDb.unicastRoutes.count(prefix)) {
-      delta.unicastRoutesToDelete.emplace_back(prefix);
+      delta.unicastRoutesToDelete.emplace_back(prefix.toCIDRNetwork());
     }
   }
 
@@ -168,13 +277,25 @@ class SpfSolver::SpfSolverImpl {
       bool computeLfaPaths,
       bool enableOrderedFib,
       bool bgpDryRun,
-      bool enableBestRouteSelection)
+      bool enableBestRouteSelection,
+      size_t routeComputationThreads,
+      bool enableIncrementalRouteBuild,
+      bool enableLfaBackupNextHops,
+      std::optional<thrift::ThreadConfig> threadConfig)
       : myNodeName_(myNodeName),
         enableV4_(enableV4),
         computeLfaPaths_(computeLfaPaths),
         enableOrderedFib_(enableOrderedFib),
         bgpDryRun_(bgpDryRun),
-        enableBestRouteSelection_(enableBestRouteSelection) {
+        enableBestRouteSelection_(enableBestRouteSelection),
+        enableIncrementalRouteBuild_(enableIncrementalRouteBuild),
+        enableLfaBackupNextHops_(computeLfaPaths and enableLfaBackupNextHops) {
+    if (routeComputationThreads > 1) {
+      routeComputationExecutor_ =
+          std::make_unique<folly::CPUThreadPoolExecutor>(
+              routeComputationThreads,
+              createThreadFactory("SpfSolver", threadConfig));
+    }
     // Initialize stat keys
     fb303::fbData->addStatExportType("decision.adj_db_update", fb303::COUNT);
     fb303::fbData->addStatExportType(
@@ -195,12 +316,26 @@ class SpfSolver::SpfSolverImpl {
         "decision.duplicate_node_label", fb303::COUNT);
     fb303::fbData->addStatExportType(
         "decision.skipped_unicast_route", fb303::COUNT);
+    fb303::fbData->addStatExportType(
+        "decision.incremental_route_build_fallbacks", fb303::COUNT);
+    fb303::fbData->addStatExportType(
+        "decision.incremental_route_build_prefixes", fb303::AVG);
+    fb303::fbData->addStatExportType(
+        "decision.incremental_route_build_runs", fb303::COUNT);
+    fb303::fbData->addStatExportType(
+        "decision.nexthops_cache.hits", fb303::COUNT);
+    fb303::fbData->addStatExportType(
+        "decision.nexthops_cache.misses", fb303::COUNT);
     fb303::fbData->addStatExportType("decision.spf_ms", fb303::AVG);
     fb303::fbData->addStatExportType("decision.spf_runs", fb303::COUNT);
     fb303::fbData->addStatExportType("decision.errors", fb303::COUNT);
   }
 
-  ~SpfSolverImpl() = default;
+  ~SpfSolverImpl() {
+    if (routeComputationExecutor_) {
+      routeComputationExecutor_->join();
+    }
+  }
 
   //
   // mpls static route
@@ -210,6 +345,12 @@ class SpfSolver::SpfSolverImpl {
 
   StaticMplsRoutes const& getStaticRoutes();
 
+  std::unordered_set<thrift::IpPrefix> getPrefixesDependingOnStaticRoutes(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState,
+      std::unordered_set<int32_t> const& labels) const;
+
   //
   // best path calculation
   //
@@ -226,16 +367,38 @@ class SpfSolver::SpfSolverImpl {
       const std::string& myNodeName,
       std::unordered_map<std::string, LinkState> const& areaLinkStates,
       PrefixState const& prefixState,
-      thrift::IpPrefix const& prefix);
+      PackedPrefix const& prefix);
 
-  std::unordered_map<thrift::IpPrefix, BestRouteSelectionResult> const&
+  std::unordered_map<PackedPrefix, BestRouteSelectionResult> const&
   getBestRoutesCache() const {
     return bestRoutesCache_;
   }
 
+  void
+  clearNextHopsCache() {
+    nextHopsCache_.wlock()->clear();
+    nextHopsCacheNodeName_.clear();
+    nextHopsCacheVersions_.clear();
+  }
+
+  SpfSolver::RouteBuildPhaseTimes moveOutRouteBuildPhaseTimes();
+
+  DecisionRouteDb buildMplsRouteDb(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
+  std::optional<std::unordered_set<thrift::IpPrefix>>
+  getPrefixesAffectedByLinkStateChange(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState);
+
   // helpers used in best path calculation
-  static std::pair<Metric, std::unordered_set<std::string>> getMinCostNodes(
-      const SpfResult& spfResult, const std::set<NodeAndArea>& dstNodeAreas);
+  static std::pair<Metric, std::pmr::unordered_set<std::string>>
+  getMinCostNodes(
+      const SpfResult& spfResult,
+      const std::set<NodeAndArea>& dstNodeAreas,
+      std::pmr::memory_resource* scratch);
 
   // spf counters
   void updateGlobalCounters();
@@ -245,41 +408,167 @@ class SpfSolver::SpfSolverImpl {
   SpfSolverImpl(SpfSolverImpl const&) = delete;
   SpfSolverImpl& operator=(SpfSolverImpl const&) = delete;
 
+  // createRouteForPrefix() recording best route selection in the given cache
+  std::optional<RibUnicastEntry> createRouteForPrefix(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState,
+      PackedPrefix const& prefix,
+      std::unordered_map<PackedPrefix, BestRouteSelectionResult>&
+          bestRoutesCache);
+
+  // Create unicast routes of all prefixes on routeComputationExecutor_ and
+  // add them to routeDb
+  void createUnicastRoutesParallel(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState,
+      DecisionRouteDb& routeDb);
+
+  // Key of nextHopsCache_. Next-hops of a SP_ECMP route only depend on link
+  // states and on these inputs, which are commonly shared by many prefixes,
+  // e.g. anycast or aggregated prefixes advertised by the same set of nodes
+  struct NextHopsCacheKey {
+    // best advertisers (node and area) of the prefix
+    std::set<NodeAndArea> nodeAreas;
+    bool isV4{false};
+    bool perDestination{false};
+    // prepend labels of advertisers in order of nodeAreas. Only relevant, and
+    // hence only set, if perDestination
+    std::vector<std::optional<int32_t>> prependLabels;
+
+    bool
+    operator<(NextHopsCacheKey const& other) const {
+      return std::tie(nodeAreas, isV4, perDestination, prependLabels) <
+          std::tie(
+                 other.nodeAreas,
+                 other.isV4,
+                 other.perDestination,
+                 other.prependLabels);
+    }
+  };
+
+  // Create MPLS routes of node labels, adjacency labels and static routes
+  void addMplsRoutes(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      DecisionRouteDb& routeDb);
+
+  // Metric and next-hop neighbors of shortest paths from a node towards some
+  // node names, in every area. Without LFA, next-hops towards the nodes only
+  // depend on these and on local links
+  using ShortestPaths = std::map<
+      std::string /* area */,
+      std::map<
+          std::string /* node */,
+          std::pair<Metric, std::unordered_set<std::string>>>>;
+
+  static ShortestPaths getShortestPaths(
+      const std::string& myNodeName,
+      std::set<NodeAndArea> const& dstNodeAreas,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
+  // Node label route towards a node, std::nullopt if it isn't reachable.
+  // Without LFA, it only depends on the label, on local links and on
+  // shortest paths towards the node name
+  struct NodeLabelRoute {
+    int32_t label{0};
+    ShortestPaths paths;
+    std::optional<RibMplsEntry> route;
+  };
+
+  // Local links of all areas as (area, link, isUp, metric, v6 next-hop, v4
+  // next-hop)
+  using LocalLinksKey = std::set<std::tuple<
+      std::string,
+      std::string,
+      bool,
+      Metric,
+      std::string,
+      std::string>>;
+
+  static LocalLinksKey getLocalLinksKey(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
+  // Node label route of node in area, reused from nodeLabelRoutes_ if
+  // `cacheValid` and its inputs didn't change since it was computed, which
+  // is the case for all of them if `versionsUnchanged`
+  NodeLabelRoute getNodeLabelRoute(
+      const std::string& myNodeName,
+      NodeAndArea const& nodeArea,
+      int32_t label,
+      bool cacheValid,
+      bool versionsUnchanged,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
+  // Inputs of routes in an area which may change with link state, i.e.
+  // besides prefix state, routes of a prefix only depend on these for its
+  // advertisers unless LFA or KSP2 is used
+  struct RouteInputs {
+    // metric and next-hop neighbors toward every reachable node
+    std::unordered_map<
+        std::string /* node */,
+        std::pair<Metric, std::unordered_set<std::string>>>
+        paths;
+    std::unordered_set<std::string> overloadedNodes;
+    // local links as (link, isUp, metric)
+    std::set<std::tuple<std::string, bool, Metric>> localLinks;
+  };
+
+  static RouteInputs getRouteInputs(
+      const std::string& myNodeName, LinkState const& linkState);
+
+  void updateRouteInputs(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
+  // Clear nextHopsCache_ if it was built for another node, over other local
+  // links or, with LFA, if link state of any area changed since. Otherwise
+  // entries get revalidated on use after link state changes
+  void maybeInvalidateNextHopsCache(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
   // Given prefixes and the nodes who announce it, get the ecmp routes.
+  // Temporaries are allocated from scratch, see RouteScratchArena
   std::optional<RibUnicastEntry> selectBestPathsSpf(
       std::string const& myNodeName,
-      thrift::IpPrefix const& prefix,
+      PackedPrefix const& prefix,
       BestRouteSelectionResult const& bestRouteSelectionResult,
       PrefixEntries const& prefixEntries,
       bool const isBgp,
       thrift::PrefixForwardingType const& forwardingType,
       std::unordered_map<std::string, LinkState> const& areaLinkStates,
-      PrefixState const& prefixState);
+      PrefixState const& prefixState,
+      std::pmr::memory_resource* scratch);
 
   // Given prefixes and the nodes who announce it, get the kspf routes.
+  // Temporaries are allocated from scratch, see RouteScratchArena
   std::optional<RibUnicastEntry> selectBestPathsKsp2(
       const string& myNodeName,
-      const thrift::IpPrefix& prefix,
+      PackedPrefix const& prefix,
       BestRouteSelectionResult const& bestRouteSelectionResult,
       PrefixEntries const& prefixEntries,
       bool isBgp,
       thrift::PrefixForwardingType const& forwardingType,
       std::unordered_map<std::string, LinkState> const& areaLinkStates,
-      PrefixState const& prefixState);
+      PrefixState const& prefixState,
+      std::pmr::memory_resource* scratch);
 
   std::optional<RibUnicastEntry> addBestPaths(
       const string& myNodeName,
-      const thrift::IpPrefix& prefixThrift,
+      PackedPrefix const& prefix,
       const BestRouteSelectionResult& bestRouteSelectionResult,
       const PrefixEntries& prefixEntries,
       const PrefixState& prefixState,
       const bool isBgp,
-      std::unordered_set<thrift::NextHopThrift>&& nextHops);
+      NextHops nextHops);
 
   // helper function to find the nodes for the nexthop for bgp route
   BestRouteSelectionResult runBestPathSelectionBgp(
       std::string const& myNodeName,
-      thrift::IpPrefix const& prefix,
+      PackedPrefix const& prefix,
       PrefixEntries const& prefixEntries,
       std::unordered_map<std::string, LinkState> const& areaLinkStates);
 
@@ -288,7 +577,7 @@ class SpfSolver::SpfSolverImpl {
    */
   BestRouteSelectionResult selectBestRoutes(
       std::string const& myNodeName,
-      thrift::IpPrefix const& prefix,
+      PackedPrefix const& prefix,
       PrefixEntries const& prefixEntries,
       bool const hasBgp,
       std::unordered_map<std::string, LinkState> const& areaLinkStates);
@@ -305,18 +594,21 @@ class SpfSolver::SpfSolverImpl {
       BestRouteSelectionResult&& result,
       std::unordered_map<std::string, LinkState> const& areaLinkStates) const;
 
+  // Next-hop nodes towards destinations, allocated from scratch space of the
+  // route computation
+  using NextHopNodes = std::pmr::unordered_map<
+      std::pair<std::string /* nextHopNodeName */, std::string /* dest */>,
+      Metric /* the distance from the nexthop to the dest */>;
+
   // Give source node-name and dstNodeNames, this function returns the set of
   // nexthops (along with LFA if enabled) towards these set of dstNodeNames
-  std::pair<
-      Metric /* minimum metric to destination */,
-      std::unordered_map<
-          std::pair<std::string /* nextHopNodeName */, std::string /* dest */>,
-          Metric /* the distance from the nexthop to the dest */>>
+  std::pair<Metric /* minimum metric to destination */, NextHopNodes>
   getNextHopsWithMetric(
       const std::string& srcNodeName,
       const std::set<NodeAndArea>& dstNodeAreas,
       bool perDestination,
-      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      std::pmr::memory_resource* scratch);
 
   // This function converts best nexthop nodes to best nexthop adjacencies
   // which can then be passed to FIB for programming. It considers LFA and
@@ -329,8 +621,7 @@ class SpfSolver::SpfSolverImpl {
       bool isV4,
       bool perDestination,
       const Metric minMetric,
-      std::unordered_map<std::pair<std::string, std::string>, Metric>
-          nextHopNodes,
+      NextHopNodes const& nextHopNodes,
       std::optional<int32_t> swapLabel,
       std::unordered_map<std::string, LinkState> const& areaLinkStates,
       PrefixEntries const& prefixEntries = {}) const;
@@ -340,8 +631,42 @@ class SpfSolver::SpfSolverImpl {
   // Cache of best route selection.
   // - Cleared when topology changes
   // - Updated for the prefix whenever a route is created for it
-  std::unordered_map<thrift::IpPrefix, BestRouteSelectionResult>
-      bestRoutesCache_;
+  std::unordered_map<PackedPrefix, BestRouteSelectionResult> bestRoutesCache_;
+
+  // Entry of nextHopsCache_
+  struct CachedNextHops {
+    // std::nullopt if there is no route
+    std::optional<NextHops> nextHops;
+    // Shortest paths towards the advertisers and, for per destination
+    // next-hops, their node labels. Not set with LFA
+    ShortestPaths paths;
+    std::map<NodeAndArea, int32_t> nodeLabels;
+    // nextHopsCacheGeneration_ the entry is known to be valid in
+    uint64_t generation{0};
+  };
+
+  // Inputs of next-hops of the cache key beyond local links
+  CachedNextHops getNextHopsInputs(
+      const std::string& myNodeName,
+      NextHopsCacheKey const& key,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates) const;
+
+  // Cache of SP_ECMP next-hops.
+  // - Cleared when local links change, or with LFA when link state of any
+  //   area changes
+  // - Otherwise entries of an older generation are reused when their inputs
+  //   are unchanged
+  // - Shared by route computation workers
+  folly::Synchronized<std::map<NextHopsCacheKey, CachedNextHops>>
+      nextHopsCache_;
+
+  // Node, link state versions of areas and local links nextHopsCache_ is
+  // valid for. Generation is bumped on every link state change
+  std::string nextHopsCacheNodeName_;
+  std::unordered_map<std::string /* area */, uint64_t /* version */>
+      nextHopsCacheVersions_;
+  LocalLinksKey nextHopsCacheLocalLinks_;
+  uint64_t nextHopsCacheGeneration_{0};
 
   const std::string myNodeName_;
 
@@ -356,8 +681,61 @@ class SpfSolver::SpfSolverImpl {
   const bool bgpDryRun_{false};
 
   const bool enableBestRouteSelection_{false};
+
+  const bool enableIncrementalRouteBuild_{false};
+
+  // mark LFA next-hops as backup next-hops rather than ECMP next-hops
+  const bool enableLfaBackupNextHops_{false};
+
+  // Inputs of the last computed routes of every area, set only if
+  // incremental route build is enabled
+  std::string routeInputsNodeName_;
+  std::unordered_map<std::string /* area */, RouteInputs> routeInputs_;
+
+  // Node label routes of the last MPLS route build, and the node, link state
+  // versions and local links they were built for. Not used with LFA, whose
+  // next-hops depend on shortest paths of neighbors as well
+  std::map<NodeAndArea, NodeLabelRoute> nodeLabelRoutes_;
+  std::string nodeLabelRoutesNodeName_;
+  std::unordered_map<std::string /* area */, uint64_t /* version */>
+      nodeLabelRoutesVersions_;
+  LocalLinksKey nodeLabelRoutesLocalLinks_;
+
+  // Worker pool for parallel route computation. Routes are computed serially
+  // if not set
+  std::unique_ptr<folly::CPUThreadPoolExecutor> routeComputationExecutor_{
+      nullptr};
+
+  // record time of a route computation phase started at `startTime`. May be
+  // called from route computation workers
+  void recordPhaseTime(
+      SpfSolver::RouteBuildPhase phase,
+      std::chrono::steady_clock::time_point startTime);
+
+  // time spent in route computation phases in microseconds
+  std::array<std::atomic<int64_t>, SpfSolver::kNumRouteBuildPhases>
+      phaseTimesUs_{};
 };
 
+void
+SpfSolver::SpfSolverImpl::recordPhaseTime(
+    SpfSolver::RouteBuildPhase phase,
+    std::chrono::steady_clock::time_point startTime) {
+  phaseTimesUs_[static_cast<size_t>(phase)] +=
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - startTime)
+          .count();
+}
+
+SpfSolver::RouteBuildPhaseTimes
+SpfSolver::SpfSolverImpl::moveOutRouteBuildPhaseTimes() {
+  SpfSolver::RouteBuildPhaseTimes times;
+  for (size_t i = 0; i < SpfSolver::kNumRouteBuildPhases; ++i) {
+    times[i] = std::chrono::microseconds(phaseTimesUs_[i].exchange(0));
+  }
+  return times;
+}
+
 void
 SpfSolver::SpfSolverImpl::updateStaticRoutes(
     thrift::RouteDatabaseDelta&& staticRoutesDelta) {
@@ -393,54 +771,142 @@ SpfSolver::SpfSolverImpl::getStaticRoutes() {
   return staticMplsRoutes_;
 }
 
+std::unordered_set<thrift::IpPrefix>
+SpfSolver::SpfSolverImpl::getPrefixesDependingOnStaticRoutes(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    PrefixState const& prefixState,
+    std::unordered_set<int32_t> const& labels) const {
+  // Static next-hops are only added to routes of prefixes advertised by
+  // myNodeName with prepend label, see addBestPaths(). Hence only prefixes of
+  // myNodeName are looked at rather than all prefixes
+  std::unordered_set<thrift::IpPrefix> prefixes;
+  for (auto const& [area, _] : areaLinkStates) {
+    const NodeAndArea nodeAndArea{myNodeName, area};
+    for (auto const& prefix : prefixState.getNodePrefixes(nodeAndArea)) {
+      auto entriesIt = prefixState.prefixes().find(PackedPrefix(prefix));
+      if (entriesIt == prefixState.prefixes().end()) {
+        continue;
+      }
+      auto entryIt = entriesIt->second.find(nodeAndArea);
+      if (entryIt == entriesIt->second.end()) {
+        continue;
+      }
+      auto const& prependLabel = entryIt->second->prependLabel_ref();
+      if (prependLabel.has_value() and labels.count(*prependLabel)) {
+        prefixes.emplace(prefix);
+      }
+    }
+  }
+  return prefixes;
+}
+
+std::optional<RibUnicastEntry>
+SpfSolver::SpfSolverImpl::createRouteForPrefix(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    PrefixState const& prefixState,
+    PackedPrefix const& prefix) {
+  maybeInvalidateNextHopsCache(myNodeName, areaLinkStates);
+  return createRouteForPrefix(
+      myNodeName, areaLinkStates, prefixState, prefix, bestRoutesCache_);
+}
+
+void
+SpfSolver::SpfSolverImpl::maybeInvalidateNextHopsCache(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  bool isValid = nextHopsCacheNodeName_ == myNodeName and
+      nextHopsCacheVersions_.size() == areaLinkStates.size();
+  for (auto const& [area, linkState] : areaLinkStates) {
+    if (not isValid) {
+      break;
+    }
+    auto it = nextHopsCacheVersions_.find(area);
+    isValid = it != nextHopsCacheVersions_.end() and
+        it->second == linkState.getVersion();
+  }
+  if (isValid) {
+    return;
+  }
+
+  // Without LFA, next-hops only depend on local links and inputs of the
+  // entry, which are checked on use
+  LocalLinksKey localLinks;
+  if (not computeLfaPaths_) {
+    localLinks = getLocalLinksKey(myNodeName, areaLinkStates);
+  }
+  if (computeLfaPaths_ or nextHopsCacheNodeName_ != myNodeName or
+      nextHopsCacheLocalLinks_ != localLinks) {
+    nextHopsCache_.wlock()->clear();
+  }
+  ++nextHopsCacheGeneration_;
+  nextHopsCacheNodeName_ = myNodeName;
+  nextHopsCacheLocalLinks_ = std::move(localLinks);
+  nextHopsCacheVersions_.clear();
+  for (auto const& [area, linkState] : areaLinkStates) {
+    nextHopsCacheVersions_.emplace(area, linkState.getVersion());
+  }
+}
+
 std::optional<RibUnicastEntry>
 SpfSolver::SpfSolverImpl::createRouteForPrefix(
     const std::string& myNodeName,
     std::unordered_map<std::string, LinkState> const& areaLinkStates,
     PrefixState const& prefixState,
-    thrift::IpPrefix const& prefix) {
+    PackedPrefix const& prefix,
+    std::unordered_map<PackedPrefix, BestRouteSelectionResult>&
+        bestRoutesCache) {
   fb303::fbData->addStatValue("decision.get_route_for_prefix", 1, fb303::COUNT);
 
   auto search = prefixState.prefixes().find(prefix);
   if (search == prefixState.prefixes().end()) {
     return std::nullopt;
   }
-  auto const& allPrefixEntries = search->second;
 
   // Clear best route selection in prefix state
-  bestRoutesCache_.erase(prefix);
+  bestRoutesCache.erase(prefix);
 
   //
-  // Create list of prefix-entries from reachable nodes only
-  // NOTE: We're copying prefix-entries and it can be expensive. Using
-  // pointers for storing prefix information can be efficient (CPU & Memory)
+  // Use prefix-entries from reachable nodes only. Prefix state maintains them
+  // for the link states of this node, otherwise filter them here
   //
-  auto prefixEntries = folly::copy(allPrefixEntries);
-  for (auto& [area, linkState] : areaLinkStates) {
-    auto const& mySpfResult = linkState.getSpfResult(myNodeName);
-
-    // Delete entries of unreachable nodes from prefixEntries
-    for (auto it = prefixEntries.begin(); it != prefixEntries.end();) {
-      const auto& [prefixNode, prefixArea] = it->first;
-      if (area != prefixArea || mySpfResult.count(prefixNode)) {
-        ++it; // retain
-      } else {
-        it = prefixEntries.erase(it); // erase the unreachable prefix entry
+  PrefixEntries const* reachablePrefixEntries{nullptr};
+  PrefixEntries filteredPrefixEntries;
+  if (prefixState.isReachabilityCurrent(myNodeName, areaLinkStates)) {
+    reachablePrefixEntries = prefixState.getReachablePrefixEntries(prefix);
+  } else {
+    // NOTE: Only references to the shared prefix-entries are copied
+    filteredPrefixEntries = search->second;
+    for (auto& [area, linkState] : areaLinkStates) {
+      auto const& mySpfResult = linkState.getSpfResult(myNodeName);
+
+      // Delete entries of unreachable nodes from prefixEntries
+      for (auto it = filteredPrefixEntries.begin();
+           it != filteredPrefixEntries.end();) {
+        const auto& [prefixNode, prefixArea] = it->first;
+        if (area != prefixArea || mySpfResult.count(prefixNode)) {
+          ++it; // retain
+        } else {
+          // erase the unreachable prefix entry
+          it = filteredPrefixEntries.erase(it);
+        }
       }
     }
+    reachablePrefixEntries = &filteredPrefixEntries;
   }
 
   // Skip if no valid prefixes
-  if (prefixEntries.empty()) {
+  if (not reachablePrefixEntries or reachablePrefixEntries->empty()) {
     VLOG(3) << "Skipping route to " << toString(prefix)
             << " with no reachable node.";
     fb303::fbData->addStatValue("decision.no_route_to_prefix", 1, fb303::COUNT);
     return std::nullopt;
   }
+  auto const& prefixEntries = *reachablePrefixEntries;
 
   // Sanity check for V4 prefixes
-  const bool isV4Prefix = prefix.prefixAddress_ref()->addr_ref()->size() ==
-      folly::IPAddressV4::byteCount();
+  const bool isV4Prefix = prefix.isV4();
   if (isV4Prefix && !enableV4_) {
     LOG(WARNING) << "Received v4 prefix " << toString(prefix)
                  << " while v4 is not enabled.";
@@ -458,13 +924,13 @@ SpfSolver::SpfSolverImpl::createRouteForPrefix(
   // TODO: With new PrefixMetrics we no longer treat routes differently based
   // on their origin source aka `prefixEntry.type`
   for (auto const& [nodeAndArea, prefixEntry] : prefixEntries) {
-    bool isBGP = prefixEntry.type_ref().value() == thrift::PrefixType::BGP;
+    bool isBGP = prefixEntry->type_ref().value() == thrift::PrefixType::BGP;
     hasBGP |= isBGP;
     hasNonBGP |= !isBGP;
     if (nodeAndArea.first == myNodeName) {
-      hasSelfPrependLabel &= prefixEntry.prependLabel_ref().has_value();
+      hasSelfPrependLabel &= prefixEntry->prependLabel_ref().has_value();
     }
-    if (isBGP and not prefixEntry.mv_ref().has_value()) {
+    if (isBGP and not prefixEntry->mv_ref().has_value()) {
       missingMv = true;
       LOG(ERROR) << "Prefix entry for prefix " << toString(prefix)
                  << " advertised by " << nodeAndArea.first << ", area "
@@ -494,8 +960,11 @@ SpfSolver::SpfSolverImpl::createRouteForPrefix(
   }
 
   // Perform best route selection from received route announcements
+  const auto selectionStartTime = std::chrono::steady_clock::now();
   const auto& bestRouteSelectionResult = selectBestRoutes(
       myNodeName, prefix, prefixEntries, hasBGP, areaLinkStates);
+  recordPhaseTime(
+      SpfSolver::RouteBuildPhase::BEST_ROUTE_SELECTION, selectionStartTime);
   if (not bestRouteSelectionResult.success) {
     return std::nullopt;
   }
@@ -506,7 +975,7 @@ SpfSolver::SpfSolverImpl::createRouteForPrefix(
   }
 
   // Set best route selection in prefix state
-  bestRoutesCache_.insert_or_assign(prefix, bestRouteSelectionResult);
+  bestRoutesCache.insert_or_assign(prefix, bestRouteSelectionResult);
 
   // Skip adding route for prefixes advertised by this node. The originated
   // routes are already programmed on the system e.g. re-distributed from
@@ -530,6 +999,11 @@ SpfSolver::SpfSolverImpl::createRouteForPrefix(
   // - Compute paths, algorithm type influences this step (ECMP or KSPF)
   // - Create next-hops from paths, forwarding type influences this step
   //
+  const auto nextHopsStartTime = std::chrono::steady_clock::now();
+  SCOPE_EXIT {
+    recordPhaseTime(SpfSolver::RouteBuildPhase::NEXTHOPS, nextHopsStartTime);
+  };
+  RouteScratchArena scratch;
   switch (forwardingAlgo) {
   case thrift::PrefixForwardingAlgorithm::SP_ECMP:
     return selectBestPathsSpf(
@@ -540,7 +1014,8 @@ SpfSolver::SpfSolverImpl::createRouteForPrefix(
         hasBGP,
         forwardingType,
         areaLinkStates,
-        prefixState);
+        prefixState,
+        scratch.get());
   case thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP:
     return selectBestPathsKsp2(
         myNodeName,
@@ -550,7 +1025,8 @@ SpfSolver::SpfSolverImpl::createRouteForPrefix(
         hasBGP,
         forwardingType,
         areaLinkStates,
-        prefixState);
+        prefixState,
+        scratch.get());
   default:
     LOG(ERROR) << "Unknown prefix algorithm type "
                << apache::thrift::util::enumNameSafe(forwardingAlgo)
@@ -559,6 +1035,101 @@ SpfSolver::SpfSolverImpl::createRouteForPrefix(
   }
 }
 
+void
+SpfSolver::SpfSolverImpl::createUnicastRoutesParallel(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    PrefixState const& prefixState,
+    DecisionRouteDb& routeDb) {
+  auto executor =
+      folly::Executor::getKeepAliveToken(routeComputationExecutor_.get());
+
+  // Run SPF of every area in parallel. Route computation of prefixes below
+  // then mostly reads the memoized SPF results
+  std::vector<folly::SemiFuture<folly::Unit>> spfFutures;
+  for (auto const& [_, linkState] : areaLinkStates) {
+    spfFutures.emplace_back(
+        folly::via(
+            executor,
+            [this, &myNodeName, &linkState = linkState]() {
+              linkState.getSpfResult(myNodeName);
+              if (not computeLfaPaths_) {
+                return;
+              }
+              for (auto const& link : linkState.linksFromNode(myNodeName)) {
+                if (link->isUp()) {
+                  linkState.getSpfResult(link->getOtherNodeName(myNodeName));
+                }
+              }
+            })
+            .semi());
+  }
+  for (auto& result : folly::collectAll(std::move(spfFutures)).get()) {
+    // rethrow exception from worker if any
+    result.throwIfFailed();
+  }
+
+  // Partition prefixes into chunks of consecutive prefixes. Chunks outnumber
+  // workers to balance the load across them
+  std::vector<PackedPrefix const*> prefixes;
+  prefixes.reserve(prefixState.prefixes().size());
+  for (const auto& [prefix, _] : prefixState.prefixes()) {
+    prefixes.emplace_back(&prefix);
+  }
+  const size_t chunkSize = Constants::kDecisionRouteComputationChunkSize;
+  const size_t numChunks = (prefixes.size() + chunkSize - 1) / chunkSize;
+
+  // Compute routes of every chunk in parallel along with its own best route
+  // selection cache. ATTN: LinkState memoization is thread-safe while the
+  // rest of the inputs are only read
+  struct ChunkResult {
+    std::vector<RibUnicastEntry> routes;
+    std::unordered_map<PackedPrefix, BestRouteSelectionResult> bestRoutes;
+  };
+  std::vector<ChunkResult> chunkResults(numChunks);
+  std::vector<folly::SemiFuture<folly::Unit>> futures;
+  futures.reserve(numChunks);
+  for (size_t i = 0; i < numChunks; ++i) {
+    futures.emplace_back(
+        folly::via(
+            executor,
+            [this,
+             &myNodeName,
+             &areaLinkStates,
+             &prefixState,
+             &prefixes,
+             &chunkResult = chunkResults[i],
+             begin = i * chunkSize,
+             end = std::min(prefixes.size(), (i + 1) * chunkSize)]() {
+              for (auto idx = begin; idx < end; ++idx) {
+                if (auto maybeRoute = createRouteForPrefix(
+                        myNodeName,
+                        areaLinkStates,
+                        prefixState,
+                        *prefixes[idx],
+                        chunkResult.bestRoutes)) {
+                  chunkResult.routes.emplace_back(
+                      std::move(maybeRoute).value());
+                }
+              }
+            })
+            .semi());
+  }
+  for (auto& result : folly::collectAll(std::move(futures)).get()) {
+    result.throwIfFailed();
+  }
+
+  // Merge results in chunk order
+  for (auto& chunkResult : chunkResults) {
+    for (auto& route : chunkResult.routes) {
+      routeDb.addUnicastRoute(std::move(route));
+    }
+    for (auto& [prefix, bestRoutes] : chunkResult.bestRoutes) {
+      bestRoutesCache_.insert_or_assign(prefix, std::move(bestRoutes));
+    }
+  }
+}
+
 std::optional<DecisionRouteDb>
 SpfSolver::SpfSolverImpl::buildRouteDb(
     const std::string& myNodeName,
@@ -579,18 +1150,74 @@ SpfSolver::SpfSolverImpl::buildRouteDb(
 
   // Clear best route selection cache
   bestRoutesCache_.clear();
+  maybeInvalidateNextHopsCache(myNodeName, areaLinkStates);
 
   // Create IPv4, IPv6 routes (includes IP -> MPLS routes)
-  for (const auto& [prefix, _] : prefixState.prefixes()) {
-    if (auto maybeRoute = createRouteForPrefix(
-            myNodeName, areaLinkStates, prefixState, prefix)) {
-      routeDb.addUnicastRoute(std::move(maybeRoute).value());
-    }
-  } // for prefixState.prefixes()
+  if (routeComputationExecutor_ and
+      prefixState.prefixes().size() >=
+          Constants::kDecisionRouteComputationChunkSize) {
+    createUnicastRoutesParallel(
+        myNodeName, areaLinkStates, prefixState, routeDb);
+  } else {
+    for (const auto& [prefix, _] : prefixState.prefixes()) {
+      if (auto maybeRoute = createRouteForPrefix(
+              myNodeName, areaLinkStates, prefixState, prefix)) {
+        routeDb.addUnicastRoute(std::move(maybeRoute).value());
+      }
+    } // for prefixState.prefixes()
+  }
+
+  // Create MPLS routes
+  const auto mplsStartTime = std::chrono::steady_clock::now();
+  addMplsRoutes(myNodeName, areaLinkStates, routeDb);
+  recordPhaseTime(SpfSolver::RouteBuildPhase::MPLS_ROUTES, mplsStartTime);
 
+  // Record inputs of computed routes to narrow down future link state
+  // changes to the affected prefixes
+  if (enableIncrementalRouteBuild_) {
+    updateRouteInputs(myNodeName, areaLinkStates);
+  }
+
+  // TODO: add support for originated routes
+
+  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  LOG(INFO) << "Decision::buildRouteDb took " << deltaTime.count() << "ms.";
+  fb303::fbData->addStatValue(
+      "decision.route_build_ms", deltaTime.count(), fb303::AVG);
+  return routeDb;
+} // buildRouteDb
+
+void
+SpfSolver::SpfSolverImpl::addMplsRoutes(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    DecisionRouteDb& routeDb) {
   //
   // Create MPLS routes for all nodeLabel
   //
+  // Routes of the previous build are reused for nodes whose label and
+  // shortest paths didn't change, unless local links changed
+  LocalLinksKey localLinks;
+  bool cacheValid{false};
+  bool versionsUnchanged{false};
+  if (not computeLfaPaths_) {
+    localLinks = getLocalLinksKey(myNodeName, areaLinkStates);
+    cacheValid = nodeLabelRoutesNodeName_ == myNodeName and
+        nodeLabelRoutesLocalLinks_ == localLinks;
+    versionsUnchanged = cacheValid and
+        nodeLabelRoutesVersions_.size() == areaLinkStates.size();
+    for (auto const& [area, linkState] : areaLinkStates) {
+      if (not versionsUnchanged) {
+        break;
+      }
+      auto it = nodeLabelRoutesVersions_.find(area);
+      versionsUnchanged = it != nodeLabelRoutesVersions_.end() and
+          it->second == linkState.getVersion();
+    }
+  }
+  std::map<NodeAndArea, NodeLabelRoute> nodeLabelRoutes;
+
   std::unordered_map<int32_t, std::pair<std::string, RibMplsEntry>> labelToNode;
   for (const auto& [area, linkState] : areaLinkStates) {
     for (const auto& [_, adjDb] : linkState.getAdjacencyDatabases()) {
@@ -638,40 +1265,26 @@ SpfSolver::SpfSolverImpl::buildRouteDb(
         continue;
       }
 
-      // Get best nexthop towards the node
-      auto metricNhs = getNextHopsWithMetric(
+      // Get route over best nexthops towards the node
+      NodeAndArea nodeArea{*adjDb.thisNodeName_ref(), area};
+      auto nodeLabelRoute = getNodeLabelRoute(
           myNodeName,
-          {{adjDb.thisNodeName_ref().value(), area}},
-          false,
+          nodeArea,
+          topLabel,
+          cacheValid,
+          versionsUnchanged,
           areaLinkStates);
-      if (metricNhs.second.empty()) {
-        LOG(WARNING) << "No route to nodeLabel " << std::to_string(topLabel)
-                     << " of node " << *adjDb.thisNodeName_ref();
+      auto const& maybeRoute =
+          nodeLabelRoutes.insert_or_assign(nodeArea, std::move(nodeLabelRoute))
+              .first->second.route;
+      if (not maybeRoute.has_value()) {
         fb303::fbData->addStatValue(
             "decision.no_route_to_label", 1, fb303::COUNT);
         continue;
       }
-
-      // Create nexthops with appropriate MplsAction (PHP and SWAP). Note that
-      // all nexthops are valid for routing without loops. Fib is responsible
-      // for installing these routes by making sure it programs least cost
-      // nexthops first and of same action type (based on HW limitations)
       labelToNode.erase(topLabel);
       labelToNode.emplace(
-          topLabel,
-          std::make_pair(
-              adjDb.thisNodeName_ref().value(),
-              RibMplsEntry(
-                  topLabel,
-                  getNextHopsThrift(
-                      myNodeName,
-                      {{adjDb.thisNodeName_ref().value(), area}},
-                      false,
-                      false,
-                      metricNhs.first,
-                      metricNhs.second,
-                      topLabel,
-                      areaLinkStates))));
+          topLabel, std::make_pair(*adjDb.thisNodeName_ref(), *maybeRoute));
     }
   }
 
@@ -679,6 +1292,17 @@ SpfSolver::SpfSolverImpl::buildRouteDb(
     routeDb.addMplsRoute(std::move(nodeToEntry.second));
   }
 
+  // Routes of nodes which are gone are dropped along with the old cache
+  if (not computeLfaPaths_) {
+    nodeLabelRoutes_ = std::move(nodeLabelRoutes);
+    nodeLabelRoutesNodeName_ = myNodeName;
+    nodeLabelRoutesLocalLinks_ = std::move(localLinks);
+    nodeLabelRoutesVersions_.clear();
+    for (auto const& [area, linkState] : areaLinkStates) {
+      nodeLabelRoutesVersions_.emplace(area, linkState.getVersion());
+    }
+  }
+
   //
   // Create MPLS routes for all of our adjacencies
   //
@@ -718,62 +1342,312 @@ SpfSolver::SpfSolverImpl::buildRouteDb(
         topLabel,
         std::unordered_set<thrift::NextHopThrift>{nhs.begin(), nhs.end()}));
   }
+}
 
-  // TODO: add support for originated routes
+SpfSolver::SpfSolverImpl::LocalLinksKey
+SpfSolver::SpfSolverImpl::getLocalLinksKey(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  LocalLinksKey key;
+  for (auto const& [area, linkState] : areaLinkStates) {
+    for (auto const& link : linkState.linksFromNode(myNodeName)) {
+      key.emplace(
+          area,
+          link->directionalToString(myNodeName),
+          link->isUp(),
+          link->getMetricFromNode(myNodeName),
+          *link->getNhV6FromNode(myNodeName).addr_ref(),
+          *link->getNhV4FromNode(myNodeName).addr_ref());
+    }
+  }
+  return key;
+}
 
-  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-      std::chrono::steady_clock::now() - startTime);
-  LOG(INFO) << "Decision::buildRouteDb took " << deltaTime.count() << "ms.";
-  fb303::fbData->addStatValue(
-      "decision.route_build_ms", deltaTime.count(), fb303::AVG);
-  return routeDb;
-} // buildRouteDb
+SpfSolver::SpfSolverImpl::CachedNextHops
+SpfSolver::SpfSolverImpl::getNextHopsInputs(
+    const std::string& myNodeName,
+    NextHopsCacheKey const& key,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) const {
+  CachedNextHops inputs;
+  inputs.paths = getShortestPaths(myNodeName, key.nodeAreas, areaLinkStates);
+  if (key.perDestination) {
+    for (auto const& [node, area] : key.nodeAreas) {
+      auto linkStateIt = areaLinkStates.find(area);
+      if (linkStateIt == areaLinkStates.end()) {
+        continue;
+      }
+      auto const& adjDbs = linkStateIt->second.getAdjacencyDatabases();
+      auto it = adjDbs.find(node);
+      if (it != adjDbs.end()) {
+        inputs.nodeLabels.emplace(
+            NodeAndArea{node, area}, *it->second.nodeLabel_ref());
+      }
+    }
+  }
+  return inputs;
+}
 
-BestRouteSelectionResult
-SpfSolver::SpfSolverImpl::selectBestRoutes(
-    std::string const& myNodeName,
-    thrift::IpPrefix const& prefix,
-    PrefixEntries const& prefixEntries,
-    bool const isBgp,
+SpfSolver::SpfSolverImpl::ShortestPaths
+SpfSolver::SpfSolverImpl::getShortestPaths(
+    const std::string& myNodeName,
+    std::set<NodeAndArea> const& dstNodeAreas,
     std::unordered_map<std::string, LinkState> const& areaLinkStates) {
-  CHECK(prefixEntries.size()) << "No prefixes for best route selection";
-  BestRouteSelectionResult ret;
+  // NOTE: like getMinCostNodes(), node names are looked up in every area
+  ShortestPaths paths;
+  for (auto const& [area, linkState] : areaLinkStates) {
+    auto const& spfResult = linkState.getSpfResult(myNodeName);
+    for (auto const& [node, _] : dstNodeAreas) {
+      auto it = spfResult.find(node);
+      if (it != spfResult.end()) {
+        paths[area].emplace(
+            node, std::make_pair(it->second.metric(), it->second.nextHops()));
+      }
+    }
+  }
+  return paths;
+}
 
-  if (enableBestRouteSelection_) {
-    // Perform best route selection based on metrics
-    ret.allNodeAreas = selectBestPrefixMetrics(prefixEntries);
-    ret.bestNodeArea = selectBestNodeArea(ret.allNodeAreas, myNodeName);
-    ret.success = true;
-  } else if (isBgp) {
-    ret = runBestPathSelectionBgp(
-        myNodeName, prefix, prefixEntries, areaLinkStates);
-  } else {
-    // If it is openr route, all nodes are considered as best nodes.
-    for (auto const& [nodeAndArea, prefixEntry] : prefixEntries) {
-      ret.allNodeAreas.emplace(nodeAndArea);
+SpfSolver::SpfSolverImpl::NodeLabelRoute
+SpfSolver::SpfSolverImpl::getNodeLabelRoute(
+    const std::string& myNodeName,
+    NodeAndArea const& nodeArea,
+    int32_t label,
+    bool cacheValid,
+    bool versionsUnchanged,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  auto cachedIt = nodeLabelRoutes_.end();
+  if (cacheValid) {
+    cachedIt = nodeLabelRoutes_.find(nodeArea);
+    if (cachedIt != nodeLabelRoutes_.end() and
+        cachedIt->second.label != label) {
+      cachedIt = nodeLabelRoutes_.end();
     }
-    ret.bestNodeArea = *ret.allNodeAreas.begin();
-    ret.success = true;
+  }
+  if (versionsUnchanged and cachedIt != nodeLabelRoutes_.end()) {
+    return std::move(cachedIt->second);
   }
 
-  return maybeFilterDrainedNodes(std::move(ret), areaLinkStates);
-}
+  NodeLabelRoute nodeLabelRoute;
+  nodeLabelRoute.label = label;
+  nodeLabelRoute.paths =
+      getShortestPaths(myNodeName, {nodeArea}, areaLinkStates);
+  if (cachedIt != nodeLabelRoutes_.end() and
+      cachedIt->second.paths == nodeLabelRoute.paths) {
+    return std::move(cachedIt->second);
+  }
 
-std::optional<int64_t>
-SpfSolver::SpfSolverImpl::getMinNextHopThreshold(
-    BestRouteSelectionResult nodes, PrefixEntries const& prefixEntries) {
-  std::optional<int64_t> maxMinNexthopForPrefix = std::nullopt;
-  for (const auto& nodeArea : nodes.allNodeAreas) {
-    const auto& prefixEntry = prefixEntries.at(nodeArea);
-    maxMinNexthopForPrefix = prefixEntry.minNexthop_ref().has_value() &&
-            (not maxMinNexthopForPrefix.has_value() ||
-             prefixEntry.minNexthop_ref().value() >
-                 maxMinNexthopForPrefix.value())
-        ? prefixEntry.minNexthop_ref().value()
-        : maxMinNexthopForPrefix;
+  RouteScratchArena scratch;
+  auto metricNhs = getNextHopsWithMetric(
+      myNodeName, {nodeArea}, false, areaLinkStates, scratch.get());
+  if (metricNhs.second.empty()) {
+    LOG(WARNING) << "No route to nodeLabel " << std::to_string(label)
+                 << " of node " << nodeArea.first;
+    return nodeLabelRoute;
   }
-  return maxMinNexthopForPrefix;
-}
+
+  // Create nexthops with appropriate MplsAction (PHP and SWAP). Note that
+  // all nexthops are valid for routing without loops. Fib is responsible
+  // for installing these routes by making sure it programs least cost
+  // nexthops first and of same action type (based on HW limitations)
+  nodeLabelRoute.route = RibMplsEntry(
+      label,
+      getNextHopsThrift(
+          myNodeName,
+          {nodeArea},
+          false,
+          false,
+          metricNhs.first,
+          metricNhs.second,
+          label,
+          areaLinkStates));
+  return nodeLabelRoute;
+}
+
+DecisionRouteDb
+SpfSolver::SpfSolverImpl::buildMplsRouteDb(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  DecisionRouteDb routeDb{};
+  const auto mplsStartTime = std::chrono::steady_clock::now();
+  addMplsRoutes(myNodeName, areaLinkStates, routeDb);
+  recordPhaseTime(SpfSolver::RouteBuildPhase::MPLS_ROUTES, mplsStartTime);
+  return routeDb;
+}
+
+SpfSolver::SpfSolverImpl::RouteInputs
+SpfSolver::SpfSolverImpl::getRouteInputs(
+    const std::string& myNodeName, LinkState const& linkState) {
+  RouteInputs inputs;
+  for (auto const& [node, nodeResult] : linkState.getSpfResult(myNodeName)) {
+    inputs.paths.emplace(
+        node, std::make_pair(nodeResult.metric(), nodeResult.nextHops()));
+  }
+  for (auto const& [node, _] : linkState.getAdjacencyDatabases()) {
+    if (linkState.isNodeOverloaded(node)) {
+      inputs.overloadedNodes.emplace(node);
+    }
+  }
+  for (auto const& link : linkState.linksFromNode(myNodeName)) {
+    inputs.localLinks.emplace(
+        link->directionalToString(myNodeName),
+        link->isUp(),
+        link->getMetricFromNode(myNodeName));
+  }
+  return inputs;
+}
+
+void
+SpfSolver::SpfSolverImpl::updateRouteInputs(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  routeInputsNodeName_ = myNodeName;
+  routeInputs_.clear();
+  for (auto const& [area, linkState] : areaLinkStates) {
+    routeInputs_.emplace(area, getRouteInputs(myNodeName, linkState));
+  }
+}
+
+std::optional<std::unordered_set<thrift::IpPrefix>>
+SpfSolver::SpfSolverImpl::getPrefixesAffectedByLinkStateChange(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    PrefixState const& prefixState) {
+  if (not enableIncrementalRouteBuild_) {
+    return std::nullopt;
+  }
+
+  // Compare with inputs of previously computed routes. The new inputs become
+  // the baseline for the next change regardless of the outcome
+  const auto prevNodeName = std::move(routeInputsNodeName_);
+  const auto prevRouteInputs = std::move(routeInputs_);
+  updateRouteInputs(myNodeName, areaLinkStates);
+
+  // LFA next-hops depend on shortest paths of neighbors, and next-hops of all
+  // prefixes depend on local links
+  bool fullRebuildRequired = computeLfaPaths_ or prevNodeName != myNodeName or
+      prevRouteInputs.size() != routeInputs_.size();
+  std::unordered_set<NodeAndArea> changedNodes;
+  for (auto const& [area, inputs] : routeInputs_) {
+    if (fullRebuildRequired) {
+      break;
+    }
+    auto prevIt = prevRouteInputs.find(area);
+    if (prevIt == prevRouteInputs.end() or
+        prevIt->second.localLinks != inputs.localLinks) {
+      fullRebuildRequired = true;
+      break;
+    }
+    auto const& prevInputs = prevIt->second;
+
+    // Nodes whose shortest paths changed, appeared or disappeared
+    for (auto const& [node, path] : inputs.paths) {
+      auto it = prevInputs.paths.find(node);
+      if (it == prevInputs.paths.end() or it->second != path) {
+        changedNodes.emplace(node, area);
+      }
+    }
+    for (auto const& [node, _] : prevInputs.paths) {
+      if (not inputs.paths.count(node)) {
+        changedNodes.emplace(node, area);
+      }
+    }
+
+    // Nodes whose overload state changed
+    for (auto const& node : inputs.overloadedNodes) {
+      if (not prevInputs.overloadedNodes.count(node)) {
+        changedNodes.emplace(node, area);
+      }
+    }
+    for (auto const& node : prevInputs.overloadedNodes) {
+      if (not inputs.overloadedNodes.count(node)) {
+        changedNodes.emplace(node, area);
+      }
+    }
+  }
+
+  std::unordered_set<thrift::IpPrefix> prefixes;
+  if (not fullRebuildRequired) {
+    for (auto const& nodeArea : changedNodes) {
+      auto const& nodePrefixes = prefixState.getNodePrefixes(nodeArea);
+      prefixes.insert(nodePrefixes.begin(), nodePrefixes.end());
+    }
+
+    // KSP2 paths may go through any node
+    for (auto const& [prefix, prefixEntries] : prefixState.prefixes()) {
+      for (auto const& [_, prefixEntry] : prefixEntries) {
+        if (*prefixEntry->forwardingAlgorithm_ref() ==
+            thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP) {
+          prefixes.emplace(prefix.toThrift());
+          break;
+        }
+      }
+    }
+
+    // Not worth it if most of the prefixes are affected
+    fullRebuildRequired = prefixes.size() >
+        prefixState.prefixes().size() *
+            Constants::kDecisionIncrementalRouteBuildMaxRatio;
+  }
+
+  if (fullRebuildRequired) {
+    fb303::fbData->addStatValue(
+        "decision.incremental_route_build_fallbacks", 1, fb303::COUNT);
+    return std::nullopt;
+  }
+  fb303::fbData->addStatValue(
+      "decision.incremental_route_build_runs", 1, fb303::COUNT);
+  fb303::fbData->addStatValue(
+      "decision.incremental_route_build_prefixes",
+      prefixes.size(),
+      fb303::AVG);
+  return prefixes;
+}
+
+BestRouteSelectionResult
+SpfSolver::SpfSolverImpl::selectBestRoutes(
+    std::string const& myNodeName,
+    PackedPrefix const& prefix,
+    PrefixEntries const& prefixEntries,
+    bool const isBgp,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  CHECK(prefixEntries.size()) << "No prefixes for best route selection";
+  BestRouteSelectionResult ret;
+
+  if (enableBestRouteSelection_) {
+    // Perform best route selection based on metrics
+    ret.allNodeAreas = selectBestPrefixMetrics(prefixEntries);
+    ret.bestNodeArea = selectBestNodeArea(ret.allNodeAreas, myNodeName);
+    ret.success = true;
+  } else if (isBgp) {
+    ret = runBestPathSelectionBgp(
+        myNodeName, prefix, prefixEntries, areaLinkStates);
+  } else {
+    // If it is openr route, all nodes are considered as best nodes.
+    for (auto const& [nodeAndArea, prefixEntry] : prefixEntries) {
+      ret.allNodeAreas.emplace(nodeAndArea);
+    }
+    ret.bestNodeArea = *ret.allNodeAreas.begin();
+    ret.success = true;
+  }
+
+  return maybeFilterDrainedNodes(std::move(ret), areaLinkStates);
+}
+
+std::optional<int64_t>
+SpfSolver::SpfSolverImpl::getMinNextHopThreshold(
+    BestRouteSelectionResult nodes, PrefixEntries const& prefixEntries) {
+  std::optional<int64_t> maxMinNexthopForPrefix = std::nullopt;
+  for (const auto& nodeArea : nodes.allNodeAreas) {
+    const auto& prefixEntry = *prefixEntries.at(nodeArea);
+    maxMinNexthopForPrefix = prefixEntry.minNexthop_ref().has_value() &&
+            (not maxMinNexthopForPrefix.has_value() ||
+             prefixEntry.minNexthop_ref().value() >
+                 maxMinNexthopForPrefix.value())
+        ? prefixEntry.minNexthop_ref().value()
+        : maxMinNexthopForPrefix;
+  }
+  return maxMinNexthopForPrefix;
+}
 
 BestRouteSelectionResult
 SpfSolver::SpfSolverImpl::maybeFilterDrainedNodes(
@@ -802,22 +1676,24 @@ SpfSolver::SpfSolverImpl::maybeFilterDrainedNodes(
 BestRouteSelectionResult
 SpfSolver::SpfSolverImpl::runBestPathSelectionBgp(
     std::string const& myNodeName,
-    thrift::IpPrefix const& prefix,
+    PackedPrefix const& prefix,
     PrefixEntries const& prefixEntries,
     std::unordered_map<std::string, LinkState> const& areaLinkStates) {
   BestRouteSelectionResult ret;
-  std::optional<thrift::MetricVector> bestVector;
+  // Entries are immutable and outlive selection, refer to the best vector
+  // instead of copying it. PrefixState keeps vectors sorted by priority
+  thrift::MetricVector const* bestVector{nullptr};
   for (auto const& [nodeAndArea, prefixEntry] : prefixEntries) {
     auto const& [nodeName, area] = nodeAndArea;
-    switch (bestVector.has_value()
-                ? MetricVectorUtils::compareMetricVectors(
-                      can_throw(*prefixEntry.mv_ref()), *bestVector)
+    auto const& mv = can_throw(*prefixEntry->mv_ref());
+    switch (bestVector
+                ? MetricVectorUtils::compareMetricVectors(mv, *bestVector)
                 : MetricVectorUtils::CompareResult::WINNER) {
     case MetricVectorUtils::CompareResult::WINNER:
       ret.allNodeAreas.clear();
       FOLLY_FALLTHROUGH;
     case MetricVectorUtils::CompareResult::TIE_WINNER:
-      bestVector = can_throw(*prefixEntry.mv_ref());
+      bestVector = &mv;
       ret.bestNodeArea = nodeAndArea;
       FOLLY_FALLTHROUGH;
     case MetricVectorUtils::CompareResult::TIE_LOOSER:
@@ -842,15 +1718,15 @@ SpfSolver::SpfSolverImpl::runBestPathSelectionBgp(
 std::optional<RibUnicastEntry>
 SpfSolver::SpfSolverImpl::selectBestPathsSpf(
     std::string const& myNodeName,
-    thrift::IpPrefix const& prefix,
+    PackedPrefix const& prefix,
     BestRouteSelectionResult const& bestRouteSelectionResult,
     PrefixEntries const& prefixEntries,
     bool const isBgp,
     thrift::PrefixForwardingType const& forwardingType,
     std::unordered_map<std::string, LinkState> const& areaLinkStates,
-    PrefixState const& prefixState) {
-  const bool isV4Prefix = prefix.prefixAddress_ref()->addr_ref()->size() ==
-      folly::IPAddressV4::byteCount();
+    PrefixState const& prefixState,
+    std::pmr::memory_resource* scratch) {
+  const bool isV4Prefix = prefix.isV4();
   const bool perDestination =
       forwardingType == thrift::PrefixForwardingType::SR_MPLS;
 
@@ -865,17 +1741,92 @@ SpfSolver::SpfSolverImpl::selectBestPathsSpf(
   if (bestRouteSelectionResult.hasNode(myNodeName) && perDestination) {
     for (const auto& [nodeAndArea, prefixEntry] : prefixEntries) {
       if (perDestination && nodeAndArea.first == myNodeName &&
-          prefixEntry.prependLabel_ref()) {
+          prefixEntry->prependLabel_ref()) {
         filteredBestNodeAreas.erase(nodeAndArea);
         break;
       }
     }
   }
 
-  // Get next-hops
-  const auto nextHopsWithMetric = getNextHopsWithMetric(
-      myNodeName, filteredBestNodeAreas, perDestination, areaLinkStates);
-  if (nextHopsWithMetric.second.empty()) {
+  // Look up next-hops computed for another prefix with the same inputs.
+  // NOTE: filteredBestNodeAreas is derived from the key
+  NextHopsCacheKey cacheKey;
+  cacheKey.nodeAreas = bestRouteSelectionResult.allNodeAreas;
+  cacheKey.isV4 = isV4Prefix;
+  cacheKey.perDestination = perDestination;
+  if (perDestination) {
+    for (auto const& nodeArea : cacheKey.nodeAreas) {
+      cacheKey.prependLabels.emplace_back(
+          prefixEntries.at(nodeArea)->prependLabel_ref().to_optional());
+    }
+  }
+  // Entries of an older generation are valid if their inputs are unchanged
+  const auto generation = nextHopsCacheGeneration_;
+  std::optional<std::optional<NextHops>> cachedNextHops;
+  std::optional<CachedNextHops> inputs;
+  bool revalidated{false};
+  {
+    auto cache = nextHopsCache_.rlock();
+    auto it = cache->find(cacheKey);
+    if (it != cache->end() and it->second.generation == generation) {
+      cachedNextHops = it->second.nextHops;
+    } else if (it != cache->end() and not computeLfaPaths_) {
+      inputs = getNextHopsInputs(myNodeName, cacheKey, areaLinkStates);
+      if (inputs->paths == it->second.paths and
+          inputs->nodeLabels == it->second.nodeLabels) {
+        cachedNextHops = it->second.nextHops;
+        revalidated = true;
+      }
+    }
+  }
+  if (revalidated) {
+    auto cache = nextHopsCache_.wlock();
+    auto it = cache->find(cacheKey);
+    if (it != cache->end()) {
+      it->second.generation = std::max(it->second.generation, generation);
+    }
+  }
+
+  if (cachedNextHops.has_value()) {
+    fb303::fbData->addStatValue(
+        "decision.nexthops_cache.hits", 1, fb303::COUNT);
+  } else {
+    fb303::fbData->addStatValue(
+        "decision.nexthops_cache.misses", 1, fb303::COUNT);
+
+    // Get next-hops
+    const auto nextHopsWithMetric = getNextHopsWithMetric(
+        myNodeName,
+        filteredBestNodeAreas,
+        perDestination,
+        areaLinkStates,
+        scratch);
+    if (nextHopsWithMetric.second.empty()) {
+      cachedNextHops.emplace(std::nullopt);
+    } else {
+      cachedNextHops.emplace(getNextHopsThrift(
+          myNodeName,
+          bestRouteSelectionResult.allNodeAreas,
+          isV4Prefix,
+          perDestination,
+          nextHopsWithMetric.first,
+          nextHopsWithMetric.second,
+          std::nullopt,
+          areaLinkStates,
+          prefixEntries));
+    }
+    if (not inputs.has_value()) {
+      inputs = computeLfaPaths_
+          ? CachedNextHops()
+          : getNextHopsInputs(myNodeName, cacheKey, areaLinkStates);
+    }
+    inputs->nextHops = *cachedNextHops;
+    inputs->generation = generation;
+    nextHopsCache_.wlock()->insert_or_assign(
+        std::move(cacheKey), std::move(inputs).value());
+  }
+
+  if (not cachedNextHops->has_value()) {
     VLOG(3) << "No route to prefix " << toString(prefix);
     fb303::fbData->addStatValue("decision.no_route_to_prefix", 1, fb303::COUNT);
     return std::nullopt;
@@ -888,28 +1839,20 @@ SpfSolver::SpfSolverImpl::selectBestPathsSpf(
       prefixEntries,
       prefixState,
       isBgp,
-      getNextHopsThrift(
-          myNodeName,
-          bestRouteSelectionResult.allNodeAreas,
-          isV4Prefix,
-          perDestination,
-          nextHopsWithMetric.first,
-          nextHopsWithMetric.second,
-          std::nullopt,
-          areaLinkStates,
-          prefixEntries));
+      std::move(cachedNextHops)->value());
 }
 
 std::optional<RibUnicastEntry>
 SpfSolver::SpfSolverImpl::selectBestPathsKsp2(
     const string& myNodeName,
-    const thrift::IpPrefix& prefix,
+    PackedPrefix const& prefix,
     BestRouteSelectionResult const& bestRouteSelectionResult,
     PrefixEntries const& prefixEntries,
     bool isBgp,
     thrift::PrefixForwardingType const& forwardingType,
     std::unordered_map<std::string, LinkState> const& areaLinkStates,
-    PrefixState const& prefixState) {
+    PrefixState const& prefixState,
+    std::pmr::memory_resource* scratch) {
   // Sanity check for forwarding type
   if (forwardingType != thrift::PrefixForwardingType::SR_MPLS) {
     LOG(ERROR) << "Incompatible forwarding type "
@@ -922,7 +1865,8 @@ SpfSolver::SpfSolverImpl::selectBestPathsKsp2(
   }
 
   std::unordered_set<thrift::NextHopThrift> nextHops;
-  std::vector<LinkState::Path> paths;
+  // NOTE: Paths are memoized by link state and not copied
+  std::pmr::vector<LinkState::Path const*> paths(scratch);
 
   for (const auto& [area, linkState] : areaLinkStates) {
     // find shortest and sec shortest routes towards each node.
@@ -932,7 +1876,7 @@ SpfSolver::SpfSolverImpl::selectBestPathsKsp2(
         continue;
       }
       for (auto const& path : linkState.getKthPaths(myNodeName, node, 1)) {
-        paths.push_back(path);
+        paths.push_back(&path);
       }
     }
 
@@ -953,13 +1897,13 @@ SpfSolver::SpfSolverImpl::selectBestPathsKsp2(
           // paths are A->B and A->C. And it is second shortest path is
           // A->B->C and A->C->B. In this case,  A->B->C containser A->B
           // already, so we want to avoid this.
-          if (LinkState::pathAInPathB(paths[i], secPath)) {
+          if (LinkState::pathAInPathB(*paths[i], secPath)) {
             add = false;
             break;
           }
         }
         if (add) {
-          paths.push_back(secPath);
+          paths.push_back(&secPath);
         }
       }
     }
@@ -969,15 +1913,15 @@ SpfSolver::SpfSolverImpl::selectBestPathsKsp2(
     return std::nullopt;
   }
 
-  for (const auto& path : paths) {
+  for (const auto* path : paths) {
     for (const auto& [area, linkState] : areaLinkStates) {
       Metric cost = 0;
-      std::list<int32_t> labels;
+      std::pmr::list<int32_t> labels(scratch);
       // if self node is one of it's ecmp, it means this prefix is anycast and
       // we need to add prepend label which is static MPLS route the destination
       // prepared.
       auto nextNodeName = myNodeName;
-      for (auto& link : path) {
+      for (auto& link : *path) {
         cost += link->getMetricFromNode(nextNodeName);
         nextNodeName = link->getOtherNodeName(nextNodeName);
         labels.push_front(*linkState.getAdjacencyDatabases()
@@ -985,15 +1929,15 @@ SpfSolver::SpfSolverImpl::selectBestPathsKsp2(
                                .nodeLabel_ref());
       }
       labels.pop_back(); // Remove first node's label to respect PHP
-      auto& prefixEntry = prefixEntries.at({nextNodeName, area});
+      auto& prefixEntry = *prefixEntries.at({nextNodeName, area});
       if (prefixEntry.prependLabel_ref()) {
         // add prepend label to bottom of the stack
         labels.push_front(prefixEntry.prependLabel_ref().value());
       }
 
       // Create nexthop
-      CHECK_GE(path.size(), 1);
-      auto const& firstLink = path.front();
+      CHECK_GE(path->size(), 1);
+      auto const& firstLink = path->front();
       std::optional<thrift::MplsAction> mplsAction;
       if (labels.size()) {
         std::vector<int32_t> labelVec{labels.begin(), labels.end()};
@@ -1001,8 +1945,7 @@ SpfSolver::SpfSolverImpl::selectBestPathsKsp2(
             thrift::MplsActionCode::PUSH, std::nullopt, std::move(labelVec));
       }
 
-      auto const& prefixStr = *prefix.prefixAddress_ref()->addr_ref();
-      bool isV4Prefix = prefixStr.size() == folly::IPAddressV4::byteCount();
+      const bool isV4Prefix = prefix.isV4();
 
       nextHops.emplace(createNextHop(
           isV4Prefix ? firstLink->getNhV4FromNode(myNodeName)
@@ -1028,20 +1971,18 @@ SpfSolver::SpfSolverImpl::selectBestPathsKsp2(
 std::optional<RibUnicastEntry>
 SpfSolver::SpfSolverImpl::addBestPaths(
     const string& myNodeName,
-    const thrift::IpPrefix& prefixThrift,
+    PackedPrefix const& prefix,
     const BestRouteSelectionResult& bestRouteSelectionResult,
     const PrefixEntries& prefixEntries,
     const PrefixState& prefixState,
     const bool isBgp,
-    std::unordered_set<thrift::NextHopThrift>&& nextHops) {
-  const auto prefix = toIPNetwork(prefixThrift);
-
+    NextHops nextHops) {
   // Apply min-nexthop requirements. Ignore the route from programming if
   // min-nexthop requirement is not met.
   auto minNextHop =
       getMinNextHopThreshold(bestRouteSelectionResult, prefixEntries);
   if (minNextHop.has_value() && minNextHop.value() > nextHops.size()) {
-    LOG(WARNING) << "Dropping route to " << toString(prefixThrift)
+    LOG(WARNING) << "Dropping route to " << toString(prefix)
                  << " because of min-nexthop requirement. "
                  << "Minimum required " << minNextHop.value() << ", got "
                  << nextHops.size();
@@ -1056,8 +1997,8 @@ SpfSolver::SpfSolverImpl::addBestPaths(
   if (bestRouteSelectionResult.hasNode(myNodeName)) {
     std::optional<int32_t> prependLabel;
     for (auto const& [nodeAndArea, prefixEntry] : prefixEntries) {
-      if (nodeAndArea.first == myNodeName and prefixEntry.prependLabel_ref()) {
-        prependLabel = prefixEntry.prependLabel_ref().value();
+      if (nodeAndArea.first == myNodeName and prefixEntry->prependLabel_ref()) {
+        prependLabel = prefixEntry->prependLabel_ref().value();
         break;
       }
     }
@@ -1080,20 +2021,22 @@ SpfSolver::SpfSolverImpl::addBestPaths(
 
   // Create RibUnicastEntry and add it the list
   return RibUnicastEntry(
-      prefix,
+      prefix.masked().toCIDRNetwork(),
       std::move(nextHops),
-      prefixEntries.at(bestRouteSelectionResult.bestNodeArea),
+      *prefixEntries.at(bestRouteSelectionResult.bestNodeArea),
       bestRouteSelectionResult.bestNodeArea.second,
       isBgp & bgpDryRun_); // doNotInstall
 }
 
-std::pair<Metric, std::unordered_set<std::string>>
+std::pair<Metric, std::pmr::unordered_set<std::string>>
 SpfSolver::SpfSolverImpl::getMinCostNodes(
-    const SpfResult& spfResult, const std::set<NodeAndArea>& dstNodeAreas) {
+    const SpfResult& spfResult,
+    const std::set<NodeAndArea>& dstNodeAreas,
+    std::pmr::memory_resource* scratch) {
   Metric shortestMetric = std::numeric_limits<Metric>::max();
 
   // find the set of the closest nodes to our destination
-  std::unordered_set<std::string> minCostNodes;
+  std::pmr::unordered_set<std::string> minCostNodes(scratch);
   for (const auto& [dstNode, _] : dstNodeAreas) {
     auto it = spfResult.find(dstNode);
     if (it == spfResult.end()) {
@@ -1114,26 +2057,22 @@ SpfSolver::SpfSolverImpl::getMinCostNodes(
 
 std::pair<
     Metric /* min metric to destination */,
-    std::unordered_map<
-        std::pair<std::string /* nextHopNodeName */, std::string /* dstNode */>,
-        Metric /* the distance from the nexthop to the dest */>>
+    SpfSolver::SpfSolverImpl::NextHopNodes>
 SpfSolver::SpfSolverImpl::getNextHopsWithMetric(
     const std::string& myNodeName,
     const std::set<NodeAndArea>& dstNodeAreas,
     bool perDestination,
-    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    std::pmr::memory_resource* scratch) {
   // build up next hop nodes both nodes that are along a shortest path to the
   // prefix and, if enabled, those with an LFA path to the prefix
-  std::unordered_map<
-      std::pair<std::string /* nextHopNodeName */, std::string /* dstNode */>,
-      Metric /* the distance from the nexthop to the dest */>
-      nextHopNodes;
+  NextHopNodes nextHopNodes(scratch);
   Metric shortestMetric = std::numeric_limits<Metric>::max();
 
   for (auto const& [area, linkState] : areaLinkStates) {
     auto const& shortestPathsFromHere = linkState.getSpfResult(myNodeName);
     auto const& minMetricNodes =
-        getMinCostNodes(shortestPathsFromHere, dstNodeAreas);
+        getMinCostNodes(shortestPathsFromHere, dstNodeAreas, scratch);
 
     // Choose routes with lowest Metric
     // if Metric is the same, ecmp in multiple area
@@ -1200,7 +2139,7 @@ SpfSolver::SpfSolverImpl::getNextHopsWithMetric(
     }
   }
 
-  return std::make_pair(shortestMetric, nextHopNodes);
+  return std::make_pair(shortestMetric, std::move(nextHopNodes));
 }
 
 std::unordered_set<thrift::NextHopThrift>
@@ -1210,18 +2149,19 @@ SpfSolver::SpfSolverImpl::getNextHopsThrift(
     bool isV4,
     bool perDestination,
     const Metric minMetric,
-    std::unordered_map<std::pair<std::string, std::string>, Metric>
-        nextHopNodes,
+    NextHopNodes const& nextHopNodes,
     std::optional<int32_t> swapLabel,
     std::unordered_map<std::string, LinkState> const& areaLinkStates,
     PrefixEntries const& prefixEntries) const {
   CHECK(not nextHopNodes.empty());
+  // Next-hops which aren't per destination are keyed by empty destination
+  static const std::set<NodeAndArea> kAnyDstNodeArea{{"", ""}};
 
   std::unordered_set<thrift::NextHopThrift> nextHops;
   for (const auto& [area, linkState] : areaLinkStates) {
     for (const auto& link : linkState.linksFromNode(myNodeName)) {
       for (const auto& [dstNode, dstArea] :
-           perDestination ? dstNodeAreas : std::set<NodeAndArea>{{"", ""}}) {
+           perDestination ? dstNodeAreas : kAnyDstNodeArea) {
         // Only consider destinations within the area
         if (not dstArea.empty() and area != dstArea) {
           continue;
@@ -1269,7 +2209,7 @@ SpfSolver::SpfSolverImpl::getNextHopsThrift(
           std::vector<int32_t> pushLabels;
 
           // Add prepend label if any
-          auto& dstPrefixEntry = prefixEntries.at({dstNode, area});
+          auto& dstPrefixEntry = *prefixEntries.at({dstNode, area});
           if (dstPrefixEntry.prependLabel_ref()) {
             pushLabels.emplace_back(dstPrefixEntry.prependLabel_ref().value());
             if (not isMplsLabelValid(pushLabels.back())) {
@@ -1298,14 +2238,18 @@ SpfSolver::SpfSolverImpl::getNextHopsThrift(
 
         // if we are computing LFA paths, any nexthop to the node will do
         // otherwise, we only want those nexthops along a shortest path
-        nextHops.emplace(createNextHop(
+        auto nextHop = createNextHop(
             isV4 ? link->getNhV4FromNode(myNodeName)
                  : link->getNhV6FromNode(myNodeName),
             link->getIfaceFromNode(myNodeName),
             distOverLink,
             mplsAction,
             link->getArea(),
-            link->getOtherNodeName(myNodeName)));
+            link->getOtherNodeName(myNodeName));
+        if (enableLfaBackupNextHops_ and distOverLink != minMetric) {
+          nextHop.isBackup_ref() = true;
+        }
+        nextHops.emplace(std::move(nextHop));
       } // end for perDestination ...
     } // end for linkState ...
   }
@@ -1322,14 +2266,22 @@ SpfSolver::SpfSolver(
     bool computeLfaPaths,
     bool enableOrderedFib,
     bool bgpDryRun,
-    bool enableBestRouteSelection)
+    bool enableBestRouteSelection,
+    size_t routeComputationThreads,
+    bool enableIncrementalRouteBuild,
+    bool enableLfaBackupNextHops,
+    std::optional<thrift::ThreadConfig> threadConfig)
     : impl_(new SpfSolver::SpfSolverImpl(
           myNodeName,
           enableV4,
           computeLfaPaths,
           enableOrderedFib,
           bgpDryRun,
-          enableBestRouteSelection)) {}
+          enableBestRouteSelection,
+          routeComputationThreads,
+          enableIncrementalRouteBuild,
+          enableLfaBackupNextHops,
+          std::move(threadConfig))) {}
 
 SpfSolver::~SpfSolver() {}
 
@@ -1343,21 +2295,41 @@ SpfSolver::getStaticRoutes() {
   return impl_->getStaticRoutes();
 }
 
+std::unordered_set<thrift::IpPrefix>
+SpfSolver::getPrefixesDependingOnStaticRoutes(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    PrefixState const& prefixState,
+    std::unordered_set<int32_t> const& labels) const {
+  return impl_->getPrefixesDependingOnStaticRoutes(
+      myNodeName, areaLinkStates, prefixState, labels);
+}
+
 std::optional<RibUnicastEntry>
 SpfSolver::createRouteForPrefix(
     const std::string& myNodeName,
     std::unordered_map<std::string, LinkState> const& areaLinkStates,
     PrefixState const& prefixState,
-    thrift::IpPrefix const& prefix) {
+    PackedPrefix const& prefix) {
   return impl_->createRouteForPrefix(
       myNodeName, areaLinkStates, prefixState, prefix);
 }
 
-std::unordered_map<thrift::IpPrefix, BestRouteSelectionResult> const&
+std::unordered_map<PackedPrefix, BestRouteSelectionResult> const&
 SpfSolver::getBestRoutesCache() const {
   return impl_->getBestRoutesCache();
 }
 
+void
+SpfSolver::clearNextHopsCache() {
+  impl_->clearNextHopsCache();
+}
+
+SpfSolver::RouteBuildPhaseTimes
+SpfSolver::moveOutRouteBuildPhaseTimes() {
+  return impl_->moveOutRouteBuildPhaseTimes();
+}
+
 std::optional<DecisionRouteDb>
 SpfSolver::buildRouteDb(
     const std::string& myNodeName,
@@ -1366,6 +2338,22 @@ SpfSolver::buildRouteDb(
   return impl_->buildRouteDb(myNodeName, areaLinkStates, prefixState);
 }
 
+DecisionRouteDb
+SpfSolver::buildMplsRouteDb(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  return impl_->buildMplsRouteDb(myNodeName, areaLinkStates);
+}
+
+std::optional<std::unordered_set<thrift::IpPrefix>>
+SpfSolver::getPrefixesAffectedByLinkStateChange(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    PrefixState const& prefixState) {
+  return impl_->getPrefixesAffectedByLinkStateChange(
+      myNodeName, areaLinkStates, prefixState);
+}
+
 //
 // Decision class implementation
 //
@@ -1376,25 +2364,39 @@ Decision::Decision(
     bool bgpDryRun,
     std::chrono::milliseconds debounceMinDur,
     std::chrono::milliseconds debounceMaxDur,
-    messaging::RQueue<thrift::Publication> kvStoreUpdatesQueue,
+    messaging::RQueue<KvStorePublicationPtr> kvStoreUpdatesQueue,
     messaging::RQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue,
-    messaging::ReplicateQueue<DecisionRouteUpdate>& routeUpdatesQueue)
+    messaging::ReplicateQueue<DecisionRouteUpdatePtr>& routeUpdatesQueue,
+    std::optional<messaging::RQueue<KvStoreSyncEvent>> kvStoreSyncEventsQueue)
     : config_(config),
       routeUpdatesQueue_(routeUpdatesQueue),
       myNodeName_(*config->getConfig().node_name_ref()),
-      pendingUpdates_(*config->getConfig().node_name_ref()),
-      rebuildRoutesDebounced_(
-          getEvb(), debounceMinDur, debounceMaxDur, [this]() noexcept {
-            rebuildRoutes("DECISION_DEBOUNCE");
-          }) {
+      pendingUpdates_(*config->getConfig().node_name_ref()) {
   auto tConfig = config->getConfig();
+  if (config->isAdaptiveDecisionDebounceEnabled()) {
+    rebuildRoutesAdaptiveDebounced_ =
+        std::make_unique<AdaptiveDebounce<std::chrono::milliseconds>>(
+            getEvb(), debounceMinDur, debounceMaxDur, [this]() noexcept {
+              rebuildRoutes("DECISION_DEBOUNCE");
+            });
+  } else {
+    rebuildRoutesDebounced_ =
+        std::make_unique<AsyncDebounce<std::chrono::milliseconds>>(
+            getEvb(), debounceMinDur, debounceMaxDur, [this]() noexcept {
+              rebuildRoutes("DECISION_DEBOUNCE");
+            });
+  }
   spfSolver_ = std::make_unique<SpfSolver>(
       *tConfig.node_name_ref(),
       tConfig.enable_v4_ref().value_or(false),
       computeLfaPaths,
       tConfig.enable_ordered_fib_programming_ref().value_or(false),
       bgpDryRun,
-      config->isBestRouteSelectionEnabled());
+      config->isBestRouteSelectionEnabled(),
+      config->getRouteComputationThreads(),
+      config->isIncrementalRouteBuildEnabled(),
+      config->isLfaBackupNextHopsEnabled(),
+      config->getModuleThreadConfig("Decision"));
 
   coldStartTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     pendingUpdates_.setNeedsFullRebuild();
@@ -1404,6 +2406,54 @@ Decision::Decision(
     coldStartTimer_->scheduleTimeout(std::chrono::seconds(*eor));
   }
 
+  // Add reader to end cold start on initial sync of KvStore in every area
+  // rather than on expiry of the cold start timer
+  if (kvStoreSyncEventsQueue.has_value()) {
+    areasPendingInitialSync_ = config->getAreaIds();
+    addFiberTask([q = std::move(kvStoreSyncEventsQueue).value(),
+                  this]() mutable noexcept {
+      LOG(INFO) << "Starting KvStore sync events processing fiber";
+      while (true) {
+        auto maybeEvent = q.get(); // perform read
+        if (maybeEvent.hasError()) {
+          LOG(INFO) << "Terminating KvStore sync events processing fiber";
+          break;
+        }
+        processKvStoreSyncEvent(maybeEvent.value());
+      }
+    });
+  }
+
+  // Persist LSDB periodically and restore it on start for fast restart
+  if (auto snapshotFile = tConfig.decision_lsdb_snapshot_file_ref()) {
+    lsdbSnapshotFile_ = *snapshotFile;
+    if (auto interval = tConfig.decision_lsdb_snapshot_interval_s_ref()) {
+      lsdbSnapshotInterval_ = std::chrono::seconds(std::max(1, *interval));
+    }
+    if (auto maxAge = tConfig.decision_lsdb_snapshot_max_age_s_ref()) {
+      lsdbSnapshotMaxAge_ = std::chrono::seconds(std::max(0, *maxAge));
+    }
+    lsdbSnapshotTimer_ =
+        folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+          writeLsdbSnapshot();
+          lsdbSnapshotTimer_->scheduleTimeout(lsdbSnapshotInterval_);
+        });
+    lsdbReconcileTimer_ =
+        folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+          LOG(WARNING) << "KvStore didn't sync all areas in time, reconciling "
+                       << "LSDB restored from snapshot";
+          for (auto const& [area, _] : restoredNodes_) {
+            areasPendingReconcile_.emplace(area);
+          }
+          scheduleRebuildRoutes();
+        });
+    // restore LSDB once event-base is running
+    runInEventBaseThread([this]() noexcept {
+      loadLsdbSnapshot();
+      lsdbSnapshotTimer_->scheduleTimeout(lsdbSnapshotInterval_);
+    });
+  }
+
   // Schedule periodic timer for counter submission
   counterUpdateTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     updateGlobalCounters();
@@ -1426,34 +2476,23 @@ Decision::Decision(
   }
 
   // Add reader to process publication from KvStore
+#if FOLLY_HAS_COROUTINES
+  addCoroTask(processKvStoreUpdates(std::move(kvStoreUpdatesQueue)));
+#else
   addFiberTask([q = std::move(kvStoreUpdatesQueue), this]() mutable noexcept {
     LOG(INFO) << "Starting KvStore updates processing fiber";
     while (true) {
-      auto maybeThriftPub = q.get(); // perform read
-      VLOG(2) << "Received KvStore update";
-      if (maybeThriftPub.hasError()) {
+      // perform read of all pending publications
+      auto maybeThriftPubs =
+          q.getBatch(Constants::kDecisionPublicationBatchSize);
+      if (maybeThriftPubs.hasError()) {
         LOG(INFO) << "Terminating KvStore updates processing fiber";
         break;
       }
-      try {
-        processPublication(maybeThriftPub.value());
-      } catch (const std::exception& e) {
-#if FOLLY_USE_SYMBOLIZER
-        // collect stack strace then fail the process
-        for (auto& exInfo : folly::exception_tracer::getCurrentExceptions()) {
-          LOG(ERROR) << exInfo;
-        }
-#endif
-        // FATAL to produce core dump
-        LOG(FATAL) << "Exception occured in Decision::processPublication - "
-                   << folly::exceptionStr(e);
-      }
-      // compute routes with exponential backoff timer if needed
-      if (pendingUpdates_.needsRouteUpdate()) {
-        rebuildRoutesDebounced_();
-      }
+      processPublications(maybeThriftPubs.value());
     }
   });
+#endif
 
   // Add reader to process static routes publication from prefix-manager
   addFiberTask(
@@ -1466,23 +2505,81 @@ Decision::Decision(
             LOG(INFO) << "Terminating static routes update processing fiber";
             break;
           }
+          auto delta = std::move(maybeThriftPub).value();
+          std::unordered_set<int32_t> labels{
+              delta.mplsRoutesToDelete_ref()->begin(),
+              delta.mplsRoutesToDelete_ref()->end()};
+          for (auto const& mplsRoute : *delta.mplsRoutesToUpdate_ref()) {
+            labels.emplace(*mplsRoute.topLabel_ref());
+          }
           // Apply publication and update stored update status
-          spfSolver_->updateStaticRoutes(std::move(maybeThriftPub).value());
-          pendingUpdates_.setNeedsFullRebuild(); // Mark for full DB rebuild
-          rebuildRoutesDebounced_();
+          spfSolver_->updateStaticRoutes(std::move(delta));
+          // Computed routes of nodes include static MPLS routes
+          computedRouteDbs_.clear();
+          // Only routes resolving through changed static routes are rebuilt
+          auto dependentPrefixes =
+              spfSolver_->getPrefixesDependingOnStaticRoutes(
+                  myNodeName_, areaLinkStates_, prefixState_, labels);
+          fb303::fbData->addStatValue(
+              "decision.static_route_dependent_prefixes",
+              dependentPrefixes.size(),
+              fb303::SUM);
+          pendingUpdates_.applyStaticRoutesChange(
+              std::move(labels),
+              std::move(dependentPrefixes),
+              thrift::RouteDatabaseDelta().perfEvents_ref()); // No perf events
+          scheduleRebuildRoutes();
         }
       });
 
   // Create RibPolicy timer to process routes on policy expiry
   ribPolicyTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     LOG(WARNING) << "RibPolicy is expired";
-    pendingUpdates_.setNeedsFullRebuild();
-    rebuildRoutes("RIB_POLICY_EXPIRED");
+    rebuildRibPolicyRoutes(ribPolicy_.get(), "RIB_POLICY_EXPIRED");
   });
 
+  // Create route damping and its timer reusing suppressed prefixes
+  if (auto dampingConfig = config->getRouteDampingConfig()) {
+    routeDamping_ = std::make_unique<RouteDamping>(*dampingConfig);
+    routeDampingTimer_ =
+        folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+          reuseDampedRoutes();
+        });
+  }
+
   // Initialize some stat keys
   fb303::fbData->addStatExportType(
       "decision.rib_policy_processing.time_ms", fb303::AVG);
+  for (size_t i = 0; i < SpfSolver::kNumRouteBuildPhases; ++i) {
+    fb303::fbData->addHistogram(
+        getRouteBuildPhaseHistogram(i),
+        Constants::kDecisionPhaseHistogramBucketUs,
+        0,
+        Constants::kDecisionPhaseHistogramMaxUs);
+    fb303::fbData->exportHistogramPercentile(
+        getRouteBuildPhaseHistogram(i), 50, 99);
+  }
+  fb303::fbData->addHistogram(
+      kNetworkConvergenceHistogram,
+      Constants::kConvergenceHistogramBucketMs,
+      0,
+      std::chrono::milliseconds(Constants::kConvergenceMaxDuration).count());
+  fb303::fbData->exportHistogramPercentile(
+      kNetworkConvergenceHistogram, 50, 99);
+}
+
+void
+Decision::stop() {
+  // persist latest state for next start
+  if (lsdbSnapshotTimer_ and isRunning()) {
+    getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
+      lsdbSnapshotTimer_->cancelTimeout();
+      writeLsdbSnapshot();
+    });
+  }
+
+  // Invoke stop method of super class
+  OpenrEventBase::stop();
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
@@ -1490,23 +2587,123 @@ Decision::getDecisionRouteDb(std::string nodeName) {
   folly::Promise<std::unique_ptr<thrift::RouteDatabase>> p;
   auto sf = p.getSemiFuture();
   runInEventBaseThread([p = std::move(p), nodeName, this]() mutable {
-    thrift::RouteDatabase routeDb;
+    if (nodeName.empty()) {
+      nodeName = myNodeName_;
+    }
+    p.setValue(
+        std::make_unique<thrift::RouteDatabase>(getComputedRouteDb(nodeName)));
+  });
+  return sf;
+}
 
+folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
+Decision::getDecisionRouteDbFiltered(
+    std::string nodeName, std::vector<thrift::IpPrefix> prefixes) {
+  folly::Promise<std::unique_ptr<thrift::RouteDatabase>> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([p = std::move(p),
+                        nodeName = std::move(nodeName),
+                        prefixes = std::move(prefixes),
+                        this]() mutable {
     if (nodeName.empty()) {
       nodeName = myNodeName_;
     }
-    auto maybeRouteDb =
-        spfSolver_->buildRouteDb(nodeName, areaLinkStates_, prefixState_);
-    if (maybeRouteDb.has_value()) {
-      routeDb = maybeRouteDb->toThrift();
+    const std::unordered_set<thrift::IpPrefix> prefixSet(
+        prefixes.begin(), prefixes.end());
+    thrift::RouteDatabase routeDb;
+    *routeDb.thisNodeName_ref() = nodeName;
+
+    if (auto cachedRouteDb = findComputedRouteDb(nodeName)) {
+      for (const auto& route : *cachedRouteDb->unicastRoutes_ref()) {
+        if (prefixSet.count(*route.dest_ref())) {
+          routeDb.unicastRoutes_ref()->emplace_back(route);
+        }
+      }
+      p.setValue(std::make_unique<thrift::RouteDatabase>(std::move(routeDb)));
+      return;
     }
 
-    *routeDb.thisNodeName_ref() = nodeName;
+    bool nodeExist{false};
+    for (const auto& [_, linkState] : areaLinkStates_) {
+      nodeExist |= linkState.hasNode(nodeName);
+    }
+    for (const auto& prefix : prefixSet) {
+      const auto key = PackedPrefix::tryFrom(prefix);
+      if (not nodeExist or not key or not prefixState_.prefixes().count(*key)) {
+        continue;
+      }
+      if (auto maybeRoute = spfSolver_->createRouteForPrefix(
+              nodeName, areaLinkStates_, prefixState_, *key)) {
+        routeDb.unicastRoutes_ref()->emplace_back(maybeRoute->toThrift());
+      }
+    }
     p.setValue(std::make_unique<thrift::RouteDatabase>(std::move(routeDb)));
   });
   return sf;
 }
 
+thrift::RouteDatabase const*
+Decision::findComputedRouteDb(const std::string& nodeName) {
+  auto it = computedRouteDbs_.find(nodeName);
+  if (it == computedRouteDbs_.end()) {
+    return nullptr;
+  }
+  auto& computedRouteDb = it->second;
+  bool isCurrent = computedRouteDb.prefixStateVersion ==
+          prefixState_.getVersion() and
+      computedRouteDb.linkStateVersions.size() == areaLinkStates_.size();
+  for (const auto& [area, linkState] : areaLinkStates_) {
+    if (not isCurrent) {
+      break;
+    }
+    auto versionIt = computedRouteDb.linkStateVersions.find(area);
+    isCurrent = versionIt != computedRouteDb.linkStateVersions.end() and
+        versionIt->second == linkState.getVersion();
+  }
+  if (not isCurrent) {
+    computedRouteDbs_.erase(it);
+    return nullptr;
+  }
+  computedRouteDb.lastUsed = ++computedRouteDbUses_;
+  fb303::fbData->addStatValue(
+      "decision.computed_route_db_cache_hit", 1, fb303::COUNT);
+  return &computedRouteDb.routeDb;
+}
+
+thrift::RouteDatabase
+Decision::getComputedRouteDb(const std::string& nodeName) {
+  if (auto cachedRouteDb = findComputedRouteDb(nodeName)) {
+    return *cachedRouteDb;
+  }
+
+  ComputedRouteDb computedRouteDb;
+  auto maybeRouteDb =
+      spfSolver_->buildRouteDb(nodeName, areaLinkStates_, prefixState_);
+  if (maybeRouteDb.has_value()) {
+    computedRouteDb.routeDb = maybeRouteDb->toThrift();
+  }
+  *computedRouteDb.routeDb.thisNodeName_ref() = nodeName;
+  for (const auto& [area, linkState] : areaLinkStates_) {
+    computedRouteDb.linkStateVersions.emplace(area, linkState.getVersion());
+  }
+  computedRouteDb.prefixStateVersion = prefixState_.getVersion();
+  computedRouteDb.lastUsed = ++computedRouteDbUses_;
+
+  // Evict least recently used node
+  if (computedRouteDbs_.size() >=
+      Constants::kDecisionComputedRouteDbCacheSize) {
+    auto lruIt = std::min_element(
+        computedRouteDbs_.begin(),
+        computedRouteDbs_.end(),
+        [](const auto& a, const auto& b) {
+          return a.second.lastUsed < b.second.lastUsed;
+        });
+    computedRouteDbs_.erase(lruIt);
+  }
+  return computedRouteDbs_.emplace(nodeName, std::move(computedRouteDb))
+      .first->second.routeDb;
+}
+
 folly::SemiFuture<StaticMplsRoutes>
 Decision::getMplsStaticRoutes() {
   folly::Promise<StaticMplsRoutes> p;
@@ -1537,6 +2734,62 @@ Decision::getDecisionAdjacenciesFiltered(thrift::AdjacenciesFilter filter) {
   return sf;
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::AdjacencyDbsPage>>
+Decision::getDecisionAdjacenciesFilteredPage(
+    thrift::AdjacenciesFilter filter, thrift::PageParams page) {
+  auto [p, sf] =
+      folly::makePromiseContract<std::unique_ptr<thrift::AdjacencyDbsPage>>();
+  runInEventBaseThread([p = std::move(p),
+                        filter = std::move(filter),
+                        page = std::move(page),
+                        this]() mutable {
+    // Key of adjacency database is "<area>\x01<node>". Separator sorts ahead
+    // of any character of names, hence areas are paginated in order of their
+    // names and nodes in order within area
+    const auto cursor = page.cursor_ref().to_optional();
+    const auto cursorArea = cursor.has_value()
+        ? std::make_optional(cursor->substr(0, cursor->find('\x01')))
+        : std::nullopt;
+    std::map<std::string, LinkState const*> linkStates;
+    for (auto const& [area, linkState] : areaLinkStates_) {
+      if ((filter.get_selectAreas().empty() ||
+           filter.get_selectAreas().count(area)) and
+          (not cursorArea.has_value() or area >= *cursorArea)) {
+        linkStates.emplace(area, &linkState);
+      }
+    }
+
+    auto res = std::make_unique<thrift::AdjacencyDbsPage>();
+    size_t pageSize = std::max(*page.pageSize_ref(), 1);
+    for (auto areaIt = linkStates.begin(); areaIt != linkStates.end();
+         ++areaIt) {
+      const auto keyPrefix = areaIt->first + '\x01';
+      auto [entries, nextCursor] = selectPage(
+          areaIt->second->getAdjacencyDatabases(),
+          [&keyPrefix](auto const& kv) {
+            return std::make_optional(keyPrefix + kv.first);
+          },
+          areaIt->first == cursorArea ? cursor : std::nullopt,
+          pageSize);
+      for (auto const& it : entries) {
+        res->adjacencyDbs_ref()->emplace_back(it->second);
+      }
+      pageSize -= entries.size();
+      if (pageSize == 0 and not nextCursor.has_value() and
+          std::next(areaIt) != linkStates.end()) {
+        // page is full, resume after its last entry
+        nextCursor = keyPrefix + entries.back()->first;
+      }
+      if (nextCursor.has_value()) {
+        res->nextCursor_ref() = std::move(*nextCursor);
+        break;
+      }
+    }
+    p.setValue(std::move(res));
+  });
+  return std::move(sf);
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::PrefixDbs>>
 Decision::getDecisionPrefixDbs() {
   folly::Promise<std::unique_ptr<thrift::PrefixDbs>> p;
@@ -1548,41 +2801,446 @@ Decision::getDecisionPrefixDbs() {
   return sf;
 }
 
-folly::SemiFuture<std::unique_ptr<std::vector<thrift::ReceivedRouteDetail>>>
+folly::SemiFuture<std::unique_ptr<thrift::LsdbSnapshot>>
+Decision::getDecisionLsdbSnapshot(thrift::LsdbSnapshotParams params) {
+  auto [p, sf] =
+      folly::makePromiseContract<std::unique_ptr<thrift::LsdbSnapshot>>();
+  runInEventBaseThread(
+      [this, p = std::move(p), params = std::move(params)]() mutable noexcept {
+        std::optional<int64_t> sinceVersion;
+        if (params.epoch_ref().has_value() and
+            *params.epoch_ref() == lsdbEpoch_ and
+            params.sinceVersion_ref().has_value() and
+            *params.sinceVersion_ref() <= lsdbVersion_) {
+          sinceVersion = *params.sinceVersion_ref();
+        }
+        p.setValue(std::make_unique<thrift::LsdbSnapshot>(
+            buildLsdbSnapshot(sinceVersion)));
+      });
+  return std::move(sf);
+}
+
+thrift::LsdbSnapshot
+Decision::buildLsdbSnapshot(std::optional<int64_t> sinceVersion) const {
+  const bool isDelta = sinceVersion.has_value();
+  LsdbSnapshotWriter writer(myNodeName_, lsdbEpoch_, lsdbVersion_, isDelta);
+  for (const auto& [areaAndNode, version] : lsdbNodeVersions_) {
+    if (isDelta and version <= *sinceVersion) {
+      continue;
+    }
+    const auto& [area, nodeName] = areaAndNode;
+    thrift::AdjacencyDatabase const* adjDb{nullptr};
+    auto linkStateIt = areaLinkStates_.find(area);
+    if (linkStateIt != areaLinkStates_.end()) {
+      const auto& adjDbs = linkStateIt->second.getAdjacencyDatabases();
+      auto adjDbIt = adjDbs.find(nodeName);
+      if (adjDbIt != adjDbs.end()) {
+        adjDb = &adjDbIt->second;
+      }
+    }
+    // Full snapshots leave out nodes gone from area
+    if (not isDelta and adjDb == nullptr and
+        prefixState_.getNodePrefixes({nodeName, area}).empty()) {
+      continue;
+    }
+    writer.addNode(area, nodeName, adjDb, prefixState_);
+  }
+  return std::move(writer).build();
+}
+
+void
+Decision::writeLsdbSnapshot() {
+  if (lsdbVersion_ == lsdbSnapshotWrittenVersion_) {
+    return;
+  }
+  const auto startTime = std::chrono::steady_clock::now();
+
+  auto snapshot = buildLsdbSnapshot(std::nullopt);
+  auto& keyVersions = *snapshot.keyVersions_ref();
+  for (auto const& [area, versions] : lsdbKeyVersions_) {
+    keyVersions[area].insert(versions.begin(), versions.end());
+  }
+  snapshot.timestampMs_ref() = getUnixTimeStampMs();
+
+  try {
+    auto buf = writeThriftObj(snapshot, serializer_);
+    auto iov = buf->getIov();
+    folly::writeFileAtomic(*lsdbSnapshotFile_, iov.data(), iov.size(), 0644);
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to write LSDB snapshot to " << *lsdbSnapshotFile_
+               << ". Error: " << folly::exceptionStr(e);
+    fb303::fbData->addStatValue(
+        "decision.lsdb_snapshot.write_failure", 1, fb303::COUNT);
+    return;
+  }
+  lsdbSnapshotWrittenVersion_ = lsdbVersion_;
+
+  fb303::fbData->addStatValue(
+      "decision.lsdb_snapshot.num_nodes_written",
+      snapshot.nodes_ref()->size(),
+      fb303::AVG);
+  fb303::fbData->addStatValue(
+      "decision.lsdb_snapshot.write_time_ms",
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - startTime)
+          .count(),
+      fb303::AVG);
+}
+
+void
+Decision::loadLsdbSnapshot() {
+  // Publications processed already are more recent than any snapshot
+  if (lsdbVersion_ != 0) {
+    LOG(INFO) << "Not restoring LSDB snapshot, KvStore updates already "
+              << "processed";
+    return;
+  }
+
+  folly::File file;
+  try {
+    file = folly::File(*lsdbSnapshotFile_);
+  } catch (std::system_error const& e) {
+    LOG(INFO) << "No LSDB snapshot at " << *lsdbSnapshotFile_
+              << ". Waiting for KvStore";
+    return;
+  }
+
+  thrift::LsdbSnapshot snapshot;
+  std::unordered_map<std::string, LinkState> linkStates;
+  PrefixState prefixState;
+  try {
+    // deserialize straight off the mapped file
+    folly::MemoryMapping mapping(std::move(file));
+    auto buf = folly::IOBuf::wrapBufferAsValue(mapping.range());
+    snapshot = readThriftObj<thrift::LsdbSnapshot>(buf, serializer_);
+    if (*snapshot.thisNodeName_ref() != myNodeName_) {
+      throw std::invalid_argument(
+          "snapshot of node " + *snapshot.thisNodeName_ref());
+    }
+    const auto ageMs = getUnixTimeStampMs() - *snapshot.timestampMs_ref();
+    if (ageMs > std::chrono::milliseconds(lsdbSnapshotMaxAge_).count()) {
+      LOG(WARNING) << "Not restoring LSDB snapshot written " << ageMs
+                   << "ms ago, older than max age of "
+                   << lsdbSnapshotMaxAge_.count() << "s. Waiting for KvStore";
+      fb303::fbData->addStatValue(
+          "decision.lsdb_snapshot.num_stale", 1, fb303::COUNT);
+      return;
+    }
+    // applied to empty state first, a broken snapshot leaves LSDB untouched
+    applyLsdbSnapshot(
+        snapshot, linkStates, prefixState, config_->isIncrementalSpfEnabled());
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to load LSDB snapshot from " << *lsdbSnapshotFile_
+               << ". Error: " << folly::exceptionStr(e);
+    fb303::fbData->addStatValue(
+        "decision.lsdb_snapshot.load_failure", 1, fb303::COUNT);
+    return;
+  }
+
+  // With ordered FIB, restored adjacencies are held like ones learnt from
+  // KvStore, i.e. by hops from this node, so that routes through far nodes
+  // are programmed after nearer nodes had the chance to program theirs
+  if (orderedFibTimer_ != nullptr) {
+    for (auto& [area, linkState] : linkStates) {
+      LinkState heldLinkState(area, config_->isIncrementalSpfEnabled());
+      for (auto const& [nodeName, adjDb] :
+           linkState.getAdjacencyDatabases()) {
+        LinkStateMetric holdUpTtl = 0, holdDownTtl = 0;
+        if (auto hops = linkState.getHopsFromAToB(myNodeName_, nodeName)) {
+          holdUpTtl = *hops;
+          holdDownTtl = linkState.getMaxHopsToNode(nodeName) - holdUpTtl;
+        }
+        heldLinkState.updateAdjacencyDatabase(adjDb, holdUpTtl, holdDownTtl);
+      }
+      linkState = std::move(heldLinkState);
+    }
+  }
+
+  bool hasHolds{false};
+  for (auto& [area, linkState] : linkStates) {
+    hasHolds |= linkState.hasHolds();
+    areaLinkStates_.insert_or_assign(area, std::move(linkState));
+  }
+  prefixState_ = std::move(prefixState);
+  if (hasHolds and orderedFibTimer_ != nullptr and
+      not orderedFibTimer_->isScheduled()) {
+    orderedFibTimer_->scheduleTimeout(getMaxFib());
+  }
+  const auto& strings = *snapshot.strings_ref();
+  for (auto const& node : *snapshot.nodes_ref()) {
+    const auto& area = strings.at(*node.area_ref());
+    const auto& nodeName = strings.at(*node.nodeName_ref());
+    markLsdbChange(area, nodeName);
+    restoredNodes_[area].emplace(nodeName);
+  }
+  // Keys are superseded as KvStore syncs them, the remaining ones are gone
+  for (auto& [area, versions] : *snapshot.keyVersions_ref()) {
+    restoredKeyVersions_[area].insert(
+        std::make_move_iterator(versions.begin()),
+        std::make_move_iterator(versions.end()));
+  }
+  lsdbKeyVersions_ = restoredKeyVersions_;
+  lsdbSnapshotWrittenVersion_ = lsdbVersion_;
+
+  LOG(INFO) << "Restored LSDB of " << snapshot.nodes_ref()->size()
+            << " nodes from " << *lsdbSnapshotFile_
+            << ", ending cold start";
+  fb303::fbData->addStatValue(
+      "decision.lsdb_snapshot.num_nodes_loaded",
+      snapshot.nodes_ref()->size(),
+      fb303::SUM);
+
+  // Restored state is as consistent as before the restart. Routes are built
+  // from it right away and amended incrementally as KvStore syncs
+  coldStartTimer_->cancelTimeout();
+  if (auto eor = config_->getConfig().eor_time_s_ref()) {
+    lsdbReconcileTimer_->scheduleTimeout(std::chrono::seconds(*eor));
+  } else {
+    lsdbReconcileTimer_->scheduleTimeout(
+        Constants::kDecisionLsdbSnapshotReconcileTimeout);
+  }
+  pendingUpdates_.setNeedsFullRebuild();
+  rebuildRoutes("LSDB_SNAPSHOT_RESTORED");
+}
+
+bool
+Decision::updateLsdbKeyVersion(
+    const std::string& area,
+    const std::string& key,
+    thrift::Value const* value) {
+  if (not lsdbSnapshotFile_.has_value()) {
+    return false;
+  }
+
+  // Key restored from snapshot is synced now, whatever its value
+  std::optional<thrift::LsdbKeyVersion> restored;
+  if (auto areaIt = restoredKeyVersions_.find(area);
+      areaIt != restoredKeyVersions_.end()) {
+    if (auto it = areaIt->second.find(key); it != areaIt->second.end()) {
+      restored = std::move(it->second);
+      areaIt->second.erase(it);
+    }
+  }
+
+  if (value == nullptr) {
+    lsdbKeyVersions_[area].erase(key);
+    return false;
+  }
+  auto& version = lsdbKeyVersions_[area][key];
+  version.version_ref() = *value->version_ref();
+  version.originatorId_ref() = *value->originatorId_ref();
+  if (not restored.has_value() or
+      *restored->version_ref() != *value->version_ref() or
+      *restored->originatorId_ref() != *value->originatorId_ref()) {
+    return false;
+  }
+
+  // Value is the one restored, reuse its state if still there
+  const auto nodeName = getNodeNameFromKey(key);
+  if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
+    auto it = areaLinkStates_.find(area);
+    return it != areaLinkStates_.end() and
+        it->second.getAdjacencyDatabases().count(nodeName);
+  }
+  // NOTE: entries of full prefix databases are tracked per key, which the
+  //       snapshot doesn't hold. Such keys are always parsed
+  auto prefixKey = PrefixKey::fromStr(key);
+  if (not prefixKey.hasValue()) {
+    return false;
+  }
+  const NodeAndArea nodeAndArea{nodeName, area};
+  auto const& prefix = prefixKey.value().getIpPrefix();
+  auto const& prefixes = prefixState_.prefixes();
+  auto prefixIt = prefixes.find(PackedPrefix(prefix));
+  if (prefixIt == prefixes.end()) {
+    return false;
+  }
+  auto entryIt = prefixIt->second.find(nodeAndArea);
+  if (entryIt == prefixIt->second.end()) {
+    return false;
+  }
+  perPrefixPrefixEntries_[nodeAndArea][prefix] = *entryIt->second;
+  return true;
+}
+
+void
+Decision::reconcileRestoredLsdb(const std::string& area) {
+  auto nodesIt = restoredNodes_.find(area);
+  if (nodesIt == restoredNodes_.end()) {
+    return;
+  }
+  const auto restoredNodes = std::move(nodesIt->second);
+  restoredNodes_.erase(nodesIt);
+  if (restoredNodes_.empty()) {
+    lsdbReconcileTimer_->cancelTimeout();
+  }
+
+  // Keys restored but not synced are gone from KvStore
+  thrift::Publication publication;
+  publication.area_ref() = area;
+  if (auto it = restoredKeyVersions_.find(area);
+      it != restoredKeyVersions_.end()) {
+    for (auto const& [key, _] : it->second) {
+      publication.expiredKeys_ref()->emplace_back(key);
+    }
+    restoredKeyVersions_.erase(it);
+  }
+  const auto numExpiredKeys = publication.expiredKeys_ref()->size();
+  processPublication(publication);
+
+  // Prefixes of full prefix databases are withdrawn unless a key of their
+  // node still advertises them
+  for (auto const& nodeName : restoredNodes) {
+    const NodeAndArea nodeAndArea{nodeName, area};
+    auto perPrefixIt = perPrefixPrefixEntries_.find(nodeAndArea);
+    auto fullDbIt = fullDbPrefixEntries_.find(nodeAndArea);
+    // NOTE: copy, prefix state changes while iterating
+    const auto prefixes = prefixState_.getNodePrefixes(nodeAndArea);
+    std::unordered_set<thrift::IpPrefix> changed;
+    for (auto const& prefix : prefixes) {
+      bool advertised = perPrefixIt != perPrefixPrefixEntries_.end() and
+          perPrefixIt->second.count(prefix);
+      if (not advertised and fullDbIt != fullDbPrefixEntries_.end()) {
+        for (auto const& [_, entries] : fullDbIt->second) {
+          if (entries.count(prefix)) {
+            advertised = true;
+            break;
+          }
+        }
+      }
+      if (not advertised and prefixState_.deletePrefix(nodeAndArea, prefix)) {
+        changed.insert(prefix);
+      }
+    }
+    if (not changed.empty()) {
+      markLsdbChange(area, nodeName);
+      pendingUpdates_.applyPrefixStateChange(
+          std::move(changed),
+          thrift::PrefixDatabase().perfEvents_ref()); // Empty perf events
+    }
+  }
+
+  LOG(INFO) << "Reconciled LSDB of area " << area << " restored from "
+            << "snapshot, " << numExpiredKeys << " keys gone";
+  fb303::fbData->addStatValue(
+      "decision.lsdb_snapshot.num_keys_expired", numExpiredKeys, fb303::SUM);
+}
+
+folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteDampingState>>>
+Decision::getRouteDampingStates() {
+  folly::Promise<std::unique_ptr<std::vector<thrift::RouteDampingState>>> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([p = std::move(p), this]() mutable {
+    auto states = std::make_unique<std::vector<thrift::RouteDampingState>>();
+    if (routeDamping_) {
+      *states = routeDamping_->getStates();
+    }
+    p.setValue(std::move(states));
+  });
+  return sf;
+}
+
+void
+Decision::dropCaches() {
+  runInEventBaseThread([this]() noexcept {
+    LOG(INFO) << "Dropping caches of route computation";
+    fb303::fbData->addStatValue("decision.caches_dropped", 1, fb303::COUNT);
+    spfSolver_->clearNextHopsCache();
+    computedRouteDbs_.clear();
+    for (auto& [_, linkState] : areaLinkStates_) {
+      linkState.clearMemoizedResults();
+    }
+  });
+}
+
+void
+Decision::markLsdbChange(const std::string& area, const std::string& nodeName) {
+  lsdbNodeVersions_[{area, nodeName}] = ++lsdbVersion_;
+}
+
+folly::SemiFuture<std::unique_ptr<std::vector<thrift::ReceivedRouteDetail>>>
 Decision::getReceivedRoutesFiltered(thrift::ReceivedRouteFilter filter) {
   auto [p, sf] = folly::makePromiseContract<
       std::unique_ptr<std::vector<thrift::ReceivedRouteDetail>>>();
   runInEventBaseThread(
       [this, p = std::move(p), filter = std::move(filter)]() mutable noexcept {
-        // Get route details
-        auto routes = prefixState_.getReceivedRoutesFiltered(filter);
-
-        // Add best path result to this
-        auto const& bestRoutesCache = spfSolver_->getBestRoutesCache();
-        for (auto& route : routes) {
-          auto const& bestRoutesIt = bestRoutesCache.find(*route.prefix_ref());
-          if (bestRoutesIt != bestRoutesCache.end()) {
-            auto const& bestRoutes = bestRoutesIt->second;
-            // Set all selected node-area
-            for (auto const& [node, area] : bestRoutes.allNodeAreas) {
-              route.bestKeys_ref()->emplace_back();
-              auto& key = route.bestKeys_ref()->back();
-              key.node_ref() = node;
-              key.area_ref() = area;
-            }
-            // Set best node-area
-            route.bestKey_ref()->node_ref() = bestRoutes.bestNodeArea.first;
-            route.bestKey_ref()->area_ref() = bestRoutes.bestNodeArea.second;
-          }
-        }
-
-        // Set the promise
         p.setValue(std::make_unique<std::vector<thrift::ReceivedRouteDetail>>(
-            std::move(routes)));
+            getReceivedRoutesWithBest(filter)));
       });
   return std::move(sf);
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::ReceivedRoutesPage>>
+Decision::getReceivedRoutesFilteredPage(
+    thrift::ReceivedRouteFilter filter, thrift::PageParams page) {
+  auto [p, sf] =
+      folly::makePromiseContract<std::unique_ptr<thrift::ReceivedRoutesPage>>();
+  runInEventBaseThread([this,
+                        p = std::move(p),
+                        filter = std::move(filter),
+                        page = std::move(page)]() mutable noexcept {
+    // Select page of prefixes, then get their routes
+    std::optional<std::unordered_set<PackedPrefix>> selectPrefixes;
+    if (filter.prefixes_ref()) {
+      selectPrefixes.emplace();
+      for (auto const& prefix : *filter.prefixes_ref()) {
+        if (auto key = PackedPrefix::tryFrom(prefix)) {
+          selectPrefixes->emplace(*key);
+        }
+      }
+    }
+    auto [entries, nextCursor] = selectPage(
+        prefixState_.prefixes(),
+        [&selectPrefixes](auto const& kv) -> std::optional<std::string> {
+          if (kv.second.empty() or
+              (selectPrefixes.has_value() and
+               not selectPrefixes->count(kv.first))) {
+            return std::nullopt;
+          }
+          return toString(kv.first);
+        },
+        page.cursor_ref().to_optional(),
+        std::max(*page.pageSize_ref(), 1));
+
+    filter.prefixes_ref() = std::vector<thrift::IpPrefix>();
+    for (auto const& it : entries) {
+      filter.prefixes_ref()->emplace_back(it->first.toThrift());
+    }
+    auto res = std::make_unique<thrift::ReceivedRoutesPage>();
+    res->routes_ref() = getReceivedRoutesWithBest(filter);
+    res->nextCursor_ref().from_optional(std::move(nextCursor));
+    p.setValue(std::move(res));
+  });
+  return std::move(sf);
+}
+
+std::vector<thrift::ReceivedRouteDetail>
+Decision::getReceivedRoutesWithBest(
+    thrift::ReceivedRouteFilter const& filter) const {
+  // Get route details
+  auto routes = prefixState_.getReceivedRoutesFiltered(filter);
+
+  // Add best path result to this
+  auto const& bestRoutesCache = spfSolver_->getBestRoutesCache();
+  for (auto& route : routes) {
+    auto const& bestRoutesIt = bestRoutesCache.find(*route.prefix_ref());
+    if (bestRoutesIt != bestRoutesCache.end()) {
+      auto const& bestRoutes = bestRoutesIt->second;
+      // Set all selected node-area
+      for (auto const& [node, area] : bestRoutes.allNodeAreas) {
+        route.bestKeys_ref()->emplace_back();
+        auto& key = route.bestKeys_ref()->back();
+        key.node_ref() = node;
+        key.area_ref() = area;
+      }
+      // Set best node-area
+      route.bestKey_ref()->node_ref() = bestRoutes.bestNodeArea.first;
+      route.bestKey_ref()->area_ref() = bestRoutes.bestNodeArea.second;
+    }
+  }
+  return routes;
+}
+
 folly::SemiFuture<folly::Unit>
 Decision::setRibPolicy(thrift::RibPolicy const& ribPolicyThrift) {
   auto [p, sf] = folly::makePromiseContract<folly::Unit>();
@@ -1614,14 +3272,13 @@ Decision::setRibPolicy(thrift::RibPolicy const& ribPolicyThrift) {
         // Update local policy instance
         LOG(INFO) << "Updating RibPolicy with new instance. Validity "
                   << durationLeft.count() << "ms";
-        ribPolicy_ = std::move(ribPolicy);
+        std::swap(ribPolicy_, ribPolicy);
 
         // Schedule timer for processing routes on expiry
         ribPolicyTimer_->scheduleTimeout(durationLeft);
 
-        // Trigger route computation
-        pendingUpdates_.setNeedsFullRebuild();
-        rebuildRoutes("RIB_POLICY_UPDATE");
+        // Trigger route computation of routes matched by old or new policy
+        rebuildRibPolicyRoutes(ribPolicy.get(), "RIB_POLICY_UPDATE");
 
         // Mark the policy update request to be done
         p.setValue();
@@ -1651,19 +3308,25 @@ Decision::getRibPolicy() {
   return std::move(sf);
 }
 
-std::optional<thrift::PrefixDatabase>
+std::optional<std::unordered_set<thrift::IpPrefix>>
 Decision::updateNodePrefixDatabase(
-    const std::string& key, const thrift::PrefixDatabase& prefixDb) {
+    const std::string& key,
+    const thrift::PrefixDatabase& prefixDb,
+    const std::string& area) {
   auto const& nodeName = *prefixDb.thisNodeName_ref();
+  const NodeAndArea nodeAndArea{nodeName, area};
 
+  // prefixes whose entry advertised by the node may have changed
+  std::vector<thrift::IpPrefix> touchedPrefixes;
   auto prefixKey = PrefixKey::fromStr(key);
   // per prefix key
   if (prefixKey.hasValue()) {
+    auto const& prefix = prefixKey.value().getIpPrefix();
     if (*prefixDb.deletePrefix_ref()) {
-      perPrefixPrefixEntries_[nodeName].erase(prefixKey.value().getIpPrefix());
+      perPrefixPrefixEntries_[nodeAndArea].erase(prefix);
     } else {
       CHECK_EQ(1, prefixDb.prefixEntries_ref()->size());
-      auto prefixEntry = prefixDb.prefixEntries_ref()->at(0);
+      auto const& prefixEntry = prefixDb.prefixEntries_ref()->at(0);
 
       // Ignore self redistributed route reflection
       // These routes are programmed by Decision,
@@ -1676,33 +3339,143 @@ Decision::updateNodePrefixDatabase(
         return std::nullopt;
       }
 
-      perPrefixPrefixEntries_[nodeName][prefixKey.value().getIpPrefix()] =
-          prefixEntry;
+      perPrefixPrefixEntries_[nodeAndArea][prefix] = prefixEntry;
     }
+    touchedPrefixes.emplace_back(prefix);
   } else {
-    // TODO: deprecate non per-prefix-key logic
-    //       fullDbPrefixEntries_ can be retired
-    fullDbPrefixEntries_[nodeName].clear();
+    // Full database or one of its shards
+    // TODO: deprecate full database logic
+    auto& entries = fullDbPrefixEntries_[nodeAndArea][key];
+    std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry> newEntries;
     for (auto const& entry : *prefixDb.prefixEntries_ref()) {
-      fullDbPrefixEntries_[nodeName][*entry.prefix_ref()] = entry;
+      newEntries[*entry.prefix_ref()] = entry;
+    }
+    for (auto const& [prefix, _] : entries) {
+      if (not newEntries.count(prefix)) {
+        touchedPrefixes.emplace_back(prefix);
+      }
+    }
+    for (auto const& [prefix, entry] : newEntries) {
+      auto it = entries.find(prefix);
+      if (it == entries.end() or it->second != entry) {
+        touchedPrefixes.emplace_back(prefix);
+      }
+    }
+    if (newEntries.empty()) {
+      fullDbPrefixEntries_[nodeAndArea].erase(key);
+    } else {
+      entries = std::move(newEntries);
+    }
+  }
+
+  // Entries of per prefix keys take precedence over full database
+  auto& perPrefixEntries = perPrefixPrefixEntries_[nodeAndArea];
+  auto& fullDbEntries = fullDbPrefixEntries_[nodeAndArea];
+  std::unordered_set<thrift::IpPrefix> changed;
+  for (auto const& prefix : touchedPrefixes) {
+    thrift::PrefixEntry const* entry{nullptr};
+    if (auto it = perPrefixEntries.find(prefix);
+        it != perPrefixEntries.end()) {
+      entry = &it->second;
+    } else {
+      for (auto const& [_, keyEntries] : fullDbEntries) {
+        if (auto it = keyEntries.find(prefix); it != keyEntries.end()) {
+          entry = &it->second;
+          break;
+        }
+      }
     }
+    if (entry ? prefixState_.updatePrefix(nodeAndArea, *entry)
+              : prefixState_.deletePrefix(nodeAndArea, prefix)) {
+      changed.insert(prefix);
+    }
+  }
+  if (perPrefixEntries.empty()) {
+    perPrefixPrefixEntries_.erase(nodeAndArea);
+  }
+  if (fullDbEntries.empty()) {
+    fullDbPrefixEntries_.erase(nodeAndArea);
+  }
+
+  fb303::fbData->addStatValue(
+      "decision.prefix_db_update.touched_prefixes",
+      touchedPrefixes.size(),
+      fb303::SUM);
+  fb303::fbData->addStatValue(
+      "decision.prefix_db_update.changed_prefixes",
+      changed.size(),
+      fb303::SUM);
+  return changed;
+}
+
+void
+Decision::processKvStoreSyncEvent(KvStoreSyncEvent const& event) {
+  // State restored from LSDB snapshot is reconciled with synced KvStore on
+  // next rebuild, which picks up any publication still in flight
+  if (restoredNodes_.count(event.area)) {
+    areasPendingReconcile_.emplace(event.area);
+    scheduleRebuildRoutes();
+  }
+
+  if (not areasPendingInitialSync_.erase(event.area) or
+      not areasPendingInitialSync_.empty() or
+      not coldStartTimer_->isScheduled()) {
+    return;
   }
 
-  thrift::PrefixDatabase nodePrefixDb;
-  *nodePrefixDb.thisNodeName_ref() = nodeName;
-  nodePrefixDb.perfEvents_ref().copy_from(prefixDb.perfEvents_ref());
-  nodePrefixDb.prefixEntries_ref()->reserve(
-      perPrefixPrefixEntries_[nodeName].size());
-  for (auto& kv : perPrefixPrefixEntries_[nodeName]) {
-    nodePrefixDb.prefixEntries_ref()->emplace_back(kv.second);
+  // Publications of the initial sync precede the sync event in KvStore. Full
+  // rebuild goes through debounce to pick up any publication still in flight
+  LOG(INFO) << "KvStore completed initial sync in all areas, ending cold "
+            << "start. Last synced area " << event.area << " with peer "
+            << event.nodeName;
+  fb303::fbData->addStatValue(
+      "decision.cold_start.initial_sync_completed", 1, fb303::COUNT);
+  coldStartTimer_->cancelTimeout();
+  pendingUpdates_.setNeedsFullRebuild();
+  scheduleRebuildRoutes();
+}
+
+void
+Decision::processPublications(std::vector<KvStorePublicationPtr> const& pubs) {
+  VLOG(2) << "Received " << pubs.size() << " KvStore updates";
+  try {
+    for (const auto& thriftPub : pubs) {
+      processPublication(*thriftPub);
+    }
+  } catch (const std::exception& e) {
+#if FOLLY_USE_SYMBOLIZER
+    // collect stack strace then fail the process
+    for (auto& exInfo : folly::exception_tracer::getCurrentExceptions()) {
+      LOG(ERROR) << exInfo;
+    }
+#endif
+    // FATAL to produce core dump
+    LOG(FATAL) << "Exception occured in Decision::processPublication - "
+               << folly::exceptionStr(e);
   }
-  for (auto& kv : fullDbPrefixEntries_[nodeName]) {
-    if (not perPrefixPrefixEntries_[nodeName].count(kv.first)) {
-      nodePrefixDb.prefixEntries_ref()->emplace_back(kv.second);
+  // compute routes with exponential backoff timer if needed, once for the
+  // whole batch
+  if (pendingUpdates_.needsRouteUpdate()) {
+    scheduleRebuildRoutes();
+  }
+}
+
+#if FOLLY_HAS_COROUTINES
+folly::coro::Task<void>
+Decision::processKvStoreUpdates(messaging::RQueue<KvStorePublicationPtr> q) {
+  LOG(INFO) << "Starting KvStore updates processing task";
+  while (true) {
+    // perform read of all pending publications
+    auto maybeThriftPubs =
+        co_await q.getBatchCoro(Constants::kDecisionPublicationBatchSize);
+    if (maybeThriftPubs.hasError()) {
+      LOG(INFO) << "Terminating KvStore updates processing task";
+      break;
     }
+    processPublications(maybeThriftPubs.value());
   }
-  return nodePrefixDb;
 }
+#endif
 
 void
 Decision::processPublication(thrift::Publication const& thriftPub) {
@@ -1710,7 +3483,10 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
   auto const& area = *thriftPub.area_ref();
 
   if (!areaLinkStates_.count(area)) {
-    areaLinkStates_.emplace(area, area);
+    areaLinkStates_.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(area),
+        std::forward_as_tuple(area, config_->isIncrementalSpfEnabled()));
   }
   auto& areaLinkState = areaLinkStates_.at(area);
 
@@ -1732,8 +3508,18 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
     //  1) prefix:*
     //  2) adj:*
     //  3) fibtime:*
+    //  4) convtime:*
     const std::string nodeName = getNodeNameFromKey(key);
 
+    // Skip parsing values restored from LSDB snapshot already
+    if ((key.find(Constants::kAdjDbMarker.toString()) == 0 or
+         key.find(Constants::kPrefixDbMarker.toString()) == 0) and
+        updateLsdbKeyVersion(area, key, &rawVal)) {
+      fb303::fbData->addStatValue(
+          "decision.lsdb_snapshot.num_keys_reused", 1, fb303::SUM);
+      continue;
+    }
+
     try {
       // adjacencyDb: update keys starting with "adj:"
       if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
@@ -1754,11 +3540,14 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
           }
         }
         fb303::fbData->addStatValue("decision.adj_db_update", 1, fb303::COUNT);
+        const auto change = areaLinkState.updateAdjacencyDatabase(
+            std::move(adjacencyDb), holdUpTtl, holdDownTtl);
+        // perf events are read from the database moved into link state
+        auto const& storedAdjDb =
+            areaLinkState.getAdjacencyDatabases().at(nodeName);
         pendingUpdates_.applyLinkStateChange(
-            nodeName,
-            areaLinkState.updateAdjacencyDatabase(
-                adjacencyDb, holdUpTtl, holdDownTtl),
-            adjacencyDb.perfEvents_ref());
+            nodeName, change, storedAdjDb.perfEvents_ref());
+        markLsdbChange(area, nodeName);
         if (areaLinkState.hasHolds() && orderedFibTimer_ != nullptr &&
             !orderedFibTimer_->isScheduled()) {
           orderedFibTimer_->scheduleTimeout(getMaxFib());
@@ -1772,19 +3561,19 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
             rawVal.value_ref().value(), serializer_);
         CHECK_EQ(nodeName, *prefixDb.thisNodeName_ref());
 
-        auto maybeNodePrefixDb = updateNodePrefixDatabase(key, prefixDb);
-        if (not maybeNodePrefixDb.has_value()) {
+        // TODO - area should directly come from KvStore.
+        auto changedPrefixes = updateNodePrefixDatabase(key, prefixDb, area);
+        if (not changedPrefixes.has_value()) {
           continue;
         }
-        auto nodePrefixDb = maybeNodePrefixDb.value();
-        // TODO - this should directly come from KvStore.
-        *nodePrefixDb.area_ref() = area;
+        if (not changedPrefixes->empty()) {
+          markLsdbChange(area, nodeName);
+        }
 
         fb303::fbData->addStatValue(
             "decision.prefix_db_update", 1, fb303::COUNT);
         pendingUpdates_.applyPrefixStateChange(
-            prefixState_.updatePrefixDatabase(nodePrefixDb),
-            nodePrefixDb.perfEvents_ref());
+            std::move(changedPrefixes).value(), prefixDb.perfEvents_ref());
         continue;
       }
 
@@ -1800,6 +3589,20 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
         }
         continue;
       }
+
+      // update keys starting with "convtime:"
+      if (key.find(Constants::kConvergenceTimeMarker.toString()) == 0) {
+        try {
+          fb303::fbData->addHistogramValue(
+              kNetworkConvergenceHistogram,
+              stoll(rawVal.value_ref().value()));
+        } catch (...) {
+          LOG(ERROR) << "Could not convert "
+                     << Constants::kConvergenceTimeMarker.toString()
+                     << " value to int64";
+        }
+        continue;
+      }
     } catch (const std::exception& e) {
       LOG(ERROR) << "Failed to deserialize info for key " << key
                  << ". Exception: " << folly::exceptionStr(e);
@@ -1812,41 +3615,250 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
 
     // adjacencyDb: delete keys starting with "adj:"
     if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
+      updateLsdbKeyVersion(area, key, nullptr);
       pendingUpdates_.applyLinkStateChange(
           nodeName,
           areaLinkState.deleteAdjacencyDatabase(nodeName),
           thrift::PrefixDatabase().perfEvents_ref()); // Empty perf events
+      markLsdbChange(area, nodeName);
       continue;
     }
 
     // prefixDb: delete keys starting with "prefix:"
     if (key.find(Constants::kPrefixDbMarker.toString()) == 0) {
+      updateLsdbKeyVersion(area, key, nullptr);
       // manually build delete prefix db to signal delete just as a client would
       thrift::PrefixDatabase deletePrefixDb;
       *deletePrefixDb.thisNodeName_ref() = nodeName;
       deletePrefixDb.deletePrefix_ref() = true;
 
-      auto maybeNodePrefixDb = updateNodePrefixDatabase(key, deletePrefixDb);
-      if (not maybeNodePrefixDb.has_value()) {
+      // TODO - area should directly come from KvStore.
+      auto changedPrefixes =
+          updateNodePrefixDatabase(key, deletePrefixDb, area);
+      if (not changedPrefixes.has_value()) {
         continue;
       }
-      auto nodePrefixDb = maybeNodePrefixDb.value();
-      // TODO - this should directly come from KvStore.
-      *nodePrefixDb.area_ref() = area;
+      if (not changedPrefixes->empty()) {
+        markLsdbChange(area, nodeName);
+      }
 
       pendingUpdates_.applyPrefixStateChange(
-          prefixState_.updatePrefixDatabase(nodePrefixDb),
+          std::move(changedPrefixes).value(),
           thrift::PrefixDatabase().perfEvents_ref()); // Empty perf events
       continue;
     }
   }
 }
 
+DecisionRouteUpdate
+Decision::rebuildAffectedRoutes(
+    std::unordered_set<thrift::IpPrefix>&& affectedPrefixes) {
+  const auto startTime = std::chrono::steady_clock::now();
+  DecisionRouteUpdate update;
+
+  // Routes of affected and updated prefixes
+  affectedPrefixes.insert(
+      pendingUpdates_.updatedPrefixes().begin(),
+      pendingUpdates_.updatedPrefixes().end());
+  for (auto const& prefix : affectedPrefixes) {
+    if (auto maybeRibEntry = spfSolver_->createRouteForPrefix(
+            myNodeName_, areaLinkStates_, prefixState_, prefix)) {
+      update.addRouteToUpdate(std::move(maybeRibEntry).value());
+    } else if (const auto key = PackedPrefix(prefix).masked();
+               routeDb_.unicastRoutes.count(key)) {
+      update.unicastRoutesToDelete.emplace_back(key.toCIDRNetwork());
+    }
+  }
+  if (ribPolicy_) {
+    auto start = std::chrono::steady_clock::now();
+    auto const changes = ribPolicy_->applyPolicy(update.unicastRoutesToUpdate);
+    updateCounters(
+        "decision.rib_policy_processing.time_ms",
+        start,
+        std::chrono::steady_clock::now());
+    for (auto const& prefix : changes.deletedRoutes) {
+      update.unicastRoutesToDelete.push_back(prefix);
+    }
+  }
+
+  // Only report routes that actually changed, as a full rebuild would
+  for (auto it = update.unicastRoutesToUpdate.begin();
+       it != update.unicastRoutesToUpdate.end();) {
+    auto search = routeDb_.unicastRoutes.find(it->first);
+    if (search != routeDb_.unicastRoutes.end() and
+        search->second == it->second) {
+      it = update.unicastRoutesToUpdate.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // MPLS routes are few, rebuild all of them
+  DecisionRouteDb mplsRouteDb =
+      spfSolver_->buildMplsRouteDb(myNodeName_, areaLinkStates_);
+  // NOTE: calculateUpdate() diffs complete route DBs, hence diff MPLS-only DBs
+  DecisionRouteDb currentMplsDb;
+  currentMplsDb.mplsRoutes = routeDb_.mplsRoutes;
+  auto mplsUpdate = currentMplsDb.calculateUpdate(std::move(mplsRouteDb));
+  update.mplsRoutesToUpdate = std::move(mplsUpdate.mplsRoutesToUpdate);
+  update.mplsRoutesToDelete = std::move(mplsUpdate.mplsRoutesToDelete);
+
+  updateCounters(
+      "decision.incremental_route_build_ms",
+      startTime,
+      std::chrono::steady_clock::now());
+  return update;
+}
+
+void
+Decision::rebuildRibPolicyRoutes(
+    RibPolicy const* oldRibPolicy, std::string const& event) {
+  // Routes get built along with policy on cold start
+  if (coldStartTimer_->isScheduled()) {
+    return;
+  }
+
+  // Policy only transforms existing routes
+  std::unordered_set<folly::CIDRNetwork> prefixes;
+  RibPolicy const* const policies[] = {oldRibPolicy, ribPolicy_.get()};
+  for (auto const* policy : policies) {
+    if (not policy) {
+      continue;
+    }
+    for (auto const& prefix : policy->getMatchedPrefixes()) {
+      if (routeDb_.unicastRoutes.count(prefix)) {
+        prefixes.emplace(prefix);
+      }
+    }
+  }
+
+  auto update = rebuildPrefixRoutes(prefixes);
+  fb303::fbData->addStatValue(
+      "decision.rib_policy.rebuilt_routes", prefixes.size(), fb303::SUM);
+
+  VLOG(1) << "Decision: " << event << " changed "
+          << update.unicastRoutesToUpdate.size() << " of " << prefixes.size()
+          << " routes matched by RibPolicy.";
+  dampRouteUpdate(update);
+  routeDb_.update(update);
+  routeUpdatesQueue_.pushShared(std::move(update));
+}
+
+DecisionRouteUpdate
+Decision::rebuildPrefixRoutes(
+    std::unordered_set<folly::CIDRNetwork> const& prefixes) {
+  prefixState_.updateReachability(myNodeName_, areaLinkStates_);
+  DecisionRouteUpdate update;
+  for (auto const& prefix : prefixes) {
+    if (auto maybeRibEntry = spfSolver_->createRouteForPrefix(
+            myNodeName_, areaLinkStates_, prefixState_, toIpPrefix(prefix))) {
+      update.addRouteToUpdate(std::move(maybeRibEntry).value());
+    } else if (routeDb_.unicastRoutes.count(prefix)) {
+      update.unicastRoutesToDelete.emplace_back(prefix);
+    }
+  }
+  if (ribPolicy_) {
+    auto start = std::chrono::steady_clock::now();
+    auto const changes = ribPolicy_->applyPolicy(update.unicastRoutesToUpdate);
+    updateCounters(
+        "decision.rib_policy_processing.time_ms",
+        start,
+        std::chrono::steady_clock::now());
+    for (auto const& prefix : changes.deletedRoutes) {
+      if (routeDb_.unicastRoutes.count(prefix)) {
+        update.unicastRoutesToDelete.push_back(prefix);
+      }
+    }
+  }
+
+  // Only report routes that actually changed, as a full rebuild would
+  for (auto it = update.unicastRoutesToUpdate.begin();
+       it != update.unicastRoutesToUpdate.end();) {
+    auto search = routeDb_.unicastRoutes.find(it->first);
+    if (search != routeDb_.unicastRoutes.end() and
+        search->second == it->second) {
+      it = update.unicastRoutesToUpdate.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return update;
+}
+
+void
+Decision::dampRouteUpdate(DecisionRouteUpdate& update) {
+  if (not routeDamping_) {
+    return;
+  }
+  routeDamping_->apply(update, routeDb_.unicastRoutes);
+  if (routeDamping_->getNumPrefixes() and
+      not routeDampingTimer_->isScheduled()) {
+    routeDampingTimer_->scheduleTimeout(
+        Constants::kDecisionRouteDampingReuseInterval);
+  }
+}
+
+void
+Decision::reuseDampedRoutes() {
+  const auto reused = routeDamping_->reuse();
+  if (routeDamping_->getNumPrefixes()) {
+    routeDampingTimer_->scheduleTimeout(
+        Constants::kDecisionRouteDampingReuseInterval);
+  }
+  if (reused.empty()) {
+    return;
+  }
+
+  auto update = rebuildPrefixRoutes({reused.begin(), reused.end()});
+  VLOG(1) << "Decision: reused " << reused.size() << " damped prefixes, "
+          << update.unicastRoutesToUpdate.size() << " routes changed, "
+          << update.unicastRoutesToDelete.size() << " withdrawn.";
+  if (update.unicastRoutesToUpdate.empty() and
+      update.unicastRoutesToDelete.empty()) {
+    return;
+  }
+  routeDb_.update(update);
+  routeUpdatesQueue_.pushShared(std::move(update));
+}
+
+void
+Decision::scheduleRebuildRoutes() {
+  if (rebuildRoutesDebounced_) {
+    (*rebuildRoutesDebounced_)();
+    return;
+  }
+  if (auto delay = (*rebuildRoutesAdaptiveDebounced_)()) {
+    fb303::fbData->addStatValue(
+        "decision.debounce.delay_ms", delay->count(), fb303::AVG);
+    fb303::fbData->addStatValue(
+        "decision.debounce.last_rebuild_ms",
+        rebuildRoutesAdaptiveDebounced_->getLastRunCost().count(),
+        fb303::AVG);
+  }
+}
+
 void
 Decision::rebuildRoutes(std::string const& event) {
   if (coldStartTimer_->isScheduled()) {
     return;
   }
+  if (not areasPendingReconcile_.empty()) {
+    for (auto const& area : std::exchange(
+             areasPendingReconcile_, std::unordered_set<std::string>())) {
+      reconcileRestoredLsdb(area);
+    }
+    if (not pendingUpdates_.needsRouteUpdate()) {
+      return;
+    }
+  }
+  FOLLY_SDT(
+      openr,
+      decision_rebuild_routes_entry,
+      event.c_str(),
+      pendingUpdates_.getCount());
+  SCOPE_EXIT {
+    FOLLY_SDT(openr, decision_rebuild_routes_return, event.c_str());
+  };
 
   pendingUpdates_.addEvent(event);
   VLOG(2) << "Decision: processing " << pendingUpdates_.getCount()
@@ -1861,10 +3873,33 @@ Decision::rebuildRoutes(std::string const& event) {
     }
   }
 
+  // Time route computation phases of this rebuild only
+  const auto rebuildStartTs = getUnixTimeStampMs();
+  spfSolver_->moveOutRouteBuildPhaseTimes();
+
+  // Run SPF of this node up front to time it apart from route computation
+  const auto spfStartTime = std::chrono::steady_clock::now();
+  for (auto const& [_, linkState] : areaLinkStates_) {
+    linkState.getSpfResult(myNodeName_);
+  }
+  const auto spfTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - spfStartTime);
+
+  // Refresh reachable advertisers of prefixes for route computation
+  prefixState_.updateReachability(myNodeName_, areaLinkStates_);
+
+  // Narrow down topology changes to affected prefixes if possible
+  std::optional<std::unordered_set<thrift::IpPrefix>> affectedPrefixes;
+  if (pendingUpdates_.needsTopologyRebuildOnly()) {
+    affectedPrefixes = spfSolver_->getPrefixesAffectedByLinkStateChange(
+        myNodeName_, areaLinkStates_, prefixState_);
+  }
+
   DecisionRouteUpdate update;
-  if (pendingUpdates_.needsFullRebuild()) {
-    // if only static routes gets updated, we still need to update routes
-    // because there maybe routes depended on static routes.
+  std::chrono::microseconds calculateUpdateTime{0};
+  if (affectedPrefixes.has_value()) {
+    update = rebuildAffectedRoutes(std::move(affectedPrefixes).value());
+  } else if (pendingUpdates_.needsFullRebuild()) {
     auto maybeRouteDb =
         spfSolver_->buildRouteDb(myNodeName_, areaLinkStates_, prefixState_);
     LOG_IF(WARNING, !maybeRouteDb)
@@ -1878,14 +3913,19 @@ Decision::rebuildRoutes(std::string const& event) {
           start,
           std::chrono::steady_clock::now());
     }
+    const auto calculateUpdateStartTime = std::chrono::steady_clock::now();
     update = routeDb_.calculateUpdate(std::move(db));
+    calculateUpdateTime =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - calculateUpdateStartTime);
   } else {
     for (auto const& prefix : pendingUpdates_.updatedPrefixes()) {
       if (auto maybeRibEntry = spfSolver_->createRouteForPrefix(
               myNodeName_, areaLinkStates_, prefixState_, prefix)) {
         update.addRouteToUpdate(std::move(maybeRibEntry).value());
       } else {
-        update.unicastRoutesToDelete.emplace_back(toIPNetwork(prefix));
+        update.unicastRoutesToDelete.emplace_back(
+            PackedPrefix(prefix).masked().toCIDRNetwork());
       }
     }
     if (ribPolicy_) {
@@ -1900,14 +3940,64 @@ Decision::rebuildRoutes(std::string const& event) {
         update.unicastRoutesToDelete.push_back(prefix);
       }
     }
+
+    // Changed static MPLS routes. Routes depending on them are among updated
+    // prefixes
+    auto const& staticRoutes = spfSolver_->getStaticRoutes();
+    for (auto const label : pendingUpdates_.updatedStaticLabels()) {
+      auto it = staticRoutes.find(label);
+      if (it == staticRoutes.end()) {
+        if (routeDb_.mplsRoutes.count(label)) {
+          update.mplsRoutesToDelete.emplace_back(label);
+        }
+        continue;
+      }
+      RibMplsEntry entry(
+          label,
+          std::unordered_set<thrift::NextHopThrift>{
+              it->second.begin(), it->second.end()});
+      auto search = routeDb_.mplsRoutes.find(label);
+      if (search != routeDb_.mplsRoutes.end() and search->second == entry) {
+        continue;
+      }
+      update.mplsRoutesToUpdate.emplace_back(std::move(entry));
+    }
   }
 
+  auto phaseTimes = spfSolver_->moveOutRouteBuildPhaseTimes();
+  phaseTimes[static_cast<size_t>(SpfSolver::RouteBuildPhase::SPF)] = spfTime;
+  phaseTimes[static_cast<size_t>(
+      SpfSolver::RouteBuildPhase::CALCULATE_UPDATE)] = calculateUpdateTime;
+  recordRouteBuildPhases(phaseTimes, rebuildStartTs);
+
+  dampRouteUpdate(update);
   routeDb_.update(update);
   pendingUpdates_.addEvent("ROUTE_UPDATE");
   update.perfEvents = pendingUpdates_.moveOutEvents();
   pendingUpdates_.reset();
 
-  routeUpdatesQueue_.push(std::move(update));
+  routeUpdatesQueue_.pushShared(std::move(update));
+}
+
+void
+Decision::recordRouteBuildPhases(
+    SpfSolver::RouteBuildPhaseTimes const& phaseTimes, int64_t startTs) {
+  // Phases interleave per prefix, hence perf events of phases are placed at
+  // the cumulative time of phases since the start of the rebuild
+  std::chrono::microseconds elapsedTime{0};
+  for (size_t i = 0; i < SpfSolver::kNumRouteBuildPhases; ++i) {
+    fb303::fbData->addHistogramValue(
+        getRouteBuildPhaseHistogram(i), phaseTimes[i].count());
+    elapsedTime += phaseTimes[i];
+    pendingUpdates_.addEvent(
+        kRouteBuildPhaseNames[i].second.str(),
+        std::min<int64_t>(
+            getUnixTimeStampMs(),
+            startTs +
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    elapsedTime)
+                    .count()));
+  }
 }
 
 bool
@@ -1990,6 +4080,19 @@ Decision::updateGlobalCounters() const {
       "decision.num_nodes", std::max(nodeSet.size(), static_cast<size_t>(1ul)));
   fb303::fbData->setCounter(
       "decision.num_prefixes", prefixState_.prefixes().size());
+  fb303::fbData->setCounter(
+      "decision.num_nexthop_groups", NextHopGroup::numGroups());
+  if (routeDamping_) {
+    fb303::fbData->setCounter(
+        "decision.route_damping.num_prefixes",
+        routeDamping_->getNumPrefixes());
+    fb303::fbData->setCounter(
+        "decision.route_damping.num_suppressed_prefixes",
+        routeDamping_->getNumSuppressed());
+    fb303::fbData->setCounter(
+        "decision.route_damping.max_penalty",
+        static_cast<int64_t>(routeDamping_->getMaxPenalty()));
+  }
 }
 
 } // namespace openr
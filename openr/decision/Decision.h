@@ -7,9 +7,12 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <map>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <folly/Format.h>
 #include <folly/IPAddress.h>
@@ -20,6 +23,7 @@
 #include <thrift/lib/cpp2/Thrift.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
+#include <openr/common/AdaptiveDebounce.h>
 #include <openr/common/AsyncDebounce.h>
 #include <openr/common/AsyncThrottle.h>
 #include <openr/common/OpenrEventBase.h>
@@ -29,6 +33,7 @@
 #include <openr/decision/PrefixState.h>
 #include <openr/decision/RibEntry.h>
 #include <openr/decision/RibPolicy.h>
+#include <openr/decision/RouteDamping.h>
 #include <openr/decision/RouteUpdate.h>
 #include <openr/if/gen-cpp2/Decision_types.h>
 #include <openr/if/gen-cpp2/Fib_types.h>
@@ -79,8 +84,9 @@ struct BestRouteSelectionResult {
 
 class DecisionRouteDb {
  public:
-  std::unordered_map<folly::CIDRNetwork /* prefix */, RibUnicastEntry>
-      unicastRoutes;
+  // NOTE: Keyed by PackedPrefix of RibUnicastEntry::prefix, route deltas of
+  // DecisionRouteUpdate carry folly::CIDRNetwork
+  std::unordered_map<PackedPrefix, RibUnicastEntry> unicastRoutes;
   std::unordered_map<int32_t /* label */, RibMplsEntry> mplsRoutes;
 
   // calculate the delta between this and newDb. Note, this method is const;
@@ -139,12 +145,20 @@ class DecisionPendingUpdates {
 
   bool
   needsFullRebuild() const {
-    return needsFullRebuild_;
+    return needsFullRebuild_ || topologyChanged_;
+  }
+
+  // full rebuild is only needed because of topology changes. Routes may then
+  // be rebuilt for affected prefixes only
+  bool
+  needsTopologyRebuildOnly() const {
+    return topologyChanged_ && !needsFullRebuild_;
   }
 
   bool
   needsRouteUpdate() const {
-    return needsFullRebuild() || !updatedPrefixes_.empty();
+    return needsFullRebuild() || !updatedPrefixes_.empty() ||
+        !updatedStaticLabels_.empty();
   }
 
   std::unordered_set<thrift::IpPrefix> const&
@@ -152,6 +166,11 @@ class DecisionPendingUpdates {
     return updatedPrefixes_;
   }
 
+  std::unordered_set<int32_t> const&
+  updatedStaticLabels() const {
+    return updatedStaticLabels_;
+  }
+
   void applyLinkStateChange(
       std::string const& nodeName,
       LinkState::LinkStateChange const& change,
@@ -161,10 +180,21 @@ class DecisionPendingUpdates {
       std::unordered_set<thrift::IpPrefix>&& change,
       apache::thrift::optional_field_ref<thrift::PerfEvents const&> perfEvents);
 
+  // static MPLS routes of given labels changed. Routes of given prefixes
+  // resolve through them and get rebuilt along with updated prefixes
+  void applyStaticRoutesChange(
+      std::unordered_set<int32_t>&& labels,
+      std::unordered_set<thrift::IpPrefix>&& dependentPrefixes,
+      apache::thrift::optional_field_ref<thrift::PerfEvents const&> perfEvents);
+
   void reset();
 
   void addEvent(std::string const& eventDescription);
 
+  // add event at given unix timestamp in ms, e.g. the end of a phase that got
+  // timed separately. Timestamp doesn't go before the previous event
+  void addEvent(std::string const& eventDescription, int64_t unixTs);
+
   std::optional<thrift::PerfEvents> const&
   perfEvents() const {
     return perfEvents_;
@@ -190,9 +220,16 @@ class DecisionPendingUpdates {
   // set if we need to rebuild all routes
   bool needsFullRebuild_{false};
 
+  // set if topology changed, which requires to rebuild routes of prefixes
+  // affected by the change
+  bool topologyChanged_{false};
+
   // track prefixes that have changed in this batch
   std::unordered_set<thrift::IpPrefix> updatedPrefixes_;
 
+  // track labels of static MPLS routes that have changed in this batch
+  std::unordered_set<int32_t> updatedStaticLabels_;
+
   // local node name to determine action on linkAttributes change
   std::string myNodeName_;
 };
@@ -210,7 +247,11 @@ class SpfSolver {
       bool computeLfaPaths,
       bool enableOrderedFib = false,
       bool bgpDryRun = false,
-      bool enableBestRouteSelection = false);
+      bool enableBestRouteSelection = false,
+      size_t routeComputationThreads = 0,
+      bool enableIncrementalRouteBuild = false,
+      bool enableLfaBackupNextHops = false,
+      std::optional<thrift::ThreadConfig> threadConfig = std::nullopt);
   ~SpfSolver();
 
   //
@@ -222,6 +263,15 @@ class SpfSolver {
 
   StaticMplsRoutes const& getStaticRoutes();
 
+  // Prefixes whose routes resolve through static MPLS routes of given labels,
+  // i.e. prefixes myNodeName advertises with one of them as prepend label.
+  // Only their routes change along with the static routes
+  std::unordered_set<thrift::IpPrefix> getPrefixesDependingOnStaticRoutes(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState,
+      std::unordered_set<int32_t> const& labels) const;
+
   // Build route database using given prefix and link states for a given
   // router, myNodeName
   // Returns std::nullopt if myNodeName doesn't have any prefix database
@@ -230,15 +280,52 @@ class SpfSolver {
       std::unordered_map<std::string, LinkState> const& areaLinkStates,
       PrefixState const& prefixState);
 
+  // Build MPLS routes only, i.e. routes of node labels, adjacency labels and
+  // static MPLS routes
+  DecisionRouteDb buildMplsRouteDb(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
+  // Returns prefixes whose routes may have changed because of link state
+  // changes since the last call or buildRouteDb(), i.e. prefixes advertised
+  // by nodes whose shortest paths or overload state changed and all KSP2
+  // prefixes. Returns std::nullopt if a full rebuild is required instead,
+  // i.e. incremental route build is disabled, LFA is enabled, local links
+  // changed or too many prefixes are affected
+  std::optional<std::unordered_set<thrift::IpPrefix>>
+  getPrefixesAffectedByLinkStateChange(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState);
+
   std::optional<RibUnicastEntry> createRouteForPrefix(
       const std::string& myNodeName,
       std::unordered_map<std::string, LinkState> const& areaLinkStates,
       PrefixState const& prefixState,
-      thrift::IpPrefix const& prefix);
+      PackedPrefix const& prefix);
 
-  std::unordered_map<thrift::IpPrefix, BestRouteSelectionResult> const&
+  std::unordered_map<PackedPrefix, BestRouteSelectionResult> const&
   getBestRoutesCache() const;
 
+  // drop cached SP_ECMP next-hops, recomputed on demand
+  void clearNextHopsCache();
+
+  // phases of route computation whose time is tracked
+  enum class RouteBuildPhase {
+    SPF = 0,
+    BEST_ROUTE_SELECTION = 1,
+    NEXTHOPS = 2,
+    MPLS_ROUTES = 3,
+    CALCULATE_UPDATE = 4,
+  };
+  static constexpr size_t kNumRouteBuildPhases{5};
+  using RouteBuildPhaseTimes =
+      std::array<std::chrono::microseconds, kNumRouteBuildPhases>;
+
+  // Time spent in best route selection, next-hops and MPLS routes computation
+  // since the last call. SPF and CALCULATE_UPDATE are timed by the caller
+  RouteBuildPhaseTimes moveOutRouteBuildPhaseTimes();
+
  private:
   // no-copy
   SpfSolver(SpfSolver const&) = delete;
@@ -267,6 +354,8 @@ class SpfSolver {
 //
 
 class Decision : public OpenrEventBase {
+  friend class DecisionWrapper;
+
  public:
   Decision(
       std::shared_ptr<const Config> config,
@@ -274,12 +363,17 @@ class Decision : public OpenrEventBase {
       bool bgpDryRun,
       std::chrono::milliseconds debounceMinDur,
       std::chrono::milliseconds debounceMaxDur,
-      messaging::RQueue<thrift::Publication> kvStoreUpdatesQueue,
+      messaging::RQueue<KvStorePublicationPtr> kvStoreUpdatesQueue,
       messaging::RQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue,
-      messaging::ReplicateQueue<DecisionRouteUpdate>& routeUpdatesQueue);
+      messaging::ReplicateQueue<DecisionRouteUpdatePtr>& routeUpdatesQueue,
+      std::optional<messaging::RQueue<KvStoreSyncEvent>>
+          kvStoreSyncEventsQueue = std::nullopt);
 
   virtual ~Decision() = default;
 
+  // Persists LSDB snapshot, if enabled, before stopping
+  void stop() override;
+
   /*
    * Retrieve routeDb from specified node.
    * If empty nodename specified, will return routeDb of its own
@@ -287,6 +381,15 @@ class Decision : public OpenrEventBase {
   folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>> getDecisionRouteDb(
       std::string nodeName);
 
+  /*
+   * Retrieve unicast routes of given prefixes from specified node. Only
+   * routes of these prefixes are computed unless all routes of the node are
+   * cached
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
+  getDecisionRouteDbFiltered(
+      std::string nodeName, std::vector<thrift::IpPrefix> prefixes);
+
   /**
    * Retrieve static routes from Decision
    */
@@ -298,17 +401,54 @@ class Decision : public OpenrEventBase {
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::AdjacencyDatabase>>>
   getDecisionAdjacenciesFiltered(thrift::AdjacenciesFilter filter = {});
 
+  /*
+   * Retrieve page of AdjacencyDatabase for all nodes in selected areas, see
+   * thrift::PageParams
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::AdjacencyDbsPage>>
+  getDecisionAdjacenciesFilteredPage(
+      thrift::AdjacenciesFilter filter, thrift::PageParams page);
+
   /*
    * Retrieve PrefixDatabase as a map.
    */
   folly::SemiFuture<std::unique_ptr<thrift::PrefixDbs>> getDecisionPrefixDbs();
 
+  /*
+   * Retrieve snapshot of link states and prefix state, see LsdbSnapshot.h.
+   * Only entries changed since the version of params are included if it is of
+   * the current epoch
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::LsdbSnapshot>>
+  getDecisionLsdbSnapshot(thrift::LsdbSnapshotParams params);
+
+  /*
+   * Retrieve flap damping state of penalized prefixes, empty if route
+   * damping is disabled
+   */
+  folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteDampingState>>>
+  getRouteDampingStates();
+
+  /*
+   * Drop memoized SPF and KSP results, cached next-hops and computed route
+   * databases, e.g. to release memory. They are recomputed on demand
+   */
+  void dropCaches();
+
   /*
    * Retrieve received routes along with best route selection output.
    */
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::ReceivedRouteDetail>>>
   getReceivedRoutesFiltered(thrift::ReceivedRouteFilter filter);
 
+  /*
+   * Retrieve page of received routes, paginated by prefix. See
+   * thrift::PageParams
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::ReceivedRoutesPage>>
+  getReceivedRoutesFilteredPage(
+      thrift::ReceivedRouteFilter filter, thrift::PageParams page);
+
   /*
    * Set new or replace existing RibPolicy. This will trigger the new policy
    * run against computed routes and delta will be published.
@@ -337,6 +477,24 @@ class Decision : public OpenrEventBase {
   // process publication from KvStore
   void processPublication(thrift::Publication const& thriftPub);
 
+  // process batch of publications read from KvStore and schedule route
+  // rebuild once for the whole batch if needed
+  void processPublications(std::vector<KvStorePublicationPtr> const& pubs);
+
+#if FOLLY_HAS_COROUTINES
+  // read and process publications from KvStore until queue gets closed
+  folly::coro::Task<void> processKvStoreUpdates(
+      messaging::RQueue<KvStorePublicationPtr> q);
+#endif
+
+  // process initial sync of KvStore with a peer. Cold start ends as soon as
+  // KvStore of every area is synced
+  void processKvStoreSyncEvent(KvStoreSyncEvent const& event);
+
+  // received routes of given filter along with best route selection output
+  std::vector<thrift::ReceivedRouteDetail> getReceivedRoutesWithBest(
+      thrift::ReceivedRouteFilter const& filter) const;
+
   // openr config
   std::shared_ptr<const Config> config_;
 
@@ -344,6 +502,63 @@ class Decision : public OpenrEventBase {
   // gracefulRestartDuration
   std::unique_ptr<folly::AsyncTimeout> coldStartTimer_{nullptr};
 
+  // areas whose KvStore has not completed initial sync with any peer yet
+  std::unordered_set<std::string> areasPendingInitialSync_;
+
+  //
+  // LSDB snapshot for fast restart, see `decision_lsdb_snapshot_file`
+  //
+
+  // Snapshot of link states and prefix state, along with entries changed
+  // since given version only if set
+  thrift::LsdbSnapshot buildLsdbSnapshot(
+      std::optional<int64_t> sinceVersion) const;
+
+  // write full snapshot with KvStore versions of keys to snapshot file, unless
+  // nothing changed since the last write
+  void writeLsdbSnapshot();
+
+  // restore link states and prefix state from snapshot file, if any and not
+  // older than max age, and build routes from them right away, ending cold
+  // start. Restored links are held like newly learnt ones with ordered FIB
+  void loadLsdbSnapshot();
+
+  // record KvStore version of `adj:` or `prefix:` key, nullptr value if it
+  // expired. Returns true if the value is the one restored from snapshot and
+  // needs no parsing
+  bool updateLsdbKeyVersion(
+      const std::string& area,
+      const std::string& key,
+      thrift::Value const* value);
+
+  // withdraw state restored from snapshot which KvStore of area didn't sync,
+  // i.e. of keys gone while this node was down
+  void reconcileRestoredLsdb(const std::string& area);
+
+  std::optional<std::string> lsdbSnapshotFile_;
+  std::chrono::seconds lsdbSnapshotInterval_{
+      Constants::kDecisionLsdbSnapshotInterval};
+  std::chrono::seconds lsdbSnapshotMaxAge_{
+      Constants::kDecisionLsdbSnapshotMaxAge};
+  std::unique_ptr<folly::AsyncTimeout> lsdbSnapshotTimer_{nullptr};
+  // reconciles restored state of areas KvStore doesn't report synced in time
+  std::unique_ptr<folly::AsyncTimeout> lsdbReconcileTimer_{nullptr};
+  // lsdbVersion_ of the last written snapshot
+  int64_t lsdbSnapshotWrittenVersion_{0};
+
+  using LsdbKeyVersions = std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<std::string /* key */, thrift::LsdbKeyVersion>>;
+  // KvStore versions of keys of link states and prefix state
+  LsdbKeyVersions lsdbKeyVersions_;
+  // keys restored from snapshot which KvStore didn't sync yet
+  LsdbKeyVersions restoredKeyVersions_;
+  // nodes restored from snapshot per area, until reconciled
+  std::unordered_map<std::string /* area */, std::unordered_set<std::string>>
+      restoredNodes_;
+  // areas to reconcile on next route rebuild
+  std::unordered_set<std::string> areasPendingReconcile_;
+
   /**
    * Rebuild all routes and send out update delta. Check current pendingUpdates_
    * to decide which routes need rebuilding, otherwise rebuild all. Use
@@ -352,6 +567,33 @@ class Decision : public OpenrEventBase {
    */
   void rebuildRoutes(std::string const& event);
 
+  // Report time of route computation phases of a rebuild started at unix
+  // timestamp `startTs` in histograms and perf events
+  void recordRouteBuildPhases(
+      SpfSolver::RouteBuildPhaseTimes const& phaseTimes, int64_t startTs);
+
+  // Rebuild routes of given prefixes affected by topology changes along with
+  // updated prefixes and all MPLS routes. Returns changes w.r.t. routeDb_
+  DecisionRouteUpdate rebuildAffectedRoutes(
+      std::unordered_set<thrift::IpPrefix>&& affectedPrefixes);
+
+  // Rebuild routes matched by either of old or current RibPolicy and send
+  // the changed ones. Other routes are not affected by a policy change
+  void rebuildRibPolicyRoutes(
+      RibPolicy const* oldRibPolicy, std::string const& event);
+
+  // Build routes of given prefixes with RibPolicy applied. Returns changes
+  // w.r.t. routeDb_
+  DecisionRouteUpdate rebuildPrefixRoutes(
+      std::unordered_set<folly::CIDRNetwork> const& prefixes);
+
+  // Hold back route changes of suppressed prefixes if route damping is
+  // enabled, before update gets applied to routeDb_
+  void dampRouteUpdate(DecisionRouteUpdate& update);
+
+  // Rebuild and send routes of prefixes whose suppression ended
+  void reuseDampedRoutes();
+
   // decremnts holds and send any resulting output, returns true if any
   // linkstate has remaining holds
   bool decrementOrderedFibHolds();
@@ -362,15 +604,42 @@ class Decision : public OpenrEventBase {
 
   std::chrono::milliseconds getMaxFib();
 
-  // node to prefix entries database for nodes advertising per prefix keys
-  std::optional<thrift::PrefixDatabase> updateNodePrefixDatabase(
-      const std::string& key, const thrift::PrefixDatabase& prefixDb);
+  // apply prefix key update of a node in the area to prefix state. Only
+  // prefixes that changed in the update are revisited. Returns changed
+  // prefixes of prefix state or std::nullopt if the update was ignored
+  std::optional<std::unordered_set<thrift::IpPrefix>> updateNodePrefixDatabase(
+      const std::string& key,
+      const thrift::PrefixDatabase& prefixDb,
+      const std::string& area);
+
+  // record change of adjacency or prefix database of node in area for delta
+  // LSDB snapshots
+  void markLsdbChange(const std::string& area, const std::string& nodeName);
+
+  // Return computed route database of node, from cache if still current
+  thrift::RouteDatabase getComputedRouteDb(const std::string& nodeName);
+
+  // Cached route database of node if it is current, nullptr otherwise
+  thrift::RouteDatabase const* findComputedRouteDb(const std::string& nodeName);
 
   // cached routeDb
   DecisionRouteDb routeDb_;
 
+  // Route databases computed for nodes on request, valid as long as the
+  // versions of link states and prefix state they were computed from are
+  struct ComputedRouteDb {
+    std::map<std::string /* area */, uint64_t> linkStateVersions;
+    uint64_t prefixStateVersion{0};
+    // sequence number of last use, for LRU eviction
+    uint64_t lastUsed{0};
+    thrift::RouteDatabase routeDb;
+  };
+  std::unordered_map<std::string /* node */, ComputedRouteDb>
+      computedRouteDbs_;
+  uint64_t computedRouteDbUses_{0};
+
   // Queue to publish route changes
-  messaging::ReplicateQueue<DecisionRouteUpdate>& routeUpdatesQueue_;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr>& routeUpdatesQueue_;
 
   // Pointer to RibPolicy
   std::unique_ptr<RibPolicy> ribPolicy_;
@@ -379,6 +648,11 @@ class Decision : public OpenrEventBase {
   // aims to revert the policy effects on programmed routes.
   std::unique_ptr<folly::AsyncTimeout> ribPolicyTimer_;
 
+  // Flap damping of routes, see `route_damping_config`. Penalties are checked
+  // for reuse periodically while any prefix is penalized
+  std::unique_ptr<RouteDamping> routeDamping_;
+  std::unique_ptr<folly::AsyncTimeout> routeDampingTimer_;
+
   // the pointer to the SPF path calculator
   std::unique_ptr<SpfSolver> spfSolver_;
 
@@ -388,6 +662,14 @@ class Decision : public OpenrEventBase {
   // global prefix state
   PrefixState prefixState_;
 
+  // Epoch and version of LSDB snapshots, and version of last change of every
+  // [area, node] entry. Entries of deleted nodes are kept so that deltas
+  // report their deletion
+  const int64_t lsdbEpoch_{getUnixTimeStampMs()};
+  int64_t lsdbVersion_{0};
+  std::map<std::pair<std::string /* area */, std::string /* node */>, int64_t>
+      lsdbNodeVersions_;
+
   // For orderedFib prgramming, we keep track of the fib programming times
   // across the network
   std::unordered_map<std::string, std::chrono::milliseconds> fibTimes_;
@@ -409,9 +691,18 @@ class Decision : public OpenrEventBase {
   // need to store all this for backward compatibility, otherwise a key update
   // can lead to mistakenly withdrawing some prefixes
   std::unordered_map<
-      std::string,
+      NodeAndArea,
       std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry>>
-      perPrefixPrefixEntries_, fullDbPrefixEntries_;
+      perPrefixPrefixEntries_;
+
+  // entries of keys carrying multiple prefixes, i.e. full database or shards
+  // of it, per key
+  std::unordered_map<
+      NodeAndArea,
+      std::unordered_map<
+          std::string /* key */,
+          std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry>>>
+      fullDbPrefixEntries_;
 
   // this node's name and the key markers
   const std::string myNodeName_;
@@ -419,11 +710,18 @@ class Decision : public OpenrEventBase {
   // store rebuildROutes to-do status and perf events
   detail::DecisionPendingUpdates pendingUpdates_;
 
+  // trigger debounced rebuildRoutes with the debounce in use
+  void scheduleRebuildRoutes();
+
   /**
    * Debounced trigger for rebuildRoutes invoked by input paths kvstore update
-   * queue and static routes update queue
+   * queue and static routes update queue. Only one of them is set, depending
+   * on whether adaptive debounce is enabled
    */
-  AsyncDebounce<std::chrono::milliseconds> rebuildRoutesDebounced_;
+  std::unique_ptr<AsyncDebounce<std::chrono::milliseconds>>
+      rebuildRoutesDebounced_;
+  std::unique_ptr<AdaptiveDebounce<std::chrono::milliseconds>>
+      rebuildRoutesAdaptiveDebounced_;
 };
 
 } // namespace openr
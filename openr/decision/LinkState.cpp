@@ -8,11 +8,16 @@
 #include "openr/decision/LinkState.h"
 
 #include <algorithm>
+#include <deque>
 #include <functional>
+#include <set>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 
 #include <fb303/ServiceData.h>
 #include <folly/Format.h>
+#include <folly/tracing/StaticTracepoint.h>
 #include <openr/common/Util.h>
 
 namespace fb303 = facebook::fb303;
@@ -376,7 +381,20 @@ Link::directionalToString(const std::string& fromNode) const {
       getIfaceFromNode(getOtherNodeName(fromNode)));
 }
 
-LinkState::LinkState(const std::string& area) : area_(area) {}
+namespace {
+// source of link state versions, shared by all link states of the process
+std::atomic<uint64_t> nextLinkStateVersion{1};
+} // namespace
+
+LinkState::LinkState(const std::string& area, bool enableIncrementalSpf)
+    : area_(area), enableIncrementalSpf_(enableIncrementalSpf) {
+  bumpVersion();
+}
+
+void
+LinkState::bumpVersion() {
+  version_ = nextLinkStateVersion.fetch_add(1, std::memory_order_relaxed);
+}
 
 size_t
 LinkState::LinkPtrHash::operator()(const std::shared_ptr<Link>& l) const {
@@ -423,6 +441,7 @@ LinkState::addLink(std::shared_ptr<Link> link) {
   CHECK(linkMap_[link->firstNodeName()].insert(link).second);
   CHECK(linkMap_[link->secondNodeName()].insert(link).second);
   CHECK(allLinks_.insert(link).second);
+  spfGraph_.reset();
 }
 
 // throws std::out_of_range if links are not present
@@ -431,6 +450,8 @@ LinkState::removeLink(std::shared_ptr<Link> link) {
   CHECK(linkMap_.at(link->firstNodeName()).erase(link));
   CHECK(linkMap_.at(link->secondNodeName()).erase(link));
   CHECK(allLinks_.erase(link));
+  heldLinks_.erase(link);
+  spfGraph_.reset();
 }
 
 void
@@ -446,12 +467,15 @@ LinkState::removeNode(const std::string& nodeName) {
     try {
       CHECK(linkMap_.at(link->getOtherNodeName(nodeName)).erase(link));
       CHECK(allLinks_.erase(link));
+      heldLinks_.erase(link);
     } catch (std::out_of_range const& e) {
       LOG(FATAL) << "std::out_of_range for " << nodeName;
     }
   }
   linkMap_.erase(search);
   nodeOverloads_.erase(nodeName);
+  heldNodes_.erase(nodeName);
+  spfGraph_.reset();
 }
 
 const LinkState::LinkSet&
@@ -464,28 +488,21 @@ LinkState::linksFromNode(const std::string& nodeName) const {
   return defaultEmptySet;
 }
 
-std::vector<std::shared_ptr<Link>>
-LinkState::orderedLinksFromNode(const std::string& nodeName) const {
-  std::vector<std::shared_ptr<Link>> links;
-  if (linkMap_.count(nodeName)) {
-    links.insert(
-        links.begin(),
-        linkMap_.at(nodeName).begin(),
-        linkMap_.at(nodeName).end());
-    std::sort(links.begin(), links.end(), LinkPtrLess{});
-  }
-  return links;
-}
-
 bool
 LinkState::updateNodeOverloaded(
     const std::string& nodeName,
     bool isOverloaded,
     LinkStateMetric holdUpTtl,
     LinkStateMetric holdDownTtl) {
-  if (nodeOverloads_.count(nodeName)) {
-    return nodeOverloads_.at(nodeName).updateValue(
-        isOverloaded, holdUpTtl, holdDownTtl);
+  if (auto it = nodeOverloads_.find(nodeName); it != nodeOverloads_.end()) {
+    const bool changed =
+        it->second.updateValue(isOverloaded, holdUpTtl, holdDownTtl);
+    if (it->second.hasHold()) {
+      heldNodes_.emplace(nodeName);
+    } else {
+      heldNodes_.erase(nodeName);
+    }
+    return changed;
   }
   nodeOverloads_.emplace(nodeName, HoldableValue<bool>{isOverloaded});
   // don't indicate LinkState changed if this is a new node
@@ -497,35 +514,60 @@ LinkState::isNodeOverloaded(const std::string& nodeName) const {
   return nodeOverloads_.count(nodeName) && nodeOverloads_.at(nodeName).value();
 }
 
+void
+LinkState::clearMemoizedResults() {
+  std::unique_lock<std::shared_mutex> lock(memoMutex_);
+  spfResults_.clear();
+  pendingSpfLinks_.clear();
+  kthPathResults_.clear();
+  hopCounts_.clear();
+  spfGraph_.reset();
+}
+
+void
+LinkState::updateHeldLink(std::shared_ptr<Link> const& link) {
+  if (link->hasHolds()) {
+    heldLinks_.insert(link);
+  } else {
+    heldLinks_.erase(link);
+  }
+}
+
 LinkState::LinkStateChange
 LinkState::decrementHolds() {
   LinkStateChange change;
-  for (auto& link : allLinks_) {
-    change.topologyChanged |= link->decrementHolds();
+  LinkSet changedLinks;
+  for (auto it = heldLinks_.begin(); it != heldLinks_.end();) {
+    auto const& link = *it;
+    if (link->decrementHolds()) {
+      changedLinks.insert(link);
+    }
+    it = link->hasHolds() ? std::next(it) : heldLinks_.erase(it);
   }
-  for (auto& kv : nodeOverloads_) {
-    change.topologyChanged |= kv.second.decrementTtl();
+  // expired overload hold of a node changes paths through it, i.e. over its
+  // links
+  for (auto it = heldNodes_.begin(); it != heldNodes_.end();) {
+    auto& overload = nodeOverloads_.at(*it);
+    if (overload.decrementTtl()) {
+      auto const& links = linksFromNode(*it);
+      changedLinks.insert(links.begin(), links.end());
+      change.topologyChanged = true;
+    }
+    it = overload.hasHold() ? std::next(it) : heldNodes_.erase(it);
   }
+  change.topologyChanged |= not changedLinks.empty();
   if (change.topologyChanged) {
-    spfResults_.clear();
-    kthPathResults_.clear();
+    invalidateSpfResults(changedLinks);
+    // expired holds may have taken links down
+    updateHopCounts({}, true /* resetRequired */);
+    bumpVersion();
   }
   return change;
 }
 
 bool
 LinkState::hasHolds() const {
-  for (auto& link : allLinks_) {
-    if (link->hasHolds()) {
-      return true;
-    }
-  }
-  for (auto& kv : nodeOverloads_) {
-    if (kv.second.hasHold()) {
-      return true;
-    }
-  }
-  return false;
+  return not heldLinks_.empty() or not heldNodes_.empty();
 }
 
 std::shared_ptr<Link>
@@ -546,28 +588,13 @@ LinkState::maybeMakeLink(
   return nullptr;
 }
 
-std::vector<std::shared_ptr<Link>>
-LinkState::getOrderedLinkSet(const thrift::AdjacencyDatabase& adjDb) const {
-  std::vector<std::shared_ptr<Link>> links;
-  links.reserve(adjDb.adjacencies_ref()->size());
-  for (const auto& adj : *adjDb.adjacencies_ref()) {
-    auto linkPtr = maybeMakeLink(*adjDb.thisNodeName_ref(), adj);
-    if (nullptr != linkPtr) {
-      links.emplace_back(linkPtr);
-    }
-  }
-  links.shrink_to_fit();
-  std::sort(links.begin(), links.end(), LinkState::LinkPtrLess{});
-  return links;
-}
-
 LinkState::LinkStateChange
 LinkState::updateAdjacencyDatabase(
-    thrift::AdjacencyDatabase const& newAdjacencyDb,
+    thrift::AdjacencyDatabase newAdjacencyDb,
     LinkStateMetric holdUpTtl,
     LinkStateMetric holdDownTtl) {
   LinkStateChange change;
-  auto const& nodeName = *newAdjacencyDb.thisNodeName_ref();
+  const std::string nodeName = *newAdjacencyDb.thisNodeName_ref();
   VLOG(1) << "Updating adjacency database for node " << nodeName << ", area "
           << *newAdjacencyDb.area_ref();
 
@@ -583,137 +610,160 @@ LinkState::updateAdjacencyDatabase(
             << ", rtt: " << *adj.rtt_ref();
   }
 
-  // Default construct if it did not exist
-  thrift::AdjacencyDatabase priorAdjacencyDb(
-      std::move(adjacencyDatabases_[nodeName]));
-  // replace
-  adjacencyDatabases_[nodeName] = newAdjacencyDb;
-
-  // for comparing old and new state, we order the links based on the tuple
-  // <nodeName1, iface1, nodeName2, iface2>, this allows us to easily discern
-  // topology changes in the single loop below
-  auto oldLinks = orderedLinksFromNode(nodeName);
-  auto newLinks = getOrderedLinkSet(newAdjacencyDb);
-
-  // fill these sets with the appropriate links
-  std::unordered_set<Link> linksUp;
-  std::unordered_set<Link> linksDown;
-
-  change.topologyChanged |= updateNodeOverloaded(
-      nodeName, *newAdjacencyDb.isOverloaded_ref(), holdUpTtl, holdDownTtl);
-
+  // replace, default construct if it did not exist
+  auto& adjacencyDb = adjacencyDatabases_[nodeName];
   change.nodeLabelChanged =
-      *priorAdjacencyDb.nodeLabel_ref() != *newAdjacencyDb.nodeLabel_ref();
-
-  auto newIter = newLinks.begin();
-  auto oldIter = oldLinks.begin();
-  while (newIter != newLinks.end() || oldIter != oldLinks.end()) {
-    if (newIter != newLinks.end() &&
-        (oldIter == oldLinks.end() || **newIter < **oldIter)) {
-      // newIter is pointing at a Link not currently present, record this as a
-      // link to add and advance newIter
-      (*newIter)->setHoldUpTtl(holdUpTtl);
-      change.topologyChanged |= (*newIter)->isUp();
+      *adjacencyDb.nodeLabel_ref() != *newAdjacencyDb.nodeLabel_ref();
+  adjacencyDb = std::move(newAdjacencyDb);
+
+  // existing links of node by local interface. Adjacencies are diffed against
+  // them directly and matching links are updated in place, links left over
+  // went down
+  std::unordered_multimap<std::string_view, std::shared_ptr<Link>> oldLinks;
+  for (auto const& link : linksFromNode(nodeName)) {
+    oldLinks.emplace(link->getIfaceFromNode(nodeName), link);
+  }
+
+  // links whose change affects shortest paths. Overload change of the node
+  // changes paths through it, i.e. over its links as of before the update
+  LinkSet changedLinks;
+  const bool overloadChanged = updateNodeOverloaded(
+      nodeName, *adjacencyDb.isOverloaded_ref(), holdUpTtl, holdDownTtl);
+  if (overloadChanged) {
+    auto const& links = linksFromNode(nodeName);
+    changedLinks.insert(links.begin(), links.end());
+  }
+  change.topologyChanged |= overloadChanged;
+
+  // links which came up, metric changes do not affect hop counts
+  LinkSet hopLinksUp;
+  bool hopCountsResetRequired = overloadChanged;
+
+  for (auto const& adj : *adjacencyDb.adjacencies_ref()) {
+    auto [begin, end] = oldLinks.equal_range(*adj.ifName_ref());
+    auto oldIt = std::find_if(begin, end, [&](auto const& kv) {
+      auto const& otherNodeName = kv.second->getOtherNodeName(nodeName);
+      return otherNodeName == *adj.otherNodeName_ref() and
+          kv.second->getIfaceFromNode(otherNodeName) == *adj.otherIfName_ref();
+    });
+
+    if (oldIt == end) {
+      // Link not currently present, bidirectional only if the other node
+      // reports the adjacency too
+      auto newLink = maybeMakeLink(nodeName, adj);
+      if (nullptr == newLink) {
+        continue;
+      }
+      newLink->setHoldUpTtl(holdUpTtl);
+      if (newLink->isUp()) {
+        change.topologyChanged = true;
+        changedLinks.insert(newLink);
+        hopLinksUp.insert(newLink);
+      }
       // even if we are holding a change, we apply the change to our link state
       // and check for holds when running spf. this ensures we don't add the
       // same hold twice
-      addLink(*newIter);
-      VLOG(1) << "[LINK UP]" << (*newIter)->toString();
-      ++newIter;
-      continue;
-    }
-    if (oldIter != oldLinks.end() &&
-        (newIter == newLinks.end() || **oldIter < **newIter)) {
-      // oldIter is pointing at a Link that is no longer present, record this
-      // as a link to remove and advance oldIter.
-      // If this link was previously overloaded or had a hold up, this does not
-      // change the topology.
-      change.topologyChanged |= (*oldIter)->isUp();
-      removeLink(*oldIter);
-      VLOG(1) << "[LINK DOWN] " << (*oldIter)->toString();
-      ++oldIter;
+      addLink(newLink);
+      updateHeldLink(newLink);
+      VLOG(1) << "[LINK UP]" << newLink->toString();
       continue;
     }
-    // The newIter and oldIter point to the same link. This link did not go up
-    // or down. The topology may still have changed though if the link overlaod
-    // or metric changed
-    auto& newLink = **newIter;
-    auto& oldLink = **oldIter;
+
+    // The link did not go up or down. The topology may still have changed
+    // though if the link overload or metric changed
+    auto link = std::move(oldIt->second);
+    oldLinks.erase(oldIt);
 
     // change the metric on the link object we already have
-    if (newLink.getMetricFromNode(nodeName) !=
-        oldLink.getMetricFromNode(nodeName)) {
+    if (*adj.metric_ref() != link->getMetricFromNode(nodeName)) {
       VLOG(1) << folly::sformat(
           "[LINK UPDATE] Metric change on link {}, {} -> {}",
-          newLink.directionalToString(nodeName),
-          oldLink.getMetricFromNode(nodeName),
-          newLink.getMetricFromNode(nodeName));
-      change.topologyChanged |= oldLink.setMetricFromNode(
-          nodeName,
-          newLink.getMetricFromNode(nodeName),
-          holdUpTtl,
-          holdDownTtl);
-    }
-
-    if (newLink.getOverloadFromNode(nodeName) !=
-        oldLink.getOverloadFromNode(nodeName)) {
+          link->directionalToString(nodeName),
+          link->getMetricFromNode(nodeName),
+          *adj.metric_ref());
+      if (link->setMetricFromNode(
+              nodeName, *adj.metric_ref(), holdUpTtl, holdDownTtl)) {
+        change.topologyChanged = true;
+        changedLinks.insert(link);
+      }
+      updateHeldLink(link);
+    }
+
+    if (*adj.isOverloaded_ref() != link->getOverloadFromNode(nodeName)) {
       VLOG(1) << folly::sformat(
           "[LINK UPDATE] Overload change on link {}: {} -> {}",
-          newLink.directionalToString(nodeName),
-          oldLink.getOverloadFromNode(nodeName),
-          newLink.getOverloadFromNode(nodeName));
-      change.topologyChanged |= oldLink.setOverloadFromNode(
-          nodeName,
-          newLink.getOverloadFromNode(nodeName),
-          holdUpTtl,
-          holdDownTtl);
+          link->directionalToString(nodeName),
+          link->getOverloadFromNode(nodeName),
+          *adj.isOverloaded_ref());
+      if (link->setOverloadFromNode(
+              nodeName, *adj.isOverloaded_ref(), holdUpTtl, holdDownTtl)) {
+        change.topologyChanged = true;
+        changedLinks.insert(link);
+        if (link->isUp()) {
+          hopLinksUp.insert(link);
+        } else {
+          hopCountsResetRequired = true;
+        }
+      }
+      updateHeldLink(link);
     }
 
     // Check if adjacency label has changed
-    if (newLink.getAdjLabelFromNode(nodeName) !=
-        oldLink.getAdjLabelFromNode(nodeName)) {
+    if (*adj.adjLabel_ref() != link->getAdjLabelFromNode(nodeName)) {
       VLOG(1) << folly::sformat(
           "[LINK UPDATE] AdjLabel change on link {}: {} => {}",
-          newLink.directionalToString(nodeName),
-          oldLink.getAdjLabelFromNode(nodeName),
-          newLink.getAdjLabelFromNode(nodeName));
+          link->directionalToString(nodeName),
+          link->getAdjLabelFromNode(nodeName),
+          *adj.adjLabel_ref());
 
       change.linkAttributesChanged |= true;
 
       // change the adjLabel on the link object we already have
-      oldLink.setAdjLabelFromNode(
-          nodeName, newLink.getAdjLabelFromNode(nodeName));
+      link->setAdjLabelFromNode(nodeName, *adj.adjLabel_ref());
     }
 
     // check if local nextHops Changed
-    if (newLink.getNhV4FromNode(nodeName) !=
-        oldLink.getNhV4FromNode(nodeName)) {
+    if (*adj.nextHopV4_ref() != link->getNhV4FromNode(nodeName)) {
       VLOG(1) << folly::sformat(
           "[LINK UPDATE] V4-NextHop address change on link {}: {} => {}",
-          newLink.directionalToString(nodeName),
-          toString(oldLink.getNhV4FromNode(nodeName)),
-          toString(newLink.getNhV4FromNode(nodeName)));
+          link->directionalToString(nodeName),
+          toString(link->getNhV4FromNode(nodeName)),
+          toString(*adj.nextHopV4_ref()));
 
       change.linkAttributesChanged |= true;
-      oldLink.setNhV4FromNode(nodeName, newLink.getNhV4FromNode(nodeName));
+      link->setNhV4FromNode(nodeName, *adj.nextHopV4_ref());
     }
-    if (newLink.getNhV6FromNode(nodeName) !=
-        oldLink.getNhV6FromNode(nodeName)) {
+    if (*adj.nextHopV6_ref() != link->getNhV6FromNode(nodeName)) {
       VLOG(1) << folly::sformat(
           "[LINK UPDATE] V6-NextHop address change on link {}: {} => {}",
-          newLink.directionalToString(nodeName),
-          toString(oldLink.getNhV6FromNode(nodeName)),
-          toString(newLink.getNhV6FromNode(nodeName)));
+          link->directionalToString(nodeName),
+          toString(link->getNhV6FromNode(nodeName)),
+          toString(*adj.nextHopV6_ref()));
 
       change.linkAttributesChanged |= true;
-      oldLink.setNhV6FromNode(nodeName, newLink.getNhV6FromNode(nodeName));
+      link->setNhV6FromNode(nodeName, *adj.nextHopV6_ref());
+    }
+  }
+
+  // Links no longer present. If this link was previously overloaded or had a
+  // hold up, this does not change the topology.
+  for (auto& [_, link] : oldLinks) {
+    if (link->isUp()) {
+      change.topologyChanged = true;
+      changedLinks.insert(link);
+      hopCountsResetRequired = true;
     }
-    ++newIter;
-    ++oldIter;
+    removeLink(link);
+    VLOG(1) << "[LINK DOWN] " << link->toString();
   }
+
   if (change.topologyChanged) {
-    spfResults_.clear();
-    kthPathResults_.clear();
+    invalidateSpfResults(changedLinks);
+    updateHopCounts(hopLinksUp, hopCountsResetRequired);
+  }
+  if (change.topologyChanged or change.linkAttributesChanged or
+      change.nodeLabelChanged) {
+    bumpVersion();
   }
   return change;
 }
@@ -725,10 +775,13 @@ LinkState::deleteAdjacencyDatabase(const std::string& nodeName) {
   auto search = adjacencyDatabases_.find(nodeName);
 
   if (search != adjacencyDatabases_.end()) {
+    // paths through the node are gone along with all of its links
+    const auto changedLinks = linksFromNode(nodeName);
     removeNode(nodeName);
     adjacencyDatabases_.erase(search);
-    spfResults_.clear();
-    kthPathResults_.clear();
+    invalidateSpfResults(changedLinks);
+    updateHopCounts({}, true /* resetRequired */);
+    bumpVersion();
     change.topologyChanged = true;
   } else {
     LOG(WARNING) << "Trying to delete adjacency db for non-existing node "
@@ -750,13 +803,87 @@ LinkState::getMetricFromAToB(
   return std::nullopt;
 }
 
+std::optional<LinkStateMetric>
+LinkState::getHopsFromAToB(std::string const& a, std::string const& b) const {
+  if (a == b) {
+    return 0;
+  }
+  auto const& hops = getHopCounts(a).hops;
+  auto it = hops.find(b);
+  if (it != hops.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
 LinkStateMetric
 LinkState::getMaxHopsToNode(const std::string& nodeName) const {
-  LinkStateMetric max = 0;
-  for (auto const& pathsFromNode : getSpfResult(nodeName, false)) {
-    max = std::max(max, pathsFromNode.second.metric());
+  return getHopCounts(nodeName).maxHops;
+}
+
+LinkState::HopCounts const&
+LinkState::getHopCounts(const std::string& nodeName) const {
+  {
+    std::shared_lock<std::shared_mutex> lock(memoMutex_);
+    auto entryIter = hopCounts_.find(nodeName);
+    if (hopCounts_.end() != entryIter) {
+      return entryIter->second;
+    }
+  }
+
+  // run BFS without holding the lock. Result of another thread is kept if it
+  // got here first
+  auto hopCounts = runHopCount(nodeName);
+  std::unique_lock<std::shared_mutex> lock(memoMutex_);
+  return hopCounts_.try_emplace(nodeName, std::move(hopCounts)).first->second;
+}
+
+void
+LinkState::updateHopCounts(LinkSet const& linksUp, bool resetRequired) {
+  if (resetRequired) {
+    hopCounts_.clear();
+    return;
+  }
+
+  for (auto& [src, hopCounts] : hopCounts_) {
+    auto& hops = hopCounts.hops;
+    bool changed = false;
+    std::deque<std::string> queue;
+    // offer path via `from` to `to`, no transit through overloaded nodes
+    auto relax = [&, &src = src](
+                     std::string const& from, std::string const& to) {
+      auto fromIter = hops.find(from);
+      if (fromIter == hops.end() or (from != src and isNodeOverloaded(from))) {
+        return;
+      }
+      auto const newHops = fromIter->second + 1;
+      auto [toIter, inserted] = hops.emplace(to, newHops);
+      if (inserted or newHops < toIter->second) {
+        toIter->second = newHops;
+        changed = true;
+        queue.emplace_back(to);
+      }
+    };
+    for (auto const& link : linksUp) {
+      relax(link->firstNodeName(), link->secondNodeName());
+      relax(link->secondNodeName(), link->firstNodeName());
+    }
+    while (not queue.empty()) {
+      auto node = std::move(queue.front());
+      queue.pop_front();
+      for (auto const& link : linksFromNode(node)) {
+        if (link->isUp()) {
+          relax(node, link->getOtherNodeName(node));
+        }
+      }
+    }
+    if (changed) {
+      hopCounts.maxHops = 0;
+      for (auto const& [node, nodeHops] : hops) {
+        hopCounts.maxHops = std::max(hopCounts.maxHops, nodeHops);
+      }
+    }
   }
-  return max;
 }
 
 std::vector<LinkState::Path> const&
@@ -764,19 +891,28 @@ LinkState::getKthPaths(
     const std::string& src, const std::string& dest, size_t k) const {
   CHECK_GE(k, 1);
   std::tuple<std::string, std::string, size_t> key(src, dest, k);
-  auto entryIter = kthPathResults_.find(key);
-  if (kthPathResults_.end() == entryIter) {
-    LinkSet linksToIgnore;
-    for (size_t i = 1; i < k; ++i) {
-      for (auto const& path : getKthPaths(src, dest, i)) {
-        for (auto const& link : path) {
-          linksToIgnore.insert(link);
-        }
+  {
+    std::shared_lock<std::shared_mutex> lock(memoMutex_);
+    auto entryIter = kthPathResults_.find(key);
+    if (kthPathResults_.end() != entryIter) {
+      return entryIter->second;
+    }
+  }
+
+  // compute paths without holding the lock as it recurses into other
+  // memoized APIs
+  LinkSet linksToIgnore;
+  for (size_t i = 1; i < k; ++i) {
+    for (auto const& path : getKthPaths(src, dest, i)) {
+      for (auto const& link : path) {
+        linksToIgnore.insert(link);
       }
     }
-    std::vector<LinkState::Path> paths;
-    auto const& res = linksToIgnore.empty() ? getSpfResult(src, true)
-                                            : runSpf(src, true, linksToIgnore);
+  }
+  std::vector<LinkState::Path> paths;
+  if (linksToIgnore.empty()) {
+    // shortest paths are traced on the memoized SPF result of src
+    auto const& res = getSpfResult(src, true);
     if (res.count(dest)) {
       LinkSet visitedLinks;
       auto path = traceOnePath(src, dest, res, visitedLinks);
@@ -785,26 +921,389 @@ LinkState::getKthPaths(
         path = traceOnePath(src, dest, res, visitedLinks);
       }
     }
-    entryIter = kthPathResults_.emplace(key, std::move(paths)).first;
+  } else {
+    paths = traceDisjointPaths(src, dest, linksToIgnore);
   }
-  return entryIter->second;
+
+  // keep paths of another thread if it got here first
+  std::unique_lock<std::shared_mutex> lock(memoMutex_);
+  return kthPathResults_.try_emplace(std::move(key), std::move(paths))
+      .first->second;
 }
 
 LinkState::SpfResult const&
 LinkState::getSpfResult(
     const std::string& thisNodeName, bool useLinkMetric) const {
   std::pair<std::string, bool> key{thisNodeName, useLinkMetric};
+  {
+    std::shared_lock<std::shared_mutex> lock(memoMutex_);
+    auto entryIter = spfResults_.find(key);
+    if (spfResults_.end() != entryIter and not pendingSpfLinks_.count(key)) {
+      return entryIter->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(memoMutex_);
   auto entryIter = spfResults_.find(key);
   if (spfResults_.end() == entryIter) {
+    // run SPF without holding the lock. Result of another thread is kept if
+    // it got here first
+    lock.unlock();
     auto res = runSpf(thisNodeName, useLinkMetric);
-    entryIter = spfResults_.emplace(std::move(key), std::move(res)).first;
+    lock.lock();
+    entryIter = spfResults_.try_emplace(std::move(key), std::move(res)).first;
+  } else if (auto pendingIter = pendingSpfLinks_.find(key);
+             pendingSpfLinks_.end() != pendingIter) {
+    entryIter->second = runIncrementalSpf(
+        thisNodeName,
+        useLinkMetric,
+        std::move(entryIter->second),
+        pendingIter->second);
+    pendingSpfLinks_.erase(pendingIter);
   }
   return entryIter->second;
 }
 
+void
+LinkState::invalidateSpfResults(LinkSet const& changedLinks) {
+  for (auto it = spfResults_.begin(); it != spfResults_.end();) {
+    auto const& [key, result] = *it;
+    auto pendingIt = pendingSpfLinks_.find(key);
+    // results with pending links are outdated, hence can't tell what the
+    // change affects
+    if (pendingIt == pendingSpfLinks_.end() and
+        not isSpfResultAffected(key.first, key.second, result, changedLinks)) {
+      ++it;
+      continue;
+    }
+    if (not enableIncrementalSpf_) {
+      it = spfResults_.erase(it);
+      continue;
+    }
+    if (pendingIt == pendingSpfLinks_.end()) {
+      pendingIt = pendingSpfLinks_.emplace(key, LinkSet{}).first;
+    }
+    pendingIt->second.insert(changedLinks.begin(), changedLinks.end());
+    ++it;
+  }
+  // shortest paths (k = 1) are traced on the SPF result of src and stay
+  // valid along with it. Disjoint paths may use any link
+  for (auto it = kthPathResults_.begin(); it != kthPathResults_.end();) {
+    auto const& [src, dest, k] = it->first;
+    std::pair<std::string, bool> spfKey{src, true};
+    if (k == 1 and spfResults_.count(spfKey) and
+        not pendingSpfLinks_.count(spfKey)) {
+      ++it;
+    } else {
+      it = kthPathResults_.erase(it);
+    }
+  }
+}
+
+bool
+LinkState::isSpfResultAffected(
+    const std::string& src,
+    bool useLinkMetric,
+    SpfResult const& result,
+    LinkSet const& changedLinks) const {
+  for (auto const& link : changedLinks) {
+    for (auto const& nodeName :
+         {link->firstNodeName(), link->secondNodeName()}) {
+      auto const& otherNodeName = link->getOtherNodeName(nodeName);
+      auto it = result.find(nodeName);
+      if (it != result.end() and
+          std::any_of(
+              it->second.pathLinks().begin(),
+              it->second.pathLinks().end(),
+              [&](NodeSpfResult::PathLink const& pathLink) {
+                return *pathLink.link == *link;
+              })) {
+        return true;
+      }
+      // no transit traffic through overloaded nodes other than src
+      auto otherIt = result.find(otherNodeName);
+      if (not link->isUp() or otherIt == result.end() or
+          (otherNodeName != src and isNodeOverloaded(otherNodeName))) {
+        continue;
+      }
+      if (it == result.end()) {
+        // link makes node reachable
+        return true;
+      }
+      auto metric = otherIt->second.metric() +
+          (useLinkMetric ? link->getMetricFromNode(otherNodeName) : 1);
+      if (metric <= it->second.metric()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Update shortest-path routes from perspective of src incrementally;
+ *
+ * 1. Nodes whose shortest paths go through a changed link and all nodes
+ *    downstream of them on the shortest path tree are removed from result.
+ *    So are nodes that get a shorter or an additional equal-cost path.
+ * 2. Removed nodes are re-settled in Dijkstra order using the retained
+ *    nodes. A retained node gets removed the same way once a re-settled node
+ *    offers it a path as good as its current one.
+ *
+ * NOTE: link metrics are assumed to be positive, which Open/R enforces
+ */
+LinkState::SpfResult
+LinkState::runIncrementalSpf(
+    const std::string& src,
+    bool useLinkMetric,
+    SpfResult result,
+    const LinkSet& changedLinks) const {
+  fb303::fbData->addStatValue("decision.spf_runs", 1, fb303::COUNT);
+  fb303::fbData->addStatValue(
+      "decision.incremental_spf_runs", 1, fb303::COUNT);
+  const auto startTime = std::chrono::steady_clock::now();
+
+  auto getMetric = [useLinkMetric](
+                       std::shared_ptr<Link> const& link,
+                       std::string const& fromNode) -> LinkStateMetric {
+    return useLinkMetric ? link->getMetricFromNode(fromNode) : 1;
+  };
+  // no transit traffic through overloaded nodes other than src
+  auto isTransit = [this, &src](std::string const& nodeName) {
+    return nodeName == src or not isNodeOverloaded(nodeName);
+  };
+
+  // downstream nodes of every node on the shortest path tree
+  std::unordered_map<std::string, std::vector<std::string>> children;
+  for (auto const& [nodeName, nodeResult] : result) {
+    for (auto const& pathLink : nodeResult.pathLinks()) {
+      children[pathLink.prevNode].emplace_back(nodeName);
+    }
+  }
+
+  // nodes to be settled, ordered by lower bound of their metric
+  std::set<std::pair<LinkStateMetric, std::string>> queue;
+  std::unordered_map<std::string, LinkStateMetric> queuedMetrics;
+  auto enqueue = [&](std::string const& nodeName, LinkStateMetric metric) {
+    auto it = queuedMetrics.find(nodeName);
+    if (it != queuedMetrics.end()) {
+      if (it->second <= metric) {
+        return;
+      }
+      queue.erase({it->second, nodeName});
+      it->second = metric;
+    } else {
+      queuedMetrics.emplace(nodeName, metric);
+    }
+    queue.emplace(metric, nodeName);
+  };
+
+  // enqueue node with the best metric offered by nodes in result
+  auto enqueueFromNeighbors = [&](std::string const& nodeName) {
+    for (auto const& link : linksFromNode(nodeName)) {
+      auto const& otherNodeName = link->getOtherNodeName(nodeName);
+      auto it = result.find(otherNodeName);
+      if (link->isUp() and it != result.end() and isTransit(otherNodeName)) {
+        enqueue(
+            nodeName, it->second.metric() + getMetric(link, otherNodeName));
+      }
+    }
+  };
+
+  // nodes settled in this run are final and never removed again
+  std::unordered_set<std::string> settled;
+  auto removeSubtree = [&](std::string const& nodeName) {
+    std::vector<std::string> removed;
+    std::vector<std::string> stack{nodeName};
+    while (not stack.empty()) {
+      auto name = std::move(stack.back());
+      stack.pop_back();
+      if (name == src or settled.count(name) or not result.erase(name)) {
+        continue;
+      }
+      auto it = children.find(name);
+      if (it != children.end()) {
+        stack.insert(stack.end(), it->second.begin(), it->second.end());
+      }
+      removed.emplace_back(std::move(name));
+    }
+    for (auto const& name : removed) {
+      enqueueFromNeighbors(name);
+    }
+  };
+
+  // whether node in result is offered a shorter or an additional equal-cost
+  // path by its neighbors
+  auto hasBetterPath = [&](std::string const& nodeName) {
+    auto const& nodeResult = result.at(nodeName);
+    for (auto const& link : linksFromNode(nodeName)) {
+      auto const& otherNodeName = link->getOtherNodeName(nodeName);
+      auto it = result.find(otherNodeName);
+      if (not link->isUp() or it == result.end() or
+          not isTransit(otherNodeName)) {
+        continue;
+      }
+      auto metric = it->second.metric() + getMetric(link, otherNodeName);
+      if (metric < nodeResult.metric()) {
+        return true;
+      }
+      if (metric == nodeResult.metric() and
+          std::none_of(
+              nodeResult.pathLinks().begin(),
+              nodeResult.pathLinks().end(),
+              [&](NodeSpfResult::PathLink const& pathLink) {
+                return pathLink.prevNode == otherNodeName and
+                    *pathLink.link == *link;
+              })) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Step 1: remove nodes whose shortest paths went through changed links
+  for (auto const& link : changedLinks) {
+    for (auto const& nodeName :
+         {link->firstNodeName(), link->secondNodeName()}) {
+      auto it = result.find(nodeName);
+      if (it != result.end() and
+          std::any_of(
+              it->second.pathLinks().begin(),
+              it->second.pathLinks().end(),
+              [&](NodeSpfResult::PathLink const& pathLink) {
+                return *pathLink.link == *link;
+              })) {
+        removeSubtree(nodeName);
+      }
+    }
+  }
+  // ... and nodes which may have better paths over changed links
+  for (auto const& link : changedLinks) {
+    for (auto const& nodeName :
+         {link->firstNodeName(), link->secondNodeName()}) {
+      if (not result.count(nodeName)) {
+        enqueueFromNeighbors(nodeName);
+      } else if (hasBetterPath(nodeName)) {
+        removeSubtree(nodeName);
+      }
+    }
+  }
+
+  // Step 2: settle removed nodes in Dijkstra order
+  uint64_t loop = 0;
+  while (not queue.empty()) {
+    ++loop;
+    auto [queuedMetric, nodeName] = *queue.begin();
+    queue.erase(queue.begin());
+    queuedMetrics.erase(nodeName);
+
+    // collect shortest paths from neighbors in result. Lower bound of metric
+    // is outdated if the neighbor offering it got removed meanwhile
+    NodeSpfResult nodeResult(std::numeric_limits<LinkStateMetric>::max());
+    for (auto const& link : linksFromNode(nodeName)) {
+      auto const& otherNodeName = link->getOtherNodeName(nodeName);
+      auto it = result.find(otherNodeName);
+      if (not link->isUp() or it == result.end() or
+          not isTransit(otherNodeName)) {
+        continue;
+      }
+      auto metric = it->second.metric() + getMetric(link, otherNodeName);
+      if (metric > nodeResult.metric()) {
+        continue;
+      }
+      if (metric < nodeResult.metric()) {
+        nodeResult.reset(metric);
+      }
+      nodeResult.addPath(link, otherNodeName);
+      nodeResult.addNextHops(it->second.nextHops());
+      if (otherNodeName == src) {
+        // directly connected node
+        nodeResult.addNextHop(nodeName);
+      }
+    }
+    if (nodeResult.metric() == std::numeric_limits<LinkStateMetric>::max()) {
+      // not reachable anymore
+      continue;
+    }
+    if (nodeResult.metric() > queuedMetric) {
+      enqueue(nodeName, nodeResult.metric());
+      continue;
+    }
+
+    auto const metric = nodeResult.metric();
+    result.emplace(nodeName, std::move(nodeResult));
+    settled.emplace(nodeName);
+    if (not isTransit(nodeName)) {
+      continue;
+    }
+
+    // relax neighbors. Retained neighbors offered a path as good as theirs
+    // are removed to be settled again
+    for (auto const& link : linksFromNode(nodeName)) {
+      auto const& otherNodeName = link->getOtherNodeName(nodeName);
+      if (not link->isUp() or settled.count(otherNodeName)) {
+        continue;
+      }
+      auto otherMetric = metric + getMetric(link, nodeName);
+      auto it = result.find(otherNodeName);
+      if (it == result.end()) {
+        enqueue(otherNodeName, otherMetric);
+      } else if (otherMetric <= it->second.metric()) {
+        removeSubtree(otherNodeName);
+      }
+    }
+  }
+
+  VLOG(3) << "Incremental Dijkstra loop count: " << loop;
+  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  VLOG(3) << "Incremental SPF elapsed time: " << deltaTime.count() << "ms.";
+  fb303::fbData->addStatValue(
+      "decision.incremental_spf_ms", deltaTime.count(), fb303::AVG);
+  return result;
+}
+
 /**
  * Compute shortest-path routes from perspective of nodeName;
  */
+LinkState::SpfGraph const&
+LinkState::getSpfGraph() const {
+  {
+    std::shared_lock<std::shared_mutex> lock(memoMutex_);
+    if (spfGraph_.has_value()) {
+      return *spfGraph_;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(memoMutex_);
+  if (spfGraph_.has_value()) {
+    return *spfGraph_;
+  }
+  auto& graph = spfGraph_.emplace();
+  graph.nodeNames.reserve(linkMap_.size());
+  for (auto const& kv : linkMap_) {
+    graph.nodeNames.emplace_back(kv.first);
+  }
+  // number nodes in order of names to keep SPF order deterministic
+  std::sort(graph.nodeNames.begin(), graph.nodeNames.end());
+  graph.nodeIds.reserve(graph.nodeNames.size());
+  for (uint32_t id = 0; id < graph.nodeNames.size(); ++id) {
+    graph.nodeIds.emplace(graph.nodeNames[id], id);
+  }
+
+  graph.offsets.reserve(graph.nodeNames.size() + 1);
+  graph.offsets.emplace_back(0);
+  graph.edges.reserve(2 * allLinks_.size());
+  for (auto const& nodeName : graph.nodeNames) {
+    for (auto const& link : linkMap_.at(nodeName)) {
+      graph.edges.push_back(SpfGraph::Edge{
+          graph.nodeIds.at(link->getOtherNodeName(nodeName)), link});
+    }
+    graph.offsets.emplace_back(graph.edges.size());
+  }
+  return graph;
+}
+
 LinkState::SpfResult
 LinkState::runSpf(
     const std::string& thisNodeName,
@@ -813,23 +1312,127 @@ LinkState::runSpf(
   LinkState::SpfResult result;
 
   fb303::fbData->addStatValue("decision.spf_runs", 1, fb303::COUNT);
+  fb303::fbData->addStatValue("decision.full_spf_runs", 1, fb303::COUNT);
   const auto startTime = std::chrono::steady_clock::now();
+  FOLLY_SDT(openr, linkstate_run_spf_entry, area_.c_str());
 
-  DijkstraQ q;
-  q.insertNode(thisNodeName, 0);
+  auto const& graph = getSpfGraph();
+  auto const srcIter = graph.nodeIds.find(thisNodeName);
   uint64_t loop = 0;
-  while (auto node = q.extractMin()) {
-    ++loop;
-    // we've found this node's shortest paths. record it
-    auto emplaceRc = result.emplace(node->nodeName, std::move(node->result));
-    CHECK(emplaceRc.second);
+  if (srcIter == graph.nodeIds.end()) {
+    // node without any links only reaches itself
+    result.emplace(thisNodeName, NodeSpfResult(0));
+  } else {
+    auto const state = runDenseSpf(
+        graph,
+        srcIter->second,
+        useLinkMetric,
+        linksToIgnore,
+        std::nullopt,
+        true /* trackNextHops */);
+    auto const& nodes = state.nodes;
+    auto const& recordedNodes = state.recordedNodes;
+    loop = recordedNodes.size();
+
+    // translate node ids back into names
+    result.reserve(recordedNodes.size());
+    for (auto const id : recordedNodes) {
+      auto const& node = nodes[id];
+      NodeSpfResult nodeResult(node.metric);
+      for (auto const& [edge, prevId] : node.pathLinks) {
+        nodeResult.addPath(edge->link, graph.nodeNames[prevId]);
+      }
+      for (auto const nextHopId : node.nextHops) {
+        nodeResult.addNextHop(graph.nodeNames[nextHopId]);
+      }
+      result.emplace(graph.nodeNames[id], std::move(nodeResult));
+    }
+  }
+  VLOG(3) << "Dijkstra loop count: " << loop;
+  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  VLOG(3) << "SPF elapsed time: " << deltaTime.count() << "ms.";
+  fb303::fbData->addStatValue("decision.spf_ms", deltaTime.count(), fb303::AVG);
+  FOLLY_SDT(openr, linkstate_run_spf_return, area_.c_str(), result.size());
+  return result;
+}
+
+LinkState::HopCounts
+LinkState::runHopCount(const std::string& src) const {
+  fb303::fbData->addStatValue("decision.hop_count_runs", 1, fb303::COUNT);
+  HopCounts result;
+  auto const& graph = getSpfGraph();
+  auto const srcIter = graph.nodeIds.find(src);
+  if (srcIter == graph.nodeIds.end()) {
+    // node without any links only reaches itself
+    result.hops.emplace(src, 0);
+    return result;
+  }
 
-    auto const& recordedNodeName = emplaceRc.first->first;
-    auto const recordedNodeMetric = emplaceRc.first->second.metric();
-    auto const& recordedNodeNextHops = emplaceRc.first->second.nextHops();
+  // nodes in the order they are reached, which is the order of hop counts
+  auto const srcId = srcIter->second;
+  std::vector<LinkStateMetric> hops(
+      graph.nodeNames.size(), std::numeric_limits<LinkStateMetric>::max());
+  std::vector<uint32_t> reachedNodes{srcId};
+  hops[srcId] = 0;
+  for (size_t i = 0; i < reachedNodes.size(); ++i) {
+    auto const id = reachedNodes[i];
+    if (id != srcId and isNodeOverloaded(graph.nodeNames[id])) {
+      // no transit through overloaded node, same as runDenseSpf()
+      continue;
+    }
+    for (auto j = graph.offsets[id]; j < graph.offsets[id + 1]; ++j) {
+      auto const& edge = graph.edges[j];
+      if (hops[edge.otherNode] != std::numeric_limits<LinkStateMetric>::max() or
+          not edge.link->isUp()) {
+        continue;
+      }
+      hops[edge.otherNode] = hops[id] + 1;
+      reachedNodes.emplace_back(edge.otherNode);
+    }
+  }
+
+  result.hops.reserve(reachedNodes.size());
+  for (auto const id : reachedNodes) {
+    result.hops.emplace(graph.nodeNames[id], hops[id]);
+  }
+  result.maxHops = hops[reachedNodes.back()];
+  return result;
+}
 
-    if (isNodeOverloaded(recordedNodeName) &&
-        recordedNodeName != thisNodeName) {
+LinkState::DenseSpfState
+LinkState::runDenseSpf(
+    SpfGraph const& graph,
+    uint32_t srcId,
+    bool useLinkMetric,
+    LinkSet const& linksToIgnore,
+    std::optional<uint32_t> stopId,
+    bool trackNextHops) const {
+  DenseSpfState state;
+  auto& nodes = state.nodes;
+  nodes.resize(graph.nodeNames.size());
+
+  DijkstraQ q(graph.nodeNames.size());
+  nodes[srcId].metric = 0;
+  q.push(srcId, 0);
+  while (not q.empty()) {
+    // we've found this node's shortest paths. record it
+    auto const [recordedId, recordedMetric] = q.pop();
+    auto& recordedNode = nodes[recordedId];
+    recordedNode.recorded = true;
+    state.recordedNodes.emplace_back(recordedId);
+    if (stopId == recordedId) {
+      // paths towards stopId only go through nodes recorded before it
+      break;
+    }
+    auto& recordedNextHops = recordedNode.nextHops;
+    std::sort(recordedNextHops.begin(), recordedNextHops.end());
+    recordedNextHops.erase(
+        std::unique(recordedNextHops.begin(), recordedNextHops.end()),
+        recordedNextHops.end());
+
+    auto const& recordedNodeName = graph.nodeNames[recordedId];
+    if (recordedId != srcId and isNodeOverloaded(recordedNodeName)) {
       // no transit traffic through this node. we've recorded the nexthops to
       // this node, but will not consider any of it's adjancecies as offering
       // lower cost paths towards further away nodes. This effectively drains
@@ -837,48 +1440,104 @@ LinkState::runSpf(
       continue;
     }
     // we have the shortest path nexthops for recordedNodeName. Use these
-    // nextHops for any node that is connected to recordedNodeName that doesn't
-    // already have a lower cost path from thisNodeName
+    // nextHops for any node that is connected to recordedNodeName that
+    // doesn't already have a lower cost path from the source
     //
     // this is the "relax" step in the Dijkstra Algorithm pseudocode in CLRS
-    for (const auto& link : linksFromNode(recordedNodeName)) {
-      auto& otherNodeName = link->getOtherNodeName(recordedNodeName);
-      if (!link->isUp() or result.count(otherNodeName) or
-          linksToIgnore.count(link)) {
+    for (auto i = graph.offsets[recordedId]; i < graph.offsets[recordedId + 1];
+         ++i) {
+      auto const& edge = graph.edges[i];
+      auto& otherNode = nodes[edge.otherNode];
+      if (otherNode.recorded or not edge.link->isUp() or
+          linksToIgnore.count(edge.link)) {
         continue;
       }
-      auto metric =
-          useLinkMetric ? link->getMetricFromNode(recordedNodeName) : 1;
-      auto otherNode = q.get(otherNodeName);
-      if (!otherNode) {
-        q.insertNode(otherNodeName, recordedNodeMetric + metric);
-        otherNode = q.get(otherNodeName);
-      }
-      if (otherNode->result.metric() >= recordedNodeMetric + metric) {
-        // recordedNodeName is either along an alternate shortest path towards
-        // otherNodeName or is along a new shorter path. In either case,
-        // otherNodeName should use recordedNodeName's nextHops until it finds
-        // some shorter path
-        if (otherNode->result.metric() > recordedNodeMetric + metric) {
-          // if this is strictly better, forget about any other paths
-          otherNode->result.reset(recordedNodeMetric + metric);
-          q.reMake();
-        }
-        otherNode->result.addPath(link, recordedNodeName);
-        otherNode->result.addNextHops(recordedNodeNextHops);
-        if (otherNode->result.nextHops().empty()) {
-          // directly connected node
-          otherNode->result.addNextHop(otherNodeName);
-        }
+      auto const metric = recordedMetric +
+          (useLinkMetric ? edge.link->getMetricFromNode(recordedNodeName) : 1);
+      if (otherNode.metric < metric) {
+        continue;
+      }
+      // recordedNodeName is either along an alternate shortest path towards
+      // otherNode or is along a new shorter path. In either case, otherNode
+      // should use recordedNodeName's nextHops until it finds some shorter
+      // path
+      if (otherNode.metric > metric) {
+        // if this is strictly better, forget about any other paths
+        otherNode.metric = metric;
+        otherNode.pathLinks.clear();
+        otherNode.nextHops.clear();
+        q.push(edge.otherNode, metric);
+      }
+      otherNode.pathLinks.emplace_back(&edge, recordedId);
+      if (not trackNextHops) {
+        continue;
+      }
+      if (recordedId == srcId) {
+        // directly connected node
+        otherNode.nextHops.emplace_back(edge.otherNode);
+      } else {
+        otherNode.nextHops.insert(
+            otherNode.nextHops.end(),
+            recordedNextHops.begin(),
+            recordedNextHops.end());
       }
     }
   }
-  VLOG(3) << "Dijkstra loop count: " << loop;
-  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-      std::chrono::steady_clock::now() - startTime);
-  VLOG(3) << "SPF elapsed time: " << deltaTime.count() << "ms.";
-  fb303::fbData->addStatValue("decision.spf_ms", deltaTime.count(), fb303::AVG);
-  return result;
+  return state;
+}
+
+std::vector<LinkState::Path>
+LinkState::traceDisjointPaths(
+    std::string const& src,
+    std::string const& dest,
+    LinkSet const& linksToIgnore) const {
+  std::vector<Path> paths;
+  auto const& graph = getSpfGraph();
+  auto const srcIter = graph.nodeIds.find(src);
+  auto const destIter = graph.nodeIds.find(dest);
+  if (src == dest or srcIter == graph.nodeIds.end() or
+      destIter == graph.nodeIds.end()) {
+    return paths;
+  }
+
+  // counted as SPF run, it replaces runSpf() with ignored links
+  fb303::fbData->addStatValue("decision.spf_runs", 1, fb303::COUNT);
+  fb303::fbData->addStatValue("decision.ksp_spf_runs", 1, fb303::COUNT);
+  auto const srcId = srcIter->second;
+  auto const destId = destIter->second;
+  auto const state = runDenseSpf(
+      graph,
+      srcId,
+      true /* useLinkMetric */,
+      linksToIgnore,
+      destId,
+      false /* trackNextHops */);
+  if (not state.nodes[destId].recorded) {
+    return paths;
+  }
+
+  // same depth-first walk as traceOnePath() in the order of pathLinks
+  LinkSet visitedLinks;
+  std::function<bool(uint32_t, Path&)> traceOne = [&](uint32_t id,
+                                                      Path& path) {
+    if (id == srcId) {
+      return true;
+    }
+    for (auto const& [edge, prevId] : state.nodes[id].pathLinks) {
+      // only consider this link if we haven't yet
+      if (visitedLinks.insert(edge->link).second and traceOne(prevId, path)) {
+        path.push_back(edge->link);
+        return true;
+      }
+    }
+    return false;
+  };
+  Path path;
+  while (traceOne(destId, path)) {
+    paths.push_back(std::move(path));
+    path.clear();
+  }
+  return paths;
 }
 
 } // namespace openr
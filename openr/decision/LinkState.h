@@ -8,7 +8,11 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -176,7 +180,11 @@ class Link {
 
 class LinkState {
  public:
-  explicit LinkState(const std::string& area);
+  // If `enableIncrementalSpf` is set, memoized SPF results are updated only
+  // for the part of shortest path tree affected by link changes instead of
+  // being recomputed from scratch
+  explicit LinkState(
+      const std::string& area, bool enableIncrementalSpf = false);
 
   struct LinkPtrHash {
     size_t operator()(const std::shared_ptr<Link>& l) const;
@@ -268,6 +276,9 @@ class LinkState {
   // each is memoized all params. memoization invalidated for any topolgy
   // altering calls, i.e. if decrementHolds(), updateAdjacencyDatabase(), or
   // deleteAdjacencyDatabase() returns with LinkState::topologyChanged set true
+  //
+  // Shortest paths APIs are thread-safe among each other. Returned references
+  // stay valid until the next topology altering call
   SpfResult const& getSpfResult(
       const std::string& nodeName, bool useLinkMetric = true) const;
 
@@ -275,12 +286,28 @@ class LinkState {
   // LinkState belongs to a unique area
   const std::string area_;
 
+  // see getVersion()
+  uint64_t version_{0};
+
+  // assign a new version to the link state
+  void bumpVersion();
+
+  // update memoized SPF results incrementally on link changes
+  const bool enableIncrementalSpf_{false};
+
   // memoization structure for getSpfResult()
   mutable std::unordered_map<
       std::pair<std::string /* nodeName */, bool /* useLinkMetric */>,
       SpfResult>
       spfResults_;
 
+  // links changed since memoized SPF result was computed. Result is brought
+  // up to date with incremental SPF on next getSpfResult()
+  mutable std::unordered_map<
+      std::pair<std::string /* nodeName */, bool /* useLinkMetric */>,
+      LinkSet>
+      pendingSpfLinks_;
+
  public:
   // Trace edge-disjoint paths from dest to src.
   // I.e., no two paths returned from this function can share any links
@@ -300,6 +327,23 @@ class LinkState {
       std::vector<LinkState::Path>>
       kthPathResults_;
 
+  // Hop counts from a node, i.e. the metrics of an unweighted SPF run
+  struct HopCounts {
+    std::unordered_map<std::string /* otherNodeName */, LinkStateMetric> hops;
+    // hop count to furthest away node
+    LinkStateMetric maxHops{0};
+  };
+
+  // memoized hop counts from nodeName. Kept apart from SPF results as they
+  // are queried for every node on adjacency updates with ordered FIB
+  // programming. Hop counts are not affected by metric changes and are
+  // updated in place when links come up, see updateHopCounts()
+  HopCounts const& getHopCounts(const std::string& nodeName) const;
+
+  // memoization structure for getHopCounts()
+  mutable std::unordered_map<std::string /* nodeName */, HopCounts>
+      hopCounts_;
+
  public:
   // non-const public methods
   // IMPT: clear memoization structures as appropirate in these functions
@@ -326,9 +370,14 @@ class LinkState {
 
   LinkStateChange decrementHolds();
 
-  // update adjacencies for the given router
+  // drop memoized shortest paths results, e.g. to release memory. They are
+  // recomputed on demand
+  void clearMemoizedResults();
+
+  // update adjacencies for the given router. Move the database in to avoid
+  // copying it, links of adjacencies which remain are updated in place
   LinkStateChange updateAdjacencyDatabase(
-      thrift::AdjacencyDatabase const& adjacencyDb,
+      thrift::AdjacencyDatabase adjacencyDb,
       LinkStateMetric holdUpTtl = 0,
       LinkStateMetric holdDownTtl = 0);
 
@@ -345,10 +394,10 @@ class LinkState {
       std::string const& b,
       bool useLinkMetric = true) const;
 
-  std::optional<LinkStateMetric>
-  getHopsFromAToB(std::string const& a, std::string const& b) const {
-    return getMetricFromAToB(a, b, false);
-  }
+  // returns hop count from a to b,
+  // if nodes b is not reachable from a, returns std::nullopt
+  std::optional<LinkStateMetric> getHopsFromAToB(
+      std::string const& a, std::string const& b) const;
 
   // returns hop count to furthest away node connected to nodeName
   LinkStateMetric getMaxHopsToNode(const std::string& nodeName) const;
@@ -358,6 +407,15 @@ class LinkState {
     return area_;
   }
 
+  // Version of the link state, changes with every call altering topology,
+  // link attributes or node labels. Versions are unique within the process,
+  // hence state derived from link states stays valid as long as their
+  // versions are unchanged
+  uint64_t
+  getVersion() const {
+    return version_;
+  }
+
   bool
   hasNode(const std::string& nodeName) const {
     return 0 != adjacencyDatabases_.count(nodeName);
@@ -367,6 +425,7 @@ class LinkState {
 
   bool isNodeOverloaded(const std::string& nodeName) const;
 
+  // whether any link or node overload has an active hold, O(1)
   bool hasHolds() const;
 
   size_t
@@ -432,6 +491,99 @@ class LinkState {
       LinkStateMetric holdUpTtl,
       LinkStateMetric holdDownTtl);
 
+  // index link in heldLinks_ if it has active holds, remove it otherwise
+  void updateHeldLink(std::shared_ptr<Link> const& link);
+
+  // invalidate memoized shortest paths on topology change described by
+  // `changedLinks`. Only memoized results it may affect are invalidated, and
+  // kept for incremental SPF if enabled
+  void invalidateSpfResults(LinkSet const& changedLinks);
+
+  // whether SPF result of `src` may change after `changedLinks` changed, i.e.
+  // a shortest path goes through one of them or one of them offers a path
+  // at least as good as the current one to one of its ends
+  bool isSpfResultAffected(
+      const std::string& src,
+      bool useLinkMetric,
+      SpfResult const& result,
+      LinkSet const& changedLinks) const;
+
+  // bring SPF result of `src` up to date after `changedLinks` changed (came
+  // up, went down or changed metric). Only nodes whose shortest paths may go
+  // through changed links are recomputed, the rest of `result` is retained
+  SpfResult runIncrementalSpf(
+      const std::string& src,
+      bool useLinkMetric,
+      SpfResult result,
+      const LinkSet& changedLinks) const;
+
+  // breadth-first search from src on the link state graph. Same as the
+  // metrics of runSpf(src, false) without tracking any paths
+  HopCounts runHopCount(const std::string& src) const;
+
+  // update memoized hop counts on topology change. Hop counts only decrease
+  // when `linksUp` come up, memoized ones are relaxed along them. Any other
+  // change affecting hop counts, i.e. links going down or node overload
+  // changes, requires `resetRequired` and clears them
+  void updateHopCounts(LinkSet const& linksUp, bool resetRequired);
+
+  // Dense integer representation of the link state graph used by SPF. Nodes
+  // are numbered in order of their names and adjacencies are kept in
+  // compressed sparse row layout, i.e. adjacencies of node `i` are
+  // edges[offsets[i]] .. edges[offsets[i + 1] - 1]. Link state (up, metric)
+  // is read from links at SPF time, hence the graph only needs to be rebuilt
+  // when links are added or removed
+  struct SpfGraph {
+    struct Edge {
+      uint32_t otherNode;
+      std::shared_ptr<Link> link;
+    };
+
+    std::vector<std::string> nodeNames;
+    std::unordered_map<std::string, uint32_t> nodeIds;
+    std::vector<size_t> offsets;
+    std::vector<Edge> edges;
+  };
+
+  // build spfGraph_ from linkMap_ if it was invalidated
+  SpfGraph const& getSpfGraph() const;
+
+  // SPF state of every node on SpfGraph, indexed by node id. Node names are
+  // looked up only when translating results
+  struct DenseSpfState {
+    struct Node {
+      LinkStateMetric metric{std::numeric_limits<LinkStateMetric>::max()};
+      // (edge, previous node) of shortest paths towards the node
+      std::vector<std::pair<SpfGraph::Edge const*, uint32_t>> pathLinks;
+      std::vector<uint32_t> nextHops;
+      bool recorded{false};
+    };
+
+    std::vector<Node> nodes;
+    // node ids in the order they were recorded
+    std::vector<uint32_t> recordedNodes;
+  };
+
+  // run Dijkstra's algorithm from srcId on graph. If stopId is given, the run
+  // ends as soon as shortest paths to it are recorded. Next-hops are only
+  // tracked if trackNextHops is set
+  DenseSpfState runDenseSpf(
+      SpfGraph const& graph,
+      uint32_t srcId,
+      bool useLinkMetric,
+      LinkSet const& linksToIgnore,
+      std::optional<uint32_t> stopId,
+      bool trackNextHops) const;
+
+  // trace all edge-disjoint shortest paths from src to dest avoiding
+  // linksToIgnore. Yields the same paths as tracing
+  // runSpf(src, true, linksToIgnore) with traceOnePath() but stops the SPF
+  // run at dest and skips translating it into a SpfResult
+  std::vector<Path> traceDisjointPaths(
+      std::string const& src,
+      std::string const& dest,
+      LinkSet const& linksToIgnore) const;
+
   // run Dijkstra's Shortest Path First algorithm on the link state graph
   SpfResult runSpf(
       const std::string& src, /* the source node for the SPF run */
@@ -447,91 +599,135 @@ class LinkState {
   std::shared_ptr<Link> maybeMakeLink(
       const std::string& nodeName, const thrift::Adjacency& adj) const;
 
-  std::vector<std::shared_ptr<Link>> getOrderedLinkSet(
-      const thrift::AdjacencyDatabase& adjDb) const;
-
-  std::vector<std::shared_ptr<Link>> orderedLinksFromNode(
-      const std::string& nodeName) const;
-
   // this stores the same link object accessible from either nodeName
   std::unordered_map<std::string /* nodeName */, LinkSet> linkMap_;
 
   // useful for iterating over all the links
   LinkSet allLinks_;
 
+  // graph for SPF runs, reset whenever a link is added or removed
+  mutable std::optional<SpfGraph> spfGraph_;
+
+  // Shared mutex movable along with LinkState. Moved-to object gets a fresh
+  // unlocked mutex
+  struct MovableSharedMutex : public std::shared_mutex {
+    MovableSharedMutex() = default;
+    MovableSharedMutex(MovableSharedMutex&&) noexcept {}
+    MovableSharedMutex&
+    operator=(MovableSharedMutex&&) noexcept {
+      return *this;
+    }
+  };
+
+  // Guards memoization structures (spfResults_, pendingSpfLinks_,
+  // kthPathResults_, hopCounts_, spfGraph_) so that shortest paths APIs can
+  // be called from multiple threads concurrently. ATTN: topology altering
+  // calls must NOT run concurrently with any other call
+  mutable MovableSharedMutex memoMutex_;
+
   std::unordered_map<std::string /* nodeName */, HoldableValue<bool>>
       nodeOverloads_;
 
+  // links and nodes whose metric or overload has an active hold, so that
+  // ordered FIB programming ticks don't scan the whole link state
+  LinkSet heldLinks_;
+  std::unordered_set<std::string /* nodeName */> heldNodes_;
+
   // the latest AdjacencyDatabase we've received from each node
   std::unordered_map<std::string, thrift::AdjacencyDatabase>
       adjacencyDatabases_;
 
 }; // class LinkState
 
-// Classes needed for running Dijkstra
-// In addition to implementing the priority queue at the heart of Dijkstra's
-// algorithm, this structure also allows us to store appication specfic data:
-// nexthops.
-class DijkstraQNode {
- public:
-  DijkstraQNode(const std::string& n, LinkStateMetric m)
-      : nodeName(n), result(m) {}
-  const std::string nodeName;
-  LinkState::NodeSpfResult result;
-};
-
+// Priority queue at the heart of Dijkstra's algorithm. Binary min-heap of
+// dense node ids keyed by tentative metric which supports decrease-key. Ties
+// are broken by node id
 class DijkstraQ {
- private:
-  std::vector<std::shared_ptr<DijkstraQNode>> heap_;
-  std::unordered_map<std::string, std::shared_ptr<DijkstraQNode>> nameToNode_;
+ public:
+  explicit DijkstraQ(size_t numNodes) : positions_(numNodes, kNotQueued) {}
 
-  struct {
-    bool
-    operator()(
-        std::shared_ptr<DijkstraQNode> a,
-        std::shared_ptr<DijkstraQNode> b) const {
-      if (a->result.metric() != b->result.metric()) {
-        return a->result.metric() > b->result.metric();
-      }
-      return a->nodeName > b->nodeName;
-    }
-  } DijkstraQNodeGreater;
+  bool
+  empty() const {
+    return heap_.empty();
+  }
 
- public:
+  // insert node or decrease its metric if it is already queued
   void
-  insertNode(const std::string& nodeName, LinkStateMetric d) {
-    heap_.push_back(std::make_shared<DijkstraQNode>(nodeName, d));
-    nameToNode_[nodeName] = heap_.back();
-    std::push_heap(heap_.begin(), heap_.end(), DijkstraQNodeGreater);
+  push(uint32_t node, LinkStateMetric metric) {
+    auto pos = positions_.at(node);
+    if (pos == kNotQueued) {
+      pos = heap_.size();
+      heap_.emplace_back(metric, node);
+    } else {
+      CHECK_LE(metric, heap_[pos].first);
+      heap_[pos].first = metric;
+    }
+    siftUp(pos);
   }
 
-  std::shared_ptr<DijkstraQNode>
-  get(const std::string& nodeName) {
-    if (nameToNode_.count(nodeName)) {
-      return nameToNode_.at(nodeName);
+  // remove and return node with the lowest metric
+  std::pair<uint32_t, LinkStateMetric>
+  pop() {
+    CHECK(not heap_.empty());
+    auto const [metric, node] = heap_.front();
+    positions_[node] = kNotQueued;
+    if (heap_.size() > 1) {
+      heap_.front() = heap_.back();
+      heap_.pop_back();
+      siftDown(0);
+    } else {
+      heap_.pop_back();
     }
-    return nullptr;
+    return {node, metric};
+  }
+
+ private:
+  static constexpr size_t kNotQueued = std::numeric_limits<size_t>::max();
+
+  void
+  place(size_t pos, std::pair<LinkStateMetric, uint32_t> entry) {
+    positions_[entry.second] = pos;
+    heap_[pos] = entry;
   }
 
-  std::shared_ptr<DijkstraQNode>
-  extractMin() {
-    if (heap_.empty()) {
-      return nullptr;
+  void
+  siftUp(size_t pos) {
+    auto entry = heap_[pos];
+    while (pos > 0) {
+      auto parent = (pos - 1) / 2;
+      if (not(entry < heap_[parent])) {
+        break;
+      }
+      place(pos, heap_[parent]);
+      pos = parent;
     }
-    auto min = heap_.at(0);
-    CHECK(nameToNode_.erase(min->nodeName));
-    std::pop_heap(heap_.begin(), heap_.end(), DijkstraQNodeGreater);
-    heap_.pop_back();
-    return min;
+    place(pos, entry);
   }
 
   void
-  reMake() {
-    // this is a bit slow but is rarely called in our application. In fact,
-    // in networks where the metric is hop count, this will never be called
-    // and the Dijkstra run is no different than BFS
-    std::make_heap(heap_.begin(), heap_.end(), DijkstraQNodeGreater);
+  siftDown(size_t pos) {
+    auto entry = heap_[pos];
+    while (true) {
+      auto child = 2 * pos + 1;
+      if (child >= heap_.size()) {
+        break;
+      }
+      if (child + 1 < heap_.size() and heap_[child + 1] < heap_[child]) {
+        ++child;
+      }
+      if (not(heap_[child] < entry)) {
+        break;
+      }
+      place(pos, heap_[child]);
+      pos = child;
+    }
+    place(pos, entry);
   }
+
+  // (metric, node) pairs in heap order
+  std::vector<std::pair<LinkStateMetric, uint32_t>> heap_;
+  // position of every node in heap_, kNotQueued if node is not queued
+  std::vector<size_t> positions_;
 };
 } // namespace openr
 
@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/decision/LsdbSnapshot.h>
+
+#include <stdexcept>
+#include <unordered_set>
+
+#include <folly/Format.h>
+
+#include <openr/if/gen-cpp2/Decision_constants.h>
+
+namespace openr {
+
+namespace {
+
+const std::string&
+lookup(thrift::LsdbSnapshot const& snapshot, int32_t index) {
+  const auto& strings = *snapshot.strings_ref();
+  if (index < 0 or static_cast<size_t>(index) >= strings.size()) {
+    throw std::invalid_argument(folly::sformat(
+        "Invalid string index {} of {} strings", index, strings.size()));
+  }
+  return strings.at(index);
+}
+
+} // namespace
+
+LsdbSnapshotWriter::LsdbSnapshotWriter(
+    const std::string& thisNodeName,
+    int64_t epoch,
+    int64_t version,
+    bool isDelta) {
+  *snapshot_.thisNodeName_ref() = thisNodeName;
+  *snapshot_.epoch_ref() = epoch;
+  *snapshot_.version_ref() = version;
+  *snapshot_.isDelta_ref() = isDelta;
+}
+
+int32_t
+LsdbSnapshotWriter::intern(const std::string& str) {
+  auto [it, inserted] =
+      stringIndices_.emplace(str, snapshot_.strings_ref()->size());
+  if (inserted) {
+    snapshot_.strings_ref()->emplace_back(str);
+  }
+  return it->second;
+}
+
+void
+LsdbSnapshotWriter::addNode(
+    const std::string& area,
+    const std::string& nodeName,
+    thrift::AdjacencyDatabase const* adjDb,
+    PrefixState const& prefixState) {
+  thrift::LsdbSnapshotNode node;
+  *node.nodeName_ref() = intern(nodeName);
+  *node.area_ref() = intern(area);
+
+  if (adjDb) {
+    *node.hasAdjacencyDb_ref() = true;
+    *node.isOverloaded_ref() = *adjDb->isOverloaded_ref();
+    *node.nodeLabel_ref() = *adjDb->nodeLabel_ref();
+    for (const auto& adj : *adjDb->adjacencies_ref()) {
+      thrift::LsdbSnapshotAdjacency snapshotAdj;
+      *snapshotAdj.otherNodeName_ref() = intern(*adj.otherNodeName_ref());
+      *snapshotAdj.ifName_ref() = intern(*adj.ifName_ref());
+      *snapshotAdj.otherIfName_ref() = intern(*adj.otherIfName_ref());
+      *snapshotAdj.nextHopV6_ref() = *adj.nextHopV6_ref();
+      *snapshotAdj.nextHopV4_ref() = *adj.nextHopV4_ref();
+      *snapshotAdj.metric_ref() = *adj.metric_ref();
+      *snapshotAdj.adjLabel_ref() = *adj.adjLabel_ref();
+      *snapshotAdj.isOverloaded_ref() = *adj.isOverloaded_ref();
+      *snapshotAdj.rtt_ref() = *adj.rtt_ref();
+      *snapshotAdj.weight_ref() = *adj.weight_ref();
+      node.adjacencies_ref()->emplace_back(std::move(snapshotAdj));
+    }
+  }
+
+  const auto nodeAndArea = std::make_pair(nodeName, area);
+  for (const auto& prefix : prefixState.getNodePrefixes(nodeAndArea)) {
+    node.prefixEntries_ref()->emplace_back(
+        *prefixState.prefixes().at(prefix).at(nodeAndArea));
+  }
+
+  snapshot_.nodes_ref()->emplace_back(std::move(node));
+}
+
+void
+applyLsdbSnapshot(
+    thrift::LsdbSnapshot const& snapshot,
+    std::unordered_map<std::string, LinkState>& areaLinkStates,
+    PrefixState& prefixState,
+    bool enableIncrementalSpf) {
+  const auto formatVersion =
+      thrift::Decision_constants::kLsdbSnapshotFormatVersion();
+  if (*snapshot.formatVersion_ref() != formatVersion) {
+    throw std::invalid_argument(folly::sformat(
+        "Unsupported LSDB snapshot format version {}, expected {}",
+        *snapshot.formatVersion_ref(),
+        formatVersion));
+  }
+
+  if (not *snapshot.isDelta_ref()) {
+    // Withdraw prefixes rather than resetting prefix state, which keeps its
+    // version moving forward
+    std::unordered_set<NodeAndArea> advertisers;
+    for (const auto& [prefix, entries] : prefixState.prefixes()) {
+      for (const auto& [nodeAndArea, entry] : entries) {
+        advertisers.emplace(nodeAndArea);
+      }
+    }
+    for (const auto& [node, area] : advertisers) {
+      thrift::PrefixDatabase prefixDb;
+      *prefixDb.thisNodeName_ref() = node;
+      *prefixDb.area_ref() = area;
+      prefixState.updatePrefixDatabase(prefixDb);
+    }
+    areaLinkStates.clear();
+  }
+
+  for (const auto& node : *snapshot.nodes_ref()) {
+    const auto& nodeName = lookup(snapshot, *node.nodeName_ref());
+    const auto& area = lookup(snapshot, *node.area_ref());
+    auto& linkState =
+        areaLinkStates.try_emplace(area, area, enableIncrementalSpf)
+            .first->second;
+
+    if (*node.hasAdjacencyDb_ref()) {
+      thrift::AdjacencyDatabase adjDb;
+      *adjDb.thisNodeName_ref() = nodeName;
+      *adjDb.area_ref() = area;
+      *adjDb.isOverloaded_ref() = *node.isOverloaded_ref();
+      *adjDb.nodeLabel_ref() = *node.nodeLabel_ref();
+      for (const auto& snapshotAdj : *node.adjacencies_ref()) {
+        thrift::Adjacency adj;
+        *adj.otherNodeName_ref() =
+            lookup(snapshot, *snapshotAdj.otherNodeName_ref());
+        *adj.ifName_ref() = lookup(snapshot, *snapshotAdj.ifName_ref());
+        *adj.otherIfName_ref() =
+            lookup(snapshot, *snapshotAdj.otherIfName_ref());
+        *adj.nextHopV6_ref() = *snapshotAdj.nextHopV6_ref();
+        *adj.nextHopV4_ref() = *snapshotAdj.nextHopV4_ref();
+        *adj.metric_ref() = *snapshotAdj.metric_ref();
+        *adj.adjLabel_ref() = *snapshotAdj.adjLabel_ref();
+        *adj.isOverloaded_ref() = *snapshotAdj.isOverloaded_ref();
+        *adj.rtt_ref() = *snapshotAdj.rtt_ref();
+        *adj.weight_ref() = *snapshotAdj.weight_ref();
+        adjDb.adjacencies_ref()->emplace_back(std::move(adj));
+      }
+      linkState.updateAdjacencyDatabase(std::move(adjDb));
+    } else if (linkState.hasNode(nodeName)) {
+      linkState.deleteAdjacencyDatabase(nodeName);
+    }
+
+    thrift::PrefixDatabase prefixDb;
+    *prefixDb.thisNodeName_ref() = nodeName;
+    *prefixDb.area_ref() = area;
+    *prefixDb.prefixEntries_ref() = *node.prefixEntries_ref();
+    prefixState.updatePrefixDatabase(prefixDb);
+  }
+}
+
+} // namespace openr
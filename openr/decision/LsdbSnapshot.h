@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include <openr/decision/LinkState.h>
+#include <openr/decision/PrefixState.h>
+#include <openr/if/gen-cpp2/Decision_types.h>
+
+namespace openr {
+
+/**
+ * Builds thrift::LsdbSnapshot from link states and prefix state, interning
+ * names of nodes, areas and interfaces into the string table of snapshot
+ */
+class LsdbSnapshotWriter {
+ public:
+  LsdbSnapshotWriter(
+      const std::string& thisNodeName,
+      int64_t epoch,
+      int64_t version,
+      bool isDelta);
+
+  // Add entry of node in area with its adjacency database, nullptr if there
+  // is none, and its prefixes in prefix state
+  void addNode(
+      const std::string& area,
+      const std::string& nodeName,
+      thrift::AdjacencyDatabase const* adjDb,
+      PrefixState const& prefixState);
+
+  thrift::LsdbSnapshot
+  build() && {
+    return std::move(snapshot_);
+  }
+
+ private:
+  int32_t intern(const std::string& str);
+
+  thrift::LsdbSnapshot snapshot_;
+  std::unordered_map<std::string, int32_t> stringIndices_;
+};
+
+/**
+ * Apply snapshot to link states and prefix state, e.g. to rebuild LSDB of a
+ * node offline and run SpfSolver on it. Full snapshots replace the whole
+ * state, delta snapshots replace the state of their entries only. Link
+ * states of new areas are created with `enableIncrementalSpf`. Throws
+ * std::invalid_argument on unsupported format version or invalid index into
+ * string table.
+ */
+void applyLsdbSnapshot(
+    thrift::LsdbSnapshot const& snapshot,
+    std::unordered_map<std::string /* area */, LinkState>& areaLinkStates,
+    PrefixState& prefixState,
+    bool enableIncrementalSpf = false);
+
+} // namespace openr
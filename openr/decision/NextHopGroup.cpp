@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/decision/NextHopGroup.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace openr {
+
+namespace {
+
+struct GroupPtrHash {
+  size_t
+  operator()(NextHopGroup const* group) const {
+    return group->hash();
+  }
+};
+
+struct GroupPtrEqual {
+  bool
+  operator()(NextHopGroup const* a, NextHopGroup const* b) const {
+    return a->nexthops() == b->nexthops();
+  }
+};
+
+// Table of interned groups. Groups are owned by routes referring to them and
+// the table only keeps weak references
+struct GroupTable {
+  std::mutex mutex;
+  std::unordered_map<
+      NextHopGroup const*,
+      std::weak_ptr<NextHopGroup const>,
+      GroupPtrHash,
+      GroupPtrEqual>
+      groups;
+};
+
+// ATTN: intentionally leaked to outlive groups referred by static objects
+GroupTable&
+getGroupTable() {
+  static auto* table = new GroupTable();
+  return *table;
+}
+
+std::atomic<uint64_t> nextGroupId{1};
+
+} // namespace
+
+std::shared_ptr<NextHopGroup const>
+NextHopGroup::intern(NextHopSet nexthops) {
+  // order independent hash of the set
+  size_t hash = nexthops.size();
+  for (auto const& nh : nexthops) {
+    hash += std::hash<thrift::NextHopThrift>()(nh);
+  }
+
+  auto& table = getGroupTable();
+  // remove group from the table with its last reference unless the entry was
+  // already taken over by a new group of the same next-hops
+  auto deleter = [&table](NextHopGroup const* group) {
+    {
+      std::lock_guard<std::mutex> lock(table.mutex);
+      auto it = table.groups.find(group);
+      if (it != table.groups.end() and it->first == group) {
+        table.groups.erase(it);
+      }
+    }
+    delete group;
+  };
+  std::shared_ptr<NextHopGroup const> group(
+      new NextHopGroup(std::move(nexthops), hash, nextGroupId++), deleter);
+
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.groups.find(group.get());
+  if (it != table.groups.end()) {
+    if (auto existing = it->second.lock()) {
+      return existing;
+    }
+    // last reference of the existing group is being released
+    table.groups.erase(it);
+  }
+  table.groups.emplace(group.get(), group);
+  return group;
+}
+
+std::shared_ptr<NextHopGroup const> const&
+NextHopGroup::empty() {
+  static auto const* group =
+      new std::shared_ptr<NextHopGroup const>(intern(NextHopSet{}));
+  return *group;
+}
+
+size_t
+NextHopGroup::numGroups() {
+  auto& table = getGroupTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.groups.size();
+}
+
+void
+NextHops::emplace(thrift::NextHopThrift nh) {
+  if (count(nh)) {
+    return;
+  }
+  auto nexthops = group_->nexthops();
+  nexthops.emplace(std::move(nh));
+  group_ = NextHopGroup::intern(std::move(nexthops));
+}
+
+size_t
+NextHops::erase(thrift::NextHopThrift const& nh) {
+  if (not count(nh)) {
+    return 0;
+  }
+  auto nexthops = group_->nexthops();
+  nexthops.erase(nh);
+  group_ = NextHopGroup::intern(std::move(nexthops));
+  return 1;
+}
+
+} // namespace openr
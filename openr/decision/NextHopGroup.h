@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <initializer_list>
+#include <memory>
+#include <unordered_set>
+
+#include <openr/common/NetworkUtil.h>
+#include <openr/if/gen-cpp2/Network_types.h>
+
+namespace openr {
+
+using NextHopSet = std::unordered_set<thrift::NextHopThrift>;
+
+/**
+ * Immutable set of next-hops shared by all routes with the same next-hops.
+ *
+ * Groups are hash-consed in a process wide table, i.e. equal sets of
+ * next-hops are interned into the same group object for as long as any route
+ * refers to it. Hence two groups are equal iff they are the same object. The
+ * group is released from the table along with its last reference.
+ */
+class NextHopGroup {
+ public:
+  // Get interned group of given next-hops. Thread-safe
+  static std::shared_ptr<NextHopGroup const> intern(NextHopSet nexthops);
+
+  // Interned group of no next-hops
+  static std::shared_ptr<NextHopGroup const> const& empty();
+
+  // Number of groups currently interned
+  static size_t numGroups();
+
+  // Unique ID of the group within the process. IDs are never reused
+  uint64_t
+  id() const {
+    return id_;
+  }
+
+  NextHopSet const&
+  nexthops() const {
+    return nexthops_;
+  }
+
+  size_t
+  hash() const {
+    return hash_;
+  }
+
+ private:
+  NextHopGroup(NextHopSet&& nexthops, size_t hash, uint64_t id)
+      : nexthops_(std::move(nexthops)), hash_(hash), id_(id) {}
+
+  NextHopSet const nexthops_;
+  size_t const hash_{0};
+  uint64_t const id_{0};
+};
+
+/**
+ * Next-hops of a RIB entry. Holds a reference to an interned NextHopGroup and
+ * offers a read-only set interface on top of it. Modifications intern a new
+ * group (copy-on-write), comparison is a pointer comparison.
+ */
+class NextHops {
+ public:
+  using value_type = thrift::NextHopThrift;
+  using const_iterator = NextHopSet::const_iterator;
+  using iterator = const_iterator;
+
+  NextHops() : group_(NextHopGroup::empty()) {}
+
+  // implicit to allow assignment from sets of next-hops
+  /* implicit */ NextHops(NextHopSet nexthops)
+      : group_(NextHopGroup::intern(std::move(nexthops))) {}
+
+  NextHops(std::initializer_list<thrift::NextHopThrift> nexthops)
+      : NextHops(NextHopSet(nexthops)) {}
+
+  const_iterator
+  begin() const {
+    return group_->nexthops().begin();
+  }
+
+  const_iterator
+  end() const {
+    return group_->nexthops().end();
+  }
+
+  size_t
+  size() const {
+    return group_->nexthops().size();
+  }
+
+  bool
+  empty() const {
+    return group_->nexthops().empty();
+  }
+
+  size_t
+  count(thrift::NextHopThrift const& nh) const {
+    return group_->nexthops().count(nh);
+  }
+
+  NextHopSet const&
+  set() const {
+    return group_->nexthops();
+  }
+
+  std::shared_ptr<NextHopGroup const> const&
+  group() const {
+    return group_;
+  }
+
+  // copy-on-write modifiers
+  void emplace(thrift::NextHopThrift nh);
+  size_t erase(thrift::NextHopThrift const& nh);
+
+  bool
+  operator==(NextHops const& other) const {
+    return group_ == other.group_;
+  }
+
+  bool
+  operator!=(NextHops const& other) const {
+    return group_ != other.group_;
+  }
+
+ private:
+  std::shared_ptr<NextHopGroup const> group_;
+};
+
+} // namespace openr
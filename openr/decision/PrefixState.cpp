@@ -19,65 +19,100 @@ PrefixState::updatePrefixDatabase(thrift::PrefixDatabase const& prefixDb) {
 
   auto const nodeAndArea =
       std::make_pair(*prefixDb.thisNodeName_ref(), *prefixDb.area_ref());
-  auto const& nodeName = *prefixDb.thisNodeName_ref();
-  auto const& area = *prefixDb.area_ref();
 
-  // Get reference existing set or create new one
-  auto& newPrefixSet = nodeToPrefixes_[nodeAndArea];
-
-  // Create copy of existing prefix set - NOTE explicit copy
-  const std::set<thrift::IpPrefix> oldPrefixSet = newPrefixSet;
-
-  // update the entry
-  newPrefixSet.clear();
+  std::unordered_set<thrift::IpPrefix> newPrefixSet;
   for (const auto& prefixEntry : *prefixDb.prefixEntries_ref()) {
     newPrefixSet.emplace(*prefixEntry.prefix_ref());
   }
 
   // Remove old prefixes first
-  for (const auto& prefix : oldPrefixSet) {
-    if (newPrefixSet.count(prefix)) {
-      continue;
+  std::vector<thrift::IpPrefix> withdrawnPrefixes;
+  for (const auto& prefix : getNodePrefixes(nodeAndArea)) {
+    if (not newPrefixSet.count(prefix)) {
+      withdrawnPrefixes.emplace_back(prefix);
     }
-
-    VLOG(1) << "[ROUTE WITHDRAW] "
-            << "Area: " << area << ", Node: " << nodeName << ", "
-            << toString(prefix);
-
-    // Update prefix
-    auto& entriesByOriginator = prefixes_.at(prefix);
-    entriesByOriginator.erase(nodeAndArea);
-    if (entriesByOriginator.empty()) {
-      prefixes_.erase(prefix);
+  }
+  for (const auto& prefix : withdrawnPrefixes) {
+    if (deletePrefix(nodeAndArea, prefix)) {
+      changed.insert(prefix);
     }
-    changed.insert(prefix);
   }
 
   // update prefix entry for new announcement
   for (const auto& prefixEntry : *prefixDb.prefixEntries_ref()) {
-    auto& entriesByOriginator = prefixes_[*prefixEntry.prefix_ref()];
-
-    // Skip rest of code, if prefix exists and has no change
-    auto [it, inserted] = entriesByOriginator.emplace(nodeAndArea, prefixEntry);
-    if (not inserted && it->second == prefixEntry) {
-      continue;
+    if (updatePrefix(nodeAndArea, prefixEntry)) {
+      changed.insert(*prefixEntry.prefix_ref());
     }
+  }
+  return changed;
+}
 
-    // Update prefix
-    if (not inserted) {
-      it->second = prefixEntry;
-    }
-    changed.insert(*prefixEntry.prefix_ref());
+bool
+PrefixState::updatePrefix(
+    NodeAndArea const& nodeAndArea, thrift::PrefixEntry const& prefixEntry) {
+  auto const& prefix = *prefixEntry.prefix_ref();
+  const PackedPrefix key(prefix);
+  auto& entriesByOriginator = prefixes_[key];
 
-    VLOG(1) << "[ROUTE ADVERTISEMENT] "
-            << "Area: " << area << ", Node: " << nodeName << ", "
-            << toString(prefixEntry, VLOG_IS_ON(2));
+  // Metric vectors are kept sorted by priority so that best path selection
+  // compares them as they are, instead of sorting shared entries every time
+  std::optional<thrift::PrefixEntry> sortedEntry;
+  if (prefixEntry.mv_ref().has_value() and
+      not MetricVectorUtils::isSorted(*prefixEntry.mv_ref())) {
+    sortedEntry = prefixEntry;
+    MetricVectorUtils::sortMetricVector(*sortedEntry->mv_ref());
   }
+  auto const& entry = sortedEntry.has_value() ? *sortedEntry : prefixEntry;
 
-  if (newPrefixSet.empty()) {
-    nodeToPrefixes_.erase(nodeAndArea);
+  // Skip rest of code, if prefix exists and has no change
+  auto [it, inserted] = entriesByOriginator.try_emplace(nodeAndArea);
+  if (not inserted && *it->second == entry) {
+    return false;
   }
-  return changed;
+
+  // Update prefix. The entry is copied once and shared from here on
+  it->second = std::make_shared<thrift::PrefixEntry const>(entry);
+  nodeToPrefixes_[nodeAndArea].emplace(prefix);
+  areaToNodes_[nodeAndArea.second].emplace(nodeAndArea.first);
+  updateReachableEntry(key, nodeAndArea);
+  ++version_;
+
+  VLOG(1) << "[ROUTE ADVERTISEMENT] "
+          << "Area: " << nodeAndArea.second << ", Node: " << nodeAndArea.first
+          << ", " << toString(prefixEntry, VLOG_IS_ON(2));
+  return true;
+}
+
+bool
+PrefixState::deletePrefix(
+    NodeAndArea const& nodeAndArea, thrift::IpPrefix const& prefix) {
+  auto nodeIt = nodeToPrefixes_.find(nodeAndArea);
+  if (nodeIt == nodeToPrefixes_.end() or not nodeIt->second.erase(prefix)) {
+    return false;
+  }
+  if (nodeIt->second.empty()) {
+    nodeToPrefixes_.erase(nodeIt);
+    auto areaIt = areaToNodes_.find(nodeAndArea.second);
+    areaIt->second.erase(nodeAndArea.first);
+    if (areaIt->second.empty()) {
+      areaToNodes_.erase(areaIt);
+    }
+  }
+
+  VLOG(1) << "[ROUTE WITHDRAW] "
+          << "Area: " << nodeAndArea.second << ", Node: " << nodeAndArea.first
+          << ", " << toString(prefix);
+
+  // Update prefix
+  const PackedPrefix key(prefix);
+  auto& entriesByOriginator = prefixes_.at(key);
+  entriesByOriginator.erase(nodeAndArea);
+  if (entriesByOriginator.empty()) {
+    prefixes_.erase(key);
+  }
+  updateReachableEntry(key, nodeAndArea);
+  ++version_;
+  return true;
 }
 
 std::unordered_map<std::string /* nodeName */, thrift::PrefixDatabase>
@@ -89,20 +124,144 @@ PrefixState::getPrefixDatabases() const {
     prefixDb.area_ref() = nodeAndArea.second;
     for (auto const& prefix : prefixes) {
       prefixDb.prefixEntries_ref()->emplace_back(
-          prefixes_.at(prefix).at(nodeAndArea));
+          *prefixes_.at(prefix).at(nodeAndArea));
     }
     prefixDatabases.emplace(nodeAndArea.first, std::move(prefixDb));
   }
   return prefixDatabases;
 }
 
+std::set<thrift::IpPrefix> const&
+PrefixState::getNodePrefixes(NodeAndArea const& nodeAndArea) const {
+  static const std::set<thrift::IpPrefix> kNoPrefixes;
+  auto it = nodeToPrefixes_.find(nodeAndArea);
+  return it != nodeToPrefixes_.end() ? it->second : kNoPrefixes;
+}
+
+void
+PrefixState::updateReachability(
+    std::string const& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  if (isReachabilityCurrent(myNodeName, areaLinkStates)) {
+    return;
+  }
+  ++version_;
+
+  bool rebuild = myNodeName != reachabilityNodeName_ or
+      areaLinkStates.size() != reachableNodes_.size();
+  std::unordered_map<std::string, std::unordered_set<std::string>>
+      reachableNodes;
+  std::vector<NodeAndArea> changedNodes;
+  reachabilityVersions_.clear();
+  for (auto const& [area, linkState] : areaLinkStates) {
+    auto& nodes = reachableNodes[area];
+    for (auto const& [node, _] : linkState.getSpfResult(myNodeName)) {
+      nodes.emplace(node);
+    }
+    reachabilityVersions_.emplace(area, linkState.getVersion());
+
+    auto oldIt = reachableNodes_.find(area);
+    if (rebuild or oldIt == reachableNodes_.end()) {
+      rebuild = true;
+      continue;
+    }
+    for (auto const& node : nodes) {
+      if (not oldIt->second.count(node)) {
+        changedNodes.emplace_back(node, area);
+      }
+    }
+    for (auto const& node : oldIt->second) {
+      if (not nodes.count(node)) {
+        changedNodes.emplace_back(node, area);
+      }
+    }
+  }
+  reachabilityNodeName_ = myNodeName;
+  reachableNodes_ = std::move(reachableNodes);
+
+  if (rebuild) {
+    reachablePrefixes_.clear();
+    for (auto const& [prefix, entries] : prefixes_) {
+      for (auto const& [nodeAndArea, entry] : entries) {
+        if (isReachable(nodeAndArea)) {
+          reachablePrefixes_[prefix].emplace(nodeAndArea, entry);
+        }
+      }
+    }
+    return;
+  }
+  for (auto const& nodeAndArea : changedNodes) {
+    for (auto const& prefix : getNodePrefixes(nodeAndArea)) {
+      updateReachableEntry(prefix, nodeAndArea);
+    }
+  }
+}
+
+bool
+PrefixState::isReachabilityCurrent(
+    std::string const& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) const {
+  if (myNodeName != reachabilityNodeName_ or
+      areaLinkStates.size() != reachabilityVersions_.size()) {
+    return false;
+  }
+  for (auto const& [area, linkState] : areaLinkStates) {
+    auto it = reachabilityVersions_.find(area);
+    if (it == reachabilityVersions_.end() or
+        it->second != linkState.getVersion()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+PrefixEntries const*
+PrefixState::getReachablePrefixEntries(PackedPrefix const& prefix) const {
+  auto it = reachablePrefixes_.find(prefix);
+  return it != reachablePrefixes_.end() ? &it->second : nullptr;
+}
+
+bool
+PrefixState::isReachable(NodeAndArea const& nodeAndArea) const {
+  auto it = reachableNodes_.find(nodeAndArea.second);
+  return it == reachableNodes_.end() or it->second.count(nodeAndArea.first);
+}
+
+void
+PrefixState::updateReachableEntry(
+    PackedPrefix const& prefix, NodeAndArea const& nodeAndArea) {
+  std::shared_ptr<thrift::PrefixEntry const> entry;
+  if (auto it = prefixes_.find(prefix); it != prefixes_.end()) {
+    if (auto entryIt = it->second.find(nodeAndArea);
+        entryIt != it->second.end() and isReachable(nodeAndArea)) {
+      entry = entryIt->second;
+    }
+  }
+  if (entry) {
+    reachablePrefixes_[prefix].insert_or_assign(nodeAndArea, std::move(entry));
+    return;
+  }
+  auto it = reachablePrefixes_.find(prefix);
+  if (it != reachablePrefixes_.end()) {
+    it->second.erase(nodeAndArea);
+    if (it->second.empty()) {
+      reachablePrefixes_.erase(it);
+    }
+  }
+}
+
 std::vector<thrift::ReceivedRouteDetail>
 PrefixState::getReceivedRoutesFiltered(
     thrift::ReceivedRouteFilter const& filter) const {
   std::vector<thrift::ReceivedRouteDetail> routes;
   if (filter.prefixes_ref()) {
     for (auto& prefix : filter.prefixes_ref().value()) {
-      auto it = prefixes_.find(prefix);
+      // malformed prefix of filter matches none
+      const auto key = PackedPrefix::tryFrom(prefix);
+      if (not key.has_value()) {
+        continue;
+      }
+      auto it = prefixes_.find(*key);
       if (it == prefixes_.end()) {
         continue;
       }
@@ -110,22 +269,58 @@ PrefixState::getReceivedRoutesFiltered(
           routes,
           filter.nodeName_ref(),
           filter.areaName_ref(),
-          it->first,
+          prefix,
           it->second);
     }
+  } else if (filter.nodeName_ref() or filter.areaName_ref()) {
+    // Visit only prefixes of matching advertisers
+    for (auto const& prefix : getFilteredNodePrefixes(
+             filter.nodeName_ref(), filter.areaName_ref())) {
+      filterAndAddReceivedRoute(
+          routes,
+          filter.nodeName_ref(),
+          filter.areaName_ref(),
+          prefix,
+          prefixes_.at(prefix));
+    }
   } else {
     for (auto& [prefix, prefixEntries] : prefixes_) {
       filterAndAddReceivedRoute(
           routes,
           filter.nodeName_ref(),
           filter.areaName_ref(),
-          prefix,
+          prefix.toThrift(),
           prefixEntries);
     }
   }
   return routes;
 }
 
+std::set<thrift::IpPrefix>
+PrefixState::getFilteredNodePrefixes(
+    apache::thrift::optional_field_ref<const std::string&> const& nodeFilter,
+    apache::thrift::optional_field_ref<const std::string&> const& areaFilter)
+    const {
+  std::set<thrift::IpPrefix> prefixes;
+  auto const addNodePrefixes = [&](NodeAndArea const& nodeAndArea) {
+    auto const& nodePrefixes = getNodePrefixes(nodeAndArea);
+    prefixes.insert(nodePrefixes.begin(), nodePrefixes.end());
+  };
+  for (auto const& [area, nodes] : areaToNodes_) {
+    if (areaFilter and *areaFilter != area) {
+      continue;
+    }
+    if (nodeFilter) {
+      addNodePrefixes({*nodeFilter, area});
+      continue;
+    }
+    for (auto const& node : nodes) {
+      addNodePrefixes({node, area});
+    }
+  }
+  return prefixes;
+}
+
 void
 PrefixState::filterAndAddReceivedRoute(
     std::vector<thrift::ReceivedRouteDetail>& routes,
@@ -153,7 +348,7 @@ PrefixState::filterAndAddReceivedRoute(
     auto& route = routeDetail.routes_ref()->back();
     route.key_ref()->node_ref() = nodeAndArea.first;
     route.key_ref()->area_ref() = nodeAndArea.second;
-    route.route_ref() = prefixEntry;
+    route.route_ref() = *prefixEntry;
   }
 
   // Add detail if there are entries to return
@@ -174,11 +369,11 @@ PrefixState::hasConflictingForwardingInfo(const PrefixEntries& prefixEntries) {
 
   // Iterate over all entries and make sure the forwarding information agrees
   for (auto& [_, entry] : prefixEntries) {
-    if (firstEntry.forwardingAlgorithm_ref() !=
-        entry.forwardingAlgorithm_ref()) {
+    if (firstEntry->forwardingAlgorithm_ref() !=
+        entry->forwardingAlgorithm_ref()) {
       return true;
     }
-    if (firstEntry.forwardingType_ref() != entry.forwardingType_ref()) {
+    if (firstEntry->forwardingType_ref() != entry->forwardingType_ref()) {
       return true;
     }
   }
@@ -9,10 +9,12 @@
 
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <openr/common/NetworkUtil.h>
 #include <openr/common/Types.h>
+#include <openr/decision/LinkState.h>
 #include <openr/if/gen-cpp2/Decision_types.h>
 #include <openr/if/gen-cpp2/Lsdb_types.h>
 #include <openr/if/gen-cpp2/Network_types.h>
@@ -20,9 +22,13 @@
 
 namespace openr {
 
+/**
+ * Prefix entries of all [node, area] originators. Entries are keyed by
+ * PackedPrefix internally, thrift::IpPrefix is accepted at the API.
+ */
 class PrefixState {
  public:
-  std::unordered_map<thrift::IpPrefix, PrefixEntries> const&
+  std::unordered_map<PackedPrefix, PrefixEntries> const&
   prefixes() const {
     return prefixes_;
   }
@@ -32,9 +38,49 @@ class PrefixState {
   std::unordered_set<thrift::IpPrefix> updatePrefixDatabase(
       thrift::PrefixDatabase const& prefixDb);
 
+  // update entry of a single prefix advertised by [node, area]. Returns true
+  // if it was changed
+  bool updatePrefix(
+      NodeAndArea const& nodeAndArea, thrift::PrefixEntry const& prefixEntry);
+
+  // withdraw a single prefix advertised by [node, area]. Returns true if it
+  // was advertised
+  bool deletePrefix(
+      NodeAndArea const& nodeAndArea, thrift::IpPrefix const& prefix);
+
   std::unordered_map<std::string /* nodeName */, thrift::PrefixDatabase>
   getPrefixDatabases() const;
 
+  // Version of prefix state, changes with every change of prefix entries or
+  // of their reachable-only view
+  uint64_t
+  getVersion() const {
+    return version_;
+  }
+
+  // prefixes advertised by the given node in the given area
+  std::set<thrift::IpPrefix> const& getNodePrefixes(
+      NodeAndArea const& nodeAndArea) const;
+
+  // update reachable-only view of prefix entries with SPF results of
+  // myNodeName. Only advertisers whose reachability changed are revisited
+  // unless the node or set of areas changed
+  void updateReachability(
+      std::string const& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
+  // returns true if reachable-only view reflects SPF results of myNodeName on
+  // given link states
+  bool isReachabilityCurrent(
+      std::string const& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates) const;
+
+  // entries of prefix advertised by reachable nodes, nullptr if there is none.
+  // Entries of areas without reachability information are considered
+  // reachable. Use only if isReachabilityCurrent()
+  PrefixEntries const* getReachablePrefixEntries(
+      PackedPrefix const& prefix) const;
+
   std::vector<thrift::ReceivedRouteDetail> getReceivedRoutesFiltered(
       thrift::ReceivedRouteFilter const& filter) const;
 
@@ -55,23 +101,43 @@ class PrefixState {
   static bool hasConflictingForwardingInfo(PrefixEntries const& prefixEntries);
 
  private:
-  // TODO: Also maintain clean list of reachable prefix entries. A node might
-  // become un-reachable we might still have their prefix entries, until gets
-  // expired in KvStore. This will simplify logic in route computation where
-  // we exclude unreachable nodes.
+  bool isReachable(NodeAndArea const& nodeAndArea) const;
 
-  // TODO: Maintain shared_ptr for `thrift::PrefixEntry` within
-  // `PrefixEntries` to avoid data-copy for best metric selection and
-  // route re-distribution
+  // sync reachable-only view of the entry of [node, area] for prefix
+  void updateReachableEntry(
+      PackedPrefix const& prefix, NodeAndArea const& nodeAndArea);
+
+  // prefixes advertised by [node, area] entries matching node and area filter
+  std::set<thrift::IpPrefix> getFilteredNodePrefixes(
+      apache::thrift::optional_field_ref<const std::string&> const& nodeFilter,
+      apache::thrift::optional_field_ref<const std::string&> const& areaFilter)
+      const;
 
   // Data structure to maintain mapping from:
   //  IpPrefix -> collection of originator(i.e. [node, area] combination)
-  std::unordered_map<thrift::IpPrefix, PrefixEntries> prefixes_;
+  std::unordered_map<PackedPrefix, PrefixEntries> prefixes_;
 
   // (Reverse Mapping) Data structure to maintain mapping from:
   //  [node, area] combination -> set of IpPrefix
   std::unordered_map<NodeAndArea, std::set<thrift::IpPrefix>> nodeToPrefixes_;
 
+  // Nodes of nodeToPrefixes_ per area, to look up prefixes of a node or of
+  // an area without scanning all prefixes
+  std::unordered_map<std::string /* area */, std::unordered_set<std::string>>
+      areaToNodes_;
+
+  // A node might become un-reachable while we still have its prefix entries,
+  // until they get expired in KvStore. Maintain entries of reachable nodes
+  // only, as per SPF results of reachabilityNodeName_ in every area
+  std::unordered_map<PackedPrefix, PrefixEntries> reachablePrefixes_;
+  std::string reachabilityNodeName_;
+  std::unordered_map<std::string /* area */, std::unordered_set<std::string>>
+      reachableNodes_;
+  std::unordered_map<std::string /* area */, uint64_t> reachabilityVersions_;
+
+  // see getVersion()
+  uint64_t version_{0};
+
   // loopbackV4/V6 address for each node
   std::unordered_map<std::string, thrift::BinaryAddress> nodeHostLoopbacksV4_;
   std::unordered_map<std::string, thrift::BinaryAddress> nodeHostLoopbacksV6_;
@@ -13,6 +13,7 @@
 
 #include <folly/IPAddress.h>
 #include <openr/common/NetworkUtil.h>
+#include <openr/decision/NextHopGroup.h>
 #include <openr/if/gen-cpp2/Lsdb_types.h>
 #include <openr/if/gen-cpp2/Network_types.h>
 
@@ -20,14 +21,15 @@ namespace openr {
 
 struct RibEntry {
   // TODO: should this be map<area, nexthops>?
-  std::unordered_set<thrift::NextHopThrift> nexthops;
+  // ATTN: routes with the same next-hops share the interned next-hop group
+  NextHops nexthops;
 
   // constructor
-  explicit RibEntry(std::unordered_set<thrift::NextHopThrift> nexthops)
-      : nexthops(std::move(nexthops)) {}
+  explicit RibEntry(NextHops nexthops) : nexthops(std::move(nexthops)) {}
 
   RibEntry() = default;
 
+  // cheap comparison of interned next-hop groups
   bool
   operator==(const RibEntry& other) const {
     return nexthops == other.nexthops;
@@ -44,14 +46,12 @@ struct RibUnicastEntry : RibEntry {
   // constructor
   explicit RibUnicastEntry(const folly::CIDRNetwork& prefix) : prefix(prefix) {}
 
-  RibUnicastEntry(
-      const folly::CIDRNetwork& prefix,
-      std::unordered_set<thrift::NextHopThrift> nexthops)
+  RibUnicastEntry(const folly::CIDRNetwork& prefix, NextHops nexthops)
       : RibEntry(std::move(nexthops)), prefix(prefix) {}
 
   RibUnicastEntry(
       const folly::CIDRNetwork& prefix,
-      std::unordered_set<thrift::NextHopThrift> nexthops,
+      NextHops nexthops,
       thrift::PrefixEntry bestPrefixEntry,
       const std::string& bestArea,
       bool doNotInstall = false)
@@ -95,15 +95,14 @@ struct RibMplsEntry : RibEntry {
   explicit RibMplsEntry(int32_t label) : label(label) {}
 
   // constructor
-  RibMplsEntry(
-      int32_t label, std::unordered_set<thrift::NextHopThrift> nexthops)
+  RibMplsEntry(int32_t label, NextHops nexthops)
       : RibEntry(std::move(nexthops)), label(label) {}
 
   static RibMplsEntry
   fromThrift(const thrift::MplsRoute& tMpls) {
     return RibMplsEntry(
         *tMpls.topLabel_ref(),
-        std::unordered_set<thrift::NextHopThrift>(
+        NextHopSet(
             tMpls.nextHops_ref()->begin(), tMpls.nextHops_ref()->end()));
   }
 
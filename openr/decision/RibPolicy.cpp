@@ -128,6 +128,13 @@ RibPolicy::RibPolicy(thrift::RibPolicy const& policy)
   for (auto const& statement : *policy.statements_ref()) {
     policyStatements_.emplace_back(RibPolicyStatement(statement));
   }
+
+  // Index statements by matched prefix
+  for (size_t i = 0; i < policyStatements_.size(); ++i) {
+    for (auto const& prefix : policyStatements_.at(i).getPrefixSet()) {
+      prefixToStatements_[prefix].emplace_back(i);
+    }
+  }
 }
 
 thrift::RibPolicy
@@ -160,40 +167,75 @@ RibPolicy::isActive() const {
 
 bool
 RibPolicy::match(const RibUnicastEntry& route) const {
-  for (auto const& statement : policyStatements_) {
-    if (statement.match(route)) {
-      return true;
-    }
-  }
-  return false;
+  return prefixToStatements_.count(route.prefix) > 0;
 }
 
 bool
 RibPolicy::applyAction(RibUnicastEntry& route) const {
-  for (auto const& statement : policyStatements_) {
-    if (statement.applyAction(route)) {
+  auto it = prefixToStatements_.find(route.prefix);
+  if (it == prefixToStatements_.end()) {
+    return false;
+  }
+  // Statement may not transform the route e.g. if its action invalidates all
+  // next-hops. Try matching statements in order then
+  for (auto const i : it->second) {
+    if (policyStatements_.at(i).applyAction(route)) {
       return true;
     }
   }
   return false;
 }
 
+std::vector<folly::CIDRNetwork>
+RibPolicy::getMatchedPrefixes() const {
+  std::vector<folly::CIDRNetwork> prefixes;
+  prefixes.reserve(prefixToStatements_.size());
+  for (auto const& [prefix, _] : prefixToStatements_) {
+    prefixes.emplace_back(prefix);
+  }
+  return prefixes;
+}
+
 RibPolicy::PolicyChange
 RibPolicy::applyPolicy(std::unordered_map<folly::CIDRNetwork, RibUnicastEntry>&
                            unicastEntries) const {
+  return applyPolicyImpl(unicastEntries);
+}
+
+RibPolicy::PolicyChange
+RibPolicy::applyPolicy(
+    std::unordered_map<PackedPrefix, RibUnicastEntry>& unicastEntries) const {
+  return applyPolicyImpl(unicastEntries);
+}
+
+template <typename UnicastEntries>
+RibPolicy::PolicyChange
+RibPolicy::applyPolicyImpl(UnicastEntries& unicastEntries) const {
   PolicyChange change;
   if (not isActive()) {
     return change;
   }
-  auto iter = unicastEntries.begin();
-  while (iter != unicastEntries.end()) {
-    if (applyAction(iter->second)) {
-      DCHECK(iter->second.nexthops.size()) << "Unexpected empty next-hops";
-      change.updatedRoutes.push_back(iter->second.prefix);
+  auto applyToEntry = [this, &change](RibUnicastEntry& entry) {
+    if (applyAction(entry)) {
+      DCHECK(entry.nexthops.size()) << "Unexpected empty next-hops";
+      change.updatedRoutes.push_back(entry.prefix);
       VLOG(2) << "RibPolicy transformed the route "
-              << folly::IPAddress::networkToString(iter->second.prefix);
+              << folly::IPAddress::networkToString(entry.prefix);
+    }
+  };
+
+  // Walk the smaller of policy prefixes and routes
+  if (prefixToStatements_.size() < unicastEntries.size()) {
+    for (auto const& [prefix, _] : prefixToStatements_) {
+      auto iter = unicastEntries.find(prefix);
+      if (iter != unicastEntries.end()) {
+        applyToEntry(iter->second);
+      }
+    }
+  } else {
+    for (auto& [_, entry] : unicastEntries) {
+      applyToEntry(entry);
     }
-    ++iter;
   }
   return change;
 }
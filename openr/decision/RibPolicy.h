@@ -42,6 +42,14 @@ class RibPolicyStatement {
    */
   bool applyAction(RibUnicastEntry& route) const;
 
+  /**
+   * Prefixes matched by the policy statement
+   */
+  std::unordered_set<folly::CIDRNetwork> const&
+  getPrefixSet() const {
+    return prefixSet_;
+  }
+
  private:
   const std::string name_;
 
@@ -106,11 +114,27 @@ class RibPolicy {
   PolicyChange applyPolicy(
       std::unordered_map<folly::CIDRNetwork, RibUnicastEntry>& unicastEntries)
       const;
+  PolicyChange applyPolicy(
+      std::unordered_map<PackedPrefix, RibUnicastEntry>& unicastEntries) const;
+
+  /**
+   * Prefixes matched by any of the policy statements
+   */
+  std::vector<folly::CIDRNetwork> getMatchedPrefixes() const;
 
  private:
+  template <typename UnicastEntries>
+  PolicyChange applyPolicyImpl(UnicastEntries& unicastEntries) const;
+
   // List of policy statements
   std::vector<RibPolicyStatement> policyStatements_;
 
+  // Policy statements compiled into an index of matched prefix -> indices of
+  // matching statements in order of policyStatements_. Lookup of a route is
+  // independent of the number of statements
+  std::unordered_map<folly::CIDRNetwork, std::vector<size_t>>
+      prefixToStatements_;
+
   // Validity
   const std::chrono::steady_clock::time_point validUntilTs_;
 };
@@ -0,0 +1,222 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/decision/RouteDamping.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <fb303/ServiceData.h>
+#include <glog/logging.h>
+
+#include <openr/common/NetworkUtil.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+namespace {
+
+// Next-hops of `programmed` which `nexthops` still has, compared by address
+// so that metric changes of remaining next-hops are left out
+NextHopSet
+getRemainingNextHops(NextHops const& programmed, NextHops const& nexthops) {
+  NextHopSet remaining;
+  for (auto const& nh : programmed) {
+    auto it = std::find_if(
+        nexthops.begin(), nexthops.end(), [&](auto const& other) {
+          return *other.address_ref() == *nh.address_ref();
+        });
+    if (it != nexthops.end()) {
+      remaining.emplace(nh);
+    }
+  }
+  return remaining;
+}
+
+} // namespace
+
+RouteDamping::RouteDamping(thrift::RouteDampingConfig const& config)
+    : config_(config),
+      halfLife_(std::chrono::seconds(*config.half_life_s_ref())),
+      maxPenalty_(
+          *config.reuse_threshold_ref() *
+          std::exp2(
+              static_cast<double>(*config.max_suppress_time_s_ref()) /
+              *config.half_life_s_ref())) {}
+
+double
+RouteDamping::getPenalty(
+    DampingState const& state, Clock::time_point now) const {
+  const std::chrono::duration<double> elapsed = now - state.updateTime;
+  return state.penalty * std::exp2(-(elapsed / halfLife_));
+}
+
+bool
+RouteDamping::hold(
+    folly::CIDRNetwork const& prefix,
+    std::optional<RibUnicastEntry> route,
+    bool penalize,
+    Clock::time_point now) {
+  auto it = prefixes_.find(prefix);
+  if (it == prefixes_.end()) {
+    if (not penalize) {
+      return false;
+    }
+    it = prefixes_.emplace(prefix, DampingState()).first;
+  }
+  auto& state = it->second;
+
+  // Full rebuilds report held back changes again, they don't count twice
+  if (state.suppressed and state.heldRoute == route) {
+    return true;
+  }
+
+  if (penalize) {
+    state.penalty = std::min(
+        getPenalty(state, now) + *config_.penalty_ref(), maxPenalty_);
+    state.updateTime = now;
+    if (not state.suppressed and
+        state.penalty > *config_.suppress_threshold_ref()) {
+      LOG(INFO) << "Suppressing route changes of flapping prefix "
+                << folly::IPAddress::networkToString(prefix) << ", penalty "
+                << state.penalty;
+      fb303::fbData->addStatValue(
+          "decision.route_damping.suppressed", 1, fb303::COUNT);
+      state.suppressed = true;
+      ++numSuppressed_;
+    }
+  }
+  if (not state.suppressed) {
+    return false;
+  }
+
+  state.heldRoute = std::move(route);
+  return true;
+}
+
+void
+RouteDamping::apply(
+    DecisionRouteUpdate& update,
+    std::unordered_map<folly::CIDRNetwork, RibUnicastEntry> const&
+        unicastRoutes,
+    Clock::time_point now) {
+  // Withdrawals remove all next-hops and are never held back
+  for (auto const& prefix : update.unicastRoutesToDelete) {
+    if (hold(prefix, std::nullopt, true, now)) {
+      fb303::fbData->addStatValue(
+          "decision.route_damping.next_hops_removed", 1, fb303::SUM);
+    }
+  }
+
+  std::vector<folly::CIDRNetwork> toDelete;
+  for (auto it = update.unicastRoutesToUpdate.begin();
+       it != update.unicastRoutesToUpdate.end();) {
+    auto const& prefix = it->first;
+    auto programmed = unicastRoutes.find(prefix);
+    // NOTE: announcement of a new prefix is not a flap, its withdrawal is
+    if (not hold(prefix, it->second, programmed != unicastRoutes.end(), now)) {
+      ++it;
+      continue;
+    }
+
+    // Hold back additions of next-hops and metric changes only, next-hops
+    // which are gone are removed from the programmed route
+    if (programmed == unicastRoutes.end()) {
+      fb303::fbData->addStatValue(
+          "decision.route_damping.held_routes", 1, fb303::SUM);
+      it = update.unicastRoutesToUpdate.erase(it);
+      continue;
+    }
+    NextHops remaining =
+        getRemainingNextHops(programmed->second.nexthops, it->second.nexthops);
+    if (remaining == programmed->second.nexthops) {
+      fb303::fbData->addStatValue(
+          "decision.route_damping.held_routes", 1, fb303::SUM);
+      it = update.unicastRoutesToUpdate.erase(it);
+      continue;
+    }
+    fb303::fbData->addStatValue(
+        "decision.route_damping.next_hops_removed", 1, fb303::SUM);
+    if (remaining == it->second.nexthops) {
+      // removal of next-hops only, nothing to hold back
+      ++it;
+      continue;
+    }
+    fb303::fbData->addStatValue(
+        "decision.route_damping.held_routes", 1, fb303::SUM);
+    if (remaining.empty()) {
+      toDelete.emplace_back(prefix);
+      it = update.unicastRoutesToUpdate.erase(it);
+    } else {
+      it->second = programmed->second;
+      it->second.nexthops = std::move(remaining);
+      ++it;
+    }
+  }
+  update.unicastRoutesToDelete.insert(
+      update.unicastRoutesToDelete.end(), toDelete.begin(), toDelete.end());
+}
+
+std::vector<folly::CIDRNetwork>
+RouteDamping::reuse(Clock::time_point now) {
+  std::vector<folly::CIDRNetwork> reused;
+  for (auto it = prefixes_.begin(); it != prefixes_.end();) {
+    auto& [prefix, state] = *it;
+    const auto penalty = getPenalty(state, now);
+    if (state.suppressed and penalty < *config_.reuse_threshold_ref()) {
+      LOG(INFO) << "Reusing prefix "
+                << folly::IPAddress::networkToString(prefix) << ", penalty "
+                << penalty;
+      fb303::fbData->addStatValue(
+          "decision.route_damping.reused", 1, fb303::COUNT);
+      state.suppressed = false;
+      state.heldRoute.reset();
+      --numSuppressed_;
+      reused.emplace_back(prefix);
+    }
+    if (not state.suppressed and
+        penalty < *config_.reuse_threshold_ref() / 2.0) {
+      it = prefixes_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return reused;
+}
+
+std::vector<thrift::RouteDampingState>
+RouteDamping::getStates(Clock::time_point now) const {
+  std::vector<thrift::RouteDampingState> states;
+  states.reserve(prefixes_.size());
+  for (auto const& [prefix, state] : prefixes_) {
+    auto& dampingState = states.emplace_back();
+    dampingState.prefix_ref() = toIpPrefix(prefix);
+    const auto penalty = getPenalty(state, now);
+    dampingState.penalty_ref() = penalty;
+    dampingState.suppressed_ref() = state.suppressed;
+    if (state.suppressed) {
+      const auto reuseIn = halfLife_ *
+          std::log2(
+              std::max(1.0, penalty / *config_.reuse_threshold_ref()));
+      dampingState.reuseInMs_ref() =
+          std::chrono::ceil<std::chrono::milliseconds>(reuseIn).count();
+    }
+  }
+  return states;
+}
+
+double
+RouteDamping::getMaxPenalty(Clock::time_point now) const {
+  double maxPenalty{0};
+  for (auto const& [_, state] : prefixes_) {
+    maxPenalty = std::max(maxPenalty, getPenalty(state, now));
+  }
+  return maxPenalty;
+}
+
+} // namespace openr
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/IPAddress.h>
+
+#include <openr/decision/RibEntry.h>
+#include <openr/decision/RouteUpdate.h>
+#include <openr/if/gen-cpp2/Decision_types.h>
+#include <openr/if/gen-cpp2/OpenrConfig_types.h>
+
+namespace openr {
+
+/**
+ * Flap damping of unicast routes, like BGP route flap damping (RFC 2439).
+ *
+ * Every change of the route of a prefix, i.e. its withdrawal or a change of
+ * its next-hops, adds `penalty` to the prefix. Penalty decays exponentially
+ * with `half_life_s`. Once it exceeds `suppress_threshold`, additions of
+ * next-hops and metric changes are held back and Fib keeps the route it has,
+ * next-hops which are gone are still removed from it. When penalty decays
+ * below `reuse_threshold` the prefix is reused and its latest route gets
+ * programmed. Penalty is capped so that a prefix which stops flapping is
+ * reused within `max_suppress_time_s`.
+ *
+ * Not thread-safe, used from Decision thread only
+ */
+class RouteDamping {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit RouteDamping(thrift::RouteDampingConfig const& config);
+
+  /**
+   * Penalize prefixes whose routes `update` changes against `unicastRoutes`,
+   * the routes Fib has, and hold back changes of suppressed prefixes. Routes
+   * of suppressed prefixes are updated to the next-hops Fib has and the new
+   * route still has, or withdrawn if none. New prefixes are not penalized but
+   * their routes are held back as well if suppressed
+   */
+  void apply(
+      DecisionRouteUpdate& update,
+      std::unordered_map<folly::CIDRNetwork, RibUnicastEntry> const&
+          unicastRoutes,
+      Clock::time_point now = Clock::now());
+
+  /**
+   * End suppression of prefixes whose penalty decayed below reuse threshold
+   * and return them, their routes are to be rebuilt. Forgets prefixes whose
+   * penalty decayed to less than half of reuse threshold
+   */
+  std::vector<folly::CIDRNetwork> reuse(Clock::time_point now = Clock::now());
+
+  // Damping state of penalized prefixes, penalties decayed to `now`
+  std::vector<thrift::RouteDampingState> getStates(
+      Clock::time_point now = Clock::now()) const;
+
+  bool
+  isSuppressed(folly::CIDRNetwork const& prefix) const {
+    auto it = prefixes_.find(prefix);
+    return it != prefixes_.end() and it->second.suppressed;
+  }
+
+  // Number of penalized prefixes, suppressed or not
+  size_t
+  getNumPrefixes() const {
+    return prefixes_.size();
+  }
+
+  size_t
+  getNumSuppressed() const {
+    return numSuppressed_;
+  }
+
+  // Highest penalty of any prefix, decayed to `now`
+  double getMaxPenalty(Clock::time_point now = Clock::now()) const;
+
+ private:
+  struct DampingState {
+    // penalty as of `updateTime`
+    double penalty{0};
+    Clock::time_point updateTime;
+    bool suppressed{false};
+    // latest route while suppressed, std::nullopt for withdrawal
+    std::optional<RibUnicastEntry> heldRoute;
+  };
+
+  double getPenalty(DampingState const& state, Clock::time_point now) const;
+
+  // Penalize change of route of prefix if `penalize` and remember the route
+  // if suppressed. Returns true if suppressed
+  bool hold(
+      folly::CIDRNetwork const& prefix,
+      std::optional<RibUnicastEntry> route,
+      bool penalize,
+      Clock::time_point now);
+
+  const thrift::RouteDampingConfig config_;
+  const std::chrono::duration<double> halfLife_;
+  // penalty from which a prefix is reused after max_suppress_time_s
+  const double maxPenalty_{0};
+
+  std::unordered_map<folly::CIDRNetwork, DampingState> prefixes_;
+  size_t numSuppressed_{0};
+};
+
+} // namespace openr
@@ -8,9 +8,13 @@
 #pragma once
 
 #include <list>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <folly/IPAddress.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 #include <openr/common/Util.h>
 #include <openr/decision/RibEntry.h>
 #include <openr/decision/RibPolicy.h>
@@ -18,6 +22,42 @@
 
 namespace openr {
 
+namespace detail {
+/**
+ * Value computed on first use and shared with all later users, from any
+ * thread. Copies of the owner don't share it and compute their own, as the
+ * owner may be modified after copying
+ */
+template <typename T>
+class Memoized {
+ public:
+  Memoized() = default;
+
+  Memoized(Memoized const&) {}
+
+  Memoized&
+  operator=(Memoized const&) {
+    std::lock_guard<std::mutex> l(mutex_);
+    value_ = nullptr;
+    return *this;
+  }
+
+  template <typename F>
+  std::shared_ptr<const T>
+  get(F&& compute) const {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (not value_) {
+      value_ = std::make_shared<const T>(compute());
+    }
+    return value_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  mutable std::shared_ptr<const T> value_;
+};
+} // namespace detail
+
 // Route updates published by Decision
 // consumed by PrefixManager, BgpSpeaker, Fib.
 struct DecisionRouteUpdate {
@@ -42,7 +82,7 @@ struct DecisionRouteUpdate {
   }
 
   thrift::RouteDatabaseDelta
-  toThrift() {
+  toThrift() const {
     thrift::RouteDatabaseDelta delta;
 
     // unicast
@@ -61,6 +101,33 @@ struct DecisionRouteUpdate {
 
     return delta;
   }
+
+  /**
+   * Thrift form of the update, converted once and shared by all readers of
+   * the published update. The update must not be modified after the first
+   * call
+   */
+  std::shared_ptr<const thrift::RouteDatabaseDelta>
+  getThrift() const {
+    return thrift_.get([this]() { return toThrift(); });
+  }
+
+  // Thrift form of the update serialized with CompactSerializer, memoized
+  // like getThrift()
+  std::shared_ptr<const std::string>
+  getThriftSerialized() const {
+    return thriftSerialized_.get([this]() {
+      apache::thrift::CompactSerializer serializer;
+      return writeThriftObjStr(*getThrift(), serializer);
+    });
+  }
+
+ private:
+  detail::Memoized<thrift::RouteDatabaseDelta> thrift_;
+  detail::Memoized<std::string> thriftSerialized_;
 };
 
+// Route updates are shared by all readers of route updates queue
+using DecisionRouteUpdatePtr = std::shared_ptr<const DecisionRouteUpdate>;
+
 } // namespace openr
@@ -27,6 +27,19 @@ BENCHMARK_COUNTERS_PARAM(BM_DecisionGrid, counters, 1000, KSP2_ED_ECMP);
 BENCHMARK_COUNTERS_PARAM(BM_DecisionFabric, counters, 344, SP_ECMP);
 BENCHMARK_COUNTERS_PARAM(BM_DecisionFabric, counters, 1000, SP_ECMP);
 BENCHMARK_COUNTERS_PARAM(BM_DecisionFabric, counters, 5000, SP_ECMP);
+
+// The integer parameter is the number of nodes in converged grid topology
+// the event is replayed on
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 1024, LINK_FLAP);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 10000, LINK_FLAP);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 1024, METRIC_CHANGE);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 10000, METRIC_CHANGE);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 1024, NODE_OVERLOAD);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 10000, NODE_OVERLOAD);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 1024, PREFIX_CHURN);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 10000, PREFIX_CHURN);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 1024, RIB_POLICY);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionGridEvent, counters, 10000, RIB_POLICY);
 } // namespace openr
 
 int
@@ -5,7 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
 #include <memory>
+#include <unistd.h>
 
 #include <fb303/ServiceData.h>
 #include <folly/IPAddress.h>
@@ -666,6 +670,190 @@ TEST(SpfSolver, AdjacencyUpdate) {
   }
 }
 
+//
+// Prefixes advertised by the same node share next-hops computed once. Cached
+// next-hops are invalidated on change of local links or of shortest paths
+// towards the advertisers
+//
+TEST(SpfSolver, NextHopsCache) {
+  auto adjacencyDb1 = createAdjDb("1", {adj12}, 1);
+  auto adjacencyDb2 = createAdjDb("2", {adj21, adj23}, 2);
+  auto adjacencyDb3 = createAdjDb("3", {adj32}, 3);
+
+  const std::string nodeName("1");
+  SpfSolver spfSolver(
+      nodeName, false /* disable v4 */, false /* disable LFA */);
+
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  areaLinkStates.emplace(kTestingAreaName, LinkState(kTestingAreaName));
+  auto& linkState = areaLinkStates.at(kTestingAreaName);
+  PrefixState prefixState;
+
+  linkState.updateAdjacencyDatabase(adjacencyDb1);
+  linkState.updateAdjacencyDatabase(adjacencyDb2);
+  linkState.updateAdjacencyDatabase(adjacencyDb3);
+  prefixState.updatePrefixDatabase(createPrefixDb(
+      "3",
+      {createPrefixEntry(addr3),
+       createPrefixEntry(addr4),
+       createPrefixEntry(addr5)}));
+
+  fb303::fbData->resetAllData();
+  auto routeDb = spfSolver.buildRouteDb(nodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(routeDb.has_value());
+  ASSERT_EQ(3, routeDb->unicastRoutes.size());
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.at("decision.nexthops_cache.misses.count.60"));
+  EXPECT_EQ(2, counters.at("decision.nexthops_cache.hits.count.60"));
+
+  // all routes refer to the same next-hops
+  auto const& route3 = routeDb->unicastRoutes.at(toIPNetwork(addr3));
+  ASSERT_EQ(1, route3.nexthops.size());
+  EXPECT_EQ(
+      *adj12.nextHopV6_ref(), *route3.nexthops.begin()->address_ref());
+  for (auto const& addr : {addr4, addr5}) {
+    EXPECT_EQ(
+        route3.nexthops.group(),
+        routeDb->unicastRoutes.at(toIPNetwork(addr)).nexthops.group());
+  }
+
+  // cache is retained while link state is unchanged
+  routeDb = spfSolver.buildRouteDb(nodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(routeDb.has_value());
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.at("decision.nexthops_cache.misses.count.60"));
+  EXPECT_EQ(5, counters.at("decision.nexthops_cache.hits.count.60"));
+
+  // link attribute change invalidates the cache
+  *adjacencyDb1.adjacencies_ref()[0].nextHopV6_ref() =
+      toBinaryAddress("fe80::1234:b00c");
+  EXPECT_TRUE(
+      linkState.updateAdjacencyDatabase(adjacencyDb1).linkAttributesChanged);
+  routeDb = spfSolver.buildRouteDb(nodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(routeDb.has_value());
+  ASSERT_EQ(3, routeDb->unicastRoutes.size());
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(2, counters.at("decision.nexthops_cache.misses.count.60"));
+  EXPECT_EQ(7, counters.at("decision.nexthops_cache.hits.count.60"));
+  for (auto const& addr : {addr3, addr4, addr5}) {
+    auto const& route = routeDb->unicastRoutes.at(toIPNetwork(addr));
+    ASSERT_EQ(1, route.nexthops.size());
+    EXPECT_EQ(
+        toBinaryAddress("fe80::1234:b00c"),
+        *route.nexthops.begin()->address_ref());
+  }
+
+  // topology change which leaves shortest paths towards 3 unchanged keeps
+  // the cache
+  auto adjacencyDb4 = createAdjDb("4", {adj43}, 4);
+  adjacencyDb3 = createAdjDb("3", {adj32, adj34}, 3);
+  EXPECT_TRUE(linkState.updateAdjacencyDatabase(adjacencyDb3).topologyChanged);
+  EXPECT_TRUE(linkState.updateAdjacencyDatabase(adjacencyDb4).topologyChanged);
+  routeDb = spfSolver.buildRouteDb(nodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(routeDb.has_value());
+  ASSERT_EQ(3, routeDb->unicastRoutes.size());
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(2, counters.at("decision.nexthops_cache.misses.count.60"));
+  EXPECT_EQ(10, counters.at("decision.nexthops_cache.hits.count.60"));
+
+  // metric change on shortest path towards 3 invalidates the cache
+  adjacencyDb2.adjacencies_ref()[1].metric_ref() = 20;
+  EXPECT_TRUE(linkState.updateAdjacencyDatabase(adjacencyDb2).topologyChanged);
+  routeDb = spfSolver.buildRouteDb(nodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(routeDb.has_value());
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(3, counters.at("decision.nexthops_cache.misses.count.60"));
+  EXPECT_EQ(12, counters.at("decision.nexthops_cache.hits.count.60"));
+  for (auto const& addr : {addr3, addr4, addr5}) {
+    auto const& route = routeDb->unicastRoutes.at(toIPNetwork(addr));
+    ASSERT_EQ(1, route.nexthops.size());
+    EXPECT_EQ(30, *route.nexthops.begin()->metric_ref());
+  }
+}
+
+//
+// Thrift forms of route update are converted once and shared, copies of the
+// update convert their own
+//
+TEST(DecisionRouteUpdate, MemoizedThrift) {
+  const auto nh1 = createNextHop(toBinaryAddress("fe80::1"), "iface1", 1);
+  DecisionRouteUpdate update;
+  update.addRouteToUpdate(RibUnicastEntry(toIPNetwork(addr1), {nh1}));
+  update.unicastRoutesToDelete.emplace_back(toIPNetwork(addr2));
+  update.mplsRoutesToUpdate.emplace_back(RibMplsEntry(1, {nh1}));
+  update.mplsRoutesToDelete.emplace_back(2);
+
+  auto const thriftDelta = update.getThrift();
+  EXPECT_EQ(update.toThrift(), *thriftDelta);
+  EXPECT_EQ(thriftDelta, update.getThrift());
+
+  auto const serialized = update.getThriftSerialized();
+  EXPECT_EQ(serialized, update.getThriftSerialized());
+  CompactSerializer serializer;
+  EXPECT_EQ(
+      *thriftDelta,
+      readThriftObjStr<thrift::RouteDatabaseDelta>(*serialized, serializer));
+
+  auto copy = update;
+  copy.mplsRoutesToDelete.emplace_back(3);
+  EXPECT_NE(thriftDelta, copy.getThrift());
+  EXPECT_EQ(copy.toThrift(), *copy.getThrift());
+  EXPECT_EQ(*thriftDelta, *update.getThrift());
+}
+
+TEST(DecisionRouteDb, CalculateUpdate) {
+  const auto nh1 = createNextHop(toBinaryAddress("fe80::1"), "iface1", 1);
+  const auto nh2 = createNextHop(toBinaryAddress("fe80::2"), "iface2", 1);
+  const auto prefix1 = toIPNetwork(addr1);
+  const auto prefix2 = toIPNetwork(addr2);
+  const auto prefix3 = toIPNetwork(addr3);
+
+  DecisionRouteDb oldDb;
+  oldDb.addUnicastRoute(RibUnicastEntry(prefix1, {nh1}));
+  oldDb.addUnicastRoute(RibUnicastEntry(prefix2, {nh1}));
+  oldDb.addMplsRoute(RibMplsEntry(1, {nh1}));
+  oldDb.addMplsRoute(RibMplsEntry(2, {nh1}));
+
+  // no change
+  {
+    auto newDb = oldDb;
+    auto update = oldDb.calculateUpdate(std::move(newDb));
+    EXPECT_TRUE(update.unicastRoutesToUpdate.empty());
+    EXPECT_TRUE(update.unicastRoutesToDelete.empty());
+    EXPECT_TRUE(update.mplsRoutesToUpdate.empty());
+    EXPECT_TRUE(update.mplsRoutesToDelete.empty());
+  }
+
+  // changed, added and deleted routes
+  {
+    DecisionRouteDb newDb;
+    newDb.addUnicastRoute(RibUnicastEntry(prefix1, {nh1}));
+    newDb.addUnicastRoute(RibUnicastEntry(prefix2, {nh1, nh2}));
+    newDb.addUnicastRoute(RibUnicastEntry(prefix3, {nh2}));
+    newDb.addMplsRoute(RibMplsEntry(2, {nh2}));
+    auto update = oldDb.calculateUpdate(std::move(newDb));
+    EXPECT_EQ(2, update.unicastRoutesToUpdate.size());
+    EXPECT_EQ(1, update.unicastRoutesToUpdate.count(prefix2));
+    EXPECT_EQ(1, update.unicastRoutesToUpdate.count(prefix3));
+    EXPECT_TRUE(update.unicastRoutesToDelete.empty());
+    ASSERT_EQ(1, update.mplsRoutesToUpdate.size());
+    EXPECT_EQ(RibMplsEntry(2, {nh2}), update.mplsRoutesToUpdate.at(0));
+    EXPECT_THAT(update.mplsRoutesToDelete, testing::ElementsAre(1));
+  }
+
+  // deleted routes only
+  {
+    DecisionRouteDb newDb;
+    newDb.addUnicastRoute(RibUnicastEntry(prefix2, {nh1}));
+    auto update = oldDb.calculateUpdate(std::move(newDb));
+    EXPECT_TRUE(update.unicastRoutesToUpdate.empty());
+    EXPECT_THAT(update.unicastRoutesToDelete, testing::ElementsAre(prefix1));
+    EXPECT_TRUE(update.mplsRoutesToUpdate.empty());
+    EXPECT_THAT(
+        update.mplsRoutesToDelete, testing::UnorderedElementsAre(1, 2));
+  }
+}
+
 //
 // Node-1 connects to 2 but 2 doesn't report bi-directionality
 // Node-2 and Node-3 are bi-directionally connected
@@ -715,6 +903,75 @@ TEST(MplsRoutes, BasicTest) {
   validateAdjLabelRoutes(routeMap, "3", {adj32});
 }
 
+/**
+ * Node label routes are reused across route builds of the same SpfSolver.
+ * Verify they are the same as the ones of a fresh SpfSolver after every
+ * change of labels and topology
+ */
+TEST(MplsRoutes, ReuseNodeLabelRoutes) {
+  const std::string nodeName("1");
+  SpfSolver spfSolver(
+      nodeName, false /* disable v4 */, false /* disable LFA */);
+
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  areaLinkStates.emplace(kTestingAreaName, LinkState(kTestingAreaName));
+  auto& linkState = areaLinkStates.at(kTestingAreaName);
+  PrefixState prefixState;
+
+  // box
+  //
+  //   1--2
+  //   |  |
+  //   3--4
+  //
+  auto adjacencyDb1 = createAdjDb("1", {adj12, adj13}, 1);
+  auto adjacencyDb2 = createAdjDb("2", {adj21, adj24}, 2);
+  auto adjacencyDb3 = createAdjDb("3", {adj31, adj34}, 3);
+  auto adjacencyDb4 = createAdjDb("4", {adj42, adj43}, 4);
+  for (auto const& adjDb :
+       {adjacencyDb1, adjacencyDb2, adjacencyDb3, adjacencyDb4}) {
+    linkState.updateAdjacencyDatabase(adjDb);
+  }
+
+  auto verifyMplsRoutes = [&](size_t expectedNumRoutes) {
+    SpfSolver freshSpfSolver(
+        nodeName, false /* disable v4 */, false /* disable LFA */);
+    auto expected =
+        freshSpfSolver.buildRouteDb(nodeName, areaLinkStates, prefixState);
+    auto actual = spfSolver.buildRouteDb(nodeName, areaLinkStates, prefixState);
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(actual.has_value());
+    EXPECT_EQ(expectedNumRoutes, expected->mplsRoutes.size());
+    EXPECT_EQ(expected->mplsRoutes, actual->mplsRoutes);
+  };
+
+  // 4 node labels and 2 adjacency labels
+  verifyMplsRoutes(6);
+  // no change
+  verifyMplsRoutes(6);
+
+  // metric change makes paths towards 4 go through 3 only
+  auto adj12Metric = adj12;
+  adj12Metric.metric_ref() = 20;
+  adjacencyDb1 = createAdjDb("1", {adj12Metric, adj13}, 1);
+  linkState.updateAdjacencyDatabase(adjacencyDb1);
+  verifyMplsRoutes(6);
+  EXPECT_EQ(
+      1,
+      spfSolver.buildRouteDb(nodeName, areaLinkStates, prefixState)
+          ->mplsRoutes.at(4)
+          .nexthops.size());
+
+  // node label change of 4
+  adjacencyDb4 = createAdjDb("4", {adj42, adj43}, 44);
+  linkState.updateAdjacencyDatabase(adjacencyDb4);
+  verifyMplsRoutes(6);
+
+  // 3 goes away, 4 is reachable over 2 again
+  linkState.deleteAdjacencyDatabase("3");
+  verifyMplsRoutes(4);
+}
+
 TEST(BGPRedistribution, BasicOperation) {
   std::string nodeName("1");
   SpfSolver spfSolver(
@@ -1260,7 +1517,7 @@ TEST_P(ConnectivityTest, GraphConnectedOrPartitioned) {
   bool foundRouteNodeLabel = false;
   if (routeDb.has_value()) {
     for (auto const& [prefix, _] : routeDb->unicastRoutes) {
-      if (toIpPrefix(prefix) == addr3) {
+      if (prefix.toThrift() == addr3) {
         foundRouteV6 = true;
         break;
       }
@@ -2666,6 +2923,20 @@ TEST_P(SimpleRingTopologyFixture, Ksp2EdEcmpForBGP) {
                     toBinaryAddress("1.1.1.1"), std::nullopt, 0, std::nullopt),
                 createNextHopFromAdj(adj13, v4Enabled, 30, push24),
                 createNextHopFromAdj(adj12, v4Enabled, 10, std::nullopt)}));
+
+  // Only route of node 1 towards the prefix resolves through static route
+  EXPECT_THAT(
+      spfSolver->getPrefixesDependingOnStaticRoutes(
+          "1", areaLinkStates, prefixState, {staticMplsRouteLabel}),
+      testing::UnorderedElementsAre(v4Enabled ? bgpAddr1V4 : bgpAddr1));
+  EXPECT_TRUE(spfSolver
+                  ->getPrefixesDependingOnStaticRoutes(
+                      "3", areaLinkStates, prefixState, {staticMplsRouteLabel})
+                  .empty());
+  EXPECT_TRUE(spfSolver
+                  ->getPrefixesDependingOnStaticRoutes(
+                      "1", areaLinkStates, prefixState, {60001})
+                  .empty());
 }
 
 TEST_P(SimpleRingTopologyFixture, Ksp2EdEcmpForBGP123) {
@@ -4362,6 +4633,178 @@ TEST_P(GridTopologyFixture, ShortestPathTest) {
   EXPECT_EQ(gridDistance(src, dst, n), *nextHops.begin()->metric_ref());
 }
 
+// routes computed on worker threads must be the same as computed serially
+TEST_P(GridTopologyFixture, ParallelRouteComputation) {
+  SpfSolver parallelSpfSolver(
+      nodeName,
+      false /* disable v4 */,
+      true /* enable LFA */,
+      false /* disable ordered fib */,
+      false /* bgpDryRun */,
+      false /* disable best route selection */,
+      4 /* routeComputationThreads */);
+  SpfSolver serialSpfSolver(nodeName, false, true);
+
+  // advertise more prefixes from every node, half of them with KSP2, to have
+  // large grids computed in multiple chunks
+  const int kNumExtraPrefixes = 10;
+  for (int node = 0; node < n * n; ++node) {
+    std::vector<thrift::PrefixEntry> prefixEntries{
+        createPrefixEntry(toIpPrefix(nodeToPrefixV6(node)))};
+    for (int k = 0; k < kNumExtraPrefixes; ++k) {
+      auto entry = createPrefixEntry(
+          toIpPrefix(folly::sformat("fc00::{}:{}/128", node, k)));
+      if (k % 2) {
+        entry.forwardingType_ref() = thrift::PrefixForwardingType::SR_MPLS;
+        entry.forwardingAlgorithm_ref() =
+            thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP;
+      }
+      prefixEntries.emplace_back(std::move(entry));
+    }
+    prefixState.updatePrefixDatabase(
+        createPrefixDb(folly::sformat("{}", node), prefixEntries));
+  }
+
+  for (auto const& node : {0, n * n / 2, n * n - 1}) {
+    auto const& myNodeName = folly::sformat("{}", node);
+    auto serialRouteDb =
+        serialSpfSolver.buildRouteDb(myNodeName, areaLinkStates, prefixState);
+    auto parallelRouteDb = parallelSpfSolver.buildRouteDb(
+        myNodeName, areaLinkStates, prefixState);
+    ASSERT_TRUE(serialRouteDb.has_value());
+    ASSERT_TRUE(parallelRouteDb.has_value());
+    // route to every prefix of every other node
+    EXPECT_EQ(
+        (n * n - 1) * (1 + kNumExtraPrefixes),
+        parallelRouteDb->unicastRoutes.size());
+    EXPECT_EQ(serialRouteDb->unicastRoutes, parallelRouteDb->unicastRoutes);
+    EXPECT_EQ(serialRouteDb->mplsRoutes, parallelRouteDb->mplsRoutes);
+    EXPECT_EQ(
+        serialSpfSolver.getBestRoutesCache().size(),
+        parallelSpfSolver.getBestRoutesCache().size());
+  }
+}
+
+// routes rebuilt for prefixes affected by a remote link change must be the
+// same as routes rebuilt from scratch
+TEST_P(GridTopologyFixture, IncrementalRouteBuild) {
+  const std::string myNodeName{"0"};
+  SpfSolver incrementalSpfSolver(
+      myNodeName,
+      false /* disable v4 */,
+      false /* disable LFA */,
+      false /* disable ordered fib */,
+      false /* bgpDryRun */,
+      false /* disable best route selection */,
+      0 /* routeComputationThreads */,
+      true /* enable incremental route build */);
+  auto routeDb = incrementalSpfSolver.buildRouteDb(
+      myNodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(routeDb.has_value());
+
+  // no change, no affected prefixes
+  auto affectedPrefixes =
+      incrementalSpfSolver.getPrefixesAffectedByLinkStateChange(
+          myNodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(affectedPrefixes.has_value());
+  EXPECT_TRUE(affectedPrefixes->empty());
+
+  // bring down a link of the corner opposite to us
+  auto& linkState = areaLinkStates.at(kTestingAreaName);
+  auto adjDb = linkState.getAdjacencyDatabases().at(
+      folly::sformat("{}", n * n - 1));
+  adjDb.adjacencies_ref()->pop_back();
+  EXPECT_TRUE(linkState.updateAdjacencyDatabase(adjDb).topologyChanged);
+
+  affectedPrefixes = incrementalSpfSolver.getPrefixesAffectedByLinkStateChange(
+      myNodeName, areaLinkStates, prefixState);
+  if (not affectedPrefixes.has_value()) {
+    // small grids fall back to full rebuild with most prefixes affected
+    EXPECT_GE(4, n);
+    return;
+  }
+  EXPECT_FALSE(affectedPrefixes->empty());
+  EXPECT_GT(prefixState.prefixes().size(), affectedPrefixes->size());
+  for (auto const& prefix : *affectedPrefixes) {
+    routeDb->unicastRoutes.erase(toIPNetwork(prefix));
+    if (auto maybeRoute = incrementalSpfSolver.createRouteForPrefix(
+            myNodeName, areaLinkStates, prefixState, prefix)) {
+      routeDb->addUnicastRoute(std::move(maybeRoute).value());
+    }
+  }
+
+  SpfSolver fullSpfSolver(myNodeName, false, false);
+  auto fullRouteDb =
+      fullSpfSolver.buildRouteDb(myNodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(fullRouteDb.has_value());
+  EXPECT_EQ(fullRouteDb->unicastRoutes, routeDb->unicastRoutes);
+  EXPECT_EQ(
+      fullRouteDb->mplsRoutes,
+      incrementalSpfSolver.buildMplsRouteDb(myNodeName, areaLinkStates)
+          .mplsRoutes);
+
+  // change of local link requires full rebuild
+  adjDb = linkState.getAdjacencyDatabases().at(myNodeName);
+  adjDb.adjacencies_ref()->at(0).metric_ref() = 2;
+  EXPECT_TRUE(linkState.updateAdjacencyDatabase(adjDb).topologyChanged);
+  EXPECT_FALSE(incrementalSpfSolver
+                   .getPrefixesAffectedByLinkStateChange(
+                       myNodeName, areaLinkStates, prefixState)
+                   .has_value());
+}
+
+// LFA next-hops must be marked as backup while shortest path next-hops must
+// not be, the set of next-hops must be the same as with plain LFA
+TEST_P(GridTopologyFixture, LfaBackupNextHops) {
+  const std::string myNodeName{"0"};
+
+  // uniform grid has no LFA off shortest paths, raise metric of a local link
+  auto& linkState = areaLinkStates.at(kTestingAreaName);
+  auto adjDb = linkState.getAdjacencyDatabases().at(myNodeName);
+  adjDb.adjacencies_ref()->at(0).metric_ref() = 2;
+  EXPECT_TRUE(linkState.updateAdjacencyDatabase(adjDb).topologyChanged);
+
+  SpfSolver backupSpfSolver(
+      myNodeName,
+      false /* disable v4 */,
+      true /* enable LFA */,
+      false /* disable ordered fib */,
+      false /* bgpDryRun */,
+      false /* disable best route selection */,
+      0 /* routeComputationThreads */,
+      false /* disable incremental route build */,
+      true /* enable LFA backup next-hops */);
+  SpfSolver lfaSpfSolver(myNodeName, false, true);
+
+  auto backupRouteDb =
+      backupSpfSolver.buildRouteDb(myNodeName, areaLinkStates, prefixState);
+  auto lfaRouteDb =
+      lfaSpfSolver.buildRouteDb(myNodeName, areaLinkStates, prefixState);
+  ASSERT_TRUE(backupRouteDb.has_value());
+  ASSERT_TRUE(lfaRouteDb.has_value());
+  ASSERT_EQ(
+      lfaRouteDb->unicastRoutes.size(), backupRouteDb->unicastRoutes.size());
+
+  size_t numBackupNextHops{0};
+  for (auto const& [prefix, entry] : backupRouteDb->unicastRoutes) {
+    ASSERT_FALSE(entry.nexthops.empty());
+    int32_t minMetric = std::numeric_limits<int32_t>::max();
+    for (auto const& nh : entry.nexthops) {
+      minMetric = std::min(minMetric, *nh.metric_ref());
+    }
+    NextHopSet nexthops;
+    for (auto nh : entry.nexthops) {
+      EXPECT_EQ(*nh.metric_ref() != minMetric, *nh.isBackup_ref());
+      numBackupNextHops += *nh.isBackup_ref() ? 1 : 0;
+      nh.isBackup_ref() = false;
+      nexthops.emplace(std::move(nh));
+    }
+    EXPECT_EQ(
+        lfaRouteDb->unicastRoutes.at(prefix).nexthops, NextHops(nexthops));
+  }
+  EXPECT_LT(0, numBackupNextHops);
+}
+
 // measure SPF execution time for large networks
 TEST(GridTopology, StressTest) {
   if (!FLAGS_stress_test) {
@@ -4401,7 +4844,8 @@ class DecisionTestFixture : public ::testing::Test {
         debounceTimeoutMax,
         kvStoreUpdatesQueue.getReader(),
         staticRoutesUpdateQueue.getReader(),
-        routeUpdatesQueue);
+        routeUpdatesQueue,
+        kvStoreSyncEventsQueue.getReader());
 
     decisionThread = std::make_unique<std::thread>([this]() {
       LOG(INFO) << "Decision thread starting";
@@ -4415,6 +4859,7 @@ class DecisionTestFixture : public ::testing::Test {
   TearDown() override {
     kvStoreUpdatesQueue.close();
     staticRoutesUpdateQueue.close();
+    kvStoreSyncEventsQueue.close();
 
     LOG(INFO) << "Stopping the decision thread";
     decision->stop();
@@ -4452,14 +4897,15 @@ class DecisionTestFixture : public ::testing::Test {
   recvRouteUpdates() {
     auto maybeRouteDb = routeUpdatesQueueReader.get();
     EXPECT_FALSE(maybeRouteDb.hasError());
-    auto routeDbDelta = maybeRouteDb.value();
+    auto routeDbDelta = *maybeRouteDb.value();
     return routeDbDelta;
   }
 
   // publish routeDb
   void
   sendKvPublication(const thrift::Publication& publication) {
-    kvStoreUpdatesQueue.push(publication);
+    kvStoreUpdatesQueue.push(
+        std::make_shared<const thrift::Publication>(publication));
   }
 
   void
@@ -4573,10 +5019,11 @@ class DecisionTestFixture : public ::testing::Test {
   CompactSerializer serializer{};
 
   std::shared_ptr<Config> config;
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue;
+  messaging::ReplicateQueue<KvStorePublicationPtr> kvStoreUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
-  messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueueReader{
+  messaging::ReplicateQueue<KvStoreSyncEvent> kvStoreSyncEventsQueue;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
+  messaging::RQueue<DecisionRouteUpdatePtr> routeUpdatesQueueReader{
       routeUpdatesQueue.getReader()};
 
   // Decision owned by this wrapper.
@@ -4795,7 +5242,7 @@ TEST_F(DecisionTestFixture, BasicOperations) {
 
   // Update 32011 and make sure only that is updated
   sendStaticRoutesUpdate(input);
-  auto routesDelta = routeUpdatesQueueReader.get().value();
+  auto routesDelta = *routeUpdatesQueueReader.get().value();
   routesDelta.perfEvents.reset();
   EXPECT_EQ(routesDelta.toThrift(), input);
 
@@ -4803,7 +5250,7 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   route.topLabel_ref() = 32012;
   input.mplsRoutesToUpdate_ref() = {route};
   sendStaticRoutesUpdate(input);
-  routesDelta = routeUpdatesQueueReader.get().value();
+  routesDelta = *routeUpdatesQueueReader.get().value();
   routesDelta.perfEvents.reset();
   EXPECT_EQ(routesDelta.toThrift(), input);
 
@@ -4824,7 +5271,7 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   input.mplsRoutesToDelete_ref() = {32011};
   sendStaticRoutesUpdate(input);
 
-  routesDelta = routeUpdatesQueueReader.get().value();
+  routesDelta = *routeUpdatesQueueReader.get().value();
   routesDelta.perfEvents.reset();
   EXPECT_EQ(routesDelta.mplsRoutesToDelete.at(0), 32011);
   EXPECT_EQ(routesDelta.mplsRoutesToUpdate.size(), 0);
@@ -4845,7 +5292,7 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   input.mplsRoutesToDelete_ref()->clear();
   sendStaticRoutesUpdate(input);
 
-  routesDelta = routeUpdatesQueueReader.get().value();
+  routesDelta = *routeUpdatesQueueReader.get().value();
   routesDelta.perfEvents.reset();
   EXPECT_EQ(1, routesDelta.mplsRoutesToUpdate.size());
   EXPECT_EQ(32012, routesDelta.mplsRoutesToUpdate.at(0).label);
@@ -4926,6 +5373,114 @@ TEST_F(DecisionTestFixture, InitialRouteUpdate) {
   EXPECT_EQ(0, routeDbDelta.unicastRoutesToDelete.size());
 }
 
+/**
+ * Verifies that computed route databases of nodes are served from cache until
+ * link or prefix state changes, and that filtered dumps only return routes of
+ * requested prefixes
+ */
+TEST_F(DecisionTestFixture, ComputedRouteDbCache) {
+  const auto getCacheHits = []() {
+    const auto counters = fb303::fbData->getCounters();
+    auto it = counters.find("decision.computed_route_db_cache_hit.count.60");
+    return it != counters.end() ? it->second : 0;
+  };
+
+  sendKvPublication(createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  recvRouteUpdates();
+
+  auto routeDb = dumpRouteDb({"2"})["2"];
+  ASSERT_EQ(1, routeDb.unicastRoutes_ref()->size());
+  EXPECT_EQ(addr1, *routeDb.unicastRoutes_ref()->at(0).dest_ref());
+  const auto hits = getCacheHits();
+  EXPECT_EQ(routeDb, dumpRouteDb({"2"})["2"]);
+  EXPECT_EQ(hits + 1, getCacheHits());
+
+  // Filtered dump is served from cached routes
+  auto filteredRouteDb =
+      decision->getDecisionRouteDbFiltered("2", {addr1, addr3}).get();
+  EXPECT_EQ("2", *filteredRouteDb->thisNodeName_ref());
+  EXPECT_EQ(
+      *routeDb.unicastRoutes_ref(), *filteredRouteDb->unicastRoutes_ref());
+  EXPECT_TRUE(filteredRouteDb->mplsRoutes_ref()->empty());
+  EXPECT_EQ(hits + 2, getCacheHits());
+
+  // Prefix change invalidates cache, filtered dump computes requested
+  // prefixes only
+  sendKvPublication(createThriftPublication(
+      {{"prefix:1", createPrefixValue("1", 2, {addr1, addr3})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  recvRouteUpdates();
+
+  filteredRouteDb = decision->getDecisionRouteDbFiltered("2", {addr3}).get();
+  ASSERT_EQ(1, filteredRouteDb->unicastRoutes_ref()->size());
+  EXPECT_EQ(addr3, *filteredRouteDb->unicastRoutes_ref()->at(0).dest_ref());
+  EXPECT_EQ(hits + 2, getCacheHits());
+
+  routeDb = dumpRouteDb({"2"})["2"];
+  EXPECT_EQ(2, routeDb.unicastRoutes_ref()->size());
+  EXPECT_EQ(hits + 2, getCacheHits());
+}
+
+/**
+ * Verifies that prefix key updates only revisit prefixes changed by the update
+ */
+TEST_F(DecisionTestFixture, PrefixDbUpdateTouchedPrefixes) {
+  sendKvPublication(createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12})},
+       {"adj:2", createAdjValue("2", 1, {adj21})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2, addr3})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  auto routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(2, routeDbDelta.unicastRoutesToUpdate.size());
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(2, counters["decision.prefix_db_update.touched_prefixes.sum"]);
+  EXPECT_EQ(2, counters["decision.prefix_db_update.changed_prefixes.sum"]);
+
+  // per prefix key only touches its prefix
+  sendKvPublication(createThriftPublication(
+      createPerPrefixKeyValue("2", 1, {addr4}),
+      {},
+      {},
+      {},
+      std::string("")));
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.count(toIPNetwork(addr4)));
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(3, counters["decision.prefix_db_update.touched_prefixes.sum"]);
+  EXPECT_EQ(3, counters["decision.prefix_db_update.changed_prefixes.sum"]);
+
+  // full prefix database only touches withdrawn and changed prefixes
+  sendKvPublication(createThriftPublication(
+      {{"prefix:2", createPrefixValue("2", 2, {addr2})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_THAT(
+      routeDbDelta.unicastRoutesToDelete,
+      testing::ElementsAre(toIPNetwork(addr3)));
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(4, counters["decision.prefix_db_update.touched_prefixes.sum"]);
+  EXPECT_EQ(4, counters["decision.prefix_db_update.changed_prefixes.sum"]);
+}
+
 // The following topology is used:
 //  1--- A ---2
 //  |         |
@@ -5277,6 +5832,75 @@ TEST_F(DecisionTestFixture, RibPolicy) {
   }
 }
 
+/**
+ * Verifies that RibPolicy change is applied as delta, i.e. only routes matched
+ * by the old or the new policy get rebuilt and sent.
+ */
+TEST_F(DecisionTestFixture, RibPolicyDelta) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2, addr3})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  {
+    auto updates = recvRouteUpdates();
+    ASSERT_EQ(2, updates.unicastRoutesToUpdate.size());
+  }
+
+  thrift::RibRouteActionWeight actionWeight;
+  actionWeight.neighbor_to_weight_ref()->emplace("2", 2);
+  thrift::RibPolicyStatement policyStatement;
+  policyStatement.matcher_ref()->prefixes_ref() =
+      std::vector<thrift::IpPrefix>({addr2});
+  policyStatement.action_ref()->set_weight_ref() = actionWeight;
+  thrift::RibPolicy policy;
+  policy.statements_ref()->emplace_back(policyStatement);
+  policy.ttl_secs_ref() = 300;
+
+  // Only addr2 is matched and updated
+  EXPECT_NO_THROW(decision->setRibPolicy(policy).get());
+  {
+    auto updates = recvRouteUpdates();
+    ASSERT_EQ(1, updates.unicastRoutesToUpdate.size());
+    ASSERT_EQ(1, updates.unicastRoutesToUpdate.count(toIPNetwork(addr2)));
+    EXPECT_EQ(0, updates.unicastRoutesToDelete.size());
+    auto counters = fb303::fbData->getCounters();
+    EXPECT_EQ(1, counters.at("decision.rib_policy.rebuilt_routes.sum"));
+  }
+
+  // Move policy to addr3. addr2 loses the weight, addr3 gains it
+  policy.statements_ref()->at(0).matcher_ref()->prefixes_ref() =
+      std::vector<thrift::IpPrefix>({addr3});
+  EXPECT_NO_THROW(decision->setRibPolicy(policy).get());
+  {
+    auto updates = recvRouteUpdates();
+    ASSERT_EQ(2, updates.unicastRoutesToUpdate.size());
+    for (auto& nh :
+         updates.unicastRoutesToUpdate.at(toIPNetwork(addr2)).nexthops) {
+      EXPECT_FALSE(nh.weight_ref().has_value());
+    }
+    for (auto& nh :
+         updates.unicastRoutesToUpdate.at(toIPNetwork(addr3)).nexthops) {
+      EXPECT_EQ(2, *nh.weight_ref());
+    }
+    auto counters = fb303::fbData->getCounters();
+    EXPECT_EQ(3, counters.at("decision.rib_policy.rebuilt_routes.sum"));
+  }
+
+  // Same policy again. Nothing changes
+  EXPECT_NO_THROW(decision->setRibPolicy(policy).get());
+  {
+    auto updates = recvRouteUpdates();
+    EXPECT_EQ(0, updates.unicastRoutesToUpdate.size());
+    EXPECT_EQ(0, updates.unicastRoutesToDelete.size());
+  }
+}
+
 /**
  * Verifies that error is set if RibPolicy is invalid
  */
@@ -5300,9 +5924,9 @@ TEST(Decision, RibPolicyFeatureKnob) {
   auto config = std::make_shared<Config>(tConfig);
   ASSERT_FALSE(config->isRibPolicyEnabled());
 
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue;
+  messaging::ReplicateQueue<KvStorePublicationPtr> kvStoreUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
   auto decision = std::make_unique<Decision>(
       config,
       true, /* computeLfaPaths */
@@ -6519,6 +7143,28 @@ TEST(DecisionPendingUpdates, needsFullRebuild) {
   EXPECT_TRUE(updates.needsFullRebuild());
 }
 
+TEST(DecisionPendingUpdates, needsTopologyRebuildOnly) {
+  openr::detail::DecisionPendingUpdates updates("node1");
+  LinkState::LinkStateChange linkStateChange;
+
+  linkStateChange.topologyChanged = true;
+  updates.applyLinkStateChange("node2", linkStateChange, kEmptyPerfEventRef);
+  EXPECT_TRUE(updates.needsFullRebuild());
+  EXPECT_TRUE(updates.needsTopologyRebuildOnly());
+
+  // any other reason requires full rebuild
+  linkStateChange.topologyChanged = false;
+  linkStateChange.nodeLabelChanged = true;
+  updates.applyLinkStateChange("node2", linkStateChange, kEmptyPerfEventRef);
+  EXPECT_TRUE(updates.needsFullRebuild());
+  EXPECT_FALSE(updates.needsTopologyRebuildOnly());
+
+  updates.reset();
+  EXPECT_FALSE(updates.needsTopologyRebuildOnly());
+  updates.setNeedsFullRebuild();
+  EXPECT_FALSE(updates.needsTopologyRebuildOnly());
+}
+
 TEST(DecisionPendingUpdates, updatedPrefixes) {
   openr::detail::DecisionPendingUpdates updates("node1");
 
@@ -6550,6 +7196,362 @@ TEST(DecisionPendingUpdates, updatedPrefixes) {
   EXPECT_TRUE(updates.updatedPrefixes().empty());
 }
 
+/**
+ * Verifies that route computation phases are reported in perf events of the
+ * route update in order, before ROUTE_UPDATE
+ */
+TEST_F(DecisionTestFixture, RouteBuildPhasePerfEvents) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+
+  auto updates = recvRouteUpdates();
+  ASSERT_TRUE(updates.perfEvents.has_value());
+  std::vector<std::string> eventDescrs;
+  for (auto const& event : *updates.perfEvents->events_ref()) {
+    eventDescrs.emplace_back(*event.eventDescr_ref());
+  }
+  EXPECT_THAT(
+      eventDescrs,
+      testing::IsSupersetOf(
+          {"DECISION_SPF",
+           "DECISION_BEST_ROUTE_SELECTION",
+           "DECISION_NEXTHOPS",
+           "DECISION_MPLS_ROUTES",
+           "DECISION_CALCULATE_UPDATE",
+           "ROUTE_UPDATE"}));
+  EXPECT_EQ("ROUTE_UPDATE", eventDescrs.back());
+  EXPECT_EQ(
+      "DECISION_CALCULATE_UPDATE", eventDescrs.at(eventDescrs.size() - 2));
+
+  // Timestamps of events don't go back
+  auto const& events = *updates.perfEvents->events_ref();
+  for (size_t i = 1; i < events.size(); ++i) {
+    EXPECT_LE(*events.at(i - 1).unixTs_ref(), *events.at(i).unixTs_ref());
+  }
+}
+
+class DecisionColdStartTestFixture : public DecisionTestFixture {
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = DecisionTestFixture::createConfig();
+    // cold start timer must not expire during the test
+    tConfig.eor_time_s_ref() = 3600;
+    return tConfig;
+  }
+};
+
+/**
+ * Verifies that cold start ends and routes get computed as soon as KvStore of
+ * every area completed initial sync, without waiting for cold start timer
+ */
+TEST_F(DecisionColdStartTestFixture, InitialSyncEndsColdStart) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+
+  // no routes before initial sync, sync of unknown area does not count
+  kvStoreSyncEventsQueue.push(KvStoreSyncEvent("2", "unknown_area"));
+  std::this_thread::sleep_for(debounceTimeoutMax * 2);
+  EXPECT_EQ(0, routeUpdatesQueueReader.size());
+
+  kvStoreSyncEventsQueue.push(KvStoreSyncEvent("2", kTestingAreaName));
+  auto routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      1,
+      fb303::fbData->getCounters().at(
+          "decision.cold_start.initial_sync_completed.count"));
+
+  // later syncs, e.g. with new peers, do not trigger any rebuild
+  kvStoreSyncEventsQueue.push(KvStoreSyncEvent("3", kTestingAreaName));
+  std::this_thread::sleep_for(debounceTimeoutMax * 2);
+  EXPECT_EQ(0, routeUpdatesQueueReader.size());
+}
+
+class DecisionRouteDampingTestFixture : public DecisionTestFixture {
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = DecisionTestFixture::createConfig();
+    // suppress on third change of route, reuse within 2s of last change
+    thrift::RouteDampingConfig dampingConfig;
+    dampingConfig.half_life_s_ref() = 1;
+    dampingConfig.max_suppress_time_s_ref() = 2;
+    tConfig.route_damping_config_ref() = dampingConfig;
+    return tConfig;
+  }
+};
+
+/**
+ * Verifies damping of route of flapping prefix end to end. Once suppressed,
+ * next-hops going away are still removed from the route while next-hops
+ * coming back are held until the prefix is reused, which programs its latest
+ * route.
+ *
+ * 1 = 2 with two parallel links, flapping link 2/1-2 first and then 2/1-1.
+ */
+TEST_F(DecisionRouteDampingTestFixture, SuppressedPrefixNextHopRemoval) {
+  auto adj12_1 =
+      createAdjacency("2", "1/2-1", "2/1-1", "fe80::2", "192.168.0.2", 100, 0);
+  auto adj12_2 =
+      createAdjacency("2", "1/2-2", "2/1-2", "fe80::2", "192.168.0.2", 100, 0);
+  auto adj21_1 =
+      createAdjacency("1", "2/1-1", "1/2-1", "fe80::1", "192.168.0.1", 100, 0);
+  auto adj21_2 =
+      createAdjacency("1", "2/1-2", "1/2-2", "fe80::1", "192.168.0.1", 100, 0);
+  const auto nh1 = createNextHopFromAdj(adj12_1, false, 100);
+  const auto nh2 = createNextHopFromAdj(adj12_2, false, 100);
+  const auto prefix2 = toIPNetwork(addr2);
+
+  sendKvPublication(createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12_1, adj12_2})},
+       {"adj:2", createAdjValue("2", 1, {adj21_1, adj21_2})},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  auto routeDbDelta = recvRouteUpdates();
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      NextHops({nh1, nh2}),
+      routeDbDelta.unicastRoutesToUpdate.at(prefix2).nexthops);
+
+  // publish adjacencies of node 2 and receive route update
+  int64_t version = 1;
+  auto publishAdjs = [&](std::vector<thrift::Adjacency> const& adjs) {
+    sendKvPublication(createThriftPublication(
+        {{"adj:2", createAdjValue("2", ++version, adjs)}},
+        {},
+        {},
+        {},
+        std::string("")));
+    return recvRouteUpdates();
+  };
+  auto isSuppressed = [&]() {
+    auto states = decision->getRouteDampingStates().get();
+    return states->size() == 1 and *states->at(0).suppressed_ref();
+  };
+
+  // first two changes go through
+  routeDbDelta = publishAdjs({adj21_1});
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      NextHops({nh1}), routeDbDelta.unicastRoutesToUpdate.at(prefix2).nexthops);
+  routeDbDelta = publishAdjs({adj21_1, adj21_2});
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_FALSE(isSuppressed());
+
+  // third change suppresses prefix, removal of next-hop is applied
+  routeDbDelta = publishAdjs({adj21_1});
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      NextHops({nh1}), routeDbDelta.unicastRoutesToUpdate.at(prefix2).nexthops);
+  EXPECT_TRUE(isSuppressed());
+
+  // next-hop coming back is held
+  routeDbDelta = publishAdjs({adj21_1, adj21_2});
+  EXPECT_TRUE(routeDbDelta.unicastRoutesToUpdate.empty());
+  EXPECT_TRUE(routeDbDelta.unicastRoutesToDelete.empty());
+
+  // last programmed next-hop going away withdraws route, new one is held
+  routeDbDelta = publishAdjs({adj21_2});
+  EXPECT_TRUE(routeDbDelta.unicastRoutesToUpdate.empty());
+  EXPECT_THAT(
+      routeDbDelta.unicastRoutesToDelete, testing::ElementsAre(prefix2));
+  EXPECT_LE(
+      1,
+      fb303::fbData->getCounters().at(
+          "decision.route_damping.next_hops_removed.sum"));
+
+  // reuse programs latest route
+  routeDbDelta = recvRouteUpdates();
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      NextHops({nh2}), routeDbDelta.unicastRoutesToUpdate.at(prefix2).nexthops);
+  EXPECT_FALSE(isSuppressed());
+}
+
+/**
+ * Verifies that Decision restores LSDB from snapshot across restart and
+ * computes routes from it without waiting for KvStore. Values KvStore syncs
+ * at unchanged version are not parsed again, and state of keys gone while
+ * Decision was down is withdrawn once KvStore synced.
+ */
+class DecisionLsdbSnapshotTestFixture : public ::testing::Test {
+ protected:
+  void
+  SetUp() override {
+    fb303::fbData->resetAllData();
+    ASSERT_NE(nullptr, ::mkdtemp(snapshotDir_));
+    snapshotFile_ = folly::sformat("{}/lsdb.snapshot", snapshotDir_);
+
+    auto tConfig = getBasicOpenrConfig("1");
+    // cold start timer must not expire during the test
+    tConfig.eor_time_s_ref() = 3600;
+    tConfig.decision_lsdb_snapshot_file_ref() = snapshotFile_;
+    config_ = std::make_shared<Config>(tConfig);
+
+    const auto adjValue = [&](const std::string& node,
+                              const thrift::Adjacency& adj,
+                              int32_t nodeId) {
+      return createThriftValue(
+          1,
+          "originator-1",
+          writeThriftObjStr(createAdjDb(node, {adj}, nodeId), serializer_));
+    };
+    publication_ = createThriftPublication(
+        {{"adj:1", adjValue("1", adj12, 1)},
+         {"adj:2", adjValue("2", adj21, 2)},
+         {"prefix:2",
+          createThriftValue(
+              1,
+              "2",
+              writeThriftObjStr(
+                  createPrefixDb("2", {createPrefixEntry(addr2)}),
+                  serializer_))}},
+        {});
+  }
+
+  void
+  TearDown() override {
+    std::remove(snapshotFile_.c_str());
+    ::rmdir(snapshotDir_);
+  }
+
+  // run Decision until `test` returns, snapshot is written on stop
+  template <typename TestFn>
+  void
+  runDecision(TestFn&& test) {
+    messaging::ReplicateQueue<KvStorePublicationPtr> kvStoreUpdatesQueue;
+    messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesQueue;
+    messaging::ReplicateQueue<KvStoreSyncEvent> kvStoreSyncEventsQueue;
+    messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
+    auto routeUpdatesQueueReader = routeUpdatesQueue.getReader();
+    Decision decision(
+        config_,
+        true, /* computeLfaPaths */
+        false, /* bgpDryRun */
+        debounceTimeoutMin,
+        debounceTimeoutMax,
+        kvStoreUpdatesQueue.getReader(),
+        staticRoutesQueue.getReader(),
+        routeUpdatesQueue,
+        kvStoreSyncEventsQueue.getReader());
+    std::thread decisionThread([&]() { decision.run(); });
+    decision.waitUntilRunning();
+
+    test(kvStoreUpdatesQueue, kvStoreSyncEventsQueue, routeUpdatesQueueReader);
+
+    kvStoreUpdatesQueue.close();
+    staticRoutesQueue.close();
+    kvStoreSyncEventsQueue.close();
+    decision.stop();
+    decisionThread.join();
+  }
+
+  // run Decision which writes snapshot of initial publication_ on stop
+  void
+  writeSnapshot() {
+    runDecision([&](auto& kvStoreUpdatesQueue,
+                    auto& kvStoreSyncEventsQueue,
+                    auto& routeUpdatesQueueReader) {
+      kvStoreUpdatesQueue.push(
+          std::make_shared<const thrift::Publication>(publication_));
+      kvStoreSyncEventsQueue.push(KvStoreSyncEvent("2", kTestingAreaName));
+      auto routeDbDelta = routeUpdatesQueueReader.get().value();
+      EXPECT_EQ(1, routeDbDelta->unicastRoutesToUpdate.size());
+    });
+  }
+
+  char snapshotDir_[64] = "/tmp/openr_decision_snapshot.XXXXXX";
+  std::string snapshotFile_;
+  std::shared_ptr<Config> config_;
+  CompactSerializer serializer_;
+  thrift::Publication publication_;
+};
+
+TEST_F(DecisionLsdbSnapshotTestFixture, FastRestart) {
+  writeSnapshot();
+
+  runDecision([&](auto& kvStoreUpdatesQueue,
+                  auto& kvStoreSyncEventsQueue,
+                  auto& routeUpdatesQueueReader) {
+    // routes are computed from snapshot without any publication or sync
+    auto routeDbDelta = routeUpdatesQueueReader.get().value();
+    EXPECT_EQ(1, routeDbDelta->unicastRoutesToUpdate.size());
+    EXPECT_EQ(1, routeDbDelta->unicastRoutesToUpdate.count(toIPNetwork(addr2)));
+    auto counters = fb303::fbData->getCounters();
+    EXPECT_EQ(2, counters["decision.lsdb_snapshot.num_nodes_loaded.sum"]);
+
+    // KvStore syncs adjacencies at same version, prefix:2 is gone
+    auto syncedPublication = publication_;
+    syncedPublication.keyVals_ref()->erase("prefix:2");
+    kvStoreUpdatesQueue.push(
+        std::make_shared<const thrift::Publication>(syncedPublication));
+    kvStoreSyncEventsQueue.push(KvStoreSyncEvent("2", kTestingAreaName));
+    routeDbDelta = routeUpdatesQueueReader.get().value();
+    EXPECT_EQ(0, routeDbDelta->unicastRoutesToUpdate.size());
+    EXPECT_THAT(
+        routeDbDelta->unicastRoutesToDelete,
+        testing::ElementsAre(toIPNetwork(addr2)));
+    counters = fb303::fbData->getCounters();
+    EXPECT_EQ(2, counters["decision.lsdb_snapshot.num_keys_reused.sum"]);
+    EXPECT_EQ(1, counters["decision.lsdb_snapshot.num_keys_expired.sum"]);
+  });
+}
+
+TEST_F(DecisionLsdbSnapshotTestFixture, StaleSnapshotNotRestored) {
+  writeSnapshot();
+
+  // age snapshot beyond default max age
+  std::string content;
+  ASSERT_TRUE(folly::readFile(snapshotFile_.c_str(), content));
+  auto snapshot =
+      readThriftObjStr<thrift::LsdbSnapshot>(content, serializer_);
+  ASSERT_LT(0, *snapshot.timestampMs_ref());
+  *snapshot.timestampMs_ref() -=
+      std::chrono::milliseconds(Constants::kDecisionLsdbSnapshotMaxAge)
+          .count() +
+      1000;
+  ASSERT_TRUE(folly::writeFile(
+      writeThriftObjStr(snapshot, serializer_), snapshotFile_.c_str()));
+
+  runDecision([&](auto& kvStoreUpdatesQueue,
+                  auto& kvStoreSyncEventsQueue,
+                  auto& routeUpdatesQueueReader) {
+    // snapshot is discarded, no routes until KvStore syncs
+    const std::string staleCounter{"decision.lsdb_snapshot.num_stale.count"};
+    while (fb303::fbData->getCounters()[staleCounter] == 0) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(0, routeUpdatesQueueReader.size());
+    auto counters = fb303::fbData->getCounters();
+    EXPECT_EQ(0, counters["decision.lsdb_snapshot.num_nodes_loaded.sum"]);
+
+    kvStoreUpdatesQueue.push(
+        std::make_shared<const thrift::Publication>(publication_));
+    kvStoreSyncEventsQueue.push(KvStoreSyncEvent("2", kTestingAreaName));
+    auto routeDbDelta = routeUpdatesQueueReader.get().value();
+    EXPECT_EQ(1, routeDbDelta->unicastRoutesToUpdate.size());
+    counters = fb303::fbData->getCounters();
+    EXPECT_EQ(0, counters["decision.lsdb_snapshot.num_keys_reused.sum"]);
+  });
+}
+
 TEST(DecisionPendingUpdates, perfEvents) {
   openr::detail::DecisionPendingUpdates updates("node1");
   LinkState::LinkStateChange linkStateChange;
@@ -5,6 +5,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <map>
+#include <random>
+
+#include <folly/Format.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -134,6 +138,33 @@ TEST(LinkTest, BasicOperation) {
   EXPECT_TRUE(l1 < l3 || l3 < l1);
 }
 
+TEST(DijkstraQTest, BasicOperation) {
+  openr::DijkstraQ q(5);
+  EXPECT_TRUE(q.empty());
+  q.push(0, 10);
+  q.push(1, 5);
+  q.push(2, 7);
+  q.push(3, 5);
+  // decrease-key of queued nodes
+  q.push(0, 6);
+  q.push(2, 1);
+
+  using QEntry = std::pair<uint32_t, openr::LinkStateMetric>;
+  std::vector<QEntry> popped;
+  while (not q.empty()) {
+    popped.emplace_back(q.pop());
+  }
+  // ties are broken by node id
+  EXPECT_THAT(
+      popped,
+      ElementsAre(QEntry(2, 1), QEntry(1, 5), QEntry(3, 5), QEntry(0, 6)));
+
+  // popped node can be queued again
+  q.push(1, 3);
+  EXPECT_EQ(QEntry(1, 3), q.pop());
+  EXPECT_TRUE(q.empty());
+}
+
 TEST(LinkStateTest, BasicOperation) {
   std::string n1 = "node1";
   std::string n2 = "node2";
@@ -197,6 +228,60 @@ TEST(LinkStateTest, BasicOperation) {
   EXPECT_THAT(state.linksFromNode(n3), UnorderedElementsAre(Pointee(l2)));
 }
 
+/**
+ * Links of adjacencies which are re-advertised are updated in place, new
+ * objects are only created for links which come up
+ */
+TEST(LinkStateTest, UpdateReusesLinks) {
+  std::string n1 = "node1";
+  std::string n2 = "node2";
+  auto adj12 =
+      openr::createAdjacency(n2, "if2", "if1", "fe80::2", "10.0.0.2", 1, 1, 1);
+  auto adj21 =
+      openr::createAdjacency(n1, "if1", "if2", "fe80::1", "10.0.0.1", 1, 1, 1);
+  auto adjDb1 = openr::createAdjDb(n1, {adj12}, 1);
+  auto adjDb2 = openr::createAdjDb(n2, {adj21}, 2);
+
+  openr::LinkState state{kTestingAreaName};
+  EXPECT_FALSE(state.updateAdjacencyDatabase(adjDb1).topologyChanged);
+  EXPECT_TRUE(state.updateAdjacencyDatabase(adjDb2).topologyChanged);
+  ASSERT_EQ(1, state.linksFromNode(n1).size());
+  const auto link = *state.linksFromNode(n1).begin();
+
+  // rtt change only
+  adj12.rtt_ref() = 100;
+  auto change =
+      state.updateAdjacencyDatabase(openr::createAdjDb(n1, {adj12}, 1));
+  EXPECT_FALSE(change.topologyChanged);
+  EXPECT_FALSE(change.linkAttributesChanged);
+  ASSERT_EQ(1, state.linksFromNode(n1).size());
+  EXPECT_EQ(link, *state.linksFromNode(n1).begin());
+  EXPECT_EQ(
+      100,
+      *state.getAdjacencyDatabases()
+           .at(n1)
+           .adjacencies_ref()
+           ->at(0)
+           .rtt_ref());
+
+  // metric change is applied to the same link object
+  adj12.metric_ref() = 5;
+  change = state.updateAdjacencyDatabase(openr::createAdjDb(n1, {adj12}, 1));
+  EXPECT_TRUE(change.topologyChanged);
+  EXPECT_EQ(link, *state.linksFromNode(n1).begin());
+  EXPECT_EQ(5, link->getMetricFromNode(n1));
+  EXPECT_EQ(5, state.getMetricFromAToB(n1, n2));
+
+  // different remote interface is a different link
+  auto adj12Other =
+      openr::createAdjacency(n2, "if2", "if3", "fe80::2", "10.0.0.2", 1, 1, 1);
+  change =
+      state.updateAdjacencyDatabase(openr::createAdjDb(n1, {adj12Other}, 1));
+  EXPECT_TRUE(change.topologyChanged);
+  EXPECT_THAT(state.linksFromNode(n1), testing::IsEmpty());
+  EXPECT_FALSE(state.getMetricFromAToB(n1, n2).has_value());
+}
+
 TEST(LinkStateTest, pathAInPathB) {
   auto l1 =
       std::make_shared<openr::Link>(kTestingAreaName, "1", "1/2", "2", "2/1");
@@ -314,6 +399,47 @@ TEST(LinkStateTest, getKthPaths) {
       }
     }
   }
+
+  {
+    // ring with a tail, metric is hop count
+    //
+    //   1---2---6
+    //   |   |
+    //   4---3
+    //
+    auto linkState = openr::getLinkState({
+        {1, {2, 4}},
+        {2, {1, 3, 6}},
+        {3, {2, 4}},
+        {4, {1, 3}},
+        {6, {2}},
+    });
+
+    // second path goes the long way around the ring
+    EXPECT_THAT(linkState.getKthPaths("1", "2", 1), ElementsAre(SizeIs(1)));
+    auto secondPaths = linkState.getKthPaths("1", "2", 2);
+    ASSERT_THAT(secondPaths, ElementsAre(SizeIs(3)));
+    std::string nextNode = "1";
+    for (auto const& link : secondPaths.at(0)) {
+      nextNode = link->getOtherNodeName(nextNode);
+    }
+    EXPECT_EQ(nextNode, "2");
+
+    // no second path towards node behind a single link
+    EXPECT_THAT(linkState.getKthPaths("1", "6", 1), ElementsAre(SizeIs(2)));
+    EXPECT_THAT(linkState.getKthPaths("1", "6", 2), IsEmpty());
+    EXPECT_THAT(linkState.getKthPaths("1", "6", 3), IsEmpty());
+
+    // second paths are re-computed on topology changes. Bring down 1---4
+    auto adjDb = openr::createAdjDb(
+        "1",
+        {openr::createAdjacency(
+            "2", "1/2/0", "2/1/0", "fe80::0002", "192.168.0.2", 1, 0x10002)},
+        1);
+    linkState.updateAdjacencyDatabase(adjDb, 0, 0);
+    EXPECT_THAT(linkState.getKthPaths("1", "2", 1), ElementsAre(SizeIs(1)));
+    EXPECT_THAT(linkState.getKthPaths("1", "2", 2), IsEmpty());
+  }
 }
 
 TEST(LinkStateTest, getHopCounts) {
@@ -377,6 +503,374 @@ TEST(LinkStateTest, getHopCounts) {
   }
 }
 
+TEST(LinkStateTest, ClearMemoizedResults) {
+  // box
+  //
+  //   1--2
+  //   |  |
+  //   3--4
+  //
+  auto linkState = openr::getLinkState({
+      {1, {2, 3}},
+      {2, {1, 4}},
+      {3, {1, 4}},
+      {4, {2, 3}},
+  });
+
+  EXPECT_EQ(2, linkState.getMetricFromAToB("1", "4"));
+  EXPECT_EQ(2, linkState.getKthPaths("1", "4", 1).size());
+  EXPECT_EQ(2, linkState.getMaxHopsToNode("1"));
+
+  // Results are recomputed on demand
+  linkState.clearMemoizedResults();
+  EXPECT_EQ(2, linkState.getMetricFromAToB("1", "4"));
+  EXPECT_EQ(2, linkState.getKthPaths("1", "4", 1).size());
+  EXPECT_EQ(2, linkState.getMaxHopsToNode("1"));
+
+  // and still follow topology changes
+  linkState.deleteAdjacencyDatabase("2");
+  EXPECT_EQ(2, linkState.getMetricFromAToB("1", "4"));
+  EXPECT_EQ(1, linkState.getKthPaths("1", "4", 1).size());
+  EXPECT_FALSE(linkState.getMetricFromAToB("1", "2").has_value());
+}
+
+/**
+ * Apply same random link flaps, metric changes and node removals to two link
+ * states, one with incremental SPF, and verify their SPF results are the same
+ * after every change
+ */
+TEST(LinkStateTest, IncrementalSpf) {
+  // grid of kSize x kSize nodes
+  const int kSize = 6;
+  const int kNumNodes = kSize * kSize;
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<int> nodeDist(0, kNumNodes - 1);
+  std::uniform_int_distribution<int> metricDist(1, 4);
+  std::uniform_int_distribution<int> actionDist(0, 9);
+
+  // adjacent node to metric of adjacency, per node
+  std::vector<std::map<int, int>> adjMetrics(kNumNodes);
+  for (int i = 0; i < kNumNodes; ++i) {
+    if (i % kSize != kSize - 1) {
+      adjMetrics[i][i + 1] = adjMetrics[i + 1][i] = 1;
+    }
+    if (i + kSize < kNumNodes) {
+      adjMetrics[i][i + kSize] = adjMetrics[i + kSize][i] = 1;
+    }
+  }
+  auto createNodeAdjDb = [&](int node) {
+    std::vector<openr::thrift::Adjacency> adjs;
+    for (auto const& [adj, metric] : adjMetrics[node]) {
+      adjs.emplace_back(openr::createAdjacency(
+          folly::sformat("{}", adj),
+          folly::sformat("{}/{}", node, adj),
+          folly::sformat("{}/{}", adj, node),
+          folly::sformat("fe80::{}", adj + 1),
+          folly::sformat("10.0.0.{}", adj + 1),
+          metric,
+          100000 + adj));
+    }
+    return openr::createAdjDb(folly::sformat("{}", node), adjs, node + 1);
+  };
+
+  openr::LinkState fullState{kTestingAreaName};
+  openr::LinkState incrementalState{kTestingAreaName, true};
+  auto updateNode = [&](int node) {
+    auto adjDb = createNodeAdjDb(node);
+    EXPECT_EQ(
+        fullState.updateAdjacencyDatabase(adjDb, 0, 0).topologyChanged,
+        incrementalState.updateAdjacencyDatabase(adjDb, 0, 0).topologyChanged);
+  };
+  for (int i = 0; i < kNumNodes; ++i) {
+    updateNode(i);
+  }
+
+  auto verifySpfResults = [&]() {
+    for (int src : {0, kNumNodes / 2, kNumNodes - 1}) {
+      for (bool useLinkMetric : {true, false}) {
+        auto const& srcName = folly::sformat("{}", src);
+        auto const& expected = fullState.getSpfResult(srcName, useLinkMetric);
+        auto const& actual =
+            incrementalState.getSpfResult(srcName, useLinkMetric);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (auto const& [nodeName, nodeResult] : expected) {
+          ASSERT_EQ(1, actual.count(nodeName));
+          auto const& actualResult = actual.at(nodeName);
+          EXPECT_EQ(nodeResult.metric(), actualResult.metric());
+          EXPECT_EQ(nodeResult.nextHops(), actualResult.nextHops());
+          EXPECT_EQ(
+              nodeResult.pathLinks().size(), actualResult.pathLinks().size());
+        }
+      }
+    }
+  };
+  verifySpfResults();
+
+  for (int iter = 0; iter < 200; ++iter) {
+    const int node = nodeDist(gen);
+    const auto action = actionDist(gen);
+    if (action == 0) {
+      // remove node and bring it back later with its adjacencies
+      auto nodeName = folly::sformat("{}", node);
+      EXPECT_EQ(
+          fullState.deleteAdjacencyDatabase(nodeName).topologyChanged,
+          incrementalState.deleteAdjacencyDatabase(nodeName).topologyChanged);
+      verifySpfResults();
+      updateNode(node);
+    } else if (action < 4) {
+      // flap adjacency of a node towards random neighbor. Link goes down
+      // until the adjacency is reported again
+      auto it = adjMetrics[node].begin();
+      std::advance(it, gen() % adjMetrics[node].size());
+      auto const [adj, metric] = *it;
+      adjMetrics[node].erase(it);
+      updateNode(node);
+      verifySpfResults();
+      adjMetrics[node].emplace(adj, metric);
+      updateNode(node);
+    } else {
+      // change metric of a node's adjacency in single direction
+      for (auto& [adj, metric] : adjMetrics[node]) {
+        if (gen() % 2) {
+          metric = metricDist(gen);
+        }
+      }
+      updateNode(node);
+    }
+    verifySpfResults();
+  }
+}
+
+/**
+ * Apply random metric changes and node overloads with holds to link states
+ * and verify memoized SPF results, which are invalidated only where the
+ * changes and expired holds may affect them, match the ones computed from
+ * scratch after every change and every ordered FIB programming tick
+ */
+TEST(LinkStateTest, HoldsInvalidation) {
+  // grid of kSize x kSize nodes
+  const int kSize = 5;
+  const int kNumNodes = kSize * kSize;
+  std::mt19937 gen(2468);
+  std::uniform_int_distribution<int> nodeDist(0, kNumNodes - 1);
+  std::uniform_int_distribution<int> metricDist(1, 4);
+  std::uniform_int_distribution<int> ttlDist(0, 3);
+
+  std::vector<std::map<int, int>> adjMetrics(kNumNodes);
+  std::vector<bool> overloads(kNumNodes, false);
+  for (int i = 0; i < kNumNodes; ++i) {
+    if (i % kSize != kSize - 1) {
+      adjMetrics[i][i + 1] = adjMetrics[i + 1][i] = 1;
+    }
+    if (i + kSize < kNumNodes) {
+      adjMetrics[i][i + kSize] = adjMetrics[i + kSize][i] = 1;
+    }
+  }
+  auto createNodeAdjDb = [&](int node) {
+    std::vector<openr::thrift::Adjacency> adjs;
+    for (auto const& [adj, metric] : adjMetrics[node]) {
+      adjs.emplace_back(openr::createAdjacency(
+          folly::sformat("{}", adj),
+          folly::sformat("{}/{}", node, adj),
+          folly::sformat("{}/{}", adj, node),
+          folly::sformat("fe80::{}", adj + 1),
+          folly::sformat("10.0.0.{}", adj + 1),
+          metric,
+          100000 + adj));
+    }
+    auto adjDb =
+        openr::createAdjDb(folly::sformat("{}", node), adjs, node + 1);
+    adjDb.isOverloaded_ref() = overloads[node];
+    return adjDb;
+  };
+
+  // reference state drops its memoized results before every query
+  openr::LinkState referenceState{kTestingAreaName};
+  openr::LinkState targetedState{kTestingAreaName};
+  openr::LinkState incrementalState{kTestingAreaName, true};
+  std::vector<openr::LinkState*> states{
+      &referenceState, &targetedState, &incrementalState};
+  auto updateNode = [&](int node, int holdUpTtl, int holdDownTtl) {
+    auto adjDb = createNodeAdjDb(node);
+    for (auto* state : states) {
+      state->updateAdjacencyDatabase(adjDb, holdUpTtl, holdDownTtl);
+    }
+  };
+  for (int i = 0; i < kNumNodes; ++i) {
+    updateNode(i, 0, 0);
+  }
+
+  auto verifySpfResults = [&]() {
+    for (int src : {0, kNumNodes / 2, kNumNodes - 1}) {
+      auto const& srcName = folly::sformat("{}", src);
+      auto const& dstName =
+          folly::sformat("{}", (src + kNumNodes / 2 + 1) % kNumNodes);
+      for (bool useLinkMetric : {true, false}) {
+        referenceState.clearMemoizedResults();
+        auto const& expected =
+            referenceState.getSpfResult(srcName, useLinkMetric);
+        for (auto* state : {&targetedState, &incrementalState}) {
+          auto const& actual = state->getSpfResult(srcName, useLinkMetric);
+          ASSERT_EQ(expected.size(), actual.size());
+          for (auto const& [nodeName, nodeResult] : expected) {
+            ASSERT_EQ(1, actual.count(nodeName));
+            auto const& actualResult = actual.at(nodeName);
+            EXPECT_EQ(nodeResult.metric(), actualResult.metric());
+            EXPECT_EQ(nodeResult.nextHops(), actualResult.nextHops());
+          }
+        }
+      }
+      referenceState.clearMemoizedResults();
+      const auto numPaths =
+          referenceState.getKthPaths(srcName, dstName, 1).size();
+      EXPECT_EQ(
+          numPaths, targetedState.getKthPaths(srcName, dstName, 1).size());
+      EXPECT_EQ(
+          numPaths, incrementalState.getKthPaths(srcName, dstName, 1).size());
+    }
+  };
+  verifySpfResults();
+
+  for (int iter = 0; iter < 200; ++iter) {
+    const int node = nodeDist(gen);
+    if (gen() % 4 == 0) {
+      overloads[node] = not overloads[node];
+    } else {
+      for (auto& [adj, metric] : adjMetrics[node]) {
+        if (gen() % 2) {
+          metric = metricDist(gen);
+        }
+      }
+    }
+    updateNode(node, ttlDist(gen), ttlDist(gen));
+    verifySpfResults();
+
+    // tick ordered FIB programming a few times
+    for (int tick = gen() % 3; tick > 0; --tick) {
+      const auto hasHolds = referenceState.hasHolds();
+      for (auto* state : states) {
+        EXPECT_EQ(hasHolds, state->hasHolds());
+        state->decrementHolds();
+      }
+      verifySpfResults();
+    }
+  }
+
+  // all holds expire eventually
+  for (int tick = 0; tick < 4; ++tick) {
+    for (auto* state : states) {
+      state->decrementHolds();
+    }
+  }
+  for (auto* state : states) {
+    EXPECT_FALSE(state->hasHolds());
+  }
+  verifySpfResults();
+}
+
+/**
+ * Apply random link flaps, node overloads and metric changes to a link state
+ * and verify memoized hop counts, which are updated in place when links come
+ * up, match the metrics of unweighted SPF after every change
+ */
+TEST(LinkStateTest, HopCountsUpdate) {
+  // grid of kSize x kSize nodes
+  const int kSize = 6;
+  const int kNumNodes = kSize * kSize;
+  std::mt19937 gen(4321);
+  std::uniform_int_distribution<int> nodeDist(0, kNumNodes - 1);
+  std::uniform_int_distribution<int> metricDist(1, 4);
+  std::uniform_int_distribution<int> actionDist(0, 9);
+
+  // adjacent node to metric of adjacency, per node
+  std::vector<std::map<int, int>> adjMetrics(kNumNodes);
+  for (int i = 0; i < kNumNodes; ++i) {
+    if (i % kSize != kSize - 1) {
+      adjMetrics[i][i + 1] = adjMetrics[i + 1][i] = 1;
+    }
+    if (i + kSize < kNumNodes) {
+      adjMetrics[i][i + kSize] = adjMetrics[i + kSize][i] = 1;
+    }
+  }
+  std::vector<bool> overloaded(kNumNodes, false);
+
+  openr::LinkState linkState{kTestingAreaName};
+  auto updateNode = [&](int node) {
+    std::vector<openr::thrift::Adjacency> adjs;
+    for (auto const& [adj, metric] : adjMetrics[node]) {
+      adjs.emplace_back(openr::createAdjacency(
+          folly::sformat("{}", adj),
+          folly::sformat("{}/{}", node, adj),
+          folly::sformat("{}/{}", adj, node),
+          folly::sformat("fe80::{}", adj + 1),
+          folly::sformat("10.0.0.{}", adj + 1),
+          metric,
+          100000 + adj));
+    }
+    auto adjDb = openr::createAdjDb(folly::sformat("{}", node), adjs, node + 1);
+    adjDb.isOverloaded_ref() = overloaded[node];
+    linkState.updateAdjacencyDatabase(adjDb, 0, 0);
+  };
+  for (int i = 0; i < kNumNodes; ++i) {
+    updateNode(i);
+  }
+
+  auto verifyHopCounts = [&]() {
+    for (int src : {0, kNumNodes / 2, kNumNodes - 1}) {
+      auto const& srcName = folly::sformat("{}", src);
+      auto const& spfResult = linkState.getSpfResult(srcName, false);
+      openr::LinkStateMetric maxHops = 0;
+      for (int dst = 0; dst < kNumNodes; ++dst) {
+        auto const& dstName = folly::sformat("{}", dst);
+        auto const hops = linkState.getHopsFromAToB(srcName, dstName);
+        if (not spfResult.count(dstName)) {
+          EXPECT_FALSE(hops.has_value());
+          continue;
+        }
+        ASSERT_TRUE(hops.has_value());
+        EXPECT_EQ(spfResult.at(dstName).metric(), hops.value());
+        maxHops = std::max(maxHops, hops.value());
+      }
+      EXPECT_EQ(maxHops, linkState.getMaxHopsToNode(srcName));
+    }
+  };
+  verifyHopCounts();
+
+  for (int iter = 0; iter < 200; ++iter) {
+    const int node = nodeDist(gen);
+    const auto action = actionDist(gen);
+    if (action == 0) {
+      // remove node and bring it back with its adjacencies
+      linkState.deleteAdjacencyDatabase(folly::sformat("{}", node));
+      verifyHopCounts();
+      updateNode(node);
+    } else if (action < 4) {
+      // flap adjacency of a node towards random neighbor
+      auto it = adjMetrics[node].begin();
+      std::advance(it, gen() % adjMetrics[node].size());
+      auto const [adj, metric] = *it;
+      adjMetrics[node].erase(it);
+      updateNode(node);
+      verifyHopCounts();
+      adjMetrics[node].emplace(adj, metric);
+      updateNode(node);
+    } else if (action < 6) {
+      // toggle node overload, i.e. transit through the node
+      overloaded[node] = not overloaded[node];
+      updateNode(node);
+    } else {
+      // change metric of a node's adjacency in single direction
+      for (auto& [adj, metric] : adjMetrics[node]) {
+        if (gen() % 2) {
+          metric = metricDist(gen);
+        }
+      }
+      updateNode(node);
+    }
+    verifyHopCounts();
+  }
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <set>
+
+#include <gtest/gtest.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/common/Util.h>
+#include <openr/decision/LsdbSnapshot.h>
+#include <openr/decision/tests/DecisionTestUtils.h>
+
+using namespace openr;
+
+namespace {
+
+// Timestamps of adjacencies are not part of snapshots
+std::unordered_map<std::string, thrift::AdjacencyDatabase>
+getAdjDbsWithoutTimestamps(LinkState const& linkState) {
+  auto adjDbs = linkState.getAdjacencyDatabases();
+  for (auto& [_, adjDb] : adjDbs) {
+    for (auto& adj : *adjDb.adjacencies_ref()) {
+      *adj.timestamp_ref() = 0;
+    }
+  }
+  return adjDbs;
+}
+
+thrift::PrefixDatabase
+getPrefixDb(const std::string& nodeName, const std::string& prefix) {
+  return createPrefixDb(nodeName, {createPrefixEntry(toIpPrefix(prefix))});
+}
+
+} // namespace
+
+class LsdbSnapshotTestFixture : public ::testing::Test {
+ protected:
+  void
+  SetUp() override {
+    prefixState_.updatePrefixDatabase(getPrefixDb("1", "10.0.0.1/32"));
+    prefixState_.updatePrefixDatabase(getPrefixDb("2", "10.0.0.2/32"));
+    prefixState_.updatePrefixDatabase(getPrefixDb("3", "10.0.0.3/32"));
+  }
+
+  thrift::LsdbSnapshot
+  getFullSnapshot() const {
+    LsdbSnapshotWriter writer("1", 1 /* epoch */, 1 /* version */, false);
+    for (const auto& [node, adjDb] : linkState_.getAdjacencyDatabases()) {
+      writer.addNode(kTestingAreaName, node, &adjDb, prefixState_);
+    }
+    return std::move(writer).build();
+  }
+
+  LinkState linkState_{getLinkState({{1, {2, 3}}, {2, {1, 3}}, {3, {1, 2}}})};
+  PrefixState prefixState_;
+};
+
+TEST_F(LsdbSnapshotTestFixture, FullSnapshotRoundTrip) {
+  apache::thrift::CompactSerializer serializer;
+  auto snapshot = readThriftObjStr<thrift::LsdbSnapshot>(
+      writeThriftObjStr(getFullSnapshot(), serializer), serializer);
+
+  // Every name is stored once
+  const auto& strings = *snapshot.strings_ref();
+  EXPECT_EQ(
+      strings.size(),
+      std::set<std::string>(strings.begin(), strings.end()).size());
+  EXPECT_EQ(3, snapshot.nodes_ref()->size());
+
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  PrefixState prefixState;
+  prefixState.updatePrefixDatabase(getPrefixDb("4", "10.0.0.4/32"));
+  applyLsdbSnapshot(snapshot, areaLinkStates, prefixState);
+
+  ASSERT_EQ(1, areaLinkStates.size());
+  EXPECT_EQ(
+      getAdjDbsWithoutTimestamps(linkState_),
+      getAdjDbsWithoutTimestamps(areaLinkStates.at(kTestingAreaName)));
+  // Prefixes not in full snapshot are withdrawn
+  EXPECT_EQ(
+      prefixState_.getPrefixDatabases(), prefixState.getPrefixDatabases());
+}
+
+TEST_F(LsdbSnapshotTestFixture, DeltaSnapshot) {
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  PrefixState prefixState;
+  applyLsdbSnapshot(getFullSnapshot(), areaLinkStates, prefixState);
+
+  // Node 3 goes away and node 2 changes its prefix
+  linkState_.deleteAdjacencyDatabase("3");
+  prefixState_.updatePrefixDatabase(createPrefixDb("3", {}));
+  prefixState_.updatePrefixDatabase(getPrefixDb("2", "10.0.0.22/32"));
+
+  LsdbSnapshotWriter writer("1", 1 /* epoch */, 2 /* version */, true);
+  writer.addNode(kTestingAreaName, "3", nullptr, prefixState_);
+  writer.addNode(
+      kTestingAreaName,
+      "2",
+      &linkState_.getAdjacencyDatabases().at("2"),
+      prefixState_);
+  applyLsdbSnapshot(std::move(writer).build(), areaLinkStates, prefixState);
+
+  EXPECT_FALSE(areaLinkStates.at(kTestingAreaName).hasNode("3"));
+  EXPECT_EQ(
+      getAdjDbsWithoutTimestamps(linkState_),
+      getAdjDbsWithoutTimestamps(areaLinkStates.at(kTestingAreaName)));
+  EXPECT_EQ(
+      prefixState_.getPrefixDatabases(), prefixState.getPrefixDatabases());
+}
+
+TEST_F(LsdbSnapshotTestFixture, InvalidSnapshot) {
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  PrefixState prefixState;
+
+  auto snapshot = getFullSnapshot();
+  *snapshot.formatVersion_ref() += 1;
+  EXPECT_THROW(
+      applyLsdbSnapshot(snapshot, areaLinkStates, prefixState),
+      std::invalid_argument);
+
+  snapshot = getFullSnapshot();
+  *snapshot.nodes_ref()->at(0).nodeName_ref() = snapshot.strings_ref()->size();
+  EXPECT_THROW(
+      applyLsdbSnapshot(snapshot, areaLinkStates, prefixState),
+      std::invalid_argument);
+}
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/Util.h>
+#include <openr/decision/NextHopGroup.h>
+#include <openr/decision/RibEntry.h>
+
+using namespace openr;
+
+namespace {
+const auto nh1 = createNextHop(toBinaryAddress("fe80::1"), "iface1", 1);
+const auto nh2 = createNextHop(toBinaryAddress("fe80::2"), "iface2", 1);
+const auto nh3 = createNextHop(toBinaryAddress("fe80::3"), "iface3", 2);
+} // namespace
+
+TEST(NextHopGroupTest, Interning) {
+  const auto numGroups = NextHopGroup::numGroups();
+  {
+    auto group1 = NextHopGroup::intern({nh1, nh2});
+    auto group2 = NextHopGroup::intern({nh2, nh1});
+    auto group3 = NextHopGroup::intern({nh1, nh3});
+
+    // equal sets are interned into the same group
+    EXPECT_EQ(group1, group2);
+    EXPECT_EQ(group1->id(), group2->id());
+    EXPECT_NE(group1, group3);
+    EXPECT_NE(group1->id(), group3->id());
+    EXPECT_THAT(group1->nexthops(), testing::UnorderedElementsAre(nh1, nh2));
+    EXPECT_EQ(numGroups + 2, NextHopGroup::numGroups());
+
+    // empty set is always interned
+    EXPECT_EQ(NextHopGroup::empty(), NextHopGroup::intern({}));
+  }
+  // groups are released along with their last reference
+  EXPECT_EQ(numGroups, NextHopGroup::numGroups());
+}
+
+TEST(NextHopGroupTest, NextHops) {
+  NextHops nexthops1{nh1, nh2};
+  NextHops nexthops2 = NextHopSet{nh1};
+  EXPECT_NE(nexthops1, nexthops2);
+  EXPECT_TRUE(NextHops().empty());
+
+  // modifications intern new group without altering others sharing the old
+  auto nexthops3 = nexthops2;
+  nexthops2.emplace(nh2);
+  EXPECT_EQ(nexthops1, nexthops2);
+  EXPECT_EQ(nexthops1.group(), nexthops2.group());
+  EXPECT_THAT(nexthops3, testing::UnorderedElementsAre(nh1));
+
+  EXPECT_EQ(0, nexthops2.erase(nh3));
+  EXPECT_EQ(1, nexthops2.erase(nh2));
+  EXPECT_EQ(nexthops3, nexthops2);
+  EXPECT_EQ(1, nexthops2.count(nh1));
+  EXPECT_EQ(0, nexthops2.count(nh2));
+
+  // routes with same next-hops share the group
+  RibUnicastEntry route1(folly::IPAddress::createNetwork("fc00::1/128"), {nh1});
+  RibUnicastEntry route2(folly::IPAddress::createNetwork("fc00::2/128"), {nh1});
+  EXPECT_EQ(route1.nexthops.group(), route2.nexthops.group());
+}
+
+TEST(NextHopGroupTest, ConcurrentInterning) {
+  const auto numGroups = NextHopGroup::numGroups();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([]() {
+      for (int j = 0; j < 1000; ++j) {
+        auto group = NextHopGroup::intern({nh1, j % 2 ? nh2 : nh3});
+        EXPECT_EQ(2, group->nexthops().size());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(numGroups, NextHopGroup::numGroups());
+}
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
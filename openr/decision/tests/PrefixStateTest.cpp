@@ -11,6 +11,7 @@
 #include <openr/common/NetworkUtil.h>
 #include <openr/common/Util.h>
 #include <openr/decision/PrefixState.h>
+#include <openr/decision/tests/DecisionTestUtils.h>
 
 using namespace openr;
 
@@ -93,6 +94,118 @@ TEST_F(PrefixStateTestFixture, basicOperation) {
       testing::UnorderedElementsAreArray(affectedPrefixes));
 }
 
+/**
+ * Verifies that prefix entries are shared and only replaced on change
+ */
+TEST_F(PrefixStateTestFixture, sharedPrefixEntries) {
+  auto const& [nodeName, prefixDb] = *prefixDbs_.begin();
+  NodeAndArea const nodeAndArea{nodeName, kTestingAreaName};
+  auto const& entry = prefixDb.prefixEntries_ref()->at(0);
+  auto const entryPtr =
+      state_.prefixes().at(*entry.prefix_ref()).at(nodeAndArea);
+  EXPECT_EQ(entry, *entryPtr);
+
+  // re-advertisement without change keeps the entry
+  EXPECT_TRUE(state_.updatePrefixDatabase(prefixDb).empty());
+  EXPECT_EQ(
+      entryPtr, state_.prefixes().at(*entry.prefix_ref()).at(nodeAndArea));
+
+  // update replaces the entry and leaves the previous one untouched
+  auto prefixDbUpdated = prefixDb;
+  prefixDbUpdated.prefixEntries_ref()->at(0).type_ref() =
+      thrift::PrefixType::BREEZE;
+  EXPECT_FALSE(state_.updatePrefixDatabase(prefixDbUpdated).empty());
+  auto const& updatedPtr =
+      state_.prefixes().at(*entry.prefix_ref()).at(nodeAndArea);
+  EXPECT_NE(entryPtr, updatedPtr);
+  EXPECT_EQ(prefixDbUpdated.prefixEntries_ref()->at(0), *updatedPtr);
+  EXPECT_EQ(entry, *entryPtr);
+}
+
+/**
+ * Verifies that metric vectors are stored sorted by priority and that
+ * re-advertisement of an unsorted vector isn't seen as change
+ */
+TEST(PrefixState, SortedMetricVectors) {
+  PrefixState state;
+  const NodeAndArea nodeAndArea{"1", kTestingAreaName};
+  const auto prefix = toIpPrefix("10.0.0.1/32");
+
+  auto entry = createPrefixEntry(prefix, thrift::PrefixType::BGP);
+  entry.mv_ref() = thrift::MetricVector();
+  for (int64_t priority : {1, 3, 2}) {
+    entry.mv_ref()->metrics_ref()->emplace_back(
+        MetricVectorUtils::createMetricEntity(
+            priority /* type */,
+            priority,
+            thrift::CompareType::WIN_IF_PRESENT,
+            false /* isBestPathTieBreaker */,
+            {priority}));
+  }
+  ASSERT_FALSE(MetricVectorUtils::isSorted(*entry.mv_ref()));
+
+  EXPECT_TRUE(state.updatePrefix(nodeAndArea, entry));
+  auto const entryPtr = state.prefixes().at(prefix).at(nodeAndArea);
+  EXPECT_TRUE(MetricVectorUtils::isSorted(*entryPtr->mv_ref()));
+  EXPECT_EQ(3, *entryPtr->mv_ref()->metrics_ref()->at(0).priority_ref());
+  // advertised entry is left untouched
+  EXPECT_EQ(1, *entry.mv_ref()->metrics_ref()->at(0).priority_ref());
+
+  EXPECT_FALSE(state.updatePrefix(nodeAndArea, entry));
+  EXPECT_EQ(entryPtr, state.prefixes().at(prefix).at(nodeAndArea));
+}
+
+/**
+ * Verifies reachable-only view of prefix entries follows SPF reachability
+ */
+TEST(PrefixState, ReachablePrefixEntries) {
+  PrefixState state;
+  auto const anycast = toIpPrefix("10.0.0.0/8");
+  for (auto const& node : {"1", "2", "3"}) {
+    state.updatePrefixDatabase(createPrefixDb(
+        node,
+        {createPrefixEntry(anycast),
+         createPrefixEntry(toIpPrefix(folly::sformat("10.0.0.{}/32", node)))}));
+  }
+  auto getReachableNodes = [&state](thrift::IpPrefix const& prefix) {
+    std::set<std::string> nodes;
+    if (auto entries = state.getReachablePrefixEntries(prefix)) {
+      for (auto const& [nodeAndArea, _] : *entries) {
+        nodes.emplace(nodeAndArea.first);
+      }
+    }
+    return nodes;
+  };
+
+  // 1---2---3
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  areaLinkStates.emplace(
+      kTestingAreaName, getLinkState({{1, {2}}, {2, {1, 3}}, {3, {2}}}));
+  EXPECT_FALSE(state.isReachabilityCurrent("1", areaLinkStates));
+  state.updateReachability("1", areaLinkStates);
+  EXPECT_TRUE(state.isReachabilityCurrent("1", areaLinkStates));
+  EXPECT_THAT(getReachableNodes(anycast), testing::ElementsAre("1", "2", "3"));
+
+  // node 3 becomes unreachable
+  areaLinkStates.at(kTestingAreaName).deleteAdjacencyDatabase("3");
+  EXPECT_FALSE(state.isReachabilityCurrent("1", areaLinkStates));
+  state.updateReachability("1", areaLinkStates);
+  EXPECT_THAT(getReachableNodes(anycast), testing::ElementsAre("1", "2"));
+  EXPECT_THAT(getReachableNodes(toIpPrefix("10.0.0.3/32")), testing::IsEmpty());
+
+  // withdrawals and advertisements update the view
+  state.updatePrefixDatabase(createPrefixDb("2"));
+  EXPECT_THAT(getReachableNodes(anycast), testing::ElementsAre("1"));
+  state.updatePrefixDatabase(createPrefixDb("2", {createPrefixEntry(anycast)}));
+  EXPECT_THAT(getReachableNodes(anycast), testing::ElementsAre("1", "2"));
+
+  // view of another node is computed from scratch
+  EXPECT_FALSE(state.isReachabilityCurrent("3", areaLinkStates));
+  state.updateReachability("3", areaLinkStates);
+  EXPECT_TRUE(state.isReachabilityCurrent("3", areaLinkStates));
+  EXPECT_THAT(getReachableNodes(anycast), testing::ElementsAre("3"));
+}
+
 /**
  * Verifies `getReceivedRoutesFiltered` with all filter combinations
  */
@@ -213,6 +326,41 @@ TEST(PrefixState, GetReceivedRoutes) {
     EXPECT_EQ("area0", route.key_ref()->area_ref().value());
   }
 
+  //
+  // Filter on the node-name, across areas
+  //
+  {
+    thrift::ReceivedRouteFilter filter;
+    filter.nodeName_ref() = "node0";
+
+    auto routes = state.getReceivedRoutesFiltered(filter);
+    ASSERT_EQ(1, routes.size());
+
+    auto& routeDetail = routes.at(0);
+    EXPECT_EQ(*routeDetail.prefix_ref(), *prefixEntry.prefix_ref());
+    ASSERT_EQ(2, routeDetail.routes_ref()->size());
+    for (auto const& route : *routeDetail.routes_ref()) {
+      EXPECT_EQ("node0", route.key_ref()->node_ref().value());
+    }
+  }
+
+  //
+  // Filter on the node-name and area-name
+  //
+  {
+    thrift::ReceivedRouteFilter filter;
+    filter.nodeName_ref() = "node0";
+    filter.areaName_ref() = "area1";
+
+    auto routes = state.getReceivedRoutesFiltered(filter);
+    ASSERT_EQ(1, routes.size());
+    ASSERT_EQ(1, routes.at(0).routes_ref()->size());
+
+    auto& route = routes.at(0).routes_ref()->at(0);
+    EXPECT_EQ("node0", route.key_ref()->node_ref().value());
+    EXPECT_EQ("area1", route.key_ref()->area_ref().value());
+  }
+
   //
   // Filter on unknown area or node
   //
@@ -222,6 +370,30 @@ TEST(PrefixState, GetReceivedRoutes) {
 
     auto routes = state.getReceivedRoutesFiltered(filter);
     ASSERT_EQ(0, routes.size());
+
+    filter.areaName_ref().reset();
+    filter.nodeName_ref() = "unknown";
+    EXPECT_EQ(0, state.getReceivedRoutesFiltered(filter).size());
+  }
+
+  //
+  // Node and area filters follow withdrawals
+  //
+  {
+    state.updatePrefixDatabase(createPrefixDb("node0", {}, "area0"));
+
+    thrift::ReceivedRouteFilter filter;
+    filter.areaName_ref() = "area0";
+    EXPECT_EQ(0, state.getReceivedRoutesFiltered(filter).size());
+
+    filter.areaName_ref().reset();
+    filter.nodeName_ref() = "node0";
+    auto routes = state.getReceivedRoutesFiltered(filter);
+    ASSERT_EQ(1, routes.size());
+    ASSERT_EQ(1, routes.at(0).routes_ref()->size());
+    EXPECT_EQ(
+        "area1",
+        routes.at(0).routes_ref()->at(0).key_ref()->area_ref().value());
   }
 }
 
@@ -245,7 +417,7 @@ TEST(PrefixState, FilterReceivedRoutes) {
  * Test PrefixState::hasConflictingForwardingInfo
  */
 TEST(PrefixState, HasConflictingForwardingInfo) {
-  std::unordered_map<NodeAndArea, thrift::PrefixEntry> prefixEntries;
+  PrefixEntries prefixEntries;
 
   thrift::PrefixEntry pIpSpf, pMplsSpf, pMplsKspf;
   pIpSpf.forwardingType_ref() = thrift::PrefixForwardingType::IP;
@@ -256,6 +428,9 @@ TEST(PrefixState, HasConflictingForwardingInfo) {
   pMplsKspf.forwardingType_ref() = thrift::PrefixForwardingType::SR_MPLS;
   pMplsKspf.forwardingAlgorithm_ref() =
       thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP;
+  auto const ipSpf = std::make_shared<thrift::PrefixEntry const>(pIpSpf);
+  auto const mplsSpf = std::make_shared<thrift::PrefixEntry const>(pMplsSpf);
+  auto const mplsKspf = std::make_shared<thrift::PrefixEntry const>(pMplsKspf);
 
   //
   // Empty case
@@ -265,25 +440,25 @@ TEST(PrefixState, HasConflictingForwardingInfo) {
   //
   // Single entry (doesn't conflict)
   //
-  prefixEntries = {{{"0", "0"}, pIpSpf}};
+  prefixEntries = {{{"0", "0"}, ipSpf}};
   EXPECT_FALSE(PrefixState::hasConflictingForwardingInfo(prefixEntries));
 
   //
   // Multiple entries conflicting type
   //
-  prefixEntries = {{{"0", "0"}, pIpSpf}, {{"1", "1"}, pMplsSpf}};
+  prefixEntries = {{{"0", "0"}, ipSpf}, {{"1", "1"}, mplsSpf}};
   EXPECT_TRUE(PrefixState::hasConflictingForwardingInfo(prefixEntries));
 
   //
   // Multiple entries conflicting algorithm
   //
-  prefixEntries = {{{"0", "0"}, pMplsSpf}, {{"1", "1"}, pMplsKspf}};
+  prefixEntries = {{{"0", "0"}, mplsSpf}, {{"1", "1"}, mplsKspf}};
   EXPECT_TRUE(PrefixState::hasConflictingForwardingInfo(prefixEntries));
 
   //
   // Multiple entries (no conflicts)
   //
-  prefixEntries = {{{"0", "0"}, pMplsSpf}, {{"1", "1"}, pMplsSpf}};
+  prefixEntries = {{{"0", "0"}, mplsSpf}, {{"1", "1"}, mplsSpf}};
   EXPECT_FALSE(PrefixState::hasConflictingForwardingInfo(prefixEntries));
 }
 
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+
+#include <openr/common/Util.h>
+#include <openr/decision/RibPolicy.h>
+
+namespace {
+
+// Number of prefixes matched by every policy statement
+const size_t kPrefixesPerStatement = 10;
+
+folly::CIDRNetwork
+getPrefix(size_t idx) {
+  return folly::IPAddress::createNetwork(
+      folly::sformat("fc00:{:x}:{:x}::/64", idx >> 16, idx & 0xffff));
+}
+
+} // namespace
+
+namespace openr {
+
+/**
+ * Apply policy of numStatements statements on numRoutes routes. Statements
+ * match every other route so that half of the routes get transformed.
+ */
+static void
+BM_RibPolicyApply(uint32_t iters, size_t numStatements, size_t numRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+
+  thrift::RibPolicy tPolicy;
+  for (size_t i = 0; i < numStatements; ++i) {
+    thrift::RibPolicyStatement stmt;
+    *stmt.name_ref() = folly::sformat("stmt{}", i);
+    stmt.matcher_ref()->prefixes_ref() = std::vector<thrift::IpPrefix>();
+    for (size_t j = 0; j < kPrefixesPerStatement; ++j) {
+      const auto idx = 2 * (i * kPrefixesPerStatement + j);
+      stmt.matcher_ref()->prefixes_ref()->emplace_back(
+          toIpPrefix(getPrefix(idx % std::max<size_t>(numRoutes, 1))));
+    }
+    stmt.action_ref()->set_weight_ref() = thrift::RibRouteActionWeight{};
+    stmt.action_ref()->set_weight_ref()->default_weight_ref() = 1;
+    tPolicy.statements_ref()->emplace_back(std::move(stmt));
+  }
+  tPolicy.ttl_secs_ref() = 3600;
+  const RibPolicy policy(tPolicy);
+
+  const auto nh = createNextHop(
+      toBinaryAddress("fe80::1"), "iface1", 0, std::nullopt, "area1");
+  std::unordered_map<folly::CIDRNetwork, RibUnicastEntry> entries;
+  for (size_t i = 0; i < numRoutes; ++i) {
+    const auto prefix = getPrefix(i);
+    entries.emplace(prefix, RibUnicastEntry(prefix, {nh}));
+  }
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; i++) {
+    auto change = policy.applyPolicy(entries);
+    folly::doNotOptimizeAway(change);
+  }
+}
+
+// The integer parameters are number of statements and number of routes
+BENCHMARK_NAMED_PARAM(BM_RibPolicyApply, 1_1000, 1, 1000);
+BENCHMARK_NAMED_PARAM(BM_RibPolicyApply, 10_1000, 10, 1000);
+BENCHMARK_NAMED_PARAM(BM_RibPolicyApply, 100_1000, 100, 1000);
+BENCHMARK_NAMED_PARAM(BM_RibPolicyApply, 1_100000, 1, 100000);
+BENCHMARK_NAMED_PARAM(BM_RibPolicyApply, 100_100000, 100, 100000);
+BENCHMARK_NAMED_PARAM(BM_RibPolicyApply, 1000_100000, 1000, 100000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
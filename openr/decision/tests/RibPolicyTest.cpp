@@ -233,6 +233,50 @@ TEST(RibPolicy, ApplyAction) {
   }
 }
 
+/**
+ * Test intends to verify that statements sharing a prefix are tried in order
+ * and that a statement invalidating all next-hops falls through to the next.
+ */
+TEST(RibPolicy, ApplyActionStatementOrder) {
+  const auto stmt1 =
+      createPolicyStatement({toIpPrefix("fc01::/64")}, 0, {{"area3", 5}});
+  const auto stmt2 = createPolicyStatement(
+      {toIpPrefix("fc01::/64"), toIpPrefix("fc02::/64")}, 2, {});
+  const auto stmt3 = createPolicyStatement({toIpPrefix("fc02::/64")}, 3, {});
+  auto policy = RibPolicy(createPolicy({stmt1, stmt2, stmt3}, 1));
+
+  const auto nh1 = createNextHop(
+      toBinaryAddress("fe80::1"), "iface1", 0, std::nullopt, "area1");
+
+  // stmt1 invalidates all next-hops, stmt2 gets applied
+  {
+    RibUnicastEntry entry(folly::IPAddress::createNetwork("fc01::/64"), {nh1});
+    EXPECT_TRUE(policy.match(entry));
+    EXPECT_TRUE(policy.applyAction(entry));
+
+    auto expectNh1 = nh1;
+    expectNh1.weight_ref() = 2;
+    EXPECT_THAT(entry.nexthops, testing::UnorderedElementsAre(expectNh1));
+  }
+
+  // stmt2 precedes stmt3
+  {
+    RibUnicastEntry entry(folly::IPAddress::createNetwork("fc02::/64"), {nh1});
+    EXPECT_TRUE(policy.applyAction(entry));
+
+    auto expectNh1 = nh1;
+    expectNh1.weight_ref() = 2;
+    EXPECT_THAT(entry.nexthops, testing::UnorderedElementsAre(expectNh1));
+  }
+
+  // Less specific prefix doesn't match
+  {
+    RibUnicastEntry entry(folly::IPAddress::createNetwork("fc01::/48"), {nh1});
+    EXPECT_FALSE(policy.match(entry));
+    EXPECT_FALSE(policy.applyAction(entry));
+  }
+}
+
 TEST(RibPolicy, ApplyPolicy) {
   const auto stmt1 = createPolicyStatement(
       {toIpPrefix("fc01::/64")}, 1, {{"area1", 99}}, {{"nbr3", 98}});
@@ -0,0 +1,263 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/IPAddress.h>
+#include <gflags/gflags.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/Util.h>
+#include <openr/decision/RouteDamping.h>
+
+using namespace openr;
+
+namespace {
+
+const auto kPrefix = folly::IPAddress::createNetwork("fc00::/64");
+const auto kOtherPrefix = folly::IPAddress::createNetwork("fc00:1::/64");
+
+const auto kNextHop1 = createNextHop(toBinaryAddress("fe80::1"), "iface1");
+const auto kNextHop2 = createNextHop(toBinaryAddress("fe80::2"), "iface2");
+const auto kNextHop3 = createNextHop(toBinaryAddress("fe80::3"), "iface3");
+
+// penalty 1000, suppress above 2000, reuse below 750, half-life 10s and
+// reuse within 40s of the last flap
+thrift::RouteDampingConfig
+getDampingConfig() {
+  thrift::RouteDampingConfig config;
+  config.half_life_s_ref() = 10;
+  config.max_suppress_time_s_ref() = 40;
+  return config;
+}
+
+DecisionRouteUpdate
+getRouteUpdate(folly::CIDRNetwork const& prefix, NextHops nexthops) {
+  DecisionRouteUpdate update;
+  update.addRouteToUpdate(RibUnicastEntry(prefix, std::move(nexthops)));
+  return update;
+}
+
+DecisionRouteUpdate
+getRouteDelete(folly::CIDRNetwork const& prefix) {
+  DecisionRouteUpdate update;
+  update.unicastRoutesToDelete.emplace_back(prefix);
+  return update;
+}
+
+} // namespace
+
+class RouteDampingTestFixture : public ::testing::Test {
+ protected:
+  // apply update to damping and then to the routes Fib has
+  DecisionRouteUpdate
+  apply(DecisionRouteUpdate update) {
+    damping_.apply(update, unicastRoutes_, now_);
+    for (auto const& prefix : update.unicastRoutesToDelete) {
+      unicastRoutes_.erase(prefix);
+    }
+    for (auto const& [prefix, route] : update.unicastRoutesToUpdate) {
+      unicastRoutes_.insert_or_assign(prefix, route);
+    }
+    return update;
+  }
+
+  // flap route of prefix from kNextHop1 to withdrawn and back
+  void
+  flap(folly::CIDRNetwork const& prefix) {
+    apply(getRouteDelete(prefix));
+    apply(getRouteUpdate(prefix, {kNextHop1}));
+  }
+
+  // announce prefix and change its route until it's suppressed with penalty
+  // of 3000 and Fib has kNextHop1 and kNextHop2
+  void
+  suppress(folly::CIDRNetwork const& prefix) {
+    apply(getRouteUpdate(prefix, {kNextHop1, kNextHop2}));
+    apply(getRouteDelete(prefix));
+    apply(getRouteUpdate(prefix, {kNextHop1, kNextHop2}));
+    apply(getRouteUpdate(prefix, {kNextHop1, kNextHop2, kNextHop3}));
+    apply(getRouteUpdate(prefix, {kNextHop1, kNextHop2}));
+  }
+
+  RouteDamping damping_{getDampingConfig()};
+  std::unordered_map<folly::CIDRNetwork, RibUnicastEntry> unicastRoutes_;
+  RouteDamping::Clock::time_point now_{RouteDamping::Clock::now()};
+};
+
+/**
+ * Announcement of new prefix is not penalized, withdrawals and changes of
+ * next-hops are. Prefix is suppressed once penalty exceeds suppress
+ * threshold, additions of next-hops are held back from then on
+ */
+TEST_F(RouteDampingTestFixture, SuppressFlappingPrefix) {
+  auto update = apply(getRouteUpdate(kPrefix, {kNextHop1}));
+  EXPECT_EQ(1, update.unicastRoutesToUpdate.size());
+  EXPECT_EQ(0, damping_.getNumPrefixes());
+
+  // first withdrawal and next-hop change go through
+  flap(kPrefix);
+  update = apply(getRouteUpdate(kPrefix, {kNextHop1, kNextHop2}));
+  EXPECT_EQ(1, update.unicastRoutesToUpdate.size());
+  EXPECT_FALSE(damping_.isSuppressed(kPrefix));
+  EXPECT_DOUBLE_EQ(2000, damping_.getMaxPenalty(now_));
+
+  // third change exceeds suppress threshold and is held back
+  update = apply(getRouteUpdate(kPrefix, {kNextHop1, kNextHop2, kNextHop3}));
+  EXPECT_TRUE(update.unicastRoutesToUpdate.empty());
+  EXPECT_TRUE(damping_.isSuppressed(kPrefix));
+  EXPECT_EQ(1, damping_.getNumSuppressed());
+  EXPECT_EQ(
+      RibUnicastEntry(kPrefix, {kNextHop1, kNextHop2}),
+      unicastRoutes_.at(kPrefix));
+
+  // routes of other prefixes are not affected
+  update = apply(getRouteUpdate(kOtherPrefix, {kNextHop1}));
+  EXPECT_EQ(1, update.unicastRoutesToUpdate.size());
+
+  auto states = damping_.getStates(now_);
+  ASSERT_EQ(1, states.size());
+  EXPECT_EQ(toIpPrefix(kPrefix), *states.at(0).prefix_ref());
+  EXPECT_DOUBLE_EQ(3000, *states.at(0).penalty_ref());
+  EXPECT_TRUE(*states.at(0).suppressed_ref());
+  // 3000 decays to 750 in two half-lifes
+  EXPECT_EQ(20000, states.at(0).reuseInMs_ref().value_or(0));
+}
+
+/**
+ * Changes removing next-hops of suppressed prefix are applied, Fib keeps the
+ * next-hops it has and the new route still has. Added next-hops and metric
+ * changes are held back
+ */
+TEST_F(RouteDampingTestFixture, NextHopRemovalWhileSuppressed) {
+  suppress(kPrefix);
+  ASSERT_TRUE(damping_.isSuppressed(kPrefix));
+
+  // removal of kNextHop2 only goes through as is
+  auto update = apply(getRouteUpdate(kPrefix, {kNextHop1}));
+  ASSERT_EQ(1, update.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      RibUnicastEntry(kPrefix, {kNextHop1}), unicastRoutes_.at(kPrefix));
+
+  // metric change of remaining next-hop is held back
+  const auto metricNextHop1 =
+      createNextHop(toBinaryAddress("fe80::1"), "iface1", 10);
+  update = apply(getRouteUpdate(kPrefix, {metricNextHop1}));
+  EXPECT_TRUE(update.unicastRoutesToUpdate.empty());
+  EXPECT_EQ(
+      RibUnicastEntry(kPrefix, {kNextHop1}), unicastRoutes_.at(kPrefix));
+
+  // replacing all next-hops withdraws the route, its new next-hops are held
+  update = apply(getRouteUpdate(kPrefix, {kNextHop2, kNextHop3}));
+  EXPECT_TRUE(update.unicastRoutesToUpdate.empty());
+  EXPECT_THAT(update.unicastRoutesToDelete, testing::ElementsAre(kPrefix));
+  EXPECT_EQ(0, unicastRoutes_.count(kPrefix));
+
+  // and so is the route of the prefix while it's withdrawn
+  update = apply(getRouteUpdate(kPrefix, {kNextHop1, kNextHop2}));
+  EXPECT_TRUE(update.unicastRoutesToUpdate.empty());
+  EXPECT_EQ(0, unicastRoutes_.count(kPrefix));
+}
+
+/**
+ * Route of suppressed prefix keeps the next-hops Fib has and the new route
+ * still has when next-hops are both added and removed
+ */
+TEST_F(RouteDampingTestFixture, NextHopReplacementWhileSuppressed) {
+  suppress(kPrefix);
+  ASSERT_TRUE(damping_.isSuppressed(kPrefix));
+
+  auto update = apply(getRouteUpdate(kPrefix, {kNextHop1, kNextHop3}));
+  ASSERT_EQ(1, update.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      RibUnicastEntry(kPrefix, {kNextHop1}),
+      update.unicastRoutesToUpdate.at(kPrefix));
+
+  // withdrawal goes through as well
+  update = apply(getRouteDelete(kPrefix));
+  EXPECT_THAT(update.unicastRoutesToDelete, testing::ElementsAre(kPrefix));
+  EXPECT_TRUE(unicastRoutes_.empty());
+}
+
+/**
+ * Held back change reported again, e.g. by a full rebuild, is held back
+ * without being penalized again
+ */
+TEST_F(RouteDampingTestFixture, RepeatedHeldChangeNotPenalized) {
+  suppress(kPrefix);
+  ASSERT_TRUE(damping_.isSuppressed(kPrefix));
+
+  auto update = apply(getRouteUpdate(kPrefix, {kNextHop1, kNextHop3}));
+  EXPECT_EQ(1, update.unicastRoutesToUpdate.size());
+  const auto penalty = damping_.getMaxPenalty(now_);
+
+  update = apply(getRouteUpdate(kPrefix, {kNextHop1, kNextHop3}));
+  EXPECT_TRUE(update.unicastRoutesToUpdate.empty());
+  EXPECT_DOUBLE_EQ(penalty, damping_.getMaxPenalty(now_));
+}
+
+/**
+ * Suppressed prefix is reused once penalty decayed below reuse threshold,
+ * and forgotten once it decayed below half of reuse threshold
+ */
+TEST_F(RouteDampingTestFixture, ReuseAfterDecay) {
+  suppress(kPrefix);
+  ASSERT_TRUE(damping_.isSuppressed(kPrefix));
+
+  // penalty of 3000 decays to 1500 after one half-life
+  now_ += std::chrono::seconds(10);
+  EXPECT_TRUE(damping_.reuse(now_).empty());
+  EXPECT_NEAR(1500, damping_.getMaxPenalty(now_), 1e-6);
+
+  // and falls below 750 after two
+  now_ += std::chrono::seconds(11);
+  EXPECT_THAT(damping_.reuse(now_), testing::ElementsAre(kPrefix));
+  EXPECT_FALSE(damping_.isSuppressed(kPrefix));
+  EXPECT_EQ(0, damping_.getNumSuppressed());
+  EXPECT_EQ(1, damping_.getNumPrefixes());
+
+  // route changes go through again
+  auto update = apply(getRouteUpdate(kPrefix, {kNextHop1, kNextHop3}));
+  EXPECT_EQ(1, update.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      RibUnicastEntry(kPrefix, {kNextHop1, kNextHop3}),
+      unicastRoutes_.at(kPrefix));
+
+  now_ += std::chrono::seconds(30);
+  EXPECT_TRUE(damping_.reuse(now_).empty());
+  EXPECT_EQ(0, damping_.getNumPrefixes());
+}
+
+/**
+ * Penalty is capped, prefix which stops flapping is reused within max
+ * suppress time however long it flapped before
+ */
+TEST_F(RouteDampingTestFixture, MaxSuppressTime) {
+  apply(getRouteUpdate(kPrefix, {kNextHop1}));
+  for (int i = 0; i < 100; ++i) {
+    flap(kPrefix);
+  }
+  ASSERT_TRUE(damping_.isSuppressed(kPrefix));
+  // 750 * 2^(40s / 10s)
+  EXPECT_DOUBLE_EQ(12000, damping_.getMaxPenalty(now_));
+
+  now_ += std::chrono::seconds(40) - std::chrono::milliseconds(1);
+  EXPECT_TRUE(damping_.reuse(now_).empty());
+  now_ += std::chrono::milliseconds(2);
+  EXPECT_THAT(damping_.reuse(now_), testing::ElementsAre(kPrefix));
+}
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -62,6 +62,7 @@ sendRecvUpdate(
   addPerfEvent(perfEvents, nodeName, "DECISION_INIT_UPDATE");
 
   // Add adjs to publication
+  newPub.area_ref() = kTestingAreaName.t;
   (*newPub.keyVals_ref())[folly::sformat("adj:{}", nodeName)] =
       decisionWrapper->createAdjValue(
           nodeName, 2, adjs, std::move(perfEvents), overloadBit);
@@ -210,6 +211,7 @@ createGrid(
   LOG(INFO) << "grid: " << n << " by " << n;
   LOG(INFO) << " number of prefixes " << numPrefixes;
   thrift::Publication initialPub;
+  initialPub.area_ref() = kTestingAreaName.t;
 
   // Grid topology
   for (int row = 0; row < n; ++row) {
@@ -361,6 +363,7 @@ createFabric(
     const int numOfRswsPerPod) {
   LOG(INFO) << "Pods number: " << numOfPods;
   thrift::Publication initialPub;
+  initialPub.area_ref() = kTestingAreaName.t;
 
   // ssw: each ssw connects to one fsw of each pod
   auto numOfPlanes = numOfFswsPerPod;
@@ -478,6 +481,80 @@ updateRandomGridAdjs(
       decisionWrapper, newPub, nodeName, adjs, processTimes, overloadBit);
 }
 
+//
+// Create publication of event on node at grid(row, col)
+//
+thrift::Publication
+createGridEventPublication(
+    const std::shared_ptr<DecisionWrapper>& decisionWrapper,
+    DecisionEvent event,
+    const int row,
+    const int col,
+    const int n,
+    const int64_t version,
+    const bool revert) {
+  thrift::Publication pub;
+  pub.area_ref() = kTestingAreaName.t;
+  const auto nodeId = row * n + col;
+  const auto nodeName = folly::sformat("{}", nodeId);
+
+  if (event == DecisionEvent::PREFIX_CHURN) {
+    // Same prefix as advertised by createGrid() plus one no other node has
+    std::vector<thrift::IpPrefix> prefixes{toIpPrefix(nodeToPrefixV6(nodeId))};
+    if (not revert) {
+      prefixes.emplace_back(toIpPrefix(nodeToPrefixV6(nodeId + n * n)));
+    }
+    (*pub.keyVals_ref())[folly::sformat("prefix:{}", nodeName)] =
+        decisionWrapper->createPrefixValue(
+            nodeName, version, prefixes, SP_ECMP);
+    return pub;
+  }
+
+  auto adjs = createGridAdjacencys(row, col, n);
+  bool overloadBit{false};
+  switch (event) {
+  case DecisionEvent::LINK_FLAP:
+    if (not revert) {
+      adjs.erase(adjs.begin());
+    }
+    break;
+  case DecisionEvent::METRIC_CHANGE:
+    adjs.front().metric_ref() = revert ? 1 : 2;
+    break;
+  case DecisionEvent::NODE_OVERLOAD:
+    overloadBit = not revert;
+    break;
+  default:
+    LOG(FATAL) << "Event is not carried by adjacencies";
+  }
+  (*pub.keyVals_ref())[folly::sformat("adj:{}", nodeName)] =
+      decisionWrapper->createAdjValue(
+          nodeName, version, adjs, std::nullopt, overloadBit);
+  return pub;
+}
+
+//
+// Create RibPolicy setting weight of routes towards numPrefixes random nodes
+//
+thrift::RibPolicy
+createGridRibPolicy(
+    const int n, const size_t numPrefixes, const int32_t weight) {
+  thrift::RibPolicyStatement stmt;
+  *stmt.name_ref() = "benchmark";
+  stmt.matcher_ref()->prefixes_ref() = std::vector<thrift::IpPrefix>();
+  for (size_t i = 0; i < numPrefixes; ++i) {
+    stmt.matcher_ref()->prefixes_ref()->emplace_back(
+        toIpPrefix(nodeToPrefixV6(folly::Random::rand32() % (n * n))));
+  }
+  stmt.action_ref()->set_weight_ref() = thrift::RibRouteActionWeight{};
+  stmt.action_ref()->set_weight_ref()->default_weight_ref() = weight;
+
+  thrift::RibPolicy policy;
+  policy.statements_ref()->emplace_back(std::move(stmt));
+  policy.ttl_secs_ref() = 3600;
+  return policy;
+}
+
 //
 // Get average processTimes and insert as user counters.
 //
@@ -628,4 +705,58 @@ BM_DecisionFabric(
   // Insert processTimes as user counters
   insertUserCounters(counters, iters, processTimes, std::nullopt);
 }
+
+//
+// Benchmark test for events on converged grid topology. Reports time through
+// publication processing and route rebuild per event
+//
+void
+BM_DecisionGridEvent(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfSws,
+    DecisionEvent event) {
+  auto suspender = folly::BenchmarkSuspender();
+  const std::string nodeName{"1"};
+  auto decisionWrapper = std::make_shared<DecisionWrapper>(nodeName);
+  const int n = std::sqrt(numOfSws);
+  auto initialPub = createGrid(decisionWrapper, n, 1, SP_ECMP);
+
+  // Converge on initial topology first
+  decisionWrapper->sendKvPublication(initialPub);
+  decisionWrapper->recvMyRouteDb();
+
+  // RibPolicy matches routes towards 1% of nodes
+  const size_t numPolicyPrefixes = std::max(1, n * n / 100);
+
+  int row{0};
+  int col{0};
+  uint64_t totalTimeUs{0};
+  for (uint32_t i = 0; i < iters; i++) {
+    // Every other event reverts the previous one on the same node
+    const bool revert = i % 2;
+    if (not revert) {
+      row = folly::Random::rand32() % n;
+      col = folly::Random::rand32() % n;
+    }
+
+    std::chrono::microseconds time;
+    if (event == DecisionEvent::RIB_POLICY) {
+      auto policy = createGridRibPolicy(n, numPolicyPrefixes, revert ? 1 : 2);
+      time = suspender.dismissing(
+          [&]() { return decisionWrapper->setRibPolicy(policy); });
+    } else {
+      auto pub = createGridEventPublication(
+          decisionWrapper, event, row, col, n, i + 2, revert);
+      time = suspender.dismissing([&]() {
+        return decisionWrapper->processPublicationAndRebuild(pub);
+      });
+    }
+    totalTimeUs += time.count();
+  }
+
+  // Time within decision thread, except for RibPolicy updates which include
+  // the hop to it
+  counters["event_us"] = totalTimeUs / (iters == 0 ? 1 : iters);
+}
 } // namespace openr
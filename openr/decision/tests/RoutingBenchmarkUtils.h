@@ -108,7 +108,7 @@ class DecisionWrapper {
   DecisionRouteUpdate
   recvMyRouteDb() {
     auto maybeRouteDb = routeUpdatesQueueReader.get();
-    auto routeDb = maybeRouteDb.value();
+    auto routeDb = *maybeRouteDb.value();
     return routeDb;
   }
 
@@ -161,7 +161,52 @@ class DecisionWrapper {
   // publish routeDb
   void
   sendKvPublication(const thrift::Publication& publication) {
-    kvStoreUpdatesQueue.push(publication);
+    kvStoreUpdatesQueue.push(
+        std::make_shared<const thrift::Publication>(publication));
+  }
+
+  /**
+   * Process publication and rebuild routes in decision thread right away,
+   * bypassing batching and debounce, and receive the resulting route update.
+   * Returns the time spent in Decision::processPublication and
+   * Decision::rebuildRoutes
+   */
+  std::chrono::microseconds
+  processPublicationAndRebuild(const thrift::Publication& publication) {
+    bool rebuilt{false};
+    folly::Promise<std::chrono::microseconds> p;
+    auto sf = p.getSemiFuture();
+    decision->runInEventBaseThread(
+        [this, &publication, &rebuilt, p = std::move(p)]() mutable {
+          const auto start = std::chrono::steady_clock::now();
+          decision->processPublication(publication);
+          if (decision->pendingUpdates_.needsRouteUpdate()) {
+            decision->rebuildRoutes("DECISION_BENCHMARK");
+            rebuilt = true;
+          }
+          p.setValue(std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start));
+        });
+    auto duration = std::move(sf).get();
+    if (rebuilt) {
+      recvMyRouteDb();
+    }
+    return duration;
+  }
+
+  /**
+   * Set RibPolicy and receive the resulting route update. Returns the time
+   * till the policy got applied to routes, including the hop to decision
+   * thread
+   */
+  std::chrono::microseconds
+  setRibPolicy(const thrift::RibPolicy& ribPolicy) {
+    const auto start = std::chrono::steady_clock::now();
+    decision->setRibPolicy(ribPolicy).get();
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    recvMyRouteDb();
+    return duration;
   }
 
  private:
@@ -190,10 +235,10 @@ class DecisionWrapper {
   CompactSerializer serializer{};
 
   std::shared_ptr<Config> config;
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue;
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  messaging::ReplicateQueue<KvStorePublicationPtr> kvStoreUpdatesQueue;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
-  messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueueReader{
+  messaging::RQueue<DecisionRouteUpdatePtr> routeUpdatesQueueReader{
       routeUpdatesQueue.getReader()};
 
   // KvStore owned by this wrapper.
@@ -346,6 +391,41 @@ void updateRandomGridAdjs(
     const int n,
     std::vector<uint64_t>& processTimes);
 
+/**
+ * Event replayed on converged grid topology by BM_DecisionGridEvent. Every
+ * other event reverts the previous one
+ */
+enum class DecisionEvent {
+  // Link of a random node goes down, then back up
+  LINK_FLAP,
+  // Metric of a link of a random node changes, then back
+  METRIC_CHANGE,
+  // Random node gets overloaded, then back
+  NODE_OVERLOAD,
+  // Random node advertises an additional prefix, then withdraws it
+  PREFIX_CHURN,
+  // RibPolicy changing weights of routes of random nodes gets set
+  RIB_POLICY,
+};
+
+//
+// Create publication of event on node at grid(row, col)
+//
+thrift::Publication createGridEventPublication(
+    const std::shared_ptr<DecisionWrapper>& decisionWrapper,
+    DecisionEvent event,
+    const int row,
+    const int col,
+    const int n,
+    const int64_t version,
+    const bool revert);
+
+//
+// Create RibPolicy setting weight of routes towards numPrefixes random nodes
+//
+thrift::RibPolicy createGridRibPolicy(
+    const int n, const size_t numPrefixes, const int32_t weight);
+
 //
 // Get average processTimes and insert as user counters.
 //
@@ -374,6 +454,22 @@ void BM_DecisionFabric(
     uint32_t numOfSws,
     thrift::PrefixForwardingAlgorithm /* TODO use this */);
 
+//
+// Benchmark test for events on converged grid topology. Reports time through
+// publication processing and route rebuild per event
+//
+void BM_DecisionGridEvent(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfSws,
+    DecisionEvent event);
+
 const auto SP_ECMP = thrift::PrefixForwardingAlgorithm::SP_ECMP;
 const auto KSP2_ED_ECMP = thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP;
+
+const auto LINK_FLAP = DecisionEvent::LINK_FLAP;
+const auto METRIC_CHANGE = DecisionEvent::METRIC_CHANGE;
+const auto NODE_OVERLOAD = DecisionEvent::NODE_OVERLOAD;
+const auto PREFIX_CHURN = DecisionEvent::PREFIX_CHURN;
+const auto RIB_POLICY = DecisionEvent::RIB_POLICY;
 } // namespace openr
@@ -59,19 +59,52 @@ DualStateMachine::processEvent(DualEvent event, bool fc) {
   }
 }
 
+// class DualNeighbors methods
+
+size_t
+DualNeighbors::getOrAddIndex(const std::string& neighbor) {
+  auto [it, inserted] = indices_.emplace(neighbor, entries_.size());
+  if (inserted) {
+    entries_.emplace_back();
+    entries_.back().name = neighbor;
+  }
+  return it->second;
+}
+
+std::optional<size_t>
+DualNeighbors::getIndex(const std::string& neighbor) const noexcept {
+  auto it = indices_.find(neighbor);
+  if (it == indices_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void
+DualNeighbors::setDistance(size_t index, int64_t distance) noexcept {
+  auto& entry = entries_[index];
+  if (not entry.hasDistance) {
+    entry.hasDistance = true;
+    ++numWithDistance_;
+  }
+  entry.distance = distance;
+}
+
 // class Dual methods
 
 Dual::Dual(
     const std::string& nodeId,
     const std::string& rootId,
-    const std::unordered_map<std::string, int64_t>& localDistance,
+    const DualNeighbors& neighbors,
     std::function<void(
         const std::optional<std::string>& oldNh,
-        const std::optional<std::string>& newNh)> nexthopChangeCb)
+        const std::optional<std::string>& newNh)> nexthopChangeCb,
+    std::function<void(std::chrono::microseconds duration)> diffusingDoneCb)
     : nodeId(nodeId),
       rootId(rootId),
-      localDistances_(localDistance),
-      nexthopCb_(std::move(nexthopChangeCb)) {
+      neighbors_(neighbors),
+      nexthopCb_(std::move(nexthopChangeCb)),
+      diffusingDoneCb_(std::move(diffusingDoneCb)) {
   // set distance to 0 if I'm the root, otherwise default to inf
   if (rootId == nodeId) {
     info_.distance = 0;
@@ -81,6 +114,49 @@ Dual::Dual(
   }
 }
 
+Dual::NeighborInfo&
+Dual::getNeighborInfo(size_t neighbor) {
+  if (neighbor >= info_.neighborInfos.size()) {
+    info_.neighborInfos.resize(neighbors_.size());
+  }
+  return info_.neighborInfos[neighbor];
+}
+
+int64_t
+Dual::getReportDistance(size_t neighbor) const noexcept {
+  if (neighbor >= info_.neighborInfos.size()) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return info_.neighborInfos[neighbor].reportDistance;
+}
+
+int64_t
+Dual::getDistanceVia(size_t neighbor) const noexcept {
+  return addDistances(
+      neighbors_.getDistance(neighbor), getReportDistance(neighbor));
+}
+
+thrift::DualPerRootCounters&
+Dual::getNeighborCounters(size_t neighbor) {
+  if (neighbor >= counters_.size()) {
+    counters_.resize(neighbors_.size());
+  }
+  return counters_[neighbor];
+}
+
+void
+Dual::setNexthop(const std::optional<size_t>& nexthop) {
+  std::optional<std::string> newNh{std::nullopt};
+  if (nexthop.has_value()) {
+    newNh = neighbors_.getName(*nexthop);
+  }
+  if (nexthopCb_) {
+    nexthopCb_(info_.nexthop, newNh);
+  }
+  info_.nexthop = std::move(newNh);
+  nexthopIndex_ = nexthop;
+}
+
 int64_t
 Dual::getMinDistance() {
   if (nodeId == rootId) {
@@ -88,17 +164,15 @@ Dual::getMinDistance() {
     return 0;
   }
   int64_t dmin = std::numeric_limits<int64_t>::max();
-  for (const auto& kv : localDistances_) {
-    const auto& ld = kv.second;
-    const auto& rd = info_.neighborInfos[kv.first].reportDistance;
-    dmin = std::min(dmin, addDistances(ld, rd));
+  for (size_t i = 0; i < neighbors_.size(); ++i) {
+    dmin = std::min(dmin, getDistanceVia(i));
   }
   return dmin;
 }
 
 bool
 Dual::routeAffected() {
-  if (localDistances_.size() == 0) {
+  if (neighbors_.numWithDistance() == 0) {
     // no neighbor
     return false;
   }
@@ -121,46 +195,40 @@ Dual::routeAffected() {
     return false;
   }
 
-  std::unordered_set<std::string> nexthops;
-  for (const auto& kv : localDistances_) {
-    const auto& neighbor = kv.first;
-    const auto& ld = kv.second;
-    const auto& rd = info_.neighborInfos[neighbor].reportDistance;
-    int64_t d = addDistances(ld, rd);
-    if (d == dmin) {
-      nexthops.emplace(neighbor);
-    }
-  }
-
   // nexthop MUST has value, if it's none, it will be handled in
   // above "distance changed" or "no valid route found" cases
-  CHECK(info_.nexthop.has_value());
-  if (nexthops.count(*info_.nexthop) == 0) {
+  CHECK(nexthopIndex_.has_value());
+  if (getDistanceVia(*nexthopIndex_) != dmin) {
     // nextHop changed
-    auto oldnh = info_.nexthop.has_value() ? *info_.nexthop : "none";
-    VLOG(2) << rootId << "::" << nodeId << ": nexthop changed " << oldnh
-            << " -> " << folly::join(",", nexthops);
+    std::vector<std::string> nexthops;
+    for (size_t i = 0; i < neighbors_.size(); ++i) {
+      if (getDistanceVia(i) == dmin) {
+        nexthops.emplace_back(neighbors_.getName(i));
+      }
+    }
+    VLOG(2) << rootId << "::" << nodeId << ": nexthop changed "
+            << *info_.nexthop << " -> " << folly::join(",", nexthops);
     return true;
   }
   return false;
 }
 
 bool
-Dual::meetFeasibleCondition(std::string& nexthop, int64_t& distance) {
+Dual::meetFeasibleCondition(size_t& nexthop, int64_t& distance) {
   int64_t dmin = getMinDistance();
   // find feasible nexthop according to SNC(source node condition)
-  for (const auto& kv : localDistances_) {
-    const auto& neighbor = kv.first;
-    const auto& ld = kv.second;
+  for (size_t i = 0; i < neighbors_.size(); ++i) {
+    const auto ld = neighbors_.getDistance(i);
     if (ld == std::numeric_limits<int64_t>::max()) {
       // skip down neighbor
       continue;
     }
-    const auto& rd = info_.neighborInfos[neighbor].reportDistance;
+    const auto rd = getReportDistance(i);
     if (rd < info_.feasibleDistance and addDistances(ld, rd) == dmin) {
-      VLOG(2) << rootId << "::" << nodeId << ": meet FC: " << neighbor << ", "
-              << rd << ", " << dmin;
-      nexthop = neighbor;
+      VLOG(2) << rootId << "::" << nodeId
+              << ": meet FC: " << neighbors_.getName(i) << ", " << rd << ", "
+              << dmin;
+      nexthop = i;
       distance = dmin;
       return true;
     }
@@ -169,37 +237,33 @@ Dual::meetFeasibleCondition(std::string& nexthop, int64_t& distance) {
 }
 
 void
-Dual::floodUpdates(
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+Dual::floodUpdates(std::vector<thrift::DualMessages>& msgsToSend) {
   thrift::DualMessage msg;
   *msg.dstId_ref() = rootId;
   msg.distance_ref() = info_.reportDistance;
   msg.type_ref() = thrift::DualMessageType::UPDATE;
 
-  for (const auto& kv : localDistances_) {
-    const auto& neighbor = kv.first;
-    if (kv.second == std::numeric_limits<int64_t>::max()) {
+  for (size_t i = 0; i < neighbors_.size(); ++i) {
+    if (not neighborUp(i)) {
       // skip down neighbor
       continue;
     }
-    msgsToSend[neighbor].messages_ref()->emplace_back(msg);
-    (*counters_[neighbor].updateSent_ref())++;
-    (*counters_[neighbor].totalSent_ref())++;
+    msgsToSend[i].messages_ref()->emplace_back(msg);
+    auto& counters = getNeighborCounters(i);
+    (*counters.updateSent_ref())++;
+    (*counters.totalSent_ref())++;
   }
 }
 
 void
 Dual::localComputation(
-    const std::string& newNexthop,
+    size_t newNexthop,
     int64_t newDistance,
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+    std::vector<thrift::DualMessages>& msgsToSend) {
   bool sameRd = newDistance == info_.reportDistance;
   // perform local update
-  if (info_.nexthop != newNexthop) {
-    if (nexthopCb_) {
-      nexthopCb_(info_.nexthop, newNexthop);
-    }
-    info_.nexthop = newNexthop;
+  if (nexthopIndex_ != newNexthop) {
+    setNexthop(newNexthop);
   }
   info_.distance = newDistance;
   info_.reportDistance = newDistance;
@@ -211,12 +275,10 @@ Dual::localComputation(
 }
 
 bool
-Dual::diffusingComputation(
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+Dual::diffusingComputation(std::vector<thrift::DualMessages>& msgsToSend) {
   // maintain current nexthop, update other fields
-  auto ld = localDistances_[*info_.nexthop];
-  auto rd = info_.neighborInfos[*info_.nexthop].reportDistance;
-  int64_t newDistance = addDistances(ld, rd);
+  CHECK(nexthopIndex_.has_value());
+  int64_t newDistance = getDistanceVia(*nexthopIndex_);
   info_.distance = newDistance;
   info_.reportDistance = newDistance;
   info_.feasibleDistance = newDistance;
@@ -229,17 +291,17 @@ Dual::diffusingComputation(
   msg.distance_ref() = info_.reportDistance;
   msg.type_ref() = thrift::DualMessageType::QUERY;
 
-  for (const auto& kv : localDistances_) {
-    const auto& neighbor = kv.first;
-    if (kv.second == std::numeric_limits<int64_t>::max()) {
+  for (size_t i = 0; i < neighbors_.size(); ++i) {
+    if (not neighborUp(i)) {
       // skip down neighbor
       continue;
     }
 
-    msgsToSend[neighbor].messages_ref()->emplace_back(msg);
-    (*counters_[neighbor].querySent_ref())++;
-    (*counters_[neighbor].totalSent_ref())++;
-    info_.neighborInfos[neighbor].expectReply = true;
+    msgsToSend[i].messages_ref()->emplace_back(msg);
+    auto& counters = getNeighborCounters(i);
+    (*counters.querySent_ref())++;
+    (*counters.totalSent_ref())++;
+    getNeighborInfo(i).expectReply = true;
     success = true;
   }
   return success;
@@ -249,7 +311,7 @@ void
 Dual::tryLocalOrDiffusing(
     const DualEvent& event,
     bool needReply,
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+    std::vector<thrift::DualMessages>& msgsToSend) {
   auto affected = routeAffected();
   if (not affected) {
     if (needReply) {
@@ -258,8 +320,8 @@ Dual::tryLocalOrDiffusing(
     return;
   }
 
-  std::string newNexthop;
-  int64_t newDistance;
+  size_t newNexthop{0};
+  int64_t newDistance{0};
   bool fc = meetFeasibleCondition(newNexthop, newDistance);
   if (not info_.nexthop.has_value()) {
     CHECK_EQ(fc, true) << "my nexthop was invalid, must meet FC";
@@ -280,14 +342,11 @@ Dual::tryLocalOrDiffusing(
     VLOG(2) << rootId << "::" << nodeId << ": start diffusing";
     bool success = diffusingComputation(msgsToSend);
     if (success) {
-      info_.sm.processEvent(event, false);
+      processEvent(event, false);
     }
-    if (info_.nexthop.has_value() and not neighborUp(*info_.nexthop)) {
+    if (nexthopIndex_.has_value() and not neighborUp(*nexthopIndex_)) {
       // current successor is down
-      if (nexthopCb_) {
-        nexthopCb_(info_.nexthop, std::nullopt);
-      }
-      info_.nexthop = std::nullopt;
+      setNexthop(std::nullopt);
     }
   }
 }
@@ -295,12 +354,11 @@ Dual::tryLocalOrDiffusing(
 std::string
 Dual::getStatusString() const noexcept {
   std::vector<std::string> counterStrs;
-  for (const auto& kv : counters_) {
-    const auto& neighbor = kv.first;
-    const auto& counters = kv.second;
+  for (size_t i = 0; i < counters_.size(); ++i) {
+    const auto& counters = counters_[i];
     counterStrs.emplace_back(folly::sformat(
         "{}: Q ({}, {}), R ({}, {}), U ({}, {}), total ({}, {})",
-        neighbor,
+        neighbors_.getName(i),
         *counters.querySent_ref(),
         *counters.queryRecv_ref(),
         *counters.replySent_ref(),
@@ -320,14 +378,30 @@ Dual::getStatusString() const noexcept {
 
 std::map<std::string, thrift::DualPerRootCounters>
 Dual::getCounters() const noexcept {
-  return counters_;
+  std::map<std::string, thrift::DualPerRootCounters> counters;
+  for (size_t i = 0; i < counters_.size(); ++i) {
+    counters.emplace(neighbors_.getName(i), counters_[i]);
+  }
+  return counters;
 }
 
 void
-Dual::clearCounters(const std::string& neighbor) noexcept {
-  if (counters_.count(neighbor) == 0) {
+Dual::processEvent(DualEvent event, bool fc) {
+  const bool wasActive = isActive();
+  info_.sm.processEvent(event, fc);
+  if (not wasActive and isActive()) {
+    activeSince_ = std::chrono::steady_clock::now();
+  } else if (wasActive and not isActive() and diffusingDoneCb_) {
+    diffusingDoneCb_(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - activeSince_));
+  }
+}
+
+void
+Dual::clearCounters(size_t neighbor) noexcept {
+  if (neighbor >= counters_.size()) {
     LOG(WARNING) << "clearCounters called on non-existing neighbor "
-                 << neighbor;
+                 << neighbors_.getName(neighbor);
     return;
   }
   counters_[neighbor] = thrift::DualPerRootCounters();
@@ -357,11 +431,9 @@ Dual::children() const noexcept {
 }
 
 bool
-Dual::neighborUp(const std::string& neighbor) {
-  if (localDistances_.count(neighbor) == 0) {
-    return false;
-  }
-  return localDistances_.at(neighbor) != std::numeric_limits<int64_t>::max();
+Dual::neighborUp(size_t neighbor) const noexcept {
+  return neighbors_.getDistance(neighbor) !=
+      std::numeric_limits<int64_t>::max();
 }
 
 const Dual::RouteInfo&
@@ -377,6 +449,11 @@ Dual::hasValidRoute() const noexcept {
       info_.nexthop.has_value());
 }
 
+bool
+Dual::isActive() const noexcept {
+  return info_.sm.state != DualState::PASSIVE;
+}
+
 std::unordered_set<std::string>
 Dual::sptPeers() const noexcept {
   if (not hasValidRoute()) {
@@ -399,40 +476,31 @@ Dual::addDistances(int64_t d1, int64_t d2) {
 }
 
 void
-Dual::peerUp(
-    const std::string& neighbor,
-    int64_t cost,
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
-  LOG(INFO) << rootId << "::" << nodeId << ": LINK UP event from (" << neighbor
-            << ", " << cost << ")";
+Dual::peerUp(size_t neighbor, std::vector<thrift::DualMessages>& msgsToSend) {
+  LOG(INFO) << rootId << "::" << nodeId << ": LINK UP event from ("
+            << neighbors_.getName(neighbor) << ", "
+            << neighbors_.getDistance(neighbor) << ")";
 
   // reset parent, if I chose this neighbor as parent before, but I didn't
   // receive peer-down event(non-graceful shutdown), reset nexthop and distance
   // as-if we received peer-down event before.
-  if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
-    if (nexthopCb_) {
-      nexthopCb_(info_.nexthop, std::nullopt);
-    }
-    info_.nexthop = std::nullopt;
+  if (nexthopIndex_ == neighbor) {
+    setNexthop(std::nullopt);
     info_.distance = std::numeric_limits<int64_t>::max();
   }
 
-  // update local-distance
-  localDistances_[neighbor] = cost;
-  info_.neighborInfos.emplace(neighbor, NeighborInfo());
-
   if (info_.sm.state == DualState::PASSIVE) {
     // passive
     tryLocalOrDiffusing(DualEvent::OTHERS, false, msgsToSend);
   } else {
     // active
-    if (info_.neighborInfos[neighbor].expectReply) {
+    if (getNeighborInfo(neighbor).expectReply) {
       // I expected a reply from this neighbor before and it just came up
       // this is equivlent to receiving a reply
 
       thrift::DualMessage msg;
       *msg.dstId_ref() = rootId;
-      msg.distance_ref() = info_.neighborInfos[neighbor].reportDistance;
+      msg.distance_ref() = getReportDistance(neighbor);
       msg.type_ref() = thrift::DualMessageType::REPLY;
       processReply(neighbor, msg, msgsToSend);
     }
@@ -447,37 +515,36 @@ Dual::peerUp(
   msg.distance_ref() = info_.reportDistance;
   msg.type_ref() = thrift::DualMessageType::UPDATE;
   msgsToSend[neighbor].messages_ref()->emplace_back(std::move(msg));
-  (*counters_[neighbor].updateSent_ref())++;
-  (*counters_[neighbor].totalSent_ref())++;
+  auto& counters = getNeighborCounters(neighbor);
+  (*counters.updateSent_ref())++;
+  (*counters.totalSent_ref())++;
 
-  if (info_.neighborInfos[neighbor].needToReply) {
-    info_.neighborInfos.at(neighbor).needToReply = false;
+  auto& neighborInfo = getNeighborInfo(neighbor);
+  if (neighborInfo.needToReply) {
+    neighborInfo.needToReply = false;
 
     thrift::DualMessage reply;
     *reply.dstId_ref() = rootId;
     reply.distance_ref() = info_.reportDistance;
     reply.type_ref() = thrift::DualMessageType::REPLY;
     msgsToSend[neighbor].messages_ref()->emplace_back(std::move(reply));
-    (*counters_[neighbor].replySent_ref())++;
-    (*counters_[neighbor].totalSent_ref())++;
+    (*counters.replySent_ref())++;
+    (*counters.totalSent_ref())++;
   }
 }
 
 void
-Dual::peerDown(
-    const std::string& neighbor,
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+Dual::peerDown(size_t neighbor, std::vector<thrift::DualMessages>& msgsToSend) {
   LOG(INFO) << rootId << "::" << nodeId << ": LINK DOWN event from "
-            << neighbor;
+            << neighbors_.getName(neighbor);
   // clear counters
   clearCounters(neighbor);
 
   // remove child
-  removeChild(neighbor);
+  removeChild(neighbors_.getName(neighbor));
 
-  // update local-distance and report-distance
-  localDistances_[neighbor] = std::numeric_limits<int64_t>::max();
-  info_.neighborInfos[neighbor].reportDistance =
+  // update report-distance
+  getNeighborInfo(neighbor).reportDistance =
       std::numeric_limits<int64_t>::max();
   DualEvent event = DualEvent::INCREASE_D;
 
@@ -486,8 +553,8 @@ Dual::peerDown(
     tryLocalOrDiffusing(event, false, msgsToSend);
   } else {
     // active
-    info_.sm.processEvent(event);
-    if (info_.neighborInfos[neighbor].expectReply) {
+    processEvent(event);
+    if (getNeighborInfo(neighbor).expectReply) {
       // expecting a reply from this neighbor, but it goes down
       // equivlent to receing a reply from this guy with max-distance.
 
@@ -502,15 +569,13 @@ Dual::peerDown(
 
 void
 Dual::peerCostChange(
-    const std::string& neighbor,
-    int64_t cost,
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+    size_t neighbor,
+    int64_t oldCost,
+    std::vector<thrift::DualMessages>& msgsToSend) {
+  const auto cost = neighbors_.getDistance(neighbor);
   LOG(INFO) << rootId << "::" << nodeId << ": LINK COST event from ("
-            << neighbor << ", " << cost << ")";
-  DualEvent event = cost > localDistances_[neighbor] ? DualEvent::INCREASE_D
-                                                     : DualEvent::OTHERS;
-  // update local-distance
-  localDistances_[neighbor] = cost;
+            << neighbors_.getName(neighbor) << ", " << cost << ")";
+  DualEvent event = cost > oldCost ? DualEvent::INCREASE_D : DualEvent::OTHERS;
 
   if (info_.sm.state == DualState::PASSIVE) {
     // passive
@@ -518,34 +583,34 @@ Dual::peerCostChange(
   } else {
     // active
     // only update d while leaving rd, fd as-is
-    if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
-      info_.distance = addDistances(
-          cost, info_.neighborInfos[*info_.nexthop].reportDistance);
+    if (nexthopIndex_ == neighbor) {
+      info_.distance = getDistanceVia(neighbor);
     }
-    info_.sm.processEvent(event);
+    processEvent(event);
   }
 }
 
 void
 Dual::processUpdate(
-    const std::string& neighbor,
+    size_t neighbor,
     const thrift::DualMessage& update,
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+    std::vector<thrift::DualMessages>& msgsToSend) {
   CHECK(*update.type_ref() == thrift::DualMessageType::UPDATE);
   CHECK_EQ(*update.dstId_ref(), rootId)
       << "received update dst-id: " << *update.dstId_ref()
       << " != my-root-id: " << rootId;
 
   const auto& rd = *update.distance_ref();
-  VLOG(2) << rootId << "::" << nodeId << ": received UPDATE from (" << neighbor
-          << ", " << rd << ")";
-  (*counters_[neighbor].updateRecv_ref())++;
-  (*counters_[neighbor].totalRecv_ref())++;
+  VLOG(2) << rootId << "::" << nodeId << ": received UPDATE from ("
+          << neighbors_.getName(neighbor) << ", " << rd << ")";
+  auto& counters = getNeighborCounters(neighbor);
+  (*counters.updateRecv_ref())++;
+  (*counters.totalRecv_ref())++;
 
   // update report-distance
-  info_.neighborInfos[neighbor].reportDistance = rd;
+  getNeighborInfo(neighbor).reportDistance = rd;
 
-  if (localDistances_.count(neighbor) == 0) {
+  if (not neighbors_.hasDistance(neighbor)) {
     // received UPDATE before having local info_ (LINK-UP), done here
     return;
   }
@@ -556,19 +621,18 @@ Dual::processUpdate(
   } else {
     // active
     // only update d while leaving rd, fd as-is
-    if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
-      info_.distance = addDistances(localDistances_[*info_.nexthop], rd);
+    if (nexthopIndex_ == neighbor) {
+      info_.distance = getDistanceVia(neighbor);
     }
-    info_.sm.processEvent(DualEvent::OTHERS);
+    processEvent(DualEvent::OTHERS);
   }
 }
 
 void
-Dual::sendReply(
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+Dual::sendReply(std::vector<thrift::DualMessages>& msgsToSend) {
   CHECK_GT(info_.cornet.size(), 0) << "send reply called on empty cornet";
 
-  std::string dstNode = info_.cornet.top();
+  const auto dstNode = info_.cornet.top();
   info_.cornet.pop();
 
   if (not neighborUp(dstNode)) {
@@ -579,7 +643,7 @@ Dual::sendReply(
     // 2. link is up on the other end, I received a query, but I haven't
     //    received a neighbor-up event yet. set pending-reply = true so when
     //    link is up on my end, I can send out reply.
-    info_.neighborInfos[dstNode].needToReply = true;
+    getNeighborInfo(dstNode).needToReply = true;
     return;
   }
 
@@ -589,31 +653,33 @@ Dual::sendReply(
   msg.type_ref() = thrift::DualMessageType::REPLY;
 
   msgsToSend[dstNode].messages_ref()->emplace_back(std::move(msg));
-  (*counters_[dstNode].replySent_ref())++;
-  (*counters_[dstNode].totalSent_ref())++;
+  auto& counters = getNeighborCounters(dstNode);
+  (*counters.replySent_ref())++;
+  (*counters.totalSent_ref())++;
 }
 
 void
 Dual::processQuery(
-    const std::string& neighbor,
+    size_t neighbor,
     const thrift::DualMessage& query,
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+    std::vector<thrift::DualMessages>& msgsToSend) {
   CHECK(*query.type_ref() == thrift::DualMessageType::QUERY);
   CHECK_EQ(*query.dstId_ref(), rootId)
       << "received query dst-id: " << *query.dstId_ref()
       << " != my-root-id: " << rootId;
 
   const auto& rd = *query.distance_ref();
-  VLOG(2) << rootId << "::" << nodeId << ": received QUERY from (" << neighbor
-          << ", " << rd << ")";
-  (*counters_[neighbor].queryRecv_ref())++;
-  (*counters_[neighbor].totalRecv_ref())++;
+  VLOG(2) << rootId << "::" << nodeId << ": received QUERY from ("
+          << neighbors_.getName(neighbor) << ", " << rd << ")";
+  auto& counters = getNeighborCounters(neighbor);
+  (*counters.queryRecv_ref())++;
+  (*counters.totalRecv_ref())++;
 
   // update report-distance
-  info_.neighborInfos[neighbor].reportDistance = rd;
+  getNeighborInfo(neighbor).reportDistance = rd;
   info_.cornet.emplace(neighbor);
   DualEvent event = DualEvent::OTHERS;
-  if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
+  if (nexthopIndex_ == neighbor) {
     event = DualEvent::QUERY_FROM_SUCCESSOR;
   }
 
@@ -622,49 +688,50 @@ Dual::processQuery(
     tryLocalOrDiffusing(event, true /* need reply */, msgsToSend);
   } else {
     // active
-    if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
-      info_.distance = addDistances(
-          localDistances_[*info_.nexthop],
-          info_.neighborInfos[*info_.nexthop].reportDistance);
+    if (nexthopIndex_ == neighbor) {
+      info_.distance = getDistanceVia(neighbor);
     }
-    info_.sm.processEvent(event);
+    processEvent(event);
     sendReply(msgsToSend);
   }
 }
 
 void
 Dual::processReply(
-    const std::string& neighbor,
+    size_t neighbor,
     const thrift::DualMessage& reply,
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+    std::vector<thrift::DualMessages>& msgsToSend) {
   CHECK(*reply.type_ref() == thrift::DualMessageType::REPLY);
   CHECK_EQ(*reply.dstId_ref(), rootId)
       << "received reply dst-id: " << *reply.dstId_ref()
       << " != my-root-id: " << rootId;
 
   const auto& reportDistance = *reply.distance_ref();
-  VLOG(2) << rootId << "::" << nodeId << ": received REPLY from (" << neighbor
-          << ", " << reportDistance << ")";
-  (*counters_[neighbor].replyRecv_ref())++;
-  (*counters_[neighbor].totalRecv_ref())++;
-
-  if (not info_.neighborInfos[neighbor].expectReply) {
+  VLOG(2) << rootId << "::" << nodeId << ": received REPLY from ("
+          << neighbors_.getName(neighbor) << ", " << reportDistance << ")";
+  auto& counters = getNeighborCounters(neighbor);
+  (*counters.replyRecv_ref())++;
+  (*counters.totalRecv_ref())++;
+
+  auto& neighborInfo = getNeighborInfo(neighbor);
+  if (not neighborInfo.expectReply) {
     // received a reply when I don't expect to receive a reply from it
     // this is OK, this can happen when I detect link-down event before I
     // receive the reply, just ignore it.
-    VLOG(2) << rootId << "::" << nodeId << " recv REPLY from " << neighbor
+    VLOG(2) << rootId << "::" << nodeId << " recv REPLY from "
+            << neighbors_.getName(neighbor)
             << " while I dont expect a reply, ignore it";
     return;
   }
 
   // active
   // update report-distance and expect-reply flag
-  info_.neighborInfos[neighbor].reportDistance = reportDistance;
-  info_.neighborInfos[neighbor].expectReply = false;
+  neighborInfo.reportDistance = reportDistance;
+  neighborInfo.expectReply = false;
 
   bool lastReply = true;
-  for (const auto& kv : info_.neighborInfos) {
-    if (kv.second.expectReply) {
+  for (const auto& info : info_.neighborInfos) {
+    if (info.expectReply) {
       lastReply = false;
       break;
     }
@@ -676,30 +743,24 @@ Dual::processReply(
   // step1. all my dependent nodes have either modified their routes as a
   // result of the distance reported by me OR stopped being my dependent
   // Therefore, I'm free to pick the optimal solution
-  info_.sm.processEvent(DualEvent::LAST_REPLY, true);
+  processEvent(DualEvent::LAST_REPLY, true);
 
   int64_t d;
   int64_t dmin = std::numeric_limits<int64_t>::max();
-  std::optional<std::string> newNh{std::nullopt};
-  for (const auto& kv : localDistances_) {
-    const auto& nb = kv.first;
-    const auto& ld = kv.second;
-    const auto& rd = info_.neighborInfos[nb].reportDistance;
-    d = addDistances(ld, rd);
+  std::optional<size_t> newNh{std::nullopt};
+  for (size_t i = 0; i < neighbors_.size(); ++i) {
+    d = getDistanceVia(i);
     if (d < dmin) {
       dmin = d;
-      newNh = nb;
+      newNh = i;
     }
   }
   bool sameRd = dmin == info_.reportDistance;
   info_.distance = dmin;
   info_.reportDistance = dmin;
   info_.feasibleDistance = dmin;
-  if (info_.nexthop != newNh) {
-    if (nexthopCb_) {
-      nexthopCb_(info_.nexthop, newNh);
-    }
-    info_.nexthop = newNh;
+  if (nexthopIndex_ != newNh) {
+    setNexthop(newNh);
   }
   if (not sameRd) {
     floodUpdates(msgsToSend);
@@ -726,12 +787,13 @@ DualNode::DualNode(const std::string& nodeId, bool isRoot)
 void
 DualNode::peerUp(const std::string& neighbor, int64_t cost) {
   // update local-distance
-  localDistances_[neighbor] = cost;
+  const auto index = neighbors_.getOrAddIndex(neighbor);
+  neighbors_.setDistance(index, cost);
 
-  std::unordered_map<std::string, thrift::DualMessages> msgsToSend;
+  std::vector<thrift::DualMessages> msgsToSend(neighbors_.size());
 
   for (auto& kv : duals_) {
-    kv.second.peerUp(neighbor, cost, msgsToSend);
+    kv.second.peerUp(index, msgsToSend);
   }
 
   sendAllDualMessages(msgsToSend);
@@ -740,14 +802,16 @@ DualNode::peerUp(const std::string& neighbor, int64_t cost) {
 void
 DualNode::peerDown(const std::string& neighbor) {
   // update local-distance
-  localDistances_[neighbor] = std::numeric_limits<int64_t>::max();
-  // clear counters
+  const auto index = neighbors_.getOrAddIndex(neighbor);
+  neighbors_.setDistance(index, std::numeric_limits<int64_t>::max());
+  // clear counters, and drop messages pending towards it
   clearCounters(neighbor);
+  pendingMsgs_.erase(neighbor);
 
-  std::unordered_map<std::string, thrift::DualMessages> msgsToSend;
+  std::vector<thrift::DualMessages> msgsToSend(neighbors_.size());
 
   for (auto& kv : duals_) {
-    kv.second.peerDown(neighbor, msgsToSend);
+    kv.second.peerDown(index, msgsToSend);
   }
 
   sendAllDualMessages(msgsToSend);
@@ -756,12 +820,14 @@ DualNode::peerDown(const std::string& neighbor) {
 void
 DualNode::peerCostChange(const std::string& neighbor, int64_t cost) {
   // update local-distance
-  localDistances_[neighbor] = cost;
+  const auto index = neighbors_.getOrAddIndex(neighbor);
+  const auto oldCost = neighbors_.getDistance(index);
+  neighbors_.setDistance(index, cost);
 
-  std::unordered_map<std::string, thrift::DualMessages> msgsToSend;
+  std::vector<thrift::DualMessages> msgsToSend(neighbors_.size());
 
   for (auto& kv : duals_) {
-    kv.second.peerCostChange(neighbor, cost, msgsToSend);
+    kv.second.peerCostChange(index, oldCost, msgsToSend);
   }
 
   sendAllDualMessages(msgsToSend);
@@ -820,8 +886,9 @@ DualNode::getSptPeers(const std::optional<std::string>& rootId) const noexcept {
 
 void
 DualNode::processDualMessages(const thrift::DualMessages& messages) {
-  std::unordered_map<std::string, thrift::DualMessages> msgsToSend;
   const auto& neighbor = *messages.srcId_ref();
+  const auto index = neighbors_.getOrAddIndex(neighbor);
+  std::vector<thrift::DualMessages> msgsToSend(neighbors_.size());
 
   (*counters_[neighbor].pktRecv_ref())++;
   counters_[neighbor].msgRecv_ref() =
@@ -833,15 +900,15 @@ DualNode::processDualMessages(const thrift::DualMessages& messages) {
     auto& dual = duals_.at(rootId);
     switch (*msg.type_ref()) {
     case thrift::DualMessageType::UPDATE: {
-      dual.processUpdate(neighbor, msg, msgsToSend);
+      dual.processUpdate(index, msg, msgsToSend);
       break;
     }
     case thrift::DualMessageType::QUERY: {
-      dual.processQuery(neighbor, msg, msgsToSend);
+      dual.processQuery(index, msg, msgsToSend);
       break;
     }
     case thrift::DualMessageType::REPLY: {
-      dual.processReply(neighbor, msg, msgsToSend);
+      dual.processReply(index, msg, msgsToSend);
       break;
     }
     default: {
@@ -906,10 +973,11 @@ DualNode::getStatusStrings() const noexcept {
 
 bool
 DualNode::neighborUp(const std::string& neighbor) const noexcept {
-  if (localDistances_.count(neighbor) == 0) {
+  const auto index = neighbors_.getIndex(neighbor);
+  if (not index.has_value()) {
     return false;
   }
-  return localDistances_.at(neighbor) != std::numeric_limits<int64_t>::max();
+  return neighbors_.getDistance(*index) != std::numeric_limits<int64_t>::max();
 }
 
 thrift::DualCounters
@@ -922,6 +990,15 @@ DualNode::getCounters() const noexcept {
   return counters;
 }
 
+size_t
+DualNode::getNumActiveDiffusingComputations() const noexcept {
+  size_t numActive{0};
+  for (const auto& [_, dual] : duals_) {
+    numActive += dual.isActive() ? 1 : 0;
+  }
+  return numActive;
+}
+
 void
 DualNode::clearCounters(const std::string& neighbor) noexcept {
   if (counters_.count(neighbor) == 0) {
@@ -933,15 +1010,37 @@ DualNode::clearCounters(const std::string& neighbor) noexcept {
 }
 
 void
-DualNode::sendAllDualMessages(
-    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
-  for (auto& kv : msgsToSend) {
-    const auto& neighbor = kv.first;
-    auto& msgs = kv.second;
+DualNode::sendAllDualMessages(std::vector<thrift::DualMessages>& msgsToSend) {
+  const bool wasPending = not pendingMsgs_.empty();
+  for (size_t i = 0; i < msgsToSend.size(); ++i) {
+    auto& msgs = msgsToSend[i];
     if (msgs.messages_ref()->empty()) {
       // ignore empty messages
       continue;
     }
+    // append to messages pending towards neighbor, in order
+    auto& pendingMsgs = *pendingMsgs_[neighbors_.getName(i)].messages_ref();
+    if (pendingMsgs.empty()) {
+      pendingMsgs = std::move(*msgs.messages_ref());
+    } else {
+      pendingMsgs.insert(
+          pendingMsgs.end(),
+          std::make_move_iterator(msgs.messages_ref()->begin()),
+          std::make_move_iterator(msgs.messages_ref()->end()));
+    }
+  }
+  if (not wasPending and not pendingMsgs_.empty()) {
+    scheduleDualMessagesFlush();
+  }
+}
+
+void
+DualNode::flushDualMessages() noexcept {
+  auto msgsToSend = std::move(pendingMsgs_);
+  pendingMsgs_.clear();
+  for (auto& kv : msgsToSend) {
+    const auto& neighbor = kv.first;
+    auto& msgs = kv.second;
 
     // set srcId = myNodeId
     *msgs.srcId_ref() = nodeId;
@@ -966,7 +1065,11 @@ DualNode::addDual(const std::string& rootId) {
                        const std::optional<std::string>& newNh) {
     processNexthopChange(rootId, oldNh, newNh);
   };
-  duals_.emplace(rootId, Dual(nodeId, rootId, localDistances_, nexthopCb));
+  auto diffusingDoneCb = [this, rootId](std::chrono::microseconds duration) {
+    processDiffusingComputationDone(rootId, duration);
+  };
+  duals_.emplace(
+      rootId, Dual(nodeId, rootId, neighbors_, nexthopCb, diffusingDoneCb));
 }
 
 } // namespace openr
@@ -7,10 +7,14 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <limits>
+#include <optional>
 #include <stack>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <folly/Format.h>
 
@@ -57,6 +61,68 @@ struct DualStateMachine {
   void processEvent(DualEvent event, bool fc = true);
 };
 
+/**
+ * Neighbors of a DualNode along with their local distances, shared by Dual of
+ * all roots. Every neighbor is assigned a dense index on first sight (link
+ * event or dual message) which is never reused. Per-root state is kept in
+ * vectors indexed by it instead of maps keyed by neighbor name, and dual
+ * messages to send are collected the same way.
+ */
+class DualNeighbors {
+ public:
+  // get index of a neighbor, assign next one if not seen yet
+  size_t getOrAddIndex(const std::string& neighbor);
+
+  // get index of a neighbor, none if not seen yet
+  std::optional<size_t> getIndex(const std::string& neighbor) const noexcept;
+
+  // set local distance towards neighbor, max if it's down
+  void setDistance(size_t index, int64_t distance) noexcept;
+
+  const std::string&
+  getName(size_t index) const noexcept {
+    return entries_[index].name;
+  }
+
+  // local distance towards neighbor, max if it's down or never came up
+  int64_t
+  getDistance(size_t index) const noexcept {
+    return entries_[index].distance;
+  }
+
+  // check if received any link event for neighbor
+  bool
+  hasDistance(size_t index) const noexcept {
+    return entries_[index].hasDistance;
+  }
+
+  // number of neighbors with received link events
+  size_t
+  numWithDistance() const noexcept {
+    return numWithDistance_;
+  }
+
+  size_t
+  size() const noexcept {
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    std::string name;
+    int64_t distance{std::numeric_limits<int64_t>::max()};
+    bool hasDistance{false};
+  };
+
+  // map<neighbor: index>
+  std::unordered_map<std::string, size_t> indices_;
+
+  // neighbors by index
+  std::vector<Entry> entries_;
+
+  size_t numWithDistance_{0};
+};
+
 /**
  * DUAL (Diffusing Update Algorithm) Node
  * details refer to: https://www.cs.cornell.edu/people/egs/615/lunes93.pdf
@@ -67,61 +133,64 @@ struct DualStateMachine {
 class Dual {
  public:
   // constructor
-  // takes nodeId, rootId, current local-distances
+  // takes nodeId, rootId, neighbors with local-distances, which must outlive
+  // the Dual, and optional callback invoked with duration of every diffusing
+  // computation once it completed, i.e. on return to PASSIVE
   Dual(
       const std::string& nodeId,
       const std::string& rootId,
-      const std::unordered_map<std::string, int64_t>& localDistance,
+      const DualNeighbors& neighbors,
       std::function<void(
           const std::optional<std::string>& oldNh,
-          const std::optional<std::string>& newNh)> nexthopChangeCb);
+          const std::optional<std::string>& newNh)> nexthopChangeCb,
+      std::function<void(std::chrono::microseconds duration)>
+          diffusingDoneCb = nullptr);
+
+  // NOTE: neighbors are referred to by their index in DualNeighbors and
+  // msgsToSend is indexed the same way, sized to number of neighbors.
+  // Local-distances are updated in DualNeighbors ahead of peer events
 
   // peer up event
-  // input: (neighbor-id, link-metric)
-  // output: map<neighbor-id: dual-messages-to-send>
-  void peerUp(
-      const std::string& neighbor,
-      int64_t cost,
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+  // input: (neighbor-index)
+  // output: vector<dual-messages-to-send>
+  void peerUp(size_t neighbor, std::vector<thrift::DualMessages>& msgsToSend);
 
   // peer down event
-  // input: (neighbor-id)
-  // output: map<neighbor-id: dual-messages-to-send>
-  void peerDown(
-      const std::string& neighbor,
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+  // input: (neighbor-index)
+  // output: vector<dual-messages-to-send>
+  void peerDown(size_t neighbor, std::vector<thrift::DualMessages>& msgsToSend);
 
   // peer cost change event
-  // input: (neighbor-id, new-link-metric)
-  // output: map<neighbor-id: dual-messages-to-send>
+  // input: (neighbor-index, old-link-metric)
+  // output: vector<dual-messages-to-send>
   void peerCostChange(
-      const std::string& neighbor,
-      int64_t cost,
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+      size_t neighbor,
+      int64_t oldCost,
+      std::vector<thrift::DualMessages>& msgsToSend);
 
   // process a DUAL update message
-  // input: (neighbor-id, a update dual-message)
-  // output: map<neighbor-id: dual-messages-to-send>
+  // input: (neighbor-index, a update dual-message)
+  // output: vector<dual-messages-to-send>
   void processUpdate(
-      const std::string& neighbor,
+      size_t neighbor,
       const thrift::DualMessage& update,
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+      std::vector<thrift::DualMessages>& msgsToSend);
 
   // process a DUAL query message
-  // input: (neighbor-id, a query dual-message)
-  // output: map<neighbor-id: dual-messages-to-send>
+  // input: (neighbor-index, a query dual-message)
+  // output: vector<dual-messages-to-send>
   void processQuery(
-      const std::string& neighbor,
+      size_t neighbor,
       const thrift::DualMessage& query,
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+      std::vector<thrift::DualMessages>& msgsToSend);
 
   // process a DUAL reply message
-  // input: (neighbor-id, a reply dual-message)
-  // output: map<neighbor-id: dual-messages-to-send>
+  // input: (neighbor-index, a reply dual-message)
+  // output: vector<dual-messages-to-send>
   void processReply(
-      const std::string& neighbor,
+      size_t neighbor,
       const thrift::DualMessage& reply,
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+      std::vector<thrift::DualMessages>& msgsToSend);
 
   // Neighbor information per destination
   struct NeighborInfo {
@@ -148,10 +217,11 @@ class Dual {
     std::optional<std::string> nexthop{std::nullopt};
     // state machine
     DualStateMachine sm;
-    // neighbor exchanged information <report-distance, expect-reply-flag>
-    std::unordered_map<std::string, NeighborInfo> neighborInfos;
-    // diffusing: track received query
-    std::stack<std::string> cornet{};
+    // neighbor exchanged information <report-distance, expect-reply-flag>,
+    // indexed by neighbor-index. Neighbors beyond its size are at defaults
+    std::vector<NeighborInfo> neighborInfos;
+    // diffusing: track received query by neighbor-index
+    std::stack<size_t> cornet{};
 
     // dump route info into human-friendly string mainly for logging or
     // debugging
@@ -200,6 +270,9 @@ class Dual {
   // check if have a valid route towards root or not
   bool hasValidRoute() const noexcept;
 
+  // check if diffusing computation is in progress, i.e. state is ACTIVE
+  bool isActive() const noexcept;
+
   // get status string (includes route-info and dual-counters)
   std::string getStatusString() const noexcept;
 
@@ -238,50 +311,69 @@ class Dual {
   // if we can find a neighbor whose report-distance < my-feasible-distance
   // AND local-distance + report-distance == current minimum-distance
   // return true, otherwise return false
-  bool meetFeasibleCondition(std::string& nexthop, int64_t& distance);
+  bool meetFeasibleCondition(size_t& nexthop, int64_t& distance);
 
   // flood updates to all my neighbor
-  void floodUpdates(
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+  void floodUpdates(std::vector<thrift::DualMessages>& msgsToSend);
 
   // perform a local computation
   void localComputation(
-      const std::string& newNexthop,
+      size_t newNexthop,
       int64_t newDistance,
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+      std::vector<thrift::DualMessages>& msgsToSend);
 
   // start diffuing computation (when not meet feasible condition)
-  bool diffusingComputation(
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+  bool diffusingComputation(std::vector<thrift::DualMessages>& msgsToSend);
 
   // perform local or diffusing computation depends on if FC is met
   // if needReply: send reply back
   void tryLocalOrDiffusing(
       const DualEvent& event,
       bool needReply,
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+      std::vector<thrift::DualMessages>& msgsToSend);
 
   // helper to add two distances
   static int64_t addDistances(int64_t d1, int64_t d2);
 
   // send a reply back
-  void sendReply(
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+  void sendReply(std::vector<thrift::DualMessages>& msgsToSend);
 
   // check if a neighbor is up or not
-  bool neighborUp(const std::string& neighbor);
+  bool neighborUp(size_t neighbor) const noexcept;
 
   // clear counters to zero for a given neighbor
-  void clearCounters(const std::string& neighbor) noexcept;
+  void clearCounters(size_t neighbor) noexcept;
+
+  // get neighbor info, growing neighbor-infos up to all known neighbors
+  NeighborInfo& getNeighborInfo(size_t neighbor);
+
+  // get neighbor reported distance towards destination
+  int64_t getReportDistance(size_t neighbor) const noexcept;
+
+  // get my distance towards destination via neighbor
+  int64_t getDistanceVia(size_t neighbor) const noexcept;
+
+  // get counters, growing counters up to all known neighbors
+  thrift::DualPerRootCounters& getNeighborCounters(size_t neighbor);
+
+  // set my nexthop towards destination and notify callback
+  void setNexthop(const std::optional<size_t>& nexthop);
+
+  // feed event to state machine, tracking start and end of diffusing
+  // computation
+  void processEvent(DualEvent event, bool fc = true);
 
   // route-info towards root
   RouteInfo info_;
 
-  // local neighbor distances
-  std::unordered_map<std::string, int64_t> localDistances_;
+  // neighbors and their local distances, shared by all roots
+  const DualNeighbors& neighbors_;
+
+  // neighbor-index of info_.nexthop, none if it's invalid or myself
+  std::optional<size_t> nexthopIndex_{std::nullopt};
 
-  // dual messages counters map<neighbor: dual-counters>
-  std::map<std::string, thrift::DualPerRootCounters> counters_;
+  // dual messages counters indexed by neighbor-index
+  std::vector<thrift::DualPerRootCounters> counters_;
 
   // callback when nexthop changed
   const std::function<void(
@@ -289,6 +381,13 @@ class Dual {
       const std::optional<std::string>& newNh)>
       nexthopCb_{nullptr};
 
+  // callback when diffusing computation completed
+  const std::function<void(std::chrono::microseconds duration)>
+      diffusingDoneCb_{nullptr};
+
+  // start of diffusing computation in progress
+  std::chrono::steady_clock::time_point activeSince_;
+
   // spt children
   std::unordered_set<std::string> children_;
 };
@@ -325,6 +424,18 @@ class DualNode {
       const std::string& neighbor,
       const thrift::DualMessages& msgs) noexcept = 0;
 
+  // called once dual messages become pending. Subclass may override it to
+  // defer flushDualMessages(), e.g. to the end of event loop iteration, so
+  // that messages of all roots and events towards a neighbor are coalesced
+  // into single send. Messages are flushed right away by default
+  virtual void
+  scheduleDualMessagesFlush() noexcept {
+    flushDualMessages();
+  }
+
+  // send out all pending dual messages, one send per neighbor
+  void flushDualMessages() noexcept;
+
   // subclass needs to override this api to perform actions when nexthop changes
   // for a given root-id
   virtual void processNexthopChange(
@@ -384,6 +495,16 @@ class DualNode {
   // get dual related counters
   thrift::DualCounters getCounters() const noexcept;
 
+  // get number of roots with diffusing computation in progress
+  size_t getNumActiveDiffusingComputations() const noexcept;
+
+  // called once diffusing computation of a root completed, with its
+  // duration. Subclass may override it to export metrics
+  virtual void
+  processDiffusingComputationDone(
+      const std::string& /* rootId */,
+      std::chrono::microseconds /* duration */) noexcept {}
+
   // myRootId
   const std::string nodeId;
 
@@ -391,9 +512,8 @@ class DualNode {
   const bool isRoot{false};
 
  private:
-  // send out dual messages for a given <neighbor: dual-messages>
-  void sendAllDualMessages(
-      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+  // queue dual messages indexed by neighbor-index to be sent
+  void sendAllDualMessages(std::vector<thrift::DualMessages>& msgsToSend);
 
   // add Dual for a given root-id if not exist yet
   void addDual(const std::string& rootId);
@@ -401,8 +521,11 @@ class DualNode {
   // clear counters to zero for a given neighbor
   void clearCounters(const std::string& neighbor) noexcept;
 
-  // local distances map<neighbor: distance>
-  std::unordered_map<std::string, int64_t> localDistances_;
+  // neighbors and their local distances
+  DualNeighbors neighbors_;
+
+  // dual messages pending to be sent map<neighbor: dual-messages>
+  std::unordered_map<std::string, thrift::DualMessages> pendingMsgs_;
 
   // map<root-id: Dual-object>
   std::map<std::string, Dual> duals_;
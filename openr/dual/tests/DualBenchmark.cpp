@@ -0,0 +1,382 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+
+#include <openr/dual/Dual.h>
+
+namespace {
+
+// Neighbor which is the best nexthop towards all roots
+const std::string kBestNbr{"nbr-0"};
+
+std::string
+getNbrName(size_t index) {
+  return folly::sformat("nbr-{}", index);
+}
+
+} // namespace
+
+namespace openr {
+
+/**
+ * DualNode under measurement. Messages are counted but not delivered
+ */
+class DualBenchmarkNode final : public DualNode {
+ public:
+  explicit DualBenchmarkNode(const std::string& nodeId) : DualNode(nodeId) {}
+
+  bool
+  sendDualMessages(
+      const std::string& /* neighbor */,
+      const thrift::DualMessages& msgs) noexcept override {
+    numSentMessages += msgs.messages_ref()->size();
+    return true;
+  }
+
+  void
+  processNexthopChange(
+      const std::string& /* rootId */,
+      const std::optional<std::string>& /* oldNh */,
+      const std::optional<std::string>& /* newNh */) noexcept override {}
+
+  size_t numSentMessages{0};
+};
+
+/**
+ * UPDATE for all roots from a neighbor. kBestNbr reports distance 1, all
+ * others report distance 2 which doesn't meet feasible condition once
+ * kBestNbr goes away, hence it triggers diffusing computation
+ */
+thrift::DualMessages
+createUpdates(size_t numRoots, size_t nbrIndex) {
+  thrift::DualMessages msgs;
+  *msgs.srcId_ref() = getNbrName(nbrIndex);
+  for (size_t i = 0; i < numRoots; ++i) {
+    thrift::DualMessage msg;
+    *msg.dstId_ref() = folly::sformat("root-{}", i);
+    msg.distance_ref() = nbrIndex == 0 ? 1 : 2;
+    msg.type_ref() = thrift::DualMessageType::UPDATE;
+    msgs.messages_ref()->emplace_back(std::move(msg));
+  }
+  return msgs;
+}
+
+// Bring up all neighbors of node
+void
+peerUpAll(DualBenchmarkNode& node, size_t numNbrs) {
+  for (size_t j = 0; j < numNbrs; ++j) {
+    node.peerUp(getNbrName(j), 1);
+  }
+}
+
+/**
+ * Benchmark for discovery of roots through UPDATEs
+ * 1. Bring up numNbrs neighbors
+ * 2. Process UPDATEs for numRoots roots from every neighbor
+ */
+static void
+BM_DualProcessUpdates(uint32_t iters, size_t numRoots, size_t numNbrs) {
+  auto suspender = folly::BenchmarkSuspender();
+  for (uint32_t i = 0; i < iters; ++i) {
+    DualBenchmarkNode node("dut");
+    peerUpAll(node, numNbrs);
+    std::vector<thrift::DualMessages> updates;
+    for (size_t j = 0; j < numNbrs; ++j) {
+      updates.emplace_back(createUpdates(numRoots, j));
+    }
+
+    suspender.dismiss(); // Start measuring benchmark time
+    for (const auto& msgs : updates) {
+      node.processDualMessages(msgs);
+    }
+    suspender.rehire(); // Stop measuring time again
+  }
+}
+
+/**
+ * Benchmark for flap of the best nexthop towards all roots
+ * 1. Converge numRoots roots over numNbrs neighbors
+ * 2. Bring best neighbor down, which starts diffusing computation for all
+ *    roots, and back up
+ */
+static void
+BM_DualPeerFlap(uint32_t iters, size_t numRoots, size_t numNbrs) {
+  auto suspender = folly::BenchmarkSuspender();
+  for (uint32_t i = 0; i < iters; ++i) {
+    DualBenchmarkNode node("dut");
+    peerUpAll(node, numNbrs);
+    for (size_t j = 0; j < numNbrs; ++j) {
+      node.processDualMessages(createUpdates(numRoots, j));
+    }
+    CHECK_EQ(numRoots, node.getInfos().size());
+
+    suspender.dismiss(); // Start measuring benchmark time
+    node.peerDown(kBestNbr);
+    node.peerUp(kBestNbr, 1);
+    suspender.rehire(); // Stop measuring time again
+  }
+}
+
+/**
+ * DualNode of DualBenchmarkNetwork. Messages are queued in the network until
+ * it delivers them
+ */
+class DualNetworkNode final : public DualNode {
+ public:
+  DualNetworkNode(
+      const std::string& nodeId,
+      bool isRoot,
+      std::deque<std::pair<std::string, thrift::DualMessages>>& queue)
+      : DualNode(nodeId, isRoot), queue_(queue) {}
+
+  bool
+  sendDualMessages(
+      const std::string& neighbor,
+      const thrift::DualMessages& msgs) noexcept override {
+    numSentMessages += msgs.messages_ref()->size();
+    queue_.emplace_back(neighbor, msgs);
+    return true;
+  }
+
+  void
+  processNexthopChange(
+      const std::string& /* rootId */,
+      const std::optional<std::string>& /* oldNh */,
+      const std::optional<std::string>& /* newNh */) noexcept override {}
+
+  void
+  processDiffusingComputationDone(
+      const std::string& /* rootId */,
+      std::chrono::microseconds /* duration */) noexcept override {
+    ++numDiffusingComputations;
+  }
+
+  size_t numSentMessages{0};
+  size_t numDiffusingComputations{0};
+
+ private:
+  std::deque<std::pair<std::string, thrift::DualMessages>>& queue_;
+};
+
+/**
+ * Two tier fabric of DualNetworkNodes in a single thread. Spines are roots
+ * and every leaf is connected to every spine. Messages are delivered in FIFO
+ * order until no more are pending, i.e. SPTs of all roots are stable
+ */
+class DualBenchmarkNetwork {
+ public:
+  DualBenchmarkNetwork(size_t numSpines, size_t numLeaves)
+      : numSpines_(numSpines), numLeaves_(numLeaves) {
+    for (size_t i = 0; i < numSpines; ++i) {
+      addNode(getSpineName(i), true /* isRoot */);
+    }
+    for (size_t j = 0; j < numLeaves; ++j) {
+      addNode(getLeafName(j), false /* isRoot */);
+      for (size_t i = 0; i < numSpines; ++i) {
+        linkUp(i, numSpines + j);
+      }
+    }
+    deliverAll();
+    for (const auto& node : nodes_) {
+      CHECK_EQ(numSpines, node->getInfos().size());
+      CHECK(node->getSptRootId().has_value());
+    }
+  }
+
+  static std::string
+  getSpineName(size_t i) {
+    return folly::sformat("spine-{}", i);
+  }
+
+  static std::string
+  getLeafName(size_t j) {
+    return folly::sformat("leaf-{}", j);
+  }
+
+  void
+  addNode(const std::string& nodeId, bool isRoot) {
+    nodeIndices_.emplace(nodeId, nodes_.size());
+    nodes_.emplace_back(
+        std::make_unique<DualNetworkNode>(nodeId, isRoot, queue_));
+  }
+
+  // Bring link between nodes of given indices up or down on both ends
+  void
+  linkUp(size_t a, size_t b) {
+    nodes_.at(a)->peerUp(nodes_.at(b)->nodeId, 1);
+    nodes_.at(b)->peerUp(nodes_.at(a)->nodeId, 1);
+  }
+  void
+  linkDown(size_t a, size_t b) {
+    nodes_.at(a)->peerDown(nodes_.at(b)->nodeId);
+    nodes_.at(b)->peerDown(nodes_.at(a)->nodeId);
+  }
+
+  // Bring all links of spine of given index up or down
+  void
+  spineUp(size_t i) {
+    for (size_t j = 0; j < numLeaves_; ++j) {
+      linkUp(i, numSpines_ + j);
+    }
+  }
+  void
+  spineDown(size_t i) {
+    for (size_t j = 0; j < numLeaves_; ++j) {
+      linkDown(i, numSpines_ + j);
+    }
+  }
+
+  // Deliver pending messages until no more are sent
+  void
+  deliverAll() {
+    while (not queue_.empty()) {
+      auto [dst, msgs] = std::move(queue_.front());
+      queue_.pop_front();
+      nodes_.at(nodeIndices_.at(dst))->processDualMessages(msgs);
+    }
+  }
+
+  size_t
+  getNumSentMessages() const {
+    size_t numSent{0};
+    for (const auto& node : nodes_) {
+      numSent += node->numSentMessages;
+    }
+    return numSent;
+  }
+
+  size_t
+  getNumDiffusingComputations() const {
+    size_t numDiffusing{0};
+    for (const auto& node : nodes_) {
+      numDiffusing += node->numDiffusingComputations;
+    }
+    return numDiffusing;
+  }
+
+ private:
+  const size_t numSpines_{0};
+  const size_t numLeaves_{0};
+  std::deque<std::pair<std::string, thrift::DualMessages>> queue_;
+  std::vector<std::unique_ptr<DualNetworkNode>> nodes_;
+  std::unordered_map<std::string, size_t> nodeIndices_;
+};
+
+/**
+ * Benchmark for network-wide convergence after failure of a root
+ * 1. Converge SPTs of numSpines roots in fabric of numSpines x numLeaves
+ * 2. Bring all links of a root down and deliver messages until SPTs of all
+ *    roots are stable. Restoring the root is not measured
+ */
+static void
+BM_DualNetworkRootFailure(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numSpines,
+    size_t numLeaves) {
+  auto suspender = folly::BenchmarkSuspender();
+  DualBenchmarkNetwork network(numSpines, numLeaves);
+  size_t numSent{0};
+  size_t numDiffusing{0};
+  for (uint32_t i = 0; i < iters; ++i) {
+    const auto sentStart = network.getNumSentMessages();
+    const auto diffusingStart = network.getNumDiffusingComputations();
+    suspender.dismiss(); // Start measuring benchmark time
+    network.spineDown(0);
+    network.deliverAll();
+    suspender.rehire(); // Stop measuring time again
+    numSent += network.getNumSentMessages() - sentStart;
+    numDiffusing += network.getNumDiffusingComputations() - diffusingStart;
+
+    network.spineUp(0);
+    network.deliverAll();
+  }
+  counters["messages"] = numSent / std::max<uint32_t>(1, iters);
+  counters["diffusing_computations"] =
+      numDiffusing / std::max<uint32_t>(1, iters);
+}
+
+/**
+ * Benchmark for network-wide convergence after failure of a link
+ * 1. Converge SPTs of numSpines roots in fabric of numSpines x numLeaves
+ * 2. Bring link between first spine and first leaf down and deliver messages
+ *    until SPTs of all roots are stable. Restoring the link is not measured
+ */
+static void
+BM_DualNetworkLinkFailure(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numSpines,
+    size_t numLeaves) {
+  auto suspender = folly::BenchmarkSuspender();
+  DualBenchmarkNetwork network(numSpines, numLeaves);
+  size_t numSent{0};
+  size_t numDiffusing{0};
+  for (uint32_t i = 0; i < iters; ++i) {
+    const auto sentStart = network.getNumSentMessages();
+    const auto diffusingStart = network.getNumDiffusingComputations();
+    suspender.dismiss(); // Start measuring benchmark time
+    network.linkDown(0, numSpines);
+    network.deliverAll();
+    suspender.rehire(); // Stop measuring time again
+    numSent += network.getNumSentMessages() - sentStart;
+    numDiffusing += network.getNumDiffusingComputations() - diffusingStart;
+
+    network.linkUp(0, numSpines);
+    network.deliverAll();
+  }
+  counters["messages"] = numSent / std::max<uint32_t>(1, iters);
+  counters["diffusing_computations"] =
+      numDiffusing / std::max<uint32_t>(1, iters);
+}
+
+// The first parameter is number of roots and the second one is number of
+// neighbors
+BENCHMARK_NAMED_PARAM(BM_DualProcessUpdates, 1_16, 1, 16);
+BENCHMARK_NAMED_PARAM(BM_DualProcessUpdates, 16_16, 16, 16);
+BENCHMARK_NAMED_PARAM(BM_DualProcessUpdates, 16_128, 16, 128);
+BENCHMARK_NAMED_PARAM(BM_DualProcessUpdates, 64_128, 64, 128);
+BENCHMARK_NAMED_PARAM(BM_DualProcessUpdates, 64_512, 64, 512);
+
+BENCHMARK_NAMED_PARAM(BM_DualPeerFlap, 1_16, 1, 16);
+BENCHMARK_NAMED_PARAM(BM_DualPeerFlap, 16_16, 16, 16);
+BENCHMARK_NAMED_PARAM(BM_DualPeerFlap, 16_128, 16, 128);
+BENCHMARK_NAMED_PARAM(BM_DualPeerFlap, 64_128, 64, 128);
+BENCHMARK_NAMED_PARAM(BM_DualPeerFlap, 64_512, 64, 512);
+
+// The first parameter is number of spines, i.e. roots, and the second one is
+// number of leaves
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_DualNetworkRootFailure, counters, 2_16, 2, 16);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_DualNetworkRootFailure, counters, 4_64, 4, 64);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_DualNetworkRootFailure, counters, 8_256, 8, 256);
+
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_DualNetworkLinkFailure, counters, 2_16, 2, 16);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_DualNetworkLinkFailure, counters, 4_64, 4, 64);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_DualNetworkLinkFailure, counters, 8_256, 8, 256);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -15,6 +15,7 @@
 #include <folly/io/async/EventBase.h>
 #include <openr/dual/Dual.h>
 
+#include <deque>
 #include <vector>
 
 using namespace openr;
@@ -222,6 +223,86 @@ TEST(Dual, StateMachine) {
   EXPECT_EQ(sm.state, DualState::ACTIVE3);
 }
 
+// DualNode whose messages are queued until test delivers them
+class DualQueuedNode final : public DualNode {
+ public:
+  DualQueuedNode(
+      const std::string& nodeId,
+      bool isRoot,
+      std::deque<std::pair<std::string, thrift::DualMessages>>& queue)
+      : DualNode(nodeId, isRoot), queue_(queue) {}
+
+  bool
+  sendDualMessages(
+      const std::string& neighbor,
+      const thrift::DualMessages& msgs) noexcept override {
+    queue_.emplace_back(neighbor, msgs);
+    return true;
+  }
+
+  void
+  processNexthopChange(
+      const std::string& /* rootId */,
+      const std::optional<std::string>& /* oldNh */,
+      const std::optional<std::string>& /* newNh */) noexcept override {}
+
+  void
+  processDiffusingComputationDone(
+      const std::string& rootId,
+      std::chrono::microseconds /* duration */) noexcept override {
+    diffusingDoneRoots.emplace_back(rootId);
+  }
+
+  // roots of completed diffusing computations
+  std::vector<std::string> diffusingDoneRoots;
+
+ private:
+  std::deque<std::pair<std::string, thrift::DualMessages>>& queue_;
+};
+
+// Loss of successor without feasible successor runs diffusing computation,
+// which completes once the last reply got received
+TEST(DualNode, DiffusingComputationDone) {
+  std::deque<std::pair<std::string, thrift::DualMessages>> queue;
+  std::map<std::string, std::unique_ptr<DualQueuedNode>> nodes;
+  nodes.emplace("r", std::make_unique<DualQueuedNode>("r", true, queue));
+  nodes.emplace("a", std::make_unique<DualQueuedNode>("a", false, queue));
+  nodes.emplace("b", std::make_unique<DualQueuedNode>("b", false, queue));
+  const auto deliver = [&]() {
+    while (not queue.empty()) {
+      auto [dst, msgs] = std::move(queue.front());
+      queue.pop_front();
+      nodes.at(dst)->processDualMessages(msgs);
+    }
+  };
+
+  // Links r-a and r-b of cost 1, a-b of cost 10
+  for (const auto& [node1, node2, cost] :
+       std::vector<std::tuple<std::string, std::string, int64_t>>{
+           {"r", "a", 1}, {"r", "b", 1}, {"a", "b", 10}}) {
+    nodes.at(node1)->peerUp(node2, cost);
+    nodes.at(node2)->peerUp(node1, cost);
+  }
+  deliver();
+  auto& a = *nodes.at("a");
+  ASSERT_TRUE(a.getDual("r").hasValidRoute());
+  EXPECT_EQ("r", a.getInfo("r")->nexthop.value_or(""));
+  a.diffusingDoneRoots.clear();
+
+  // b reports the same distance as a, hence isn't a feasible successor
+  a.peerDown("r");
+  nodes.at("r")->peerDown("a");
+  EXPECT_EQ(1, a.getNumActiveDiffusingComputations());
+  EXPECT_TRUE(a.diffusingDoneRoots.empty());
+
+  deliver();
+  EXPECT_EQ(0, a.getNumActiveDiffusingComputations());
+  EXPECT_EQ(std::vector<std::string>{"r"}, a.diffusingDoneRoots);
+  ASSERT_TRUE(a.getDual("r").hasValidRoute());
+  EXPECT_EQ("b", a.getInfo("r")->nexthop.value_or(""));
+  EXPECT_EQ(11, a.getInfo("r")->distance);
+}
+
 // Dual Implementation Test Node
 class DualTestNode final : public DualNode {
  public:
@@ -229,8 +310,22 @@ class DualTestNode final : public DualNode {
       const std::string& nodeId,
       bool isRoot,
       std::shared_ptr<folly::EventBase> evb,
-      std::map<std::string, std::shared_ptr<DualTestNode>>& nodes)
-      : DualNode(nodeId, isRoot), evb_(std::move(evb)), nodes_(nodes) {}
+      std::map<std::string, std::shared_ptr<DualTestNode>>& nodes,
+      bool deferFlush)
+      : DualNode(nodeId, isRoot),
+        evb_(std::move(evb)),
+        nodes_(nodes),
+        deferFlush_(deferFlush) {}
+
+  // coalesce messages to the end of event loop iteration, as KvStore does
+  void
+  scheduleDualMessagesFlush() noexcept override {
+    if (not deferFlush_) {
+      flushDualMessages();
+      return;
+    }
+    evb_->runInLoop([this]() noexcept { flushDualMessages(); });
+  }
 
   bool
   sendDualMessages(
@@ -263,6 +358,8 @@ class DualTestNode final : public DualNode {
   std::shared_ptr<folly::EventBase> evb_;
   // reference to map<node-id: DualTestNode*>
   std::map<std::string, std::shared_ptr<DualTestNode>>& nodes_;
+  // send pending dual messages at the end of event loop iteration
+  const bool deferFlush_{false};
 };
 
 // Dual test fixture
@@ -287,7 +384,8 @@ class DualBaseFixture : public ::testing::Test {
 
   void
   addNode(const std::string& nodeId, bool isRoot) {
-    auto node = std::make_shared<DualTestNode>(nodeId, isRoot, evb, nodes);
+    auto node =
+        std::make_shared<DualTestNode>(nodeId, isRoot, evb, nodes, deferFlush);
     nodes.emplace(nodeId, node);
     vertices.emplace_back(Vertex{nodeId, true});
     if (isRoot) {
@@ -847,17 +945,29 @@ class DualBaseFixture : public ::testing::Test {
 
   std::vector<Vertex> vertices;
   std::vector<Edge> edges;
+
+  // nodes defer sending of dual messages to the end of loop iteration
+  bool deferFlush{false};
 };
 
 // Test Parameters
 struct TestParam {
   int totalRoots; // number of roots
   bool flap; // flap link/node or not
-  TestParam(int totalRoots, bool flap) : totalRoots(totalRoots), flap(flap) {}
+  bool deferFlush; // coalesce dual messages within loop iteration or not
+  TestParam(int totalRoots, bool flap, bool deferFlush = false)
+      : totalRoots(totalRoots), flap(flap), deferFlush(deferFlush) {}
 };
 
 class DualFixture : public DualBaseFixture,
-                    public ::testing::WithParamInterface<TestParam> {};
+                    public ::testing::WithParamInterface<TestParam> {
+ protected:
+  void
+  SetUp() override {
+    deferFlush = GetParam().deferFlush;
+    DualBaseFixture::SetUp();
+  }
+};
 
 // Test all following different cases for each topology
 INSTANTIATE_TEST_CASE_P(
@@ -869,7 +979,9 @@ INSTANTIATE_TEST_CASE_P(
         TestParam(1, false),
         TestParam(1, true),
         TestParam(2, false),
-        TestParam(2, true)));
+        TestParam(2, true),
+        TestParam(2, false, true /* deferFlush */),
+        TestParam(2, true, true /* deferFlush */)));
 
 /**
  *  Circular Topology
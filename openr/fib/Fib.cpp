@@ -7,9 +7,15 @@
 
 #include "Fib.h"
 
+#include <algorithm>
+#include <deque>
+
 #include <fb303/ServiceData.h>
 #include <fbzmq/service/logging/LogSample.h>
 #include <folly/MapUtil.h>
+#include <folly/ScopeGuard.h>
+#include <folly/tracing/StaticTracepoint.h>
+#include <thrift/lib/cpp/TApplicationException.h>
 #include <thrift/lib/cpp/protocol/TProtocolTypes.h>
 #include <thrift/lib/cpp/transport/THeader.h>
 #include <thrift/lib/cpp2/async/HeaderClientChannel.h>
@@ -22,11 +28,102 @@ namespace fb303 = facebook::fb303;
 
 namespace openr {
 
+namespace {
+
+// Histograms of route programming latencies and batch sizes
+const std::string kUnicastAddHistogram{"fib.route_programming.unicast_add_ms"};
+const std::string kUnicastDeleteHistogram{
+    "fib.route_programming.unicast_delete_ms"};
+const std::string kMplsAddHistogram{"fib.route_programming.mpls_add_ms"};
+const std::string kMplsDeleteHistogram{"fib.route_programming.mpls_delete_ms"};
+const std::string kPendingWaitHistogram{
+    "fib.route_programming.pending_wait_ms"};
+const std::string kDecisionToAckHistogram{
+    "fib.route_programming.decision_to_ack_ms"};
+const std::string kRoutesPerCallHistogram{
+    "fib.route_programming.routes_per_call"};
+
+// Histograms of stages of convergence, measured between perf events of
+// route updates. Flooding spans from ADJ_DB_UPDATED on the node originating
+// adjacency change until DECISION_RECEIVED on this one
+struct ConvergenceStage {
+  std::string histogram;
+  std::string firstEvent;
+  std::string secondEvent;
+};
+const std::vector<ConvergenceStage> kConvergenceStages{
+    {"fib.convergence.kvstore_flood_ms", "ADJ_DB_UPDATED", "DECISION_RECEIVED"},
+    {"fib.convergence.decision_debounce_ms",
+     "DECISION_RECEIVED",
+     "DECISION_DEBOUNCE"},
+    {"fib.convergence.route_build_ms", "DECISION_DEBOUNCE", "ROUTE_UPDATE"},
+    {"fib.convergence.fib_received_ms", "ROUTE_UPDATE", "FIB_ROUTE_DB_RECVD"},
+    {"fib.convergence.fib_programmed_ms",
+     "FIB_ROUTE_DB_RECVD",
+     "OPENR_FIB_ROUTES_PROGRAMMED"},
+};
+const std::string kConvergenceTotalHistogram{"fib.convergence.total_ms"};
+
+// Prefixes of keys of routes in paginated route db. MPLS routes sort first
+const std::string kMplsPageKeyPrefix{"mpls:"};
+const std::string kUnicastPageKeyPrefix{"unicast:"};
+
+// Next-hops reduced to attributes the agent programs, in canonical order
+std::vector<thrift::NextHopThrift>
+getForwardingNextHops(const std::vector<thrift::NextHopThrift>& nextHops) {
+  std::vector<thrift::NextHopThrift> fwdNextHops;
+  fwdNextHops.reserve(nextHops.size());
+  for (const auto& nh : nextHops) {
+    thrift::NextHopThrift fwdNh;
+    fwdNh.address_ref() = *nh.address_ref();
+    fwdNh.weight_ref() = *nh.weight_ref();
+    if (nh.mplsAction_ref().has_value()) {
+      fwdNh.mplsAction_ref() = *nh.mplsAction_ref();
+    }
+    fwdNextHops.emplace_back(std::move(fwdNh));
+  }
+  std::sort(fwdNextHops.begin(), fwdNextHops.end());
+  return fwdNextHops;
+}
+
+// Collect routes differing from programmed ones and keys of programmed routes
+// which are not in routes
+template <typename Key, typename Route, typename GetKeyFn>
+void
+diffRouteTable(
+    const std::vector<Route>& routes,
+    const std::vector<Route>& programmedRoutes,
+    GetKeyFn&& getKey,
+    std::vector<Route>& routesToUpdate,
+    std::vector<Key>& keysToDelete) {
+  std::unordered_map<Key, std::vector<thrift::NextHopThrift>> programmed;
+  for (const auto& route : programmedRoutes) {
+    programmed.emplace(
+        getKey(route), getForwardingNextHops(*route.nextHops_ref()));
+  }
+  for (const auto& route : routes) {
+    auto it = programmed.find(getKey(route));
+    if (it == programmed.end()) {
+      routesToUpdate.emplace_back(route);
+      continue;
+    }
+    if (it->second != getForwardingNextHops(*route.nextHops_ref())) {
+      routesToUpdate.emplace_back(route);
+    }
+    programmed.erase(it);
+  }
+  for (const auto& [key, _] : programmed) {
+    keysToDelete.emplace_back(key);
+  }
+}
+
+} // namespace
+
 Fib::Fib(
     std::shared_ptr<const Config> config,
     int32_t thriftPort,
     std::chrono::seconds coldStartDuration,
-    messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueue,
+    messaging::RQueue<DecisionRouteUpdatePtr> routeUpdatesQueue,
     messaging::RQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue,
     messaging::ReplicateQueue<thrift::RouteDatabaseDelta>& fibUpdatesQueue,
     messaging::ReplicateQueue<LogSample>& logSampleQueue,
@@ -39,7 +136,8 @@ Fib::Fib(
           false),
       kvStore_(kvStore),
       fibUpdatesQueue_(fibUpdatesQueue),
-      logSampleQueue_(logSampleQueue) {
+      logSampleQueue_(logSampleQueue),
+      logSampleLimiter_(*config->getMonitorConfig().event_log_limits_ref()) {
   auto tConfig = config->getConfig();
 
   dryrun_ = config->getConfig().dryrun_ref().value_or(false);
@@ -47,8 +145,19 @@ Fib::Fib(
       config->getConfig().enable_segment_routing_ref().value_or(false);
   enableOrderedFib_ =
       config->getConfig().enable_ordered_fib_programming_ref().value_or(false);
+  fibSyncChunkSize_ = config->getFibSyncChunkSize();
+  routeCoalesceWindow_ = config->getFibRouteCoalesceWindow();
+  priorityClasses_ = config->getFibPriorityClasses();
+  enableRouteReconcile_ = config->isFibRouteReconcileEnabled();
 
   syncRoutesTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+    if (isRouteProgrammingInFlight_) {
+      // Full sync must not race with route updates in flight on the async
+      // client. Retry once they got programmed
+      syncRoutesTimer_->scheduleTimeout(Constants::kFibSyncInitialBackoff);
+      fb303::fbData->setCounter("fib.synced", 0);
+      return;
+    }
     if (routeState_.hasRoutesFromDecision) {
       if (syncRouteDb()) {
         hasSyncedFib_ = true;
@@ -67,13 +176,27 @@ Fib::Fib(
   // On startup we do require routedb_sync so explicitly set the counter to 0
   fb303::fbData->setCounter("fib.synced", 0);
 
-  if (enableOrderedFib_) {
+  if (enableOrderedFib_ or config->isConvergenceTimeFloodingEnabled()) {
     // check non-empty module ptr
     CHECK(kvStore_);
     kvStoreClient_ =
         std::make_unique<KvStoreClientInternal>(this, myNodeName_, kvStore_);
   }
 
+  if (config->isConvergenceTimeFloodingEnabled()) {
+    convergenceTimeTimer_ = folly::AsyncTimeout::make(
+        *getEvb(), [this, areaIds = config->getAreaIds()]() noexcept {
+          for (const auto& area : areaIds) {
+            kvStoreClient_->persistKey(
+                AreaId{area},
+                Constants::kConvergenceTimeMarker.toString() + myNodeName_,
+                std::to_string(maxConvergenceTime_.count()),
+                Constants::kTtlInfInterval);
+          }
+          maxConvergenceTime_ = std::chrono::milliseconds(0);
+        });
+  }
+
   if (not tConfig.eor_time_s_ref()) {
     routeState_.hasRoutesFromDecision = true;
     LOG(INFO)
@@ -102,17 +225,64 @@ Fib::Fib(
     keepAliveTimer_->scheduleTimeout(Constants::kKeepAliveCheckInterval);
   }
 
-  // Fiber to process route updates from Decision
+  // Task to process route updates from Decision
+#if FOLLY_HAS_COROUTINES
+  addCoroTask(processRouteUpdatesQueue(std::move(routeUpdatesQueue)));
+#else
   addFiberTask([q = std::move(routeUpdatesQueue), this]() mutable noexcept {
     while (true) {
       auto maybeThriftObj = q.get(); // perform read
       VLOG(1) << "Received route updates";
       if (maybeThriftObj.hasError()) {
         LOG(INFO) << "Terminating route delta processing fiber";
+        isRouteProgrammingStopped_ = true;
+        signalRouteProgramming();
         break;
       }
 
-      processRouteUpdates(std::move(maybeThriftObj).value().toThrift());
+      processRouteUpdates(
+          thrift::RouteDatabaseDelta(*maybeThriftObj.value()->getThrift()));
+    }
+  });
+#endif
+
+  // Fiber to program route updates. Route updates arriving while programming
+  // is in flight get coalesced and programmed together afterwards
+  addFiberTask([this]() mutable noexcept {
+    while (true) {
+      routeProgrammingBaton_.wait();
+      routeProgrammingBaton_.reset();
+      isRouteProgrammingSignaled_ = false;
+      if (isRouteProgrammingStopped_) {
+        LOG(INFO) << "Terminating route programming fiber";
+        break;
+      }
+      if (pendingRouteUpdates_.empty()) {
+        pendingRouteUpdates_ = PendingRouteUpdates();
+        continue;
+      }
+
+      if (routeCoalesceWindow_.count() > 0) {
+        // Let a burst of route updates coalesce before programming
+        folly::fibers::Baton windowBaton;
+        windowBaton.try_wait_for(routeCoalesceWindow_);
+        if (isRouteProgrammingStopped_) {
+          LOG(INFO) << "Terminating route programming fiber";
+          break;
+        }
+      }
+
+      if (pendingRouteUpdates_.pendingSince.has_value()) {
+        addHistogramValue(
+            kPendingWaitHistogram,
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() -
+                *pendingRouteUpdates_.pendingSince)
+                .count());
+      }
+      isRouteProgrammingInFlight_ = true;
+      programRoutes(pendingRouteUpdates_.release());
+      isRouteProgrammingInFlight_ = false;
     }
   });
 
@@ -151,6 +321,13 @@ Fib::Fib(
   fb303::fbData->addStatExportType("fib.num_of_route_updates", fb303::SUM);
   fb303::fbData->addStatExportType("fib.process_route_db", fb303::COUNT);
   fb303::fbData->addStatExportType("fib.sync_fib_calls", fb303::COUNT);
+  fb303::fbData->addStatExportType("fib.coalesced_route_updates", fb303::COUNT);
+  fb303::fbData->addStatExportType("fib.route_operations_avoided", fb303::SUM);
+  fb303::fbData->addStatExportType("fib.sync_fib_chunks", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "fib.route_reconcile.routes_programmed", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "fib.route_reconcile.routes_unchanged", fb303::SUM);
   fb303::fbData->addStatExportType(
       "fib.thrift.failure.add_del_route", fb303::COUNT);
   fb303::fbData->addStatExportType(
@@ -158,6 +335,38 @@ Fib::Fib(
   fb303::fbData->addStatExportType("fib.thrift.failure.sync_fib", fb303::COUNT);
   fb303::fbData->addStatExportType("fib.route_programming.time_ms", fb303::AVG);
   fb303::fbData->addStatExportType("fib.route_sync.time_ms", fb303::AVG);
+  for (const auto& histogram :
+       {kUnicastAddHistogram,
+        kUnicastDeleteHistogram,
+        kMplsAddHistogram,
+        kMplsDeleteHistogram,
+        kPendingWaitHistogram,
+        kDecisionToAckHistogram}) {
+    fb303::fbData->addHistogram(
+        histogram,
+        Constants::kFibLatencyHistogramBucketMs,
+        0,
+        Constants::kFibLatencyHistogramMaxMs);
+    fb303::fbData->exportHistogramPercentile(histogram, 50, 99);
+  }
+  fb303::fbData->addHistogram(
+      kRoutesPerCallHistogram,
+      Constants::kFibRoutesPerCallHistogramBucket,
+      0,
+      Constants::kFibRoutesPerCallHistogramMax);
+  fb303::fbData->exportHistogramPercentile(kRoutesPerCallHistogram, 50, 99);
+  std::vector<std::string> convergenceHistograms{kConvergenceTotalHistogram};
+  for (const auto& stage : kConvergenceStages) {
+    convergenceHistograms.emplace_back(stage.histogram);
+  }
+  for (const auto& histogram : convergenceHistograms) {
+    fb303::fbData->addHistogram(
+        histogram,
+        Constants::kConvergenceHistogramBucketMs,
+        0,
+        std::chrono::milliseconds(Constants::kConvergenceMaxDuration).count());
+    fb303::fbData->exportHistogramPercentile(histogram, 50, 90, 99);
+  }
 }
 
 void
@@ -171,44 +380,354 @@ Fib::stop() {
   OpenrEventBase::stop();
 }
 
+bool
+Fib::PendingRouteUpdates::empty() const {
+  return unicastRoutesToUpdate.empty() and unicastRoutesToDelete.empty() and
+      mplsRoutesToUpdate.empty() and mplsRoutesToDelete.empty();
+}
+
+size_t
+Fib::PendingRouteUpdates::merge(thrift::RouteDatabaseDelta&& routeDbDelta) {
+  if (not pendingSince.has_value()) {
+    pendingSince = std::chrono::steady_clock::now();
+  }
+  if (not perfEvents.has_value() and routeDbDelta.perfEvents_ref()) {
+    perfEvents = std::move(*routeDbDelta.perfEvents_ref());
+  }
+  size_t numSuperseded = 0;
+  for (auto& route : *routeDbDelta.unicastRoutesToUpdate_ref()) {
+    const auto prefix = *route.dest_ref();
+    numSuperseded += unicastRoutesToDelete.erase(prefix);
+    if (not unicastRoutesToUpdate.insert_or_assign(prefix, std::move(route))
+                .second) {
+      ++numSuperseded;
+    }
+  }
+  for (const auto& prefix : *routeDbDelta.unicastRoutesToDelete_ref()) {
+    numSuperseded += unicastRoutesToUpdate.erase(prefix);
+    if (not unicastRoutesToDelete.insert(prefix).second) {
+      ++numSuperseded;
+    }
+  }
+  for (auto& route : *routeDbDelta.mplsRoutesToUpdate_ref()) {
+    const auto topLabel = *route.topLabel_ref();
+    numSuperseded += mplsRoutesToDelete.erase(topLabel);
+    if (not mplsRoutesToUpdate.insert_or_assign(topLabel, std::move(route))
+                .second) {
+      ++numSuperseded;
+    }
+  }
+  for (const auto& topLabel : *routeDbDelta.mplsRoutesToDelete_ref()) {
+    numSuperseded += mplsRoutesToUpdate.erase(topLabel);
+    if (not mplsRoutesToDelete.insert(topLabel).second) {
+      ++numSuperseded;
+    }
+  }
+  return numSuperseded;
+}
+
+thrift::RouteDatabaseDelta
+Fib::PendingRouteUpdates::release() {
+  thrift::RouteDatabaseDelta routeDbDelta;
+  for (auto& [_, route] : unicastRoutesToUpdate) {
+    routeDbDelta.unicastRoutesToUpdate_ref()->emplace_back(std::move(route));
+  }
+  routeDbDelta.unicastRoutesToDelete_ref()->assign(
+      unicastRoutesToDelete.begin(), unicastRoutesToDelete.end());
+  for (auto& [_, route] : mplsRoutesToUpdate) {
+    routeDbDelta.mplsRoutesToUpdate_ref()->emplace_back(std::move(route));
+  }
+  routeDbDelta.mplsRoutesToDelete_ref()->assign(
+      mplsRoutesToDelete.begin(), mplsRoutesToDelete.end());
+  if (perfEvents.has_value()) {
+    routeDbDelta.perfEvents_ref() = std::move(*perfEvents);
+  }
+  *this = PendingRouteUpdates();
+  return routeDbDelta;
+}
+
+void
+Fib::PrefixLengthCounts::add(const thrift::IpPrefix& prefix) {
+  const bool isV4 = prefix.prefixAddress_ref()->addr_ref()->size() ==
+      folly::IPAddressV4::byteCount();
+  ++(isV4 ? v4 : v6).at(*prefix.prefixLength_ref());
+}
+
+void
+Fib::PrefixLengthCounts::remove(const thrift::IpPrefix& prefix) {
+  const bool isV4 = prefix.prefixAddress_ref()->addr_ref()->size() ==
+      folly::IPAddressV4::byteCount();
+  auto& count = (isV4 ? v4 : v6).at(*prefix.prefixLength_ref());
+  CHECK_LT(0, count);
+  --count;
+}
+
+void
+Fib::PrefixLengthCounts::add(const folly::CIDRNetwork& prefix) {
+  ++(prefix.first.isV4() ? v4 : v6).at(prefix.second);
+}
+
+void
+Fib::PrefixLengthCounts::remove(const folly::CIDRNetwork& prefix) {
+  auto& count = (prefix.first.isV4() ? v4 : v6).at(prefix.second);
+  CHECK_LT(0, count);
+  --count;
+}
+
+void
+Fib::PrefixLengthCounts::add(const PackedPrefix& prefix) {
+  ++(prefix.isV4() ? v4 : v6).at(prefix.length());
+}
+
+void
+Fib::PrefixLengthCounts::remove(const PackedPrefix& prefix) {
+  auto& count = (prefix.isV4() ? v4 : v6).at(prefix.length());
+  CHECK_LT(0, count);
+  --count;
+}
+
+std::vector<std::vector<thrift::UnicastRoute>>
+Fib::splitByPriorityClass(
+    std::vector<thrift::UnicastRoute> unicastRoutes,
+    const std::vector<std::vector<folly::CIDRNetwork>>& priorityClasses) {
+  // batch of remaining routes comes last
+  std::vector<std::vector<thrift::UnicastRoute>> batches(
+      priorityClasses.size() + 1);
+  for (auto& route : unicastRoutes) {
+    const auto prefix = toIPNetwork(*route.dest_ref());
+    size_t idx = 0;
+    for (; idx < priorityClasses.size(); ++idx) {
+      const auto& classPrefixes = priorityClasses.at(idx);
+      if (std::any_of(
+              classPrefixes.begin(),
+              classPrefixes.end(),
+              [&prefix](const folly::CIDRNetwork& classPrefix) {
+                return prefix.second >= classPrefix.second and
+                    prefix.first.inSubnet(
+                        classPrefix.first, classPrefix.second);
+              })) {
+        break;
+      }
+    }
+    batches.at(idx).emplace_back(std::move(route));
+  }
+  batches.erase(
+      std::remove_if(
+          batches.begin(),
+          batches.end(),
+          [](const auto& batch) { return batch.empty(); }),
+      batches.end());
+  return batches;
+}
+
+thrift::RouteDatabaseDelta
+Fib::computeRouteTableDelta(
+    const std::vector<thrift::UnicastRoute>& unicastRoutes,
+    const std::vector<thrift::UnicastRoute>& programmedUnicastRoutes,
+    const std::vector<thrift::MplsRoute>& mplsRoutes,
+    const std::vector<thrift::MplsRoute>& programmedMplsRoutes) {
+  thrift::RouteDatabaseDelta delta;
+  diffRouteTable(
+      unicastRoutes,
+      programmedUnicastRoutes,
+      [](const thrift::UnicastRoute& route) { return *route.dest_ref(); },
+      *delta.unicastRoutesToUpdate_ref(),
+      *delta.unicastRoutesToDelete_ref());
+  diffRouteTable(
+      mplsRoutes,
+      programmedMplsRoutes,
+      [](const thrift::MplsRoute& route) { return *route.topLabel_ref(); },
+      *delta.mplsRoutesToUpdate_ref(),
+      *delta.mplsRoutesToDelete_ref());
+  return delta;
+}
+
+Fib::UnicastRouteRecord
+Fib::UnicastRouteRecord::fromThrift(const thrift::UnicastRoute& route) {
+  UnicastRouteRecord record;
+  record.nexthops = NextHopSet(
+      route.nextHops_ref()->begin(), route.nextHops_ref()->end());
+  if (route.data_ref().has_value()) {
+    record.data = std::make_unique<std::string>(*route.data_ref());
+  }
+  record.adminDistance = route.adminDistance_ref().to_optional();
+  record.prefixType = route.prefixType_ref().to_optional();
+  record.doNotInstall = *route.doNotInstall_ref();
+  return record;
+}
+
+thrift::UnicastRoute
+Fib::UnicastRouteRecord::toThrift(const PackedPrefix& prefix) const {
+  thrift::UnicastRoute route;
+  route.dest_ref() = prefix.toThrift();
+  route.nextHops_ref() =
+      std::vector<thrift::NextHopThrift>(nexthops.begin(), nexthops.end());
+  std::sort(route.nextHops_ref()->begin(), route.nextHops_ref()->end());
+  if (data) {
+    route.data_ref() = *data;
+  }
+  if (adminDistance.has_value()) {
+    route.adminDistance_ref() = *adminDistance;
+  }
+  if (prefixType.has_value()) {
+    route.prefixType_ref() = *prefixType;
+  }
+  route.doNotInstall_ref() = doNotInstall;
+  return route;
+}
+
+namespace {
+
+// Look up input masked to every prefix length present, longest first
+template <typename ContainsFn>
+std::optional<folly::CIDRNetwork>
+longestPrefixMatchImpl(
+    const folly::CIDRNetwork& inputPrefix,
+    const Fib::PrefixLengthCounts& prefixLengthCounts,
+    ContainsFn&& contains) {
+  const auto& inputIP = inputPrefix.first;
+  const auto& inputMask = inputPrefix.second;
+  const uint32_t* counts = inputIP.isV4() ? prefixLengthCounts.v4.data()
+                                          : prefixLengthCounts.v6.data();
+
+  for (int mask = std::min<int>(inputMask, inputIP.bitCount()); mask >= 0;
+       --mask) {
+    if (not counts[mask]) {
+      continue;
+    }
+    folly::CIDRNetwork prefix(inputIP.mask(mask), mask);
+    if (contains(prefix)) {
+      return prefix;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
 std::optional<thrift::IpPrefix>
 Fib::longestPrefixMatch(
     const folly::CIDRNetwork& inputPrefix,
     const std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute>&
-        unicastRoutes) {
-  std::optional<thrift::IpPrefix> matchedPrefix;
-  int maxMask = -1;
-  const auto& inputIP = inputPrefix.first;
-  const auto& inputMask = inputPrefix.second;
+        unicastRoutes,
+    const PrefixLengthCounts& prefixLengthCounts) {
+  const auto matchedPrefix = longestPrefixMatchImpl(
+      inputPrefix, prefixLengthCounts, [&](const folly::CIDRNetwork& prefix) {
+        return unicastRoutes.count(toIpPrefix(prefix)) > 0;
+      });
+  if (not matchedPrefix.has_value()) {
+    return std::nullopt;
+  }
+  return toIpPrefix(*matchedPrefix);
+}
 
-  // longest prefix matching
-  for (const auto& route : unicastRoutes) {
-    const auto& dbIP = toIPAddress(*route.first.prefixAddress_ref());
-    const auto& dbMask = *route.first.prefixLength_ref();
+std::optional<folly::CIDRNetwork>
+Fib::longestPrefixMatch(
+    const folly::CIDRNetwork& inputPrefix,
+    const UnicastRouteRecords& unicastRoutes,
+    const PrefixLengthCounts& prefixLengthCounts) {
+  return longestPrefixMatchImpl(
+      inputPrefix, prefixLengthCounts, [&](const folly::CIDRNetwork& prefix) {
+        return unicastRoutes.count(prefix) > 0;
+      });
+}
 
-    if (maxMask < dbMask && inputMask >= dbMask &&
-        inputIP.mask(dbMask) == dbIP) {
-      maxMask = dbMask;
-      matchedPrefix = route.first;
-    }
+std::optional<thrift::IpPrefix>
+Fib::longestPrefixMatch(
+    const folly::CIDRNetwork& inputPrefix,
+    const std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute>&
+        unicastRoutes) {
+  PrefixLengthCounts prefixLengthCounts;
+  for (const auto& route : unicastRoutes) {
+    prefixLengthCounts.add(route.first);
   }
-  return matchedPrefix;
+  return longestPrefixMatch(inputPrefix, unicastRoutes, prefixLengthCounts);
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
 Fib::getRouteDb() {
+  if (auto snapshot = routeDbSnapshot_.load()) {
+    fb303::fbData->addStatValue("fib.route_db_snapshot.hit", 1, fb303::COUNT);
+    return folly::makeSemiFuture(
+        std::make_unique<thrift::RouteDatabase>(*snapshot));
+  }
+
   folly::Promise<std::unique_ptr<thrift::RouteDatabase>> p;
   auto sf = p.getSemiFuture();
   runInEventBaseThread([p = std::move(p), this]() mutable {
-    thrift::RouteDatabase routeDb;
+    // Snapshot may have been rebuilt by reader queued ahead of this one
+    auto snapshot = routeDbSnapshot_.load();
+    if (not snapshot) {
+      auto routeDb = std::make_shared<thrift::RouteDatabase>();
+      *routeDb->thisNodeName_ref() = myNodeName_;
+      routeDb->unicastRoutes_ref() = getAllUnicastRoutes();
+      for (const auto& route : routeState_.mplsRoutes) {
+        routeDb->mplsRoutes_ref()->emplace_back(route.second);
+      }
+      snapshot = std::move(routeDb);
+      routeDbSnapshot_.store(snapshot);
+    }
+    p.setValue(std::make_unique<thrift::RouteDatabase>(*snapshot));
+  });
+  return sf;
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::RouteDbPage>>
+Fib::getRouteDbPage(thrift::PageParams page) {
+  folly::Promise<std::unique_ptr<thrift::RouteDbPage>> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([p = std::move(p),
+                        page = std::move(page),
+                        this]() mutable {
+    auto cursor = page.cursor_ref().to_optional();
+    size_t pageSize = std::max(*page.pageSize_ref(), 1);
+    thrift::RouteDbPage routeDbPage;
+    auto& routeDb = *routeDbPage.routeDb_ref();
     *routeDb.thisNodeName_ref() = myNodeName_;
-    for (const auto& route : routeState_.unicastRoutes) {
-      routeDb.unicastRoutes_ref()->emplace_back(route.second);
+
+    if (not cursor.has_value() or *cursor < kUnicastPageKeyPrefix) {
+      // labels are zero padded to sort keys in order of labels
+      auto [entries, nextCursor] = selectPage(
+          routeState_.mplsRoutes,
+          [](auto const& route) {
+            return std::make_optional(
+                folly::sformat("{}{:010}", kMplsPageKeyPrefix, route.first));
+          },
+          cursor,
+          pageSize);
+      for (auto const& it : entries) {
+        routeDb.mplsRoutes_ref()->emplace_back(it->second);
+      }
+      if (nextCursor.has_value() or routeState_.unicastRoutes.empty()) {
+        routeDbPage.nextCursor_ref().from_optional(std::move(nextCursor));
+        p.setValue(
+            std::make_unique<thrift::RouteDbPage>(std::move(routeDbPage)));
+        return;
+      }
+      // continue with unicast routes, from their beginning
+      pageSize -= entries.size();
+      cursor = kUnicastPageKeyPrefix;
+      if (pageSize == 0) {
+        routeDbPage.nextCursor_ref() = *cursor;
+        p.setValue(
+            std::make_unique<thrift::RouteDbPage>(std::move(routeDbPage)));
+        return;
+      }
     }
-    for (const auto& route : routeState_.mplsRoutes) {
-      routeDb.mplsRoutes_ref()->emplace_back(route.second);
+
+    auto [entries, nextCursor] = selectPage(
+        routeState_.unicastRoutes,
+        [](auto const& route) {
+          return std::make_optional(
+              kUnicastPageKeyPrefix + route.first.str());
+        },
+        cursor,
+        pageSize);
+    for (auto const& it : entries) {
+      routeDb.unicastRoutes_ref()->emplace_back(it->second.toThrift(it->first));
     }
-    p.setValue(std::make_unique<thrift::RouteDatabase>(std::move(routeDb)));
+    routeDbPage.nextCursor_ref().from_optional(std::move(nextCursor));
+    p.setValue(std::make_unique<thrift::RouteDbPage>(std::move(routeDbPage)));
   });
   return sf;
 }
@@ -239,12 +758,8 @@ Fib::getMplsRoutes(std::vector<int32_t> labels) {
 
 folly::SemiFuture<std::unique_ptr<thrift::PerfDatabase>>
 Fib::getPerfDb() {
-  folly::Promise<std::unique_ptr<thrift::PerfDatabase>> p;
-  auto sf = p.getSemiFuture();
-  runInEventBaseThread([p = std::move(p), this]() mutable {
-    p.setValue(std::make_unique<thrift::PerfDatabase>(dumpPerfDb()));
-  });
-  return sf;
+  return folly::makeSemiFuture(
+      std::make_unique<thrift::PerfDatabase>(dumpPerfDb()));
 }
 
 std::vector<thrift::UnicastRoute>
@@ -252,14 +767,11 @@ Fib::getUnicastRoutesFiltered(std::vector<std::string> prefixes) {
   // return and send the vector<thrift::UnicastRoute>
   std::vector<thrift::UnicastRoute> retRouteVec;
   // the matched prefix after longest prefix matching and avoid duplicates
-  std::set<thrift::IpPrefix> matchPrefixSet;
+  std::set<folly::CIDRNetwork> matchPrefixSet;
 
   // if the params is empty, return all routes
   if (prefixes.empty()) {
-    for (const auto& routes : routeState_.unicastRoutes) {
-      retRouteVec.emplace_back(routes.second);
-    }
-    return retRouteVec;
+    return getAllUnicastRoutes();
   }
 
   // longest prefix matching for each input string
@@ -274,8 +786,10 @@ Fib::getUnicastRoutesFiltered(std::vector<std::string> prefixes) {
     const auto inputPrefix = maybePrefix.value();
 
     // do longest prefix match, add the matched prefix to the result set
-    const auto& matchedPrefix =
-        Fib::longestPrefixMatch(inputPrefix, routeState_.unicastRoutes);
+    const auto& matchedPrefix = Fib::longestPrefixMatch(
+        inputPrefix,
+        routeState_.unicastRoutes,
+        routeState_.unicastPrefixLengths);
     if (matchedPrefix.has_value()) {
       matchPrefixSet.insert(matchedPrefix.value());
     }
@@ -283,12 +797,23 @@ Fib::getUnicastRoutesFiltered(std::vector<std::string> prefixes) {
 
   // get the routes from the prefix set
   for (const auto& prefix : matchPrefixSet) {
-    retRouteVec.emplace_back(routeState_.unicastRoutes.at(prefix));
+    retRouteVec.emplace_back(
+        routeState_.unicastRoutes.at(prefix).toThrift(prefix));
   }
 
   return retRouteVec;
 }
 
+std::vector<thrift::UnicastRoute>
+Fib::getAllUnicastRoutes() const {
+  std::vector<thrift::UnicastRoute> unicastRoutes;
+  unicastRoutes.reserve(routeState_.unicastRoutes.size());
+  for (const auto& [prefix, record] : routeState_.unicastRoutes) {
+    unicastRoutes.emplace_back(record.toThrift(prefix));
+  }
+  return unicastRoutes;
+}
+
 std::vector<thrift::MplsRoute>
 Fib::getMplsRoutesFiltered(std::vector<int32_t> labels) {
   // return and send the vector<thrift::MplsRoute>
@@ -323,9 +848,29 @@ Fib::getFibUpdatesReader() {
   return fibUpdatesQueue_.getReader();
 }
 
+#if FOLLY_HAS_COROUTINES
+folly::coro::Task<void>
+Fib::processRouteUpdatesQueue(messaging::RQueue<DecisionRouteUpdatePtr> q) {
+  while (true) {
+    auto maybeThriftObj = co_await q.getCoro(); // perform read
+    VLOG(1) << "Received route updates";
+    if (maybeThriftObj.hasError()) {
+      LOG(INFO) << "Terminating route delta processing task";
+      isRouteProgrammingStopped_ = true;
+      signalRouteProgramming();
+      break;
+    }
+
+    processRouteUpdates(
+        thrift::RouteDatabaseDelta(*maybeThriftObj.value()->getThrift()));
+  }
+}
+#endif
+
 void
 Fib::processRouteUpdates(thrift::RouteDatabaseDelta&& routeDelta) {
   routeState_.hasRoutesFromDecision = true;
+  routeDbSnapshot_.store(nullptr);
   // Update perfEvents_ .. We replace existing perf events with new one as
   // convergence is going to be based on new data, not the old.
   if (routeDelta.perfEvents_ref()) {
@@ -347,7 +892,12 @@ Fib::processRouteUpdates(thrift::RouteDatabaseDelta&& routeDelta) {
 
   // Add/Update unicast routes to update
   for (const auto& route : *routeDelta.unicastRoutesToUpdate_ref()) {
-    routeState_.unicastRoutes[*route.dest_ref()] = route;
+    auto [it, inserted] = routeState_.unicastRoutes.insert_or_assign(
+        PackedPrefix(*route.dest_ref()).masked(),
+        UnicastRouteRecord::fromThrift(route));
+    if (inserted) {
+      routeState_.unicastPrefixLengths.add(it->first);
+    }
   }
 
   // Add mpls routes to update
@@ -357,7 +907,10 @@ Fib::processRouteUpdates(thrift::RouteDatabaseDelta&& routeDelta) {
 
   // Delete unicast routes
   for (const auto& dest : *routeDelta.unicastRoutesToDelete_ref()) {
-    routeState_.unicastRoutes.erase(dest);
+    const auto prefix = PackedPrefix(dest).masked();
+    if (routeState_.unicastRoutes.erase(prefix)) {
+      routeState_.unicastPrefixLengths.remove(prefix);
+    }
   }
 
   // Delete mpls routes
@@ -373,11 +926,11 @@ Fib::processRouteUpdates(thrift::RouteDatabaseDelta&& routeDelta) {
 
 thrift::PerfDatabase
 Fib::dumpPerfDb() const {
+  if (auto snapshot = perfDbSnapshot_.load()) {
+    return *snapshot;
+  }
   thrift::PerfDatabase perfDb;
   *perfDb.thisNodeName_ref() = myNodeName_;
-  for (auto const& perf : perfDb_) {
-    perfDb.eventInfo_ref()->emplace_back(perf);
-  }
   return perfDb;
 }
 
@@ -416,19 +969,20 @@ Fib::printMplsRoutesAddUpdate(
 void
 Fib::updateRoutes(
     thrift::RouteDatabaseDelta&& routeDbDelta, bool isStaticRoutes) {
+  FOLLY_SDT(
+      openr,
+      fib_update_routes_entry,
+      routeDbDelta.unicastRoutesToUpdate_ref()->size(),
+      routeDbDelta.unicastRoutesToDelete_ref()->size(),
+      routeDbDelta.mplsRoutesToUpdate_ref()->size(),
+      routeDbDelta.mplsRoutesToDelete_ref()->size(),
+      isStaticRoutes);
   SCOPE_EXIT {
-    updateRoutesSemaphore_.signal(); // Release when this function returns
+    FOLLY_SDT(openr, fib_update_routes_return, isStaticRoutes);
   };
-  updateRoutesSemaphore_.wait();
-
   // update flat counters here as they depend on routeState_ and its change
   updateGlobalCounters();
 
-  // Only for backward compatibility
-  auto const& unicastRoutesToUpdate = *routeDbDelta.unicastRoutesToUpdate_ref();
-  auto const& mplsRoutesToUpdate = createMplsRoutesWithSelectedNextHops(
-      *routeDbDelta.mplsRoutesToUpdate_ref());
-
   if (dryrun_) {
     // Do not program routes in case of dryrun
     LOG(INFO) << "Skipping programming of routes in dryrun ... ";
@@ -464,6 +1018,35 @@ Fib::updateRoutes(
     return;
   }
 
+  // Coalesce with route updates not yet programmed, if any. The route
+  // programming fiber picks them up once route updates in flight completed
+  if (not pendingRouteUpdates_.empty()) {
+    fb303::fbData->addStatValue("fib.coalesced_route_updates", 1, fb303::COUNT);
+  }
+  const auto numSuperseded =
+      pendingRouteUpdates_.merge(std::move(routeDbDelta));
+  if (numSuperseded) {
+    fb303::fbData->addStatValue(
+        "fib.route_operations_avoided", numSuperseded, fb303::SUM);
+  }
+  signalRouteProgramming();
+}
+
+void
+Fib::signalRouteProgramming() {
+  if (not isRouteProgrammingSignaled_) {
+    isRouteProgrammingSignaled_ = true;
+    routeProgrammingBaton_.post();
+  }
+}
+
+void
+Fib::programRoutes(thrift::RouteDatabaseDelta&& routeDbDelta) {
+  // Only for backward compatibility
+  auto const& unicastRoutesToUpdate = *routeDbDelta.unicastRoutesToUpdate_ref();
+  auto const& mplsRoutesToUpdate = createMplsRoutesWithSelectedNextHops(
+      *routeDbDelta.mplsRoutesToUpdate_ref());
+
   // Make thrift calls to do real programming
   try {
     LOG(INFO) << "Updating routes in FIB";
@@ -471,7 +1054,7 @@ Fib::updateRoutes(
     uint32_t numOfRouteUpdates = 0;
 
     // Create FIB client if doesn't exists
-    createFibClient(evb_, socket_, client_, thriftPort_);
+    createFibClient(*getEvb(), asyncSocket_, asyncClient_, thriftPort_);
 
     // Delete unicast routes
     if (routeDbDelta.unicastRoutesToDelete_ref()->size()) {
@@ -484,8 +1067,16 @@ Fib::updateRoutes(
       }
 
       numOfRouteUpdates += routeDbDelta.unicastRoutesToDelete_ref()->size();
-      client_->sync_deleteUnicastRoutes(
-          kFibId_, *routeDbDelta.unicastRoutesToDelete_ref());
+      const auto callStartTime = std::chrono::steady_clock::now();
+      asyncClient_
+          ->semifuture_deleteUnicastRoutes(
+              kFibId_, *routeDbDelta.unicastRoutesToDelete_ref())
+          .via(getEvb())
+          .get();
+      recordProgrammingCall(
+          kUnicastDeleteHistogram,
+          callStartTime,
+          routeDbDelta.unicastRoutesToDelete_ref()->size());
     }
 
     // Add unicast routes
@@ -496,7 +1087,16 @@ Fib::updateRoutes(
       printUnicastRoutesAddUpdate(unicastRoutesToUpdate);
 
       numOfRouteUpdates += unicastRoutesToUpdate.size();
-      client_->sync_addUnicastRoutes(kFibId_, unicastRoutesToUpdate);
+      // Program routes of priority classes first, in separate batches
+      for (const auto& batch :
+           splitByPriorityClass(unicastRoutesToUpdate, priorityClasses_)) {
+        const auto callStartTime = std::chrono::steady_clock::now();
+        asyncClient_->semifuture_addUnicastRoutes(kFibId_, batch)
+            .via(getEvb())
+            .get();
+        recordProgrammingCall(
+            kUnicastAddHistogram, callStartTime, batch.size());
+      }
     }
 
     // Delete mpls routes
@@ -510,8 +1110,16 @@ Fib::updateRoutes(
       }
 
       numOfRouteUpdates += routeDbDelta.mplsRoutesToDelete_ref()->size();
-      client_->sync_deleteMplsRoutes(
-          kFibId_, *routeDbDelta.mplsRoutesToDelete_ref());
+      const auto callStartTime = std::chrono::steady_clock::now();
+      asyncClient_
+          ->semifuture_deleteMplsRoutes(
+              kFibId_, *routeDbDelta.mplsRoutesToDelete_ref())
+          .via(getEvb())
+          .get();
+      recordProgrammingCall(
+          kMplsDeleteHistogram,
+          callStartTime,
+          routeDbDelta.mplsRoutesToDelete_ref()->size());
     }
 
     // Add mpls routes
@@ -522,7 +1130,12 @@ Fib::updateRoutes(
 
       printMplsRoutesAddUpdate(mplsRoutesToUpdate);
 
-      client_->sync_addMplsRoutes(kFibId_, mplsRoutesToUpdate);
+      const auto callStartTime = std::chrono::steady_clock::now();
+      asyncClient_->semifuture_addMplsRoutes(kFibId_, mplsRoutesToUpdate)
+          .via(getEvb())
+          .get();
+      recordProgrammingCall(
+          kMplsAddHistogram, callStartTime, mplsRoutesToUpdate.size());
     }
 
     const auto elapsedTime =
@@ -536,10 +1149,22 @@ Fib::updateRoutes(
         "fib.route_programming.time_ms", elapsedTime.count(), fb303::AVG);
     fb303::fbData->addStatValue(
         "fib.num_of_route_updates", numOfRouteUpdates, fb303::SUM);
+
+    // End-to-end latency since Decision began computing the routes, as per
+    // the first perf event of the earliest delta
+    if (routeDbDelta.perfEvents_ref().has_value() and
+        not routeDbDelta.perfEvents_ref()->events_ref()->empty()) {
+      const auto& firstEvent =
+          routeDbDelta.perfEvents_ref()->events_ref()->front();
+      addHistogramValue(
+          kDecisionToAckHistogram,
+          getUnixTimeStampMs() - *firstEvent.unixTs_ref());
+    }
+    updateGlobalCounters();
   } catch (const std::exception& e) {
     fb303::fbData->addStatValue(
         "fib.thrift.failure.add_del_route", 1, fb303::COUNT);
-    client_.reset();
+    asyncClient_.reset();
     routeState_.dirtyRouteDb = true;
     syncRouteDbDebounced(); // Schedule future full sync of route DB
     LOG(ERROR) << "Failed to update routes in FIB. Error: "
@@ -547,10 +1172,29 @@ Fib::updateRoutes(
   }
 }
 
+void
+Fib::recordProgrammingCall(
+    const std::string& histogram,
+    std::chrono::steady_clock::time_point startTime,
+    size_t numRoutes) {
+  addHistogramValue(
+      histogram,
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - startTime)
+          .count());
+  addHistogramValue(kRoutesPerCallHistogram, numRoutes);
+}
+
+void
+Fib::addHistogramValue(const std::string& histogram, int64_t value) {
+  fb303::fbData->addHistogramValue(histogram, value);
+  auto& maxValue = histogramMax_[histogram];
+  maxValue = std::max(maxValue, value);
+}
+
 bool
 Fib::syncRouteDb() {
-  const auto& unicastRoutes =
-      createUnicastRoutesFromMap(routeState_.unicastRoutes);
+  const auto& unicastRoutes = getAllUnicastRoutes();
   const auto& mplsRoutes =
       createMplsRoutesWithSelectedNextHopsMap(routeState_.mplsRoutes);
 
@@ -573,16 +1217,39 @@ Fib::syncRouteDb() {
     createFibClient(evb_, socket_, client_, thriftPort_);
     fb303::fbData->addStatValue("fib.sync_fib_calls", 1, fb303::COUNT);
 
-    // Sync unicast routes
-    LOG(INFO) << "Syncing " << unicastRoutes.size() << " unicast routes in FIB";
-    client_->sync_syncFib(kFibId_, unicastRoutes);
-    printUnicastRoutesAddUpdate(unicastRoutes);
+    if (enableRouteReconcile_) {
+      reconcileRouteDb(unicastRoutes, mplsRoutes);
+      printUnicastRoutesAddUpdate(unicastRoutes);
+      if (enableSegmentRouting_) {
+        printMplsRoutesAddUpdate(mplsRoutes);
+      }
+    } else {
+      // Sync unicast routes
+      LOG(INFO) << "Syncing " << unicastRoutes.size()
+                << " unicast routes in FIB";
+      if (not priorityClasses_.empty()) {
+        // Program routes of priority classes ahead of the full sync, which
+        // then finds them programmed already
+        auto batches = splitByPriorityClass(unicastRoutes, priorityClasses_);
+        for (size_t i = 0; i + 1 < batches.size(); ++i) {
+          LOG(INFO) << "Adding " << batches.at(i).size()
+                    << " unicast routes of priority batch " << i << " in FIB";
+          client_->sync_addUnicastRoutes(kFibId_, batches.at(i));
+        }
+      }
+      if (fibSyncChunkSize_ > 0 and unicastRoutes.size() > fibSyncChunkSize_) {
+        syncUnicastRoutesInChunks(unicastRoutes);
+      } else {
+        client_->sync_syncFib(kFibId_, unicastRoutes);
+      }
+      printUnicastRoutesAddUpdate(unicastRoutes);
 
-    // Sync mpls routes
-    if (enableSegmentRouting_) {
-      LOG(INFO) << "Syncing " << mplsRoutes.size() << " mpls routes in FIB";
-      client_->sync_syncMplsFib(kFibId_, mplsRoutes);
-      printMplsRoutesAddUpdate(mplsRoutes);
+      // Sync mpls routes
+      if (enableSegmentRouting_) {
+        LOG(INFO) << "Syncing " << mplsRoutes.size() << " mpls routes in FIB";
+        client_->sync_syncMplsFib(kFibId_, mplsRoutes);
+        printMplsRoutesAddUpdate(mplsRoutes);
+      }
     }
 
     const auto elapsedTime =
@@ -593,6 +1260,7 @@ Fib::syncRouteDb() {
     fb303::fbData->addStatValue(
         "fib.route_sync.time_ms", elapsedTime.count(), fb303::AVG);
     routeState_.dirtyRouteDb = false;
+    pendingChunkedSync_.reset();
     return true;
   } catch (std::exception const& e) {
     fb303::fbData->addStatValue("fib.thrift.failure.sync_fib", 1, fb303::COUNT);
@@ -612,6 +1280,142 @@ Fib::syncRouteDbDebounced() {
   }
 }
 
+void
+Fib::syncUnicastRoutesInChunks(
+    const std::vector<thrift::UnicastRoute>& unicastRoutes) {
+  CHECK_GT(fibSyncChunkSize_, 0);
+
+  if (pendingChunkedSync_.has_value() and
+      (pendingChunkedSync_->routes != unicastRoutes or
+       getAgentPendingSyncId() != pendingChunkedSync_->syncId)) {
+    LOG(INFO) << "Restarting interrupted unicast FIB sync "
+              << pendingChunkedSync_->syncId;
+    pendingChunkedSync_.reset();
+  }
+  if (not pendingChunkedSync_.has_value()) {
+    pendingChunkedSync_ = PendingChunkedSync{++fibSyncId_, unicastRoutes, 0};
+  }
+  auto& pendingSync = *pendingChunkedSync_;
+  const auto& routes = pendingSync.routes;
+  const auto syncId = pendingSync.syncId;
+  const auto firstChunk = pendingSync.numChunksAcked;
+  if (firstChunk > 0) {
+    LOG(INFO) << "Resuming unicast FIB sync " << syncId << " from chunk "
+              << firstChunk;
+    fb303::fbData->addStatValue(
+        "fib.sync_fib_chunks_resumed", firstChunk, fb303::SUM);
+  }
+
+  // Chunks are acknowledged in order as the oldest one in flight is waited on
+  std::deque<folly::SemiFuture<folly::Unit>> chunksInFlight;
+  const auto waitForOldestChunk = [&]() {
+    std::move(chunksInFlight.front()).getVia(&evb_);
+    chunksInFlight.pop_front();
+    ++pendingSync.numChunksAcked;
+  };
+
+  size_t numChunks = 0;
+  auto chunkBegin = routes.begin() + firstChunk * fibSyncChunkSize_;
+  while (true) {
+    const auto chunkEnd = chunkBegin +
+        std::min<size_t>(fibSyncChunkSize_, routes.end() - chunkBegin);
+    const std::vector<thrift::UnicastRoute> chunk(chunkBegin, chunkEnd);
+    chunkBegin = chunkEnd;
+    ++numChunks;
+
+    if (chunkEnd == routes.end()) {
+      // Commit sync only after all other chunks got programmed
+      while (not chunksInFlight.empty()) {
+        waitForOldestChunk();
+      }
+      client_->sync_syncFibChunk(kFibId_, syncId, chunk, true /* isFinal */);
+      break;
+    }
+
+    if (chunksInFlight.size() >= Constants::kFibSyncMaxChunksInFlight) {
+      waitForOldestChunk();
+    }
+    chunksInFlight.emplace_back(client_->semifuture_syncFibChunk(
+        kFibId_, syncId, chunk, false /* isFinal */));
+  }
+
+  VLOG(1) << "Synced " << routes.size() << " unicast routes in " << numChunks
+          << " chunks";
+  fb303::fbData->addStatValue("fib.sync_fib_chunks", numChunks, fb303::SUM);
+  pendingChunkedSync_.reset();
+}
+
+int64_t
+Fib::getAgentPendingSyncId() {
+  try {
+    return client_->sync_getPendingSyncFibId(kFibId_);
+  } catch (apache::thrift::TApplicationException const& e) {
+    // Agent doesn't support resuming syncs
+    VLOG(1) << "Failed to get pending FIB sync of agent. Error: "
+            << folly::exceptionStr(e);
+    return 0;
+  }
+}
+
+void
+Fib::reconcileRouteDb(
+    const std::vector<thrift::UnicastRoute>& unicastRoutes,
+    const std::vector<thrift::MplsRoute>& mplsRoutes) {
+  std::vector<thrift::UnicastRoute> programmedUnicastRoutes;
+  client_->sync_getRouteTableByClient(programmedUnicastRoutes, kFibId_);
+  std::vector<thrift::MplsRoute> programmedMplsRoutes;
+  if (enableSegmentRouting_) {
+    client_->sync_getMplsRouteTableByClient(programmedMplsRoutes, kFibId_);
+  }
+
+  auto delta = computeRouteTableDelta(
+      unicastRoutes,
+      programmedUnicastRoutes,
+      enableSegmentRouting_ ? mplsRoutes : std::vector<thrift::MplsRoute>{},
+      programmedMplsRoutes);
+  auto& unicastRoutesToUpdate = *delta.unicastRoutesToUpdate_ref();
+  auto& unicastRoutesToDelete = *delta.unicastRoutesToDelete_ref();
+  auto& mplsRoutesToUpdate = *delta.mplsRoutesToUpdate_ref();
+  auto& mplsRoutesToDelete = *delta.mplsRoutesToDelete_ref();
+  LOG(INFO) << "Reconciling " << unicastRoutes.size() << " unicast routes with "
+            << programmedUnicastRoutes.size() << " in FIB: adding "
+            << unicastRoutesToUpdate.size() << ", deleting "
+            << unicastRoutesToDelete.size();
+
+  // Add routes before deleting stale ones, highest priority first
+  for (auto& batch :
+       splitByPriorityClass(unicastRoutesToUpdate, priorityClasses_)) {
+    client_->sync_addUnicastRoutes(kFibId_, batch);
+  }
+  if (not unicastRoutesToDelete.empty()) {
+    client_->sync_deleteUnicastRoutes(kFibId_, unicastRoutesToDelete);
+  }
+
+  if (enableSegmentRouting_) {
+    LOG(INFO) << "Reconciling " << mplsRoutes.size() << " mpls routes with "
+              << programmedMplsRoutes.size() << " in FIB: adding "
+              << mplsRoutesToUpdate.size() << ", deleting "
+              << mplsRoutesToDelete.size();
+    if (not mplsRoutesToUpdate.empty()) {
+      client_->sync_addMplsRoutes(kFibId_, mplsRoutesToUpdate);
+    }
+    if (not mplsRoutesToDelete.empty()) {
+      client_->sync_deleteMplsRoutes(kFibId_, mplsRoutesToDelete);
+    }
+  }
+
+  const size_t numProgrammed = unicastRoutesToUpdate.size() +
+      unicastRoutesToDelete.size() + mplsRoutesToUpdate.size() +
+      mplsRoutesToDelete.size();
+  const size_t numUnchanged = unicastRoutes.size() +
+      (enableSegmentRouting_ ? mplsRoutes.size() : 0) -
+      unicastRoutesToUpdate.size() - mplsRoutesToUpdate.size();
+  fb303::fbData->addStatValue(
+      "fib.route_reconcile.routes_programmed", numProgrammed, fb303::SUM);
+  fb303::fbData->addStatValue(
+      "fib.route_reconcile.routes_unchanged", numUnchanged, fb303::SUM);
+}
+
 void
 Fib::keepAliveCheck() {
   createFibClient(evb_, socket_, client_, thriftPort_);
@@ -677,12 +1481,17 @@ Fib::updateGlobalCounters() {
 
   // Count the number of bgp routes
   int64_t bgpCounter = 0;
-  for (const auto& route : routeState_.unicastRoutes) {
-    if (route.second.data_ref().has_value()) {
+  for (const auto& [_, record] : routeState_.unicastRoutes) {
+    if (record.data) {
       bgpCounter++;
     }
   }
   fb303::fbData->setCounter("fib.num_routes.BGP", bgpCounter);
+
+  // Max values of route programming histograms
+  for (const auto& [histogram, maxValue] : histogramMax_) {
+    fb303::fbData->setCounter(histogram + ".max", maxValue);
+  }
 }
 
 void
@@ -750,12 +1559,36 @@ Fib::logPerfEvents(
     VLOG(2) << "  " << str;
   }
 
-  // Add new entry to perf DB and purge extra entries
-  perfDb_.push_back(std::move(perfEvents).value());
-  while (perfDb_.size() >= Constants::kPerfBufferSize) {
-    perfDb_.pop_front();
+  // Export convergence time by stage. Stages without both perf events, e.g.
+  // on route updates not triggered by adjacency change, are skipped
+  for (const auto& stage : kConvergenceStages) {
+    auto duration = getDurationBetweenPerfEvents(
+        *perfEvents, stage.firstEvent, stage.secondEvent);
+    if (duration.hasValue()) {
+      addHistogramValue(stage.histogram, duration->count());
+    }
+  }
+  addHistogramValue(kConvergenceTotalHistogram, totalDuration.count());
+  if (convergenceTimeTimer_) {
+    maxConvergenceTime_ = std::max(maxConvergenceTime_, totalDuration);
+    if (not convergenceTimeTimer_->isScheduled()) {
+      convergenceTimeTimer_->scheduleTimeout(
+          Constants::kConvergenceTimeFloodInterval);
+    }
   }
 
+  // Publish perf DB with new entry and without purged oldest ones. Copy is
+  // bounded by kPerfBufferSize entries
+  auto perfDb = std::make_shared<thrift::PerfDatabase>(dumpPerfDb());
+  auto& eventInfo = *perfDb->eventInfo_ref();
+  eventInfo.emplace_back(std::move(perfEvents).value());
+  if (eventInfo.size() >= Constants::kPerfBufferSize) {
+    eventInfo.erase(
+        eventInfo.begin(),
+        eventInfo.end() - (Constants::kPerfBufferSize - 1));
+  }
+  perfDbSnapshot_.store(std::move(perfDb));
+
   // Export convergence duration counter
   fb303::fbData->addStatValue(
       "fib.convergence_time_ms", totalDuration.count(), fb303::AVG);
@@ -765,7 +1598,9 @@ Fib::logPerfEvents(
   sample.addString("event", "ROUTE_CONVERGENCE");
   sample.addStringVector("perf_events", eventStrs);
   sample.addInt("duration_ms", totalDuration.count());
-  logSampleQueue_.push(sample);
+  if (logSampleLimiter_.admit(sample)) {
+    logSampleQueue_.push(std::move(sample));
+  }
 }
 
 } // namespace openr
@@ -7,7 +7,11 @@
 
 #pragma once
 
-#include <folly/fibers/Semaphore.h>
+#include <array>
+#include <unordered_set>
+
+#include <folly/concurrency/AtomicSharedPtr.h>
+#include <folly/fibers/Baton.h>
 #include <folly/io/async/AsyncSocket.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/EventBase.h>
@@ -21,10 +25,12 @@
 #include <openr/if/gen-cpp2/FibService.h>
 #include <openr/if/gen-cpp2/Fib_types.h>
 #include <openr/if/gen-cpp2/LinkMonitor_types.h>
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
 #include <openr/if/gen-cpp2/Platform_types.h>
 #include <openr/kvstore/KvStoreClientInternal.h>
 #include <openr/messaging/Queue.h>
 #include <openr/monitor/LogSample.h>
+#include <openr/monitor/LogSampleLimiter.h>
 
 namespace openr {
 
@@ -53,7 +59,7 @@ class Fib final : public OpenrEventBase {
   Fib(std::shared_ptr<const Config> config,
       int32_t thriftPort,
       std::chrono::seconds coldStartDuration,
-      messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueue,
+      messaging::RQueue<DecisionRouteUpdatePtr> routeUpdatesQueue,
       messaging::RQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue,
       messaging::ReplicateQueue<thrift::RouteDatabaseDelta>& fibUpdatesQueue,
       messaging::ReplicateQueue<LogSample>& logSampleQueue,
@@ -75,13 +81,116 @@ class Fib final : public OpenrEventBase {
       std::unique_ptr<thrift::FibServiceAsyncClient>& client,
       int32_t port);
 
+  /**
+   * Number of unicast routes per prefix length of each address family. Index
+   * of route database for longest prefix match, which only looks up prefix
+   * lengths present in the route database.
+   */
+  struct PrefixLengthCounts {
+    std::array<uint32_t, 33> v4{};
+    std::array<uint32_t, 129> v6{};
+
+    void add(const thrift::IpPrefix& prefix);
+    void remove(const thrift::IpPrefix& prefix);
+    void add(const folly::CIDRNetwork& prefix);
+    void remove(const folly::CIDRNetwork& prefix);
+    void add(const PackedPrefix& prefix);
+    void remove(const PackedPrefix& prefix);
+  };
+
+  /**
+   * Compact record of a unicast route as held in the route state. The prefix
+   * is the key of the record and next-hops refer to the group interned for
+   * all routes with the same next-hops. Records are converted to thrift only
+   * at API boundaries.
+   */
+  struct UnicastRouteRecord {
+    NextHops nexthops;
+    // BGP route data, set if route has data only
+    std::unique_ptr<std::string> data;
+    std::optional<thrift::AdminDistance> adminDistance;
+    std::optional<thrift::PrefixType> prefixType;
+    bool doNotInstall{false};
+
+    static UnicastRouteRecord fromThrift(const thrift::UnicastRoute& route);
+    thrift::UnicastRoute toThrift(const PackedPrefix& prefix) const;
+  };
+
+  using UnicastRouteRecords =
+      std::unordered_map<PackedPrefix, UnicastRouteRecord>;
+
+  /**
+   * Route changes not yet sent to the switch agent. Deltas are coalesced per
+   * prefix and label, i.e. the latest change of a route wins.
+   */
+  struct PendingRouteUpdates {
+    std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute>
+        unicastRoutesToUpdate;
+    std::unordered_set<thrift::IpPrefix> unicastRoutesToDelete;
+    std::unordered_map<int32_t, thrift::MplsRoute> mplsRoutesToUpdate;
+    std::unordered_set<int32_t> mplsRoutesToDelete;
+
+    // Perf events of the earliest delta merged, for end-to-end latency
+    std::optional<thrift::PerfEvents> perfEvents;
+    // Time when the earliest delta got merged
+    std::optional<std::chrono::steady_clock::time_point> pendingSince;
+
+    bool empty() const;
+
+    // Merge route changes, returns number of pending route changes which got
+    // superseded and hence need no programming
+    size_t merge(thrift::RouteDatabaseDelta&& routeDbDelta);
+
+    // Move out pending changes as delta, leaving none pending
+    thrift::RouteDatabaseDelta release();
+  };
+
+  /**
+   * Split unicast routes into one batch per priority class, highest priority
+   * first, followed by the batch of remaining routes. A route belongs to the
+   * first class with a prefix covering the route's prefix. Empty batches are
+   * omitted
+   */
+  static std::vector<std::vector<thrift::UnicastRoute>> splitByPriorityClass(
+      std::vector<thrift::UnicastRoute> unicastRoutes,
+      const std::vector<std::vector<folly::CIDRNetwork>>& priorityClasses);
+
+  /**
+   * Compute delta turning routes programmed in the agent into given routes.
+   * Routes are compared by forwarding attributes of their next-hops, i.e.
+   * address, weight and MPLS action, irrespective of next-hop order
+   */
+  static thrift::RouteDatabaseDelta computeRouteTableDelta(
+      const std::vector<thrift::UnicastRoute>& unicastRoutes,
+      const std::vector<thrift::UnicastRoute>& programmedUnicastRoutes,
+      const std::vector<thrift::MplsRoute>& mplsRoutes,
+      const std::vector<thrift::MplsRoute>& programmedMplsRoutes);
+
   /**
    * Perform longest prefix match among all prefixes in route database.
    * @param inputPrefix - a prefix that need to be matched
    * @param unicastRoutes - current unicast routes in RouteDatabase
+   * @param prefixLengthCounts - prefix lengths of unicastRoutes
    *
    * @return the matched IpPrefix if prefix matching succeed.
    */
+  static std::optional<thrift::IpPrefix> longestPrefixMatch(
+      const folly::CIDRNetwork& inputPrefix,
+      const std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute>&
+          unicastRoutes,
+      const PrefixLengthCounts& prefixLengthCounts);
+
+  /**
+   * Same as above on route records of the route state
+   */
+  static std::optional<folly::CIDRNetwork> longestPrefixMatch(
+      const folly::CIDRNetwork& inputPrefix,
+      const UnicastRouteRecords& unicastRoutes,
+      const PrefixLengthCounts& prefixLengthCounts);
+
+  /**
+   * Same as above, indexing prefix lengths of unicastRoutes on the fly
+   */
   static std::optional<thrift::IpPrefix> longestPrefixMatch(
       const folly::CIDRNetwork& inputPrefix,
       const std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute>&
@@ -101,9 +210,19 @@ class Fib final : public OpenrEventBase {
 
   /**
    * NOTE: DEPRECATED! Use getUnicastRoutes or getMplsRoutes.
+   *
+   * Served from snapshot of route database without running on Fib thread,
+   * unless routes changed since the last call. Thread safe
    */
   folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>> getRouteDb();
 
+  /**
+   * Retrieve page of route database, see thrift::PageParams. MPLS routes are
+   * paginated ahead of unicast routes
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::RouteDbPage>> getRouteDbPage(
+      thrift::PageParams page);
+
   /**
    * Retrieve unicast routes for specified prefixes or IP. Returns all if
    * no prefix is specified in filter list.
@@ -134,7 +253,7 @@ class Fib final : public OpenrEventBase {
   Fib& operator=(const Fib&) = delete;
 
   /**
-   * Convert local perfDb_ into PerfDataBase
+   * Copy of latest perfDbSnapshot_. Thread safe
    */
   thrift::PerfDatabase dumpPerfDb() const;
 
@@ -155,14 +274,53 @@ class Fib final : public OpenrEventBase {
    */
   void processRouteUpdates(thrift::RouteDatabaseDelta&& routeDelta);
 
+#if FOLLY_HAS_COROUTINES
   /**
-   * Trigger add/del routes thrift calls
-   * on success no action needed
-   * on failure invokes syncRouteDbDebounced
+   * Read and process route updates from Decision until queue gets closed,
+   * then stop route programming
+   */
+  folly::coro::Task<void> processRouteUpdatesQueue(
+      messaging::RQueue<DecisionRouteUpdatePtr> q);
+#endif
+
+  /**
+   * Convert all unicast routes of the route state to thrift
+   */
+  std::vector<thrift::UnicastRoute> getAllUnicastRoutes() const;
+
+  /**
+   * Queue route changes for programming. Changes get coalesced with pending
+   * ones while previous changes are being programmed
    */
   void updateRoutes(
       thrift::RouteDatabaseDelta&& routeDbDelta, bool isStaticRoutes);
 
+  /**
+   * Wake up route programming fiber for pending route updates or termination
+   */
+  void signalRouteProgramming();
+
+  /**
+   * Trigger add/del routes thrift calls with the async client, suspending the
+   * calling fiber until the agent responds
+   * on success no action needed
+   * on failure invokes syncRouteDbDebounced
+   */
+  void programRoutes(thrift::RouteDatabaseDelta&& routeDbDelta);
+
+  /**
+   * Record latency of a route programming call with numRoutes routes
+   */
+  void recordProgrammingCall(
+      const std::string& histogram,
+      std::chrono::steady_clock::time_point startTime,
+      size_t numRoutes);
+
+  /**
+   * Add value to fb303 histogram and track its max for flat counters
+   */
+  void addHistogramValue(const std::string& histogram, int64_t value);
+
   /**
    * Sync the current routeDb_ with the switch agent.
    * on success no action needed
@@ -170,6 +328,32 @@ class Fib final : public OpenrEventBase {
    */
   bool syncRouteDb();
 
+  /**
+   * Sync unicast routes via syncFibChunk in chunks of fibSyncChunkSize_
+   * routes. Up to kFibSyncMaxChunksInFlight chunks are in flight while the
+   * final chunk commits the sync after all others completed. Throws on
+   * failure of any chunk.
+   *
+   * An interrupted sync is resumed from its first chunk not acknowledged by
+   * the agent if neither the routes changed nor the agent discarded the
+   * chunks received so far, e.g. across reconnects or restarts of the agent
+   * retaining its state. Otherwise a new sync starts from the first chunk.
+   */
+  void syncUnicastRoutesInChunks(
+      const std::vector<thrift::UnicastRoute>& unicastRoutes);
+
+  // syncId of incomplete chunked sync retained by the agent, 0 if none
+  int64_t getAgentPendingSyncId();
+
+  /**
+   * Sync routes by reading route tables of the agent and programming only
+   * routes that differ. Routes get added before stale ones get deleted.
+   * Throws on failure of any call
+   */
+  void reconcileRouteDb(
+      const std::vector<thrift::UnicastRoute>& unicastRoutes,
+      const std::vector<thrift::MplsRoute>& mplsRoutes);
+
   /**
    * Asynchrounsly schedules the syncRouteDb call and returns immediately. All
    * APIs should call this function to sync-routes.
@@ -192,10 +376,14 @@ class Fib final : public OpenrEventBase {
   // Prefix to available nexthop information. Also store perf information of
   // received route-db if provided.
   struct RouteState {
-    // Non modified copy of Unicast and MPLS routes received from Decision
-    std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute> unicastRoutes;
+    // Unicast routes received from Decision as compact records and non
+    // modified copy of MPLS routes received from Decision
+    UnicastRouteRecords unicastRoutes;
     std::unordered_map<uint32_t, thrift::MplsRoute> mplsRoutes;
 
+    // Prefix lengths of unicastRoutes for longest prefix match
+    PrefixLengthCounts unicastPrefixLengths;
+
     // indicates we've received a decision route publication and therefore have
     // routes to sync. will not synce routes with system until this is set
     bool hasRoutesFromDecision{false};
@@ -208,8 +396,16 @@ class Fib final : public OpenrEventBase {
   };
   RouteState routeState_;
 
-  // Events to capture and indicate performance of protocol convergence.
-  std::deque<thrift::PerfEvents> perfDb_;
+  // Immutable snapshot of routeState_ routes served by getRouteDb(). Dropped
+  // on Fib thread on every route update and rebuilt there by the first
+  // reader afterwards, hence route updates don't pay for copies and repeated
+  // reads of unchanged routes don't touch Fib thread
+  folly::atomic_shared_ptr<const thrift::RouteDatabase> routeDbSnapshot_;
+
+  // Events to capture and indicate performance of protocol convergence. Ring
+  // of recent entries, replaced by a new snapshot on Fib thread on every
+  // logged event, hence getPerfDb() reads it without hopping onto Fib thread
+  folly::atomic_shared_ptr<const thrift::PerfDatabase> perfDbSnapshot_;
 
   // Create timestamp of recently logged perf event
   int64_t recentPerfEventCreateTs_{0};
@@ -226,9 +422,39 @@ class Fib final : public OpenrEventBase {
   // Enable segment routing
   bool enableSegmentRouting_{false};
 
+  // Prefixes of route priority classes, highest priority first
+  std::vector<std::vector<folly::CIDRNetwork>> priorityClasses_;
+
+  // Time window to coalesce route updates for before programming them
+  std::chrono::milliseconds routeCoalesceWindow_{0};
+
+  // Max number of routes per chunk of unicast route sync. 0 if disabled
+  size_t fibSyncChunkSize_{0};
+
+  // ID of last chunked unicast route sync
+  int64_t fibSyncId_{0};
+
+  // Interrupted chunked unicast route sync to resume
+  struct PendingChunkedSync {
+    int64_t syncId{0};
+    // Routes in order of chunks
+    std::vector<thrift::UnicastRoute> routes;
+    // Number of leading chunks acknowledged by the agent
+    size_t numChunksAcked{0};
+  };
+  std::optional<PendingChunkedSync> pendingChunkedSync_;
+
+  // Reconcile with route tables of the agent instead of full sync
+  bool enableRouteReconcile_{false};
+
   // indicates that we should publish fib programming time to kvstore
   bool enableOrderedFib_{false};
 
+  // Timer to flood worst convergence time since its last run. Set only if
+  // flooding of convergence time is enabled
+  std::unique_ptr<folly::AsyncTimeout> convergenceTimeTimer_{nullptr};
+  std::chrono::milliseconds maxConvergenceTime_{0};
+
   apache::thrift::CompactSerializer serializer_;
 
   // Thrift client connection to switch FIB Agent using which we actually
@@ -237,6 +463,11 @@ class Fib final : public OpenrEventBase {
   std::shared_ptr<folly::AsyncSocket> socket_{nullptr};
   std::unique_ptr<thrift::FibServiceAsyncClient> client_{nullptr};
 
+  // Thrift client connection to switch FIB Agent driven by the Fib event base
+  // for incremental route programming, which doesn't block the event base
+  std::shared_ptr<folly::AsyncSocket> asyncSocket_{nullptr};
+  std::unique_ptr<thrift::FibServiceAsyncClient> asyncClient_{nullptr};
+
   // Callback timer to sync routes to switch agent and scheduled on route-sync
   // failure. ExponentialBackoff timer to ease up things if they go wrong
   std::unique_ptr<folly::AsyncTimeout> syncRoutesTimer_{nullptr};
@@ -261,14 +492,23 @@ class Fib final : public OpenrEventBase {
 
   const int16_t kFibId_{static_cast<int16_t>(thrift::FibClient::OPENR)};
 
-  // TODO: Remove if not needed
-  // Semaphore to serialize route programming across two fibers (interface
-  // updates & route updates)
-  // NOTE: Initializing with a single slot to avoid parallel processing
-  folly::fibers::Semaphore updateRoutesSemaphore_{1};
+  // Route updates to program once route updates in flight got programmed.
+  // Programming is serialized on the route programming fiber, which gets
+  // woken up by the baton
+  PendingRouteUpdates pendingRouteUpdates_;
+  folly::fibers::Baton routeProgrammingBaton_;
+  bool isRouteProgrammingSignaled_{false};
+  bool isRouteProgrammingInFlight_{false};
+  bool isRouteProgrammingStopped_{false};
 
   // Queue to publish the event log
   messaging::ReplicateQueue<LogSample>& logSampleQueue_;
+
+  // Sampling and rate limiting of route convergence events
+  LogSampleLimiter logSampleLimiter_;
+
+  // Max value of route programming histograms, exported as flat counters
+  std::unordered_map<std::string, int64_t> histogramMax_;
 };
 
 } // namespace openr
@@ -7,7 +7,10 @@
 
 #include <gtest/gtest.h>
 
+#include <deque>
+
 #include <folly/Benchmark.h>
+#include <folly/Random.h>
 #include <folly/init/Init.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 #include <thrift/lib/cpp2/util/ScopedServerThread.h>
@@ -52,6 +55,17 @@ static const long kBitMaskLen = 128;
 static const uint32_t kDeltaSize = 10;
 // Number of nexthops
 const uint8_t kNumOfNexthops = 128;
+// Number of nexthops of routes in route table benchmarks
+const uint8_t kNumOfTableNexthops = 4;
+// Number of prefixes looked up per getUnicastRoutesFiltered call
+const uint32_t kNumOfLookups = 100;
+
+int64_t
+getElapsedMs(std::chrono::steady_clock::time_point startTime) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - startTime)
+      .count();
+}
 
 } // anonymous namespace
 
@@ -62,7 +76,8 @@ using apache::thrift::util::ScopedServerThread;
 
 class FibWrapper {
  public:
-  FibWrapper() {
+  explicit FibWrapper(
+      bool waitOnDecision = false, bool enableSegmentRouting = false) {
     // Register Singleton
     folly::SingletonVault::singleton()->registrationComplete();
     // Create MockNetlinkFibHandler
@@ -81,9 +96,13 @@ class FibWrapper {
         "domain",
         {}, /* area config */
         true, /* enableV4 */
-        false /*enableSegmentRouting*/,
+        enableSegmentRouting,
         false /*orderedFibProgramming*/,
         false /*dryrun*/);
+    if (waitOnDecision) {
+      // Sync routes as soon as the first route update is received
+      tConfig.eor_time_s_ref() = 1;
+    }
     config = std::make_shared<Config>(tConfig);
 
     // Creat Fib module and start fib thread
@@ -185,7 +204,7 @@ class FibWrapper {
   std::shared_ptr<ThriftServer> server;
   ScopedServerThread fibThriftThread;
 
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> fibUpdatesQueue;
   messaging::ReplicateQueue<LogSample> logSampleQueue;
@@ -203,6 +222,40 @@ class FibWrapper {
   PrefixGenerator prefixGenerator;
 };
 
+// Random set of at most numOfNexthops nexthops
+NextHopSet
+getRandomNextHopSet(uint8_t numOfNexthops) {
+  auto nhs =
+      PrefixGenerator::getRandomNextHopsUnicast(numOfNexthops, kVethNameY);
+  return NextHopSet(nhs.begin(), nhs.end());
+}
+
+// Random set of at most numOfNexthops nexthops swapping label
+NextHopSet
+getRandomMplsNextHopSet(uint8_t numOfNexthops, int32_t label) {
+  auto nhs =
+      PrefixGenerator::getRandomNextHopsUnicast(numOfNexthops, kVethNameY);
+  for (auto& nh : nhs) {
+    nh.mplsAction_ref() =
+        createMplsAction(thrift::MplsActionCode::SWAP, label + 1);
+  }
+  return NextHopSet(nhs.begin(), nhs.end());
+}
+
+// Route update of unicast routes to prefixes with random nexthops
+DecisionRouteUpdate
+getUnicastRouteUpdate(
+    const std::vector<thrift::IpPrefix>& prefixes, uint8_t numOfNexthops) {
+  DecisionRouteUpdate routeUpdate;
+  for (const auto& prefix : prefixes) {
+    routeUpdate.unicastRoutesToUpdate.emplace(
+        toIPNetwork(prefix),
+        RibUnicastEntry(
+            toIPNetwork(prefix), getRandomNextHopSet(numOfNexthops)));
+  }
+  return routeUpdate;
+}
+
 /**
  * Benchmark for fib
  * 1. Create a fib
@@ -211,7 +264,11 @@ class FibWrapper {
  * 4. Wait until the completion of routes update
  */
 static void
-BM_Fib(folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
+BM_Fib(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numOfPrefixes,
+    uint8_t numOfNexthops = kNumOfNexthops) {
   auto suspender = folly::BenchmarkSuspender();
   // Fib starts with clean route database
   auto fibWrapper = std::make_unique<FibWrapper>();
@@ -223,17 +280,9 @@ BM_Fib(folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
   auto prefixes = fibWrapper->prefixGenerator.ipv6PrefixGenerator(
       numOfPrefixes, kBitMaskLen);
   {
-    DecisionRouteUpdate routeUpdate;
-    for (auto& prefix : prefixes) {
-      auto nhs = fibWrapper->prefixGenerator.getRandomNextHopsUnicast(
-          kNumOfNexthops, kVethNameY);
-      auto nhsSet =
-          std::unordered_set<thrift::NextHopThrift>(nhs.begin(), nhs.end());
-      routeUpdate.unicastRoutesToUpdate.emplace(
-          toIPNetwork(prefix), RibUnicastEntry(toIPNetwork(prefix), nhsSet));
-    }
+    auto routeUpdate = getUnicastRouteUpdate(prefixes, numOfNexthops);
     // Send routeDB to Fib and wait for updating completing
-    fibWrapper->routeUpdatesQueue.push(std::move(routeUpdate));
+    fibWrapper->routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
   fibWrapper->mockFibHandler->waitForUpdateUnicastRoutes();
 
@@ -248,23 +297,17 @@ BM_Fib(folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
 
   for (uint32_t i = 0; i < iters; i++) {
     // Update routes by randomly regenerating nextHops for deltaSize prefixes.
-    DecisionRouteUpdate routeUpdate;
-    for (uint32_t index = 0; index < deltaSize; index++) {
-      auto nhs = fibWrapper->prefixGenerator.getRandomNextHopsUnicast(
-          kNumOfNexthops, kVethNameY);
-      auto nhsSet =
-          std::unordered_set<thrift::NextHopThrift>(nhs.begin(), nhs.end());
-      routeUpdate.unicastRoutesToUpdate.emplace(
-          toIPNetwork(prefixes[index]),
-          RibUnicastEntry(toIPNetwork(prefixes[index]), nhsSet));
-    }
+    auto routeUpdate = getUnicastRouteUpdate(
+        std::vector<thrift::IpPrefix>(
+            prefixes.begin(), prefixes.begin() + deltaSize),
+        numOfNexthops);
     // Add perfevents
     thrift::PerfEvents perfEvents;
     addPerfEvent(perfEvents, "node-1", "FIB_INIT_UPDATE");
     routeUpdate.perfEvents = perfEvents;
 
     // Send routeDB to Fib for updates
-    fibWrapper->routeUpdatesQueue.push(std::move(routeUpdate));
+    fibWrapper->routeUpdatesQueue.pushShared(std::move(routeUpdate));
     fibWrapper->mockFibHandler->waitForUpdateUnicastRoutes();
 
     // Get time information from perf event
@@ -282,12 +325,251 @@ BM_Fib(folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
   counters["route_install"] = processTimes[2];
 }
 
+/**
+ * Benchmark for longest prefix match of fib
+ * 1. Generate random IpV6 routes of various prefix lengths
+ * 2. Look up addresses covered by the routes
+ */
+static void
+BM_FibLongestPrefixMatch(uint32_t iters, unsigned numOfPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  PrefixGenerator prefixGenerator;
+  std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute> unicastRoutes;
+  Fib::PrefixLengthCounts prefixLengthCounts;
+  for (const auto bitMaskLen : {48, 64, 128}) {
+    for (auto& prefix : prefixGenerator.ipv6PrefixGenerator(
+             numOfPrefixes / 3 + 1, bitMaskLen)) {
+      thrift::UnicastRoute route;
+      route.dest_ref() = prefix;
+      if (unicastRoutes.emplace(prefix, std::move(route)).second) {
+        prefixLengthCounts.add(prefix);
+      }
+    }
+  }
+  std::vector<folly::CIDRNetwork> inputPrefixes;
+  for (const auto& [prefix, _] : unicastRoutes) {
+    auto network = toIPNetwork(prefix);
+    inputPrefixes.emplace_back(network.first, 128);
+  }
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto matchedPrefix = Fib::longestPrefixMatch(
+        inputPrefixes.at(i % inputPrefixes.size()),
+        unicastRoutes,
+        prefixLengthCounts);
+    folly::doNotOptimizeAway(matchedPrefix);
+  }
+}
+
+/**
+ * Benchmark for full sync of unicast routes
+ * 1. Create a fib waiting for the first route update to sync routes
+ * 2. Send numOfPrefixes routes with up to numOfNexthops nexthops to fib
+ * 3. Wait until routes got synced and read back the route database
+ */
+static void
+BM_FibSync(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numOfPrefixes,
+    uint8_t numOfNexthops = kNumOfTableNexthops) {
+  auto suspender = folly::BenchmarkSuspender();
+  int64_t syncMs{0};
+  int64_t getRouteDbMs{0};
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto fibWrapper = std::make_unique<FibWrapper>(true /* waitOnDecision */);
+    auto routeUpdate = getUnicastRouteUpdate(
+        fibWrapper->prefixGenerator.ipv6PrefixGenerator(
+            numOfPrefixes, kBitMaskLen),
+        numOfNexthops);
+    suspender.dismiss(); // Start measuring benchmark time
+
+    auto startTime = std::chrono::steady_clock::now();
+    fibWrapper->routeUpdatesQueue.pushShared(std::move(routeUpdate));
+    fibWrapper->mockFibHandler->waitForSyncFib();
+    syncMs += getElapsedMs(startTime);
+
+    startTime = std::chrono::steady_clock::now();
+    auto routeDb = fibWrapper->handler->semifuture_getRouteDb().get();
+    folly::doNotOptimizeAway(routeDb);
+    getRouteDbMs += getElapsedMs(startTime);
+
+    suspender.rehire(); // Stop measuring time again
+  }
+
+  const auto numIters = std::max<uint32_t>(iters, 1);
+  counters["route_sync_ms"] = syncMs / numIters;
+  counters["get_route_db_ms"] = getRouteDbMs / numIters;
+}
+
+/**
+ * Benchmark for mixed deltas on a large route table
+ * 1. Create a fib and sync numOfPrefixes routes
+ * 2. Add kDeltaSize new routes and delete kDeltaSize existing ones per
+ *    route update
+ * 3. Wait until routes got added and deleted
+ */
+static void
+BM_FibMixedDelta(
+    folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto fibWrapper = std::make_unique<FibWrapper>(true /* waitOnDecision */);
+
+  auto prefixes = fibWrapper->prefixGenerator.ipv6PrefixGenerator(
+      numOfPrefixes, kBitMaskLen);
+  std::deque<thrift::IpPrefix> programmedPrefixes(
+      prefixes.begin(), prefixes.end());
+  fibWrapper->routeUpdatesQueue.pushShared(
+      getUnicastRouteUpdate(prefixes, kNumOfTableNexthops));
+  fibWrapper->mockFibHandler->waitForSyncFib();
+
+  const auto deltaSize = std::min<uint32_t>(kDeltaSize, numOfPrefixes);
+  int64_t updateMs{0};
+  for (uint32_t i = 0; i < iters; i++) {
+    auto newPrefixes =
+        fibWrapper->prefixGenerator.ipv6PrefixGenerator(deltaSize, kBitMaskLen);
+    auto routeUpdate = getUnicastRouteUpdate(newPrefixes, kNumOfTableNexthops);
+    for (uint32_t index = 0; index < deltaSize; index++) {
+      routeUpdate.unicastRoutesToDelete.emplace_back(
+          toIPNetwork(programmedPrefixes.front()));
+      programmedPrefixes.pop_front();
+    }
+    programmedPrefixes.insert(
+        programmedPrefixes.end(), newPrefixes.begin(), newPrefixes.end());
+    suspender.dismiss(); // Start measuring benchmark time
+
+    const auto startTime = std::chrono::steady_clock::now();
+    fibWrapper->routeUpdatesQueue.pushShared(std::move(routeUpdate));
+    fibWrapper->mockFibHandler->waitForUpdateUnicastRoutes();
+    fibWrapper->mockFibHandler->waitForDeleteUnicastRoutes();
+    updateMs += getElapsedMs(startTime);
+
+    suspender.rehire(); // Stop measuring time again
+  }
+
+  counters["route_update_ms"] = updateMs / std::max<uint32_t>(iters, 1);
+}
+
+/**
+ * Benchmark for MPLS heavy route tables
+ * 1. Create a fib with segment routing and sync numOfLabels MPLS routes
+ * 2. Update kDeltaSize MPLS routes with new nexthops per route update
+ * 3. Wait until MPLS routes got updated
+ */
+static void
+BM_FibMpls(
+    folly::UserCounters& counters, uint32_t iters, unsigned numOfLabels) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto fibWrapper = std::make_unique<FibWrapper>(
+      true /* waitOnDecision */, true /* enableSegmentRouting */);
+
+  // labels start after reserved range of MPLS labels
+  const int32_t firstLabel = 16;
+  {
+    DecisionRouteUpdate routeUpdate;
+    for (unsigned index = 0; index < numOfLabels; index++) {
+      const int32_t label = firstLabel + index;
+      routeUpdate.mplsRoutesToUpdate.emplace_back(RibMplsEntry(
+          label, getRandomMplsNextHopSet(kNumOfTableNexthops, label)));
+    }
+    suspender.dismiss();
+    const auto startTime = std::chrono::steady_clock::now();
+    fibWrapper->routeUpdatesQueue.pushShared(std::move(routeUpdate));
+    fibWrapper->mockFibHandler->waitForSyncFib();
+    fibWrapper->mockFibHandler->waitForSyncMplsFib();
+    counters["mpls_sync_ms"] = getElapsedMs(startTime);
+    suspender.rehire();
+  }
+
+  const auto deltaSize = std::min<uint32_t>(kDeltaSize, numOfLabels);
+  int64_t updateMs{0};
+  for (uint32_t i = 0; i < iters; i++) {
+    DecisionRouteUpdate routeUpdate;
+    for (uint32_t index = 0; index < deltaSize; index++) {
+      const int32_t label = firstLabel +
+          folly::Random::rand32() % std::max<unsigned>(numOfLabels, 1);
+      routeUpdate.mplsRoutesToUpdate.emplace_back(RibMplsEntry(
+          label, getRandomMplsNextHopSet(kNumOfTableNexthops, label)));
+    }
+    suspender.dismiss(); // Start measuring benchmark time
+
+    const auto startTime = std::chrono::steady_clock::now();
+    fibWrapper->routeUpdatesQueue.pushShared(std::move(routeUpdate));
+    fibWrapper->mockFibHandler->waitForUpdateMplsRoutes();
+    updateMs += getElapsedMs(startTime);
+
+    suspender.rehire(); // Stop measuring time again
+  }
+
+  counters["mpls_update_ms"] = updateMs / std::max<uint32_t>(iters, 1);
+}
+
+/**
+ * Benchmark for getUnicastRoutesFiltered
+ * 1. Create a fib and sync numOfPrefixes routes
+ * 2. Look up kNumOfLookups addresses covered by the routes per call
+ */
+static void
+BM_FibGetUnicastRoutesFiltered(uint32_t iters, unsigned numOfPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto fibWrapper = std::make_unique<FibWrapper>(true /* waitOnDecision */);
+
+  auto prefixes = fibWrapper->prefixGenerator.ipv6PrefixGenerator(
+      numOfPrefixes, kBitMaskLen);
+  fibWrapper->routeUpdatesQueue.pushShared(
+      getUnicastRouteUpdate(prefixes, kNumOfTableNexthops));
+  fibWrapper->mockFibHandler->waitForSyncFib();
+
+  std::vector<std::string> lookups;
+  for (uint32_t index = 0; index < kNumOfLookups; index++) {
+    lookups.emplace_back(
+        toIPNetwork(prefixes.at(index % prefixes.size())).first.str());
+  }
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto routes = fibWrapper->handler
+                      ->semifuture_getUnicastRoutesFiltered(
+                          std::make_unique<std::vector<std::string>>(lookups))
+                      .get();
+    folly::doNotOptimizeAway(routes);
+  }
+
+  suspender.rehire(); // Stop measuring time again
+}
+
 // The parameter is the number of prefixes sent to fib
 BENCHMARK_COUNTERS_PARAM(BM_Fib, counters, 10);
 BENCHMARK_COUNTERS_PARAM(BM_Fib, counters, 100);
 BENCHMARK_COUNTERS_PARAM(BM_Fib, counters, 1000);
 BENCHMARK_COUNTERS_PARAM(BM_Fib, counters, 9000);
 
+// The parameters are the number of prefixes and of nexthops per prefix
+BENCHMARK_COUNTERS_NAME_PARAM(BM_Fib, counters, 1000_16, 1000, 16);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_Fib, counters, 1000_255, 1000, 255);
+
+// The parameter is the number of routes synced to fib
+BENCHMARK_COUNTERS_PARAM(BM_FibSync, counters, 10000);
+BENCHMARK_COUNTERS_PARAM(BM_FibSync, counters, 100000);
+BENCHMARK_COUNTERS_PARAM(BM_FibSync, counters, 1000000);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_FibSync, counters, 10000_128, 10000, 128);
+
+// The parameter is the number of routes in fib
+BENCHMARK_COUNTERS_PARAM(BM_FibMixedDelta, counters, 10000);
+BENCHMARK_COUNTERS_PARAM(BM_FibMixedDelta, counters, 100000);
+
+// The parameter is the number of MPLS routes in fib
+BENCHMARK_COUNTERS_PARAM(BM_FibMpls, counters, 10000);
+BENCHMARK_COUNTERS_PARAM(BM_FibMpls, counters, 100000);
+
+// The parameter is the number of routes in fib
+BENCHMARK_PARAM(BM_FibLongestPrefixMatch, 1000);
+BENCHMARK_PARAM(BM_FibLongestPrefixMatch, 100000);
+BENCHMARK_PARAM(BM_FibGetUnicastRoutesFiltered, 10000);
+BENCHMARK_PARAM(BM_FibGetUnicastRoutesFiltered, 1000000);
+
 } // namespace openr
 
 int
@@ -5,10 +5,12 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fb303/ServiceData.h>
 #include <folly/init/Init.h>
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 #include <thrift/lib/cpp2/util/ScopedServerThread.h>
 
@@ -37,6 +39,7 @@ const auto prefix1 = toIpPrefix("::ffff:10.1.1.1/128");
 const auto prefix2 = toIpPrefix("::ffff:10.2.2.2/128");
 const auto prefix3 = toIpPrefix("::ffff:10.3.3.3/128");
 const auto prefix4 = toIpPrefix("::ffff:10.4.4.4/128");
+const auto prefix5 = toIpPrefix("::ffff:10.5.5.5/128");
 
 const auto label1{1};
 const auto label2{2};
@@ -214,8 +217,15 @@ checkEqualRouteDatabaseDeltaUnicast(
 
 class FibTestFixture : public ::testing::Test {
  public:
-  explicit FibTestFixture(bool waitOnDecision = false)
-      : waitOnDecision_(waitOnDecision) {}
+  explicit FibTestFixture(
+      bool waitOnDecision = false,
+      int32_t fibSyncChunkSize = 0,
+      int32_t routeCoalesceWindowMs = 0,
+      bool enableRouteReconcile = false)
+      : waitOnDecision_(waitOnDecision),
+        fibSyncChunkSize_(fibSyncChunkSize),
+        routeCoalesceWindowMs_(routeCoalesceWindowMs),
+        enableRouteReconcile_(enableRouteReconcile) {}
   void
   SetUp() override {
     mockFibHandler = std::make_shared<MockNetlinkFibHandler>();
@@ -240,6 +250,13 @@ class FibTestFixture : public ::testing::Test {
     if (waitOnDecision_) {
       tConfig.eor_time_s_ref() = 1;
     }
+    if (fibSyncChunkSize_ > 0) {
+      tConfig.fib_sync_chunk_size_ref() = fibSyncChunkSize_;
+    }
+    if (routeCoalesceWindowMs_ > 0) {
+      tConfig.fib_route_coalesce_window_ms_ref() = routeCoalesceWindowMs_;
+    }
+    tConfig.enable_fib_route_reconcile_ref() = enableRouteReconcile_;
 
     config = make_shared<Config>(tConfig);
 
@@ -387,7 +404,7 @@ class FibTestFixture : public ::testing::Test {
   std::shared_ptr<ThriftServer> server;
   ScopedServerThread fibThriftThread;
 
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> fibUpdatesQueue;
   messaging::ReplicateQueue<openr::LogSample> logSampleQueue;
@@ -405,6 +422,9 @@ class FibTestFixture : public ::testing::Test {
 
  private:
   bool waitOnDecision_{false};
+  int32_t fibSyncChunkSize_{0};
+  int32_t routeCoalesceWindowMs_{0};
+  bool enableRouteReconcile_{false};
 };
 
 // Fib single streaming client test.
@@ -426,7 +446,7 @@ TEST_F(FibTestFixture, fibStreamingSingleSubscriber) {
     routeUpdate1.unicastRoutesToUpdate.emplace(
         toIPNetwork(prefix1),
         RibUnicastEntry(toIPNetwork(prefix1), {path1_2_1, path1_2_2}));
-    routeUpdatesQueue.push(std::move(routeUpdate1));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate1));
 
     // Start the streaming after OpenrCtrlHandler consumes initial route update.
     wait_for_initial_update();
@@ -491,9 +511,9 @@ TEST_F(FibTestFixture, fibStreamingSingleSubscriber) {
 
     EXPECT_EQ(1, handler->getNumFibPublishers());
 
-    routeUpdatesQueue.push(std::move(routeUpdate2));
-    routeUpdatesQueue.push(std::move(routeUpdate3));
-    routeUpdatesQueue.push(std::move(routeUpdate4));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate2));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate3));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate4));
 
     // Check we should receive 2 updates
     while (received < 2) {
@@ -528,7 +548,7 @@ TEST_F(FibTestFixture, fibStreamingTwoSubscribers) {
     routeUpdate1.unicastRoutesToUpdate.emplace(
         toIPNetwork(prefix1),
         RibUnicastEntry(toIPNetwork(prefix1), {path1_2_1, path1_2_2}));
-    routeUpdatesQueue.push(std::move(routeUpdate1));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate1));
 
     // Start the streaming after OpenrCtrlHandler consumes initial route update.
     wait_for_initial_update();
@@ -582,7 +602,7 @@ TEST_F(FibTestFixture, fibStreamingTwoSubscribers) {
 
     EXPECT_EQ(2, handler->getNumFibPublishers());
 
-    routeUpdatesQueue.push(std::move(routeUpdate2));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate2));
 
     // Check we should receive 1 updates for each client
     while ((received_1 < 1) || (received_2 < 1)) {
@@ -602,6 +622,83 @@ TEST_F(FibTestFixture, fibStreamingTwoSubscribers) {
   }
 }
 
+// Verify serialized stream delivers the same delta as the typed stream
+TEST_F(FibTestFixture, fibStreamingSerialized) {
+  std::atomic<int> received{0};
+  std::atomic<int> receivedSerialized{0};
+
+  DecisionRouteUpdate routeUpdate1;
+  routeUpdate1.unicastRoutesToUpdate.emplace(
+      toIPNetwork(prefix1),
+      RibUnicastEntry(toIPNetwork(prefix1), {path1_2_1, path1_2_2}));
+  routeUpdatesQueue.pushShared(std::move(routeUpdate1));
+
+  // Start the streaming after OpenrCtrlHandler consumes initial route update.
+  wait_for_initial_update();
+  auto responseAndSubscription = handler->semifuture_subscribeAndGetFib().get();
+  auto responseAndSubscriptionSerialized =
+      handler->semifuture_subscribeAndGetFibSerialized().get();
+  EXPECT_EQ(
+      *responseAndSubscription.response.unicastRoutes_ref(),
+      *responseAndSubscriptionSerialized.response.unicastRoutes_ref());
+
+  thrift::RouteDatabaseDelta routeDbExpected;
+  (*routeDbExpected.unicastRoutesToUpdate_ref())
+      .emplace_back(createUnicastRoute(prefix3, {path1_2_1, path1_2_2}));
+  DecisionRouteUpdate routeUpdate2;
+  routeUpdate2.unicastRoutesToUpdate.emplace(
+      toIPNetwork(prefix3),
+      RibUnicastEntry(toIPNetwork(prefix3), {path1_2_1, path1_2_2}));
+
+  auto subscription =
+      std::move(responseAndSubscription.stream)
+          .toClientStreamUnsafeDoNotUse()
+          .subscribeExTry(
+              folly::getEventBase(), [&received, &routeDbExpected](auto&& t) {
+                if (not t.hasValue()) {
+                  return;
+                }
+                EXPECT_TRUE(
+                    checkEqualRouteDatabaseDeltaUnicast(routeDbExpected, *t));
+                received++;
+              });
+
+  auto subscriptionSerialized =
+      std::move(responseAndSubscriptionSerialized.stream)
+          .toClientStreamUnsafeDoNotUse()
+          .subscribeExTry(
+              folly::getEventBase(),
+              [&receivedSerialized, &routeDbExpected](auto&& t) {
+                if (not t.hasValue()) {
+                  return;
+                }
+                auto delta = apache::thrift::CompactSerializer::deserialize<
+                    thrift::RouteDatabaseDelta>(&*t);
+                EXPECT_TRUE(checkEqualRouteDatabaseDeltaUnicast(
+                    routeDbExpected, delta));
+                receivedSerialized++;
+              });
+
+  EXPECT_EQ(2, handler->getNumFibPublishers());
+
+  routeUpdatesQueue.pushShared(std::move(routeUpdate2));
+
+  while ((received < 1) || (receivedSerialized < 1)) {
+    std::this_thread::yield();
+  }
+
+  // Cancel subscription
+  subscription.cancel();
+  std::move(subscription).detach();
+  subscriptionSerialized.cancel();
+  std::move(subscriptionSerialized).detach();
+
+  // Wait until publisher is destroyed
+  while (handler->getNumFibPublishers() != 0) {
+    std::this_thread::yield();
+  }
+}
+
 TEST_F(FibTestFixture, processRouteDb) {
   // Make sure fib starts with clean route database
   std::vector<thrift::UnicastRoute> routes;
@@ -624,7 +721,7 @@ TEST_F(FibTestFixture, processRouteDb) {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(
         RibUnicastEntry(toIPNetwork(prefix2), {path1_2_1, path1_2_2}));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
 
   int64_t countAdd = mockFibHandler->getAddRoutesCount();
@@ -648,7 +745,7 @@ TEST_F(FibTestFixture, processRouteDb) {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(
         RibUnicastEntry(toIPNetwork(prefix3), {path1_3_1, path1_3_2}));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
 
   // syncFib debounce
@@ -672,7 +769,7 @@ TEST_F(FibTestFixture, processRouteDb) {
         RibUnicastEntry(toIPNetwork(prefix2), {path1_2_2, path1_2_3}));
     routeUpdate.addRouteToUpdate(
         RibUnicastEntry(toIPNetwork(prefix3), {path1_3_2}));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
   // syncFib debounce
   mockFibHandler->waitForUpdateUnicastRoutes();
@@ -683,6 +780,45 @@ TEST_F(FibTestFixture, processRouteDb) {
   EXPECT_TRUE(checkEqualRouteDatabaseUnicast(routeDb, getRouteDb()));
 }
 
+// Perf DB keeps most recent convergence events, and is read without Fib
+// thread
+TEST_F(FibTestFixture, perfDbRing) {
+  mockFibHandler->waitForSyncFib();
+
+  const size_t numUpdates = Constants::kPerfBufferSize + 2;
+  for (size_t i = 0; i < numUpdates; ++i) {
+    DecisionRouteUpdate routeUpdate;
+    // every update changes next-hops of the route
+    routeUpdate.addRouteToUpdate(RibUnicastEntry(
+        toIPNetwork(prefix2), {i % 2 ? path1_2_1 : path1_2_2}));
+    routeUpdate.perfEvents = thrift::PerfEvents();
+    addPerfEvent(
+        *routeUpdate.perfEvents, folly::sformat("node-{}", i), "DECISION");
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
+    mockFibHandler->waitForUpdateUnicastRoutes();
+
+    // perf events with older create timestamp are ignored
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+
+  // node name of first event of entry in perf DB
+  auto getNodeName = [](thrift::PerfEvents const& perfEvents) {
+    return *perfEvents.events_ref()->front().nodeName_ref();
+  };
+  const auto lastNodeName = folly::sformat("node-{}", numUpdates - 1);
+  thrift::PerfDatabase perfDb;
+  while (perfDb.eventInfo_ref()->empty() or
+         getNodeName(perfDb.eventInfo_ref()->back()) != lastNodeName) {
+    std::this_thread::yield();
+    perfDb = *fib->getPerfDb().get();
+  }
+  EXPECT_EQ(Constants::kPerfBufferSize - 1, perfDb.eventInfo_ref()->size());
+  EXPECT_EQ(
+      folly::sformat("node-{}", numUpdates - Constants::kPerfBufferSize + 1),
+      getNodeName(perfDb.eventInfo_ref()->front()));
+}
+
 TEST_F(FibTestFixture, basicAddAndDelete) {
   // Make sure fib starts with clean route database
   std::vector<thrift::UnicastRoute> routes;
@@ -709,7 +845,7 @@ TEST_F(FibTestFixture, basicAddAndDelete) {
         RibMplsEntry(label2, {mpls_path1_2_2}));
     routeUpdate.mplsRoutesToUpdate.emplace_back(
         RibMplsEntry(label3, {mpls_path1_2_1}));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
 
   // wait
@@ -732,7 +868,7 @@ TEST_F(FibTestFixture, basicAddAndDelete) {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.unicastRoutesToDelete = {toIPNetwork(prefix3)};
     routeUpdate.mplsRoutesToDelete = {label1, label3};
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
 
   mockFibHandler->waitForDeleteUnicastRoutes();
@@ -757,7 +893,7 @@ TEST_F(FibTestFixture, basicAddAndDelete) {
         RibUnicastEntry(toIPNetwork(prefix3), {path1_3_1, path1_3_2}));
     routeUpdate.mplsRoutesToUpdate.emplace_back(
         RibMplsEntry(label1, {mpls_path1_2_1, mpls_path1_2_2}));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
 
   mockFibHandler->waitForUpdateUnicastRoutes();
@@ -792,7 +928,7 @@ TEST_F(FibTestFixture, fibRestart) {
   routeUpdate.mplsRoutesToUpdate.emplace_back(
       RibMplsEntry(label2, {mpls_path1_2_2}));
 
-  routeUpdatesQueue.push(std::move(routeUpdate));
+  routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
   // initial syncFib debounce
   mockFibHandler->waitForSyncFib();
@@ -844,7 +980,7 @@ TEST_F(FibTestFixtureWaitOnDecision, WaitOnDecision) {
   routeUpdate.mplsRoutesToUpdate.emplace_back(
       RibMplsEntry(label2, {mpls_path1_2_2}));
 
-  routeUpdatesQueue.push(std::move(routeUpdate));
+  routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
   // initial syncFib debounce
   mockFibHandler->waitForSyncFib();
@@ -860,6 +996,149 @@ TEST_F(FibTestFixtureWaitOnDecision, WaitOnDecision) {
   EXPECT_EQ(mockFibHandler->getDelMplsRoutesCount(), 0);
 }
 
+class FibTestFixtureChunkedSync : public FibTestFixture {
+ public:
+  FibTestFixtureChunkedSync() : FibTestFixture(true, 2) {}
+};
+
+// Full sync of more routes than fit in a chunk is done in chunks of at most
+// fib_sync_chunk_size routes, committed by the final one
+TEST_F(FibTestFixtureChunkedSync, ChunkedSync) {
+  thrift::RouteDatabase routeDb;
+  *routeDb.thisNodeName_ref() = "node-1";
+  DecisionRouteUpdate routeUpdate;
+  for (const auto& prefix : {prefix1, prefix2, prefix3, prefix4, prefix5}) {
+    routeDb.unicastRoutes_ref()->emplace_back(
+        createUnicastRoute(prefix, {path1_2_1}));
+    routeUpdate.addRouteToUpdate(
+        RibUnicastEntry(toIPNetwork(prefix), {path1_2_1}));
+  }
+  routeUpdatesQueue.pushShared(std::move(routeUpdate));
+
+  // initial syncFib debounce
+  mockFibHandler->waitForSyncFib();
+
+  // 5 routes get synced in chunks of 2, 2 and 1 routes
+  EXPECT_EQ(mockFibHandler->getFibSyncChunkCount(), 3);
+  EXPECT_EQ(mockFibHandler->getFibSyncCount(), 1);
+  EXPECT_EQ(mockFibHandler->getAddRoutesCount(), 0);
+  EXPECT_EQ(mockFibHandler->getDelRoutesCount(), 0);
+
+  std::vector<thrift::UnicastRoute> routes;
+  mockFibHandler->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(routes.size(), 5);
+  EXPECT_TRUE(checkEqualRouteDatabaseUnicast(routeDb, getRouteDb()));
+}
+
+// Interrupted chunked sync resumes from its first unacknowledged chunk
+TEST_F(FibTestFixtureChunkedSync, ResumeChunkedSync) {
+  mockFibHandler->failFinalSyncFibChunk();
+
+  thrift::RouteDatabase routeDb;
+  *routeDb.thisNodeName_ref() = "node-1";
+  DecisionRouteUpdate routeUpdate;
+  for (const auto& prefix : {prefix1, prefix2, prefix3, prefix4, prefix5}) {
+    routeDb.unicastRoutes_ref()->emplace_back(
+        createUnicastRoute(prefix, {path1_2_1}));
+    routeUpdate.addRouteToUpdate(
+        RibUnicastEntry(toIPNetwork(prefix), {path1_2_1}));
+  }
+  routeUpdatesQueue.pushShared(std::move(routeUpdate));
+
+  // Retry of sync only sends the final chunk, after the failed attempt sent
+  // all 3 chunks
+  mockFibHandler->waitForSyncFib();
+  EXPECT_EQ(mockFibHandler->getFibSyncChunkCount(), 4);
+  EXPECT_EQ(mockFibHandler->getFibSyncCount(), 1);
+  EXPECT_EQ(mockFibHandler->getPendingSyncFibId(kFibId), 0);
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(counters["fib.sync_fib_chunks_resumed.sum"], 2);
+
+  std::vector<thrift::UnicastRoute> routes;
+  mockFibHandler->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(routes.size(), 5);
+  EXPECT_TRUE(checkEqualRouteDatabaseUnicast(routeDb, getRouteDb()));
+}
+
+class FibTestFixtureCoalesceWindow : public FibTestFixture {
+ public:
+  FibTestFixtureCoalesceWindow() : FibTestFixture(false, 0, 500) {}
+};
+
+// Churn of a route within the coalesce window is not programmed
+TEST_F(FibTestFixtureCoalesceWindow, CoalesceRouteUpdates) {
+  // initial syncFib debounce
+  mockFibHandler->waitForSyncFib();
+
+  {
+    DecisionRouteUpdate routeUpdate;
+    routeUpdate.addRouteToUpdate(
+        RibUnicastEntry(toIPNetwork(prefix2), {path1_2_1}));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
+  }
+  {
+    DecisionRouteUpdate routeUpdate;
+    routeUpdate.unicastRoutesToDelete.emplace_back(toIPNetwork(prefix2));
+    routeUpdate.addRouteToUpdate(
+        RibUnicastEntry(toIPNetwork(prefix3), {path1_3_1}));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
+  }
+
+  // Both updates get programmed at once, without the add of prefix2
+  mockFibHandler->waitForDeleteUnicastRoutes();
+  mockFibHandler->waitForUpdateUnicastRoutes();
+  EXPECT_EQ(mockFibHandler->getAddRoutesCount(), 1);
+  EXPECT_EQ(mockFibHandler->getDelRoutesCount(), 1);
+
+  thrift::RouteDatabase routeDb;
+  *routeDb.thisNodeName_ref() = "node-1";
+  routeDb.unicastRoutes_ref()->emplace_back(
+      createUnicastRoute(prefix3, {path1_3_1}));
+  EXPECT_TRUE(checkEqualRouteDatabaseUnicast(routeDb, getRouteDb()));
+}
+
+class FibTestFixtureRouteReconcile : public FibTestFixture {
+ public:
+  FibTestFixtureRouteReconcile() : FibTestFixture(true, 0, 0, true) {}
+};
+
+// Full sync only programs routes differing from the route table of the agent
+TEST_F(FibTestFixtureRouteReconcile, ReconcileRouteDb) {
+  // Mimic routes retained by the agent across restart of Open/R
+  mockFibHandler->addUnicastRoutes(
+      kFibId,
+      std::make_unique<std::vector<thrift::UnicastRoute>>(
+          std::vector<thrift::UnicastRoute>{
+              createUnicastRoute(prefix1, {path1_2_1}),
+              createUnicastRoute(prefix2, {path1_2_1})}));
+  mockFibHandler->waitForUpdateUnicastRoutes();
+  EXPECT_EQ(mockFibHandler->getAddRoutesCount(), 2);
+
+  thrift::RouteDatabase routeDb;
+  *routeDb.thisNodeName_ref() = "node-1";
+  DecisionRouteUpdate routeUpdate;
+  for (const auto& prefix : {prefix1, prefix3}) {
+    routeDb.unicastRoutes_ref()->emplace_back(
+        createUnicastRoute(prefix, {path1_2_1}));
+    routeUpdate.addRouteToUpdate(
+        RibUnicastEntry(toIPNetwork(prefix), {path1_2_1}));
+  }
+  routeUpdatesQueue.pushShared(std::move(routeUpdate));
+
+  // prefix3 gets added and prefix2 deleted, prefix1 is left untouched
+  mockFibHandler->waitForUpdateUnicastRoutes();
+  mockFibHandler->waitForDeleteUnicastRoutes();
+  EXPECT_EQ(mockFibHandler->getAddRoutesCount(), 3);
+  EXPECT_EQ(mockFibHandler->getDelRoutesCount(), 1);
+  EXPECT_EQ(mockFibHandler->getFibSyncCount(), 0);
+
+  std::vector<thrift::UnicastRoute> routes;
+  mockFibHandler->getRouteTableByClient(routes, kFibId);
+  EXPECT_TRUE(checkEqualUnicastRoutes(*routeDb.unicastRoutes_ref(), routes));
+  EXPECT_TRUE(checkEqualRouteDatabaseUnicast(routeDb, getRouteDb()));
+}
+
 TEST_F(FibTestFixture, getMslpRoutesFilteredTest) {
   // Make sure fib starts with clean route database
   std::vector<thrift::UnicastRoute> routes;
@@ -885,7 +1164,7 @@ TEST_F(FibTestFixture, getMslpRoutesFilteredTest) {
   routeUpdate.mplsRoutesToUpdate.emplace_back(std::move(route1));
   routeUpdate.mplsRoutesToUpdate.emplace_back(std::move(route2));
   routeUpdate.mplsRoutesToUpdate.emplace_back(std::move(route3));
-  routeUpdatesQueue.push(std::move(routeUpdate));
+  routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
   // wait for mpls
   mockFibHandler->waitForUpdateMplsRoutes();
@@ -963,7 +1242,7 @@ TEST_F(FibTestFixture, getUnicastRoutesFilteredTest) {
   routeUpdate.addRouteToUpdate(std::move(route2));
   routeUpdate.addRouteToUpdate(std::move(route3));
   routeUpdate.addRouteToUpdate(std::move(route4));
-  routeUpdatesQueue.push(std::move(routeUpdate));
+  routeUpdatesQueue.pushShared(std::move(routeUpdate));
   mockFibHandler->waitForUpdateUnicastRoutes();
   mockFibHandler->getRouteTableByClient(routes, kFibId);
   EXPECT_EQ(routes.size(), 4);
@@ -1088,6 +1367,28 @@ TEST_F(FibTestFixture, longestPrefixMatchTest) {
   const auto& result7 = Fib::longestPrefixMatch(inputPrefix7, unicastRoutes);
   EXPECT_TRUE(result7.has_value());
   EXPECT_EQ(result7.value(), dbPrefix3);
+
+  // maintain prefix lengths along with routes
+  Fib::PrefixLengthCounts prefixLengthCounts;
+  for (const auto& [prefix, _] : unicastRoutes) {
+    prefixLengthCounts.add(prefix);
+  }
+  unicastRoutes.erase(dbPrefix4);
+  prefixLengthCounts.remove(dbPrefix4);
+  EXPECT_EQ(0, prefixLengthCounts.v4.at(28));
+  EXPECT_EQ(1, prefixLengthCounts.v6.at(0));
+
+  // input 192.168.20.19 matched 192.168.0.0/16 after removal of /28
+  const auto& result8 = Fib::longestPrefixMatch(
+      inputPrefix1, unicastRoutes, prefixLengthCounts);
+  EXPECT_TRUE(result8.has_value());
+  EXPECT_EQ(result8.value(), dbPrefix1);
+
+  // input 192.168.0.0 still matched 192.168.0.0/24
+  const auto& result9 = Fib::longestPrefixMatch(
+      inputPrefix3, unicastRoutes, prefixLengthCounts);
+  EXPECT_TRUE(result9.has_value());
+  EXPECT_EQ(result9.value(), dbPrefix3);
 }
 
 TEST_F(FibTestFixture, doNotInstall) {
@@ -1114,7 +1415,7 @@ TEST_F(FibTestFixture, doNotInstall) {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(std::move(route1));
     routeUpdate.addRouteToUpdate(std::move(route2));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
   mockFibHandler->waitForSyncFib();
   mockFibHandler->getRouteTableByClient(routes, kFibId);
@@ -1127,7 +1428,7 @@ TEST_F(FibTestFixture, doNotInstall) {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(std::move(route3));
     routeUpdate.addRouteToUpdate(std::move(route4));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
   }
 
   mockFibHandler->waitForUpdateUnicastRoutes();
@@ -1181,7 +1482,7 @@ TEST_F(FibTestFixtureWaitOnDecision, StaticRouteUpdates) {
 
   // Mimic decision pub sock publishing RouteDatabaseDelta (empty DB)
   DecisionRouteUpdate routeUpdate;
-  routeUpdatesQueue.push(std::move(routeUpdate));
+  routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
   // Expect FIB sync for unicast & mpls routes
   mockFibHandler->waitForSyncFib();
@@ -1211,6 +1512,138 @@ TEST_F(FibTestFixtureWaitOnDecision, StaticRouteUpdates) {
   }
 }
 
+// Route records convert back to the same thrift route and routes with the
+// same next-hops share the next-hop group
+TEST(FibTest, UnicastRouteRecord) {
+  auto route1 = createUnicastRoute(prefix1, {path1_2_1});
+  route1.prefixType_ref() = thrift::PrefixType::BGP;
+  route1.data_ref() = "data";
+  const auto route2 = createUnicastRoute(prefix2, {path1_2_1});
+
+  const auto record1 = Fib::UnicastRouteRecord::fromThrift(route1);
+  const auto record2 = Fib::UnicastRouteRecord::fromThrift(route2);
+  EXPECT_EQ(route1, record1.toThrift(toIPNetwork(prefix1)));
+  EXPECT_EQ(route2, record2.toThrift(toIPNetwork(prefix2)));
+  EXPECT_EQ(record1.nexthops.group(), record2.nexthops.group());
+  EXPECT_TRUE(record1.data);
+  EXPECT_FALSE(record2.data);
+}
+
+// Routes get batched by the first priority class covering them
+TEST(FibTest, SplitByPriorityClass) {
+  const std::vector<std::vector<folly::CIDRNetwork>> priorityClasses{
+      {folly::IPAddress::createNetwork("::ffff:10.1.1.1/128")},
+      {folly::IPAddress::createNetwork("::ffff:10.0.0.0/104"),
+       folly::IPAddress::createNetwork("::ffff:10.3.3.3/128")},
+      {folly::IPAddress::createNetwork("::/0")}};
+  const auto route1 = createUnicastRoute(prefix1, {path1_2_1});
+  const auto route2 = createUnicastRoute(prefix2, {path1_2_1});
+  const auto route3 = createUnicastRoute(prefix3, {path1_2_1});
+  const auto route4 = createUnicastRoute(toIpPrefix("fc00::/64"), {});
+
+  const auto batches = Fib::splitByPriorityClass(
+      {route4, route3, route2, route1}, priorityClasses);
+  ASSERT_EQ(3, batches.size());
+  EXPECT_EQ(std::vector<thrift::UnicastRoute>({route1}), batches.at(0));
+  EXPECT_EQ(std::vector<thrift::UnicastRoute>({route3, route2}), batches.at(1));
+  EXPECT_EQ(std::vector<thrift::UnicastRoute>({route4}), batches.at(2));
+
+  // without priority classes all routes are in one batch
+  EXPECT_EQ(1, Fib::splitByPriorityClass({route1, route2}, {}).size());
+}
+
+// Routes are compared by forwarding attributes of next-hops only
+TEST(FibTest, ComputeRouteTableDelta) {
+  auto path1_2_1_metric = path1_2_1;
+  path1_2_1_metric.metric_ref() = 10;
+  const std::vector<thrift::UnicastRoute> unicastRoutes{
+      createUnicastRoute(prefix1, {path1_2_1, path1_2_2}),
+      createUnicastRoute(prefix3, {path1_3_1})};
+  const std::vector<thrift::UnicastRoute> programmedUnicastRoutes{
+      createUnicastRoute(prefix1, {path1_2_2, path1_2_1_metric}),
+      createUnicastRoute(prefix2, {path1_2_1}),
+      createUnicastRoute(prefix3, {path1_3_2})};
+  const std::vector<thrift::MplsRoute> mplsRoutes{
+      createMplsRoute(label1, {mpls_path1_2_1})};
+  const std::vector<thrift::MplsRoute> programmedMplsRoutes{
+      createMplsRoute(label1, {mpls_path1_2_1}),
+      createMplsRoute(label2, {mpls_path1_2_2})};
+
+  const auto delta = Fib::computeRouteTableDelta(
+      unicastRoutes, programmedUnicastRoutes, mplsRoutes, programmedMplsRoutes);
+  EXPECT_EQ(
+      std::vector<thrift::UnicastRoute>(
+          {createUnicastRoute(prefix3, {path1_3_1})}),
+      *delta.unicastRoutesToUpdate_ref());
+  EXPECT_EQ(
+      std::vector<thrift::IpPrefix>({prefix2}),
+      *delta.unicastRoutesToDelete_ref());
+  EXPECT_TRUE(delta.mplsRoutesToUpdate_ref()->empty());
+  EXPECT_EQ(std::vector<int32_t>({label2}), *delta.mplsRoutesToDelete_ref());
+
+  // nothing to program if routes are programmed already
+  const auto emptyDelta = Fib::computeRouteTableDelta(
+      unicastRoutes, unicastRoutes, mplsRoutes, mplsRoutes);
+  EXPECT_TRUE(emptyDelta.unicastRoutesToUpdate_ref()->empty());
+  EXPECT_TRUE(emptyDelta.unicastRoutesToDelete_ref()->empty());
+  EXPECT_TRUE(emptyDelta.mplsRoutesToUpdate_ref()->empty());
+  EXPECT_TRUE(emptyDelta.mplsRoutesToDelete_ref()->empty());
+}
+
+// Latest change of a route wins when coalescing route updates
+TEST(FibTest, PendingRouteUpdatesMerge) {
+  Fib::PendingRouteUpdates pending;
+  EXPECT_TRUE(pending.empty());
+
+  {
+    thrift::RouteDatabaseDelta delta;
+    delta.unicastRoutesToUpdate_ref()->emplace_back(
+        createUnicastRoute(prefix1, {path1_2_1}));
+    delta.unicastRoutesToUpdate_ref()->emplace_back(
+        createUnicastRoute(prefix2, {path1_2_1}));
+    delta.unicastRoutesToDelete_ref()->emplace_back(prefix3);
+    delta.mplsRoutesToUpdate_ref()->emplace_back(
+        createMplsRoute(label1, {mpls_path1_2_1}));
+    delta.perfEvents_ref() = thrift::PerfEvents();
+    addPerfEvent(*delta.perfEvents_ref(), "node-1", "DECISION_RECEIVED");
+    EXPECT_EQ(0, pending.merge(std::move(delta)));
+    EXPECT_TRUE(pending.pendingSince.has_value());
+  }
+  {
+    thrift::RouteDatabaseDelta delta;
+    delta.unicastRoutesToUpdate_ref()->emplace_back(
+        createUnicastRoute(prefix1, {path1_2_2}));
+    delta.unicastRoutesToUpdate_ref()->emplace_back(
+        createUnicastRoute(prefix3, {path1_2_1}));
+    delta.unicastRoutesToDelete_ref()->emplace_back(prefix2);
+    delta.mplsRoutesToDelete_ref()->emplace_back(label1);
+    // every change supersedes a pending one
+    EXPECT_EQ(4, pending.merge(std::move(delta)));
+  }
+  EXPECT_FALSE(pending.empty());
+
+  auto delta = pending.release();
+  EXPECT_TRUE(pending.empty());
+  EXPECT_FALSE(pending.pendingSince.has_value());
+
+  // perf events of the earliest delta are kept
+  ASSERT_TRUE(delta.perfEvents_ref().has_value());
+  EXPECT_EQ(1, delta.perfEvents_ref()->events_ref()->size());
+
+  auto& routesToUpdate = *delta.unicastRoutesToUpdate_ref();
+  std::sort(routesToUpdate.begin(), routesToUpdate.end());
+  EXPECT_EQ(
+      routesToUpdate,
+      std::vector<thrift::UnicastRoute>(
+          {createUnicastRoute(prefix1, {path1_2_2}),
+           createUnicastRoute(prefix3, {path1_2_1})}));
+  EXPECT_EQ(
+      *delta.unicastRoutesToDelete_ref(),
+      std::vector<thrift::IpPrefix>({prefix2}));
+  EXPECT_TRUE(delta.mplsRoutesToUpdate_ref()->empty());
+  EXPECT_EQ(*delta.mplsRoutesToDelete_ref(), std::vector<int32_t>({label1}));
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -14,6 +14,7 @@ namespace lua openr.Decision
 namespace wiki Open_Routing.Thrift_APIs
 
 include "Lsdb.thrift"
+include "Network.thrift"
 
 typedef map<string, Lsdb.AdjacencyDatabase>
   (
@@ -24,3 +25,94 @@ typedef map<string, Lsdb.AdjacencyDatabase>
 typedef map<string, Lsdb.PrefixDatabase>
   (cpp.type = "std::unordered_map<std::string, openr::thrift::PrefixDatabase>")
   PrefixDbs
+
+/**
+ * Format version of LsdbSnapshot, bumped on incompatible changes
+ */
+const i32 kLsdbSnapshotFormatVersion = 1
+
+/**
+ * Adjacency of LsdbSnapshotNode. Names are indices into `strings` of the
+ * snapshot, other fields are the same as of Lsdb.Adjacency. Timestamp is
+ * left out as it doesn't affect route computation
+ */
+struct LsdbSnapshotAdjacency {
+  1: i32 otherNodeName
+  2: i32 ifName
+  3: i32 otherIfName
+  4: Network.BinaryAddress nextHopV6
+  5: Network.BinaryAddress nextHopV4
+  6: i32 metric
+  7: i32 adjLabel = 0
+  8: bool isOverloaded = 0
+  9: i32 rtt
+  10: i64 weight = 1
+}
+
+/**
+ * Adjacency database and prefixes of a node in an area. In delta snapshots
+ * an entry without adjacency database and prefixes is a node gone from area
+ */
+struct LsdbSnapshotNode {
+  1: i32 nodeName
+  2: i32 area
+  3: bool hasAdjacencyDb = 0
+  4: bool isOverloaded = 0
+  5: i32 nodeLabel
+  6: list<LsdbSnapshotAdjacency> adjacencies
+  7: list<Lsdb.PrefixEntry> prefixEntries
+}
+
+/**
+ * KvStore version of a key. Value of key is the same as long as its version
+ * and originator are
+ */
+struct LsdbKeyVersion {
+  1: i64 version
+  2: string originatorId
+}
+
+/**
+ * Versioned snapshot of link states and prefix state of Decision, i.e. of
+ * the inputs of route computation. Names of nodes, areas and interfaces are
+ * interned into `strings` and referred to by index
+ */
+struct LsdbSnapshot {
+  1: i32 formatVersion = kLsdbSnapshotFormatVersion
+  2: string thisNodeName
+  // identifies the Decision instance `version` belongs to
+  3: i64 epoch
+  // version of link and prefix state the snapshot reflects
+  4: i64 version
+  // if set, `nodes` only holds entries changed since `sinceVersion` of
+  // LsdbSnapshotParams, otherwise all entries
+  5: bool isDelta = 0
+  6: list<string> strings
+  7: list<LsdbSnapshotNode> nodes
+  // KvStore versions of `adj:` and `prefix:` keys the snapshot reflects, per
+  // area and key. Only set in snapshots Decision persists for fast restart
+  8: map<string, map<string, LsdbKeyVersion>> keyVersions
+  // Unix time in ms of writing the snapshot. Only set in snapshots Decision
+  // persists for fast restart, older ones than max age aren't restored
+  9: i64 timestampMs = 0
+}
+
+/**
+ * Flap damping state of a prefix, see `route_damping_config` of OpenrConfig
+ */
+struct RouteDampingState {
+  1: Network.IpPrefix prefix
+  // penalty decayed to the time of the request
+  2: double penalty
+  // changes of route are held back, Fib keeps the route it has
+  3: bool suppressed
+  // time until suppressed prefix is reused unless its route changes again
+  4: optional i64 reuseInMs
+}
+
+struct LsdbSnapshotParams {
+  // `epoch` and `version` of previous snapshot to get changes since. A full
+  // snapshot is returned if unset or if epoch doesn't match
+  1: optional i64 epoch
+  2: optional i64 sinceVersion
+}
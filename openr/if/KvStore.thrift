@@ -15,10 +15,26 @@ namespace lua openr.KvStore
 namespace wiki Open_Routing.Thrift_APIs
 
 include "Dual.thrift"
+include "OpenrConfig.thrift"
 
 const string kDefaultArea = "0"
 
 // a value as reported in get replies/publications
+//
+// Delta of a binary value against a base value. Value is reconstructed as
+// base[0, prefixLen) + data + base[size - suffixLen, size)
+//
+struct ValueDelta {
+  // hash of the base value, which delta is computed against
+  1: i64 baseHash;
+  // number of leading bytes shared with base value
+  2: i32 prefixLen;
+  // number of trailing bytes shared with base value
+  3: i32 suffixLen;
+  // bytes in between shared prefix and suffix
+  4: binary data;
+}
+
 struct Value {
   // current version of this value
   1: i64 version;
@@ -39,11 +55,24 @@ struct Value {
   // should leave it empty and as will be computed by KvStore on `KEY_SET`
   // operation.
   6: optional i64 hash;
+  // Delta-encoded value against the previous version of the value. Only set
+  // for flooding. `value` must be reconstructed from it before merge.
+  7: optional ValueDelta valueDelta;
 }
 
 typedef map<string, Value>
   (cpp.type = "std::unordered_map<std::string, openr::thrift::Value>") KeyVals
 
+// Metadata of Value, i.e. Value without its payload. Field ids MUST match the
+// ones of Value, so that serialized Value can be decoded as ValueMeta with
+// the payload skipped
+struct ValueMeta {
+  1: i64 version;
+  3: string originatorId
+  5: i64 ttlVersion = 0;
+  6: optional i64 hash;
+}
+
 
 enum Command {
   // operations on keys in the store
@@ -59,6 +88,13 @@ enum FilterOperator {
   AND = 2,
 }
 
+// Codec used to compress full-sync publications between peers
+enum CompressionType {
+  NONE = 0,
+  ZSTD = 1,
+  LZ4 = 2,
+}
+
 
 struct KeySetParams {
   // NOTE: the struct is denormalized on purpose,
@@ -112,6 +148,48 @@ struct KeyDumpParams {
   // kinds of updates. For example, a consumer might be interesred in
   // getting "adj:.*" keys from open/r domain.
   5: optional list<string> keys;
+
+  // optional attribute to scope the full-sync to given leaves of KvStore
+  // hash-tree index. Keys outside of these leaves are ignored both in
+  // `keyValHashes` and in the response. Used after walking down the
+  // hash-tree of peer with `getKvStoreHashTreeArea`
+  8: optional list<i32> hashTreeLeaves;
+
+  // optional attribute to advertise compression codec accepted by requester
+  // for the response. Peer may still respond uncompressed, e.g. if response
+  // is small or codec is not supported.
+  9: optional CompressionType compression;
+
+  // optional attribute to resume a subscription from cursors of previous one,
+  // as map<area: sequence-number>. For areas of which changes since the
+  // cursor are still held by the server, only those changes are returned
+  // instead of a full dump. Other areas are dumped fully.
+  10: optional map<string, i64> resumeSeqNums;
+
+  // optional attribute to advertise hash scheme of `keyValHashes`. Peer
+  // responds with hashes of the same scheme. BOOST if not set
+  11: optional OpenrConfig.KvStoreHashVersion hashVersion;
+}
+
+// parameters to walk down the KvStore hash-tree index
+struct HashTreeParams {
+  // level of the requested nodes. 0 being the root
+  1: i32 level
+  // index of requested nodes at `level`. Hashes of their children are returned
+  2: list<i32> indices
+}
+
+// nodes of KvStore hash-tree index
+struct HashTreeNodes {
+  // level of the returned nodes
+  1: i32 level
+  // map<node-index: node-hash>
+  2: map<i32, i64> nodes
+  // shape of the tree. Nodes are only comparable between trees of same shape
+  3: i32 fanout
+  4: i32 depth
+  // hash scheme of values the tree is built from. BOOST if not set
+  5: optional OpenrConfig.KvStoreHashVersion hashVersion
 }
 
 // Peer's publication and command socket URLs
@@ -126,6 +204,10 @@ struct PeerSpec {
 
   // thrift port
   4: i32 ctrlPort = 0
+
+  // compression codec to request for full-sync responses from this peer.
+  // KvStore default is used if not set
+  5: optional CompressionType syncCompression
 }
 
 typedef map<string, PeerSpec>
@@ -216,6 +298,30 @@ struct KvStoreRequest {
   10: optional FloodTopoSetParams floodTopoSetParams
 }
 
+//
+// Metadata views of KEY_SET request, decoded with value payloads skipped.
+// Field ids MUST match the ones of KeySetParams and KvStoreRequest
+//
+struct KeySetParamsMeta {
+  2: map<string, ValueMeta> keyVals;
+  3: bool solicitResponse = 1;
+  5: optional list<string> nodeIds;
+  7: optional i64 timestamp_ms
+}
+
+struct KvStoreRequestMeta {
+  1: Command cmd
+  11: string area
+  2: optional KeySetParamsMeta keySetParams
+}
+
+// Compact-serialized publication compressed with `codec`
+struct CompressedPublication {
+  1: CompressionType codec
+  2: i64 uncompressedSize
+  3: binary data
+}
+
 //
 // Responses
 //
@@ -241,4 +347,44 @@ struct Publication {
 
   // area to which this publication belongs
   7: string area;
+
+  // compressed full-sync response. If set, all other attributes except `area`
+  // are empty and must be read from the decompressed publication
+  8: optional CompressedPublication compressed;
+
+  // sequence number of publication in KvStore change log of its area. Set on
+  // publications and snapshots of subscriptions only, and used as cursor to
+  // resume a subscription
+  9: optional i64 seqNum;
+
+  // set on subscription snapshot if it only carries the changes since the
+  // resume cursor rather than a full dump of the area
+  10: optional bool isIncremental;
+
+  // hash scheme of sender, set on full-sync responses only. If set, hashes
+  // of key-vals are of the scheme requested in KeyDumpParams. Otherwise they
+  // are of BOOST scheme
+  11: optional OpenrConfig.KvStoreHashVersion hashVersion;
+}
+
+// Metadata view of full-sync response, decoded with value payloads skipped.
+// Field ids MUST match the ones of Publication
+struct CompressedPublicationMeta {
+  1: CompressionType codec
+}
+
+struct PublicationMeta {
+  2: map<string, ValueMeta> keyVals;
+  5: optional list<string> tobeUpdatedKeys;
+  8: optional CompressedPublicationMeta compressed;
+}
+
+// Snapshot of KvStore area persisted for warm restart. TTL of key-vals is the
+// remaining TTL at the time of snapshot
+struct KvStoreSnapshot {
+  1: string area
+  2: i64 timestampMs
+  3: KeyVals keyVals
+  // hash scheme of key-vals. BOOST if not set
+  4: optional OpenrConfig.KvStoreHashVersion hashVersion
 }
@@ -94,6 +94,11 @@ struct NextHopThrift {
 
   // Name of next-hop device
   54: optional string neighborNodeName
+
+  // Backup next-hop, i.e. loop-free alternate per RFC 5286. It is not used
+  // for forwarding as long as any of the primary next-hops of the route is
+  // available
+  55: bool isBackup = false
 }
 
 struct MplsRoute {
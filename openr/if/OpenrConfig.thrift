@@ -22,6 +22,19 @@ struct KvstoreFloodRate {
   2: i32 flood_msg_burst_size
 }
 
+/**
+ * Hash function of KvStore values, i.e. of `tuple<version, originatorId,
+ * value>`. Hashes are compared between peers on full-sync, hence nodes using
+ * different schemes exchange the scheme on full-sync and translate hashes.
+ */
+enum KvStoreHashVersion {
+  # boost::hash_combine over version, originator and value
+  BOOST = 0
+  # farmhash Fingerprint64, which is stable across platforms and several times
+  # faster for large values
+  FINGERPRINT64 = 1
+}
+
 struct KvstoreConfig {
   # kvstore
   1: i32 key_ttl_ms = 300000 # 5min 300*1000
@@ -36,6 +49,90 @@ struct KvstoreConfig {
   # flood optimization
   8: optional bool enable_flood_optimization
   9: optional bool is_flood_root
+
+  # Number of hash shards used to merge large publications in parallel.
+  # Merge decisions and hash generation for each shard are computed on a
+  # dedicated worker pool while the final update is applied on the KvStore
+  # event-base. Disabled (serial merge) if not set or set to <= 1
+  10: optional i32 merge_shards
+
+  # Maintain hash-tree index of key-vals and use it for initial full-sync
+  # over thrift. Peers walk down the hash-tree to find differing subtrees and
+  # only exchange hashes of keys under differing leaves
+  11: optional bool enable_hash_tree_sync
+
+  # Flood value updates of adj: and prefix: keys as delta against the previous
+  # value to thrift peers. Receiver falls back to full-sync with the sender if
+  # delta can't be applied. All nodes must run version supporting it.
+  12: optional bool enable_value_delta_encoding
+
+  # Coalescing window for TTL refreshes of locally originated keys. TTL-only
+  # updates set by local clients within the window are flooded as a single
+  # publication per area. Disabled (flooded immediately) if not set or 0
+  13: optional i32 ttl_refresh_coalesce_ms
+
+  # Request compressed (zstd) full-sync responses from peers. Responses above
+  # a size threshold are compressed if peer supports it, plain otherwise
+  14: optional bool enable_sync_compression
+
+  # Maximum number of full-syncs in flight with peers per area. The window
+  # starts small and doubles on every sync response up to this limit. Peers
+  # on flood-topology are synced first. Default is 32 if not set
+  15: optional i32 max_parallel_sync
+
+  # Maximum bytes of key-vals queued for flooding towards a slow thrift peer.
+  # One flood request is in flight per peer; updates are queued meanwhile and
+  # updates of the same key collapse into the latest one. Peer is re-synced
+  # from scratch if its queue overflows. Default is 16MB if not set
+  16: optional i32 flood_queue_max_bytes
+
+  # Directory to write periodic snapshots of KvStore areas to. On restart
+  # KvStore is warmed up from the snapshots with TTLs adjusted by the time
+  # passed, so that only the difference has to be synced with peers.
+  # Disabled if not set
+  17: optional string snapshot_dir
+  # Interval of writing snapshots. Default is 30s if not set
+  18: optional i32 snapshot_interval_s
+
+  # Keep last formed flood topology (SPT-peers) per root as backup, and keep
+  # flooding along it while the topology is re-converging instead of falling
+  # back to flooding to all peers. Only effective with
+  # enable_flood_optimization. Disabled if not set
+  19: optional bool enable_flood_backup_tree
+
+  # Decode only metadata (version, originator, ttl-version, hash) of key-vals
+  # in flooded KEY_SET requests and full-sync responses over ZMQ first. Value
+  # payloads are decoded only if some key-val can update local store, which
+  # saves CPU on redundant floods. Disabled if not set
+  20: optional bool enable_lazy_value_decode
+
+  # Run KvStore of every area in its own event loop thread, so that a heavy
+  # area doesn't slow down convergence of the others. APIs spanning multiple
+  # areas fan out to all area threads and merge results. Disabled if not set
+  21: optional bool enable_area_threads
+
+  # Hash scheme of values. Peers with different scheme still sync, hence it
+  # can be rolled out node by node. BOOST if not set
+  22: optional KvStoreHashVersion hash_version
+
+  # Keys of these prefixes, e.g. `adj:`, are flooded ahead of other keys.
+  # They bypass `flood_rate`, hence reachability changes don't wait behind
+  # bulk prefix floods while the rate limiter is saturated. Keys of other
+  # prefixes are buffered and flooded as rate allows. None if not set
+  23: optional list<string> priority_flood_key_prefixes
+
+  # Flood requests pipelined on the thrift channel of a peer before later
+  # updates are queued and collapsed until an ack. 1 if not set
+  24: optional i32 max_flood_requests_in_flight
+
+  # Sync and flood with peers over thrift only. ZMQ command and peer-sync
+  # sockets are neither bound nor polled, hence peers still on ZMQ transport
+  # can't sync or flood towards this node. Roll out only after every node
+  # runs with enable_kvstore_thrift, which keeps serving ZMQ peers meanwhile.
+  # Requires enable_kvstore_thrift, incompatible with
+  # enable_flood_optimization whose topology commands are ZMQ only. Disabled
+  # if not set
+  25: optional bool enable_thrift_only_transport
 }
 
 struct LinkMonitorConfig {
@@ -47,6 +144,11 @@ struct LinkMonitorConfig {
   4: list<string> include_interface_regexes = [] (deprecated)
   5: list<string> exclude_interface_regexes = [] (deprecated)
   6: list<string> redistribute_interface_regexes = [] (deprecated)
+
+  # Keep interfaces in sync from netlink events only. Full dump of links and
+  # addresses is taken initially and whenever netlink events got lost, instead
+  # of periodically
+  7: bool enable_event_driven_interface_sync = false
 }
 
 struct StepDetectorConfig {
@@ -57,6 +159,20 @@ struct StepDetectorConfig {
    5: i64 ads_threshold = 500
 }
 
+# Smoothing of RTT measurements and damping of RTT changes reported by Spark.
+# Changes are readvertised as adjacency metric, hence noisy ones cause
+# needless floods and route computations
+struct RttChangeConfig {
+  # Weight of new measurement in exponentially weighted moving average of RTT
+  # samples fed to step detector. 1.0 disables smoothing
+  1: double ewma_weight = 1.0
+  # Changes smaller than this from reported RTT are suppressed
+  2: i64 min_change_us = 0
+  # Changes of a neighbor are reported at most once within this interval,
+  # latest RTT is reported at end of interval
+  3: i64 min_interval_ms = 0
+}
+
 struct SparkConfig {
   1: i32 neighbor_discovery_port = 6666
 
@@ -68,17 +184,62 @@ struct SparkConfig {
   6: i32 graceful_restart_time_s = 30
 
   7: StepDetectorConfig step_detector_conf
+
+  # Fast failure detection with lightweight fixed-format heartbeats exchanged
+  # with established neighbors, in addition to regular heartbeats. Neighbor is
+  # brought down once no fast heartbeat is received within hold time. Takes
+  # effect for a neighbor only once it is received from it, hence peers not
+  # enabling it are unaffected.
+  8: bool enable_fast_heartbeat = false
+  9: i32 fast_heartbeat_interval_ms = 50
+  10: i32 fast_heartbeat_hold_time_ms = 200
+  # Fast heartbeats processed per second on an interface, bounds CPU spent on
+  # them, others are dropped
+  11: i32 fast_heartbeat_max_pps_per_interface = 1000
+
+  12: RttChangeConfig rtt_change_conf
+
+  # Send heartbeats in fixed-layout encoding instead of thrift over interfaces
+  # where all neighbors support it as per advertised version. It is parsed
+  # without allocation. Received ones are always processed
+  13: bool enable_fixed_layout_heartbeat = false
+
+  # Drop packets in the kernel which Spark drops after parsing, e.g. hellos of
+  # other domains on shared segments. Don't enable if adjacencies are formed
+  # with nodes of other domains in non-default areas
+  14: bool enable_kernel_packet_filter = false
 }
 
 struct WatchdogConfig {
   1: i32 interval_s = 20
   2: i32 thread_timeout_s = 300
   3: i32 max_memory_mb = 800
+  /**
+   * Limits of memory allocated by module threads, by thread name e.g.
+   * "KvStore". Only enforced with jemalloc, which serves every module thread
+   * from its own arena
+   */
+  4: map<string, i32> module_max_memory_mb
+}
+
+/**
+ * Limits of log events of a type, applied where they are produced. Suppressed
+ * events are counted in the next admitted event as `num_suppressed`
+ */
+struct EventLogLimit {
+  # Admit one in sample_rate events
+  1: i32 sample_rate = 1
+  # Token bucket of admitted events. 0 => unlimited
+  2: double rate_per_sec = 0
+  # Defaults to rate_per_sec if not set
+  3: double burst = 0
 }
 
 struct MonitorConfig {
   1: i32 max_event_log = 100
   2: bool enable_event_log_submission  = true
+  # Limits by event name, e.g. "NB_UP" or "KVSTORE_FULL_SYNC"
+  3: map<string, EventLogLimit> event_log_limits
 }
 
 enum PrefixForwardingType {
@@ -275,6 +436,103 @@ struct BgpRouteTranslationConfig {
 
 }
 
+/**
+ * Class of routes which Fib programs ahead of other routes. Routes to
+ * prefixes equal to or more specific than any of the prefixes belong to the
+ * class, e.g. loopback and infrastructure prefixes or default routes
+ */
+struct FibPriorityClass {
+  1: string name
+  2: list<string> prefixes = []
+}
+
+/**
+ * Priorities of OpenrCtrl requests. Every priority is served by its own pool
+ * of worker threads, hence heavy requests of lower priority don't delay
+ * requests of higher one
+ */
+enum CtrlRequestPriority {
+  HIGH = 1
+  NORMAL = 3
+  BEST_EFFORT = 4
+}
+
+struct CtrlServerConfig {
+  # Number of worker threads serving requests of each priority
+  1: i32 high_priority_threads = 1
+  2: i32 normal_priority_threads = 1
+  3: i32 best_effort_threads = 1
+
+  # Priority of OpenrCtrl methods by method name, e.g. "getRouteDb", on top of
+  # the defaults which serve state changing requests with HIGH and large dumps
+  # with BEST_EFFORT priority. Other methods are served with NORMAL priority
+  4: map<string, CtrlRequestPriority> method_priorities = {}
+}
+
+/**
+ * Linux scheduling policies of threads, values match SCHED_* of sched.h
+ */
+enum ThreadSchedPolicy {
+  OTHER = 0
+  FIFO = 1
+  RR = 2
+  BATCH = 3
+}
+
+/**
+ * CPU affinity and scheduling of a module thread. Applied by the thread to
+ * itself once it starts, failures are logged and leave the thread unchanged
+ */
+struct ThreadConfig {
+  # CPUs the thread is pinned to. Not pinned if empty
+  1: list<i32> cpus = []
+
+  2: ThreadSchedPolicy sched_policy = ThreadSchedPolicy.OTHER
+
+  # Static priority, must be in [1, 99] for FIFO and RR and 0 otherwise.
+  # NOTE: Real-time policies need CAP_SYS_NICE
+  3: i32 sched_priority = 0
+
+  # Enable or disable jemalloc thread cache of the thread. Threads which
+  # allocate little can do without, saving memory of cached objects.
+  # Unchanged if not set
+  4: optional bool enable_tcache
+}
+
+/**
+ * Tuning of jemalloc applied at startup, left at defaults of jemalloc or
+ * `MALLOC_CONF` if not set. No-op if not running with jemalloc.
+ * NOTE: Number of arenas and max size of thread caches can only be set
+ * before first allocation, through `MALLOC_CONF` environment variable e.g.
+ * `MALLOC_CONF=narenas:4,tcache_max:65536`
+ */
+struct MemoryAllocatorConfig {
+  # Purge unused dirty pages from background threads instead of allocating
+  # threads
+  1: optional bool background_thread
+
+  # Time after which unused dirty pages of all arenas become muzzy, and
+  # muzzy pages are released to the system. -1 never, 0 immediately
+  2: optional i32 dirty_decay_ms
+  3: optional i32 muzzy_decay_ms
+}
+
+/**
+ * Flap damping of routes of prefixes in Decision, like BGP route flap
+ * damping. Every withdrawal or change of next-hops of the route of a prefix
+ * adds `penalty`, which halves every `half_life_s`. Route changes of prefixes
+ * whose penalty exceeds `suppress_threshold` are held back, Fib keeps the
+ * route it has until penalty decays below `reuse_threshold`
+ */
+struct RouteDampingConfig {
+  1: i32 penalty = 1000
+  2: i32 suppress_threshold = 2000
+  3: i32 reuse_threshold = 750
+  4: i32 half_life_s = 15
+  # Prefixes which stop flapping are reused within this time
+  5: i32 max_suppress_time_s = 60
+}
+
 struct OpenrConfig {
   1: string node_name
   # domain is deprecated, prefer area config
@@ -351,6 +609,116 @@ struct OpenrConfig {
   # NOTE: Label route add or update will happen immediately
   53: i32 mpls_route_delete_delay_s = 10
 
+  # If enabled, Decision updates cached SPF results of every area only for
+  # the part of the shortest path tree affected by link up/down and metric
+  # changes instead of recomputing them from scratch. Node overload changes
+  # still trigger full SPF runs.
+  54: bool enable_incremental_spf = 0
+
+  # Number of worker threads used by Decision to compute routes. SPF of every
+  # area and routes of prefixes are computed in parallel on the workers while
+  # the routes are merged on the Decision thread. Disabled (serial route
+  # computation) if not set or set to <= 1
+  55: optional i32 route_computation_threads
+
+  # If enabled, Decision rebuilds routes on topology changes only for prefixes
+  # advertised by nodes whose shortest paths or overload state changed,
+  # instead of rebuilding all routes. Falls back to a full rebuild if LFA is
+  # enabled, local links changed or most prefixes are affected
+  56: bool enable_incremental_route_build = 0
+
+  # If enabled, Decision picks the delay of route rebuilds from the observed
+  # update rate and from the cost of previous rebuilds instead of exponential
+  # debounce restarting from minimum after every rebuild. A single update
+  # after a quiet period is processed after the minimum delay, while storms
+  # back off to the maximum delay. See decision debounce flags
+  57: bool enable_adaptive_decision_debounce = 0
+
+  # If enabled along with LFA computation, Decision marks loop-free alternate
+  # next-hops of routes as backup instead of programming them as ECMP next-hops
+  # along with the shortest ones. Backup next-hops get programmed apart from
+  # primary ones in the FIB and take over traffic on failure of the primary
+  # next-hops before routes are re-computed
+  58: bool enable_lfa_backup_nexthops = 0
+
+  # Maximum number of unicast routes per chunk of a full FIB sync. If set, Fib
+  # syncs route tables larger than a chunk via syncFibChunk, i.e. in multiple
+  # bounded calls pipelined with route programming by the agent, instead of
+  # one syncFib call. Requires support of syncFibChunk by the agent. Disabled
+  # if not set or set to <= 0
+  59: optional i32 fib_sync_chunk_size
+
+  # Time window in milliseconds for which Fib holds back route updates before
+  # programming them. Route updates within the window get coalesced per
+  # prefix and label, i.e. short-lived churn of a route is not programmed.
+  # Disabled if not set or set to <= 0
+  60: optional i32 fib_route_coalesce_window_ms
+
+  # Priority classes of routes, highest priority first. On full sync and on
+  # route updates Fib programs routes of each class in a separate batch ahead
+  # of remaining routes, which shortens the time until reachability of
+  # critical prefixes gets restored e.g. after a reboot. A route belongs to
+  # the first class it matches
+  61: list<FibPriorityClass> fib_priority_classes = []
+
+  # If enabled, full FIB syncs e.g. on restart of Open/R or of the agent read
+  # the route tables of the agent and only program routes that differ from
+  # them instead of replacing all routes via syncFib. Routes are compared by
+  # forwarding attributes of their next-hops. Keeps restarts free of hardware
+  # churn when the agent retained routes across the restart
+  62: bool enable_fib_route_reconcile = 0
+
+  # If enabled, NetlinkFibHandler programs next-hops of unicast routes as
+  # kernel nexthop objects (Linux 5.3+) shared by all routes with the same
+  # next-hops, instead of encoding next-hops in every route. Routes with MPLS
+  # next-hops keep inline next-hops
+  63: bool enable_netlink_nexthop_objects = 0
+
+  # Number of keys per node and area PrefixManager packs advertised prefixes
+  # into. Prefixes are hash-bucketed into the keys, each one carrying a
+  # PrefixDatabase of all its prefixes, which bounds number of keys in KvStore
+  # at the cost of flooding whole bucket on change of any of its prefixes.
+  # Every prefix is advertised with its own key if not set or set to <= 0
+  64: optional i32 prefix_db_key_shards
+
+  # Worker threads and request priorities of OpenrCtrl thrift server
+  65: CtrlServerConfig ctrl_server_config
+
+  # If enabled, Fib floods worst end-to-end convergence time of this node
+  # every 10s with key `convtime:<node>`, and Decision aggregates the ones of
+  # all nodes into `decision.network_convergence_time_ms` histogram
+  66: bool enable_convergence_time_flooding = 0
+
+  # CPU affinity and scheduling of module threads by module name, e.g.
+  # "Spark" with FIFO policy to keep hello timing stable under co-located
+  # load. Helper threads of a module, i.e. route computation workers of
+  # Decision and area and merge threads of KvStore, share config of module.
+  # Threads of modules not in the map are left as is
+  67: map<string, ThreadConfig> module_thread_configs = {}
+
+  # File to persist snapshot of link states and prefix state of Decision to,
+  # along with KvStore versions of their keys. On restart Decision computes
+  # routes from the snapshot right away instead of waiting for KvStore to
+  # sync, skips parsing keys of unchanged version and withdraws state of keys
+  # gone once KvStore synced every area. Disabled if not set
+  68: optional string decision_lsdb_snapshot_file
+  # Interval of writing Decision LSDB snapshot. Default is 30s if not set
+  69: optional i32 decision_lsdb_snapshot_interval_s
+
+  # Flap damping of routes of unstable prefixes in Decision. Disabled if not
+  # set
+  70: optional RouteDampingConfig route_damping_config
+
+  # jemalloc tuning, see MemoryAllocatorConfig. Per thread cache of module
+  # threads is set with `module_thread_configs`
+  71: optional MemoryAllocatorConfig memory_allocator_config
+
+  # Max age of Decision LSDB snapshot restored on restart. Older snapshots
+  # are discarded and Decision waits for KvStore to sync, as routes of a
+  # topology long gone would be programmed otherwise. Default is 300s if not
+  # set
+  72: optional i32 decision_lsdb_snapshot_max_age_s
+
   # bgp
   100: optional bool enable_bgp_peering
   102: optional BgpConfig.BgpConfig bgp_config
@@ -73,6 +73,57 @@ struct AdjacenciesFilter {
   1: set<string> selectAreas;
 }
 
+//
+// Paginated dumps
+//
+
+/**
+ * Selects page of paginated dump. Entries of dump are ordered by their key and
+ * page holds up to `pageSize` of them following `cursor`. Pages are built one
+ * at a time on the module thread, without building the full dump.
+ *
+ * Iterate with `nextCursor` of previous page until it is not set. Page may
+ * hold less entries than `pageSize` after filtering, even none. Entries
+ * changing between pages may be missed or returned twice.
+ */
+struct PageParams {
+  // opaque cursor, `nextCursor` of previous page. Unset for first page
+  1: optional string cursor;
+  2: i32 pageSize = 1000;
+}
+
+/**
+ * Counters selected by counter subscription. Counters with one of `keys` as
+ * name or partially matching any of `regexes` are selected, all counters if
+ * both are empty. Matchers are compiled once on subscription.
+ */
+struct CountersSubscriptionParams {
+  1: list<string> keys = [];
+  2: list<string> regexes = [];
+  // interval of publications of changed counters. Raised to 1s if lower
+  3: i32 intervalMs = 5000;
+}
+
+struct KvStorePage {
+  1: KvStore.Publication publication;
+  2: optional string nextCursor;
+}
+
+struct RouteDbPage {
+  1: Fib.RouteDatabase routeDb;
+  2: optional string nextCursor;
+}
+
+struct ReceivedRoutesPage {
+  1: list<ReceivedRouteDetail> routes;
+  2: optional string nextCursor;
+}
+
+struct AdjacencyDbsPage {
+  1: list<Lsdb.AdjacencyDatabase> adjacencyDbs;
+  2: optional string nextCursor;
+}
+
 //
 // RIB Policy related data structures
 //
@@ -166,6 +217,71 @@ struct RibPolicy {
   2: i32 ttl_secs;
 }
 
+enum ProfileType {
+  // Sampling CPU profile in legacy CPU profile format of gperftools
+  CPU = 0
+  // Heap profile of jemalloc in its heap_v2 format
+  HEAP = 1
+}
+
+struct ProfileParams {
+  1: ProfileType type = ProfileType.CPU
+  // Time CPU profile is sampled over. At most 60s
+  2: i32 duration_ms = 10000
+  // Samples per second of CPU time. At most 1000
+  3: i32 frequency_hz = 100
+}
+
+/**
+ * Tech-support snapshot of a node. Sections are gathered from all modules in
+ * parallel and streamed as soon as each module responds, in no specific
+ * order. Stream completes once every module responded.
+ */
+struct TechSupportParams {
+  // include route databases of Decision and Fib, which can be large
+  1: bool includeRoutes = false
+  // codec of section payloads. Payloads are sent uncompressed if codec is
+  // not available or compression doesn't reduce size
+  2: KvStore.CompressionType compression = KvStore.CompressionType.ZSTD
+}
+
+struct TechSupportHeader {
+  1: string nodeName
+  // time snapshot was requested at, in ms since epoch
+  2: i64 timestampMs
+}
+
+// Payload of tech-support section, one module state per member
+union TechSupportPayload {
+  1: OpenrConfig.OpenrConfig config
+  2: LinkMonitor.DumpLinksReply interfaces
+  3: list<Lsdb.AdjacencyDatabase> linkMonitorAdjacencies
+  4: list<Spark.SparkNeighbor> neighbors
+  5: KvStore.PeersMap kvStorePeers
+  6: KvStore.Publication kvStoreKeyVals
+  7: list<Lsdb.AdjacencyDatabase> decisionAdjacencies
+  8: Decision.PrefixDbs decisionPrefixes
+  9: Fib.RouteDatabase routesComputed
+  10: Fib.RouteDatabase routesInstalled
+  11: Fib.PerfDatabase perfDb
+  12: list<Lsdb.PrefixEntry> prefixes
+  13: map<string, i64> counters
+  14: list<string> eventLogs
+}
+
+struct TechSupportSection {
+  // name of section, e.g. `kvstore_key_vals`
+  1: string name
+  // set for per-area sections
+  2: optional string area
+  // set if module failed to provide section, payload is empty then
+  3: optional string error
+  // compact-serialized TechSupportPayload compressed with `codec`
+  4: KvStore.CompressionType codec = KvStore.CompressionType.NONE
+  5: i64 uncompressedSize
+  6: binary payload
+}
+
 /**
  * Thrift service - exposes RPC APIs for interaction with all of Open/R's
  * modules.
@@ -197,6 +313,17 @@ service OpenrCtrl extends fb303_core.BaseService {
   string dryrunConfig(1: string file)
     throws (1: OpenrError error)
 
+  /**
+   * Load file config, validate it and apply it without restart. Throws
+   * exception upon error, or if config differs from running config in fields
+   * which require restart. Reloadable are interface regexes of areas and
+   * `kvstore_config.flood_rate` if it stays set.
+   *
+   * Only checks whether config can be reloaded if dryrun is set
+   */
+  void reloadConfig(1: string file, 2: bool dryrun)
+    throws (1: OpenrError error)
+
   //
   // PrefixManager APIs
   //
@@ -261,12 +388,27 @@ service OpenrCtrl extends fb303_core.BaseService {
   list<ReceivedRouteDetail> getReceivedRoutesFiltered(
       1: ReceivedRouteFilter filter) throws (1: OpenrError error);
 
+  /**
+   * Paginated getReceivedRoutesFiltered, see PageParams
+   */
+  ReceivedRoutesPage getReceivedRoutesFilteredPage(
+    1: ReceivedRouteFilter filter,
+    2: PageParams page,
+  ) throws (1: OpenrError error)
+
   /**
    * Get route database of the current node. It is retrieved from FIB module.
    */
   Fib.RouteDatabase getRouteDb()
     throws (1: OpenrError error)
 
+  /**
+   * Paginated getRouteDb, see PageParams. MPLS routes are dumped ahead of
+   * unicast routes
+   */
+  RouteDbPage getRouteDbPage(1: PageParams page)
+    throws (1: OpenrError error)
+
   /**
    * Get route database from decision module. Since Decision has global
    * topology information, any node can be retrieved.
@@ -276,6 +418,16 @@ service OpenrCtrl extends fb303_core.BaseService {
   Fib.RouteDatabase getRouteDbComputed(1: string nodeName)
     throws (1: OpenrError error)
 
+  /**
+   * Same as getRouteDbComputed but only unicast routes of `prefixes` are
+   * returned and computed, unless all routes of the node are cached already.
+   * No MPLS routes are returned.
+   */
+  Fib.RouteDatabase getRouteDbComputedFiltered(
+    1: string nodeName,
+    2: list<Network.IpPrefix> prefixes,
+  ) throws (1: OpenrError error)
+
   /**
    * Get unicast routes after applying a list of prefix filter.
    * Perform longest prefix match for each input filter among the prefixes
@@ -340,6 +492,14 @@ service OpenrCtrl extends fb303_core.BaseService {
     1: AdjacenciesFilter filter
   ) throws (1: OpenrError error)
 
+  /**
+   * Paginated getDecisionAdjacenciesFiltered, see PageParams
+   */
+  AdjacencyDbsPage getDecisionAdjacenciesFilteredPage(
+    1: AdjacenciesFilter filter,
+    2: PageParams page,
+  ) throws (1: OpenrError error)
+
   /**
    * Get global prefix databases. This represents prefixes of actives nodes
    * only. While KvStore can represent dead node's information until their keys
@@ -347,6 +507,23 @@ service OpenrCtrl extends fb303_core.BaseService {
    */
   Decision.PrefixDbs getDecisionPrefixDbs() throws (1: OpenrError error)
 
+  /**
+   * Get snapshot of link states and prefix state of Decision, or of its
+   * changes since a previous snapshot. Snapshots can be stored with
+   * CompactSerializer and applied to LinkState and PrefixState offline, see
+   * openr/decision/LsdbSnapshot.h
+   */
+  Decision.LsdbSnapshot getDecisionLsdbSnapshot(
+    1: Decision.LsdbSnapshotParams params,
+  ) throws (1: OpenrError error)
+
+  /**
+   * Get flap damping state of prefixes penalized by route damping, see
+   * `route_damping_config`. Empty if route damping is disabled
+   */
+  list<Decision.RouteDampingState> getRouteDampingStates()
+    throws (1: OpenrError error)
+
 
   //
   // KvStore APIs
@@ -382,6 +559,16 @@ service OpenrCtrl extends fb303_core.BaseService {
     2: string area
   ) throws (1: OpenrError error)
 
+  /**
+   * Paginated getKvStoreKeyValsFilteredArea, see PageParams. Full-sync
+   * attributes of filter, e.g. `keyValHashes`, are not supported
+   */
+  KvStorePage getKvStoreKeyValsFilteredAreaPage(
+    1: KvStore.KeyDumpParams filter,
+    2: string area,
+    3: PageParams page,
+  ) throws (1: OpenrError error)
+
   /**
    * Get kvstore metadata (no values) with filter
    */
@@ -396,6 +583,15 @@ service OpenrCtrl extends fb303_core.BaseService {
     2: string area
   ) throws (1: OpenrError error)
 
+  /**
+   * Get hashes of children of the requested nodes of KvStore hash-tree index.
+   * Used by peers to walk down to differing subtrees during full-sync
+   */
+  KvStore.HashTreeNodes getKvStoreHashTreeArea(
+    1: KvStore.HashTreeParams params,
+    2: string area
+  ) throws (1: OpenrError error)
+
   /**
    * Set/Update key-values in KvStore.
    */
@@ -569,6 +765,16 @@ service OpenrCtrl extends fb303_core.BaseService {
   // Get log events
   list<string> getEventLogs() throws (1: OpenrError error)
 
+  /**
+   * Profile of the running process, readable by pprof. CPU profile blocks
+   * for duration of sampling. Heap profile requires jemalloc with profiling
+   * active, e.g. started with `MALLOC_CONF=prof:true`
+   *
+   * @throws OpenrError if params are invalid, a CPU profile is already being
+   *         collected or heap profiling isn't active
+   */
+  binary getProfile(1: ProfileParams params) throws (1: OpenrError error)
+
   // Get Openr Node Name
   string getMyNodeName()
 
@@ -13,6 +13,8 @@ include "openr/if/Fib.thrift"
 include "openr/if/KvStore.thrift"
 include "openr/if/OpenrCtrl.thrift"
 
+typedef binary (cpp.type = "::folly::IOBuf") IOBuf
+
 /**
  * Extends OpenrCtrl and implements stream APIs as streams are only
  * supported in C++
@@ -40,6 +42,18 @@ service OpenrCtrlCpp extends OpenrCtrl.OpenrCtrl {
     2: set<string> selectAreas,
   )
 
+  /**
+   * Same as subscribeAndGetAreaKvStores but stream items are Publication
+   * serialized with CompactSerializer. Subscribers with identical filter and
+   * areas share publications, which are filtered and serialized once for all
+   * of them.
+   */
+  list<KvStore.Publication>, stream<IOBuf>
+  subscribeAndGetAreaKvStoresSerialized(
+    1: KvStore.KeyDumpParams filter,
+    2: set<string> selectAreas,
+  )
+
   /**
    * Retrieve Fib snapshot and subscribe for subsequent updates.
    * No update between snapshot and fullstream will be lost,
@@ -49,4 +63,29 @@ service OpenrCtrlCpp extends OpenrCtrl.OpenrCtrl {
 
   Fib.RouteDatabase, stream<Fib.RouteDatabaseDelta> subscribeAndGetFib()
 
+  /**
+   * Same as subscribeAndGetFib but stream items are RouteDatabaseDelta
+   * serialized with CompactSerializer. Every delta is serialized once and the
+   * buffer is shared by all subscribers, which is cheaper than the typed
+   * stream when many clients are subscribed.
+   */
+  Fib.RouteDatabase, stream<IOBuf> subscribeAndGetFibSerialized()
+
+  /**
+   * Retrieve values of selected counters and subscribe to their changes.
+   * Every `intervalMs` counters which changed since the previous item are
+   * streamed, no item is streamed if none changed. Counters removed from
+   * the server are not reported.
+   */
+  map<string, i64>, stream<map<string, i64>> subscribeAndGetCounters(
+    1: OpenrCtrl.CountersSubscriptionParams params
+  ) throws (1: OpenrCtrl.OpenrError error)
+
+  /**
+   * Tech-support snapshot of all modules in one call, see
+   * OpenrCtrl.TechSupportParams. Replaces dozens of separate dump calls.
+   */
+  OpenrCtrl.TechSupportHeader, stream<OpenrCtrl.TechSupportSection>
+  getTechSupportSnapshot(1: OpenrCtrl.TechSupportParams params)
+
 }
@@ -103,6 +103,27 @@ service FibService extends fb303_core.BaseService {
     2: list<Network.UnicastRoute> routes,
   ) throws (1: PlatformError error)
 
+  // Chunked version of syncFib for large route tables. Routes of a sync,
+  // identified by syncId, are sent in multiple chunks of bounded size. Routes
+  // of non-final chunks may get programmed right away and chunks of a sync
+  // may be in flight concurrently. The final chunk is sent after all others
+  // completed and commits the sync, i.e. it has syncFib semantics for the
+  // routes of all chunks of the sync. Chunks of a new syncId discard routes of
+  // a previous, incomplete sync of the client
+  void syncFibChunk(
+    1: i16 clientId,
+    2: i64 syncId,
+    3: list<Network.UnicastRoute> routes,
+    4: bool isFinal,
+  ) throws (1: PlatformError error)
+
+  // syncId of the incomplete chunked sync of the client, i.e. whose chunks
+  // received so far are retained until its final chunk, or 0 if none. Lets the
+  // client resume an interrupted sync from its first unacknowledged chunk
+  i64 getPendingSyncFibId(
+    1: i16 clientId
+  ) throws (1: PlatformError error)
+
   // Retrieve list of unicast routes per client
   list<Network.UnicastRoute> getRouteTableByClient(
     1: i16 clientId
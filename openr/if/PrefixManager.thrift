@@ -21,6 +21,9 @@ enum PrefixUpdateCommand {
   WITHDRAW_PREFIXES = 2,
   WITHDRAW_PREFIXES_BY_TYPE = 3,
   SYNC_PREFIXES_BY_TYPE = 6,
+  // end-of-RIB marker completing a bulk load, carries no prefixes. See
+  // `PrefixUpdateRequest.batchInProgress`
+  END_OF_RIB = 7,
 }
 
 struct PrefixUpdateRequest {
@@ -29,6 +32,11 @@ struct PrefixUpdateRequest {
   3: list<Lsdb.PrefixEntry> prefixes
   // empty list = inject to all configured areas
   4: set<string> dstAreas = {} (cpp2.type = "std::unordered_set<std::string>")
+  // set on all requests of a bulk load but the last one, e.g. of a BGP table
+  // load by a plugin. PrefixManager applies them as they come but defers
+  // advertising to KvStore until a request without it, e.g. END_OF_RIB,
+  // completes the batch
+  5: bool batchInProgress = false
 }
 
 // struct to represent originated prefix from PrefixManager's view
@@ -7,13 +7,23 @@
 
 #include "KvStore.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 #include <fb303/ServiceData.h>
 #include <fbzmq/service/logging/LogSample.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/FileUtil.h>
 #include <folly/Format.h>
 #include <folly/GLog.h>
 #include <folly/Random.h>
+#include <folly/ScopeGuard.h>
 #include <folly/String.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/system/MemoryMapping.h>
+#include <folly/system/ThreadName.h>
+#include <folly/tracing/StaticTracepoint.h>
 
 #include <openr/common/Constants.h>
 #include <openr/common/Util.h>
@@ -53,12 +63,64 @@ getKvStoreFilters(std::shared_ptr<const openr::Config> config) {
 
 namespace openr {
 
+namespace {
+
+// Return literal prefix equivalent to the anchored regex `keyPrefix`, i.e.
+// regex without special characters except for an optional trailing `.*`.
+// std::nullopt if regex isn't a plain prefix
+std::optional<std::string>
+getLiteralPrefix(std::string const& keyPrefix) {
+  folly::StringPiece prefix(keyPrefix);
+  prefix.removeSuffix(".*");
+  for (char c : prefix) {
+    if (std::strchr("\\^$.|?*+()[]{}", c)) {
+      return std::nullopt;
+    }
+  }
+  return prefix.str();
+}
+
+std::vector<std::string>
+getLiteralPrefixes(std::vector<std::string> const& keyPrefixList) {
+  std::vector<std::string> literals;
+  for (auto const& keyPrefix : keyPrefixList) {
+    if (auto literal = getLiteralPrefix(keyPrefix)) {
+      literals.emplace_back(std::move(*literal));
+    }
+  }
+  return literals;
+}
+
+std::vector<std::string>
+getRegexPrefixes(std::vector<std::string> const& keyPrefixList) {
+  std::vector<std::string> regexes;
+  for (auto const& keyPrefix : keyPrefixList) {
+    if (not getLiteralPrefix(keyPrefix).has_value()) {
+      regexes.emplace_back(keyPrefix);
+    }
+  }
+  return regexes;
+}
+
+} // namespace
+
 KvStoreFilters::KvStoreFilters(
     std::vector<std::string> const& keyPrefix,
     std::set<std::string> const& nodeIds)
     : keyPrefixList_(keyPrefix),
       originatorIds_(nodeIds),
-      keyRegexSet_(RegexSet(keyPrefixList_)) {}
+      originatorIdSet_(nodeIds.begin(), nodeIds.end()),
+      keyPrefixTrie_(getLiteralPrefixes(keyPrefixList_)),
+      keyRegexList_(getRegexPrefixes(keyPrefixList_)),
+      keyRegexSet_(RegexSet(keyRegexList_)) {}
+
+bool
+KvStoreFilters::keyPrefixMatch(std::string const& key) const {
+  if (keyPrefixTrie_.match(key)) {
+    return true;
+  }
+  return not keyRegexList_.empty() and keyRegexSet_.match(key);
+}
 
 bool
 KvStoreFilters::keyMatchAny(
@@ -66,11 +128,11 @@ KvStoreFilters::keyMatchAny(
   if (keyPrefixList_.empty() && originatorIds_.empty()) {
     return true;
   }
-  if (!keyPrefixList_.empty() && keyRegexSet_.match(key)) {
+  if (!keyPrefixList_.empty() && keyPrefixMatch(key)) {
     return true;
   }
   if (!originatorIds_.empty() &&
-      originatorIds_.count(*value.originatorId_ref())) {
+      originatorIdSet_.count(*value.originatorId_ref())) {
     return true;
   }
   return false;
@@ -97,12 +159,12 @@ KvStoreFilters::keyMatchAll(
     return true;
   }
 
-  if (!keyPrefixList_.empty() && not keyRegexSet_.match(key)) {
+  if (!keyPrefixList_.empty() && not keyPrefixMatch(key)) {
     return false;
   }
 
   if (!originatorIds_.empty() &&
-      not originatorIds_.count(*value.originatorId_ref())) {
+      not originatorIdSet_.count(*value.originatorId_ref())) {
     return false;
   }
 
@@ -133,10 +195,96 @@ KvStoreFilters::str() const {
   return result;
 }
 
+void
+KvStoreSubscription::setKey(
+    std::string const& area, std::string const& key, bool isSubscribed) {
+  auto state = state_.wlock();
+  if (isSubscribed) {
+    state->keys[area].emplace(key);
+    return;
+  }
+  auto it = state->keys.find(area);
+  if (it == state->keys.end()) {
+    return;
+  }
+  it->second.erase(key);
+  if (it->second.empty()) {
+    state->keys.erase(it);
+  }
+}
+
+void
+KvStoreSubscription::addKeyPrefix(
+    int64_t id, std::string const& area, std::string const& prefix) {
+  state_.wlock()->keyPrefixes.emplace(id, std::make_pair(area, prefix));
+}
+
+void
+KvStoreSubscription::removeKeyPrefix(int64_t id) {
+  state_.wlock()->keyPrefixes.erase(id);
+}
+
+void
+KvStoreSubscription::setFilters(std::optional<KvStoreFilters> filters) {
+  state_.wlock()->filters = std::move(filters);
+}
+
+void
+KvStoreSubscription::setMatchAll(bool matchAll) {
+  state_.wlock()->matchAll = matchAll;
+}
+
+bool
+KvStoreSubscription::isMatch(
+    State const& state,
+    std::string const& area,
+    std::string const& key,
+    thrift::Value const* value) const {
+  auto it = state.keys.find(area);
+  if (it != state.keys.end() and it->second.count(key)) {
+    return true;
+  }
+  for (auto const& [_, areaPrefix] : state.keyPrefixes) {
+    auto const& [prefixArea, prefix] = areaPrefix;
+    if (prefixArea == area and key.compare(0, prefix.size(), prefix) == 0) {
+      return true;
+    }
+  }
+  return value and state.filters.has_value() and
+      state.filters->keyMatch(key, *value);
+}
+
+KvStorePublicationPtr
+KvStoreSubscription::match(KvStorePublicationPtr const& publication) const {
+  auto state = state_.rlock();
+  if (state->matchAll) {
+    return publication;
+  }
+
+  auto const& area = *publication->area_ref();
+  thrift::Publication matched;
+  for (auto const& [key, value] : *publication->keyVals_ref()) {
+    if (value.value_ref().has_value() and
+        isMatch(*state, area, key, &value)) {
+      matched.keyVals_ref()->emplace(key, value);
+    }
+  }
+  for (auto const& key : *publication->expiredKeys_ref()) {
+    if (isMatch(*state, area, key, nullptr)) {
+      matched.expiredKeys_ref()->emplace_back(key);
+    }
+  }
+  if (matched.keyVals_ref()->empty() and matched.expiredKeys_ref()->empty()) {
+    return nullptr;
+  }
+  matched.area_ref() = area;
+  return std::make_shared<const thrift::Publication>(std::move(matched));
+}
+
 KvStore::KvStore(
     // initializers for immutable state
     fbzmq::Context& zmqContext,
-    messaging::ReplicateQueue<thrift::Publication>& kvStoreUpdatesQueue,
+    messaging::ReplicateQueue<KvStorePublicationPtr>& kvStoreUpdatesQueue,
     messaging::ReplicateQueue<KvStoreSyncEvent>& kvStoreSyncEventsQueue,
     messaging::RQueue<thrift::PeerUpdateRequest> peerUpdateQueue,
     messaging::ReplicateQueue<LogSample>& logSampleQueue,
@@ -145,7 +293,8 @@ KvStore::KvStore(
     std::optional<int> maybeIpTos,
     int zmqHwm,
     bool enableKvStoreThrift,
-    bool enablePeriodicSync)
+    bool enablePeriodicSync,
+    std::optional<messaging::RQueue<ConfigPtr>> configUpdatesQueue)
     : kvParams_(
           config->getNodeName(),
           kvStoreUpdatesQueue,
@@ -171,40 +320,125 @@ KvStore::KvStore(
               false),
           config->getKvStoreConfig().is_flood_root_ref().value_or(false)),
       areaIds_(config->getAreaIds()) {
+  // Parallel merge of publications
+  if (auto mergeShards = config->getKvStoreConfig().merge_shards_ref()) {
+    kvParams_.mergeShards = std::max(1, *mergeShards);
+  }
+  kvParams_.enableHashTreeSync =
+      config->getKvStoreConfig().enable_hash_tree_sync_ref().value_or(false);
+  if (auto window =
+          config->getKvStoreConfig().ttl_refresh_coalesce_ms_ref()) {
+    kvParams_.ttlRefreshCoalesceWindow =
+        std::chrono::milliseconds(std::max(0, *window));
+  }
+  // Delta of values is ONLY flooded over thrift peer connections
+  kvParams_.enableValueDelta = enableKvStoreThrift and
+      config->getKvStoreConfig().enable_value_delta_encoding_ref().value_or(
+          false);
+  if (config->getKvStoreConfig().enable_sync_compression_ref().value_or(
+          false)) {
+    kvParams_.syncCompression = thrift::CompressionType::ZSTD;
+  }
+  if (auto hashVersion = config->getKvStoreConfig().hash_version_ref()) {
+    kvParams_.hashVersion = *hashVersion;
+  }
+  if (auto maxParallelSync =
+          config->getKvStoreConfig().max_parallel_sync_ref()) {
+    kvParams_.maxParallelSync = std::max(1, *maxParallelSync);
+  }
+  if (auto maxBytes = config->getKvStoreConfig().flood_queue_max_bytes_ref()) {
+    kvParams_.floodQueueMaxBytes = std::max(0, *maxBytes);
+  }
+  if (auto maxInFlight =
+          config->getKvStoreConfig().max_flood_requests_in_flight_ref()) {
+    kvParams_.maxFloodsInFlight = std::max(1, *maxInFlight);
+  }
+  kvParams_.snapshotDir =
+      config->getKvStoreConfig().snapshot_dir_ref().to_optional();
+  if (auto interval = config->getKvStoreConfig().snapshot_interval_s_ref()) {
+    kvParams_.snapshotInterval = std::chrono::seconds(std::max(1, *interval));
+  }
+  kvParams_.eventLogLimits =
+      *config->getMonitorConfig().event_log_limits_ref();
+  kvParams_.enableFloodBackupTree = kvParams_.enableFloodOptimization and
+      config->getKvStoreConfig().enable_flood_backup_tree_ref().value_or(false);
+  kvParams_.enableLazyValueDecode =
+      config->getKvStoreConfig().enable_lazy_value_decode_ref().value_or(false);
+  if (auto prefixes =
+          config->getKvStoreConfig().priority_flood_key_prefixes_ref()) {
+    kvParams_.priorityFloodKeyPrefixes = *prefixes;
+  }
+  kvParams_.enableAreaThreads =
+      config->getKvStoreConfig().enable_area_threads_ref().value_or(false);
+  kvParams_.threadConfig = config->getModuleThreadConfig("KvStore");
+  // ZMQ sockets are ONLY skipped if peers are served over thrift
+  kvParams_.enableZmqTransport = not enableKvStoreThrift or
+      not config->getKvStoreConfig()
+              .enable_thrift_only_transport_ref()
+              .value_or(false);
+
   // Schedule periodic timer for counters submission
   counterUpdateTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
-    for (auto& counter : getGlobalCounters()) {
-      fb303::fbData->setCounter(counter.first, counter.second);
-    }
+    getCounters().via(getEvb()).thenValue(
+        [](std::map<std::string, int64_t>&& counters) {
+          for (auto& counter : counters) {
+            fb303::fbData->setCounter(counter.first, counter.second);
+          }
+        });
     counterUpdateTimer_->scheduleTimeout(Constants::kCounterSubmitInterval);
   });
   counterUpdateTimer_->scheduleTimeout(Constants::kCounterSubmitInterval);
 
   // Prepare global command socket
-  prepareSocket(kvParams_.globalCmdSock, std::string(globalCmdUrl), maybeIpTos);
-  addSocket(
-      fbzmq::RawZmqSocketPtr{*kvParams_.globalCmdSock},
-      ZMQ_POLLIN,
-      [this](int) noexcept {
-        // Drain all available messages in loop
-        while (true) {
-          // NOTE: globalCmSock is connected with neighbor's peerSyncSock_.
-          // recvMultiple() will get a vector of fbzmq::Message which has:
-          //  1) requestIdMsg; 2) delimMsg; 3) kvStoreRequestMsg;
-          auto maybeReq = kvParams_.globalCmdSock.recvMultiple();
-          if (maybeReq.hasError() and maybeReq.error().errNum == EAGAIN) {
-            break;
-          }
-
-          if (maybeReq.hasError()) {
-            LOG(ERROR) << "failed reading messages from globalCmdSock: "
-                       << maybeReq.error();
-            continue;
-          }
+  if (not kvParams_.enableZmqTransport) {
+    LOG(INFO) << "ZMQ transport disabled, serving peers over thrift only";
+  } else {
+    prepareSocket(
+        kvParams_.globalCmdSock, std::string(globalCmdUrl), maybeIpTos);
+    addSocket(
+        fbzmq::RawZmqSocketPtr{*kvParams_.globalCmdSock},
+        ZMQ_POLLIN,
+        [this](int) noexcept {
+          // Drain all available messages in loop
+          while (true) {
+            // NOTE: globalCmSock is connected with neighbor's peerSyncSock_.
+            // recvMultiple() will get a vector of fbzmq::Message which has:
+            //  1) requestIdMsg; 2) delimMsg; 3) kvStoreRequestMsg;
+            auto maybeReq = kvParams_.globalCmdSock.recvMultiple();
+            if (maybeReq.hasError() and maybeReq.error().errNum == EAGAIN) {
+              break;
+            }
+
+            if (maybeReq.hasError()) {
+              LOG(ERROR) << "failed reading messages from globalCmdSock: "
+                         << maybeReq.error();
+              continue;
+            }
+
+            processCmdSocketRequest(std::move(maybeReq).value());
+          } // while
+        });
+  }
 
-          processCmdSocketRequest(std::move(maybeReq).value());
-        } // while
-      });
+  // Add reader to deliver KvStore updates to subscriptions
+  addFiberTask([q = kvParams_.kvStoreUpdatesQueue.getReader(),
+                this]() mutable noexcept {
+    LOG(INFO) << "Starting KvStore subscriptions processing fiber";
+    while (true) {
+      auto maybePublication = q.get(); // perform read
+      if (maybePublication.hasError()) {
+        LOG(INFO) << "Terminating KvStore subscriptions processing fiber";
+        break;
+      }
+      dispatchToSubscriptions(maybePublication.value());
+    }
+    auto subscriptionQueues = subscriptionQueues_.wlock();
+    for (auto& subscriptionQueue : subscriptionQueues->queues) {
+      subscriptionQueue.queue->close();
+    }
+    subscriptionQueues->queues.clear();
+    subscriptionQueues->isClosed = true;
+  });
 
   // Add reader to process peer updates from LinkMonitor
   addFiberTask([q = std::move(peerUpdateQueue), this]() mutable noexcept {
@@ -225,13 +459,33 @@ KvStore::KvStore(
     }
   });
 
+  // Add reader to process reloaded config
+  if (configUpdatesQueue) {
+    addFiberTask([q = std::move(configUpdatesQueue).value(),
+                  this]() mutable noexcept {
+      while (true) {
+        auto maybeConfig = q.get(); // perform read
+        if (maybeConfig.hasError()) {
+          LOG(INFO) << "Terminating config updates processing fiber";
+          break;
+        }
+        processConfigUpdate(*maybeConfig.value());
+      }
+    });
+  }
+
   // create KvStoreDb instances
   for (auto const& area : areaIds_) {
+    OpenrEventBase* evb = this;
+    if (kvParams_.enableAreaThreads) {
+      evb = areaEvbs_.emplace(area, std::make_unique<OpenrEventBase>())
+                .first->second.get();
+    }
     kvStoreDb_.emplace(
         std::piecewise_construct,
         std::forward_as_tuple(area),
         std::forward_as_tuple(
-            this,
+            evb,
             kvParams_,
             area,
             fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_CLIENT>(
@@ -245,177 +499,368 @@ KvStore::KvStore(
   }
 }
 
+void
+KvStore::run() {
+  for (auto& [area, evb] : areaEvbs_) {
+    areaThreads_.emplace_back([this, area = area, evb = evb.get()]() noexcept {
+      LOG(INFO) << "Starting KvStore thread of area " << area;
+      folly::setThreadName(folly::sformat("KvStore-{}", area));
+      if (kvParams_.threadConfig) {
+        applyThreadConfig(*kvParams_.threadConfig);
+      }
+      evb->run();
+      LOG(INFO) << "KvStore thread of area " << area << " got stopped";
+    });
+    evb->waitUntilRunning();
+  }
+
+  // Invoke run method of super class
+  OpenrEventBase::run();
+}
+
 void
 KvStore::stop() {
   getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
     // NOTE: destructor of every instance inside `kvStoreDb_` will gracefully
     //       exit and wait for all pending thrift requests to be processed
-    //       before eventbase stops.
+    //       before eventbase stops. Instances of area threads are destructed
+    //       in their own event loop.
+    for (auto& [area, evb] : areaEvbs_) {
+      evb->getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait(
+          [this, &area = area]() { kvStoreDb_.erase(area); });
+    }
     kvStoreDb_.clear();
   });
 
+  // stop area threads if any
+  for (auto& areaEvb : areaEvbs_) {
+    areaEvb.second->stop();
+    areaEvb.second->waitUntilStopped();
+  }
+  for (auto& thread : areaThreads_) {
+    thread.join();
+  }
+  areaThreads_.clear();
+
   // Invoke stop method of super class
   OpenrEventBase::stop();
 }
 
-// static, public
-std::unordered_map<std::string, thrift::Value>
-KvStore::mergeKeyValues(
-    std::unordered_map<std::string, thrift::Value>& kvStore,
-    std::unordered_map<std::string, thrift::Value> const& keyVals,
-    std::optional<KvStoreFilters> const& filters) {
-  // the publication to build if we update our KV store
-  std::unordered_map<std::string, thrift::Value> kvUpdates;
+namespace {
 
-  // Counters for logging
-  uint32_t ttlUpdateCnt{0}, valUpdateCnt{0};
+// keys whose values are delta-encoded for flooding
+bool
+isDeltaEncodedKey(std::string const& key) {
+  return key.find(Constants::kAdjDbMarker.toString()) == 0 or
+      key.find(Constants::kPrefixDbMarker.toString()) == 0;
+}
 
-  for (const auto& [key, value] : keyVals) {
-    if (filters.has_value() && not filters->keyMatch(key, value)) {
-      VLOG(4) << "key: " << key << " not adding from "
-              << *value.originatorId_ref();
-      continue;
-    }
+// Type of the update required to merge a received value into local store
+enum class MergeType {
+  NONE = 0,
+  UPDATE_ALL = 1,
+  UPDATE_TTL = 2,
+};
+
+// Merge decision for single key computed by a merge shard
+struct MergeDecision {
+  std::string const* key{nullptr};
+  thrift::Value const* value{nullptr};
+  MergeType type{MergeType::NONE};
+  // pre-computed hash if value needs to be updated and it is missing hash
+  std::optional<int64_t> hash{std::nullopt};
+};
+
+// Figure out how the received `value` for `key` should be merged with local
+// store. This never modifies `kvStore` and is safe to be invoked concurrently
+// for different keys as long as there is no writer of `kvStore`.
+MergeType
+getMergeType(
+    std::string const& key,
+    thrift::Value const& value,
+    std::unordered_map<std::string, thrift::Value> const& kvStore,
+    std::optional<KvStoreFilters> const& filters) {
+  if (filters.has_value() && not filters->keyMatch(key, value)) {
+    VLOG(4) << "key: " << key << " not adding from "
+            << *value.originatorId_ref();
+    return MergeType::NONE;
+  }
 
-    // versions must start at 1; setting this to zero here means
-    // we would be beaten by any version supplied by the setter
-    int64_t myVersion{0};
-    int64_t newVersion = *value.version_ref();
+  // Delta-encoded value must be reconstructed before merge. Skip if not
+  if (value.valueDelta_ref().has_value() and
+      not value.value_ref().has_value()) {
+    return MergeType::NONE;
+  }
 
-    // Check if TTL is valid. It must be infinite or positive number
-    // Skip if invalid!
-    if (*value.ttl_ref() != Constants::kTtlInfinity && *value.ttl_ref() <= 0) {
-      continue;
-    }
+  // versions must start at 1; setting this to zero here means
+  // we would be beaten by any version supplied by the setter
+  int64_t myVersion{0};
+  int64_t newVersion = *value.version_ref();
 
-    // if key exist, compare values first
-    // if they are the same, no need to propagate changes
-    auto kvStoreIt = kvStore.find(key);
-    if (kvStoreIt != kvStore.end()) {
-      myVersion = *kvStoreIt->second.version_ref();
-    } else {
-      VLOG(4) << "(mergeKeyValues) key: '" << key << "' not found, adding";
-    }
+  // Check if TTL is valid. It must be infinite or positive number
+  // Skip if invalid!
+  if (*value.ttl_ref() != Constants::kTtlInfinity && *value.ttl_ref() <= 0) {
+    return MergeType::NONE;
+  }
 
-    // If we get an old value just skip it
-    if (newVersion < myVersion) {
-      continue;
-    }
+  // if key exist, compare values first
+  // if they are the same, no need to propagate changes
+  auto kvStoreIt = kvStore.find(key);
+  if (kvStoreIt != kvStore.end()) {
+    myVersion = *kvStoreIt->second.version_ref();
+  } else {
+    VLOG(4) << "(mergeKeyValues) key: '" << key << "' not found, adding";
+  }
 
-    bool updateAllNeeded{false};
-    bool updateTtlNeeded{false};
+  // If we get an old value just skip it
+  if (newVersion < myVersion) {
+    return MergeType::NONE;
+  }
 
-    //
-    // Check updateAll and updateTtl
-    //
-    if (value.value_ref().has_value()) {
-      if (newVersion > myVersion) {
-        // Version is newer or
-        // kvStoreIt is NULL(myVersion is set to 0)
-        updateAllNeeded = true;
-      } else if (
-          *value.originatorId_ref() > *kvStoreIt->second.originatorId_ref()) {
-        // versions are the same but originatorId is higher
-        updateAllNeeded = true;
-      } else if (
-          *value.originatorId_ref() == *kvStoreIt->second.originatorId_ref()) {
-        // This can occur after kvstore restarts or simply reconnects after
-        // disconnection. We let one of the two values win if they
-        // differ(higher in this case but can be lower as long as it's
-        // deterministic). Otherwise, local store can have new value while
-        // other stores have old value and they never sync.
-        int rc = (*value.value_ref()).compare(*kvStoreIt->second.value_ref());
-        if (rc > 0) {
-          // versions and orginatorIds are same but value is higher
-          VLOG(3) << "Previous incarnation reflected back for key " << key;
-          updateAllNeeded = true;
-        } else if (rc == 0) {
-          // versions, orginatorIds, value are all same
-          // retain higher ttlVersion
-          if (*value.ttlVersion_ref() > *kvStoreIt->second.ttlVersion_ref()) {
-            updateTtlNeeded = true;
-          }
+  //
+  // Check updateAll and updateTtl
+  //
+  if (value.value_ref().has_value()) {
+    if (newVersion > myVersion) {
+      // Version is newer or
+      // kvStoreIt is NULL(myVersion is set to 0)
+      return MergeType::UPDATE_ALL;
+    } else if (
+        *value.originatorId_ref() > *kvStoreIt->second.originatorId_ref()) {
+      // versions are the same but originatorId is higher
+      return MergeType::UPDATE_ALL;
+    } else if (
+        *value.originatorId_ref() == *kvStoreIt->second.originatorId_ref()) {
+      // This can occur after kvstore restarts or simply reconnects after
+      // disconnection. We let one of the two values win if they
+      // differ(higher in this case but can be lower as long as it's
+      // deterministic). Otherwise, local store can have new value while
+      // other stores have old value and they never sync.
+      int rc = (*value.value_ref()).compare(*kvStoreIt->second.value_ref());
+      if (rc > 0) {
+        // versions and orginatorIds are same but value is higher
+        VLOG(3) << "Previous incarnation reflected back for key " << key;
+        return MergeType::UPDATE_ALL;
+      } else if (rc == 0) {
+        // versions, orginatorIds, value are all same
+        // retain higher ttlVersion
+        if (*value.ttlVersion_ref() > *kvStoreIt->second.ttlVersion_ref()) {
+          return MergeType::UPDATE_TTL;
         }
       }
     }
+  }
+
+  //
+  // Check updateTtl
+  //
+  if (not value.value_ref().has_value() and kvStoreIt != kvStore.end() and
+      *value.version_ref() == *kvStoreIt->second.version_ref() and
+      *value.originatorId_ref() == *kvStoreIt->second.originatorId_ref() and
+      *value.ttlVersion_ref() > *kvStoreIt->second.ttlVersion_ref()) {
+    return MergeType::UPDATE_TTL;
+  }
 
+  VLOG(3) << "(mergeKeyValues) no need to update anything for key: '" << key
+          << "'";
+  return MergeType::NONE;
+}
+
+// Apply merge decision on local store and record the update in `kvUpdates`
+void
+applyMergeDecision(
+    std::unordered_map<std::string, thrift::Value>& kvStore,
+    std::unordered_map<std::string, thrift::Value>& kvUpdates,
+    MergeDecision const& decision,
+    thrift::KvStoreHashVersion hashVersion) {
+  auto const& key = *decision.key;
+  auto const& value = *decision.value;
+  auto kvStoreIt = kvStore.find(key);
+
+  VLOG(3)
+      << "Updating key: " << key << "\n  Version: "
+      << (kvStoreIt != kvStore.end() ? *kvStoreIt->second.version_ref() : 0)
+      << " -> " << *value.version_ref() << "\n  Originator: "
+      << (kvStoreIt != kvStore.end() ? *kvStoreIt->second.originatorId_ref()
+                                     : "null")
+      << " -> " << *value.originatorId_ref() << "\n  TtlVersion: "
+      << (kvStoreIt != kvStore.end() ? *kvStoreIt->second.ttlVersion_ref() : 0)
+      << " -> " << *value.ttlVersion_ref() << "\n  Ttl: "
+      << (kvStoreIt != kvStore.end() ? *kvStoreIt->second.ttl_ref() : 0)
+      << " -> " << *value.ttl_ref();
+
+  if (decision.type == MergeType::UPDATE_ALL) {
+    FB_LOG_EVERY_MS(INFO, 500)
+        << "Updating key: " << key
+        << ", Originator: " << *value.originatorId_ref()
+        << ", Version: " << *value.version_ref()
+        << ", TtlVersion: " << *value.ttlVersion_ref()
+        << ", Ttl: " << *value.ttl_ref();
     //
-    // Check updateTtl
+    // update everything for such key
     //
-    if (not value.value_ref().has_value() and kvStoreIt != kvStore.end() and
-        *value.version_ref() == *kvStoreIt->second.version_ref() and
-        *value.originatorId_ref() == *kvStoreIt->second.originatorId_ref() and
-        *value.ttlVersion_ref() > *kvStoreIt->second.ttlVersion_ref()) {
-      updateTtlNeeded = true;
+    CHECK(value.value_ref().has_value());
+    // grab the new value (this will copy, intended)
+    thrift::Value newValue = value;
+    if (kvStoreIt == kvStore.end()) {
+      // create new entry
+      std::tie(kvStoreIt, std::ignore) = kvStore.emplace(
+          std::piecewise_construct,
+          std::forward_as_tuple(key),
+          std::forward_as_tuple(std::move(newValue)));
+    } else {
+      // update the entry in place, the old value will be destructed
+      kvStoreIt->second = std::move(newValue);
     }
-
-    if (!updateAllNeeded and !updateTtlNeeded) {
-      VLOG(3) << "(mergeKeyValues) no need to update anything for key: '" << key
-              << "'";
-      continue;
+    // update hash if it's not there
+    if (not kvStoreIt->second.hash_ref().has_value()) {
+      kvStoreIt->second.hash_ref() = decision.hash.has_value()
+          ? *decision.hash
+          : generateHash(
+                *value.version_ref(),
+                *value.originatorId_ref(),
+                value.value_ref(),
+                hashVersion);
     }
+  } else if (decision.type == MergeType::UPDATE_TTL) {
+    //
+    // update ttl,ttlVersion only
+    //
+    CHECK(kvStoreIt != kvStore.end());
 
-    VLOG(3)
-        << "Updating key: " << key << "\n  Version: " << myVersion << " -> "
-        << newVersion << "\n  Originator: "
-        << (kvStoreIt != kvStore.end() ? *kvStoreIt->second.originatorId_ref()
-                                       : "null")
-        << " -> " << *value.originatorId_ref() << "\n  TtlVersion: "
-        << (kvStoreIt != kvStore.end() ? *kvStoreIt->second.ttlVersion_ref()
-                                       : 0)
-        << " -> " << *value.ttlVersion_ref() << "\n  Ttl: "
-        << (kvStoreIt != kvStore.end() ? *kvStoreIt->second.ttl_ref() : 0)
-        << " -> " << *value.ttl_ref();
+    // update TTL only, nothing else
+    kvStoreIt->second.ttl_ref() = *value.ttl_ref();
+    kvStoreIt->second.ttlVersion_ref() = *value.ttlVersion_ref();
+  }
 
-    // grab the new value (this will copy, intended)
-    thrift::Value newValue = value;
+  // announce the update
+  kvUpdates.emplace(key, value);
+}
+
+} // namespace
+
+// static, public
+std::unordered_map<std::string, thrift::Value>
+KvStore::mergeKeyValues(
+    std::unordered_map<std::string, thrift::Value>& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::optional<KvStoreFilters> const& filters,
+    thrift::KvStoreHashVersion hashVersion) {
+  // the publication to build if we update our KV store
+  std::unordered_map<std::string, thrift::Value> kvUpdates;
+
+  // Counters for logging
+  uint32_t ttlUpdateCnt{0}, valUpdateCnt{0};
+  FOLLY_SDT(openr, kvstore_merge_key_values_entry, keyVals.size());
 
-    if (updateAllNeeded) {
+  for (const auto& [key, value] : keyVals) {
+    MergeDecision decision;
+    decision.key = &key;
+    decision.value = &value;
+    decision.type = getMergeType(key, value, kvStore, filters);
+    if (decision.type == MergeType::NONE) {
+      continue;
+    }
+    if (decision.type == MergeType::UPDATE_ALL) {
       ++valUpdateCnt;
-      FB_LOG_EVERY_MS(INFO, 500)
-          << "Updating key: " << key
-          << ", Originator: " << *value.originatorId_ref()
-          << ", Version: " << newVersion
-          << ", TtlVersion: " << *value.ttlVersion_ref()
-          << ", Ttl: " << *value.ttl_ref();
-      //
-      // update everything for such key
-      //
-      CHECK(value.value_ref().has_value());
-      if (kvStoreIt == kvStore.end()) {
-        // create new entry
-        std::tie(kvStoreIt, std::ignore) = kvStore.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(key),
-            std::forward_as_tuple(std::move(newValue)));
-      } else {
-        // update the entry in place, the old value will be destructed
-        kvStoreIt->second = std::move(newValue);
-      }
-      // update hash if it's not there
-      if (not kvStoreIt->second.hash_ref().has_value()) {
-        kvStoreIt->second.hash_ref() = generateHash(
-            *value.version_ref(), *value.originatorId_ref(), value.value_ref());
-      }
-    } else if (updateTtlNeeded) {
+    } else {
       ++ttlUpdateCnt;
-      //
-      // update ttl,ttlVersion only
-      //
-      CHECK(kvStoreIt != kvStore.end());
-
-      // update TTL only, nothing else
-      kvStoreIt->second.ttl_ref() = *value.ttl_ref();
-      kvStoreIt->second.ttlVersion_ref() = *value.ttlVersion_ref();
     }
-
-    // announce the update
-    kvUpdates.emplace(key, value);
+    applyMergeDecision(kvStore, kvUpdates, decision, hashVersion);
   }
 
   VLOG(4) << "(mergeKeyValues) updating " << kvUpdates.size()
           << " keyvals. ValueUpdates: " << valUpdateCnt
           << ", TtlUpdates: " << ttlUpdateCnt;
+  FOLLY_SDT(
+      openr,
+      kvstore_merge_key_values_return,
+      kvUpdates.size(),
+      valUpdateCnt,
+      ttlUpdateCnt);
+  return kvUpdates;
+}
+
+// static, public
+std::unordered_map<std::string, thrift::Value>
+KvStore::mergeKeyValuesSharded(
+    std::unordered_map<std::string, thrift::Value>& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::optional<KvStoreFilters> const& filters,
+    folly::Executor* executor,
+    size_t numShards,
+    thrift::KvStoreHashVersion hashVersion) {
+  // Fallback to serial merge if publication is too small to amortize the cost
+  // of handing work over to worker threads
+  if (executor == nullptr or numShards <= 1 or
+      keyVals.size() < numShards * Constants::kKvStoreMinKeysPerMergeShard) {
+    return mergeKeyValues(kvStore, keyVals, filters, hashVersion);
+  }
+
+  // Partition received key-vals into shards based on hash of the key
+  std::vector<std::vector<MergeDecision>> shards(numShards);
+  for (auto& shard : shards) {
+    shard.reserve(keyVals.size() / numShards + 1);
+  }
+  for (const auto& [key, value] : keyVals) {
+    auto& decision = shards[std::hash<std::string>{}(key) % numShards]
+                         .emplace_back(MergeDecision{});
+    decision.key = &key;
+    decision.value = &value;
+  }
+
+  // Compute merge decision of every shard in parallel. ATTN: `kvStore` is
+  // ONLY read by the workers and it is not modified until all of them finish
+  std::vector<folly::SemiFuture<folly::Unit>> futures;
+  futures.reserve(numShards);
+  for (auto& shard : shards) {
+    futures.emplace_back(
+        folly::via(
+            folly::Executor::getKeepAliveToken(executor),
+            [&shard, &kvStore, &filters, hashVersion]() {
+              for (auto& decision : shard) {
+                decision.type = getMergeType(
+                    *decision.key, *decision.value, kvStore, filters);
+                auto const& value = *decision.value;
+                if (decision.type == MergeType::UPDATE_ALL and
+                    not value.hash_ref().has_value()) {
+                  decision.hash = generateHash(
+                      *value.version_ref(),
+                      *value.originatorId_ref(),
+                      value.value_ref(),
+                      hashVersion);
+                }
+              }
+            })
+            .semi());
+  }
+  auto results = folly::collectAll(std::move(futures)).get();
+  for (auto& result : results) {
+    // rethrow exception from worker if any
+    result.throwIfFailed();
+  }
+
+  // Apply the decisions in shard order
+  std::unordered_map<std::string, thrift::Value> kvUpdates;
+  uint32_t ttlUpdateCnt{0}, valUpdateCnt{0};
+  for (auto const& shard : shards) {
+    for (auto const& decision : shard) {
+      if (decision.type == MergeType::NONE) {
+        continue;
+      }
+      if (decision.type == MergeType::UPDATE_ALL) {
+        ++valUpdateCnt;
+      } else {
+        ++ttlUpdateCnt;
+      }
+      applyMergeDecision(kvStore, kvUpdates, decision, hashVersion);
+    }
+  }
+
+  VLOG(4) << "(mergeKeyValuesSharded) updating " << kvUpdates.size()
+          << " keyvals over " << numShards
+          << " shards. ValueUpdates: " << valUpdateCnt
+          << ", TtlUpdates: " << ttlUpdateCnt;
   return kvUpdates;
 }
 
@@ -517,6 +962,19 @@ KvStore::getAreaDbOrThrow(
   return search->second;
 }
 
+OpenrEventBase*
+KvStore::getAreaEvb(std::string const& areaId) {
+  if (areaEvbs_.empty()) {
+    return this;
+  }
+  auto search = areaEvbs_.find(areaId);
+  if (areaEvbs_.end() == search) {
+    // ATTN: same fallback to single area as in getAreaDbOrThrow()
+    return areaEvbs_.size() == 1 ? areaEvbs_.begin()->second.get() : this;
+  }
+  return search->second.get();
+}
+
 void
 KvStore::processCmdSocketRequest(std::vector<fbzmq::Message>&& req) noexcept {
   if (req.empty()) {
@@ -550,6 +1008,15 @@ KvStore::processRequestMsg(
     const std::string& requestId, fbzmq::Message&& request) {
   fb303::fbData->addStatValue(
       "kvstore.peers.bytes_received", request.size(), fb303::SUM);
+
+  // Redundant floods are dropped without decoding their values
+  if (kvParams_.enableLazyValueDecode) {
+    auto maybeReply = processRedundantRequestMsg(request);
+    if (maybeReply.has_value()) {
+      return std::move(*maybeReply);
+    }
+  }
+
   auto maybeThriftReq =
       request.readThriftObj<thrift::KvStoreRequest>(serializer_);
 
@@ -566,7 +1033,16 @@ KvStore::processRequestMsg(
     auto& kvStoreDb =
         getAreaDbOrThrow(thriftRequest.get_area(), "processRequestMsg");
     VLOG(2) << "Request received for area " << kvStoreDb.getAreaId();
-    auto response = kvStoreDb.processRequestMsgHelper(requestId, thriftRequest);
+    // ATTN: reply is sent on global command socket of this event loop, hence
+    //       wait for area thread (if any) to process the request
+    folly::Expected<fbzmq::Message, fbzmq::Error> response{
+        folly::makeUnexpected(fbzmq::Error())};
+    getAreaEvb(kvStoreDb.getAreaId())
+        ->getEvb()
+        ->runImmediatelyOrRunInEventBaseThreadAndWait([&]() {
+          response =
+              kvStoreDb.processRequestMsgHelper(requestId, thriftRequest);
+        });
     if (response.hasValue()) {
       fb303::fbData->addStatValue(
           "kvstore.peers.bytes_sent", response->size(), fb303::SUM);
@@ -578,11 +1054,102 @@ KvStore::processRequestMsg(
   return {folly::makeUnexpected(fbzmq::Error())};
 }
 
-messaging::RQueue<thrift::Publication>
+std::optional<folly::Expected<fbzmq::Message, fbzmq::Error>>
+KvStore::processRedundantRequestMsg(const fbzmq::Message& request) {
+  auto maybeMeta =
+      request.readThriftObj<thrift::KvStoreRequestMeta>(serializer_);
+  if (maybeMeta.hasError() or
+      *maybeMeta->cmd_ref() != thrift::Command::KEY_SET or
+      not maybeMeta->keySetParams_ref().has_value()) {
+    return std::nullopt;
+  }
+  // ATTN: unknown areas are left to the regular path for error handling
+  auto kvStoreDbIt = kvStoreDb_.find(maybeMeta->get_area());
+  if (kvStoreDbIt == kvStoreDb_.end()) {
+    return std::nullopt;
+  }
+  std::optional<folly::Expected<fbzmq::Message, fbzmq::Error>> reply;
+  getAreaEvb(kvStoreDbIt->first)
+      ->getEvb()
+      ->runImmediatelyOrRunInEventBaseThreadAndWait([&]() {
+        reply = kvStoreDbIt->second.processRedundantKeySet(
+            *maybeMeta->keySetParams_ref());
+      });
+  return reply;
+}
+
+messaging::RQueue<KvStorePublicationPtr>
 KvStore::getKvStoreUpdatesReader() {
   return kvParams_.kvStoreUpdatesQueue.getReader();
 }
 
+messaging::RQueue<KvStorePublicationPtr>
+KvStore::getKvStoreUpdatesReader(
+    std::shared_ptr<const KvStoreSubscription> subscription) {
+  CHECK(subscription);
+  auto queue = std::make_shared<messaging::RWQueue<KvStorePublicationPtr>>();
+  auto subscriptionQueues = subscriptionQueues_.wlock();
+  if (subscriptionQueues->isClosed) {
+    queue->close();
+  } else {
+    subscriptionQueues->queues.emplace_back(
+        SubscriptionQueue{std::move(subscription), queue});
+  }
+  return messaging::RQueue<KvStorePublicationPtr>(queue);
+}
+
+void
+KvStore::dispatchToSubscriptions(KvStorePublicationPtr const& publication) {
+  auto subscriptionQueues = subscriptionQueues_.wlock();
+  auto& queues = subscriptionQueues->queues;
+
+  // drop subscriptions released by their subscribers
+  queues.erase(
+      std::remove_if(
+          queues.begin(),
+          queues.end(),
+          [](SubscriptionQueue& subscriptionQueue) {
+            if (subscriptionQueue.subscription.use_count() > 1) {
+              return false;
+            }
+            subscriptionQueue.queue->close();
+            return true;
+          }),
+      queues.end());
+
+  size_t numDelivered{0};
+  for (auto& subscriptionQueue : queues) {
+    if (auto matched = subscriptionQueue.subscription->match(publication)) {
+      subscriptionQueue.queue->push(std::move(matched));
+      ++numDelivered;
+    }
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.subscription.num_skipped",
+      queues.size() - numDelivered,
+      fb303::SUM);
+}
+
+void
+KvStore::processConfigUpdate(Config const& config) {
+  auto floodRate = config.getKvStoreConfig().flood_rate_ref().to_optional();
+  // NOTE: Flood rate can't be set or unset without restart
+  if (not floodRate or not kvParams_.floodRate or
+      *floodRate == *kvParams_.floodRate) {
+    return;
+  }
+  LOG(INFO) << "Reloading flood rate to "
+            << *floodRate->flood_msg_per_sec_ref() << " msgs/s with burst of "
+            << *floodRate->flood_msg_burst_size_ref();
+  kvParams_.floodRate = floodRate;
+  for (auto& [area, kvStoreDb] : kvStoreDb_) {
+    getAreaEvb(area)->runInEventBaseThread(
+        [&kvStoreDb = kvStoreDb, floodRate = *floodRate]() noexcept {
+          kvStoreDb.setFloodRate(floodRate);
+        });
+  }
+}
+
 void
 KvStore::processPeerUpdates(thrift::PeerUpdateRequest&& req) {
   CHECK(not req.get_area().empty());
@@ -601,10 +1168,11 @@ KvStore::getKvStoreKeyVals(
     std::string area, thrift::KeyGetParams keyGetParams) {
   folly::Promise<std::unique_ptr<thrift::Publication>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        keyGetParams = std::move(keyGetParams),
-                        area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             keyGetParams = std::move(keyGetParams),
+                             area]() mutable {
     VLOG(3) << "Get key requested for AREA: " << area;
     try {
       auto& kvStoreDb = getAreaDbOrThrow(area, "getKvStoreKeyVals");
@@ -636,55 +1204,134 @@ KvStore::dumpKvStoreKeys(
                 ? "all areas."
                 : folly::sformat("areas: {}.", folly::join(", ", selectAreas)));
 
-    auto result = std::make_unique<std::vector<thrift::Publication>>();
+    // fan out to event loop of every area and merge publications in order
+    std::vector<folly::SemiFuture<thrift::Publication>> areaPubs;
     for (auto& [area, kvStoreDb] : kvStoreDb_) {
       if (not selectAreas.empty() && not selectAreas.count(area)) {
         continue;
       }
-      fb303::fbData->addStatValue("kvstore.cmd_key_dump", 1, fb303::COUNT);
+      auto pf = folly::makePromiseContract<thrift::Publication>();
+      getAreaEvb(area)->runInEventBaseThread(
+          [&kvStoreDb = kvStoreDb,
+           keyDumpParams,
+           areaPromise = std::move(pf.first)]() mutable {
+            areaPromise.setValue(
+                dumpKvStoreKeysOfArea(kvStoreDb, keyDumpParams));
+          });
+      areaPubs.emplace_back(std::move(pf.second));
+    }
+    folly::collectAll(std::move(areaPubs))
+        .toUnsafeFuture()
+        .thenValue([p = std::move(p)](
+                       std::vector<folly::Try<thrift::Publication>>&&
+                           pubs) mutable {
+          auto result = std::make_unique<std::vector<thrift::Publication>>();
+          for (auto& pub : pubs) {
+            result->push_back(std::move(pub).value());
+          }
+          p.setValue(std::move(result));
+        });
+  });
+  return sf;
+}
 
-      std::vector<std::string> keyPrefixList;
-      if (keyDumpParams.keys_ref().has_value()) {
-        keyPrefixList = *keyDumpParams.keys_ref();
-      } else {
-        folly::split(",", *keyDumpParams.prefix_ref(), keyPrefixList, true);
-      }
-      const auto keyPrefixMatch =
-          KvStoreFilters(keyPrefixList, *keyDumpParams.originatorIds_ref());
+thrift::Publication
+KvStore::dumpKvStoreKeysOfArea(
+    KvStoreDb& kvStoreDb, thrift::KeyDumpParams const& keyDumpParams) {
+  fb303::fbData->addStatValue("kvstore.cmd_key_dump", 1, fb303::COUNT);
 
-      thrift::FilterOperator oper = thrift::FilterOperator::OR;
-      if (keyDumpParams.oper_ref().has_value()) {
-        oper = *keyDumpParams.oper_ref();
-      }
+  std::vector<std::string> keyPrefixList;
+  if (keyDumpParams.keys_ref().has_value()) {
+    keyPrefixList = *keyDumpParams.keys_ref();
+  } else {
+    folly::split(",", *keyDumpParams.prefix_ref(), keyPrefixList, true);
+  }
+  const auto keyPrefixMatch =
+      KvStoreFilters(keyPrefixList, *keyDumpParams.originatorIds_ref());
 
-      auto thriftPub = kvStoreDb.dumpAllWithFilters(
-          keyPrefixMatch, oper, *keyDumpParams.doNotPublishValue_ref());
-      if (keyDumpParams.keyValHashes_ref().has_value()) {
-        thriftPub = kvStoreDb.dumpDifference(
-            *thriftPub.keyVals_ref(), keyDumpParams.keyValHashes_ref().value());
-      }
-      kvStoreDb.updatePublicationTtl(thriftPub);
-      // I'm the initiator, set flood-root-id
-      thriftPub.floodRootId_ref().from_optional(kvStoreDb.getSptRootId());
-
-      if (keyDumpParams.keyValHashes_ref().has_value() and
-          (*keyDumpParams.prefix_ref()).empty() and
-          (not keyDumpParams.keys_ref().has_value() or
-           (*keyDumpParams.keys_ref()).empty())) {
-        // This usually comes from neighbor nodes
-        size_t numMissingKeys = 0;
-        if (thriftPub.tobeUpdatedKeys_ref().has_value()) {
-          numMissingKeys = thriftPub.tobeUpdatedKeys_ref()->size();
-        }
-        LOG(INFO) << "[Thrift Sync] Processed full-sync request with "
-                  << keyDumpParams.keyValHashes_ref().value().size()
-                  << " keyValHashes item(s). Sending "
-                  << thriftPub.keyVals_ref()->size() << " key-vals and "
-                  << numMissingKeys << " missing keys";
+  thrift::FilterOperator oper = thrift::FilterOperator::OR;
+  if (keyDumpParams.oper_ref().has_value()) {
+    oper = *keyDumpParams.oper_ref();
+  }
+
+  auto thriftPub = kvStoreDb.dumpAllWithFilters(
+      keyPrefixMatch, oper, *keyDumpParams.doNotPublishValue_ref());
+  if (auto leaves = keyDumpParams.hashTreeLeaves_ref()) {
+    // full-sync scoped to the hash-tree leaves which differ from peer
+    KvStoreDb::filterHashTreeLeaves(*thriftPub.keyVals_ref(), *leaves);
+  }
+  if (keyDumpParams.keyValHashes_ref().has_value()) {
+    // compare and respond with hashes in scheme of requester
+    kvStoreDb.rehashKeyVals(
+        *thriftPub.keyVals_ref(),
+        keyDumpParams.hashVersion_ref().value_or(
+            thrift::KvStoreHashVersion::BOOST));
+    thriftPub = kvStoreDb.dumpDifference(
+        std::move(*thriftPub.keyVals_ref()),
+        keyDumpParams.keyValHashes_ref().value());
+    thriftPub.hashVersion_ref() = kvStoreDb.getHashVersion();
+  }
+  kvStoreDb.updatePublicationTtl(thriftPub);
+  // I'm the initiator, set flood-root-id
+  thriftPub.floodRootId_ref().from_optional(kvStoreDb.getFloodRootId());
+
+  if (keyDumpParams.keyValHashes_ref().has_value() and
+      (*keyDumpParams.prefix_ref()).empty() and
+      (not keyDumpParams.keys_ref().has_value() or
+       (*keyDumpParams.keys_ref()).empty())) {
+    // This usually comes from neighbor nodes
+    size_t numMissingKeys = 0;
+    if (thriftPub.tobeUpdatedKeys_ref().has_value()) {
+      numMissingKeys = thriftPub.tobeUpdatedKeys_ref()->size();
+    }
+    LOG(INFO) << "[Thrift Sync] Processed full-sync request with "
+              << keyDumpParams.keyValHashes_ref().value().size()
+              << " keyValHashes item(s). Sending "
+              << thriftPub.keyVals_ref()->size() << " key-vals and "
+              << numMissingKeys << " missing keys";
+  }
+  return thriftPub;
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::KvStorePage>>
+KvStore::dumpKvStoreKeysPage(
+    std::string area,
+    thrift::KeyDumpParams keyDumpParams,
+    thrift::PageParams page) {
+  folly::Promise<std::unique_ptr<thrift::KvStorePage>> p;
+  auto sf = p.getSemiFuture();
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             keyDumpParams = std::move(keyDumpParams),
+                             page = std::move(page),
+                             area]() mutable {
+    VLOG(3) << "Dump page of keys requested for AREA: " << area;
+    try {
+      auto& kvStoreDb = getAreaDbOrThrow(area, "dumpKvStoreKeysPage");
+      fb303::fbData->addStatValue("kvstore.cmd_key_dump_page", 1, fb303::COUNT);
+
+      std::vector<std::string> keyPrefixList;
+      if (keyDumpParams.keys_ref().has_value()) {
+        keyPrefixList = *keyDumpParams.keys_ref();
+      } else {
+        folly::split(",", *keyDumpParams.prefix_ref(), keyPrefixList, true);
       }
-      result->push_back(std::move(thriftPub));
+      const auto keyPrefixMatch =
+          KvStoreFilters(keyPrefixList, *keyDumpParams.originatorIds_ref());
+
+      auto kvStorePage = kvStoreDb.dumpPageWithFilters(
+          keyPrefixMatch,
+          keyDumpParams.oper_ref().value_or(thrift::FilterOperator::OR),
+          *keyDumpParams.doNotPublishValue_ref(),
+          page.cursor_ref().to_optional(),
+          *page.pageSize_ref());
+      kvStoreDb.updatePublicationTtl(*kvStorePage.publication_ref());
+      p.setValue(
+          std::make_unique<thrift::KvStorePage>(std::move(kvStorePage)));
+    } catch (thrift::OpenrError const& e) {
+      p.setException(e);
     }
-    p.setValue(std::move(result));
   });
   return sf;
 }
@@ -694,10 +1341,11 @@ KvStore::dumpKvStoreHashes(
     std::string area, thrift::KeyDumpParams keyDumpParams) {
   folly::Promise<std::unique_ptr<thrift::Publication>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        keyDumpParams = std::move(keyDumpParams),
-                        area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             keyDumpParams = std::move(keyDumpParams),
+                             area]() mutable {
     VLOG(3) << "Dump all hashes requested for AREA: " << area;
     try {
       auto& kvStoreDb = getAreaDbOrThrow(area, "dumpKvStoreHashes");
@@ -721,15 +1369,39 @@ KvStore::dumpKvStoreHashes(
   return sf;
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::HashTreeNodes>>
+KvStore::getKvStoreHashTree(
+    std::string area, thrift::HashTreeParams hashTreeParams) {
+  folly::Promise<std::unique_ptr<thrift::HashTreeNodes>> p;
+  auto sf = p.getSemiFuture();
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             hashTreeParams = std::move(hashTreeParams),
+                             area]() mutable {
+    VLOG(3) << "Hash-tree nodes requested for AREA: " << area;
+    try {
+      auto& kvStoreDb = getAreaDbOrThrow(area, "getKvStoreHashTree");
+      fb303::fbData->addStatValue("kvstore.cmd_hash_tree", 1, fb303::COUNT);
+      p.setValue(std::make_unique<thrift::HashTreeNodes>(
+          kvStoreDb.getHashTreeNodes(hashTreeParams)));
+    } catch (thrift::OpenrError const& e) {
+      p.setException(e);
+    }
+  });
+  return sf;
+}
+
 folly::SemiFuture<folly::Unit>
 KvStore::setKvStoreKeyVals(
     std::string area, thrift::KeySetParams keySetParams) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        keySetParams = std::move(keySetParams),
-                        area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             keySetParams = std::move(keySetParams),
+                             area]() mutable {
     VLOG(3) << "Set key requested for AREA: " << area;
     try {
       auto& kvStoreDb = getAreaDbOrThrow(area, "setKvStoreKeyVals");
@@ -744,6 +1416,14 @@ KvStore::setKvStoreKeyVals(
         }
       }
 
+      // Reconstruct delta-encoded values before computing hash
+      std::optional<std::string> senderId;
+      if (keySetParams.nodeIds_ref().has_value() and
+          not keySetParams.nodeIds_ref()->empty()) {
+        senderId = keySetParams.nodeIds_ref()->back();
+      }
+      kvStoreDb.applyValueDeltas(*keySetParams.keyVals_ref(), senderId);
+
       // Update hash for key-values
       for (auto& kv : *keySetParams.keyVals_ref()) {
         auto& value = kv.second;
@@ -751,7 +1431,21 @@ KvStore::setKvStoreKeyVals(
           value.hash_ref() = generateHash(
               *value.version_ref(),
               *value.originatorId_ref(),
-              value.value_ref());
+              value.value_ref(),
+              kvStoreDb.getHashVersion());
+        }
+      }
+
+      // Fast path for re-set of unchanged values by local modules, detected
+      // by hash instead of comparing full values on merge
+      if (not senderId.has_value()) {
+        const auto numUnchanged =
+            kvStoreDb.eraseUnchangedKeyVals(*keySetParams.keyVals_ref());
+        fb303::fbData->addStatValue(
+            "kvstore.local_set_unchanged_key_vals", numUnchanged, fb303::SUM);
+        if (keySetParams.keyVals_ref()->empty()) {
+          p.setValue();
+          return;
         }
       }
 
@@ -777,7 +1471,8 @@ KvStore::getKvStorePeerState(
     std::string const& area, std::string const& peerName) {
   folly::Promise<std::optional<KvStorePeerState>> promise;
   auto sf = promise.getSemiFuture();
-  runInEventBaseThread(
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread(
       [this, p = std::move(promise), peerName, area]() mutable {
         try {
           p.setValue(getAreaDbOrThrow(area, "getKvStorePeerState")
@@ -793,7 +1488,8 @@ folly::SemiFuture<std::unique_ptr<thrift::PeersMap>>
 KvStore::getKvStorePeers(std::string area) {
   folly::Promise<std::unique_ptr<thrift::PeersMap>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this, p = std::move(p), area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this, p = std::move(p), area]() mutable {
     VLOG(2) << "Peer dump requested for AREA: " << area;
     try {
       p.setValue(std::make_unique<thrift::PeersMap>(
@@ -811,10 +1507,11 @@ KvStore::addUpdateKvStorePeers(
     std::string area, thrift::PeerAddParams peerAddParams) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        peerAddParams = std::move(peerAddParams),
-                        area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             peerAddParams = std::move(peerAddParams),
+                             area]() mutable {
     try {
       auto peersToAdd = folly::gen::from(*peerAddParams.peers_ref()) |
           folly::gen::get<0>() | folly::gen::as<std::vector<std::string>>();
@@ -842,10 +1539,11 @@ KvStore::deleteKvStorePeers(
     std::string area, thrift::PeerDelParams peerDelParams) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        peerDelParams = std::move(peerDelParams),
-                        area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             peerDelParams = std::move(peerDelParams),
+                             area]() mutable {
     LOG(INFO) << "Peer deletion for: ["
               << folly::join(",", *peerDelParams.peerNames_ref())
               << "] in area: " << area;
@@ -870,7 +1568,8 @@ folly::SemiFuture<std::unique_ptr<thrift::SptInfos>>
 KvStore::getSpanningTreeInfos(std::string area) {
   folly::Promise<std::unique_ptr<thrift::SptInfos>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this, p = std::move(p), area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this, p = std::move(p), area]() mutable {
     VLOG(3) << "FLOOD_TOPO_GET command requested for AREA: " << area;
     try {
       p.setValue(std::make_unique<thrift::SptInfos>(
@@ -888,10 +1587,11 @@ KvStore::updateFloodTopologyChild(
     std::string area, thrift::FloodTopoSetParams floodTopoSetParams) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        floodTopoSetParams = std::move(floodTopoSetParams),
-                        area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             floodTopoSetParams = std::move(floodTopoSetParams),
+                             area]() mutable {
     VLOG(2) << "FLOOD_TOPO_SET command requested for AREA: " << area;
     try {
       getAreaDbOrThrow(area, "updateFloodTopologyChild")
@@ -909,10 +1609,11 @@ KvStore::processKvStoreDualMessage(
     std::string area, thrift::DualMessages dualMessages) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        dualMessages = std::move(dualMessages),
-                        area]() mutable {
+  auto* evb = getAreaEvb(area);
+  evb->runInEventBaseThread([this,
+                             p = std::move(p),
+                             dualMessages = std::move(dualMessages),
+                             area]() mutable {
     VLOG(2) << "DUAL messages received for AREA: " << area;
     try {
       auto& kvStoreDb = getAreaDbOrThrow(area, "processKvStoreDualMessage");
@@ -935,30 +1636,29 @@ KvStore::processKvStoreDualMessage(
 
 folly::SemiFuture<std::map<std::string, int64_t>>
 KvStore::getCounters() {
-  auto pf = folly::makePromiseContract<std::map<std::string, int64_t>>();
-  runInEventBaseThread([this, p = std::move(pf.first)]() mutable {
-    p.setValue(getGlobalCounters());
-  });
-  return std::move(pf.second);
-}
-
-std::map<std::string, int64_t>
-KvStore::getGlobalCounters() const {
-  std::map<std::string, int64_t> flatCounters;
-  for (auto& kvDb : kvStoreDb_) {
-    auto kvDbCounters = kvDb.second.getCounters();
-    // add up counters for same key from all kvStoreDb instances
-    flatCounters = std::accumulate(
-        kvDbCounters.begin(),
-        kvDbCounters.end(),
-        flatCounters,
-        [](std::map<std::string, int64_t>& flatCounters,
-           const std::pair<const std::string, int64_t>& kvDbcounter) {
-          flatCounters[kvDbcounter.first] += kvDbcounter.second;
-          return flatCounters;
+  // fan out to event loop of every area
+  std::vector<folly::SemiFuture<std::map<std::string, int64_t>>> areaCounters;
+  for (auto& [area, kvStoreDb] : kvStoreDb_) {
+    auto pf = folly::makePromiseContract<std::map<std::string, int64_t>>();
+    getAreaEvb(area)->runInEventBaseThread(
+        [&kvStoreDb = kvStoreDb, p = std::move(pf.first)]() mutable {
+          p.setValue(kvStoreDb.getCounters());
         });
+    areaCounters.emplace_back(std::move(pf.second));
   }
-  return flatCounters;
+  return folly::collectAll(std::move(areaCounters))
+      .deferValue(
+          [](std::vector<folly::Try<std::map<std::string, int64_t>>>&&
+                 kvDbCounters) {
+            // add up counters for same key from all kvStoreDb instances
+            std::map<std::string, int64_t> flatCounters;
+            for (auto& counters : kvDbCounters) {
+              for (auto const& [key, value] : counters.value()) {
+                flatCounters[key] += value;
+              }
+            }
+            return flatCounters;
+          });
 }
 
 //
@@ -1118,6 +1818,11 @@ KvStoreDb::KvStoreDb(
       area_(area),
       peerSyncSock_(std::move(peersyncSock)),
       evb_(evb) {
+  // initial in-flight window of full-syncs can't exceed configured limit
+  parallelSyncLimit_ = std::min(parallelSyncLimit_, kvParams_.maxParallelSync);
+  parallelSyncLimitOverThrift_ =
+      std::min(parallelSyncLimitOverThrift_, kvParams_.maxParallelSync);
+
   if (kvParams_.floodRate) {
     floodLimiter_ = std::make_unique<folly::BasicTokenBucket<>>(
         *kvParams_.floodRate->flood_msg_per_sec_ref(),
@@ -1133,6 +1838,58 @@ KvStoreDb::KvStoreDb(
         });
   }
 
+  if (kvParams_.ttlRefreshCoalesceWindow.count() > 0) {
+    ttlRefreshTimer_ = folly::AsyncTimeout::make(
+        *evb_->getEvb(), [this]() noexcept { floodPendingTtlRefreshes(); });
+    fb303::fbData->addStatExportType(
+        folly::sformat("kvstore.ttl_refresh_batch_size.{}", area_),
+        fb303::AVG);
+    fb303::fbData->addStatExportType(
+        folly::sformat("kvstore.ttl_refresh_batches.{}", area_),
+        fb303::COUNT);
+  }
+
+  // Latency histograms of publication processing stages
+  const std::array<folly::StringPiece, kNumPublicationStages> stageNames{
+      "merge", "ttl_update", "queue_push", "peer_send"};
+  for (size_t i = 0; i < kNumPublicationStages; ++i) {
+    stageHistograms_[i] = folly::sformat(
+        "kvstore.latency_us.{}.{}",
+        kvParams_.enableKvStoreThrift ? "thrift" : "zmq",
+        stageNames[i]);
+    fb303::fbData->addHistogram(
+        stageHistograms_[i],
+        Constants::kKvStoreLatencyHistogramBucketUs,
+        0,
+        Constants::kKvStoreLatencyHistogramMaxUs);
+    fb303::fbData->exportHistogramPercentile(stageHistograms_[i], 50, 99);
+  }
+
+  if (kvParams_.snapshotDir.has_value()) {
+    snapshotTimer_ =
+        folly::AsyncTimeout::make(*evb_->getEvb(), [this]() noexcept {
+          writeSnapshot();
+          snapshotTimer_->scheduleTimeout(kvParams_.snapshotInterval);
+        });
+    // warm up store once event-base is running
+    evb_->getEvb()->runInEventBaseThread([this]() noexcept {
+      loadSnapshot();
+      snapshotTimer_->scheduleTimeout(kvParams_.snapshotInterval);
+    });
+  }
+
+  if (kvParams_.enableHashTreeSync) {
+    hashTree_.emplace(
+        Constants::kKvStoreHashTreeFanout, Constants::kKvStoreHashTreeDepth);
+  }
+
+  if (kvParams_.mergeShards > 1) {
+    mergeExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        kvParams_.mergeShards,
+        createThreadFactory(
+            folly::sformat("KvStoreMerge-{}", area), kvParams_.threadConfig));
+  }
+
   LOG(INFO) << "Starting kvstore DB instance for node " << nodeId << " area "
             << area;
 
@@ -1144,6 +1901,11 @@ KvStoreDb::KvStoreDb(
   ttlCountdownTimer_ = folly::AsyncTimeout::make(
       *evb_->getEvb(), [this]() noexcept { cleanupTtlCountdownQueue(); });
 
+  // Dual messages generated by all events of an event loop iteration, e.g. a
+  // burst of peer or topology changes, are sent in a single batch per neighbor
+  dualMessagesFlushTimer_ = folly::AsyncTimeout::make(
+      *evb_->getEvb(), [this]() noexcept { flushDualMessages(); });
+
   // Initialize fb303 counter keys for thrift
   fb303::fbData->addStatExportType(
       "kvstore.thrift.num_client_connection_failure", fb303::COUNT);
@@ -1165,6 +1927,10 @@ KvStoreDb::KvStoreDb(
       "kvstore.thrift.num_finalized_sync_success", fb303::COUNT);
   fb303::fbData->addStatExportType(
       "kvstore.thrift.num_finalized_sync_failure", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.thrift.num_hash_tree_walk", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.thrift.num_hash_tree_walk_failure", fb303::COUNT);
 
   fb303::fbData->addStatExportType(
       "kvstore.thrift.full_sync_duration_ms", fb303::AVG);
@@ -1187,7 +1953,17 @@ KvStoreDb::KvStoreDb(
 
   // Initialize stats keys
   fb303::fbData->addStatExportType("kvstore.cmd_hash_dump", fb303::COUNT);
+  fb303::fbData->addStatExportType("kvstore.cmd_hash_tree", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.value_delta.num_sent", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.value_delta.bytes_saved", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.value_delta.num_received", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.value_delta.num_failures", fb303::SUM);
   fb303::fbData->addStatExportType("kvstore.cmd_key_dump", fb303::COUNT);
+  fb303::fbData->addStatExportType("kvstore.cmd_key_dump_page", fb303::COUNT);
   fb303::fbData->addStatExportType("kvstore.cmd_key_get", fb303::COUNT);
   fb303::fbData->addStatExportType("kvstore.cmd_key_set", fb303::COUNT);
   fb303::fbData->addStatExportType("kvstore.cmd_peer_add", fb303::COUNT);
@@ -1195,6 +1971,13 @@ KvStoreDb::KvStoreDb(
   fb303::fbData->addStatExportType("kvstore.cmd_per_del", fb303::COUNT);
   fb303::fbData->addStatExportType("kvstore.expired_key_vals", fb303::SUM);
   fb303::fbData->addStatExportType("kvstore.flood_duration_ms", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "kvstore.flood_queue.num_collapsed", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.flood_queue.num_dropped", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.flood_queue.num_overflows", fb303::COUNT);
+  fb303::fbData->addStatExportType("kvstore.ttl_expiry_lag_ms", fb303::AVG);
   fb303::fbData->addStatExportType("kvstore.full_sync_duration_ms", fb303::AVG);
   fb303::fbData->addStatExportType("kvstore.looped_publications", fb303::COUNT);
   fb303::fbData->addStatExportType("kvstore.peers.bytes_received", fb303::SUM);
@@ -1203,14 +1986,55 @@ KvStoreDb::KvStoreDb(
   fb303::fbData->addStatExportType("kvstore.rate_limit_suppress", fb303::COUNT);
   fb303::fbData->addStatExportType(
       "kvstore.received_dual_messages", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.dual.messages_per_batch", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "kvstore.dual.diffusing_computations", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.dual.diffusing_computation_us", fb303::AVG);
   fb303::fbData->addStatExportType("kvstore.received_key_vals", fb303::SUM);
   fb303::fbData->addStatExportType(
       "kvstore.received_publications", fb303::COUNT);
   fb303::fbData->addStatExportType(
       "kvstore.received_redundant_publications", fb303::COUNT);
+  fb303::fbData->addStatExportType("kvstore.flood_fanout.actual", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.flood_fanout.full_mesh", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.flood_fanout.num_backup_tree", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.flood_fanout.num_backup_tree_broken", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.flood_fanout.num_flood_to_all", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.lazy_decode.num_decoded", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.lazy_decode.num_skipped", fb303::COUNT);
   fb303::fbData->addStatExportType("kvstore.sent_key_vals", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.snapshot.load_failure", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.snapshot.num_keys_loaded", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.snapshot.num_keys_written", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "kvstore.snapshot.write_failure", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.snapshot.write_time_ms", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "kvstore.sync_compression_num_responses", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.sync_compression_ratio", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "kvstore.sync_compression_time_us", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "kvstore.sync_decompression_failure", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "kvstore.sync_decompression_time_us", fb303::AVG);
   fb303::fbData->addStatExportType("kvstore.sent_publications", fb303::COUNT);
   fb303::fbData->addStatExportType("kvstore.updated_key_vals", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.hash_version.num_rehashed", fb303::SUM);
 }
 
 KvStoreDb::~KvStoreDb() {
@@ -1220,10 +2044,23 @@ KvStoreDb::~KvStoreDb() {
     // Destroy thrift clients associated with peers, which will
     // fulfill promises with exceptions if any.
     thriftPeers_.clear();
+
+    // persist latest state for next start
+    if (snapshotTimer_) {
+      snapshotTimer_->cancelTimeout();
+      writeSnapshot();
+    }
   });
 
+  // stop merge workers if any
+  if (mergeExecutor_) {
+    mergeExecutor_->join();
+  }
+
   // remove ZMQ socket
-  evb_->removeSocket(fbzmq::RawZmqSocketPtr{*peerSyncSock_});
+  if (kvParams_.enableZmqTransport) {
+    evb_->removeSocket(fbzmq::RawZmqSocketPtr{*peerSyncSock_});
+  }
 
   LOG(INFO) << "Successfully destructed KvStoreDb in area: " << area_;
 }
@@ -1235,25 +2072,38 @@ KvStoreDb::updateTtlCountdownQueue(const thrift::Publication& publication) {
     const auto& value = kv.second;
 
     if (*value.ttl_ref() != Constants::kTtlInfinity) {
-      TtlCountdownQueueEntry queueEntry;
-      queueEntry.expiryTime = std::chrono::steady_clock::now() +
+      TtlCountdownEntry entry;
+      entry.expiryTime = std::chrono::steady_clock::now() +
           std::chrono::milliseconds(*value.ttl_ref());
-      queueEntry.key = key;
-      queueEntry.version = *value.version_ref();
-      queueEntry.ttlVersion = *value.ttlVersion_ref();
-      queueEntry.originatorId = *value.originatorId_ref();
-
-      if ((ttlCountdownQueue_.empty() or
-           (queueEntry.expiryTime <= ttlCountdownQueue_.top().expiryTime)) and
-          ttlCountdownTimer_) {
-        // Reschedule the shorter timeout
-        ttlCountdownTimer_->scheduleTimeout(
-            std::chrono::milliseconds(*value.ttl_ref()));
-      }
+      entry.key = key;
+      entry.version = *value.version_ref();
+      entry.ttlVersion = *value.ttlVersion_ref();
+      entry.originatorId = *value.originatorId_ref();
 
-      ttlCountdownQueue_.push(std::move(queueEntry));
+      // ATTN: entry replaces the previous one of the same key if any
+      ttlCountdownWheel_.upsert(std::move(entry));
+    } else {
+      // key no longer expires
+      ttlCountdownWheel_.erase(key);
     }
   }
+
+  // Reschedule as expiry might have become shorter
+  scheduleTtlCountdownTimer();
+}
+
+void
+KvStoreDb::scheduleTtlCountdownTimer() {
+  if (not ttlCountdownTimer_) {
+    return;
+  }
+  auto timeout =
+      ttlCountdownWheel_.getNextTimeout(std::chrono::steady_clock::now());
+  if (timeout.has_value()) {
+    ttlCountdownTimer_->scheduleTimeout(*timeout);
+  } else {
+    ttlCountdownTimer_->cancelTimeout();
+  }
 }
 
 // build publication out of the requested keys (per request)
@@ -1313,6 +2163,37 @@ KvStoreDb::dumpAllWithFilters(
   return thriftPub;
 }
 
+thrift::KvStorePage
+KvStoreDb::dumpPageWithFilters(
+    KvStoreFilters const& kvFilters,
+    thrift::FilterOperator oper,
+    bool doNotPublishValue,
+    std::optional<std::string> const& cursor,
+    size_t pageSize) const {
+  auto [entries, nextCursor] = selectPage(
+      kvStore_,
+      [&](auto const& kv) -> std::optional<std::string> {
+        const bool match = oper == thrift::FilterOperator::AND
+            ? kvFilters.keyMatchAll(kv.first, kv.second)
+            : kvFilters.keyMatch(kv.first, kv.second);
+        return match ? std::make_optional(kv.first) : std::nullopt;
+      },
+      cursor,
+      pageSize);
+
+  thrift::KvStorePage page;
+  auto& thriftPub = *page.publication_ref();
+  *thriftPub.area_ref() = area_;
+  for (auto const& it : entries) {
+    thriftPub.keyVals_ref()->emplace(
+        it->first,
+        doNotPublishValue ? createThriftValueWithoutBinaryValue(it->second)
+                          : it->second);
+  }
+  page.nextCursor_ref().from_optional(std::move(nextCursor));
+  return page;
+}
+
 // dump the hashes of my KV store whose keys match the given prefix
 // if prefix is the empty string, the full hash store is dumped
 thrift::Publication
@@ -1334,6 +2215,145 @@ KvStoreDb::dumpHashWithFilters(KvStoreFilters const& kvFilters) const {
   return thriftPub;
 }
 
+thrift::HashTreeNodes
+KvStoreDb::getHashTreeNodes(thrift::HashTreeParams const& params) const {
+  if (not hashTree_.has_value()) {
+    throw thrift::OpenrError(
+        folly::sformat("Hash-tree index is not enabled in area: {}", area_));
+  }
+
+  thrift::HashTreeNodes nodes;
+  nodes.level_ref() = *params.level_ref() + 1;
+  *nodes.nodes_ref() =
+      hashTree_->getChildren(*params.level_ref(), *params.indices_ref());
+  nodes.fanout_ref() = hashTree_->getFanout();
+  nodes.depth_ref() = hashTree_->getDepth();
+  nodes.hashVersion_ref() = kvParams_.hashVersion;
+  return nodes;
+}
+
+// static
+void
+KvStoreDb::filterHashTreeLeaves(
+    std::unordered_map<std::string, thrift::Value>& keyVals,
+    std::vector<int32_t> const& leaves) {
+  const std::unordered_set<int32_t> leafSet(leaves.begin(), leaves.end());
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    const auto leaf = KvStoreHashTree::getLeafIndex(
+        it->first,
+        Constants::kKvStoreHashTreeFanout,
+        Constants::kKvStoreHashTreeDepth);
+    if (leafSet.count(leaf)) {
+      ++it;
+    } else {
+      it = keyVals.erase(it);
+    }
+  }
+}
+
+void
+KvStoreDb::applyValueDeltas(
+    std::unordered_map<std::string, thrift::Value>& keyVals,
+    std::optional<std::string> const& senderId) {
+  size_t numDeltas{0};
+  size_t numFailures{0};
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    auto& [key, value] = *it;
+    if (not value.valueDelta_ref().has_value()) {
+      ++it;
+      continue;
+    }
+    auto delta = std::move(*value.valueDelta_ref());
+    value.valueDelta_ref().reset();
+    if (value.value_ref().has_value()) {
+      // full value takes precedence over delta
+      ++it;
+      continue;
+    }
+    ++numDeltas;
+
+    auto kvIt = kvStore_.find(key);
+    if (kvIt != kvStore_.end() and kvIt->second.value_ref().has_value() and
+        kvIt->second.hash_ref().to_optional() == *delta.baseHash_ref()) {
+      auto newValue = applyValueDelta(*kvIt->second.value_ref(), delta);
+      if (newValue.has_value()) {
+        value.value_ref() = std::move(*newValue);
+        ++it;
+        continue;
+      }
+    }
+
+    // Need full value from sender unless we already have it or a newer one
+    if (kvIt == kvStore_.end() or
+        (kvIt->second.hash_ref().to_optional() !=
+             value.hash_ref().to_optional() and
+         *kvIt->second.version_ref() <= *value.version_ref())) {
+      VLOG(2) << "Unable to apply value delta for key: " << key
+              << ", version: " << *value.version_ref();
+      ++numFailures;
+    }
+    it = keyVals.erase(it);
+  }
+
+  if (numDeltas == 0) {
+    return;
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.value_delta.num_received", numDeltas, fb303::SUM);
+  if (numFailures == 0) {
+    return;
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.value_delta.num_failures", numFailures, fb303::SUM);
+
+  // Fall back to full-sync with the sender to fetch full values
+  if (senderId.has_value() and thriftPeers_.count(*senderId)) {
+    processThriftFailure(
+        *senderId,
+        folly::sformat("Failed to apply {} value deltas", numFailures),
+        std::chrono::milliseconds(0));
+  } else {
+    LOG(WARNING) << "Failed to apply " << numFailures
+                 << " value deltas from unknown sender";
+  }
+}
+
+void
+KvStoreDb::rehashKeyVals(
+    std::unordered_map<std::string, thrift::Value>& keyVals,
+    thrift::KvStoreHashVersion peerHashVersion) const {
+  if (peerHashVersion == kvParams_.hashVersion) {
+    return;
+  }
+  for (auto& [_, value] : keyVals) {
+    if (value.value_ref().has_value()) {
+      value.hash_ref() = generateHash(
+          *value.version_ref(),
+          *value.originatorId_ref(),
+          value.value_ref(),
+          peerHashVersion);
+    }
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.hash_version.num_rehashed", keyVals.size(), fb303::SUM);
+}
+
+thrift::KvStoreHashVersion
+KvStoreDb::processSyncResponseHashes(thrift::Publication& pub) const {
+  if (auto hashVersion = pub.hashVersion_ref()) {
+    // peer responded with hashes of our scheme
+    return *hashVersion;
+  }
+  if (kvParams_.hashVersion != thrift::KvStoreHashVersion::BOOST) {
+    for (auto& [_, value] : *pub.keyVals_ref()) {
+      if (value.value_ref().has_value()) {
+        value.hash_ref().reset();
+      }
+    }
+  }
+  return thrift::KvStoreHashVersion::BOOST;
+}
+
 // dump the keys on which hashes differ from given keyVals
 // thriftPub.keyVals: better keys or keys exist only in MY-KEY-VAL
 // thriftPub.tobeUpdatedKeys: better keys or keys exist only in REQ-KEY-VAL
@@ -1341,50 +2361,95 @@ KvStoreDb::dumpHashWithFilters(KvStoreFilters const& kvFilters) const {
 // 3-way full-sync
 thrift::Publication
 KvStoreDb::dumpDifference(
-    std::unordered_map<std::string, thrift::Value> const& myKeyVal,
+    std::unordered_map<std::string, thrift::Value>&& myKeyVal,
     std::unordered_map<std::string, thrift::Value> const& reqKeyVal) const {
   thrift::Publication thriftPub;
   *thriftPub.area_ref() = area_;
 
+  // keys which only exist in reqKeyVal
   thriftPub.tobeUpdatedKeys_ref() = std::vector<std::string>{};
-  std::unordered_set<std::string> allKeys;
-  for (const auto& kv : myKeyVal) {
-    allKeys.insert(kv.first);
-  }
-  for (const auto& kv : reqKeyVal) {
-    allKeys.insert(kv.first);
+  auto& tobeUpdatedKeys = *thriftPub.tobeUpdatedKeys_ref();
+  for (const auto& [key, _] : reqKeyVal) {
+    if (not myKeyVal.count(key)) {
+      tobeUpdatedKeys.emplace_back(key);
+    }
   }
 
-  for (const auto& key : allKeys) {
-    const auto& myKv = myKeyVal.find(key);
-    const auto& reqKv = reqKeyVal.find(key);
-    if (myKv == myKeyVal.end()) {
-      // not exist in myKeyVal
-      thriftPub.tobeUpdatedKeys_ref()->emplace_back(key);
-      continue;
-    }
+  // ATTN: respond with myKeyVal in place and erase keys on which peer is
+  //       up to date, instead of copying values into a new map
+  auto& keyVals = *thriftPub.keyVals_ref();
+  keyVals = std::move(myKeyVal);
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    const auto reqKv = reqKeyVal.find(it->first);
     if (reqKv == reqKeyVal.end()) {
       // not exist in reqKeyVal
-      thriftPub.keyVals_ref()->emplace(key, myKv->second);
+      ++it;
       continue;
     }
     // common key
-    const auto& myVal = myKv->second;
-    const auto& reqVal = reqKv->second;
-    int rc = KvStore::compareValues(myVal, reqVal);
-    if (rc == 1 or rc == -2) {
-      // myVal is better or unknown
-      thriftPub.keyVals_ref()->emplace(key, myVal);
-    }
+    int rc = KvStore::compareValues(it->second, reqKv->second);
     if (rc == -1 or rc == -2) {
       // reqVal is better or unknown
-      thriftPub.tobeUpdatedKeys_ref()->emplace_back(key);
+      tobeUpdatedKeys.emplace_back(it->first);
+    }
+    if (rc == 1 or rc == -2) {
+      // myVal is better or unknown
+      ++it;
+    } else {
+      it = keyVals.erase(it);
     }
   }
 
   return thriftPub;
 }
 
+void
+KvStoreDb::sortPeersForFullSync(std::vector<std::string>& peers) const {
+  // 0 => flood-topology parent, 1 => flood-topology child, 2 => others
+  std::unordered_map<std::string, int> priorities;
+  const auto rootId = DualNode::getSptRootId();
+  if (rootId.has_value()) {
+    for (auto const& sptPeer : DualNode::getSptPeers(rootId)) {
+      priorities.emplace(sptPeer, 1);
+    }
+    const auto info = DualNode::getInfo(*rootId);
+    if (info.has_value() and info->nexthop.has_value()) {
+      priorities[*info->nexthop] = 0;
+    }
+  }
+
+  auto getPriority = [&priorities](std::string const& peer) {
+    auto it = priorities.find(peer);
+    return it == priorities.end() ? 2 : it->second;
+  };
+  std::sort(
+      peers.begin(),
+      peers.end(),
+      [&getPriority](std::string const& lhs, std::string const& rhs) {
+        const auto lhsPriority = getPriority(lhs);
+        const auto rhsPriority = getPriority(rhs);
+        return lhsPriority != rhsPriority ? lhsPriority < rhsPriority
+                                          : lhs < rhs;
+      });
+}
+
+void
+KvStoreDb::recordPeerSyncDuration(
+    std::string const& peerName, std::chrono::milliseconds duration) {
+  auto& stats = peerSyncStats_[peerName];
+  const int64_t durationMs = duration.count();
+  stats.count += 1;
+  stats.sumMs += durationMs;
+  stats.maxMs = std::max(stats.maxMs, durationMs);
+  stats.lastMs = durationMs;
+
+  const auto& bounds = PeerSyncStats::kBucketBoundsMs;
+  const size_t bucket =
+      std::lower_bound(bounds.begin(), bounds.end(), durationMs) -
+      bounds.begin();
+  stats.buckets[bucket] += 1;
+}
+
 // This function serves the purpose of periodically scanning peers in
 // IDLE state and promote them to SYNCING state. The initial dump will
 // happen in async nature to unblock KvStore to process other requests.
@@ -1397,13 +2462,22 @@ KvStoreDb::requestThriftPeerSync() {
   uint32_t numThriftPeersInSync =
       getPeersByState(KvStorePeerState::SYNCING).size();
 
-  // Scan over thriftPeers to promote IDLE peers to SYNCING
-  for (auto& [peerName, thriftPeer] : thriftPeers_) {
+  // Scan over IDLE peers in order of priority to promote them to SYNCING
+  auto idlePeers = getPeersByState(KvStorePeerState::IDLE);
+  sortPeersForFullSync(idlePeers);
+
+  for (auto const& peerName : idlePeers) {
+    auto& thriftPeer = thriftPeers_.at(peerName);
     auto& peerSpec = thriftPeer.peerSpec; // thrift::PeerSpec
 
-    // ignore peers in state other than IDLE
-    if (thriftPeer.state != KvStorePeerState::IDLE) {
-      continue;
+    // in case pending peer size reaches parallelSyncLimit,
+    // wait until kMaxBackoff or next sync response before next round
+    if (numThriftPeersInSync >= parallelSyncLimitOverThrift_) {
+      timeout = Constants::kMaxBackoff;
+      LOG(INFO) << "[Thrift Sync] " << numThriftPeersInSync
+                << " peers are syncing in progress. Reached parallel sync "
+                << "limit: " << parallelSyncLimitOverThrift_;
+      break;
     }
 
     // update the global minimum timeout value for next try
@@ -1462,76 +2536,23 @@ KvStoreDb::requestThriftPeerSync() {
     // mark peer from IDLE -> SYNCING
     numThriftPeersInSync += 1;
 
-    // build KeyDumpParam
-    thrift::KeyDumpParams params;
-    if (kvParams_.filters.has_value()) {
-      std::string keyPrefix =
-          folly::join(",", kvParams_.filters.value().getKeyPrefixes());
-      /* prefix is for backward compatibility */
-      *params.prefix_ref() = keyPrefix;
-      if (not keyPrefix.empty()) {
-        params.keys_ref() = kvParams_.filters.value().getKeyPrefixes();
-      }
-      params.originatorIds_ref() =
-          kvParams_.filters.value().getOriginatorIdList();
-    }
-    KvStoreFilters kvFilters(
-        std::vector<std::string>{}, /* keyPrefixList */
-        std::set<std::string>{} /* originator */);
-    params.keyValHashes_ref() =
-        std::move(*dumpHashWithFilters(kvFilters).keyVals_ref());
-
     // record telemetry for initial full-sync
     fb303::fbData->addStatValue(
         "kvstore.thrift.num_full_sync", 1, fb303::COUNT);
 
-    // send request over thrift client and attach callback
     auto startTime = std::chrono::steady_clock::now();
-    // TODO: switch to getKvStoreKeyValsFiltered() when all nodes have
-    // version with area param
-    auto sf = thriftPeer.client->semifuture_getKvStoreKeyValsFilteredArea(
-        params, area_);
-    std::move(sf)
-        .via(evb_->getEvb())
-        .thenValue(
-            [this, peer = peerName, startTime](thrift::Publication&& pub) {
-              // state transition to INITIALIZED
-              auto endTime = std::chrono::steady_clock::now();
-              auto timeDelta =
-                  std::chrono::duration_cast<std::chrono::milliseconds>(
-                      endTime - startTime);
-              processThriftSuccess(peer, std::move(pub), timeDelta);
-            })
-        .thenError([this, peer = peerName, startTime](
-                       const folly::exception_wrapper& ew) {
-          // state transition to IDLE
-          auto endTime = std::chrono::steady_clock::now();
-          auto timeDelta =
-              std::chrono::duration_cast<std::chrono::milliseconds>(
-                  endTime - startTime);
-          processThriftFailure(peer, ew.what(), timeDelta);
-
-          // record telemetry for thrift calls
-          fb303::fbData->addStatValue(
-              "kvstore.thrift.num_full_sync_failure", 1, fb303::COUNT);
-        });
-
-    // in case pending peer size is over parallelSyncLimit,
-    // wait until kMaxBackoff before sending next round of sync
-    if (numThriftPeersInSync > parallelSyncLimitOverThrift_) {
-      timeout = Constants::kMaxBackoff;
-      LOG(INFO) << "[Thrift Sync] " << numThriftPeersInSync
-                << " peers are syncing in progress. Over parallel sync limit: "
-                << parallelSyncLimitOverThrift_;
-      break;
+    if (hashTree_.has_value() and not kvParams_.filters.has_value()) {
+      // walk down the hash-tree of peer from the root to find differing keys
+      walkPeerHashTree(peerName, 0 /* level */, {0} /* root */, startTime);
+    } else {
+      sendThriftFullSyncRequest(peerName, std::nullopt, startTime);
     }
   } // for loop
 
   // process the rest after min timeout if NOT scheduled
   uint32_t numThriftPeersInIdle =
       getPeersByState(KvStorePeerState::IDLE).size();
-  if (numThriftPeersInIdle > 0 or
-      numThriftPeersInSync > parallelSyncLimitOverThrift_) {
+  if (numThriftPeersInIdle > 0) {
     LOG_IF(INFO, numThriftPeersInIdle)
         << "[Thrift Sync] " << numThriftPeersInIdle
         << " idle peers require full-sync. Schedule full-sync after: "
@@ -1540,28 +2561,205 @@ KvStoreDb::requestThriftPeerSync() {
   }
 }
 
-// This function will process the full-dump response from peers:
-//  1) Merge peer's publication with local KvStoreDb;
-//  2) Send a finalized full-sync to peer for missing keys;
-//  3) Exponetially update number of peers to SYNC in parallel;
-//  4) Promote KvStorePeerState from SYNCING -> INITIALIZED;
+// Periodic sync over thrift with one randomly selected peer which is done
+// with its initial full-sync. Peers in IDLE or SYNCING state are handled by
+// `thriftSyncTimer_`
 void
-KvStoreDb::processThriftSuccess(
-    std::string const& peerName,
-    thrift::Publication&& pub,
-    std::chrono::milliseconds timeDelta) {
-  // check if it is valid peer(i.e. peer removed in process of syncing)
-  if (not thriftPeers_.count(peerName)) {
-    LOG(WARNING) << "Received async full-sync response from invalid peer: "
-                 << peerName << ". Ignore state transition.";
+KvStoreDb::requestThriftPeriodicSync() {
+  auto initializedPeers = getPeersByState(KvStorePeerState::INITIALIZED);
+  if (initializedPeers.empty()) {
     return;
   }
 
-  // ATTN: In parallel link case, peer state can be set to IDLE when
-  //       parallel adj comes up before the previous full-sync response
-  //       being received. KvStoreDb will ignore the old full-sync
-  //       response and will rely on the new full-sync response to
-  //       promote the state.
+  const auto& peerName =
+      initializedPeers.at(folly::Random::rand32() % initializedPeers.size());
+  if (not thriftPeers_.at(peerName).client) {
+    return;
+  }
+  LOG(INFO) << "[Thrift Sync] Periodic full-sync with peer " << peerName;
+  fb303::fbData->addStatValue(
+      "kvstore.thrift.num_periodic_sync", 1, fb303::COUNT);
+
+  auto startTime = std::chrono::steady_clock::now();
+  if (hashTree_.has_value() and not kvParams_.filters.has_value()) {
+    walkPeerHashTree(peerName, 0 /* level */, {0} /* root */, startTime);
+  } else {
+    sendThriftFullSyncRequest(peerName, std::nullopt, startTime);
+  }
+}
+
+void
+KvStoreDb::sendThriftFullSyncRequest(
+    std::string const& peerName,
+    std::optional<std::vector<int32_t>> hashTreeLeaves,
+    std::chrono::steady_clock::time_point startTime) {
+  auto& thriftPeer = thriftPeers_.at(peerName);
+  CHECK(thriftPeer.client) << "thrift client is NOT initialized";
+
+  // build KeyDumpParam
+  thrift::KeyDumpParams params;
+  if (kvParams_.filters.has_value()) {
+    std::string keyPrefix =
+        folly::join(",", kvParams_.filters.value().getKeyPrefixes());
+    /* prefix is for backward compatibility */
+    *params.prefix_ref() = keyPrefix;
+    if (not keyPrefix.empty()) {
+      params.keys_ref() = kvParams_.filters.value().getKeyPrefixes();
+    }
+    params.originatorIds_ref() =
+        kvParams_.filters.value().getOriginatorIdList();
+  }
+  KvStoreFilters kvFilters(
+      std::vector<std::string>{}, /* keyPrefixList */
+      std::set<std::string>{} /* originator */);
+  params.keyValHashes_ref() =
+      std::move(*dumpHashWithFilters(kvFilters).keyVals_ref());
+  params.hashVersion_ref() = kvParams_.hashVersion;
+  if (hashTreeLeaves.has_value()) {
+    filterHashTreeLeaves(*params.keyValHashes_ref(), *hashTreeLeaves);
+    params.hashTreeLeaves_ref() = std::move(*hashTreeLeaves);
+  }
+
+  // send request over thrift client and attach callback
+  // TODO: switch to getKvStoreKeyValsFiltered() when all nodes have
+  // version with area param
+  auto sf = thriftPeer.client->semifuture_getKvStoreKeyValsFilteredArea(
+      params, area_);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue([this, peer = peerName, startTime](thrift::Publication&& pub) {
+        // state transition to INITIALIZED
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
+        processThriftSuccess(peer, std::move(pub), timeDelta);
+      })
+      .thenError([this, peer = peerName, startTime](
+                     const folly::exception_wrapper& ew) {
+        // state transition to IDLE
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
+        processThriftFailure(peer, ew.what(), timeDelta);
+
+        // record telemetry for thrift calls
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_full_sync_failure", 1, fb303::COUNT);
+      });
+}
+
+void
+KvStoreDb::walkPeerHashTree(
+    std::string const& peerName,
+    int32_t level,
+    std::vector<int32_t> indices,
+    std::chrono::steady_clock::time_point startTime) {
+  CHECK(hashTree_.has_value());
+  auto& thriftPeer = thriftPeers_.at(peerName);
+  CHECK(thriftPeer.client) << "thrift client is NOT initialized";
+
+  fb303::fbData->addStatValue(
+      "kvstore.thrift.num_hash_tree_walk", 1, fb303::COUNT);
+
+  thrift::HashTreeParams params;
+  params.level_ref() = level;
+  *params.indices_ref() = std::move(indices);
+
+  // ATTN: peer can be removed or reset back to IDLE while walking down the
+  //       tree. Only proceed if it is still waiting for initial full-sync.
+  auto isSyncing = [this](std::string const& peer) {
+    auto it = thriftPeers_.find(peer);
+    return it != thriftPeers_.end() and
+        it->second.state == KvStorePeerState::SYNCING and it->second.client;
+  };
+
+  auto sf = thriftPeer.client->semifuture_getKvStoreHashTreeArea(params, area_);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue([this, peer = peerName, startTime, isSyncing](
+                     thrift::HashTreeNodes&& nodes) {
+        if (not isSyncing(peer)) {
+          return;
+        }
+
+        // fall back to regular full-sync if tree shape doesn't match
+        if (*nodes.fanout_ref() != static_cast<int>(hashTree_->getFanout()) or
+            *nodes.depth_ref() != static_cast<int>(hashTree_->getDepth())) {
+          LOG(WARNING) << "[Thrift Sync] Hash-tree of peer: " << peer
+                       << " has different shape. Fall back to full-sync.";
+          sendThriftFullSyncRequest(peer, std::nullopt, startTime);
+          return;
+        }
+        // same for trees built from hashes of different scheme
+        if (nodes.hashVersion_ref().value_or(
+                thrift::KvStoreHashVersion::BOOST) != kvParams_.hashVersion) {
+          LOG(WARNING) << "[Thrift Sync] Hash-tree of peer: " << peer
+                       << " has different hash scheme. Fall back to full-sync.";
+          sendThriftFullSyncRequest(peer, std::nullopt, startTime);
+          return;
+        }
+
+        const auto childLevel = *nodes.level_ref();
+        auto differingNodes =
+            hashTree_->getDifferingNodes(childLevel, *nodes.nodes_ref());
+        VLOG(2) << "[Thrift Sync] " << differingNodes.size()
+                << " hash-tree nodes differ with peer: " << peer
+                << " at level: " << childLevel;
+
+        if (differingNodes.empty()) {
+          // both stores are identical, nothing to be synced
+          auto timeDelta =
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - startTime);
+          processThriftSuccess(peer, thrift::Publication{}, timeDelta);
+          return;
+        }
+
+        if (childLevel == static_cast<int>(hashTree_->getDepth())) {
+          // reached leaves, exchange hashes for keys in differing leaves
+          sendThriftFullSyncRequest(peer, std::move(differingNodes), startTime);
+          return;
+        }
+        walkPeerHashTree(
+            peer, childLevel, std::move(differingNodes), startTime);
+      })
+      .thenError([this, peer = peerName, startTime, isSyncing](
+                     const folly::exception_wrapper& ew) {
+        // peer might not have hash-tree index enabled. Fall back to regular
+        // full-sync which will take care of failure of the connection itself
+        LOG(WARNING) << "[Thrift Sync] Failed to walk hash-tree of peer: "
+                     << peer << ". Exception: " << ew.what()
+                     << ". Fall back to full-sync.";
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_hash_tree_walk_failure", 1, fb303::COUNT);
+        if (isSyncing(peer)) {
+          sendThriftFullSyncRequest(peer, std::nullopt, startTime);
+        }
+      });
+}
+
+// This function will process the full-dump response from peers:
+//  1) Merge peer's publication with local KvStoreDb;
+//  2) Send a finalized full-sync to peer for missing keys;
+//  3) Exponetially update number of peers to SYNC in parallel;
+//  4) Promote KvStorePeerState from SYNCING -> INITIALIZED;
+void
+KvStoreDb::processThriftSuccess(
+    std::string const& peerName,
+    thrift::Publication&& pub,
+    std::chrono::milliseconds timeDelta) {
+  // check if it is valid peer(i.e. peer removed in process of syncing)
+  if (not thriftPeers_.count(peerName)) {
+    LOG(WARNING) << "Received async full-sync response from invalid peer: "
+                 << peerName << ". Ignore state transition.";
+    return;
+  }
+
+  // ATTN: In parallel link case, peer state can be set to IDLE when
+  //       parallel adj comes up before the previous full-sync response
+  //       being received. KvStoreDb will ignore the old full-sync
+  //       response and will rely on the new full-sync response to
+  //       promote the state.
   auto& peer = thriftPeers_.at(peerName);
   if (peer.state == KvStorePeerState::IDLE) {
     LOG(WARNING) << "Ignore response from: " << peerName
@@ -1569,6 +2767,8 @@ KvStoreDb::processThriftSuccess(
     return;
   }
 
+  peer.hashVersion = processSyncResponseHashes(pub);
+
   // ATTN: `peerName` is MANDATORY to fulfill the finialized
   //       full-sync with peers.
   const auto kvUpdateCnt = mergePublication(pub, peerName);
@@ -1602,14 +2802,14 @@ KvStoreDb::processThriftSuccess(
 
   // Log full-sync event via replicate queue
   logSyncEvent(peerName, timeDelta);
+  recordPeerSyncDuration(peerName, timeDelta);
 
   // Successfully received full-sync response. Double the parallel
   // sync limit. This is to:
   //  1) accelerate the rest of pending full-syncs if any;
   //  2) assume subsequeny sync diff will be small in traffic amount;
-  parallelSyncLimitOverThrift_ = std::min(
-      2 * parallelSyncLimitOverThrift_,
-      Constants::kMaxFullSyncPendingCountThreshold);
+  parallelSyncLimitOverThrift_ =
+      std::min(2 * parallelSyncLimitOverThrift_, kvParams_.maxParallelSync);
 
   // Schedule another round of `thriftSyncTimer_` full-sync request if
   // there is still peer in IDLE state. If no IDLE peer, cancel timeout.
@@ -1642,9 +2842,12 @@ KvStoreDb::processThriftFailure(
   // reset client to reconnect later in next batch of thriftSyncTimer_
   // scanning
   auto& peer = thriftPeers_.at(peerName);
-  peer.keepAliveTimer->cancelTimeout();
   peer.expBackoff.reportError(); // apply exponential backoff
-  peer.client.reset();
+  resetThriftPeerClient(peerName);
+
+  // queued updates are covered by full-sync after reconnecting
+  peer.floodQueue.clear();
+  peer.floodQueueBytes = 0;
 
   // state transition
   KvStorePeerState oldState = peer.state;
@@ -1685,8 +2888,7 @@ KvStoreDb::addThriftPeers(
 
       peerIter->second.peerSpec = newPeerSpec; // update peerSpec
       peerIter->second.state = KvStorePeerState::IDLE; // set IDLE initially
-      peerIter->second.keepAliveTimer->cancelTimeout(); // cancel timer
-      peerIter->second.client.reset(); // destruct thriftClient
+      resetThriftPeerClient(peerName); // destruct thriftClient
     } else {
       // case 2: found a new peer coming up
       LOG(INFO) << "[Peer Add] " << peerName << " is added."
@@ -1730,6 +2932,11 @@ KvStoreDb::addPeers(
     addThriftPeers(peers);
   }
 
+  // ZMQ peers are NOT tracked with thrift only transport
+  if (not kvParams_.enableZmqTransport) {
+    return;
+  }
+
   for (auto const& kv : peers) {
     auto const& peerName = kv.first;
     auto const& newPeerSpec = kv.second;
@@ -1850,13 +3057,89 @@ KvStoreDb::sendMessageToPeer(
       fbzmq::Message::from(peerSocketId).value(), fbzmq::Message(), msg);
 }
 
+void
+KvStoreDb::setFloodRate(thrift::KvstoreFloodRate const& floodRate) {
+  CHECK(floodLimiter_);
+  floodLimiter_->reset(
+      *floodRate.flood_msg_per_sec_ref(),
+      *floodRate.flood_msg_burst_size_ref());
+}
+
 std::map<std::string, int64_t>
 KvStoreDb::getCounters() const {
   std::map<std::string, int64_t> counters;
 
   // Add some more flat counters
   counters["kvstore.num_keys"] = kvStore_.size();
-  counters["kvstore.num_peers"] = peers_.size();
+  counters["kvstore.num_peers"] =
+      kvParams_.enableZmqTransport ? peers_.size() : thriftPeers_.size();
+  counters["kvstore.dual.active_diffusing_computations"] =
+      DualNode::getNumActiveDiffusingComputations();
+
+  // Progress of full-sync with peers
+  counters["kvstore.num_pending_full_sync"] = peersToSyncWith_.size();
+  counters["kvstore.num_in_flight_full_sync"] = latestSentPeerSync_.size();
+  for (auto const& [_, peer] : thriftPeers_) {
+    if (peer.state == KvStorePeerState::IDLE) {
+      ++counters["kvstore.num_pending_full_sync"];
+    } else if (peer.state == KvStorePeerState::SYNCING) {
+      ++counters["kvstore.num_in_flight_full_sync"];
+    }
+  }
+
+  // Flood queues of thrift peers
+  for (auto const& [peerName, peer] : thriftPeers_) {
+    const auto prefix = folly::sformat("kvstore.flood_queue.{}", peerName);
+    counters[prefix + ".num_keys"] = peer.floodQueue.size();
+    counters[prefix + ".bytes"] = peer.floodQueueBytes;
+    counters[prefix + ".num_dropped"] = peer.numFloodQueueDrops;
+  }
+
+  // Requests on thrift channels of peers
+  for (auto const& [peerName, peer] : thriftPeers_) {
+    const auto prefix = folly::sformat("kvstore.thrift_peer.{}", peerName);
+    counters[prefix + ".flood_rtt_ms"] = peer.floodRttMs;
+    counters[prefix + ".floods_in_flight"] = peer.numFloodsInFlight;
+    counters[prefix + ".flood_key_vals_sent"] = peer.numFloodKeyValsSent;
+    counters[prefix + ".flood_bytes_sent"] = peer.numFloodBytesSent;
+    counters[prefix + ".dual_messages_sent"] = peer.numDualMessagesSent;
+  }
+
+  // Max latency of publication processing stages
+  for (size_t i = 0; i < kNumPublicationStages; ++i) {
+    counters[folly::sformat("{}.{}.max", stageHistograms_[i], area_)] =
+        stageLatencyMaxUs_[i];
+  }
+
+  // Histogram of full-sync durations per peer
+  for (auto const& [peerName, stats] : peerSyncStats_) {
+    const auto prefix =
+        folly::sformat("kvstore.peer_sync_duration_ms.{}", peerName);
+    counters[prefix + ".count"] = stats.count;
+    counters[prefix + ".avg"] = stats.sumMs / stats.count;
+    counters[prefix + ".max"] = stats.maxMs;
+    counters[prefix + ".last"] = stats.lastMs;
+    for (size_t i = 0; i < stats.buckets.size(); ++i) {
+      const auto bucket = i < PeerSyncStats::kBucketBoundsMs.size()
+          ? folly::to<std::string>(PeerSyncStats::kBucketBoundsMs[i])
+          : std::string("inf");
+      counters[folly::sformat("{}.le_{}", prefix, bucket)] = stats.buckets[i];
+    }
+  }
+
+  // Occupancy of TTL countdown wheel and savings of its interned
+  // originator-ids. Values of kvStore_ keep their own copies
+  counters["kvstore.ttl_wheel.num_entries"] = ttlCountdownWheel_.size();
+  auto const& originatorIds = ttlCountdownWheel_.getOriginatorIds();
+  counters["kvstore.ttl_wheel.num_interned_originator_ids"] =
+      originatorIds.size();
+  counters["kvstore.ttl_wheel.originator_id_bytes_saved"] =
+      originatorIds.getSavedBytes();
+  const auto levelSizes = ttlCountdownWheel_.getLevelSizes();
+  for (size_t level = 0; level < levelSizes.size(); ++level) {
+    counters[folly::sformat("kvstore.ttl_wheel.level{}.num_entries", level)] =
+        levelSizes[level];
+  }
   return counters;
 }
 
@@ -1878,6 +3161,7 @@ KvStoreDb::delThriftPeers(std::vector<std::string> const& peers) {
     peerIter->second.keepAliveTimer.reset();
     peerIter->second.client.reset();
     thriftPeers_.erase(peerIter);
+    peerSyncStats_.erase(peerName);
   }
 }
 
@@ -1890,6 +3174,11 @@ KvStoreDb::delPeers(std::vector<std::string> const& peers) {
     delThriftPeers(peers);
   }
 
+  // ZMQ peers are NOT tracked with thrift only transport
+  if (not kvParams_.enableZmqTransport) {
+    return;
+  }
+
   for (auto const& peerName : peers) {
     // not currently subscribed
     auto it = peers_.find(peerName);
@@ -1911,6 +3200,7 @@ KvStoreDb::delPeers(std::vector<std::string> const& peers) {
     }
 
     peersToSyncWith_.erase(peerName);
+    peerSyncStats_.erase(peerName);
     auto const& peerCmdSocketId = it->second.second;
     if (latestSentPeerSync_.count(peerCmdSocketId)) {
       latestSentPeerSync_.erase(peerCmdSocketId);
@@ -1933,14 +3223,29 @@ KvStoreDb::requestFullSyncFromPeers() {
   // minimal timeout for next run
   auto timeout = std::chrono::milliseconds(Constants::kMaxBackoff);
 
-  // Make requests
-  for (auto it = peersToSyncWith_.begin(); it != peersToSyncWith_.end();) {
-    auto& peerName = it->first;
-    auto& expBackoff = it->second;
+  // Make requests in order of peer priority
+  std::vector<std::string> peerNames;
+  peerNames.reserve(peersToSyncWith_.size());
+  for (auto const& kv : peersToSyncWith_) {
+    peerNames.emplace_back(kv.first);
+  }
+  sortPeersForFullSync(peerNames);
+
+  for (auto const& peerName : peerNames) {
+    // if pending response is above the limit wait until kMaxBackoff before
+    // sending next sync request
+    if (latestSentPeerSync_.size() >= parallelSyncLimit_) {
+      LOG(INFO) << latestSentPeerSync_.size() << " full-sync in progress which "
+                << " is above limit: " << parallelSyncLimit_ << ". Will send "
+                << "sync request after max timeout or on receipt of sync "
+                << "response";
+      timeout = Constants::kMaxBackoff;
+      break;
+    }
 
+    auto& expBackoff = peersToSyncWith_.at(peerName);
     if (not expBackoff.canTryNow()) {
       timeout = std::min(timeout, expBackoff.getTimeRemainingUntilRetry());
-      ++it;
       continue;
     }
 
@@ -1965,6 +3270,15 @@ KvStoreDb::requestFullSyncFromPeers() {
     KvStoreFilters kvFilters{keyPrefixList, originator};
     params.keyValHashes_ref() =
         std::move(*dumpHashWithFilters(kvFilters).keyVals_ref());
+    params.hashVersion_ref() = kvParams_.hashVersion;
+
+    // advertise accepted compression codec, peer spec overrides default
+    const auto compression =
+        peers_.at(peerName).first.syncCompression_ref().value_or(
+            kvParams_.syncCompression);
+    if (compression != thrift::CompressionType::NONE) {
+      params.compression_ref() = compression;
+    }
 
     dumpRequest.cmd_ref() = thrift::Command::KEY_DUMP;
     dumpRequest.keyDumpParams_ref() = params;
@@ -1982,23 +3296,9 @@ KvStoreDb::requestFullSyncFromPeers() {
       collectSendFailureStats(ret.error(), peerCmdSocketId);
       expBackoff.reportError(); // Apply exponential backoff
       timeout = std::min(timeout, expBackoff.getTimeRemainingUntilRetry());
-      ++it;
     } else {
       latestSentPeerSync_[peerCmdSocketId] = std::chrono::steady_clock::now();
-
-      // Remove the iterator
-      it = peersToSyncWith_.erase(it);
-    }
-
-    // if pending response is above the limit wait until kMaxBackoff before
-    // sending next sync request
-    if (latestSentPeerSync_.size() >= parallelSyncLimit_) {
-      LOG(INFO) << latestSentPeerSync_.size() << " full-sync in progress which "
-                << " is above limit: " << parallelSyncLimit_ << ". Will send "
-                << "sync request after max timeout or on receipt of sync "
-                << "response";
-      timeout = Constants::kMaxBackoff;
-      break;
+      peersToSyncWith_.erase(peerName);
     }
   } // for
 
@@ -2038,26 +3338,27 @@ void
 KvStoreDb::updatePublicationTtl(
     thrift::Publication& thriftPub, bool removeAboutToExpire) {
   auto timeNow = std::chrono::steady_clock::now();
-  for (const auto& qE : ttlCountdownQueue_) {
-    // Find key and ensure we are taking time from right entry from queue
-    auto kv = thriftPub.keyVals_ref()->find(qE.key);
-    if (kv == thriftPub.keyVals_ref()->end() or
-        *kv->second.version_ref() != qE.version or
-        *kv->second.originatorId_ref() != qE.originatorId or
-        *kv->second.ttlVersion_ref() != qE.ttlVersion) {
+  auto& keyVals = *thriftPub.keyVals_ref();
+  for (auto kv = keyVals.begin(); kv != keyVals.end();) {
+    // Find entry and ensure we are taking time from right entry of the key
+    auto qE = ttlCountdownWheel_.find(kv->first);
+    if (not qE.has_value() or *kv->second.version_ref() != qE->version or
+        *kv->second.originatorId_ref() != qE->originatorId or
+        *kv->second.ttlVersion_ref() != qE->ttlVersion) {
+      ++kv;
       continue;
     }
 
     // Compute timeLeft and do sanity check on it
-    auto timeLeft = duration_cast<milliseconds>(qE.expiryTime - timeNow);
+    auto timeLeft = duration_cast<milliseconds>(qE->expiryTime - timeNow);
     if (timeLeft <= kvParams_.ttlDecr) {
-      thriftPub.keyVals_ref()->erase(kv);
+      kv = keyVals.erase(kv);
       continue;
     }
 
     // filter key from publication if time left is below ttl threshold
     if (removeAboutToExpire and timeLeft < Constants::kTtlThreshold) {
-      thriftPub.keyVals_ref()->erase(kv);
+      kv = keyVals.erase(kv);
       continue;
     }
 
@@ -2065,6 +3366,7 @@ KvStoreDb::updatePublicationTtl(
     // deterministically whenever it is exchanged between KvStores. This
     // will avoid looping of updates between stores.
     kv->second.ttl_ref() = timeLeft.count() - kvParams_.ttlDecr.count();
+    ++kv;
   }
 }
 
@@ -2107,7 +3409,10 @@ KvStoreDb::processRequestMsgHelper(
       auto& value = kv.second;
       if (value.value_ref().has_value()) {
         value.hash_ref() = generateHash(
-            *value.version_ref(), *value.originatorId_ref(), value.value_ref());
+            *value.version_ref(),
+            *value.originatorId_ref(),
+            value.value_ref(),
+            kvParams_.hashVersion);
       }
     }
 
@@ -2147,11 +3452,18 @@ KvStoreDb::processRequestMsgHelper(
         KvStoreFilters(keyPrefixList, *keyDumpParamsVal.originatorIds_ref());
     auto thriftPub = dumpAllWithFilters(keyPrefixMatch);
     if (auto keyValHashes = keyDumpParamsVal.keyValHashes_ref()) {
-      thriftPub = dumpDifference(*thriftPub.keyVals_ref(), *keyValHashes);
+      // compare and respond with hashes in scheme of requester
+      rehashKeyVals(
+          *thriftPub.keyVals_ref(),
+          keyDumpParamsVal.hashVersion_ref().value_or(
+              thrift::KvStoreHashVersion::BOOST));
+      thriftPub =
+          dumpDifference(std::move(*thriftPub.keyVals_ref()), *keyValHashes);
+      thriftPub.hashVersion_ref() = kvParams_.hashVersion;
     }
     updatePublicationTtl(thriftPub);
     // I'm the initiator, set flood-root-id
-    thriftPub.floodRootId_ref().from_optional(DualNode::getSptRootId());
+    thriftPub.floodRootId_ref().from_optional(getFloodRootId());
 
     if (keyDumpParamsVal.keyValHashes_ref() and
         (not keyDumpParamsVal.prefix_ref().has_value() or
@@ -2169,6 +3481,34 @@ KvStoreDb::processRequestMsgHelper(
                 << thriftPub.keyVals_ref()->size() << " key-vals and "
                 << numMissingKeys << " missing keys";
     }
+
+    // compress response if requested by peer
+    if (auto compression = keyDumpParamsVal.compression_ref()) {
+      const auto startTime = std::chrono::steady_clock::now();
+      auto compressed = compressPublication(
+          thriftPub, *compression, Constants::kKvStoreMinSyncCompressionSize);
+      if (compressed.has_value()) {
+        fb303::fbData->addStatValue(
+            "kvstore.sync_compression_time_us",
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - startTime)
+                .count(),
+            fb303::AVG);
+        // ratio in percentage of compressed over uncompressed size
+        fb303::fbData->addStatValue(
+            "kvstore.sync_compression_ratio",
+            100 * compressed->data_ref()->size() /
+                *compressed->uncompressedSize_ref(),
+            fb303::AVG);
+        fb303::fbData->addStatValue(
+            "kvstore.sync_compression_num_responses", 1, fb303::COUNT);
+
+        thrift::Publication compressedPub;
+        compressedPub.compressed_ref() = std::move(*compressed);
+        *compressedPub.area_ref() = *thriftPub.area_ref();
+        return fbzmq::Message::fromThriftObj(compressedPub, serializer_);
+      }
+    }
     return fbzmq::Message::fromThriftObj(thriftPub, serializer_);
   }
   case thrift::Command::DUAL: {
@@ -2315,6 +3655,17 @@ KvStoreDb::unsetChildAll(const std::string& peerName) noexcept {
   sendTopoSetCmd("" /* root-id is ignored */, peerName, false, true);
 }
 
+void
+KvStoreDb::processDiffusingComputationDone(
+    const std::string& rootId, std::chrono::microseconds duration) noexcept {
+  VLOG(1) << "dual diffusing computation of root-id (" << rootId
+          << ") completed in " << duration.count() << "us";
+  fb303::fbData->addStatValue(
+      "kvstore.dual.diffusing_computations", 1, fb303::COUNT);
+  fb303::fbData->addStatValue(
+      "kvstore.dual.diffusing_computation_us", duration.count(), fb303::AVG);
+}
+
 void
 KvStoreDb::processNexthopChange(
     const std::string& rootId,
@@ -2392,15 +3743,60 @@ KvStoreDb::processSyncResponse(
     }
   }
 
+  // Decode metadata of key-vals first if enabled. Values aren't decoded if
+  // none of them can update local store, and only missing keys of 3-way sync
+  // are retained from the response
+  folly::Expected<thrift::Publication, fbzmq::Error> maybeSyncPub =
+      folly::makeUnexpected(fbzmq::Error());
+  if (kvParams_.enableLazyValueDecode) {
+    auto maybeMeta =
+        syncPubMsg.readThriftObj<thrift::PublicationMeta>(serializer_);
+    if (maybeMeta.hasValue() and
+        not maybeMeta->compressed_ref().has_value() and
+        not mayUpdateStore(*maybeMeta->keyVals_ref())) {
+      fb303::fbData->addStatValue(
+          "kvstore.lazy_decode.num_skipped", 1, fb303::COUNT);
+      thrift::Publication syncPub;
+      syncPub.area_ref() = area_;
+      syncPub.tobeUpdatedKeys_ref().copy_from(
+          maybeMeta->tobeUpdatedKeys_ref());
+      maybeSyncPub = std::move(syncPub);
+    } else {
+      fb303::fbData->addStatValue(
+          "kvstore.lazy_decode.num_decoded", 1, fb303::COUNT);
+    }
+  }
+
   // Perform error check
-  auto maybeSyncPub =
-      syncPubMsg.readThriftObj<thrift::Publication>(serializer_);
+  if (not maybeSyncPub.hasValue()) {
+    maybeSyncPub = syncPubMsg.readThriftObj<thrift::Publication>(serializer_);
+  }
   if (maybeSyncPub.hasError()) {
     LOG(ERROR) << "Received bad response on peerSyncSock";
     return;
   }
 
-  const auto& syncPub = maybeSyncPub.value();
+  // decompress full-sync response if peer sent it compressed
+  if (auto compressed = maybeSyncPub->compressed_ref()) {
+    const auto startTime = std::chrono::steady_clock::now();
+    auto maybeDecompressedPub = decompressPublication(*compressed);
+    if (not maybeDecompressedPub.has_value()) {
+      LOG(ERROR) << "Received bad compressed response from " << requestId;
+      fb303::fbData->addStatValue(
+          "kvstore.sync_decompression_failure", 1, fb303::COUNT);
+      return;
+    }
+    fb303::fbData->addStatValue(
+        "kvstore.sync_decompression_time_us",
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count(),
+        fb303::AVG);
+    maybeSyncPub.value() = std::move(*maybeDecompressedPub);
+  }
+
+  auto& syncPub = maybeSyncPub.value();
+  processSyncResponseHashes(syncPub);
   const size_t kvUpdateCnt = mergePublication(syncPub, requestId);
   size_t numMissingKeys = 0;
 
@@ -2428,13 +3824,20 @@ KvStoreDb::processSyncResponse(
     VLOG(1) << "It took " << syncDuration.count() << " ms to sync with "
             << requestId;
     latestSentPeerSync_.erase(requestId);
+
+    for (auto const& [peerName, peer] : peers_) {
+      if (peer.second == requestId) {
+        recordPeerSyncDuration(peerName, syncDuration);
+        break;
+      }
+    }
   }
 
   // We've received a full sync response. Double the parallel sync-request
   // limit. This is under assumption that, subsequent sync request will not
   // incur huge changes.
-  parallelSyncLimit_ = std::min(
-      2 * parallelSyncLimit_, Constants::kMaxFullSyncPendingCountThreshold);
+  parallelSyncLimit_ =
+      std::min(2 * parallelSyncLimit_, kvParams_.maxParallelSync);
 
   // Schedule timeout immediately to resume sending full sync requests. If
   // no outstanding sync is required, then cancel the timeout. Cancelling
@@ -2457,6 +3860,11 @@ KvStoreDb::requestSync() {
     requestSyncTimer_->scheduleTimeout(period);
   };
 
+  if (not kvParams_.enableZmqTransport) {
+    requestThriftPeriodicSync();
+    return;
+  }
+
   if (peers_.empty()) {
     return;
   }
@@ -2486,11 +3894,9 @@ KvStoreDb::requestSync() {
   }
 }
 
-// this will poll the sockets listening to the requests
+// this will set up ZMQ peer-sync socket and poll it for sync responses
 void
-KvStoreDb::attachCallbacks() {
-  VLOG(2) << "KvStore: Registering events callbacks ...";
-
+KvStoreDb::attachZmqCallbacks() {
   const auto peersSyncSndHwm = peerSyncSock_.setSockOpt(
       ZMQ_SNDHWM, &kvParams_.zmqHwm, sizeof(kvParams_.zmqHwm));
   if (peersSyncSndHwm.hasError()) {
@@ -2547,6 +3953,16 @@ KvStoreDb::attachCallbacks() {
         drainPeerSyncSockTimer_->scheduleTimeout(std::chrono::seconds(1));
       });
   drainPeerSyncSockTimer_->scheduleTimeout(std::chrono::seconds(1));
+}
+
+// this will poll the sockets listening to the requests
+void
+KvStoreDb::attachCallbacks() {
+  VLOG(2) << "KvStore: Registering events callbacks ...";
+
+  if (kvParams_.enableZmqTransport) {
+    attachZmqCallbacks();
+  }
 
   // Perform full-sync if there are peers to sync with.
   fullSyncTimer_ = folly::AsyncTimeout::make(
@@ -2604,13 +4020,14 @@ KvStoreDb::cleanupTtlCountdownQueue() {
   std::vector<std::string> expiredKeys;
   auto now = std::chrono::steady_clock::now();
 
-  // Iterate through ttlCountdownQueue_ until the top expires in the future
-  while (not ttlCountdownQueue_.empty()) {
-    auto top = ttlCountdownQueue_.top();
-    if (top.expiryTime > now) {
-      // Nothing in queue worth evicting
-      break;
-    }
+  // Advance ttlCountdownWheel_ and purge expired entries
+  for (auto const& top : ttlCountdownWheel_.advance(now)) {
+    fb303::fbData->addStatValue(
+        "kvstore.ttl_expiry_lag_ms",
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - top.expiryTime)
+            .count(),
+        fb303::AVG);
     auto it = kvStore_.find(top.key);
     if (it != kvStore_.end() and *it->second.version_ref() == top.version and
         *it->second.originatorId_ref() == top.originatorId and
@@ -2629,17 +4046,15 @@ KvStoreDb::cleanupTtlCountdownQueue() {
                  kvParams_.nodeId,
                  area_);
       logKvEvent("KEY_EXPIRE", top.key);
+      if (hashTree_.has_value()) {
+        hashTree_->update(top.key, it->second.hash_ref().to_optional(), {});
+      }
       kvStore_.erase(it);
     }
-    ttlCountdownQueue_.pop();
   }
 
-  // Reschedule based on most recent timeout
-  if (not ttlCountdownQueue_.empty()) {
-    ttlCountdownTimer_->scheduleTimeout(
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            ttlCountdownQueue_.top().expiryTime - now));
-  }
+  // Reschedule based on next tick of the wheel
+  scheduleTtlCountdownTimer();
 
   if (expiredKeys.empty()) {
     // no key expires
@@ -2676,6 +4091,212 @@ KvStoreDb::bufferPublication(thrift::Publication&& publication) {
   }
 }
 
+thrift::Publication
+KvStoreDb::extractPriorityPublication(thrift::Publication& publication) const {
+  thrift::Publication priorityPublication;
+  *priorityPublication.area_ref() = *publication.area_ref();
+  priorityPublication.nodeIds_ref().copy_from(publication.nodeIds_ref());
+  priorityPublication.floodRootId_ref().copy_from(
+      publication.floodRootId_ref());
+  if (kvParams_.priorityFloodKeyPrefixes.empty()) {
+    return priorityPublication;
+  }
+
+  const auto isPriorityKey = [this](std::string const& key) {
+    for (auto const& prefix : kvParams_.priorityFloodKeyPrefixes) {
+      if (key.compare(0, prefix.size(), prefix) == 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto& keyVals = *publication.keyVals_ref();
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    if (isPriorityKey(it->first)) {
+      priorityPublication.keyVals_ref()->emplace(
+          it->first, std::move(it->second));
+      it = keyVals.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  auto& expiredKeys = *publication.expiredKeys_ref();
+  auto expiredIt = std::stable_partition(
+      expiredKeys.begin(), expiredKeys.end(), [&](std::string const& key) {
+        return not isPriorityKey(key);
+      });
+  std::move(
+      expiredIt,
+      expiredKeys.end(),
+      std::back_inserter(*priorityPublication.expiredKeys_ref()));
+  expiredKeys.erase(expiredIt, expiredKeys.end());
+  return priorityPublication;
+}
+
+void
+KvStoreDb::floodPendingTtlRefreshes() {
+  thrift::Publication publication;
+  *publication.area_ref() = area_;
+  for (auto& [key, value] : pendingTtlRefreshes_) {
+    // skip TTL refresh superseded by a value update within the window
+    auto it = kvStore_.find(key);
+    if (it == kvStore_.end() or
+        *it->second.version_ref() != *value.version_ref() or
+        *it->second.originatorId_ref() != *value.originatorId_ref() or
+        *it->second.ttlVersion_ref() != *value.ttlVersion_ref()) {
+      continue;
+    }
+    publication.keyVals_ref()->emplace(key, std::move(value));
+  }
+  pendingTtlRefreshes_.clear();
+
+  if (publication.keyVals_ref()->empty()) {
+    return;
+  }
+  fb303::fbData->addStatValue(
+      folly::sformat("kvstore.ttl_refresh_batch_size.{}", area_),
+      publication.keyVals_ref()->size(),
+      fb303::AVG);
+  fb303::fbData->addStatValue(
+      folly::sformat("kvstore.ttl_refresh_batches.{}", area_),
+      1,
+      fb303::COUNT);
+  floodPublication(std::move(publication));
+}
+
+void
+KvStoreDb::recordStageLatency(
+    PublicationStage stage, std::chrono::steady_clock::time_point startTime) {
+  const auto idx = static_cast<size_t>(stage);
+  const int64_t latencyUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - startTime)
+          .count();
+  fb303::fbData->addHistogramValue(stageHistograms_[idx], latencyUs);
+  stageLatencyMaxUs_[idx] = std::max(stageLatencyMaxUs_[idx], latencyUs);
+}
+
+std::string
+KvStoreDb::getSnapshotFilePath() const {
+  return folly::sformat(
+      "{}/kvstore_{}.snapshot", kvParams_.snapshotDir.value(), area_);
+}
+
+void
+KvStoreDb::writeSnapshot() {
+  const auto startTime = std::chrono::steady_clock::now();
+
+  thrift::KvStoreSnapshot snapshot;
+  snapshot.area_ref() = area_;
+  snapshot.timestampMs_ref() = getUnixTimeStampMs();
+  snapshot.hashVersion_ref() = kvParams_.hashVersion;
+  auto& keyVals = *snapshot.keyVals_ref();
+  for (auto const& [key, val] : kvStore_) {
+    int64_t ttl = Constants::kTtlInfinity;
+    if (*val.ttl_ref() != Constants::kTtlInfinity) {
+      auto entry = ttlCountdownWheel_.find(key);
+      if (not entry.has_value() or entry->expiryTime <= startTime) {
+        // about to expire
+        continue;
+      }
+      ttl = std::chrono::ceil<std::chrono::milliseconds>(
+                entry->expiryTime - startTime)
+                .count();
+    }
+    keyVals.emplace(key, val).first->second.ttl_ref() = ttl;
+  }
+
+  const auto filePath = getSnapshotFilePath();
+  try {
+    // write the encoded chain out as is, snapshot of a large store is big
+    auto buf = writeThriftObj(snapshot, serializer_);
+    auto iov = buf->getIov();
+    folly::writeFileAtomic(filePath, iov.data(), iov.size(), 0644);
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to write KvStore snapshot of area " << area_
+               << " to " << filePath << ". Error: " << folly::exceptionStr(e);
+    fb303::fbData->addStatValue(
+        "kvstore.snapshot.write_failure", 1, fb303::COUNT);
+    return;
+  }
+
+  fb303::fbData->addStatValue(
+      "kvstore.snapshot.num_keys_written", keyVals.size(), fb303::AVG);
+  fb303::fbData->addStatValue(
+      "kvstore.snapshot.write_time_ms",
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - startTime)
+          .count(),
+      fb303::AVG);
+}
+
+void
+KvStoreDb::loadSnapshot() {
+  const auto filePath = getSnapshotFilePath();
+  folly::File file;
+  try {
+    file = folly::File(filePath);
+  } catch (std::system_error const& e) {
+    LOG(INFO) << "No KvStore snapshot of area " << area_ << " at "
+              << filePath << ". Starting with empty store";
+    return;
+  }
+
+  thrift::KvStoreSnapshot snapshot;
+  try {
+    // deserialize straight off the mapped file
+    folly::MemoryMapping mapping(std::move(file));
+    auto buf = folly::IOBuf::wrapBufferAsValue(mapping.range());
+    snapshot = readThriftObj<thrift::KvStoreSnapshot>(buf, serializer_);
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to load KvStore snapshot of area " << area_
+               << " from " << filePath << ". Error: " << folly::exceptionStr(e);
+    fb303::fbData->addStatValue(
+        "kvstore.snapshot.load_failure", 1, fb303::COUNT);
+    return;
+  }
+  if (*snapshot.area_ref() != area_) {
+    LOG(ERROR) << "Ignoring KvStore snapshot of area " << *snapshot.area_ref()
+               << " at " << filePath;
+    fb303::fbData->addStatValue(
+        "kvstore.snapshot.load_failure", 1, fb303::COUNT);
+    return;
+  }
+
+  // ATTN: keys originated by this node are skipped. They are re-advertised by
+  //       their owners, and might have been withdrawn while we were down
+  const int64_t elapsedMs =
+      std::max<int64_t>(0, getUnixTimeStampMs() - *snapshot.timestampMs_ref());
+  // hashes are regenerated on merge if hash scheme changed since the snapshot
+  const bool isSameHashVersion =
+      snapshot.hashVersion_ref().value_or(thrift::KvStoreHashVersion::BOOST) ==
+      kvParams_.hashVersion;
+  thrift::Publication publication;
+  publication.area_ref() = area_;
+  for (auto& [key, val] : *snapshot.keyVals_ref()) {
+    if (*val.originatorId_ref() == kvParams_.nodeId) {
+      continue;
+    }
+    if (not isSameHashVersion) {
+      val.hash_ref().reset();
+    }
+    if (*val.ttl_ref() != Constants::kTtlInfinity) {
+      const int64_t ttl = *val.ttl_ref() - elapsedMs;
+      if (ttl <= kvParams_.ttlDecr.count()) {
+        continue;
+      }
+      val.ttl_ref() = ttl;
+    }
+    publication.keyVals_ref()->emplace(key, std::move(val));
+  }
+
+  const auto numLoaded = mergePublication(publication);
+  LOG(INFO) << "Loaded " << numLoaded << " key-vals of area " << area_
+            << " from KvStore snapshot taken " << elapsedMs << "ms ago";
+  fb303::fbData->addStatValue(
+      "kvstore.snapshot.num_keys_loaded", numLoaded, fb303::SUM);
+}
+
 void
 KvStoreDb::floodBufferedUpdates() {
   if (!publicationBuffer_.size()) {
@@ -2740,7 +4361,7 @@ KvStoreDb::finalizeFullSync(
   *params.keyVals_ref() = std::move(*updates.keyVals_ref());
   params.solicitResponse_ref() = false;
   // I'm the initiator, set flood-root-id
-  params.floodRootId_ref().from_optional(DualNode::getSptRootId());
+  params.floodRootId_ref().from_optional(getFloodRootId());
   params.timestamp_ms_ref() = getUnixTimeStampMs();
 
   updateRequest.cmd_ref() = thrift::Command::KEY_SET;
@@ -2821,6 +4442,23 @@ KvStoreDb::finalizeFullSync(
 std::unordered_set<std::string>
 KvStoreDb::getFloodPeers(const std::optional<std::string>& rootId) {
   auto sptPeers = DualNode::getSptPeers(rootId);
+  if (kvParams_.enableFloodBackupTree and rootId.has_value()) {
+    auto& backupPeers = backupFloodPeers_[*rootId];
+    if (not sptPeers.empty()) {
+      // remember formed SPT as backup for re-convergence
+      if (backupPeers != sptPeers) {
+        backupPeers = sptPeers;
+      }
+    } else if (not isBackupFloodTreeBroken(*rootId)) {
+      // SPT in flux, keep flooding along backup tree as long as it's intact
+      sptPeers = backupPeers;
+      if (not sptPeers.empty()) {
+        fb303::fbData->addStatValue(
+            "kvstore.flood_fanout.num_backup_tree", 1, fb303::COUNT);
+      }
+    }
+  }
+
   bool floodToAll = false;
   if (not kvParams_.enableFloodOptimization or sptPeers.empty()) {
     // fall back to naive flooding if feature not enabled or can not find
@@ -2840,6 +4478,37 @@ KvStoreDb::getFloodPeers(const std::optional<std::string>& rootId) {
   return floodPeers;
 }
 
+bool
+KvStoreDb::isBackupFloodTreeBroken(const std::string& rootId) {
+  if (not kvParams_.enableFloodBackupTree or
+      not DualNode::getSptPeers(rootId).empty()) {
+    return false;
+  }
+  auto it = backupFloodPeers_.find(rootId);
+  if (it == backupFloodPeers_.end()) {
+    return false;
+  }
+  for (auto const& peer : it->second) {
+    if (not peers_.count(peer)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::optional<std::string>
+KvStoreDb::getFloodRootId() {
+  auto rootId = DualNode::getSptRootId();
+  if (not kvParams_.enableFloodBackupTree) {
+    return rootId;
+  }
+  if (rootId.has_value()) {
+    lastSptRootId_ = rootId;
+    return rootId;
+  }
+  return lastSptRootId_;
+}
+
 void
 KvStoreDb::collectSendFailureStats(
     const fbzmq::Error& error, const std::string& dstSockId) {
@@ -2852,21 +4521,42 @@ KvStoreDb::collectSendFailureStats(
 void
 KvStoreDb::floodPublication(
     thrift::Publication&& publication, bool rateLimit, bool setFloodRoot) {
+  FOLLY_SDT(
+      openr,
+      kvstore_flood_publication_entry,
+      area_.c_str(),
+      publication.keyVals_ref()->size());
+  SCOPE_EXIT {
+    FOLLY_SDT(openr, kvstore_flood_publication_return, area_.c_str());
+  };
   // rate limit if configured
   if (floodLimiter_ && rateLimit && !floodLimiter_->consume(1)) {
-    bufferPublication(std::move(publication));
-    pendingPublicationTimer_->scheduleTimeout(
-        Constants::kFloodPendingPublication);
-    return;
-  }
-  // merge with buffered publication and flood
-  if (publicationBuffer_.size()) {
+    // keys of priority prefixes are flooded right away, only remaining ones
+    // wait for the rate limiter
+    auto priorityPublication = extractPriorityPublication(publication);
+    if (publication.keyVals_ref()->size() or
+        publication.expiredKeys_ref()->size()) {
+      bufferPublication(std::move(publication));
+      pendingPublicationTimer_->scheduleTimeout(
+          Constants::kFloodPendingPublication);
+    }
+    if (priorityPublication.keyVals_ref()->empty() and
+        priorityPublication.expiredKeys_ref()->empty()) {
+      return;
+    }
+    fb303::fbData->addStatValue(
+        "kvstore.rate_limit_priority_bypass", 1, fb303::COUNT);
+    publication = std::move(priorityPublication);
+  } else if (publicationBuffer_.size()) {
+    // merge with buffered publication and flood
     bufferPublication(std::move(publication));
     return floodBufferedUpdates();
   }
   // Update ttl on keys we are trying to advertise. Also remove keys which
   // are about to expire.
+  const auto ttlStartTime = std::chrono::steady_clock::now();
   updatePublicationTtl(publication, true);
+  recordStageLatency(PublicationStage::TTL_UPDATE, ttlStartTime);
 
   // If there are no changes then return
   if (publication.keyVals_ref()->empty() &&
@@ -2887,17 +4577,32 @@ KvStoreDb::floodPublication(
   }
   publication.nodeIds_ref()->emplace_back(kvParams_.nodeId);
 
-  // Flood publication to internal subscribers
-  kvParams_.kvStoreUpdatesQueue.push(publication);
+  // prepare thrift structure for flooding purpose. This has to be done
+  // before publication is handed over to internal subscribers
+  thrift::KvStoreRequest floodRequest;
+  thrift::KeySetParams params;
+  const bool floodToPeers = not publication.keyVals_ref()->empty();
+  if (floodToPeers) {
+    *params.keyVals_ref() = *publication.keyVals_ref();
+    params.nodeIds_ref().copy_from(publication.nodeIds_ref());
+    params.floodRootId_ref().copy_from(publication.floodRootId_ref());
+  }
+
+  // Flood publication to internal subscribers. Publication is moved into the
+  // immutable copy shared by all readers
+  const auto pushStartTime = std::chrono::steady_clock::now();
+  kvParams_.kvStoreUpdatesQueue.push(
+      std::make_shared<const thrift::Publication>(std::move(publication)));
+  recordStageLatency(PublicationStage::QUEUE_PUSH, pushStartTime);
   fb303::fbData->addStatValue("kvstore.num_updates", 1, fb303::COUNT);
 
   // Flood keyValue ONLY updates to external neighbors
-  if (publication.keyVals_ref()->empty()) {
+  if (not floodToPeers) {
     return;
   }
 
   // Key collection to be flooded
-  auto keysToUpdate = folly::gen::from(*publication.keyVals_ref()) |
+  auto keysToUpdate = folly::gen::from(*params.keyVals_ref()) |
       folly::gen::get<0>() | folly::gen::as<std::vector<std::string>>();
 
   VLOG(2) << "Flood publication from: " << kvParams_.nodeId
@@ -2906,33 +4611,84 @@ KvStoreDb::floodPublication(
 
   if (setFloodRoot and not senderId.has_value()) {
     // I'm the initiator, set flood-root-id
-    publication.floodRootId_ref().from_optional(DualNode::getSptRootId());
+    params.floodRootId_ref().from_optional(getFloodRootId());
   }
 
-  // prepare thrift structure for flooding purpose
-  thrift::KvStoreRequest floodRequest;
-  thrift::KeySetParams params;
+  // Backup tree with a peer down doesn't span all nodes anymore. Drop
+  // flood-root-id so that downstream nodes flood to all their peers as well
+  if (params.floodRootId_ref().has_value() and
+      isBackupFloodTreeBroken(*params.floodRootId_ref())) {
+    fb303::fbData->addStatValue(
+        "kvstore.flood_fanout.num_backup_tree_broken", 1, fb303::COUNT);
+    params.floodRootId_ref().reset();
+  }
 
-  *params.keyVals_ref() = *publication.keyVals_ref();
   // TODO: remove solicit response when all KEY_SET request is over thrift
   params.solicitResponse_ref() = false;
-  params.nodeIds_ref().copy_from(publication.nodeIds_ref());
-  params.floodRootId_ref().copy_from(publication.floodRootId_ref());
   params.timestamp_ms_ref() = getUnixTimeStampMs();
 
+  // thrift peers are flooded with `params` directly, skip copying them
   floodRequest.cmd_ref() = thrift::Command::KEY_SET;
-  floodRequest.keySetParams_ref() = params;
+  if (not kvParams_.enableKvStoreThrift) {
+    floodRequest.keySetParams_ref() = params;
+  }
   *floodRequest.area_ref() = area_;
 
+  // Delta-encode updated values against previously flooded ones. Delta is
+  // used only if it saves at-least half of the bytes
+  std::optional<thrift::KeySetParams> deltaParams;
+  for (auto const& [key, value] : *params.keyVals_ref()) {
+    auto baseIt = deltaBases_.find(key);
+    if (baseIt == deltaBases_.end()) {
+      continue;
+    }
+    auto base = std::move(baseIt->second);
+    deltaBases_.erase(baseIt);
+    if (not value.value_ref().has_value() or
+        value.value_ref()->size() < Constants::kKvStoreMinDeltaValueSize) {
+      continue;
+    }
+
+    auto delta = createValueDelta(
+        *base.value_ref(), *value.value_ref(), *base.hash_ref());
+    if (delta.data_ref()->size() * 2 >= value.value_ref()->size()) {
+      continue;
+    }
+    fb303::fbData->addStatValue("kvstore.value_delta.num_sent", 1, fb303::SUM);
+    fb303::fbData->addStatValue(
+        "kvstore.value_delta.bytes_saved",
+        value.value_ref()->size() - delta.data_ref()->size(),
+        fb303::SUM);
+    if (not deltaParams.has_value()) {
+      deltaParams = params;
+    }
+    auto& deltaValue = deltaParams->keyVals_ref()->at(key);
+    deltaValue.value_ref().reset();
+    deltaValue.valueDelta_ref() = std::move(delta);
+  }
+  auto const& thriftParams = deltaParams.has_value() ? *deltaParams : params;
+
   std::optional<std::string> floodRootId{std::nullopt};
   if (params.floodRootId_ref().has_value()) {
     floodRootId = params.floodRootId_ref().value();
   }
   const auto& floodPeers = getFloodPeers(floodRootId);
+  fb303::fbData->addStatValue(
+      "kvstore.flood_fanout.actual", floodPeers.size(), fb303::SUM);
+  fb303::fbData->addStatValue(
+      "kvstore.flood_fanout.full_mesh", peers_.size(), fb303::SUM);
+  if (floodPeers.size() == peers_.size()) {
+    fb303::fbData->addStatValue(
+        "kvstore.flood_fanout.num_flood_to_all", 1, fb303::COUNT);
+  }
 
   // ATTN: KvStore maintains different ways of flooding mechanism.
   //  1) Over thrift peer connection;
   //  2) Over ZMQ socket;
+  const auto sendStartTime = std::chrono::steady_clock::now();
+  SCOPE_EXIT {
+    recordStageLatency(PublicationStage::PEER_SEND, sendStartTime);
+  };
   if (kvParams_.enableKvStoreThrift) {
     for (const auto& peerName : floodPeers) {
       auto peerIt = thriftPeers_.find(peerName);
@@ -2955,47 +4711,11 @@ KvStoreDb::floodPublication(
         continue;
       }
 
-      // record telemetry for flooding publications
-      fb303::fbData->addStatValue(
-          "kvstore.thrift.num_flood_pub", 1, fb303::COUNT);
-      fb303::fbData->addStatValue(
-          "kvstore.thrift.num_flood_key_vals",
-          publication.keyVals_ref()->size(),
-          fb303::SUM);
-
-      auto startTime = std::chrono::steady_clock::now();
-      auto sf = thriftPeer.client->semifuture_setKvStoreKeyVals(params, area_);
-      std::move(sf)
-          .via(evb_->getEvb())
-          .thenValue([peerName, startTime](folly::Unit&&) {
-            VLOG(4) << "Flooding ack received from peer: " << peerName;
-
-            auto endTime = std::chrono::steady_clock::now();
-            auto timeDelta =
-                std::chrono::duration_cast<std::chrono::milliseconds>(
-                    endTime - startTime);
-
-            // record telemetry for thrift calls
-            fb303::fbData->addStatValue(
-                "kvstore.thrift.num_flood_pub_success", 1, fb303::COUNT);
-            fb303::fbData->addStatValue(
-                "kvstore.thrift.flood_pub_duration_ms",
-                timeDelta.count(),
-                fb303::AVG);
-          })
-          .thenError(
-              [this, peerName, startTime](const folly::exception_wrapper& ew) {
-                // state transition to IDLE
-                auto endTime = std::chrono::steady_clock::now();
-                auto timeDelta =
-                    std::chrono::duration_cast<std::chrono::milliseconds>(
-                        endTime - startTime);
-                processThriftFailure(peerName, ew.what(), timeDelta);
-
-                // record telemetry for thrift calls
-                fb303::fbData->addStatValue(
-                    "kvstore.thrift.num_flood_pub_failure", 1, fb303::COUNT);
-              });
+      // ATTN: delta refers to hash of base value in our hash scheme
+      floodToThriftPeer(
+          peerName,
+          thriftPeer.hashVersion == kvParams_.hashVersion ? thriftParams
+                                                          : params);
     }
   } else {
     for (const auto& peer : floodPeers) {
@@ -3010,9 +4730,7 @@ KvStoreDb::floodPublication(
 
       fb303::fbData->addStatValue("kvstore.sent_publications", 1, fb303::COUNT);
       fb303::fbData->addStatValue(
-          "kvstore.sent_key_vals",
-          publication.keyVals_ref()->size(),
-          fb303::SUM);
+          "kvstore.sent_key_vals", params.keyVals_ref()->size(), fb303::SUM);
 
       // Send flood request
       auto const& peerCmdSocketId = peers_.at(peer).second;
@@ -3028,6 +4746,265 @@ KvStoreDb::floodPublication(
   }
 }
 
+void
+KvStoreDb::floodToThriftPeer(
+    std::string const& peerName, thrift::KeySetParams const& params) {
+  auto& thriftPeer = thriftPeers_.at(peerName);
+
+  // queue key-vals behind the request in flight. Peer is slow to ack, hence
+  // collapse updates of same key and bound the bytes queued
+  if (thriftPeer.numFloodsInFlight >= kvParams_.maxFloodsInFlight) {
+    auto getBytes = [](thrift::Value const& value) {
+      return value.value_ref().has_value() ? value.value_ref()->size() : 0;
+    };
+    for (auto const& [key, value] : *params.keyVals_ref()) {
+      auto [it, inserted] = thriftPeer.floodQueue.try_emplace(key);
+      if (inserted) {
+        thriftPeer.floodQueueBytes += key.size();
+      } else {
+        fb303::fbData->addStatValue(
+            "kvstore.flood_queue.num_collapsed", 1, fb303::SUM);
+        auto& queued = it->second;
+        // TTL refresh of the queued version only bumps its TTL, value of
+        // queued update must still reach peer
+        if (not value.value_ref().has_value() and
+            *queued.version_ref() == *value.version_ref() and
+            *queued.originatorId_ref() == *value.originatorId_ref()) {
+          queued.ttl_ref() = *value.ttl_ref();
+          queued.ttlVersion_ref() =
+              std::max(*queued.ttlVersion_ref(), *value.ttlVersion_ref());
+          continue;
+        }
+        thriftPeer.floodQueueBytes -= getBytes(queued);
+      }
+      // ATTN: delta-encoded value is replaced by the full value from local
+      //       store as the delta is not against what peer will have. So is
+      //       TTL refresh, peer might not have the version it refreshes
+      auto kvIt = kvStore_.find(key);
+      it->second = ((value.valueDelta_ref().has_value() or
+                     not value.value_ref().has_value()) and
+                    kvIt != kvStore_.end())
+          ? kvIt->second
+          : value;
+      thriftPeer.floodQueueBytes += getBytes(it->second);
+    }
+    thriftPeer.floodQueueRootId = params.floodRootId_ref().to_optional();
+
+    if (thriftPeer.floodQueueBytes > kvParams_.floodQueueMaxBytes) {
+      // peer can't keep up. Drop queued updates and re-sync from scratch
+      LOG(WARNING) << "[Thrift Flood] Flood queue of peer: " << peerName
+                   << " overflowed with " << thriftPeer.floodQueueBytes
+                   << " bytes. Dropping " << thriftPeer.floodQueue.size()
+                   << " queued key-vals and re-syncing with peer.";
+      fb303::fbData->addStatValue(
+          "kvstore.flood_queue.num_dropped",
+          thriftPeer.floodQueue.size(),
+          fb303::SUM);
+      fb303::fbData->addStatValue(
+          "kvstore.flood_queue.num_overflows", 1, fb303::COUNT);
+      thriftPeer.numFloodQueueDrops += thriftPeer.floodQueue.size();
+      processThriftFailure(
+          peerName, "flood queue overflow", std::chrono::milliseconds(0));
+    }
+    return;
+  }
+
+  // record telemetry for flooding publications
+  fb303::fbData->addStatValue("kvstore.thrift.num_flood_pub", 1, fb303::COUNT);
+  fb303::fbData->addStatValue(
+      "kvstore.thrift.num_flood_key_vals",
+      params.keyVals_ref()->size(),
+      fb303::SUM);
+
+  thriftPeer.numFloodKeyValsSent += params.keyVals_ref()->size();
+  for (auto const& [key, value] : *params.keyVals_ref()) {
+    thriftPeer.numFloodBytesSent += key.size() +
+        (value.value_ref().has_value() ? value.value_ref()->size() : 0);
+  }
+
+  // requests are pipelined on the channel of client. Peer merges key-vals
+  // by version, hence order of processing doesn't matter
+  ++thriftPeer.numFloodsInFlight;
+  const auto clientId = thriftPeer.clientId;
+
+  auto startTime = std::chrono::steady_clock::now();
+  auto sf = thriftPeer.client->semifuture_setKvStoreKeyVals(params, area_);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue([this, peerName, startTime, clientId](folly::Unit&&) {
+        VLOG(4) << "Flooding ack received from peer: " << peerName;
+
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
+
+        // record telemetry for thrift calls
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_flood_pub_success", 1, fb303::COUNT);
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.flood_pub_duration_ms",
+            timeDelta.count(),
+            fb303::AVG);
+
+        // send updates queued meanwhile. Ignore stale acks of client which
+        // has been reset in the meantime
+        auto peerIt = thriftPeers_.find(peerName);
+        if (peerIt == thriftPeers_.end() or
+            peerIt->second.clientId != clientId) {
+          return;
+        }
+        auto& peer = peerIt->second;
+        --peer.numFloodsInFlight;
+        peer.floodRttMs = peer.floodRttMs
+            ? (7 * peer.floodRttMs + timeDelta.count()) / 8
+            : timeDelta.count();
+        floodQueuedKeyVals(peerName);
+      })
+      .thenError([this, peerName, startTime, clientId](
+                     const folly::exception_wrapper& ew) {
+        // record telemetry for thrift calls
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_flood_pub_failure", 1, fb303::COUNT);
+
+        // other requests pipelined on the same client fail as well, process
+        // failure only once
+        auto peerIt = thriftPeers_.find(peerName);
+        if (peerIt == thriftPeers_.end() or
+            peerIt->second.clientId != clientId) {
+          return;
+        }
+
+        // state transition to IDLE
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
+        processThriftFailure(peerName, ew.what(), timeDelta);
+      });
+}
+
+void
+KvStoreDb::floodQueuedKeyVals(std::string const& peerName) {
+  auto& thriftPeer = thriftPeers_.at(peerName);
+  if (thriftPeer.floodQueue.empty() or
+      thriftPeer.state != KvStorePeerState::INITIALIZED or
+      (not thriftPeer.client)) {
+    return;
+  }
+
+  // ATTN: I'm the sender of collapsed updates. TTLs are refreshed as updates
+  //       might have been queued for a while
+  thrift::Publication publication;
+  *publication.keyVals_ref() = std::move(thriftPeer.floodQueue);
+  updatePublicationTtl(publication, true);
+  thriftPeer.floodQueue.clear();
+  thriftPeer.floodQueueBytes = 0;
+  if (publication.keyVals_ref()->empty()) {
+    return;
+  }
+
+  thrift::KeySetParams params;
+  *params.keyVals_ref() = std::move(*publication.keyVals_ref());
+  params.solicitResponse_ref() = false;
+  params.nodeIds_ref() = std::vector<std::string>{kvParams_.nodeId};
+  params.floodRootId_ref().from_optional(thriftPeer.floodQueueRootId);
+  params.timestamp_ms_ref() = getUnixTimeStampMs();
+  floodToThriftPeer(peerName, params);
+}
+
+bool
+KvStoreDb::mayUpdateStore(
+    std::map<std::string, thrift::ValueMeta> const& keyVals) const {
+  // ATTN: mirrors the order of checks in `mergeKeyValues`
+  for (auto const& [key, meta] : keyVals) {
+    auto it = kvStore_.find(key);
+    if (it == kvStore_.end()) {
+      return true;
+    }
+    auto const& value = it->second;
+    if (*meta.version_ref() != *value.version_ref()) {
+      if (*meta.version_ref() > *value.version_ref()) {
+        return true;
+      }
+      continue;
+    }
+    if (*meta.originatorId_ref() != *value.originatorId_ref()) {
+      if (*meta.originatorId_ref() > *value.originatorId_ref()) {
+        return true;
+      }
+      continue;
+    }
+    if (*meta.ttlVersion_ref() > *value.ttlVersion_ref()) {
+      return true;
+    }
+    // same version and originator, value can only be told apart by hash
+    if (not meta.hash_ref().has_value() or not value.hash_ref().has_value() or
+        *meta.hash_ref() != *value.hash_ref()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t
+KvStoreDb::eraseUnchangedKeyVals(thrift::KeyVals& keyVals) const {
+  size_t numErased{0};
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    auto const& value = it->second;
+    auto kvIt = kvStore_.find(it->first);
+    if (kvIt != kvStore_.end() and value.value_ref().has_value() and
+        value.hash_ref().has_value() and
+        kvIt->second.hash_ref().has_value() and
+        *value.hash_ref() == *kvIt->second.hash_ref() and
+        *value.version_ref() == *kvIt->second.version_ref() and
+        *value.originatorId_ref() == *kvIt->second.originatorId_ref() and
+        *value.ttlVersion_ref() <= *kvIt->second.ttlVersion_ref()) {
+      it = keyVals.erase(it);
+      ++numErased;
+    } else {
+      ++it;
+    }
+  }
+  return numErased;
+}
+
+std::optional<folly::Expected<fbzmq::Message, fbzmq::Error>>
+KvStoreDb::processRedundantKeySet(thrift::KeySetParamsMeta const& params) {
+  if (params.keyVals_ref()->empty() or mayUpdateStore(*params.keyVals_ref())) {
+    fb303::fbData->addStatValue(
+        "kvstore.lazy_decode.num_decoded", 1, fb303::COUNT);
+    return std::nullopt;
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.lazy_decode.num_skipped", 1, fb303::COUNT);
+
+  // account request the same way as if it was fully processed
+  fb303::fbData->addStatValue("kvstore.cmd_key_set", 1, fb303::COUNT);
+  if (params.timestamp_ms_ref().has_value()) {
+    auto floodMs = getUnixTimeStampMs() - params.timestamp_ms_ref().value();
+    if (floodMs > 0) {
+      fb303::fbData->addStatValue(
+          "kvstore.flood_duration_ms", floodMs, fb303::AVG);
+    }
+  }
+  fb303::fbData->addStatValue("kvstore.received_publications", 1, fb303::COUNT);
+  fb303::fbData->addStatValue(
+      "kvstore.received_key_vals", params.keyVals_ref()->size(), fb303::SUM);
+  const auto nodeIds = params.nodeIds_ref();
+  if (nodeIds.has_value() and
+      std::find(nodeIds->begin(), nodeIds->end(), kvParams_.nodeId) !=
+          nodeIds->end()) {
+    fb303::fbData->addStatValue("kvstore.looped_publications", 1, fb303::COUNT);
+  } else {
+    fb303::fbData->addStatValue(
+        "kvstore.received_redundant_publications", 1, fb303::COUNT);
+  }
+
+  if (*params.solicitResponse_ref()) {
+    return fbzmq::Message::from(Constants::kSuccessResponse.toString());
+  }
+  return fbzmq::Message();
+}
+
 size_t
 KvStoreDb::mergePublication(
     const thrift::Publication& rcvdPublication,
@@ -3057,10 +5034,44 @@ KvStoreDb::mergePublication(
     return 0;
   }
 
+  // Snapshot hashes of existing keys being updated to maintain hash-tree
+  std::unordered_map<std::string, std::optional<int64_t>> oldHashes;
+  if (hashTree_.has_value()) {
+    for (auto const& [key, _] : *rcvdPublication.keyVals_ref()) {
+      auto it = kvStore_.find(key);
+      if (it != kvStore_.end()) {
+        oldHashes.emplace(key, it->second.hash_ref().to_optional());
+      }
+    }
+  }
+
+  // Snapshot existing values being updated as base for delta-encoding
+  std::unordered_map<std::string, thrift::Value> deltaBaseCandidates;
+  if (kvParams_.enableValueDelta) {
+    for (auto const& [key, value] : *rcvdPublication.keyVals_ref()) {
+      if (not value.value_ref().has_value() or not isDeltaEncodedKey(key) or
+          deltaBases_.count(key)) {
+        continue;
+      }
+      auto it = kvStore_.find(key);
+      if (it != kvStore_.end() and it->second.value_ref().has_value() and
+          it->second.hash_ref().has_value()) {
+        deltaBaseCandidates.emplace(key, it->second);
+      }
+    }
+  }
+
   // Generate delta with local KvStore
+  const auto mergeStartTime = std::chrono::steady_clock::now();
   thrift::Publication deltaPublication;
-  *deltaPublication.keyVals_ref() = KvStore::mergeKeyValues(
-      kvStore_, *rcvdPublication.keyVals_ref(), kvParams_.filters);
+  *deltaPublication.keyVals_ref() = KvStore::mergeKeyValuesSharded(
+      kvStore_,
+      *rcvdPublication.keyVals_ref(),
+      kvParams_.filters,
+      mergeExecutor_.get(),
+      kvParams_.mergeShards,
+      kvParams_.hashVersion);
+  recordStageLatency(PublicationStage::MERGE, mergeStartTime);
   deltaPublication.floodRootId_ref().copy_from(
       rcvdPublication.floodRootId_ref());
   *deltaPublication.area_ref() = area_;
@@ -3069,6 +5080,27 @@ KvStoreDb::mergePublication(
   fb303::fbData->addStatValue(
       "kvstore.updated_key_vals", kvUpdateCnt, fb303::SUM);
 
+  // Retain base of updated values until they are flooded. ATTN: base of a key
+  // which has not been flooded yet(e.g. buffered) is NOT overridden
+  for (auto& [key, base] : deltaBaseCandidates) {
+    auto it = deltaPublication.keyVals_ref()->find(key);
+    if (it != deltaPublication.keyVals_ref()->end() and
+        it->second.value_ref().has_value()) {
+      deltaBases_.emplace(key, std::move(base));
+    }
+  }
+
+  // Apply updated values to hash-tree index. TTL updates are no-op
+  if (hashTree_.has_value()) {
+    for (auto const& [key, _] : *deltaPublication.keyVals_ref()) {
+      auto oldIt = oldHashes.find(key);
+      hashTree_->update(
+          key,
+          oldIt != oldHashes.end() ? oldIt->second : std::nullopt,
+          kvStore_.at(key).hash_ref().to_optional());
+    }
+  }
+
   // Populate nodeIds and our nodeId_ to the end
   if (rcvdPublication.nodeIds_ref().has_value()) {
     deltaPublication.nodeIds_ref().copy_from(rcvdPublication.nodeIds_ref());
@@ -3077,7 +5109,23 @@ KvStoreDb::mergePublication(
   // Update ttl values of keys
   updateTtlCountdownQueue(deltaPublication);
 
-  if (not deltaPublication.keyVals_ref()->empty()) {
+  // TTL refreshes of local keys are coalesced and flooded in one batch
+  const bool isLocalTtlRefresh = ttlRefreshTimer_ and
+      not senderId.has_value() and
+      not rcvdPublication.nodeIds_ref().has_value() and
+      std::none_of(
+          deltaPublication.keyVals_ref()->cbegin(),
+          deltaPublication.keyVals_ref()->cend(),
+          [](auto const& kv) { return kv.second.value_ref().has_value(); });
+
+  if (not deltaPublication.keyVals_ref()->empty() and isLocalTtlRefresh) {
+    for (auto& [key, value] : *deltaPublication.keyVals_ref()) {
+      pendingTtlRefreshes_[key] = std::move(value);
+    }
+    if (not ttlRefreshTimer_->isScheduled()) {
+      ttlRefreshTimer_->scheduleTimeout(kvParams_.ttlRefreshCoalesceWindow);
+    }
+  } else if (not deltaPublication.keyVals_ref()->empty()) {
     // Flood change to all of our neighbors/subscribers
     floodPublication(std::move(deltaPublication));
   } else {
@@ -3106,7 +5154,9 @@ KvStoreDb::logSyncEvent(
   sample.addString("neighbor", peerNodeName);
   sample.addInt("duration_ms", syncDuration.count());
 
-  kvParams_.logSampleQueue.push(std::move(sample));
+  if (logSampleLimiter_.admit(sample)) {
+    kvParams_.logSampleQueue.push(std::move(sample));
+  }
 }
 
 void
@@ -3117,12 +5167,33 @@ KvStoreDb::logKvEvent(const std::string& event, const std::string& key) {
   sample.addString("node_name", kvParams_.nodeId);
   sample.addString("key", key);
 
-  kvParams_.logSampleQueue.push(std::move(sample));
+  if (logSampleLimiter_.admit(sample)) {
+    kvParams_.logSampleQueue.push(std::move(sample));
+  }
 }
 
 bool
 KvStoreDb::sendDualMessages(
     const std::string& neighbor, const thrift::DualMessages& msgs) noexcept {
+  // prefer connected thrift client of peer, messages are queued behind the
+  // batch in flight to preserve their order
+  if (kvParams_.enableKvStoreThrift) {
+    auto peerIt = thriftPeers_.find(neighbor);
+    if (peerIt != thriftPeers_.end() and peerIt->second.client) {
+      auto& dualQueue = peerIt->second.dualQueue;
+      if (dualQueue.has_value()) {
+        dualQueue->messages_ref()->insert(
+            dualQueue->messages_ref()->end(),
+            msgs.messages_ref()->begin(),
+            msgs.messages_ref()->end());
+      } else {
+        dualQueue = msgs;
+      }
+      sendQueuedDualMessages(neighbor);
+      return true;
+    }
+  }
+
   if (peers_.count(neighbor) == 0) {
     LOG(ERROR) << "fail to send dual messages to " << neighbor << ", not exist";
     return false;
@@ -3132,6 +5203,10 @@ KvStoreDb::sendDualMessages(
   dualRequest.cmd_ref() = thrift::Command::DUAL;
   dualRequest.dualMessages_ref() = msgs;
   *dualRequest.area_ref() = area_;
+  fb303::fbData->addStatValue(
+      "kvstore.dual.messages_per_batch",
+      msgs.messages_ref()->size(),
+      fb303::AVG);
   const auto ret = sendMessageToPeer(neighborCmdSocketId, dualRequest);
   // NOTE: we rely on zmq (on top of tcp) to reliably deliver message,
   // if we switch to other protocols, we need to make sure its reliability.
@@ -3148,4 +5223,78 @@ KvStoreDb::sendDualMessages(
   return true;
 }
 
+void
+KvStoreDb::sendQueuedDualMessages(std::string const& peerName) {
+  auto& peer = thriftPeers_.at(peerName);
+  if (peer.dualInFlight or not peer.dualQueue.has_value() or
+      not peer.client) {
+    return;
+  }
+
+  auto msgs = std::move(*peer.dualQueue);
+  peer.dualQueue.reset();
+  peer.dualInFlight = true;
+  peer.numDualMessagesSent += msgs.messages_ref()->size();
+  fb303::fbData->addStatValue(
+      "kvstore.dual.messages_per_batch",
+      msgs.messages_ref()->size(),
+      fb303::AVG);
+
+  const auto clientId = peer.clientId;
+  auto sf = peer.client->semifuture_processKvStoreDualMessage(msgs, area_);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue([this, peerName, clientId](folly::Unit&&) {
+        auto peerIt = thriftPeers_.find(peerName);
+        if (peerIt == thriftPeers_.end() or
+            peerIt->second.clientId != clientId) {
+          return;
+        }
+        peerIt->second.dualInFlight = false;
+        sendQueuedDualMessages(peerName);
+      })
+      .thenError(
+          [this, peerName, clientId](const folly::exception_wrapper& ew) {
+            fb303::fbData->addStatValue(
+                "kvstore.thrift.num_dual_msg_failure", 1, fb303::COUNT);
+
+            auto peerIt = thriftPeers_.find(peerName);
+            if (peerIt == thriftPeers_.end() or
+                peerIt->second.clientId != clientId) {
+              return;
+            }
+            processThriftFailure(
+                peerName, ew.what(), std::chrono::milliseconds(0));
+          });
+}
+
+void
+KvStoreDb::resetThriftPeerClient(std::string const& peerName) {
+  auto& peer = thriftPeers_.at(peerName);
+  peer.keepAliveTimer->cancelTimeout();
+  peer.client.reset();
+
+  // responses of requests sent over previous client are stale
+  ++peer.clientId;
+  peer.numFloodsInFlight = 0;
+
+  // NOTE: like over ZMQ, batch in flight is lost if peer is going down and
+  // DUAL learns about it from peer removal. Queued batches fall back to ZMQ
+  peer.dualInFlight = false;
+  if (peer.dualQueue.has_value()) {
+    auto msgs = std::move(*peer.dualQueue);
+    peer.dualQueue.reset();
+    fb303::fbData->addStatValue(
+        "kvstore.thrift.num_dual_msg_zmq_fallback", 1, fb303::COUNT);
+    sendDualMessages(peerName, msgs);
+  }
+}
+
+void
+KvStoreDb::scheduleDualMessagesFlush() noexcept {
+  if (not dualMessagesFlushTimer_->isScheduled()) {
+    dualMessagesFlushTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+  }
+}
+
 } // namespace openr
@@ -7,15 +7,19 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <unordered_set>
 
-#include <boost/heap/priority_queue.hpp>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/Optional.h>
+#include <folly/Synchronized.h>
 #include <folly/TokenBucket.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/futures/Future.h>
 #include <folly/gen/Base.h>
 #include <folly/io/IOBuf.h>
@@ -34,8 +38,12 @@
 #include <openr/if/gen-cpp2/KvStore_constants.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
 #include <openr/if/gen-cpp2/OpenrConfig_types.h>
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
+#include <openr/kvstore/KvStoreHashTree.h>
+#include <openr/kvstore/KvStoreTtlWheel.h>
 #include <openr/messaging/ReplicateQueue.h>
 #include <openr/monitor/LogSample.h>
+#include <openr/monitor/LogSampleLimiter.h>
 
 namespace openr {
 
@@ -60,25 +68,6 @@ enum class KvStorePeerEvent {
   THRIFT_API_ERROR = 3,
 };
 
-struct TtlCountdownQueueEntry {
-  std::chrono::steady_clock::time_point expiryTime;
-  std::string key;
-  int64_t version{0};
-  int64_t ttlVersion{0};
-  std::string originatorId;
-  bool
-  operator>(TtlCountdownQueueEntry other) const {
-    return expiryTime > other.expiryTime;
-  }
-};
-
-// TODO: migrate to std::priority_queue
-using TtlCountdownQueue = boost::heap::priority_queue<
-    TtlCountdownQueueEntry,
-    // Always returns smallest first
-    boost::heap::compare<std::greater<TtlCountdownQueueEntry>>,
-    boost::heap::stable<true>>;
-
 class KvStoreFilters {
  public:
   // takes the list of comma separated key prefixes to match,
@@ -108,23 +97,89 @@ class KvStoreFilters {
   std::string str() const;
 
  private:
+  // match key against literal prefixes first, then against regexes if any
+  bool keyPrefixMatch(std::string const& key) const;
+
   // list of string prefixes, empty list matches all keys
   std::vector<std::string> keyPrefixList_{};
 
   // set of node IDs to match, empty set matches all nodes
   std::set<std::string> originatorIds_{};
 
-  // keyPrefix class to create RE2 set and to match keys
+  // hashed copy of originatorIds_ for matching
+  std::unordered_set<std::string> originatorIdSet_{};
+
+  // compiled form of keyPrefixList_. Prefixes without regex syntax (or with
+  // trailing `.*` only) are matched with the trie, the rest with RE2 set
+  KeyPrefixTrie keyPrefixTrie_;
+  std::vector<std::string> keyRegexList_{};
   RegexSet keyRegexSet_;
 };
 
+// Publication shared with all in-process readers of KvStore updates. It is
+// immutable once pushed so that readers can share it without deep copies
+using KvStorePublicationPtr = std::shared_ptr<const thrift::Publication>;
+
+/**
+ * Keys an in-process subscriber of KvStore updates is interested in, see
+ * KvStore::getKvStoreUpdatesReader(). KvStore delivers only matching key-vals
+ * and expired keys to the subscriber, instead of every publication. It is
+ * updated by the subscriber while KvStore matches publications against it,
+ * hence thread-safe. KvStore drops it once the subscriber releases it.
+ */
+class KvStoreSubscription {
+ public:
+  // Subscribe to or unsubscribe from exact key in area
+  void setKey(
+      std::string const& area, std::string const& key, bool isSubscribed);
+
+  // Subscribe to keys with prefix in area, identified by `id`
+  void addKeyPrefix(
+      int64_t id, std::string const& area, std::string const& prefix);
+  void removeKeyPrefix(int64_t id);
+
+  // Subscribe to key-vals matching filters in any area. Filters need value of
+  // key, hence they don't match expired keys
+  void setFilters(std::optional<KvStoreFilters> filters);
+
+  // Subscribe to all key-vals, including TTL updates, and expired keys
+  void setMatchAll(bool matchAll);
+
+  // Publication with matching key-vals and expired keys of `publication`.
+  // TTL updates match only if all key-vals are subscribed to. nullptr if
+  // nothing matches
+  KvStorePublicationPtr match(KvStorePublicationPtr const& publication) const;
+
+ private:
+  struct State {
+    bool matchAll{false};
+    std::unordered_map<
+        std::string /* area */,
+        std::unordered_set<std::string /* key */>>
+        keys;
+    std::unordered_map<
+        int64_t /* id */,
+        std::pair<std::string /* area */, std::string /* prefix */>>
+        keyPrefixes;
+    std::optional<KvStoreFilters> filters;
+  };
+
+  bool isMatch(
+      State const& state,
+      std::string const& area,
+      std::string const& key,
+      thrift::Value const* value) const;
+
+  folly::Synchronized<State> state_;
+};
+
 // structure for common params across all instances of KvStoreDb
 struct KvStoreParams {
   // the name of this node (unique in domain)
   std::string nodeId;
 
   // Queue for publishing KvStore updates to other modules within a process
-  messaging::ReplicateQueue<thrift::Publication>& kvStoreUpdatesQueue;
+  messaging::ReplicateQueue<KvStorePublicationPtr>& kvStoreUpdatesQueue;
 
   // Queue for publishing kvstore peer initial sync events
   messaging::ReplicateQueue<KvStoreSyncEvent>& kvStoreSyncEventsQueue;
@@ -139,6 +194,8 @@ struct KvStoreParams {
   int zmqHwm;
   // flag to enable KvStore external communication over thrift
   bool enableKvStoreThrift{false};
+  // flag to bind and poll ZMQ sockets along with thrift. false => thrift only
+  bool enableZmqTransport{true};
   // flag to enable periodic sync over ZMQ
   bool enablePeriodicSync{true};
   // IP ToS
@@ -153,10 +210,44 @@ struct KvStoreParams {
   std::chrono::milliseconds ttlDecr{Constants::kTtlDecrement};
   bool enableFloodOptimization{false};
   bool isFloodRoot{false};
+  // flag to flood along last formed SPT while flood topology re-converges
+  bool enableFloodBackupTree{false};
+  // flag to decode metadata of flooded key-vals before their values
+  bool enableLazyValueDecode{false};
+  // flag to run KvStoreDb of every area in its own event loop thread
+  bool enableAreaThreads{false};
+  // CPU affinity and scheduling of area and merge threads
+  std::optional<thrift::ThreadConfig> threadConfig;
+  // number of hash shards to merge publications in parallel. 1 => serial
+  size_t mergeShards{1};
+  // flag to maintain hash-tree index and use it for initial full-sync
+  bool enableHashTreeSync{false};
+  // flag to flood value updates of adj: and prefix: keys as delta
+  bool enableValueDelta{false};
+  // window to coalesce local TTL refreshes before flooding. 0 => disabled
+  std::chrono::milliseconds ttlRefreshCoalesceWindow{0};
+  // default codec to request compressed full-sync responses from peers
+  thrift::CompressionType syncCompression{thrift::CompressionType::NONE};
+  // hash scheme of values in local store
+  thrift::KvStoreHashVersion hashVersion{thrift::KvStoreHashVersion::BOOST};
+  // max number of full-syncs in flight with peers
+  size_t maxParallelSync{Constants::kMaxFullSyncPendingCountThreshold};
+  // max bytes of key-vals queued for flooding towards a thrift peer
+  size_t floodQueueMaxBytes{Constants::kKvStoreFloodQueueMaxBytes};
+  // max flood requests in flight towards a thrift peer
+  size_t maxFloodsInFlight{1};
+  // directory of snapshots for warm restart. std::nullopt => disabled
+  std::optional<std::string> snapshotDir;
+  // interval of writing snapshots
+  std::chrono::seconds snapshotInterval{Constants::kKvStoreSnapshotInterval};
+  // limits of log events by event name
+  std::map<std::string, thrift::EventLogLimit> eventLogLimits;
+  // prefixes of keys flooded bypassing flood rate limiter
+  std::vector<std::string> priorityFloodKeyPrefixes;
 
   KvStoreParams(
       std::string nodeid,
-      messaging::ReplicateQueue<thrift::Publication>& kvStoreUpdatesQueue,
+      messaging::ReplicateQueue<KvStorePublicationPtr>& kvStoreUpdatesQueue,
       messaging::ReplicateQueue<KvStoreSyncEvent>& kvStoreSyncEventsQueue,
       messaging::ReplicateQueue<LogSample>& logSampleQueue,
       fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_SERVER> globalCmdSock,
@@ -222,6 +313,10 @@ class KvStoreDb : public DualNode {
   // Extracts the counters
   std::map<std::string, int64_t> getCounters() const;
 
+  // change rate of flood limiter on config reload. Flood rate must have been
+  // configured already
+  void setFloodRate(thrift::KvstoreFloodRate const& floodRate);
+
   // get multiple keys at once
   thrift::Publication getKeyVals(std::vector<std::string> const& keys);
 
@@ -231,16 +326,63 @@ class KvStoreDb : public DualNode {
       thrift::FilterOperator oper = thrift::FilterOperator::OR,
       bool doNotPublishValue = false) const;
 
+  // dump page of the entries matching the filter, in order of their keys.
+  // See thrift::PageParams
+  thrift::KvStorePage dumpPageWithFilters(
+      KvStoreFilters const& kvFilters,
+      thrift::FilterOperator oper,
+      bool doNotPublishValue,
+      std::optional<std::string> const& cursor,
+      size_t pageSize) const;
+
   // dump the hashes of my KV store whose keys match the given prefix
   // if prefix is the empty sting, the full hash store is dumped
   thrift::Publication dumpHashWithFilters(
       KvStoreFilters const& kvFilters) const;
 
-  // dump the keys on which hashes differ from given keyVals
+  // get hashes of children of requested nodes of the hash-tree index.
+  // throws thrift::OpenrError if hash-tree index is not maintained
+  thrift::HashTreeNodes getHashTreeNodes(
+      thrift::HashTreeParams const& params) const;
+
+  // retain ONLY keys belonging to given leaves of the hash-tree index
+  static void filterHashTreeLeaves(
+      std::unordered_map<std::string, thrift::Value>& keyVals,
+      std::vector<int32_t> const& leaves);
+
+  // rewrite hashes of key-vals with payload in hash scheme of peer, to
+  // compare them with hashes of full-sync request of the peer
+  void rehashKeyVals(
+      std::unordered_map<std::string, thrift::Value>& keyVals,
+      thrift::KvStoreHashVersion peerHashVersion) const;
+
+  thrift::KvStoreHashVersion
+  getHashVersion() const {
+    return kvParams_.hashVersion;
+  }
+
+  // dump the keys on which hashes differ from given keyVals. Key-vals to
+  // respond with are moved out of myKeyVal
   thrift::Publication dumpDifference(
-      std::unordered_map<std::string, thrift::Value> const& myKeyVal,
+      std::unordered_map<std::string, thrift::Value>&& myKeyVal,
       std::unordered_map<std::string, thrift::Value> const& reqKeyVal) const;
 
+  // Check from metadata of key-vals if any of them can update local store.
+  // ATTN: conservative, i.e. true unless all of them are known to be stale
+  bool mayUpdateStore(
+      std::map<std::string, thrift::ValueMeta> const& keyVals) const;
+
+  // Erase hashed key-vals which are identical to the ones in local store,
+  // i.e. same version, originator and hash and no newer ttlVersion. Their
+  // merge is a no-op. Returns number of erased key-vals
+  size_t eraseUnchangedKeyVals(thrift::KeyVals& keyVals) const;
+
+  // Process KEY_SET request from its metadata only, if none of its key-vals
+  // can update local store. Return reply to the request, or std::nullopt if
+  // request must be fully decoded and processed
+  std::optional<folly::Expected<fbzmq::Message, fbzmq::Error>>
+  processRedundantKeySet(thrift::KeySetParamsMeta const& params);
+
   // Merge received publication with local store and publish out the delta.
   // If senderId is set, will build <key:value> map from kvStore_ and
   // rcvdPublication.tobeUpdatedKeys and send back to senderId to update it
@@ -249,6 +391,13 @@ class KvStoreDb : public DualNode {
       thrift::Publication const& rcvdPublication,
       std::optional<std::string> senderId = std::nullopt);
 
+  // reconstruct delta-encoded values of flooded key-vals against local store.
+  // Keys which can't be reconstructed are removed and a full-sync with
+  // `senderId` is requested to fetch their values
+  void applyValueDeltas(
+      std::unordered_map<std::string, thrift::Value>& keyVals,
+      std::optional<std::string> const& senderId);
+
   // update Time to expire filed in Publication
   // removeAboutToExpire: knob to remove keys which are about to expire
   // and hence do not want to include them. Constants::kTtlThreshold
@@ -281,6 +430,11 @@ class KvStoreDb : public DualNode {
   // get current snapshot of SPT(s) information
   thrift::SptInfos processFloodTopoGet() noexcept;
 
+  // flood-root-id to be set by initiator of a publication. Falls back to the
+  // last valid SPT root while flood topology re-converges if backup tree is
+  // enabled
+  std::optional<std::string> getFloodRootId();
+
   // util function to fetch peer by its state
   std::vector<std::string> getPeersByState(KvStorePeerState state);
 
@@ -306,6 +460,39 @@ class KvStoreDb : public DualNode {
   // method to scan over thriftPeers to send full-dump request
   void requestThriftPeerSync();
 
+  // periodic full-sync over thrift with a random INITIALIZED peer, replaces
+  // ZMQ periodic sync with thrift only transport
+  void requestThriftPeriodicSync();
+
+  // order peers by full-sync priority: flood-topology parent first, then
+  // flood-topology children, then the rest. Ties are ordered by name
+  void sortPeersForFullSync(std::vector<std::string>& peers) const;
+
+  // record full-sync duration of peer into its histogram
+  void recordPeerSyncDuration(
+      std::string const& peerName, std::chrono::milliseconds duration);
+
+  // send full-dump request with hashes of all keys, or of keys in the given
+  // hash-tree leaves only, to peer in SYNCING state
+  void sendThriftFullSyncRequest(
+      std::string const& peerName,
+      std::optional<std::vector<int32_t>> hashTreeLeaves,
+      std::chrono::steady_clock::time_point startTime);
+
+  // walk down the hash-tree of peer starting from the given nodes until
+  // differing leaves are found, then request full-dump for those leaves
+  void walkPeerHashTree(
+      std::string const& peerName,
+      int32_t level,
+      std::vector<int32_t> indices,
+      std::chrono::steady_clock::time_point startTime);
+
+  // drop hashes of full-sync response of a peer which doesn't negotiate hash
+  // scheme, if its legacy scheme isn't ours. They are regenerated on merge.
+  // @return: hash scheme of peer
+  thrift::KvStoreHashVersion processSyncResponseHashes(
+      thrift::Publication& pub) const;
+
   // util function to process when sync response received
   void processThriftSuccess(
       std::string const& peerName,
@@ -323,6 +510,9 @@ class KvStoreDb : public DualNode {
       const std::string& neighbor,
       const thrift::DualMessages& msgs) noexcept override;
 
+  // defer sending of dual messages to the end of event loop iteration
+  void scheduleDualMessagesFlush() noexcept override;
+
   // send topology-set command to peer, peer will set/unset me as child
   // rootId: action will applied on given rootId
   // peerName: peer name
@@ -352,12 +542,22 @@ class KvStoreDb : public DualNode {
       const std::optional<std::string>& oldNh,
       const std::optional<std::string>& newNh) noexcept override;
 
+  // export duration of completed diffusing computation of a root
+  void processDiffusingComputationDone(
+      const std::string& rootId,
+      std::chrono::microseconds duration) noexcept override;
+
   // get flooding peers for a given spt-root-id
   // if rootId is none => flood to all physical peers
-  // else only flood to formed SPT-peers for rootId
+  // else only flood to formed SPT-peers for rootId. If SPT is not formed,
+  // backup SPT-peers of rootId are used if enabled and none of them is down
   std::unordered_set<std::string> getFloodPeers(
       const std::optional<std::string>& rootId);
 
+  // true if SPT of rootId is not formed and backup SPT-peers of rootId lost
+  // a peer, i.e. backup tree may no longer reach all nodes
+  bool isBackupFloodTreeBroken(const std::string& rootId);
+
   // collect router-client send failure statistics in following form
   // "kvstore.send_failure.dst-peer-id.error-code"
   // error: fbzmq-Error
@@ -371,13 +571,16 @@ class KvStoreDb : public DualNode {
   // request full-sync (KEY_DUMP) with peersToSyncWith_
   void requestFullSyncFromPeers();
 
-  // add new query entries into ttlCountdownQueue from publication
+  // add or refresh TTL countdown entries of keys from publication
   // and Reschedule ttl expiry timer if needed
   void updateTtlCountdownQueue(const thrift::Publication& publication);
 
-  // periodically count down and purge expired keys from CountdownQueue
+  // periodically count down and purge expired keys from TTL countdown wheel
   void cleanupTtlCountdownQueue();
 
+  // schedule ttl expiry timer for the next tick of TTL countdown wheel
+  void scheduleTtlCountdownTimer();
+
   // Function to flood publication to neighbors
   // publication => data element to flood
   // rateLimit => if 'false', publication will not be rate limited
@@ -387,6 +590,21 @@ class KvStoreDb : public DualNode {
       bool rateLimit = true,
       bool setFloodRoot = true);
 
+  // Send flood request to thrift peer if no other one is in flight, queue
+  // key-vals of the request otherwise
+  void floodToThriftPeer(
+      std::string const& peerName, thrift::KeySetParams const& params);
+
+  // Send flood request with all queued key-vals of thrift peer if any
+  void floodQueuedKeyVals(std::string const& peerName);
+
+  // Send DUAL messages queued for thrift peer if none are in flight
+  void sendQueuedDualMessages(std::string const& peerName);
+
+  // Destroy thrift client of peer. Requests in flight become stale, queued
+  // DUAL messages fall back to ZMQ
+  void resetThriftPeerClient(std::string const& peerName);
+
   // perform last step as a 3-way full-sync request
   // full-sync initiator sends back key-val to senderId (where we made
   // full-sync request to) who need to update those keys
@@ -403,6 +621,9 @@ class KvStoreDb : public DualNode {
   // this will poll the sockets listening to the requests
   void attachCallbacks();
 
+  // set up peer-sync socket and poll it, skipped with thrift only transport
+  void attachZmqCallbacks();
+
   // Submit full-sync event to monitor
   void logSyncEvent(
       const std::string& peerNodeName,
@@ -414,9 +635,40 @@ class KvStoreDb : public DualNode {
   // buffer publications blocked by the rate limiter
   void bufferPublication(thrift::Publication&& publication);
 
+  // move key-vals and expired keys of priority flood key prefixes out of
+  // publication into the returned one
+  thrift::Publication extractPriorityPublication(
+      thrift::Publication& publication) const;
+
   // flood pending update blocked by rate limiter
   void floodBufferedUpdates(void);
 
+  // flood TTL refreshes of local keys coalesced within the window
+  void floodPendingTtlRefreshes();
+
+  // stages of processing a publication whose latency is tracked
+  enum class PublicationStage {
+    MERGE = 0,
+    TTL_UPDATE = 1,
+    QUEUE_PUSH = 2,
+    PEER_SEND = 3,
+  };
+  static constexpr size_t kNumPublicationStages{4};
+
+  // record latency of a publication processing stage started at `startTime`
+  void recordStageLatency(
+      PublicationStage stage, std::chrono::steady_clock::time_point startTime);
+
+  // path of snapshot file of this area
+  std::string getSnapshotFilePath() const;
+
+  // write snapshot of key-vals with their remaining TTL to snapshot file
+  void writeSnapshot();
+
+  // warm up store from snapshot file if any. Key-vals whose TTL has run out
+  // since the snapshot, and ones originated by this node, are skipped
+  void loadSnapshot();
+
   // Send message via socket
   folly::Expected<size_t, fbzmq::Error> sendMessageToPeer(
       const std::string& peerSocketId, const thrift::KvStoreRequest& request);
@@ -470,11 +722,58 @@ class KvStoreDb : public DualNode {
     // ATTN: this mechanism serves the purpose of avoiding channel being
     //       closed from thrift server due to IDLE timeout(i.e. 60s by default)
     std::unique_ptr<folly::AsyncTimeout> keepAliveTimer{nullptr};
+
+    // number of flood requests in flight. At most `maxFloodsInFlight` are
+    // pipelined on the channel, later updates are queued meanwhile
+    size_t numFloodsInFlight{0};
+
+    // incremented on every reset of client. Responses of requests sent with
+    // an older client are stale
+    uint64_t clientId{0};
+
+    // DUAL messages to send once the ones in flight are acked. DUAL relies
+    // on in-order delivery, hence at most one request is in flight
+    std::optional<thrift::DualMessages> dualQueue{std::nullopt};
+    bool dualInFlight{false};
+
+    // stats of flood requests: smoothed RTT of acks and totals sent
+    int64_t floodRttMs{0};
+    int64_t numFloodKeyValsSent{0};
+    int64_t numFloodBytesSent{0};
+    int64_t numDualMessagesSent{0};
+
+    // key-vals queued for flooding. Updates of same key collapse into latest
+    std::unordered_map<std::string, thrift::Value> floodQueue{};
+    std::optional<std::string> floodQueueRootId{std::nullopt};
+    size_t floodQueueBytes{0};
+
+    // number of queued key-vals dropped on overflow of the queue
+    int64_t numFloodQueueDrops{0};
+
+    // hash scheme of peer learnt on full-sync. Delta-encoded values are only
+    // flooded to peers of same scheme, as delta refers to hash of base value
+    thrift::KvStoreHashVersion hashVersion{thrift::KvStoreHashVersion::BOOST};
   };
 
   // set of peers with all info over thrift channel
   std::unordered_map<std::string, KvStorePeer> thriftPeers_{};
 
+  // histogram of full-sync durations with a peer
+  struct PeerSyncStats {
+    // inclusive upper bounds of histogram buckets. Last bucket holds the rest
+    static constexpr std::array<int64_t, 6> kBucketBoundsMs{
+        10, 100, 500, 1000, 5000, 10000};
+
+    int64_t count{0};
+    int64_t sumMs{0};
+    int64_t maxMs{0};
+    int64_t lastMs{0};
+    std::array<int64_t, kBucketBoundsMs.size() + 1> buckets{};
+  };
+
+  // map<peer-name: full-sync stats>, reported via getCounters()
+  std::unordered_map<std::string, PeerSyncStats> peerSyncStats_{};
+
   // [TO BE DEPRECATED]
   // The peers we will be talking to: both PUB and CMD URLs for each. We use
   // peerAddCounter_ to uniquely identify a peering session's socket-id.
@@ -501,8 +800,23 @@ class KvStoreDb : public DualNode {
   // store keys mapped to (version, originatoId, value)
   std::unordered_map<std::string, thrift::Value> kvStore_;
 
-  // TTL count down queue
-  TtlCountdownQueue ttlCountdownQueue_;
+  // hash-tree index of kvStore_. Maintained only if hash-tree sync is enabled
+  std::optional<KvStoreHashTree> hashTree_{std::nullopt};
+
+  // map<root-id: last formed SPT-peers> used as backup flood tree while SPT
+  // re-converges. Maintained only if backup tree is enabled
+  std::unordered_map<std::string, std::unordered_set<std::string>>
+      backupFloodPeers_;
+
+  // last valid SPT root-id
+  std::optional<std::string> lastSptRootId_;
+
+  // previous values of keys pending to be flooded, which are used as base for
+  // delta-encoding. Maintained only if value delta encoding is enabled
+  std::unordered_map<std::string, thrift::Value> deltaBases_;
+
+  // TTL count down wheel of keys with finite TTL
+  KvStoreTtlWheel ttlCountdownWheel_{Constants::kKvStoreTtlWheelTick};
 
   // TTL count down timer
   std::unique_ptr<folly::AsyncTimeout> ttlCountdownTimer_;
@@ -519,9 +833,31 @@ class KvStoreDb : public DualNode {
   // Kvstore rate limiter
   std::unique_ptr<folly::BasicTokenBucket<>> floodLimiter_{nullptr};
 
+  // Sampling and rate limiting of log events of this area
+  LogSampleLimiter logSampleLimiter_{kvParams_.eventLogLimits};
+
   // timer to send pending kvstore publication
   std::unique_ptr<folly::AsyncTimeout> pendingPublicationTimer_{nullptr};
 
+  // TTL refreshes of local keys pending to be flooded in a single batch
+  std::unordered_map<std::string, thrift::Value> pendingTtlRefreshes_;
+
+  // timer to flood coalesced TTL refreshes
+  std::unique_ptr<folly::AsyncTimeout> ttlRefreshTimer_{nullptr};
+
+  // timer to send dual messages coalesced within event loop iteration
+  std::unique_ptr<folly::AsyncTimeout> dualMessagesFlushTimer_{nullptr};
+
+  // fb303 histograms of publication processing stages. Named after flooding
+  // path (thrift or zmq) and stage
+  std::array<std::string, kNumPublicationStages> stageHistograms_;
+
+  // max latency of publication processing stages in microseconds
+  std::array<int64_t, kNumPublicationStages> stageLatencyMaxUs_{};
+
+  // timer to write periodic snapshots for warm restart
+  std::unique_ptr<folly::AsyncTimeout> snapshotTimer_{nullptr};
+
   // timer for requesting full-sync
   std::unique_ptr<folly::AsyncTimeout> requestSyncTimer_{nullptr};
 
@@ -550,6 +886,10 @@ class KvStoreDb : public DualNode {
   // thrift version of "parallelSyncLimit_"
   size_t parallelSyncLimitOverThrift_{2};
 
+  // worker pool for sharded merge of large publications. Only created if
+  // `kvParams_.mergeShards` is greater than 1
+  std::unique_ptr<folly::CPUThreadPoolExecutor> mergeExecutor_{nullptr};
+
   // event loop
   OpenrEventBase* evb_{nullptr};
 };
@@ -567,7 +907,7 @@ class KvStore final : public OpenrEventBase {
       // the zmq context to use for IO
       fbzmq::Context& zmqContext,
       // Queue for publishing kvstore updates
-      messaging::ReplicateQueue<thrift::Publication>& kvStoreUpdatesQueue,
+      messaging::ReplicateQueue<KvStorePublicationPtr>& kvStoreUpdatesQueue,
       // Queue for publishing kvstore peer initial sync events
       messaging::ReplicateQueue<KvStoreSyncEvent>& kvStoreSyncEventsQueue,
       // Queue for receiving peer updates
@@ -583,20 +923,43 @@ class KvStore final : public OpenrEventBase {
       // ZMQ high water mark
       int zmqHwm = Constants::kHighWaterMark,
       bool enableKvStoreThrift = false,
-      bool enablePeriodicSync = true);
+      bool enablePeriodicSync = true,
+      // Queue for receiving reloaded config
+      std::optional<messaging::RQueue<ConfigPtr>> configUpdatesQueue =
+          std::nullopt);
 
   ~KvStore() override = default;
 
+  // override run() method of OpenrEventBase to start area threads if any
+  void run() override;
+
   // override stop() method of OpenrEventBase
   void stop() override;
 
   // process the key-values publication, and attempt to
   // merge it in existing map (first argument)
   // Return a publication made out of the updated values
+  // Hashes missing in `update` are generated in `hashVersion` scheme
   static std::unordered_map<std::string, thrift::Value> mergeKeyValues(
       std::unordered_map<std::string, thrift::Value>& kvStore,
       std::unordered_map<std::string, thrift::Value> const& update,
-      std::optional<KvStoreFilters> const& filters = std::nullopt);
+      std::optional<KvStoreFilters> const& filters = std::nullopt,
+      thrift::KvStoreHashVersion hashVersion =
+          thrift::KvStoreHashVersion::BOOST);
+
+  // sharded flavor of mergeKeyValues. Keys of `update` are partitioned into
+  // `numShards` hash shards and merge decisions (including hash generation)
+  // are computed for each shard in parallel on `executor`. The resulting
+  // updates are applied to `kvStore` in the calling thread afterwards, hence
+  // the result is identical to the serial version.
+  static std::unordered_map<std::string, thrift::Value> mergeKeyValuesSharded(
+      std::unordered_map<std::string, thrift::Value>& kvStore,
+      std::unordered_map<std::string, thrift::Value> const& update,
+      std::optional<KvStoreFilters> const& filters,
+      folly::Executor* executor,
+      size_t numShards,
+      thrift::KvStoreHashVersion hashVersion =
+          thrift::KvStoreHashVersion::BOOST);
 
   // compare two thrift::Values to figure out which value is better to
   // use, it will compare following attributes in order
@@ -623,9 +986,19 @@ class KvStore final : public OpenrEventBase {
       thrift::KeyDumpParams keyDumpParams,
       std::set<std::string> selectAreas = {});
 
+  // dump page of key-vals of an area. Page is built in event loop of the area
+  // without building full dump
+  folly::SemiFuture<std::unique_ptr<thrift::KvStorePage>> dumpKvStoreKeysPage(
+      std::string area,
+      thrift::KeyDumpParams keyDumpParams,
+      thrift::PageParams page);
+
   folly::SemiFuture<std::unique_ptr<thrift::Publication>> dumpKvStoreHashes(
       std::string area, thrift::KeyDumpParams keyDumpParams);
 
+  folly::SemiFuture<std::unique_ptr<thrift::HashTreeNodes>> getKvStoreHashTree(
+      std::string area, thrift::HashTreeParams hashTreeParams);
+
   folly::SemiFuture<std::unique_ptr<thrift::PeersMap>> getKvStorePeers(
       std::string area);
 
@@ -647,7 +1020,13 @@ class KvStore final : public OpenrEventBase {
   folly::SemiFuture<std::map<std::string, int64_t>> getCounters();
 
   // API to get reader for kvStoreUpdatesQueue
-  messaging::RQueue<thrift::Publication> getKvStoreUpdatesReader();
+  messaging::RQueue<KvStorePublicationPtr> getKvStoreUpdatesReader();
+
+  // API to get reader of KvStore updates matching `subscription` only.
+  // Publications with nothing of interest are not delivered. Reader is closed
+  // along with kvStoreUpdatesQueue
+  messaging::RQueue<KvStorePublicationPtr> getKvStoreUpdatesReader(
+      std::shared_ptr<const KvStoreSubscription> subscription);
 
   // API to fetch state of peerNode, used for unit-testing
   folly::SemiFuture<std::optional<KvStorePeerState>> getKvStorePeerState(
@@ -674,9 +1053,21 @@ class KvStore final : public OpenrEventBase {
   folly::Expected<fbzmq::Message, fbzmq::Error> processRequestMsg(
       const std::string& requestId, fbzmq::Message&& msg);
 
+  // Peek at metadata of request and reply to it without decoding it fully if
+  // it is a redundant KEY_SET. Return std::nullopt otherwise
+  std::optional<folly::Expected<fbzmq::Message, fbzmq::Error>>
+  processRedundantRequestMsg(const fbzmq::Message& msg);
+
   void processPeerUpdates(thrift::PeerUpdateRequest&& req);
 
-  std::map<std::string, int64_t> getGlobalCounters() const;
+  // apply reloadable KvStore fields of config, i.e. flood rate
+  void processConfigUpdate(Config const& config);
+
+  // dump key-vals of an area for dumpKvStoreKeys(). Must be called in the
+  // event loop owning `kvStoreDb`
+  static thrift::Publication dumpKvStoreKeysOfArea(
+      KvStoreDb& kvStoreDb, thrift::KeyDumpParams const& keyDumpParams);
+
 
   // helper for public semifuture API. Returns a reference to the relevant
   // KvStoreDb (to be captured and operated on in this event loop) or throws an
@@ -687,6 +1078,15 @@ class KvStore final : public OpenrEventBase {
   KvStoreDb& getAreaDbOrThrow(
       std::string const& areaId, std::string const& caller);
 
+  // event loop owning KvStoreDb of the area. This is the KvStore event loop
+  // itself unless areas run on their own threads. Area is resolved the same
+  // way as in getAreaDbOrThrow(), unknown areas are served by KvStore event
+  // loop so that getAreaDbOrThrow() rejects them as usual
+  OpenrEventBase* getAreaEvb(std::string const& areaId);
+
+  // deliver KvStore update to queues of subscriptions it matches
+  void dispatchToSubscriptions(KvStorePublicationPtr const& publication);
+
   //
   // Private variables
   //
@@ -697,9 +1097,29 @@ class KvStore final : public OpenrEventBase {
   // kvstore parameters common to all kvstoreDB
   KvStoreParams kvParams_;
 
-  // map of area IDs and instance of KvStoreDb
+  // map of area IDs and instance of KvStoreDb. It is populated in constructor
+  // and cleared in stop() only, hence it can be looked up from any thread
   std::unordered_map<std::string /* area ID */, KvStoreDb> kvStoreDb_{};
 
+  // event loop and thread of every area if `enableAreaThreads` is set
+  std::unordered_map<std::string /* area ID */, std::unique_ptr<OpenrEventBase>>
+      areaEvbs_{};
+  std::vector<std::thread> areaThreads_{};
+
+  struct SubscriptionQueue {
+    std::shared_ptr<const KvStoreSubscription> subscription;
+    std::shared_ptr<messaging::RWQueue<KvStorePublicationPtr>> queue;
+  };
+
+  // queues of readers of getKvStoreUpdatesReader(subscription). Fed by
+  // KvStore event loop from its own reader of kvStoreUpdatesQueue
+  struct SubscriptionQueues {
+    std::vector<SubscriptionQueue> queues;
+    // set once kvStoreUpdatesQueue is closed
+    bool isClosed{false};
+  };
+  folly::Synchronized<SubscriptionQueues> subscriptionQueues_;
+
   // the serializer/deserializer helper we'll be using
   apache::thrift::CompactSerializer serializer_;
 
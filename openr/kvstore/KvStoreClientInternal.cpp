@@ -29,9 +29,10 @@ KvStoreClientInternal::KvStoreClientInternal(
   CHECK(!nodeId.empty());
   CHECK(kvStore_);
 
-  // Fiber to process thrift::Publication from KvStore
+  // Fiber to process thrift::Publication from KvStore. KvStore only delivers
+  // keys of interest to this client, see updateKeySubscription()
   taskFuture_ = eventBase_->addFiberTaskFuture([
-    q = std::move(kvStore_->getKvStoreUpdatesReader()),
+    q = std::move(kvStore_->getKvStoreUpdatesReader(subscription_)),
     this
   ]() mutable noexcept {
     LOG(INFO) << "Starting KvStore updates processing fiber";
@@ -42,7 +43,7 @@ KvStoreClientInternal::KvStoreClientInternal(
         LOG(INFO) << "Terminating KvStore updates processing fiber";
         break;
       }
-      processPublication(maybePublication.value());
+      processPublication(*maybePublication.value());
     }
   });
 
@@ -170,8 +171,50 @@ KvStoreClientInternal::persistKey(
   VLOG(3) << "KvStoreClientInternal: persistKey called for key:" << key
           << " area:" << area.t;
 
+  if (not persistKeyImpl(area, key, value, ttl)) {
+    return false;
+  }
+
+  // Best effort to advertise pending keys
+  advertisePendingKeys();
+  advertiseTtlUpdates();
+  return true;
+}
+
+std::unordered_set<std::string>
+KvStoreClientInternal::persistKeys(
+    AreaId const& area,
+    std::unordered_map<std::string, std::string> const& keyVals,
+    std::chrono::milliseconds const ttl /* = Constants::kTtlInfInterval */) {
+  CHECK(eventBase_->getEvb()->isInEventBaseThread());
+
+  VLOG(3) << "KvStoreClientInternal: persistKeys called for "
+          << keyVals.size() << " keys, area:" << area.t;
+
+  std::unordered_set<std::string> changedKeys;
+  for (auto const& [key, value] : keyVals) {
+    if (persistKeyImpl(area, key, value, ttl)) {
+      changedKeys.emplace(key);
+    }
+  }
+
+  // Advertise all pending keys in one go
+  if (not changedKeys.empty()) {
+    advertisePendingKeys();
+    advertiseTtlUpdates();
+  }
+  return changedKeys;
+}
+
+bool
+KvStoreClientInternal::persistKeyImpl(
+    AreaId const& area,
+    std::string const& key,
+    std::string const& value,
+    std::chrono::milliseconds const ttl) {
+
   auto& persistedKeyVals = persistedKeyVals_[area];
-  const auto& keyTtlBackoffs = keyTtlBackoffs_[area];
+  const auto& keyTtls = keyTtls_[area];
   auto& keysToAdvertise = keysToAdvertise_[area];
   auto& callbacks = keyCallbacks_[area];
 
@@ -205,8 +248,8 @@ KvStoreClientInternal::persistKey(
       // this is a no op, return early and change no state
       return false;
     }
-    auto ttlIt = keyTtlBackoffs.find(key);
-    if (ttlIt != keyTtlBackoffs.end()) {
+    auto ttlIt = keyTtls.find(key);
+    if (ttlIt != keyTtls.end()) {
       thriftValue.ttlVersion_ref() = *ttlIt->second.first.ttlVersion_ref();
     }
   }
@@ -233,6 +276,7 @@ KvStoreClientInternal::persistKey(
 
   // Cache it in persistedKeyVals_. Override the existing one
   persistedKeyVals[key] = thriftValue;
+  updateKeySubscription(area, key);
 
   // Override existing backoff as well
   backoffs_[area][key] = ExponentialBackoff<std::chrono::milliseconds>(
@@ -249,9 +293,6 @@ KvStoreClientInternal::persistKey(
     keysToAdvertise.insert(key);
   }
 
-  // Best effort to advertise pending keys
-  advertisePendingKeys();
-
   scheduleTtlUpdates(
       area,
       key,
@@ -319,6 +360,7 @@ KvStoreClientInternal::setKey(
       *thriftValue.ttlVersion_ref(),
       *thriftValue.ttl_ref(),
       false /* advertiseImmediately */);
+  advertiseTtlUpdates();
 
   return ret;
 }
@@ -332,11 +374,9 @@ KvStoreClientInternal::scheduleTtlUpdates(
     int64_t ttl,
     bool advertiseImmediately) {
   // infinite TTL does not need update
-
-  auto& keyTtlBackoffs = keyTtlBackoffs_[area];
   if (ttl == Constants::kTtlInfinity) {
     // in case ttl is finite before
-    keyTtlBackoffs.erase(key);
+    eraseKeyTtl(area, key);
     return;
   }
 
@@ -351,21 +391,32 @@ KvStoreClientInternal::scheduleTtlUpdates(
   ttlThriftValue.value_ref().reset();
   CHECK(not ttlThriftValue.value_ref().has_value());
 
-  // renew before Ttl expires about every ttl/3, i.e., try twice
-  // use ExponentialBackoff to track remaining time
-  keyTtlBackoffs[key] = std::make_pair(
-      ttlThriftValue,
-      ExponentialBackoff<std::chrono::milliseconds>(
-          std::chrono::milliseconds(ttl / 4),
-          std::chrono::milliseconds(ttl / 4 + 1)));
+  // renew before Ttl expires about every ttl/4, i.e., try thrice
+  const std::chrono::milliseconds refreshInterval(ttl / 4);
+  keyTtls_[area][key] = std::make_pair(ttlThriftValue, refreshInterval);
+  updateKeySubscription(area, key);
 
   // Delay first ttl advertisement by (ttl / 4). We have just advertised key or
   // update and would like to avoid sending unncessary immediate ttl update
+  TtlCountdownEntry entry;
+  entry.key = key;
+  entry.expiryTime = std::chrono::steady_clock::now();
   if (not advertiseImmediately) {
-    keyTtlBackoffs.at(key).second.reportError();
+    entry.expiryTime += refreshInterval;
   }
+  ttlRefreshWheels_.try_emplace(area, Constants::kKvStoreTtlWheelTick)
+      .first->second.upsert(std::move(entry));
+}
 
-  advertiseTtlUpdates();
+void
+KvStoreClientInternal::eraseKeyTtl(
+    AreaId const& area, std::string const& key) {
+  keyTtls_[area].erase(key);
+  auto it = ttlRefreshWheels_.find(area);
+  if (it != ttlRefreshWheels_.end()) {
+    it->second.erase(key);
+  }
+  updateKeySubscription(area, key);
 }
 
 void
@@ -377,8 +428,16 @@ KvStoreClientInternal::unsetKey(AreaId const& area, std::string const& key) {
 
   persistedKeyVals_[area].erase(key);
   backoffs_[area].erase(key);
-  keyTtlBackoffs_[area].erase(key);
   keysToAdvertise_[area].erase(key);
+  eraseKeyTtl(area, key);
+}
+
+void
+KvStoreClientInternal::updateKeySubscription(
+    AreaId const& area, std::string const& key) {
+  const bool isSubscribed = persistedKeyVals_[area].count(key) or
+      keyTtls_[area].count(key) or keyCallbacks_[area].count(key);
+  subscription_->setKey(area.t, key, isSubscribed);
 }
 
 void
@@ -387,31 +446,44 @@ KvStoreClientInternal::clearKey(
     std::string const& key,
     std::string keyValue,
     std::chrono::milliseconds ttl) {
-  CHECK(eventBase_->getEvb()->isInEventBaseThread());
-
   VLOG(2) << "KvStoreClientInternal: clear key called for key " << key;
 
-  // erase keys
-  unsetKey(area, key);
+  clearKeys(area, {{key, std::move(keyValue)}}, ttl);
+}
+
+void
+KvStoreClientInternal::clearKeys(
+    AreaId const& area,
+    std::unordered_map<std::string, std::string> keyVals,
+    std::chrono::milliseconds ttl) {
+  CHECK(eventBase_->getEvb()->isInEventBaseThread());
+
+  std::unordered_map<std::string, thrift::Value> thriftKeyVals;
+  for (auto& [key, keyValue] : keyVals) {
+    // erase keys
+    unsetKey(area, key);
 
-  // if key doesn't exist in KvStore no need to add it as "empty". This
-  // condition should not exist.
-  auto maybeValue = getKey(area, key);
-  if (!maybeValue.has_value()) {
+    // if key doesn't exist in KvStore no need to add it as "empty". This
+    // condition should not exist.
+    auto maybeValue = getKey(area, key);
+    if (!maybeValue.has_value()) {
+      continue;
+    }
+    // overwrite all values, increment version, reset value to empty
+    auto& thriftValue = maybeValue.value();
+    *thriftValue.originatorId_ref() = nodeId_;
+    (*thriftValue.version_ref())++;
+    thriftValue.ttl_ref() = ttl.count();
+    thriftValue.ttlVersion_ref() = 0;
+    thriftValue.value_ref() = std::move(keyValue);
+    thriftKeyVals.emplace(key, std::move(thriftValue));
+  }
+  if (thriftKeyVals.empty()) {
     return;
   }
-  // overwrite all values, increment version, reset value to empty
-  auto& thriftValue = maybeValue.value();
-  *thriftValue.originatorId_ref() = nodeId_;
-  (*thriftValue.version_ref())++;
-  thriftValue.ttl_ref() = ttl.count();
-  thriftValue.ttlVersion_ref() = 0;
-  thriftValue.value_ref() = std::move(keyValue);
 
-  std::unordered_map<std::string, thrift::Value> keyVals;
-  keyVals.emplace(key, std::move(thriftValue));
   // Advertise to KvStore
-  const auto ret = setKeysHelper(area, std::move(keyVals));
+  const auto ret = setKeysHelper(area, std::move(thriftKeyVals));
   if (!ret.has_value()) {
     LOG(ERROR) << "Error sending SET_KEY request to KvStore";
   }
@@ -477,6 +549,7 @@ KvStoreClientInternal::subscribeKey(
 
   VLOG(3) << "KvStoreClientInternal: subscribeKey called for key " << key;
   keyCallbacks_[area][key] = std::move(callback);
+  updateKeySubscription(area, key);
 
   return fetchKeyValue ? getKey(area, key) : std::nullopt;
 }
@@ -486,6 +559,8 @@ KvStoreClientInternal::subscribeKeyFilter(
     KvStoreFilters kvFilters, KeyCallback callback) {
   CHECK(eventBase_->getEvb()->isInEventBaseThread());
 
+  subscription_->setFilters(KvStoreFilters(
+      kvFilters.getKeyPrefixes(), kvFilters.getOriginatorIdList()));
   keyPrefixFilter_ = std::move(kvFilters);
   keyPrefixFilterCallback_ = std::move(callback);
   return;
@@ -497,9 +572,47 @@ KvStoreClientInternal::unsubscribeKeyFilter() {
 
   keyPrefixFilterCallback_ = nullptr;
   keyPrefixFilter_ = KvStoreFilters({}, {});
+  subscription_->setFilters(std::nullopt);
   return;
 }
 
+int64_t
+KvStoreClientInternal::subscribeKeyPrefix(
+    AreaId const& area, std::string const& prefix, KeyCallback callback) {
+  CHECK(eventBase_->getEvb()->isInEventBaseThread());
+  CHECK(bool(callback)) << "Callback function for " << prefix << " is empty";
+
+  const auto subscriptionId = nextKeyPrefixSubscriptionId_++;
+  keyPrefixSubscriptions_.emplace(
+      subscriptionId, KeyPrefixSubscription{area, prefix, std::move(callback)});
+  subscription_->addKeyPrefix(subscriptionId, area.t, prefix);
+  return subscriptionId;
+}
+
+void
+KvStoreClientInternal::unsubscribeKeyPrefix(int64_t subscriptionId) {
+  CHECK(eventBase_->getEvb()->isInEventBaseThread());
+
+  if (keyPrefixSubscriptions_.erase(subscriptionId) == 0) {
+    LOG(WARNING) << "UnsubscribeKeyPrefix called for non-existing "
+                 << "subscription " << subscriptionId;
+  }
+  subscription_->removeKeyPrefix(subscriptionId);
+}
+
+void
+KvStoreClientInternal::processKeyPrefixSubscriptions(
+    AreaId const& area,
+    std::string const& key,
+    std::optional<thrift::Value> const& value) {
+  for (auto& [_, subscription] : keyPrefixSubscriptions_) {
+    if (subscription.area == area and
+        key.compare(0, subscription.prefix.size(), subscription.prefix) == 0) {
+      subscription.callback(key, value);
+    }
+  }
+}
+
 void
 KvStoreClientInternal::unsubscribeKey(
     AreaId const& area, std::string const& key) {
@@ -510,6 +623,7 @@ KvStoreClientInternal::unsubscribeKey(
   if (keyCallbacks_[area].erase(key) == 0) {
     LOG(WARNING) << "UnsubscribeKey called for non-existing key" << key;
   }
+  updateKeySubscription(area, key);
 }
 
 void
@@ -517,6 +631,7 @@ KvStoreClientInternal::setKvCallback(KeyCallback callback) {
   CHECK(eventBase_->getEvb()->isInEventBaseThread());
 
   kvCallback_ = std::move(callback);
+  subscription_->setMatchAll(bool(kvCallback_));
 }
 
 void
@@ -525,12 +640,15 @@ KvStoreClientInternal::processExpiredKeys(
   auto const& expiredKeys = *publication.expiredKeys_ref();
 
   // NOTE: default construct empty map if it didn't exist
-  auto& callbacks = keyCallbacks_[AreaId{publication.get_area()}];
+  const AreaId area{publication.get_area()};
+  auto& callbacks = keyCallbacks_[area];
   for (auto const& key : expiredKeys) {
     /* callback registered by the thread */
     if (kvCallback_) {
       kvCallback_(key, std::nullopt);
     }
+    /* key prefix registered callbacks */
+    processKeyPrefixSubscriptions(area, key, std::nullopt);
     /* key specific registered callback */
     auto cb = callbacks.find(key);
     if (cb != callbacks.end()) {
@@ -547,7 +665,7 @@ KvStoreClientInternal::processPublication(
   AreaId area{publication.get_area()};
   // NOTE: default construct empty containers if they didn't exist
   auto& persistedKeyVals = persistedKeyVals_[area];
-  auto& keyTtlBackoffs = keyTtlBackoffs_[area];
+  auto& keyTtls = keyTtls_[area];
   auto& keysToAdvertise = keysToAdvertise_[area];
   auto& callbacks = keyCallbacks_[area];
 
@@ -562,21 +680,22 @@ KvStoreClientInternal::processPublication(
     if (kvCallback_) {
       kvCallback_(key, rcvdValue);
     }
+    processKeyPrefixSubscriptions(area, key, rcvdValue);
 
     // Update local keyVals as per need
     auto it = persistedKeyVals.find(key);
     auto cb = callbacks.find(key);
     // set key w/ finite TTL
-    auto sk = keyTtlBackoffs.find(key);
+    auto sk = keyTtls.find(key);
 
     // key set but not persisted
-    if (sk != keyTtlBackoffs.end() and it == persistedKeyVals.end()) {
+    if (sk != keyTtls.end() and it == persistedKeyVals.end()) {
       auto& setValue = sk->second.first;
       if (*rcvdValue.version_ref() > *setValue.version_ref() or
           (*rcvdValue.version_ref() == *setValue.version_ref() and
            *rcvdValue.originatorId_ref() > *setValue.originatorId_ref())) {
         // key lost, cancel TTL update
-        keyTtlBackoffs.erase(sk);
+        eraseKeyTtl(area, key);
       } else if (
           *rcvdValue.version_ref() == *setValue.version_ref() and
           *rcvdValue.originatorId_ref() == *setValue.originatorId_ref() and
@@ -584,7 +703,7 @@ KvStoreClientInternal::processPublication(
         // If version, value and originatorId is same then we should look up
         // ttlVersion and update local value if rcvd ttlVersion is higher
         // NOTE: We don't need to advertise the value back
-        if (sk != keyTtlBackoffs.end() and
+        if (sk != keyTtls.end() and
             *sk->second.first.ttlVersion_ref() < *rcvdValue.ttlVersion_ref()) {
           VLOG(2) << "Bumping TTL version for (key, version, originatorId) "
                   << folly::sformat(
@@ -649,7 +768,7 @@ KvStoreClientInternal::processPublication(
     }
 
     // copy ttlVersion from ttl backoff map
-    if (sk != keyTtlBackoffs.end()) {
+    if (sk != keyTtls.end()) {
       currentValue.ttlVersion_ref() = *sk->second.first.ttlVersion_ref();
     }
 
@@ -658,7 +777,7 @@ KvStoreClientInternal::processPublication(
     // update to latest ttlVersion works fine
     if (*currentValue.ttlVersion_ref() < *rcvdValue.ttlVersion_ref()) {
       currentValue.ttlVersion_ref() = *rcvdValue.ttlVersion_ref();
-      if (sk != keyTtlBackoffs.end()) {
+      if (sk != keyTtls.end()) {
         sk->second.first.ttlVersion_ref() = *rcvdValue.ttlVersion_ref();
       }
     }
@@ -750,29 +869,28 @@ void
 KvStoreClientInternal::advertiseTtlUpdates() {
   // Build set of keys to advertise ttl updates
   auto timeout = Constants::kMaxTtlUpdateInterval;
+  const auto now = std::chrono::steady_clock::now();
 
   // advertise TTL updates for each area
-  for (auto& keyTtlBackoffsEntry : keyTtlBackoffs_) {
-    auto& keyTtlBackoffs = keyTtlBackoffsEntry.second;
-    auto& persistedKeyVals = persistedKeyVals_[keyTtlBackoffsEntry.first];
-    auto& area = keyTtlBackoffsEntry.first;
+  for (auto& [area, ttlRefreshWheel] : ttlRefreshWheels_) {
+    auto& keyTtls = keyTtls_[area];
+    auto& persistedKeyVals = persistedKeyVals_[area];
 
     std::unordered_map<std::string, thrift::Value> keyVals;
 
-    for (auto& kv : keyTtlBackoffs) {
-      const auto& key = kv.first;
-      auto& backoff = kv.second.second;
-      if (not backoff.canTryNow()) {
-        VLOG(2) << "Skipping key: " << key << ", area: " << area.t;
-        timeout = std::min(timeout, backoff.getTimeRemainingUntilRetry());
+    // ONLY keys due for refresh are visited
+    for (auto& entry : ttlRefreshWheel.advance(now)) {
+      auto kv = keyTtls.find(entry.key);
+      if (kv == keyTtls.end()) {
         continue;
       }
+      const auto& key = kv->first;
 
-      // Apply backoff
-      backoff.reportError();
-      timeout = std::min(timeout, backoff.getTimeRemainingUntilRetry());
+      // Schedule next refresh
+      entry.expiryTime = now + kv->second.second;
+      ttlRefreshWheel.upsert(std::move(entry));
 
-      auto& thriftValue = kv.second.first;
+      auto& thriftValue = kv->second.first;
       const auto it = persistedKeyVals.find(key);
       if (it != persistedKeyVals.end()) {
         // we may have got a newer vesion for persisted key
@@ -805,6 +923,10 @@ KvStoreClientInternal::advertiseTtlUpdates() {
         LOG(ERROR) << "Error sending SET_KEY request to KvStore.";
       }
     }
+
+    if (auto nextTimeout = ttlRefreshWheel.getNextTimeout(now)) {
+      timeout = std::min(timeout, *nextTimeout);
+    }
   }
 
   // Schedule next-timeout for processing/clearing backoffs
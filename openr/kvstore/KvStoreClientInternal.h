@@ -10,6 +10,7 @@
 #include <chrono>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <folly/Function.h>
 #include <folly/Optional.h>
@@ -37,6 +38,8 @@ using namespace std::chrono_literals;
  * `setKey`, `getKey` operations. With `subscribeKey` you can write your
  * logic in asynchronous fashion.
  *
+ * Client subscribes to KvStore updates of the keys it persists, sets or
+ * subscribes to only, hence it doesn't process every publication of KvStore.
  */
 class KvStoreClientInternal {
  public:
@@ -78,6 +81,18 @@ class KvStoreClientInternal {
       std::string const& value,
       std::chrono::milliseconds const ttl = Constants::kTtlInfInterval);
 
+  /**
+   * Batched flavour of `persistKey`. All key-values changing state are
+   * advertised to KvStore of the area in a single set request, rather than
+   * one request (and flooding) per key.
+   *
+   * returns set of keys for which call results in state change
+   */
+  std::unordered_set<std::string> persistKeys(
+      AreaId const& area,
+      std::unordered_map<std::string, std::string> const& keyVals,
+      std::chrono::milliseconds const ttl = Constants::kTtlInfInterval);
+
   /**
    * Advertise the key-value into KvStore with specified version. If version is
    * not specified than the one greater than the latest known will be used.
@@ -112,6 +127,15 @@ class KvStoreClientInternal {
       std::string value = "",
       std::chrono::milliseconds ttl = Constants::kTtlInfInterval);
 
+  /**
+   * Batched flavour of `clearKey`. Keys are mapped to value set on clearing,
+   * all of them are advertised to KvStore of the area in a single set request.
+   */
+  void clearKeys(
+      AreaId const& area,
+      std::unordered_map<std::string, std::string> keyVals,
+      std::chrono::milliseconds ttl = Constants::kTtlInfInterval);
+
   /**
    * Get key from KvStore. It gets from local snapshot KeyVals of the kvstore.
    */
@@ -148,6 +172,15 @@ class KvStoreClientInternal {
   void subscribeKeyFilter(KvStoreFilters kvFilters, KeyCallback callback);
   void unsubscribeKeyFilter();
 
+  /**
+   * APIs to subscribe/unsubscribe to value change and expiry of all keys with
+   * given prefix in an area. Unlike key filter, any number of subscriptions
+   * can co-exist, each is identified by returned subscription ID
+   */
+  int64_t subscribeKeyPrefix(
+      AreaId const& area, std::string const& prefix, KeyCallback callback);
+  void unsubscribeKeyPrefix(int64_t subscriptionId);
+
   OpenrEventBase*
   getOpenrEventBase() const noexcept {
     return eventBase_;
@@ -171,6 +204,20 @@ class KvStoreClientInternal {
    */
   void processExpiredKeys(thrift::Publication const& publication);
 
+  /**
+   * Subscribe to updates of key in KvStore as long as it is persisted, set
+   * with finite TTL or has callback, unsubscribe otherwise
+   */
+  void updateKeySubscription(AreaId const& area, std::string const& key);
+
+  /**
+   * Invoke callbacks of key prefixes subscribed in area matching the key
+   */
+  void processKeyPrefixSubscriptions(
+      AreaId const& area,
+      std::string const& key,
+      std::optional<thrift::Value> const& value);
+
   /*
    * Utility function to build thrift::Value in KvStoreClientInternal
    * This method will:
@@ -187,6 +234,17 @@ class KvStoreClientInternal {
       uint32_t version = 0,
       std::chrono::milliseconds ttl = Constants::kTtlInfInterval);
 
+  /**
+   * Update locally persisted state of key and queue it for advertisement,
+   * without sending anything to KvStore. Caller advertises pending keys and
+   * ttl updates afterwards.
+   */
+  bool persistKeyImpl(
+      AreaId const& area,
+      std::string const& key,
+      std::string const& value,
+      std::chrono::milliseconds const ttl);
+
   /**
    * Utility function to SET keys in KvStore.
    */
@@ -202,7 +260,8 @@ class KvStoreClientInternal {
   void advertisePendingKeys();
 
   /**
-   * Helper function to schedule TTL update advertisement
+   * Helper function to schedule TTL update advertisement. Advertisement
+   * itself is left to caller with advertiseTtlUpdates()
    */
   void scheduleTtlUpdates(
       AreaId const& area,
@@ -213,10 +272,14 @@ class KvStoreClientInternal {
       bool advertiseImmediately);
 
   /**
-   * Helper function to advertise TTL update
+   * Helper function to advertise TTL updates of keys due for refresh in one
+   * request per area
    */
   void advertiseTtlUpdates();
 
+  // Stop refreshing TTL of key
+  void eraseKeyTtl(AreaId const& area, std::string const& key);
+
   void checkPersistKeyInStore();
 
   /*
@@ -266,6 +329,16 @@ class KvStoreClientInternal {
   // callback for updates from keys filtered with provided filter
   KeyCallback keyPrefixFilterCallback_{nullptr};
 
+  struct KeyPrefixSubscription {
+    AreaId area;
+    std::string prefix;
+    KeyCallback callback;
+  };
+
+  // Subscribed key prefixes by subscription ID
+  std::unordered_map<int64_t, KeyPrefixSubscription> keyPrefixSubscriptions_;
+  int64_t nextKeyPrefixSubscriptionId_{0};
+
   // backoff associated with each key for re-advertisements
   std::unordered_map<
       AreaId,
@@ -274,15 +347,19 @@ class KvStoreClientInternal {
           ExponentialBackoff<std::chrono::milliseconds>>>
       backoffs_;
 
-  // backoff associated with each key for freshing TTL
+  // TTL update and refresh interval of each key with finite TTL
   std::unordered_map<
       AreaId,
       std::unordered_map<
           std::string /* key */,
           std::pair<
               thrift::Value /* value */,
-              ExponentialBackoff<std::chrono::milliseconds>>>>
-      keyTtlBackoffs_;
+              std::chrono::milliseconds /* refresh interval */>>>
+      keyTtls_;
+
+  // Next TTL refresh of keys of `keyTtls_` ordered by time, hence timer only
+  // visits keys due for refresh
+  std::unordered_map<AreaId, KvStoreTtlWheel> ttlRefreshWheels_;
 
   // Set of local keys to be re-advertised.
   std::unordered_map<AreaId, std::unordered_set<std::string /* key */>>
@@ -297,6 +374,10 @@ class KvStoreClientInternal {
   // prefix key filter to apply for key updates
   KvStoreFilters keyPrefixFilter_{{}, {}};
 
+  // keys of interest of this client. KvStore only delivers their updates
+  std::shared_ptr<KvStoreSubscription> subscription_{
+      std::make_shared<KvStoreSubscription>()};
+
   // fiber task future hold
   folly::Future<folly::Unit> taskFuture_;
 };
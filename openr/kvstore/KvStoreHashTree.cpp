@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/kvstore/KvStoreHashTree.h>
+
+#include <limits>
+
+#include <folly/hash/Hash.h>
+#include <glog/logging.h>
+
+namespace openr {
+
+KvStoreHashTree::KvStoreHashTree(size_t fanout, size_t depth)
+    : fanout_(fanout), depth_(depth) {
+  CHECK_GT(fanout_, 1) << "Hash tree fanout must be greater than 1";
+  CHECK_GT(depth_, 0) << "Hash tree must have at-least one level of leaves";
+
+  size_t numNodes = 1;
+  for (size_t level = 0; level <= depth_; ++level) {
+    levels_.emplace_back(numNodes, 0);
+    numNodes *= fanout_;
+  }
+  CHECK_LE(levels_.back().size(), std::numeric_limits<int32_t>::max());
+}
+
+// static
+int32_t
+KvStoreHashTree::getLeafIndex(
+    std::string const& key, size_t fanout, size_t depth) {
+  uint64_t numLeaves = 1;
+  for (size_t level = 0; level < depth; ++level) {
+    numLeaves *= fanout;
+  }
+  // ATTN: This must be stable across nodes and builds, do not use std::hash
+  return static_cast<int32_t>(folly::hash::fnv64(key) % numLeaves);
+}
+
+// static
+int64_t
+KvStoreHashTree::getDigest(std::string const& key, int64_t hash) {
+  return static_cast<int64_t>(folly::hash::hash_128_to_64(
+      folly::hash::fnv64(key), static_cast<uint64_t>(hash)));
+}
+
+void
+KvStoreHashTree::update(
+    std::string const& key,
+    std::optional<int64_t> const& oldHash,
+    std::optional<int64_t> const& newHash) {
+  if (oldHash == newHash) {
+    return;
+  }
+
+  int64_t delta{0};
+  if (oldHash.has_value()) {
+    delta ^= getDigest(key, *oldHash);
+  }
+  if (newHash.has_value()) {
+    delta ^= getDigest(key, *newHash);
+  }
+
+  // propagate the change from leaf up to the root
+  size_t index = getLeafIndex(key);
+  for (int level = depth_; level >= 0; --level) {
+    levels_[level][index] ^= delta;
+    index /= fanout_;
+  }
+}
+
+std::map<int32_t, int64_t>
+KvStoreHashTree::getChildren(
+    int32_t level, std::vector<int32_t> const& indices) const {
+  std::map<int32_t, int64_t> children;
+  if (level < 0 or static_cast<size_t>(level) >= depth_) {
+    return children;
+  }
+  auto const& nodes = levels_.at(level);
+  auto const& childNodes = levels_.at(level + 1);
+  for (auto index : indices) {
+    if (index < 0 or static_cast<size_t>(index) >= nodes.size()) {
+      continue;
+    }
+    for (size_t i = 0; i < fanout_; ++i) {
+      size_t childIndex = index * fanout_ + i;
+      children.emplace(childIndex, childNodes.at(childIndex));
+    }
+  }
+  return children;
+}
+
+std::vector<int32_t>
+KvStoreHashTree::getDifferingNodes(
+    int32_t level, std::map<int32_t, int64_t> const& nodes) const {
+  std::vector<int32_t> differingNodes;
+  if (level < 0 or static_cast<size_t>(level) > depth_) {
+    return differingNodes;
+  }
+  auto const& myNodes = levels_.at(level);
+  for (auto const& [index, hash] : nodes) {
+    if (index < 0 or static_cast<size_t>(index) >= myNodes.size()) {
+      continue;
+    }
+    if (myNodes.at(index) != hash) {
+      differingNodes.emplace_back(index);
+    }
+  }
+  return differingNodes;
+}
+
+} // namespace openr
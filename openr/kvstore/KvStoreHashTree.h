@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openr {
+
+/**
+ * Hash tree (Merkle tree) index over the key-vals of a KvStoreDb instance.
+ *
+ * Every key is placed into a leaf bucket based on a stable hash of the key.
+ * Hash of a leaf is the XOR of the digests of all keys in the bucket, where
+ * digest of a key covers the key itself and the hash of
+ * <version, originatorId, value>. Hash of an internal node is the XOR of its
+ * children. This allows each key update to be applied in O(depth) without
+ * re-hashing any sibling.
+ *
+ * Two stores with identical key-vals have identical trees. A full-sync
+ * initiator can thus walk down from the root towards differing subtrees and
+ * exchange hashes of the keys under differing leaves only.
+ *
+ * Nodes are addressed with (level, index). Level 0 is the root and level
+ * `depth` holds `fanout ^ depth` leaves. Children of node `i` at level `l`
+ * are nodes `[i * fanout, (i + 1) * fanout)` at level `l + 1`.
+ */
+class KvStoreHashTree {
+ public:
+  KvStoreHashTree(size_t fanout, size_t depth);
+
+  // Leaf bucket of a key for the given tree shape. This is static so that a
+  // store without the index maintained can still serve leaf-scoped dumps
+  static int32_t getLeafIndex(
+      std::string const& key, size_t fanout, size_t depth);
+
+  int32_t
+  getLeafIndex(std::string const& key) const {
+    return getLeafIndex(key, fanout_, depth_);
+  }
+
+  // Update the index for a key. `oldHash` is the hash of the value being
+  // replaced (none for a new key) and `newHash` is the hash of the new
+  // value (none if the key is removed)
+  void update(
+      std::string const& key,
+      std::optional<int64_t> const& oldHash,
+      std::optional<int64_t> const& newHash);
+
+  // Return hashes of the children of requested nodes at `level`. Invalid
+  // indices are ignored. Returned map is keyed by index at `level + 1`
+  std::map<int32_t, int64_t> getChildren(
+      int32_t level, std::vector<int32_t> const& indices) const;
+
+  // Return indices of the nodes at `level` for which the hash differs from
+  // the given one. Nodes missing in `nodes` are ignored
+  std::vector<int32_t> getDifferingNodes(
+      int32_t level, std::map<int32_t, int64_t> const& nodes) const;
+
+  int64_t
+  getRootHash() const {
+    return levels_.front().front();
+  }
+
+  size_t
+  getFanout() const {
+    return fanout_;
+  }
+
+  size_t
+  getDepth() const {
+    return depth_;
+  }
+
+ private:
+  // digest of a key-val pair contributed to its leaf
+  static int64_t getDigest(std::string const& key, int64_t hash);
+
+  const size_t fanout_{0};
+  const size_t depth_{0};
+
+  // levels_[l] contains hashes of all nodes at level l
+  std::vector<std::vector<int64_t>> levels_;
+};
+
+} // namespace openr
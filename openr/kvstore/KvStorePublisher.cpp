@@ -16,17 +16,84 @@
 #include <openr/common/Util.h>
 #include <openr/if/gen-cpp2/PersistentStore_types.h>
 #include <openr/kvstore/KvStore.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 
 namespace openr {
 
+KvStoreChangeLog::KvStoreChangeLog(size_t maxSize, int64_t startSeqNum)
+    : maxSize_(maxSize), startSeqNum_(startSeqNum) {
+  CHECK_GT(maxSize_, 0) << "Change log must hold at-least one publication";
+}
+
+KvStorePublicationPtr
+KvStoreChangeLog::append(thrift::Publication pub) {
+  auto& log = logs_.try_emplace(pub.get_area(), AreaLog{startSeqNum_, {}})
+                  .first->second;
+  pub.seqNum_ref() = log.nextSeqNum++;
+  auto ptr = std::make_shared<const thrift::Publication>(std::move(pub));
+  log.pubs.emplace_back(ptr);
+  if (log.pubs.size() > maxSize_) {
+    log.pubs.pop_front();
+  }
+  return ptr;
+}
+
+int64_t
+KvStoreChangeLog::getLastSeqNum(std::string const& area) const {
+  auto it = logs_.find(area);
+  return it == logs_.end() ? startSeqNum_ - 1 : it->second.nextSeqNum - 1;
+}
+
+std::optional<thrift::Publication>
+KvStoreChangeLog::getChangesSince(
+    std::string const& area, int64_t seqNum) const {
+  const int64_t lastSeqNum = getLastSeqNum(area);
+  auto it = logs_.find(area);
+  const int64_t firstSeqNum = it == logs_.end()
+      ? startSeqNum_
+      : lastSeqNum + 1 - static_cast<int64_t>(it->second.pubs.size());
+  if (seqNum < firstSeqNum - 1 or seqNum > lastSeqNum) {
+    return std::nullopt;
+  }
+
+  thrift::Publication merged;
+  merged.area_ref() = area;
+  merged.seqNum_ref() = lastSeqNum;
+  merged.isIncremental_ref() = true;
+  if (seqNum == lastSeqNum) {
+    return merged;
+  }
+
+  auto& keyVals = *merged.keyVals_ref();
+  std::set<std::string> expiredKeys;
+  const auto& pubs = it->second.pubs;
+  for (auto pubIt = pubs.end() - (lastSeqNum - seqNum); pubIt != pubs.end();
+       ++pubIt) {
+    for (auto const& [key, val] : *(*pubIt)->keyVals_ref()) {
+      auto kvIt = keyVals.find(key);
+      if (val.value_ref().has_value() or kvIt == keyVals.end()) {
+        keyVals.insert_or_assign(key, val);
+      } else {
+        // TTL update of a key changed earlier. Retain its value
+        kvIt->second.ttl_ref() = *val.ttl_ref();
+        kvIt->second.ttlVersion_ref() = *val.ttlVersion_ref();
+      }
+      expiredKeys.erase(key);
+    }
+    for (auto const& key : *(*pubIt)->expiredKeys_ref()) {
+      keyVals.erase(key);
+      expiredKeys.emplace(key);
+    }
+  }
+  merged.expiredKeys_ref() =
+      std::vector<std::string>(expiredKeys.begin(), expiredKeys.end());
+  return merged;
+}
+
 KvStorePublisher::KvStorePublisher(
-    std::set<std::string> const& selectAreas,
-    thrift::KeyDumpParams filter,
-    apache::thrift::ServerStreamPublisher<thrift::Publication>&& publisher)
-    : selectAreas_(selectAreas),
-      filter_(filter),
-      publisher_(std::move(publisher)) {
+    std::set<std::string> const& selectAreas, thrift::KeyDumpParams filter)
+    : selectAreas_(selectAreas), filter_(filter) {
   std::vector<std::string> keyPrefix;
 
   if (filter.keys_ref().has_value()) {
@@ -39,6 +106,36 @@ KvStorePublisher::KvStorePublisher(
       KvStoreFilters(keyPrefix, std::move(*filter.originatorIds_ref()));
 }
 
+std::string
+KvStorePublisher::getGroupKey(
+    std::set<std::string> const& selectAreas,
+    thrift::KeyDumpParams const& filter) {
+  // NOTE: serialization is deterministic as filter holds ordered containers
+  // only. Area names can't contain separator
+  return folly::join(",", selectAreas) + '\0' +
+      apache::thrift::CompactSerializer::serialize<std::string>(filter);
+}
+
+void
+KvStorePublisher::addStream(
+    int64_t clientToken,
+    apache::thrift::ServerStreamPublisher<thrift::Publication>&& publisher) {
+  publishers_.emplace(clientToken, std::move(publisher));
+}
+
+void
+KvStorePublisher::addStream(
+    int64_t clientToken,
+    apache::thrift::ServerStreamPublisher<folly::IOBuf>&& publisher) {
+  serializedPublishers_.emplace(clientToken, std::move(publisher));
+}
+
+bool
+KvStorePublisher::removeStream(int64_t clientToken) {
+  return publishers_.erase(clientToken) or
+      serializedPublishers_.erase(clientToken);
+}
+
 /**
  * A publication object (param) can have multiple key value pairs as follows.
  * pub = {"prefix1": value1, "prefix2": value2, "random-key": random-value}
@@ -60,18 +157,48 @@ KvStorePublisher::publish(const thrift::Publication& pub) {
     LOG(INFO) << "Skipping pub not in selectAreas";
     return;
   }
-  if ((not filter_.keys_ref().has_value() or (*filter_.keys_ref()).empty()) and
-      (not filter_.originatorIds_ref().has_value() or
-       (*filter_.originatorIds_ref()).empty()) and
-      not*filter_.ignoreTtl_ref() and not*filter_.doNotPublishValue_ref()) {
-    // No filtering criteria. Accept all updates as TTL updates are not be
-    // to be updated. If we don't optimize here, we will have go through
-    // key values of a publication and copy them.
-    auto filteredPub = std::make_unique<thrift::Publication>(pub);
-    publisher_.next(std::move(*filteredPub));
-    return;
+  const thrift::Publication* toPublish = &pub;
+  std::optional<thrift::Publication> publication_filtered;
+  if ((filter_.keys_ref().has_value() and not(*filter_.keys_ref()).empty()) or
+      (filter_.originatorIds_ref().has_value() and
+       not(*filter_.originatorIds_ref()).empty()) or
+      *filter_.ignoreTtl_ref() or *filter_.doNotPublishValue_ref()) {
+    // Without filtering criteria all updates are accepted as is. Otherwise
+    // key values of publication are filtered and copied, once for all streams
+    publication_filtered = applyFilter(pub);
+    if (publication_filtered->keyVals_ref()->empty()) {
+      // No key value in the publication for the clients
+      return;
+    }
+    toPublish = &publication_filtered.value();
   }
 
+  for (auto& [_, publisher] : publishers_) {
+    publisher.next(*toPublish);
+  }
+  if (not serializedPublishers_.empty()) {
+    const auto buf =
+        apache::thrift::CompactSerializer::serialize<folly::IOBuf>(*toPublish);
+    for (auto& [_, publisher] : serializedPublishers_) {
+      publisher.next(buf.cloneAsValue());
+    }
+  }
+}
+
+std::optional<thrift::Publication>
+KvStorePublisher::getIncrementalSnapshot(
+    KvStoreChangeLog const& changeLog,
+    std::string const& area,
+    int64_t seqNum) const {
+  auto changes = changeLog.getChangesSince(area, seqNum);
+  if (not changes.has_value()) {
+    return std::nullopt;
+  }
+  return applyFilter(*changes);
+}
+
+thrift::Publication
+KvStorePublisher::applyFilter(const thrift::Publication& pub) const {
   thrift::Publication publication_filtered;
   if (pub.expiredKeys_ref().has_value()) {
     publication_filtered.expiredKeys_ref() = *pub.expiredKeys_ref();
@@ -93,6 +220,9 @@ KvStorePublisher::publish(const thrift::Publication& pub) {
     publication_filtered.area_ref() = *pub.area_ref();
   }
 
+  publication_filtered.seqNum_ref().copy_from(pub.seqNum_ref());
+  publication_filtered.isIncremental_ref().copy_from(pub.isIncremental_ref());
+
   thrift::KeyVals keyvals;
   thrift::FilterOperator op = filter_.oper_ref().has_value()
       ? *filter_.oper_ref()
@@ -119,10 +249,7 @@ KvStorePublisher::publish(const thrift::Publication& pub) {
     }
   }
 
-  if (keyvals.size()) {
-    // There is at least one key value in the publication for the client
-    publication_filtered.keyVals_ref() = keyvals;
-    publisher_.next(std::move(publication_filtered));
-  }
+  publication_filtered.keyVals_ref() = std::move(keyvals);
+  return publication_filtered;
 }
 } // namespace openr
@@ -7,7 +7,11 @@
 
 #pragma once
 
+#include <deque>
+#include <optional>
+
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/io/IOBuf.h>
 #include <openr/common/Types.h>
 #include <openr/config/Config.h>
 #include <openr/if/gen-cpp2/KvStore_constants.h>
@@ -16,29 +20,129 @@
 #include <openr/kvstore/KvStore.h>
 
 namespace openr {
+
+/**
+ * Bounded in-memory log of recent KvStore publications per area. Every
+ * publication is assigned a sequence number, monotonically increasing per
+ * area, which subscribers use as cursor to resume a subscription with only
+ * the changes they have missed.
+ *
+ * Sequence numbers start from `startSeqNum`, usually derived from the start
+ * time of the process, so that cursors of a previous process are never mixed
+ * up with the ones of current process.
+ */
+class KvStoreChangeLog {
+ public:
+  KvStoreChangeLog(size_t maxSize, int64_t startSeqNum);
+
+  // Append publication to the log of its area. Return stored publication
+  // with its sequence number set
+  KvStorePublicationPtr append(thrift::Publication pub);
+
+  // Sequence number of last publication of an area. Areas without any
+  // publication yet report `startSeqNum - 1`
+  int64_t getLastSeqNum(std::string const& area) const;
+
+  // Merge all publications of an area after `seqNum` into one publication.
+  // Return std::nullopt if log doesn't hold all of them anymore or cursor is
+  // unknown, in which case subscriber needs a full dump
+  std::optional<thrift::Publication> getChangesSince(
+      std::string const& area, int64_t seqNum) const;
+
+ private:
+  struct AreaLog {
+    // sequence number of next publication. `pubs.front()` has sequence
+    // number `nextSeqNum - pubs.size()`
+    int64_t nextSeqNum{0};
+    std::deque<KvStorePublicationPtr> pubs;
+  };
+
+  const size_t maxSize_{0};
+  const int64_t startSeqNum_{0};
+
+  std::unordered_map<std::string, AreaLog> logs_;
+};
+
+// Snapshots built for a subscription from change log
+struct KvStoreSubscriptionSnapshots {
+  // incremental snapshots of areas resumed from their cursor
+  std::vector<thrift::Publication> publications;
+  // map<area: cursor> of selected areas at the time of subscription
+  std::unordered_map<std::string, int64_t> seqNums;
+};
+
+/**
+ * Publisher of KvStore changes to all streams subscribed with the same filter
+ * and set of areas. Every publication is filtered once for all of them, and
+ * serialized once for all serialized streams.
+ */
 class KvStorePublisher {
  public:
   KvStorePublisher(
+      std::set<std::string> const& selectAreas, thrift::KeyDumpParams filter);
+
+  ~KvStorePublisher() {}
+
+  // Key identifying subscriptions which can share a publisher
+  static std::string getGroupKey(
       std::set<std::string> const& selectAreas,
-      thrift::KeyDumpParams filter,
+      thrift::KeyDumpParams const& filter);
+
+  // Add stream of client. Serialized streams receive publications serialized
+  // with CompactSerializer
+  void addStream(
+      int64_t clientToken,
       apache::thrift::ServerStreamPublisher<thrift::Publication>&& publisher);
+  void addStream(
+      int64_t clientToken,
+      apache::thrift::ServerStreamPublisher<folly::IOBuf>&& publisher);
 
-  ~KvStorePublisher() {}
+  // Remove stream of client. Return false if client is unknown
+  bool removeStream(int64_t clientToken);
+
+  size_t
+  getNumStreams() const {
+    return publishers_.size() + serializedPublishers_.size();
+  }
 
   // Invoked whenever there is change. Apply filter and publish changes
   void publish(const thrift::Publication& pub);
 
+  // Build snapshot of an area from changes in change log since the cursor,
+  // with filter applied. Return std::nullopt if change log can't cover it
+  std::optional<thrift::Publication> getIncrementalSnapshot(
+      KvStoreChangeLog const& changeLog,
+      std::string const& area,
+      int64_t seqNum) const;
+
+  // Complete all streams with the same arguments
   template <class... Args>
   void
-  complete(Args&&... args) {
-    std::move(publisher_).complete(std::forward<Args>(args)...);
+  complete(Args const&... args) {
+    for (auto& [_, publisher] : publishers_) {
+      std::move(publisher).complete(args...);
+    }
+    for (auto& [_, publisher] : serializedPublishers_) {
+      std::move(publisher).complete(args...);
+    }
   }
 
  private:
+  // Apply filter on key-values of publication. Other attributes are retained
+  thrift::Publication applyFilter(const thrift::Publication& pub) const;
+
   // set of areas whose updates should be published. If empty, publish all
   std::set<std::string> selectAreas_;
   thrift::KeyDumpParams filter_;
   KvStoreFilters keyPrefixFilter_{{}, {}};
-  apache::thrift::ServerStreamPublisher<thrift::Publication> publisher_;
+  // streams by client token
+  std::unordered_map<
+      int64_t,
+      apache::thrift::ServerStreamPublisher<thrift::Publication>>
+      publishers_;
+  std::unordered_map<
+      int64_t,
+      apache::thrift::ServerStreamPublisher<folly::IOBuf>>
+      serializedPublishers_;
 };
 } // namespace openr
@@ -0,0 +1,37 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/kvstore/KvStoreStringPool.h>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+std::string const*
+KvStoreStringPool::intern(std::string const& str) {
+  auto [it, inserted] = strings_.try_emplace(str, 0);
+  if (inserted) {
+    bytes_ += str.size();
+  }
+  ++it->second;
+  refBytes_ += str.size();
+  // ATTN: key of unordered_map node is stable till the node is erased
+  return &it->first;
+}
+
+void
+KvStoreStringPool::release(std::string const* str) {
+  auto it = strings_.find(*str);
+  CHECK(it != strings_.end()) << "Releasing string not in the pool: " << *str;
+  refBytes_ -= it->first.size();
+  if (--it->second == 0) {
+    bytes_ -= it->first.size();
+    strings_.erase(it);
+  }
+}
+
+} // namespace openr
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+namespace openr {
+
+/**
+ * Reference counted pool of interned strings, i.e. originator-ids of entries
+ * of KvStoreTtlWheel shared by many keys. Each distinct string is stored once
+ * and handed out as a stable pointer which stays valid until the last
+ * reference to it is released.
+ */
+class KvStoreStringPool {
+ public:
+  // Return pointer to the interned copy of `str` and take a reference on it
+  std::string const* intern(std::string const& str);
+
+  // Release a reference taken with `intern()`. String is removed from the
+  // pool with its last reference
+  void release(std::string const* str);
+
+  // Number of distinct strings in the pool
+  size_t
+  size() const {
+    return strings_.size();
+  }
+
+  // Number of bytes of all distinct strings in the pool
+  size_t
+  getBytes() const {
+    return bytes_;
+  }
+
+  // Number of bytes saved against keeping a copy per reference
+  size_t
+  getSavedBytes() const {
+    return refBytes_ - bytes_;
+  }
+
+ private:
+  // map<string: number-of-references>
+  std::unordered_map<std::string, size_t> strings_;
+
+  // total size of distinct strings and of strings over all references
+  size_t bytes_{0};
+  size_t refBytes_{0};
+};
+
+} // namespace openr
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/kvstore/KvStoreTtlWheel.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+constexpr size_t KvStoreTtlWheel::kNumSlotBits;
+constexpr size_t KvStoreTtlWheel::kNumSlots;
+constexpr size_t KvStoreTtlWheel::kNumLevels;
+
+KvStoreTtlWheel::KvStoreTtlWheel(
+    std::chrono::milliseconds tick,
+    std::chrono::steady_clock::time_point startTime)
+    : tick_(tick), startTime_(startTime) {
+  CHECK_GT(tick_.count(), 0) << "TTL wheel tick must be positive";
+}
+
+uint64_t
+KvStoreTtlWheel::toTick(
+    std::chrono::steady_clock::time_point time, bool roundUp) const {
+  if (time <= startTime_) {
+    return 0;
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      time - startTime_);
+  const auto tickNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(tick_).count();
+  return roundUp ? (elapsed.count() + tickNs - 1) / tickNs
+                 : elapsed.count() / tickNs;
+}
+
+void
+KvStoreTtlWheel::setEntry(Node& node, TtlCountdownEntry&& entry) {
+  auto const* originatorId = originatorIds_.intern(entry.originatorId);
+  if (node.originatorId) {
+    originatorIds_.release(node.originatorId);
+  }
+  node.originatorId = originatorId;
+  node.expiryTime = entry.expiryTime;
+  node.version = entry.version;
+  node.ttlVersion = entry.ttlVersion;
+  node.expiryTick = toTick(entry.expiryTime, true /* roundUp */);
+}
+
+TtlCountdownEntry
+KvStoreTtlWheel::toEntry(std::string const& key, Node const& node) {
+  TtlCountdownEntry entry;
+  entry.expiryTime = node.expiryTime;
+  entry.key = key;
+  entry.version = node.version;
+  entry.ttlVersion = node.ttlVersion;
+  entry.originatorId = *node.originatorId;
+  return entry;
+}
+
+void
+KvStoreTtlWheel::insert(
+    std::string const& key,
+    Node& node,
+    uint64_t minTick,
+    SlotKeys* from,
+    SlotKeys::iterator pos) {
+  // ATTN: expiry beyond span of the wheel is parked at the top level and
+  //       re-inserted when it is cascaded down
+  const uint64_t maxDelta = (uint64_t{1} << (kNumSlotBits * kNumLevels)) - 1;
+  const uint64_t delta =
+      std::min(std::max(node.expiryTick, minTick) - currentTick_, maxDelta);
+  const uint64_t slotTick = currentTick_ + delta;
+
+  size_t level = 0;
+  while (delta >> (kNumSlotBits * (level + 1))) {
+    ++level;
+  }
+  node.level = static_cast<uint8_t>(level);
+  node.slot = static_cast<uint8_t>(
+      (slotTick >> (kNumSlotBits * level)) & (kNumSlots - 1));
+
+  auto& target = slots_[level][node.slot];
+  if (from) {
+    target.splice(target.end(), *from, pos);
+    node.pos = pos;
+  } else {
+    node.pos = target.emplace(target.end(), &key);
+  }
+  ++levelSizes_[level];
+}
+
+void
+KvStoreTtlWheel::upsert(TtlCountdownEntry entry) {
+  auto it = entries_.find(entry.key);
+  if (it == entries_.end()) {
+    auto key = std::move(entry.key);
+    it = entries_.emplace(std::move(key), Node{}).first;
+    setEntry(it->second, std::move(entry));
+    insert(it->first, it->second, currentTick_ + 1);
+    return;
+  }
+
+  // refresh existing entry by moving it to the new slot
+  auto& node = it->second;
+  setEntry(node, std::move(entry));
+  --levelSizes_[node.level];
+  insert(
+      it->first,
+      node,
+      currentTick_ + 1,
+      &slots_[node.level][node.slot],
+      node.pos);
+}
+
+void
+KvStoreTtlWheel::erase(std::string const& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return;
+  }
+  auto& node = it->second;
+  slots_[node.level][node.slot].erase(node.pos);
+  --levelSizes_[node.level];
+  originatorIds_.release(node.originatorId);
+  entries_.erase(it);
+}
+
+std::optional<TtlCountdownEntry>
+KvStoreTtlWheel::find(std::string const& key) const {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  return toEntry(it->first, it->second);
+}
+
+void
+KvStoreTtlWheel::cascade(size_t level) {
+  const size_t slot =
+      (currentTick_ >> (kNumSlotBits * level)) & (kNumSlots - 1);
+  // cascade higher level first as it can only fill lower levels
+  if (slot == 0 and level + 1 < kNumLevels) {
+    cascade(level + 1);
+  }
+
+  auto& keys = slots_[level][slot];
+  while (not keys.empty()) {
+    auto pos = keys.begin();
+    auto const& key = **pos;
+    auto& node = entries_.at(key);
+    --levelSizes_[level];
+    insert(key, node, currentTick_, &keys, pos);
+  }
+}
+
+std::vector<TtlCountdownEntry>
+KvStoreTtlWheel::advance(std::chrono::steady_clock::time_point now) {
+  std::vector<TtlCountdownEntry> expired;
+  const uint64_t nowTick = toTick(now, false /* roundUp */);
+
+  while (currentTick_ < nowTick) {
+    if (entries_.empty()) {
+      currentTick_ = nowTick;
+      break;
+    }
+    if (levelSizes_[0] == 0) {
+      // nothing expires before next cascade, skip rest of level-0 rotation
+      const uint64_t lastTick = currentTick_ | (kNumSlots - 1);
+      if (lastTick >= nowTick) {
+        currentTick_ = nowTick;
+        break;
+      }
+      currentTick_ = lastTick;
+    }
+
+    ++currentTick_;
+    if ((currentTick_ & (kNumSlots - 1)) == 0) {
+      cascade(1);
+    }
+
+    auto& keys = slots_[0][currentTick_ & (kNumSlots - 1)];
+    while (not keys.empty()) {
+      auto pos = keys.begin();
+      auto it = entries_.find(**pos);
+      auto& node = it->second;
+      --levelSizes_[0];
+      if (node.expiryTick > currentTick_) {
+        // parked entry of long expiry, move it further
+        insert(it->first, node, currentTick_ + 1, &keys, pos);
+        continue;
+      }
+      keys.erase(pos);
+      expired.emplace_back(toEntry(it->first, node));
+      originatorIds_.release(node.originatorId);
+      entries_.erase(it);
+    }
+  }
+  return expired;
+}
+
+std::optional<std::chrono::milliseconds>
+KvStoreTtlWheel::getNextTimeout(
+    std::chrono::steady_clock::time_point now) const {
+  if (entries_.empty()) {
+    return std::nullopt;
+  }
+
+  // wheel must be advanced at-least at next level-0 rotation to cascade
+  // entries of higher levels
+  uint64_t nextTick = std::numeric_limits<uint64_t>::max();
+  if (levelSizes_[0] != entries_.size()) {
+    nextTick = (currentTick_ | (kNumSlots - 1)) + 1;
+  }
+  if (levelSizes_[0] > 0) {
+    for (uint64_t tick = currentTick_ + 1; tick < nextTick; ++tick) {
+      if (not slots_[0][tick & (kNumSlots - 1)].empty()) {
+        nextTick = tick;
+        break;
+      }
+    }
+  }
+
+  const auto nextTime = startTime_ + tick_ * static_cast<int64_t>(nextTick);
+  return std::max(
+      std::chrono::milliseconds(0),
+      std::chrono::ceil<std::chrono::milliseconds>(nextTime - now));
+}
+
+} // namespace openr
@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <openr/kvstore/KvStoreStringPool.h>
+
+namespace openr {
+
+// TTL countdown entry of a key. Key expires at `expiryTime` unless it is
+// refreshed or updated before
+struct TtlCountdownEntry {
+  std::chrono::steady_clock::time_point expiryTime;
+  std::string key;
+  int64_t version{0};
+  int64_t ttlVersion{0};
+  std::string originatorId;
+};
+
+/**
+ * Hierarchical timing wheel tracking TTL expiry of KvStore keys.
+ *
+ * There is at most one entry per key. Adding, refreshing and removing an
+ * entry is O(1) and doesn't leave stale entries behind. Wheel has `kNumLevels`
+ * levels of `kNumSlots` slots each. A slot at level `l` spans
+ * `kNumSlots ^ l` ticks. Entries of a higher level slot are cascaded down to
+ * lower levels when the wheel reaches the slot. Expiry is precise up to one
+ * tick.
+ *
+ * Entries are kept compact: key is stored once and referenced from its slot,
+ * and originator-ids are interned as they are shared by many keys.
+ */
+class KvStoreTtlWheel {
+ public:
+  static constexpr size_t kNumSlotBits{8};
+  static constexpr size_t kNumSlots{1 << kNumSlotBits};
+  static constexpr size_t kNumLevels{4};
+
+  explicit KvStoreTtlWheel(
+      std::chrono::milliseconds tick,
+      std::chrono::steady_clock::time_point startTime =
+          std::chrono::steady_clock::now());
+
+  // Add entry for a key or replace existing one
+  void upsert(TtlCountdownEntry entry);
+
+  // Remove entry of a key if any
+  void erase(std::string const& key);
+
+  // Return entry of a key, std::nullopt if not found
+  std::optional<TtlCountdownEntry> find(std::string const& key) const;
+
+  // Advance wheel till `now` and return all entries expired by then
+  std::vector<TtlCountdownEntry> advance(
+      std::chrono::steady_clock::time_point now);
+
+  // Time till the wheel must be advanced next. std::nullopt if wheel is empty
+  std::optional<std::chrono::milliseconds> getNextTimeout(
+      std::chrono::steady_clock::time_point now) const;
+
+  size_t
+  size() const {
+    return entries_.size();
+  }
+
+  bool
+  empty() const {
+    return entries_.empty();
+  }
+
+  // Number of entries at each level of the wheel
+  std::array<size_t, kNumLevels>
+  getLevelSizes() const {
+    return levelSizes_;
+  }
+
+  // Pool of interned originator-ids of all entries
+  KvStoreStringPool const&
+  getOriginatorIds() const {
+    return originatorIds_;
+  }
+
+ private:
+  // key-list of a slot. Keys point to the keys of `entries_`
+  using SlotKeys = std::list<std::string const*>;
+
+  static_assert(kNumLevels <= 256 and kNumSlots <= 256);
+
+  struct Node {
+    std::chrono::steady_clock::time_point expiryTime;
+    int64_t version{0};
+    int64_t ttlVersion{0};
+    // interned in `originatorIds_`
+    std::string const* originatorId{nullptr};
+    uint64_t expiryTick{0};
+    uint8_t level{0};
+    uint8_t slot{0};
+    SlotKeys::iterator pos;
+  };
+
+  // set node attributes from entry except for its position in the wheel
+  void setEntry(Node& node, TtlCountdownEntry&& entry);
+
+  // build entry from the node of a key
+  static TtlCountdownEntry toEntry(std::string const& key, Node const& node);
+
+  // place node of a key into a slot based on its expiry relative to current
+  // tick. Node expires no earlier than `minTick`. If `from` is given, node is
+  // moved from given position instead of being added
+  void insert(
+      std::string const& key,
+      Node& node,
+      uint64_t minTick,
+      SlotKeys* from = nullptr,
+      SlotKeys::iterator pos = {});
+
+  // re-insert entries of current slot at `level` into lower levels
+  void cascade(size_t level);
+
+  // convert time to ticks since start time. Round up if `roundUp` is set
+  uint64_t toTick(std::chrono::steady_clock::time_point time, bool roundUp)
+      const;
+
+  const std::chrono::milliseconds tick_;
+  const std::chrono::steady_clock::time_point startTime_;
+
+  // last processed tick
+  uint64_t currentTick_{0};
+
+  // slots_[level][slot] => keys in the slot
+  std::array<std::array<SlotKeys, kNumSlots>, kNumLevels> slots_;
+  std::array<size_t, kNumLevels> levelSizes_{};
+
+  std::unordered_map<std::string, Node> entries_;
+
+  KvStoreStringPool originatorIds_;
+};
+
+} // namespace openr
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <functional>
+
 #include <openr/common/OpenrClient.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
 #include <openr/kvstore/KvStore.h>
@@ -53,7 +55,8 @@ dumpAllWithPrefixMultipleAndParse(
     const std::shared_ptr<folly::SSLContext> sslContext,
     std::optional<int> maybeIpTos /* std::nullopt */,
     const folly::SocketAddress&
-        bindAddr /* folly::AsyncSocket::anyAddress()*/) {
+        bindAddr /* folly::AsyncSocket::anyAddress()*/,
+    size_t maxConcurrency /* Constants::kKvStoreDumpMaxConcurrency */) {
   auto val = dumpAllWithThriftClientFromMultiple(
       area,
       sockAddrs,
@@ -62,7 +65,8 @@ dumpAllWithPrefixMultipleAndParse(
       processTimeout,
       sslContext,
       maybeIpTos,
-      bindAddr);
+      bindAddr,
+      maxConcurrency);
   if (not val.first) {
     return std::make_pair(std::nullopt, val.second);
   }
@@ -82,9 +86,9 @@ dumpAllWithThriftClientFromMultiple(
     const std::shared_ptr<folly::SSLContext> sslContext,
     std::optional<int> maybeIpTos /* std::nullopt */,
     const folly::SocketAddress&
-        bindAddr /* folly::AsyncSocket::anyAddress()*/) {
+        bindAddr /* folly::AsyncSocket::anyAddress()*/,
+    size_t maxConcurrency /* Constants::kKvStoreDumpMaxConcurrency */) {
   folly::EventBase evb;
-  std::vector<folly::SemiFuture<thrift::Publication>> calls;
   std::unordered_map<std::string, thrift::Value> merged;
   std::vector<fbzmq::SocketUrl> unreachedUrls;
 
@@ -106,8 +110,7 @@ dumpAllWithThriftClientFromMultiple(
             << ". Required SSL secure connection: " << std::boolalpha
             << (sslContext != nullptr);
 
-  auto startTime = std::chrono::steady_clock::now();
-  for (auto const& sockAddr : sockAddrs) {
+  auto getClient = [&](const folly::SocketAddress& sockAddr) {
     std::unique_ptr<thrift::OpenrCtrlCppAsyncClient> client{nullptr};
     if (sslContext) {
       VLOG(2) << "Try to connect Open/R SSL secure client.";
@@ -148,53 +151,80 @@ dumpAllWithThriftClientFromMultiple(
             << "via plain-text client. Exception: " << folly::exceptionStr(ex);
       }
     }
+    return client;
+  };
+
+  // Dumps run concurrently, up to `maxConcurrency` in flight. Every response
+  // is merged and released as soon as it arrives, rather than once all of
+  // them are collected. Everything below runs in evb thread, hence without
+  // locking
+  std::unordered_map<
+      size_t /* index of sockAddr */,
+      std::unique_ptr<thrift::OpenrCtrlCppAsyncClient>>
+      clients;
+  size_t nextIndex{0};
+  size_t numResponses{0};
+  std::function<void()> dumpNext;
+  dumpNext = [&]() {
+    while (nextIndex < sockAddrs.size() and
+           clients.size() < std::max<size_t>(1, maxConcurrency)) {
+      const auto index = nextIndex++;
+      const auto& sockAddr = sockAddrs.at(index);
+      auto client = getClient(sockAddr);
+
+      // Cannot connect to Open/R via either plain-text or secured client
+      if (!client) {
+        unreachedUrls.push_back(fbzmq::SocketUrl{sockAddr.getAddressStr()});
+        continue;
+      }
 
-    // Cannot connect to Open/R via either plain-text client or secured client
-    if (!client) {
-      unreachedUrls.push_back(fbzmq::SocketUrl{sockAddr.getAddressStr()});
-      continue;
+      VLOG(3) << "Successfully connected to Open/R with addr: "
+              << sockAddr.getAddressStr();
+
+      // Bound time an endpoint takes to connect and respond, so that a slow
+      // instance doesn't hold up the others
+      (area ? client->semifuture_getKvStoreKeyValsFilteredArea(params, *area)
+            : client->semifuture_getKvStoreKeyValsFiltered(params))
+          .via(&evb)
+          .within(connectTimeout + processTimeout)
+          .thenTry([&, index](folly::Try<thrift::Publication>&& result) {
+            const auto& addr = sockAddrs.at(index).getAddressStr();
+            // folly::Try will contain either value or exception
+            // Do NOT CHECK(result.hasValue()) since exception can happen.
+            if (result.hasException()) {
+              LOG(ERROR) << "Failed to dump key-vals from " << addr
+                         << ". Exception: "
+                         << folly::exceptionStr(result.exception());
+              unreachedUrls.push_back(fbzmq::SocketUrl{addr});
+            } else {
+              ++numResponses;
+              auto& keyVals = *result.value().keyVals_ref();
+              const auto deltaPub = KvStore::mergeKeyValues(merged, keyVals);
+              VLOG(1) << "Received kvstore publication from " << addr
+                      << " with: " << keyVals.size() << " key-vals. Incurred "
+                      << deltaPub.size() << " key-val updates.";
+            }
+            clients.erase(index);
+            dumpNext();
+          });
+      clients.emplace(index, std::move(client));
     }
 
-    VLOG(3) << "Successfully connected to Open/R with addr: "
-            << sockAddr.getAddressStr();
-
-    calls.emplace_back(
-        area ? client->semifuture_getKvStoreKeyValsFilteredArea(params, *area)
-             : client->semifuture_getKvStoreKeyValsFiltered(params));
-  }
-
-  // can't connect to ANY single Open/R instance
-  if (calls.empty()) {
-    return std::make_pair(std::nullopt, unreachedUrls);
-  }
+    if (clients.empty() and nextIndex == sockAddrs.size()) {
+      evb.terminateLoopSoon();
+    }
+  };
 
-  folly::collectAll(calls).via(&evb).thenValue(
-      [&](std::vector<folly::Try<openr::thrift::Publication>>&& results) {
-        LOG(INFO) << "Merge key-vals from " << results.size()
-                  << " different Open/R instances.";
-
-        // loop semifuture collection to merge all values
-        for (auto& result : results) {
-          // folly::Try will contain either value or exception
-          // Do NOT CHECK(result.hasValue()) since exception can happen.
-          if (result.hasException()) {
-            LOG(ERROR) << "Exception: "
-                       << folly::exceptionStr(result.exception());
-          } else if (result.hasValue()) {
-            auto keyVals = *result.value().keyVals_ref();
-            const auto deltaPub = KvStore::mergeKeyValues(merged, keyVals);
-
-            LOG(INFO) << "Received kvstore publication with: " << keyVals.size()
-                      << " key-vals. Incurred " << deltaPub.size()
-                      << " key-val updates.";
-          }
-        }
-        evb.terminateLoopSoon();
-      });
+  auto startTime = std::chrono::steady_clock::now();
+  evb.runInEventBaseThread([&]() { dumpNext(); });
 
   // magic happens here
   evb.loopForever();
 
+  LOG(INFO) << "Merged key-vals from " << numResponses
+            << " different Open/R instances, " << unreachedUrls.size()
+            << " unreached.";
+
   // record time used to fetch from all Open/R instances
   const auto elapsedTime =
       std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -203,7 +233,11 @@ dumpAllWithThriftClientFromMultiple(
 
   LOG(INFO) << "Took: " << elapsedTime << "ms to retrieve KvStore snapshot";
 
-  return std::make_pair(merged, unreachedUrls);
+  // can't dump from ANY single Open/R instance
+  if (not numResponses) {
+    return std::make_pair(std::nullopt, unreachedUrls);
+  }
+  return std::make_pair(std::move(merged), unreachedUrls);
 }
 
 } // namespace openr
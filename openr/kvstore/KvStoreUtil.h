@@ -42,6 +42,7 @@ static std::unordered_map<std::string, ThriftType> parseThriftValues(
  * @param connectTimeout - timeout value set on connecting
  * @param processTimeout - timeout value set on porcessing
  * @param bindAddr - source addr for binding purpose. Default will be ANY
+ * @param maxConcurrency - maximum number of instances dumped at once
  *
  * @return first member of the pair is key-value map obtained by merging data
  * from all stores. Null value if failed connecting and obtaining snapshot
@@ -61,18 +62,24 @@ dumpAllWithPrefixMultipleAndParse(
     std::chrono::milliseconds processTimeout = Constants::kServiceProcTimeout,
     const std::shared_ptr<folly::SSLContext> sslContext = nullptr,
     std::optional<int> maybeIpTos = std::nullopt,
-    const folly::SocketAddress& bindAddr = folly::AsyncSocket::anyAddress());
+    const folly::SocketAddress& bindAddr = folly::AsyncSocket::anyAddress(),
+    size_t maxConcurrency = Constants::kKvStoreDumpMaxConcurrency);
 
 /*
  * This will be a static method to do a full-dump of KvStore key-val to
  * multiple KvStore instances. It will fetch values from different KvStore
  * instances and merge them together to finally return thrift::Value
  *
+ * Instances are dumped concurrently and every response is merged as soon as
+ * it arrives. An instance which doesn't respond within connectTimeout +
+ * processTimeout is reported as unreached without holding up the others.
+ *
  * @param sockAddrs - (address, port) to connect OpenR instance to
  * @param prefix - the key prefix used for key dumping. Dump all if empty
  * @param connectTimeout - timeout value set on connecting
  * @param processTimeout - timeout value set on porcessing
  * @param bindAddr - source addr for binding purpose. Default will be ANY
+ * @param maxConcurrency - maximum number of instances dumped at once
  *
  * @return first member of the pair is key-value map obtained by merging data
  * from all stores. Null value if failed connecting and obtaining snapshot
@@ -91,7 +98,8 @@ dumpAllWithThriftClientFromMultiple(
     std::chrono::milliseconds processTimeout = Constants::kServiceProcTimeout,
     const std::shared_ptr<folly::SSLContext> sslContext = nullptr,
     std::optional<int> maybeIpTos = std::nullopt,
-    const folly::SocketAddress& bindAddr = folly::AsyncSocket::anyAddress());
+    const folly::SocketAddress& bindAddr = folly::AsyncSocket::anyAddress(),
+    size_t maxConcurrency = Constants::kKvStoreDumpMaxConcurrency);
 
 } // namespace openr
 
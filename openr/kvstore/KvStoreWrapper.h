@@ -54,7 +54,7 @@ class KvStoreWrapper {
   /**
    * Get reader for KvStore updates queue
    */
-  messaging::RQueue<thrift::Publication>
+  messaging::RQueue<KvStorePublicationPtr>
   getReader() {
     return kvStoreUpdatesQueue_.getReader();
   }
@@ -195,8 +195,8 @@ class KvStoreWrapper {
   apache::thrift::CompactSerializer serializer_;
 
   // Queue for streaming KvStore updates
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue_;
-  messaging::RQueue<thrift::Publication> kvStoreUpdatesQueueReader_{
+  messaging::ReplicateQueue<KvStorePublicationPtr> kvStoreUpdatesQueue_;
+  messaging::RQueue<KvStorePublicationPtr> kvStoreUpdatesQueueReader_{
       kvStoreUpdatesQueue_.getReader()};
 
   // Queue to get KvStore Initial Sync Updates
@@ -260,6 +260,65 @@ BM_KvStoreDumpAll(uint32_t iters, size_t numOfKeysInStore) {
   }
 }
 
+/**
+ * Benchmark for responding to full-sync request of a peer:
+ * 1. Start kvStore and set (key, value)s into it
+ * 2. Build hashes of peer which differ on 1% of keys in each direction
+ * 3. Benchmark the time for dumping the difference from hashes of peer
+ */
+static void
+BM_KvStoreDumpDifference(uint32_t iters, size_t numOfKeysInStore) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto kvStoreTestFixture = std::make_unique<KvStoreTestFixture>();
+  auto kvStore = kvStoreTestFixture->createKvStore("kvStore");
+  kvStore->run();
+
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  keyVals.reserve(numOfKeysInStore);
+  for (uint32_t idx = 0; idx < numOfKeysInStore; idx++) {
+    thrift::Value thriftVal(
+        apache::thrift::FRAGILE,
+        1 /* version */,
+        "kvStore" /* originatorId */,
+        genRandomStr(kSizeOfValue) /* value */,
+        Constants::kTtlInfinity /* ttl */,
+        0 /* ttl version */,
+        0 /* hash */);
+    thriftVal.hash_ref() = generateHash(
+        *thriftVal.version_ref(),
+        *thriftVal.originatorId_ref(),
+        thriftVal.value_ref());
+    keyVals.emplace_back(genRandomStr(kSizeOfKey), std::move(thriftVal));
+  }
+  kvStore->setKeys(kTestingAreaName, keyVals);
+
+  // every 100th key is missing on peer, is newer on peer or is peer only
+  auto keyValHashes = kvStore->dumpHashes(kTestingAreaName);
+  CHECK_EQ(numOfKeysInStore, keyValHashes.size());
+  size_t idx{0};
+  for (auto it = keyValHashes.begin(); it != keyValHashes.end(); ++idx) {
+    if (idx % 100 == 0) {
+      it = keyValHashes.erase(it);
+      continue;
+    }
+    if (idx % 100 == 1) {
+      it->second.version_ref() = *it->second.version_ref() + 1;
+    }
+    ++it;
+  }
+  for (idx = 0; idx < numOfKeysInStore / 100; idx++) {
+    keyValHashes.emplace(
+        genRandomStr(kSizeOfKey),
+        createThriftValue(1 /* version */, "peer", std::nullopt));
+  }
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; i++) {
+    folly::doNotOptimizeAway(
+        kvStore->syncKeyVals(kTestingAreaName, keyValHashes));
+  }
+}
+
 /**
  * Benchmark for synchronizing update from a peer
  * 1. Start kvStore
@@ -290,6 +349,43 @@ BM_KvStoreFloodingUpdate(uint32_t iters, size_t numOfUpdateKeys) {
   }
 }
 
+/**
+ * Benchmark for matching keys against KvStoreFilters
+ * 1. Create filters with given number of key prefixes and originator ids
+ * 2. Match a fixed set of keys against the filters
+ */
+static void
+BM_KvStoreFilterMatch(uint32_t iters, size_t numOfFilters) {
+  auto suspender = folly::BenchmarkSuspender();
+  const size_t kNumOfKeys = 1000;
+
+  std::vector<std::string> keyPrefixes;
+  std::set<std::string> originatorIds;
+  for (size_t idx = 0; idx < numOfFilters; idx++) {
+    keyPrefixes.emplace_back(folly::sformat("adj:node{}:", idx));
+    originatorIds.emplace(folly::sformat("node{}", idx));
+  }
+  const KvStoreFilters filters(keyPrefixes, originatorIds);
+
+  // half of the keys match the filters
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  keyVals.reserve(kNumOfKeys);
+  for (size_t idx = 0; idx < kNumOfKeys; idx++) {
+    const auto node = folly::sformat("node{}", idx % (2 * numOfFilters));
+    keyVals.emplace_back(
+        folly::sformat("adj:{}:{}", node, genRandomStr(kSizeOfKey)),
+        createThriftValue(1 /* version */, node, std::string("value")));
+  }
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; i++) {
+    for (auto const& [key, value] : keyVals) {
+      folly::doNotOptimizeAway(
+          filters.keyMatch(key, value, thrift::FilterOperator::AND));
+    }
+  }
+}
+
 // The first integer parameter is number of keyVals already in store
 // The second integer parameter is the number of keyVals for update
 BENCHMARK_NAMED_PARAM(BM_KvStoreMergeKeyValues, 10_10, 10, 10);
@@ -306,12 +402,23 @@ BENCHMARK_PARAM(BM_KvStoreDumpAll, 100);
 BENCHMARK_PARAM(BM_KvStoreDumpAll, 1000);
 BENCHMARK_PARAM(BM_KvStoreDumpAll, 10000);
 
+// The parameter is number of keyVals already in store
+BENCHMARK_PARAM(BM_KvStoreDumpDifference, 1000);
+BENCHMARK_PARAM(BM_KvStoreDumpDifference, 10000);
+BENCHMARK_PARAM(BM_KvStoreDumpDifference, 100000);
+
 // The parameter is number of keyVals for update
 BENCHMARK_PARAM(BM_KvStoreFloodingUpdate, 10);
 BENCHMARK_PARAM(BM_KvStoreFloodingUpdate, 100);
 BENCHMARK_PARAM(BM_KvStoreFloodingUpdate, 1000);
 BENCHMARK_PARAM(BM_KvStoreFloodingUpdate, 10000);
 
+// The parameter is number of key prefixes and originator ids in filters
+BENCHMARK_PARAM(BM_KvStoreFilterMatch, 1);
+BENCHMARK_PARAM(BM_KvStoreFilterMatch, 10);
+BENCHMARK_PARAM(BM_KvStoreFilterMatch, 100);
+BENCHMARK_PARAM(BM_KvStoreFilterMatch, 1000);
+
 } // namespace openr
 
 int
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <map>
 #include <sodium.h>
 #include <thread>
 #include <unordered_set>
@@ -702,6 +703,67 @@ TEST(KvStoreClientInternal, PersistKeyTest) {
   evbThread.join();
 }
 
+/**
+ * Test batched persist and clear of keys
+ * - Persist two keys in one call, both get advertised and reported changed
+ * - Persist same key-vals again, nothing is reported changed
+ * - Clear both keys in one call, both get empty value with higher version
+ */
+TEST(KvStoreClientInternal, PersistKeysTest) {
+  fbzmq::Context context;
+  folly::Baton waitBaton;
+  const std::string nodeId{"test_store"};
+
+  auto config = std::make_shared<Config>(getBasicOpenrConfig(nodeId));
+  auto store = std::make_shared<KvStoreWrapper>(context, config);
+  store->run();
+
+  OpenrEventBase evb;
+  auto client1 = std::make_shared<KvStoreClientInternal>(
+      &evb, nodeId, store->getKvStore());
+
+  const std::unordered_map<std::string, std::string> keyVals = {
+      {"test_key1", "test_value1"}, {"test_key2", "test_value2"}};
+
+  evb.scheduleTimeout(std::chrono::milliseconds(0), [&]() noexcept {
+    auto changedKeys = client1->persistKeys(kTestingAreaName, keyVals);
+    EXPECT_EQ(2, changedKeys.size());
+    for (auto const& [key, value] : keyVals) {
+      auto maybeVal = client1->getKey(kTestingAreaName, key);
+      ASSERT_TRUE(maybeVal.has_value());
+      EXPECT_EQ(1, *maybeVal->version_ref());
+      EXPECT_EQ(value, maybeVal->value_ref());
+    }
+
+    // no op
+    EXPECT_TRUE(client1->persistKeys(kTestingAreaName, keyVals).empty());
+
+    client1->clearKeys(
+        kTestingAreaName, {{"test_key1", ""}, {"test_key2", ""}});
+    for (auto const& [key, _] : keyVals) {
+      auto maybeVal = client1->getKey(kTestingAreaName, key);
+      ASSERT_TRUE(maybeVal.has_value());
+      EXPECT_EQ(2, *maybeVal->version_ref());
+      EXPECT_EQ("", maybeVal->value_ref());
+    }
+
+    waitBaton.post();
+  });
+
+  std::thread evbThread([&]() { evb.run(); });
+  evb.waitUntilRunning();
+  waitBaton.wait();
+
+  store->closeQueue();
+  client1.reset();
+  store->stop();
+  store.reset();
+
+  evb.stop();
+  evb.waitUntilStopped();
+  evbThread.join();
+}
+
 /**
  * Test ttl change with persist key while keeping value and version same
  * - Set key with ttl 1s
@@ -1285,6 +1347,102 @@ TEST(KvStoreClientInternal, SubscribeKeyFilterApiTest) {
   evbThread.join();
 }
 
+TEST(KvStoreClientInternal, SubscribeKeyPrefixApiTest) {
+  fbzmq::Context context;
+  folly::Baton waitBaton;
+  const std::string nodeId{"test_store"};
+
+  // Initialize and start KvStore with empty peer
+  auto config = std::make_shared<Config>(getBasicOpenrConfig(nodeId));
+  auto store = std::make_shared<KvStoreWrapper>(context, config);
+  store->run();
+
+  // Create another OpenrEventBase instance for looping clients
+  OpenrEventBase evb;
+  auto client1 = std::make_unique<KvStoreClientInternal>(
+      &evb, nodeId, store->getKvStore());
+
+  const auto testValue = createThriftValue(
+      1,
+      nodeId,
+      std::string("test_key_val"),
+      10000, /* ttl in msec */
+      500 /* ttl version */,
+      0 /* hash */);
+
+  // received <key: updates> of both subscriptions, none on expiry
+  std::map<std::string, std::vector<bool>> prefixCbs;
+  std::map<std::string, std::vector<bool>> keyPrefixCbs;
+  int64_t prefixSubscriptionId{0};
+  evb.scheduleTimeout(std::chrono::milliseconds(0), [&]() noexcept {
+    // overlapping subscriptions are both invoked
+    prefixSubscriptionId = client1->subscribeKeyPrefix(
+        kTestingAreaName,
+        "test_",
+        [&](std::string const& k, std::optional<thrift::Value> v) noexcept {
+          prefixCbs[k].emplace_back(v.has_value());
+        });
+    client1->subscribeKeyPrefix(
+        kTestingAreaName,
+        "test_key",
+        [&](std::string const& k, std::optional<thrift::Value> v) noexcept {
+          keyPrefixCbs[k].emplace_back(v.has_value());
+        });
+
+    store->setKey(kTestingAreaName, "test_key1", testValue, std::nullopt);
+    store->setKey(kTestingAreaName, "test_other", testValue, std::nullopt);
+    store->setKey(kTestingAreaName, "other_key", testValue, std::nullopt);
+
+    // expires soon after
+    auto shortLivedValue = testValue;
+    *shortLivedValue.ttl_ref() = 100;
+    store->setKey(
+        kTestingAreaName, "test_key_expiring", shortLivedValue, std::nullopt);
+  });
+
+  // unsubscribe one of subscriptions, the other one is still invoked
+  evb.scheduleTimeout(std::chrono::milliseconds(500), [&]() noexcept {
+    client1->unsubscribeKeyPrefix(prefixSubscriptionId);
+    store->setKey(kTestingAreaName, "test_key2", testValue, std::nullopt);
+  });
+
+  evb.scheduleTimeout(std::chrono::milliseconds(600), [&]() noexcept {
+    // Synchronization primitive
+    waitBaton.post();
+  });
+
+  // Start the event loop
+  std::thread evbThread([&]() { evb.run(); });
+  evb.waitUntilRunning();
+
+  // Synchronization primitive
+  waitBaton.wait();
+
+  const std::map<std::string, std::vector<bool>> expectedPrefixCbs{
+      {"test_key1", {true}},
+      {"test_other", {true}},
+      {"test_key_expiring", {true, false}},
+  };
+  const std::map<std::string, std::vector<bool>> expectedKeyPrefixCbs{
+      {"test_key1", {true}},
+      {"test_key_expiring", {true, false}},
+      {"test_key2", {true}},
+  };
+  evb.getEvb()->runInEventBaseThreadAndWait([&]() {
+    EXPECT_EQ(expectedPrefixCbs, prefixCbs);
+    EXPECT_EQ(expectedKeyPrefixCbs, keyPrefixCbs);
+  });
+
+  // Stop server
+  LOG(INFO) << "Stopping store";
+  store->stop();
+  client1.reset();
+
+  evb.stop();
+  evb.waitUntilStopped();
+  evbThread.join();
+}
+
 /*
  * area related tests for KvStoreClientInternal. Things to test:
  * - Flooding is contained within area - basic verification
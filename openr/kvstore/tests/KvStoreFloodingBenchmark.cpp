@@ -0,0 +1,344 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <thread>
+
+#include <fb303/ServiceData.h>
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+
+#include <openr/common/Util.h>
+#include <openr/config/Config.h>
+#include <openr/config/tests/Utils.h>
+#include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+
+namespace {
+
+// interval for periodic syncs. Large enough to not interfere with benchmark
+const std::chrono::seconds kDbSyncInterval(10000);
+
+// Number of keys originated by every node before benchmark starts
+const size_t kNumKeysPerNode = 10;
+
+// Number of keys injected by a node per iteration
+const size_t kNumInjectedKeys = 10;
+
+// The byte size of a value
+const size_t kSizeOfValue = 1024;
+
+// Total CPU time (user + system) consumed by the process so far
+std::chrono::microseconds
+getCpuTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  const auto toUs = [](struct timeval const& tv) {
+    return std::chrono::seconds(tv.tv_sec) +
+        std::chrono::microseconds(tv.tv_usec);
+  };
+  return toUs(usage.ru_utime) + toUs(usage.ru_stime);
+}
+
+// Total bytes sent to peers by all stores in the process so far
+int64_t
+getBytesFlooded() {
+  return fb303::fbData->getCounters()["kvstore.peers.bytes_sent.sum"];
+}
+} // namespace
+
+namespace openr {
+
+enum class Topology {
+  // every node peers with its two neighbors
+  RING,
+  // quarter of nodes are spines, every leaf peers with all spines
+  CLOS,
+  // every node peers with every other node
+  FULL_MESH,
+};
+
+/**
+ * Return undirected links of a topology of `numNodes` nodes as pair of node
+ * indices
+ */
+std::vector<std::pair<size_t, size_t>>
+getTopologyLinks(Topology topology, size_t numNodes) {
+  std::vector<std::pair<size_t, size_t>> links;
+  switch (topology) {
+  case Topology::RING: {
+    for (size_t i = 0; i < numNodes and numNodes > 1; ++i) {
+      if (numNodes == 2 and i == 1) {
+        break;
+      }
+      links.emplace_back(i, (i + 1) % numNodes);
+    }
+    break;
+  }
+  case Topology::CLOS: {
+    const size_t numSpines = std::max<size_t>(1, numNodes / 4);
+    for (size_t leaf = numSpines; leaf < numNodes; ++leaf) {
+      for (size_t spine = 0; spine < numSpines; ++spine) {
+        links.emplace_back(leaf, spine);
+      }
+    }
+    break;
+  }
+  case Topology::FULL_MESH: {
+    for (size_t i = 0; i < numNodes; ++i) {
+      for (size_t j = i + 1; j < numNodes; ++j) {
+        links.emplace_back(i, j);
+      }
+    }
+    break;
+  }
+  }
+  return links;
+}
+
+/**
+ * Network of KvStores peered in the given topology
+ */
+class KvStoreNetwork {
+ public:
+  KvStoreNetwork(Topology topology, size_t numNodes)
+      : links_(getTopologyLinks(topology, numNodes)) {
+    for (size_t i = 0; i < numNodes; ++i) {
+      auto tConfig = getBasicOpenrConfig(folly::sformat("node{}", i));
+      tConfig.kvstore_config_ref()->sync_interval_s_ref() =
+          kDbSyncInterval.count();
+      configs_.emplace_back(std::make_shared<Config>(tConfig));
+      stores_.emplace_back(
+          std::make_unique<KvStoreWrapper>(context_, configs_.back()));
+      stores_.back()->run();
+    }
+
+    // originate keys of every node before peering them
+    for (auto& store : stores_) {
+      for (size_t k = 0; k < kNumKeysPerNode; ++k) {
+        store->setKey(
+            kTestingAreaName,
+            folly::sformat("key:{}:{}", store->getNodeId(), k),
+            createThriftValue(
+                1, store->getNodeId(), std::string(kSizeOfValue, 'a')));
+      }
+    }
+
+    for (auto const& [a, b] : links_) {
+      addLink(a, b);
+    }
+    waitForFullSync();
+  }
+
+  ~KvStoreNetwork() {
+    for (auto& store : stores_) {
+      store->stop();
+    }
+  }
+
+  KvStoreWrapper*
+  getStore(size_t idx) {
+    return stores_.at(idx).get();
+  }
+
+  std::pair<size_t, size_t> const&
+  getLink(size_t idx) const {
+    return links_.at(idx);
+  }
+
+  void
+  addLink(size_t a, size_t b) {
+    auto storeA = stores_.at(a).get();
+    auto storeB = stores_.at(b).get();
+    storeA->addPeer(
+        kTestingAreaName, storeB->getNodeId(), storeB->getPeerSpec());
+    storeB->addPeer(
+        kTestingAreaName, storeA->getNodeId(), storeA->getPeerSpec());
+  }
+
+  void
+  delLink(size_t a, size_t b) {
+    auto storeA = stores_.at(a).get();
+    auto storeB = stores_.at(b).get();
+    storeA->delPeer(kTestingAreaName, storeB->getNodeId());
+    storeB->delPeer(kTestingAreaName, storeA->getNodeId());
+  }
+
+  // wait until no full-sync is pending or in flight on any store
+  void
+  waitForFullSync() {
+    for (auto& store : stores_) {
+      while (true) {
+        auto counters = store->getCounters();
+        if (counters["kvstore.num_pending_full_sync"] == 0 and
+            counters["kvstore.num_in_flight_full_sync"] == 0) {
+          break;
+        }
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // wait until every store has given version of the key
+  void
+  waitForKey(std::string const& key, int64_t version) {
+    for (auto& store : stores_) {
+      while (true) {
+        auto value = store->getKey(kTestingAreaName, key);
+        if (value.has_value() and *value->version_ref() >= version) {
+          break;
+        }
+        std::this_thread::yield();
+      }
+    }
+  }
+
+ private:
+  fbzmq::Context context_;
+  std::vector<std::shared_ptr<Config>> configs_;
+  std::vector<std::unique_ptr<KvStoreWrapper>> stores_;
+  const std::vector<std::pair<size_t, size_t>> links_;
+};
+
+// report flooding cost of `iters` iterations into benchmark counters
+void
+reportCost(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numNodes,
+    int64_t bytesFlooded,
+    std::chrono::microseconds cpuTime) {
+  counters["bytes_flooded"] = bytesFlooded / std::max<uint32_t>(1, iters);
+  counters["cpu_us_per_node"] =
+      cpuTime.count() / std::max<uint32_t>(1, iters) / numNodes;
+}
+
+/**
+ * Benchmark for convergence of key injections:
+ * 1. Peer stores in given topology and sync them
+ * 2. Inject keys at one node
+ * 3. Wait until all stores have the injected keys
+ */
+static void
+BM_KvStoreFloodingConvergence(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    Topology topology,
+    size_t numNodes) {
+  auto suspender = folly::BenchmarkSuspender();
+  KvStoreNetwork network(topology, numNodes);
+  auto injector = network.getStore(numNodes - 1);
+
+  const auto bytesStart = getBytesFlooded();
+  const auto cpuStart = getCpuTime();
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    const int64_t version = i + 1;
+    std::vector<std::pair<std::string, thrift::Value>> keyVals;
+    for (size_t k = 0; k < kNumInjectedKeys; ++k) {
+      keyVals.emplace_back(
+          folly::sformat("injected:{}", k),
+          createThriftValue(
+              version,
+              injector->getNodeId(),
+              std::string(kSizeOfValue, 'a' + (i % 26))));
+    }
+    injector->setKeys(kTestingAreaName, keyVals);
+    for (size_t k = 0; k < kNumInjectedKeys; ++k) {
+      network.waitForKey(folly::sformat("injected:{}", k), version);
+    }
+  }
+
+  suspender.rehire();
+  reportCost(
+      counters,
+      iters,
+      numNodes,
+      getBytesFlooded() - bytesStart,
+      getCpuTime() - cpuStart);
+}
+
+/**
+ * Benchmark for re-convergence after peer flaps:
+ * 1. Peer stores in given topology and sync them
+ * 2. Bring a link down and up again
+ * 3. Wait until full-sync over the link completes on all stores
+ */
+static void
+BM_KvStoreFloodingPeerFlap(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    Topology topology,
+    size_t numNodes) {
+  auto suspender = folly::BenchmarkSuspender();
+  KvStoreNetwork network(topology, numNodes);
+  const auto [a, b] = network.getLink(0);
+
+  const auto bytesStart = getBytesFlooded();
+  const auto cpuStart = getCpuTime();
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    network.delLink(a, b);
+    network.addLink(a, b);
+    network.waitForFullSync();
+  }
+
+  suspender.rehire();
+  reportCost(
+      counters,
+      iters,
+      numNodes,
+      getBytesFlooded() - bytesStart,
+      getCpuTime() - cpuStart);
+}
+
+// The first parameter is topology and the second one is number of nodes
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingConvergence, counters, RING_8, Topology::RING, 8);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingConvergence, counters, RING_32, Topology::RING, 32);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingConvergence, counters, CLOS_8, Topology::CLOS, 8);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingConvergence, counters, CLOS_32, Topology::CLOS, 32);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingConvergence,
+    counters,
+    FULL_MESH_8,
+    Topology::FULL_MESH,
+    8);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingConvergence,
+    counters,
+    FULL_MESH_16,
+    Topology::FULL_MESH,
+    16);
+
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingPeerFlap, counters, RING_8, Topology::RING, 8);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingPeerFlap, counters, CLOS_32, Topology::CLOS, 32);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_KvStoreFloodingPeerFlap,
+    counters,
+    FULL_MESH_16,
+    Topology::FULL_MESH,
+    16);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
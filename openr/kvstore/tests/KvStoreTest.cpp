@@ -10,6 +10,7 @@
 #include <thread>
 #include <tuple>
 #include <unordered_set>
+#include <unistd.h>
 
 #include <sodium.h>
 
@@ -384,6 +385,15 @@ TEST_F(KvStoreTestFixture, CounterReport) {
   ASSERT_EQ(1, counters.count("kvstore.cmd_key_get.count"));
   ASSERT_EQ(1, counters.count("kvstore.sent_key_vals.sum"));
   ASSERT_EQ(1, counters.count("kvstore.sent_publications.count"));
+  for (auto const& stage : {"merge", "ttl_update", "queue_push", "peer_send"}) {
+    const auto prefix = folly::sformat("kvstore.latency_us.zmq.{}", stage);
+    ASSERT_EQ(1, counters.count(prefix + ".p50.60"));
+    ASSERT_EQ(1, counters.count(prefix + ".p99.60"));
+    ASSERT_EQ(
+        1,
+        counters.count(
+            folly::sformat("{}.{}.max", prefix, kTestingAreaName.t)));
+  }
   // Verify the value of counter keys
   EXPECT_EQ(0, counters.at("kvstore.num_peers"));
   EXPECT_EQ(0, counters.at("kvstore.cmd_peer_dump.count"));
@@ -965,6 +975,91 @@ TEST_F(KvStoreTestFixture, PeerSyncTtlExpiry) {
   EXPECT_GE(kTtlMs, *maybeThriftVal.value().ttl_ref());
 }
 
+/**
+ * Test to verify full-sync with multiple peers under in-flight limit of 1.
+ * All peers are eventually synced and per-peer sync durations are reported.
+ */
+TEST_F(KvStoreTestFixture, BoundedParallelSync) {
+  auto kvConf = getTestKvConf();
+  kvConf.max_parallel_sync_ref() = 1;
+  auto store0 = createKvStore("store0", kvConf);
+  store0->run();
+
+  std::vector<KvStoreWrapper*> peerStores;
+  for (int i = 1; i <= 3; ++i) {
+    auto store = createKvStore(folly::sformat("store{}", i));
+    store->run();
+    EXPECT_TRUE(store->setKey(
+        kTestingAreaName,
+        folly::sformat("key{}", i),
+        createThriftValue(1, store->getNodeId(), "value")));
+    peerStores.emplace_back(store);
+  }
+  for (auto store : peerStores) {
+    EXPECT_TRUE(store0->addPeer(
+        kTestingAreaName, store->getNodeId(), store->getPeerSpec()));
+  }
+
+  // wait for all full-syncs to complete
+  for (int i = 1; i <= 3; ++i) {
+    const auto key = folly::sformat("key{}", i);
+    while (not store0->getKey(kTestingAreaName, key).has_value()) {
+      std::this_thread::yield();
+    }
+  }
+
+  auto counters = store0->getCounters();
+  for (auto store : peerStores) {
+    const auto prefix = folly::sformat(
+        "kvstore.peer_sync_duration_ms.{}", store->getNodeId());
+    EXPECT_EQ(1, counters.at(prefix + ".count"));
+    EXPECT_EQ(1, counters.count(prefix + ".le_inf"));
+  }
+  EXPECT_EQ(0, counters.at("kvstore.num_pending_full_sync"));
+}
+
+/**
+ * Verify that KvStore is warmed up from snapshot across restart. Keys of
+ * other originators are restored with TTL adjusted, own keys are not.
+ */
+TEST_F(KvStoreTestFixture, WarmRestartFromSnapshot) {
+  char snapshotDir[] = "/tmp/openr_kvstore_snapshot.XXXXXX";
+  ASSERT_NE(nullptr, ::mkdtemp(snapshotDir));
+  auto kvConf = getTestKvConf();
+  kvConf.snapshot_dir_ref() = snapshotDir;
+
+  auto store = createKvStore("store0", kvConf);
+  store->run();
+  EXPECT_TRUE(store->setKey(
+      kTestingAreaName,
+      "key1",
+      createThriftValue(1, "node1", "value1", 60000)));
+  EXPECT_TRUE(store->setKey(
+      kTestingAreaName, "key2", createThriftValue(1, "store0", "value2")));
+
+  // snapshot is written on shutdown
+  store->stop();
+  stores_.clear();
+
+  store = createKvStore("store0", kvConf);
+  store->run();
+  while (not store->getKey(kTestingAreaName, "key1").has_value()) {
+    std::this_thread::yield();
+  }
+  auto val = store->getKey(kTestingAreaName, "key1");
+  EXPECT_EQ("value1", *val->value_ref());
+  EXPECT_EQ(1, *val->version_ref());
+  EXPECT_GE(60000, *val->ttl_ref());
+  EXPECT_FALSE(store->getKey(kTestingAreaName, "key2").has_value());
+
+  std::remove(folly::sformat(
+                  "{}/kvstore_{}.snapshot",
+                  snapshotDir,
+                  kTestingAreaName.t)
+                  .c_str());
+  ::rmdir(snapshotDir);
+}
+
 /**
  * Test to verify PEER_ADD/PEER_DEL and verify that keys are synchronized
  * to the neighbor.
@@ -1580,6 +1675,107 @@ TEST_F(KvStoreTestFixture, DualTest) {
   validateAllRootsUpCase();
 }
 
+/**
+ * Flood root r0 and non-root nodes a, b, c, d with backup flood tree enabled.
+ * SPT of r0 is r0-a-c and r0-b-d, link c-d is not part of it.
+ *    r0
+ *   /  \
+ *  a    b
+ *  |    |
+ *  c -- d
+ * Verify that once r0 goes down, i.e. SPT is gone while its backup tree lost
+ * a peer, publications are flooded to all peers and still reach every node.
+ */
+TEST_F(KvStoreTestFixture, FloodBackupTreePeerDown) {
+  auto kvConf = getTestKvConf();
+  kvConf.enable_flood_optimization_ref() = true;
+  kvConf.enable_flood_backup_tree_ref() = true;
+  // no periodic sync, keys are to reach nodes by flooding only
+  kvConf.sync_interval_s_ref() = 3600;
+  auto floodRootConf = kvConf;
+  floodRootConf.is_flood_root_ref() = true;
+  kvConf.is_flood_root_ref() = false;
+
+  auto r0 = createKvStore("r0", floodRootConf);
+  auto a = createKvStore("a", kvConf);
+  auto b = createKvStore("b", kvConf);
+  auto c = createKvStore("c", kvConf);
+  auto d = createKvStore("d", kvConf);
+  const std::vector<KvStoreWrapper*> nodes{a, b, c, d};
+  r0->run();
+  for (auto node : nodes) {
+    node->run();
+  }
+
+  auto addLink = [&](KvStoreWrapper* store1, KvStoreWrapper* store2) {
+    EXPECT_TRUE(store1->addPeer(
+        kTestingAreaName, store2->getNodeId(), store2->getPeerSpec()));
+    EXPECT_TRUE(store2->addPeer(
+        kTestingAreaName, store1->getNodeId(), store1->getPeerSpec()));
+  };
+  addLink(r0, a);
+  addLink(r0, b);
+  addLink(a, c);
+  addLink(b, d);
+  addLink(c, d);
+
+  // let kvstore dual sync
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  {
+    const auto& sptInfos = c->getFloodTopo(kTestingAreaName);
+    EXPECT_EQ(sptInfos.floodRootId_ref(), "r0");
+    EXPECT_EQ(sptInfos.floodPeers_ref()->size(), 1);
+    EXPECT_EQ(sptInfos.floodPeers_ref()->count("a"), 1);
+  }
+
+  // flooding along formed SPT remembers it as backup tree
+  auto waitForKey = [&](std::string const& key) {
+    for (auto node : nodes) {
+      while (not node->getKey(kTestingAreaName, key).has_value()) {
+        std::this_thread::yield();
+      }
+    }
+  };
+  EXPECT_TRUE(
+      a->setKey(kTestingAreaName, "key1", createThriftValue(1, "a", "value")));
+  waitForKey("key1");
+
+  // bring r0 down, a and b lose their SPT parent
+  r0->delPeer(kTestingAreaName, "a");
+  r0->delPeer(kTestingAreaName, "b");
+  a->delPeer(kTestingAreaName, "r0");
+  b->delPeer(kTestingAreaName, "r0");
+
+  // let kvstore dual sync
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  EXPECT_FALSE(a->getFloodTopo(kTestingAreaName).floodRootId_ref().has_value());
+
+  auto counters = a->getCounters();
+  const auto numBroken =
+      counters["kvstore.flood_fanout.num_backup_tree_broken.count"];
+  const auto numBackupTree =
+      counters["kvstore.flood_fanout.num_backup_tree.count"];
+  const auto numFloodToAll =
+      counters["kvstore.flood_fanout.num_flood_to_all.count"];
+
+  // a floods to all, and so do c and d as flood-root-id is dropped
+  EXPECT_TRUE(
+      a->setKey(kTestingAreaName, "key2", createThriftValue(1, "a", "value")));
+  waitForKey("key2");
+
+  counters = a->getCounters();
+  EXPECT_LT(
+      numBroken, counters["kvstore.flood_fanout.num_backup_tree_broken.count"]);
+  EXPECT_EQ(
+      numBackupTree, counters["kvstore.flood_fanout.num_backup_tree.count"]);
+  // a, c and d at least flooded to all peers before b received key2
+  EXPECT_LE(
+      numFloodToAll + 3,
+      counters["kvstore.flood_fanout.num_flood_to_all.count"]);
+}
+
 /**
  * Perform KvStore synchronization test on full mesh.
  */
@@ -2222,6 +2418,39 @@ TEST_F(KvStoreTestFixture, OneWaySetKey) {
   EXPECT_EQ(expectedKeyVals, myStore->dumpAll(kTestingAreaName));
 }
 
+/**
+ * Re-set of unchanged value by local module is detected by hash and skips
+ * merge, while re-set with newer ttlVersion or from a peer is still merged
+ */
+TEST_F(KvStoreTestFixture, LocalSetUnchangedKey) {
+  auto myStore = createKvStore("test-node1");
+  myStore->run();
+
+  const std::string key{"test-key"};
+  auto thriftVal =
+      createThriftValue(1, "test-node1", std::string("test-value"));
+  auto getNumUnchanged = []() {
+    auto counters = fb303::fbData->getCounters();
+    return counters["kvstore.local_set_unchanged_key_vals.sum"];
+  };
+
+  EXPECT_TRUE(myStore->setKey(kTestingAreaName, key, thriftVal));
+  myStore->recvPublication();
+  const auto numUnchanged = getNumUnchanged();
+
+  // same value again is skipped
+  EXPECT_TRUE(myStore->setKey(kTestingAreaName, key, thriftVal));
+  EXPECT_EQ(numUnchanged + 1, getNumUnchanged());
+
+  // newer ttlVersion is merged
+  thriftVal.ttlVersion_ref() = 1;
+  EXPECT_TRUE(myStore->setKey(kTestingAreaName, key, thriftVal));
+  EXPECT_EQ(numUnchanged + 1, getNumUnchanged());
+  auto pub = myStore->recvPublication();
+  EXPECT_EQ(1, *pub.keyVals_ref()->at(key).ttlVersion_ref());
+  EXPECT_EQ(1, *myStore->getKey(kTestingAreaName, key)->ttlVersion_ref());
+}
+
 /*
  * check key value is decremented with the TTL decrement value provided,
  * and is not synced if remaining TTL is < TTL decrement value provided
@@ -2373,6 +2602,84 @@ TEST_F(KvStoreTestFixture, RateLimiterFlood) {
   EXPECT_EQ(expectNumKeys, kv2.size());
 }
 
+/**
+ * Verify TTL refreshes of local keys set within the coalescing window are
+ * published as a single publication, while value updates are not delayed.
+ */
+TEST_F(KvStoreTestFixture, TtlRefreshCoalescing) {
+  auto kvConf = getTestKvConf();
+  kvConf.ttl_refresh_coalesce_ms_ref() = 200;
+  auto store = createKvStore("store", kvConf);
+  store->run();
+
+  const std::vector<std::string> keys{"key1", "key2"};
+  for (auto const& key : keys) {
+    auto thriftVal = createThriftValue(
+        1 /* version */, "store" /* originatorId */, "value", 30000 /* ttl */);
+    EXPECT_TRUE(store->setKey(kTestingAreaName, key, thriftVal));
+    // value update is published right away
+    auto pub = store->recvPublication();
+    EXPECT_EQ(1, pub.keyVals_ref()->count(key));
+  }
+
+  // send TTL refreshes one by one
+  for (auto const& key : keys) {
+    auto thriftVal = createThriftValue(
+        1 /* version */,
+        "store" /* originatorId */,
+        std::nullopt /* value */,
+        30000 /* ttl */,
+        1 /* ttl version */);
+    EXPECT_TRUE(store->setKey(kTestingAreaName, key, thriftVal));
+  }
+
+  // both refreshes are received in one publication
+  auto pub = store->recvPublication();
+  ASSERT_EQ(keys.size(), pub.keyVals_ref()->size());
+  for (auto const& key : keys) {
+    auto const& value = pub.keyVals_ref()->at(key);
+    EXPECT_FALSE(value.value_ref().has_value());
+    EXPECT_EQ(1, *value.ttlVersion_ref());
+  }
+}
+
+/**
+ * Verify keys of priority flood key prefixes bypass the rate limiter, while
+ * other keys wait for it
+ */
+TEST_F(KvStoreTestFixture, RateLimiterPriorityKeys) {
+  auto kvConf = getTestKvConf();
+  kvConf.flood_rate_ref() = thrift::KvstoreFloodRate(
+      apache::thrift::FRAGILE,
+      1 /* flood_msg_per_sec */,
+      1 /* flood_msg_burst_size */);
+  kvConf.priority_flood_key_prefixes_ref() = {"adj:"};
+  auto store = createKvStore("store", kvConf);
+  store->run();
+
+  const auto setKey = [&](std::string const& key) {
+    auto thriftVal = createThriftValue(
+        1 /* version */, "store" /* originatorId */, "value", 30000 /* ttl */);
+    EXPECT_TRUE(store->setKey(kTestingAreaName, key, thriftVal));
+  };
+
+  // first key consumes the burst
+  setKey("prefix:1");
+  EXPECT_EQ(1, store->recvPublication().keyVals_ref()->count("prefix:1"));
+
+  // prefix key is buffered, adjacency key is published right away
+  setKey("prefix:2");
+  setKey("adj:1");
+  {
+    auto pub = store->recvPublication();
+    EXPECT_EQ(1, pub.keyVals_ref()->size());
+    EXPECT_EQ(1, pub.keyVals_ref()->count("adj:1"));
+  }
+
+  // buffered key follows once rate allows
+  EXPECT_EQ(1, store->recvPublication().keyVals_ref()->count("prefix:2"));
+}
+
 TEST_F(KvStoreTestFixture, RateLimiter) {
   fbzmq::Context context;
   fb303::fbData->resetAllData();
@@ -2663,6 +2970,47 @@ TEST_F(KvStoreTestFixture, FullSync) {
   EXPECT_EQ(v4->value_ref().value(), "b");
 }
 
+/**
+ * Verify full-sync over ZMQ with compressed response. storeA advertises
+ * compression in its full-sync request and storeB responds with all of its
+ * keys, which are large enough to be compressed.
+ */
+TEST_F(KvStoreTestFixture, CompressedFullSync) {
+  auto kvConfA = getTestKvConf();
+  kvConfA.enable_sync_compression_ref() = true;
+  auto storeA = createKvStore("storeA", kvConfA);
+  auto storeB = createKvStore("storeB");
+  storeA->run();
+  storeB->run();
+
+  // set key vals in storeB, exceeding minimum size of compressed response
+  const size_t numKeys{64};
+  const size_t valueSize{1024};
+  ASSERT_LT(Constants::kKvStoreMinSyncCompressionSize, numKeys * valueSize);
+  for (size_t i = 0; i < numKeys; ++i) {
+    const auto val = createThriftValue(
+        1 /* version */,
+        "storeB" /* originatorId */,
+        std::string(valueSize, 'a' + i % 26) /* value */);
+    EXPECT_TRUE(
+        storeB->setKey(kTestingAreaName, folly::sformat("key{}", i), val));
+  }
+
+  // let A send a full-sync request to B and wait for completion
+  storeA->addPeer(kTestingAreaName, "storeB", storeB->getPeerSpec());
+  while (storeA->dumpAll(kTestingAreaName).size() < numKeys) {
+    std::this_thread::yield();
+  }
+
+  // all key vals are decompressed as is
+  EXPECT_EQ(
+      storeB->dumpAll(kTestingAreaName), storeA->dumpAll(kTestingAreaName));
+
+  auto counters = storeA->getCounters();
+  EXPECT_LE(1, counters.at("kvstore.sync_compression_num_responses.count"));
+  EXPECT_EQ(0, counters.at("kvstore.sync_decompression_failure.count"));
+}
+
 /* Kvstore tests related to area */
 
 /* Verify flooding is containted within an area. Add a key in one area and
@@ -2841,6 +3189,65 @@ TEST_F(KvStoreTestFixture, KeySyncMultipleArea) {
   evb.loop();
 }
 
+/**
+ * Verify KvStore with every area on its own thread: keys are synced per area
+ * and APIs spanning all areas merge results of all area threads
+ */
+TEST_F(KvStoreTestFixture, AreaThreads) {
+  thrift::AreaConfig pod, plane;
+  *pod.area_id_ref() = "pod-area";
+  pod.neighbor_regexes_ref()->emplace_back(".*");
+  *plane.area_id_ref() = "plane-area";
+  plane.neighbor_regexes_ref()->emplace_back(".*");
+  const AreaId podArea{pod.get_area_id()};
+  const AreaId planeArea{plane.get_area_id()};
+
+  auto kvConf = getTestKvConf();
+  kvConf.enable_area_threads_ref() = true;
+  auto storeA = createKvStore("storeA", kvConf, {pod, plane});
+  auto storeB = createKvStore("storeB", kvConf, {pod, plane});
+  storeA->run();
+  storeB->run();
+
+  for (auto const& area : {podArea, planeArea}) {
+    EXPECT_TRUE(storeA->addPeer(area, "storeB", storeB->getPeerSpec()));
+    EXPECT_TRUE(storeB->addPeer(area, "storeA", storeA->getPeerSpec()));
+  }
+
+  const auto thriftVal = createThriftValue(
+      1 /* version */, "storeA" /* originatorId */, std::string("value"));
+  EXPECT_TRUE(storeA->setKey(podArea, "pod-key", thriftVal));
+  EXPECT_TRUE(storeA->setKey(planeArea, "plane-key", thriftVal));
+
+  // wait for keys to be flooded in their areas
+  while (not storeB->getKey(podArea, "pod-key").has_value() or
+         not storeB->getKey(planeArea, "plane-key").has_value()) {
+    storeB->recvPublication();
+  }
+  EXPECT_FALSE(storeB->getKey(planeArea, "pod-key").has_value());
+  EXPECT_FALSE(storeB->getKey(podArea, "plane-key").has_value());
+
+  // dump of all areas is merged from all area threads
+  thrift::KeyDumpParams params;
+  auto pubs = storeB->getKvStore()->dumpKvStoreKeys(params).get();
+  ASSERT_EQ(2, pubs->size());
+  std::map<std::string, std::vector<std::string>> areaKeys;
+  for (auto const& pub : *pubs) {
+    for (auto const& kv : *pub.keyVals_ref()) {
+      areaKeys[*pub.area_ref()].emplace_back(kv.first);
+    }
+  }
+  EXPECT_EQ(
+      (std::map<std::string, std::vector<std::string>>{
+          {podArea.t, {"pod-key"}}, {planeArea.t, {"plane-key"}}}),
+      areaKeys);
+
+  // counters are summed up across areas
+  auto counters = storeB->getCounters();
+  EXPECT_EQ(2, counters.at("kvstore.num_keys"));
+  EXPECT_EQ(2, counters.at("kvstore.num_peers"));
+}
+
 /**
  * Verify correctness of initial full sync rate limiting.
  *
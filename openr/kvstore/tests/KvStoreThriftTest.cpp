@@ -10,6 +10,7 @@
 
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/init/Init.h>
+#include <folly/synchronization/Baton.h>
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -55,8 +56,20 @@ class KvStoreThriftTestFixture : public ::testing::Test {
   }
 
   void
-  createKvStore(const std::string& nodeId) {
+  createKvStore(
+      const std::string& nodeId,
+      std::optional<int32_t> maxFloodsInFlight = std::nullopt,
+      bool enableThriftOnlyTransport = false,
+      bool enableValueDelta = false) {
     auto tConfig = getBasicOpenrConfig(nodeId);
+    if (maxFloodsInFlight.has_value()) {
+      tConfig.kvstore_config_ref()->max_flood_requests_in_flight_ref() =
+          *maxFloodsInFlight;
+    }
+    tConfig.kvstore_config_ref()->enable_thrift_only_transport_ref() =
+        enableThriftOnlyTransport;
+    tConfig.kvstore_config_ref()->enable_value_delta_encoding_ref() =
+        enableValueDelta;
     stores_.emplace_back(std::make_shared<KvStoreWrapper>(
         context_,
         std::make_shared<Config>(tConfig),
@@ -586,6 +599,307 @@ TEST_F(SimpleKvStoreThriftTestFixture, BasicFloodingOverThrift) {
   EXPECT_EQ(3, store2->dumpAll(kTestingAreaName).size());
 }
 
+//
+// Test case for thrift only transport, no ZMQ socket is bound or polled.
+//
+// 1) Start 2 kvStores with thrift only transport;
+// 2) Add peer to each other with unreachable ZMQ urls;
+// 3) Make sure full-sync and flooding still happen over thrift;
+//
+TEST_F(KvStoreThriftTestFixture, ThriftOnlyTransport) {
+  const std::string node1{"node-1"};
+  const std::string node2{"node-2"};
+  createKvStore(node1, std::nullopt, true /* enableThriftOnlyTransport */);
+  createThriftServer(node1, stores_.back());
+  createKvStore(node2, std::nullopt, true /* enableThriftOnlyTransport */);
+  createThriftServer(node2, stores_.back());
+  auto store1 = stores_.front();
+  auto store2 = stores_.back();
+
+  const std::string key1{"key1"};
+  const std::string key2{"key2"};
+  auto thriftVal1 =
+      createThriftValue(1, store1->getNodeId(), std::string("value1"));
+  auto thriftVal2 =
+      createThriftValue(2, store2->getNodeId(), std::string("value2"));
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, key1, thriftVal1));
+  EXPECT_TRUE(store2->setKey(kTestingAreaName, key2, thriftVal2));
+
+  // ZMQ urls are never connected to
+  auto peerSpec1 = createPeerSpec(
+      "tcp://[::1]:1",
+      Constants::kPlatformHost.toString(),
+      thriftServers_.back()->getOpenrCtrlThriftPort());
+  auto peerSpec2 = createPeerSpec(
+      "tcp://[::1]:1",
+      Constants::kPlatformHost.toString(),
+      thriftServers_.front()->getOpenrCtrlThriftPort());
+  EXPECT_TRUE(
+      store1->addPeer(kTestingAreaName, store2->getNodeId(), peerSpec1));
+  EXPECT_TRUE(
+      store2->addPeer(kTestingAreaName, store1->getNodeId(), peerSpec2));
+
+  // full-sync over thrift
+  EXPECT_TRUE(verifyKvStorePeerState(
+      store1.get(),
+      store2->getNodeId(),
+      KvStorePeerState::INITIALIZED,
+      kTestingAreaName));
+  EXPECT_TRUE(
+      verifyKvStoreKeyVal(store1.get(), key2, thriftVal2, kTestingAreaName));
+  EXPECT_TRUE(
+      verifyKvStoreKeyVal(store2.get(), key1, thriftVal1, kTestingAreaName));
+  EXPECT_EQ(1, store1->getPeers(kTestingAreaName).size());
+
+  // flooding over thrift
+  const std::string key3{"key3"};
+  auto thriftVal3 =
+      createThriftValue(3, store2->getNodeId(), std::string("value3"));
+  EXPECT_TRUE(store2->setKey(kTestingAreaName, key3, thriftVal3));
+  EXPECT_TRUE(
+      verifyKvStoreKeyVal(store1.get(), key3, thriftVal3, kTestingAreaName));
+
+  EXPECT_TRUE(store1->delPeer(kTestingAreaName, store2->getNodeId()));
+  EXPECT_EQ(0, store1->getPeers(kTestingAreaName).size());
+}
+
+//
+// Test case for flood requests pipelined over thrift client of peer.
+//
+// node1 ---> node2
+//
+// 1) Inject many keys one by one into node1;
+// 2) Make sure all of them reach node2 while several flood requests are
+//    allowed in flight towards it;
+//
+TEST_F(KvStoreThriftTestFixture, PipelinedFloodingOverThrift) {
+  const std::string node1{"node-1"};
+  const std::string node2{"node-2"};
+  const int numKeys{100};
+
+  createKvStore(node1, 4 /* maxFloodsInFlight */);
+  auto store1 = stores_.back();
+  createThriftServer(node1, store1);
+
+  createKvStore(node2);
+  auto store2 = stores_.back();
+  createThriftServer(node2, store2);
+  auto thriftServer2 = thriftServers_.back();
+
+  auto peerSpec = createPeerSpec(
+      "inproc://dummy-spec-1", // TODO: remove dummy url once zmq deprecated
+      Constants::kPlatformHost.toString(),
+      thriftServer2->getOpenrCtrlThriftPort());
+  EXPECT_TRUE(store1->addPeer(kTestingAreaName, store2->getNodeId(), peerSpec));
+  EXPECT_TRUE(verifyKvStorePeerState(
+      store1.get(),
+      store2->getNodeId(),
+      KvStorePeerState::INITIALIZED,
+      kTestingAreaName));
+
+  thrift::Value lastVal;
+  for (int i = 0; i < numKeys; ++i) {
+    lastVal = createThriftValue(
+        1, store1->getNodeId(), folly::sformat("value-{}", i));
+    EXPECT_TRUE(store1->setKey(
+        kTestingAreaName, folly::sformat("key-{}", i), lastVal));
+  }
+
+  EXPECT_TRUE(verifyKvStoreKeyVal(
+      store2.get(),
+      folly::sformat("key-{}", numKeys - 1),
+      lastVal,
+      kTestingAreaName));
+  EXPECT_EQ(numKeys, store2->dumpAll(kTestingAreaName).size());
+
+  auto counters = store1->getCounters();
+  const auto prefix =
+      folly::sformat("kvstore.thrift_peer.{}", store2->getNodeId());
+  EXPECT_EQ(numKeys, counters.at(prefix + ".flood_key_vals_sent"));
+  EXPECT_GE(4, counters.at(prefix + ".floods_in_flight"));
+}
+
+//
+// Test case for TTL refresh collapsing into value update queued for peer.
+//
+// node1 ---> node2
+//
+// 1) Stall node2 so that the flood request in flight isn't acked;
+// 2) Queue value update of key1 followed by TTL refresh of same version;
+// 3) Make sure node2 ends up with the value once acks resume;
+//
+TEST_F(KvStoreThriftTestFixture, QueuedTtlRefreshKeepsValue) {
+  const std::string node1{"node-1"};
+  const std::string node2{"node-2"};
+  const std::string key1{"key1"};
+
+  createKvStore(node1, 1 /* maxFloodsInFlight */);
+  auto store1 = stores_.back();
+  createThriftServer(node1, store1);
+
+  createKvStore(node2);
+  auto store2 = stores_.back();
+  createThriftServer(node2, store2);
+
+  auto peerSpec = createPeerSpec(
+      "inproc://dummy-spec-1", // TODO: remove dummy url once zmq deprecated
+      Constants::kPlatformHost.toString(),
+      thriftServers_.back()->getOpenrCtrlThriftPort());
+  EXPECT_TRUE(store1->addPeer(kTestingAreaName, store2->getNodeId(), peerSpec));
+  EXPECT_TRUE(verifyKvStorePeerState(
+      store1.get(),
+      store2->getNodeId(),
+      KvStorePeerState::INITIALIZED,
+      kTestingAreaName));
+
+  // stall node2, flood of key0 fills in-flight window of node1
+  folly::Baton<> stalled, resume;
+  store2->getKvStore()->getEvb()->runInEventBaseThread([&]() noexcept {
+    stalled.post();
+    resume.wait();
+  });
+  stalled.wait();
+  const auto val0 = createThriftValue(1, node1, std::string("value0"));
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, "key0", val0));
+
+  // value update and TTL refresh of same version are queued
+  const auto val1 = createThriftValue(
+      1, node1, std::string("value1"), 300000 /* ttl */, 1 /* ttlVersion */);
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, key1, val1));
+  const auto ttlRefresh = createThriftValue(
+      1, node1, std::nullopt, 300000 /* ttl */, 2 /* ttlVersion */);
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, key1, ttlRefresh));
+  resume.post();
+
+  // node2 gets value of key1 with refreshed TTL
+  auto startTime = std::chrono::steady_clock::now();
+  std::optional<thrift::Value> val;
+  while (std::chrono::steady_clock::now() - startTime < waitTime_) {
+    val = store2->getKey(kTestingAreaName, key1);
+    if (val.has_value() and *val->ttlVersion_ref() == 2) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(2, *val->ttlVersion_ref());
+  ASSERT_TRUE(val->value_ref().has_value());
+  EXPECT_EQ("value1", *val->value_ref());
+}
+
+//
+// Test case for flooding value updates as delta over thrift.
+//
+// node1 ---> node2
+//
+// 1) Inject large adj: value into node1 and make sure node2 gets it;
+// 2) Update single byte of the value in node1;
+// 3) Make sure node2 reconstructs updated value from delta;
+//
+TEST_F(KvStoreThriftTestFixture, ValueDeltaFloodingOverThrift) {
+  const std::string node1{"node-1"};
+  const std::string node2{"node-2"};
+  const std::string key{"adj:node-1"};
+
+  // ONLY sender delta-encodes, receiver always decodes
+  createKvStore(
+      node1,
+      std::nullopt,
+      false /* enableThriftOnlyTransport */,
+      true /* enableValueDelta */);
+  auto store1 = stores_.back();
+  createThriftServer(node1, store1);
+
+  createKvStore(node2);
+  auto store2 = stores_.back();
+  createThriftServer(node2, store2);
+
+  auto peerSpec = createPeerSpec(
+      "inproc://dummy-spec-1", // TODO: remove dummy url once zmq deprecated
+      Constants::kPlatformHost.toString(),
+      thriftServers_.back()->getOpenrCtrlThriftPort());
+  EXPECT_TRUE(store1->addPeer(kTestingAreaName, store2->getNodeId(), peerSpec));
+  EXPECT_TRUE(verifyKvStorePeerState(
+      store1.get(),
+      store2->getNodeId(),
+      KvStorePeerState::INITIALIZED,
+      kTestingAreaName));
+
+  // first value is flooded as is, there is no base yet
+  std::string data(4 * Constants::kKvStoreMinDeltaValueSize, 'a');
+  const auto val1 = createThriftValue(1, node1, data);
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, key, val1));
+  EXPECT_TRUE(verifyKvStoreKeyVal(store2.get(), key, val1, kTestingAreaName));
+
+  // updated value is flooded as delta against first one
+  data[data.size() / 2] = 'b';
+  const auto val2 = createThriftValue(2, node1, data);
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, key, val2));
+  EXPECT_TRUE(verifyKvStoreKeyVal(store2.get(), key, val2, kTestingAreaName));
+
+  auto counters = store1->getCounters();
+  EXPECT_EQ(1, counters.at("kvstore.value_delta.num_sent.sum"));
+  EXPECT_LT(0, counters.at("kvstore.value_delta.bytes_saved.sum"));
+  EXPECT_LE(1, counters.at("kvstore.value_delta.num_received.sum"));
+}
+
+//
+// Test case for full-sync fallback on delta against mismatching base.
+//
+// node2 ---> node1
+//
+// 1) Full-sync first value of key from node1 into node2;
+// 2) Update value in node1, which isn't flooded to node2;
+// 3) Inject delta against unknown base into node2 as if flooded by node1;
+// 4) Make sure node2 fetches updated value via full-sync with node1;
+//
+TEST_F(KvStoreThriftTestFixture, ValueDeltaBaseMismatchFullSync) {
+  const std::string node1{"node-1"};
+  const std::string node2{"node-2"};
+  const std::string key{"adj:node-1"};
+
+  createKvStore(node1);
+  auto store1 = stores_.back();
+  createThriftServer(node1, store1);
+
+  createKvStore(node2);
+  auto store2 = stores_.back();
+  createThriftServer(node2, store2);
+
+  std::string data(4 * Constants::kKvStoreMinDeltaValueSize, 'a');
+  const auto val1 = createThriftValue(1, node1, data);
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, key, val1));
+
+  auto peerSpec = createPeerSpec(
+      "inproc://dummy-spec-1", // TODO: remove dummy url once zmq deprecated
+      Constants::kPlatformHost.toString(),
+      thriftServers_.front()->getOpenrCtrlThriftPort());
+  EXPECT_TRUE(store2->addPeer(kTestingAreaName, store1->getNodeId(), peerSpec));
+  EXPECT_TRUE(verifyKvStoreKeyVal(store2.get(), key, val1, kTestingAreaName));
+
+  // node1 has no peer to flood to
+  data[data.size() / 2] = 'b';
+  const auto val2 = createThriftValue(2, node1, data);
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, key, val2));
+
+  // delta of updated value against base node2 doesn't have
+  thrift::ValueDelta delta;
+  delta.baseHash_ref() = *val1.hash_ref() + 1;
+  delta.prefixLen_ref() = data.size() / 2;
+  delta.suffixLen_ref() = data.size() / 2 - 1;
+  delta.data_ref() = std::string("b");
+  auto deltaVal = createThriftValue(2, node1, std::nullopt);
+  deltaVal.hash_ref() = *val2.hash_ref();
+  deltaVal.valueDelta_ref() = std::move(delta);
+  EXPECT_TRUE(store2->setKey(
+      kTestingAreaName, key, deltaVal, std::vector<std::string>{node1}));
+
+  // delta is dropped and full value is fetched from node1
+  EXPECT_TRUE(verifyKvStoreKeyVal(store2.get(), key, val2, kTestingAreaName));
+  auto counters = store2->getCounters();
+  EXPECT_EQ(1, counters.at("kvstore.value_delta.num_failures.sum"));
+}
+
 //
 // Test case for flooding publication over thrift.
 //
@@ -9,6 +9,8 @@
 #include <thread>
 
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/Format.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/init/Init.h>
 #include <glog/logging.h>
 #include <gmock/gmock.h>
@@ -17,6 +19,10 @@
 #include <openr/config/Config.h>
 #include <openr/config/tests/Utils.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/kvstore/KvStoreHashTree.h>
+#include <openr/kvstore/KvStorePublisher.h>
+#include <openr/kvstore/KvStoreStringPool.h>
+#include <openr/kvstore/KvStoreTtlWheel.h>
 #include <openr/kvstore/KvStoreUtil.h>
 #include <openr/kvstore/KvStoreWrapper.h>
 #include <openr/tests/OpenrThriftServerWrapper.h>
@@ -268,6 +274,365 @@ TEST(KvStore, mergeKeyValuesTest) {
   }
 }
 
+//
+// validate sharded mergeKeyValues produces same result as serial merge
+//
+TEST(KvStore, mergeKeyValuesShardedTest) {
+  const size_t numShards = 4;
+  const size_t numKeys =
+      2 * numShards * Constants::kKvStoreMinKeysPerMergeShard;
+  folly::CPUThreadPoolExecutor executor(numShards);
+
+  std::unordered_map<std::string, thrift::Value> initialStore;
+  std::unordered_map<std::string, thrift::Value> update;
+  for (size_t i = 0; i < numKeys; ++i) {
+    auto key = folly::sformat("key{}", i);
+    initialStore.emplace(
+        key, createThriftValue(5, "node5", "value", 3600, 0, std::nullopt));
+    auto val = createThriftValue(5, "node5", "value", 3600, 0, std::nullopt);
+    if (i % 3 == 0) {
+      // newer version => full update
+      *val.version_ref() = 6;
+    } else if (i % 3 == 1) {
+      // ttl update only
+      val.value_ref().reset();
+      *val.ttlVersion_ref() = 1;
+    } else {
+      // older version => no update
+      *val.version_ref() = 4;
+    }
+    update.emplace(key, std::move(val));
+  }
+  // keys only exist in the update
+  for (size_t i = 0; i < numKeys / 4; ++i) {
+    update.emplace(
+        folly::sformat("newKey{}", i),
+        createThriftValue(1, "node1", "value", 3600, 0, std::nullopt));
+  }
+
+  auto serialStore = initialStore;
+  auto shardedStore = initialStore;
+  auto serialUpdates = KvStore::mergeKeyValues(serialStore, update);
+  auto shardedUpdates = KvStore::mergeKeyValuesSharded(
+      shardedStore, update, std::nullopt, &executor, numShards);
+
+  EXPECT_EQ(serialUpdates, shardedUpdates);
+  EXPECT_EQ(serialStore, shardedStore);
+  // hash must be generated for every key with updated value
+  for (auto const& [key, val] : shardedUpdates) {
+    if (val.value_ref().has_value()) {
+      EXPECT_TRUE(shardedStore.at(key).hash_ref().has_value()) << key;
+    }
+  }
+}
+
+//
+// validate KvStoreHashTree root hash and walk down to differing leaves
+//
+TEST(KvStore, hashTreeTest) {
+  const size_t fanout = 4;
+  const size_t depth = 2;
+  KvStoreHashTree tree1(fanout, depth);
+  KvStoreHashTree tree2(fanout, depth);
+  EXPECT_EQ(tree1.getRootHash(), tree2.getRootHash());
+
+  // insert keys in different order into two trees
+  const size_t numKeys = 100;
+  for (size_t i = 0; i < numKeys; ++i) {
+    tree1.update(folly::sformat("key{}", i), std::nullopt, i);
+    const auto j = numKeys - 1 - i;
+    tree2.update(folly::sformat("key{}", j), std::nullopt, j);
+  }
+  EXPECT_EQ(tree1.getRootHash(), tree2.getRootHash());
+  EXPECT_TRUE(tree1.getDifferingNodes(1, tree2.getChildren(0, {0})).empty());
+
+  // update a single key in tree2 and verify exactly one leaf differs
+  tree2.update("key7", 7, 1007);
+  EXPECT_NE(tree1.getRootHash(), tree2.getRootHash());
+  auto level1 = tree1.getDifferingNodes(1, tree2.getChildren(0, {0}));
+  ASSERT_EQ(1, level1.size());
+  auto leaves = tree1.getDifferingNodes(2, tree2.getChildren(1, level1));
+  ASSERT_EQ(1, leaves.size());
+  EXPECT_EQ(tree1.getLeafIndex("key7"), leaves.front());
+  EXPECT_EQ(
+      KvStoreHashTree::getLeafIndex("key7", fanout, depth), leaves.front());
+
+  // revert the update and verify trees converge
+  tree2.update("key7", 1007, 7);
+  EXPECT_EQ(tree1.getRootHash(), tree2.getRootHash());
+
+  // remove all keys and verify tree is back to initial state
+  for (size_t i = 0; i < numKeys; ++i) {
+    tree1.update(folly::sformat("key{}", i), i, std::nullopt);
+  }
+  EXPECT_EQ(KvStoreHashTree(fanout, depth).getRootHash(), tree1.getRootHash());
+
+  // invalid indices are ignored
+  EXPECT_TRUE(tree1.getChildren(0, {1}).empty());
+  EXPECT_TRUE(tree1.getChildren(depth, {0}).empty());
+}
+
+TEST(KvStore, ttlWheelTest) {
+  using namespace std::chrono;
+  const auto start = steady_clock::now();
+  KvStoreTtlWheel wheel(milliseconds(1), start);
+  EXPECT_FALSE(wheel.getNextTimeout(start).has_value());
+
+  auto createEntry = [&](std::string const& key, milliseconds ttl) {
+    TtlCountdownEntry entry;
+    entry.key = key;
+    entry.expiryTime = start + ttl;
+    entry.originatorId = "node1";
+    return entry;
+  };
+
+  // keys spanning all levels of the wheel
+  const std::vector<milliseconds> ttls{
+      milliseconds(10),
+      milliseconds(300),
+      milliseconds(100000),
+      milliseconds(20000000)};
+  for (size_t i = 0; i < ttls.size(); ++i) {
+    wheel.upsert(createEntry(folly::sformat("key{}", i), ttls.at(i)));
+  }
+  EXPECT_EQ(ttls.size(), wheel.size());
+  for (auto size : wheel.getLevelSizes()) {
+    EXPECT_EQ(1, size);
+  }
+  ASSERT_TRUE(wheel.find("key1").has_value());
+  EXPECT_EQ(start + ttls.at(1), wheel.find("key1")->expiryTime);
+  EXPECT_EQ("node1", wheel.find("key1")->originatorId);
+  // originator-id is shared by all entries
+  EXPECT_EQ(1, wheel.getOriginatorIds().size());
+  EXPECT_EQ(
+      (ttls.size() - 1) * std::string("node1").size(),
+      wheel.getOriginatorIds().getSavedBytes());
+
+  // refresh replaces existing entry
+  wheel.upsert(createEntry("key0", milliseconds(20)));
+  EXPECT_EQ(ttls.size(), wheel.size());
+  EXPECT_TRUE(wheel.advance(start + milliseconds(19)).empty());
+  EXPECT_EQ(milliseconds(1), *wheel.getNextTimeout(start + milliseconds(19)));
+
+  // advance by following timeouts and verify each key expires on time
+  auto now = start + milliseconds(19);
+  std::vector<std::string> expiredKeys;
+  while (not wheel.empty()) {
+    now += *wheel.getNextTimeout(now);
+    for (auto const& entry : wheel.advance(now)) {
+      EXPECT_LE(entry.expiryTime, now);
+      EXPECT_GT(entry.expiryTime + milliseconds(1), now);
+      expiredKeys.emplace_back(entry.key);
+    }
+  }
+  EXPECT_EQ(
+      std::vector<std::string>({"key0", "key1", "key2", "key3"}), expiredKeys);
+
+  // removed key never expires
+  wheel.upsert(createEntry("key4", milliseconds(40000000)));
+  wheel.erase("key4");
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_TRUE(wheel.advance(start + milliseconds(50000000)).empty());
+  EXPECT_EQ(0, wheel.getOriginatorIds().size());
+}
+
+TEST(KvStore, filterMatchTest) {
+  auto value = createThriftValue(1, "node1", "value");
+
+  // literal, literal with trailing `.*` and regex prefixes
+  KvStoreFilters filters({"adj:", "prefix:.*", "(allocprefix|nodeLabel):"}, {});
+  EXPECT_TRUE(filters.keyMatchAny("adj:node1", value));
+  EXPECT_TRUE(filters.keyMatchAny("prefix:node1", value));
+  EXPECT_TRUE(filters.keyMatchAny("allocprefix:node1", value));
+  EXPECT_TRUE(filters.keyMatchAny("nodeLabel:node1", value));
+  EXPECT_FALSE(filters.keyMatchAny("ad", value));
+  EXPECT_FALSE(filters.keyMatchAny("xadj:node1", value));
+  EXPECT_FALSE(filters.keyMatchAny("allocprefi:node1", value));
+
+  // empty prefix matches all keys
+  EXPECT_TRUE(KvStoreFilters({""}, {}).keyMatchAny("any", value));
+  EXPECT_TRUE(KvStoreFilters({}, {}).keyMatchAll("any", value));
+
+  // combination with originator ids
+  KvStoreFilters nodeFilters({"adj:"}, {"node2"});
+  EXPECT_TRUE(nodeFilters.keyMatchAny("adj:node1", value));
+  EXPECT_FALSE(nodeFilters.keyMatchAll("adj:node1", value));
+  EXPECT_TRUE(nodeFilters.keyMatchAny(
+      "prefix:node2", createThriftValue(1, "node2", "value")));
+  EXPECT_TRUE(nodeFilters.keyMatchAll(
+      "adj:node2", createThriftValue(1, "node2", "value")));
+  EXPECT_FALSE(nodeFilters.keyMatchAny("prefix:node1", value));
+}
+
+TEST(KvStore, subscriptionMatchTest) {
+  thrift::Publication pub;
+  pub.area_ref() = "area1";
+  pub.keyVals_ref()->emplace("key1", createThriftValue(1, "node1", "value"));
+  pub.keyVals_ref()->emplace("adj:node1", createThriftValue(1, "node1", "v"));
+  pub.keyVals_ref()->emplace("adj:node2", createThriftValue(1, "node2", "v"));
+  auto ttlUpdate = createThriftValue(1, "node1", "value");
+  ttlUpdate.value_ref().reset();
+  pub.keyVals_ref()->emplace("key2", ttlUpdate);
+  *pub.expiredKeys_ref() = {"key3", "adj:node3"};
+  auto pubPtr = std::make_shared<const thrift::Publication>(pub);
+
+  // nothing subscribed
+  KvStoreSubscription subscription;
+  EXPECT_EQ(nullptr, subscription.match(pubPtr));
+
+  // exact keys of area. TTL updates don't match
+  subscription.setKey("area1", "key1", true);
+  subscription.setKey("area1", "key2", true);
+  subscription.setKey("area1", "key3", true);
+  subscription.setKey("area2", "adj:node1", true);
+  auto matched = subscription.match(pubPtr);
+  ASSERT_NE(nullptr, matched);
+  EXPECT_EQ("area1", *matched->area_ref());
+  EXPECT_EQ(1, matched->keyVals_ref()->size());
+  EXPECT_EQ(1, matched->keyVals_ref()->count("key1"));
+  EXPECT_EQ(std::vector<std::string>{"key3"}, *matched->expiredKeys_ref());
+  subscription.setKey("area1", "key1", false);
+  subscription.setKey("area1", "key3", false);
+  EXPECT_EQ(nullptr, subscription.match(pubPtr));
+
+  // key prefixes of area
+  subscription.addKeyPrefix(1, "area1", "adj:");
+  matched = subscription.match(pubPtr);
+  ASSERT_NE(nullptr, matched);
+  EXPECT_EQ(2, matched->keyVals_ref()->size());
+  EXPECT_EQ(
+      std::vector<std::string>{"adj:node3"}, *matched->expiredKeys_ref());
+  subscription.removeKeyPrefix(1);
+  EXPECT_EQ(nullptr, subscription.match(pubPtr));
+
+  // filters of any area. They don't match expired keys
+  subscription.setFilters(KvStoreFilters({"adj:"}, {"node2"}));
+  matched = subscription.match(pubPtr);
+  ASSERT_NE(nullptr, matched);
+  EXPECT_EQ(2, matched->keyVals_ref()->size());
+  EXPECT_TRUE(matched->expiredKeys_ref()->empty());
+  subscription.setFilters(std::nullopt);
+  EXPECT_EQ(nullptr, subscription.match(pubPtr));
+
+  // everything, publication is shared as is
+  subscription.setMatchAll(true);
+  EXPECT_EQ(pubPtr, subscription.match(pubPtr));
+}
+
+TEST(KvStore, stringPoolTest) {
+  KvStoreStringPool pool;
+  auto const* node1 = pool.intern("node1");
+  auto const* node2 = pool.intern("node2");
+  EXPECT_EQ(node1, pool.intern("node1"));
+  EXPECT_NE(node1, node2);
+  EXPECT_EQ("node1", *node1);
+  EXPECT_EQ(2, pool.size());
+  EXPECT_EQ(10, pool.getBytes());
+  EXPECT_EQ(5, pool.getSavedBytes());
+
+  // string stays interned till its last reference is released
+  pool.release(node1);
+  EXPECT_EQ(2, pool.size());
+  EXPECT_EQ(0, pool.getSavedBytes());
+  pool.release(node1);
+  pool.release(node2);
+  EXPECT_EQ(0, pool.size());
+  EXPECT_EQ(0, pool.getBytes());
+}
+
+TEST(KvStore, changeLogTest) {
+  KvStoreChangeLog changeLog(2, 100);
+  auto makePub = [](thrift::KeyVals keyVals,
+                    std::vector<std::string> expiredKeys = {}) {
+    thrift::Publication pub;
+    pub.area_ref() = "area1";
+    pub.keyVals_ref() = std::move(keyVals);
+    pub.expiredKeys_ref() = std::move(expiredKeys);
+    return pub;
+  };
+
+  // empty log can be resumed from its initial cursor only
+  EXPECT_EQ(99, changeLog.getLastSeqNum("area1"));
+  EXPECT_TRUE(changeLog.getChangesSince("area1", 99).has_value());
+  EXPECT_FALSE(changeLog.getChangesSince("area1", 100).has_value());
+
+  auto pub = changeLog.append(
+      makePub({{"key1", createThriftValue(1, "node1", "v1")},
+               {"key2", createThriftValue(1, "node1", "v2")}}));
+  EXPECT_EQ(100, *pub->seqNum_ref());
+  changeLog.append(makePub(
+      {{"key1", createThriftValue(1, "node1", std::nullopt, 100, 1)}},
+      {"key2"}));
+  EXPECT_EQ(101, changeLog.getLastSeqNum("area1"));
+  EXPECT_EQ(99, changeLog.getLastSeqNum("area2"));
+
+  // changes are merged. TTL update retains value of the key
+  auto changes = changeLog.getChangesSince("area1", 99);
+  ASSERT_TRUE(changes.has_value());
+  EXPECT_EQ(101, *changes->seqNum_ref());
+  EXPECT_TRUE(*changes->isIncremental_ref());
+  ASSERT_EQ(1, changes->keyVals_ref()->size());
+  auto const& val = changes->keyVals_ref()->at("key1");
+  EXPECT_EQ("v1", *val.value_ref());
+  EXPECT_EQ(1, *val.ttlVersion_ref());
+  EXPECT_EQ(std::vector<std::string>{"key2"}, *changes->expiredKeys_ref());
+
+  // nothing missed since last publication
+  changes = changeLog.getChangesSince("area1", 101);
+  ASSERT_TRUE(changes.has_value());
+  EXPECT_TRUE(changes->keyVals_ref()->empty());
+
+  // evicted publication can't be resumed from
+  changeLog.append(makePub({{"key3", createThriftValue(1, "node1", "v3")}}));
+  EXPECT_FALSE(changeLog.getChangesSince("area1", 99).has_value());
+  changes = changeLog.getChangesSince("area1", 100);
+  ASSERT_TRUE(changes.has_value());
+  EXPECT_EQ(2, changes->keyVals_ref()->size());
+  EXPECT_FALSE(changes->keyVals_ref()->at("key1").value_ref().has_value());
+  EXPECT_EQ(std::vector<std::string>{"key2"}, *changes->expiredKeys_ref());
+}
+
+TEST(KvStore, valueMetaDecodeTest) {
+  apache::thrift::CompactSerializer serializer;
+  thrift::KvStoreRequest request;
+  request.cmd_ref() = thrift::Command::KEY_SET;
+  request.area_ref() = "area1";
+  thrift::KeySetParams params;
+  params.keyVals_ref()->emplace(
+      "key1", createThriftValue(3, "node1", "value1", 100, 2, 12345));
+  params.solicitResponse_ref() = false;
+  params.nodeIds_ref() = std::vector<std::string>{"node1"};
+  params.timestamp_ms_ref() = 1000;
+  request.keySetParams_ref() = params;
+
+  // request decodes as its metadata view with values skipped
+  auto meta = readThriftObjStr<thrift::KvStoreRequestMeta>(
+      writeThriftObjStr(request, serializer), serializer);
+  EXPECT_EQ(thrift::Command::KEY_SET, *meta.cmd_ref());
+  EXPECT_EQ("area1", *meta.area_ref());
+  ASSERT_TRUE(meta.keySetParams_ref().has_value());
+  auto const& metaParams = *meta.keySetParams_ref();
+  EXPECT_FALSE(*metaParams.solicitResponse_ref());
+  EXPECT_EQ(std::vector<std::string>{"node1"}, *metaParams.nodeIds_ref());
+  EXPECT_EQ(1000, *metaParams.timestamp_ms_ref());
+  ASSERT_EQ(1, metaParams.keyVals_ref()->size());
+  auto const& valueMeta = metaParams.keyVals_ref()->at("key1");
+  EXPECT_EQ(3, *valueMeta.version_ref());
+  EXPECT_EQ("node1", *valueMeta.originatorId_ref());
+  EXPECT_EQ(2, *valueMeta.ttlVersion_ref());
+  EXPECT_EQ(12345, *valueMeta.hash_ref());
+
+  // so does full-sync response
+  thrift::Publication pub;
+  *pub.keyVals_ref() = *params.keyVals_ref();
+  pub.tobeUpdatedKeys_ref() = std::vector<std::string>{"key2"};
+  auto pubMeta = readThriftObjStr<thrift::PublicationMeta>(
+      writeThriftObjStr(pub, serializer), serializer);
+  EXPECT_EQ(1, pubMeta.keyVals_ref()->count("key1"));
+  EXPECT_EQ(std::vector<std::string>{"key2"}, *pubMeta.tobeUpdatedKeys_ref());
+  EXPECT_FALSE(pubMeta.compressed_ref().has_value());
+}
+
 //
 // Test compareValues method
 //
@@ -5,9 +5,15 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <thread>
 
+#include <folly/Bits.h>
+#include <folly/Random.h>
 #include <folly/init/Init.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/OpenrClient.h>
 #include <openr/kvstore/KvStore.h>
@@ -16,25 +22,132 @@ DEFINE_string(host, "::1", "Host to connect to");
 DEFINE_int32(port, openr::Constants::kOpenrCtrlPort, "OpenrCtrl server port");
 DEFINE_int32(connect_timeout_ms, 1000, "Connect timeout for client");
 DEFINE_int32(processing_timeout_ms, 5000, "Processing timeout for client");
+DEFINE_string(
+    mode,
+    "snoop",
+    "One of `snoop` (print publications), `record` (write publications to "
+    "--record_file), `replay` (set publications of --record_file) or "
+    "`generate` (set synthetic key churn)");
 
-int
-main(int argc, char** argv) {
-  // Initialize all params
-  folly::init(&argc, &argv);
+// record / replay
+DEFINE_string(record_file, "", "File publications are recorded to/played from");
+DEFINE_int32(
+    record_duration_s, 0, "Stop recording after duration. 0 records forever");
+DEFINE_double(
+    replay_speed,
+    1.0,
+    "Speed multiple of replay against recorded timing. 0 replays publications "
+    "back to back");
+DEFINE_string(replay_area, "", "Replay into area instead of recorded one");
+DEFINE_int64(
+    replay_version_offset,
+    0,
+    "Added to versions of replayed key-vals, so they win over the ones which "
+    "target node already has");
 
-  // Define and start event base
-  folly::EventBase evb;
-  std::thread evbThread([&evb]() { evb.loopForever(); });
+// generate
+DEFINE_string(
+    gen_area,
+    openr::thrift::KvStore_constants::kDefaultArea().c_str(),
+    "Area to generate key churn in");
+DEFINE_string(gen_key_prefix, "snooper:", "Prefix of generated keys");
+DEFINE_string(gen_originator, "kvstore-snooper", "Originator of key-vals");
+DEFINE_uint32(gen_num_keys, 1000, "Number of distinct keys updated");
+DEFINE_uint32(gen_updates_per_sec, 100, "Key updates per second");
+DEFINE_uint32(gen_duration_s, 60, "Duration of key churn");
+DEFINE_uint32(gen_batch_interval_ms, 100, "Interval of update batches");
+DEFINE_uint32(gen_value_size_min, 64, "Minimum value size in bytes");
+DEFINE_uint32(gen_value_size_max, 1024, "Maximum value size in bytes");
+DEFINE_int64(
+    gen_start_version,
+    1,
+    "Version of first update of every key, raise it to win over key-vals of "
+    "a previous run");
+DEFINE_int64(
+    gen_ttl_ms, openr::Constants::kTtlInfinity, "TTL of generated key-vals");
 
-  // Create Open/R client
-  auto client =
-      openr::getOpenrCtrlPlainTextClient<apache::thrift::RocketClientChannel>(
-          evb,
-          folly::IPAddress(FLAGS_host),
-          FLAGS_port,
-          std::chrono::milliseconds(FLAGS_connect_timeout_ms),
-          std::chrono::milliseconds(FLAGS_processing_timeout_ms));
-  auto response = client->semifuture_subscribeAndGetAreaKvStores({}, {}).get();
+namespace {
+
+using OpenrCtrlClient = openr::thrift::OpenrCtrlCppAsyncClient;
+
+/**
+ * Recording is a sequence of compact-serialized thrift::KvStoreSnapshot, one
+ * per publication, each preceded by its size as big-endian uint32. Snapshot
+ * timestamp is the time publication was received at.
+ */
+void
+writeRecord(std::ofstream& out, const openr::thrift::KvStoreSnapshot& record) {
+  const auto buf =
+      apache::thrift::CompactSerializer::serialize<std::string>(record);
+  const uint32_t size = folly::Endian::big(static_cast<uint32_t>(buf.size()));
+  out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out.write(buf.data(), buf.size());
+  out.flush();
+}
+
+std::optional<openr::thrift::KvStoreSnapshot>
+readRecord(std::ifstream& in) {
+  uint32_t size{0};
+  if (not in.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+    return std::nullopt;
+  }
+  std::string buf(folly::Endian::big(size), '\0');
+  if (not in.read(buf.data(), buf.size())) {
+    LOG(ERROR) << "Truncated record in " << FLAGS_record_file;
+    return std::nullopt;
+  }
+  return apache::thrift::CompactSerializer::deserialize<
+      openr::thrift::KvStoreSnapshot>(buf);
+}
+
+int64_t
+getUnixTimeMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void
+printPublication(
+    std::unordered_map<std::string, openr::thrift::Value>& keyVals,
+    const openr::thrift::Publication& pub) {
+  // Print expired key-vals
+  for (const auto& key : *pub.expiredKeys_ref()) {
+    std::cout << "Expired Key: " << key << std::endl;
+    std::cout << "" << std::endl;
+  }
+
+  // Print updates
+  auto updatedKeyVals =
+      openr::KvStore::mergeKeyValues(keyVals, *pub.keyVals_ref());
+  for (auto& kv : updatedKeyVals) {
+    std::cout << (kv.second.value_ref().has_value() ? "Updated" : "Refreshed")
+              << " KeyVal: " << kv.first << std::endl;
+    std::cout << "  version: " << *kv.second.version_ref() << std::endl;
+    std::cout << "  originatorId: " << *kv.second.originatorId_ref()
+              << std::endl;
+    std::cout << "  ttl: " << *kv.second.ttl_ref() << std::endl;
+    std::cout << "  ttlVersion: " << *kv.second.ttlVersion_ref() << std::endl;
+    std::cout << "  hash: " << kv.second.hash_ref().value() << std::endl
+              << std::endl; // intended
+  }
+}
+
+// Snoop or record publications of all areas until evb is terminated
+int
+subscribe(
+    folly::EventBase& evb, std::thread& evbThread, OpenrCtrlClient& client) {
+  std::unique_ptr<std::ofstream> out;
+  if (FLAGS_mode == "record") {
+    out = std::make_unique<std::ofstream>(
+        FLAGS_record_file, std::ios::binary | std::ios::trunc);
+    if (not *out) {
+      LOG(ERROR) << "Failed to open " << FLAGS_record_file;
+      return 1;
+    }
+  }
+
+  auto response = client.semifuture_subscribeAndGetAreaKvStores({}, {}).get();
   std::unordered_map<
       std::string /* area */,
       std::unordered_map<std::string /* key */, openr::thrift::Value>>
@@ -44,51 +157,280 @@ main(int argc, char** argv) {
     LOG(INFO) << "Received " << pub.get_keyVals().size()
               << " entries in initial dump for area: " << pub.get_area();
     areaKeyVals[pub.get_area()] = pub.get_keyVals();
+    if (out) {
+      // Initial dump is replayed at time 0 of recording
+      openr::thrift::KvStoreSnapshot record;
+      *record.area_ref() = pub.get_area();
+      *record.timestampMs_ref() = getUnixTimeMs();
+      *record.keyVals_ref() = pub.get_keyVals();
+      writeRecord(*out, record);
+    }
   }
   LOG(INFO) << "";
 
+  if (out and FLAGS_record_duration_s > 0) {
+    evb.runInEventBaseThread([&evb]() {
+      evb.runAfterDelay(
+          [&evb]() { evb.terminateLoopSoon(); },
+          FLAGS_record_duration_s * 1000);
+    });
+  }
+
+  size_t numRecorded{0};
   auto subscription =
       std::move(response.stream)
           .subscribeExTry(
               folly::Executor::getKeepAliveToken(&evb),
-              [areaKeyVals = std::move(areaKeyVals)](
+              [&out, &numRecorded, areaKeyVals = std::move(areaKeyVals)](
                   folly::Try<openr::thrift::Publication>&& maybePub) mutable {
                 if (maybePub.hasException()) {
                   LOG(ERROR) << maybePub.exception().what();
                   return;
                 }
                 auto& pub = maybePub.value();
-                // Print expired key-vals
-                for (const auto& key : *pub.expiredKeys_ref()) {
-                  std::cout << "Expired Key: " << key << std::endl;
-                  std::cout << "" << std::endl;
+                if (not out) {
+                  printPublication(areaKeyVals[pub.get_area()], pub);
+                  return;
                 }
-
-                // Print updates
-                auto updatedKeyVals = openr::KvStore::mergeKeyValues(
-                    areaKeyVals.at(pub.get_area()), *pub.keyVals_ref());
-                for (auto& kv : updatedKeyVals) {
-                  std::cout << (kv.second.value_ref().has_value() ? "Updated"
-                                                                  : "Refreshed")
-                            << " KeyVal: " << kv.first << std::endl;
-                  std::cout << "  version: " << *kv.second.version_ref()
-                            << std::endl;
-                  std::cout
-                      << "  originatorId: " << *kv.second.originatorId_ref()
-                      << std::endl;
-                  std::cout << "  ttl: " << *kv.second.ttl_ref() << std::endl;
-                  std::cout << "  ttlVersion: " << *kv.second.ttlVersion_ref()
-                            << std::endl;
-                  std::cout << "  hash: " << kv.second.hash_ref().value()
-                            << std::endl
-                            << std::endl; // intended
+                // NOTE: expired keys can't be replayed and aren't recorded
+                if (pub.keyVals_ref()->empty()) {
+                  return;
+                }
+                openr::thrift::KvStoreSnapshot record;
+                *record.area_ref() = pub.get_area();
+                *record.timestampMs_ref() = getUnixTimeMs();
+                *record.keyVals_ref() = std::move(*pub.keyVals_ref());
+                writeRecord(*out, record);
+                if (++numRecorded % 1000 == 0) {
+                  LOG(INFO) << "Recorded " << numRecorded << " publications";
                 }
               });
 
   evbThread.join();
   subscription.cancel();
   std::move(subscription).detach();
-  client.reset();
+  if (out) {
+    LOG(INFO) << "Recorded " << numRecorded << " publications to "
+              << FLAGS_record_file;
+  }
+  return 0;
+}
 
+/**
+ * Set key-vals in target node and account time it took. Returns false if
+ * request failed
+ */
+bool
+setKeyVals(
+    OpenrCtrlClient& client,
+    const std::string& area,
+    openr::thrift::KeyVals keyVals,
+    std::chrono::milliseconds& totalLatency,
+    std::chrono::milliseconds& maxLatency) {
+  openr::thrift::KeySetParams params;
+  *params.keyVals_ref() = std::move(keyVals);
+  const auto startTime = std::chrono::steady_clock::now();
+  try {
+    client.semifuture_setKvStoreKeyVals(params, area).get();
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to set key-vals: " << folly::exceptionStr(ex);
+    return false;
+  }
+  const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  totalLatency += latency;
+  maxLatency = std::max(maxLatency, latency);
+  return true;
+}
+
+void
+logThroughput(
+    size_t numRequests,
+    size_t numKeys,
+    std::chrono::steady_clock::time_point startTime,
+    std::chrono::milliseconds totalLatency,
+    std::chrono::milliseconds maxLatency) {
+  const auto durationMs = std::max<int64_t>(
+      1,
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - startTime)
+          .count());
+  LOG(INFO) << "Set " << numKeys << " key-vals in " << numRequests
+            << " requests over " << durationMs << "ms, "
+            << numKeys * 1000 / durationMs << " keys/sec, request latency avg "
+            << (numRequests ? totalLatency.count() / numRequests : 0)
+            << "ms, max " << maxLatency.count() << "ms";
+}
+
+// Set recorded publications in target node at recorded pace
+int
+replay(OpenrCtrlClient& client) {
+  std::ifstream in(FLAGS_record_file, std::ios::binary);
+  if (not in) {
+    LOG(ERROR) << "Failed to open " << FLAGS_record_file;
+    return 1;
+  }
+
+  size_t numRequests{0};
+  size_t numKeys{0};
+  size_t numSkipped{0};
+  std::chrono::milliseconds totalLatency{0};
+  std::chrono::milliseconds maxLatency{0};
+  std::optional<int64_t> firstTimestampMs;
+  const auto startTime = std::chrono::steady_clock::now();
+  while (auto record = readRecord(in)) {
+    if (not firstTimestampMs.has_value()) {
+      firstTimestampMs = *record->timestampMs_ref();
+    }
+    if (FLAGS_replay_speed > 0) {
+      /* sleep override */
+      std::this_thread::sleep_until(
+          startTime +
+          std::chrono::milliseconds(static_cast<int64_t>(
+              (*record->timestampMs_ref() - *firstTimestampMs) /
+              FLAGS_replay_speed)));
+    }
+
+    openr::thrift::KeyVals keyVals;
+    for (auto& [key, val] : *record->keyVals_ref()) {
+      // Delta-encoded values are against base only known by recorded node
+      if (val.valueDelta_ref().has_value()) {
+        ++numSkipped;
+        continue;
+      }
+      if (FLAGS_replay_version_offset) {
+        *val.version_ref() += FLAGS_replay_version_offset;
+        val.hash_ref() = openr::generateHash(
+            *val.version_ref(),
+            *val.originatorId_ref(),
+            val.value_ref().to_optional());
+      }
+      keyVals.emplace(key, std::move(val));
+    }
+    if (keyVals.empty()) {
+      continue;
+    }
+    numKeys += keyVals.size();
+    ++numRequests;
+    setKeyVals(
+        client,
+        FLAGS_replay_area.empty() ? *record->area_ref() : FLAGS_replay_area,
+        std::move(keyVals),
+        totalLatency,
+        maxLatency);
+  }
+  if (numSkipped) {
+    LOG(WARNING) << "Skipped " << numSkipped << " delta-encoded key-vals";
+  }
+  logThroughput(numRequests, numKeys, startTime, totalLatency, maxLatency);
+  return 0;
+}
+
+// Set random updates of FLAGS_gen_num_keys keys at FLAGS_gen_updates_per_sec
+int
+generate(OpenrCtrlClient& client) {
+  if (not FLAGS_gen_num_keys or not FLAGS_gen_batch_interval_ms or
+      FLAGS_gen_value_size_min > FLAGS_gen_value_size_max) {
+    LOG(ERROR) << "Invalid key churn parameters";
+    return 1;
+  }
+
+  std::vector<int64_t> versions(FLAGS_gen_num_keys, FLAGS_gen_start_version);
+  const auto interval = std::chrono::milliseconds(FLAGS_gen_batch_interval_ms);
+  const auto numBatches = FLAGS_gen_duration_s * 1000 / interval.count();
+  // Spread remainder over batches to keep overall rate exact
+  uint64_t numScheduled{0};
+
+  size_t numRequests{0};
+  size_t numKeys{0};
+  std::chrono::milliseconds totalLatency{0};
+  std::chrono::milliseconds maxLatency{0};
+  const auto startTime = std::chrono::steady_clock::now();
+  for (uint64_t batch = 1; batch <= numBatches; ++batch) {
+    const uint64_t numDue =
+        batch * interval.count() * FLAGS_gen_updates_per_sec / 1000;
+    openr::thrift::KeyVals keyVals;
+    for (; numScheduled < numDue; ++numScheduled) {
+      const auto index = folly::Random::rand32(FLAGS_gen_num_keys);
+      const auto size = folly::Random::rand32(
+          FLAGS_gen_value_size_min, FLAGS_gen_value_size_max + 1);
+      std::string data(size, '\0');
+      for (auto& c : data) {
+        c = static_cast<char>(folly::Random::rand32(256));
+      }
+      // Same key drawn twice in a batch is set once with latest version
+      keyVals[folly::sformat("{}{}", FLAGS_gen_key_prefix, index)] =
+          openr::createThriftValue(
+              versions[index]++,
+              FLAGS_gen_originator,
+              std::move(data),
+              FLAGS_gen_ttl_ms);
+    }
+    if (not keyVals.empty()) {
+      numKeys += keyVals.size();
+      ++numRequests;
+      if (not setKeyVals(
+              client,
+              FLAGS_gen_area,
+              std::move(keyVals),
+              totalLatency,
+              maxLatency)) {
+        return 1;
+      }
+    }
+    // NOTE: falls behind schedule if node doesn't keep up with rate
+    /* sleep override */
+    std::this_thread::sleep_until(startTime + batch * interval);
+  }
+  logThroughput(numRequests, numKeys, startTime, totalLatency, maxLatency);
   return 0;
 }
+
+} // namespace
+
+int
+main(int argc, char** argv) {
+  // Initialize all params
+  folly::init(&argc, &argv);
+
+  if (FLAGS_mode != "snoop" and FLAGS_mode != "record" and
+      FLAGS_mode != "replay" and FLAGS_mode != "generate") {
+    LOG(ERROR) << "Unknown mode " << FLAGS_mode;
+    return 1;
+  }
+  if ((FLAGS_mode == "record" or FLAGS_mode == "replay") and
+      FLAGS_record_file.empty()) {
+    LOG(ERROR) << "--record_file is required in mode " << FLAGS_mode;
+    return 1;
+  }
+
+  // Define and start event base
+  folly::EventBase evb;
+  std::thread evbThread([&evb]() { evb.loopForever(); });
+
+  // Create Open/R client
+  auto client =
+      openr::getOpenrCtrlPlainTextClient<apache::thrift::RocketClientChannel>(
+          evb,
+          folly::IPAddress(FLAGS_host),
+          FLAGS_port,
+          std::chrono::milliseconds(FLAGS_connect_timeout_ms),
+          std::chrono::milliseconds(FLAGS_processing_timeout_ms));
+
+  int ret{0};
+  if (FLAGS_mode == "replay") {
+    ret = replay(*client);
+  } else if (FLAGS_mode == "generate") {
+    ret = generate(*client);
+  } else {
+    ret = subscribe(evb, evbThread, *client);
+  }
+
+  if (evbThread.joinable()) {
+    evb.terminateLoopSoon();
+    evbThread.join();
+  }
+  client.reset();
+
+  return ret;
+}
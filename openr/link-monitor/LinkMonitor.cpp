@@ -77,10 +77,11 @@ LinkMonitor::LinkMonitor(
     messaging::ReplicateQueue<thrift::PeerUpdateRequest>& peerUpdatesQueue,
     messaging::ReplicateQueue<LogSample>& logSampleQueue,
     messaging::RQueue<thrift::SparkNeighborEvent> neighborUpdatesQueue,
-    messaging::RQueue<fbnl::NetlinkEvent> netlinkEventsQueue,
+    messaging::RQueue<fbnl::NetlinkEvents> netlinkEventsQueue,
     bool assumeDrained,
     bool overrideDrainState,
-    std::chrono::seconds adjHoldTime)
+    std::chrono::seconds adjHoldTime,
+    std::optional<messaging::RQueue<ConfigPtr>> configUpdatesQueue)
     : nodeId_(config->getNodeName()),
       enablePerfMeasurement_(enablePerfMeasurement),
       enableV4_(config->isV4Enabled()),
@@ -89,6 +90,9 @@ LinkMonitor::LinkMonitor(
       prefixForwardingAlgorithm_(
           *config->getConfig().prefix_forwarding_algorithm_ref()),
       useRttMetric_(*config->getLinkMonitorConfig().use_rtt_metric_ref()),
+      eventDrivenInterfaceSync_(
+          *config->getLinkMonitorConfig()
+               .enable_event_driven_interface_sync_ref()),
       linkflapInitBackoff_(std::chrono::milliseconds(
           *config->getLinkMonitorConfig().linkflap_initial_backoff_ms_ref())),
       linkflapMaxBackoff_(std::chrono::milliseconds(
@@ -99,6 +103,7 @@ LinkMonitor::LinkMonitor(
       prefixUpdatesQueue_(prefixUpdatesQueue),
       peerUpdatesQueue_(peerUpdatesQueue),
       logSampleQueue_(logSampleQueue),
+      logSampleLimiter_(*config->getMonitorConfig().event_log_limits_ref()),
       expBackoff_(Constants::kInitialBackoff, Constants::kMaxBackoff, true),
       configStore_(configStore),
       nlSock_(nlSock) {
@@ -112,17 +117,33 @@ LinkMonitor::LinkMonitor(
     LOG(INFO) << "Hold time expired. Advertising adjacencies and addresses";
     // Advertise adjacencies and addresses after hold-timeout
     advertiseAdjacencies();
-    advertiseRedistAddrs();
+    advertiseRedistAddrs(true /* fullSync */);
+    redistAddrsFullSyncTimer_->scheduleTimeout(
+        Constants::kRedistAddrsFullSyncInterval);
   });
 
-  // Create throttled adjacency advertiser
-  advertiseAdjacenciesThrottled_ = std::make_unique<AsyncThrottle>(
-      getEvb(), Constants::kLinkThrottleTimeout, [this]() noexcept {
-        // will advertise to all areas but will not trigger a adj key update
-        // if nothing changed.
-        advertiseAdjacencies();
+  // Periodically sync all redistribute prefixes to recover from any drift
+  // of incremental updates
+  redistAddrsFullSyncTimer_ =
+      folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+        advertiseRedistAddrs(true /* fullSync */);
+        redistAddrsFullSyncTimer_->scheduleTimeout(
+            Constants::kRedistAddrsFullSyncInterval);
       });
 
+  // Create throttled adjacency advertiser per area
+  for (const auto& [areaId, _] : areas_) {
+    advertiseAdjacenciesThrottled_.emplace(
+        areaId,
+        std::make_unique<AsyncThrottle>(
+            getEvb(),
+            Constants::kLinkThrottleTimeout,
+            [this, areaId = areaId]() noexcept {
+              // will not trigger a adj key update if nothing changed.
+              advertiseAdjacencies(areaId);
+            }));
+  }
+
   // Create throttled interfaces and addresses advertiser
   advertiseIfaceAddrThrottled_ = std::make_unique<AsyncThrottle>(
       getEvb(), Constants::kLinkThrottleTimeout, [this]() noexcept {
@@ -173,6 +194,7 @@ LinkMonitor::LinkMonitor(
               kvStoreClient_.get(),
               [&](std::optional<int32_t> newVal) noexcept {
                 state_.nodeLabel_ref() = newVal ? newVal.value() : 0;
+                invalidateAdjacencyDbCache();
                 advertiseAdjacencies();
               }, /* callback */
               std::chrono::milliseconds(100), /* minBackoffDur */
@@ -199,40 +221,105 @@ LinkMonitor::LinkMonitor(
   // start initial dump timer
   adjHoldTimer_->scheduleTimeout(adjHoldTime);
 
-  // Add fiber to process the neighbor events
+  // Add fiber per area to process its neighbor events. Fibers yield after
+  // every event, so that a burst of events in one area, e.g. on link flaps,
+  // doesn't hold back events of other areas queued behind it
+  for (const auto& [areaId, _] : areas_) {
+    auto areaQueue =
+        std::make_shared<messaging::RWQueue<thrift::SparkNeighborEvent>>();
+    areaNeighborUpdatesQueues_.emplace(areaId, areaQueue);
+    addFiberTask([q = std::move(areaQueue), areaId = areaId, this]() noexcept {
+      while (true) {
+        auto maybeEvent = q->get();
+        if (maybeEvent.hasError()) {
+          LOG(INFO) << "Terminating neighbor update processing fiber of area "
+                    << areaId;
+          break;
+        }
+        processNeighborEvent(std::move(maybeEvent).value());
+        folly::fibers::yield();
+      }
+    });
+  }
+
+  // Add fiber to dispatch the neighbor events to fibers of their area
   addFiberTask([q = std::move(neighborUpdatesQueue), this]() mutable noexcept {
     while (true) {
       auto maybeEvent = q.get();
       if (maybeEvent.hasError()) {
         LOG(INFO) << "Terminating neighbor update processing fiber";
+        for (auto& [_, areaQueue] : areaNeighborUpdatesQueues_) {
+          areaQueue->close();
+        }
         break;
       }
-      processNeighborEvent(std::move(maybeEvent).value());
+      auto& event = maybeEvent.value();
+      auto it = areaNeighborUpdatesQueues_.find(*event.info_ref()->area_ref());
+      if (it == areaNeighborUpdatesQueues_.end()) {
+        // Unknown area, it gets reported by processing of the event
+        processNeighborEvent(std::move(event));
+        continue;
+      }
+      it->second->push(std::move(event));
     }
   });
 
   // Add fiber to process the LINK/ADDR events from platform
   addFiberTask([q = std::move(netlinkEventsQueue), this]() mutable noexcept {
     while (true) {
-      auto maybeEvent = q.get();
-      if (maybeEvent.hasError()) {
+      auto maybeEvents = q.get();
+      if (maybeEvents.hasError()) {
         LOG(INFO) << "Terminating netlink events processing fiber";
         break;
       }
-      processNetlinkEvent(std::move(maybeEvent).value());
+      processNetlinkEvents(std::move(maybeEvents).value());
     }
   });
 
+  // Add fiber to process reloaded config
+  if (configUpdatesQueue) {
+    addFiberTask([q = std::move(configUpdatesQueue).value(),
+                  this]() mutable noexcept {
+      while (true) {
+        auto maybeConfig = q.get();
+        if (maybeConfig.hasError()) {
+          LOG(INFO) << "Terminating config updates processing fiber";
+          break;
+        }
+        processConfigUpdate(*maybeConfig.value());
+      }
+    });
+  }
+
   // TODO: Add fiber to process KvStore InitialSync events
   // processKvStoreSyncEvent();
 
   // Schedule periodic timer for InterfaceDb re-sync from Netlink Platform
+  // NOTE: With event driven sync, timer only checks for lost netlink events
+  // once InterfaceDb is synced. Netlink events keep it up to date otherwise
   interfaceDbSyncTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+    const auto eventsLostCount = nlSock_->getEventsLostCount();
+    if (eventDrivenInterfaceSync_ and interfaceDbSynced_) {
+      if (eventsLostCount == netlinkEventsLostCount_) {
+        interfaceDbSyncTimer_->scheduleTimeout(
+            Constants::kNetlinkEventsLostCheckInterval);
+        return;
+      }
+      LOG(WARNING) << "Netlink events got lost, re-syncing InterfaceDb";
+      fb303::fbData->addStatValue(
+          "link_monitor.netlink_events_lost_resync", 1, fb303::SUM);
+    }
+
     auto success = syncInterfaces();
     if (success) {
       VLOG(2) << "InterfaceDb Sync is successful";
+      // Events lost during sync are caught by the next check
+      interfaceDbSynced_ = true;
+      netlinkEventsLostCount_ = eventsLostCount;
       expBackoff_.reportSuccess();
-      interfaceDbSyncTimer_->scheduleTimeout(Constants::kPlatformSyncInterval);
+      interfaceDbSyncTimer_->scheduleTimeout(
+          eventDrivenInterfaceSync_ ? Constants::kNetlinkEventsLostCheckInterval
+                                    : Constants::kPlatformSyncInterval);
     } else {
       fb303::fbData->addStatValue(
           "link_monitor.thrift.failure.getAllLinks", 1, fb303::SUM);
@@ -351,12 +438,13 @@ LinkMonitor::neighborUpEvent(const thrift::SparkNeighborEvent& event) {
   const auto adjId = std::make_pair(remoteNodeName, localIfName);
   adjacencies_[adjId] =
       AdjacencyValue(area, peerSpec, std::move(newAdj), false);
+  markAdjacencyChanged(adjId);
 
   // Advertise KvStore peers immediately
   advertiseKvStorePeers(area, {{remoteNodeName, peerSpec}});
 
   // Advertise new adjancies in a throttled fashion
-  advertiseAdjacenciesThrottled_->operator()();
+  advertiseAdjacenciesThrottled(area);
 }
 
 void
@@ -372,13 +460,25 @@ LinkMonitor::neighborDownEvent(const thrift::SparkNeighborEvent& event) {
 
   const auto adjId = std::make_pair(remoteNodeName, localIfName);
   auto adjValueIt = adjacencies_.find(adjId);
-  if (adjValueIt != adjacencies_.end()) {
+  // Areas are processed independently. Adjacency may have come up in another
+  // area already, e.g. upon change of area of interface
+  if (adjValueIt != adjacencies_.end() and adjValueIt->second.area == area) {
     // remove such adjacencies
     adjacencies_.erase(adjValueIt);
+    markAdjacencyChanged(adjId);
   }
-  // advertise both peers and adjacencies
+  // advertise both peers and adjacencies. Adjacencies are advertised right
+  // away unless an advertisement of the area is pending already or interface
+  // is flapping, in which case down event is coalesced with the others
   advertiseKvStorePeers(area);
-  advertiseAdjacencies(area);
+  auto throttleIt = advertiseAdjacenciesThrottled_.find(area);
+  if ((throttleIt != advertiseAdjacenciesThrottled_.end() and
+       throttleIt->second->isActive()) or
+      isInterfaceFlapping(localIfName)) {
+    advertiseAdjacenciesThrottled(area);
+  } else {
+    advertiseAdjacencies(area);
+  }
 }
 
 void
@@ -396,7 +496,7 @@ LinkMonitor::neighborRestartingEvent(const thrift::SparkNeighborEvent& event) {
   // update adjacencies_ restarting-bit and advertise peers
   const auto adjId = std::make_pair(remoteNodeName, localIfName);
   auto adjValueIt = adjacencies_.find(adjId);
-  if (adjValueIt != adjacencies_.end()) {
+  if (adjValueIt != adjacencies_.end() and adjValueIt->second.area == area) {
     adjValueIt->second.isRestarting = true;
   }
   advertiseKvStorePeers(area);
@@ -418,7 +518,8 @@ LinkMonitor::neighborRttChangeEvent(const thrift::SparkNeighborEvent& event) {
     auto& adj = it->second.adjacency;
     adj.metric_ref() = newRttMetric;
     adj.rtt_ref() = rttUs;
-    advertiseAdjacenciesThrottled_->operator()();
+    markAdjacencyChanged(it->first);
+    advertiseAdjacenciesThrottled(it->second.area);
   }
 }
 
@@ -552,20 +653,27 @@ LinkMonitor::advertiseAdjacencies(const std::string& area) {
     return;
   }
 
-  // Cancel throttle timeout if scheduled
-  if (advertiseAdjacenciesThrottled_->isActive()) {
-    advertiseAdjacenciesThrottled_->cancel();
+  // Cancel throttle timeout of area if scheduled
+  auto throttleIt = advertiseAdjacenciesThrottled_.find(area);
+  if (throttleIt != advertiseAdjacenciesThrottled_.end() and
+      throttleIt->second->isActive()) {
+    throttleIt->second->cancel();
   }
 
-  // Extract information from `adjacencies_`
-  auto adjDb = buildAdjacencyDatabase(area);
+  // Extract information from `adjacencies_`. Serialized database is reused
+  // unless adjacencies of the area changed. It is rebuilt every time with
+  // perf measurement, as it carries timestamp of the update
+  updateAdjacencyCache();
+  auto& adjDbStr = adjDbStrs_[area];
+  if (adjDbStr.empty() or enablePerfMeasurement_) {
+    adjDbStr = writeThriftObjStr(buildAdjacencyDatabase(area), serializer_);
+  }
 
   LOG(INFO) << "Updating adjacency database in KvStore with "
-            << adjDb.adjacencies_ref()->size() << " entries in area: " << area;
+            << areaAdjacencies_[area].size() << " entries in area: " << area;
 
   // Persist `adj:node_Id` key into KvStore via KvStoreClientInternal
   const auto keyName = Constants::kAdjDbMarker.toString() + nodeId_;
-  std::string adjDbStr = writeThriftObjStr(adjDb, serializer_);
   kvStoreClient_->persistKey(AreaId{area}, keyName, adjDbStr, ttlKeyInKvStore_);
 
   // Config is most likely to have changed. Update it in `ConfigStore`
@@ -591,6 +699,39 @@ LinkMonitor::advertiseAdjacencies() {
   }
 }
 
+void
+LinkMonitor::advertiseAdjacenciesThrottled(const std::string& area) {
+  fb303::fbData->addStatValue(
+      "link_monitor.advertise_adjacencies.requested", 1, fb303::SUM);
+
+  auto it = advertiseAdjacenciesThrottled_.find(area);
+  if (it == advertiseAdjacenciesThrottled_.end()) {
+    LOG(ERROR) << "Skip advertising adjacencies to unknown area: " << area;
+    return;
+  }
+  // Hold timer advertises all of them at once on expiry, as does pending
+  // throttle of the area
+  if (adjHoldTimer_->isScheduled() or it->second->isActive()) {
+    fb303::fbData->addStatValue(
+        "link_monitor.advertise_adjacencies.coalesced", 1, fb303::SUM);
+  }
+  it->second->operator()();
+}
+
+void
+LinkMonitor::advertiseAdjacenciesThrottled() {
+  for (const auto& [areaId, _] : areas_) {
+    advertiseAdjacenciesThrottled(areaId);
+  }
+}
+
+bool
+LinkMonitor::isInterfaceFlapping(const std::string& ifName) const {
+  auto it = interfaces_.find(ifName);
+  return it != interfaces_.end() and
+      it->second.getBackoffDuration() > linkflapInitBackoff_;
+}
+
 void
 LinkMonitor::advertiseIfaceAddr() {
   auto retryTime = getRetryTimeOnUnstableInterfaces();
@@ -635,12 +776,11 @@ LinkMonitor::advertiseInterfaces() {
 }
 
 void
-LinkMonitor::advertiseRedistAddrs() {
+LinkMonitor::advertiseRedistAddrs(bool fullSync) {
   if (adjHoldTimer_->isScheduled()) {
     return;
   }
-  std::unordered_map<std::string, std::vector<thrift::PrefixEntry>>
-      areaPrefixes;
+  std::unordered_map<thrift::IpPrefix, RedistAddr> redistAddrs;
 
   // Add redistribute addresses
   for (auto& [_, interface] : interfaces_) {
@@ -649,6 +789,16 @@ LinkMonitor::advertiseRedistAddrs() {
       continue;
     }
 
+    std::set<std::string> areas;
+    for (auto const& [areaId, areaConf] : areas_) {
+      if (areaConf.shouldRedistributeIface(interface.getIfName())) {
+        areas.emplace(areaId);
+      }
+    }
+    if (areas.empty()) {
+      continue;
+    }
+
     std::vector<thrift::PrefixEntry> ifacePrefixes;
     // Add all prefixes of this interface
     for (auto& prefix : interface.getGlobalUnicastNetworks(enableV4_)) {
@@ -669,31 +819,91 @@ LinkMonitor::advertiseRedistAddrs() {
       ifacePrefixes.emplace_back(std::move(prefix));
     }
 
-    for (auto const& [areaId, areaConf] : areas_) {
-      if (areaConf.shouldRedistributeIface(interface.getIfName())) {
-        auto& prefixList = areaPrefixes[areaId];
-        prefixList.insert(
-            prefixList.end(), ifacePrefixes.begin(), ifacePrefixes.end());
-      }
+    for (auto& prefix : ifacePrefixes) {
+      auto& redistAddr = redistAddrs[*prefix.prefix_ref()];
+      redistAddr.areas.insert(areas.begin(), areas.end());
+      redistAddr.entry = std::move(prefix);
     }
   }
 
-  for (auto const& [areaId, _] : areas_) {
-    LOG_IF(INFO, !areaPrefixes.count(areaId) || areaPrefixes.at(areaId).empty())
-        << "Advertising empty LOOPBACK addresses for area: " << areaId;
+  // Prefixes to advertise grouped by their areas, as areas are per request
+  std::map<std::set<std::string>, std::vector<thrift::PrefixEntry>>
+      areasToPrefixes;
+  std::vector<thrift::PrefixEntry> prefixesToWithdraw;
+  for (const auto& [prefix, redistAddr] : redistAddrs) {
+    auto it = advertisedRedistAddrs_.find(prefix);
+    if (fullSync or it == advertisedRedistAddrs_.end() or
+        not(it->second == redistAddr)) {
+      areasToPrefixes[redistAddr.areas].emplace_back(redistAddr.entry);
+    }
+  }
+  if (not fullSync) {
+    for (const auto& [prefix, redistAddr] : advertisedRedistAddrs_) {
+      if (not redistAddrs.count(prefix)) {
+        prefixesToWithdraw.emplace_back(redistAddr.entry);
+      }
+    }
   }
+  advertisedRedistAddrs_ = std::move(redistAddrs);
 
-  for (auto& [areaId, _] : areas_) {
-    // Advertise via prefix manager client
+  const auto makeRequest = [](thrift::PrefixUpdateCommand cmd,
+                              const std::set<std::string>& areas,
+                              std::vector<thrift::PrefixEntry>&& prefixes) {
     thrift::PrefixUpdateRequest request;
-    request.set_cmd(thrift::PrefixUpdateCommand::SYNC_PREFIXES_BY_TYPE);
+    request.set_cmd(cmd);
     request.set_type(openr::thrift::PrefixType::LOOPBACK);
-    // default construct syncing empty set if we found nothing
-    request.set_prefixes(std::move(areaPrefixes[areaId]));
-    request.set_dstAreas({areaId});
-    // publish prefixes to prefix manager
-    prefixUpdatesQueue_.push(std::move(request));
+    request.set_prefixes(std::move(prefixes));
+    request.dstAreas_ref() =
+        std::unordered_set<std::string>(areas.begin(), areas.end());
+    return request;
+  };
+
+  if (fullSync) {
+    // Sync prefixes of first group of areas, which withdraws all others, and
+    // add the rest in the same bulk load so that KvStore only sees the result
+    LOG(INFO) << "Syncing " << advertisedRedistAddrs_.size()
+              << " LOOPBACK addresses";
+    std::vector<thrift::PrefixUpdateRequest> requests;
+    if (areasToPrefixes.empty()) {
+      // sync empty set if we found nothing
+      requests.emplace_back(makeRequest(
+          thrift::PrefixUpdateCommand::SYNC_PREFIXES_BY_TYPE, {}, {}));
+    }
+    for (auto& [areas, prefixes] : areasToPrefixes) {
+      requests.emplace_back(makeRequest(
+          requests.empty() ? thrift::PrefixUpdateCommand::SYNC_PREFIXES_BY_TYPE
+                           : thrift::PrefixUpdateCommand::ADD_PREFIXES,
+          areas,
+          std::move(prefixes)));
+    }
+    for (size_t i = 0; i < requests.size(); ++i) {
+      requests.at(i).set_batchInProgress(i + 1 < requests.size());
+      prefixUpdatesQueue_.push(std::move(requests.at(i)));
+    }
+    fb303::fbData->addStatValue(
+        "link_monitor.redist_addrs_full_sync", 1, fb303::COUNT);
+    return;
+  }
+
+  size_t numAdvertised{0};
+  for (auto& [areas, prefixes] : areasToPrefixes) {
+    numAdvertised += prefixes.size();
+    prefixUpdatesQueue_.push(makeRequest(
+        thrift::PrefixUpdateCommand::ADD_PREFIXES, areas, std::move(prefixes)));
+  }
+  const auto numWithdrawn = prefixesToWithdraw.size();
+  if (numWithdrawn) {
+    prefixUpdatesQueue_.push(makeRequest(
+        thrift::PrefixUpdateCommand::WITHDRAW_PREFIXES,
+        {},
+        std::move(prefixesToWithdraw)));
   }
+  VLOG(1) << "Advertised " << numAdvertised << " and withdrew " << numWithdrawn
+          << " LOOPBACK addresses";
+  fb303::fbData->addStatValue(
+      "link_monitor.redist_addrs_advertised", numAdvertised, fb303::SUM);
+  fb303::fbData->addStatValue(
+      "link_monitor.redist_addrs_withdrawn", numWithdrawn, fb303::SUM);
 }
 
 std::chrono::milliseconds
@@ -725,32 +935,13 @@ LinkMonitor::buildAdjacencyDatabase(const std::string& area) {
   adjDb.nodeLabel_ref() = enableSegmentRouting_ ? *state_.nodeLabel_ref() : 0;
   *adjDb.area_ref() = area;
 
-  for (const auto& [_, adjValue] : adjacencies_) {
-    // ignore unrelated area
-    if (adjValue.area != area) {
-      continue;
+  updateAdjacencyCache();
+  auto it = areaAdjacencies_.find(area);
+  if (it != areaAdjacencies_.end()) {
+    adjDb.adjacencies_ref()->reserve(it->second.size());
+    for (const auto& [_, adj] : it->second) {
+      adjDb.adjacencies_ref()->emplace_back(adj);
     }
-    // NOTE: copy on purpose
-    auto adj = folly::copy(adjValue.adjacency);
-
-    // Set link overload bit
-    adj.isOverloaded_ref() =
-        state_.overloadedLinks_ref()->count(*adj.ifName_ref()) > 0;
-
-    // Override metric with link metric if it exists
-    adj.metric_ref() = folly::get_default(
-        *state_.linkMetricOverrides_ref(),
-        *adj.ifName_ref(),
-        *adj.metric_ref());
-
-    // Override metric with adj metric if it exists
-    thrift::AdjKey adjKey;
-    *adjKey.nodeName_ref() = *adj.otherNodeName_ref();
-    *adjKey.ifName_ref() = *adj.ifName_ref();
-    adj.metric_ref() = folly::get_default(
-        *state_.adjMetricOverrides_ref(), adjKey, *adj.metric_ref());
-
-    adjDb.adjacencies_ref()->emplace_back(std::move(adj));
   }
 
   // Add perf information if enabled
@@ -765,6 +956,68 @@ LinkMonitor::buildAdjacencyDatabase(const std::string& area) {
   return adjDb;
 }
 
+thrift::Adjacency
+LinkMonitor::buildAdjacency(const thrift::Adjacency& adjacency) const {
+  // NOTE: copy on purpose
+  auto adj = folly::copy(adjacency);
+
+  // Set link overload bit
+  adj.isOverloaded_ref() =
+      state_.overloadedLinks_ref()->count(*adj.ifName_ref()) > 0;
+
+  // Override metric with link metric if it exists
+  adj.metric_ref() = folly::get_default(
+      *state_.linkMetricOverrides_ref(), *adj.ifName_ref(), *adj.metric_ref());
+
+  // Override metric with adj metric if it exists
+  thrift::AdjKey adjKey;
+  *adjKey.nodeName_ref() = *adj.otherNodeName_ref();
+  *adjKey.ifName_ref() = *adj.ifName_ref();
+  adj.metric_ref() = folly::get_default(
+      *state_.adjMetricOverrides_ref(), adjKey, *adj.metric_ref());
+
+  return adj;
+}
+
+void
+LinkMonitor::markAdjacencyChanged(const AdjacencyKey& adjKey) {
+  changedAdjacencies_.emplace(adjKey);
+}
+
+void
+LinkMonitor::markInterfaceAdjacenciesChanged(const std::string& ifName) {
+  for (const auto& [adjKey, _] : adjacencies_) {
+    if (adjKey.second == ifName) {
+      changedAdjacencies_.emplace(adjKey);
+    }
+  }
+}
+
+void
+LinkMonitor::updateAdjacencyCache() {
+  for (const auto& adjKey : changedAdjacencies_) {
+    // Adjacency may have moved across areas, remove it from all of them
+    for (auto& [area, adjs] : areaAdjacencies_) {
+      if (adjs.erase(adjKey)) {
+        adjDbStrs_.erase(area);
+      }
+    }
+    auto it = adjacencies_.find(adjKey);
+    if (it == adjacencies_.end()) {
+      continue;
+    }
+    const auto& area = it->second.area;
+    areaAdjacencies_[area][adjKey] = buildAdjacency(it->second.adjacency);
+    adjDbStrs_.erase(area);
+  }
+  changedAdjacencies_.clear();
+}
+
+void
+LinkMonitor::invalidateAdjacencyDbCache() {
+  adjDbStrs_.clear();
+}
+
 InterfaceEntry* FOLLY_NULLABLE
 LinkMonitor::getOrCreateInterfaceEntry(const std::string& ifName) {
   // Return null if ifName doesn't quality regex match criteria
@@ -852,6 +1105,14 @@ LinkMonitor::syncInterfaces() {
   return true;
 }
 
+void
+LinkMonitor::processNetlinkEvents(fbnl::NetlinkEvents&& events) {
+  VLOG(3) << "Received batch of " << events.size() << " netlink events";
+  for (auto& event : events) {
+    processNetlinkEvent(std::move(event));
+  }
+}
+
 void
 LinkMonitor::processNetlinkEvent(fbnl::NetlinkEvent&& event) {
   if (auto* link = std::get_if<fbnl::Link>(&event)) {
@@ -961,6 +1222,7 @@ LinkMonitor::setNodeOverload(bool isOverloaded) {
       state_.isOverloaded_ref() = isOverloaded;
       SYSLOG(INFO) << (isOverloaded ? "Setting" : "Unsetting")
                    << " overload bit for node";
+      invalidateAdjacencyDbCache();
       advertiseAdjacencies();
     }
     p.setValue();
@@ -1007,7 +1269,8 @@ LinkMonitor::setInterfaceOverload(
       state_.overloadedLinks_ref()->erase(interfaceName);
       SYSLOG(INFO) << "Unsetting overload bit for interface " << interfaceName;
     }
-    advertiseAdjacenciesThrottled_->operator()();
+    markInterfaceAdjacenciesChanged(interfaceName);
+    advertiseAdjacenciesThrottled();
     p.setValue();
   });
   return sf;
@@ -1059,7 +1322,8 @@ LinkMonitor::setLinkMetric(
           SYSLOG(INFO) << "Removing metric override for interface "
                        << interfaceName;
         }
-        advertiseAdjacenciesThrottled_->operator()();
+        markInterfaceAdjacenciesChanged(interfaceName);
+        advertiseAdjacenciesThrottled();
         p.setValue();
       });
   return sf;
@@ -1119,7 +1383,9 @@ LinkMonitor::setAdjacencyMetric(
       SYSLOG(INFO) << "Removing metric override for adjacency: [" << adjNodeName
                    << ":" << interfaceName << "]";
     }
-    advertiseAdjacenciesThrottled_->operator()();
+    markAdjacencyChanged(std::make_pair(adjNodeName, interfaceName));
+    advertiseAdjacenciesThrottled(
+        adjacencies_.at(std::make_pair(adjNodeName, interfaceName)).area);
     p.setValue();
   });
   return sf;
@@ -1248,7 +1514,9 @@ LinkMonitor::logNeighborEvent(thrift::SparkNeighborEvent const& event) {
   sample.addString("area", *(event.info_ref()->area_ref()));
   sample.addInt("rtt_us", *(event.info_ref()->rttUs_ref()));
 
-  logSampleQueue_.push(std::move(sample));
+  if (logSampleLimiter_.admit(sample)) {
+    logSampleQueue_.push(std::move(sample));
+  }
 }
 
 void
@@ -1269,7 +1537,9 @@ LinkMonitor::logLinkEvent(
   sample.addString("interface", iface);
   sample.addInt("backoff_ms", backoffTime.count());
 
-  logSampleQueue_.push(sample);
+  if (logSampleLimiter_.admit(sample)) {
+    logSampleQueue_.push(std::move(sample));
+  }
 
   SYSLOG(INFO) << "Interface " << iface << " is " << event
                << " and has backoff of " << backoffTime.count() << "ms";
@@ -1287,7 +1557,27 @@ LinkMonitor::logPeerEvent(
   sample.addString("peer_name", peerName);
   sample.addString("cmd_url", *peerSpec.cmdUrl_ref());
 
-  logSampleQueue_.push(sample);
+  if (logSampleLimiter_.admit(sample)) {
+    logSampleQueue_.push(std::move(sample));
+  }
+}
+
+void
+LinkMonitor::processConfigUpdate(Config const& config) {
+  const auto& areas = config.getAreas();
+  CHECK_EQ(areas_.size(), areas.size()) << "Areas can't change on reload";
+  // NOTE: AreaConfiguration isn't assignable
+  areas_.clear();
+  for (const auto& [areaId, areaConf] : areas) {
+    areas_.emplace(areaId, areaConf);
+  }
+  LOG(INFO) << "Reloaded interface regexes of areas";
+
+  // Force full re-sync to pick up interfaces matching new regexes, interfaces
+  // and addresses are re-advertised with the ones no longer matching left out
+  interfaceDbSynced_ = false;
+  interfaceDbSyncTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+  advertiseIfaceAddrThrottled_->operator()();
 }
 
 bool
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <map>
+#include <set>
+#include <unordered_set>
+
 #include <folly/CppAttributes.h>
 #include <folly/IPAddress.h>
 #include <folly/Optional.h>
@@ -32,6 +36,7 @@
 #include <openr/kvstore/KvStoreClientInternal.h>
 #include <openr/link-monitor/InterfaceEntry.h>
 #include <openr/messaging/ReplicateQueue.h>
+#include <openr/monitor/LogSampleLimiter.h>
 #include <openr/nl/NetlinkProtocolSocket.h>
 #include <openr/spark/Spark.h>
 
@@ -94,7 +99,7 @@ class LinkMonitor final : public OpenrEventBase {
       messaging::ReplicateQueue<LogSample>& logSampleQueue,
       // consumer queue
       messaging::RQueue<thrift::SparkNeighborEvent> neighborUpdatesQueue,
-      messaging::RQueue<fbnl::NetlinkEvent> netlinkEventsQueue,
+      messaging::RQueue<fbnl::NetlinkEvents> netlinkEventsQueue,
       // if set, we will assume drained if no drain state is found in the
       // persitentStore
       bool assumeDrained,
@@ -102,7 +107,10 @@ class LinkMonitor final : public OpenrEventBase {
       // assumeDrained value
       bool overrideDrainState,
       // how long to wait before initial adjacency advertisement
-      std::chrono::seconds adjHoldTime);
+      std::chrono::seconds adjHoldTime,
+      // consumer queue of reloaded config
+      std::optional<messaging::RQueue<ConfigPtr>> configUpdatesQueue =
+          std::nullopt);
 
   ~LinkMonitor() override = default;
 
@@ -173,6 +181,9 @@ class LinkMonitor final : public OpenrEventBase {
    * [Netlink Platform] related functions
    */
 
+  // process batch of LINK/ADDR event updates from platform
+  void processNetlinkEvents(fbnl::NetlinkEvents&& events);
+
   // process LINK/ADDR event updates from platform
   void processNetlinkEvent(fbnl::NetlinkEvent&& event);
 
@@ -224,6 +235,15 @@ class LinkMonitor final : public OpenrEventBase {
   void advertiseAdjacencies(const std::string& area);
   void advertiseAdjacencies(); // Advertise my adjacencies_ in to all areas
 
+  // Throttled versions of above. Calls within throttle interval of an area are
+  // coalesced into one advertisement of the area
+  void advertiseAdjacenciesThrottled(const std::string& area);
+  void advertiseAdjacenciesThrottled();
+
+  // Interface is flapping, i.e. it went down again while in backoff and its
+  // backoff grew beyond the initial one
+  bool isInterfaceFlapping(const std::string& ifName) const;
+
   /*
    * [Spark/Fib] Advertise interfaces_ over interfaceUpdatesQueue_ to Spark/Fib
    *
@@ -236,11 +256,16 @@ class LinkMonitor final : public OpenrEventBase {
    * prefix manager "redistribute prefixes" includes addresses of interfaces
    * that match redistribute_interface_regexes
    *
+   * Only changes since the previous call are advertised or withdrawn, unless
+   * fullSync is set. Then all redistribute prefixes get synced, which
+   * withdraws any other LOOPBACK prefixes
+   *
    * Called in
-   * - adjHoldTimer_ during initial start
+   * - adjHoldTimer_ during initial start and redistAddrsFullSyncTimer_ with
+   *   fullSync
    * - and advertiseIfaceAddr() upon interface changes
    */
-  void advertiseRedistAddrs();
+  void advertiseRedistAddrs(bool fullSync = false);
 
   /*
    * [Util function] general function used for util purpose
@@ -254,6 +279,23 @@ class LinkMonitor final : public OpenrEventBase {
   // build AdjacencyDatabase
   thrift::AdjacencyDatabase buildAdjacencyDatabase(const std::string& area);
 
+  // Adjacency as advertised, i.e. with overload bit and metric overrides
+  // applied
+  thrift::Adjacency buildAdjacency(const thrift::Adjacency& adjacency) const;
+
+  // Mark an adjacency, or all adjacencies over an interface, for rebuild in
+  // areaAdjacencies_ on next updateAdjacencyCache()
+  void markAdjacencyChanged(const AdjacencyKey& adjKey);
+  void markInterfaceAdjacenciesChanged(const std::string& ifName);
+
+  // Rebuild changed adjacencies in areaAdjacencies_ and invalidate serialized
+  // adjacency database of affected areas
+  void updateAdjacencyCache();
+
+  // Invalidate serialized adjacency database of all areas, e.g. on change of
+  // node overload bit or node label
+  void invalidateAdjacencyDbCache();
+
   // submit events to monitor
   void logNeighborEvent(thrift::SparkNeighborEvent const& event);
 
@@ -270,6 +312,10 @@ class LinkMonitor final : public OpenrEventBase {
       const std::string& peerName,
       const thrift::PeerSpec& peerSpec);
 
+  // apply reloadable LinkMonitor fields of config, i.e. interface regexes of
+  // areas, and re-discover interfaces matching them
+  void processConfigUpdate(Config const& config);
+
   // returns any(a.shouldDiscoverOnIface(iface) for a in areas_)
   bool anyAreaShouldDiscoverOnIface(std::string const& iface) const;
 
@@ -293,13 +339,17 @@ class LinkMonitor final : public OpenrEventBase {
   thrift::PrefixForwardingAlgorithm prefixForwardingAlgorithm_;
   // Use spark measured RTT to neighbor as link metric
   bool useRttMetric_{false};
+  // Re-sync InterfaceDb only when netlink events got lost
+  const bool eventDrivenInterfaceSync_{false};
   // link flap back offs
   std::chrono::milliseconds linkflapInitBackoff_;
   std::chrono::milliseconds linkflapMaxBackoff_;
   // TTL for a key in the key value store
   std::chrono::milliseconds ttlKeyInKvStore_;
 
-  std::unordered_map<std::string, AreaConfiguration> const areas_;
+  // NOTE: Area ids are immutable, their interface regexes change on config
+  // reload
+  std::unordered_map<std::string, AreaConfiguration> areas_;
 
   //
   // Mutable state
@@ -324,6 +374,9 @@ class LinkMonitor final : public OpenrEventBase {
   // Queue to publish the event log
   messaging::ReplicateQueue<LogSample>& logSampleQueue_;
 
+  // Sampling and rate limiting of neighbor, link and peer events
+  LogSampleLimiter logSampleLimiter_;
+
   // ser/deser binary data for transmission
   apache::thrift::CompactSerializer serializer_;
 
@@ -333,12 +386,30 @@ class LinkMonitor final : public OpenrEventBase {
   // (we use the "min" interface) for tcp connection
   std::unordered_map<AdjacencyKey, AdjacencyValue> adjacencies_;
 
+  // adjacencies_ as advertised per area, ordered for a stable adjacency
+  // database. Only adjacencies in changedAdjacencies_ get rebuilt
+  std::unordered_map<
+      std::string /* area */,
+      std::map<AdjacencyKey, thrift::Adjacency>>
+      areaAdjacencies_;
+  std::unordered_set<AdjacencyKey> changedAdjacencies_;
+
+  // Serialized adjacency database per area, last persisted in KvStore. Entry
+  // is erased when areaAdjacencies_ of the area or node attributes change
+  std::unordered_map<std::string /* area */, std::string> adjDbStrs_;
+
   // Previously announced KvStore peers
   std::unordered_map<
       std::string /* area */,
       std::unordered_map<std::string /* node name */, KvStorePeerValue>>
       peers_;
 
+  // Neighbor events queued per area for processing by fiber of the area
+  std::unordered_map<
+      std::string /* area */,
+      std::shared_ptr<messaging::RWQueue<thrift::SparkNeighborEvent>>>
+      areaNeighborUpdatesQueues_;
+
   // all interfaces states, including DOWN one
   // Keyed by interface Name
   std::unordered_map<std::string, InterfaceEntry> interfaces_;
@@ -348,8 +419,10 @@ class LinkMonitor final : public OpenrEventBase {
   std::unordered_map<int64_t, std::string> ifIndexToName_;
 
   // Throttled versions of "advertise<>" functions. It batches
-  // up multiple calls and send them in one go!
-  std::unique_ptr<AsyncThrottle> advertiseAdjacenciesThrottled_;
+  // up multiple calls and send them in one go! Adjacencies are throttled per
+  // area
+  std::unordered_map<std::string /* area */, std::unique_ptr<AsyncThrottle>>
+      advertiseAdjacenciesThrottled_;
   std::unique_ptr<AsyncThrottle> advertiseIfaceAddrThrottled_;
 
   // Timer for processing interfaces which are in backoff states
@@ -357,8 +430,29 @@ class LinkMonitor final : public OpenrEventBase {
 
   // Timer for resyncing InterfaceDb from netlink
   std::unique_ptr<folly::AsyncTimeout> interfaceDbSyncTimer_;
+
+  // Redistribute prefix and areas it got advertised to
+  struct RedistAddr {
+    thrift::PrefixEntry entry;
+    std::set<std::string> areas;
+
+    bool
+    operator==(const RedistAddr& other) const {
+      return entry == other.entry and areas == other.areas;
+    }
+  };
+  // Redistribute prefixes advertised to PrefixManager
+  std::unordered_map<thrift::IpPrefix, RedistAddr> advertisedRedistAddrs_;
+
+  // Timer for periodic full sync of redistribute prefixes
+  std::unique_ptr<folly::AsyncTimeout> redistAddrsFullSyncTimer_;
   ExponentialBackoff<std::chrono::milliseconds> expBackoff_;
 
+  // Whether InterfaceDb got synced successfully at least once, and number of
+  // lost netlink events as of last successful sync
+  bool interfaceDbSynced_{false};
+  uint64_t netlinkEventsLostCount_{0};
+
   // client to interact with KvStore
   std::unique_ptr<KvStoreClientInternal> kvStoreClient_;
 
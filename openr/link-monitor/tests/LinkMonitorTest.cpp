@@ -322,7 +322,7 @@ class LinkMonitorTestFixture : public ::testing::Test {
         peerUpdatesQueue,
         logSampleQueue,
         neighborUpdatesQueue.getReader(),
-        nlSock->getReader(),
+        nlSock->getBatchReader(),
         assumeDrained,
         overrideDrainState,
         std::chrono::seconds(1) /* adjHoldTime */
@@ -541,7 +541,7 @@ class LinkMonitorTestFixture : public ::testing::Test {
   messaging::ReplicateQueue<thrift::SparkNeighborEvent> neighborUpdatesQueue;
   messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRouteUpdatesQueue;
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
   messaging::RQueue<thrift::InterfaceDatabase> interfaceUpdatesReader{
       interfaceUpdatesQueue.getReader()};
   messaging::ReplicateQueue<openr::LogSample> logSampleQueue;
@@ -1027,8 +1027,8 @@ TEST_F(LinkMonitorTestFixture, ParallelAdj) {
     // still use iface_2_1 because it's the "min" and will not call addPeers
 
     {
-      // note: adj_2_2 is hashed ahead of adj_2_1
-      auto adjDb = createAdjDatabase("node-1", {adj_2_2, adj_2_1}, kNodeLabel);
+      // note: adjacencies are ordered by <node name, interface name>
+      auto adjDb = createAdjDatabase("node-1", {adj_2_1, adj_2_2}, kNodeLabel);
       expectedAdjDbs.push(std::move(adjDb));
     }
 
@@ -1675,7 +1675,7 @@ TEST_F(LinkMonitorTestFixture, NodeLabelAlloc) {
         peerUpdatesQueue,
         logSampleQueue,
         neighborUpdatesQueue.getReader(),
-        nlSock->getReader(),
+        nlSock->getBatchReader(),
         false, /* assumeDrained */
         false, /* overrideDrainState */
         std::chrono::seconds(1));
@@ -1843,6 +1843,62 @@ TEST_F(LinkMonitorTestFixture, LoopbackPrefixAdvertisement) {
   LOG(INFO) << "All prefixes get withdrawn.";
 }
 
+// Address changes advertise and withdraw only the changed prefixes
+TEST_F(LinkMonitorTestFixture, RedistAddrDeltas) {
+  SetUp({});
+
+  const std::string nodeName = "node-1";
+  const std::string loopbackAddr1 = "2803:cafe:babe::1/128";
+  const std::string loopbackAddr2 = "2803:cafe:babe::2/128";
+
+  nlEventsInjector->sendLinkEvent("loopback", 101, true);
+  nlEventsInjector->sendAddrEvent("loopback", loopbackAddr1, true);
+  recvAndReplyIfUpdate();
+
+  // Wait for initial full sync, which advertises the first address
+  auto prefixes = getNextPrefixDb(nodeName);
+  while (prefixes.size() != 1) {
+    prefixes = getNextPrefixDb(nodeName);
+  }
+
+  auto prefixUpdatesReader = prefixUpdatesQueue.getReader();
+
+  // Adding an address advertises just the new prefix
+  nlEventsInjector->sendAddrEvent("loopback", loopbackAddr2, true);
+  recvAndReplyIfUpdate();
+  {
+    auto request = prefixUpdatesReader.get();
+    ASSERT_TRUE(request.hasValue());
+    EXPECT_EQ(thrift::PrefixUpdateCommand::ADD_PREFIXES, *request->cmd_ref());
+    ASSERT_EQ(1, request->prefixes_ref()->size());
+    EXPECT_EQ(
+        toIpPrefix(loopbackAddr2),
+        *request->prefixes_ref()->at(0).prefix_ref());
+    EXPECT_EQ(
+        std::unordered_set<std::string>({kTestingAreaName}),
+        *request->dstAreas_ref());
+  }
+
+  // Removing an address withdraws just its prefix
+  nlEventsInjector->sendAddrEvent("loopback", loopbackAddr1, false);
+  recvAndReplyIfUpdate();
+  {
+    auto request = prefixUpdatesReader.get();
+    ASSERT_TRUE(request.hasValue());
+    EXPECT_EQ(
+        thrift::PrefixUpdateCommand::WITHDRAW_PREFIXES, *request->cmd_ref());
+    ASSERT_EQ(1, request->prefixes_ref()->size());
+    EXPECT_EQ(
+        toIpPrefix(loopbackAddr1),
+        *request->prefixes_ref()->at(0).prefix_ref());
+  }
+
+  while (prefixes.size() != 1 or
+         not prefixes.count(toIpPrefix(loopbackAddr2))) {
+    prefixes = getNextPrefixDb(nodeName);
+  }
+}
+
 TEST_F(LinkMonitorTestFixture, GetAllLinks) {
   SetUp({});
 
@@ -22,6 +22,12 @@ RQueue<ValueType>::get() {
   return queue_->get();
 }
 
+template <typename ValueType>
+folly::Expected<std::vector<ValueType>, QueueError>
+RQueue<ValueType>::getBatch(size_t maxItems) {
+  return queue_->getBatch(maxItems);
+}
+
 #if FOLLY_HAS_COROUTINES
 template <typename ValueType>
 folly::coro::Task<folly::Expected<ValueType, QueueError>>
@@ -29,6 +35,13 @@ RQueue<ValueType>::getCoro() {
   auto val = co_await queue_->getCoro();
   co_return val;
 }
+
+template <typename ValueType>
+folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+RQueue<ValueType>::getBatchCoro(size_t maxItems) {
+  auto batch = co_await queue_->getBatchCoro(maxItems);
+  co_return batch;
+}
 #endif
 
 template <typename ValueType>
@@ -38,7 +51,35 @@ RQueue<ValueType>::size() {
 }
 
 template <typename ValueType>
-RWQueue<ValueType>::RWQueue() {}
+RWQueue<ValueType>::RWQueue() : RWQueue(QueueOptions<ValueType>{}) {}
+
+template <typename ValueType>
+RWQueue<ValueType>::RWQueue(QueueMode mode)
+    : RWQueue(QueueOptions<ValueType>{mode}) {}
+
+template <typename ValueType>
+RWQueue<ValueType>::RWQueue(
+    QueueOptions<ValueType> options, std::shared_ptr<QueueCounters> counters)
+    : options_(std::move(options)),
+      mode_(options_.mode),
+      counters_(std::move(counters)) {
+  CHECK(mode_ == QueueMode::LOCKED or options_.capacity == 0)
+      << "Bounded queue must be in LOCKED mode";
+  CHECK(
+      options_.overflowPolicy != OverflowPolicy::COALESCE_BY_KEY or
+      options_.getKey)
+      << "Coalescing queue requires getKey";
+  if (not counters_ and not options_.name.empty()) {
+    counters_ = std::make_shared<QueueCounters>(
+        options_.name, options_.measureDwellTime);
+    ownsCounters_ = true;
+  }
+  measureDwellTime_ = counters_ and options_.measureDwellTime;
+  if (mode_ == QueueMode::SINGLE_READER) {
+    lockFreeQueue_ =
+        std::make_unique<folly::UMPSCQueue<Entry, false /* MayBlock */>>();
+  }
+}
 
 template <typename ValueType>
 RWQueue<ValueType>::~RWQueue() {
@@ -49,7 +90,37 @@ template <typename ValueType>
 template <typename ValueTypeT>
 bool
 RWQueue<ValueType>::push(ValueTypeT&& val) {
-  std::lock_guard<std::mutex> l(lock_);
+  if (mode_ == QueueMode::SINGLE_READER) {
+    if (closed_.load()) {
+      return false;
+    }
+    lockFreeQueue_->enqueue(
+        Entry{std::forward<ValueTypeT>(val), getEnqueueTime()});
+    // Pairs with fence of reader between setting `waiting_` and re-checking
+    // queue. Either reader sees the data or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.exchange(false)) {
+      baton_.post();
+    }
+    return true;
+  }
+
+  std::unique_lock<std::mutex> l(lock_);
+
+  // Wait for room in full queue. Readers unblock one write per read
+  bool blocked{false};
+  while (not closed_ and pendingReads_.empty() and isFull() and
+         options_.overflowPolicy == OverflowPolicy::BLOCK) {
+    if (counters_ and not blocked) {
+      counters_->addBlocked();
+    }
+    blocked = true;
+    folly::fibers::Baton baton;
+    pendingWrites_.emplace_back(baton);
+    l.unlock();
+    baton.wait();
+    l.lock();
+  }
 
   // If queue is closed, don't enqueue
   if (closed_) {
@@ -60,19 +131,119 @@ RWQueue<ValueType>::push(ValueTypeT&& val) {
     // Unblock a pending read
     auto& pendingRead = pendingReads_.front().get();
     pendingRead.data = std::forward<ValueTypeT>(val);
+    pendingRead.enqueueTime = getEnqueueTime();
     pendingRead.baton.post();
     pendingReads_.pop_front();
-  } else {
-    // Add data into the queue
-    queue_.emplace_back(std::forward<ValueTypeT>(val));
+    return true;
   }
 
+  // NOTE: val is consumed by makeRoom only if it returns true
+  if (isFull() and makeRoom(std::forward<ValueTypeT>(val))) {
+    return true;
+  }
+
+  // Add data into the queue
+  queue_.emplace_back(std::forward<ValueTypeT>(val));
+  if (measureDwellTime_) {
+    enqueueTimes_.emplace_back(Clock::now());
+  }
+  if (counters_) {
+    if (ownsCounters_) {
+      counters_->setDepth(queue_.size());
+    }
+    counters_->updateHighWatermark(queue_.size());
+  }
   return true;
 }
 
+template <typename ValueType>
+template <typename ValueTypeT>
+bool
+RWQueue<ValueType>::makeRoom(ValueTypeT&& val) {
+  DCHECK(options_.overflowPolicy != OverflowPolicy::BLOCK);
+  if (counters_) {
+    counters_->addDropped(1);
+  }
+
+  // Replace latest pending value of same key, which keeps its position and
+  // enqueue timestamp
+  if (options_.overflowPolicy == OverflowPolicy::COALESCE_BY_KEY) {
+    const auto key = options_.getKey(val);
+    for (auto it = queue_.rbegin(); it != queue_.rend(); ++it) {
+      if (options_.getKey(*it) == key) {
+        *it = std::forward<ValueTypeT>(val);
+        return true;
+      }
+    }
+  }
+
+  queue_.pop_front();
+  if (measureDwellTime_) {
+    enqueueTimes_.pop_front();
+  }
+  return false;
+}
+
+template <typename ValueType>
+void
+RWQueue<ValueType>::drainImpl(std::vector<ValueType>& batch, size_t maxItems) {
+  if (mode_ == QueueMode::SINGLE_READER) {
+    while (batch.size() < maxItems and not closed_.load()) {
+      auto maybeEntry = lockFreeQueue_->try_dequeue();
+      if (not maybeEntry) {
+        break;
+      }
+      recordDwellTime(maybeEntry->enqueueTime);
+      batch.emplace_back(std::move(maybeEntry->value));
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> l(lock_);
+  if (closed_) {
+    return;
+  }
+  while (batch.size() < maxItems and queue_.size()) {
+    batch.emplace_back(std::move(queue_.front()));
+    queue_.pop_front();
+    if (measureDwellTime_) {
+      recordDwellTime(enqueueTimes_.front());
+      enqueueTimes_.pop_front();
+    }
+    unblockPendingWrite();
+  }
+}
+
+template <typename ValueType>
+void
+RWQueue<ValueType>::unblockPendingWrite() {
+  if (pendingWrites_.size()) {
+    pendingWrites_.front().get().post();
+    pendingWrites_.pop_front();
+  }
+}
+
 template <typename ValueType>
 folly::Expected<ValueType, QueueError>
 RWQueue<ValueType>::get() {
+  if (mode_ == QueueMode::SINGLE_READER) {
+    std::optional<ValueType> data;
+    Clock::time_point enqueueTime;
+    while (true) {
+      auto maybeRead = getSingleReaderImpl(data, enqueueTime);
+      if (maybeRead.hasError()) {
+        return folly::makeUnexpected(maybeRead.error());
+      }
+      if (not maybeRead.value()) {
+        baton_.wait();
+      }
+      if (data) {
+        recordDwellTime(enqueueTime);
+        return std::move(data).value();
+      }
+    }
+  }
+
   PendingRead pendingRead;
 
   // Queue is closed
@@ -92,15 +263,53 @@ RWQueue<ValueType>::get() {
   // Wait for baton and read the data
   pendingRead.baton.wait();
   if (pendingRead.data) {
+    recordDwellTime(pendingRead.enqueueTime);
     return std::move(pendingRead.data).value();
   }
   return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
 }
 
+template <typename ValueType>
+folly::Expected<std::vector<ValueType>, QueueError>
+RWQueue<ValueType>::getBatch(size_t maxItems) {
+  CHECK_GT(maxItems, 0);
+  std::vector<ValueType> batch;
+  drainImpl(batch, maxItems);
+  if (batch.empty()) {
+    // Wait for data like a single read
+    auto maybeValue = get();
+    if (maybeValue.hasError()) {
+      return folly::makeUnexpected(maybeValue.error());
+    }
+    batch.emplace_back(std::move(maybeValue).value());
+    // Pick up data pushed along
+    drainImpl(batch, maxItems);
+  }
+  return batch;
+}
+
 #if FOLLY_HAS_COROUTINES
 template <typename ValueType>
 folly::coro::Task<folly::Expected<ValueType, QueueError>>
 RWQueue<ValueType>::getCoro() {
+  if (mode_ == QueueMode::SINGLE_READER) {
+    std::optional<ValueType> data;
+    Clock::time_point enqueueTime;
+    while (true) {
+      auto maybeRead = getSingleReaderImpl(data, enqueueTime);
+      if (maybeRead.hasError()) {
+        co_return folly::makeUnexpected(maybeRead.error());
+      }
+      if (not maybeRead.value()) {
+        co_await baton_;
+      }
+      if (data) {
+        recordDwellTime(enqueueTime);
+        co_return std::move(data).value();
+      }
+    }
+  }
+
   PendingRead pendingRead;
 
   // Queue is closed
@@ -118,10 +327,30 @@ RWQueue<ValueType>::getCoro() {
   // Wait for baton and read the data
   co_await pendingRead.baton;
   if (pendingRead.data) {
+    recordDwellTime(pendingRead.enqueueTime);
     co_return std::move(pendingRead.data).value();
   }
   co_return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
 }
+
+template <typename ValueType>
+folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+RWQueue<ValueType>::getBatchCoro(size_t maxItems) {
+  CHECK_GT(maxItems, 0);
+  std::vector<ValueType> batch;
+  drainImpl(batch, maxItems);
+  if (batch.empty()) {
+    // Wait for data like a single read
+    auto maybeValue = co_await getCoro();
+    if (maybeValue.hasError()) {
+      co_return folly::makeUnexpected(maybeValue.error());
+    }
+    batch.emplace_back(std::move(maybeValue).value());
+    // Pick up data pushed along
+    drainImpl(batch, maxItems);
+  }
+  co_return batch;
+}
 #endif
 
 template <typename ValueType>
@@ -138,6 +367,11 @@ RWQueue<ValueType>::getAnyImpl(PendingRead& pendingRead) {
   if (queue_.size()) {
     pendingRead.data = std::move(queue_.front());
     queue_.pop_front();
+    if (measureDwellTime_) {
+      pendingRead.enqueueTime = enqueueTimes_.front();
+      enqueueTimes_.pop_front();
+    }
+    unblockPendingWrite();
     return true;
   }
 
@@ -146,9 +380,56 @@ RWQueue<ValueType>::getAnyImpl(PendingRead& pendingRead) {
   return false;
 }
 
+template <typename ValueType>
+folly::Expected<bool, QueueError>
+RWQueue<ValueType>::getSingleReaderImpl(
+    std::optional<ValueType>& data, Clock::time_point& enqueueTime) {
+  if (closed_.load()) {
+    return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
+  }
+
+  // Perform immediate read if data is available
+  if (auto maybeEntry = lockFreeQueue_->try_dequeue()) {
+    data = std::move(maybeEntry->value);
+    enqueueTime = maybeEntry->enqueueTime;
+    return true;
+  }
+
+  // Announce wait and re-check queue, data may have been pushed meanwhile.
+  // NOTE: baton_ is not posted here, writer posts only after clearing
+  // `waiting_` set below
+  CHECK(not waiting_.load()) << "Concurrent reads of single reader queue";
+  baton_.reset();
+  waiting_.store(true);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  auto maybeEntry = lockFreeQueue_->try_dequeue();
+  if (maybeEntry) {
+    data = std::move(maybeEntry->value);
+    enqueueTime = maybeEntry->enqueueTime;
+  }
+  if (maybeEntry or closed_.load()) {
+    // Withdraw wait. If a writer (or close) withdrew it already, baton_ is
+    // about to get posted and must be waited on before it can be reset
+    return waiting_.exchange(false);
+  }
+  return false;
+}
+
 template <typename ValueType>
 void
 RWQueue<ValueType>::close() {
+  if (mode_ == QueueMode::SINGLE_READER) {
+    // NOTE: pending data is released along with the queue, it can't be
+    // dequeued concurrently with the reader
+    closed_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.exchange(false)) {
+      baton_.post();
+    }
+    return;
+  }
+
   std::lock_guard<std::mutex> l(lock_);
 
   if (not closed_) {
@@ -161,13 +442,21 @@ RWQueue<ValueType>::close() {
       pendingRead.baton.post();
       pendingReads_.pop_front();
     }
+    // Unblock all pending writes, they fail on closed queue
+    while (pendingWrites_.size()) {
+      unblockPendingWrite();
+    }
     queue_.clear();
+    enqueueTimes_.clear();
   }
 }
 
 template <typename ValueType>
 bool
 RWQueue<ValueType>::isClosed() {
+  if (mode_ == QueueMode::SINGLE_READER) {
+    return closed_.load();
+  }
   std::lock_guard<std::mutex> l(lock_);
   return closed_;
 }
@@ -175,6 +464,9 @@ RWQueue<ValueType>::isClosed() {
 template <typename ValueType>
 size_t
 RWQueue<ValueType>::size() {
+  if (mode_ == QueueMode::SINGLE_READER) {
+    return lockFreeQueue_->size();
+  }
   std::lock_guard<std::mutex> l(lock_);
   return queue_.size();
 }
@@ -182,6 +474,9 @@ RWQueue<ValueType>::size() {
 template <typename ValueType>
 size_t
 RWQueue<ValueType>::numPendingReads() {
+  if (mode_ == QueueMode::SINGLE_READER) {
+    return waiting_.load() ? 1 : 0;
+  }
   std::lock_guard<std::mutex> l(lock_);
   return pendingReads_.size();
 }
@@ -8,12 +8,20 @@
 #pragma once
 
 #include <any>
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include <fb303/ServiceData.h>
 #include <folly/Expected.h>
+#include <folly/concurrency/UnboundedQueue.h>
 #include <folly/fibers/Baton.h>
 #if FOLLY_HAS_COROUTINES
 #include <folly/experimental/coro/Task.h>
@@ -26,6 +34,120 @@ enum class QueueError {
   QUEUE_CLOSED,
 };
 
+enum class QueueMode {
+  // Multiple writers and readers, protected by lock
+  LOCKED,
+  // Multiple writers and at most one reader at a time, lock-free. Suits
+  // high rate queues drained by a single fiber/thread
+  SINGLE_READER,
+};
+
+// Behavior of push into a full bounded queue
+enum class OverflowPolicy {
+  // Writer waits until reader makes room
+  BLOCK,
+  // Oldest pending value is dropped
+  DROP_OLDEST,
+  // Pending value with same key is replaced in place, oldest pending value is
+  // dropped if there is none
+  COALESCE_BY_KEY,
+};
+
+/**
+ * Counters of a queue exported through fb303 as `messaging.<name>.<counter>`
+ * - depth: number of pending values as of last push, of deepest reader for
+ *   ReplicateQueue
+ * - high_watermark: max number of pending values ever
+ * - dropped: values dropped or coalesced on overflow
+ * - blocked: writes blocked on overflow
+ * - dwell_time_us: histogram of time values spent in queue until read, if
+ *   enabled with QueueOptions::measureDwellTime
+ */
+class QueueCounters {
+ public:
+  // Buckets of dwell time histogram
+  static constexpr int64_t kDwellTimeHistogramBucketUs{1000};
+  static constexpr int64_t kDwellTimeHistogramMaxUs{1000000};
+
+  QueueCounters(const std::string& name, bool measureDwellTime)
+      : depthKey_("messaging." + name + ".depth"),
+        highWatermarkKey_("messaging." + name + ".high_watermark"),
+        droppedKey_("messaging." + name + ".dropped"),
+        blockedKey_("messaging." + name + ".blocked"),
+        dwellTimeKey_("messaging." + name + ".dwell_time_us") {
+    if (measureDwellTime) {
+      facebook::fb303::fbData->addHistogram(
+          dwellTimeKey_,
+          kDwellTimeHistogramBucketUs,
+          0,
+          kDwellTimeHistogramMaxUs);
+      facebook::fb303::fbData->exportHistogramPercentile(
+          dwellTimeKey_, 50, 99);
+    }
+  }
+
+  void
+  setDepth(size_t depth) {
+    facebook::fb303::fbData->setCounter(depthKey_, depth);
+  }
+
+  void
+  updateHighWatermark(size_t depth) {
+    auto highWatermark = highWatermark_.load();
+    while (depth > highWatermark) {
+      if (highWatermark_.compare_exchange_weak(highWatermark, depth)) {
+        facebook::fb303::fbData->setCounter(highWatermarkKey_, depth);
+        break;
+      }
+    }
+  }
+
+  void
+  addDropped(size_t count) {
+    facebook::fb303::fbData->addStatValue(
+        droppedKey_, count, facebook::fb303::SUM);
+  }
+
+  void
+  addBlocked() {
+    facebook::fb303::fbData->addStatValue(
+        blockedKey_, 1, facebook::fb303::SUM);
+  }
+
+  void
+  addDwellTime(std::chrono::microseconds dwellTime) {
+    facebook::fb303::fbData->addHistogramValue(
+        dwellTimeKey_, dwellTime.count());
+  }
+
+ private:
+  const std::string depthKey_;
+  const std::string highWatermarkKey_;
+  const std::string droppedKey_;
+  const std::string blockedKey_;
+  const std::string dwellTimeKey_;
+  std::atomic<size_t> highWatermark_{0};
+};
+
+template <typename ValueType>
+struct QueueOptions {
+  QueueMode mode{QueueMode::LOCKED};
+
+  // Max number of pending values, 0 for unbounded. QueueMode::LOCKED only
+  size_t capacity{0};
+  OverflowPolicy overflowPolicy{OverflowPolicy::BLOCK};
+
+  // Key of value, required by OverflowPolicy::COALESCE_BY_KEY
+  std::function<std::string(const ValueType&)> getKey{nullptr};
+
+  // Name of queue counters, counters are not exported if empty
+  std::string name;
+
+  // Timestamp values on push and report time spent in queue on read. Named
+  // queues only
+  bool measureDwellTime{false};
+};
+
 template <typename ValueType>
 class RWQueue;
 
@@ -44,11 +166,20 @@ class RQueue {
    */
   folly::Expected<ValueType, QueueError> get();
 
+  /**
+   * Blocking read of all pending data, up to maxItems, in order. Waits if
+   * there is none like get().
+   */
+  folly::Expected<std::vector<ValueType>, QueueError> getBatch(
+      size_t maxItems = std::numeric_limits<size_t>::max());
+
 #if FOLLY_HAS_COROUTINES
   /**
    * Read methods for co-routines
    */
   folly::coro::Task<folly::Expected<ValueType, QueueError>> getCoro();
+  folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+  getBatchCoro(size_t maxItems = std::numeric_limits<size_t>::max());
 #endif
 
   // Utility function to retrieve size of pending data in underlying queue
@@ -69,15 +200,30 @@ class RQueue {
  *
  * After closing queue, all subsequent push are ignored and return false. All
  * subsequent reads return QUEUE_CLOSED error
+ *
+ * With QueueMode::SINGLE_READER data goes through a lock-free unbounded queue
+ * instead, and the reader parks on a baton only when it finds queue empty.
+ * Concurrent reads are not allowed in this mode.
+ *
+ * Queue can be bounded with QueueOptions::capacity, see OverflowPolicy for
+ * behavior of push into full queue.
  */
 template <typename ValueType>
 class RWQueue {
  public:
   RWQueue();
+  explicit RWQueue(QueueMode mode);
+
+  // Counters are shared by queues of all readers of ReplicateQueue, created
+  // from QueueOptions::name otherwise
+  explicit RWQueue(
+      QueueOptions<ValueType> options,
+      std::shared_ptr<QueueCounters> counters = nullptr);
   ~RWQueue();
 
   /**
-   * Non blocking push. Any typed value can be pushed!
+   * Push. Any typed value can be pushed! Non blocking unless queue is full
+   * and its overflow policy is OverflowPolicy::BLOCK.
    * Return true/false!!
    */
   template <typename ValueTypeT>
@@ -89,11 +235,21 @@ class RWQueue {
    */
   folly::Expected<ValueType, QueueError> get();
 
+  /**
+   * Blocking read of all pending data, up to maxItems, in order. Pending data
+   * is drained at once, under single lock acquisition in LOCKED mode. Waits
+   * for data like get() if there is none.
+   */
+  folly::Expected<std::vector<ValueType>, QueueError> getBatch(
+      size_t maxItems = std::numeric_limits<size_t>::max());
+
 #if FOLLY_HAS_COROUTINES
   /**
    * Read methods for co-routines
    */
   folly::coro::Task<folly::Expected<ValueType, QueueError>> getCoro();
+  folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+  getBatchCoro(size_t maxItems = std::numeric_limits<size_t>::max());
 #endif
 
   /**
@@ -113,11 +269,52 @@ class RWQueue {
   size_t numPendingReads();
 
  private:
+  using Clock = std::chrono::steady_clock;
+
   struct PendingRead {
     folly::fibers::Baton baton;
     std::optional<ValueType> data;
+    // Set along with data, if dwell time is measured
+    Clock::time_point enqueueTime;
+  };
+
+  // Value of lock-free queue along with its enqueue timestamp
+  struct Entry {
+    ValueType value;
+    Clock::time_point enqueueTime;
   };
 
+  Clock::time_point
+  getEnqueueTime() const {
+    return measureDwellTime_ ? Clock::now() : Clock::time_point();
+  }
+
+  void
+  recordDwellTime(Clock::time_point enqueueTime) {
+    if (measureDwellTime_) {
+      counters_->addDwellTime(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              Clock::now() - enqueueTime));
+    }
+  }
+
+  bool
+  isFull() const {
+    return options_.capacity and queue_.size() >= options_.capacity;
+  }
+
+  // Make room in full queue for the value according to overflow policy.
+  // @returns true if value is coalesced into a pending one, i.e. consumed
+  template <typename ValueTypeT>
+  bool makeRoom(ValueTypeT&& val);
+
+  // Unblock a writer waiting for room, after a value got read
+  void unblockPendingWrite();
+
+  // Move pending data into batch without waiting, until it holds maxItems.
+  // Nothing is moved from closed queue
+  void drainImpl(std::vector<ValueType>& batch, size_t maxItems);
+
   /**
    * Implementation for reading a pending or future data element.
    *
@@ -126,17 +323,47 @@ class RWQueue {
    */
   folly::Expected<bool, QueueError> getAnyImpl(PendingRead& pendingRead);
 
+  /**
+   * Implementation of read in SINGLE_READER mode.
+   *
+   * @returns true if data is read. false if reader must wait on baton_, data
+   *          may be read already but a writer is about to post baton_
+   * @returns QUEUE_CLOSED error if queue is closed.
+   */
+  folly::Expected<bool, QueueError> getSingleReaderImpl(
+      std::optional<ValueType>& data, Clock::time_point& enqueueTime);
+
+  const QueueOptions<ValueType> options_;
+  const QueueMode mode_{QueueMode::LOCKED};
+
+  // Counters, if queue is named. Depth is exported by owner of counters
+  std::shared_ptr<QueueCounters> counters_{nullptr};
+  bool ownsCounters_{false};
+  bool measureDwellTime_{false};
+
   // Lock to protect below private variables
   std::mutex lock_;
 
-  // State of queue
-  bool closed_{false};
+  // State of queue. Written under lock, but read without it in SINGLE_READER
+  // mode
+  std::atomic<bool> closed_{false};
 
   // Pending reads - readers are actively waiting for data
   std::deque<std::reference_wrapper<PendingRead>> pendingReads_;
 
-  // Pending data
+  // Pending data, and its enqueue timestamps if dwell time is measured
   std::deque<ValueType> queue_;
+  std::deque<Clock::time_point> enqueueTimes_;
+
+  // Pending writes - writers waiting for room in full queue
+  std::deque<std::reference_wrapper<folly::fibers::Baton>> pendingWrites_;
+
+  // SINGLE_READER mode only. Pending data, and baton of reader waiting for
+  // data. Writer that observes `waiting_` set clears it and posts baton
+  std::unique_ptr<folly::UMPSCQueue<Entry, false /* MayBlock */>>
+      lockFreeQueue_;
+  std::atomic<bool> waiting_{false};
+  folly::fibers::Baton baton_;
 };
 
 } // namespace messaging
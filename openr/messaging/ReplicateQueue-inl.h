@@ -13,6 +13,19 @@ namespace messaging {
 template <typename ValueType>
 ReplicateQueue<ValueType>::ReplicateQueue() {}
 
+template <typename ValueType>
+ReplicateQueue<ValueType>::ReplicateQueue(QueueMode mode)
+    : ReplicateQueue(QueueOptions<ValueType>{mode}) {}
+
+template <typename ValueType>
+ReplicateQueue<ValueType>::ReplicateQueue(QueueOptions<ValueType> options)
+    : options_(std::move(options)) {
+  if (not options_.name.empty()) {
+    counters_ = std::make_shared<QueueCounters>(
+        options_.name, options_.measureDwellTime);
+  }
+}
+
 template <typename ValueType>
 ReplicateQueue<ValueType>::~ReplicateQueue() {
   close();
@@ -50,9 +63,28 @@ ReplicateQueue<ValueType>::push(ValueTypeT&& value) {
     readers.back()->push(std::forward<ValueTypeT>(value));
   }
 
+  if (counters_) {
+    size_t depth{0};
+    for (auto& reader : readers) {
+      depth = std::max(depth, reader->size());
+    }
+    counters_->setDepth(depth);
+  }
+
   return true;
 }
 
+template <typename ValueType>
+template <typename T>
+bool
+ReplicateQueue<ValueType>::pushShared(T&& value) {
+  using SharedType = std::shared_ptr<const std::decay_t<T>>;
+  static_assert(
+      std::is_same_v<ValueType, SharedType>,
+      "pushShared requires queue of std::shared_ptr<const T>");
+  return push(std::make_shared<const std::decay_t<T>>(std::forward<T>(value)));
+}
+
 /**
  * Get new reader stream of this queue. Stream will get closed automatically
  * when reader is destructed.
@@ -64,7 +96,8 @@ ReplicateQueue<ValueType>::getReader() {
   if (closed_) {
     throw std::runtime_error("queue is closed");
   }
-  lockedReaders->emplace_back(std::make_shared<RWQueue<ValueType>>());
+  lockedReaders->emplace_back(
+      std::make_shared<RWQueue<ValueType>>(options_, counters_));
   return RQueue<ValueType>(lockedReaders->back());
 }
 
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include <openr/messaging/Queue.h>
 
 namespace openr {
@@ -17,13 +19,26 @@ namespace messaging {
  * every writer. Writer pays the cost of replicating data to all readers. If no
  * reader exists then all the messages are silently dropped.
  *
- * Pushed object must be copy constructible.
+ * Pushed object must be copy constructible. For large objects consider using
+ * `std::shared_ptr<const T>` as ValueType so that all readers share a single
+ * immutable instance instead of a deep copy each.
+ *
+ * With bounded reader queues a slow reader applies its overflow policy on its
+ * own queue, e.g. blocks writer with OverflowPolicy::BLOCK, without affecting
+ * what other readers get.
  */
 template <typename ValueType>
 class ReplicateQueue {
  public:
   ReplicateQueue();
 
+  // Mode of the queue of every reader, see QueueMode
+  explicit ReplicateQueue(QueueMode mode);
+
+  // Options of the queue of every reader, see QueueOptions. Counters are
+  // shared by all of them, depth being the one of the deepest queue
+  explicit ReplicateQueue(QueueOptions<ValueType> options);
+
   ~ReplicateQueue();
 
   /**
@@ -45,6 +60,14 @@ class ReplicateQueue {
   template <typename ValueTypeT>
   bool push(ValueTypeT&& value);
 
+  /**
+   * Push value shared by all readers into queue of immutable values, i.e. with
+   * ValueType `std::shared_ptr<const T>`. Value is moved into a single
+   * reference counted instance instead of being copied for every reader.
+   */
+  template <typename T>
+  bool pushShared(T&& value);
+
   /**
    * Get new reader stream of this queue. Stream will get closed automatically
    * when reader is destructed.
@@ -70,6 +93,8 @@ class ReplicateQueue {
   void close();
 
  private:
+  QueueOptions<ValueType> options_;
+  std::shared_ptr<QueueCounters> counters_{nullptr};
   folly::Synchronized<std::list<std::shared_ptr<RWQueue<ValueType>>>> readers_;
   bool closed_{false}; // Protected by above Synchronized lock
 };
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <openr/messaging/Queue.h>
+
+namespace openr {
+
+namespace {
+
+// Number of messages pushed per benchmark iteration
+const size_t kNumMessages{100000};
+
+} // namespace
+
+/**
+ * Benchmark for throughput of RWQueue:
+ * 1. Start numWriters threads, each pushing its share of kNumMessages
+ * 2. Read all of them from a single reader thread, as modules do
+ */
+static void
+BM_RWQueue(uint32_t iters, messaging::QueueMode mode, size_t numWriters) {
+  auto suspender = folly::BenchmarkSuspender();
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    messaging::RWQueue<size_t> q(mode);
+
+    suspender.dismiss(); // Start measuring benchmark time
+    std::vector<std::thread> writers;
+    for (size_t w = 0; w < numWriters; ++w) {
+      writers.emplace_back([&q, numWriters]() {
+        for (size_t n = 0; n < kNumMessages / numWriters; ++n) {
+          q.push(n);
+        }
+      });
+    }
+    for (size_t n = 0; n < kNumMessages / numWriters * numWriters; ++n) {
+      folly::doNotOptimizeAway(q.get());
+    }
+    suspender.rehire();
+
+    for (auto& writer : writers) {
+      writer.join();
+    }
+  }
+}
+
+static void
+BM_RWQueueLocked(uint32_t iters, size_t numWriters) {
+  BM_RWQueue(iters, messaging::QueueMode::LOCKED, numWriters);
+}
+
+static void
+BM_RWQueueSingleReader(uint32_t iters, size_t numWriters) {
+  BM_RWQueue(iters, messaging::QueueMode::SINGLE_READER, numWriters);
+}
+
+// The parameter is number of writer threads
+BENCHMARK_PARAM(BM_RWQueueLocked, 1);
+BENCHMARK_RELATIVE_PARAM(BM_RWQueueSingleReader, 1);
+BENCHMARK_PARAM(BM_RWQueueLocked, 4);
+BENCHMARK_RELATIVE_PARAM(BM_RWQueueSingleReader, 4);
+BENCHMARK_PARAM(BM_RWQueueLocked, 16);
+BENCHMARK_RELATIVE_PARAM(BM_RWQueueSingleReader, 16);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
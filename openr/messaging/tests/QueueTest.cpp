@@ -7,6 +7,7 @@
 
 #include <gtest/gtest.h>
 
+#include <fb303/ServiceData.h>
 #include <folly/executors/ManualExecutor.h>
 #include <folly/fibers/EventBaseLoopController.h>
 #include <folly/fibers/FiberManager.h>
@@ -227,6 +228,200 @@ TEST(RWQueueTest, MultiThreadTest) {
   EXPECT_EQ(kNumWriters * kCountPerWriter, totalReads);
 }
 
+TEST(RWQueueTest, SingleReader) {
+  RWQueue<std::string> q(QueueMode::SINGLE_READER);
+
+  q.push(std::string("one"));
+  q.push(std::string("two"));
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ("one", q.get().value());
+  EXPECT_EQ("two", q.get().value());
+  EXPECT_EQ(0, q.size());
+  EXPECT_EQ(0, q.numPendingReads());
+
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q]() mutable {
+    EXPECT_EQ("three", q.get().value());
+    auto x = q.get(); // Perform read
+    EXPECT_TRUE(x.hasError());
+    EXPECT_EQ(x.error(), QueueError::QUEUE_CLOSED);
+  });
+
+  evb.loopOnce(); // Fiber should get stuck at the read
+  EXPECT_EQ(1, q.numPendingReads());
+
+  q.push(std::string("three"));
+  evb.loopOnce(); // Fiber should get stuck at the next read
+  EXPECT_EQ(0, q.size());
+  EXPECT_EQ(1, q.numPendingReads());
+
+  q.close();
+  evb.loopOnce();
+  EXPECT_TRUE(q.isClosed());
+  EXPECT_EQ(0, q.numPendingReads());
+  EXPECT_FALSE(q.push(std::string("four")));
+  EXPECT_EQ(q.get().error(), QueueError::QUEUE_CLOSED);
+}
+
+TEST(RWQueueTest, BoundedDropOldest) {
+  QueueOptions<int> options;
+  options.capacity = 2;
+  options.overflowPolicy = OverflowPolicy::DROP_OLDEST;
+  options.name = "test_drop_oldest";
+  RWQueue<int> q(options);
+
+  EXPECT_TRUE(q.push(1));
+  EXPECT_TRUE(q.push(2));
+  EXPECT_TRUE(q.push(3)); // 1 is dropped
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ(2, q.get().value());
+  EXPECT_EQ(3, q.get().value());
+  EXPECT_EQ(
+      2,
+      facebook::fb303::fbData->getCounter(
+          "messaging.test_drop_oldest.high_watermark"));
+}
+
+TEST(RWQueueTest, BoundedCoalesceByKey) {
+  QueueOptions<std::pair<std::string, int>> options;
+  options.capacity = 2;
+  options.overflowPolicy = OverflowPolicy::COALESCE_BY_KEY;
+  options.getKey = [](const std::pair<std::string, int>& val) {
+    return val.first;
+  };
+  RWQueue<std::pair<std::string, int>> q(options);
+
+  q.push(std::make_pair("a", 1));
+  q.push(std::make_pair("b", 1));
+  q.push(std::make_pair("a", 2)); // replaces ("a", 1) in place
+  q.push(std::make_pair("c", 1)); // no pending "c", ("a", 2) is dropped
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ(std::make_pair(std::string("b"), 1), q.get().value());
+  EXPECT_EQ(std::make_pair(std::string("c"), 1), q.get().value());
+
+  // Values are not coalesced unless queue is full
+  q.push(std::make_pair("a", 1));
+  q.push(std::make_pair("a", 2));
+  EXPECT_EQ(2, q.size());
+}
+
+TEST(RWQueueTest, BoundedBlock) {
+  QueueOptions<int> options;
+  options.capacity = 1;
+  RWQueue<int> q(options);
+
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q]() mutable {
+    EXPECT_TRUE(q.push(1));
+    EXPECT_TRUE(q.push(2)); // Blocks until 1 is read
+    EXPECT_FALSE(q.push(3)); // Blocks until queue is closed
+  });
+
+  evb.loopOnce(); // Fiber should get stuck at the second push
+  EXPECT_EQ(1, q.size());
+
+  EXPECT_EQ(1, q.get().value());
+  evb.loopOnce(); // Fiber should get stuck at the third push
+  EXPECT_EQ(1, q.size());
+
+  q.close();
+  evb.loop();
+  EXPECT_EQ(0, manager.numActiveTasks());
+}
+
+TEST(RWQueueTest, DwellTime) {
+  for (auto mode : {QueueMode::LOCKED, QueueMode::SINGLE_READER}) {
+    QueueOptions<int> options;
+    options.mode = mode;
+    options.name = "test_dwell_time";
+    options.measureDwellTime = true;
+    RWQueue<int> q(options);
+
+    // Values are timestamped without affecting what readers get
+    q.push(1);
+    q.push(2);
+    EXPECT_EQ(1, q.get().value());
+    EXPECT_EQ(2, q.get().value());
+
+    std::thread reader([&q]() { EXPECT_EQ(3, q.get().value()); });
+    q.push(3);
+    reader.join();
+    EXPECT_EQ(0, q.size());
+  }
+}
+
+TEST(RWQueueTest, GetBatch) {
+  for (auto mode : {QueueMode::LOCKED, QueueMode::SINGLE_READER}) {
+    RWQueue<int> q(mode);
+    for (int i = 1; i <= 5; ++i) {
+      q.push(i);
+    }
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), q.getBatch(3).value());
+    EXPECT_EQ(std::vector<int>({4, 5}), q.getBatch().value());
+    EXPECT_EQ(0, q.size());
+
+    folly::EventBase evb;
+    auto& manager = folly::fibers::getFiberManager(evb);
+    manager.addTask([&q]() mutable {
+      EXPECT_EQ(std::vector<int>({6}), q.getBatch().value());
+      auto x = q.getBatch(); // Perform read
+      EXPECT_TRUE(x.hasError());
+      EXPECT_EQ(x.error(), QueueError::QUEUE_CLOSED);
+    });
+
+    evb.loopOnce(); // Fiber should get stuck at the read
+    EXPECT_EQ(1, q.numPendingReads());
+
+    q.push(6);
+    evb.loopOnce(); // Fiber should get stuck at the next read
+    EXPECT_EQ(1, q.numPendingReads());
+
+    q.close();
+    evb.loop();
+    EXPECT_EQ(0, manager.numActiveTasks());
+  }
+}
+
+TEST(RWQueueTest, SingleReaderMultiThreadTest) {
+  const size_t kNumWriters{16};
+  const size_t kCountPerWriter{8192};
+  RWQueue<size_t> q(QueueMode::SINGLE_READER);
+
+  // Reader verifies order of every writer
+  std::thread reader([&q]() {
+    std::vector<size_t> nextNums(kNumWriters, 0);
+    for (size_t i = 0; i < kNumWriters * kCountPerWriter; ++i) {
+      auto maybeNum = q.get();
+      ASSERT_TRUE(maybeNum.hasValue());
+      const auto writer = maybeNum.value() / kCountPerWriter;
+      EXPECT_EQ(
+          writer * kCountPerWriter + nextNums[writer]++, maybeNum.value());
+    }
+    EXPECT_EQ(q.get().error(), QueueError::QUEUE_CLOSED);
+  });
+
+  std::vector<std::thread> writers;
+  for (size_t i = 0; i < kNumWriters; ++i) {
+    writers.emplace_back([&q, i]() {
+      for (size_t j = 0; j < kCountPerWriter; ++j) {
+        q.push(i * kCountPerWriter + j);
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  // Wait for reader to drain the queue before closing it
+  while (q.size() or not q.numPendingReads()) {
+    std::this_thread::yield();
+  }
+  q.close();
+  reader.join();
+}
+
 #if FOLLY_HAS_COROUTINES
 TEST(RWQueueTest, CoroTest) {
   const size_t kNumReaders{16};
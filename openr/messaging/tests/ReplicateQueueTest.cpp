@@ -84,3 +84,56 @@ TEST(ReplicateQueueTest, OpenQueueTest) {
 
   q.close();
 }
+
+TEST(ReplicateQueueTest, SharedValueTest) {
+  ReplicateQueue<std::shared_ptr<const std::string>> q;
+  auto r1 = q.getReader();
+  auto r2 = q.getReader();
+
+  // readers must receive the same immutable instance without deep copies
+  auto value = std::make_shared<const std::string>("publication");
+  EXPECT_TRUE(q.push(value));
+  auto v1 = r1.get();
+  auto v2 = r2.get();
+  ASSERT_TRUE(v1.hasValue());
+  ASSERT_TRUE(v2.hasValue());
+  EXPECT_EQ(value.get(), v1.value().get());
+  EXPECT_EQ(value.get(), v2.value().get());
+  EXPECT_EQ(3, value.use_count());
+
+  // value moved into single shared instance
+  std::string str("update");
+  EXPECT_TRUE(q.pushShared(std::move(str)));
+  auto v3 = r1.get();
+  auto v4 = r2.get();
+  ASSERT_TRUE(v3.hasValue());
+  ASSERT_TRUE(v4.hasValue());
+  EXPECT_EQ("update", *v3.value());
+  EXPECT_EQ(v3.value().get(), v4.value().get());
+
+  q.close();
+}
+
+TEST(ReplicateQueueTest, BoundedReadersTest) {
+  QueueOptions<int> options;
+  options.capacity = 2;
+  options.overflowPolicy = OverflowPolicy::DROP_OLDEST;
+  options.name = "test_replicate";
+  ReplicateQueue<int> q(options);
+  auto r1 = q.getReader();
+  auto r2 = q.getReader();
+
+  // slow reader drops from its own queue only
+  EXPECT_TRUE(q.push(1));
+  EXPECT_EQ(1, r1.get().value());
+  EXPECT_TRUE(q.push(2));
+  EXPECT_TRUE(q.push(3));
+  EXPECT_EQ(2, r1.size());
+  EXPECT_EQ(2, r2.size());
+  EXPECT_EQ(2, r1.get().value());
+  EXPECT_EQ(2, r2.get().value());
+  EXPECT_EQ(3, r1.get().value());
+  EXPECT_EQ(3, r2.get().value());
+
+  q.close();
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/monitor/LogSampleLimiter.h>
+
+#include <algorithm>
+
+#include <fb303/ServiceData.h>
+#include <folly/Format.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+LogSampleLimiter::LogSampleLimiter(
+    const std::map<std::string, thrift::EventLogLimit>& limits) {
+  for (const auto& [event, limit] : limits) {
+    auto& state = states_[event];
+    state.sampleRate = std::max(1, *limit.sample_rate_ref());
+    const auto rate = *limit.rate_per_sec_ref();
+    if (rate > 0) {
+      // Burst defaults to one second worth of events
+      const auto burst = *limit.burst_ref() > 0 ? *limit.burst_ref() : rate;
+      state.bucket.emplace(rate, std::max(1.0, burst));
+    }
+  }
+}
+
+bool
+LogSampleLimiter::admit(LogSample& sample) {
+  if (states_.empty() || not sample.isStringSet("event")) {
+    return true;
+  }
+  const auto event = sample.getString("event");
+  auto it = states_.find(event);
+  if (it == states_.end()) {
+    return true;
+  }
+
+  auto& state = it->second;
+  const bool sampled = (state.numSeen++ % state.sampleRate) == 0;
+  if (not sampled or (state.bucket and not state.bucket->consume(1))) {
+    ++state.numPending;
+    ++state.numSuppressed;
+    fb303::fbData->addStatValue(
+        folly::sformat("monitor.log_sample.suppressed.{}", event),
+        1,
+        fb303::COUNT);
+    return false;
+  }
+
+  if (state.numPending) {
+    sample.addInt("num_suppressed", state.numPending);
+    state.numPending = 0;
+  }
+  return true;
+}
+
+std::unordered_map<std::string, int64_t>
+LogSampleLimiter::getSuppressedCounts() const {
+  std::unordered_map<std::string, int64_t> counts;
+  for (const auto& [event, state] : states_) {
+    counts.emplace(event, state.numSuppressed);
+  }
+  return counts;
+}
+
+} // namespace openr
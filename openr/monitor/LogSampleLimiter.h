@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <folly/TokenBucket.h>
+
+#include <openr/if/gen-cpp2/OpenrConfig_types.h>
+#include <openr/monitor/LogSample.h>
+
+namespace openr {
+
+/**
+ * Sampling and rate limiting of LogSample producers per `event` name, as
+ * configured by `monitor_config.event_log_limits`. Events without limits are
+ * always admitted.
+ *
+ * Suppressed events are exported as `monitor.log_sample.suppressed.<event>`
+ * and summarized in the next admitted sample of the same event through int
+ * `num_suppressed`, hence counts of events are not lost in logs.
+ *
+ * NOTE: Not thread safe. Every producer owns an instance and uses it from the
+ * thread it pushes to log sample queue from.
+ */
+class LogSampleLimiter {
+ public:
+  explicit LogSampleLimiter(
+      const std::map<std::string, thrift::EventLogLimit>& limits);
+
+  /**
+   * Returns true if sample is to be pushed to log sample queue, annotating it
+   * with number of events suppressed since the last admitted one.
+   */
+  bool admit(LogSample& sample);
+
+  // Total number of suppressed events by event name
+  std::unordered_map<std::string, int64_t> getSuppressedCounts() const;
+
+ private:
+  struct EventState {
+    // Admit one in sampleRate events. 1 => all
+    int32_t sampleRate{1};
+    uint64_t numSeen{0};
+    // Limit of admitted events. std::nullopt => unlimited
+    std::optional<folly::BasicTokenBucket<>> bucket;
+    // Suppressed since last admitted event, and in total
+    int64_t numPending{0};
+    int64_t numSuppressed{0};
+  };
+
+  std::unordered_map<std::string /* event */, EventState> states_;
+};
+
+} // namespace openr
@@ -6,7 +6,12 @@
  */
 
 #include "openr/monitor/MonitorBase.h"
+
+#include <folly/Format.h>
+#include <folly/ScopeGuard.h>
+
 #include <openr/common/Constants.h>
+#include <openr/common/MemoryAllocator.h>
 
 namespace openr {
 
@@ -18,6 +23,8 @@ MonitorBase::MonitorBase(
       maxLogEvents_{
           folly::to<uint32_t>(*config->getMonitorConfig().max_event_log_ref())},
       startTime_{std::chrono::steady_clock::now()} {
+  recentLogs_.wlock()->logs.reserve(maxLogEvents_);
+
   // Initialize stats counter
   fb303::fbData->addStatExportType("monitor.log.publish.failure", fb303::COUNT);
 
@@ -48,7 +55,7 @@ MonitorBase::MonitorBase(
 
           // validate, process and publish the event logs
           try {
-            auto inputLog = maybeLog.value();
+            auto inputLog = std::move(maybeLog).value();
             // add common attributes
             inputLog.addString("node_name", config->getNodeName());
             inputLog.addString("domain", *config->getConfig().domain_ref());
@@ -56,11 +63,10 @@ MonitorBase::MonitorBase(
             // throws std::invalid_argument if not exist
             inputLog.getString("event");
 
-            // add to recent log list
-            if (recentLog_.size() >= maxLogEvents_) {
-              recentLog_.pop_front();
-            }
-            recentLog_.emplace_back(inputLog.toJson());
+            // add to recent logs, also if publishing fails
+            SCOPE_EXIT {
+              addRecentEventLog(std::move(inputLog));
+            };
 
             // publish the log if enable log submission
             if (config->isLogSubmissionEnabled()) {
@@ -76,9 +82,37 @@ MonitorBase::MonitorBase(
       });
 }
 
+void
+MonitorBase::addRecentEventLog(LogSample&& eventLog) {
+  if (maxLogEvents_ == 0) {
+    return;
+  }
+  auto recentLogs = recentLogs_.wlock();
+  if (recentLogs->logs.size() < maxLogEvents_) {
+    recentLogs->logs.emplace_back(std::move(eventLog));
+    return;
+  }
+  recentLogs->logs[recentLogs->next] = std::move(eventLog);
+  recentLogs->next = (recentLogs->next + 1) % maxLogEvents_;
+}
+
 std::list<std::string>
 MonitorBase::getRecentEventLogs() {
-  return recentLog_;
+  std::list<std::string> eventLogs;
+  auto recentLogs = recentLogs_.rlock();
+  const auto& logs = recentLogs->logs;
+  for (size_t i = 0; i < logs.size(); ++i) {
+    eventLogs.emplace_back(logs[(recentLogs->next + i) % logs.size()].toJson());
+  }
+  return eventLogs;
+}
+
+void
+MonitorBase::clearRecentEventLogs() {
+  auto recentLogs = recentLogs_.wlock();
+  LOG(INFO) << "Dropping " << recentLogs->logs.size() << " recent event logs";
+  recentLogs->logs.clear();
+  recentLogs->next = 0;
 }
 
 void
@@ -101,6 +135,36 @@ MonitorBase::updateProcessCounters() {
   if (cpuPct.has_value()) {
     fb303::fbData->setCounter("process.cpu.pct", cpuPct.value());
   }
+
+  // set process.cpu.pct.<thread> counters of module threads, e.g. KvStore
+  const std::string threadNamePrefix{"openr-"};
+  for (const auto& [name, pct] :
+       systemMetrics_.getThreadCPUpercentage(threadNamePrefix)) {
+    fb303::fbData->setCounter(
+        folly::sformat(
+            "process.cpu.pct.{}", name.substr(threadNamePrefix.size())),
+        pct);
+  }
+
+  // set process.memory.allocator.* counters of jemalloc, if running with it
+  if (const auto stats = getMemoryAllocatorStats()) {
+    fb303::fbData->setCounter(
+        "process.memory.allocator.allocated_bytes", stats->allocated);
+    fb303::fbData->setCounter(
+        "process.memory.allocator.active_bytes", stats->active);
+    fb303::fbData->setCounter(
+        "process.memory.allocator.resident_bytes", stats->resident);
+    fb303::fbData->setCounter(
+        "process.memory.allocator.mapped_bytes", stats->mapped);
+    fb303::fbData->setCounter(
+        "process.memory.allocator.retained_bytes", stats->retained);
+    // share of active pages not allocated by application
+    if (stats->active > 0) {
+      fb303::fbData->setCounter(
+          "process.memory.allocator.fragmentation_pct",
+          (stats->active - stats->allocated) * 100 / stats->active);
+    }
+  }
 }
 
 } // namespace openr
@@ -7,7 +7,10 @@
 
 #pragma once
 
+#include <vector>
+
 #include <folly/Function.h>
+#include <folly/Synchronized.h>
 
 #include <fb303/ServiceData.h>
 #include <openr/common/OpenrEventBase.h>
@@ -27,7 +30,7 @@ namespace openr {
  *    subclass's processEventLog() implementation.
  * 2. Store and return the most recent logs;
  * 3. Export process counters: process.memory.rss, process.uptime,
- *    and process.cpu.pct
+ *    process.cpu.pct and process.memory.allocator.* of jemalloc
  */
 class MonitorBase : public OpenrEventBase {
  public:
@@ -36,9 +39,12 @@ class MonitorBase : public OpenrEventBase {
       const std::string& category,
       messaging::RQueue<LogSample> logSampleQueue);
 
-  // Get recent event logs
+  // Get recent event logs as json, oldest first. Thread safe
   std::list<std::string> getRecentEventLogs();
 
+  // Drop recent event logs, e.g. to release memory. Thread safe
+  void clearRecentEventLogs();
+
   // Destructor
   virtual ~MonitorBase() = default;
 
@@ -53,14 +59,23 @@ class MonitorBase : public OpenrEventBase {
   // Set process counters
   void updateProcessCounters();
 
+  // Keep log among the last maxLogEvents_ ones
+  void addRecentEventLog(LogSample&& eventLog);
+
   // Common information added to each log: "domain", "node-name", etc
   LogSample commonLogToMerge_;
 
   // Number of last log events to queue
   const uint32_t maxLogEvents_{0};
 
-  // List of recent log
-  std::list<std::string> recentLog_{};
+  // Ring buffer of recent logs, preallocated to maxLogEvents_. Logs are kept
+  // as is and converted to json only when read
+  struct RecentLogs {
+    std::vector<LogSample> logs;
+    // position of the oldest log once buffer is full
+    size_t next{0};
+  };
+  folly::Synchronized<RecentLogs> recentLogs_;
 
   // Timer to periodically set process cpu/uptime/memory counter
   std::unique_ptr<folly::AsyncTimeout> setProcessCounterTimer_;
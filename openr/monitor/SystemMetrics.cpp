@@ -7,6 +7,13 @@
 
 #include "openr/monitor/SystemMetrics.h"
 
+#include <unistd.h>
+#include <filesystem>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/String.h>
+
 namespace openr {
 
 /* Return RSS memory the process currently used from /proc/[pid]/status.
@@ -74,6 +81,92 @@ SystemMetrics::getCPUpercentage() {
   return cpuPct;
 }
 
+/* Return CPU% used by threads of the process by thread name
+ / Like getCPUpercentage, it is calculated from the time difference of two
+ / queries, hence threads seen for the first time are skipped.
+*/
+std::unordered_map<std::string, double>
+SystemMetrics::getThreadCPUpercentage(const std::string& namePrefix) {
+  static const double kNanosPerTick = 1.0e9 / sysconf(_SC_CLK_TCK);
+
+  std::unordered_map<std::string, double> cpuPcts;
+  std::unordered_map<std::string, ThreadCpuTime> nowThreadCpuTimes;
+  try {
+    for (const auto& entry :
+         std::filesystem::directory_iterator("/proc/self/task")) {
+      std::ifstream input(entry.path() / "stat");
+      std::string stat;
+      if (not input.is_open() or not std::getline(input, stat)) {
+        // thread exited in the meantime
+        continue;
+      }
+      auto nameAndTicks = parseThreadStat(stat);
+      if (not nameAndTicks.has_value() or
+          nameAndTicks->first.compare(0, namePrefix.size(), namePrefix)) {
+        continue;
+      }
+
+      const auto tid = entry.path().filename().string();
+      ThreadCpuTime nowCpuTime{
+          std::move(nameAndTicks->first),
+          static_cast<uint64_t>(nameAndTicks->second * kNanosPerTick),
+          getCurrentNanoTime()};
+
+      // calculate the CPU% = (thread time diff) / (time elapsed) * 100
+      auto prevIt = prevThreadCpuTimes_.find(tid);
+      if (prevIt != prevThreadCpuTimes_.end() &&
+          prevIt->second.name == nowCpuTime.name &&
+          nowCpuTime.timestamp > prevIt->second.timestamp &&
+          nowCpuTime.totalTime >= prevIt->second.totalTime) {
+        uint64_t timestampDiff =
+            nowCpuTime.timestamp - prevIt->second.timestamp;
+        uint64_t threadTimeDiff =
+            nowCpuTime.totalTime - prevIt->second.totalTime;
+        cpuPcts[nowCpuTime.name] +=
+            ((double)threadTimeDiff / (double)timestampDiff) * 100;
+      }
+      nowThreadCpuTimes.emplace(tid, std::move(nowCpuTime));
+    }
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Fail to read the \"/proc/self/task\" of current process "
+               << "to get the CPU usage of threads: " << ex.what();
+  }
+
+  // update the cache for next CPU% update, forgetting exited threads
+  prevThreadCpuTimes_ = std::move(nowThreadCpuTimes);
+
+  return cpuPcts;
+}
+
+/* Parse thread stat like "1234 (openr-KvStore) S 1 ... <utime> <stime> ..."
+ / Name is enclosed by the first "(" and the last ")" as it may contain any
+ / character. utime and stime are 14th and 15th fields of stat, i.e. 12th
+ / and 13th after name.
+*/
+std::optional<std::pair<std::string, uint64_t>>
+SystemMetrics::parseThreadStat(const std::string& stat) {
+  const auto nameBegin = stat.find('(');
+  const auto nameEnd = stat.rfind(')');
+  if (nameBegin == std::string::npos || nameEnd == std::string::npos ||
+      nameEnd < nameBegin) {
+    return std::nullopt;
+  }
+
+  std::vector<folly::StringPiece> fields;
+  folly::split(
+      ' ', folly::StringPiece(stat).subpiece(nameEnd + 1), fields, true);
+  if (fields.size() < 13) {
+    return std::nullopt;
+  }
+  try {
+    return std::make_pair(
+        stat.substr(nameBegin + 1, nameEnd - nameBegin - 1),
+        folly::to<uint64_t>(fields[11]) + folly::to<uint64_t>(fields[12]));
+  } catch (const std::exception&) {
+    return std::nullopt;
+  }
+}
+
 // get current timestamp
 uint64_t
 SystemMetrics::getCurrentNanoTime() {
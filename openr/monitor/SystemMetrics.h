@@ -13,6 +13,9 @@
 #include <sys/time.h>
 #include <chrono>
 #include <fstream>
+#include <optional>
+#include <string>
+#include <unordered_map>
 
 namespace openr {
 
@@ -28,6 +31,22 @@ class SystemMetrics {
   // get CPU% the process used
   std::optional<double> getCPUpercentage();
 
+  /**
+   * Get CPU% used by threads whose name starts with namePrefix, by thread
+   * name, from /proc/self/task/<tid>/stat. Threads of the same name are
+   * accounted together. Like getCPUpercentage, a thread is only accounted
+   * from the second query it is seen in.
+   */
+  std::unordered_map<std::string, double> getThreadCPUpercentage(
+      const std::string& namePrefix);
+
+  /**
+   * Parse name and CPU time used in user and system mode (in clock ticks) of
+   * a thread from content of its /proc/<pid>/task/<tid>/stat
+   */
+  static std::optional<std::pair<std::string, uint64_t>> parseThreadStat(
+      const std::string& stat);
+
  private:
   /**
   / To record CPU used time of current process (in nanoseconds)
@@ -50,6 +69,18 @@ class SystemMetrics {
   // cache for CPU used time of previous query
   ProcCpuTime prevCpuTime;
 
+  /**
+  / To record CPU used time of a thread of current process (in nanoseconds)
+  */
+  struct ThreadCpuTime {
+    std::string name;
+    uint64_t totalTime = 0; /* total CPU time used */
+    uint64_t timestamp = 0; /* timestamp for current record */
+  };
+
+  // cache for CPU used time of threads of previous query, by thread id
+  std::unordered_map<std::string, ThreadCpuTime> prevThreadCpuTimes_;
+
   // get current timestamp (in nanoseconds)
   uint64_t static getCurrentNanoTime();
 };
@@ -14,6 +14,7 @@
 #include <gtest/gtest.h>
 
 #include <openr/monitor/LogSample.h>
+#include <openr/monitor/LogSampleLimiter.h>
 
 namespace openr {
 
@@ -153,6 +154,51 @@ TEST(LogSampleTest, fromJsonTest) {
   EXPECT_THROW(LogSample::fromJson(jsonSampleNoTimeKey), std::exception);
 }
 
+TEST(LogSampleTest, LimiterTest) {
+  std::map<std::string, thrift::EventLogLimit> limits;
+  // admit one in 3 NB_UP events
+  limits["NB_UP"].sample_rate_ref() = 3;
+  // admit burst of 2 NB_DOWN events, refilled once a day
+  limits["NB_DOWN"].rate_per_sec_ref() = 1.0 / 86400;
+  limits["NB_DOWN"].burst_ref() = 2;
+  LogSampleLimiter limiter(limits);
+
+  auto makeSample = [](const std::string& event) {
+    LogSample sample;
+    sample.addString("event", event);
+    return sample;
+  };
+
+  // sampled events, summary of suppressed ones in next admitted event
+  std::vector<bool> admitted;
+  for (int i = 0; i < 4; ++i) {
+    auto sample = makeSample("NB_UP");
+    admitted.push_back(limiter.admit(sample));
+    if (i == 3) {
+      EXPECT_EQ(2, sample.getInt("num_suppressed"));
+    }
+  }
+  EXPECT_EQ(std::vector<bool>({true, false, false, true}), admitted);
+
+  // rate limited events
+  for (int i = 0; i < 5; ++i) {
+    auto sample = makeSample("NB_DOWN");
+    EXPECT_EQ(i < 2, limiter.admit(sample));
+  }
+
+  // events without limits
+  for (int i = 0; i < 5; ++i) {
+    auto sample = makeSample("NB_RESTART");
+    EXPECT_TRUE(limiter.admit(sample));
+    EXPECT_FALSE(sample.isIntSet("num_suppressed"));
+  }
+
+  const auto counts = limiter.getSuppressedCounts();
+  EXPECT_EQ(2, counts.at("NB_UP"));
+  EXPECT_EQ(3, counts.at("NB_DOWN"));
+  EXPECT_EQ(0, counts.count("NB_RESTART"));
+}
+
 } // namespace openr
 
 int
@@ -110,6 +110,36 @@ TEST_F(MonitorTestFixture, LogBasicOperation) {
   }
 }
 
+TEST_F(MonitorTestFixture, RecentLogsRingBuffer) {
+  // Default max_event_log is 100
+  const int kMaxLogs = 100;
+  const int kNumLogs = kMaxLogs + 5;
+  EXPECT_CALL(*monitor, processEventLog(_)).Times(kNumLogs);
+  for (int i = 0; i < kNumLogs; ++i) {
+    LogSample log;
+    log.addString("event", "event_unit_test");
+    log.addInt("num", i);
+    eventLogUpdatesQueue.push(std::move(log));
+  }
+
+  // Wait for the last log, oldest ones get overwritten
+  while (true) {
+    auto logs = monitor->getRecentEventLogs();
+    if (logs.size() == kMaxLogs and
+        LogSample::fromJson(logs.back()).getInt("num") == kNumLogs - 1) {
+      int num = kNumLogs - kMaxLogs;
+      for (const auto& log : logs) {
+        EXPECT_EQ(num++, LogSample::fromJson(log).getInt("num"));
+      }
+      break;
+    }
+    std::this_thread::yield();
+  }
+
+  monitor->clearRecentEventLogs();
+  EXPECT_TRUE(monitor->getRecentEventLogs().empty());
+}
+
 TEST_F(MonitorTestFixture, ProcessCounterTest) {
   // Wait for calling getCPUpercentage() twice for calculating the cpu% counter
   while (true) {
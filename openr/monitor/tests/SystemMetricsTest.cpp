@@ -6,9 +6,13 @@
  */
 
 #include <openr/monitor/SystemMetrics.h>
+#include <folly/system/ThreadName.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
+
 using namespace std;
 using namespace openr;
 using namespace testing;
@@ -41,6 +45,48 @@ TEST(MonitorTestFixture, SystemMetrics) {
   EXPECT_GT(cpu2.value(), 0);
 }
 
+TEST(MonitorTestFixture, ParseThreadStat) {
+  // name with spaces and parentheses, utime 11 and stime 22
+  auto nameAndTicks = SystemMetrics::parseThreadStat(
+      "42 (openr-a) (b)) S 1 2 3 4 5 6 7 8 9 10 11 22 33 44 20 0 1 0");
+  ASSERT_TRUE(nameAndTicks.has_value());
+  EXPECT_EQ("openr-a) (b)", nameAndTicks->first);
+  EXPECT_EQ(33, nameAndTicks->second);
+
+  EXPECT_FALSE(SystemMetrics::parseThreadStat("42 (openr-a S 1").has_value());
+  EXPECT_FALSE(SystemMetrics::parseThreadStat("42 (openr-a) S 1").has_value());
+}
+
+TEST(MonitorTestFixture, ThreadCPUpercentage) {
+  SystemMetrics systemMetrics_{};
+
+  // Busy thread of name with prefix
+  std::atomic<bool> stop{false};
+  std::atomic<bool> named{false};
+  std::thread busyThread([&]() {
+    folly::setThreadName("openr-busy");
+    named = true;
+    while (not stop) {
+    }
+  });
+  while (not named) {
+    std::this_thread::yield();
+  }
+
+  // First query returns nothing
+  EXPECT_TRUE(systemMetrics_.getThreadCPUpercentage("openr-").empty());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  auto cpuPcts = systemMetrics_.getThreadCPUpercentage("openr-");
+  stop = true;
+  busyThread.join();
+
+  // Only threads of name with prefix
+  ASSERT_EQ(1, cpuPcts.count("openr-busy"));
+  EXPECT_EQ(1, cpuPcts.size());
+  EXPECT_GT(cpuPcts.at("openr-busy"), 0);
+}
+
 int
 main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
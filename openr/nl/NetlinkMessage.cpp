@@ -7,20 +7,107 @@
 
 #include <openr/nl/NetlinkMessage.h>
 
+#include <mutex>
+
+#include <fb303/ServiceData.h>
+
+namespace fb303 = facebook::fb303;
+
 namespace openr::fbnl {
 
+namespace {
+
+struct BufferPool {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<NetlinkBufferPool::Buffer>> buffers;
+};
+
+// ATTN: intentionally leaked to outlive messages held by static objects
+BufferPool&
+getBufferPool() {
+  static auto* pool = new BufferPool();
+  return *pool;
+}
+
+} // namespace
+
+void
+NetlinkBufferPool::Recycler::operator()(Buffer* buffer) const {
+  std::unique_ptr<Buffer> ptr(buffer);
+  auto& pool = getBufferPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  if (pool.buffers.size() < kMaxNlBufferPoolSize) {
+    pool.buffers.emplace_back(std::move(ptr));
+  }
+}
+
+NetlinkBufferPool::BufferPtr
+NetlinkBufferPool::get() {
+  std::unique_ptr<Buffer> ptr;
+  {
+    auto& pool = getBufferPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (not pool.buffers.empty()) {
+      ptr = std::move(pool.buffers.back());
+      pool.buffers.pop_back();
+    }
+  }
+
+  if (ptr) {
+    fb303::fbData->addStatValue("netlink.buffer_pool.hits", 1, fb303::SUM);
+    ptr->fill(0);
+  } else {
+    fb303::fbData->addStatValue("netlink.buffer_pool.misses", 1, fb303::SUM);
+    ptr = std::make_unique<Buffer>(); // value-initialized, i.e. zeroed
+  }
+  return BufferPtr(ptr.release());
+}
+
+size_t
+NetlinkBufferPool::numIdle() {
+  auto& pool = getBufferPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  return pool.buffers.size();
+}
+
+NetlinkBulkRequest::NetlinkBulkRequest(size_t numMessages)
+    : status_(numMessages, 0), numPending_(numMessages) {
+  if (numMessages == 0) {
+    promise_.setValue(std::vector<int>{});
+  }
+}
+
+NetlinkBulkRequest::~NetlinkBulkRequest() {
+  CHECK(promise_.isFulfilled());
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkBulkRequest::getSemiFuture() {
+  return promise_.getSemiFuture();
+}
+
+void
+NetlinkBulkRequest::setReturnStatus(size_t index, int status) {
+  status_.at(index) = status;
+  // Last message to complete fulfils the promise. Acquire-release ordering
+  // makes status of all messages visible to it
+  if (numPending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    promise_.setValue(std::move(status_));
+  }
+}
+
 NetlinkMessage::NetlinkMessage()
-    : msghdr(reinterpret_cast<struct nlmsghdr*>(msg.data())) {}
+    : msghdr(reinterpret_cast<struct nlmsghdr*>(msg->data())) {}
 
 NetlinkMessage::NetlinkMessage(int type)
-    : msghdr(reinterpret_cast<struct nlmsghdr*>(msg.data())) {
+    : msghdr(reinterpret_cast<struct nlmsghdr*>(msg->data())) {
   // initialize netlink header
   msghdr->nlmsg_len = NLMSG_LENGTH(0);
   msghdr->nlmsg_type = type;
 }
 
 NetlinkMessage::~NetlinkMessage() {
-  CHECK(promise_.isFulfilled());
+  CHECK(hasReturnStatus_);
 }
 
 struct nlmsghdr*
@@ -95,14 +182,31 @@ NetlinkMessage::addAttributes(
 
 folly::SemiFuture<int>
 NetlinkMessage::getSemiFuture() {
+  CHECK(not promise_.valid()) << "SemiFuture can be retrieved only once";
+  promise_ = folly::Promise<int>();
   return promise_.getSemiFuture();
 }
 
+void
+NetlinkMessage::setBulkRequest(
+    std::shared_ptr<NetlinkBulkRequest> bulkRequest, size_t index) {
+  bulkRequest_ = std::move(bulkRequest);
+  bulkIndex_ = index;
+}
+
 void
 NetlinkMessage::setReturnStatus(int status) {
   VLOG(3) << "Netlink request completed. retval=" << status << ", "
           << folly::errnoStr(std::abs(status));
-  promise_.setValue(status);
+  CHECK(not hasReturnStatus_);
+  hasReturnStatus_ = true;
+  if (promise_.valid()) {
+    promise_.setValue(status);
+  }
+  if (bulkRequest_) {
+    bulkRequest_->setReturnStatus(bulkIndex_, status);
+    bulkRequest_.reset();
+  }
 }
 
 } // namespace openr::fbnl
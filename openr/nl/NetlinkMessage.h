@@ -7,8 +7,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include <limits.h>
 #include <linux/lwtunnel.h>
@@ -25,6 +28,62 @@ namespace openr::fbnl {
 
 constexpr uint16_t kMaxNlPayloadSize{4096};
 
+class RouteView;
+
+// Maximum number of idle message buffers retained by NetlinkBufferPool
+constexpr size_t kMaxNlBufferPoolSize{4096};
+
+/**
+ * Process wide pool of netlink message buffers. Buffers of destroyed messages
+ * are recycled for new messages instead of being freed, up to
+ * `kMaxNlBufferPoolSize` idle buffers. Buffers are zeroed when handed out.
+ * Thread-safe, as messages are usually created and destroyed on different
+ * threads.
+ *
+ * Exposes fb303 counters `netlink.buffer_pool.hits` and
+ * `netlink.buffer_pool.misses`
+ */
+class NetlinkBufferPool {
+ public:
+  using Buffer = std::array<char, kMaxNlPayloadSize>;
+
+  struct Recycler {
+    void operator()(Buffer* buffer) const;
+  };
+
+  using BufferPtr = std::unique_ptr<Buffer, Recycler>;
+
+  // Get zeroed buffer, from pool if available else newly allocated
+  static BufferPtr get();
+
+  // Number of idle buffers currently in pool
+  static size_t numIdle();
+};
+
+/**
+ * Completion of a bulk request, i.e. of multiple netlink messages sharing one
+ * promise instead of one promise per message. Collects return status of every
+ * message and fulfils the promise once all messages completed. Return status
+ * may be set from any thread.
+ */
+class NetlinkBulkRequest {
+ public:
+  explicit NetlinkBulkRequest(size_t numMessages);
+
+  ~NetlinkBulkRequest();
+
+  // Get SemiFuture of return status of every message, indexed by message
+  folly::SemiFuture<std::vector<int>> getSemiFuture();
+
+  // Set return status of message at index
+  void setReturnStatus(size_t index, int status);
+
+ private:
+  std::vector<int> status_;
+  std::atomic<size_t> numPending_{0};
+  folly::Promise<std::vector<int>> promise_;
+};
+
 /**
  * Data structure representing a netlink message, either to be sent or received.
  * It wraps `struct nlmsghdr` and provides buffer for appending message payload.
@@ -54,8 +113,8 @@ class NetlinkMessage {
   // get current length
   uint32_t getDataLength() const;
 
-  // Buffer to create message
-  std::array<char, kMaxNlPayloadSize> msg = {};
+  // Buffer to create message, recycled through NetlinkBufferPool
+  const NetlinkBufferPool::BufferPtr msg{NetlinkBufferPool::get()};
 
   /**
    * APIs for accumulating objects of `GET_<>` request. These APIs are invoked
@@ -72,6 +131,13 @@ class NetlinkMessage {
     CHECK(false) << "Must be implemented by subclass";
   }
 
+  // Invoked with a view of every route message received. View is valid only
+  // for the duration of the call
+  virtual void
+  rcvdRouteView(const RouteView& /* route */) {
+    CHECK(false) << "Must be implemented by subclass";
+  }
+
   virtual void
   rcvdLink(Link&& /* link */) {
     CHECK(false) << "Must be implemented by subclass";
@@ -89,10 +155,18 @@ class NetlinkMessage {
 
   /**
    * Get SemiFuture associated with the the associated netlink request. Upon
-   * receipt of the ack from kernel, the value will be set.
+   * receipt of the ack from kernel, the value will be set. Promise is only
+   * created on retrieval of the SemiFuture, which can be retrieved only once.
    */
   folly::SemiFuture<int> getSemiFuture();
 
+  /**
+   * Report return status of the request to bulk request at index instead of
+   * (or in addition to) the SemiFuture
+   */
+  void setBulkRequest(
+      std::shared_ptr<NetlinkBulkRequest> bulkRequest, size_t index);
+
   /**
    * Set the return value of the netlink request. Invoke this on receipt of the
    * ack. This must be invoked before class is destroyed.
@@ -108,6 +182,17 @@ class NetlinkMessage {
     return createTs_;
   }
 
+  // Timestamp when message was sent to kernel. Used to measure ack latency
+  void
+  setSendTs(std::chrono::steady_clock::time_point sendTs) {
+    sendTs_ = sendTs;
+  }
+
+  std::chrono::steady_clock::time_point
+  getSendTs() const {
+    return sendTs_;
+  }
+
  protected:
   // Add TLV attributes, specify the length and size of data returns ENOBUFS
   // if enough buffer is not available. Also updates the length field in
@@ -132,12 +217,23 @@ class NetlinkMessage {
   // pointer to the netlink message header
   struct nlmsghdr* const msghdr{nullptr};
 
-  // Promise to relay the status code received from kernel
-  folly::Promise<int> promise_;
+  // Promise to relay the status code received from kernel. Empty unless
+  // SemiFuture is retrieved
+  folly::Promise<int> promise_{folly::Promise<int>::makeEmpty()};
+
+  // Bulk request this message is part of, if any, and index within it
+  std::shared_ptr<NetlinkBulkRequest> bulkRequest_{nullptr};
+  size_t bulkIndex_{0};
+
+  // Whether return status has been set
+  bool hasReturnStatus_{false};
 
   // Timestamp when message object was created
   const std::chrono::steady_clock::time_point createTs_{
       std::chrono::steady_clock::now()};
+
+  // Timestamp when message was sent to kernel
+  std::chrono::steady_clock::time_point sendTs_{createTs_};
 };
 
 } // namespace openr::fbnl
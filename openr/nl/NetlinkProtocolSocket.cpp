@@ -5,9 +5,12 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <iterator>
 #include <thread>
 
 #include <fb303/ServiceData.h>
+#include <folly/ScopeGuard.h>
+#include <folly/tracing/StaticTracepoint.h>
 
 #include <openr/common/Util.h>
 #include <openr/nl/NetlinkProtocolSocket.h>
@@ -15,15 +18,29 @@
 using facebook::fb303::fbData;
 namespace fb303 = facebook::fb303;
 
+namespace {
+
+// Set socket buffer size. Privileged `forceOpt` overrides system wide limits
+// (net.core.rmem_max/wmem_max), fall back to `opt` capped by them otherwise
+bool
+setSocketBufferSize(int fd, int forceOpt, int opt, int size) {
+  return setsockopt(fd, SOL_SOCKET, forceOpt, &size, sizeof(size)) == 0 or
+      setsockopt(fd, SOL_SOCKET, opt, &size, sizeof(size)) == 0;
+}
+
+} // namespace
+
 namespace openr::fbnl {
 
 NetlinkProtocolSocket::NetlinkProtocolSocket(
     folly::EventBase* evb,
     messaging::ReplicateQueue<NetlinkEvent>& netlinkEventsQ,
-    bool enableIPv6RouteReplaceSemantics)
+    bool enableIPv6RouteReplaceSemantics,
+    messaging::ReplicateQueue<NetlinkEvents>* netlinkEventsBatchQ)
     : EventHandler(evb),
       evb_(evb),
       netlinkEventsQueue_(netlinkEventsQ),
+      netlinkEventsBatchQueue_(netlinkEventsBatchQ),
       enableIPv6RouteReplaceSemantics_(enableIPv6RouteReplaceSemantics) {
   CHECK_NOTNULL(evb_);
 
@@ -50,6 +67,8 @@ NetlinkProtocolSocket::NetlinkProtocolSocket(
               << ", port=" << portId_;
     unregisterHandler();
     close(nlSock_);
+    // Events in the receive buffer of closed socket are gone
+    ++eventsLostCount_;
     init();
 
     // Resume sending netlink messages if any queued
@@ -107,11 +126,30 @@ NetlinkProtocolSocket::init() {
   if (nlSock_ < 0) {
     LOG(FATAL) << "Netlink socket create failed.";
   }
-  int size = kNetlinkSockRecvBuf;
-  // increase socket recv buffer size
-  if (setsockopt(nlSock_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
+  // increase socket recv and send buffer size
+  if (not setSocketBufferSize(
+          nlSock_, SO_RCVBUFFORCE, SO_RCVBUF, kNetlinkSockRecvBuf)) {
     LOG(FATAL) << "Netlink socket set recv buffer failed.";
-  };
+  }
+  if (not setSocketBufferSize(
+          nlSock_, SO_SNDBUFFORCE, SO_SNDBUF, kNetlinkSockSendBuf)) {
+    LOG(FATAL) << "Netlink socket set send buffer failed.";
+  }
+
+  // Let kernel filter route dumps by attributes of request instead of
+  // returning all routes of family (Linux 4.20+). Older kernels reject the
+  // option and routes are filtered on user side only
+  const int strictCheck = 1;
+  strictCheckEnabled_ = setsockopt(
+                            nlSock_,
+                            SOL_NETLINK,
+                            NETLINK_GET_STRICT_CHK,
+                            &strictCheck,
+                            sizeof(strictCheck)) == 0;
+  if (not strictCheckEnabled_) {
+    LOG(WARNING) << "Netlink strict checking unsupported, route dumps are "
+                 << "filtered on user side. Error: " << folly::errnoStr(errno);
+  }
 
   // Bind on the source address. We let kernel chose the available port-ID
   struct sockaddr_nl saddr;
@@ -148,19 +186,18 @@ NetlinkProtocolSocket::init() {
 void
 NetlinkProtocolSocket::handlerReady(uint16_t events) noexcept {
   CHECK_EQ(events, folly::EventHandler::READ);
-  try {
-    recvNetlinkMessage();
-  } catch (std::exception const& e) {
-    LOG(ERROR) << "Error processing netlink message" << folly::exceptionStr(e);
-    fbData->addStatValue("netlink.errors", 1, fb303::SUM);
-  }
+  recvNetlinkMessage();
 }
 
 void
 NetlinkProtocolSocket::setLinkEventCB(
     std::function<void(fbnl::Link, bool)> linkEventCB) {
-  CHECK(!linkEventCB_) << "Callback can be registered only once";
-  linkEventCB_ = linkEventCB;
+  // Callback is invoked on event base thread, hence it is set there as well.
+  // NOTE: Runs inline if event base is not running yet
+  evb_->runImmediatelyOrRunInEventBaseThreadAndWait([this, linkEventCB]() {
+    CHECK(!linkEventCB_) << "Callback can be registered only once";
+    linkEventCB_ = linkEventCB;
+  });
 }
 
 void
@@ -179,6 +216,10 @@ NetlinkProtocolSocket::setNeighborEventCB(
 
 void
 NetlinkProtocolSocket::processAck(uint32_t ack, int status) {
+  FOLLY_SDT(openr, netlink_process_ack_entry, ack, status);
+  SCOPE_EXIT {
+    FOLLY_SDT(openr, netlink_process_ack_return, ack);
+  };
   VLOG(2) << "Completed netlink request. seq=" << ack << ", retval=" << status;
   if (std::abs(status) != EEXIST && std::abs(status) != ESRCH && status != 0) {
     fbData->addStatValue("netlink.requests.error", 1, fb303::SUM);
@@ -194,6 +235,14 @@ NetlinkProtocolSocket::processAck(uint32_t ack, int status) {
     fbData->addStatValue(
         "netlink.requests.latency_ms", requestLatency.count(), fb303::AVG);
 
+    // Adapt window of in-flight messages as per the ack latency
+    const auto sendTs = it->second->getSendTs();
+    if (std::chrono::steady_clock::now() - sendTs > kNlAckLatencyTarget) {
+      decreaseSendWindow(sendTs);
+    } else if (++numAckedInWindow_ >= sendWindow_) {
+      increaseSendWindow();
+    }
+
     // Set return status on promise
     it->second->setReturnStatus(status);
     nlSeqNumMap_.erase(it);
@@ -212,27 +261,59 @@ NetlinkProtocolSocket::processAck(uint32_t ack, int status) {
 
   // We've successfully completed at-least one message. Send more messages
   // if any pending. Here we add optimization to wait for some more acks and
-  // send pending message in batch of atleast `kMinIovMsg`
-  if (nlSeqNumMap_.empty() or (kMaxIovMsg - nlSeqNumMap_.size() > kMinIovMsg)) {
+  // send pending message in batch of atleast half of the window
+  if (nlSeqNumMap_.size() <= sendWindow_ / 2) {
     sendNetlinkMessage();
   }
 }
 
+void
+NetlinkProtocolSocket::increaseSendWindow() {
+  numAckedInWindow_ = 0;
+  sendWindow_ = std::min(kMaxIovMsg, sendWindow_ + kMinIovMsg);
+}
+
+void
+NetlinkProtocolSocket::decreaseSendWindow(
+    std::chrono::steady_clock::time_point sendTs) {
+  if (sendTs < lastWindowDecreaseTs_) {
+    // Message was sent with the window prior to last decrease
+    return;
+  }
+  numAckedInWindow_ = 0;
+  lastWindowDecreaseTs_ = std::chrono::steady_clock::now();
+  sendWindow_ = std::max(kMinIovMsg, sendWindow_ / 2);
+  fbData->addStatValue("netlink.requests.window_decrease", 1, fb303::SUM);
+  VLOG(1) << "Decreased netlink send window to " << sendWindow_;
+}
+
 void
 NetlinkProtocolSocket::sendNetlinkMessage() {
   CHECK(evb_->isInEventBaseThread());
+  FOLLY_SDT(
+      openr,
+      netlink_send_message_entry,
+      msgQueue_.size(),
+      nlSeqNumMap_.size());
+  SCOPE_EXIT {
+    FOLLY_SDT(openr, netlink_send_message_return, nlSeqNumMap_.size());
+  };
   struct sockaddr_nl nladdr = {
       .nl_family = AF_NETLINK, .nl_pad = 0, .nl_pid = 0, .nl_groups = 0};
-  CHECK_LE(nlSeqNumMap_.size(), kMaxIovMsg)
-      << "We must have capacity to send at-least one message!";
+  if (nlSeqNumMap_.size() >= sendWindow_) {
+    // Window is full (or shrunk below in-flight messages). Wait for acks
+    return;
+  }
   uint32_t count{0};
   const uint32_t iovSize =
-      std::min(msgQueue_.size(), kMaxIovMsg - nlSeqNumMap_.size());
+      std::min(msgQueue_.size(), sendWindow_ - nlSeqNumMap_.size());
 
   if (!iovSize) {
     return;
   }
 
+  const auto sendTs = std::chrono::steady_clock::now();
+
   auto iov = std::make_unique<struct iovec[]>(iovSize);
 
   while (count < iovSize && !msgQueue_.empty()) {
@@ -246,6 +327,7 @@ NetlinkProtocolSocket::sendNetlinkMessage() {
     // fill sequence number and PID
     nlmsg_hdr->nlmsg_pid = portId_;
     nlmsg_hdr->nlmsg_seq = nextNlSeqNum_++;
+    m->setSendTs(sendTs);
     if (nextNlSeqNum_ == 0) {
       // wrap around - we start from 1
       nextNlSeqNum_ = 1;
@@ -277,15 +359,24 @@ NetlinkProtocolSocket::sendNetlinkMessage() {
   // `sendmsg` return -1 in case of error else number of bytes sent. `errno`
   // will be set to an appropriate code in case of error.
   int bytesSent = sendmsg(nlSock_, outMsg.get(), 0);
+  const int sendErrno = errno;
   if (bytesSent < 0) {
     LOG(ERROR) << "Error sending on netlink socket. Error: "
                << folly::errnoStr(std::abs(errno)) << ", errno=" << errno
                << ", fd=" << nlSock_ << ", num-messages=" << outMsg->msg_iovlen;
     fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+    if (sendErrno == ENOBUFS) {
+      fbData->addStatValue("netlink.requests.enobufs", 1, fb303::SUM);
+      decreaseSendWindow(sendTs);
+    }
   } else {
     fbData->addStatValue("netlink.bytes.tx", bytesSent, fb303::SUM);
   }
   fbData->addStatValue("netlink.requests", outMsg->msg_iovlen, fb303::SUM);
+  fbData->addStatValue(
+      "netlink.requests.in_flight", nlSeqNumMap_.size(), fb303::AVG);
+  fbData->addStatValue("netlink.requests.queued", msgQueue_.size(), fb303::AVG);
+  fbData->addStatValue("netlink.requests.window", sendWindow_, fb303::AVG);
   VLOG(2) << "Sent " << outMsg->msg_iovlen << " netlink requests on fd "
           << nlSock_;
 
@@ -311,13 +402,12 @@ NetlinkProtocolSocket::processMessage(
     switch (nlh->nlmsg_type) {
     case RTM_NEWROUTE:
     case RTM_DELROUTE: {
-      // next RTM message to be processed
-      auto route = NetlinkRouteMessage::parseMessage(nlh);
+      // next RTM message to be processed. Parsed in place by request
       if (nlSeqIt != nlSeqNumMap_.end()) {
         // Extend message timer as we received a valid ack
         nlMessageTimer_->scheduleTimeout(kNlRequestAckTimeout);
         // Received route in response to request
-        nlSeqIt->second->rcvdRoute(std::move(route));
+        nlSeqIt->second->rcvdRouteView(RouteView(nlh));
       } else {
         // Route notification
         fbData->addStatValue("netlink.notifications.route", 1, fb303::SUM);
@@ -344,7 +434,7 @@ NetlinkProtocolSocket::processMessage(
         }
 
         // notification via replicateQueue
-        netlinkEventsQueue_.push(link);
+        publishEvent(std::move(link));
       }
     } break;
 
@@ -383,7 +473,7 @@ NetlinkProtocolSocket::processMessage(
         }
 
         // notification via replicateQueue
-        netlinkEventsQueue_.push(addr);
+        publishEvent(std::move(addr));
       }
     } break;
 
@@ -406,7 +496,7 @@ NetlinkProtocolSocket::processMessage(
         }
 
         // notification via replicateQueue
-        netlinkEventsQueue_.push(neighbor);
+        publishEvent(std::move(neighbor));
       }
     } break;
 
@@ -440,24 +530,78 @@ NetlinkProtocolSocket::processMessage(
 
 void
 NetlinkProtocolSocket::recvNetlinkMessage() {
-  // messages buffer
-  std::array<char, kMaxNlPayloadSize> recvMsg = {};
+  // Receive up to kNlRecvBatchSize messages with a single system call
+  std::array<struct iovec, kNlRecvBatchSize> iovs;
+  std::array<struct mmsghdr, kNlRecvBatchSize> msgs;
+  ::memset(msgs.data(), 0, sizeof(msgs));
+  for (size_t i = 0; i < kNlRecvBatchSize; ++i) {
+    iovs[i].iov_base = recvBuffers_[i].data();
+    iovs[i].iov_len = kMaxNlPayloadSize;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
 
-  int32_t bytesRead = ::recv(nlSock_, recvMsg.data(), kMaxNlPayloadSize, 0);
-  VLOG(4) << "Message received with size: " << bytesRead;
+  int numMsgs = ::recvmmsg(
+      nlSock_, msgs.data(), kNlRecvBatchSize, MSG_DONTWAIT, nullptr);
+  const int recvErrno = errno;
+  fbData->addStatValue("netlink.recv.syscalls", 1, fb303::SUM);
+  VLOG(4) << "Messages received: " << numMsgs;
 
-  if (bytesRead < 0) {
-    if (errno == EINTR || errno == EAGAIN) {
+  if (numMsgs < 0) {
+    if (recvErrno == EINTR || recvErrno == EAGAIN) {
       return;
     }
-    LOG(ERROR) << "Error in netlink socket receive: " << bytesRead
-               << " err: " << folly::errnoStr(std::abs(errno));
+    LOG(ERROR) << "Error in netlink socket receive: " << numMsgs
+               << " err: " << folly::errnoStr(std::abs(recvErrno));
     fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+    if (recvErrno == ENOBUFS) {
+      // Receive buffer overrun, kernel dropped messages. Slow down requests
+      fbData->addStatValue("netlink.requests.enobufs", 1, fb303::SUM);
+      ++eventsLostCount_;
+      decreaseSendWindow(std::chrono::steady_clock::now());
+    }
     return;
-  } else {
+  }
+  fbData->addStatValue("netlink.recv.messages", numMsgs, fb303::SUM);
+
+  for (int i = 0; i < numMsgs; ++i) {
+    const uint32_t bytesRead = msgs[i].msg_len;
+    VLOG(4) << "Message received with size: " << bytesRead;
     fbData->addStatValue("netlink.bytes.rx", bytesRead, fb303::SUM);
+    if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      LOG(ERROR) << "Truncated netlink message of size " << bytesRead;
+      fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+      ++eventsLostCount_;
+    }
+    try {
+      processMessage(recvBuffers_[i], bytesRead);
+    } catch (std::exception const& e) {
+      LOG(ERROR) << "Error processing netlink message"
+                 << folly::exceptionStr(e);
+      fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+    }
+  }
+  publishEventBatch();
+}
+
+void
+NetlinkProtocolSocket::publishEvent(NetlinkEvent&& event) {
+  if (netlinkEventsBatchQueue_) {
+    pendingEvents_.emplace_back(std::move(event));
+  } else {
+    netlinkEventsQueue_.push(std::move(event));
+  }
+}
+
+void
+NetlinkProtocolSocket::publishEventBatch() {
+  if (pendingEvents_.empty()) {
+    return;
   }
-  processMessage(recvMsg, static_cast<uint32_t>(bytesRead));
+  fbData->addStatValue(
+      "netlink.notifications.batch_size", pendingEvents_.size(), fb303::AVG);
+  netlinkEventsBatchQueue_->push(std::move(pendingEvents_));
+  pendingEvents_ = NetlinkEvents{};
 }
 
 folly::SemiFuture<int>
@@ -482,32 +626,48 @@ NetlinkProtocolSocket::collectReturnStatus(
           });
 }
 
+int
+NetlinkProtocolSocket::initAddRouteMessage(
+    NetlinkRouteMessage& rtmMsg, const Route& route) {
+  switch (route.getFamily()) {
+  case AF_INET:
+  case AF_INET6:
+    return rtmMsg.addRoute(route);
+  case AF_MPLS:
+    return rtmMsg.addLabelRoute(route);
+  default:
+    return -EPROTONOSUPPORT;
+  }
+}
+
+int
+NetlinkProtocolSocket::initDeleteRouteMessage(
+    NetlinkRouteMessage& rtmMsg, const Route& route) {
+  switch (route.getFamily()) {
+  case AF_INET:
+  case AF_INET6:
+    return rtmMsg.deleteRoute(route);
+  case AF_MPLS:
+    return rtmMsg.deleteLabelRoute(route);
+  default:
+    return -EPROTONOSUPPORT;
+  }
+}
+
 folly::SemiFuture<int>
 NetlinkProtocolSocket::addRoute(const openr::fbnl::Route& route) {
   VLOG(1) << "Netlink add route. " << route.str();
   auto rtmMsg = std::make_unique<NetlinkRouteMessage>();
   auto future = rtmMsg->getSemiFuture();
 
-  int status{0};
-  switch (route.getFamily()) {
-  case AF_INET6:
-    if (not enableIPv6RouteReplaceSemantics_) {
-      // Special case for IPv6 route add. We first delete the route and then
-      // add it.
-      // NOTE: We ignore the error for the deleteRoute
-      deleteRoute(route);
-    }
-    FOLLY_FALLTHROUGH;
-  case AF_INET:
-    status = rtmMsg->addRoute(route);
-    break;
-  case AF_MPLS:
-    status = rtmMsg->addLabelRoute(route);
-    break;
-  default:
-    status = -EPROTONOSUPPORT;
+  if (route.getFamily() == AF_INET6 and not enableIPv6RouteReplaceSemantics_) {
+    // Special case for IPv6 route add. We first delete the route and then
+    // add it.
+    // NOTE: We ignore the error for the deleteRoute
+    deleteRoute(route);
   }
 
+  int status = initAddRouteMessage(*rtmMsg, route);
   if (status != 0) {
     rtmMsg->setReturnStatus(status);
   } else {
@@ -523,19 +683,7 @@ NetlinkProtocolSocket::deleteRoute(const openr::fbnl::Route& route) {
   auto rtmMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
   auto future = rtmMsg->getSemiFuture();
 
-  int status{0};
-  switch (route.getFamily()) {
-  case AF_INET:
-  case AF_INET6:
-    status = rtmMsg->deleteRoute(route);
-    break;
-  case AF_MPLS:
-    status = rtmMsg->deleteLabelRoute(route);
-    break;
-  default:
-    status = -EPROTONOSUPPORT;
-  }
-
+  int status = initDeleteRouteMessage(*rtmMsg, route);
   if (status != 0) {
     rtmMsg->setReturnStatus(status);
   } else {
@@ -545,6 +693,126 @@ NetlinkProtocolSocket::deleteRoute(const openr::fbnl::Route& route) {
   return future;
 }
 
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::addRoutes(
+    const std::vector<openr::fbnl::Route>& routes) {
+  VLOG(1) << "Netlink add " << routes.size() << " routes";
+  auto bulkRequest = std::make_shared<NetlinkBulkRequest>(routes.size());
+  auto future = bulkRequest->getSemiFuture();
+
+  std::vector<std::unique_ptr<NetlinkMessage>> msgs;
+  msgs.reserve(routes.size());
+  for (size_t i = 0; i < routes.size(); ++i) {
+    const auto& route = routes.at(i);
+    VLOG(2) << "Netlink add route. " << route.str();
+    if (route.getFamily() == AF_INET6 and
+        not enableIPv6RouteReplaceSemantics_) {
+      // Special case for IPv6 route add as in addRoute. Status of the delete
+      // is ignored, hence it is not part of the bulk request
+      auto delMsg = std::make_unique<NetlinkRouteMessage>();
+      int delStatus = initDeleteRouteMessage(*delMsg, route);
+      if (delStatus != 0) {
+        delMsg->setReturnStatus(delStatus);
+      } else {
+        msgs.emplace_back(std::move(delMsg));
+      }
+    }
+
+    auto rtmMsg = std::make_unique<NetlinkRouteMessage>();
+    rtmMsg->setBulkRequest(bulkRequest, i);
+    int status = initAddRouteMessage(*rtmMsg, route);
+    if (status != 0) {
+      rtmMsg->setReturnStatus(status);
+    } else {
+      msgs.emplace_back(std::move(rtmMsg));
+    }
+  }
+  notifQueue_.putMessages(
+      std::make_move_iterator(msgs.begin()),
+      std::make_move_iterator(msgs.end()));
+
+  return future;
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::deleteRoutes(
+    const std::vector<openr::fbnl::Route>& routes) {
+  VLOG(1) << "Netlink delete " << routes.size() << " routes";
+  auto bulkRequest = std::make_shared<NetlinkBulkRequest>(routes.size());
+  auto future = bulkRequest->getSemiFuture();
+
+  std::vector<std::unique_ptr<NetlinkMessage>> msgs;
+  msgs.reserve(routes.size());
+  for (size_t i = 0; i < routes.size(); ++i) {
+    const auto& route = routes.at(i);
+    VLOG(2) << "Netlink delete route. " << route.str();
+    auto rtmMsg = std::make_unique<NetlinkRouteMessage>();
+    rtmMsg->setBulkRequest(bulkRequest, i);
+    int status = initDeleteRouteMessage(*rtmMsg, route);
+    if (status != 0) {
+      rtmMsg->setReturnStatus(status);
+    } else {
+      msgs.emplace_back(std::move(rtmMsg));
+    }
+  }
+  notifQueue_.putMessages(
+      std::make_move_iterator(msgs.begin()),
+      std::make_move_iterator(msgs.end()));
+
+  return future;
+}
+
+folly::SemiFuture<int>
+NetlinkProtocolSocket::addNextHopObject(
+    uint32_t id, const openr::fbnl::NextHop& nextHop) {
+  VLOG(1) << "Netlink add nexthop object " << id << ". " << nextHop.str();
+  auto nhMsg = std::make_unique<NetlinkNextHopMessage>();
+  auto future = nhMsg->getSemiFuture();
+
+  int status = nhMsg->addNextHop(id, nextHop);
+  if (status != 0) {
+    nhMsg->setReturnStatus(status);
+  } else {
+    notifQueue_.putMessage(std::move(nhMsg));
+  }
+
+  return future;
+}
+
+folly::SemiFuture<int>
+NetlinkProtocolSocket::addNextHopGroupObject(
+    uint32_t id, const std::vector<std::pair<uint32_t, uint16_t>>& members) {
+  VLOG(1) << "Netlink add nexthop group object " << id << " of "
+          << members.size() << " members";
+  auto nhMsg = std::make_unique<NetlinkNextHopMessage>();
+  auto future = nhMsg->getSemiFuture();
+
+  int status = nhMsg->addNextHopGroup(id, members);
+  if (status != 0) {
+    nhMsg->setReturnStatus(status);
+  } else {
+    notifQueue_.putMessage(std::move(nhMsg));
+  }
+
+  return future;
+}
+
+folly::SemiFuture<int>
+NetlinkProtocolSocket::deleteNextHopObject(uint32_t id) {
+  VLOG(1) << "Netlink delete nexthop object " << id;
+  auto nhMsg = std::make_unique<NetlinkNextHopMessage>();
+  auto future = nhMsg->getSemiFuture();
+
+  int status = nhMsg->deleteNextHop(id);
+  if (status != 0) {
+    nhMsg->setReturnStatus(status);
+  } else {
+    notifQueue_.putMessage(std::move(nhMsg));
+  }
+
+  return future;
+}
+
 folly::SemiFuture<int>
 NetlinkProtocolSocket::addIfAddress(const openr::fbnl::IfAddress& ifAddr) {
   VLOG(1) << "Netlink add interface address. " << ifAddr.str();
@@ -579,6 +847,48 @@ NetlinkProtocolSocket::deleteIfAddress(const openr::fbnl::IfAddress& ifAddr) {
   return future;
 }
 
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::addIfAddresses(
+    const std::vector<openr::fbnl::IfAddress>& ifAddrs) {
+  VLOG(1) << "Netlink add " << ifAddrs.size() << " interface addresses";
+  return addOrDeleteIfAddresses(ifAddrs, RTM_NEWADDR);
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::deleteIfAddresses(
+    const std::vector<openr::fbnl::IfAddress>& ifAddrs) {
+  VLOG(1) << "Netlink delete " << ifAddrs.size() << " interface addresses";
+  return addOrDeleteIfAddresses(ifAddrs, RTM_DELADDR);
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::addOrDeleteIfAddresses(
+    const std::vector<openr::fbnl::IfAddress>& ifAddrs, int type) {
+  auto bulkRequest = std::make_shared<NetlinkBulkRequest>(ifAddrs.size());
+  auto future = bulkRequest->getSemiFuture();
+
+  std::vector<std::unique_ptr<NetlinkMessage>> msgs;
+  msgs.reserve(ifAddrs.size());
+  for (size_t i = 0; i < ifAddrs.size(); ++i) {
+    const auto& ifAddr = ifAddrs.at(i);
+    VLOG(2) << "Netlink " << (type == RTM_NEWADDR ? "add" : "delete")
+            << " interface address. " << ifAddr.str();
+    auto addrMsg = std::make_unique<openr::fbnl::NetlinkAddrMessage>();
+    addrMsg->setBulkRequest(bulkRequest, i);
+    int status = addrMsg->addOrDeleteIfAddress(ifAddr, type);
+    if (status != 0) {
+      addrMsg->setReturnStatus(status);
+    } else {
+      msgs.emplace_back(std::move(addrMsg));
+    }
+  }
+  notifQueue_.putMessages(
+      std::make_move_iterator(msgs.begin()),
+      std::make_move_iterator(msgs.end()));
+
+  return future;
+}
+
 folly::SemiFuture<folly::Expected<std::vector<fbnl::Link>, int>>
 NetlinkProtocolSocket::getAllLinks() {
   VLOG(1) << "Netlink get links";
@@ -631,6 +941,41 @@ NetlinkProtocolSocket::getRoutes(const fbnl::Route& filter) {
   return future;
 }
 
+folly::SemiFuture<int>
+NetlinkProtocolSocket::visitRoutes(
+    const fbnl::Route& filter, RouteVisitor visitor) {
+  VLOG(1) << "Netlink visit routes with filter. " << filter.str();
+  auto routeMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
+  routeMsg->setRouteVisitor(std::move(visitor));
+  auto future = routeMsg->getSemiFuture();
+
+  // Initialize message fields to get all routes
+  routeMsg->init(RTM_GETROUTE, 0, filter);
+  notifQueue_.putMessage(std::move(routeMsg));
+
+  return future;
+}
+
+folly::SemiFuture<int>
+NetlinkProtocolSocket::visitIPv4Routes(
+    uint8_t protocolId, RouteVisitor visitor) {
+  fbnl::RouteBuilder builder;
+  builder.setDestination({folly::IPAddressV4("0.0.0.0"), 0});
+  builder.setProtocolId(protocolId);
+  builder.setType(RTN_UNSPEC); // Explicitly set type to 0
+  return visitRoutes(builder.build(), std::move(visitor));
+}
+
+folly::SemiFuture<int>
+NetlinkProtocolSocket::visitIPv6Routes(
+    uint8_t protocolId, RouteVisitor visitor) {
+  fbnl::RouteBuilder builder;
+  builder.setDestination({folly::IPAddressV6("::"), 0});
+  builder.setProtocolId(protocolId);
+  builder.setType(RTN_UNSPEC); // Explicitly set type to 0
+  return visitRoutes(builder.build(), std::move(visitor));
+}
+
 folly::SemiFuture<folly::Expected<std::vector<fbnl::Route>, int>>
 NetlinkProtocolSocket::getAllRoutes() {
   fbnl::RouteBuilder builder;
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include <folly/IPAddress.h>
@@ -26,13 +27,24 @@ namespace openr::fbnl {
 // Netlink event as union of LINK/ADDR/NEIGH event
 using NetlinkEvent = std::variant<fbnl::Link, fbnl::IfAddress, fbnl::Neighbor>;
 
-// Receive socket buffer for netlink socket
-constexpr uint32_t kNetlinkSockRecvBuf{1 * 1024 * 1024};
+// Netlink events received in one poll cycle of the socket, in order
+using NetlinkEvents = std::vector<NetlinkEvent>;
 
-// Maximum number of in-flight messages. `kMinIovMsg` indicates the soft
-// requirement for sending bufferred messages.
-constexpr size_t kMaxIovMsg{500};
-constexpr size_t kMinIovMsg{200};
+// Receive and send socket buffers for netlink socket
+constexpr uint32_t kNetlinkSockRecvBuf{8 * 1024 * 1024};
+constexpr uint32_t kNetlinkSockSendBuf{8 * 1024 * 1024};
+
+// Maximum number of messages received from netlink socket in one system call
+constexpr size_t kNlRecvBatchSize{32};
+
+// Bounds and initial size of the window of in-flight messages. Window grows
+// by `kMinIovMsg` with every window worth of acks received within
+// `kNlAckLatencyTarget` and halves on slower acks or `ENOBUFS`. Buffered
+// messages are sent once at least half of the window is available.
+constexpr size_t kMaxIovMsg{4000};
+constexpr size_t kMinIovMsg{100};
+constexpr size_t kInitIovMsg{500};
+constexpr std::chrono::milliseconds kNlAckLatencyTarget{100};
 
 // Timeout for an ack from kernel for netlink messages we sent. The response for
 // big request (e.g. adding 5k routes or getting 10k routes) is sent back in
@@ -63,7 +75,9 @@ constexpr std::chrono::milliseconds kNlRequestAckTimeout{1000};
  * Above threading model allows multiple requests to be sent in parallel and
  * process their response asynchronously. Outstanding requests to kernel is
  * rate-limited to not overwhelm the socket buffers. Rate-limiting of requests
- * is governed by params kMaxIovMsg and kMinIovMsg. This allows adding 100k
+ * is governed by an adaptive window of in-flight messages bounded by
+ * kMinIovMsg and kMaxIovMsg, grown or shrunk as per the ack latency and
+ * socket buffer exhaustion (`ENOBUFS`). This allows adding 100k
  * routes in under 2 seconds. These performance benchmarks can be observed
  * by running associated UTs and it might vary on different systems.
  *
@@ -86,19 +100,34 @@ constexpr std::chrono::milliseconds kNlRequestAckTimeout{1000};
  *   netlink.requests.success : Request that completed successfully
  *   netlink.requests.error : Request with non zero return code
  *   netlink.requests.latency_ms : Average latency of netlink request
+ *   netlink.requests.in_flight : Average number of in-flight requests
+ *   netlink.requests.queued : Average number of requests waiting to be sent
+ *   netlink.requests.window : Average size of the in-flight window
+ *   netlink.requests.window_decrease : Window size reductions
+ *   netlink.requests.enobufs : Socket buffer exhaustion on send or receive
  *   netlink.bytes.rx : Bytes received over netlink socket
+ *   netlink.recv.syscalls : System calls made to receive messages
+ *   netlink.recv.messages : Messages received, possibly many per system call
  *   netlink.bytes.tx : Bytes sent over netlink socket
  *   netlink.notifications.link : Received link notifications
  *   netlink.notifications.addr : Received address notifications
  *   netlink.notifications.neighbors : Received neighbor notifications
  *   netlink.notifications.route : Received route notifications
+ *   netlink.notifications.batch_size : Average number of events per batch
+ *
+ * Events are published one by one on `netlinkEventsQ`. If `netlinkEventsBatchQ`
+ * is provided, events received in a poll cycle, i.e. one `recvmmsg` call, are
+ * instead published together as one batch. This amortizes the cost of queue
+ * operations and of waking up the reader over event storms, e.g. on reseat of
+ * line-card.
  */
 class NetlinkProtocolSocket : public folly::EventHandler {
  public:
   explicit NetlinkProtocolSocket(
       folly::EventBase* evb,
       messaging::ReplicateQueue<NetlinkEvent>& netlinkEventsQ,
-      bool enableIPv6RouteReplaceSemantics = false);
+      bool enableIPv6RouteReplaceSemantics = false,
+      messaging::ReplicateQueue<NetlinkEvents>* netlinkEventsBatchQ = nullptr);
 
   virtual ~NetlinkProtocolSocket();
 
@@ -142,6 +171,48 @@ class NetlinkProtocolSocket : public folly::EventHandler {
    */
   virtual folly::SemiFuture<int> deleteRoute(const openr::fbnl::Route& route);
 
+  /**
+   * Bulk versions of addRoute and deleteRoute. Every route is sent in its own
+   * netlink message with the same semantics as of the single route APIs, but
+   * completion of all of them is reported through one SemiFuture instead of
+   * one per route. Messages are enqueued at once.
+   *
+   * @returns return status of every route, in order of given routes. 0 on
+   *          success else appropriate system error code
+   */
+  virtual folly::SemiFuture<std::vector<int>> addRoutes(
+      const std::vector<openr::fbnl::Route>& routes);
+  virtual folly::SemiFuture<std::vector<int>> deleteRoutes(
+      const std::vector<openr::fbnl::Route>& routes);
+
+  /**
+   * Add or replace kernel nexthop object of single next-hop (Linux 5.3+).
+   * Routes refer to objects via `Route::setNextHopId(...)`. Requests are
+   * processed in order of calls, hence an object can be referred to by routes
+   * right after the call.
+   *
+   * @returns 0 on success else appropriate system error code
+   */
+  virtual folly::SemiFuture<int> addNextHopObject(
+      uint32_t id, const openr::fbnl::NextHop& nextHop);
+
+  /**
+   * Add or replace kernel nexthop object of group of nexthop objects with
+   * given weights. Replacing group updates all routes referring to it.
+   *
+   * @returns 0 on success else appropriate system error code
+   */
+  virtual folly::SemiFuture<int> addNextHopGroupObject(
+      uint32_t id, const std::vector<std::pair<uint32_t, uint16_t>>& members);
+
+  /**
+   * Delete kernel nexthop or group object. NOTE: Kernel deletes routes still
+   * referring to the object
+   *
+   * @returns 0 on success else appropriate system error code
+   */
+  virtual folly::SemiFuture<int> deleteNextHopObject(uint32_t id);
+
   /**
    * Add an address to the interface
    *
@@ -158,6 +229,18 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   virtual folly::SemiFuture<int> deleteIfAddress(
       const openr::fbnl::IfAddress& ifAddr);
 
+  /**
+   * Bulk versions of addIfAddress and deleteIfAddress, completion of all
+   * addresses is reported through one SemiFuture like for addRoutes.
+   *
+   * @returns return status of every address, in order of given addresses. 0
+   *          on success else appropriate system error code
+   */
+  virtual folly::SemiFuture<std::vector<int>> addIfAddresses(
+      const std::vector<openr::fbnl::IfAddress>& ifAddrs);
+  virtual folly::SemiFuture<std::vector<int>> deleteIfAddresses(
+      const std::vector<openr::fbnl::IfAddress>& ifAddrs);
+
   /**
    * API to get interfaces from kernel
    */
@@ -201,6 +284,22 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   virtual folly::SemiFuture<folly::Expected<std::vector<fbnl::Route>, int>>
   getMplsRoutes(uint8_t protocolId);
 
+  /**
+   * Streaming alternative of getRoutes(...) for reading large route tables.
+   * Visitor is invoked for every route matching the filter with a view
+   * parsing the route message in place, instead of accumulating fbnl::Route
+   * objects. Visitor is invoked on the netlink event thread, hence must be
+   * cheap and must not block on other netlink requests.
+   *
+   * @returns 0 on success else appropriate system error code
+   */
+  virtual folly::SemiFuture<int> visitRoutes(
+      const fbnl::Route& filter, RouteVisitor visitor);
+  folly::SemiFuture<int> visitIPv4Routes(
+      uint8_t protocolId, RouteVisitor visitor);
+  folly::SemiFuture<int> visitIPv6Routes(
+      uint8_t protocolId, RouteVisitor visitor);
+
   /**
    * Utility function to accumulate result of multiple requests into one. The
    * result will be 0 if all the futures are successful else it will contains
@@ -210,6 +309,26 @@ class NetlinkProtocolSocket : public folly::EventHandler {
       std::vector<folly::SemiFuture<int>>&& futures,
       std::unordered_set<int> ignoredErrors = {});
 
+  /**
+   * Number of times events may have been lost, i.e. on receive buffer overrun
+   * (`ENOBUFS`), truncated messages or re-creation of socket. Consumers
+   * keeping state from events must resync with a full dump once it changes.
+   * Safe to call from any thread.
+   */
+  uint64_t
+  getEventsLostCount() const {
+    return eventsLostCount_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Whether kernel filters route dumps by protocol, table and type, see
+   * `NETLINK_GET_STRICT_CHK`. Routes are returned filtered either way
+   */
+  bool
+  isStrictCheckEnabled() const {
+    return strictCheckEnabled_;
+  }
+
  protected:
   // Initialize netlink socket and add to eventloop for polling
   virtual void init();
@@ -230,8 +349,8 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   // Send a message batch to netlink socket from queue_
   void sendNetlinkMessage();
 
-  // Receive messages from netlink socket. Invoke `processMessage` for every
-  // message received.
+  // Receive a batch of messages from netlink socket with `recvmmsg`. Invoke
+  // `processMessage` for every message received.
   void recvNetlinkMessage();
 
   // Process received netlink message. Set return values for pending requests
@@ -239,10 +358,34 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   void processMessage(
       const std::array<char, kMaxNlPayloadSize>& rxMsg, uint32_t bytesRead);
 
+  // Publish event right away or add it to the pending batch
+  void publishEvent(NetlinkEvent&& event);
+
+  // Publish pending batch of events if any
+  void publishEventBatch();
+
   // Process ack message. Set return status on pending requests in nlSeqNumMap_
   // Resume sending messages from queue_ if any pending
   void processAck(uint32_t ack, int status);
 
+  // Grow window of in-flight messages by kMinIovMsg
+  void increaseSendWindow();
+
+  // Halve window of in-flight messages, at most once per window of messages
+  // sent, i.e. messages sent before the last decrease are not accounted
+  void decreaseSendWindow(std::chrono::steady_clock::time_point sendTs);
+
+  /**
+   * Initialize route message to add or delete route
+   * @returns 0 on success else appropriate system error code
+   */
+  int initAddRouteMessage(NetlinkRouteMessage& rtmMsg, const Route& route);
+  int initDeleteRouteMessage(NetlinkRouteMessage& rtmMsg, const Route& route);
+
+  // Enqueue bulk request of RTM_NEWADDR or RTM_DELADDR messages
+  folly::SemiFuture<std::vector<int>> addOrDeleteIfAddresses(
+      const std::vector<openr::fbnl::IfAddress>& ifAddrs, int type);
+
   // Event base for serializing read/write requests to netlink socket. Also
   // ensure thread safety of private member variables.
   folly::EventBase* evb_{nullptr};
@@ -250,6 +393,13 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   // Queue to publish LINK/ADDR/NEIGHBOR update received from kernel
   messaging::ReplicateQueue<NetlinkEvent>& netlinkEventsQueue_;
 
+  // Queue to publish batches of events instead if provided
+  messaging::ReplicateQueue<NetlinkEvents>* const netlinkEventsBatchQueue_{
+      nullptr};
+
+  // Events received in current poll cycle, published with publishEventBatch()
+  NetlinkEvents pendingEvents_;
+
   // Notification queue for thread safe enqueuing of messages from external
   // threads. All the messages enqueued are processed by the event thread.
   folly::NotificationQueue<std::unique_ptr<NetlinkMessage>> notifQueue_;
@@ -265,6 +415,9 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   // when no response is received for any of our pending requests.
   int nlSock_{-1};
 
+  // See getEventsLostCount()
+  std::atomic<uint64_t> eventsLostCount_{0};
+
   // nl_pid stands for port-ID and not process-ID. Netlink sockets are bound on
   // this specified port. This must be unique for every netlink socket that
   // is created on the system. Ironically kernel assigns the process-ID as the
@@ -272,6 +425,13 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   // netlink sockets created by process gets assigned some unique-ID.
   uint32_t portId_{UINT_MAX};
 
+  // See isStrictCheckEnabled(). Set in init()
+  std::atomic<bool> strictCheckEnabled_{false};
+
+  // Buffers for receiving a batch of messages
+  std::vector<std::array<char, kMaxNlPayloadSize>> recvBuffers_ =
+      std::vector<std::array<char, kMaxNlPayloadSize>>(kNlRecvBatchSize);
+
   // Next available sequence number to use. It is possible to wrap this around,
   // and should be fine. We put hard check to avoid conflict between pending
   // seq number with next sequence number.
@@ -298,6 +458,12 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   // corresponding entry from this map.
   std::unordered_map<uint32_t, std::shared_ptr<NetlinkMessage>> nlSeqNumMap_;
 
+  // Window of in-flight messages, see kMaxIovMsg. Number of messages acked
+  // within latency target since last resize, and time of last decrease
+  size_t sendWindow_{kInitIovMsg};
+  size_t numAckedInWindow_{0};
+  std::chrono::steady_clock::time_point lastWindowDecreaseTs_{};
+
   // Timer to help keep track of timeout of messages sent to kernel. It also
   // ensures the aliveness of the netlink socket-fd. Timer is
   // - Started when a new message is sent
@@ -55,6 +55,29 @@ NetlinkRouteMessage::rcvdRoute(Route&& route) {
   rcvdRoutes_.emplace_back(std::move(route));
 }
 
+void
+NetlinkRouteMessage::rcvdRouteView(const RouteView& route) {
+  if (not visitor_) {
+    rcvdRoute(parseMessage(route.getMessage()));
+    return;
+  }
+
+  // Same application side filters as of rcvdRoute(...)
+  if (filters_.table && filters_.table != route.getRouteTable()) {
+    return; // ignore the route
+  }
+
+  if (filters_.protocol && filters_.protocol != route.getProtocolId()) {
+    return; // ignore the route
+  }
+
+  if (filters_.type && filters_.type != route.getType()) {
+    return; // ignore the route
+  }
+
+  visitor_(route);
+}
+
 void
 NetlinkRouteMessage::setReturnStatus(int status) {
   if (status == 0) {
@@ -80,9 +103,9 @@ NetlinkRouteMessage::init(int type, uint32_t rtFlags, const Route& route) {
   if (type == RTM_GETROUTE) {
     // Get routes matching subsequent criteria specified below
     msghdr_->nlmsg_flags |= NLM_F_DUMP;
-    // NOTE - Only `rtmsg_->rtm_family` will be used by kernel as filter
-    // parameter. Other parameters such as table, protocol, scope, type will
-    // need to be filtered on user side.
+    // NOTE - With `NETLINK_GET_STRICT_CHK` enabled on socket kernel filters
+    // dump by family, table, protocol and type of `rtmsg_`, otherwise only by
+    // family. Filters are applied on user side as well for older kernels
     filters_.table = route.getRouteTable();
     filters_.type = route.getType();
     filters_.protocol = route.getProtocolId();
@@ -615,6 +638,13 @@ NetlinkRouteMessage::parseMessage(const struct nlmsghdr* nlmsg) {
       routeBuilder.setPriority(*(reinterpret_cast<int*> RTA_DATA(routeAttr)));
     } break;
 
+    case RTA_NH_ID: {
+      // route refers to kernel nexthop object. Kernel reports next-hops of
+      // the object as well unless nexthop compat mode is turned off
+      routeBuilder.setNextHopId(
+          *(reinterpret_cast<uint32_t*> RTA_DATA(routeAttr)));
+    } break;
+
     // Nexthop attributes
     case RTA_GATEWAY:
     case RTA_OIF:
@@ -668,6 +698,17 @@ std::vector<NextHop>
 NetlinkRouteMessage::parseNextHops(
     const struct rtattr* routeAttrMP, unsigned char family) {
   std::vector<NextHop> nextHops;
+  forEachNextHop(routeAttrMP, family, [&nextHops](const NextHop& nexthop) {
+    nextHops.emplace_back(nexthop);
+  });
+  return nextHops;
+}
+
+void
+NetlinkRouteMessage::forEachNextHop(
+    const struct rtattr* routeAttrMP,
+    unsigned char family,
+    folly::FunctionRef<void(const NextHop&)> callback) {
   struct rtnexthop* nh =
       reinterpret_cast<struct rtnexthop*> RTA_DATA(routeAttrMP);
 
@@ -696,12 +737,158 @@ NetlinkRouteMessage::parseNextHops(
       nhBuilder.setWeight(nh->rtnh_hops + 1);
     }
     setMplsAction(nhBuilder, family);
-    auto nexthop = nhBuilder.build();
-    nextHops.emplace_back(nexthop);
+    callback(nhBuilder.build());
     nhLen -= NLMSG_ALIGN(nh->rtnh_len);
     nh = RTNH_NEXT(nh);
   } while (RTNH_OK(nh, nhLen));
-  return nextHops;
+}
+
+RouteView::RouteView(const struct nlmsghdr* nlmsg)
+    : nlmsg_(nlmsg),
+      rtmsg_(reinterpret_cast<const struct rtmsg*>(NLMSG_DATA(nlmsg))) {}
+
+uint8_t
+RouteView::getFamily() const {
+  return route_ ? route_->getFamily() : rtmsg_->rtm_family;
+}
+
+uint8_t
+RouteView::getRouteTable() const {
+  return route_ ? route_->getRouteTable() : rtmsg_->rtm_table;
+}
+
+uint8_t
+RouteView::getProtocolId() const {
+  return route_ ? route_->getProtocolId() : rtmsg_->rtm_protocol;
+}
+
+uint8_t
+RouteView::getType() const {
+  return route_ ? route_->getType() : rtmsg_->rtm_type;
+}
+
+const struct rtattr*
+RouteView::findAttribute(unsigned short type) const {
+  const struct rtattr* routeAttr;
+  auto routeAttrLen = RTM_PAYLOAD(nlmsg_);
+  for (routeAttr = RTM_RTA(rtmsg_); RTA_OK(routeAttr, routeAttrLen);
+       routeAttr = RTA_NEXT(routeAttr, routeAttrLen)) {
+    if (routeAttr->rta_type == type) {
+      return routeAttr;
+    }
+  }
+  return nullptr;
+}
+
+std::optional<uint32_t>
+RouteView::getPriority() const {
+  if (route_) {
+    return route_->getPriority();
+  }
+  const auto priorityAttr = findAttribute(RTA_PRIORITY);
+  if (not priorityAttr) {
+    return std::nullopt;
+  }
+  return *(reinterpret_cast<const uint32_t*> RTA_DATA(priorityAttr));
+}
+
+std::optional<uint32_t>
+RouteView::getNextHopId() const {
+  if (route_) {
+    return route_->getNextHopId();
+  }
+  const auto nhIdAttr = findAttribute(RTA_NH_ID);
+  if (not nhIdAttr) {
+    return std::nullopt;
+  }
+  return *(reinterpret_cast<const uint32_t*> RTA_DATA(nhIdAttr));
+}
+
+folly::CIDRNetwork
+RouteView::getDestination() const {
+  if (route_) {
+    return route_->getDestination();
+  }
+  const auto dstAttr = findAttribute(RTA_DST);
+  if (dstAttr) {
+    auto ipAddress = NetlinkRouteMessage::parseIp(dstAttr, rtmsg_->rtm_family);
+    if (ipAddress.hasValue()) {
+      return {ipAddress.value(), rtmsg_->rtm_dst_len};
+    }
+  }
+  // Default route might be missing RTA_DST attribute
+  if (rtmsg_->rtm_family == AF_INET) {
+    return {folly::IPAddressV4("0.0.0.0"), 0};
+  }
+  return {folly::IPAddressV6("::"), 0};
+}
+
+std::optional<uint32_t>
+RouteView::getMplsLabel() const {
+  if (route_) {
+    return route_->getMplsLabel();
+  }
+  const auto dstAttr = findAttribute(RTA_DST);
+  if (rtmsg_->rtm_family != AF_MPLS or not dstAttr) {
+    return std::nullopt;
+  }
+  const auto mplsLabel =
+      reinterpret_cast<const struct mpls_label*> RTA_DATA(dstAttr);
+  return ntohl(mplsLabel->entry) >> kLabelShift;
+}
+
+void
+RouteView::forEachNextHop(
+    folly::FunctionRef<void(const NextHop&)> callback) const {
+  if (route_) {
+    for (auto const& nh : route_->getNextHops()) {
+      callback(nh);
+    }
+    return;
+  }
+
+  // Report next-hop with push labels reversed as per thrift API definition,
+  // and skip empty next-hops as in NetlinkRouteMessage::parseMessage(...)
+  auto reportNextHop = [&callback](const NextHop& nh) {
+    if (not nh.getGateway().has_value() and not nh.getIfIndex().has_value()) {
+      return;
+    }
+    auto pushLabels = nh.getPushLabels();
+    if (not pushLabels.has_value()) {
+      callback(nh);
+      return;
+    }
+    NextHop reversedNh = nh;
+    std::reverse(pushLabels->begin(), pushLabels->end());
+    reversedNh.setPushLabels(std::move(*pushLabels));
+    callback(reversedNh);
+  };
+
+  NextHopBuilder nhBuilder;
+  const struct rtattr* routeAttr;
+  auto routeAttrLen = RTM_PAYLOAD(nlmsg_);
+  for (routeAttr = RTM_RTA(rtmsg_); RTA_OK(routeAttr, routeAttrLen);
+       routeAttr = RTA_NEXT(routeAttr, routeAttrLen)) {
+    switch (routeAttr->rta_type) {
+    case RTA_GATEWAY:
+    case RTA_OIF:
+    case RTA_VIA:
+    case RTA_ENCAP:
+    case RTA_NEWDST: {
+      NetlinkRouteMessage::parseNextHopAttribute(
+          routeAttr, rtmsg_->rtm_family, nhBuilder);
+    } break;
+
+    case RTA_MULTIPATH: {
+      NetlinkRouteMessage::forEachNextHop(
+          routeAttr, rtmsg_->rtm_family, reportNextHop);
+      return;
+    }
+    }
+  }
+
+  NetlinkRouteMessage::setMplsAction(nhBuilder, rtmsg_->rtm_family);
+  reportNextHop(nhBuilder.build());
 }
 
 int
@@ -736,6 +923,16 @@ NetlinkRouteMessage::addRoute(const Route& route) {
     }
   }
 
+  // refer to kernel nexthop object instead of encoding next-hops
+  if (route.getNextHopId().has_value()) {
+    const uint32_t nhId = route.getNextHopId().value();
+    return addAttributes(
+        RTA_NH_ID,
+        reinterpret_cast<const char*>(&nhId),
+        sizeof(uint32_t),
+        msghdr_);
+  }
+
   return addNextHops(route);
 }
 
@@ -754,7 +951,19 @@ NetlinkRouteMessage::deleteRoute(const Route& route) {
   rtmsg_->rtm_family = addressFamily;
   rtmsg_->rtm_dst_len = plen; /* netmask */
   const char* const ipptr = reinterpret_cast<const char*>(ip.bytes());
-  return addAttributes(RTA_DST, ipptr, ip.byteCount(), msghdr_);
+  int status{0};
+  if ((status = addAttributes(RTA_DST, ipptr, ip.byteCount(), msghdr_))) {
+    return status;
+  }
+
+  // Delete route of specific admin distance if priority. Otherwise kernel
+  // deletes the first matching route of any priority
+  if (route.getPriority()) {
+    const uint32_t adminDistance = route.getPriority().value();
+    const char* const adPtr = reinterpret_cast<const char*>(&adminDistance);
+    return addAttributes(RTA_PRIORITY, adPtr, sizeof(uint32_t), msghdr_);
+  }
+  return 0;
 }
 
 int
@@ -854,7 +1063,8 @@ NetlinkLinkMessage::init(int type, uint32_t linkFlags) {
   ifinfomsg_ = reinterpret_cast<struct ifinfomsg*>((char*)msghdr_ + nlmsgAlen);
 
   ifinfomsg_->ifi_flags = linkFlags;
-  ifinfomsg_->ifi_change = 0xffffffff;
+  // NOTE: Strict checking of dump requests rejects non-zero change mask
+  ifinfomsg_->ifi_change = type == RTM_GETLINK ? 0 : 0xffffffff;
 }
 
 Link
@@ -1110,4 +1320,120 @@ NetlinkNeighborMessage::parseMessage(const struct nlmsghdr* nlmsg) {
   return neighbor;
 }
 
+NetlinkNextHopMessage::NetlinkNextHopMessage() {
+  // get pointer to NLMSG header
+  msghdr_ = getMessagePtr();
+}
+
+void
+NetlinkNextHopMessage::init(int type, unsigned char family) {
+  if (type != RTM_NEWNEXTHOP && type != RTM_DELNEXTHOP) {
+    LOG(ERROR) << "Incorrect Netlink message type";
+    return;
+  }
+  // initialize netlink header
+  msghdr_->nlmsg_len = NLMSG_LENGTH(sizeof(struct nhmsg));
+  msghdr_->nlmsg_type = type;
+  msghdr_->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+
+  if (type == RTM_NEWNEXTHOP) {
+    // We create new object or replace existing, routes referring to it are
+    // updated by kernel
+    msghdr_->nlmsg_flags |= NLM_F_CREATE;
+    msghdr_->nlmsg_flags |= NLM_F_REPLACE;
+  }
+
+  // intialize the nexthop message header
+  auto nlmsgAlen = NLMSG_ALIGN(sizeof(struct nlmsghdr));
+  nhmsg_ = reinterpret_cast<struct nhmsg*>((char*)msghdr_ + nlmsgAlen);
+  nhmsg_->nh_family = family;
+}
+
+int
+NetlinkNextHopMessage::addNextHop(uint32_t id, const NextHop& nextHop) {
+  if (nextHop.getLabelAction().has_value() or
+      nextHop.getPushLabels().has_value()) {
+    LOG(ERROR) << "MPLS next-hops are not supported as nexthop object";
+    return EINVAL;
+  }
+  // NOTE: Family of nexthop object is the one of the gateway. Interface only
+  // next-hops would need family of the routes using them
+  if (not nextHop.getIfIndex().has_value() or
+      not nextHop.getGateway().has_value()) {
+    LOG(ERROR) << "Gateway and interface are mandatory for nexthop object";
+    return EINVAL;
+  }
+
+  const auto gateway = nextHop.getGateway().value();
+  init(RTM_NEWNEXTHOP, gateway.family());
+
+  int status{0};
+  if ((status = addAttributes(
+           NHA_ID,
+           reinterpret_cast<const char*>(&id),
+           sizeof(uint32_t),
+           msghdr_))) {
+    return status;
+  }
+
+  const uint32_t oif = nextHop.getIfIndex().value();
+  if ((status = addAttributes(
+           NHA_OIF,
+           reinterpret_cast<const char*>(&oif),
+           sizeof(uint32_t),
+           msghdr_))) {
+    return status;
+  }
+
+  return addAttributes(
+      NHA_GATEWAY,
+      reinterpret_cast<const char*>(gateway.bytes()),
+      gateway.byteCount(),
+      msghdr_);
+}
+
+int
+NetlinkNextHopMessage::addNextHopGroup(
+    uint32_t id, const std::vector<std::pair<uint32_t, uint16_t>>& members) {
+  if (members.empty()) {
+    LOG(ERROR) << "Empty nexthop group";
+    return EINVAL;
+  }
+
+  init(RTM_NEWNEXTHOP, AF_UNSPEC);
+
+  int status{0};
+  if ((status = addAttributes(
+           NHA_ID,
+           reinterpret_cast<const char*>(&id),
+           sizeof(uint32_t),
+           msghdr_))) {
+    return status;
+  }
+
+  // kernel encodes weight 1-256 as 0-255
+  std::vector<struct nexthop_grp> group(members.size());
+  for (size_t i = 0; i < members.size(); ++i) {
+    const auto weight = std::max<uint16_t>(members.at(i).second, 1);
+    if (weight > 256) {
+      LOG(ERROR) << "Weight " << weight << " exceeds maximum of nexthop group";
+      return EINVAL;
+    }
+    group.at(i).id = members.at(i).first;
+    group.at(i).weight = weight - 1;
+  }
+  return addAttributes(
+      NHA_GROUP,
+      reinterpret_cast<const char*>(group.data()),
+      group.size() * sizeof(struct nexthop_grp),
+      msghdr_);
+}
+
+int
+NetlinkNextHopMessage::deleteNextHop(uint32_t id) {
+  init(RTM_DELNEXTHOP, AF_UNSPEC);
+  return addAttributes(
+      NHA_ID, reinterpret_cast<const char*>(&id), sizeof(uint32_t), msghdr_);
+}
+
 } // namespace openr::fbnl
@@ -9,6 +9,7 @@
 
 #include <linux/lwtunnel.h>
 #include <linux/mpls.h>
+#include <linux/nexthop.h>
 #include <linux/rtnetlink.h>
 #include <net/if_arp.h>
 #include <netinet/ether.h>
@@ -17,6 +18,7 @@
 
 #include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/Function.h>
 #include <folly/IPAddress.h>
 
 #include <openr/if/gen-cpp2/Network_types.h>
@@ -27,6 +29,10 @@
 #define MPLS_IPTUNNEL_DST 1
 #endif
 
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK 12
+#endif
+
 namespace openr::fbnl {
 
 constexpr uint16_t kMaxLabels{16};
@@ -35,6 +41,61 @@ constexpr uint32_t kLabelShift{12};
 constexpr uint32_t kLabelMask{0xFFFFF000};
 constexpr uint32_t kLabelSizeBits{20};
 
+/**
+ * Read-only view of a route in a netlink route message. Attributes are parsed
+ * in place on access, without building intermediate fbnl::Route objects or
+ * next-hop sets. The view is valid only as long as the message buffer, i.e.
+ * for the duration of the RouteVisitor call.
+ *
+ * View can also be backed by an fbnl::Route for non-kernel sources of routes,
+ * e.g. mocks.
+ */
+class RouteView final {
+ public:
+  explicit RouteView(const struct nlmsghdr* nlmsg);
+
+  explicit RouteView(const Route& route) : route_(&route) {}
+
+  // Underlying netlink message, nullptr if backed by fbnl::Route
+  const struct nlmsghdr*
+  getMessage() const {
+    return nlmsg_;
+  }
+
+  uint8_t getFamily() const;
+  uint8_t getRouteTable() const;
+  uint8_t getProtocolId() const;
+  uint8_t getType() const;
+  std::optional<uint32_t> getPriority() const;
+
+  // Destination of IPv4 or IPv6 route. Default route if not set
+  folly::CIDRNetwork getDestination() const;
+
+  // Top label of MPLS route
+  std::optional<uint32_t> getMplsLabel() const;
+
+  // ID of kernel nexthop object route refers to if any
+  std::optional<uint32_t> getNextHopId() const;
+
+  /**
+   * Invoke callback for every next-hop of route. Next-hops are same as of
+   * route returned by `NetlinkProtocolSocket::getRoutes(...)`, e.g. push
+   * labels are in order of thrift API.
+   */
+  void forEachNextHop(folly::FunctionRef<void(const NextHop&)> callback) const;
+
+ private:
+  // Find attribute of given type
+  const struct rtattr* findAttribute(unsigned short type) const;
+
+  const struct nlmsghdr* const nlmsg_{nullptr};
+  const struct rtmsg* const rtmsg_{nullptr};
+  const Route* const route_{nullptr};
+};
+
+// Visitor of routes retrieved from kernel, see RouteView
+using RouteVisitor = folly::Function<void(const RouteView&)>;
+
 /**
  * Message specialization for ROUTE object
  */
@@ -53,6 +114,14 @@ class NetlinkRouteMessage final : public NetlinkMessage {
     return routePromise_.getSemiFuture();
   }
 
+  // Invoke visitor on every route received in response to GET request
+  // instead of accumulating routes. Completion is reported with return status
+  // of getSemiFuture()
+  void
+  setRouteVisitor(RouteVisitor visitor) {
+    visitor_ = std::move(visitor);
+  }
+
   // initiallize route message with default params
   void init(int type, uint32_t flags, const Route& route);
 
@@ -102,6 +171,12 @@ class NetlinkRouteMessage final : public NetlinkMessage {
   static std::vector<NextHop> parseNextHops(
       const struct rtattr* routeAttrMultipath, unsigned char family);
 
+  // invoke callback for every next hop of RTA_MULTIPATH attribute
+  static void forEachNextHop(
+      const struct rtattr* routeAttrMultipath,
+      unsigned char family,
+      folly::FunctionRef<void(const NextHop&)> callback);
+
   // parse NextHop Attributes
   static void parseNextHopAttribute(
       const struct rtattr* routeAttr,
@@ -159,8 +234,12 @@ class NetlinkRouteMessage final : public NetlinkMessage {
   } __attribute__((__packed__));
 
  private:
+  friend class RouteView;
+
   void rcvdRoute(Route&& route) override;
 
+  void rcvdRouteView(const RouteView& route) override;
+
   struct {
     uint8_t table{0};
     uint8_t protocol{0};
@@ -169,6 +248,7 @@ class NetlinkRouteMessage final : public NetlinkMessage {
 
   folly::Promise<folly::Expected<std::vector<Route>, int>> routePromise_;
   std::vector<Route> rcvdRoutes_;
+  RouteVisitor visitor_{nullptr};
 };
 
 /**
@@ -286,4 +366,36 @@ class NetlinkNeighborMessage final : public NetlinkMessage {
   std::vector<Neighbor> rcvdNeighbors_;
 };
 
+/**
+ * Message specialization for NEXTHOP object (Linux 5.3+). Kernel nexthop
+ * objects are either a single next-hop or a group of weighted nexthop objects.
+ * Routes refer to them by ID (RTA_NH_ID), hence next-hops shared by many
+ * routes are programmed once and get updated without touching the routes.
+ */
+class NetlinkNextHopMessage final : public NetlinkMessage {
+ public:
+  NetlinkNextHopMessage();
+
+  // initiallize nexthop message with default params
+  void init(int type, unsigned char family);
+
+  // add or replace nexthop object of single IP next-hop. Only next-hops
+  // with gateway and interface and without MPLS action are supported
+  int addNextHop(uint32_t id, const NextHop& nextHop);
+
+  // add or replace group of nexthop objects with given weights
+  int addNextHopGroup(
+      uint32_t id, const std::vector<std::pair<uint32_t, uint16_t>>& members);
+
+  // delete nexthop or group object
+  int deleteNextHop(uint32_t id);
+
+ private:
+  // pointer to nexthop message header
+  struct nhmsg* nhmsg_{nullptr};
+
+  // pointer to the netlink message header
+  struct nlmsghdr* msghdr_{nullptr};
+};
+
 } // namespace openr::fbnl
@@ -17,6 +17,17 @@ const std::set<int> kNeighborReachableStates{
     NUD_REACHABLE, NUD_STALE, NUD_DELAY, NUD_PERMANENT, NUD_PROBE, NUD_NOARP};
 const int kIpAddrBufSize = 128;
 
+namespace {
+
+// Next-hops of routes without any. ATTN: intentionally leaked
+const NextHopSet&
+getEmptyNextHopSet() {
+  static const auto* empty = new NextHopSet();
+  return *empty;
+}
+
+} // namespace
+
 bool
 isNeighborReachable(int state) {
   return kNeighborReachableStates.count(state);
@@ -213,15 +224,44 @@ RouteBuilder::getRouteIfIndex() const {
 
 RouteBuilder&
 RouteBuilder::addNextHop(const NextHop& nextHop) {
-  nextHops_.emplace(nextHop);
+  if (not ownsNextHops_ or nextHops_.use_count() != 1) {
+    nextHops_ = nextHops_ ? std::make_shared<NextHopSet>(*nextHops_)
+                          : std::make_shared<NextHopSet>();
+    ownsNextHops_ = true;
+  }
+  // NOTE: safe as set was created non-const by builder and isn't shared
+  std::const_pointer_cast<NextHopSet>(nextHops_)->emplace(nextHop);
+  return *this;
+}
+
+RouteBuilder&
+RouteBuilder::setNextHops(std::shared_ptr<const NextHopSet> nextHops) {
+  nextHops_ = std::move(nextHops);
+  ownsNextHops_ = false;
   return *this;
 }
 
 const NextHopSet&
 RouteBuilder::getNextHops() const {
+  return nextHops_ ? *nextHops_ : getEmptyNextHopSet();
+}
+
+const std::shared_ptr<const NextHopSet>&
+RouteBuilder::getSharedNextHops() const {
   return nextHops_;
 }
 
+RouteBuilder&
+RouteBuilder::setNextHopId(uint32_t nextHopId) {
+  nextHopId_ = nextHopId;
+  return *this;
+}
+
+std::optional<uint32_t>
+RouteBuilder::getNextHopId() const {
+  return nextHopId_;
+}
+
 uint8_t
 RouteBuilder::getFamily() const {
   return family_;
@@ -250,8 +290,10 @@ RouteBuilder::reset() {
   tos_.reset();
   mtu_.reset();
   advMss_.reset();
-  nextHops_.clear();
+  nextHops_.reset();
+  ownsNextHops_ = false;
   routeIfName_.reset();
+  nextHopId_.reset();
 }
 
 Route::Route(const RouteBuilder& builder)
@@ -266,10 +308,11 @@ Route::Route(const RouteBuilder& builder)
       tos_(builder.getTos()),
       mtu_(builder.getMtu()),
       advMss_(builder.getAdvMss()),
-      nextHops_(builder.getNextHops()),
+      nextHops_(builder.getSharedNextHops()),
       dst_(builder.getDestination()),
       routeIfName_(builder.getRouteIfName()),
-      mplsLabel_(builder.getMplsLabel()) {}
+      mplsLabel_(builder.getMplsLabel()),
+      nextHopId_(builder.getNextHopId()) {}
 
 Route::~Route() {}
 
@@ -297,6 +340,7 @@ Route::operator=(Route&& other) noexcept {
   routeIfName_ = std::move(other.routeIfName_);
   family_ = std::move(other.family_);
   mplsLabel_ = std::move(other.mplsLabel_);
+  nextHopId_ = std::move(other.nextHopId_);
   return *this;
 }
 
@@ -324,6 +368,7 @@ Route::operator=(const Route& other) {
   routeIfName_ = other.routeIfName_;
   family_ = other.family_;
   mplsLabel_ = other.mplsLabel_;
+  nextHopId_ = other.nextHopId_;
   return *this;
 }
 
@@ -341,12 +386,18 @@ operator==(const Route& lhs, const Route& rhs) {
        lhs.getPriority() == rhs.getPriority() && lhs.getTos() == rhs.getTos() &&
        lhs.getMtu() == rhs.getMtu() && lhs.getAdvMss() == rhs.getAdvMss() &&
        lhs.getRouteIfName() == rhs.getRouteIfName() &&
+       lhs.getNextHopId() == rhs.getNextHopId() &&
        lhs.getFamily() == rhs.getFamily());
 
   if (!ret) {
     return false;
   }
 
+  // Shared next-hops are equal
+  if (lhs.getSharedNextHops() == rhs.getSharedNextHops()) {
+    return true;
+  }
+
   // Verify all nexthops are in each other (NOTE: size of nexthops are same)
   for (const NextHop& nh : lhs.getNextHops()) {
     if (!rhs.getNextHops().count(nh)) {
@@ -419,9 +470,24 @@ Route::getPriority() const {
 
 const NextHopSet&
 Route::getNextHops() const {
+  return nextHops_ ? *nextHops_ : getEmptyNextHopSet();
+}
+
+const std::shared_ptr<const NextHopSet>&
+Route::getSharedNextHops() const {
   return nextHops_;
 }
 
+std::optional<uint32_t>
+Route::getNextHopId() const {
+  return nextHopId_;
+}
+
+void
+Route::setNextHopId(std::optional<uint32_t> nextHopId) {
+  nextHopId_ = nextHopId;
+}
+
 std::optional<std::string>
 Route::getRouteIfName() const {
   return routeIfName_;
@@ -468,7 +534,10 @@ Route::str() const {
   if (advMss_) {
     result += folly::sformat(", advmss {}", advMss_.value());
   }
-  for (auto const& nextHop : nextHops_) {
+  if (nextHopId_) {
+    result += folly::sformat(", nhid {}", nextHopId_.value());
+  }
+  for (auto const& nextHop : getNextHops()) {
     result += "\n  " + nextHop.str();
   }
   return result;
@@ -481,7 +550,7 @@ Route::setPriority(uint32_t priority) {
 
 void
 Route::setNextHops(const NextHopSet& nextHops) {
-  nextHops_ = nextHops;
+  nextHops_ = std::make_shared<const NextHopSet>(nextHops);
 }
 
 /*=================================NextHop====================================*/
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -248,6 +249,17 @@ class RouteBuilder {
 
   RouteBuilder& addNextHop(const NextHop& nextHop);
 
+  // Share immutable set of next-hops, e.g. with other routes of the same
+  // next-hops, instead of adding them one by one. Replaces next-hops added
+  // so far, later addNextHop() copies the set
+  RouteBuilder& setNextHops(std::shared_ptr<const NextHopSet> nextHops);
+
+  // Refer to kernel nexthop object (nhid) instead of encoding next-hops
+  // inline. Next-hops if any are informational only
+  RouteBuilder& setNextHopId(uint32_t nextHopId);
+
+  std::optional<uint32_t> getNextHopId() const;
+
   RouteBuilder& setRouteIfName(const std::string& ifName);
 
   std::optional<std::string> getRouteIfName() const;
@@ -259,6 +271,9 @@ class RouteBuilder {
 
   const NextHopSet& getNextHops() const;
 
+  // Next-hops shared with routes built, nullptr if there are none
+  const std::shared_ptr<const NextHopSet>& getSharedNextHops() const;
+
   uint8_t getFamily() const;
 
   void reset();
@@ -275,11 +290,15 @@ class RouteBuilder {
   std::optional<uint8_t> tos_;
   std::optional<uint32_t> mtu_;
   std::optional<uint32_t> advMss_;
-  NextHopSet nextHops_;
+  // Shared with routes built from builder. Modified in place only while
+  // created and solely owned by the builder, copied on write otherwise
+  std::shared_ptr<const NextHopSet> nextHops_;
+  bool ownsNextHops_{false};
   folly::CIDRNetwork dst_;
   std::optional<int> routeIfIndex_; // for multicast or link route
   std::optional<std::string> routeIfName_; // for multicast or linkroute
   std::optional<uint32_t> mplsLabel_;
+  std::optional<uint32_t> nextHopId_;
 };
 
 class Route final {
@@ -320,12 +339,19 @@ class Route final {
 
   const NextHopSet& getNextHops() const;
 
+  // Next-hops shared with other routes, nullptr if there are none
+  const std::shared_ptr<const NextHopSet>& getSharedNextHops() const;
+
+  std::optional<uint32_t> getNextHopId() const;
+
   bool isValid() const;
 
   std::optional<std::string> getRouteIfName() const;
 
   void setPriority(uint32_t priority);
 
+  void setNextHopId(std::optional<uint32_t> nextHopId);
+
   std::string str() const;
 
   void setNextHops(const NextHopSet& nextHops);
@@ -342,10 +368,13 @@ class Route final {
   std::optional<uint8_t> tos_;
   std::optional<uint32_t> mtu_;
   std::optional<uint32_t> advMss_;
-  NextHopSet nextHops_;
+  // Immutable, shared with copies of route and routes of the same next-hops.
+  // nullptr if there are none
+  std::shared_ptr<const NextHopSet> nextHops_;
   folly::CIDRNetwork dst_;
   std::optional<std::string> routeIfName_;
   std::optional<uint32_t> mplsLabel_;
+  std::optional<uint32_t> nextHopId_;
 };
 
 bool operator==(const Route& lhs, const Route& rhs);
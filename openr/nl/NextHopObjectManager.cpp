@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include <openr/nl/NextHopObjectManager.h>
+
+namespace openr::fbnl {
+
+NextHopObjectManager::NextHopObjectManager(
+    NetlinkProtocolSocket* nlSock, bool enabled)
+    : nlSock_(nlSock), enabled_(enabled) {
+  CHECK_NOTNULL(nlSock);
+}
+
+NextHopObjectManager::RouteKey
+NextHopObjectManager::getRouteKey(const Route& route) {
+  return std::make_tuple(
+      route.getProtocolId(),
+      route.getPriority().value_or(0),
+      route.getDestination());
+}
+
+uint32_t
+NextHopObjectManager::allocateId(
+    uint32_t& nextId, std::vector<uint32_t>& freeIds) {
+  if (not freeIds.empty()) {
+    const auto id = freeIds.back();
+    freeIds.pop_back();
+    return id;
+  }
+  return nextId++;
+}
+
+uint32_t
+NextHopObjectManager::getNextHopObjectId(const NextHopKey& key) {
+  auto it = nextHops_.find(key);
+  if (it == nextHops_.end()) {
+    const auto id = allocateId(nextNextHopId_, freeNextHopIds_);
+    it = nextHops_.emplace(key, NextHopObject{id, 0}).first;
+    nextHopKeys_.emplace(id, key);
+  }
+  return it->second.id;
+}
+
+bool
+NextHopObjectManager::assign(Route& route) {
+  route.setNextHopId(std::nullopt);
+  const auto& nextHops = route.getNextHops();
+  bool isSupported = enabled_ and route.getType() == RTN_UNICAST and
+      (route.getFamily() == AF_INET or route.getFamily() == AF_INET6) and
+      not nextHops.empty();
+
+  // Next-hops must be distinct objects within group
+  std::vector<std::pair<NextHopKey, uint16_t>> members;
+  members.reserve(nextHops.size());
+  for (const auto& nh : nextHops) {
+    if (not isSupported) {
+      break;
+    }
+    if (nh.getLabelAction().has_value() or nh.getPushLabels().has_value() or
+        not nh.getGateway().has_value() or not nh.getIfIndex().has_value()) {
+      isSupported = false;
+      break;
+    }
+    // Weight 0 is default weight of 1
+    members.emplace_back(
+        NextHopKey(nh.getGateway().value(), nh.getIfIndex().value()),
+        std::max<uint16_t>(nh.getWeight(), 1));
+  }
+  std::sort(members.begin(), members.end());
+  if (std::adjacent_find(
+          members.begin(), members.end(), [](const auto& a, const auto& b) {
+            return a.first == b.first;
+          }) != members.end()) {
+    isSupported = false;
+  }
+
+  if (not isSupported) {
+    release(route);
+    return false;
+  }
+
+  // Program member objects ahead of the group
+  GroupMembers groupMembers;
+  groupMembers.reserve(members.size());
+  for (const auto& [key, weight] : members) {
+    const auto id = getNextHopObjectId(key);
+    if (programmed_.insert(id).second) {
+      NextHopBuilder nhBuilder;
+      nhBuilder.setGateway(key.first).setIfIndex(key.second);
+      nlSock_->addNextHopObject(id, nhBuilder.build());
+    }
+    groupMembers.emplace_back(id, weight);
+  }
+  std::sort(groupMembers.begin(), groupMembers.end());
+
+  auto groupIt = groups_.find(groupMembers);
+  if (groupIt == groups_.end()) {
+    const auto id = allocateId(nextGroupId_, freeGroupIds_);
+    for (const auto& [memberId, _] : groupMembers) {
+      ++nextHops_.at(nextHopKeys_.at(memberId)).refCount;
+    }
+    groupMembers_.emplace(id, groupMembers);
+    groupIt =
+        groups_.emplace(std::move(groupMembers), GroupObject{id, 0}).first;
+  }
+  auto& group = groupIt->second;
+  if (programmed_.insert(group.id).second) {
+    nlSock_->addNextHopGroupObject(group.id, groupIt->first);
+  }
+
+  // Reference group before releasing the previous one of route, which may be
+  // the same
+  ++group.refCount;
+  auto [routeIt, inserted] = routeGroups_.emplace(getRouteKey(route), group.id);
+  if (not inserted) {
+    releaseGroup(routeIt->second);
+    routeIt->second = group.id;
+  }
+
+  // NOTE: Failure to program objects fails programming of route referring to
+  // them, hence status of object requests is not tracked separately
+  route.setNextHopId(group.id);
+  return true;
+}
+
+void
+NextHopObjectManager::release(const Route& route) {
+  auto it = routeGroups_.find(getRouteKey(route));
+  if (it == routeGroups_.end()) {
+    return;
+  }
+  releaseGroup(it->second);
+  routeGroups_.erase(it);
+}
+
+void
+NextHopObjectManager::releaseAll(uint8_t protocolId) {
+  for (auto it = routeGroups_.begin(); it != routeGroups_.end();) {
+    if (std::get<0>(it->first) != protocolId) {
+      ++it;
+      continue;
+    }
+    releaseGroup(it->second);
+    it = routeGroups_.erase(it);
+  }
+}
+
+void
+NextHopObjectManager::releaseGroup(uint32_t groupId) {
+  auto& group = groups_.at(groupMembers_.at(groupId));
+  CHECK_GT(group.refCount, 0);
+  if (--group.refCount == 0) {
+    unusedGroups_.insert(groupId);
+  }
+}
+
+void
+NextHopObjectManager::deleteUnused() {
+  // NOTE: Failure to delete object leaves it unused in kernel. It doesn't
+  // affect routes, hence status of requests is ignored
+  for (const auto groupId : unusedGroups_) {
+    auto membersIt = groupMembers_.find(groupId);
+    auto groupIt = groups_.find(membersIt->second);
+    if (groupIt->second.refCount) {
+      // Referred to again after it got released
+      continue;
+    }
+    nlSock_->deleteNextHopObject(groupId);
+    programmed_.erase(groupId);
+    freeGroupIds_.emplace_back(groupId);
+
+    // Delete member objects after the group
+    for (const auto& [memberId, _] : membersIt->second) {
+      auto keyIt = nextHopKeys_.find(memberId);
+      auto nhIt = nextHops_.find(keyIt->second);
+      if (--nhIt->second.refCount) {
+        continue;
+      }
+      nlSock_->deleteNextHopObject(memberId);
+      programmed_.erase(memberId);
+      freeNextHopIds_.emplace_back(memberId);
+      nextHops_.erase(nhIt);
+      nextHopKeys_.erase(keyIt);
+    }
+    groups_.erase(groupIt);
+    groupMembers_.erase(membersIt);
+  }
+  unusedGroups_.clear();
+}
+
+void
+NextHopObjectManager::invalidate() {
+  programmed_.clear();
+}
+
+} // namespace openr::fbnl
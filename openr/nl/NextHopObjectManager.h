@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <folly/IPAddress.h>
+
+#include <openr/nl/NetlinkProtocolSocket.h>
+#include <openr/nl/NetlinkTypes.h>
+
+namespace openr::fbnl {
+
+// IDs of nexthop and group objects are allocated from disjoint ranges, kernel
+// doesn't allow to replace an object of one kind with the other
+constexpr uint32_t kMinNextHopObjectId{0x10000000};
+constexpr uint32_t kMinNextHopGroupObjectId{0x20000000};
+
+/**
+ * Manages kernel nexthop objects (Linux 5.3+) of unicast routes. Every
+ * distinct next-hop is programmed once as nexthop object and every distinct
+ * set of weighted next-hops once as group object. Routes refer to their group
+ * by ID (nhid) instead of encoding next-hops inline, hence kernel keeps a
+ * single copy of next-hops shared by many routes.
+ *
+ * Objects are reference counted by routes, and deleted once no longer used.
+ * All requests go through the same NetlinkProtocolSocket, which processes
+ * them in order. Hence routes can refer to objects right after `assign` and
+ * objects are deleted only after routes stopped referring to them.
+ *
+ * Routes with next-hops that are not supported as objects, e.g. MPLS
+ * push or interface only next-hops, are left for inline encoding.
+ *
+ * NOTE: Not thread-safe. Calls must be serialized along with the programming
+ * of the routes
+ */
+class NextHopObjectManager final {
+ public:
+  NextHopObjectManager(NetlinkProtocolSocket* nlSock, bool enabled);
+
+  /**
+   * Refer route to group object of its next-hops. Objects not yet in kernel
+   * are programmed. Group previously assigned to the route of same protocol,
+   * priority and destination is released.
+   *
+   * @returns false and resets nexthop ID of route if disabled or next-hops
+   *          can't be objects
+   */
+  bool assign(Route& route);
+
+  // Release group of the route, e.g. on deletion of route
+  void release(const Route& route);
+
+  // Release groups of all routes of the protocol, e.g. ahead of full sync
+  void releaseAll(uint8_t protocolId);
+
+  // Delete objects no longer used by any route. Must be called after routes
+  // stopped referring to them got programmed
+  void deleteUnused();
+
+  // Re-program objects on their next use, e.g. on full sync as kernel
+  // removes objects along with their interface
+  void invalidate();
+
+  bool
+  isEnabled() const {
+    return enabled_;
+  }
+
+  // Number of group objects in use
+  size_t
+  getNumGroups() const {
+    return groups_.size();
+  }
+
+ private:
+  // Next-hop without weight, i.e. <gateway, ifIndex>
+  using NextHopKey = std::pair<folly::IPAddress, int>;
+
+  // Sorted list of <nexthop object ID, weight>
+  using GroupMembers = std::vector<std::pair<uint32_t, uint16_t>>;
+
+  // <protocol, priority, destination> as routes are keyed in kernel
+  using RouteKey = std::tuple<uint8_t, uint32_t, folly::CIDRNetwork>;
+
+  struct NextHopObject {
+    uint32_t id{0};
+    // number of groups referring to the object
+    size_t refCount{0};
+  };
+
+  struct GroupObject {
+    uint32_t id{0};
+    // number of routes referring to the group
+    size_t refCount{0};
+  };
+
+  static RouteKey getRouteKey(const Route& route);
+
+  // Get ID of nexthop object, allocating one if there is none
+  uint32_t getNextHopObjectId(const NextHopKey& key);
+
+  // Decrement reference count of group, group is deleted with deleteUnused()
+  void releaseGroup(uint32_t groupId);
+
+  static uint32_t allocateId(uint32_t& nextId, std::vector<uint32_t>& freeIds);
+
+  NetlinkProtocolSocket* const nlSock_{nullptr};
+  const bool enabled_{false};
+
+  std::map<NextHopKey, NextHopObject> nextHops_;
+  std::unordered_map<uint32_t, NextHopKey> nextHopKeys_;
+  std::map<GroupMembers, GroupObject> groups_;
+  std::unordered_map<uint32_t, GroupMembers> groupMembers_;
+
+  // Group referred to by every route
+  std::map<RouteKey, uint32_t> routeGroups_;
+
+  // Groups released by all routes, candidates for deletion
+  std::unordered_set<uint32_t> unusedGroups_;
+
+  // Objects programmed in kernel since last invalidate()
+  std::unordered_set<uint32_t> programmed_;
+
+  uint32_t nextNextHopId_{kMinNextHopObjectId};
+  uint32_t nextGroupId_{kMinNextHopGroupObjectId};
+  std::vector<uint32_t> freeNextHopIds_;
+  std::vector<uint32_t> freeGroupIds_;
+};
+
+} // namespace openr::fbnl
@@ -552,6 +552,28 @@ TEST(NetlinkRouteMessage, EncodeLabel) {
   }
 }
 
+/**
+ * Buffer of destroyed message is recycled and zeroed when reused
+ */
+TEST(NetlinkBufferPool, RecycleBuffer) {
+  {
+    NetlinkRouteMessage msg;
+    msg.msg->fill('x');
+    msg.setReturnStatus(0);
+  }
+  const auto numIdle = fbnl::NetlinkBufferPool::numIdle();
+  EXPECT_LT(0, numIdle);
+
+  auto buffer = fbnl::NetlinkBufferPool::get();
+  EXPECT_EQ(numIdle - 1, fbnl::NetlinkBufferPool::numIdle());
+  for (auto c : *buffer) {
+    ASSERT_EQ(0, c);
+  }
+
+  buffer.reset();
+  EXPECT_EQ(numIdle, fbnl::NetlinkBufferPool::numIdle());
+}
+
 /**
  * This test intends to test the delayed looping of event-base. Request is
  * made before event loop is started. This will help ensuring that socket
@@ -787,6 +809,50 @@ TEST_F(NlMessageFixture, NeighborEventPublication) {
   EXPECT_EQ(neighV4.getIfIndex(), neighV6.getIfIndex());
 }
 
+/*
+ * Spawn RQueue of `NetlinkEvents` on socket in batch mode to verify:
+ *  1) LINK_EVENT(DOWN) of different interfaces is populated in batches;
+ *  2) events are not published on per event queue;
+ */
+TEST_F(NlMessageFixture, LinkEventBatchPublication) {
+  folly::EventBase batchEvb;
+  messaging::ReplicateQueue<openr::fbnl::NetlinkEvent> batchEventsQ;
+  messaging::ReplicateQueue<openr::fbnl::NetlinkEvents> batchesQ;
+  auto batchEventsReader = batchEventsQ.getReader();
+  auto batchesReader = batchesQ.getReader();
+
+  // netlink protocol socket in batch mode
+  auto batchNlSock = std::make_unique<NetlinkProtocolSocket>(
+      &batchEvb, batchEventsQ, false, &batchesQ);
+  std::thread batchEvbThread([&]() { batchEvb.loopForever(); });
+  batchEvb.waitUntilRunning();
+
+  // bring DOWN link to trigger link DOWN event
+  bringDownIntf(kVethNameX);
+  bringDownIntf(kVethNameY);
+
+  std::unordered_map<std::string, openr::fbnl::Link> linkEntryMap;
+  while (linkEntryMap.size() < 2) {
+    auto batch = batchesReader.get(); // perform read
+    ASSERT_TRUE(batch.hasValue());
+    EXPECT_FALSE(batch->empty());
+    for (auto& event : batch.value()) {
+      if (auto* link = std::get_if<openr::fbnl::Link>(&event)) {
+        linkEntryMap.emplace(link->getLinkName(), *link);
+      }
+    }
+  }
+  EXPECT_FALSE(linkEntryMap.at(kVethNameX).isUp());
+  EXPECT_FALSE(linkEntryMap.at(kVethNameY).isUp());
+  EXPECT_EQ(0, batchEventsReader.size());
+
+  batchEvb.terminateLoopSoon();
+  batchEvbThread.join();
+  batchNlSock.reset();
+  batchEventsQ.close();
+  batchesQ.close();
+}
+
 TEST_F(NlMessageFixture, IpRouteSingleNextHop) {
   // Add IPv6 route with one next hop and no labels
   // outoing IF is vethTestY
@@ -1295,6 +1361,126 @@ TEST_F(NlMessageFixture, MultipleIpRoutesLabelNexthop) {
   EXPECT_EQ(0, kernelRoutes.size());
 }
 
+TEST_F(NlMessageFixture, BulkIpRoutes) {
+  // Add and delete IPv6 routes with bulk APIs, one status per route
+  uint32_t ackCount{0};
+  uint32_t count{10000};
+  const auto routes = buildV6RouteDb(count);
+
+  ackCount = getAckCount();
+  {
+    auto statuses = nlSock->addRoutes(routes).get();
+    ASSERT_EQ(count, statuses.size());
+    for (auto status : statuses) {
+      EXPECT_EQ(0, status);
+    }
+  }
+  EXPECT_EQ(0, getErrorCount());
+  EXPECT_GE(getAckCount(), ackCount + count);
+
+  auto kernelRoutes = nlSock->getIPv6Routes(kRouteProtoId).get().value();
+  EXPECT_EQ(kernelRoutes.size(), routes.size());
+  EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, routes), count);
+
+  // delete routes
+  ackCount = getAckCount();
+  {
+    auto statuses = nlSock->deleteRoutes(routes).get();
+    ASSERT_EQ(count, statuses.size());
+    for (auto status : statuses) {
+      EXPECT_EQ(0, status);
+    }
+  }
+  EXPECT_EQ(0, getErrorCount());
+  EXPECT_GE(getAckCount(), ackCount + count);
+
+  kernelRoutes = nlSock->getIPv6Routes(kRouteProtoId).get().value();
+  EXPECT_EQ(0, kernelRoutes.size());
+
+  // empty bulk request completes immediately
+  EXPECT_TRUE(nlSock->addRoutes({}).get().empty());
+}
+
+TEST_F(NlMessageFixture, FilteredRouteDumps) {
+  // Routes of other protocol must not be returned for Open/R protocol,
+  // whether kernel or user side filters the dump
+  const uint8_t kOtherProtoId = kRouteProtoId + 1;
+  const uint32_t count{100};
+  const auto routes = buildV6RouteDb(count);
+  std::vector<fbnl::Route> otherRoutes;
+  const auto allRoutes = buildV6RouteDb(2 * count);
+  for (size_t i = count; i < allRoutes.size(); ++i) {
+    const auto& route = allRoutes.at(i);
+    std::vector<openr::fbnl::NextHop> paths(
+        route.getNextHops().begin(), route.getNextHops().end());
+    otherRoutes.emplace_back(buildRoute(
+        kOtherProtoId, route.getDestination(), folly::none, paths));
+  }
+  for (auto status : nlSock->addRoutes(routes).get()) {
+    EXPECT_EQ(0, status);
+  }
+  for (auto status : nlSock->addRoutes(otherRoutes).get()) {
+    EXPECT_EQ(0, status);
+  }
+
+  LOG(INFO) << "Strict checking enabled: " << nlSock->isStrictCheckEnabled();
+  auto kernelRoutes = nlSock->getIPv6Routes(kRouteProtoId).get().value();
+  EXPECT_EQ(count, kernelRoutes.size());
+  EXPECT_EQ(count, findRoutesInKernelRoutes(kernelRoutes, routes));
+  kernelRoutes = nlSock->getIPv6Routes(kOtherProtoId).get().value();
+  EXPECT_EQ(count, kernelRoutes.size());
+  EXPECT_EQ(count, findRoutesInKernelRoutes(kernelRoutes, otherRoutes));
+
+  // other dumps are accepted with strict checking too
+  EXPECT_TRUE(nlSock->getAllLinks().get().hasValue());
+  EXPECT_TRUE(nlSock->getAllIfAddresses().get().hasValue());
+  EXPECT_TRUE(nlSock->getAllNeighbors().get().hasValue());
+
+  for (auto status : nlSock->deleteRoutes(routes).get()) {
+    EXPECT_EQ(0, status);
+  }
+  for (auto status : nlSock->deleteRoutes(otherRoutes).get()) {
+    EXPECT_EQ(0, status);
+  }
+}
+
+TEST_F(NlMessageFixture, VisitIpRoutes) {
+  // Routes visited in place must be same as routes retrieved
+  const uint32_t count{1000};
+  const auto routes = buildV6RouteDb(count);
+  for (auto status : nlSock->addRoutes(routes).get()) {
+    EXPECT_EQ(0, status);
+  }
+
+  std::map<folly::CIDRNetwork, fbnl::NextHopSet> expectedRoutes;
+  for (auto const& route :
+       nlSock->getIPv6Routes(kRouteProtoId).get().value()) {
+    expectedRoutes.emplace(route.getDestination(), route.getNextHops());
+  }
+  EXPECT_EQ(count, expectedRoutes.size());
+
+  std::map<folly::CIDRNetwork, fbnl::NextHopSet> visitedRoutes;
+  auto status = nlSock
+                    ->visitIPv6Routes(
+                        kRouteProtoId,
+                        [&visitedRoutes](const fbnl::RouteView& route) {
+                          EXPECT_EQ(kRouteProtoId, route.getProtocolId());
+                          auto& nextHops =
+                              visitedRoutes[route.getDestination()];
+                          route.forEachNextHop(
+                              [&nextHops](const fbnl::NextHop& nh) {
+                                nextHops.insert(nh);
+                              });
+                        })
+                    .get();
+  EXPECT_EQ(0, status);
+  EXPECT_EQ(expectedRoutes, visitedRoutes);
+
+  for (auto retval : nlSock->deleteRoutes(routes).get()) {
+    EXPECT_EQ(0, retval);
+  }
+}
+
 TEST_F(NlMessageFixture, LabelRouteV4Nexthop) {
   // Add label route with single path label with PHP nexthop
 
@@ -1780,6 +1966,56 @@ TEST_F(NlMessageFixture, AddrScaleTest) {
   EXPECT_EQ(0, findAddressesInKernelAddresses(kernelAddresses, ifAddresses));
 }
 
+// Add and remove 250 IPv6 addresses with bulk requests
+TEST_F(NlMessageFixture, AddrBulkTest) {
+  const int addrCount{250};
+
+  int ifIndexX{-1};
+  for (const auto& link : nlSock->getAllLinks().get().value()) {
+    if (link.getLinkName() == kVethNameX) {
+      ifIndexX = link.getIfIndex();
+    }
+  }
+  EXPECT_NE(ifIndexX, -1);
+
+  std::vector<fbnl::IfAddress> ifAddresses;
+  for (int i = 0; i < addrCount; i++) {
+    openr::fbnl::IfAddressBuilder builder;
+    folly::CIDRNetwork prefix{
+        folly::IPAddress("face:d00d::" + std::to_string(i)), 128};
+    ifAddresses.emplace_back(builder.setPrefix(prefix)
+                                 .setIfIndex(ifIndexX)
+                                 .setScope(RT_SCOPE_UNIVERSE)
+                                 .setValid(true)
+                                 .build());
+  }
+
+  auto statuses = nlSock->addIfAddresses(ifAddresses).get();
+  ASSERT_EQ(addrCount, statuses.size());
+  for (auto status : statuses) {
+    EXPECT_EQ(0, status);
+  }
+  auto kernelAddresses = nlSock->getAllIfAddresses().get().value();
+  EXPECT_EQ(
+      addrCount, findAddressesInKernelAddresses(kernelAddresses, ifAddresses));
+
+  // adding again reports error of every address
+  for (auto status : nlSock->addIfAddresses(ifAddresses).get()) {
+    EXPECT_EQ(EEXIST, std::abs(status));
+  }
+
+  statuses = nlSock->deleteIfAddresses(ifAddresses).get();
+  ASSERT_EQ(addrCount, statuses.size());
+  for (auto status : statuses) {
+    EXPECT_EQ(0, status);
+  }
+  kernelAddresses = nlSock->getAllIfAddresses().get().value();
+  EXPECT_EQ(0, findAddressesInKernelAddresses(kernelAddresses, ifAddresses));
+
+  // empty bulk request completes immediately
+  EXPECT_TRUE(nlSock->deleteIfAddresses({}).get().empty());
+}
+
 TEST_F(NlMessageFixture, GetAllNeighbors) {
   // Add 100 neighbors and check if getAllReachableNeighbors
   // in NetlinkProtocolSocket returns the neighbors
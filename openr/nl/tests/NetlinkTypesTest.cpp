@@ -297,6 +297,53 @@ TEST(NetlinkTypes, RouteCopyTest) {
   EXPECT_EQ(route, route2);
 }
 
+TEST(NetlinkTypes, RouteSharedNextHopsTest) {
+  folly::CIDRNetwork dst1{folly::IPAddress("fc00:cafe:3::3"), 128};
+  folly::CIDRNetwork dst2{folly::IPAddress("fc00:cafe:3::4"), 128};
+  NextHopBuilder nhBuilder;
+  auto nh1 = nhBuilder.setIfIndex(kIfIndex)
+                 .setGateway(folly::IPAddress("face:cafe:3::3"))
+                 .build();
+  nhBuilder.reset();
+  auto nh2 = nhBuilder.setIfIndex(kIfIndex)
+                 .setGateway(folly::IPAddress("face:cafe:3::4"))
+                 .build();
+
+  // Route without next-hops
+  RouteBuilder builder;
+  auto route = builder.setDestination(dst1).build();
+  EXPECT_EQ(nullptr, route.getSharedNextHops());
+  EXPECT_TRUE(route.getNextHops().empty());
+
+  // Copies of route share next-hops
+  route = builder.addNextHop(nh1).build();
+  fbnl::Route routeCopy(route);
+  EXPECT_EQ(route.getSharedNextHops(), routeCopy.getSharedNextHops());
+
+  // Adding next-hops after build doesn't modify built route
+  auto route2 = builder.addNextHop(nh2).build();
+  EXPECT_EQ(1, route.getNextHops().size());
+  EXPECT_EQ(2, route2.getNextHops().size());
+  EXPECT_NE(route.getSharedNextHops(), route2.getSharedNextHops());
+
+  // Routes of different destination share next-hops set
+  builder.reset();
+  auto route3 = builder.setDestination(dst2)
+                    .setNextHops(route2.getSharedNextHops())
+                    .build();
+  EXPECT_EQ(route2.getSharedNextHops(), route3.getSharedNextHops());
+  EXPECT_EQ(route2.getNextHops(), route3.getNextHops());
+
+  // Adding next-hop to shared set copies it
+  builder.reset();
+  auto route4 = builder.setDestination(dst2)
+                    .setNextHops(route.getSharedNextHops())
+                    .addNextHop(nh2)
+                    .build();
+  EXPECT_EQ(1, route.getNextHops().size());
+  EXPECT_EQ(route2.getNextHops(), route4.getNextHops());
+}
+
 TEST(NetlinkTypes, RouteOptionalParamTest) {
   folly::CIDRNetwork dst{folly::IPAddress("fc00:cafe:3::3"), 128};
   uint32_t flags = 0x01;
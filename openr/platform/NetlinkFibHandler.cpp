@@ -14,6 +14,7 @@
 #include <utility>
 
 #include <folly/Format.h>
+#include <fb303/ServiceData.h>
 #include <folly/gen/Base.h>
 
 #include <openr/common/NetworkUtil.h>
@@ -32,6 +33,110 @@ namespace {
 const uint8_t kMinRouteProtocolId = 17;
 const uint8_t kMaxRouteProtocolId = 253;
 
+// Split next-hops into primary and backup ones. Backup next-hops are used as
+// primary if there is no primary next-hop
+std::pair<
+    std::vector<thrift::NextHopThrift>,
+    std::vector<thrift::NextHopThrift>>
+splitBackupNextHops(const std::vector<thrift::NextHopThrift>& nextHops) {
+  std::vector<thrift::NextHopThrift> primaryNextHops, backupNextHops;
+  for (auto const& nh : nextHops) {
+    (*nh.isBackup_ref() ? backupNextHops : primaryNextHops).emplace_back(nh);
+  }
+  if (primaryNextHops.empty()) {
+    std::swap(primaryNextHops, backupNextHops);
+  }
+  return std::make_pair(std::move(primaryNextHops), std::move(backupNextHops));
+}
+
+// Compare routes by the attributes that affect forwarding, i.e. destination
+// or label, type, priority and next-hops including their MPLS actions.
+// Attributes reported by kernel but not programmed by us, e.g. flags or
+// scope, must not trigger re-programming of the route on sync
+bool
+isSameForwarding(const fbnl::Route& lhs, const fbnl::Route& rhs) {
+  if (lhs.getFamily() != rhs.getFamily() or lhs.getType() != rhs.getType() or
+      lhs.getPriority() != rhs.getPriority() or
+      lhs.getNextHopId() != rhs.getNextHopId()) {
+    return false;
+  }
+  if (lhs.getFamily() == AF_MPLS) {
+    if (lhs.getMplsLabel() != rhs.getMplsLabel()) {
+      return false;
+    }
+  } else if (lhs.getDestination() != rhs.getDestination()) {
+    return false;
+  }
+  if (lhs.getNextHopId().has_value()) {
+    // Next-hops are defined by the nexthop object, which is managed apart
+    return true;
+  }
+  return lhs.getNextHops() == rhs.getNextHops();
+}
+
+// Record outcome of sync, number of routes left as is, added or replaced and
+// deleted
+void
+addSyncStats(
+    const std::string& prefix,
+    size_t numUnchanged,
+    size_t numAdded,
+    size_t numDeleted) {
+  facebook::fb303::fbData->addStatValue(
+      prefix + ".routes_unchanged", numUnchanged, facebook::fb303::SUM);
+  facebook::fb303::fbData->addStatValue(
+      prefix + ".routes_added", numAdded, facebook::fb303::SUM);
+  facebook::fb303::fbData->addStatValue(
+      prefix + ".routes_deleted", numDeleted, facebook::fb303::SUM);
+}
+
+// Backup route may have been removed by the kernel along with its interfaces
+folly::SemiFuture<std::vector<int>>
+ignoreMissingRoutes(folly::SemiFuture<std::vector<int>>&& future) {
+  return std::move(future).deferValue([](std::vector<int>&& retvals) {
+    for (auto& retval : retvals) {
+      retval = std::abs(retval) == ESRCH ? 0 : retval;
+    }
+    return std::move(retvals);
+  });
+}
+
+// Convert netlink next-hop to thrift, except for the interface name
+thrift::NextHopThrift
+createThriftNextHop(const fbnl::NextHop& nh) {
+  auto labelAction = nh.getLabelAction();
+  thrift::NextHopThrift nextHop;
+
+  // Add nexthop address
+  if (nh.getGateway().has_value()) {
+    *nextHop.address_ref() = toBinaryAddress(nh.getGateway().value());
+  } else {
+    // POP_AND_LOOKUP mpls nexthop has no nexthop address so we assign
+    // valid but zeroed ipv6 address.
+    CHECK(labelAction.has_value());
+    CHECK(thrift::MplsActionCode::POP_AND_LOOKUP == labelAction.value());
+    *nextHop.address_ref() = toBinaryAddress(folly::IPAddressV6("::"));
+  }
+
+  // Set nexthop weight
+  nextHop.weight_ref() = nh.getWeight();
+
+  // Add mpls action
+  if (labelAction.has_value()) {
+    if (labelAction.value() == thrift::MplsActionCode::POP_AND_LOOKUP ||
+        labelAction.value() == thrift::MplsActionCode::PHP) {
+      nextHop.mplsAction_ref() = createMplsAction(labelAction.value());
+    } else if (labelAction.value() == thrift::MplsActionCode::SWAP) {
+      nextHop.mplsAction_ref() =
+          createMplsAction(labelAction.value(), nh.getSwapLabel().value());
+    } else if (labelAction.value() == thrift::MplsActionCode::PUSH) {
+      nextHop.mplsAction_ref() = createMplsAction(
+          labelAction.value(), std::nullopt, nh.getPushLabels().value());
+    }
+  }
+  return nextHop;
+}
+
 template <typename T>
 folly::SemiFuture<T>
 createSemiFutureWithClientIdError() {
@@ -42,13 +147,28 @@ createSemiFutureWithClientIdError() {
 
 } // namespace
 
-NetlinkFibHandler::NetlinkFibHandler(fbnl::NetlinkProtocolSocket* nlSock)
+NetlinkFibHandler::NetlinkFibHandler(
+    fbnl::NetlinkProtocolSocket* nlSock, bool enableNextHopObjects)
     : facebook::fb303::BaseService("openr"),
       nlSock_(nlSock),
+      nextHopObjects_(folly::in_place, nlSock, enableNextHopObjects),
       startTime_(std::chrono::duration_cast<std::chrono::seconds>(
                      std::chrono::system_clock::now().time_since_epoch())
                      .count()) {
   CHECK_NOTNULL(nlSock);
+
+  // Keep interface cache up to date with link events, then initialize it
+  // with all links. Callback holds the cache only as it may outlive handler
+  nlSock_->setLinkEventCB(
+      [interfaceCache = interfaceCache_](fbnl::Link link, bool /* unused */) {
+        updateInterfaceCache(*interfaceCache, {std::move(link)}, false);
+      });
+  auto links = nlSock_->getAllLinks().get();
+  if (links.hasError()) {
+    LOG(ERROR) << "Failed fetching links: " << folly::errnoStr(links.error());
+  } else {
+    updateInterfaceCache(*interfaceCache_, links.value(), true);
+  }
 }
 
 NetlinkFibHandler::~NetlinkFibHandler() {}
@@ -85,6 +205,11 @@ NetlinkFibHandler::protocolToPriority(const uint8_t protocol) {
   return openr::thrift::Platform_constants::kUnknowProtAdminDistance();
 }
 
+uint32_t
+NetlinkFibHandler::protocolToBackupPriority(const uint8_t protocol) {
+  return static_cast<uint32_t>(protocolToPriority(protocol)) + 1;
+}
+
 folly::SemiFuture<folly::Unit>
 NetlinkFibHandler::collectAllResult(
     std::vector<folly::SemiFuture<int>>&& result,
@@ -102,6 +227,28 @@ NetlinkFibHandler::collectAllResult(
       });
 }
 
+folly::SemiFuture<folly::Unit>
+NetlinkFibHandler::collectAllResult(
+    std::vector<folly::SemiFuture<std::vector<int>>>&& result,
+    std::set<int> errorsToIgnore) {
+  return folly::collectAll(std::move(result))
+      .deferValue([errorsToIgnore](
+                      std::vector<folly::Try<std::vector<int>>>&& retvals) {
+        for (auto& retvalsTry : retvals) {
+          // Throws exception if any
+          for (auto retval : retvalsTry.value()) {
+            retval = std::abs(retval);
+            if (retval == 0 or errorsToIgnore.count(retval)) {
+              continue;
+            }
+            throw fbnl::NlException(
+                "One or more netlink request failed", retval);
+          }
+        }
+        return folly::Unit();
+      });
+}
+
 folly::SemiFuture<folly::Unit>
 NetlinkFibHandler::semifuture_addUnicastRoute(
     int16_t clientId, std::unique_ptr<thrift::UnicastRoute> route) {
@@ -130,11 +277,31 @@ NetlinkFibHandler::semifuture_addUnicastRoutes(
   LOG(INFO) << "Adding/Updating unicast routes of client "
             << getClientName(clientId) << ", numRoutes=" << routes->size();
 
-  // Add routes and return a collected semifuture
-  std::vector<folly::SemiFuture<int>> result;
+  // Add routes in bulk and return a collected semifuture
+  std::vector<fbnl::Route> nlRoutesToAdd;
+  std::vector<fbnl::Route> nlBackupRoutesToDelete;
+  nlRoutesToAdd.reserve(routes->size());
+  NextHopSetCache nextHopSetCache;
   for (auto& route : *routes) {
-    result.emplace_back(nlSock_->addRoute(buildRoute(route, protocol.value())));
+    nlRoutesToAdd.emplace_back(
+        buildRoute(route, protocol.value(), &nextHopSetCache));
+    updateBackupRoute(
+        route, protocol.value(), nlRoutesToAdd, nlBackupRoutesToDelete);
+  }
+  auto nextHopObjects = nextHopObjects_.wlock();
+  for (auto& nlRoute : nlRoutesToAdd) {
+    nextHopObjects->assign(nlRoute);
+  }
+  for (auto& nlRoute : nlBackupRoutesToDelete) {
+    nextHopObjects->release(nlRoute);
   }
+  std::vector<folly::SemiFuture<std::vector<int>>> result;
+  result.emplace_back(nlSock_->addRoutes(nlRoutesToAdd));
+  if (not nlBackupRoutesToDelete.empty()) {
+    result.emplace_back(
+        ignoreMissingRoutes(nlSock_->deleteRoutes(nlBackupRoutesToDelete)));
+  }
+  nextHopObjects->deleteUnused();
   return collectAllResult(std::move(result), {EEXIST});
 }
 
@@ -149,14 +316,24 @@ NetlinkFibHandler::semifuture_deleteUnicastRoutes(
   LOG(INFO) << "Deleting unicast routes of client " << getClientName(clientId)
             << ", numRoutes=" << prefixes->size();
 
-  // Delete routes and return a collected semifuture
-  std::vector<folly::SemiFuture<int>> result;
+  // Delete routes in bulk and return a collected semifuture
+  std::vector<fbnl::Route> nlRoutesToDelete;
+  nlRoutesToDelete.reserve(prefixes->size());
   for (auto& prefix : *prefixes) {
     fbnl::RouteBuilder rtBuilder;
     rtBuilder.setDestination(toIPNetwork(prefix));
     rtBuilder.setProtocolId(protocol.value());
-    result.emplace_back(nlSock_->deleteRoute(rtBuilder.build()));
+    rtBuilder.setPriority(protocolToPriority(protocol.value()));
+    nlRoutesToDelete.emplace_back(rtBuilder.build());
+    deleteBackupRoute(toIPNetwork(prefix), protocol.value(), nlRoutesToDelete);
+  }
+  auto nextHopObjects = nextHopObjects_.wlock();
+  for (auto& nlRoute : nlRoutesToDelete) {
+    nextHopObjects->release(nlRoute);
   }
+  std::vector<folly::SemiFuture<std::vector<int>>> result;
+  result.emplace_back(nlSock_->deleteRoutes(nlRoutesToDelete));
+  nextHopObjects->deleteUnused();
   return collectAllResult(std::move(result), {ESRCH});
 }
 
@@ -171,12 +348,16 @@ NetlinkFibHandler::semifuture_addMplsRoutes(
   LOG(INFO) << "Adding/Updating mpls routes of client "
             << getClientName(clientId) << ", numRoutes=" << routes->size();
 
-  // Add routes and return a collected semifuture
-  std::vector<folly::SemiFuture<int>> result;
+  // Add routes in bulk and return a collected semifuture
+  std::vector<fbnl::Route> nlRoutesToAdd;
+  nlRoutesToAdd.reserve(routes->size());
+  NextHopSetCache nextHopSetCache;
   for (auto& route : *routes) {
-    result.emplace_back(
-        nlSock_->addRoute(buildMplsRoute(route, protocol.value())));
+    nlRoutesToAdd.emplace_back(
+        buildMplsRoute(route, protocol.value(), &nextHopSetCache));
   }
+  std::vector<folly::SemiFuture<std::vector<int>>> result;
+  result.emplace_back(nlSock_->addRoutes(nlRoutesToAdd));
   return collectAllResult(std::move(result), {EEXIST});
 }
 
@@ -191,17 +372,75 @@ NetlinkFibHandler::semifuture_deleteMplsRoutes(
   LOG(INFO) << "Deleting mpls routes of client " << getClientName(clientId)
             << ", numRoutes=" << topLabels->size();
 
-  // Delete routes and return a collected semifuture
-  std::vector<folly::SemiFuture<int>> result;
+  // Delete routes in bulk and return a collected semifuture
+  std::vector<fbnl::Route> nlRoutesToDelete;
+  nlRoutesToDelete.reserve(topLabels->size());
   for (auto& topLabel : *topLabels) {
     fbnl::RouteBuilder rtBuilder;
     rtBuilder.setMplsLabel(topLabel);
     rtBuilder.setProtocolId(protocol.value());
-    result.emplace_back(nlSock_->deleteRoute(rtBuilder.build()));
+    nlRoutesToDelete.emplace_back(rtBuilder.build());
   }
+  std::vector<folly::SemiFuture<std::vector<int>>> result;
+  result.emplace_back(nlSock_->deleteRoutes(nlRoutesToDelete));
   return collectAllResult(std::move(result), {ESRCH});
 }
 
+folly::SemiFuture<folly::Unit>
+NetlinkFibHandler::semifuture_syncFibChunk(
+    int16_t clientId,
+    int64_t syncId,
+    std::unique_ptr<std::vector<thrift::UnicastRoute>> unicastRoutes,
+    bool isFinal) {
+  const auto protocol = getProtocol(clientId);
+  if (not protocol.has_value()) {
+    return createSemiFutureWithClientIdError<folly::Unit>();
+  }
+  VLOG(1) << "Received chunk of unicast FIB sync " << syncId << " for client "
+          << getClientName(clientId) << ", numRoutes=" << unicastRoutes->size()
+          << ", isFinal=" << isFinal;
+
+  auto allRoutes = std::make_unique<std::vector<thrift::UnicastRoute>>();
+  {
+    auto pendingFibSyncs = pendingFibSyncs_.wlock();
+    auto& pendingFibSync = (*pendingFibSyncs)[clientId];
+    if (pendingFibSync.syncId != syncId) {
+      if (not pendingFibSync.routes.empty()) {
+        LOG(WARNING) << "Discarding incomplete unicast FIB sync "
+                     << pendingFibSync.syncId << " of client "
+                     << getClientName(clientId);
+      }
+      pendingFibSync = PendingFibSync{syncId, {}};
+    }
+    for (const auto& route : *unicastRoutes) {
+      pendingFibSync.routes.insert_or_assign(
+          toIPNetwork(*route.dest_ref()), route);
+    }
+    if (isFinal) {
+      allRoutes->reserve(pendingFibSync.routes.size());
+      for (auto& [_, route] : pendingFibSync.routes) {
+        allRoutes->emplace_back(std::move(route));
+      }
+      pendingFibSyncs->erase(clientId);
+    }
+  }
+
+  if (not isFinal) {
+    // Program routes of the chunk right away. This pipelines programming with
+    // the transfer of further chunks and leaves only stale routes to delete
+    // on the final chunk
+    return semifuture_addUnicastRoutes(clientId, std::move(unicastRoutes));
+  }
+  return semifuture_syncFib(clientId, std::move(allRoutes));
+}
+
+int64_t
+NetlinkFibHandler::getPendingSyncFibId(int16_t clientId) {
+  auto pendingFibSyncs = pendingFibSyncs_.rlock();
+  auto it = pendingFibSyncs->find(clientId);
+  return it != pendingFibSyncs->end() ? it->second.syncId : 0;
+}
+
 folly::SemiFuture<folly::Unit>
 NetlinkFibHandler::semifuture_syncFib(
     int16_t clientId,
@@ -214,14 +453,17 @@ NetlinkFibHandler::semifuture_syncFib(
   LOG(INFO) << "Syncing unicast FIB for client " << getClientName(clientId)
             << ", numRoutes=" << unicastRoutes->size();
 
-  // SemiFuture vector for collecting return values of all API calls
-  std::vector<folly::SemiFuture<int>> result;
+  // Netlink routes to add and delete in bulk
+  std::vector<fbnl::Route> nlRoutesToAdd;
+  std::vector<fbnl::Route> nlRoutesToDelete;
 
   // Create set of existing route
   // NOTE: Synchronous call to retrieve all the routes. We first make both
   // requests to retrieve IPv4 and IPv6 routes. Subsequently we wait on them
   // to complete and prepare the map of existing routes
   std::unordered_map<folly::CIDRNetwork, fbnl::Route> existingRoutes;
+  std::unordered_map<folly::CIDRNetwork, fbnl::Route> existingBackupRoutes;
+  const auto backupPriority = protocolToBackupPriority(protocol.value());
   {
     auto v4Routes = nlSock_->getIPv4Routes(protocol.value()).get();
     auto v6Routes = nlSock_->getIPv6Routes(protocol.value()).get();
@@ -239,20 +481,34 @@ NetlinkFibHandler::semifuture_syncFib(
         if (route.getType() == RTN_BLACKHOLE) {
           route.setNextHops({});
         }
-        existingRoutes.emplace(prefix, std::move(route));
+        if (route.getPriority() == backupPriority) {
+          existingBackupRoutes.emplace(prefix, std::move(route));
+        } else {
+          existingRoutes.emplace(prefix, std::move(route));
+        }
       }
     }
   }
 
+  // Re-assign nexthop objects to all routes of the protocol. Objects are
+  // re-programmed as well, kernel may have removed them along with their
+  // interfaces. Existing routes referring to other objects get updated
+  auto nextHopObjects = nextHopObjects_.wlock();
+  nextHopObjects->releaseAll(protocol.value());
+  nextHopObjects->invalidate();
+
   // Go over the new routes. Add or update
   std::unordered_set<folly::CIDRNetwork> newPrefixes;
+  size_t numUnchanged{0};
   for (auto& route : *unicastRoutes) {
     const auto network = toIPNetwork(*route.dest_ref());
     newPrefixes.insert(network);
     auto nlRoute = buildRoute(route, protocol.value());
+    nextHopObjects->assign(nlRoute);
     auto it = existingRoutes.find(network);
-    if (it != existingRoutes.end() and it->second == nlRoute) {
+    if (it != existingRoutes.end() and isSameForwarding(it->second, nlRoute)) {
       // Existing route is same as the one we're trying to add. SKIP
+      ++numUnchanged;
       continue;
     }
     if (it != existingRoutes.end()) {
@@ -263,7 +519,27 @@ NetlinkFibHandler::semifuture_syncFib(
       LOG(INFO) << "Adding unicast-route \n[NEW]" << nlRoute.str();
     }
     // Add new route or replace existing one
-    result.emplace_back(nlSock_->addRoute(nlRoute));
+    nlRoutesToAdd.emplace_back(std::move(nlRoute));
+  }
+
+  // Go over backup routes of new routes. Add or update
+  std::unordered_set<folly::CIDRNetwork> newBackupPrefixes;
+  for (auto& route : *unicastRoutes) {
+    auto nlRoute = buildBackupRoute(route, protocol.value());
+    if (not nlRoute.has_value()) {
+      continue;
+    }
+    const auto network = toIPNetwork(*route.dest_ref());
+    newBackupPrefixes.insert(network);
+    nextHopObjects->assign(nlRoute.value());
+    auto it = existingBackupRoutes.find(network);
+    if (it != existingBackupRoutes.end() and
+        isSameForwarding(it->second, nlRoute.value())) {
+      ++numUnchanged;
+      continue;
+    }
+    LOG(INFO) << "Adding backup unicast-route \n[NEW]" << nlRoute->str();
+    nlRoutesToAdd.emplace_back(std::move(nlRoute).value());
   }
 
   // Go over the old routes to remove stale ones
@@ -275,12 +551,30 @@ NetlinkFibHandler::semifuture_syncFib(
     // Delete stale route
     LOG(INFO) << "Deleting unicast-route "
               << folly::IPAddress::networkToString(prefix);
-    result.emplace_back(nlSock_->deleteRoute(nlRoute));
+    nlRoutesToDelete.emplace_back(nlRoute);
+  }
+  for (auto& [prefix, nlRoute] : existingBackupRoutes) {
+    if (newBackupPrefixes.count(prefix)) {
+      continue;
+    }
+    LOG(INFO) << "Deleting backup unicast-route "
+              << folly::IPAddress::networkToString(prefix);
+    nlRoutesToDelete.emplace_back(nlRoute);
   }
+  (*backupPrefixes_.wlock())[protocol.value()] = std::move(newBackupPrefixes);
+  addSyncStats(
+      "fibagent.sync_fib",
+      numUnchanged,
+      nlRoutesToAdd.size(),
+      nlRoutesToDelete.size());
 
   // Return collected result
   // NOTE: We're ignoring EEXIST error code. ESRCH error code must not be
   // raised because we're deleting route that already exist
+  std::vector<folly::SemiFuture<std::vector<int>>> result;
+  result.emplace_back(nlSock_->addRoutes(nlRoutesToAdd));
+  result.emplace_back(nlSock_->deleteRoutes(nlRoutesToDelete));
+  nextHopObjects->deleteUnused();
   return collectAllResult(std::move(result), {EEXIST});
 }
 
@@ -296,8 +590,9 @@ NetlinkFibHandler::semifuture_syncMplsFib(
   LOG(INFO) << "Syncing mpls FIB for client " << getClientName(clientId)
             << ", numRoutes=" << mplsRoutes->size();
 
-  // SemiFuture vector for collecting return values of all API calls
-  std::vector<folly::SemiFuture<int>> result;
+  // Netlink routes to add and delete in bulk
+  std::vector<fbnl::Route> nlRoutesToAdd;
+  std::vector<fbnl::Route> nlRoutesToDelete;
 
   // Create set of existing route
   // NOTE: Synchronous call to retrieve all the routes
@@ -313,13 +608,15 @@ NetlinkFibHandler::semifuture_syncMplsFib(
 
   // Go over the new routes. Add or update
   std::unordered_set<uint32_t> newLabels;
+  size_t numUnchanged{0};
   for (auto& route : *mplsRoutes) {
     const auto label = *route.topLabel_ref();
     newLabels.insert(label);
     auto nlRoute = buildMplsRoute(route, protocol.value());
     auto it = existingRoutes.find(label);
-    if (it != existingRoutes.end() and it->second == nlRoute) {
+    if (it != existingRoutes.end() and isSameForwarding(it->second, nlRoute)) {
       // Existing route is same as the one we're trying to add. SKIP
+      ++numUnchanged;
       continue;
     }
     if (it != existingRoutes.end()) {
@@ -330,7 +627,7 @@ NetlinkFibHandler::semifuture_syncMplsFib(
       LOG(INFO) << "Adding mpls-route \n[NEW]" << nlRoute.str();
     }
     // Add new route or replace existing one
-    result.emplace_back(nlSock_->addRoute(nlRoute));
+    nlRoutesToAdd.emplace_back(std::move(nlRoute));
   }
 
   // Go over the old routes to remove stale ones
@@ -341,10 +638,18 @@ NetlinkFibHandler::semifuture_syncMplsFib(
     }
     // Delete stale route
     LOG(INFO) << "Deleting mpls-route " << *nlRoute.getMplsLabel();
-    result.emplace_back(nlSock_->deleteRoute(nlRoute));
+    nlRoutesToDelete.emplace_back(nlRoute);
   }
+  addSyncStats(
+      "fibagent.sync_mpls_fib",
+      numUnchanged,
+      nlRoutesToAdd.size(),
+      nlRoutesToDelete.size());
 
   // Return collected result
+  std::vector<folly::SemiFuture<std::vector<int>>> result;
+  result.emplace_back(nlSock_->addRoutes(nlRoutesToAdd));
+  result.emplace_back(nlSock_->deleteRoutes(nlRoutesToDelete));
   return collectAllResult(std::move(result), {EEXIST, ESRCH});
 }
 
@@ -373,29 +678,65 @@ NetlinkFibHandler::semifuture_getRouteTableByClient(int16_t clientId) {
   CHECK(protocol.has_value());
   LOG(INFO) << "Get unicast routes for client " << getClientName(clientId);
 
-  auto v4Routes = nlSock_->getIPv4Routes(protocol.value());
-  auto v6Routes = nlSock_->getIPv6Routes(protocol.value());
+  // Routes are converted while route dumps are parsed in place, on netlink
+  // event thread one after another
+  struct RouteTable {
+    std::vector<thrift::UnicastRoute> routes;
+    std::vector<thrift::UnicastRoute> backupRoutes;
+  };
+  auto table = std::make_shared<RouteTable>();
+  const auto backupPriority = protocolToBackupPriority(protocol.value());
+  auto visitor = [this, table, backupPriority](const fbnl::RouteView& nlRoute) {
+    const bool isBackup = nlRoute.getPriority() == backupPriority;
+    auto& routes = isBackup ? table->backupRoutes : table->routes;
+    thrift::UnicastRoute route;
+    route.dest_ref() = toIpPrefix(nlRoute.getDestination());
+    nlRoute.forEachNextHop([&](const fbnl::NextHop& nh) {
+      auto nextHop = createThriftNextHop(nh);
+      if (nh.getGateway().has_value() and nh.getIfIndex().has_value()) {
+        auto ifName = getIfName(nh.getIfIndex().value());
+        if (ifName.has_value()) {
+          nextHop.address_ref()->ifName_ref() = std::move(ifName.value());
+        } else {
+          LOG(WARNING) << "Unknown interface of next-hop " << nh.str();
+        }
+      }
+      route.nextHops_ref()->emplace_back(std::move(nextHop));
+    });
+    routes.emplace_back(std::move(route));
+  };
+
+  auto v4Routes = nlSock_->visitIPv4Routes(protocol.value(), visitor);
+  auto v6Routes = nlSock_->visitIPv6Routes(protocol.value(), visitor);
   return folly::collectAll(std::move(v4Routes), std::move(v6Routes))
-      .deferValue(
-          [this](std::tuple<
-                 folly::Try<folly::Expected<std::vector<fbnl::Route>, int>>,
-                 folly::Try<folly::Expected<std::vector<fbnl::Route>, int>>>&&
-                     res) {
-            auto routes = std::make_unique<std::vector<thrift::UnicastRoute>>();
-            for (auto& nlRoutes : {std::get<0>(res), std::get<1>(res)}) {
-              if (nlRoutes.value().hasError()) {
-                throw fbnl::NlException(
-                    "Failed fetching routes", nlRoutes.value().error());
-              }
-              for (auto& nlRoute : nlRoutes.value().value()) {
-                thrift::UnicastRoute route;
-                route.dest_ref() = toIpPrefix(nlRoute.getDestination());
-                route.nextHops_ref() = toThriftNextHops(nlRoute.getNextHops());
-                routes->emplace_back(std::move(route));
-              }
-            }
-            return routes;
-          });
+      .deferValue([table](std::tuple<folly::Try<int>, folly::Try<int>>&& res) {
+        for (auto& status : {std::get<0>(res), std::get<1>(res)}) {
+          if (status.value() != 0) {
+            throw fbnl::NlException("Failed fetching routes", status.value());
+          }
+        }
+
+        auto routes = std::make_unique<std::vector<thrift::UnicastRoute>>(
+            std::move(table->routes));
+
+        // Report next-hops of backup routes along with primary ones
+        for (auto& backupRoute : table->backupRoutes) {
+          auto it = std::find_if(
+              routes->begin(),
+              routes->end(),
+              [&backupRoute](auto const& route) {
+                return *route.dest_ref() == *backupRoute.dest_ref();
+              });
+          if (it == routes->end()) {
+            continue;
+          }
+          for (auto& nh : *backupRoute.nextHops_ref()) {
+            nh.isBackup_ref() = true;
+            it->nextHops_ref()->emplace_back(std::move(nh));
+          }
+        }
+        return routes;
+      });
 }
 
 folly::SemiFuture<std::unique_ptr<std::vector<openr::thrift::MplsRoute>>>
@@ -432,42 +773,12 @@ NetlinkFibHandler::toThriftNextHops(const fbnl::NextHopSet& nextHops) {
   std::vector<thrift::NextHopThrift> thriftNextHops;
 
   for (auto const& nh : nextHops) {
-    auto labelAction = nh.getLabelAction();
-    thrift::NextHopThrift nextHop;
-
-    // Add nexthop address
-    if (nh.getGateway().has_value()) {
-      *nextHop.address_ref() = toBinaryAddress(nh.getGateway().value());
-      // Add nexthop interface if any
-      if (nh.getIfIndex().has_value()) {
-        nextHop.address_ref()->ifName_ref() =
-            getIfName(nh.getIfIndex().value()).value();
-      }
-    } else {
-      // POP_AND_LOOKUP mpls nexthop has no nexthop address so we assign
-      // valid but zeroed ipv6 address.
-      CHECK(labelAction.has_value());
-      CHECK(thrift::MplsActionCode::POP_AND_LOOKUP == labelAction.value());
-      *nextHop.address_ref() = toBinaryAddress(folly::IPAddressV6("::"));
+    auto nextHop = createThriftNextHop(nh);
+    // Add nexthop interface if any
+    if (nh.getGateway().has_value() and nh.getIfIndex().has_value()) {
+      nextHop.address_ref()->ifName_ref() =
+          getIfName(nh.getIfIndex().value()).value();
     }
-
-    // Set nexthop weight
-    nextHop.weight_ref() = nh.getWeight();
-
-    // Add mpls action
-    if (labelAction.has_value()) {
-      if (labelAction.value() == thrift::MplsActionCode::POP_AND_LOOKUP ||
-          labelAction.value() == thrift::MplsActionCode::PHP) {
-        nextHop.mplsAction_ref() = createMplsAction(labelAction.value());
-      } else if (labelAction.value() == thrift::MplsActionCode::SWAP) {
-        nextHop.mplsAction_ref() =
-            createMplsAction(labelAction.value(), nh.getSwapLabel().value());
-      } else if (labelAction.value() == thrift::MplsActionCode::PUSH) {
-        nextHop.mplsAction_ref() = createMplsAction(
-            labelAction.value(), std::nullopt, nh.getPushLabels().value());
-      }
-    }
-
     thriftNextHops.emplace_back(std::move(nextHop));
   }
   return thriftNextHops;
@@ -507,7 +818,20 @@ NetlinkFibHandler::buildMplsAction(
 void
 NetlinkFibHandler::buildNextHop(
     fbnl::RouteBuilder& rtBuilder,
-    const std::vector<thrift::NextHopThrift>& nhop) {
+    const std::vector<thrift::NextHopThrift>& nhop,
+    NextHopSetCache* nextHopSetCache) {
+  if (nextHopSetCache) {
+    auto it = nextHopSetCache->find(nhop);
+    if (it == nextHopSetCache->end()) {
+      fbnl::RouteBuilder nhSetBuilder;
+      buildNextHop(nhSetBuilder, nhop);
+      it = nextHopSetCache->emplace(nhop, nhSetBuilder.getSharedNextHops())
+               .first;
+    }
+    rtBuilder.setNextHops(it->second);
+    return;
+  }
+
   // add nexthops
   fbnl::NextHopBuilder nhBuilder;
   for (const auto& nh : nhop) {
@@ -523,7 +847,10 @@ NetlinkFibHandler::buildNextHop(
 }
 
 fbnl::Route
-NetlinkFibHandler::buildRoute(const thrift::UnicastRoute& route, int protocol) {
+NetlinkFibHandler::buildRoute(
+    const thrift::UnicastRoute& route,
+    int protocol,
+    NextHopSetCache* nextHopSetCache) {
   // Create route object
   fbnl::RouteBuilder rtBuilder;
   rtBuilder.setDestination(toIPNetwork(*route.dest_ref()))
@@ -536,16 +863,70 @@ NetlinkFibHandler::buildRoute(const thrift::UnicastRoute& route, int protocol) {
     // Empty nexthops is same as DROP (aka RTN_BLACKHOLE)
     rtBuilder.setType(RTN_BLACKHOLE);
   } else {
-    // Add nexthops
-    buildNextHop(rtBuilder, *route.nextHops_ref());
+    // Add nexthops. Backup nexthops are programmed apart
+    buildNextHop(
+        rtBuilder,
+        splitBackupNextHops(*route.nextHops_ref()).first,
+        nextHopSetCache);
+  }
+
+  return rtBuilder.build();
+}
+
+std::optional<fbnl::Route>
+NetlinkFibHandler::buildBackupRoute(
+    const thrift::UnicastRoute& route, int protocol) {
+  auto backupNextHops = splitBackupNextHops(*route.nextHops_ref()).second;
+  if (backupNextHops.empty()) {
+    return std::nullopt;
   }
 
+  fbnl::RouteBuilder rtBuilder;
+  rtBuilder.setDestination(toIPNetwork(*route.dest_ref()))
+      .setProtocolId(protocol)
+      .setPriority(protocolToBackupPriority(protocol))
+      .setFlags(0)
+      .setValid(true);
+  buildNextHop(rtBuilder, backupNextHops);
   return rtBuilder.build();
 }
 
+void
+NetlinkFibHandler::updateBackupRoute(
+    const thrift::UnicastRoute& route,
+    int protocol,
+    std::vector<fbnl::Route>& nlRoutesToAdd,
+    std::vector<fbnl::Route>& nlRoutesToDelete) {
+  auto nlRoute = buildBackupRoute(route, protocol);
+  if (not nlRoute.has_value()) {
+    deleteBackupRoute(
+        toIPNetwork(*route.dest_ref()), protocol, nlRoutesToDelete);
+    return;
+  }
+  (*backupPrefixes_.wlock())[protocol].insert(nlRoute->getDestination());
+  nlRoutesToAdd.emplace_back(std::move(nlRoute).value());
+}
+
+void
+NetlinkFibHandler::deleteBackupRoute(
+    const folly::CIDRNetwork& prefix,
+    int protocol,
+    std::vector<fbnl::Route>& nlRoutesToDelete) {
+  if (not(*backupPrefixes_.wlock())[protocol].erase(prefix)) {
+    return;
+  }
+  fbnl::RouteBuilder rtBuilder;
+  rtBuilder.setDestination(prefix);
+  rtBuilder.setProtocolId(protocol);
+  rtBuilder.setPriority(protocolToBackupPriority(protocol));
+  nlRoutesToDelete.emplace_back(rtBuilder.build());
+}
+
 fbnl::Route
 NetlinkFibHandler::buildMplsRoute(
-    const thrift::MplsRoute& mplsRoute, int protocol) {
+    const thrift::MplsRoute& mplsRoute,
+    int protocol,
+    NextHopSetCache* nextHopSetCache) {
   // Create route object
   // NOTE: Priority for MPLS routes is not supported in Linux
   fbnl::RouteBuilder rtBuilder;
@@ -558,92 +939,75 @@ NetlinkFibHandler::buildMplsRoute(
     // Empty nexthops is same as DROP (aka RTN_BLACKHOLE)
     rtBuilder.setType(RTN_BLACKHOLE);
   } else {
-    // Add nexthops
-    buildNextHop(rtBuilder, *mplsRoute.nextHops_ref());
+    // Add nexthops. MPLS routes have no priority to program backup nexthops
+    // apart, hence they are skipped
+    buildNextHop(
+        rtBuilder,
+        splitBackupNextHops(*mplsRoute.nextHops_ref()).first,
+        nextHopSetCache);
   }
 
   return rtBuilder.setValid(true).build();
 }
 
 std::optional<int>
-NetlinkFibHandler::getIfIndex(const std::string& ifName) {
-  // Lambda function to lookup ifName in cache
-  auto getCachedIndex = [this, &ifName]() -> std::optional<int> {
-    auto cache = ifNameToIndex_.rlock();
-    auto it = cache->find(ifName);
-    if (it != cache->end()) {
-      return it->second;
-    }
-    return std::nullopt;
-  };
-
-  // Lookup in cache. Return if exists
-  auto maybeIndex = getCachedIndex();
-  if (maybeIndex.has_value()) {
-    return maybeIndex;
+NetlinkFibHandler::getIfIndex(const std::string& ifName) const {
+  const auto cache = interfaceCache_->snapshot.load();
+  auto it = cache->ifNameToIndex.find(ifName);
+  if (it != cache->ifNameToIndex.end()) {
+    return it->second;
   }
-
-  // Update cache and return cached index
-  initializeInterfaceCache();
-  return getCachedIndex();
+  return std::nullopt;
 }
 
 std::optional<std::string>
-NetlinkFibHandler::getIfName(const int ifIndex) {
-  // Lambda function to lookup ifIndex in cache
-  auto getCachedName = [this, ifIndex]() -> std::optional<std::string> {
-    auto cache = ifIndexToName_.rlock();
-    auto it = cache->find(ifIndex);
-    if (it != cache->end()) {
-      return it->second;
-    }
-    return std::nullopt;
-  };
-
-  // Lookup in cache. Return if exists
-  auto maybeName = getCachedName();
-  if (maybeName.has_value()) {
-    return maybeName;
+NetlinkFibHandler::getIfName(const int ifIndex) const {
+  const auto cache = interfaceCache_->snapshot.load();
+  auto it = cache->ifIndexToName.find(ifIndex);
+  if (it != cache->ifIndexToName.end()) {
+    return it->second;
   }
-
-  // Update cache and return cached index
-  initializeInterfaceCache();
-  return getCachedName();
+  return std::nullopt;
 }
 
 std::optional<int>
-NetlinkFibHandler::getLoopbackIfIndex() {
-  auto index = loopbackIfIndex_.load();
-  if (index < 0) {
-    initializeInterfaceCache();
-    index = loopbackIfIndex_.load();
-  }
-
-  if (index < 0) {
-    return std::nullopt;
-  }
-  return index;
+NetlinkFibHandler::getLoopbackIfIndex() const {
+  return interfaceCache_->snapshot.load()->loopbackIfIndex;
 }
 
 void
-NetlinkFibHandler::initializeInterfaceCache() noexcept {
-  auto links = nlSock_->getAllLinks().get().value();
-
-  // Acquire locks on the cache
-  auto lockedIfNameToIndex = ifNameToIndex_.wlock();
-  auto lockedIfIndexToName = ifIndexToName_.wlock();
-
-  // NOTE: We don't clear cache instead override entries
+NetlinkFibHandler::updateInterfaceCache(
+    InterfaceCacheState& state,
+    const std::vector<fbnl::Link>& links,
+    bool isInitialDump) {
+  std::lock_guard<std::mutex> l(state.writeMutex);
+  auto cache = std::make_shared<InterfaceCache>(*state.snapshot.load());
   for (auto const& link : links) {
-    // Update name <-> index mappings
-    (*lockedIfNameToIndex)[link.getLinkName()] = link.getIfIndex();
-    (*lockedIfIndexToName)[link.getIfIndex()] = link.getLinkName();
+    const auto& ifName = link.getLinkName();
+    const auto ifIndex = link.getIfIndex();
+    if (isInitialDump and
+        (cache->ifNameToIndex.count(ifName) or
+         cache->ifIndexToName.count(ifIndex))) {
+      continue;
+    }
+
+    // Remove stale mappings of renamed interfaces or re-used names
+    auto nameIt = cache->ifIndexToName.find(ifIndex);
+    if (nameIt != cache->ifIndexToName.end() and nameIt->second != ifName) {
+      cache->ifNameToIndex.erase(nameIt->second);
+    }
+    auto indexIt = cache->ifNameToIndex.find(ifName);
+    if (indexIt != cache->ifNameToIndex.end() and indexIt->second != ifIndex) {
+      cache->ifIndexToName.erase(indexIt->second);
+    }
+    cache->ifNameToIndex[ifName] = ifIndex;
+    cache->ifIndexToName[ifIndex] = ifName;
 
-    // Update loopbackIfIndex_
     if (link.isLoopback()) {
-      loopbackIfIndex_.store(link.getIfIndex());
+      cache->loopbackIfIndex = ifIndex;
     }
   }
+  state.snapshot.store(std::move(cache));
 }
 
 void
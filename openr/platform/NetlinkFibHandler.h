@@ -8,13 +8,17 @@
 #pragma once
 
 #include <chrono>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <fb303/BaseService.h>
 #include <folly/Expected.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/AsyncSocket.h>
 
@@ -26,6 +30,7 @@
 #include <openr/if/gen-cpp2/NeighborListenerClientForFibagent.h>
 #include <openr/nl/NetlinkProtocolSocket.h>
 #include <openr/nl/NetlinkTypes.h>
+#include <openr/nl/NextHopObjectManager.h>
 
 namespace openr {
 /**
@@ -39,7 +44,10 @@ namespace openr {
 class NetlinkFibHandler : public thrift::FibServiceSvIf,
                           public facebook::fb303::BaseService {
  public:
-  explicit NetlinkFibHandler(fbnl::NetlinkProtocolSocket* nlSock);
+  // Next-hops of unicast routes are programmed as kernel nexthop objects if
+  // enableNextHopObjects is set, see fbnl::NextHopObjectManager
+  explicit NetlinkFibHandler(
+      fbnl::NetlinkProtocolSocket* nlSock, bool enableNextHopObjects = false);
   ~NetlinkFibHandler() override;
 
   void
@@ -73,6 +81,14 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf,
       int16_t clientId,
       std::unique_ptr<std::vector<thrift::UnicastRoute>> routes) override;
 
+  folly::SemiFuture<folly::Unit> semifuture_syncFibChunk(
+      int16_t clientId,
+      int64_t syncId,
+      std::unique_ptr<std::vector<thrift::UnicastRoute>> routes,
+      bool isFinal) override;
+
+  int64_t getPendingSyncFibId(int16_t clientId) override;
+
   folly::SemiFuture<folly::Unit> semifuture_syncMplsFib(
       int16_t clientId,
       std::unique_ptr<std::vector<thrift::MplsRoute>> routes) override;
@@ -110,6 +126,15 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf,
    */
   static uint8_t protocolToPriority(const uint8_t protocol);
 
+  /**
+   * Translate protocol identifier to priority of backup routes. Backup
+   * next-hops of a unicast route are programmed as a separate route of lower
+   * preference. Kernel forwards via the backup route as soon as the primary
+   * route is removed or ignored because its next-hops are down, see
+   * `ignore_routes_with_linkdown` sysctl
+   */
+  static uint32_t protocolToBackupPriority(const uint8_t protocol);
+
   /**
    * Convert list<SemiFuture<int>> to SemiFuture<Unit>
    * The first error if any will be converted to NlException
@@ -118,6 +143,15 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf,
       std::vector<folly::SemiFuture<int>>&& result,
       std::set<int> errorsToIgnore);
 
+  /**
+   * Convert list<SemiFuture<vector<int>>> of bulk netlink requests to
+   * SemiFuture<Unit>
+   * The first error if any will be converted to NlException
+   */
+  static folly::SemiFuture<folly::Unit> collectAllResult(
+      std::vector<folly::SemiFuture<std::vector<int>>>&& result,
+      std::set<int> errorsToIgnore);
+
  protected:
   /**
    * TODO: Migrate BGP++ to stream API for neighbor notifications. Also need to
@@ -153,32 +187,47 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf,
    * API to convert thrift route representation to netlink. Used for programming
    * routes in kernel.
    */
-  fbnl::Route buildRoute(const thrift::UnicastRoute& route, int protocol);
-  fbnl::Route buildMplsRoute(const thrift::MplsRoute& mplsRoute, int protocol);
+  //
+  // Routes built with the same cache share one immutable set of next-hops
+  // per distinct thrift next-hops, e.g. all routes of a batch towards the
+  // same ECMP group. Cache must not outlive change of interface cache
+  using NextHopSetCache = std::map<
+      std::vector<thrift::NextHopThrift>,
+      std::shared_ptr<const fbnl::NextHopSet>>;
+  fbnl::Route buildRoute(
+      const thrift::UnicastRoute& route,
+      int protocol,
+      NextHopSetCache* nextHopSetCache = nullptr);
+  std::optional<fbnl::Route> buildBackupRoute(
+      const thrift::UnicastRoute& route, int protocol);
+  fbnl::Route buildMplsRoute(
+      const thrift::MplsRoute& mplsRoute,
+      int protocol,
+      NextHopSetCache* nextHopSetCache = nullptr);
   void buildMplsAction(
       fbnl::NextHopBuilder& nhBuilder, const thrift::NextHopThrift& nhop);
   void buildNextHop(
       fbnl::RouteBuilder& rtBuilder,
-      const std::vector<thrift::NextHopThrift>& nhop);
+      const std::vector<thrift::NextHopThrift>& nhop,
+      NextHopSetCache* nextHopSetCache = nullptr);
 
   /**
    * APIs to convert ifName <-> ifIndex for thrift <-> netlink route conversions
-   * Returns `folly::none` if can't find the mapping.
    *
-   * Cache is used for optimized response to subsequent query for same interface
-   * name or index. Entries in cache are lazily initialized on first instance by
-   * querying `getAllLinks`.
+   * Mappings are looked up in the interface cache, which is initialized with
+   * `getAllLinks` on construction and kept up to date by link events of the
+   * netlink socket. Lookups never lock or query netlink, hence they are safe
+   * to use on netlink event thread as well.
    *
    * Returns `std::nullopt` if mapping is not found
    */
-  std::optional<int> getIfIndex(const std::string& ifName);
-  std::optional<std::string> getIfName(const int ifIndex);
+  std::optional<int> getIfIndex(const std::string& ifName) const;
+  std::optional<std::string> getIfName(const int ifIndex) const;
 
   /**
-   * Get interface index of loopback interface. Lazily query it from netlink
-   * by querying `getAllLinks`
+   * Get interface index of loopback interface from the interface cache
    */
-  std::optional<int> getLoopbackIfIndex();
+  std::optional<int> getLoopbackIfIndex() const;
 
   // Used to interact with Linux kernel routing table
   fbnl::NetlinkProtocolSocket* nlSock_{nullptr};
@@ -190,18 +239,71 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf,
   NetlinkFibHandler(const NetlinkFibHandler&) = delete;
   NetlinkFibHandler& operator=(const NetlinkFibHandler&) = delete;
 
+  // Snapshot of interface name <-> index mappings
+  struct InterfaceCache {
+    std::unordered_map<std::string, int> ifNameToIndex;
+    std::unordered_map<int, std::string> ifIndexToName;
+    std::optional<int> loopbackIfIndex;
+  };
+
+  // Interface cache shared with link event callback of netlink socket, which
+  // may outlive the handler. Writers replace the snapshot with an updated copy
+  // under lock, readers only load the snapshot
+  struct InterfaceCacheState {
+    std::mutex writeMutex;
+    folly::atomic_shared_ptr<const InterfaceCache> snapshot{
+        std::make_shared<const InterfaceCache>()};
+  };
+
   /**
-   * Initialize cache related to interfaces. Especially loopbackIfIndex_
-   * and interface name <-> index mappings
+   * Update interface cache with links. Links of the initial dump don't
+   * override mappings of link events received meanwhile
    */
-  void initializeInterfaceCache() noexcept;
+  static void updateInterfaceCache(
+      InterfaceCacheState& state,
+      const std::vector<fbnl::Link>& links,
+      bool isInitialDump);
 
-  // Cache for interface index <-> name mapping
-  folly::Synchronized<std::unordered_map<std::string, int>> ifNameToIndex_;
-  folly::Synchronized<std::unordered_map<int, std::string>> ifIndexToName_;
+  /**
+   * Program backup route of unicast route if it has backup next-hops, remove
+   * previously programmed backup route of the prefix otherwise. Netlink
+   * routes to add or delete are appended to given lists
+   */
+  void updateBackupRoute(
+      const thrift::UnicastRoute& route,
+      int protocol,
+      std::vector<fbnl::Route>& nlRoutesToAdd,
+      std::vector<fbnl::Route>& nlRoutesToDelete);
+
+  /**
+   * Remove programmed backup route of the prefix if any. Netlink route to
+   * delete is appended to given list
+   */
+  void deleteBackupRoute(
+      const folly::CIDRNetwork& prefix,
+      int protocol,
+      std::vector<fbnl::Route>& nlRoutesToDelete);
+
+  // Kernel nexthop objects of unicast routes. Lock is held while programming
+  // routes as objects must be programmed in order with the routes
+  folly::Synchronized<fbnl::NextHopObjectManager> nextHopObjects_;
+
+  // Prefixes with programmed backup routes per protocol
+  folly::Synchronized<
+      std::unordered_map<int, std::unordered_set<folly::CIDRNetwork>>>
+      backupPrefixes_;
+
+  // Routes received so far of the incomplete chunked sync per client
+  struct PendingFibSync {
+    int64_t syncId{0};
+    std::unordered_map<folly::CIDRNetwork, thrift::UnicastRoute> routes;
+  };
+  folly::Synchronized<std::unordered_map<int16_t, PendingFibSync>>
+      pendingFibSyncs_;
 
-  // Loopback interface index cache. Initialized to negative number
-  std::atomic<int> loopbackIfIndex_{-1};
+  // Cache for interface index <-> name mapping
+  const std::shared_ptr<InterfaceCacheState> interfaceCache_{
+      std::make_shared<InterfaceCacheState>()};
 
   // Time when service started, in number of seconds, since epoch
   const int64_t startTime_{0};
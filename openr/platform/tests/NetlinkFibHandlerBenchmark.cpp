@@ -4,11 +4,15 @@
  * This source code is licensed under the MIT license found in the
  * LICENSE file in the root directory of this source tree.
  */
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
 #include <thread>
 
+#include <unistd.h>
+
+#include <fb303/ServiceData.h>
 #include <folly/Benchmark.h>
 #include <folly/Exception.h>
 #include <folly/Format.h>
@@ -21,6 +25,7 @@
 #include <folly/system/Shell.h>
 #include <folly/test/TestUtils.h>
 
+#include <openr/nl/NetlinkRoute.h>
 #include <openr/platform/NetlinkFibHandler.h>
 #include <openr/tests/mocks/MockNetlinkProtocolSocket.h>
 #include <openr/tests/mocks/PrefixGenerator.h>
@@ -29,6 +34,21 @@ using namespace openr;
 using namespace openr::fbnl;
 using namespace folly::literals::shell_literals;
 
+/**
+ * Defines a benchmark that allows users to record customized counter during
+ * benchmarking and passes a parameter to another one.
+ */
+#define BENCHMARK_COUNTERS_PARAM(name, counters, param) \
+  BENCHMARK_IMPL_COUNTERS(                              \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param)),   \
+      FOLLY_PP_STRINGIZE(name) "(" #param ")",          \
+      counters,                                         \
+      iters,                                            \
+      unsigned,                                         \
+      iters) {                                          \
+    name(counters, iters, param);                       \
+  }
+
 namespace {
 // Virtual interfaces
 const std::string kVethNameX("vethTestX");
@@ -40,6 +60,91 @@ const uint8_t kNumOfNexthops = 128;
 
 const int16_t kFibId{static_cast<int16_t>(openr::thrift::FibClient::OPENR)};
 
+// Protocol ID of routes programmed in kernel by benchmark
+const uint8_t kRouteProtoId{99};
+
+// Number of next-hops of ECMP routes
+const size_t kNumOfEcmpNexthops = 64;
+
+// Label stack of MPLS push next-hops
+const std::vector<int32_t> kPushLabels{100, 200, 300};
+
+// MPLS actions of benchmarks of MPLS routes
+const thrift::MplsActionCode kPush{thrift::MplsActionCode::PUSH};
+const thrift::MplsActionCode kSwap{thrift::MplsActionCode::SWAP};
+const thrift::MplsActionCode kPhp{thrift::MplsActionCode::PHP};
+const thrift::MplsActionCode kPop{thrift::MplsActionCode::POP_AND_LOOKUP};
+
+int64_t
+getCounter(const std::string& key) {
+  return facebook::fb303::fbData->getCounters()[key];
+}
+
+// Report rate of routes and of netlink bytes if any, per second of elapsed
+// time of the measured part of benchmark
+void
+setRateCounters(
+    folly::UserCounters& counters,
+    uint64_t numRoutes,
+    uint64_t numBytes,
+    std::chrono::steady_clock::duration elapsed) {
+  const auto elapsedUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  if (elapsedUs <= 0) {
+    return;
+  }
+  counters["routes_per_sec"] = numRoutes * 1000000 / elapsedUs;
+  if (numBytes) {
+    counters["bytes_per_sec"] = numBytes * 1000000 / elapsedUs;
+    counters["bytes_per_route"] = numBytes / numRoutes;
+  }
+}
+
+// Next-hops with distinct gateways via given interface
+std::vector<thrift::NextHopThrift>
+createNextHops(
+    size_t numOfNextHops,
+    const std::string& ifName,
+    std::optional<thrift::MplsAction> mplsAction = std::nullopt) {
+  std::vector<thrift::NextHopThrift> nextHops;
+  nextHops.reserve(numOfNextHops);
+  for (size_t i = 0; i < numOfNextHops; ++i) {
+    nextHops.emplace_back(createNextHop(
+        toBinaryAddress(folly::IPAddress(folly::sformat("fe80::{:x}", i + 1))),
+        ifName,
+        0,
+        mplsAction));
+  }
+  return nextHops;
+}
+
+// Netlink next-hops with distinct gateways via given interface
+std::vector<fbnl::NextHop>
+createNlNextHops(
+    size_t numOfNextHops,
+    int ifIndex,
+    std::optional<thrift::MplsActionCode> mplsAction = std::nullopt) {
+  std::vector<fbnl::NextHop> nextHops;
+  for (size_t i = 0; i < numOfNextHops; ++i) {
+    fbnl::NextHopBuilder nhBuilder;
+    nhBuilder.setIfIndex(ifIndex);
+    if (mplsAction != kPop) {
+      nhBuilder.setGateway(
+          folly::IPAddress(folly::sformat("fe80::{:x}", i + 1)));
+    }
+    if (mplsAction.has_value()) {
+      nhBuilder.setLabelAction(mplsAction.value());
+    }
+    if (mplsAction == kPush) {
+      nhBuilder.setPushLabels(kPushLabels);
+    } else if (mplsAction == kSwap) {
+      nhBuilder.setSwapLabel(kPushLabels.front());
+    }
+    nextHops.emplace_back(nhBuilder.build());
+  }
+  return nextHops;
+}
+
 } // namespace
 
 namespace openr {
@@ -53,6 +158,7 @@ class NetlinkFibWrapper {
     nlSock = std::make_unique<MockNetlinkProtocolSocket>(&evb);
     nlSock->addLink(utils::createLink(0, kVethNameX)).get();
     nlSock->addLink(utils::createLink(1, kVethNameY)).get();
+    nlSock->addLink(utils::createLink(2, "lo", true, true)).get();
 
     // Start FibService thread
     fibHandler = std::make_unique<NetlinkFibHandler>(nlSock.get());
@@ -107,11 +213,340 @@ BM_NetlinkFibHandler(uint32_t iters, size_t numOfPrefixes) {
   }
 }
 
+/**
+ * Benchmark programming of routes in kernel through NetlinkProtocolSocket and
+ * report system calls made for receiving acks. Routes are added and deleted
+ * via loopback interface. Must be run as root, skipped otherwise.
+ */
+static void
+BM_NetlinkProtocolSocketAck(
+    folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  if (getuid()) {
+    LOG(ERROR) << "Must run as root, skipping BM_NetlinkProtocolSocketAck";
+    return;
+  }
+
+  folly::EventBase evb;
+  messaging::ReplicateQueue<NetlinkEvent> netlinkEventsQ;
+  auto nlSock = std::make_unique<NetlinkProtocolSocket>(&evb, netlinkEventsQ);
+  std::thread evbThread([&evb]() { evb.loopForever(); });
+  evb.waitUntilRunning();
+
+  std::optional<int> loIfIndex;
+  for (const auto& link : nlSock->getAllLinks().get().value()) {
+    if (link.getLinkName() == "lo") {
+      loIfIndex = link.getIfIndex();
+    }
+  }
+  CHECK(loIfIndex.has_value()) << "Loopback interface not found";
+
+  std::vector<fbnl::Route> routes;
+  for (const auto& prefix :
+       PrefixGenerator::ipv6PrefixGenerator(numOfPrefixes, kBitMaskLen)) {
+    fbnl::RouteBuilder rtBuilder;
+    rtBuilder.setDestination(toIPNetwork(prefix))
+        .setProtocolId(kRouteProtoId)
+        .addNextHop(fbnl::NextHopBuilder().setIfIndex(*loIfIndex).build());
+    routes.emplace_back(rtBuilder.build());
+  }
+
+  const auto syscallsBefore = getCounter("netlink.recv.syscalls.sum");
+  const auto messagesBefore = getCounter("netlink.recv.messages.sum");
+  const auto acksBefore = getCounter("netlink.requests.success.sum") +
+      getCounter("netlink.requests.error.sum");
+
+  for (uint32_t i = 0; i < iters; i++) {
+    suspender.dismiss(); // Start measuring benchmark time
+    nlSock->addRoutes(routes).get();
+    nlSock->deleteRoutes(routes).get();
+    suspender.rehire(); // Stop measuring time again
+  }
+
+  const auto syscalls =
+      getCounter("netlink.recv.syscalls.sum") - syscallsBefore;
+  const auto messages =
+      getCounter("netlink.recv.messages.sum") - messagesBefore;
+  const auto acks = getCounter("netlink.requests.success.sum") +
+      getCounter("netlink.requests.error.sum") - acksBefore;
+  counters["recv_syscalls"] = syscalls;
+  counters["recv_messages"] = messages;
+  counters["acks"] = acks;
+  counters["syscalls_per_1k_acks"] = acks ? syscalls * 1000 / acks : 0;
+
+  netlinkEventsQ.close();
+  evb.terminateLoopSoon();
+  evbThread.join();
+}
+
+/**
+ * Benchmark encoding of routes into netlink messages by NetlinkRouteMessage,
+ * without sending them. Reports encoded routes and netlink bytes per second.
+ */
+static void
+benchmarkRouteEncoding(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    const std::vector<fbnl::Route>& routes) {
+  auto suspender = folly::BenchmarkSuspender();
+  uint64_t numBytes{0};
+  std::chrono::steady_clock::duration elapsed{0};
+
+  for (uint32_t i = 0; i < iters; i++) {
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss(); // Start measuring benchmark time
+    for (const auto& route : routes) {
+      NetlinkRouteMessage rtmMsg;
+      const int status = route.getFamily() == AF_MPLS
+          ? rtmMsg.addLabelRoute(route)
+          : rtmMsg.addRoute(route);
+      CHECK_EQ(0, status);
+      numBytes += rtmMsg.getDataLength();
+      rtmMsg.setReturnStatus(0);
+    }
+    suspender.rehire(); // Stop measuring time again
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+
+  setRateCounters(counters, routes.size() * iters, numBytes, elapsed);
+}
+
+/**
+ * Encoding of IPv6 unicast routes with given number of next-hops
+ */
+static void
+BM_NetlinkRouteEncodeUnicast(
+    folly::UserCounters& counters, uint32_t iters, unsigned numOfNexthops) {
+  std::vector<fbnl::Route> routes;
+  {
+    auto suspender = folly::BenchmarkSuspender();
+    for (const auto& prefix :
+         PrefixGenerator::ipv6PrefixGenerator(1000, kBitMaskLen)) {
+      fbnl::RouteBuilder rtBuilder;
+      rtBuilder.setDestination(toIPNetwork(prefix))
+          .setProtocolId(kRouteProtoId);
+      for (const auto& nh : createNlNextHops(numOfNexthops, 1)) {
+        rtBuilder.addNextHop(nh);
+      }
+      routes.emplace_back(rtBuilder.build());
+    }
+  }
+  benchmarkRouteEncoding(counters, iters, routes);
+}
+
+/**
+ * Encoding of routes with MPLS next-hops. PUSH next-hops are of IPv6 routes,
+ * the others of label routes. Routes have 4 next-hops each.
+ */
+static void
+BM_NetlinkRouteEncodeMpls(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    thrift::MplsActionCode mplsAction) {
+  std::vector<fbnl::Route> routes;
+  {
+    auto suspender = folly::BenchmarkSuspender();
+    const auto prefixes =
+        PrefixGenerator::ipv6PrefixGenerator(1000, kBitMaskLen);
+    for (size_t i = 0; i < prefixes.size(); ++i) {
+      fbnl::RouteBuilder rtBuilder;
+      rtBuilder.setProtocolId(kRouteProtoId);
+      if (mplsAction == kPush) {
+        rtBuilder.setDestination(toIPNetwork(prefixes.at(i)));
+      } else {
+        rtBuilder.setMplsLabel(i + 1000);
+      }
+      for (const auto& nh : createNlNextHops(4, 1, mplsAction)) {
+        rtBuilder.addNextHop(nh);
+      }
+      routes.emplace_back(rtBuilder.build());
+    }
+  }
+  benchmarkRouteEncoding(counters, iters, routes);
+}
+
+/**
+ * Add 64-way ECMP unicast routes through NetlinkFibHandler
+ */
+static void
+BM_NetlinkFibHandlerEcmp(
+    folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto netlinkFibWrapper = std::make_unique<NetlinkFibWrapper>();
+  const auto prefixes =
+      PrefixGenerator::ipv6PrefixGenerator(numOfPrefixes, kBitMaskLen);
+  const auto nextHops = createNextHops(kNumOfEcmpNexthops, kVethNameY);
+  std::chrono::steady_clock::duration elapsed{0};
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto routes = std::make_unique<std::vector<thrift::UnicastRoute>>();
+    for (const auto& prefix : prefixes) {
+      routes->emplace_back(createUnicastRoute(prefix, nextHops));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss(); // Start measuring benchmark time
+    netlinkFibWrapper->fibHandler
+        ->semifuture_addUnicastRoutes(kFibId, std::move(routes))
+        .wait();
+    suspender.rehire(); // Stop measuring time again
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+
+  setRateCounters(counters, numOfPrefixes * iters, 0, elapsed);
+}
+
+/**
+ * Add MPLS routes with SWAP, PHP and POP_AND_LOOKUP next-hops, one third of
+ * routes each, through NetlinkFibHandler
+ */
+static void
+BM_NetlinkFibHandlerMpls(
+    folly::UserCounters& counters, uint32_t iters, unsigned numOfLabels) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto netlinkFibWrapper = std::make_unique<NetlinkFibWrapper>();
+  const std::vector<std::vector<thrift::NextHopThrift>> nextHops{
+      createNextHops(
+          4, kVethNameY, createMplsAction(kSwap, kPushLabels.front())),
+      createNextHops(4, kVethNameY, createMplsAction(kPhp)),
+      {createNextHop(
+          toBinaryAddress(folly::IPAddressV6("::")),
+          std::nullopt,
+          0,
+          createMplsAction(kPop))}};
+  std::chrono::steady_clock::duration elapsed{0};
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto routes = std::make_unique<std::vector<thrift::MplsRoute>>();
+    for (unsigned label = 0; label < numOfLabels; ++label) {
+      routes->emplace_back(createMplsRoute(
+          label + 1000, nextHops.at(label % nextHops.size())));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss(); // Start measuring benchmark time
+    netlinkFibWrapper->fibHandler
+        ->semifuture_addMplsRoutes(kFibId, std::move(routes))
+        .wait();
+    suspender.rehire(); // Stop measuring time again
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+
+  setRateCounters(counters, numOfLabels * iters, 0, elapsed);
+}
+
+/**
+ * Delete unicast routes through NetlinkFibHandler. Routes are re-added
+ * outside of the measured time on every iteration
+ */
+static void
+BM_NetlinkFibHandlerDelete(
+    folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto netlinkFibWrapper = std::make_unique<NetlinkFibWrapper>();
+  const auto prefixes =
+      PrefixGenerator::ipv6PrefixGenerator(numOfPrefixes, kBitMaskLen);
+  const auto nextHops = createNextHops(4, kVethNameY);
+  std::chrono::steady_clock::duration elapsed{0};
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto routes = std::make_unique<std::vector<thrift::UnicastRoute>>();
+    for (const auto& prefix : prefixes) {
+      routes->emplace_back(createUnicastRoute(prefix, nextHops));
+    }
+    netlinkFibWrapper->fibHandler
+        ->semifuture_addUnicastRoutes(kFibId, std::move(routes))
+        .wait();
+
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss(); // Start measuring benchmark time
+    netlinkFibWrapper->fibHandler
+        ->semifuture_deleteUnicastRoutes(
+            kFibId, std::make_unique<std::vector<thrift::IpPrefix>>(prefixes))
+        .wait();
+    suspender.rehire(); // Stop measuring time again
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+
+  setRateCounters(counters, numOfPrefixes * iters, 0, elapsed);
+}
+
+/**
+ * Sync unicast FIB through NetlinkFibHandler with a large diff against the
+ * programmed routes. Of the synced routes a quarter is unchanged, a quarter
+ * has changed next-hops, and half is new, as many stale routes get deleted
+ */
+static void
+BM_NetlinkFibHandlerSync(
+    folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto netlinkFibWrapper = std::make_unique<NetlinkFibWrapper>();
+  const auto prefixes =
+      PrefixGenerator::ipv6PrefixGenerator(numOfPrefixes * 3 / 2, kBitMaskLen);
+  const auto nextHops = createNextHops(4, kVethNameY);
+  const auto newNextHops = createNextHops(8, kVethNameY);
+  std::chrono::steady_clock::duration elapsed{0};
+
+  for (uint32_t i = 0; i < iters; i++) {
+    std::vector<thrift::UnicastRoute> oldRoutes, newRoutes;
+    for (size_t j = 0; j < prefixes.size(); ++j) {
+      if (j < numOfPrefixes) {
+        oldRoutes.emplace_back(createUnicastRoute(prefixes.at(j), nextHops));
+      }
+      if (j >= numOfPrefixes / 4 and j < numOfPrefixes / 2) {
+        newRoutes.emplace_back(
+            createUnicastRoute(prefixes.at(j), newNextHops));
+      } else if (j < numOfPrefixes / 4 or j >= numOfPrefixes) {
+        newRoutes.emplace_back(createUnicastRoute(prefixes.at(j), nextHops));
+      }
+    }
+    netlinkFibWrapper->fibHandler
+        ->semifuture_syncFib(
+            kFibId,
+            std::make_unique<std::vector<thrift::UnicastRoute>>(
+                std::move(oldRoutes)))
+        .wait();
+
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss(); // Start measuring benchmark time
+    netlinkFibWrapper->fibHandler
+        ->semifuture_syncFib(
+            kFibId,
+            std::make_unique<std::vector<thrift::UnicastRoute>>(
+                std::move(newRoutes)))
+        .wait();
+    suspender.rehire(); // Stop measuring time again
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+
+  setRateCounters(counters, numOfPrefixes * iters, 0, elapsed);
+}
+
 // The parameter is the number of prefixes
 BENCHMARK_PARAM(BM_NetlinkFibHandler, 10);
 BENCHMARK_PARAM(BM_NetlinkFibHandler, 100);
 BENCHMARK_PARAM(BM_NetlinkFibHandler, 1000);
 BENCHMARK_PARAM(BM_NetlinkFibHandler, 10000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkProtocolSocketAck, counters, 1000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkProtocolSocketAck, counters, 10000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkProtocolSocketAck, counters, 100000);
+// The parameter is the number of next-hops of 1000 routes
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkRouteEncodeUnicast, counters, 1);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkRouteEncodeUnicast, counters, 64);
+// The parameter is the MPLS action of next-hops of 1000 routes
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkRouteEncodeMpls, counters, kPush);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkRouteEncodeMpls, counters, kSwap);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkRouteEncodeMpls, counters, kPhp);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkRouteEncodeMpls, counters, kPop);
+// The parameter is the number of routes
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkFibHandlerEcmp, counters, 1000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkFibHandlerEcmp, counters, 10000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkFibHandlerMpls, counters, 1000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkFibHandlerMpls, counters, 10000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkFibHandlerDelete, counters, 1000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkFibHandlerDelete, counters, 10000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkFibHandlerSync, counters, 1000);
+BENCHMARK_COUNTERS_PARAM(BM_NetlinkFibHandlerSync, counters, 10000);
 
 } // namespace openr
 
@@ -8,6 +8,7 @@
 #include <chrono>
 #include <stdexcept>
 
+#include <fb303/ServiceData.h>
 #include <folly/Format.h>
 #include <folly/IPAddress.h>
 #include <folly/Random.h>
@@ -124,6 +125,11 @@ sortNextHops(std::vector<RouteType>& routes) {
   }
 }
 
+int64_t
+getCounter(const std::string& key) {
+  return facebook::fb303::fbData->getCounters()[key];
+}
+
 } // namespace
 
 /**
@@ -346,6 +352,67 @@ TEST_P(FibHandlerFixture, UnicastAddUcmp) {
   EXPECT_EQ(r1, routes->at(0));
 }
 
+//
+// Add/Update/Delete route with backup nexthops. Backup nexthops are programmed
+// as separate route and reported along with primary nexthops
+//
+TEST_P(FibHandlerFixture, UnicastAddBackupNextHops) {
+  const int16_t kClientId = 786;
+  const bool isV4 = GetParam();
+
+  // Create route with two primary and one backup nexthop
+  thrift::UnicastRoute r1 = createUnicastRoute(0, 3, isV4);
+  r1.nextHops_ref()->at(2).isBackup_ref() = true;
+
+  // Add route and verify that it gets added along with backup route
+  handler
+      .semifuture_addUnicastRoute(
+          kClientId, std::make_unique<thrift::UnicastRoute>(r1))
+      .get();
+  auto routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(1, routes->size());
+  sortNextHops(*r1.nextHops_ref());
+  sortNextHops(*routes);
+  EXPECT_EQ(r1, routes->at(0));
+
+  // Update route without backup nexthop and verify backup route is removed
+  *r1.nextHops_ref() = createNextHops(2, isV4);
+  handler
+      .semifuture_addUnicastRoute(
+          kClientId, std::make_unique<thrift::UnicastRoute>(r1))
+      .get();
+  routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(1, routes->size());
+  sortNextHops(*routes);
+  EXPECT_EQ(r1, routes->at(0));
+
+  // Sync route with backup nexthop and verify backup route is added back
+  r1.nextHops_ref()->push_back(createNextHop(2 /* index */, isV4));
+  r1.nextHops_ref()->back().isBackup_ref() = true;
+  handler
+      .semifuture_syncFib(
+          kClientId,
+          std::make_unique<std::vector<thrift::UnicastRoute>>(
+              std::vector<thrift::UnicastRoute>{r1}))
+      .get();
+  routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(1, routes->size());
+  sortNextHops(*r1.nextHops_ref());
+  sortNextHops(*routes);
+  EXPECT_EQ(r1, routes->at(0));
+
+  // Remove route and verify both routes are gone
+  handler
+      .semifuture_deleteUnicastRoute(
+          kClientId, std::make_unique<thrift::IpPrefix>(*r1.dest_ref()))
+      .get();
+  routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  EXPECT_EQ(0, routes->size());
+  auto nlRoutes = nlSock.getAllRoutes().get();
+  ASSERT_TRUE(nlRoutes.hasValue());
+  EXPECT_EQ(0, nlRoutes->size());
+}
+
 //
 // Add/Get route with label push action
 //
@@ -408,6 +475,33 @@ TEST_P(FibHandlerFixture, UnicastSync) {
   ASSERT_EQ(6, routes->size());
   sortNextHops(*routes);
   EXPECT_EQ(rts, *routes);
+
+  // Sync same routes again. Nothing gets re-programmed
+  const auto numAddedBefore = getCounter("nlmock.add_route.sum");
+  const auto numUnchangedBefore =
+      getCounter("fibagent.sync_fib.routes_unchanged.sum");
+  handler
+      .semifuture_syncFib(
+          kClientId, std::make_unique<std::vector<thrift::UnicastRoute>>(rts))
+      .get();
+  EXPECT_EQ(numAddedBefore, getCounter("nlmock.add_route.sum"));
+  EXPECT_EQ(
+      numUnchangedBefore + 6,
+      getCounter("fibagent.sync_fib.routes_unchanged.sum"));
+
+  // Sync subset of routes. Only stale routes get deleted
+  const auto numDeletedBefore =
+      getCounter("fibagent.sync_fib.routes_deleted.sum");
+  rts.resize(4);
+  handler
+      .semifuture_syncFib(
+          kClientId, std::make_unique<std::vector<thrift::UnicastRoute>>(rts))
+      .get();
+  EXPECT_EQ(numAddedBefore, getCounter("nlmock.add_route.sum"));
+  EXPECT_EQ(
+      numDeletedBefore + 2, getCounter("fibagent.sync_fib.routes_deleted.sum"));
+  routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(4, routes->size());
 }
 
 //
@@ -760,6 +854,110 @@ TEST_P(FibHandlerFixture, MplsMultipleClient) {
   }
 }
 
+//
+// Interface cache is initialized with existing links and follows link events
+// afterwards, including renames
+//
+TEST(NetlinkFibHandler, InterfaceCacheFromLinkEvents) {
+  const int16_t kClientId = 786;
+  folly::EventBase evb;
+  fbnl::MockNetlinkProtocolSocket nlSock(&evb);
+  ASSERT_EQ(0, nlSock.addLink(fbnl::utils::createLink(1, "eth0")).get());
+  NetlinkFibHandler handler(&nlSock);
+
+  // Add link after creation of handler and route via it
+  ASSERT_EQ(0, nlSock.addLink(fbnl::utils::createLink(2, "eth1")).get());
+  auto r1 = createUnicastRoute(0, 1, false);
+  r1.nextHops_ref()->at(0).address_ref()->ifName_ref() = "eth1";
+  handler
+      .semifuture_addUnicastRoute(
+          kClientId, std::make_unique<thrift::UnicastRoute>(r1))
+      .get();
+  auto routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(1, routes->size());
+  EXPECT_EQ(r1, routes->at(0));
+
+  // Rename link. Route is reported via new name
+  ASSERT_EQ(0, nlSock.addLink(fbnl::utils::createLink(2, "eth2")).get());
+  r1.nextHops_ref()->at(0).address_ref()->ifName_ref() = "eth2";
+  routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(1, routes->size());
+  EXPECT_EQ(r1, routes->at(0));
+}
+
+//
+// Routes with the same next-hops share kernel nexthop objects if enabled.
+// Objects are deleted along with the last route referring to them
+//
+TEST(NetlinkFibHandler, UnicastNextHopObjects) {
+  const int16_t kClientId = 786;
+  folly::EventBase evb;
+  fbnl::MockNetlinkProtocolSocket nlSock(&evb);
+  for (size_t i = 0; i < kInterfaces.size(); ++i) {
+    ASSERT_EQ(
+        0,
+        nlSock
+            .addLink(
+                fbnl::utils::createLink(i + 1, kInterfaces.at(i), true, false))
+            .get());
+  }
+  NetlinkFibHandler handler(&nlSock, true /* enableNextHopObjects */);
+
+  // Add two routes with same two next-hops. Expect two nexthop objects and
+  // one group
+  auto r1 = createUnicastRoute(0, 2, false);
+  auto r2 = r1;
+  r2.dest_ref() = *createUnicastRoute(1, 1, false).dest_ref();
+  handler
+      .semifuture_addUnicastRoutes(
+          kClientId,
+          std::make_unique<std::vector<thrift::UnicastRoute>>(
+              std::vector<thrift::UnicastRoute>{r1, r2}))
+      .get();
+  EXPECT_EQ(3, nlSock.getNumNextHopObjects());
+  auto routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(2, routes->size());
+  sortNextHops(*routes);
+  sortNextHops(*r1.nextHops_ref());
+  sortNextHops(*r2.nextHops_ref());
+  EXPECT_EQ(r1, routes->at(0));
+  EXPECT_EQ(r2, routes->at(1));
+
+  // Add next-hop to second route. Expect new nexthop object and group, first
+  // group is still in use
+  r2.nextHops_ref()->emplace_back(createNextHop(2, false));
+  sortNextHops(*r2.nextHops_ref());
+  handler
+      .semifuture_addUnicastRoute(
+          kClientId, std::make_unique<thrift::UnicastRoute>(r2))
+      .get();
+  EXPECT_EQ(5, nlSock.getNumNextHopObjects());
+  routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(2, routes->size());
+  sortNextHops(*routes);
+  EXPECT_EQ(r2, routes->at(1));
+
+  // Delete first route. Its group gets deleted, next-hops are still in use
+  handler
+      .semifuture_deleteUnicastRoute(
+          kClientId, std::make_unique<thrift::IpPrefix>(*r1.dest_ref()))
+      .get();
+  EXPECT_EQ(4, nlSock.getNumNextHopObjects());
+
+  // Sync with first route only. Second route and its objects get deleted
+  handler
+      .semifuture_syncFib(
+          kClientId,
+          std::make_unique<std::vector<thrift::UnicastRoute>>(
+              std::vector<thrift::UnicastRoute>{r1}))
+      .get();
+  EXPECT_EQ(3, nlSock.getNumNextHopObjects());
+  routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(1, routes->size());
+  sortNextHops(*routes);
+  EXPECT_EQ(r1, routes->at(0));
+}
+
 //
 // instantiate parameterized tests
 //
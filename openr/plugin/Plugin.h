@@ -22,10 +22,13 @@
 
 namespace openr {
 struct PluginArgs {
+  // Requests are moved into PrefixManager. For bulk loads, e.g. of a BGP
+  // table, set `batchInProgress` on all requests of the batch and complete it
+  // with END_OF_RIB, so prefixes are advertised to KvStore once at the end
   messaging::ReplicateQueue<thrift::PrefixUpdateRequest>& prefixUpdatesQueue;
   messaging::ReplicateQueue<openr::thrift::RouteDatabaseDelta>&
       staticRoutesUpdateQueue;
-  messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  messaging::RQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
   std::shared_ptr<const Config> config;
   std::shared_ptr<wangle::SSLContextConfig> sslContext;
 };
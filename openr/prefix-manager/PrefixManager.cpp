@@ -26,7 +26,7 @@ PrefixManager::PrefixManager(
     messaging::ReplicateQueue<thrift::RouteDatabaseDelta>&
         staticRouteUpdatesQueue,
     messaging::RQueue<thrift::PrefixUpdateRequest> prefixUpdateRequestQueue,
-    messaging::RQueue<DecisionRouteUpdate> decisionRouteUpdatesQueue,
+    messaging::RQueue<DecisionRouteUpdatePtr> decisionRouteUpdatesQueue,
     std::shared_ptr<const Config> config,
     KvStore* kvStore,
     bool enablePerfMeasurement,
@@ -37,6 +37,7 @@ PrefixManager::PrefixManager(
       enablePerfMeasurement_{enablePerfMeasurement},
       ttlKeyInKvStore_(std::chrono::milliseconds(
           *config->getKvStoreConfig().key_ttl_ms_ref())),
+      prefixDbKeyShards_(config->getPrefixDbKeyShards()),
       allAreas_{config->getAreaIds()} {
   CHECK(kvStore_);
   CHECK(config);
@@ -57,12 +58,21 @@ PrefixManager::PrefixManager(
   // Create throttled update state
   syncKvStoreThrottled_ = std::make_unique<AsyncThrottle>(
       getEvb(), Constants::kPrefixMgrKvThrottleTimeout, [this]() noexcept {
-        if (initialSyncKvStoreTimer_->isScheduled()) {
+        if (initialSyncKvStoreTimer_->isScheduled() or bulkLoadInProgress_) {
           return;
         }
         syncKvStore();
       });
 
+  bulkLoadTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+    LOG(WARNING) << "No end-of-RIB within "
+                 << Constants::kPrefixMgrBulkLoadIdleTimeout.count()
+                 << "s of last bulk load request";
+    fb303::fbData->addStatValue(
+        "prefix_manager.bulk_load_timeouts", 1, fb303::COUNT);
+    endBulkLoad();
+  });
+
   // Schedule fiber to read prefix updates messages
   addFiberTask(
       [q = std::move(prefixUpdateRequestQueue), this]() mutable noexcept {
@@ -87,9 +97,19 @@ PrefixManager::PrefixManager(
             }
           }
 
+          if (*update.batchInProgress_ref()) {
+            if (not bulkLoadInProgress_) {
+              LOG(INFO) << "Bulk load of prefixes started";
+              bulkLoadInProgress_ = true;
+            }
+            bulkLoadTimer_->scheduleTimeout(
+                Constants::kPrefixMgrBulkLoadIdleTimeout);
+          }
+
           switch (*update.cmd_ref()) {
           case thrift::PrefixUpdateCommand::ADD_PREFIXES:
-            advertisePrefixesImpl(*update.prefixes_ref(), dstAreas);
+            // NOTE: prefixes are moved, request is consumed
+            advertisePrefixesImpl(std::move(*update.prefixes_ref()), dstAreas);
             break;
           case thrift::PrefixUpdateCommand::WITHDRAW_PREFIXES:
             withdrawPrefixesImpl(*update.prefixes_ref());
@@ -103,11 +123,17 @@ PrefixManager::PrefixManager(
             syncPrefixesByTypeImpl(
                 update.type_ref().value(), *update.prefixes_ref(), dstAreas);
             break;
+          case thrift::PrefixUpdateCommand::END_OF_RIB:
+            break;
           default:
             LOG(FATAL) << "Unknown command received. "
                        << static_cast<int>(*update.cmd_ref());
             break;
           }
+
+          if (bulkLoadInProgress_ and not *update.batchInProgress_ref()) {
+            endBulkLoad();
+          }
         }
       });
 
@@ -123,7 +149,7 @@ PrefixManager::PrefixManager(
 
           try {
             VLOG(2) << "Received RIB updates from Decision";
-            processDecisionRouteUpdates(std::move(maybeThriftObj).value());
+            processDecisionRouteUpdates(*maybeThriftObj.value());
           } catch (const std::exception&) {
 #if FOLLY_USE_SYMBOLIZER
             // collect stack strace then fail the process
@@ -182,6 +208,7 @@ PrefixManager::~PrefixManager() {
   getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
     // destory timers
     initialSyncKvStoreTimer_.reset();
+    bulkLoadTimer_.reset();
     syncKvStoreThrottled_.reset();
   });
   kvStoreClient_.reset();
@@ -234,6 +261,10 @@ PrefixManager::buildOriginatedPrefixDb(
     }
 
     // ATTN: upon initialization, no supporting routes
+    auto& prefixLengths = network.first.isV4() ? originatedPrefixLengthsV4_
+                                               : originatedPrefixLengthsV6_;
+    prefixLengths.emplace(network.second);
+    pendingOriginatedPrefixes_.emplace(network);
     originatedPrefixDb_.emplace(
         network,
         OriginatedRoute(
@@ -244,7 +275,8 @@ PrefixManager::buildOriginatedPrefixDb(
 }
 
 std::unordered_set<std::string>
-PrefixManager::updateKvStorePrefixEntry(PrefixEntry const& entry) {
+PrefixManager::updateKvStorePrefixEntry(
+    PrefixEntry const& entry, KvStoreKeyBatch& batch) {
   std::unordered_set<std::string> prefixKeys;
 
   auto dstAreas = entry.dstAreas; // intended copy
@@ -258,6 +290,16 @@ PrefixManager::updateKvStorePrefixEntry(PrefixEntry const& entry) {
 
   for (const auto& toArea : dstAreas) {
     // TODO: run ingress policy
+    if (prefixDbKeyShards_) {
+      auto shardKey = getPrefixDbShardKey(*prefixEntry.prefix_ref(), toArea);
+      auto& shard = prefixDbShards_[shardKey];
+      shard.area = toArea;
+      shard.entries[*prefixEntry.prefix_ref()] = prefixEntry;
+      batch.shardKeys.emplace(shardKey);
+      prefixKeys.emplace(std::move(shardKey));
+      continue;
+    }
+
     auto prefixKey =
         PrefixKey(nodeId_, toIPNetwork(*prefixEntry.prefix_ref()), toArea)
             .getPrefixKey();
@@ -268,39 +310,129 @@ PrefixManager::updateKvStorePrefixEntry(PrefixEntry const& entry) {
     }
     auto prefixDbStr = writeThriftObjStr(std::move(prefixDb), serializer_);
 
-    bool changed = kvStoreClient_->persistKey(
-        AreaId{toArea}, prefixKey, prefixDbStr, ttlKeyInKvStore_);
-    fb303::fbData->addStatValue(
-        "prefix_manager.route_advertisements", 1, fb303::SUM);
-    VLOG_IF(1, changed) << "[ROUTE ADVERTISEMENT] "
-                        << "Area: " << toArea << ", "
-                        << "Type: " << toString(*prefixEntry.type_ref()) << ", "
-                        << toString(prefixEntry, VLOG_IS_ON(2));
+    batch.keyVals[toArea][prefixKey] = std::move(prefixDbStr);
+    batch.entries[prefixKey] = &prefixEntry;
     prefixKeys.emplace(std::move(prefixKey));
   }
   return prefixKeys;
 }
 
+std::string
+PrefixManager::getPrefixDbShardKey(
+    thrift::IpPrefix const& prefix, std::string const& area) const {
+  return folly::sformat(
+      "{}{}:{}:shard{}",
+      Constants::kPrefixDbMarker.toString(),
+      nodeId_,
+      area,
+      std::hash<thrift::IpPrefix>()(prefix) % prefixDbKeyShards_);
+}
+
 void
-PrefixManager::syncKvStore() {
-  std::vector<std::pair<std::string, std::string>> keyVals;
-  std::unordered_set<std::string> nowAdvertisingKeys;
+PrefixManager::persistKvStoreKeyBatch(KvStoreKeyBatch const& batch) {
+  for (auto const& [area, keyVals] : batch.keyVals) {
+    auto changedKeys =
+        kvStoreClient_->persistKeys(AreaId{area}, keyVals, ttlKeyInKvStore_);
+    fb303::fbData->addStatValue(
+        "prefix_manager.route_advertisements", keyVals.size(), fb303::SUM);
+    if (not VLOG_IS_ON(1)) {
+      continue;
+    }
+    for (auto const& key : changedKeys) {
+      auto it = batch.entries.find(key);
+      if (it == batch.entries.end()) {
+        VLOG(1) << "[ROUTE ADVERTISEMENT] "
+                << "Area: " << area << ", "
+                << "Key: " << key << ", "
+                << "Prefixes: " << prefixDbShards_.at(key).entries.size();
+        continue;
+      }
+      auto const& prefixEntry = *it->second;
+      VLOG(1) << "[ROUTE ADVERTISEMENT] "
+              << "Area: " << area << ", "
+              << "Type: " << toString(*prefixEntry.type_ref()) << ", "
+              << toString(prefixEntry, VLOG_IS_ON(2));
+    }
+  }
+}
 
-  LOG(INFO) << "Syncing " << prefixMap_.size()
-            << " route advertisements in KvStore";
+bool
+PrefixManager::isAdvertisingKey(const std::string& key) const {
+  if (prefixDbShards_.count(key)) {
+    return true;
+  }
+  auto prefixKey = PrefixKey::fromStr(key);
+  if (not prefixKey.hasValue()) {
+    return false;
+  }
+  auto it = advertisedKeys_.find(prefixKey->getIpPrefix());
+  return it != advertisedKeys_.end() and it->second.count(key);
+}
 
-  for (auto const& [prefix, typeToPrefixes] : prefixMap_) {
-    CHECK(not typeToPrefixes.empty()) << "Unexpected empty entry";
-    auto bestType = *selectBestPrefixMetrics(typeToPrefixes).begin();
-    auto& bestEntry = typeToPrefixes.at(bestType);
-    addPerfEventIfNotExist(
-        addingEvents_[bestType][prefix], "UPDATE_KVSTORE_THROTTLED");
-    for (const auto& key : updateKvStorePrefixEntry(bestEntry)) {
-      nowAdvertisingKeys.emplace(key);
+void
+PrefixManager::endBulkLoad() {
+  LOG(INFO) << "Bulk load of prefixes completed, " << pendingPrefixes_.size()
+            << " prefixes to sync";
+  bulkLoadInProgress_ = false;
+  bulkLoadTimer_->cancelTimeout();
+  syncKvStoreThrottled_->operator()();
+}
+
+void
+PrefixManager::syncKvStore() {
+  LOG(INFO) << "Syncing " << pendingPrefixes_.size() << " of "
+            << prefixMap_.size() << " route advertisements in KvStore";
+
+  // Only prefixes changed since last sync are re-evaluated. Keys advertised
+  // before for such a prefix but not any more are withdrawn along with the
+  // learned keys we don't advertise. Keys of all prefixes are batched into
+  // single KvStore request per area.
+  KvStoreKeyBatch batch;
+  for (auto const& prefix : pendingPrefixes_) {
+    std::unordered_set<std::string> nowAdvertisingKeys;
+    auto typeIt = prefixMap_.find(prefix);
+    if (typeIt != prefixMap_.end()) {
+      auto const& typeToPrefixes = typeIt->second;
+      CHECK(not typeToPrefixes.empty()) << "Unexpected empty entry";
+      auto bestType = selectBestPrefixMetricsKey(typeToPrefixes).value();
+      auto& bestEntry = typeToPrefixes.at(bestType);
+      addPerfEventIfNotExist(
+          addingEvents_[bestType][prefix], "UPDATE_KVSTORE_THROTTLED");
+      nowAdvertisingKeys = updateKvStorePrefixEntry(bestEntry, batch);
+    }
+
+    auto keysIt = advertisedKeys_.find(prefix);
+    if (keysIt != advertisedKeys_.end()) {
+      for (auto const& key : keysIt->second) {
+        if (nowAdvertisingKeys.count(key)) {
+          continue;
+        }
+        // sharded key is withdrawn only once all its prefixes are gone
+        if (auto shardIt = prefixDbShards_.find(key);
+            shardIt != prefixDbShards_.end()) {
+          shardIt->second.entries.erase(prefix);
+          batch.shardKeys.emplace(key);
+        } else {
+          keysToClear_.emplace(key);
+        }
+      }
+    }
+    for (auto const& key : nowAdvertisingKeys) {
       keysToClear_.erase(key);
     }
+    if (nowAdvertisingKeys.empty()) {
+      if (keysIt != advertisedKeys_.end()) {
+        advertisedKeys_.erase(keysIt);
+      }
+    } else {
+      advertisedKeys_[prefix] = std::move(nowAdvertisingKeys);
+    }
   }
+  pendingPrefixes_.clear();
 
+  // area -> key -> value to set on withdraw
+  std::unordered_map<std::string, std::unordered_map<std::string, std::string>>
+      keyValsToClear;
   thrift::PrefixDatabase deletedPrefixDb;
   *deletedPrefixDb.thisNodeName_ref() = nodeId_;
   deletedPrefixDb.deletePrefix_ref() = true;
@@ -309,7 +441,36 @@ PrefixManager::syncKvStore() {
     addPerfEventIfNotExist(
         deletedPrefixDb.perfEvents_ref().value(), "WITHDRAW_THROTTLED");
   }
+
+  // Pack prefixes of changed shards into their keys
+  for (auto const& key : batch.shardKeys) {
+    auto shardIt = prefixDbShards_.find(key);
+    auto& shard = shardIt->second;
+    if (shard.entries.empty()) {
+      VLOG(1) << "[ROUTE WITHDRAW] "
+              << "Area: " << shard.area << ", "
+              << "Key: " << key;
+      keyValsToClear[shard.area].emplace(
+          key, writeThriftObjStr(deletedPrefixDb, serializer_));
+      keysToClear_.erase(key);
+      prefixDbShards_.erase(shardIt);
+      continue;
+    }
+    std::vector<thrift::PrefixEntry> entries;
+    entries.reserve(shard.entries.size());
+    for (auto const& [_, entry] : shard.entries) {
+      entries.emplace_back(entry);
+    }
+    batch.keyVals[shard.area][key] = writeThriftObjStr(
+        createPrefixDb(nodeId_, entries, shard.area), serializer_);
+  }
+  persistKvStoreKeyBatch(batch);
+
   for (auto const& key : keysToClear_) {
+    // learned key of prefix we still advertise, i.e. our own advertisement
+    if (isAdvertisingKey(key)) {
+      continue;
+    }
     auto prefixKey = PrefixKey::fromStr(key);
     if (prefixKey.hasValue()) {
       // Needed for backward compatibility
@@ -321,29 +482,33 @@ PrefixManager::syncKvStore() {
               << toString(*entry.prefix_ref());
       fb303::fbData->addStatValue(
           "prefix_manager.route_withdraws", 1, fb303::SUM);
-    } else {
-      LOG(ERROR) << "[ROUTE WITHDRAW] Removing old key " << key
-                 << " from KvStore";
+      // one last key set with empty DB and deletePrefix set signifies
+      // withdraw then the key should ttl out
+      keyValsToClear[prefixKey->getPrefixArea()].emplace(
+          key, writeThriftObjStr(deletedPrefixDb, serializer_));
+      continue;
     }
 
-    // one last key set with empty DB and deletePrefix set signifies withdraw
-    // then the key should ttl out
-    kvStoreClient_->clearKey(
-        AreaId{prefixKey->getPrefixArea()},
-        key,
-        writeThriftObjStr(std::move(deletedPrefixDb), serializer_),
-        ttlKeyInKvStore_);
+    // Sharded or old key, area of which is not known. Withdraw it with empty
+    // DB from any area it exists in
+    LOG(ERROR) << "[ROUTE WITHDRAW] Removing old key " << key
+               << " from KvStore";
+    deletedPrefixDb.prefixEntries_ref()->clear();
+    for (auto const& area : allAreas_) {
+      keyValsToClear[area].emplace(
+          key, writeThriftObjStr(deletedPrefixDb, serializer_));
+    }
+  }
+  for (auto& [area, keyVals] : keyValsToClear) {
+    kvStoreClient_->clearKeys(
+        AreaId{area}, std::move(keyVals), ttlKeyInKvStore_);
   }
 
-  // anything we don't advertise next time, we need to clear
-  keysToClear_ = std::move(nowAdvertisingKeys);
+  keysToClear_.clear();
 
   // Update flat counters
-  size_t num_prefixes = 0;
-  for (auto const& kv : prefixMap_) {
-    num_prefixes += kv.second.size();
-  }
-  fb303::fbData->setCounter("prefix_manager.received_prefixes", num_prefixes);
+  fb303::fbData->setCounter(
+      "prefix_manager.received_prefixes", numPrefixEntries_);
   fb303::fbData->setCounter(
       "prefix_manager.advertised_prefixes", prefixMap_.size());
 }
@@ -357,7 +522,7 @@ PrefixManager::advertisePrefixes(std::vector<thrift::PrefixEntry> prefixes) {
     p = std::move(p),
     prefixes = std::move(prefixes)
   ]() mutable noexcept {
-    p.setValue(advertisePrefixesImpl(prefixes, allAreas_));
+    p.setValue(advertisePrefixesImpl(std::move(prefixes), allAreas_));
   });
   return sf;
 }
@@ -540,24 +705,25 @@ PrefixManager::filterAndAddAdvertisedRoute(
 // helpers for modifying our Prefix Db
 bool
 PrefixManager::advertisePrefixesImpl(
-    const std::vector<thrift::PrefixEntry>& prefixes,
+    std::vector<thrift::PrefixEntry> prefixes,
     const std::unordered_set<std::string>& dstAreas) {
   std::vector<PrefixEntry> toAddOrUpdate;
-  for (const auto& prefix : prefixes) {
-    toAddOrUpdate.emplace_back(prefix, dstAreas);
+  toAddOrUpdate.reserve(prefixes.size());
+  for (auto& prefix : prefixes) {
+    toAddOrUpdate.emplace_back(std::move(prefix), dstAreas);
   }
-  return advertisePrefixesImpl(toAddOrUpdate);
+  return advertisePrefixesImpl(std::move(toAddOrUpdate));
 }
 
 // helpers for modifying our Prefix Db
 bool
-PrefixManager::advertisePrefixesImpl(
-    const std::vector<PrefixEntry>& prefixeInfos) {
+PrefixManager::advertisePrefixesImpl(std::vector<PrefixEntry>&& prefixeInfos) {
   bool updated{false};
 
-  for (const auto& entry : prefixeInfos) {
-    const auto& type = *entry.tPrefixEntry.type_ref();
-    const auto& prefix = *entry.tPrefixEntry.prefix_ref();
+  for (auto& entry : prefixeInfos) {
+    // copies, entry gets moved into prefixMap_
+    const auto type = *entry.tPrefixEntry.type_ref();
+    const auto prefix = *entry.tPrefixEntry.prefix_ref();
 
     auto& prefixes = prefixMap_[prefix];
     auto prefixIt = prefixes.find(type);
@@ -567,11 +733,13 @@ PrefixManager::advertisePrefixesImpl(
       continue;
     }
 
+    pendingPrefixes_.emplace(prefix);
     if (prefixIt == prefixes.end()) {
-      prefixes.emplace(type, entry);
+      ++numPrefixEntries_;
+      prefixes.emplace(type, std::move(entry));
       addPerfEventIfNotExist(addingEvents_[type][prefix], "ADD_PREFIX");
     } else {
-      prefixIt->second = entry;
+      prefixIt->second = std::move(entry);
       addPerfEventIfNotExist(addingEvents_[type][prefix], "UPDATE_PREFIX");
     }
     updated = true;
@@ -603,7 +771,10 @@ PrefixManager::withdrawPrefixesImpl(
   }
 
   for (const auto& prefix : prefixes) {
-    prefixMap_.at(*prefix.prefix_ref()).erase(*prefix.type_ref());
+    if (prefixMap_.at(*prefix.prefix_ref()).erase(*prefix.type_ref())) {
+      --numPrefixEntries_;
+    }
+    pendingPrefixes_.emplace(*prefix.prefix_ref());
     addingEvents_.at(*prefix.type_ref()).erase(*prefix.prefix_ref());
     if (prefixMap_.at(*prefix.prefix_ref()).empty()) {
       prefixMap_.erase(*prefix.prefix_ref());
@@ -643,7 +814,7 @@ PrefixManager::syncPrefixesByTypeImpl(
     toRemove.emplace_back(prefixMap_.at(prefix).at(type).tPrefixEntry);
   }
   bool updated = false;
-  updated |= advertisePrefixesImpl(toAddOrUpdate, dstAreas);
+  updated |= advertisePrefixesImpl(std::move(toAddOrUpdate), dstAreas);
   updated |= withdrawPrefixesImpl(toRemove);
   return updated;
 }
@@ -671,12 +842,19 @@ PrefixManager::aggregatesToAdvertise(const folly::CIDRNetwork& prefix) {
     return;
   }
 
-  for (auto& [network, route] : originatedPrefixDb_) {
-    // folly::CIDRNetwork.first -> IPAddress
-    // folly::CIDRNetwork.second -> cidr length
-    if (not prefix.first.inSubnet(network.first, network.second)) {
+  // Look up covering originated prefix of every configured length
+  // folly::CIDRNetwork.first -> IPAddress
+  // folly::CIDRNetwork.second -> cidr length
+  const auto& prefixLengths = prefix.first.isV4() ? originatedPrefixLengthsV4_
+                                                  : originatedPrefixLengthsV6_;
+  for (const auto prefixLength : prefixLengths) {
+    const folly::CIDRNetwork network(
+        prefix.first.mask(prefixLength), prefixLength);
+    auto originatedPrefixIt = originatedPrefixDb_.find(network);
+    if (originatedPrefixIt == originatedPrefixDb_.end()) {
       continue;
     }
+    auto& route = originatedPrefixIt->second;
 
     VLOG(1) << "[ROUTE ORIGINATION] Adding supporting route "
             << folly::IPAddress::networkToString(prefix)
@@ -688,6 +866,7 @@ PrefixManager::aggregatesToAdvertise(const folly::CIDRNetwork& prefix) {
 
     // mapping: OriginatedPrefix -> RIB prefixEntries
     route.supportingRoutes.emplace(prefix);
+    pendingOriginatedPrefixes_.emplace(network);
   }
 }
 
@@ -711,6 +890,7 @@ PrefixManager::aggregatesToWithdraw(const folly::CIDRNetwork& prefix) {
             << folly::IPAddress::networkToString(network);
 
     route.supportingRoutes.erase(prefix);
+    pendingOriginatedPrefixes_.emplace(network);
   }
 
   // clean local caching
@@ -719,16 +899,32 @@ PrefixManager::aggregatesToWithdraw(const folly::CIDRNetwork& prefix) {
 
 void
 PrefixManager::processDecisionRouteUpdates(
-    DecisionRouteUpdate&& decisionRouteUpdate) {
+    const DecisionRouteUpdate& decisionRouteUpdate) {
   std::vector<PrefixEntry> advertisePrefixes{};
   std::vector<thrift::PrefixEntry> withdrawPrefixes{};
   thrift::RouteDatabaseDelta routeUpdates;
 
+  // Redisrtibute RIB route ONLY when there are multiple `areaId` configured.
+  const bool redistribute = allAreas_.size() > 1;
+  if (redistribute) {
+    advertisePrefixes.reserve(decisionRouteUpdate.unicastRoutesToUpdate.size());
+    withdrawPrefixes.reserve(decisionRouteUpdate.unicastRoutesToDelete.size());
+  }
+
   // Add/Update unicast routes to update
   // Self originated (include routes imported from local BGP)
   // won't show up in decisionRouteUpdate.
-  for (auto& [prefix, route] : decisionRouteUpdate.unicastRoutesToUpdate) {
-    auto& prefixEntry = route.bestPrefixEntry;
+  for (const auto& [prefix, route] :
+       decisionRouteUpdate.unicastRoutesToUpdate) {
+    // populate originated prefixes to be advertised
+    aggregatesToAdvertise(prefix);
+
+    if (not redistribute) {
+      continue;
+    }
+
+    // NOTE: copy on purpose, update is shared with other readers
+    auto prefixEntry = route.bestPrefixEntry;
 
     // NOTE: future expansion - run egress policy here
 
@@ -743,28 +939,30 @@ PrefixManager::processDecisionRouteUpdates(
     // 3. normalize to RIB routes
     prefixEntry.type_ref() = thrift::PrefixType::RIB;
 
+    // not redistributed back into areas of next-hops
     auto dstAreas = allAreas_;
     for (const auto& nh : route.nexthops) {
       if (nh.area_ref().has_value()) {
         dstAreas.erase(*nh.area_ref());
       }
     }
-    advertisePrefixes.emplace_back(prefixEntry, dstAreas);
-
-    // populate originated prefixes to be advertised
-    aggregatesToAdvertise(prefix);
+    advertisePrefixes.emplace_back(std::move(prefixEntry), std::move(dstAreas));
   }
 
   // Delete unicast routes
   for (const auto& prefix : decisionRouteUpdate.unicastRoutesToDelete) {
-    withdrawPrefixes.emplace_back(
-        createPrefixEntry(toIpPrefix(prefix), thrift::PrefixType::RIB));
-
     // populate originated prefixes to be withdrawn
     aggregatesToWithdraw(prefix);
+
+    if (redistribute) {
+      withdrawPrefixes.emplace_back(
+          createPrefixEntry(toIpPrefix(prefix), thrift::PrefixType::RIB));
+    }
   }
 
-  for (auto& [network, route] : originatedPrefixDb_) {
+  // Evaluate only originated prefixes whose supporting routes changed
+  for (const auto& network : pendingOriginatedPrefixes_) {
+    auto& route = originatedPrefixDb_.at(network);
     bool installToFib = route.originatedPrefix.install_to_fib_ref().has_value()
         ? *route.originatedPrefix.install_to_fib_ref()
         : true;
@@ -798,6 +996,7 @@ PrefixManager::processDecisionRouteUpdates(
                    << folly::IPAddress::networkToString(network);
     }
   }
+  pendingOriginatedPrefixes_.clear();
 
   // push originatedRoutes update via replicate queue
   if (routeUpdates.unicastRoutesToUpdate_ref()->size() or
@@ -807,11 +1006,10 @@ PrefixManager::processDecisionRouteUpdates(
     staticRouteUpdatesQueue_.push(std::move(routeUpdates));
   }
 
-  // Redisrtibute RIB route ONLY when there are multiple `areaId` configured .
-  // We want to keep processDecisionRouteUpdates() running as dynamic
-  // configuration could add/remove areas.
-  if (allAreas_.size() > 1) {
-    advertisePrefixesImpl(advertisePrefixes);
+  // Redistributed routes of whole update are synced to KvStore with a single
+  // throttled write per area
+  if (redistribute) {
+    advertisePrefixesImpl(std::move(advertisePrefixes));
     withdrawPrefixesImpl(withdrawPrefixes);
   }
 
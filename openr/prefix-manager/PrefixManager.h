@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <set>
+
 #include <folly/IPAddress.h>
 #include <folly/Optional.h>
 #include <folly/futures/Future.h>
@@ -35,7 +37,7 @@ class PrefixManager final : public OpenrEventBase {
           staticRoutesUpdateQueue,
       // consumer queue
       messaging::RQueue<thrift::PrefixUpdateRequest> prefixUpdateRequestQueue,
-      messaging::RQueue<DecisionRouteUpdate> decisionRouteUpdatesQueue,
+      messaging::RQueue<DecisionRouteUpdatePtr> decisionRouteUpdatesQueue,
       // config
       std::shared_ptr<const Config> config,
       // raw ptr for modules
@@ -137,9 +139,9 @@ class PrefixManager final : public OpenrEventBase {
    * @return true if the db is modified
    */
   bool advertisePrefixesImpl(
-      const std::vector<thrift::PrefixEntry>& prefixes,
+      std::vector<thrift::PrefixEntry> prefixes,
       const std::unordered_set<std::string>& dstAreas);
-  bool advertisePrefixesImpl(const std::vector<PrefixEntry>& prefixes);
+  bool advertisePrefixesImpl(std::vector<PrefixEntry>&& prefixes);
   bool withdrawPrefixesImpl(const std::vector<thrift::PrefixEntry>& prefixes);
   bool withdrawPrefixesByTypeImpl(thrift::PrefixType type);
   bool syncPrefixesByTypeImpl(
@@ -147,9 +149,16 @@ class PrefixManager final : public OpenrEventBase {
       const std::vector<thrift::PrefixEntry>& prefixes,
       const std::unordered_set<std::string>& dstAreas);
 
-  // Util function to interact KvStore to inject/withdraw keys
+  // Util function to interact KvStore to inject/withdraw keys of prefixes
+  // changed since last sync
   void syncKvStore();
 
+  // Complete bulk load of prefix updates and advertise them to KvStore
+  void endBulkLoad();
+
+  // whether key is one of the prefix keys currently advertised by us
+  bool isAdvertisingKey(const std::string& key) const;
+
   /*
    * [Route Origination/Aggregation]
    *
@@ -176,13 +185,41 @@ class PrefixManager final : public OpenrEventBase {
    */
   void aggregatesToWithdraw(const folly::CIDRNetwork& prefix);
 
-  // add entry.tPrefixEntry in entry.dstAreas kvstore, return a set of per
-  // prefix key name for successful injected areas
+  // Prefix keys of one syncKvStore() pass, set in KvStore with a single
+  // request per area rather than one request per key
+  struct KvStoreKeyBatch {
+    // area -> key -> serialized prefix db
+    std::unordered_map<
+        std::string,
+        std::unordered_map<std::string, std::string>>
+        keyVals;
+    // key -> advertised prefix entry, for logging
+    std::unordered_map<std::string, thrift::PrefixEntry const*> entries;
+    // sharded keys whose prefixes changed
+    std::unordered_set<std::string> shardKeys;
+  };
+
+  // Prefixes packed into one sharded key
+  struct PrefixDbShard {
+    std::string area;
+    std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry> entries;
+  };
+
+  // key of shard in area the prefix is packed into
+  std::string getPrefixDbShardKey(
+      thrift::IpPrefix const& prefix, std::string const& area) const;
+
+  // add entry.tPrefixEntry in entry.dstAreas to batch, return a set of per
+  // prefix key name for injected areas
   std::unordered_set<std::string> updateKvStorePrefixEntry(
-      PrefixEntry const& entry);
+      PrefixEntry const& entry, KvStoreKeyBatch& batch);
+
+  // persist batched keys in KvStore
+  void persistKvStoreKeyBatch(KvStoreKeyBatch const& batch);
 
   // process decision route update, inject routes to different areas
-  void processDecisionRouteUpdates(DecisionRouteUpdate&& decisionRouteUpdate);
+  void processDecisionRouteUpdates(
+      const DecisionRouteUpdate& decisionRouteUpdate);
 
   // add event named updateEvent to perfEvents if it has value and the last
   // element is not already updateEvent
@@ -207,9 +244,18 @@ class PrefixManager final : public OpenrEventBase {
   std::unique_ptr<AsyncThrottle> syncKvStoreThrottled_;
   std::unique_ptr<folly::AsyncTimeout> initialSyncKvStoreTimer_;
 
+  // Set while a bulk load of prefix updates is in progress, syncKvStore() is
+  // deferred until end of batch. Timer ends the load if its client went idle
+  bool bulkLoadInProgress_{false};
+  std::unique_ptr<folly::AsyncTimeout> bulkLoadTimer_;
+
   // TTL for a key in the key value store
   const std::chrono::milliseconds ttlKeyInKvStore_;
 
+  // number of sharded keys per area prefixes are packed into, 0 if every
+  // prefix is advertised with its own key
+  const size_t prefixDbKeyShards_{0};
+
   // kvStoreClient for persisting our prefix db
   std::unique_ptr<KvStoreClientInternal> kvStoreClient_{nullptr};
 
@@ -234,6 +280,20 @@ class PrefixManager final : public OpenrEventBase {
   // anything we no longer wish to advertise
   std::unordered_set<std::string> keysToClear_;
 
+  // prefixes added, updated or withdrawn since last syncKvStore(). Sync only
+  // re-evaluates these instead of whole prefixMap_
+  std::unordered_set<thrift::IpPrefix> pendingPrefixes_;
+
+  // keys advertised in KvStore per prefix as of last syncKvStore()
+  std::unordered_map<thrift::IpPrefix, std::unordered_set<std::string>>
+      advertisedKeys_;
+
+  // total number of entries across all prefixes and types in prefixMap_
+  size_t numPrefixEntries_{0};
+
+  // sharded key -> prefixes advertised with it as of last syncKvStore()
+  std::unordered_map<std::string, PrefixDbShard> prefixDbShards_;
+
   // perfEvents related to a given prefixEntry
   std::unordered_map<
       thrift::PrefixType,
@@ -298,6 +358,20 @@ class PrefixManager final : public OpenrEventBase {
    */
   std::unordered_map<folly::CIDRNetwork, OriginatedRoute> originatedPrefixDb_;
 
+  /*
+   * prefix lengths of originated prefixes of each address family. Aggregates
+   * covering a route are looked up in `originatedPrefixDb_` by masking route
+   * with each of the lengths, rather than scanning all originated prefixes
+   */
+  std::set<uint8_t> originatedPrefixLengthsV4_;
+  std::set<uint8_t> originatedPrefixLengthsV6_;
+
+  /*
+   * originated prefixes whose supporting routes changed since they were
+   * last evaluated for advertisement/withdrawal
+   */
+  std::unordered_set<folly::CIDRNetwork> pendingOriginatedPrefixes_;
+
   /*
    * prefixes received from decision
    * ATTN: to avoid loop through ALL entries inside `originatedPrefixes`,
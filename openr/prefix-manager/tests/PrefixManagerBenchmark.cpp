@@ -0,0 +1,385 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+
+#include <openr/config/Config.h>
+#include <openr/config/tests/Utils.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+#include <openr/messaging/ReplicateQueue.h>
+#include <openr/prefix-manager/PrefixManager.h>
+
+namespace {
+
+// Name of the PrefixManager instance under measurement
+const std::string kNodeName{"node-1"};
+
+// Resident memory of the process
+int64_t
+getResidentBytes() {
+  int64_t totalPages{0};
+  int64_t residentPages{0};
+  std::ifstream statm("/proc/self/statm");
+  statm >> totalPages >> residentPages;
+  return residentPages * ::sysconf(_SC_PAGESIZE);
+}
+
+// CPU time consumed by the calling thread so far
+std::chrono::microseconds
+getThreadCpuTime() {
+  struct timespec ts;
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) +
+      std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::nanoseconds(ts.tv_nsec));
+}
+
+openr::thrift::IpPrefix
+getPrefix(size_t idx) {
+  return openr::toIpPrefix(
+      folly::sformat("fc00:{:x}:{:x}::/64", idx >> 16, idx & 0xffff));
+}
+
+std::vector<openr::thrift::PrefixEntry>
+createPrefixEntries(
+    size_t start, size_t numPrefixes, openr::thrift::PrefixType type) {
+  std::vector<openr::thrift::PrefixEntry> entries;
+  entries.reserve(numPrefixes);
+  for (size_t i = start; i < start + numPrefixes; ++i) {
+    entries.emplace_back(openr::createPrefixEntry(getPrefix(i), type));
+  }
+  return entries;
+}
+
+} // namespace
+
+namespace openr {
+
+/**
+ * PrefixManager under measurement along with KvStore it advertises into
+ */
+class PrefixManagerFixture {
+ public:
+  explicit PrefixManagerFixture(std::vector<std::string> const& areas) {
+    std::vector<thrift::AreaConfig> areaConfigs;
+    for (auto const& area : areas) {
+      areaConfigs.emplace_back(createAreaConfig(area, {".*"}, {".*"}));
+    }
+    auto tConfig = getBasicOpenrConfig(kNodeName, "domain", areaConfigs);
+    config_ = std::make_shared<Config>(tConfig);
+
+    kvStoreWrapper_ = std::make_unique<KvStoreWrapper>(context_, config_);
+    kvStoreWrapper_->run();
+
+    prefixManager_ = std::make_unique<PrefixManager>(
+        staticRouteUpdatesQueue_,
+        prefixUpdatesQueue_.getReader(),
+        routeUpdatesQueue_.getReader(),
+        config_,
+        kvStoreWrapper_->getKvStore(),
+        false /* enablePerfMeasurement */,
+        std::chrono::seconds{0});
+    prefixManagerThread_ =
+        std::make_unique<std::thread>([this]() { prefixManager_->run(); });
+    prefixManager_->waitUntilRunning();
+  }
+
+  ~PrefixManagerFixture() {
+    prefixUpdatesQueue_.close();
+    routeUpdatesQueue_.close();
+    staticRouteUpdatesQueue_.close();
+    kvStoreWrapper_->closeQueue();
+
+    prefixManager_->stop();
+    prefixManagerThread_->join();
+    prefixManager_.reset();
+
+    kvStoreWrapper_->stop();
+    kvStoreWrapper_.reset();
+  }
+
+  PrefixManager*
+  get() {
+    return prefixManager_.get();
+  }
+
+  void
+  pushRouteUpdate(DecisionRouteUpdate&& routeUpdate) {
+    routeUpdatesQueue_.pushShared(std::move(routeUpdate));
+  }
+
+  // Wait until KvStore published numKeys key updates. TTL updates without
+  // value don't count.
+  void
+  waitForKeys(size_t numKeys) {
+    size_t keys{0};
+    while (keys < numKeys) {
+      auto pub = kvStoreWrapper_->recvPublication();
+      for (auto const& [_, val] : *pub.keyVals_ref()) {
+        if (val.value_ref().has_value()) {
+          ++keys;
+        }
+      }
+    }
+    keysWritten_ += keys;
+  }
+
+  size_t
+  getKeysWritten() const {
+    return keysWritten_;
+  }
+
+  // CPU time consumed by thread of instance under measurement so far
+  std::chrono::microseconds
+  getCpuTime() {
+    std::chrono::microseconds cpuTime{0};
+    prefixManager_->getEvb()->runInEventBaseThreadAndWait(
+        [&cpuTime]() { cpuTime = getThreadCpuTime(); });
+    return cpuTime;
+  }
+
+ private:
+  fbzmq::Context context_;
+  std::shared_ptr<Config> config_{nullptr};
+
+  messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue_;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue_;
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta>
+      staticRouteUpdatesQueue_;
+
+  std::unique_ptr<KvStoreWrapper> kvStoreWrapper_;
+  std::unique_ptr<PrefixManager> prefixManager_;
+  std::unique_ptr<std::thread> prefixManagerThread_;
+
+  size_t keysWritten_{0};
+};
+
+/**
+ * Measurement of one iteration, reported per iteration through counters:
+ * - cpu_us: CPU time of PrefixManager thread
+ * - keys_written: key updates published by KvStore
+ * - bytes_per_prefix: resident memory grown, divided by number of prefixes
+ *
+ * NOTE: Benchmark time includes throttling of KvStore updates by
+ * PrefixManager, CPU time is the cost of PrefixManager itself
+ */
+class Measurement {
+ public:
+  explicit Measurement(PrefixManagerFixture& fixture)
+      : fixture_(fixture),
+        memoryStart_(getResidentBytes()),
+        keysStart_(fixture.getKeysWritten()),
+        cpuStart_(fixture.getCpuTime()) {}
+
+  void
+  finish() {
+    cpuTime_ += fixture_.getCpuTime() - cpuStart_;
+    keys_ += fixture_.getKeysWritten() - keysStart_;
+    memory_ += getResidentBytes() - memoryStart_;
+  }
+
+  static void
+  report(
+      folly::UserCounters& counters,
+      uint32_t iters,
+      size_t numPrefixes,
+      std::vector<Measurement> const& measurements) {
+    int64_t cpuUs{0};
+    int64_t keys{0};
+    int64_t memory{0};
+    for (auto const& m : measurements) {
+      cpuUs += m.cpuTime_.count();
+      keys += m.keys_;
+      memory += m.memory_;
+    }
+    const auto n = std::max<uint32_t>(1, iters);
+    counters["cpu_us"] = cpuUs / n;
+    counters["keys_written"] = keys / n;
+    counters["bytes_per_prefix"] =
+        memory / n / std::max<int64_t>(1, numPrefixes);
+  }
+
+ private:
+  PrefixManagerFixture& fixture_;
+  const int64_t memoryStart_{0};
+  const size_t keysStart_{0};
+  const std::chrono::microseconds cpuStart_{0};
+
+  std::chrono::microseconds cpuTime_{0};
+  int64_t keys_{0};
+  int64_t memory_{0};
+};
+
+/**
+ * Advertise numPrefixes prefixes with advertisePrefixes() and wait until
+ * they are all in KvStore
+ */
+static void
+BM_PrefixManagerAdvertise(
+    folly::UserCounters& counters, uint32_t iters, size_t numPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  std::vector<Measurement> measurements;
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    PrefixManagerFixture fixture({kTestingAreaName});
+    auto entries =
+        createPrefixEntries(0, numPrefixes, thrift::PrefixType::BGP);
+    auto& m = measurements.emplace_back(fixture);
+
+    suspender.dismiss(); // Start measuring benchmark time
+    fixture.get()->advertisePrefixes(std::move(entries)).get();
+    fixture.waitForKeys(numPrefixes);
+    suspender.rehire();
+
+    m.finish();
+  }
+  Measurement::report(counters, iters, numPrefixes, measurements);
+}
+
+/**
+ * Withdraw numPrefixes advertised prefixes with withdrawPrefixes() and wait
+ * until they are all withdrawn from KvStore
+ */
+static void
+BM_PrefixManagerWithdraw(
+    folly::UserCounters& counters, uint32_t iters, size_t numPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  std::vector<Measurement> measurements;
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    PrefixManagerFixture fixture({kTestingAreaName});
+    auto entries =
+        createPrefixEntries(0, numPrefixes, thrift::PrefixType::BGP);
+    fixture.get()->advertisePrefixes(entries).get();
+    fixture.waitForKeys(numPrefixes);
+    auto& m = measurements.emplace_back(fixture);
+
+    suspender.dismiss(); // Start measuring benchmark time
+    fixture.get()->withdrawPrefixes(std::move(entries)).get();
+    fixture.waitForKeys(numPrefixes);
+    suspender.rehire();
+
+    m.finish();
+  }
+  Measurement::report(counters, iters, numPrefixes, measurements);
+}
+
+/**
+ * Sync numPrefixes advertised prefixes of a type with syncPrefixesByType()
+ * to a set in which half of the prefixes got replaced, i.e. numPrefixes / 2
+ * prefixes get withdrawn and as many new ones advertised
+ */
+static void
+BM_PrefixManagerSyncByType(
+    folly::UserCounters& counters, uint32_t iters, size_t numPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  std::vector<Measurement> measurements;
+  const auto numReplaced = numPrefixes / 2;
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    PrefixManagerFixture fixture({kTestingAreaName});
+    fixture.get()
+        ->advertisePrefixes(
+            createPrefixEntries(0, numPrefixes, thrift::PrefixType::BGP))
+        .get();
+    fixture.waitForKeys(numPrefixes);
+    auto entries = createPrefixEntries(
+        numReplaced, numPrefixes, thrift::PrefixType::BGP);
+    auto& m = measurements.emplace_back(fixture);
+
+    suspender.dismiss(); // Start measuring benchmark time
+    fixture.get()
+        ->syncPrefixesByType(thrift::PrefixType::BGP, std::move(entries))
+        .get();
+    fixture.waitForKeys(2 * numReplaced);
+    suspender.rehire();
+
+    m.finish();
+  }
+  Measurement::report(counters, iters, numPrefixes, measurements);
+}
+
+/**
+ * Redistribute numRoutes routes computed by Decision via area A into areas
+ * B and C, and wait until they are advertised in both of them
+ */
+static void
+BM_PrefixManagerRedistribution(
+    folly::UserCounters& counters, uint32_t iters, size_t numRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  std::vector<Measurement> measurements;
+
+  auto nh = createNextHop(toBinaryAddress("fe80::2"), "iface_1_2_1", 1);
+  nh.area_ref() = "A";
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    PrefixManagerFixture fixture({"A", "B", "C"});
+    DecisionRouteUpdate routeUpdate;
+    for (auto& entry :
+         createPrefixEntries(0, numRoutes, thrift::PrefixType::BGP)) {
+      entry.area_stack_ref() = {"65000"};
+      const auto prefix = toIPNetwork(*entry.prefix_ref());
+      routeUpdate.addRouteToUpdate(
+          RibUnicastEntry(prefix, {nh}, std::move(entry), "A"));
+    }
+    auto& m = measurements.emplace_back(fixture);
+
+    suspender.dismiss(); // Start measuring benchmark time
+    fixture.pushRouteUpdate(std::move(routeUpdate));
+    fixture.waitForKeys(2 * numRoutes);
+    suspender.rehire();
+
+    m.finish();
+  }
+  Measurement::report(counters, iters, numRoutes, measurements);
+}
+
+// The parameter is number of prefixes (routes)
+BENCHMARK_COUNTERS_NAMED_PARAM(BM_PrefixManagerAdvertise, counters, 1000, 1000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerAdvertise, counters, 10000, 10000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerAdvertise, counters, 100000, 100000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerAdvertise, counters, 1000000, 1000000);
+BENCHMARK_COUNTERS_NAMED_PARAM(BM_PrefixManagerWithdraw, counters, 1000, 1000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerWithdraw, counters, 10000, 10000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerWithdraw, counters, 100000, 100000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerWithdraw, counters, 1000000, 1000000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerSyncByType, counters, 1000, 1000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerSyncByType, counters, 10000, 10000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerSyncByType, counters, 100000, 100000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerRedistribution, counters, 1000, 1000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerRedistribution, counters, 10000, 10000);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_PrefixManagerRedistribution, counters, 100000, 100000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -152,7 +152,7 @@ class PrefixManagerTestFixture : public testing::Test {
 
   // Queue for publishing entries to PrefixManager
   messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue;
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRouteUpdatesQueue;
 
   // Create the serializer for write/read
@@ -1006,6 +1006,47 @@ TEST_F(PrefixManagerTestFixture, PrefixUpdatesQueue) {
   }
 }
 
+/**
+ * Verifies bulk load requests are advertised to KvStore only once batch is
+ * completed by end-of-RIB
+ */
+TEST_F(PrefixManagerTestFixture, PrefixUpdatesQueueBulkLoad) {
+  const auto dumpPrefixKeys = [this]() {
+    return kvStoreWrapper->dumpAll(
+        kTestingAreaName,
+        KvStoreFilters({Constants::kPrefixDbMarker.toString()}, {}));
+  };
+
+  // Batch of prefixes in two requests
+  for (const auto& entries : std::vector<std::vector<thrift::PrefixEntry>>{
+           {prefixEntry1, prefixEntry3}, {prefixEntry7}}) {
+    thrift::PrefixUpdateRequest request;
+    request.cmd_ref() = thrift::PrefixUpdateCommand::ADD_PREFIXES;
+    *request.prefixes_ref() = entries;
+    request.batchInProgress_ref() = true;
+    prefixUpdatesQueue.push(std::move(request));
+  }
+
+  // Prefixes are applied but not advertised past throttle timeout
+  /* sleep override */
+  std::this_thread::sleep_for(2 * Constants::kPrefixMgrKvThrottleTimeout);
+  EXPECT_EQ(3, prefixManager->getPrefixes().get()->size());
+  EXPECT_TRUE(dumpPrefixKeys().empty());
+
+  // End-of-RIB completes the batch
+  {
+    thrift::PrefixUpdateRequest request;
+    request.cmd_ref() = thrift::PrefixUpdateCommand::END_OF_RIB;
+    prefixUpdatesQueue.push(std::move(request));
+  }
+  while (dumpPrefixKeys().size() < 3) {
+    EXPECT_NO_THROW(kvStoreWrapper->recvPublication());
+  }
+  EXPECT_THAT(
+      *prefixManager->getPrefixes().get(),
+      testing::UnorderedElementsAre(prefixEntry1, prefixEntry3, prefixEntry7));
+}
+
 /**
  * Verifies `getAdvertisedRoutesFiltered` with all filter combinations
  */
@@ -1121,6 +1162,90 @@ TEST(PrefixManager, FilterAdvertisedRoutes) {
   EXPECT_TRUE(routes.empty());
 }
 
+class PrefixManagerShardedKeyTestFixture : public PrefixManagerTestFixture {
+  thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = PrefixManagerTestFixture::createConfig();
+    tConfig.prefix_db_key_shards_ref() = 2;
+    return tConfig;
+  }
+
+ public:
+  // prefix entries of non-deleted keys of node-1, per key
+  std::map<std::string, std::set<thrift::IpPrefix>>
+  getShardedPrefixDbs() {
+    std::map<std::string, std::set<thrift::IpPrefix>> shards;
+    const auto keyVals = kvStoreWrapper->dumpAll(kTestingAreaName);
+    for (auto const& [key, val] : keyVals) {
+      if (key.find("prefix:node-1") != 0) {
+        continue;
+      }
+      auto prefixDb = readThriftObjStr<thrift::PrefixDatabase>(
+          val.value_ref().value(), serializer);
+      if (*prefixDb.deletePrefix_ref()) {
+        continue;
+      }
+      for (auto const& entry : *prefixDb.prefixEntries_ref()) {
+        shards[key].emplace(*entry.prefix_ref());
+      }
+    }
+    return shards;
+  }
+};
+
+/**
+ * Prefixes get packed into bounded number of sharded keys
+ * 1. Advertise 8 prefixes - Verify they are in at most 2 keys
+ * 2. Withdraw some of them - Verify remaining ones are still advertised
+ * 3. Withdraw all - Verify keys are withdrawn
+ */
+TEST_F(PrefixManagerShardedKeyTestFixture, AdvertiseWithdraw) {
+  const std::vector<thrift::PrefixEntry> entries = {
+      prefixEntry1,
+      prefixEntry2,
+      prefixEntry3,
+      prefixEntry4,
+      prefixEntry5,
+      prefixEntry6,
+      prefixEntry7,
+      prefixEntry8};
+  const auto throttle = 2 * Constants::kPrefixMgrKvThrottleTimeout;
+
+  EXPECT_TRUE(prefixManager->advertisePrefixes(entries).get());
+  std::this_thread::sleep_for(throttle);
+  {
+    auto shards = getShardedPrefixDbs();
+    EXPECT_GE(2, shards.size());
+    size_t numPrefixes{0};
+    for (auto const& [key, prefixes] : shards) {
+      EXPECT_EQ(std::string::npos, key.find("["));
+      numPrefixes += prefixes.size();
+    }
+    EXPECT_EQ(entries.size(), numPrefixes);
+  }
+
+  EXPECT_TRUE(prefixManager
+                  ->withdrawPrefixes(
+                      {prefixEntry1, prefixEntry2, prefixEntry3, prefixEntry4})
+                  .get());
+  std::this_thread::sleep_for(throttle);
+  {
+    std::set<thrift::IpPrefix> advertised;
+    for (auto const& [_, prefixes] : getShardedPrefixDbs()) {
+      advertised.insert(prefixes.begin(), prefixes.end());
+    }
+    EXPECT_EQ(
+        std::set<thrift::IpPrefix>({addr5, addr6, addr7, addr8}), advertised);
+  }
+
+  EXPECT_TRUE(prefixManager
+                  ->withdrawPrefixes(
+                      {prefixEntry5, prefixEntry6, prefixEntry7, prefixEntry8})
+                  .get());
+  std::this_thread::sleep_for(throttle);
+  EXPECT_TRUE(getShardedPrefixDbs().empty());
+}
+
 class PrefixManagerMultiAreaTestFixture : public PrefixManagerTestFixture {
   thrift::OpenrConfig
   createConfig() override {
@@ -1211,16 +1336,16 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteUpdates) {
   {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(unicast1A);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     std::map<std::string, thrift::PrefixEntry> expected, got, gotDeleted;
     expected.emplace(keyStrB, expectedPrefixEntry1A);
     expected.emplace(keyStrC, expectedPrefixEntry1A);
 
-    auto pub1 = kvStoreUpdatesQueue.get().value();
+    auto pub1 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub1, got, gotDeleted);
 
-    auto pub2 = kvStoreUpdatesQueue.get().value();
+    auto pub2 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub2, got, gotDeleted);
 
     EXPECT_EQ(expected, got);
@@ -1248,19 +1373,19 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteUpdates) {
   {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(unicast1B);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     std::map<std::string, thrift::PrefixEntry> expected, got, gotDeleted;
     expected.emplace(keyStrA, expectedPrefixEntry1B);
     expected.emplace(keyStrC, expectedPrefixEntry1B);
 
-    auto pub1 = kvStoreUpdatesQueue.get().value();
+    auto pub1 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub1, got, gotDeleted);
 
-    auto pub2 = kvStoreUpdatesQueue.get().value();
+    auto pub2 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub2, got, gotDeleted);
 
-    auto pub3 = kvStoreUpdatesQueue.get().value();
+    auto pub3 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub3, got, gotDeleted);
 
     EXPECT_EQ(expected, got);
@@ -1275,14 +1400,14 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteUpdates) {
   {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.unicastRoutesToDelete.emplace_back(toIPNetwork(addr1));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     std::map<std::string, thrift::PrefixEntry> got, gotDeleted;
 
-    auto pub1 = kvStoreUpdatesQueue.get().value();
+    auto pub1 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub1, got, gotDeleted);
 
-    auto pub2 = kvStoreUpdatesQueue.get().value();
+    auto pub2 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub2, got, gotDeleted);
 
     EXPECT_EQ(0, got.size());
@@ -1337,12 +1462,12 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteNexthopUpdates) {
   {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(unicast1A);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     std::map<std::string, thrift::PrefixEntry> expected, got, gotDeleted;
     expected.emplace(keyStrC, expectedPrefixEntry1A);
 
-    auto pub1 = kvStoreUpdatesQueue.get().value();
+    auto pub1 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub1, got, gotDeleted);
 
     EXPECT_EQ(expected, got);
@@ -1358,11 +1483,11 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteNexthopUpdates) {
   {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(unicast1A);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     std::map<std::string, thrift::PrefixEntry> got, gotDeleted;
 
-    auto pub1 = kvStoreUpdatesQueue.get().value();
+    auto pub1 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub1, got, gotDeleted);
 
     EXPECT_EQ(0, got.size());
@@ -1378,12 +1503,12 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteNexthopUpdates) {
   {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(unicast1A);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     std::map<std::string, thrift::PrefixEntry> expected, got, gotDeleted;
     expected.emplace(keyStrB, expectedPrefixEntry1A);
 
-    auto pub1 = kvStoreUpdatesQueue.get().value();
+    auto pub1 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub1, got, gotDeleted);
 
     EXPECT_EQ(expected, got);
@@ -1410,7 +1535,7 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteNexthopUpdates) {
   {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(unicast1B);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     std::map<std::string, thrift::PrefixEntry> expected, got, gotDeleted;
     expected.emplace(keyStrA, expectedPrefixEntry1B);
@@ -1420,7 +1545,7 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteNexthopUpdates) {
     // here skip ttl updates
     int expectedPubCnt{3}, gotPubCnt{0};
     while (gotPubCnt < expectedPubCnt) {
-      auto pub = kvStoreUpdatesQueue.get().value();
+      auto pub = *kvStoreUpdatesQueue.get().value();
       gotPubCnt += readPublication(pub, got, gotDeleted);
     }
 
@@ -1437,14 +1562,14 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteNexthopUpdates) {
   {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.unicastRoutesToDelete.emplace_back(toIPNetwork(addr1));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     std::map<std::string, thrift::PrefixEntry> got, gotDeleted;
 
-    auto pub1 = kvStoreUpdatesQueue.get().value();
+    auto pub1 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub1, got, gotDeleted);
 
-    auto pub2 = kvStoreUpdatesQueue.get().value();
+    auto pub2 = *kvStoreUpdatesQueue.get().value();
     readPublication(pub2, got, gotDeleted);
 
     EXPECT_EQ(0, got.size());
@@ -1609,7 +1734,7 @@ TEST_F(RouteOriginationFixture, BasicAdvertiseWithdraw) {
     DecisionRouteUpdate routeUpdate;
     routeUpdate.addRouteToUpdate(unicastEntryV4_1);
     routeUpdate.addRouteToUpdate(unicastEntryV6_1);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     // v4 route update received
     auto update = waitForRouteUpdate(reader, kRouteUpdateTimeout);
@@ -1675,7 +1800,7 @@ TEST_F(RouteOriginationFixture, BasicAdvertiseWithdraw) {
     routeUpdate.addRouteToUpdate(unicastEntryV4_2);
     routeUpdate.addRouteToUpdate(unicastEntryV6_2);
     routeUpdate.unicastRoutesToDelete.emplace_back(v6Network_2);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     // no more route update received
     EXPECT_FALSE(waitForRouteUpdate(reader, kRouteUpdateTimeout).has_value());
@@ -1720,7 +1845,7 @@ TEST_F(RouteOriginationFixture, BasicAdvertiseWithdraw) {
     tmpEntryV4.nexthops = {createNextHop(toBinaryAddress("192.168.0.1"))};
     routeUpdate.addRouteToUpdate(tmpEntryV4);
     routeUpdate.addRouteToUpdate(unicastEntryV6_2);
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     // no more route update received
     EXPECT_FALSE(waitForRouteUpdate(reader, kRouteUpdateTimeout).has_value());
@@ -1763,7 +1888,7 @@ TEST_F(RouteOriginationFixture, BasicAdvertiseWithdraw) {
     // intentionally inject random non-existing prefix
     routeUpdate.unicastRoutesToDelete.emplace_back(
         folly::IPAddress::createNetwork("fe80::2"));
-    routeUpdatesQueue.push(std::move(routeUpdate));
+    routeUpdatesQueue.pushShared(std::move(routeUpdate));
 
     auto mp = getOriginatedPrefixDb();
     auto& prefixEntryV4 = mp.at(v4Prefix_);
@@ -18,6 +18,7 @@ class ConfigCli(object):
         self.config.add_command(ConfigShowCli().show, name="show")
         self.config.add_command(ConfigDryRunCli().dryrun, name="dryrun")
         self.config.add_command(ConfigCompareCli().compare, name="compare")
+        self.config.add_command(ConfigReloadCli().reload, name="reload")
         self.config.add_command(
             ConfigPrefixAllocatorCli().config_prefix_allocator,
             name="prefix-allocator-config",
@@ -67,6 +68,21 @@ class ConfigCompareCli(object):
         config.ConfigCompareCmd(cli_opts).run(file)
 
 
+class ConfigReloadCli(object):
+    @click.command()
+    @click.argument("file")
+    @click.option(
+        "--dryrun/--no-dryrun",
+        default=False,
+        help="Only check whether config can be reloaded without restart",
+    )
+    @click.pass_obj
+    def reload(cli_opts, file, dryrun):  # noqa: B902
+        """ Apply config without restart, if it only changes reloadable fields """
+
+        config.ConfigReloadCmd(cli_opts).run(file, dryrun)
+
+
 class ConfigPrefixAllocatorCli(object):
     @click.command()
     @click.pass_obj
@@ -62,6 +62,17 @@ class ConfigCompareCmd(OpenrCtrlCmd):
             click.echo(click.style("SAME", fg="green"))
 
 
+class ConfigReloadCmd(OpenrCtrlCmd):
+    def _run(self, client: OpenrCtrl.Client, file: str, dryrun: bool):
+        try:
+            client.reloadConfig(file, dryrun)
+        except OpenrError as ex:
+            click.echo(click.style("FAILED: {}".format(ex), fg="red"))
+            return
+
+        click.echo(click.style("RELOADABLE" if dryrun else "RELOADED", fg="green"))
+
+
 class ConfigStoreCmdBase(OpenrCtrlCmd):
     def getConfigWrapper(
         self, client: OpenrCtrl.Client, config_key: str
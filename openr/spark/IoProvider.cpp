@@ -8,12 +8,140 @@
 #include <glog/logging.h>
 #include <net/if.h>
 
+#include <algorithm>
+#include <optional>
+
+#include <folly/ExceptionString.h>
 #include <folly/Format.h>
 #include <folly/SocketAddress.h>
 #include <openr/spark/IoProvider.h>
 
 namespace openr {
 
+namespace {
+
+// Maximum number of messages the kernel accepts in one `sendmmsg` call, i.e.
+// UIO_MAXIOV
+constexpr size_t kMaxMessagesPerCall{1024};
+
+// Control buffer for ancillary data of received message, aligned by control
+// message hdr
+union RecvControlBuffer {
+  char ctrlBuf[CMSG_SPACE(256)];
+  struct cmsghdr align;
+};
+
+// Control buffer carrying IPV6_PKTINFO, aligned by control message hdr
+union PktInfoControlBuffer {
+  char cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+  struct cmsghdr align;
+};
+
+// Fill header of message to be sent on ifIndex from srcAddr to dstAddr. All
+// the buffers referred to by header must outlive it
+void
+fillMessageHeader(
+    struct msghdr& msg,
+    PktInfoControlBuffer& u,
+    sockaddr_storage& addrStorage,
+    struct iovec& entry,
+    int ifIndex,
+    folly::IPAddressV6 const& srcAddr,
+    folly::SocketAddress const& dstAddr,
+    std::string const& packet) {
+  struct cmsghdr* cmsg{nullptr};
+
+  // Set the destination address for the message
+  dstAddr.getAddress(&addrStorage);
+
+  ::memset(&msg, 0, sizeof(msg));
+  msg.msg_name = reinterpret_cast<void*>(&addrStorage);
+  msg.msg_namelen = dstAddr.getActualSize();
+
+  // set the source address and source if index for this message
+  // this goes into ancilliary data fields
+  msg.msg_control = u.cbuf;
+  msg.msg_controllen = sizeof(u.cbuf);
+  cmsg = CMSG_FIRSTHDR(&msg);
+
+  cmsg->cmsg_level = IPPROTO_IPV6;
+  cmsg->cmsg_type = IPV6_PKTINFO;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+
+  auto pktinfo = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+  pktinfo->ipi6_ifindex = ifIndex;
+  ::memcpy(&pktinfo->ipi6_addr, srcAddr.bytes(), srcAddr.byteCount());
+
+  // the IO vector for data to be sent
+  msg.msg_iov = &entry;
+  msg.msg_iovlen = 1;
+
+  // write the data here (we need to remove the const qualifier)
+  entry.iov_base = const_cast<char*>(packet.data());
+  entry.iov_len = packet.size();
+}
+
+// Parse ancillary data of received message, i.e. interface index, hop limit,
+// kernel timestamp and, if SO_RXQ_OVFL is enabled, number of dropped packets
+void
+parseControlMessages(
+    struct msghdr& msg,
+    int& ifIndex,
+    int& hopLimit,
+    std::chrono::microseconds& recvTs,
+    std::optional<uint32_t>* numDropped) {
+  struct cmsghdr* cmsg{nullptr};
+
+  // use user space timestamp if kernel timestamp is not found
+  recvTs = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+
+  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_IPV6) {
+      if (cmsg->cmsg_type == IPV6_PKTINFO) {
+        struct in6_pktinfo pktinfo;
+        memcpy(
+            reinterpret_cast<void*>(&pktinfo),
+            CMSG_DATA(cmsg),
+            sizeof(pktinfo));
+        ifIndex = pktinfo.ipi6_ifindex;
+      } else if (cmsg->cmsg_type == IPV6_HOPLIMIT) {
+        memcpy(
+            reinterpret_cast<void*>(&hopLimit),
+            CMSG_DATA(cmsg),
+            sizeof(hopLimit));
+      }
+    }
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL &&
+        numDropped) {
+      uint32_t dropped{0};
+      memcpy(
+          reinterpret_cast<void*>(&dropped), CMSG_DATA(cmsg), sizeof(dropped));
+      *numDropped = dropped;
+    }
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS) {
+      struct timespec ts {
+        0, 0
+      };
+      memcpy(reinterpret_cast<void*>(&ts), CMSG_DATA(cmsg), sizeof(ts));
+
+      // cast to int64_t since ts.tv_sec is 32 bits on some platforms like arm
+      const int64_t usecs =
+          static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+      const std::chrono::microseconds kernelRecvTs(usecs);
+
+      // sanity check
+      DCHECK(recvTs >= kernelRecvTs) << "Time anomaly";
+      VLOG(4) << "Got kernel-timestamp. It took "
+              << (recvTs - kernelRecvTs).count()
+              << " us for the packet to get from kernel to user space";
+      recvTs = kernelRecvTs;
+    }
+  } // for
+}
+
+} // namespace
+
 int
 IoProvider::socket(int domain, int type, int protocol) {
   return ::socket(domain, type, protocol);
@@ -68,6 +196,22 @@ IoProvider::sendmsg(int sockfd, const struct msghdr* msg, int flags) {
   return ::sendmsg(sockfd, msg, flags);
 }
 
+int
+IoProvider::recvmmsg(
+    int sockfd,
+    struct mmsghdr* msgvec,
+    unsigned int vlen,
+    int flags,
+    struct timespec* timeout) {
+  return ::recvmmsg(sockfd, msgvec, vlen, flags, timeout);
+}
+
+int
+IoProvider::sendmmsg(
+    int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  return ::sendmmsg(sockfd, msgvec, vlen, flags);
+}
+
 std::tuple<
     ssize_t /* size */,
     int /* ifIndex */,
@@ -130,50 +274,10 @@ IoProvider::recvMessage(
 
   // grab the inIndex we received this packet on and the hopLimit
   // those are available since we requested them via socket options
-  struct cmsghdr* cmsg{nullptr};
   int ifIndex{-1};
   int hopLimit{0};
-
-  // use user space timestamp if kernel timestamp is not found
-  std::chrono::microseconds recvTs{
-      std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::system_clock::now().time_since_epoch())};
-
-  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-    if (cmsg->cmsg_level == IPPROTO_IPV6) {
-      if (cmsg->cmsg_type == IPV6_PKTINFO) {
-        struct in6_pktinfo pktinfo;
-        memcpy(
-            reinterpret_cast<void*>(&pktinfo),
-            CMSG_DATA(cmsg),
-            sizeof(pktinfo));
-        ifIndex = pktinfo.ipi6_ifindex;
-      } else if (cmsg->cmsg_type == IPV6_HOPLIMIT) {
-        memcpy(
-            reinterpret_cast<void*>(&hopLimit),
-            CMSG_DATA(cmsg),
-            sizeof(hopLimit));
-      }
-    }
-    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS) {
-      struct timespec ts {
-        0, 0
-      };
-      memcpy(reinterpret_cast<void*>(&ts), CMSG_DATA(cmsg), sizeof(ts));
-
-      // cast to int64_t since ts.tv_sec is 32 bits on some platforms like arm
-      const int64_t usecs =
-          static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
-      const std::chrono::microseconds kernelRecvTs(usecs);
-
-      // sanity check
-      DCHECK(recvTs >= kernelRecvTs) << "Time anomaly";
-      VLOG(4) << "Got kernel-timestamp. It took "
-              << (recvTs - kernelRecvTs).count()
-              << " us for the packet to get from kernel to user space";
-      recvTs = kernelRecvTs;
-    }
-  } // for
+  std::chrono::microseconds recvTs{0};
+  parseControlMessages(msg, ifIndex, hopLimit, recvTs, nullptr);
 
   // build the source socket address from recvmsg data
   folly::SocketAddress srcAddr{};
@@ -186,6 +290,73 @@ IoProvider::recvMessage(
   return std::make_tuple(bytesRead, ifIndex, srcAddr, hopLimit, recvTs);
 }
 
+std::vector<IoProvider::IncomingMessage>
+IoProvider::recvMessages(
+    int fd, size_t maxMessages, size_t maxLen, IoProvider* ioProvider) {
+  // zero initialized buffers, see recvMessage() for control buffer
+  std::vector<struct mmsghdr> msgs(maxMessages);
+  std::vector<RecvControlBuffer> ctrlBufs(maxMessages);
+  std::vector<sockaddr_storage> addrs(maxMessages);
+  std::vector<struct iovec> iovs(maxMessages);
+  // Payload buffers are reused by every call on the thread, only the bytes
+  // received are copied out per message
+  static thread_local std::vector<char> payloads;
+  if (payloads.size() < maxMessages * maxLen) {
+    payloads.resize(maxMessages * maxLen);
+  }
+  for (size_t i = 0; i < maxMessages; ++i) {
+    auto& msg = msgs[i].msg_hdr;
+    iovs[i].iov_base = payloads.data() + i * maxLen;
+    iovs[i].iov_len = maxLen;
+    msg.msg_iov = &iovs[i];
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrlBufs[i].ctrlBuf;
+    msg.msg_controllen = sizeof(ctrlBufs[i].ctrlBuf);
+    msg.msg_name = &addrs[i];
+    msg.msg_namelen = sizeof(sockaddr_storage);
+  }
+
+  const int numMsgs =
+      ioProvider->recvmmsg(fd, msgs.data(), maxMessages, MSG_DONTWAIT, nullptr);
+  if (numMsgs < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+      return {};
+    }
+    throw std::runtime_error(folly::sformat(
+        "Failed reading messages on fd {}: {}", fd, folly::errnoStr(errno)));
+  }
+
+  std::vector<IncomingMessage> messages;
+  messages.reserve(numMsgs);
+  for (int i = 0; i < numMsgs; ++i) {
+    auto& msg = msgs[i].msg_hdr;
+    if (msg.msg_flags & MSG_TRUNC) {
+      LOG(ERROR) << "Message truncated on fd " << fd;
+      continue;
+    }
+
+    IncomingMessage message;
+    parseControlMessages(
+        msg,
+        message.ifIndex,
+        message.hopLimit,
+        message.recvTs,
+        &message.numDropped);
+    try {
+      message.srcAddr.setFromSockaddr(
+          reinterpret_cast<struct sockaddr*>(&addrs[i]));
+    } catch (std::exception const& err) {
+      LOG(ERROR) << "Message without sender address on fd " << fd << ": "
+                 << folly::exceptionStr(err);
+      continue;
+    }
+    message.packet.assign(
+        static_cast<const char*>(iovs[i].iov_base), msgs[i].msg_len);
+    messages.emplace_back(std::move(message));
+  }
+  return messages;
+}
+
 ssize_t
 IoProvider::sendMessage(
     int fd,
@@ -195,46 +366,55 @@ IoProvider::sendMessage(
     std::string const& packet,
     IoProvider* ioProvider) {
   struct msghdr msg;
-  struct cmsghdr* cmsg{nullptr};
-
-  // pack control buffer, aligned by control message hdr
-  union {
-    char cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
-    struct cmsghdr align;
-  } u;
-
-  // Set the destination address for the message
+  PktInfoControlBuffer u;
   sockaddr_storage addrStorage;
-  dstAddr.getAddress(&addrStorage);
-
-  ::memset(&msg, 0, sizeof(msg));
-  msg.msg_name = reinterpret_cast<void*>(&addrStorage);
-  msg.msg_namelen = dstAddr.getActualSize();
-
-  // set the source address and source if index for this message
-  // this goes into ancilliary data fields
-  msg.msg_control = u.cbuf;
-  msg.msg_controllen = sizeof(u.cbuf);
-  cmsg = CMSG_FIRSTHDR(&msg);
-
-  cmsg->cmsg_level = IPPROTO_IPV6;
-  cmsg->cmsg_type = IPV6_PKTINFO;
-  cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
-
-  auto pktinfo = (struct in6_pktinfo*)CMSG_DATA(cmsg);
-  pktinfo->ipi6_ifindex = ifIndex;
-  ::memcpy(&pktinfo->ipi6_addr, srcAddr.bytes(), srcAddr.byteCount());
-
-  // the IO vector for data to be sent
   struct iovec entry;
-  msg.msg_iov = &entry;
-  msg.msg_iovlen = 1;
-
-  // write the data here (we need to remove the const qualifier)
-  entry.iov_base = const_cast<char*>(packet.data());
-  entry.iov_len = packet.size();
+  fillMessageHeader(
+      msg, u, addrStorage, entry, ifIndex, srcAddr, dstAddr, packet);
 
   return ioProvider->sendmsg(fd, &msg, MSG_DONTWAIT);
 }
 
+std::vector<ssize_t>
+IoProvider::sendMessages(
+    int fd,
+    std::vector<OutgoingMessage> const& messages,
+    IoProvider* ioProvider) {
+  const size_t numMessages = messages.size();
+  std::vector<struct mmsghdr> msgs(numMessages);
+  std::vector<PktInfoControlBuffer> cbufs(numMessages);
+  std::vector<sockaddr_storage> addrs(numMessages);
+  std::vector<struct iovec> iovs(numMessages);
+  for (size_t i = 0; i < numMessages; ++i) {
+    const auto& message = messages[i];
+    msgs[i].msg_len = 0;
+    fillMessageHeader(
+        msgs[i].msg_hdr,
+        cbufs[i],
+        addrs[i],
+        iovs[i],
+        message.ifIndex,
+        message.srcAddr,
+        message.dstAddr,
+        message.packet);
+  }
+
+  std::vector<ssize_t> bytesSent(numMessages, 0);
+  size_t offset = 0;
+  while (offset < numMessages) {
+    const auto vlen = std::min(numMessages - offset, kMaxMessagesPerCall);
+    const int numSent =
+        ioProvider->sendmmsg(fd, &msgs[offset], vlen, MSG_DONTWAIT);
+    if (numSent <= 0) {
+      // First message of the batch failed, skip it
+      bytesSent[offset++] = numSent < 0 ? -errno : -EAGAIN;
+      continue;
+    }
+    for (int i = 0; i < numSent; ++i, ++offset) {
+      bytesSent[offset] = msgs[offset].msg_len;
+    }
+  }
+  return bytesSent;
+}
+
 } // namespace openr
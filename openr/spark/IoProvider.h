@@ -13,6 +13,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include <folly/IPAddress.h>
 #include <folly/SocketAddress.h>
@@ -59,6 +62,16 @@ class IoProvider {
 
   virtual ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags);
 
+  virtual int recvmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags,
+      struct timespec* timeout);
+
+  virtual int sendmmsg(
+      int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags);
+
   virtual int setsockopt(
       int sockfd, int level, int optname, const void* optval, socklen_t optlen);
 
@@ -76,6 +89,28 @@ class IoProvider {
       std::chrono::microseconds /* kernel timestamp */>
   recvMessage(int fd, unsigned char* buf, int len, IoProvider* ioProvider);
 
+  // Message received on fd along with its ancillary data
+  struct IncomingMessage {
+    std::string packet;
+    int ifIndex{-1};
+    folly::SocketAddress srcAddr;
+    int hopLimit{0};
+    // kernel timestamp, user space one if not available
+    std::chrono::microseconds recvTs{0};
+    // packets dropped by socket for lack of buffer space since socket got
+    // created. Reported if SO_RXQ_OVFL is enabled
+    std::optional<uint32_t> numDropped;
+  };
+
+  /*
+   * Receive up to maxMessages messages of up to maxLen bytes on fd with
+   * single `recvmmsg` call. Truncated messages are skipped.
+   *
+   * @returns messages received, empty if there is none pending
+   */
+  static std::vector<IncomingMessage> recvMessages(
+      int fd, size_t maxMessages, size_t maxLen, IoProvider* ioProvider);
+
   /*
    * Send message on fd via given interface to the address provided
    * We supply socket address, which has dst IPv6 and port
@@ -88,6 +123,26 @@ class IoProvider {
       std::string const& packet,
       IoProvider* ioProvider);
 
+  // Message to be sent via given interface to the address provided
+  struct OutgoingMessage {
+    int ifIndex{0};
+    folly::IPAddressV6 srcAddr;
+    folly::SocketAddress dstAddr;
+    std::string packet;
+  };
+
+  /*
+   * Send batch of messages on fd with as few `sendmmsg` calls as possible.
+   * Message failing to be sent, e.g. on interface going down, is skipped and
+   * rest of the batch is sent with another call.
+   *
+   * @returns number of bytes sent for every message, or -errno on failure
+   */
+  static std::vector<ssize_t> sendMessages(
+      int fd,
+      std::vector<OutgoingMessage> const& messages,
+      IoProvider* ioProvider);
+
  private:
   IoProvider(IoProvider const&) = delete;
   IoProvider& operator=(IoProvider const&) = delete;
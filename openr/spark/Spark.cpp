@@ -13,12 +13,14 @@
 #include <folly/GLog.h>
 #include <folly/IPAddress.h>
 #include <folly/MapUtil.h>
+#include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
 #include <folly/fibers/FiberManagerMap.h>
 #include <folly/futures/Future.h>
 #include <folly/futures/Promise.h>
 #include <folly/gen/Base.h>
+#include <folly/tracing/StaticTracepoint.h>
 
 #include <openr/common/Constants.h>
 #include <openr/common/NetworkUtil.h>
@@ -45,6 +47,152 @@ const int kSparkHopLimit = 255;
 // number of restarting packets to send out per interface before I'm going down
 const int kNumRestartingPktSent = 3;
 
+// Maximum number of packets received and processed per wakeup of socket.
+// Bounds time spent on packets ahead of timers and other events
+const size_t kMaxPacketsPerWakeup = 32;
+
+// Maximum number of interfaces activated at once, and interval between
+// activation of batches. Spreads initial hellos of interfaces added in bulk
+const size_t kMaxInterfaceActivationsPerTick = 16;
+const std::chrono::milliseconds kInterfaceActivationInterval{10};
+
+// Append integer of given byte width to packet in network byte order
+void
+appendUint(std::string& packet, uint64_t value, size_t width) {
+  for (size_t i = width; i > 0; --i) {
+    packet.push_back(static_cast<char>((value >> ((i - 1) * 8)) & 0xff));
+  }
+}
+
+// Read integer of given byte width at offset of packet in network byte order
+uint64_t
+readUint(std::string const& packet, size_t offset, size_t width) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < width; ++i) {
+    value = (value << 8) | static_cast<uint8_t>(packet[offset + i]);
+  }
+  return value;
+}
+
+//
+// Fast heartbeat is fixed-format instead of thrift to keep cost of building
+// and parsing it minimal. It is laid out as
+//
+//  | magic (4) | version (1) | nodeName length (2) | nodeName |
+//
+// with integers in network byte order. First byte of magic is not a valid
+// field header of compact protocol, hence it can't be mistaken for a thrift
+// packet.
+//
+const uint32_t kFastHeartbeatMagic = 0x4F464842; // "OFHB"
+const uint8_t kFastHeartbeatVersion = 1;
+const size_t kFastHeartbeatHeaderLen = 7;
+
+bool
+isFastHeartbeat(std::string const& packet) {
+  return packet.size() >= kFastHeartbeatHeaderLen and
+      readUint(packet, 0, 4) == kFastHeartbeatMagic;
+}
+
+std::string
+encodeFastHeartbeat(std::string const& nodeName) {
+  CHECK_LE(nodeName.size(), 0xffff);
+  std::string packet;
+  packet.reserve(kFastHeartbeatHeaderLen + nodeName.size());
+  appendUint(packet, kFastHeartbeatMagic, 4);
+  appendUint(packet, kFastHeartbeatVersion, 1);
+  appendUint(packet, nodeName.size(), 2);
+  packet.append(nodeName);
+  return packet;
+}
+
+// Returns nodeName of sender, std::nullopt if packet is malformed
+std::optional<std::string>
+decodeFastHeartbeat(std::string const& packet) {
+  if (not isFastHeartbeat(packet) or
+      readUint(packet, 4, 1) != kFastHeartbeatVersion) {
+    return std::nullopt;
+  }
+  const size_t nameLen = readUint(packet, 5, 2);
+  if (packet.size() != kFastHeartbeatHeaderLen + nameLen or nameLen == 0) {
+    return std::nullopt;
+  }
+  return packet.substr(kFastHeartbeatHeaderLen);
+}
+
+//
+// Fixed-layout encoding of SparkHeartbeatMsg, sent in place of thrift one to
+// neighbors which support it as per their version. It is parsed without
+// allocation, and seqNum is updated in place on every send. It is laid out as
+//
+//  | magic (4) | version (1) | seqNum (8) | nodeName length (2) | nodeName |
+//
+// with integers in network byte order. Same as for fast heartbeat, it can't
+// be mistaken for a thrift packet.
+//
+const uint32_t kFixedHeartbeatMagic = 0x4F534842; // "OSHB"
+const uint8_t kFixedHeartbeatVersion = 1;
+const size_t kFixedHeartbeatSeqNumOffset = 5;
+const size_t kFixedHeartbeatHeaderLen = 15;
+
+bool
+isFixedHeartbeat(std::string const& packet) {
+  return packet.size() >= kFixedHeartbeatHeaderLen and
+      readUint(packet, 0, 4) == kFixedHeartbeatMagic;
+}
+
+std::string
+encodeFixedHeartbeat(std::string const& nodeName) {
+  CHECK_LE(nodeName.size(), 0xffff);
+  std::string packet;
+  packet.reserve(kFixedHeartbeatHeaderLen + nodeName.size());
+  appendUint(packet, kFixedHeartbeatMagic, 4);
+  appendUint(packet, kFixedHeartbeatVersion, 1);
+  appendUint(packet, 0 /* seqNum */, 8);
+  appendUint(packet, nodeName.size(), 2);
+  packet.append(nodeName);
+  return packet;
+}
+
+void
+setFixedHeartbeatSeqNum(std::string& packet, uint64_t seqNum) {
+  for (size_t i = 0; i < 8; ++i) {
+    packet[kFixedHeartbeatSeqNumOffset + i] =
+        static_cast<char>((seqNum >> ((7 - i) * 8)) & 0xff);
+  }
+}
+
+// Returns nodeName of sender, viewing into packet, std::nullopt if packet is
+// malformed
+std::optional<std::string_view>
+decodeFixedHeartbeat(std::string const& packet) {
+  if (not isFixedHeartbeat(packet) or
+      readUint(packet, 4, 1) != kFixedHeartbeatVersion) {
+    return std::nullopt;
+  }
+  const size_t nameLen = readUint(packet, 13, 2);
+  if (packet.size() != kFixedHeartbeatHeaderLen + nameLen or nameLen == 0) {
+    return std::nullopt;
+  }
+  return std::string_view(packet).substr(kFixedHeartbeatHeaderLen);
+}
+
+//
+// Compact protocol encoding of SparkHelloPacket, as seen by kernel packet
+// filter. Offsets are relative to UDP header, which socket filters of UDP
+// sockets see first
+//
+const uint32_t kUdpPayloadOffset = 8;
+// field headers: field id delta in high nibble, compact type in low one
+const uint8_t kCompactHelloMsgHeader = 0x3C; // field 3, struct
+const uint8_t kCompactHeartbeatMsgHeader = 0x4C; // field 4, struct
+const uint8_t kCompactHandshakeMsgHeader = 0x5C; // field 5, struct
+const uint8_t kCompactStringFieldHeader = 0x18; // next field, binary
+// strings up to this length have single byte varint length
+const size_t kCompactMaxShortStringLen = 127;
+// offset of IPv6 hop limit relative to network header
+const int32_t kIpv6HopLimitOffset = 7;
+
 //
 // Function to get current timestamp in microseconds using steady clock
 // NOTE: we use non-monotonic clock since kernel time-stamps do not support
@@ -249,6 +397,28 @@ Spark::Spark(
           std::chrono::seconds(*config->getSparkConfig().hold_time_s_ref())),
       gracefulRestartTime_(std::chrono::seconds(
           *config->getSparkConfig().graceful_restart_time_s_ref())),
+      enableFastHeartbeat_(
+          *config->getSparkConfig().enable_fast_heartbeat_ref()),
+      fastHeartbeatInterval_(std::chrono::milliseconds(
+          *config->getSparkConfig().fast_heartbeat_interval_ms_ref())),
+      fastHeartbeatHoldTime_(std::chrono::milliseconds(
+          *config->getSparkConfig().fast_heartbeat_hold_time_ms_ref())),
+      fastHeartbeatMaxPps_(
+          *config->getSparkConfig().fast_heartbeat_max_pps_per_interface_ref()),
+      enableFixedHeartbeat_(
+          *config->getSparkConfig().enable_fixed_layout_heartbeat_ref()),
+      enableKernelPacketFilter_(
+          *config->getSparkConfig().enable_kernel_packet_filter_ref()),
+      rttEwmaWeight_(*config->getSparkConfig()
+                          .rtt_change_conf_ref()
+                          ->ewma_weight_ref()),
+      rttChangeMinDelta_(std::chrono::microseconds(*config->getSparkConfig()
+                                                        .rtt_change_conf_ref()
+                                                        ->min_change_us_ref())),
+      rttChangeMinInterval_(
+          std::chrono::milliseconds(*config->getSparkConfig()
+                                         .rtt_change_conf_ref()
+                                         ->min_interval_ms_ref())),
       enableV4_(config->isV4Enabled()),
       neighborUpdatesQueue_(neighborUpdatesQueue),
       kKvStoreCmdPort_(kvStoreCmdPort),
@@ -341,6 +511,91 @@ Spark::stop() {
   OpenrEventBase::stop();
 }
 
+std::vector<sock_filter>
+Spark::createPacketFilter(
+    std::string const& domainName, std::string const& nodeName) {
+  std::vector<sock_filter> filter;
+  const uint32_t kDrop = 0;
+  const uint32_t kAccept = 0xffffffff;
+  auto load = [&](uint16_t size, uint32_t offset) {
+    filter.push_back(BPF_STMT(BPF_LD | size | BPF_ABS, offset));
+  };
+  auto dropUnless = [&](uint32_t value) {
+    filter.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, value, 1, 0));
+    filter.push_back(BPF_STMT(BPF_RET | BPF_K, kDrop));
+  };
+  auto acceptIf = [&](uint32_t value) {
+    filter.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, value, 0, 1));
+    filter.push_back(BPF_STMT(BPF_RET | BPF_K, kAccept));
+  };
+  // split bytes at offset into loads of at most 4 bytes, network byte order
+  auto getChunks = [](std::string const& bytes, uint32_t offset) {
+    std::vector<std::tuple<uint16_t, uint32_t, uint32_t>> chunks;
+    for (size_t pos = 0; pos < bytes.size();) {
+      const size_t remaining = bytes.size() - pos;
+      const size_t width = remaining >= 4 ? 4 : (remaining >= 2 ? 2 : 1);
+      const uint16_t size = width == 4 ? BPF_W : (width == 2 ? BPF_H : BPF_B);
+      chunks.emplace_back(size, offset + pos, readUint(bytes, pos, width));
+      pos += width;
+    }
+    return chunks;
+  };
+
+  // packets are sent with maximum hop limit, see validatePacket()
+  load(BPF_B, SKF_NET_OFF + kIpv6HopLimitOffset);
+  dropUnless(kSparkHopLimit);
+
+  load(BPF_B, kUdpPayloadOffset);
+  acceptIf(kCompactHeartbeatMsgHeader);
+  acceptIf(kCompactHandshakeMsgHeader);
+  // anything else than hello must be either of fixed-format heartbeats
+  filter.push_back(BPF_JUMP(
+      BPF_JMP | BPF_JEQ | BPF_K, kCompactHelloMsgHeader, 6 /* hello */, 0));
+  load(BPF_W, kUdpPayloadOffset);
+  acceptIf(kFastHeartbeatMagic);
+  acceptIf(kFixedHeartbeatMagic);
+  filter.push_back(BPF_STMT(BPF_RET | BPF_K, kDrop));
+
+  // hello: domainName and nodeName are its first two fields. Longer ones
+  // than of single byte length are not worth the filter
+  if (domainName.size() > kCompactMaxShortStringLen) {
+    filter.push_back(BPF_STMT(BPF_RET | BPF_K, kAccept));
+    return filter;
+  }
+  std::string domainField;
+  domainField.push_back(kCompactStringFieldHeader);
+  domainField.push_back(static_cast<char>(domainName.size()));
+  domainField.append(domainName);
+  for (auto const& [size, offset, value] :
+       getChunks(domainField, kUdpPayloadOffset + 1)) {
+    load(size, offset);
+    dropUnless(value);
+  }
+
+  // drop own hellos looped back by the segment
+  if (nodeName.size() <= kCompactMaxShortStringLen) {
+    std::string nodeField;
+    nodeField.push_back(kCompactStringFieldHeader);
+    nodeField.push_back(static_cast<char>(nodeName.size()));
+    nodeField.append(nodeName);
+    auto const chunks =
+        getChunks(nodeField, kUdpPayloadOffset + 1 + domainField.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      auto const& [size, offset, value] = chunks[i];
+      load(size, offset);
+      // jump to accept on first mismatch
+      filter.push_back(BPF_JUMP(
+          BPF_JMP | BPF_JEQ | BPF_K,
+          value,
+          0,
+          static_cast<uint8_t>(2 * (chunks.size() - 1 - i) + 1)));
+    }
+    filter.push_back(BPF_STMT(BPF_RET | BPF_K, kDrop));
+  }
+  filter.push_back(BPF_STMT(BPF_RET | BPF_K, kAccept));
+  return filter;
+}
+
 void
 Spark::prepareSocket(std::optional<int> maybeIpTos) noexcept {
   int fd = ioProvider_->socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
@@ -442,6 +697,15 @@ Spark::prepareSocket(std::optional<int> maybeIpTos) noexcept {
                << folly::errnoStr(errno);
   }
 
+  // report packets dropped for lack of socket buffer space
+  const int reportDrops = 1;
+  if (ioProvider_->setsockopt(
+          fd, SOL_SOCKET, SO_RXQ_OVFL, &reportDrops, sizeof(reportDrops)) !=
+      0) {
+    LOG(ERROR) << "Failed to enable reporting of dropped packets. Error: "
+               << folly::errnoStr(errno);
+  }
+
   // enable timestamping for this socket
   const int enabled = 1;
   if (ioProvider_->setsockopt(
@@ -451,6 +715,19 @@ Spark::prepareSocket(std::optional<int> maybeIpTos) noexcept {
                << folly::errnoStr(errno);
   }
 
+  // drop packets of other domains and own looped back hellos before they
+  // reach user space and get parsed
+  if (enableKernelPacketFilter_) {
+    auto filter = createPacketFilter(myDomainName_, myNodeName_);
+    sock_fprog prog{static_cast<unsigned short>(filter.size()), filter.data()};
+    if (ioProvider_->setsockopt(
+            fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) != 0) {
+      LOG(ERROR) << "Failed to attach packet filter to socket, packets are "
+                 << "filtered in user space only. Error: "
+                 << folly::errnoStr(errno);
+    }
+  }
+
   LOG(INFO) << "Spark thread attaching socket/events callbacks...";
 
   // Listen for incoming messages on multicast FD
@@ -470,6 +747,24 @@ Spark::prepareSocket(std::optional<int> maybeIpTos) noexcept {
     counterUpdateTimer_->scheduleTimeout(Constants::kCounterSubmitInterval);
   });
   counterUpdateTimer_->scheduleTimeout(Constants::kCounterSubmitInterval);
+
+  if (enableFixedHeartbeat_) {
+    fixedHeartbeatPacket_ = encodeFixedHeartbeat(myNodeName_);
+  }
+
+  activationTimer_ = folly::AsyncTimeout::make(
+      *getEvb(), [this]() noexcept { activateInterfaces(); });
+
+  // send fast heartbeats of all interfaces together on single timer
+  if (enableFastHeartbeat_) {
+    fastHeartbeatPacket_ = encodeFastHeartbeat(myNodeName_);
+    fastHeartbeatTimer_ =
+        folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+          sendFastHeartbeats();
+          fastHeartbeatTimer_->scheduleTimeout(fastHeartbeatInterval_);
+        });
+    fastHeartbeatTimer_->scheduleTimeout(fastHeartbeatInterval_);
+  }
 }
 
 PacketValidationResult
@@ -521,20 +816,12 @@ Spark::shouldProcessHelloPacket(
 }
 
 bool
-Spark::parsePacket(
-    thrift::SparkHelloPacket& pkt,
-    std::string& ifName,
-    std::chrono::microseconds& recvTime) {
-  // the read buffer
-  uint8_t buf[kMinIpv6Mtu];
-
-  ssize_t bytesRead;
-  int ifIndex;
-  folly::SocketAddress clientAddr;
-  int hopLimit;
-
-  std::tie(bytesRead, ifIndex, clientAddr, hopLimit, recvTime) =
-      IoProvider::recvMessage(mcastFd_, buf, kMinIpv6Mtu, ioProvider_.get());
+Spark::validatePacket(
+    IoProvider::IncomingMessage const& message, std::string& ifName) {
+  const auto bytesRead = message.packet.size();
+  const auto ifIndex = message.ifIndex;
+  const auto& clientAddr = message.srcAddr;
+  const auto hopLimit = message.hopLimit;
 
   if (hopLimit < kSparkHopLimit) {
     LOG(ERROR) << "Rejecting packet from " << clientAddr.getAddressStr()
@@ -571,24 +858,17 @@ Spark::parsePacket(
 
   fb303::fbData->addStatValue("spark.hello_packet_processed", 1, fb303::SUM);
 
-  if (bytesRead >= 0) {
-    VLOG(4) << "Read a total of " << bytesRead << " bytes from fd " << mcastFd_;
-
-    if (static_cast<size_t>(bytesRead) > kMinIpv6Mtu) {
-      LOG(ERROR) << "Message from " << clientAddr.getAddressStr()
-                 << " has been truncated";
-      return false;
-    }
-  } else {
-    LOG(ERROR) << "Failed reading from fd " << mcastFd_ << " error "
-               << folly::errnoStr(errno);
-    return false;
-  }
+  VLOG(4) << "Read a total of " << bytesRead << " bytes from fd " << mcastFd_;
+  return true;
+}
 
-  // Copy buffer into string object and parse it into helloPacket.
-  std::string readBuf(reinterpret_cast<const char*>(&buf[0]), bytesRead);
+bool
+Spark::parsePacket(
+    IoProvider::IncomingMessage const& message, thrift::SparkHelloPacket& pkt) {
+  // Parse buffer into helloPacket
   try {
-    pkt = readThriftObjStr<thrift::SparkHelloPacket>(readBuf, serializer_);
+    pkt = readThriftObjStr<thrift::SparkHelloPacket>(
+        message.packet, serializer_);
   } catch (std::out_of_range const& err) {
     LOG(INFO) << "Malformed Thrift packet: " << folly::exceptionStr(err);
     return false;
@@ -654,14 +934,58 @@ Spark::processRttChange(
     return;
   }
 
+  // suppress changes within noise of currently reported RTT
+  const std::chrono::microseconds rtt{newRtt};
+  if (std::chrono::abs(rtt - sparkNeighbor.rtt) < rttChangeMinDelta_) {
+    VLOG(2) << "RTT change for sparkNeighbor " << neighborName << " from "
+            << sparkNeighbor.rtt.count() << "usecs to " << newRtt
+            << "usecs is below threshold. Skip RTT change notification.";
+    fb303::fbData->addStatValue("spark.rtt_change.suppressed", 1, fb303::SUM);
+    return;
+  }
+
+  // rate limit changes of neighbor, latest one is reported at end of interval
+  const auto now = std::chrono::steady_clock::now();
+  if (sparkNeighbor.lastRttChangeTime.has_value() and
+      now - *sparkNeighbor.lastRttChangeTime < rttChangeMinInterval_) {
+    fb303::fbData->addStatValue("spark.rtt_change.deferred", 1, fb303::SUM);
+    sparkNeighbor.rttPending = rtt;
+    if (not sparkNeighbor.rttChangeTimer) {
+      sparkNeighbor.rttChangeTimer = NeighborTimeout::make(
+          *getEvb(), [this, ifName, neighborName]() noexcept {
+            auto& neighbor = sparkNeighbors_.at(ifName).at(neighborName);
+            if (neighbor.state == SparkNeighState::ESTABLISHED) {
+              reportRttChange(
+                  ifName, neighborName, neighbor, neighbor.rttPending);
+            }
+          });
+    }
+    if (not sparkNeighbor.rttChangeTimer->isScheduled()) {
+      sparkNeighbor.rttChangeTimer->scheduleTimeout(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              *sparkNeighbor.lastRttChangeTime + rttChangeMinInterval_ - now));
+    }
+    return;
+  }
+
+  reportRttChange(ifName, neighborName, sparkNeighbor, rtt);
+}
+
+void
+Spark::reportRttChange(
+    std::string const& ifName,
+    std::string const& neighborName,
+    SparkNeighbor& neighbor,
+    std::chrono::microseconds newRtt) {
   LOG(INFO) << "RTT for sparkNeighbor " << neighborName << " has changed "
-            << "from " << sparkNeighbor.rtt.count() << "usecs to " << newRtt
-            << "usecs over interface " << ifName;
+            << "from " << neighbor.rtt.count() << "usecs to "
+            << newRtt.count() << "usecs over interface " << ifName;
 
-  sparkNeighbor.rtt = std::chrono::microseconds(newRtt);
+  fb303::fbData->addStatValue("spark.rtt_change.propagated", 1, fb303::SUM);
+  neighbor.rtt = newRtt;
+  neighbor.lastRttChangeTime = std::chrono::steady_clock::now();
   notifySparkNeighborEvent(
-      thrift::SparkNeighborEventType::NEIGHBOR_RTT_CHANGE,
-      sparkNeighbor.toThrift());
+      thrift::SparkNeighborEventType::NEIGHBOR_RTT_CHANGE, neighbor.toThrift());
 }
 
 void
@@ -727,10 +1051,20 @@ Spark::updateNeighborRtt(
     if (sparkNeighborIt != sparkIfNeighbors.end()) {
       auto& sparkNeighbor = sparkNeighborIt->second;
 
+      // Smooth out noise of measurements ahead of step detection
+      if (!sparkNeighbor.rttSmoothed.count()) {
+        sparkNeighbor.rttSmoothed = rtt;
+      } else {
+        sparkNeighbor.rttSmoothed =
+            std::chrono::microseconds(static_cast<int64_t>(
+                rttEwmaWeight_ * rtt.count() +
+                (1 - rttEwmaWeight_) * sparkNeighbor.rttSmoothed.count()));
+      }
+
       // Add it to step detector
       sparkNeighbor.stepDetector.addValue(
           std::chrono::duration_cast<std::chrono::milliseconds>(myRecvTime),
-          rtt.count());
+          sparkNeighbor.rttSmoothed.count());
       // Set initial value if empty
       if (!sparkNeighbor.rtt.count()) {
         VLOG(2) << "Setting initial value for RTT for sparkNeighbor "
@@ -790,19 +1124,8 @@ Spark::sendHandshakeMsg(
     return;
   }
 
-  auto bytesSent = IoProvider::sendMessage(
-      mcastFd_, ifIndex, v6Addr.asV6(), dstAddr, packet, ioProvider_.get());
-
-  if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
-    VLOG(1) << "Sending multicast to " << dstAddr.getAddressStr() << " on "
-            << ifName << " failed due to error " << folly::errnoStr(errno);
-    return;
-  }
-
-  // update counters for number of pkts and total size of pkts sent
-  fb303::fbData->addStatValue(
-      "spark.handshake.bytes_sent", packet.size(), fb303::SUM);
-  fb303::fbData->addStatValue("spark.handshake.packets_sent", 1, fb303::SUM);
+  queuePacket(
+      ifName, ifIndex, v6Addr.asV6(), dstAddr, std::move(packet), "handshake");
 }
 
 void
@@ -830,15 +1153,30 @@ Spark::sendHeartbeatMsg(std::string const& ifName) {
   const auto ifIndex = interfaceEntry.ifIndex;
   const auto v6Addr = interfaceEntry.v6LinkLocalNetwork.first;
 
-  // build heartbeat msg
-  thrift::SparkHeartbeatMsg heartbeatMsg;
-  *heartbeatMsg.nodeName_ref() = myNodeName_;
-  heartbeatMsg.seqNum_ref() = mySeqNum_;
-
-  thrift::SparkHelloPacket pkt;
-  pkt.heartbeatMsg_ref() = std::move(heartbeatMsg);
+  // Multicast packet must be understood by all neighbors of interface
+  bool useFixedLayout = enableFixedHeartbeat_;
+  for (auto const& [_, neighbor] : sparkNeighbors_.at(ifName)) {
+    if (not useFixedLayout) {
+      break;
+    }
+    useFixedLayout =
+        neighbor.version >= Constants::kSparkFixedHeartbeatVersion;
+  }
 
-  auto packet = writeThriftObjStr(pkt, serializer_);
+  std::string packet;
+  if (useFixedLayout) {
+    setFixedHeartbeatSeqNum(fixedHeartbeatPacket_, mySeqNum_);
+    packet = fixedHeartbeatPacket_;
+  } else {
+    // build heartbeat msg once, only seqNum changes
+    if (not heartbeatPacket_.heartbeatMsg_ref().has_value()) {
+      thrift::SparkHeartbeatMsg heartbeatMsg;
+      *heartbeatMsg.nodeName_ref() = myNodeName_;
+      heartbeatPacket_.heartbeatMsg_ref() = std::move(heartbeatMsg);
+    }
+    heartbeatPacket_.heartbeatMsg_ref()->seqNum_ref() = mySeqNum_;
+    packet = writeThriftObjStr(heartbeatPacket_, serializer_);
+  }
 
   // send the pkt
   folly::SocketAddress dstAddr(
@@ -850,19 +1188,99 @@ Spark::sendHeartbeatMsg(std::string const& ifName) {
     return;
   }
 
-  auto bytesSent = IoProvider::sendMessage(
-      mcastFd_, ifIndex, v6Addr.asV6(), dstAddr, packet, ioProvider_.get());
+  queuePacket(
+      ifName,
+      ifIndex,
+      v6Addr.asV6(),
+      dstAddr,
+      std::move(packet),
+      useFixedLayout ? "fixed_heartbeat" : "heartbeat");
+}
+
+void
+Spark::sendFastHeartbeats() {
+  folly::SocketAddress dstAddr(
+      folly::IPAddress(Constants::kSparkMcastAddr.toString()),
+      neighborDiscoveryPort_);
+
+  for (auto const& [ifName, _] : ifNameToActiveNeighbors_) {
+    auto interfaceIt = interfaceDb_.find(ifName);
+    if (interfaceIt == interfaceDb_.end()) {
+      continue;
+    }
+    const auto& interfaceEntry = interfaceIt->second;
+    queuePacket(
+        ifName,
+        interfaceEntry.ifIndex,
+        interfaceEntry.v6LinkLocalNetwork.first.asV6(),
+        dstAddr,
+        std::string(fastHeartbeatPacket_),
+        "fast_heartbeat");
+  }
+}
+
+void
+Spark::processFastHeartbeat(IoProvider::IncomingMessage const& message) {
+  if (not enableFastHeartbeat_) {
+    return;
+  }
+
+  if (message.hopLimit < kSparkHopLimit) {
+    LOG(ERROR) << "Rejecting fast heartbeat from "
+               << message.srcAddr.getAddressStr() << " due to hop limit being "
+               << message.hopLimit;
+    return;
+  }
+
+  auto maybeIfName = findInterfaceFromIfindex(message.ifIndex);
+  if (not maybeIfName.has_value()) {
+    return;
+  }
+  auto const& ifName = maybeIfName.value();
+
+  // bound CPU spent on fast heartbeats of any one interface
+  auto limiterIt = fastHeartbeatLimiters_
+                       .try_emplace(
+                           ifName,
+                           fastHeartbeatMaxPps_ /* rate */,
+                           fastHeartbeatMaxPps_ /* burst */)
+                       .first;
+  if (not limiterIt->second.consume(1)) {
+    fb303::fbData->addStatValue("spark.fast_heartbeat.dropped", 1, fb303::SUM);
+    return;
+  }
+
+  auto maybeNeighborName = decodeFastHeartbeat(message.packet);
+  if (not maybeNeighborName.has_value()) {
+    fb303::fbData->addStatValue(
+        "spark.fast_heartbeat.malformed", 1, fb303::SUM);
+    return;
+  }
+  fb303::fbData->addStatValue("spark.fast_heartbeat.recv", 1, fb303::SUM);
 
-  if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
-    VLOG(1) << "Sending multicast to " << dstAddr.getAddressStr() << " on "
-            << ifName << " failed due to error " << folly::errnoStr(errno);
+  auto ifNeighborsIt = sparkNeighbors_.find(ifName);
+  if (ifNeighborsIt == sparkNeighbors_.end()) {
+    return;
+  }
+  auto const& neighborName = maybeNeighborName.value();
+  auto neighborIt = ifNeighborsIt->second.find(neighborName);
+  if (neighborIt == ifNeighborsIt->second.end() or
+      neighborIt->second.state != SparkNeighState::ESTABLISHED) {
     return;
   }
 
-  // update counters for number of pkts and total size of pkts sent
-  fb303::fbData->addStatValue(
-      "spark.heartbeat.bytes_sent", packet.size(), fb303::SUM);
-  fb303::fbData->addStatValue("spark.heartbeat.packets_sent", 1, fb303::SUM);
+  auto& neighbor = neighborIt->second;
+  if (not neighbor.fastHeartbeatHoldTimer) {
+    neighbor.fastHeartbeatHoldTimer = NeighborTimeout::make(
+        *getEvb(), [this, ifName, neighborName]() noexcept {
+          LOG(INFO) << "Fast heartbeat timer expired for: " << neighborName
+                    << " on interface " << ifName;
+          fb303::fbData->addStatValue(
+              "spark.fast_heartbeat.neighbor_down", 1, fb303::SUM);
+          processHeartbeatTimeout(ifName, neighborName);
+        });
+  }
+  neighbor.fastHeartbeatHoldTimer->scheduleTimeout(fastHeartbeatHoldTime_);
 }
 
 void
@@ -1005,8 +1423,11 @@ Spark::neighborUpWrapper(
   // remove negotiate hold timer, no longer in NEGOTIATE stage
   neighbor.negotiateHoldTimer.reset();
 
+  // fast heartbeat hold timer is armed on first fast heartbeat received
+  neighbor.fastHeartbeatHoldTimer.reset();
+
   // create heartbeat hold timer when promote to "ESTABLISHED"
-  neighbor.heartbeatHoldTimer = folly::AsyncTimeout::make(
+  neighbor.heartbeatHoldTimer = NeighborTimeout::make(
       *getEvb(), [this, ifName, neighborName]() noexcept {
         processHeartbeatTimeout(ifName, neighborName);
       });
@@ -1015,6 +1436,18 @@ Spark::neighborUpWrapper(
   // add neighborName to collection
   ifNameToActiveNeighbors_[ifName].emplace(neighborName);
 
+  // Time from bulk add of interfaces to first neighbor up over them. Value
+  // set for last interface of bulk is time until all neighbors established
+  auto addTimeIt = ifNameToAddTime_.find(ifName);
+  if (addTimeIt != ifNameToAddTime_.end()) {
+    fb303::fbData->setCounter(
+        "spark.interfaces_to_neighbors_up.time_ms",
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - addTimeIt->second)
+            .count());
+    ifNameToAddTime_.erase(addTimeIt);
+  }
+
   // notify LinkMonitor about neighbor UP state
   notifySparkNeighborEvent(
       thrift::SparkNeighborEventType::NEIGHBOR_UP, neighbor.toThrift());
@@ -1062,6 +1495,7 @@ Spark::processHeartbeatTimeout(
   SCOPE_EXIT {
     allocatedLabels_.erase(neighbor.label);
     ifNeighbors.erase(neighborName);
+    invalidateHelloPacket(ifName);
   };
 
   LOG(INFO) << "Heartbeat timer expired for: " << neighborName
@@ -1114,6 +1548,7 @@ Spark::processGRTimeout(
   SCOPE_EXIT {
     allocatedLabels_.erase(neighbor.label);
     ifNeighbors.erase(neighborName);
+    invalidateHelloPacket(ifName);
   };
 
   LOG(INFO) << "Graceful restart timer expired for: " << neighborName
@@ -1141,7 +1576,7 @@ Spark::processGRMsg(
       thrift::SparkNeighborEventType::NEIGHBOR_RESTARTING, neighbor.toThrift());
 
   // start graceful-restart timer
-  neighbor.gracefulRestartHoldTimer = folly::AsyncTimeout::make(
+  neighbor.gracefulRestartHoldTimer = NeighborTimeout::make(
       *getEvb(), [this, ifName, neighborName]() noexcept {
         // change the state back to IDLE
         processGRTimeout(ifName, neighborName);
@@ -1156,6 +1591,7 @@ Spark::processGRMsg(
 
   // neihbor is restarting, shutdown heartbeat hold timer
   neighbor.heartbeatHoldTimer.reset();
+  neighbor.fastHeartbeatHoldTimer.reset();
 }
 
 void
@@ -1226,6 +1662,7 @@ Spark::processHelloMsg(
             keepAliveTime_, // stepDetector sample period
             std::move(rttChangeCb),
             area.value()));
+    invalidateHelloPacket(ifName);
 
     auto& neighbor = ifNeighbors.at(neighborName);
     checkNeighborState(neighbor, SparkNeighState::IDLE);
@@ -1233,11 +1670,17 @@ Spark::processHelloMsg(
 
   // Up till now, node knows about this neighbor and perform SM check
   auto& neighbor = ifNeighbors.at(neighborName);
+  neighbor.version = remoteVersion;
 
   // Update timestamps for received hello packet for neighbor
   neighbor.neighborTimestamp = nbrSentTimeInUs;
   neighbor.localTimestamp = myRecvTimeInUs;
 
+  // Reflect neighbor info changed from here on in hello packet
+  SCOPE_EXIT {
+    updateHelloPacketNeighborInfo(ifName, neighborName);
+  };
+
   // Deduce RTT for this neighbor and update timestamps
   auto tsIt = neighborInfos.find(myNodeName_);
   if (tsIt != neighborInfos.end()) {
@@ -1262,6 +1705,7 @@ Spark::processHelloMsg(
   // for neighbor in fast initial state and does not see us yet,
   // reply for quick convergence
   if (*helloMsg.solicitResponse_ref()) {
+    updateHelloPacketNeighborInfo(ifName, neighborName);
     sendHelloMsg(ifName);
 
     VLOG(3) << "Reply to neighbor's helloMsg since it is under fastInit";
@@ -1299,7 +1743,7 @@ Spark::processHelloMsg(
 
     // Starts timer to periodically send hankshake msg
     const std::string neighborAreaId = neighbor.area;
-    neighbor.negotiateTimer = folly::AsyncTimeout::make(
+    neighbor.negotiateTimer = NeighborTimeout::make(
         *getEvb(), [this, ifName, neighborName, neighborAreaId]() noexcept {
           sendHandshakeMsg(ifName, neighborName, neighborAreaId, false);
           // send out handshake msg periodically to this neighbor
@@ -1315,7 +1759,7 @@ Spark::processHelloMsg(
     neighbor.negotiateTimer->scheduleTimeout(handshakeTime_);
 
     // Starts negotiate hold-timer
-    neighbor.negotiateHoldTimer = folly::AsyncTimeout::make(
+    neighbor.negotiateHoldTimer = NeighborTimeout::make(
         *getEvb(), [this, ifName, neighborName]() noexcept {
           // prevent to stucking in NEGOTIATE forever
           processNegotiateTimeout(ifName, neighborName);
@@ -1355,6 +1799,7 @@ Spark::processHelloMsg(
       // remove from tracked neighbor at the end
       allocatedLabels_.erase(neighbor.label);
       ifNeighbors.erase(neighborName);
+      invalidateHelloPacket(ifName);
     }
   } else if (neighbor.state == SparkNeighState::RESTART) {
     // Neighbor is undergoing restart. Will reply immediately for hello msg for
@@ -1386,7 +1831,7 @@ Spark::processHelloMsg(
         neighbor.toThrift());
 
     // start heartbeat timer again to make sure neighbor is alive
-    neighbor.heartbeatHoldTimer = folly::AsyncTimeout::make(
+    neighbor.heartbeatHoldTimer = NeighborTimeout::make(
         *getEvb(), [this, ifName, neighborName]() noexcept {
           processHeartbeatTimeout(ifName, neighborName);
         });
@@ -1554,7 +1999,12 @@ Spark::processHandshakeMsg(
 void
 Spark::processHeartbeatMsg(
     thrift::SparkHeartbeatMsg const& heartbeatMsg, std::string const& ifName) {
-  auto const& neighborName = *heartbeatMsg.nodeName_ref();
+  processHeartbeat(ifName, *heartbeatMsg.nodeName_ref());
+}
+
+void
+Spark::processHeartbeat(
+    std::string const& ifName, std::string_view neighborName) {
   auto& ifNeighbors = sparkNeighbors_.at(ifName);
   auto neighborIt = ifNeighbors.find(neighborName);
 
@@ -1584,12 +2034,73 @@ Spark::processHeartbeatMsg(
 
 void
 Spark::processPacket() {
-  // receive and parse pkt
-  thrift::SparkHelloPacket helloPacket;
+  // Drain pending packets up to the budget with single syscall. Packets left
+  // keep socket readable and get processed on next wakeup
+  auto messages = IoProvider::recvMessages(
+      mcastFd_, kMaxPacketsPerWakeup, kMinIpv6Mtu, ioProvider_.get());
+  fb303::fbData->addStatValue(
+      "spark.hello_packet_recv_per_wakeup", messages.size(), fb303::AVG);
+
+  for (auto const& message : messages) {
+    if (message.numDropped.has_value()) {
+      // Counter of socket is cumulative, report increments
+      const uint32_t numDropped =
+          message.numDropped.value() - numSocketDropped_;
+      numSocketDropped_ = message.numDropped.value();
+      if (numDropped) {
+        LOG(WARNING) << "Socket dropped " << numDropped
+                     << " packets for lack of buffer space";
+        fb303::fbData->addStatValue(
+            "spark.hello_packet_backlog_dropped", numDropped, fb303::SUM);
+      }
+    }
+
+    try {
+      processPacket(message);
+    } catch (std::exception const& err) {
+      if (isThrowParserErrorsOn_) {
+        throw;
+      }
+      LOG(ERROR) << "Spark: error processing hello packet "
+                 << folly::exceptionStr(err);
+    }
+  }
+}
+
+void
+Spark::processPacket(IoProvider::IncomingMessage const& message) {
+  FOLLY_SDT(
+      openr,
+      spark_process_packet_entry,
+      message.ifIndex,
+      message.packet.size());
+  SCOPE_EXIT {
+    FOLLY_SDT(openr, spark_process_packet_return, message.ifIndex);
+  };
+  if (isFastHeartbeat(message.packet)) {
+    processFastHeartbeat(message);
+    return;
+  }
+
   std::string ifName;
-  std::chrono::microseconds myRecvTime;
+  const auto myRecvTime = message.recvTs;
+  if (!validatePacket(message, ifName)) {
+    return;
+  }
 
-  if (!parsePacket(helloPacket, ifName, myRecvTime)) {
+  if (isFixedHeartbeat(message.packet)) {
+    auto neighborName = decodeFixedHeartbeat(message.packet);
+    if (not neighborName.has_value()) {
+      LOG(INFO) << "Malformed fixed-layout heartbeat packet";
+      return;
+    }
+    processHeartbeat(ifName, neighborName.value());
+    return;
+  }
+
+  // parse pkt
+  thrift::SparkHelloPacket helloPacket;
+  if (!parsePacket(message, helloPacket)) {
     return;
   }
 
@@ -1627,41 +2138,47 @@ Spark::sendHelloMsg(
   // down event has not arrived yet
   const auto& interfaceEntry = interfaceDb_.at(ifName);
   const auto ifIndex = interfaceEntry.ifIndex;
-  const auto v4Addr = interfaceEntry.v4Network.first;
   const auto v6Addr = interfaceEntry.v6LinkLocalNetwork.first;
-  thrift::OpenrVersion openrVer(*kVersion_.version_ref());
 
-  // build the helloMsg from scratch
-  thrift::SparkHelloMsg helloMsg;
-  *helloMsg.domainName_ref() = myDomainName_;
-  *helloMsg.nodeName_ref() = myNodeName_;
-  *helloMsg.ifName_ref() = ifName;
-  helloMsg.seqNum_ref() = mySeqNum_;
-  *helloMsg.neighborInfos_ref() =
-      std::map<std::string, thrift::ReflectedNeighborInfo>{};
-  helloMsg.version_ref() = openrVer;
-  helloMsg.solicitResponse_ref() = inFastInitState;
-  helloMsg.restarting_ref() = restarting;
-  helloMsg.sentTsInUs_ref() = getCurrentTimeInUs().count();
+  auto helloPacketIt = helloPackets_.find(ifName);
+  if (helloPacketIt == helloPackets_.end()) {
+    // build the helloMsg from scratch
+    thrift::SparkHelloMsg helloMsg;
+    *helloMsg.domainName_ref() = myDomainName_;
+    *helloMsg.nodeName_ref() = myNodeName_;
+    *helloMsg.ifName_ref() = ifName;
+    *helloMsg.neighborInfos_ref() =
+        std::map<std::string, thrift::ReflectedNeighborInfo>{};
+    helloMsg.version_ref() = thrift::OpenrVersion(*kVersion_.version_ref());
+
+    // bake neighborInfo into helloMsg
+    for (const auto& kv : sparkNeighbors_.at(ifName)) {
+      auto const& neighborName = kv.first;
+      auto const& neighbor = kv.second;
 
-  // bake neighborInfo into helloMsg
-  for (const auto& kv : sparkNeighbors_.at(ifName)) {
-    auto const& neighborName = kv.first;
-    auto const& neighbor = kv.second;
+      auto& neighborInfo = helloMsg.neighborInfos_ref()[neighborName];
+      neighborInfo.seqNum_ref() = neighbor.seqNum;
+      neighborInfo.lastNbrMsgSentTsInUs_ref() =
+          neighbor.neighborTimestamp.count();
+      neighborInfo.lastMyMsgRcvdTsInUs_ref() = neighbor.localTimestamp.count();
+    }
 
-    auto& neighborInfo = helloMsg.neighborInfos_ref()[neighborName];
-    neighborInfo.seqNum_ref() = neighbor.seqNum;
-    neighborInfo.lastNbrMsgSentTsInUs_ref() =
-        neighbor.neighborTimestamp.count();
-    neighborInfo.lastMyMsgRcvdTsInUs_ref() = neighbor.localTimestamp.count();
+    // fill in helloMsg field
+    thrift::SparkHelloPacket helloPacket;
+    helloPacket.helloMsg_ref() = std::move(helloMsg);
+    helloPacketIt = helloPackets_.emplace(ifName, std::move(helloPacket)).first;
+    fb303::fbData->addStatValue("spark.hello.packets_built", 1, fb303::SUM);
   }
 
-  // fill in helloMsg field
-  thrift::SparkHelloPacket helloPacket;
-  helloPacket.helloMsg_ref() = std::move(helloMsg);
+  // update per packet fields of helloMsg
+  auto& helloMsg = helloPacketIt->second.helloMsg_ref().value();
+  helloMsg.seqNum_ref() = mySeqNum_;
+  helloMsg.solicitResponse_ref() = inFastInitState;
+  helloMsg.restarting_ref() = restarting;
+  helloMsg.sentTsInUs_ref() = getCurrentTimeInUs().count();
 
   // send the payload
-  auto packet = writeThriftObjStr(helloPacket, serializer_);
+  auto packet = writeThriftObjStr(helloPacketIt->second, serializer_);
   folly::SocketAddress dstAddr(
       folly::IPAddress(Constants::kSparkMcastAddr.toString()),
       neighborDiscoveryPort_);
@@ -1671,21 +2188,97 @@ Spark::sendHelloMsg(
     return;
   }
 
-  auto bytesSent = IoProvider::sendMessage(
-      mcastFd_, ifIndex, v6Addr.asV6(), dstAddr, packet, ioProvider_.get());
+  queuePacket(
+      ifName, ifIndex, v6Addr.asV6(), dstAddr, std::move(packet), "hello");
+}
+
+void
+Spark::queuePacket(
+    std::string const& ifName,
+    int ifIndex,
+    folly::IPAddressV6 const& srcAddr,
+    folly::SocketAddress const& dstAddr,
+    std::string&& packet,
+    const char* packetType) {
+  if (pendingPackets_.empty()) {
+    // Send packets queued by all interfaces within this loop iteration, e.g.
+    // on expiry of many timers at once, together
+    getEvb()->runInLoop([this]() noexcept { flushPackets(); });
+  }
+  pendingPackets_.push_back(PendingPacket{
+      ifName, packetType, {ifIndex, srcAddr, dstAddr, std::move(packet)}});
+}
+
+void
+Spark::flushPackets() {
+  auto pendingPackets = std::move(pendingPackets_);
+  pendingPackets_.clear();
+  std::vector<IoProvider::OutgoingMessage> messages;
+  messages.reserve(pendingPackets.size());
+  for (auto& pendingPacket : pendingPackets) {
+    messages.emplace_back(std::move(pendingPacket.message));
+  }
+
+  const auto bytesSent =
+      IoProvider::sendMessages(mcastFd_, messages, ioProvider_.get());
+  fb303::fbData->addStatValue("spark.send.batches", 1, fb303::SUM);
+  fb303::fbData->addStatValue(
+      "spark.send.packets", messages.size(), fb303::SUM);
+
+  for (size_t i = 0; i < messages.size(); ++i) {
+    const auto& message = messages[i];
+    const auto& pendingPacket = pendingPackets[i];
+    if ((bytesSent[i] < 0) ||
+        (static_cast<size_t>(bytesSent[i]) != message.packet.size())) {
+      VLOG(1) << "Sending multicast to " << message.dstAddr.getAddressStr()
+              << " on " << pendingPacket.ifName << " failed due to error "
+              << folly::errnoStr(std::abs(bytesSent[i]));
+      continue;
+    }
+
+    // update counters for number of pkts and total size of pkts sent
+    const std::string packetType(pendingPacket.packetType);
+    fb303::fbData->addStatValue(
+        "spark." + packetType + ".bytes_sent",
+        message.packet.size(),
+        fb303::SUM);
+    fb303::fbData->addStatValue(
+        "spark." + packetType + ".packets_sent", 1, fb303::SUM);
+    VLOG(4) << "Sent " << bytesSent[i] << " bytes in " << packetType
+            << " packet";
+  }
+}
+
+void
+Spark::invalidateHelloPacket(std::string const& ifName) {
+  helloPackets_.erase(ifName);
+}
 
-  if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
-    VLOG(1) << "Sending multicast to " << dstAddr.getAddressStr() << " on "
-            << ifName << " failed due to error " << folly::errnoStr(errno);
+void
+Spark::updateHelloPacketNeighborInfo(
+    std::string const& ifName, std::string const& neighborName) {
+  auto helloPacketIt = helloPackets_.find(ifName);
+  if (helloPacketIt == helloPackets_.end()) {
     return;
   }
 
-  // update counters for number of pkts and total size of pkts sent
-  fb303::fbData->addStatValue(
-      "spark.hello.bytes_sent", packet.size(), fb303::SUM);
-  fb303::fbData->addStatValue("spark.hello.packets_sent", 1, fb303::SUM);
+  // neighbor added to or removed from interface, rebuild packet
+  auto& neighborInfos =
+      *helloPacketIt->second.helloMsg_ref()->neighborInfos_ref();
+  auto const& ifNeighbors = sparkNeighbors_.at(ifName);
+  auto neighborIt = ifNeighbors.find(neighborName);
+  auto neighborInfoIt = neighborInfos.find(neighborName);
+  if (neighborIt == ifNeighbors.end() or
+      neighborInfoIt == neighborInfos.end()) {
+    invalidateHelloPacket(ifName);
+    return;
+  }
 
-  VLOG(4) << "Sent " << bytesSent << " bytes in hello packet";
+  auto const& neighbor = neighborIt->second;
+  auto& neighborInfo = neighborInfoIt->second;
+  neighborInfo.seqNum_ref() = neighbor.seqNum;
+  neighborInfo.lastNbrMsgSentTsInUs_ref() = neighbor.neighborTimestamp.count();
+  neighborInfo.lastMyMsgRcvdTsInUs_ref() = neighbor.localTimestamp.count();
 }
 
 void
@@ -1811,6 +2404,9 @@ Spark::deleteInterfaceFromDb(const std::set<std::string>& toDel) {
     }
     sparkNeighbors_.erase(ifName);
     ifNameToHeartbeatTimers_.erase(ifName);
+    fastHeartbeatLimiters_.erase(ifName);
+    ifNameToAddTime_.erase(ifName);
+    invalidateHelloPacket(ifName);
 
     // unsubscribe the socket from mcast group on this interface
     // On error, log and continue
@@ -1825,6 +2421,7 @@ Spark::deleteInterfaceFromDb(const std::set<std::string>& toDel) {
     }
     // cleanup for this interface
     ifNameToHelloTimers_.erase(ifName);
+    ifIndexToName_.erase(interfaceDb_.at(ifName).ifIndex);
     interfaceDb_.erase(ifName);
   }
 }
@@ -1833,6 +2430,7 @@ void
 Spark::addInterfaceToDb(
     const std::set<std::string>& toAdd,
     const std::unordered_map<std::string, Interface>& newInterfaceDb) {
+  const auto addTime = std::chrono::steady_clock::now();
   for (const auto& ifName : toAdd) {
     auto newInterface = newInterfaceDb.at(ifName);
     auto ifIndex = newInterface.ifIndex;
@@ -1855,12 +2453,13 @@ Spark::addInterfaceToDb(
     {
       auto result = interfaceDb_.emplace(ifName, newInterface);
       CHECK(result.second);
+      ifIndexToName_[newInterface.ifIndex] = ifName;
     }
 
     {
       // create place-holders for newly added interface
       auto result = sparkNeighbors_.emplace(
-          ifName, std::unordered_map<std::string, SparkNeighbor>{});
+          ifName, folly::F14NodeMap<std::string, SparkNeighbor>{});
       CHECK(result.second);
 
       // heartbeatTimers will start as soon as intf is in UP state
@@ -1876,54 +2475,84 @@ Spark::addInterfaceToDb(
       ifNameToHeartbeatTimers_.at(ifName)->scheduleTimeout(keepAliveTime_);
     }
 
-    auto rollHelper = [](std::chrono::milliseconds timeDuration) {
-      auto base = timeDuration.count();
-      std::uniform_int_distribution<int> distribution(-0.2 * base, 0.2 * base);
-      std::default_random_engine generator;
-      return [timeDuration, distribution, generator]() mutable {
-        return timeDuration +
-            std::chrono::milliseconds(distribution(generator));
-      };
-    };
+    ifNameToAddTime_[ifName] = addTime;
+    pendingActivations_.emplace_back(ifName);
+  }
 
-    auto roll = rollHelper(helloTime_);
-    auto rollFast = rollHelper(fastInitHelloTime_);
-    auto timePoint = std::chrono::steady_clock::now();
-
-    // NOTE: We do not send hello packet immediately after adding new interface
-    // this is due to the fact that it may not have yet configured a link-local
-    // address. The hello packet will be sent later and will have good chances
-    // of making it out if small delay is introduced.
-    auto helloTimer = folly::AsyncTimeout::make(
-        *getEvb(),
-        [this, ifName, timePoint, roll, rollFast]() mutable noexcept {
-          VLOG(3) << "Sending hello multicast packet on interface " << ifName;
-          bool inFastInitState = false;
-          // Under Spark context, hello pkt will be sent in relatively low
-          // frequency. However, when node comes up initially or restarting,
-          // send multiple helloMsg to promote to 'NEGOTIATE' state ASAP.
-          // To form adj, at least 2 helloMsg is needed( i.e. with second
-          // hello contain myNodeName_ info ). To give enough margin, send
-          // 3 times of necessary packets.
-          inFastInitState = (std::chrono::steady_clock::now() - timePoint) <=
-              6 * fastInitHelloTime_;
-
-          sendHelloMsg(ifName, inFastInitState);
-
-          // Schedule next run (add 20% variance)
-          // overriding timeoutPeriod if I am in fast initial state
-          std::chrono::milliseconds timeoutPeriod =
-              inFastInitState ? rollFast() : roll();
-
-          ifNameToHelloTimers_.at(ifName)->scheduleTimeout(timeoutPeriod);
-        });
+  if (not pendingActivations_.empty() and
+      not activationTimer_->isScheduled()) {
+    activationTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+  }
+}
+
+void
+Spark::activateInterfaces() {
+  for (size_t i = 0;
+       i < kMaxInterfaceActivationsPerTick and not pendingActivations_.empty();
+       ++i) {
+    auto ifName = std::move(pendingActivations_.front());
+    pendingActivations_.pop_front();
+    // skip interface removed, or removed and added again, meanwhile
+    if (interfaceDb_.count(ifName) and not ifNameToHelloTimers_.count(ifName)) {
+      activateInterface(ifName);
+    }
+  }
 
-    // should be in fast init state when the node just starts
-    helloTimer->scheduleTimeout(rollFast());
-    ifNameToHelloTimers_[ifName] = std::move(helloTimer);
+  if (not pendingActivations_.empty()) {
+    activationTimer_->scheduleTimeout(kInterfaceActivationInterval);
   }
 }
 
+void
+Spark::activateInterface(std::string const& ifName) {
+  // Seed jitter of every interface differently, otherwise all interfaces
+  // follow same sequence of intervals and send hellos in sync
+  auto rollHelper = [this](std::chrono::milliseconds timeDuration) {
+    auto base = timeDuration.count();
+    std::uniform_int_distribution<int> distribution(-0.2 * base, 0.2 * base);
+    std::default_random_engine generator(randomEngine_());
+    return [timeDuration, distribution, generator]() mutable {
+      return timeDuration + std::chrono::milliseconds(distribution(generator));
+    };
+  };
+
+  auto roll = rollHelper(helloTime_);
+  auto rollFast = rollHelper(fastInitHelloTime_);
+  auto timePoint = std::chrono::steady_clock::now();
+
+  // NOTE: We do not send hello packet immediately after adding new interface
+  // this is due to the fact that it may not have yet configured a link-local
+  // address. The hello packet will be sent later and will have good chances
+  // of making it out if small delay is introduced.
+  auto helloTimer = folly::AsyncTimeout::make(
+      *getEvb(),
+      [this, ifName, timePoint, roll, rollFast]() mutable noexcept {
+        VLOG(3) << "Sending hello multicast packet on interface " << ifName;
+        bool inFastInitState = false;
+        // Under Spark context, hello pkt will be sent in relatively low
+        // frequency. However, when node comes up initially or restarting,
+        // send multiple helloMsg to promote to 'NEGOTIATE' state ASAP.
+        // To form adj, at least 2 helloMsg is needed( i.e. with second
+        // hello contain myNodeName_ info ). To give enough margin, send
+        // 3 times of necessary packets.
+        inFastInitState = (std::chrono::steady_clock::now() - timePoint) <=
+            6 * fastInitHelloTime_;
+
+        sendHelloMsg(ifName, inFastInitState);
+
+        // Schedule next run (add 20% variance)
+        // overriding timeoutPeriod if I am in fast initial state
+        std::chrono::milliseconds timeoutPeriod =
+            inFastInitState ? rollFast() : roll();
+
+        ifNameToHelloTimers_.at(ifName)->scheduleTimeout(timeoutPeriod);
+      });
+
+  // should be in fast init state when the node just starts
+  helloTimer->scheduleTimeout(rollFast());
+  ifNameToHelloTimers_[ifName] = std::move(helloTimer);
+}
+
 void
 Spark::updateInterfaceInDb(
     const std::set<std::string>& toUpdate,
@@ -1963,6 +2592,8 @@ Spark::updateInterfaceInDb(
         throw std::runtime_error(folly::sformat(
             "Failed joining multicast group: {}", folly::errnoStr(errno)));
       }
+      ifIndexToName_.erase(interface.ifIndex);
+      ifIndexToName_[newInterface.ifIndex] = ifName;
     }
     LOG(INFO) << "Updating iface " << ifName << " in spark tracking from "
               << "(ifindex " << interface.ifIndex << ", addrs "
@@ -1978,12 +2609,11 @@ Spark::updateInterfaceInDb(
 
 std::optional<std::string>
 Spark::findInterfaceFromIfindex(int ifIndex) {
-  for (const auto& kv : interfaceDb_) {
-    if (kv.second.ifIndex == ifIndex) {
-      return kv.first;
-    }
+  auto it = ifIndexToName_.find(ifIndex);
+  if (it == ifIndexToName_.end()) {
+    return std::nullopt;
   }
-  return std::nullopt;
+  return it->second;
 }
 
 int32_t
@@ -8,10 +8,19 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
 #include <functional>
+#include <random>
+#include <string_view>
+
+#include <linux/filter.h>
 
 #include <folly/SocketAddress.h>
+#include <folly/Function.h>
+#include <folly/TokenBucket.h>
+#include <folly/container/F14Map.h>
 #include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/HHWheelTimer.h>
 #include <folly/stats/BucketedTimeSeries.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
@@ -108,6 +117,15 @@ class Spark final : public OpenrEventBase {
   // Turn on the throwing of parsing errors.
   void setThrowParserErrors(bool);
 
+  /**
+   * Classic BPF socket filter dropping packets which Spark would drop after
+   * parsing: packets received with hop limit below maximum, packets which are
+   * neither thrift nor fixed-format ones, hellos of other domains and own
+   * hellos looped back by the segment
+   */
+  static std::vector<sock_filter> createPacketFilter(
+      std::string const& domainName, std::string const& nodeName);
+
  private:
   //
   // Interface tracking
@@ -155,9 +173,12 @@ class Spark final : public OpenrEventBase {
   bool shouldProcessHelloPacket(
       std::string const& ifName, folly::IPAddress const& addr);
 
+  // process hello packets pending on socket, up to a budget per call
+  void processPacket();
+
   // process hello packet from a neighbor. we want to see if
   // the neighbor could be added as adjacent peer.
-  void processPacket();
+  void processPacket(IoProvider::IncomingMessage const& message);
 
   // process helloMsg in Spark context
   void processHelloMsg(
@@ -169,6 +190,10 @@ class Spark final : public OpenrEventBase {
   void processHeartbeatMsg(
       thrift::SparkHeartbeatMsg const& heartbeatMsg, std::string const& ifName);
 
+  // process heartbeat of neighbor, of either encoding
+  void processHeartbeat(
+      std::string const& ifName, std::string_view neighborName);
+
   // process handshakeMsg to update sparkNeighbors_ db
   void processHandshakeMsg(
       thrift::SparkHandshakeMsg const& handshakeMsg, std::string const& ifName);
@@ -189,6 +214,33 @@ class Spark final : public OpenrEventBase {
   // util call to send heartbeat msg
   void sendHeartbeatMsg(std::string const& ifName);
 
+  // util call to send fast heartbeat on all interfaces with active neighbors
+  void sendFastHeartbeats();
+
+  // process fast heartbeat from a neighbor, extends its fast hold-timer
+  void processFastHeartbeat(IoProvider::IncomingMessage const& message);
+
+  // drop cached hello packet of interface, i.e. on addition or removal of a
+  // neighbor
+  void invalidateHelloPacket(std::string const& ifName);
+
+  // update reflected info of neighbor in cached hello packet of interface.
+  // Drops the packet if neighbor was added or removed meanwhile
+  void updateHelloPacketNeighborInfo(
+      std::string const& ifName, std::string const& neighborName);
+
+  // queue packet to be sent with other packets of current loop iteration
+  void queuePacket(
+      std::string const& ifName,
+      int ifIndex,
+      folly::IPAddressV6 const& srcAddr,
+      folly::SocketAddress const& dstAddr,
+      std::string&& packet,
+      const char* packetType);
+
+  // send all queued packets in batch with `sendmmsg`
+  void flushPackets();
+
   // Function processes interface updates from LinkMonitor and appropriately
   // enable/disable neighbor discovery
   void processInterfaceUpdates(thrift::InterfaceDatabase&& interfaceUpdates);
@@ -201,6 +253,12 @@ class Spark final : public OpenrEventBase {
       const std::set<std::string>& toAdd,
       const std::unordered_map<std::string, Interface>& newInterfaceDb);
 
+  // activate interfaces pending activation, up to a budget per call
+  void activateInterfaces();
+
+  // start sending hello packets on interface added with addInterfaceToDb
+  void activateInterface(std::string const& ifName);
+
   // util function to update interface in spark
   void updateInterfaceInDb(
       const std::set<std::string>& toUpdate,
@@ -244,11 +302,15 @@ class Spark final : public OpenrEventBase {
       const std::unordered_map<std::string /* areaId */, AreaConfiguration>&
           areaConfigs);
 
-  // function to receive and parse received pkt
+  // function to validate received pkt, e.g. hop limit and rate limit
+  bool validatePacket(
+      IoProvider::IncomingMessage const& message /* received pkt */,
+      std::string& ifName /* interface */);
+
+  // function to parse received thrift pkt
   bool parsePacket(
-      thrift::SparkHelloPacket& pkt /* packet( type will be renamed later) */,
-      std::string& ifName /* interface */,
-      std::chrono::microseconds& recvTime /* kernel timestamp when recved */);
+      IoProvider::IncomingMessage const& message /* received pkt */,
+      thrift::SparkHelloPacket& pkt /* packet( type will be renamed later) */);
 
   // function to validate v4Address with its subnet
   PacketValidationResult validateV4AddressSubnet(
@@ -267,6 +329,42 @@ class Spark final : public OpenrEventBase {
   //
   // Spark related function call
   //
+
+  // Timeout of neighbor scheduled on wheel timer of event base. Neighbor
+  // timers are rescheduled on every packet received, wheel timer makes it
+  // constant time instead of logarithmic in number of timers
+  class NeighborTimeout final : public folly::HHWheelTimer::Callback {
+   public:
+    NeighborTimeout(folly::HHWheelTimer& timer, folly::Function<void()> cb)
+        : timer_(timer), callback_(std::move(cb)) {}
+
+    static std::unique_ptr<NeighborTimeout>
+    make(folly::EventBase& evb, folly::Function<void()> cb) {
+      return std::make_unique<NeighborTimeout>(evb.timer(), std::move(cb));
+    }
+
+    // (re)schedule timeout, pending one is cancelled
+    void
+    scheduleTimeout(std::chrono::milliseconds timeout) {
+      timer_.scheduleTimeout(this, timeout);
+    }
+
+   private:
+    void
+    timeoutExpired() noexcept override {
+      // NOTE: callback may destroy this object
+      callback_();
+    }
+
+    void
+    callbackCanceled() noexcept override {
+      // Don't fire on destruction of wheel timer
+    }
+
+    folly::HHWheelTimer& timer_;
+    folly::Function<void()> callback_;
+  };
+
   struct SparkNeighbor {
     SparkNeighbor(
         const thrift::StepDetectorConfig&,
@@ -326,20 +424,29 @@ class Spark final : public OpenrEventBase {
     // Last sequence number received from neighbor
     uint64_t seqNum{0};
 
+    // OpenR version advertised by neighbor in last helloMsg
+    uint32_t version{0};
+
     // neighbor state(IDLE by default)
     SparkNeighState state{SparkNeighState::IDLE};
 
     // timer to periodically send out handshake pkt
-    std::unique_ptr<folly::AsyncTimeout> negotiateTimer{nullptr};
+    std::unique_ptr<NeighborTimeout> negotiateTimer{nullptr};
 
     // negotiate stage hold-timer
-    std::unique_ptr<folly::AsyncTimeout> negotiateHoldTimer{nullptr};
+    std::unique_ptr<NeighborTimeout> negotiateHoldTimer{nullptr};
 
     // heartbeat hold-timer
-    std::unique_ptr<folly::AsyncTimeout> heartbeatHoldTimer{nullptr};
+    std::unique_ptr<NeighborTimeout> heartbeatHoldTimer{nullptr};
 
     // graceful restart hold-timer
-    std::unique_ptr<folly::AsyncTimeout> gracefulRestartHoldTimer{nullptr};
+    std::unique_ptr<NeighborTimeout> gracefulRestartHoldTimer{nullptr};
+
+    // fast heartbeat hold-timer. Armed on first fast heartbeat received
+    std::unique_ptr<NeighborTimeout> fastHeartbeatHoldTimer{nullptr};
+
+    // timer to report RTT change deferred by rate limit
+    std::unique_ptr<NeighborTimeout> rttChangeTimer{nullptr};
 
     // KvStore related port. Info passed to LinkMonitor for neighborEvent
     int32_t kvStoreCmdPort{0};
@@ -364,6 +471,15 @@ class Spark final : public OpenrEventBase {
     // Lastest measured RTT on receipt of every hello packet
     std::chrono::microseconds rttLatest{0};
 
+    // Moving average of measured RTT, fed to step detector
+    std::chrono::microseconds rttSmoothed{0};
+
+    // RTT change deferred by rate limit, reported on rttChangeTimer
+    std::chrono::microseconds rttPending{0};
+
+    // Time when RTT change was last reported
+    std::optional<std::chrono::steady_clock::time_point> lastRttChangeTime;
+
     // Time when a neighbor state becomes IDLE
     std::chrono::time_point<std::chrono::steady_clock> idleStateTransitionTime =
         std::chrono::steady_clock::now();
@@ -379,9 +495,12 @@ class Spark final : public OpenrEventBase {
     std::string area{};
   };
 
-  std::unordered_map<
+  // Neighbors of every interface. Looked up on every packet received, hence
+  // F14 maps for probing within few cache lines. Node maps as references to
+  // neighbors are held across insertion and erasure of others
+  folly::F14NodeMap<
       std::string /* ifName */,
-      std::unordered_map<std::string /* neighborName */, SparkNeighbor>>
+      folly::F14NodeMap<std::string /* neighborName */, SparkNeighbor>>
       sparkNeighbors_{};
 
   // util function to log Spark neighbor state transition
@@ -417,6 +536,13 @@ class Spark final : public OpenrEventBase {
       std::string const& neighborName,
       int64_t const newRtt);
 
+  // update RTT of neighbor and notify LinkMonitor about it
+  void reportRttChange(
+      std::string const& ifName,
+      std::string const& neighborName,
+      SparkNeighbor& neighbor,
+      std::chrono::microseconds newRtt);
+
   // wrapper function to process GR msg
   void processGRMsg(
       std::string const& neighborName,
@@ -474,6 +600,23 @@ class Spark final : public OpenrEventBase {
   // Spark hold time under graceful-restart mode
   const std::chrono::milliseconds gracefulRestartTime_{0};
 
+  // Fast heartbeat send interval and hold time, if enabled
+  const bool enableFastHeartbeat_{false};
+  const std::chrono::milliseconds fastHeartbeatInterval_{0};
+  const std::chrono::milliseconds fastHeartbeatHoldTime_{0};
+  const uint32_t fastHeartbeatMaxPps_{0};
+
+  // Send heartbeats in fixed-layout encoding if all neighbors support it
+  const bool enableFixedHeartbeat_{false};
+
+  // Attach createPacketFilter() to socket
+  const bool enableKernelPacketFilter_{false};
+
+  // Smoothing and damping of RTT changes
+  const double rttEwmaWeight_{1.0};
+  const std::chrono::microseconds rttChangeMinDelta_{0};
+  const std::chrono::milliseconds rttChangeMinInterval_{0};
+
   // This flag indicates that we will also exchange v4 transportAddress in
   // Spark HelloMessage
   const bool enableV4_{false};
@@ -502,12 +645,33 @@ class Spark final : public OpenrEventBase {
   // Map of interface entries keyed by ifName
   std::unordered_map<std::string, Interface> interfaceDb_{};
 
+  // Reverse index of interfaceDb_ for received packets, which carry ifIndex
+  folly::F14FastMap<int /* ifIndex */, std::string /* ifName */>
+      ifIndexToName_{};
+
   // Hello packet send timers for each interface
   std::unordered_map<
       std::string /* ifName */,
       std::unique_ptr<folly::AsyncTimeout>>
       ifNameToHelloTimers_{};
 
+  // Interfaces added but not yet sending hello packets. Activated in batches
+  // so that bulk of interfaces added at once doesn't send in bursts
+  std::deque<std::string /* ifName */> pendingActivations_{};
+
+  // Timer for activating pending interfaces
+  std::unique_ptr<folly::AsyncTimeout> activationTimer_{nullptr};
+
+  // Time when interface got added along with others in bulk, until first
+  // neighbor over it comes up
+  std::unordered_map<
+      std::string /* ifName */,
+      std::chrono::steady_clock::time_point>
+      ifNameToAddTime_{};
+
+  // seeds jitter of hello timers, distinct for every interface
+  std::default_random_engine randomEngine_{std::random_device{}()};
+
   // heartbeat packet send timers for each interface
   std::unordered_map<
       std::string /* ifName */,
@@ -526,6 +690,40 @@ class Spark final : public OpenrEventBase {
   // ser/deser messages over sockets
   apache::thrift::CompactSerializer serializer_;
 
+  // hello packet of every interface. Built from scratch only when neighbor
+  // info of interface changes, per packet fields are updated on every send
+  std::unordered_map<std::string /* ifName */, thrift::SparkHelloPacket>
+      helloPackets_{};
+
+  // heartbeat packet, only seqNum is updated on every send
+  thrift::SparkHelloPacket heartbeatPacket_;
+
+  // fixed-layout heartbeat packet, seqNum is updated in place on every send
+  std::string fixedHeartbeatPacket_;
+
+  // fast heartbeat packet, same for all interfaces and sends
+  std::string fastHeartbeatPacket_;
+
+  // Timer for sending fast heartbeats on all interfaces at once
+  std::unique_ptr<folly::AsyncTimeout> fastHeartbeatTimer_{nullptr};
+
+  // rate limit of fast heartbeats received on every interface
+  std::unordered_map<std::string /* ifName */, folly::BasicTokenBucket<>>
+      fastHeartbeatLimiters_{};
+
+  // packet queued for transmit, e.g. hello, heartbeat or handshake
+  struct PendingPacket {
+    std::string ifName;
+    const char* packetType{nullptr};
+    IoProvider::OutgoingMessage message;
+  };
+
+  // packets queued within current loop iteration, sent by flushPackets()
+  std::vector<PendingPacket> pendingPackets_{};
+
+  // last number of packets dropped by socket, as reported by kernel
+  uint32_t numSocketDropped_{0};
+
   // The IO primitives provider; this is used for mocking
   // the IO during unit-tests. This could be shared with other
   // instances, hence the shared_ptr
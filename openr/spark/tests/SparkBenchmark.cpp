@@ -0,0 +1,246 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+
+#include <openr/config/Config.h>
+#include <openr/config/tests/Utils.h>
+#include <openr/spark/SparkWrapper.h>
+#include <openr/tests/mocks/MockIoProvider.h>
+
+namespace {
+
+// Latency of every simulated link
+const int32_t kLinkLatencyMs{1};
+
+// Name of the Spark instance under measurement
+const std::string kDutName{"dut"};
+
+// Resident memory of the process
+int64_t
+getResidentBytes() {
+  int64_t totalPages{0};
+  int64_t residentPages{0};
+  std::ifstream statm("/proc/self/statm");
+  statm >> totalPages >> residentPages;
+  return residentPages * ::sysconf(_SC_PAGESIZE);
+}
+
+// CPU time consumed by the calling thread so far
+std::chrono::microseconds
+getThreadCpuTime() {
+  struct timespec ts;
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) +
+      std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::nanoseconds(ts.tv_nsec));
+}
+
+openr::SparkInterfaceEntry
+createInterfaceEntry(std::string const& ifName, int ifIndex) {
+  return openr::SparkInterfaceEntry{
+      ifName,
+      ifIndex,
+      folly::IPAddress::createNetwork(
+          folly::sformat(
+              "10.{}.{}.{}",
+              (ifIndex >> 16) & 0xff,
+              (ifIndex >> 8) & 0xff,
+              ifIndex & 0xff),
+          8,
+          false /* apply mask */),
+      folly::IPAddress::createNetwork(
+          folly::sformat("fe80::{:x}/128", ifIndex))};
+}
+
+} // namespace
+
+namespace openr {
+
+/**
+ * Spark instance under measurement with numIfaces interfaces, each connected
+ * to one interface of numNbrs neighbor instances, all glued together by
+ * MockIoProvider
+ */
+class SparkNetwork {
+ public:
+  SparkNetwork(size_t numIfaces, size_t numNbrs)
+      : numIfaces_(numIfaces), numNbrs_(numNbrs) {
+    mockIoProviderThread_ = std::make_unique<std::thread>(
+        [this]() { mockIoProvider_->start(); });
+    mockIoProvider_->waitUntilRunning();
+
+    IfNameAndifIndex ifIndices;
+    ConnectedIfPairs connectedPairs;
+    for (size_t i = 0; i < numIfaces_; ++i) {
+      dutIfaces_.emplace_back(createInterfaceEntry(
+          folly::sformat("dut_{}", i), static_cast<int>(ifIndices.size() + 1)));
+      const auto& dutIface = dutIfaces_.back();
+      ifIndices.emplace_back(dutIface.ifName, dutIface.ifIndex);
+    }
+    nbrIfaces_.resize(numNbrs_);
+    for (size_t j = 0; j < numNbrs_; ++j) {
+      for (size_t i = 0; i < numIfaces_; ++i) {
+        nbrIfaces_[j].emplace_back(createInterfaceEntry(
+            folly::sformat("nbr{}_{}", j, i),
+            static_cast<int>(ifIndices.size() + 1)));
+        const auto& nbrIfName = nbrIfaces_[j].back().ifName;
+        const auto& dutIfName = dutIfaces_[i].ifName;
+        ifIndices.emplace_back(nbrIfName, nbrIfaces_[j].back().ifIndex);
+        connectedPairs[dutIfName].emplace_back(nbrIfName, kLinkLatencyMs);
+        connectedPairs[nbrIfName].emplace_back(dutIfName, kLinkLatencyMs);
+      }
+    }
+    mockIoProvider_->addIfNameIfIndex(ifIndices);
+    mockIoProvider_->setConnectedPairs(connectedPairs);
+
+    // neighbors start hello-ing right away, ahead of measurement
+    for (size_t j = 0; j < numNbrs_; ++j) {
+      auto nbr = createSpark(folly::sformat("nbr-{}", j));
+      CHECK(nbr->updateInterfaceDb(nbrIfaces_[j]));
+      nbrs_.emplace_back(std::move(nbr));
+    }
+    dut_ = createSpark(kDutName);
+  }
+
+  ~SparkNetwork() {
+    dut_.reset();
+    nbrs_.clear();
+    mockIoProvider_->stop();
+    mockIoProviderThread_->join();
+  }
+
+  // bring up interfaces of instance under measurement and wait until it
+  // established adjacencies with all neighbors over all interfaces
+  void
+  establish() {
+    CHECK(dut_->updateInterfaceDb(dutIfaces_));
+    for (size_t n = 0; n < numIfaces_ * numNbrs_; ++n) {
+      CHECK(dut_->waitForEvent(thrift::SparkNeighborEventType::NEIGHBOR_UP)
+                .has_value());
+    }
+  }
+
+  // CPU time consumed by thread of instance under measurement so far
+  std::chrono::microseconds
+  getDutCpuTime() {
+    std::chrono::microseconds cpuTime{0};
+    dut_->get()->getEvb()->runInEventBaseThreadAndWait(
+        [&cpuTime]() { cpuTime = getThreadCpuTime(); });
+    return cpuTime;
+  }
+
+  std::chrono::milliseconds
+  getHelloTime() const {
+    return std::chrono::seconds(
+        *config_->getSparkConfig().hello_time_s_ref());
+  }
+
+ private:
+  std::unique_ptr<SparkWrapper>
+  createSpark(std::string const& nodeName) {
+    auto tConfig = getBasicOpenrConfig(
+        nodeName, "domain", {}, false /* enableV4 */);
+    config_ = std::make_shared<Config>(tConfig);
+    return std::make_unique<SparkWrapper>(
+        nodeName,
+        std::make_pair(
+            Constants::kOpenrVersion, Constants::kOpenrSupportedVersion),
+        mockIoProvider_,
+        config_);
+  }
+
+  const size_t numIfaces_{0};
+  const size_t numNbrs_{0};
+
+  std::shared_ptr<MockIoProvider> mockIoProvider_{
+      std::make_shared<MockIoProvider>()};
+  std::unique_ptr<std::thread> mockIoProviderThread_{nullptr};
+  std::shared_ptr<const Config> config_{nullptr};
+
+  std::vector<SparkInterfaceEntry> dutIfaces_;
+  std::vector<std::vector<SparkInterfaceEntry>> nbrIfaces_;
+
+  std::unique_ptr<SparkWrapper> dut_;
+  std::vector<std::unique_ptr<SparkWrapper>> nbrs_;
+};
+
+/**
+ * Benchmark for neighbor establishment of single Spark instance:
+ * 1. Start numNbrs neighbors with numIfaces interfaces each
+ * 2. Bring up numIfaces interfaces of instance, each connected to all
+ *    neighbors
+ * 3. Wait until instance establishes adjacency over all of them
+ *
+ * Steady state cost of instance with all adjacencies established is reported
+ * in counters:
+ * - cpu_us_per_hello_interval: CPU time of Spark thread within hello interval
+ * - bytes_per_neighbor: resident memory grown by establishment, divided by
+ *   neighbor states on both sides of adjacencies
+ */
+static void
+BM_SparkNeighborEstablishment(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numIfaces,
+    size_t numNbrs) {
+  auto suspender = folly::BenchmarkSuspender();
+  const size_t numAdjacencies = numIfaces * numNbrs;
+  int64_t memory{0};
+  std::chrono::microseconds cpuTime{0};
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    SparkNetwork network(numIfaces, numNbrs);
+    const auto memoryStart = getResidentBytes();
+
+    suspender.dismiss(); // Start measuring benchmark time
+    network.establish();
+    suspender.rehire();
+
+    memory += getResidentBytes() - memoryStart;
+    const auto cpuStart = network.getDutCpuTime();
+    std::this_thread::sleep_for(network.getHelloTime());
+    cpuTime += network.getDutCpuTime() - cpuStart;
+  }
+
+  counters["cpu_us_per_hello_interval"] =
+      cpuTime.count() / std::max<uint32_t>(1, iters);
+  counters["bytes_per_neighbor"] =
+      memory / std::max<uint32_t>(1, iters) / (2 * numAdjacencies);
+}
+
+// The first parameter is number of interfaces and the second one is number of
+// neighbors over every interface
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_SparkNeighborEstablishment, counters, 1_1, 1, 1);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_SparkNeighborEstablishment, counters, 16_1, 16, 1);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_SparkNeighborEstablishment, counters, 64_1, 64, 1);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_SparkNeighborEstablishment, counters, 1_16, 1, 16);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_SparkNeighborEstablishment, counters, 16_8, 16, 8);
+BENCHMARK_COUNTERS_NAMED_PARAM(
+    BM_SparkNeighborEstablishment, counters, 64_4, 64, 4);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
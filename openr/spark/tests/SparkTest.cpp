@@ -5,9 +5,16 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <array>
 #include <chrono>
 #include <thread>
 
+#include <linux/filter.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <folly/ScopeGuard.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 #include <sodium.h>
@@ -179,6 +186,8 @@ class SimpleSparkFixture : public SparkFixture {
     ASSERT_EQ(1, counters.count("slo.neighbor_restart.time_ms.avg.60"));
     ASSERT_EQ(1, counters.count("slo.neighbor_restart.time_ms.avg.600"));
 
+    ASSERT_EQ(1, counters.count("spark.interfaces_to_neighbors_up.time_ms"));
+
     // Neighbor discovery should be less than 3 secs
     ASSERT_GE(3000, counters["slo.neighbor_discovery.time_ms.avg"]);
     ASSERT_GE(3000, counters["slo.neighbor_discovery.time_ms.avg.3600"]);
@@ -215,6 +224,44 @@ TEST_F(SimpleSparkFixture, GetNeighborsTest) {
   EXPECT_EQ(*neighbor1.remoteIfName_ref(), iface1);
   EXPECT_EQ(*neighbor2.localIfName_ref(), iface1);
   EXPECT_EQ(*neighbor2.remoteIfName_ref(), iface2);
+
+  // packets are sent in batches of at least one packet
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_LT(0, counters["spark.send.batches.sum"]);
+  EXPECT_GE(
+      counters["spark.send.packets.sum"], counters["spark.send.batches.sum"]);
+}
+
+//
+// Start 2 Spark instances and wait them forming adj. Verify hello packets
+// are not built again in steady state, neighbor info reflected in them is
+// updated in place on every hello received.
+//
+TEST_F(SimpleSparkFixture, HelloPacketReuseTest) {
+  // create Spark instances and establish connections
+  createAndConnect();
+
+  const std::chrono::seconds helloTime(
+      *node1->getSparkConfig().hello_time_s_ref());
+  auto counters = fb303::fbData->getCounters();
+  const auto numBuilt = counters["spark.hello.packets_built.sum"];
+  const auto numProcessed = counters["spark.hello_packet_processed.sum"];
+
+  // let nodes exchange several hellos
+  /* sleep override */
+  std::this_thread::sleep_for(helloTime * 3);
+
+  counters = fb303::fbData->getCounters();
+  EXPECT_LT(numProcessed, counters["spark.hello_packet_processed.sum"]);
+  EXPECT_EQ(numBuilt, counters["spark.hello.packets_built.sum"]);
+
+  // reflected neighbor info is still valid
+  auto db1 = *(node1->get()->getNeighbors().get());
+  auto db2 = *(node2->get()->getNeighbors().get());
+  ASSERT_EQ(1, db1.size());
+  ASSERT_EQ(1, db2.size());
+  EXPECT_EQ(*db1.back().state_ref(), Spark::toStr(ESTABLISHED));
+  EXPECT_EQ(*db2.back().state_ref(), Spark::toStr(ESTABLISHED));
 }
 
 //
@@ -296,6 +343,10 @@ TEST_F(SimpleSparkFixture, RttTest) {
               << "ms";
   }
 
+  // RTT changes are reported with no damping configured
+  EXPECT_LE(
+      2, fb303::fbData->getCounters()["spark.rtt_change.propagated.sum"]);
+
   checkCounters();
 }
 
@@ -461,6 +512,105 @@ TEST_F(SimpleSparkFixture, HeartbeatTimerExpireTest) {
   }
 }
 
+//
+// Start 2 Spark instances with fast heartbeat enabled and wait them forming
+// adj. Then stop the bi-direction communication from each other.
+// Observe neighbor going DOWN on expiry of fast heartbeat hold timer, well
+// ahead of heartbeat hold timer.
+//
+TEST_F(SparkFixture, FastHeartbeatTimerExpireTest) {
+  mockIoProvider_->addIfNameIfIndex({{iface1, ifIndex1}, {iface2, ifIndex2}});
+  ConnectedIfPairs connectedPairs = {
+      {iface1, {{iface2, 10}}},
+      {iface2, {{iface1, 10}}},
+  };
+  mockIoProvider_->setConnectedPairs(connectedPairs);
+
+  auto tConfig1 = getBasicOpenrConfig("node-1", kDomainName);
+  tConfig1.spark_config_ref()->enable_fast_heartbeat_ref() = true;
+  auto config1 = std::make_shared<Config>(tConfig1);
+
+  auto tConfig2 = getBasicOpenrConfig("node-2", kDomainName);
+  tConfig2.spark_config_ref()->enable_fast_heartbeat_ref() = true;
+  auto config2 = std::make_shared<Config>(tConfig2);
+
+  auto node1 = createSpark("node-1", config1);
+  auto node2 = createSpark("node-2", config2);
+
+  EXPECT_TRUE(node1->updateInterfaceDb({{iface1, ifIndex1, ip1V4, ip1V6}}));
+  EXPECT_TRUE(node2->updateInterfaceDb({{iface2, ifIndex2, ip2V4, ip2V6}}));
+
+  EXPECT_TRUE(node1->waitForEvent(NB_UP).has_value());
+  EXPECT_TRUE(node2->waitForEvent(NB_UP).has_value());
+
+  // let fast heartbeats arm hold timers of neighbors
+  const std::chrono::milliseconds holdTime{
+      *tConfig1.spark_config_ref()->fast_heartbeat_hold_time_ms_ref()};
+  std::this_thread::sleep_for(holdTime);
+  EXPECT_LT(0, fb303::fbData->getCounters()["spark.fast_heartbeat.recv.sum"]);
+
+  // remove underneath connections between to nodes
+  auto startTime = std::chrono::steady_clock::now();
+  connectedPairs = {};
+  mockIoProvider_->setConnectedPairs(connectedPairs);
+
+  {
+    EXPECT_TRUE(node1->waitForEvent(NB_DOWN).has_value());
+    EXPECT_TRUE(node2->waitForEvent(NB_DOWN).has_value());
+
+    auto endTime = std::chrono::steady_clock::now();
+    EXPECT_LE(holdTime, endTime - startTime);
+    EXPECT_GT(
+        std::chrono::seconds(*node1->getSparkConfig().hold_time_s_ref()),
+        endTime - startTime);
+  }
+  EXPECT_EQ(
+      2,
+      fb303::fbData->getCounters()["spark.fast_heartbeat.neighbor_down.sum"]);
+}
+
+//
+// Start 2 Spark instances with fixed-layout heartbeat enabled and wait them
+// forming adj. Verify heartbeats are sent in fixed-layout encoding and keep
+// adj up beyond heartbeat hold time.
+//
+TEST_F(SparkFixture, FixedLayoutHeartbeatTest) {
+  mockIoProvider_->addIfNameIfIndex({{iface1, ifIndex1}, {iface2, ifIndex2}});
+  ConnectedIfPairs connectedPairs = {
+      {iface1, {{iface2, 10}}},
+      {iface2, {{iface1, 10}}},
+  };
+  mockIoProvider_->setConnectedPairs(connectedPairs);
+
+  auto tConfig1 = getBasicOpenrConfig("node-1", kDomainName);
+  tConfig1.spark_config_ref()->enable_fixed_layout_heartbeat_ref() = true;
+  auto config1 = std::make_shared<Config>(tConfig1);
+
+  auto tConfig2 = getBasicOpenrConfig("node-2", kDomainName);
+  tConfig2.spark_config_ref()->enable_fixed_layout_heartbeat_ref() = true;
+  auto config2 = std::make_shared<Config>(tConfig2);
+
+  auto node1 = createSpark("node-1", config1);
+  auto node2 = createSpark("node-2", config2);
+
+  EXPECT_TRUE(node1->updateInterfaceDb({{iface1, ifIndex1, ip1V4, ip1V6}}));
+  EXPECT_TRUE(node2->updateInterfaceDb({{iface2, ifIndex2, ip2V4, ip2V6}}));
+
+  EXPECT_TRUE(node1->waitForEvent(NB_UP).has_value());
+  EXPECT_TRUE(node2->waitForEvent(NB_UP).has_value());
+
+  // adj must stay up with fixed-layout heartbeats only
+  const std::chrono::seconds holdTime{
+      *tConfig1.spark_config_ref()->hold_time_s_ref()};
+  EXPECT_FALSE(node1->waitForEvent(NB_DOWN, holdTime * 2, holdTime * 2)
+                   .has_value());
+  EXPECT_FALSE(node2->waitForEvent(NB_DOWN, holdTime, holdTime).has_value());
+
+  EXPECT_LT(
+      0,
+      fb303::fbData->getCounters()["spark.fixed_heartbeat.packets_sent.sum"]);
+}
+
 //
 // Start 2 Spark instances and wait them forming adj. Then
 // remove/add interface from one instance's perspective
@@ -1639,6 +1789,90 @@ TEST_F(SparkFixture, MultiplePeersWithDiffAreaOverSameLink) {
   }
 }
 
+/**
+ * Attach packet filter to UDP socket on loopback and verify which of packets
+ * sent to it are received
+ */
+TEST(SparkPacketFilterTest, FilterPackets) {
+  const std::string nodeName{"node-1"};
+  auto filter = Spark::createPacketFilter(kDomainName, nodeName);
+
+  auto rxFd = socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  auto txFd = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+  ASSERT_GE(rxFd, 0);
+  ASSERT_GE(txFd, 0);
+  SCOPE_EXIT {
+    close(rxFd);
+    close(txFd);
+  };
+  sock_fprog prog{static_cast<unsigned short>(filter.size()), filter.data()};
+  ASSERT_EQ(
+      0, setsockopt(rxFd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)));
+  sockaddr_in6 addr{};
+  addr.sin6_family = AF_INET6;
+  addr.sin6_addr = in6addr_loopback;
+  socklen_t addrLen = sizeof(addr);
+  ASSERT_EQ(0, bind(rxFd, reinterpret_cast<sockaddr*>(&addr), addrLen));
+  ASSERT_EQ(
+      0, getsockname(rxFd, reinterpret_cast<sockaddr*>(&addr), &addrLen));
+
+  // send packet with hop limit, return whether it is received
+  auto sendRecv = [&](std::string const& packet, int hopLimit = 255) {
+    EXPECT_EQ(
+        0,
+        setsockopt(
+            txFd,
+            IPPROTO_IPV6,
+            IPV6_UNICAST_HOPS,
+            &hopLimit,
+            sizeof(hopLimit)));
+    EXPECT_EQ(
+        static_cast<ssize_t>(packet.size()),
+        sendto(
+            txFd,
+            packet.data(),
+            packet.size(),
+            0,
+            reinterpret_cast<sockaddr*>(&addr),
+            addrLen));
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::array<char, 2048> buf;
+    return recv(rxFd, buf.data(), buf.size(), 0) ==
+        static_cast<ssize_t>(packet.size());
+  };
+  auto createHello = [](std::string const& domainName,
+                        std::string const& helloNodeName) {
+    thrift::SparkHelloPacket pkt;
+    pkt.helloMsg_ref() = thrift::SparkHelloMsg();
+    pkt.helloMsg_ref()->domainName_ref() = domainName;
+    pkt.helloMsg_ref()->nodeName_ref() = helloNodeName;
+    pkt.helloMsg_ref()->ifName_ref() = iface1;
+    return CompactSerializer::serialize<std::string>(pkt);
+  };
+
+  EXPECT_TRUE(sendRecv(createHello(kDomainName, "node-2")));
+  EXPECT_FALSE(sendRecv(createHello(kDomainName, "node-2"), 64));
+  EXPECT_FALSE(sendRecv(createHello("other_domain", "node-2")));
+  EXPECT_FALSE(sendRecv(createHello(kDomainName, nodeName)));
+  // node name sharing prefix with own one
+  EXPECT_TRUE(sendRecv(createHello(kDomainName, "node-10")));
+
+  thrift::SparkHelloPacket heartbeat;
+  heartbeat.heartbeatMsg_ref() = thrift::SparkHeartbeatMsg();
+  heartbeat.heartbeatMsg_ref()->nodeName_ref() = "node-2";
+  EXPECT_TRUE(sendRecv(CompactSerializer::serialize<std::string>(heartbeat)));
+
+  thrift::SparkHelloPacket handshake;
+  handshake.handshakeMsg_ref() = thrift::SparkHandshakeMsg();
+  handshake.handshakeMsg_ref()->nodeName_ref() = "node-2";
+  EXPECT_TRUE(sendRecv(CompactSerializer::serialize<std::string>(handshake)));
+
+  // fast heartbeat: magic, version, nodeName length, nodeName
+  EXPECT_TRUE(sendRecv(std::string("OFHB\x01\x00\x06node-2", 13)));
+  EXPECT_FALSE(sendRecv("not a spark packet"));
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -0,0 +1,301 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/tests/OpenrEmulation.h>
+
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <glog/logging.h>
+
+namespace openr {
+
+namespace {
+
+// Interval of polling FIBs of nodes while waiting for convergence
+const std::chrono::milliseconds kConvergencePollInterval(100);
+
+} // namespace
+
+OpenrEmulation::OpenrEmulation(
+    OpenrEmulationTimers timers, int32_t linkLatencyMs)
+    : timers_(std::move(timers)), linkLatencyMs_(linkLatencyMs) {
+  mockIoProvider_ = std::make_shared<MockIoProvider>();
+  mockIoProviderThread_ = std::make_unique<std::thread>([this]() {
+    LOG(INFO) << "Starting mockIoProvider thread.";
+    mockIoProvider_->start();
+    LOG(INFO) << "mockIoProvider thread got stopped.";
+  });
+  mockIoProvider_->waitUntilRunning();
+}
+
+OpenrEmulation::~OpenrEmulation() {
+  // Stop nodes before the IoProvider they send hellos over
+  nodes_.clear();
+
+  LOG(INFO) << "Stopping mockIoProvider thread.";
+  mockIoProvider_->stop();
+  mockIoProviderThread_->join();
+}
+
+std::string
+OpenrEmulation::getIfName(const std::string& nodeA, const std::string& nodeB) {
+  return folly::sformat("{}/{}", nodeA, nodeB);
+}
+
+void
+OpenrEmulation::addNode(const std::string& nodeId) {
+  CHECK(not started_) << "Nodes can't be added to running emulation";
+  CHECK(not nodes_.count(nodeId)) << "Duplicate node " << nodeId;
+
+  Node node;
+  node.index = nodes_.size();
+  node.openr =
+      std::make_unique<OpenrWrapper<apache::thrift::CompactSerializer>>(
+          context_,
+          nodeId,
+          false /* v4Enabled */,
+          timers_.kvStoreDbSyncInterval,
+          timers_.spark2HelloTime,
+          timers_.spark2FastInitHelloTime,
+          timers_.spark2HandshakeTime,
+          timers_.spark2HeartbeatTime,
+          timers_.spark2HandshakeHoldTime,
+          timers_.spark2HeartbeatHoldTime,
+          timers_.spark2GRHoldTime,
+          timers_.linkMonitorAdjHoldTime,
+          timers_.linkFlapInitialBackoff,
+          timers_.linkFlapMaxBackoff,
+          timers_.fibColdStartDuration,
+          mockIoProvider_);
+  nodes_.emplace(nodeId, std::move(node));
+}
+
+void
+OpenrEmulation::addLink(const std::string& nodeA, const std::string& nodeB) {
+  CHECK(not started_) << "Links can't be added to running emulation";
+  CHECK_NE(nodeA, nodeB);
+  auto& a = nodes_.at(nodeA);
+  auto& b = nodes_.at(nodeB);
+  a.interfaces.emplace_back(
+      Interface{getIfName(nodeA, nodeB), nextIfIndex_++, nodeB});
+  b.interfaces.emplace_back(
+      Interface{getIfName(nodeB, nodeA), nextIfIndex_++, nodeA});
+  links_.emplace_back(nodeA, nodeB);
+}
+
+void
+OpenrEmulation::buildFabric(size_t numSpines, size_t numLeaves) {
+  for (size_t i = 0; i < numSpines; ++i) {
+    addNode(folly::sformat("spine-{}", i));
+  }
+  for (size_t i = 0; i < numLeaves; ++i) {
+    const auto leaf = folly::sformat("leaf-{}", i);
+    addNode(leaf);
+    for (size_t j = 0; j < numSpines; ++j) {
+      addLink(leaf, folly::sformat("spine-{}", j));
+    }
+  }
+}
+
+void
+OpenrEmulation::updateConnectedPairs() {
+  ConnectedIfPairs connectedPairs;
+  for (const auto& [nodeId, node] : nodes_) {
+    for (const auto& iface : node.interfaces) {
+      if (downIfNames_.count(iface.ifName)) {
+        continue;
+      }
+      connectedPairs[iface.ifName].emplace_back(
+          getIfName(iface.peerNodeId, nodeId), linkLatencyMs_);
+    }
+  }
+  mockIoProvider_->setConnectedPairs(std::move(connectedPairs));
+}
+
+void
+OpenrEmulation::start() {
+  CHECK(not started_);
+  started_ = true;
+
+  IfNameAndifIndex ifNameAndIfIndex;
+  for (const auto& [_, node] : nodes_) {
+    for (const auto& iface : node.interfaces) {
+      ifNameAndIfIndex.emplace_back(iface.ifName, iface.ifIndex);
+    }
+  }
+  mockIoProvider_->addIfNameIfIndex(ifNameAndIfIndex);
+  updateConnectedPairs();
+
+  for (auto& [_, node] : nodes_) {
+    node.openr->run();
+  }
+
+  // Every node uses the same addresses on all of its interfaces
+  for (auto& [nodeId, node] : nodes_) {
+    const auto id = node.index + 1;
+    const folly::CIDRNetwork v4Network(
+        folly::IPAddress(folly::sformat("10.{}.{}.1", id >> 8, id & 0xff)),
+        32);
+    const folly::CIDRNetwork v6Network(
+        folly::IPAddress(folly::sformat("fe80::{:x}", id)), 128);
+    std::vector<SparkInterfaceEntry> entries;
+    for (const auto& iface : node.interfaces) {
+      entries.emplace_back(SparkInterfaceEntry{
+          iface.ifName, iface.ifIndex, v4Network, v6Network});
+    }
+    if (not node.openr->sparkUpdateInterfaceDb(entries)) {
+      LOG(ERROR) << "Failed to update interfaces of " << nodeId;
+    }
+  }
+  LOG(INFO) << "Started emulation of " << nodes_.size() << " nodes and "
+            << links_.size() << " links";
+}
+
+void
+OpenrEmulation::failLink(const std::string& nodeA, const std::string& nodeB) {
+  LOG(INFO) << "Bringing down link " << nodeA << " - " << nodeB;
+  downIfNames_.emplace(getIfName(nodeA, nodeB));
+  downIfNames_.emplace(getIfName(nodeB, nodeA));
+  updateConnectedPairs();
+}
+
+void
+OpenrEmulation::restoreLink(
+    const std::string& nodeA, const std::string& nodeB) {
+  LOG(INFO) << "Bringing up link " << nodeA << " - " << nodeB;
+  downIfNames_.erase(getIfName(nodeA, nodeB));
+  downIfNames_.erase(getIfName(nodeB, nodeA));
+  updateConnectedPairs();
+}
+
+void
+OpenrEmulation::failNode(const std::string& nodeId) {
+  LOG(INFO) << "Bringing down all links of " << nodeId;
+  for (const auto& iface : nodes_.at(nodeId).interfaces) {
+    downIfNames_.emplace(iface.ifName);
+    downIfNames_.emplace(getIfName(iface.peerNodeId, nodeId));
+  }
+  updateConnectedPairs();
+}
+
+void
+OpenrEmulation::restoreNode(const std::string& nodeId) {
+  LOG(INFO) << "Bringing up all links of " << nodeId;
+  for (const auto& iface : nodes_.at(nodeId).interfaces) {
+    downIfNames_.erase(iface.ifName);
+    downIfNames_.erase(getIfName(iface.peerNodeId, nodeId));
+  }
+  updateConnectedPairs();
+}
+
+std::vector<std::set<std::string>>
+OpenrEmulation::getPartitions() const {
+  std::vector<std::set<std::string>> partitions;
+  std::set<std::string> visited;
+  for (const auto& [nodeId, _] : nodes_) {
+    if (not visited.emplace(nodeId).second) {
+      continue;
+    }
+    std::set<std::string> partition{nodeId};
+    std::vector<std::string> stack{nodeId};
+    while (not stack.empty()) {
+      const auto current = std::move(stack.back());
+      stack.pop_back();
+      for (const auto& iface : nodes_.at(current).interfaces) {
+        if (downIfNames_.count(iface.ifName)) {
+          continue;
+        }
+        if (visited.emplace(iface.peerNodeId).second) {
+          partition.emplace(iface.peerNodeId);
+          stack.emplace_back(iface.peerNodeId);
+        }
+      }
+    }
+    partitions.emplace_back(std::move(partition));
+  }
+  return partitions;
+}
+
+bool
+OpenrEmulation::isConverged() {
+  // Prefixes are allocated once, cache them
+  for (auto& [_, node] : nodes_) {
+    if (not node.prefix.has_value()) {
+      node.prefix = node.openr->getIpPrefix();
+      if (not node.prefix.has_value()) {
+        return false;
+      }
+    }
+  }
+
+  for (const auto& partition : getPartitions()) {
+    for (const auto& nodeId : partition) {
+      const auto routeDb = nodes_.at(nodeId).openr->fibDumpRouteDatabase();
+      for (const auto& route : *routeDb.unicastRoutes_ref()) {
+        for (const auto& nextHop : *route.nextHops_ref()) {
+          const auto& ifName = nextHop.address_ref()->ifName_ref();
+          if (ifName.has_value() and downIfNames_.count(*ifName)) {
+            VLOG(2) << nodeId << " still routes over " << *ifName;
+            return false;
+          }
+        }
+      }
+      for (const auto& peerId : partition) {
+        if (peerId != nodeId and
+            not OpenrWrapper<apache::thrift::CompactSerializer>::
+                checkPrefixExists(*nodes_.at(peerId).prefix, routeDb)) {
+          VLOG(2) << nodeId << " has no route towards " << peerId;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+std::optional<std::chrono::milliseconds>
+OpenrEmulation::waitForConvergence(std::chrono::milliseconds timeout) {
+  const auto startTime = std::chrono::steady_clock::now();
+  const auto deadline = startTime + timeout;
+  while (not isConverged()) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      LOG(ERROR) << "Emulation didn't converge within " << timeout.count()
+                 << "ms";
+      return std::nullopt;
+    }
+    /* sleep override */
+    std::this_thread::sleep_for(kConvergencePollInterval);
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+}
+
+std::vector<OpenrEmulationNodeStats>
+OpenrEmulation::getNodeStats() {
+  // NOTE: thread names are truncated to 15 characters like by the kernel
+  const auto cpuPcts = systemMetrics_.getThreadCPUpercentage("");
+  std::vector<OpenrEmulationNodeStats> stats;
+  for (const auto& [nodeId, node] : nodes_) {
+    OpenrEmulationNodeStats nodeStats;
+    nodeStats.nodeId = nodeId;
+    auto it = cpuPcts.find(nodeId.substr(0, 15));
+    if (it != cpuPcts.end()) {
+      nodeStats.cpuPct = it->second;
+    }
+    nodeStats.numRoutes =
+        node.openr->fibDumpRouteDatabase().unicastRoutes_ref()->size();
+    stats.emplace_back(std::move(nodeStats));
+  }
+  return stats;
+}
+
+std::optional<size_t>
+OpenrEmulation::getRSSMemBytes() {
+  return systemMetrics_.getRSSMemBytes();
+}
+
+} // namespace openr
@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/monitor/SystemMetrics.h>
+#include <openr/tests/OpenrWrapper.h>
+#include <openr/tests/mocks/MockIoProvider.h>
+
+namespace openr {
+
+/**
+ * Timers of emulated nodes. Defaults are the ones of OpenrSystemTest, which
+ * keep convergence of in-process nodes within seconds.
+ */
+struct OpenrEmulationTimers {
+  std::chrono::seconds kvStoreDbSyncInterval{1};
+  std::chrono::milliseconds spark2HelloTime{100};
+  std::chrono::milliseconds spark2FastInitHelloTime{20};
+  std::chrono::milliseconds spark2HandshakeTime{20};
+  std::chrono::milliseconds spark2HeartbeatTime{20};
+  std::chrono::milliseconds spark2HandshakeHoldTime{200};
+  std::chrono::milliseconds spark2HeartbeatHoldTime{500};
+  std::chrono::milliseconds spark2GRHoldTime{1000};
+  std::chrono::seconds linkMonitorAdjHoldTime{1};
+  std::chrono::milliseconds linkFlapInitialBackoff{1};
+  std::chrono::milliseconds linkFlapMaxBackoff{8};
+  std::chrono::seconds fibColdStartDuration{1};
+};
+
+/**
+ * Resource usage of an emulated node since the previous report
+ */
+struct OpenrEmulationNodeStats {
+  std::string nodeId;
+  // CPU% of threads of node, see OpenrWrapper::run()
+  double cpuPct{0};
+  // Number of routes in FIB of node
+  size_t numRoutes{0};
+};
+
+/**
+ * Emulation of a network of OpenrWrapper nodes in a single process. Nodes
+ * exchange Spark hellos over a shared MockIoProvider and program routes into
+ * mocked netlink.
+ *
+ * Typical usage is
+ * 1. Add nodes and links, e.g. with buildFabric()
+ * 2. start() and waitForConvergence()
+ * 3. Inject failures with failLink()/failNode() and measure time until
+ *    waitForConvergence() returns again
+ *
+ * Network is converged when every node has a route in FIB towards the prefix
+ * allocated to every other node it is connected to over links which are up,
+ * and no route uses a link which is down.
+ *
+ * All nodes share the process, hence memory is reported for the whole
+ * emulation. CPU is accounted per node by name of its threads.
+ *
+ * Not thread-safe, use from the same thread only
+ */
+class OpenrEmulation final {
+ public:
+  explicit OpenrEmulation(
+      OpenrEmulationTimers timers = OpenrEmulationTimers(),
+      int32_t linkLatencyMs = 1);
+
+  ~OpenrEmulation();
+
+  // Add node, node names longer than 15 characters are truncated in thread
+  // names and hence in CPU accounting
+  void addNode(const std::string& nodeId);
+
+  // Add link between two existing nodes
+  void addLink(const std::string& nodeA, const std::string& nodeB);
+
+  /**
+   * Add a two tier fabric of numSpines spines (`spine-<i>`) and numLeaves
+   * leaves (`leaf-<i>`), every leaf connected to every spine
+   */
+  void buildFabric(size_t numSpines, size_t numLeaves);
+
+  // Start all nodes and bring all links up
+  void start();
+
+  // Bring link between two nodes down or back up
+  void failLink(const std::string& nodeA, const std::string& nodeB);
+  void restoreLink(const std::string& nodeA, const std::string& nodeB);
+
+  // Bring all links of node down or back up
+  void failNode(const std::string& nodeId);
+  void restoreNode(const std::string& nodeId);
+
+  /**
+   * Wait until network is converged. Returns time it took, or std::nullopt
+   * on timeout
+   */
+  std::optional<std::chrono::milliseconds> waitForConvergence(
+      std::chrono::milliseconds timeout);
+
+  // Resource usage of nodes since the previous call
+  std::vector<OpenrEmulationNodeStats> getNodeStats();
+
+  // RSS memory of the whole emulation
+  std::optional<size_t> getRSSMemBytes();
+
+  size_t
+  getNumNodes() const {
+    return nodes_.size();
+  }
+
+  const std::vector<std::pair<std::string, std::string>>&
+  getLinks() const {
+    return links_;
+  }
+
+ private:
+  struct Interface {
+    std::string ifName;
+    int ifIndex;
+    // Node at the other end of the link
+    std::string peerNodeId;
+  };
+
+  struct Node {
+    std::unique_ptr<OpenrWrapper<apache::thrift::CompactSerializer>> openr;
+    size_t index;
+    std::vector<Interface> interfaces;
+    std::optional<thrift::IpPrefix> prefix;
+  };
+
+  // Interface name of nodeA towards nodeB
+  static std::string getIfName(
+      const std::string& nodeA, const std::string& nodeB);
+
+  // Apply links which are up to MockIoProvider
+  void updateConnectedPairs();
+
+  // Sets of nodes connected over links which are up
+  std::vector<std::set<std::string>> getPartitions() const;
+
+  bool isConverged();
+
+  const OpenrEmulationTimers timers_;
+  const int32_t linkLatencyMs_{1};
+
+  fbzmq::Context context_;
+  std::shared_ptr<MockIoProvider> mockIoProvider_;
+  std::unique_ptr<std::thread> mockIoProviderThread_;
+
+  std::map<std::string /* nodeId */, Node> nodes_;
+  std::vector<std::pair<std::string, std::string>> links_;
+  // Names of interfaces whose link is down
+  std::set<std::string> downIfNames_;
+  int nextIfIndex_{1};
+  bool started_{false};
+
+  SystemMetrics systemMetrics_;
+};
+
+} // namespace openr
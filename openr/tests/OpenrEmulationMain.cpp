@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Format.h>
+#include <folly/Random.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <openr/tests/OpenrEmulation.h>
+
+DEFINE_uint32(num_spines, 4, "Number of spines in emulated fabric");
+DEFINE_uint32(num_leaves, 32, "Number of leaves in emulated fabric");
+DEFINE_uint32(num_link_failures, 4, "Number of random link failures");
+DEFINE_uint32(num_node_failures, 1, "Number of random spine failures");
+DEFINE_uint32(
+    convergence_timeout_s, 300, "Time to wait for network to converge");
+DEFINE_uint32(
+    max_convergence_ms,
+    0,
+    "Exit with failure if any reconvergence after failure takes longer, e.g. "
+    "to gate performance changes. 0 disables the check");
+
+namespace {
+
+void
+logNodeStats(openr::OpenrEmulation& emulation) {
+  auto stats = emulation.getNodeStats();
+  double totalCpuPct{0};
+  double maxCpuPct{0};
+  for (const auto& nodeStats : stats) {
+    VLOG(1) << nodeStats.nodeId << ": " << nodeStats.cpuPct << "% CPU, "
+            << nodeStats.numRoutes << " routes";
+    totalCpuPct += nodeStats.cpuPct;
+    maxCpuPct = std::max(maxCpuPct, nodeStats.cpuPct);
+  }
+  const auto rssMem = emulation.getRSSMemBytes();
+  LOG(INFO) << "CPU per node: avg " << totalCpuPct / stats.size() << "%, max "
+            << maxCpuPct << "%";
+  if (rssMem.has_value()) {
+    LOG(INFO) << "Memory: " << *rssMem / 1024 / 1024 << "MB total, "
+              << *rssMem / 1024 / stats.size() << "KB per node";
+  }
+}
+
+} // namespace
+
+/**
+ * Emulate two tier fabric with OpenrEmulation. Reports time network takes
+ * to converge after start and after every failure and restoration of random
+ * links and spines, along with CPU and memory used by nodes.
+ */
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+
+  const auto timeout = std::chrono::milliseconds(
+      std::chrono::seconds(FLAGS_convergence_timeout_s));
+  bool passed{true};
+  const auto check = [&](const std::string& event,
+                         std::optional<std::chrono::milliseconds> duration,
+                         bool gated) {
+    if (not duration.has_value()) {
+      LOG(ERROR) << event << ": didn't converge";
+      passed = false;
+      return;
+    }
+    LOG(INFO) << event << ": converged in " << duration->count() << "ms";
+    if (gated and FLAGS_max_convergence_ms and
+        duration->count() > FLAGS_max_convergence_ms) {
+      LOG(ERROR) << event << ": convergence exceeded "
+                 << FLAGS_max_convergence_ms << "ms";
+      passed = false;
+    }
+  };
+
+  openr::OpenrEmulation emulation;
+  emulation.buildFabric(FLAGS_num_spines, FLAGS_num_leaves);
+  emulation.start();
+  // Initial convergence includes KvStore full syncs and prefix allocation
+  // and isn't gated
+  check("Start", emulation.waitForConvergence(timeout), false);
+  logNodeStats(emulation);
+
+  const auto& links = emulation.getLinks();
+  for (uint32_t i = 0; i < FLAGS_num_link_failures and not links.empty();
+       ++i) {
+    const auto& [nodeA, nodeB] = links.at(folly::Random::rand32(links.size()));
+    const auto event = folly::sformat("Link {} - {}", nodeA, nodeB);
+    emulation.failLink(nodeA, nodeB);
+    check(event + " down", emulation.waitForConvergence(timeout), true);
+    emulation.restoreLink(nodeA, nodeB);
+    check(event + " up", emulation.waitForConvergence(timeout), true);
+  }
+
+  for (uint32_t i = 0; i < FLAGS_num_node_failures and FLAGS_num_spines;
+       ++i) {
+    const auto spine = folly::sformat(
+        "spine-{}", folly::Random::rand32(FLAGS_num_spines));
+    emulation.failNode(spine);
+    check(spine + " down", emulation.waitForConvergence(timeout), true);
+    emulation.restoreNode(spine);
+    check(spine + " up", emulation.waitForConvergence(timeout), true);
+  }
+  logNodeStats(emulation);
+
+  return passed ? 0 : 1;
+}
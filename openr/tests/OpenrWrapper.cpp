@@ -6,6 +6,9 @@
  */
 
 #include <openr/tests/OpenrWrapper.h>
+
+#include <folly/system/ThreadName.h>
+
 #include <openr/config/tests/Utils.h>
 
 namespace openr {
@@ -176,7 +179,7 @@ OpenrWrapper<Serializer>::OpenrWrapper(
       peerUpdatesQueue_,
       logSampleQueue_,
       neighborUpdatesQueue_.getReader(),
-      nlSock_->getReader(),
+      nlSock_->getBatchReader(),
       false, /* assumeDrained */
       false, /* overrideDrainState */
       linkMonitorAdjHoldTime);
@@ -212,7 +215,8 @@ OpenrWrapper<Serializer>::OpenrWrapper(
       std::chrono::milliseconds(250),
       kvStoreUpdatesQueue_.getReader(),
       staticRoutesQueue_.getReader(),
-      routeUpdatesQueue_);
+      routeUpdatesQueue_,
+      kvStoreSyncEventsQueue_.getReader());
 
   //
   // create FIB
@@ -336,6 +340,12 @@ OpenrWrapper<Serializer>::run() {
     eventBase_.run();
     VLOG(1) << nodeId_ << " Stopping eventBase_";
   });
+
+  // Name threads after node, so CPU used by each node can be told apart when
+  // many nodes run in the same process
+  for (auto& t : allThreads_) {
+    folly::setThreadName(t.get_id(), nodeId_);
+  }
 }
 
 template <class Serializer>
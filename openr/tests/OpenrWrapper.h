@@ -160,13 +160,13 @@ class OpenrWrapper {
   // sub module communication zmq urls and ports
   int kvStoreGlobalCmdPort_{0};
   const std::string kvStoreGlobalCmdUrl_;
-  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue_;
+  messaging::ReplicateQueue<DecisionRouteUpdatePtr> routeUpdatesQueue_;
   messaging::ReplicateQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue_;
   messaging::ReplicateQueue<thrift::PeerUpdateRequest> peerUpdatesQueue_;
   messaging::ReplicateQueue<thrift::SparkNeighborEvent> neighborUpdatesQueue_;
   messaging::ReplicateQueue<KvStoreSyncEvent> kvStoreSyncEventsQueue_;
   messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue_;
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue_;
+  messaging::ReplicateQueue<KvStorePublicationPtr> kvStoreUpdatesQueue_;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesQueue_;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> fibUpdatesQueue_;
   messaging::ReplicateQueue<openr::LogSample> logSampleQueue_;
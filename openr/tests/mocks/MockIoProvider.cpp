@@ -258,6 +258,53 @@ MockIoProvider::sendmsg(int sockFd, const struct msghdr* msg, int /* flags */) {
   return -1;
 }
 
+int
+MockIoProvider::recvmmsg(
+    int sockFd,
+    struct mmsghdr* msgvec,
+    unsigned int vlen,
+    int flags,
+    struct timespec* /* timeout */) {
+  unsigned int numMsgs = 0;
+  for (; numMsgs < vlen; ++numMsgs) {
+    {
+      // Messages are received only after their latency elapsed
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = mailboxes_.find(sockFd);
+      if (it == mailboxes_.end() or it->second.empty() or
+          not it->second.front().isActive()) {
+        break;
+      }
+    }
+    const auto bytesRead = recvmsg(sockFd, &msgvec[numMsgs].msg_hdr, flags);
+    if (bytesRead < 0) {
+      break;
+    }
+    msgvec[numMsgs].msg_len = bytesRead;
+  }
+  // as the syscall, fail only if no message is received
+  if (numMsgs == 0) {
+    errno = EAGAIN;
+    return -1;
+  }
+  return numMsgs;
+}
+
+int
+MockIoProvider::sendmmsg(
+    int sockFd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  unsigned int numMsgs = 0;
+  for (; numMsgs < vlen; ++numMsgs) {
+    const auto bytesSent = sendmsg(sockFd, &msgvec[numMsgs].msg_hdr, flags);
+    if (bytesSent < 0) {
+      break;
+    }
+    msgvec[numMsgs].msg_len = bytesSent;
+  }
+  // as the syscall, fail only if no message is sent
+  return numMsgs ? numMsgs : -1;
+}
+
 //
 // Simply accept all setsockopts, and build fd to ifName mapping
 //
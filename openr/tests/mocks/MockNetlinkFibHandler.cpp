@@ -124,6 +124,43 @@ MockNetlinkFibHandler::syncFib(
   syncFibBaton_.post();
 }
 
+void
+MockNetlinkFibHandler::syncFibChunk(
+    int16_t clientId,
+    int64_t syncId,
+    std::unique_ptr<std::vector<openr::thrift::UnicastRoute>> routes,
+    bool isFinal) {
+  if (isFinal and failFinalSyncFibChunk_.exchange(false)) {
+    ++fibSyncChunkCount_;
+    thrift::PlatformError error;
+    *error.message_ref() = "Mock failure of final syncFibChunk";
+    throw error;
+  }
+  auto allRoutes = std::make_unique<std::vector<openr::thrift::UnicastRoute>>();
+  SYNCHRONIZED(pendingSyncRoutes_) {
+    if (pendingSyncRoutes_.first != syncId) {
+      pendingSyncRoutes_.first = syncId;
+      pendingSyncRoutes_.second.clear();
+    }
+    for (auto& route : *routes) {
+      pendingSyncRoutes_.second.emplace_back(std::move(route));
+    }
+    if (isFinal) {
+      allRoutes->swap(pendingSyncRoutes_.second);
+      pendingSyncRoutes_.first = 0;
+    }
+  }
+  ++fibSyncChunkCount_;
+  if (isFinal) {
+    syncFib(clientId, std::move(allRoutes));
+  }
+}
+
+int64_t
+MockNetlinkFibHandler::getPendingSyncFibId(int16_t) {
+  return pendingSyncRoutes_->first;
+}
+
 void
 MockNetlinkFibHandler::addMplsRoutes(
     int16_t, std::unique_ptr<std::vector<openr::thrift::MplsRoute>> routes) {
@@ -266,6 +303,8 @@ MockNetlinkFibHandler::restart() {
   LOG(INFO) << "Restarting fib agent";
   unicastRouteDb_->clear();
   mplsRouteDb_->clear();
+  pendingSyncRoutes_->first = 0;
+  pendingSyncRoutes_->second.clear();
 
   SYNCHRONIZED(startTime_) {
     startTime_ = std::chrono::duration_cast<std::chrono::seconds>(
@@ -13,10 +13,11 @@
 namespace openr {
 
 // nextHop => local interface and nextHop IP.
-using NextHops = std::unordered_set<std::pair<std::string, folly::IPAddress>>;
+using MockNextHops =
+    std::unordered_set<std::pair<std::string, folly::IPAddress>>;
 
 // Route => prefix and its possible nextHops
-using UnicastRoutes = std::unordered_map<folly::CIDRNetwork, NextHops>;
+using MockUnicastRoutes = std::unordered_map<folly::CIDRNetwork, MockNextHops>;
 
 /**
  * This class implements Netlink Platform thrift interface for programming
@@ -54,6 +55,14 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
       std::unique_ptr<std::vector<openr::thrift::UnicastRoute>> routes)
       override;
 
+  void syncFibChunk(
+      int16_t clientId,
+      int64_t syncId,
+      std::unique_ptr<std::vector<openr::thrift::UnicastRoute>> routes,
+      bool isFinal) override;
+
+  int64_t getPendingSyncFibId(int16_t clientId) override;
+
   void addMplsRoutes(
       int16_t clientId,
       std::unique_ptr<std::vector<openr::thrift::MplsRoute>> routes) override;
@@ -87,6 +96,17 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
   getFibSyncCount() {
     return fibSyncCount_;
   }
+  size_t
+  getFibSyncChunkCount() {
+    return fibSyncChunkCount_;
+  }
+
+  // Fail next final chunk of a chunked sync, retaining its previous chunks
+  void
+  failFinalSyncFibChunk() {
+    failFinalSyncFibChunk_ = true;
+  }
+
   size_t
   getAddRoutesCount() {
     return addRoutesCount_;
@@ -118,7 +138,12 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
   folly::Synchronized<int64_t> startTime_{0};
 
   // Abstract route Db to hide kernel level routing details from Fib
-  folly::Synchronized<UnicastRoutes> unicastRouteDb_{};
+  folly::Synchronized<MockUnicastRoutes> unicastRouteDb_{};
+
+  // Routes received so far of the incomplete chunked sync by syncId
+  folly::Synchronized<
+      std::pair<int64_t, std::vector<openr::thrift::UnicastRoute>>>
+      pendingSyncRoutes_;
 
   // Mpls Route db
   folly::Synchronized<
@@ -127,6 +152,8 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
 
   // Stats
   std::atomic<size_t> fibSyncCount_{0};
+  std::atomic<size_t> fibSyncChunkCount_{0};
+  std::atomic<bool> failFinalSyncFibChunk_{false};
   std::atomic<size_t> addRoutesCount_{0};
   std::atomic<size_t> delRoutesCount_{0};
   std::atomic<size_t> fibMplsSyncCount_{0};
@@ -58,12 +58,19 @@ MockNetlinkProtocolSocket::MockNetlinkProtocolSocket(folly::EventBase* evb)
 folly::SemiFuture<int>
 MockNetlinkProtocolSocket::addRoute(const fbnl::Route& route) {
   fb303::fbData->addStatValue("nlmock.add_route", 1, fb303::SUM);
+  // Referred nexthop object must exist as in the kernel
+  const auto nhId = route.getNextHopId();
+  if (nhId.has_value() and not nextHopObjects_.count(nhId.value()) and
+      not nextHopGroupObjects_.count(nhId.value())) {
+    return folly::SemiFuture<int>(EINVAL);
+  }
   // Blindly replace existing route
   const auto proto = route.getProtocolId();
   if (route.getFamily() == AF_MPLS) {
     mplsRoutes_[proto][route.getMplsLabel().value()] = route;
   } else {
-    unicastRoutes_[proto][route.getDestination()] = route;
+    unicastRoutes_[proto][std::make_pair(
+        route.getDestination(), route.getPriority().value_or(0))] = route;
   }
   return folly::SemiFuture<int>(0);
 }
@@ -77,12 +84,77 @@ MockNetlinkProtocolSocket::deleteRoute(const fbnl::Route& route) {
   if (route.getFamily() == AF_MPLS) {
     cnt = mplsRoutes_[proto].erase(route.getMplsLabel().value());
   } else {
-    cnt = unicastRoutes_[proto].erase(route.getDestination());
+    // Route of any priority matches if priority is not specified
+    auto& routes = unicastRoutes_[proto];
+    auto it = routes.lower_bound(std::make_pair(
+        route.getDestination(), route.getPriority().value_or(0)));
+    if (it != routes.end() and it->first.first == route.getDestination() and
+        (not route.getPriority() or
+         it->first.second == route.getPriority().value())) {
+      routes.erase(it);
+      cnt = 1;
+    }
   }
   // Return 0 on success else ESRCH (no such process) error code
   return folly::SemiFuture<int>(cnt ? 0 : ESRCH);
 }
 
+folly::SemiFuture<std::vector<int>>
+MockNetlinkProtocolSocket::addRoutes(const std::vector<fbnl::Route>& routes) {
+  std::vector<int> status;
+  status.reserve(routes.size());
+  for (const auto& route : routes) {
+    status.emplace_back(addRoute(route).value());
+  }
+  return folly::SemiFuture<std::vector<int>>(std::move(status));
+}
+
+folly::SemiFuture<std::vector<int>>
+MockNetlinkProtocolSocket::deleteRoutes(
+    const std::vector<fbnl::Route>& routes) {
+  std::vector<int> status;
+  status.reserve(routes.size());
+  for (const auto& route : routes) {
+    status.emplace_back(deleteRoute(route).value());
+  }
+  return folly::SemiFuture<std::vector<int>>(std::move(status));
+}
+
+folly::SemiFuture<int>
+MockNetlinkProtocolSocket::addNextHopObject(
+    uint32_t id, const fbnl::NextHop& nextHop) {
+  fb303::fbData->addStatValue("nlmock.add_nexthop_object", 1, fb303::SUM);
+  if (nextHopGroupObjects_.count(id)) {
+    // Kernel doesn't replace group with single next-hop
+    return folly::SemiFuture<int>(EINVAL);
+  }
+  nextHopObjects_.insert_or_assign(id, nextHop);
+  return folly::SemiFuture<int>(0);
+}
+
+folly::SemiFuture<int>
+MockNetlinkProtocolSocket::addNextHopGroupObject(
+    uint32_t id, const std::vector<std::pair<uint32_t, uint16_t>>& members) {
+  fb303::fbData->addStatValue("nlmock.add_nexthop_object", 1, fb303::SUM);
+  if (members.empty() or nextHopObjects_.count(id)) {
+    return folly::SemiFuture<int>(EINVAL);
+  }
+  for (const auto& [memberId, _] : members) {
+    if (not nextHopObjects_.count(memberId)) {
+      return folly::SemiFuture<int>(EINVAL);
+    }
+  }
+  nextHopGroupObjects_.insert_or_assign(id, members);
+  return folly::SemiFuture<int>(0);
+}
+
+folly::SemiFuture<int>
+MockNetlinkProtocolSocket::deleteNextHopObject(uint32_t id) {
+  fb303::fbData->addStatValue("nlmock.delete_nexthop_object", 1, fb303::SUM);
+  const auto cnt = nextHopObjects_.erase(id) + nextHopGroupObjects_.erase(id);
+  return folly::SemiFuture<int>(cnt ? 0 : ENOENT);
+}
+
 folly::SemiFuture<folly::Expected<std::vector<fbnl::Route>, int>>
 MockNetlinkProtocolSocket::getRoutes(const fbnl::Route& filter) {
   const auto filterFamily = filter.getFamily();
@@ -126,6 +198,18 @@ MockNetlinkProtocolSocket::getRoutes(const fbnl::Route& filter) {
   return result;
 }
 
+folly::SemiFuture<int>
+MockNetlinkProtocolSocket::visitRoutes(
+    const fbnl::Route& filter, RouteVisitor visitor) {
+  auto routes = getRoutes(filter).get();
+  CHECK(routes.hasValue());
+
+  for (auto const& route : *routes) {
+    visitor(RouteView(route));
+  }
+  return folly::SemiFuture<int>(0);
+}
+
 folly::SemiFuture<int>
 MockNetlinkProtocolSocket::addIfAddress(const fbnl::IfAddress& addr) {
   // Search for addr list of interface index (it must exists)
@@ -145,7 +229,7 @@ MockNetlinkProtocolSocket::addIfAddress(const fbnl::IfAddress& addr) {
   it->second.emplace_back(addr); // Add
 
   // Publish update via queue
-  netlinkEventsQueue_.push(addr);
+  publishNetlinkEvent(addr);
   return folly::SemiFuture<int>(0);
 }
 
@@ -163,7 +247,7 @@ MockNetlinkProtocolSocket::deleteIfAddress(const fbnl::IfAddress& addr) {
       it->second.erase(addrIt);
 
       // Publish update via queue
-      netlinkEventsQueue_.push(addr);
+      publishNetlinkEvent(addr);
       return folly::SemiFuture<int>(0);
     }
   }
@@ -172,6 +256,34 @@ MockNetlinkProtocolSocket::deleteIfAddress(const fbnl::IfAddress& addr) {
   return folly::SemiFuture<int>(-EADDRNOTAVAIL);
 }
 
+folly::SemiFuture<std::vector<int>>
+MockNetlinkProtocolSocket::addIfAddresses(
+    const std::vector<fbnl::IfAddress>& addrs) {
+  std::vector<int> status;
+  status.reserve(addrs.size());
+  for (const auto& addr : addrs) {
+    status.emplace_back(addIfAddress(addr).value());
+  }
+  return folly::SemiFuture<std::vector<int>>(std::move(status));
+}
+
+folly::SemiFuture<std::vector<int>>
+MockNetlinkProtocolSocket::deleteIfAddresses(
+    const std::vector<fbnl::IfAddress>& addrs) {
+  std::vector<int> status;
+  status.reserve(addrs.size());
+  for (const auto& addr : addrs) {
+    status.emplace_back(deleteIfAddress(addr).value());
+  }
+  return folly::SemiFuture<std::vector<int>>(std::move(status));
+}
+
+void
+MockNetlinkProtocolSocket::publishNetlinkEvent(const NetlinkEvent& event) {
+  netlinkEventsQueue_.push(event);
+  netlinkEventsBatchQueue_.push(NetlinkEvents{event});
+}
+
 folly::SemiFuture<folly::Expected<std::vector<fbnl::IfAddress>, int>>
 MockNetlinkProtocolSocket::getAllIfAddresses() {
   std::vector<fbnl::IfAddress> addrs;
@@ -189,8 +301,11 @@ MockNetlinkProtocolSocket::addLink(const fbnl::Link& link) {
   // Create entry in ifAddr_ for link if doesn't exists
   ifAddrs_.emplace(link.getIfIndex(), std::list<fbnl::IfAddress>());
 
-  // Publish update via queue
-  netlinkEventsQueue_.push(link);
+  // Publish update via callback and queue as for kernel link events
+  if (linkEventCB_) {
+    linkEventCB_(link, true);
+  }
+  publishNetlinkEvent(link);
 
   return folly::SemiFuture<int>(0);
 }
@@ -52,11 +52,34 @@ class MockNetlinkProtocolSocket : public NetlinkProtocolSocket {
    */
   folly::SemiFuture<int> addRoute(const fbnl::Route& route) override;
   folly::SemiFuture<int> deleteRoute(const fbnl::Route& route) override;
+  folly::SemiFuture<std::vector<int>> addRoutes(
+      const std::vector<fbnl::Route>& routes) override;
+  folly::SemiFuture<std::vector<int>> deleteRoutes(
+      const std::vector<fbnl::Route>& routes) override;
   folly::SemiFuture<folly::Expected<std::vector<fbnl::Route>, int>> getRoutes(
       const fbnl::Route& filter) override;
+  folly::SemiFuture<int> visitRoutes(
+      const fbnl::Route& filter, RouteVisitor visitor) override;
+
+  folly::SemiFuture<int> addNextHopObject(
+      uint32_t id, const fbnl::NextHop& nextHop) override;
+  folly::SemiFuture<int> addNextHopGroupObject(
+      uint32_t id,
+      const std::vector<std::pair<uint32_t, uint16_t>>& members) override;
+  folly::SemiFuture<int> deleteNextHopObject(uint32_t id) override;
+
+  // Number of nexthop and group objects programmed
+  size_t
+  getNumNextHopObjects() const {
+    return nextHopObjects_.size() + nextHopGroupObjects_.size();
+  }
 
   folly::SemiFuture<int> addIfAddress(const fbnl::IfAddress&) override;
   folly::SemiFuture<int> deleteIfAddress(const fbnl::IfAddress&) override;
+  folly::SemiFuture<std::vector<int>> addIfAddresses(
+      const std::vector<fbnl::IfAddress>& addrs) override;
+  folly::SemiFuture<std::vector<int>> deleteIfAddresses(
+      const std::vector<fbnl::IfAddress>& addrs) override;
   folly::SemiFuture<folly::Expected<std::vector<fbnl::IfAddress>, int>>
   getAllIfAddresses() override;
 
@@ -74,14 +97,22 @@ class MockNetlinkProtocolSocket : public NetlinkProtocolSocket {
     return netlinkEventsQueue_.getReader();
   }
 
+  // Every event is published as batch of its own
+  messaging::RQueue<fbnl::NetlinkEvents>
+  getBatchReader() {
+    return netlinkEventsBatchQueue_.getReader();
+  }
+
   void
   openQueue() {
     netlinkEventsQueue_.open();
+    netlinkEventsBatchQueue_.open();
   }
 
   void
   closeQueue() {
     netlinkEventsQueue_.close();
+    netlinkEventsBatchQueue_.close();
   }
 
  protected:
@@ -91,6 +122,9 @@ class MockNetlinkProtocolSocket : public NetlinkProtocolSocket {
   }
 
  private:
+  // Publish event on both, per event and batch queues
+  void publishNetlinkEvent(const NetlinkEvent& event);
+
   // map<ifIndex -> Link>
   // NOTE: using map for ordered entries
   std::map<int, fbnl::Link> links_;
@@ -99,14 +133,23 @@ class MockNetlinkProtocolSocket : public NetlinkProtocolSocket {
   // NOTE: using map for ordered entries
   std::map<int, std::list<fbnl::IfAddress>> ifAddrs_;
 
-  // map<protocolId -> map<prefix/label, Route>
+  // map<protocolId -> map<prefix/label, Route>. Unicast routes are keyed by
+  // prefix and priority as in the kernel
   // NOTE: using map for ordered entries
-  std::unordered_map<uint8_t, std::map<folly::CIDRNetwork, fbnl::Route>>
+  std::unordered_map<
+      uint8_t,
+      std::map<std::pair<folly::CIDRNetwork, uint32_t>, fbnl::Route>>
       unicastRoutes_;
   std::unordered_map<uint8_t, std::map<uint32_t, fbnl::Route>> mplsRoutes_;
 
+  // map<id -> NextHop> and map<id -> members> of nexthop objects
+  std::unordered_map<uint32_t, fbnl::NextHop> nextHopObjects_;
+  std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, uint16_t>>>
+      nextHopGroupObjects_;
+
   // queue to publish LINK/ADDR updates
   messaging::ReplicateQueue<NetlinkEvent> netlinkEventsQueue_;
+  messaging::ReplicateQueue<NetlinkEvents> netlinkEventsBatchQueue_;
 };
 
 } // namespace openr::fbnl
@@ -7,21 +7,53 @@
 
 #include "Watchdog.h"
 
+#include <malloc.h>
+
+#include <fb303/ServiceData.h>
+#include <folly/memory/MallctlHelper.h>
+#include <folly/memory/Malloc.h>
+
 #include <openr/common/Constants.h>
 #include <openr/common/Util.h>
 
+namespace fb303 = facebook::fb303;
+
 namespace openr {
 
+namespace {
+
+// Return free memory of allocator to the system
+void
+purgeAllocator() {
+  if (not folly::usingJEMalloc()) {
+    malloc_trim(0);
+    return;
+  }
+  try {
+    // 4096 is MALLCTL_ARENAS_ALL, i.e. purge all arenas
+    folly::mallctlCall("arena.4096.purge");
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to purge memory arenas: " << folly::exceptionStr(ex);
+  }
+}
+
+} // namespace
+
 Watchdog::Watchdog(std::shared_ptr<const Config> config)
     : myNodeName_(config->getNodeName()),
       interval_(*config->getWatchdogConfig().interval_s_ref()),
       threadTimeout_(*config->getWatchdogConfig().thread_timeout_s_ref()),
       maxMemoryMB_(*config->getWatchdogConfig().max_memory_mb_ref()),
+      moduleMaxMemoryMB_(
+          *config->getWatchdogConfig().module_max_memory_mb_ref()),
       previousStatus_(true) {
+  memoryPressureHandlers_.emplace_back("purge_allocator", purgeAllocator);
+
   // Schedule periodic timer for checking thread health
   watchdogTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     updateCounters();
     monitorMemory();
+    monitorModuleMemory();
     // Schedule next timer
     watchdogTimer_->scheduleTimeout(interval_);
   });
@@ -31,12 +63,101 @@ Watchdog::Watchdog(std::shared_ptr<const Config> config)
 void
 Watchdog::addEvb(OpenrEventBase* evb, const std::string& name) {
   CHECK(evb);
-  getEvb()->runInEventBaseThreadAndWait([this, evb, name]() {
+  const auto arena = createArena(evb, name);
+  getEvb()->runInEventBaseThreadAndWait([this, evb, name, arena]() {
     CHECK_EQ(monitorEvbs_.count(evb), 0);
     monitorEvbs_.emplace(evb, name);
+    if (arena.has_value()) {
+      moduleArenas_.emplace(name, *arena);
+    }
+
+    const auto lagHistogram =
+        folly::sformat("watchdog.evb.{}.loop_lag_ms", name);
+    fb303::fbData->addHistogram(
+        lagHistogram,
+        Constants::kEvbLoopLagHistogramBucketMs,
+        0,
+        Constants::kEvbLoopLagHistogramMaxMs);
+    fb303::fbData->exportHistogramPercentile(lagHistogram, 50, 99);
   });
 }
 
+void
+Watchdog::updateLoopCounters(OpenrEventBase* evb, const std::string& name) {
+  const auto stats = evb->getAndResetLoopStats();
+  const auto prefix = folly::sformat("watchdog.evb.{}", name);
+
+  const auto loopTimeUs = stats.busyTimeUs + stats.idleTimeUs;
+  if (loopTimeUs > 0) {
+    fb303::fbData->setCounter(
+        prefix + ".busy_pct", stats.busyTimeUs * 100 / loopTimeUs);
+  }
+
+  for (const auto lagMs : stats.loopLagMs) {
+    fb303::fbData->addHistogramValue(prefix + ".loop_lag_ms", lagMs);
+  }
+
+  fb303::fbData->setCounter(prefix + ".fiber_runs", stats.numFiberRuns);
+  fb303::fbData->setCounter(
+      prefix + ".fiber_run_us.avg",
+      stats.numFiberRuns ? stats.fiberRunTimeUs / stats.numFiberRuns : 0);
+  fb303::fbData->setCounter(
+      prefix + ".fiber_run_us.max", stats.maxFiberRunTimeUs);
+
+  // Call sites show up as long as they are among the slowest
+  for (const auto& [callSite, runTimeUs] : stats.slowestCallbacksUs) {
+    VLOG(2) << "Thread " << name << ", callback from " << callSite << " ran "
+            << runTimeUs << "us";
+    fb303::fbData->addStatValue(
+        folly::sformat("{}.callback_us.{}", prefix, callSite),
+        runTimeUs,
+        fb303::MAX);
+  }
+}
+
+void
+Watchdog::addMemoryPressureHandler(
+    const std::string& name, std::function<void()> handler) {
+  getEvb()->runInEventBaseThreadAndWait(
+      [this, name, handler = std::move(handler)]() mutable {
+        memoryPressureHandlers_.emplace_back(name, std::move(handler));
+      });
+}
+
+std::optional<unsigned>
+Watchdog::createArena(OpenrEventBase* evb, const std::string& name) {
+  if (not folly::usingJEMalloc()) {
+    return std::nullopt;
+  }
+
+  unsigned arena{0};
+  try {
+    folly::mallctlRead("arenas.create", &arena);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to create memory arena for " << name << ": "
+               << folly::exceptionStr(ex);
+    return std::nullopt;
+  }
+
+  // Arena is bound per thread, hence it must be set from the thread of evb.
+  // Memory allocated before stays accounted to the default arena
+  bool bound{false};
+  evb->getEvb()->runInEventBaseThreadAndWait([&]() noexcept {
+    try {
+      folly::mallctlWrite("thread.arena", arena);
+      bound = true;
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "Failed to bind memory arena " << arena << " to " << name
+                 << ": " << folly::exceptionStr(ex);
+    }
+  });
+  if (not bound) {
+    return std::nullopt;
+  }
+  LOG(INFO) << "Allocating memory of " << name << " from arena " << arena;
+  return arena;
+}
+
 bool
 Watchdog::memoryLimitExceeded() {
   bool result;
@@ -54,6 +175,19 @@ Watchdog::monitorMemory() {
   if (memInUse_.value() / 1e6 > maxMemoryMB_) {
     LOG(WARNING) << "Memory usage critical:" << memInUse_.value() << " bytes,"
                  << " Memory limit:" << maxMemoryMB_ << " MB";
+
+    // Escalate response by one stage per interval
+    if (numMemoryPressureHandlersRun_ < memoryPressureHandlers_.size()) {
+      auto& [name, handler] =
+          memoryPressureHandlers_.at(numMemoryPressureHandlersRun_++);
+      LOG(WARNING) << "Responding to memory pressure with " << name;
+      fb303::fbData->addStatValue(
+          folly::sformat("watchdog.memory_pressure.{}", name),
+          1,
+          fb303::COUNT);
+      handler();
+    }
+
     if (not memExceedTime_.has_value()) {
       memExceedTime_ = std::chrono::steady_clock::now();
       return;
@@ -74,6 +208,63 @@ Watchdog::monitorMemory() {
   if (memExceedTime_.has_value()) {
     memExceedTime_ = std::nullopt;
   }
+  numMemoryPressureHandlersRun_ = 0;
+}
+
+void
+Watchdog::monitorModuleMemory() {
+  if (moduleArenas_.empty()) {
+    return;
+  }
+
+  try {
+    // Refresh statistics of jemalloc
+    folly::mallctlWrite<uint64_t>("epoch", 1);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to refresh memory statistics: "
+               << folly::exceptionStr(ex);
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto& [name, arena] : moduleArenas_) {
+    size_t smallAllocated{0}, largeAllocated{0};
+    try {
+      folly::mallctlRead(
+          folly::sformat("stats.arenas.{}.small.allocated", arena).c_str(),
+          &smallAllocated);
+      folly::mallctlRead(
+          folly::sformat("stats.arenas.{}.large.allocated", arena).c_str(),
+          &largeAllocated);
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "Failed to read memory statistics of " << name << ": "
+                 << folly::exceptionStr(ex);
+      continue;
+    }
+    const auto allocated = smallAllocated + largeAllocated;
+    fb303::fbData->setCounter(
+        folly::sformat("watchdog.memory.{}.allocated_bytes", name), allocated);
+
+    auto limitIt = moduleMaxMemoryMB_.find(name);
+    if (limitIt == moduleMaxMemoryMB_.end() or
+        allocated / 1e6 <= limitIt->second) {
+      moduleMemExceedTimes_.erase(name);
+      continue;
+    }
+    LOG(WARNING) << "Memory usage of " << name << " critical:" << allocated
+                 << " bytes, Memory limit:" << limitIt->second << " MB";
+    // check for sustained critical memory usage
+    auto [it, inserted] = moduleMemExceedTimes_.emplace(name, now);
+    if (not inserted and now - it->second > Constants::kMemoryThresholdTime) {
+      fireCrash(folly::sformat(
+          "Memory limit of {} exceeded the permitted limit."
+          " Mem used:{}."
+          " Mem Limit:{}",
+          name,
+          allocated,
+          limitIt->second));
+    }
+  }
 }
 
 void
@@ -96,6 +287,8 @@ Watchdog::updateCounters() {
       LOG(WARNING) << "Watchdog: " << name << " thread detected to be dead";
       stuckThreads.emplace_back(name);
     }
+
+    updateLoopCounters(kv.first, name);
   }
 
   if (stuckThreads.size() and previousStatus_) {
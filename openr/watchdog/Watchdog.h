@@ -7,9 +7,13 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <fbzmq/service/monitor/SystemMetrics.h>
 #include <folly/io/async/AsyncTimeout.h>
@@ -31,14 +35,36 @@ class Watchdog final : public OpenrEventBase {
 
   void addEvb(OpenrEventBase* evb, const std::string& name);
 
+  /**
+   * Register response to memory usage above max_memory_mb, run in Watchdog
+   * thread. Responses are run in order of registration, one more on every
+   * interval memory usage stays critical, before crashing the process after
+   * kMemoryThresholdTime. Purging free memory of allocator comes first
+   */
+  void addMemoryPressureHandler(
+      const std::string& name, std::function<void()> handler);
+
   bool memoryLimitExceeded();
 
  private:
   void updateCounters();
 
+  // export loop stats of evb, accumulated since previous export
+  void updateLoopCounters(OpenrEventBase* evb, const std::string& name);
+
   // monitor memory usage
   void monitorMemory();
 
+  // export memory allocated by every module thread and enforce limits of
+  // module_max_memory_mb
+  void monitorModuleMemory();
+
+  // serve allocations of evb thread from a jemalloc arena of its own to
+  // account memory per module. Returns the arena or std::nullopt if jemalloc
+  // is not in use
+  std::optional<unsigned> createArena(
+      OpenrEventBase* evb, const std::string& name);
+
   void fireCrash(const std::string& msg);
 
   const std::string myNodeName_;
@@ -58,12 +84,28 @@ class Watchdog final : public OpenrEventBase {
   // critcal memory threhsold
   uint32_t maxMemoryMB_{0};
 
+  // critical memory threshold of module threads by name
+  const std::map<std::string, int32_t> moduleMaxMemoryMB_;
+
+  // jemalloc arena of module threads by name
+  std::unordered_map<std::string, unsigned> moduleArenas_;
+
+  // time since memory allocated by module threads has been above their limit
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+      moduleMemExceedTimes_;
+
   // boolean to indicate previous failure
   bool previousStatus_{true};
 
   // amount of time memory usage sustained above memory limit
   std::optional<std::chrono::steady_clock::time_point> memExceedTime_;
 
+  // responses to critical memory usage in order of escalation, and number of
+  // them run since memory usage became critical
+  std::vector<std::pair<std::string, std::function<void()>>>
+      memoryPressureHandlers_;
+  size_t numMemoryPressureHandlersRun_{0};
+
   // Get the system metrics for resource usage counters
   fbzmq::SystemMetrics systemMetrics_{};
 };